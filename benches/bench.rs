@@ -4,7 +4,7 @@ use std::env;
 use criterion::{criterion_group, criterion_main, Criterion};
 
 #[allow(unused_imports)]
-use sort_test_tools::ffi_types::{FFIOneKibiByte, FFIString, F128};
+use sort_test_tools::ffi_types::{FFIArenaString, FFIOneKibiByte, FFIString, F128};
 
 use sort_test_tools::patterns;
 
@@ -48,14 +48,26 @@ fn random_x_percent(len: usize, percent: f64) -> Vec<i32> {
     shuffle_vec(v)
 }
 
+fn adversarial_max_len() -> usize {
+    env::var("BENCH_ADVERSARIAL_MAX_LEN")
+        .map(|val| {
+            val.parse()
+                .expect("BENCH_ADVERSARIAL_MAX_LEN must be a length")
+        })
+        .unwrap_or(50_000)
+}
+
 fn bench_patterns<T: Ord + std::fmt::Debug>(
     c: &mut Criterion,
     test_len: usize,
     transform_name: &str,
     transform: fn(Vec<i32>) -> Vec<T>,
 ) {
-    if test_len > 100_000 && (transform_name == "string" || transform_name == "1k") {
-        // These are just too expensive.
+    if test_len > 100_000
+        && matches!(transform_name, "string" | "dataset_string" | "1k")
+        && modules::input_cache::count().is_none()
+    {
+        // These are just too expensive, unless the inputs are only generated once per benchmark.
         return;
     }
 
@@ -226,6 +238,26 @@ fn bench_patterns<T: Ord + std::fmt::Debug>(
         pattern_providers.append(&mut extra_pattern_providers);
     }
 
+    // Worst case inputs for quicksorts, see patterns::median_of_3_killer and patterns::antiqsort.
+    // They take O(n^2) for the sorts they defeat, so they stop at BENCH_ADVERSARIAL_MAX_LEN.
+    if env::var("BENCH_ADVERSARIAL").is_ok() && test_len <= adversarial_max_len() {
+        pattern_providers.push(("median_of_3_killer", patterns::median_of_3_killer));
+        // Replaced by an adversary against the measured sort in modules::sort.
+        pattern_providers.push(("antiqsort", |len| {
+            patterns::antiqsort(len, |v, compare| v.sort_unstable_by(|a, b| compare(a, b)))
+        }));
+    }
+
+    // Real world data, see patterns::dataset.
+    if let Some(dataset_name) = patterns::dataset_name() {
+        pattern_providers.push((dataset_name, patterns::dataset));
+    }
+
+    // Slowest inputs found by the perf fuzz target, see patterns::perf_corpus.
+    if let Some(perf_corpus_name) = patterns::perf_corpus_name() {
+        pattern_providers.push((perf_corpus_name, patterns::perf_corpus));
+    }
+
     for (pattern_name, pattern_provider) in pattern_providers.iter() {
         if test_len < 3 && *pattern_name != "random" {
             continue;
@@ -289,6 +321,39 @@ fn ensure_true_random() {
     assert_ne!(random_vec_a, random_vec_b);
 }
 
+// The SIMD sorts pick their instruction set at runtime, make it visible which one the results
+// belong to.
+fn print_simd_targets() {
+    #[cfg(feature = "cpp_simdsort")]
+    eprintln!(
+        "cpp_simdsort SIMD target: {}",
+        sort_research_rs::other::cpp_simdsort::simd_target()
+    );
+
+    #[cfg(feature = "cpp_vqsort")]
+    eprintln!(
+        "cpp_vqsort SIMD target: {}",
+        sort_research_rs::other::cpp_vqsort::simd_target()
+    );
+
+    #[cfg(feature = "cpp_intel_avx512")]
+    eprintln!(
+        "cpp_intel_avx512 SIMD target: {}",
+        sort_research_rs::other::cpp_intel_avx512::simd_target()
+    );
+}
+
+// Set by run_benchmarks.py --repeat to a different size in every process, so that the heap layout
+// of a single process doesn't decide the result.
+fn pad_heap() {
+    if let Ok(val) = env::var("BENCH_HEAP_PAD") {
+        let pad = val
+            .parse::<usize>()
+            .expect("BENCH_HEAP_PAD must be a number of bytes");
+        std::mem::forget(Vec::<u8>::with_capacity(pad));
+    }
+}
+
 fn criterion_benchmark(c: &mut Criterion) {
     // Distribute points somewhat evenly up to 1e7 in log10 space.
     let test_sizes = [
@@ -296,8 +361,10 @@ fn criterion_benchmark(c: &mut Criterion) {
         22_367, 50_000, 100_000, 183_845, 400_000, 1_000_000, 2_000_000, 4_281_332, 10_000_000,
     ];
 
+    pad_heap();
     patterns::disable_fixed_seed();
     ensure_true_random();
+    print_simd_targets();
 
     for test_len in test_sizes {
         // Basic type often used to test sorting algorithms.
@@ -318,6 +385,32 @@ fn criterion_benchmark(c: &mut Criterion) {
                 .collect()
         });
 
+        // The lines of the BENCH_DATASET file, e.g. URLs, as FFIString. Every value picks the line
+        // of that rank, see patterns::dataset_lines.
+        if patterns::dataset_lines().is_some() {
+            bench_patterns(c, test_len, "dataset_string", |values| {
+                let lines = patterns::dataset_lines().unwrap();
+                values
+                    .into_iter()
+                    .map(|val| {
+                        let line = lines[val.rem_euclid(lines.len() as i32) as usize];
+                        FFIString::new(String::from_utf8_lossy(line).into_owned())
+                    })
+                    .collect()
+            });
+        }
+
+        // Same strings as "string", stored in a single arena with an inline prefix. Only supported
+        // by std, pdqsort, ips4o and powersort on the C++ side.
+        bench_patterns(c, test_len, "arena_string", |values| {
+            let strs = values
+                .into_iter()
+                .map(|val| format!("{:010}", shift_i32_to_u32(val)))
+                .collect::<Vec<_>>();
+
+            FFIArenaString::from_strs(&strs)
+        });
+
         // Very large stack value.
         bench_patterns(c, test_len, "1k", |values| {
             values.iter().map(|val| FFIOneKibiByte::new(*val)).collect()
@@ -359,6 +452,15 @@ fn criterion_benchmark(c: &mut Criterion) {
             });
         }
 
+        #[cfg(feature = "bench_type_i16")]
+        {
+            bench_patterns(c, test_len, "i16", |values| -> Vec<i16> {
+                compress_i32(&values, 2u32.pow(u16::BITS) as f64)
+                    .map(|val| (val as i32 + i16::MIN as i32) as i16)
+                    .collect()
+            });
+        }
+
         #[cfg(feature = "bench_type_u32")]
         {
             bench_patterns(c, test_len, "u32", |values| -> Vec<u32> {
@@ -373,6 +475,24 @@ fn criterion_benchmark(c: &mut Criterion) {
             });
         }
 
+        #[cfg(feature = "bench_type_f32")]
+        {
+            use sort_test_tools::ffi_types::F32;
+
+            bench_patterns(c, test_len, "f32", |values| -> Vec<F32> {
+                values.into_iter().map(F32::new).collect()
+            });
+        }
+
+        #[cfg(feature = "bench_type_f64")]
+        {
+            use sort_test_tools::ffi_types::F64;
+
+            bench_patterns(c, test_len, "f64", |values| -> Vec<F64> {
+                values.into_iter().map(F64::new).collect()
+            });
+        }
+
         #[cfg(feature = "bench_type_val_with_mutex")]
         {
             use std::cmp::Ordering;
@@ -0,0 +1,131 @@
+use criterion::{black_box, BatchSize, Criterion, Throughput};
+
+#[allow(unused_imports)]
+use sort_research_rs::{other, unstable};
+
+use sort_test_tools::Sort;
+
+use crate::modules::util::{pin_thread_to_core, should_run_benchmark};
+
+// Small batches like single network packets, and larger ones like buffered log lines.
+const BATCH_LENS: [usize; 2] = [16, 1024];
+
+// Re-sorting is quadratic in the number of batches, beyond that it only burns benchmark time.
+const MAX_RESORT_BATCHES: usize = 4096;
+
+// Compares appending batches to a run accumulator and finalizing it, against keeping the buffer
+// sorted by re-sorting all of it after every append. Reported throughput is in elements per
+// second.
+#[allow(unused)]
+fn bench_accumulate_impl<A>(
+    c: &mut Criterion,
+    test_len: usize,
+    pattern_name: &str,
+    pattern_provider: &fn(usize) -> Vec<i32>,
+    sort_name: &str,
+    new_accumulator: fn() -> A,
+    append: fn(&mut A, &[u64]),
+    finalize: fn(&mut A) -> &[u64],
+    sort: fn(&mut [u64]),
+) {
+    // Pin the benchmark to the same core to improve repeatability.
+    pin_thread_to_core();
+
+    let group_name = format!("{sort_name}-hot-u64-{pattern_name}-{test_len}");
+
+    let make_input = || {
+        pattern_provider(test_len)
+            .into_iter()
+            .map(|val| val as u64)
+            .collect::<Vec<_>>()
+    };
+
+    for batch_len in BATCH_LENS {
+        if batch_len > test_len {
+            continue;
+        }
+
+        let accumulate_name = format!("accumulate_b{batch_len}");
+        let resort_name = format!("resort_b{batch_len}");
+
+        let mut group = c.benchmark_group(&group_name);
+        group.throughput(Throughput::Elements(test_len as u64));
+
+        if should_run_benchmark(&format!("{group_name}/{accumulate_name}")) {
+            group.bench_function(&accumulate_name, |b| {
+                b.iter_batched_ref(
+                    make_input,
+                    |test_data| {
+                        let mut acc = new_accumulator();
+                        for batch in black_box(test_data.as_slice()).chunks(batch_len) {
+                            append(&mut acc, batch);
+                        }
+                        black_box(finalize(&mut acc)); // side-effect
+                    },
+                    BatchSize::LargeInput,
+                )
+            });
+        }
+
+        if test_len.div_ceil(batch_len) <= MAX_RESORT_BATCHES
+            && should_run_benchmark(&format!("{group_name}/{resort_name}"))
+        {
+            group.bench_function(&resort_name, |b| {
+                b.iter_batched_ref(
+                    make_input,
+                    |test_data| {
+                        let mut buffer = Vec::new();
+                        for batch in black_box(test_data.as_slice()).chunks(batch_len) {
+                            buffer.extend_from_slice(batch);
+                            sort(&mut buffer);
+                        }
+                        black_box(buffer); // side-effect
+                    },
+                    BatchSize::LargeInput,
+                )
+            });
+        }
+
+        group.finish();
+    }
+}
+
+#[allow(unused)]
+pub fn bench<T: Ord + std::fmt::Debug>(
+    c: &mut Criterion,
+    test_len: usize,
+    transform_name: &str,
+    transform: &fn(Vec<i32>) -> Vec<T>,
+    pattern_name: &str,
+    pattern_provider: &fn(usize) -> Vec<i32>,
+) {
+    // Only the u64 accumulator entry points exist.
+    if transform_name != "u64" {
+        return;
+    }
+
+    #[allow(unused_macros)]
+    macro_rules! bench_inst {
+        ($sort_impl_path:path) => {{
+            use $sort_impl_path::*;
+
+            bench_accumulate_impl(
+                c,
+                test_len,
+                pattern_name,
+                pattern_provider,
+                <SortImpl as Sort>::name().as_str(),
+                RunAccumulator::new,
+                RunAccumulator::append,
+                RunAccumulator::finalize,
+                <SortImpl as Sort>::sort::<u64>,
+            );
+        }};
+    }
+
+    #[cfg(feature = "cpp_pdqsort")]
+    bench_inst!(unstable::cpp_pdqsort);
+
+    #[cfg(feature = "cpp_vqsort")]
+    bench_inst!(other::cpp_vqsort);
+}
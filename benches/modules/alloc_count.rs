@@ -0,0 +1,158 @@
+//! Heap usage accounting for the whole process, by interposing the malloc family. That covers the
+//! Rust global allocator, which is System and as such backed by malloc, as well as malloc and
+//! operator new in the C and C++ implementations, including the threads spawned by the parallel
+//! ones.
+//!
+//! Allocations are forwarded to the `__libc_*` entry points, which only glibc exports. Sizes are
+//! those reported by malloc_usable_size, so they include the rounding of the allocator, but not
+//! its per chunk headers.
+
+use std::os::raw::c_void;
+use std::sync::atomic::{AtomicIsize, AtomicUsize, Ordering};
+
+extern "C" {
+    fn __libc_malloc(size: usize) -> *mut c_void;
+    fn __libc_calloc(count: usize, size: usize) -> *mut c_void;
+    fn __libc_realloc(ptr: *mut c_void, size: usize) -> *mut c_void;
+    fn __libc_free(ptr: *mut c_void);
+    fn __libc_memalign(align: usize, size: usize) -> *mut c_void;
+    fn __libc_valloc(size: usize) -> *mut c_void;
+    fn __libc_pvalloc(size: usize) -> *mut c_void;
+    fn malloc_usable_size(ptr: *mut c_void) -> usize;
+    #[link_name = "__errno_location"]
+    fn libc_errno() -> *mut i32;
+}
+
+// Signed, memory handed out before the interposition took effect may still be freed through it.
+static CURRENT_BYTES: AtomicIsize = AtomicIsize::new(0);
+static PEAK_BYTES: AtomicIsize = AtomicIsize::new(0);
+static ALLOC_COUNT: AtomicUsize = AtomicUsize::new(0);
+
+fn track_alloc(ptr: *mut c_void) -> *mut c_void {
+    if !ptr.is_null() {
+        // SAFETY: ptr was just returned by the glibc allocator.
+        let size = unsafe { malloc_usable_size(ptr) } as isize;
+        let current = CURRENT_BYTES.fetch_add(size, Ordering::Relaxed) + size;
+        PEAK_BYTES.fetch_max(current, Ordering::Relaxed);
+        ALLOC_COUNT.fetch_add(1, Ordering::Relaxed);
+    }
+
+    ptr
+}
+
+fn track_free(ptr: *mut c_void) {
+    if !ptr.is_null() {
+        // SAFETY: ptr is live memory of the glibc allocator, about to be freed.
+        let size = unsafe { malloc_usable_size(ptr) } as isize;
+        CURRENT_BYTES.fetch_sub(size, Ordering::Relaxed);
+    }
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn malloc(size: usize) -> *mut c_void {
+    track_alloc(__libc_malloc(size))
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn calloc(count: usize, size: usize) -> *mut c_void {
+    track_alloc(__libc_calloc(count, size))
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn realloc(ptr: *mut c_void, size: usize) -> *mut c_void {
+    // glibc frees ptr for a size of 0, and keeps it on failure.
+    let old_size = if ptr.is_null() {
+        0
+    } else {
+        malloc_usable_size(ptr)
+    };
+
+    let new_ptr = __libc_realloc(ptr, size);
+    if new_ptr.is_null() && size != 0 {
+        return new_ptr;
+    }
+
+    CURRENT_BYTES.fetch_sub(old_size as isize, Ordering::Relaxed);
+    track_alloc(new_ptr)
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn reallocarray(ptr: *mut c_void, count: usize, size: usize) -> *mut c_void {
+    const ENOMEM: i32 = 12;
+
+    let Some(total_size) = count.checked_mul(size) else {
+        *libc_errno() = ENOMEM;
+        return std::ptr::null_mut();
+    };
+
+    realloc(ptr, total_size)
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn free(ptr: *mut c_void) {
+    track_free(ptr);
+    __libc_free(ptr);
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn memalign(align: usize, size: usize) -> *mut c_void {
+    track_alloc(__libc_memalign(align, size))
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn aligned_alloc(align: usize, size: usize) -> *mut c_void {
+    track_alloc(__libc_memalign(align, size))
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn posix_memalign(
+    out_ptr: *mut *mut c_void,
+    align: usize,
+    size: usize,
+) -> i32 {
+    const EINVAL: i32 = 22;
+    const ENOMEM: i32 = 12;
+
+    if !align.is_power_of_two() || align % std::mem::size_of::<usize>() != 0 {
+        return EINVAL;
+    }
+
+    let ptr = track_alloc(__libc_memalign(align, size));
+    if ptr.is_null() {
+        return ENOMEM;
+    }
+
+    *out_ptr = ptr;
+    0
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn valloc(size: usize) -> *mut c_void {
+    track_alloc(__libc_valloc(size))
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn pvalloc(size: usize) -> *mut c_void {
+    track_alloc(__libc_pvalloc(size))
+}
+
+pub struct AllocStats {
+    /// Highest heap usage above the level at the start of the measurement.
+    pub peak_bytes: usize,
+    pub alloc_count: usize,
+}
+
+/// Runs `f` and reports the heap memory it needed on top of what was already allocated. Other
+/// threads that allocate concurrently are attributed to `f`.
+pub fn measure(f: impl FnOnce()) -> AllocStats {
+    let base_bytes = CURRENT_BYTES.load(Ordering::Relaxed);
+    PEAK_BYTES.store(base_bytes, Ordering::Relaxed);
+    let base_count = ALLOC_COUNT.load(Ordering::Relaxed);
+
+    f();
+
+    AllocStats {
+        peak_bytes: (PEAK_BYTES.load(Ordering::Relaxed) - base_bytes).max(0) as usize,
+        alloc_count: ALLOC_COUNT.load(Ordering::Relaxed) - base_count,
+    }
+}
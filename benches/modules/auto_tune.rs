@@ -0,0 +1,45 @@
+//! The calibrated per host choice of other::auto_tune, against ipnsort. The first call loads the
+//! table of this CPU model, or calibrates and stores it if there is none, so running this is also
+//! the way to calibrate a machine ahead of time.
+
+use criterion::Criterion;
+
+use sort_research_rs::other::auto_tune;
+use sort_research_rs::unstable::rust_ipnsort;
+
+use sort_test_tools::Sort;
+
+use crate::modules::util::bench_fn;
+
+pub fn bench<T: Ord + std::fmt::Debug>(
+    c: &mut Criterion,
+    test_len: usize,
+    transform_name: &str,
+    transform: &fn(Vec<i32>) -> Vec<T>,
+    pattern_name: &str,
+    pattern_provider: &fn(usize) -> Vec<i32>,
+) {
+    // Only these types have table entries.
+    if !matches!(transform_name, "i32" | "u64") {
+        return;
+    }
+
+    // Calibrate outside of the measurement.
+    auto_tune::table();
+
+    let mut bench_sort = |sort_name: String, test_fn: fn(&mut [T])| {
+        bench_fn(
+            c,
+            test_len,
+            transform_name,
+            transform,
+            pattern_name,
+            pattern_provider,
+            &sort_name,
+            test_fn,
+        );
+    };
+
+    bench_sort(<auto_tune::SortImpl as Sort>::name(), auto_tune::sort);
+    bench_sort(<rust_ipnsort::SortImpl as Sort>::name(), rust_ipnsort::sort);
+}
@@ -0,0 +1,276 @@
+use std::sync::Mutex;
+use std::thread;
+
+use criterion::{black_box, BatchSize, Criterion, Throughput};
+
+#[allow(unused_imports)]
+use sort_research_rs::{other, unstable};
+
+use sort_test_tools::patterns;
+use sort_test_tools::Sort;
+
+use crate::modules::util::{pin_thread_to_core, should_run_benchmark};
+
+// Typical group-by key counts.
+const SLICE_LENS: [usize; 4] = [8, 16, 32, 64];
+
+fn make_offsets(test_len: usize, slice_len: usize) -> Vec<usize> {
+    let mut offsets = (0..test_len).step_by(slice_len).collect::<Vec<_>>();
+    offsets.push(test_len);
+
+    offsets
+}
+
+// Compares sorting all slices with one batch call, against one FFI call per slice. Reported
+// throughput is in slices per second.
+#[allow(unused)]
+fn bench_batch_impl<T: Ord + std::fmt::Debug>(
+    c: &mut Criterion,
+    test_len: usize,
+    transform_name: &str,
+    transform: &fn(Vec<i32>) -> Vec<T>,
+    pattern_name: &str,
+    pattern_provider: &fn(usize) -> Vec<i32>,
+    sort_name: &str,
+    sort_batch: impl Fn(&mut [T], &[usize]),
+    sort: impl Fn(&mut [T]),
+) {
+    // Pin the benchmark to the same core to improve repeatability.
+    pin_thread_to_core();
+
+    let group_name = format!("{sort_name}-hot-{transform_name}-{pattern_name}-{test_len}");
+
+    for slice_len in SLICE_LENS {
+        if slice_len > test_len {
+            continue;
+        }
+
+        let offsets = make_offsets(test_len, slice_len);
+        let n_slices = offsets.len() - 1;
+
+        let batch_name = format!("batch_s{slice_len}");
+        let per_slice_name = format!("per_slice_s{slice_len}");
+
+        let mut group = c.benchmark_group(&group_name);
+        group.throughput(Throughput::Elements(n_slices as u64));
+
+        if should_run_benchmark(&format!("{group_name}/{batch_name}")) {
+            group.bench_function(&batch_name, |b| {
+                b.iter_batched_ref(
+                    || transform(pattern_provider(test_len)),
+                    |test_data| {
+                        sort_batch(black_box(test_data.as_mut_slice()), &offsets);
+                        black_box(test_data); // side-effect
+                    },
+                    BatchSize::LargeInput,
+                )
+            });
+        }
+
+        if should_run_benchmark(&format!("{group_name}/{per_slice_name}")) {
+            group.bench_function(&per_slice_name, |b| {
+                b.iter_batched_ref(
+                    || transform(pattern_provider(test_len)),
+                    |test_data| {
+                        let data = black_box(test_data.as_mut_slice());
+                        for bounds in offsets.windows(2) {
+                            sort(&mut data[bounds[0]..bounds[1]]);
+                        }
+                        black_box(test_data); // side-effect
+                    },
+                    BatchSize::LargeInput,
+                )
+            });
+        }
+
+        group.finish();
+    }
+}
+
+// Mostly short segments plus a few that hold a large part of the input, like group-by keys with
+// some heavy hitters. Segment lengths are log-uniform between 8 and half of the input.
+#[allow(unused)]
+fn make_skewed_offsets(test_len: usize) -> Vec<usize> {
+    let max_log = (test_len / 4).max(8).ilog2();
+    let rand_vals = patterns::random_uniform(test_len, 0..=i32::MAX);
+
+    let mut offsets = vec![0];
+    for rand_val in rand_vals.chunks_exact(2) {
+        let segment_log = 3 + (rand_val[0] as u32 % (max_log - 2));
+        let segment_len = (1 << segment_log) + (rand_val[1] as usize % (1 << segment_log));
+
+        let segment_end = offsets.last().unwrap() + segment_len;
+        if segment_end >= test_len {
+            break;
+        }
+        offsets.push(segment_end);
+    }
+    offsets.push(test_len);
+
+    offsets
+}
+
+// Sequential sort per segment, spread across threads in small chunks of segments. That's roughly
+// what a rayon `par_iter` over the segments would do.
+#[allow(unused)]
+fn sort_segments_per_thread(
+    data: &mut [u64],
+    offsets: &[usize],
+    num_threads: usize,
+    sort: fn(&mut [u64]),
+) {
+    const CHUNK_SEGMENTS: usize = 16;
+
+    let mut segments = Vec::with_capacity(offsets.len());
+    let mut rest = &mut data[offsets[0]..];
+    for bounds in offsets.windows(2) {
+        let (segment, tail) = rest.split_at_mut(bounds[1] - bounds[0]);
+        segments.push(segment);
+        rest = tail;
+    }
+
+    let chunks = Mutex::new(segments.chunks_mut(CHUNK_SEGMENTS));
+
+    thread::scope(|s| {
+        for _ in 0..num_threads {
+            s.spawn(|| loop {
+                let Some(chunk) = chunks.lock().unwrap().next() else {
+                    break;
+                };
+
+                for segment in chunk {
+                    sort(segment);
+                }
+            });
+        }
+    });
+}
+
+// Compares the segmented parallel sort against the sequential sort per segment, spread across the
+// same number of threads. Needs BENCH_NO_PIN, otherwise all threads share the pinned core.
+// Reported throughput is in segments per second.
+#[cfg(feature = "cpp_ips4o_parallel")]
+fn bench_segments_parallel(
+    c: &mut Criterion,
+    test_len: usize,
+    pattern_name: &str,
+    pattern_provider: &fn(usize) -> Vec<i32>,
+) {
+    use sort_research_rs::ffi_util;
+
+    pin_thread_to_core();
+
+    let offsets = make_skewed_offsets(test_len);
+    let n_segments = offsets.len() - 1;
+    let num_threads = ffi_util::num_threads();
+
+    let group_name = format!("segments_t{num_threads}-hot-u64-{pattern_name}-{test_len}");
+    let mut group = c.benchmark_group(&group_name);
+    group.throughput(Throughput::Elements(n_segments as u64));
+
+    let make_input = || {
+        pattern_provider(test_len)
+            .into_iter()
+            .map(|val| val as u64)
+            .collect::<Vec<_>>()
+    };
+
+    let parallel_name = <unstable::cpp_ips4o_parallel::SortImpl as Sort>::name();
+    if should_run_benchmark(&format!("{group_name}/{parallel_name}")) {
+        group.bench_function(&parallel_name, |b| {
+            b.iter_batched_ref(
+                make_input,
+                |test_data| {
+                    unstable::cpp_ips4o_parallel::sort_batch(
+                        black_box(test_data.as_mut_slice()),
+                        &offsets,
+                    );
+                    black_box(test_data); // side-effect
+                },
+                BatchSize::LargeInput,
+            )
+        });
+    }
+
+    #[cfg(feature = "cpp_ips4o")]
+    {
+        let per_thread_name = format!(
+            "{}_per_segment",
+            <unstable::cpp_ips4o::SortImpl as Sort>::name()
+        );
+        if should_run_benchmark(&format!("{group_name}/{per_thread_name}")) {
+            group.bench_function(&per_thread_name, |b| {
+                b.iter_batched_ref(
+                    make_input,
+                    |test_data| {
+                        sort_segments_per_thread(
+                            black_box(test_data.as_mut_slice()),
+                            &offsets,
+                            num_threads,
+                            <unstable::cpp_ips4o::SortImpl as Sort>::sort::<u64>,
+                        );
+                        black_box(test_data); // side-effect
+                    },
+                    BatchSize::LargeInput,
+                )
+            });
+        }
+    }
+
+    group.finish();
+}
+
+#[allow(unused)]
+pub fn bench<T: Ord + std::fmt::Debug>(
+    c: &mut Criterion,
+    test_len: usize,
+    transform_name: &str,
+    transform: &fn(Vec<i32>) -> Vec<T>,
+    pattern_name: &str,
+    pattern_provider: &fn(usize) -> Vec<i32>,
+) {
+    // Only the u64 batch entry points exist.
+    if transform_name != "u64" {
+        return;
+    }
+
+    #[allow(unused_macros)]
+    macro_rules! bench_inst {
+        ($sort_impl_path:path) => {{
+            use $sort_impl_path::*;
+
+            bench_batch_impl(
+                c,
+                test_len,
+                transform_name,
+                transform,
+                pattern_name,
+                pattern_provider,
+                <SortImpl as Sort>::name().as_str(),
+                sort_batch::<T>,
+                <SortImpl as Sort>::sort,
+            );
+        }};
+    }
+
+    #[cfg(feature = "cpp_std_sys")]
+    bench_inst!(unstable::cpp_std_sys);
+
+    #[cfg(feature = "cpp_std_libcxx")]
+    bench_inst!(unstable::cpp_std_libcxx);
+
+    #[cfg(feature = "cpp_pdqsort")]
+    bench_inst!(unstable::cpp_pdqsort);
+
+    #[cfg(feature = "cpp_vqsort")]
+    bench_inst!(other::cpp_vqsort);
+
+    #[cfg(all(feature = "cpp_intel_avx512", target_arch = "x86_64"))]
+    bench_inst!(other::cpp_intel_avx512);
+
+    // Segmented sorting only pays off for inputs that are large enough to spread across threads.
+    #[cfg(feature = "cpp_ips4o_parallel")]
+    if test_len >= 100_000 {
+        bench_segments_parallel(c, test_len, pattern_name, pattern_provider);
+    }
+}
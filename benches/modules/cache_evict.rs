@@ -0,0 +1,90 @@
+//! Evicts benchmark inputs and code from the CPU caches, for the data cold benchmarks. Together
+//! with trash_prediction this approximates a sort running on data that just arrived from the
+//! network, long after the sort itself last ran.
+
+use std::cell::RefCell;
+use std::env;
+
+use criterion::black_box;
+
+use once_cell::sync::OnceCell;
+
+use crate::modules::util::llc_bytes;
+
+// Conservative cache line size, flushing more often than needed is harmless.
+const CACHE_LINE_SIZE: usize = 64;
+
+/// Data cold benchmarks are opt-in via BENCH_COLD_DATA, they are a lot slower to run.
+pub fn is_enabled() -> bool {
+    static IS_ENABLED: OnceCell<bool> = OnceCell::new();
+
+    *IS_ENABLED.get_or_init(|| env::var("BENCH_COLD_DATA").is_ok())
+}
+
+// Touching a buffer twice the size of the LLC pushes everything else out of the unified caches,
+// including the code of the sort. The instruction cache and the predictors are then taken care
+// of by trash_prediction.
+fn stream_through_caches() {
+    thread_local! {
+        static BUFFER: RefCell<Vec<u8>> = RefCell::new(vec![1; 2 * llc_bytes()]);
+    }
+
+    BUFFER.with(|buffer| {
+        let mut buffer = buffer.borrow_mut();
+        for line in buffer.chunks_exact_mut(CACHE_LINE_SIZE) {
+            line[0] = line[0].wrapping_add(1);
+        }
+        black_box(buffer.as_ptr());
+    });
+}
+
+// Start addresses of the cache lines overlapping [ptr, ptr + len).
+#[allow(unused)]
+fn line_addrs(ptr: *const u8, len: usize) -> impl Iterator<Item = *const u8> {
+    let start = ptr as usize & !(CACHE_LINE_SIZE - 1);
+    (start..ptr as usize + len)
+        .step_by(CACHE_LINE_SIZE)
+        .map(|addr| addr as *const u8)
+}
+
+#[cfg(target_arch = "x86_64")]
+fn flush_lines(ptr: *const u8, len: usize) {
+    use std::arch::x86_64::{_mm_clflush, _mm_mfence};
+
+    // SAFETY: clflush is part of SSE2, which is baseline on x86_64, and only needs the address
+    // to be mapped. Every line overlapping a live slice is.
+    unsafe {
+        for addr in line_addrs(ptr, len) {
+            _mm_clflush(addr);
+        }
+        _mm_mfence();
+    }
+}
+
+#[cfg(target_arch = "aarch64")]
+fn flush_lines(ptr: *const u8, len: usize) {
+    // SAFETY: Linux and macOS allow dc civac from user space, and it only needs the address to be
+    // mapped. Every line overlapping a live slice is.
+    unsafe {
+        for addr in line_addrs(ptr, len) {
+            std::arch::asm!("dc civac, {}", in(reg) addr, options(nostack));
+        }
+        std::arch::asm!("dsb sy", options(nostack));
+    }
+}
+
+#[cfg(not(any(target_arch = "x86_64", target_arch = "aarch64")))]
+fn flush_lines(_ptr: *const u8, _len: usize) {
+    // The streaming pass has to do.
+}
+
+/// Evicts `data` from all cache levels, and pushes the rest, code included, out of the unified
+/// caches. Heap memory owned by the elements, e.g. string contents, is only evicted by the
+/// streaming pass.
+pub fn evict<T>(data: &[T]) {
+    stream_through_caches();
+
+    // Explicitly flushed last, the streaming pass alone may miss lines on caches with a smart
+    // replacement policy.
+    flush_lines(data.as_ptr() as *const u8, std::mem::size_of_val(data));
+}
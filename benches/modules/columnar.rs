@@ -0,0 +1,145 @@
+//! Sorting a columnar table by (u32, u64, string), once with the columnar sorts, that encode the
+//! columns into normalized integer keys and only compare rows with equal keys, and once with
+//! comparison sorts that call back into Rust for every comparison. The comparison sorts either
+//! sort the row indices, or first materialize every row as FFIOneKibiByte holding the integer
+//! columns and the row index. All variants produce the same permutation of row indices.
+//!
+//! The u64 column follows the benchmarked pattern, the u32 column has 16 distinct values and the
+//! string column 1000, with a common prefix longer than what fits into the normalized key.
+
+#[allow(unused_imports)]
+use std::cmp::Ordering;
+
+#[allow(unused_imports)]
+use criterion::{black_box, Criterion};
+
+#[allow(unused_imports)]
+use sort_research_rs::{other, unstable};
+
+#[allow(unused_imports)]
+use sort_test_tools::ffi_types::{Column, FFIOneKibiByte, FFIString, SortColumn};
+use sort_test_tools::patterns;
+
+#[allow(unused_imports)]
+use sort_test_tools::Sort;
+
+#[allow(unused_imports)]
+use crate::modules::util::{pin_thread_to_core, should_run_benchmark};
+
+struct Table {
+    col_u32: Vec<u32>,
+    col_u64: Vec<u64>,
+    col_str: Vec<FFIString>,
+}
+
+impl Table {
+    fn new(len: usize, pattern_provider: &fn(usize) -> Vec<i32>) -> Self {
+        Self {
+            col_u32: patterns::random_uniform(len, 0..=15)
+                .into_iter()
+                .map(|val| val as u32)
+                .collect(),
+            col_u64: pattern_provider(len)
+                .into_iter()
+                .map(|val| val as u64)
+                .collect(),
+            col_str: patterns::random_uniform(len, 0..=999)
+                .into_iter()
+                .map(|val| FFIString::new(format!("customer-{val:04}")))
+                .collect(),
+        }
+    }
+
+    #[allow(unused)]
+    fn sort_columns(&self) -> [SortColumn<'_>; 3] {
+        [
+            SortColumn::new(Column::U32(&self.col_u32), false),
+            SortColumn::new(Column::U64(&self.col_u64), false),
+            SortColumn::new(Column::String(&self.col_str), false),
+        ]
+    }
+
+    // The order of sort_columns, ties broken by row index.
+    #[allow(unused)]
+    fn compare_rows(&self, a: usize, b: usize) -> Ordering {
+        self.col_u32[a]
+            .cmp(&self.col_u32[b])
+            .then(self.col_u64[a].cmp(&self.col_u64[b]))
+            .then_with(|| self.col_str[a].cmp(&self.col_str[b]))
+            .then(a.cmp(&b))
+    }
+}
+
+#[allow(unused)]
+pub fn bench<T: Ord + std::fmt::Debug>(
+    c: &mut Criterion,
+    test_len: usize,
+    transform_name: &str,
+    transform: &fn(Vec<i32>) -> Vec<T>,
+    pattern_name: &str,
+    pattern_provider: &fn(usize) -> Vec<i32>,
+) {
+    // The table doesn't depend on the type, run once per length and pattern.
+    if transform_name != "u64" || test_len < 2 {
+        return;
+    }
+
+    // Pin the benchmark to the same core to improve repeatability.
+    pin_thread_to_core();
+
+    let table = Table::new(test_len, pattern_provider);
+
+    let mut bench_perm = |sort_name: &str, sort_fn: &dyn Fn(&Table) -> Vec<usize>| {
+        let bench_name = format!("{sort_name}-hot-u32_u64_str-{pattern_name}-{test_len}");
+        if should_run_benchmark(&bench_name) {
+            c.bench_function(&bench_name, |b| {
+                b.iter(|| black_box(sort_fn(black_box(&table))))
+            });
+        }
+    };
+
+    #[cfg(feature = "cpp_radix")]
+    bench_perm("cpp_radix_columnar", &|table| {
+        other::cpp_radix::sort_columns(&table.sort_columns())
+    });
+
+    #[cfg(feature = "cpp_vqsort")]
+    bench_perm("cpp_vqsort_columnar", &|table| {
+        other::cpp_vqsort::sort_columns(&table.sort_columns())
+    });
+
+    #[cfg(feature = "cpp_pdqsort")]
+    {
+        use unstable::cpp_pdqsort::SortImpl as CppPdqsort;
+
+        bench_perm("cpp_pdqsort_indices_by", &|table| {
+            let mut indices = (0..table.col_u64.len() as u64).collect::<Vec<_>>();
+            CppPdqsort::sort_by(&mut indices, |a, b| {
+                table.compare_rows(*a as usize, *b as usize)
+            });
+            indices.into_iter().map(|index| index as usize).collect()
+        });
+
+        bench_perm("cpp_pdqsort_rows_1k_by", &|table| {
+            let mut rows = (0..table.col_u64.len())
+                .map(|index| {
+                    FFIOneKibiByte::from_prefix(&[
+                        table.col_u32[index] as i64,
+                        table.col_u64[index] as i64,
+                        index as i64,
+                    ])
+                })
+                .collect::<Vec<_>>();
+
+            // Only the string column is not part of the row.
+            CppPdqsort::sort_by(&mut rows, |a, b| {
+                let (a, b) = (a.values(), b.values());
+                a[0].cmp(&b[0])
+                    .then((a[1] as u64).cmp(&(b[1] as u64)))
+                    .then_with(|| table.col_str[a[2] as usize].cmp(&table.col_str[b[2] as usize]))
+                    .then(a[2].cmp(&b[2]))
+            });
+            rows.iter().map(|row| row.values()[2] as usize).collect()
+        });
+    }
+}
@@ -0,0 +1,163 @@
+//! External merge sort of files larger than the memory budget, see other::external_sort. Reports
+//! throughput in bytes of the input file, so criterion prints GB/s.
+//!
+//! The files live in BENCH_EXTERNAL_DIR, which should be on the device under test, e.g. an NVMe
+//! drive. The runs go to the same directory. The page cache is not dropped between iterations,
+//! for a device bound measurement BENCH_EXTERNAL_BYTES has to be well above the free memory.
+
+use std::env;
+use std::fs::{self, File};
+use std::io::{self, BufWriter, Write};
+use std::path::{Path, PathBuf};
+
+use criterion::{Criterion, SamplingMode, Throughput};
+
+use sort_research_rs::other::external_sort::{self, Config, Record};
+#[allow(unused_imports)]
+use sort_research_rs::{other, unstable};
+
+use sort_test_tools::ffi_types::FFIString;
+use sort_test_tools::patterns;
+use sort_test_tools::Sort;
+
+use crate::modules::util::should_run_benchmark;
+
+const DEFAULT_EXTERNAL_BYTES: u64 = 16 << 30;
+
+type SortFileFn = fn(&Path, &Path, &Config) -> io::Result<external_sort::Stats>;
+
+fn env_bytes(name: &str) -> Option<u64> {
+    env::var(name).ok().map(|val| {
+        val.parse()
+            .unwrap_or_else(|_| panic!("{name} must be a number"))
+    })
+}
+
+fn external_dir() -> PathBuf {
+    env::var("BENCH_EXTERNAL_DIR")
+        .map(PathBuf::from)
+        .unwrap_or_else(|_| env::temp_dir())
+}
+
+fn config() -> Config {
+    let mut config = Config {
+        temp_dir: external_dir(),
+        ..Default::default()
+    };
+
+    if let Some(chunk_bytes) = env_bytes("BENCH_EXTERNAL_CHUNK_BYTES") {
+        config.chunk_bytes = chunk_bytes as usize;
+    }
+
+    config
+}
+
+// Same splitmix64 keys as the huge benchmarks.
+struct SplitMix64(u64);
+
+impl SplitMix64 {
+    fn next(&mut self) -> u64 {
+        self.0 = self.0.wrapping_add(0x9e3779b97f4a7c15);
+        let mut z = self.0;
+        z = (z ^ (z >> 30)).wrapping_mul(0xbf58476d1ce4e5b9);
+        z = (z ^ (z >> 27)).wrapping_mul(0x94d049bb133111eb);
+        z ^ (z >> 31)
+    }
+}
+
+// Writes `len` random records to `path`, u64 as 8 bytes, strings as 16 hex digits and a newline.
+fn write_input<T: Record>(path: &Path, len: u64, make_record: fn(u64) -> T) -> io::Result<()> {
+    let mut rng = SplitMix64(patterns::random(1)[0] as u64);
+    let mut writer = BufWriter::with_capacity(4 << 20, File::create(path)?);
+
+    for _ in 0..len {
+        make_record(rng.next()).write_to(&mut writer)?;
+    }
+
+    writer.flush()
+}
+
+#[allow(unused)]
+fn bench_external<T: Record>(
+    c: &mut Criterion,
+    transform_name: &str,
+    record_bytes: u64,
+    make_record: fn(u64) -> T,
+) {
+    let file_bytes = env_bytes("BENCH_EXTERNAL_BYTES").unwrap_or(DEFAULT_EXTERNAL_BYTES);
+    let len = file_bytes / record_bytes;
+    let group_name = format!("external-hot-{transform_name}-random-{len}");
+
+    let mut sorts: Vec<(String, SortFileFn)> = Vec::new();
+
+    macro_rules! add_sort {
+        ($sort_impl_path:path) => {{
+            use $sort_impl_path::*;
+
+            sorts.push((
+                <SortImpl as Sort>::name(),
+                external_sort::sort_file::<SortImpl, T>,
+            ));
+        }};
+    }
+
+    add_sort!(unstable::rust_ipnsort);
+
+    #[cfg(feature = "cpp_ips4o_parallel")]
+    add_sort!(unstable::cpp_ips4o_parallel);
+
+    // vqsort has no string support.
+    #[cfg(feature = "cpp_vqsort")]
+    if transform_name == "u64" {
+        add_sort!(other::cpp_vqsort);
+    }
+
+    sorts.retain(|(sort_name, _)| should_run_benchmark(&format!("{group_name}/{sort_name}")));
+    if sorts.is_empty() {
+        return;
+    }
+
+    let dir = external_dir();
+    let input = dir.join(format!("external_bench_{transform_name}.in"));
+    let output = dir.join(format!("external_bench_{transform_name}.out"));
+    write_input(&input, len, make_record).unwrap();
+
+    let config = config();
+
+    let mut group = c.benchmark_group(&group_name);
+    group.sample_size(10);
+    group.sampling_mode(SamplingMode::Flat);
+    group.throughput(Throughput::Bytes(fs::metadata(&input).unwrap().len()));
+
+    for (sort_name, sort_file) in sorts {
+        group.bench_function(&sort_name, |b| {
+            b.iter(|| sort_file(&input, &output, &config).unwrap())
+        });
+    }
+
+    group.finish();
+
+    let _ = fs::remove_file(&input);
+    let _ = fs::remove_file(&output);
+}
+
+#[allow(unused)]
+pub fn bench<T: Ord + std::fmt::Debug>(
+    c: &mut Criterion,
+    test_len: usize,
+    transform_name: &str,
+    transform: &fn(Vec<i32>) -> Vec<T>,
+    pattern_name: &str,
+    pattern_provider: &fn(usize) -> Vec<i32>,
+) {
+    // The sizes are fixed, run once instead of once per size and pattern.
+    if test_len != 0 || pattern_name != "random" {
+        return;
+    }
+
+    match transform_name {
+        "u64" => bench_external(c, "u64", 8, |val| val),
+        "string" => bench_external(c, "string", 17, |val| FFIString::new(format!("{val:016x}"))),
+        _ => {}
+    }
+}
@@ -0,0 +1,266 @@
+//! Inputs of 1e8 elements and more, where page faults and allocation would otherwise dominate.
+//! The input lives in a single pre-faulted buffer, backed by transparent huge pages where the
+//! kernel allows it, that is refilled before every sort. Only the sort itself is timed.
+
+use std::env;
+use std::time::{Duration, Instant};
+
+use criterion::{black_box, Criterion, SamplingMode, Throughput};
+
+#[allow(unused_imports)]
+use sort_research_rs::{other, stable, unstable};
+
+use sort_test_tools::patterns;
+use sort_test_tools::Sort;
+
+use crate::modules::util::should_run_benchmark;
+
+const DEFAULT_HUGE_LENS: [usize; 1] = [100_000_000];
+
+#[allow(unused)]
+fn huge_lens() -> Vec<usize> {
+    env::var("BENCH_HUGE_LENS")
+        .map(|val| {
+            val.split(',')
+                .map(|len| len.trim().parse().expect("BENCH_HUGE_LENS must be numbers"))
+                .collect()
+        })
+        .unwrap_or_else(|_| DEFAULT_HUGE_LENS.to_vec())
+}
+
+#[cfg(target_os = "linux")]
+mod sys {
+    use std::os::raw::{c_int, c_long, c_void};
+
+    extern "C" {
+        fn mmap(
+            addr: *mut c_void,
+            len: usize,
+            prot: c_int,
+            flags: c_int,
+            fd: c_int,
+            offset: c_long,
+        ) -> *mut c_void;
+        fn munmap(addr: *mut c_void, len: usize) -> c_int;
+        fn madvise(addr: *mut c_void, len: usize, advice: c_int) -> c_int;
+    }
+
+    const PROT_READ: c_int = 1;
+    const PROT_WRITE: c_int = 2;
+    const MAP_PRIVATE: c_int = 2;
+    const MAP_ANONYMOUS: c_int = 0x20;
+    const MADV_HUGEPAGE: c_int = 14;
+    const MAP_FAILED: *mut c_void = !0 as *mut c_void;
+
+    /// Anonymous mapping of `len` u64, zero initialized.
+    pub fn map_u64(len: usize) -> *mut u64 {
+        let size = len * std::mem::size_of::<u64>();
+
+        // SAFETY: Fresh anonymous mapping, not aliased by anything.
+        unsafe {
+            let ptr = mmap(
+                std::ptr::null_mut(),
+                size,
+                PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS,
+                -1,
+                0,
+            );
+            assert!(ptr != MAP_FAILED, "mmap of {size} bytes failed");
+
+            // Only a hint, without THP support in the kernel the mapping stays on 4k pages.
+            madvise(ptr, size, MADV_HUGEPAGE);
+
+            ptr as *mut u64
+        }
+    }
+
+    pub unsafe fn unmap_u64(ptr: *mut u64, len: usize) {
+        munmap(ptr as *mut c_void, len * std::mem::size_of::<u64>());
+    }
+}
+
+#[cfg(not(target_os = "linux"))]
+mod sys {
+    pub fn map_u64(len: usize) -> *mut u64 {
+        Vec::leak(vec![0u64; len]).as_mut_ptr()
+    }
+
+    pub unsafe fn unmap_u64(ptr: *mut u64, len: usize) {
+        drop(Vec::from_raw_parts(ptr, len, len));
+    }
+}
+
+struct HugeBuffer {
+    ptr: *mut u64,
+    len: usize,
+}
+
+impl HugeBuffer {
+    fn new(len: usize) -> Self {
+        let mut buffer = Self {
+            ptr: sys::map_u64(len),
+            len,
+        };
+
+        // Touch every page up-front, the mapping is lazy.
+        const PAGE_ELEMS: usize = 4096 / std::mem::size_of::<u64>();
+        for elem in buffer.as_mut_slice().iter_mut().step_by(PAGE_ELEMS) {
+            // SAFETY: elem is a valid reference, the volatile write can't be elided.
+            unsafe { std::ptr::write_volatile(elem, 0) };
+        }
+
+        buffer
+    }
+
+    fn as_mut_slice(&mut self) -> &mut [u64] {
+        // SAFETY: ptr points to len initialized u64, owned by self.
+        unsafe { std::slice::from_raw_parts_mut(self.ptr, self.len) }
+    }
+}
+
+impl Drop for HugeBuffer {
+    fn drop(&mut self) {
+        // SAFETY: ptr and len are the ones returned by map_u64.
+        unsafe { sys::unmap_u64(self.ptr, self.len) };
+    }
+}
+
+// Same splitmix64 keys as the numa benchmarks, generated in place. At 1e10 elements a Vec<i32>
+// detour through the regular patterns would need another 40GB.
+#[allow(unused)]
+fn fill_random_u64(seed: u64, data: &mut [u64]) {
+    let mut state = seed;
+
+    for elem in data.iter_mut() {
+        state = state.wrapping_add(0x9e3779b97f4a7c15);
+        let mut z = state;
+        z = (z ^ (z >> 30)).wrapping_mul(0xbf58476d1ce4e5b9);
+        z = (z ^ (z >> 27)).wrapping_mul(0x94d049bb133111eb);
+        *elem = z ^ (z >> 31);
+    }
+}
+
+#[cfg(feature = "parallel_cutover")]
+fn all_threads<S: Sort>(data: &mut [u64]) {
+    use sort_research_rs::{ffi_util, other::parallel_cutover};
+
+    parallel_cutover::with_threads(ffi_util::num_threads(), || S::sort(data));
+}
+
+#[allow(unused)]
+fn bench_huge(c: &mut Criterion, test_len: usize) {
+    let group_name = format!("huge-hot-u64-random-{test_len}");
+
+    let mut sorts: Vec<(String, fn(&mut [u64]))> = Vec::new();
+
+    macro_rules! add_sort {
+        ($sort_impl_path:path) => {{
+            use $sort_impl_path::*;
+
+            sorts.push((<SortImpl as Sort>::name(), <SortImpl as Sort>::sort::<u64>));
+        }};
+    }
+
+    add_sort!(unstable::rust_ipnsort);
+
+    #[cfg(feature = "cpp_ips4o")]
+    add_sort!(unstable::cpp_ips4o);
+
+    #[cfg(feature = "cpp_ips4o_parallel")]
+    add_sort!(unstable::cpp_ips4o_parallel);
+
+    #[cfg(feature = "rust_ipnsort_parallel")]
+    add_sort!(unstable::rust_ipnsort_parallel);
+
+    #[cfg(feature = "cpp_powersort_parallel")]
+    add_sort!(stable::cpp_powersort_parallel);
+
+    // The same sorts without the calibrated cutover, see the parallel_cutover benchmarks.
+    #[allow(unused_macros)]
+    macro_rules! add_all_threads {
+        ($sort_impl_path:path) => {{
+            use $sort_impl_path::*;
+
+            sorts.push((
+                format!("{}_all_threads", <SortImpl as Sort>::name()),
+                all_threads::<SortImpl>,
+            ));
+        }};
+    }
+
+    #[cfg(all(feature = "parallel_cutover", feature = "cpp_ips4o_parallel"))]
+    add_all_threads!(unstable::cpp_ips4o_parallel);
+
+    #[cfg(all(feature = "parallel_cutover", feature = "rust_ipnsort_parallel"))]
+    add_all_threads!(unstable::rust_ipnsort_parallel);
+
+    #[cfg(all(feature = "parallel_cutover", feature = "cpp_powersort_parallel"))]
+    add_all_threads!(stable::cpp_powersort_parallel);
+
+    #[cfg(feature = "cpp_vqsort")]
+    add_sort!(other::cpp_vqsort);
+
+    #[cfg(all(feature = "cpp_intel_avx512", target_arch = "x86_64"))]
+    add_sort!(other::cpp_intel_avx512);
+
+    #[cfg(feature = "cpp_gpu_sort")]
+    add_sort!(other::cpp_gpu_sort);
+
+    sorts.retain(|(sort_name, _)| should_run_benchmark(&format!("{group_name}/{sort_name}")));
+    if sorts.is_empty() {
+        return;
+    }
+
+    let mut group = c.benchmark_group(&group_name);
+    group.sample_size(10);
+    group.sampling_mode(SamplingMode::Flat);
+    group.throughput(Throughput::Elements(test_len as u64));
+
+    // One buffer shared by all sorts, only allocated if at least one of them runs.
+    let mut buffer = HugeBuffer::new(test_len);
+    let seed = patterns::random(1)[0] as u64;
+
+    for (sort_name, sort_fn) in sorts {
+        group.bench_function(&sort_name, |b| {
+            b.iter_custom(|iters| {
+                let mut elapsed = Duration::ZERO;
+
+                for _ in 0..iters {
+                    let test_data = buffer.as_mut_slice();
+                    fill_random_u64(seed, test_data);
+
+                    let start = Instant::now();
+                    sort_fn(black_box(test_data));
+                    elapsed += start.elapsed();
+
+                    black_box(test_data); // side-effect
+                }
+
+                elapsed
+            })
+        });
+    }
+
+    group.finish();
+}
+
+#[allow(unused)]
+pub fn bench<T: Ord + std::fmt::Debug>(
+    c: &mut Criterion,
+    test_len: usize,
+    transform_name: &str,
+    transform: &fn(Vec<i32>) -> Vec<T>,
+    pattern_name: &str,
+    pattern_provider: &fn(usize) -> Vec<i32>,
+) {
+    // The lengths are fixed, run once instead of once per size and pattern. Not pinned, so that
+    // the parallel implementations can use all cores.
+    if test_len != 0 || transform_name != "u64" || pattern_name != "random" {
+        return;
+    }
+
+    for huge_len in huge_lens() {
+        bench_huge(c, huge_len);
+    }
+}
@@ -0,0 +1,139 @@
+//! Inputs generated once per benchmark instead of once per criterion batch, enabled with
+//! `BENCH_INPUT_CACHE=<count>`. The patterns of `count` distinct inputs are generated in parallel,
+//! each with its own random seed, and transformed once. Every iteration then bitwise copies one of
+//! these pristine inputs into a buffer that is reused for the whole benchmark, round robin. For
+//! FFIString and 1k the generation otherwise costs far more than the sort, and allocating the
+//! input right before it also changes the state of the allocator the sort sees.
+//!
+//! Bitwise copies of non-Copy types are sound here because a sort only permutes the values and
+//! never drops or clones them. The copies in the buffers are never dropped, only the pristine
+//! inputs are.
+
+use std::env;
+use std::ptr;
+use std::time::{Duration, Instant};
+
+use criterion::black_box;
+
+use once_cell::sync::OnceCell;
+
+/// Number of distinct inputs per benchmark, `None` without `BENCH_INPUT_CACHE`.
+pub fn count() -> Option<usize> {
+    static COUNT: OnceCell<Option<usize>> = OnceCell::new();
+
+    *COUNT.get_or_init(|| {
+        env::var("BENCH_INPUT_CACHE").ok().map(|val| {
+            val.parse::<usize>()
+                .expect("BENCH_INPUT_CACHE must be a number of inputs")
+                .max(1)
+        })
+    })
+}
+
+pub struct InputCache<T> {
+    pristine: Vec<Vec<T>>,
+    next: usize,
+    // Bitwise copies of pristine inputs, see Drop.
+    buffers: Vec<Vec<T>>,
+}
+
+impl<T> InputCache<T> {
+    pub fn new(
+        count: usize,
+        test_len: usize,
+        transform: &fn(Vec<i32>) -> Vec<T>,
+        pattern_provider: &(impl Fn(usize) -> Vec<i32> + Sync),
+    ) -> Self {
+        // Only the patterns are generated in parallel, the FFI types are not Send.
+        let patterns = generate_patterns(count, test_len, pattern_provider);
+
+        Self {
+            pristine: patterns.into_iter().map(transform).collect(),
+            next: 0,
+            buffers: Vec::new(),
+        }
+    }
+
+    /// Times `test_fn` over `iters` inputs, like `iter_batched_ref` with `batch_size` inputs per
+    /// timed batch. Only the copies into the buffers happen outside of the measured region.
+    pub fn time(&mut self, iters: u64, batch_size: usize, test_fn: &impl Fn(&mut [T])) -> Duration {
+        let mut elapsed = Duration::ZERO;
+        let mut remaining = iters as usize;
+
+        while remaining > 0 {
+            let batch_len = remaining.min(batch_size);
+            self.fill(batch_len);
+
+            let start = Instant::now();
+            for buffer in &mut self.buffers[..batch_len] {
+                test_fn(black_box(buffer.as_mut_slice()));
+                black_box(buffer); // side-effect
+            }
+            elapsed += start.elapsed();
+
+            remaining -= batch_len;
+        }
+
+        elapsed
+    }
+
+    fn fill(&mut self, batch_len: usize) {
+        if self.buffers.len() < batch_len {
+            self.buffers.resize_with(batch_len, Vec::new);
+        }
+
+        for buffer in &mut self.buffers[..batch_len] {
+            let input = &self.pristine[self.next];
+            self.next = (self.next + 1) % self.pristine.len();
+
+            // SAFETY: The copies are forgotten before the buffer is refilled or dropped, so every
+            // value is only ever dropped through its pristine input.
+            unsafe {
+                buffer.set_len(0);
+                buffer.reserve(input.len());
+                ptr::copy_nonoverlapping(input.as_ptr(), buffer.as_mut_ptr(), input.len());
+                buffer.set_len(input.len());
+            }
+        }
+    }
+}
+
+impl<T> Drop for InputCache<T> {
+    fn drop(&mut self) {
+        for buffer in &mut self.buffers {
+            // SAFETY: See fill, also covers a panicking test_fn.
+            unsafe { buffer.set_len(0) };
+        }
+    }
+}
+
+fn generate_patterns(
+    count: usize,
+    test_len: usize,
+    pattern_provider: &(impl Fn(usize) -> Vec<i32> + Sync),
+) -> Vec<Vec<i32>> {
+    let core_ids = core_affinity::get_core_ids().unwrap_or_default();
+    let threads = count.min(core_ids.len()).max(1);
+
+    let mut patterns = vec![Vec::new(); count];
+    let chunk_len = count.div_ceil(threads);
+
+    std::thread::scope(|s| {
+        for (thread_idx, chunk) in patterns.chunks_mut(chunk_len).enumerate() {
+            let core_id = core_ids.get(thread_idx).copied();
+
+            s.spawn(move || {
+                // Spawned threads inherit the affinity of the pinned bench thread.
+                if let Some(core_id) = core_id {
+                    core_affinity::set_for_current(core_id);
+                }
+
+                for pattern in chunk {
+                    *pattern = pattern_provider(test_len);
+                }
+            });
+        }
+    });
+
+    patterns
+}
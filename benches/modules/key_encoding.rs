@@ -0,0 +1,98 @@
+//! Throughput of the normalized key encoder of the columnar sorts, encoding an (i32, f64, string)
+//! table into one order-preserving u64 or u128 key per row, or into memcmp-comparable byte
+//! strings. The i32 column follows the benchmarked pattern, the f64 column is descending with NaNs
+//! first, and the strings contribute their first bytes.
+
+#[allow(unused_imports)]
+use criterion::{black_box, Criterion, Throughput};
+
+#[allow(unused_imports)]
+use sort_research_rs::other;
+
+#[allow(unused_imports)]
+use sort_test_tools::ffi_types::{Column, FFIString, SortColumn};
+use sort_test_tools::patterns;
+
+#[allow(unused_imports)]
+use crate::modules::util::{pin_thread_to_core, should_run_benchmark};
+
+struct Table {
+    col_i32: Vec<i32>,
+    col_f64: Vec<f64>,
+    col_str: Vec<FFIString>,
+}
+
+impl Table {
+    fn new(len: usize, pattern_provider: &fn(usize) -> Vec<i32>) -> Self {
+        Self {
+            col_i32: pattern_provider(len),
+            col_f64: patterns::random_uniform(len, -1000..=1000)
+                .into_iter()
+                .map(|val| if val == 0 { f64::NAN } else { val as f64 / 7.0 })
+                .collect(),
+            col_str: patterns::random_uniform(len, 0..=999)
+                .into_iter()
+                .map(|val| FFIString::new(format!("{val:04}-customer")))
+                .collect(),
+        }
+    }
+
+    #[allow(unused)]
+    fn sort_columns(&self) -> [SortColumn<'_>; 3] {
+        [
+            SortColumn::new(Column::I32(&self.col_i32), false),
+            SortColumn::new(Column::F64(&self.col_f64), true).nans_first(),
+            SortColumn::new(Column::String(&self.col_str), false),
+        ]
+    }
+}
+
+#[allow(unused)]
+pub fn bench<T: Ord + std::fmt::Debug>(
+    c: &mut Criterion,
+    test_len: usize,
+    transform_name: &str,
+    transform: &fn(Vec<i32>) -> Vec<T>,
+    pattern_name: &str,
+    pattern_provider: &fn(usize) -> Vec<i32>,
+) {
+    // The table doesn't depend on the type, run once per length and pattern.
+    if transform_name != "u64" || test_len < 2 {
+        return;
+    }
+
+    // Pin the benchmark to the same core to improve repeatability.
+    pin_thread_to_core();
+
+    let table = Table::new(test_len, pattern_provider);
+
+    let group_name = format!("key_encoding-i32_f64_str-{pattern_name}-{test_len}");
+    let mut group = c.benchmark_group(&group_name);
+    group.throughput(Throughput::Elements(test_len as u64));
+
+    #[allow(unused_mut)]
+    let mut bench_encode = |encoder_name: &str, encode_fn: &dyn Fn(&[SortColumn])| {
+        if should_run_benchmark(&format!("{group_name}/{encoder_name}")) {
+            group.bench_function(encoder_name, |b| {
+                b.iter(|| encode_fn(black_box(&table.sort_columns())))
+            });
+        }
+    };
+
+    #[cfg(feature = "cpp_radix")]
+    {
+        use other::cpp_radix;
+
+        bench_encode("cpp_radix_encode_u64", &|columns| {
+            black_box(cpp_radix::encode_columns_u64(columns));
+        });
+        bench_encode("cpp_radix_encode_u128", &|columns| {
+            black_box(cpp_radix::encode_columns_u128(columns));
+        });
+        bench_encode("cpp_radix_encode_bytes", &|columns| {
+            black_box(cpp_radix::encode_columns_bytes(columns, 8));
+        });
+    }
+
+    group.finish();
+}
@@ -0,0 +1,109 @@
+//! Merging pre-sorted shards with `merge_sorted_runs`, against sorting the concatenated shards
+//! with the same implementation, which has to find the runs on its own. The input follows
+//! patterns::saw_ascending, with a varying number of runs.
+//!
+//! Not pinned, the merge splits its output across SORT_NUM_THREADS threads.
+
+#[allow(unused_imports)]
+use criterion::{black_box, BatchSize, Criterion, Throughput};
+
+#[allow(unused_imports)]
+use sort_test_tools::patterns;
+#[allow(unused_imports)]
+use sort_test_tools::Sort;
+
+#[allow(unused_imports)]
+use crate::modules::util::should_run_benchmark;
+
+// Typical shard counts, from a few files up to one shard per core on a large machine.
+const RUN_COUNTS: [usize; 4] = [8, 32, 64, 256];
+
+// Same bounds as the runs of patterns::saw_ascending.
+#[allow(unused)]
+fn saw_offsets(test_len: usize, run_count: usize) -> Vec<usize> {
+    let mut offsets = (0..test_len)
+        .step_by(test_len / run_count)
+        .collect::<Vec<_>>();
+    offsets.push(test_len);
+
+    offsets
+}
+
+#[cfg(feature = "cpp_powersort_parallel")]
+fn bench_merge_impl<T: Ord + std::fmt::Debug>(
+    c: &mut Criterion,
+    test_len: usize,
+    transform_name: &str,
+    transform: &fn(Vec<i32>) -> Vec<T>,
+) {
+    use sort_research_rs::stable::cpp_powersort_parallel;
+
+    let sort_name = <cpp_powersort_parallel::SortImpl as Sort>::name();
+    let group_name = format!("{sort_name}-hot-{transform_name}-saw_ascending-{test_len}");
+
+    let mut group = c.benchmark_group(&group_name);
+    group.throughput(Throughput::Elements(test_len as u64));
+
+    for run_count in RUN_COUNTS {
+        if run_count > test_len {
+            continue;
+        }
+
+        let offsets = saw_offsets(test_len, run_count);
+        let make_input = || transform(patterns::saw_ascending(test_len, run_count));
+
+        let merge_name = format!("merge_r{run_count}");
+        if should_run_benchmark(&format!("{group_name}/{merge_name}")) {
+            group.bench_function(&merge_name, |b| {
+                b.iter_batched_ref(
+                    make_input,
+                    |test_data| {
+                        cpp_powersort_parallel::merge_sorted_runs(
+                            black_box(test_data.as_mut_slice()),
+                            &offsets,
+                        );
+                        black_box(test_data); // side-effect
+                    },
+                    BatchSize::LargeInput,
+                )
+            });
+        }
+
+        let sort_name = format!("sort_r{run_count}");
+        if should_run_benchmark(&format!("{group_name}/{sort_name}")) {
+            group.bench_function(&sort_name, |b| {
+                b.iter_batched_ref(
+                    make_input,
+                    |test_data| {
+                        <cpp_powersort_parallel::SortImpl as Sort>::sort(black_box(
+                            test_data.as_mut_slice(),
+                        ));
+                        black_box(test_data); // side-effect
+                    },
+                    BatchSize::LargeInput,
+                )
+            });
+        }
+    }
+
+    group.finish();
+}
+
+#[allow(unused)]
+pub fn bench<T: Ord + std::fmt::Debug>(
+    c: &mut Criterion,
+    test_len: usize,
+    transform_name: &str,
+    transform: &fn(Vec<i32>) -> Vec<T>,
+    pattern_name: &str,
+    pattern_provider: &fn(usize) -> Vec<i32>,
+) {
+    // The runs are part of the input, run once per length instead of once per pattern. Only the
+    // u64, string and f128 merge entry points exist.
+    if pattern_name != "random" || !matches!(transform_name, "u64" | "string" | "f128") {
+        return;
+    }
+
+    #[cfg(feature = "cpp_powersort_parallel")]
+    bench_merge_impl(c, test_len, transform_name, transform);
+}
@@ -0,0 +1,157 @@
+//! In-place sort of a file of fixed-width records through a memory mapping, see
+//! other::mmap_sort, against reading the file into a Vec, sorting that and writing it back. Both
+//! are timed from the file on disk to the sorted file, the rewrite of the unsorted input before
+//! every iteration is not. Reports throughput in bytes of the file.
+//!
+//! The file lives in BENCH_MMAP_DIR, by default the temp dir, and holds test_len records of every
+//! size in BENCH_MMAP_RECORD_BYTES, by default 16,64,256. The key is a u64 at offset 8, following
+//! the benchmarked pattern. The page cache is not dropped, so this measures the copies and the
+//! sort, not the device.
+
+use std::env;
+#[allow(unused_imports)]
+use std::fs;
+#[allow(unused_imports)]
+use std::io;
+#[allow(unused_imports)]
+use std::path::{Path, PathBuf};
+#[allow(unused_imports)]
+use std::time::{Duration, Instant};
+
+#[allow(unused_imports)]
+use criterion::{measurement::WallTime, BenchmarkGroup, Criterion, Throughput};
+
+#[allow(unused_imports)]
+use sort_research_rs::{other, unstable};
+
+#[allow(unused_imports)]
+use sort_test_tools::ffi_types::KeyDescriptor;
+#[allow(unused_imports)]
+use sort_test_tools::Sort;
+
+#[allow(unused_imports)]
+use crate::modules::util::should_run_benchmark;
+
+const DEFAULT_RECORD_BYTES: [usize; 3] = [16, 64, 256];
+
+#[allow(unused)]
+fn record_sizes() -> Vec<usize> {
+    env::var("BENCH_MMAP_RECORD_BYTES")
+        .map(|val| {
+            val.split(',')
+                .map(|size| {
+                    size.trim()
+                        .parse()
+                        .expect("BENCH_MMAP_RECORD_BYTES must be numbers")
+                })
+                .collect()
+        })
+        .unwrap_or_else(|_| DEFAULT_RECORD_BYTES.to_vec())
+}
+
+#[allow(unused)]
+fn mmap_dir() -> PathBuf {
+    env::var("BENCH_MMAP_DIR")
+        .map(PathBuf::from)
+        .unwrap_or_else(|_| env::temp_dir())
+}
+
+#[cfg(all(feature = "mmap_sort", target_os = "linux"))]
+fn bench_record_file<S: Sort>(
+    group: &mut BenchmarkGroup<WallTime>,
+    group_name: &str,
+    path: &Path,
+    records: &[u8],
+    record_bytes: usize,
+) {
+    use other::mmap_sort::{self, Config};
+
+    let key = KeyDescriptor::new(8, 8, false, false);
+    let config = Config::default();
+
+    let variants: [(&str, fn(&Path, usize, KeyDescriptor, &Config) -> io::Result<mmap_sort::Stats>); 2] = [
+        ("mmap_in_place", mmap_sort::sort_file_in_place::<S>),
+        ("read_sort_write", mmap_sort::sort_file_buffered::<S>),
+    ];
+
+    for (variant_name, sort_file) in variants {
+        let bench_name = format!("{variant_name}-{}", S::name());
+        if !should_run_benchmark(&format!("{group_name}/{bench_name}")) {
+            continue;
+        }
+
+        group.bench_function(&bench_name, |b| {
+            b.iter_custom(|iters| {
+                let mut elapsed = Duration::ZERO;
+                for _ in 0..iters {
+                    fs::write(path, records).unwrap();
+
+                    let start = Instant::now();
+                    sort_file(path, record_bytes, key, &config).unwrap();
+                    elapsed += start.elapsed();
+                }
+                elapsed
+            })
+        });
+    }
+}
+
+#[allow(unused)]
+pub fn bench<T: Ord + std::fmt::Debug>(
+    c: &mut Criterion,
+    test_len: usize,
+    transform_name: &str,
+    transform: &fn(Vec<i32>) -> Vec<T>,
+    pattern_name: &str,
+    pattern_provider: &fn(usize) -> Vec<i32>,
+) {
+    // The records don't depend on the type, run once per length and pattern.
+    if transform_name != "u64" || test_len < 2 {
+        return;
+    }
+
+    #[cfg(all(feature = "mmap_sort", target_os = "linux"))]
+    {
+        let keys = pattern_provider(test_len);
+        let path = mmap_dir().join(format!("bench_mmap_{}.bin", std::process::id()));
+
+        for record_bytes in record_sizes() {
+            assert!(record_bytes >= 16, "Records need room for the key at offset 8");
+
+            let records = keys
+                .iter()
+                .flat_map(|val| {
+                    let mut record = vec![0xAB; record_bytes];
+                    record[8..16].copy_from_slice(&(*val as i64 as u64).to_le_bytes());
+                    record
+                })
+                .collect::<Vec<_>>();
+
+            let group_name = format!("mmap_sort-r{record_bytes}-{pattern_name}-{test_len}");
+            let mut group = c.benchmark_group(&group_name);
+            group.sample_size(10);
+            group.throughput(Throughput::Bytes(records.len() as u64));
+
+            bench_record_file::<unstable::rust_ipnsort::SortImpl>(
+                &mut group,
+                &group_name,
+                &path,
+                &records,
+                record_bytes,
+            );
+
+            #[cfg(feature = "cpp_vqsort")]
+            bench_record_file::<other::cpp_vqsort::SortImpl>(
+                &mut group,
+                &group_name,
+                &path,
+                &records,
+                record_bytes,
+            );
+
+            group.finish();
+        }
+
+        let _ = fs::remove_file(&path);
+    }
+}
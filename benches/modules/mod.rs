@@ -4,12 +4,75 @@ use criterion::Criterion;
 
 pub mod sort;
 
+pub mod batch;
+
+pub mod accumulate;
+
+pub mod merge;
+
+pub mod select;
+
+#[cfg(feature = "cpp_pdqsort")]
+pub mod unique;
+
+pub mod numa;
+
+pub mod placement;
+
+pub mod huge;
+
+pub mod thread_scaling;
+
+pub mod pipeline;
+
+pub mod columnar;
+
+pub mod key_encoding;
+
+pub mod perf_counters;
+
+pub mod rapl;
+
+pub mod roofline;
+
+pub mod input_cache;
+
+#[cfg(feature = "cold_benchmarks")]
+pub mod cache_evict;
+
+pub mod throughput;
+
+#[cfg(feature = "measure_alloc")]
+pub mod alloc_count;
+
 #[cfg(feature = "partition_point")]
 pub mod partition_point;
 
 #[cfg(feature = "partition")]
 pub mod partition;
 
+#[cfg(feature = "external_sort")]
+pub mod external;
+
+pub mod mmap;
+
+#[cfg(feature = "cpp_network_sort")]
+pub mod small_network;
+
+pub mod tiny;
+
+#[cfg(any(feature = "cpp_ips4o", feature = "cpp_ips4o_parallel"))]
+pub mod splitter_reuse;
+
+#[cfg(feature = "auto_tune")]
+pub mod auto_tune;
+
+#[cfg(feature = "parallel_cutover")]
+pub mod parallel_cutover;
+
+#[cfg(feature = "cpp_sort_telemetry")]
+pub mod telemetry;
+
 #[allow(unused)]
 pub fn bench_len_type_pattern_combo<T: Ord + std::fmt::Debug>(
     c: &mut Criterion,
@@ -43,6 +106,213 @@ pub fn bench_len_type_pattern_combo<T: Ord + std::fmt::Debug>(
                     pattern_provider,
                 );
             }
+            "batch" => {
+                batch::bench(
+                    c,
+                    test_len,
+                    transform_name,
+                    transform,
+                    pattern_name,
+                    pattern_provider,
+                );
+            }
+            "accumulate" => {
+                accumulate::bench(
+                    c,
+                    test_len,
+                    transform_name,
+                    transform,
+                    pattern_name,
+                    pattern_provider,
+                );
+            }
+            "merge" => {
+                merge::bench(
+                    c,
+                    test_len,
+                    transform_name,
+                    transform,
+                    pattern_name,
+                    pattern_provider,
+                );
+            }
+            "select" => {
+                select::bench(
+                    c,
+                    test_len,
+                    transform_name,
+                    transform,
+                    pattern_name,
+                    pattern_provider,
+                );
+            }
+            #[cfg(feature = "cpp_pdqsort")]
+            "unique" => {
+                unique::bench(
+                    c,
+                    test_len,
+                    transform_name,
+                    transform,
+                    pattern_name,
+                    pattern_provider,
+                );
+            }
+            "numa" => {
+                numa::bench(
+                    c,
+                    test_len,
+                    transform_name,
+                    transform,
+                    pattern_name,
+                    pattern_provider,
+                );
+            }
+            "placement" => {
+                placement::bench(
+                    c,
+                    test_len,
+                    transform_name,
+                    transform,
+                    pattern_name,
+                    pattern_provider,
+                );
+            }
+            "huge" => {
+                huge::bench(
+                    c,
+                    test_len,
+                    transform_name,
+                    transform,
+                    pattern_name,
+                    pattern_provider,
+                );
+            }
+            #[cfg(feature = "external_sort")]
+            "external" => {
+                external::bench(
+                    c,
+                    test_len,
+                    transform_name,
+                    transform,
+                    pattern_name,
+                    pattern_provider,
+                );
+            }
+            #[cfg(feature = "cpp_network_sort")]
+            "small_network" => {
+                small_network::bench(
+                    c,
+                    test_len,
+                    transform_name,
+                    transform,
+                    pattern_name,
+                    pattern_provider,
+                );
+            }
+            "tiny" => {
+                tiny::bench(
+                    c,
+                    test_len,
+                    transform_name,
+                    transform,
+                    pattern_name,
+                    pattern_provider,
+                );
+            }
+            #[cfg(any(feature = "cpp_ips4o", feature = "cpp_ips4o_parallel"))]
+            "splitter_reuse" => {
+                splitter_reuse::bench(
+                    c,
+                    test_len,
+                    transform_name,
+                    transform,
+                    pattern_name,
+                    pattern_provider,
+                );
+            }
+            "thread_scaling" => {
+                thread_scaling::bench(
+                    c,
+                    test_len,
+                    transform_name,
+                    transform,
+                    pattern_name,
+                    pattern_provider,
+                );
+            }
+            "pipeline" => {
+                pipeline::bench(
+                    c,
+                    test_len,
+                    transform_name,
+                    transform,
+                    pattern_name,
+                    pattern_provider,
+                );
+            }
+            "columnar" => {
+                columnar::bench(
+                    c,
+                    test_len,
+                    transform_name,
+                    transform,
+                    pattern_name,
+                    pattern_provider,
+                );
+            }
+            "key_encoding" => {
+                key_encoding::bench(
+                    c,
+                    test_len,
+                    transform_name,
+                    transform,
+                    pattern_name,
+                    pattern_provider,
+                );
+            }
+            "mmap" => {
+                mmap::bench(
+                    c,
+                    test_len,
+                    transform_name,
+                    transform,
+                    pattern_name,
+                    pattern_provider,
+                );
+            }
+            #[cfg(feature = "auto_tune")]
+            "auto_tune" => {
+                auto_tune::bench(
+                    c,
+                    test_len,
+                    transform_name,
+                    transform,
+                    pattern_name,
+                    pattern_provider,
+                );
+            }
+            #[cfg(feature = "parallel_cutover")]
+            "parallel_cutover" => {
+                parallel_cutover::bench(
+                    c,
+                    test_len,
+                    transform_name,
+                    transform,
+                    pattern_name,
+                    pattern_provider,
+                );
+            }
+            #[cfg(feature = "cpp_sort_telemetry")]
+            "telemetry" => {
+                telemetry::bench(
+                    c,
+                    test_len,
+                    transform_name,
+                    transform,
+                    pattern_name,
+                    pattern_provider,
+                );
+            }
             _ => panic!(
                 "Unknown BENCH_OTHER value: '{}'. Make sure the feature is enabled.",
                 env_val
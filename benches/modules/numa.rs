@@ -0,0 +1,111 @@
+use std::env;
+
+use criterion::{black_box, BatchSize, Criterion, Throughput};
+
+#[allow(unused_imports)]
+use sort_research_rs::unstable;
+
+use sort_test_tools::patterns;
+
+use crate::modules::util::should_run_benchmark;
+
+// Large enough that the input and the bucket buffers are far beyond the last level cache of any
+// multi socket machine.
+const DEFAULT_NUMA_LEN: usize = 1_000_000_000;
+
+#[allow(unused)]
+fn numa_len() -> usize {
+    env::var("BENCH_NUMA_LEN")
+        .map(|val| val.parse().expect("BENCH_NUMA_LEN must be a number"))
+        .unwrap_or(DEFAULT_NUMA_LEN)
+}
+
+// The regular patterns go through a Vec<i32>, which at this size is a 4GB detour. splitmix64 is
+// good enough for uniformly random keys.
+#[allow(unused)]
+pub fn random_u64(len: usize) -> Vec<u64> {
+    let mut state = patterns::random(1)[0] as u64;
+
+    (0..len)
+        .map(|_| {
+            state = state.wrapping_add(0x9e3779b97f4a7c15);
+            let mut z = state;
+            z = (z ^ (z >> 30)).wrapping_mul(0xbf58476d1ce4e5b9);
+            z = (z ^ (z >> 27)).wrapping_mul(0x94d049bb133111eb);
+            z ^ (z >> 31)
+        })
+        .collect()
+}
+
+// Compares the default ips4o pool against NUMA pinned pools, that keep each thread's buffers on
+// its own node or deliberately on the next one. The input is shared by all threads, as it would
+// be in a real application, only the sort internal memory moves.
+#[cfg(feature = "cpp_ips4o_parallel")]
+fn bench_numa_placement(c: &mut Criterion) {
+    use sort_research_rs::ffi_util;
+    use unstable::cpp_ips4o_pool::{Ips4oPool, NumaPlacement};
+
+    let test_len = numa_len();
+    let num_threads = ffi_util::num_threads();
+
+    let group_name = format!("numa_t{num_threads}-hot-u64-random-{test_len}");
+    let mut group = c.benchmark_group(&group_name);
+    group.sample_size(10);
+    group.throughput(Throughput::Elements(test_len as u64));
+
+    let pools: [(&str, fn() -> Ips4oPool); 3] = [
+        ("cpp_ips4o_pool_unstable", || {
+            Ips4oPool::new(ffi_util::num_threads())
+        }),
+        ("cpp_ips4o_pool_numa_local", || {
+            Ips4oPool::new_numa(ffi_util::num_threads(), NumaPlacement::Local)
+        }),
+        ("cpp_ips4o_pool_numa_remote", || {
+            Ips4oPool::new_numa(ffi_util::num_threads(), NumaPlacement::Remote)
+        }),
+    ];
+
+    let mut input = None;
+
+    for (pool_name, make_pool) in pools {
+        if !should_run_benchmark(&format!("{group_name}/{pool_name}")) {
+            continue;
+        }
+
+        // Only generated if at least one pool runs, it takes a while.
+        let input = input.get_or_insert_with(|| random_u64(test_len));
+        let mut pool = make_pool();
+
+        group.bench_function(pool_name, |b| {
+            b.iter_batched_ref(
+                || input.clone(),
+                |test_data| {
+                    pool.sort_u64(black_box(test_data.as_mut_slice()));
+                    black_box(test_data); // side-effect
+                },
+                BatchSize::LargeInput,
+            )
+        });
+    }
+
+    group.finish();
+}
+
+#[allow(unused)]
+pub fn bench<T: Ord + std::fmt::Debug>(
+    c: &mut Criterion,
+    test_len: usize,
+    transform_name: &str,
+    transform: &fn(Vec<i32>) -> Vec<T>,
+    pattern_name: &str,
+    pattern_provider: &fn(usize) -> Vec<i32>,
+) {
+    // The length is fixed, run once instead of once per size and pattern. The pools pin their own
+    // threads, pinning the bench thread would serialize them.
+    if test_len != 0 || transform_name != "u64" || pattern_name != "random" {
+        return;
+    }
+
+    #[cfg(feature = "cpp_ips4o_parallel")]
+    bench_numa_placement(c);
+}
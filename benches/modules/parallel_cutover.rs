@@ -0,0 +1,67 @@
+//! The calibrated thread counts of other::parallel_cutover against the same sorts with all
+//! `ffi_util::num_threads()` threads and their built-in cutover, named `<sort>_all_threads`. The
+//! first call loads the table of this CPU model, or calibrates and stores it if there is none.
+//! Inputs of 1e8 elements are covered by `BENCH_OTHER=huge`.
+
+#[allow(unused_imports)]
+use sort_research_rs::ffi_util;
+use sort_research_rs::other::parallel_cutover;
+#[allow(unused_imports)]
+use sort_research_rs::{stable, unstable};
+
+#[allow(unused_imports)]
+use sort_test_tools::Sort;
+
+use criterion::Criterion;
+
+#[allow(unused_imports)]
+use crate::modules::util::bench_fn;
+
+#[allow(unused)]
+pub fn bench<T: Ord + std::fmt::Debug>(
+    c: &mut Criterion,
+    test_len: usize,
+    transform_name: &str,
+    transform: &fn(Vec<i32>) -> Vec<T>,
+    pattern_name: &str,
+    pattern_provider: &fn(usize) -> Vec<i32>,
+) {
+    // Calibrate outside of the measurement.
+    parallel_cutover::table();
+
+    macro_rules! bench_inst {
+        ($sort_impl_path:path) => {{
+            use $sort_impl_path::*;
+
+            let sort_name = <SortImpl as Sort>::name();
+            let mut bench_sort = |bench_name: &str, test_fn: &dyn Fn(&mut [T])| {
+                bench_fn(
+                    c,
+                    test_len,
+                    transform_name,
+                    transform,
+                    pattern_name,
+                    pattern_provider,
+                    bench_name,
+                    test_fn,
+                );
+            };
+
+            bench_sort(&sort_name, &|data| <SortImpl as Sort>::sort(data));
+            bench_sort(&format!("{sort_name}_all_threads"), &|data| {
+                parallel_cutover::with_threads(ffi_util::num_threads(), || {
+                    <SortImpl as Sort>::sort(data)
+                })
+            });
+        }};
+    }
+
+    #[cfg(feature = "cpp_ips4o_parallel")]
+    bench_inst!(unstable::cpp_ips4o_parallel);
+
+    #[cfg(feature = "cpp_powersort_parallel")]
+    bench_inst!(stable::cpp_powersort_parallel);
+
+    #[cfg(feature = "rust_ipnsort_parallel")]
+    bench_inst!(unstable::rust_ipnsort_parallel);
+}
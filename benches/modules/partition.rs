@@ -25,6 +25,10 @@ fn bench_partition_impl<T: Ord + std::fmt::Debug, P: Partition>(
     pattern_provider: &fn(usize) -> Vec<i32>,
     _partition_impl: P,
 ) {
+    if !P::is_supported::<T>() {
+        return;
+    }
+
     // Pin the benchmark to the same core to improve repeatability. Doing it this way allows
     // criterion to do other stuff with other threads, which greatly impacts overall benchmark
     // throughput.
@@ -298,6 +302,18 @@ pub fn bench<T: Ord + std::fmt::Debug>(
         };
     }
 
+    #[cfg(feature = "c_crumsort")]
+    bench_inst!(c_crumsort);
+    #[cfg(feature = "cpp_blockquicksort")]
+    bench_inst!(cpp_blockquicksort);
+    #[cfg(feature = "cpp_intel_avx512")]
+    bench_inst!(cpp_intel_avx512);
+    #[cfg(feature = "cpp_pdqsort")]
+    bench_inst!(cpp_lomcyc);
+    #[cfg(feature = "cpp_pdqsort")]
+    bench_inst!(cpp_pdqsort);
+    #[cfg(feature = "cpp_vqsort")]
+    bench_inst!(cpp_vqsort);
     bench_inst!(hoare_block_butterfly);
     bench_inst!(hoare_block);
     bench_inst!(hoare_branchy_cyclic);
@@ -1,10 +1,13 @@
+use std::cell::RefCell;
 use std::hint::black_box;
 
 use criterion::Criterion;
 
 use rand::prelude::*;
 
-use sort_research_rs::other::partition_point::{self, PartitionPoint};
+use sort_research_rs::other::partition_point::{
+    self, BatchPartitionPoint, PartitionPoint, Sequential,
+};
 
 use crate::modules::util::bench_fn;
 
@@ -51,6 +54,54 @@ fn bench_impl<T: Ord + std::fmt::Debug, P: PartitionPoint>(
     )
 }
 
+/// Number of values looked up per batch.
+const BATCH_LEN: usize = 4096;
+
+#[inline(never)]
+fn bench_batch_impl<T: Ord + std::fmt::Debug, B: BatchPartitionPoint>(
+    c: &mut Criterion,
+    test_len: usize,
+    transform_name: &str,
+    transform: &fn(Vec<i32>) -> Vec<T>,
+    pattern_name: &str,
+    pattern_provider: &fn(usize) -> Vec<i32>,
+    _batch_partition_point_impl: B,
+) {
+    let bench_name = format!("batch_{}", B::name());
+
+    let p_pattern_provider = |len: usize| -> Vec<i32> {
+        // The transforms preserve the order of the values, so the index can be built before them.
+        let mut v = B::build_index(&pattern_provider(len));
+
+        // Append the values we will look for.
+        let mut rng = rand::thread_rng();
+        v.extend((0..BATCH_LEN).map(|_| (rng.gen::<u32>() % (len as u32).max(1)) as i32));
+
+        v
+    };
+
+    let out = RefCell::new(vec![0; BATCH_LEN]);
+
+    let p_test_fn = |v: &mut [T]| {
+        let (index, vals) = v.split_at(v.len() - BATCH_LEN);
+        let mut out = out.borrow_mut();
+
+        B::partition_point_batch(index, vals, &mut out);
+        black_box(out.as_slice());
+    };
+
+    bench_fn(
+        c,
+        test_len,
+        transform_name,
+        transform,
+        pattern_name,
+        p_pattern_provider,
+        &bench_name,
+        p_test_fn,
+    )
+}
+
 pub fn bench<T: Ord + std::fmt::Debug>(
     c: &mut Criterion,
     test_len: usize,
@@ -93,4 +144,64 @@ pub fn bench<T: Ord + std::fmt::Debug>(
         pattern_provider,
         partition_point::branchless_bitwise::PartitionPointImpl,
     );
+
+    bench_batch_impl(
+        c,
+        test_len,
+        transform_name,
+        &transform,
+        pattern_name,
+        pattern_provider,
+        Sequential::<partition_point::branchless_clean::PartitionPointImpl>(Default::default()),
+    );
+
+    bench_batch_impl(
+        c,
+        test_len,
+        transform_name,
+        &transform,
+        pattern_name,
+        pattern_provider,
+        Sequential::<partition_point::std::PartitionPointImpl>(Default::default()),
+    );
+
+    bench_batch_impl(
+        c,
+        test_len,
+        transform_name,
+        &transform,
+        pattern_name,
+        pattern_provider,
+        Sequential::<partition_point::branchless_bitwise::PartitionPointImpl>(Default::default()),
+    );
+
+    bench_batch_impl(
+        c,
+        test_len,
+        transform_name,
+        &transform,
+        pattern_name,
+        pattern_provider,
+        partition_point::interleaved::PartitionPointImpl,
+    );
+
+    bench_batch_impl(
+        c,
+        test_len,
+        transform_name,
+        &transform,
+        pattern_name,
+        pattern_provider,
+        partition_point::gather::PartitionPointImpl,
+    );
+
+    bench_batch_impl(
+        c,
+        test_len,
+        transform_name,
+        &transform,
+        pattern_name,
+        pattern_provider,
+        partition_point::eytzinger::PartitionPointImpl,
+    );
 }
@@ -0,0 +1,283 @@
+//! Hardware performance counters around single sort calls, via perf_event_open. Only the calling
+//! thread is counted, threads spawned by parallel implementations are not.
+//!
+//! Events the kernel refuses, e.g. because of perf_event_paranoid or a VM without PMU access, are
+//! left out. Without any usable event `Counters::new` returns `None`.
+
+pub struct Event {
+    pub name: &'static str,
+    type_: u32,
+    config: u64,
+}
+
+const PERF_TYPE_HARDWARE: u32 = 0;
+const PERF_TYPE_HW_CACHE: u32 = 3;
+
+const fn cache_read_miss(cache_id: u64) -> u64 {
+    // cache id | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+    // with OP_READ being 0.
+    cache_id | (1 << 16)
+}
+
+// Most PMUs can't schedule all six events at the same time, each group gets its own time slice
+// and the counts are scaled to the full run time.
+pub const EVENT_GROUPS: [&[Event]; 2] = [
+    &[
+        Event {
+            name: "cycles",
+            type_: PERF_TYPE_HARDWARE,
+            config: 0,
+        },
+        Event {
+            name: "instructions",
+            type_: PERF_TYPE_HARDWARE,
+            config: 1,
+        },
+        Event {
+            name: "branch_misses",
+            type_: PERF_TYPE_HARDWARE,
+            config: 5,
+        },
+    ],
+    &[
+        Event {
+            name: "l1d_misses",
+            type_: PERF_TYPE_HW_CACHE,
+            config: cache_read_miss(0),
+        },
+        Event {
+            name: "llc_misses",
+            type_: PERF_TYPE_HW_CACHE,
+            config: cache_read_miss(2),
+        },
+        Event {
+            name: "dtlb_misses",
+            type_: PERF_TYPE_HW_CACHE,
+            config: cache_read_miss(3),
+        },
+    ],
+];
+
+#[cfg(all(
+    target_os = "linux",
+    any(target_arch = "x86_64", target_arch = "aarch64")
+))]
+mod sys {
+    use std::fs::File;
+    use std::io::Read;
+    use std::os::raw::{c_int, c_long, c_ulong};
+    use std::os::unix::io::{AsRawFd, FromRawFd};
+
+    use super::Event;
+
+    #[cfg(target_arch = "x86_64")]
+    const SYS_PERF_EVENT_OPEN: c_long = 298;
+    #[cfg(target_arch = "aarch64")]
+    const SYS_PERF_EVENT_OPEN: c_long = 241;
+
+    const PERF_EVENT_IOC_ENABLE: c_ulong = 0x2400;
+    const PERF_EVENT_IOC_DISABLE: c_ulong = 0x2401;
+    const PERF_EVENT_IOC_RESET: c_ulong = 0x2403;
+    const PERF_IOC_FLAG_GROUP: c_ulong = 1;
+
+    const PERF_FORMAT_TOTAL_TIME_ENABLED: u64 = 1 << 0;
+    const PERF_FORMAT_TOTAL_TIME_RUNNING: u64 = 1 << 1;
+    const PERF_FORMAT_GROUP: u64 = 1 << 3;
+
+    const FLAG_DISABLED: u64 = 1 << 0;
+    const FLAG_EXCLUDE_KERNEL: u64 = 1 << 5;
+    const FLAG_EXCLUDE_HV: u64 = 1 << 6;
+
+    extern "C" {
+        fn syscall(num: c_long, ...) -> c_long;
+        fn ioctl(fd: c_int, request: c_ulong, ...) -> c_int;
+    }
+
+    // PERF_ATTR_SIZE_VER5 layout of perf_event_attr, the kernel accepts older sizes.
+    #[repr(C)]
+    #[derive(Default)]
+    struct PerfEventAttr {
+        type_: u32,
+        size: u32,
+        config: u64,
+        sample_period: u64,
+        sample_type: u64,
+        read_format: u64,
+        flags: u64,
+        wakeup_events: u32,
+        bp_type: u32,
+        config1: u64,
+        config2: u64,
+        branch_sample_type: u64,
+        sample_regs_user: u64,
+        sample_stack_user: u32,
+        clockid: i32,
+        sample_regs_intr: u64,
+        aux_watermark: u32,
+        sample_max_stack: u16,
+        reserved: u16,
+    }
+
+    const _: () = assert!(std::mem::size_of::<PerfEventAttr>() == 112);
+
+    pub struct Group {
+        pub names: Vec<&'static str>,
+        files: Vec<File>,
+    }
+
+    fn open_event(event: &Event, group_fd: c_int) -> Option<File> {
+        let is_leader = group_fd == -1;
+        let attr = PerfEventAttr {
+            type_: event.type_,
+            size: std::mem::size_of::<PerfEventAttr>() as u32,
+            config: event.config,
+            read_format: PERF_FORMAT_GROUP
+                | PERF_FORMAT_TOTAL_TIME_ENABLED
+                | PERF_FORMAT_TOTAL_TIME_RUNNING,
+            flags: FLAG_EXCLUDE_KERNEL
+                | FLAG_EXCLUDE_HV
+                | if is_leader { FLAG_DISABLED } else { 0 },
+            ..Default::default()
+        };
+
+        // SAFETY: attr is a valid perf_event_attr of the given size. pid 0 and cpu -1 count the
+        // calling thread on any CPU.
+        let fd = unsafe {
+            syscall(
+                SYS_PERF_EVENT_OPEN,
+                &attr as *const PerfEventAttr,
+                0 as c_long,
+                -1 as c_long,
+                group_fd as c_long,
+                0 as c_ulong,
+            )
+        };
+
+        // SAFETY: A non-negative return value is a new fd owned by nobody else.
+        (fd >= 0).then(|| unsafe { File::from_raw_fd(fd as c_int) })
+    }
+
+    impl Group {
+        pub fn open(events: &[Event]) -> Option<Self> {
+            let mut names = Vec::new();
+            let mut files: Vec<File> = Vec::new();
+
+            for event in events {
+                let group_fd = files.first().map_or(-1, |leader| leader.as_raw_fd());
+                if let Some(file) = open_event(event, group_fd) {
+                    names.push(event.name);
+                    files.push(file);
+                }
+            }
+
+            (!files.is_empty()).then_some(Self { names, files })
+        }
+
+        fn leader_ioctl(&self, request: c_ulong) {
+            // SAFETY: The leader fd is open for the lifetime of self.
+            unsafe {
+                ioctl(self.files[0].as_raw_fd(), request, PERF_IOC_FLAG_GROUP);
+            }
+        }
+
+        pub fn enable(&self) {
+            self.leader_ioctl(PERF_EVENT_IOC_RESET);
+            self.leader_ioctl(PERF_EVENT_IOC_ENABLE);
+        }
+
+        pub fn disable(&self) {
+            self.leader_ioctl(PERF_EVENT_IOC_DISABLE);
+        }
+
+        /// Counts since the last `enable`, scaled by the share of time the group was scheduled.
+        /// `None` if the group never got onto the PMU.
+        pub fn read(&mut self) -> Option<Vec<f64>> {
+            // nr, time_enabled, time_running, values[nr]
+            let mut buf = vec![0u8; 8 * (3 + self.names.len())];
+            self.files[0].read_exact(&mut buf).ok()?;
+
+            let words = buf
+                .chunks_exact(8)
+                .map(|chunk| u64::from_ne_bytes(chunk.try_into().unwrap()))
+                .collect::<Vec<_>>();
+
+            let (time_enabled, time_running) = (words[1], words[2]);
+            if time_running == 0 {
+                return None;
+            }
+            let scale = time_enabled as f64 / time_running as f64;
+
+            Some(words[3..].iter().map(|&val| val as f64 * scale).collect())
+        }
+    }
+}
+
+#[cfg(not(all(
+    target_os = "linux",
+    any(target_arch = "x86_64", target_arch = "aarch64")
+)))]
+mod sys {
+    use super::Event;
+
+    pub struct Group {
+        pub names: Vec<&'static str>,
+    }
+
+    impl Group {
+        pub fn open(_events: &[Event]) -> Option<Self> {
+            None
+        }
+
+        pub fn enable(&self) {}
+
+        pub fn disable(&self) {}
+
+        pub fn read(&mut self) -> Option<Vec<f64>> {
+            None
+        }
+    }
+}
+
+pub struct Counters {
+    groups: Vec<sys::Group>,
+}
+
+impl Counters {
+    pub fn new() -> Option<Self> {
+        let groups = EVENT_GROUPS
+            .iter()
+            .filter_map(|events| sys::Group::open(events))
+            .collect::<Vec<_>>();
+
+        (!groups.is_empty()).then_some(Self { groups })
+    }
+
+    /// Names of the events that could be opened, in the order `measure` returns them.
+    pub fn names(&self) -> Vec<&'static str> {
+        self.groups
+            .iter()
+            .flat_map(|group| group.names.iter().copied())
+            .collect()
+    }
+
+    /// Runs `f` with all groups counting. Events whose group was never scheduled are NaN.
+    pub fn measure(&mut self, f: impl FnOnce()) -> Vec<f64> {
+        for group in &self.groups {
+            group.enable();
+        }
+
+        f();
+
+        for group in self.groups.iter().rev() {
+            group.disable();
+        }
+
+        self.groups
+            .iter_mut()
+            .flat_map(|group| {
+                let len = group.names.len();
+                group.read().unwrap_or_else(|| vec![f64::NAN; len])
+            })
+            .collect()
+    }
+}
@@ -0,0 +1,161 @@
+//! A receive -> sort -> write pipeline over batches of u64, once sorting each batch synchronously
+//! in between its I/O and once submitting it to the asynchronous ips4o, so that the sort of one
+//! batch overlaps with receiving the next one and writing the previous one.
+//!
+//! The I/O is simulated by sleeping for as long as transferring the batch would take at
+//! BENCH_PIPELINE_IO_MBPS, default 1000, MB/s. If sorting a batch takes as long as receiving and
+//! writing it, the async variant approaches half the time of the sync one.
+
+use std::env;
+use std::time::{Duration, Instant};
+
+use criterion::{black_box, Criterion, Throughput};
+
+#[allow(unused_imports)]
+use sort_research_rs::unstable;
+
+#[allow(unused_imports)]
+use crate::modules::util::should_run_benchmark;
+
+const BATCH_COUNT: usize = 16;
+
+#[allow(unused)]
+fn io_duration(len: usize) -> Duration {
+    let mbps: f64 = env::var("BENCH_PIPELINE_IO_MBPS")
+        .map(|val| {
+            val.parse()
+                .expect("BENCH_PIPELINE_IO_MBPS must be a number")
+        })
+        .unwrap_or(1000.0);
+
+    Duration::from_secs_f64((len * std::mem::size_of::<u64>()) as f64 / (mbps * 1e6))
+}
+
+// Stands in for a network or disk read, the data itself is prepared up front.
+#[allow(unused)]
+fn receive(batch: &[u64], io: Duration) -> Vec<u64> {
+    std::thread::sleep(io);
+    batch.to_vec()
+}
+
+#[allow(unused)]
+fn write(batch: Vec<u64>, io: Duration) {
+    std::thread::sleep(io);
+    black_box(batch);
+}
+
+#[cfg(feature = "cpp_ips4o_parallel")]
+fn bench_pipeline(c: &mut Criterion, batches: &[Vec<u64>]) {
+    use std::future::Future;
+    use std::pin::pin;
+    use std::sync::Arc;
+    use std::task::{Context, Poll, Wake};
+    use std::thread::Thread;
+
+    use sort_research_rs::ffi_util;
+    use unstable::cpp_ips4o_async::Ips4oAsync;
+    use unstable::cpp_ips4o_pool::Ips4oPool;
+
+    // Enough of an executor to await a single future, without pulling in an async runtime.
+    struct ThreadWaker(Thread);
+
+    impl Wake for ThreadWaker {
+        fn wake(self: Arc<Self>) {
+            self.0.unpark();
+        }
+    }
+
+    fn block_on<F: Future>(future: F) -> F::Output {
+        let mut future = pin!(future);
+        let waker = Arc::new(ThreadWaker(std::thread::current())).into();
+        let mut cx = Context::from_waker(&waker);
+
+        loop {
+            match future.as_mut().poll(&mut cx) {
+                Poll::Ready(output) => return output,
+                Poll::Pending => std::thread::park(),
+            }
+        }
+    }
+
+    let test_len = batches[0].len();
+    let num_threads = ffi_util::num_threads();
+    let io = io_duration(test_len);
+
+    let group_name = format!("pipeline_t{num_threads}-u64-random-{test_len}");
+    let mut group = c.benchmark_group(&group_name);
+    group.sample_size(10);
+    group.throughput(Throughput::Elements((batches.len() * test_len) as u64));
+
+    let sync_name = "cpp_ips4o_pool_unstable";
+    if should_run_benchmark(&format!("{group_name}/{sync_name}")) {
+        let mut pool = Ips4oPool::new(num_threads);
+
+        group.bench_function(sync_name, |b| {
+            b.iter_custom(|iters| {
+                let start = Instant::now();
+                for _ in 0..iters {
+                    for batch in batches {
+                        let mut data = receive(batch, io);
+                        pool.sort_u64(&mut data);
+                        write(data, io);
+                    }
+                }
+                start.elapsed()
+            })
+        });
+    }
+
+    let async_name = "cpp_ips4o_async_unstable";
+    if should_run_benchmark(&format!("{group_name}/{async_name}")) {
+        let async_pool = Ips4oAsync::new(num_threads);
+
+        group.bench_function(async_name, |b| {
+            b.iter_custom(|iters| {
+                let start = Instant::now();
+                for _ in 0..iters {
+                    let mut in_flight = async_pool.submit(receive(&batches[0], io));
+                    for batch in &batches[1..] {
+                        let next = receive(batch, io);
+                        let sorted = block_on(in_flight);
+                        in_flight = async_pool.submit(next);
+                        write(sorted, io);
+                    }
+                    write(block_on(in_flight), io);
+                }
+                start.elapsed()
+            })
+        });
+    }
+
+    group.finish();
+}
+
+#[allow(unused)]
+pub fn bench<T: Ord + std::fmt::Debug>(
+    c: &mut Criterion,
+    test_len: usize,
+    transform_name: &str,
+    transform: &fn(Vec<i32>) -> Vec<T>,
+    pattern_name: &str,
+    pattern_provider: &fn(usize) -> Vec<i32>,
+) {
+    // Below this the batches are sorted in microseconds and the sleep granularity dominates.
+    if test_len < 100_000 || transform_name != "u64" || pattern_name != "random" {
+        return;
+    }
+
+    #[cfg(feature = "cpp_ips4o_parallel")]
+    {
+        let batches: Vec<Vec<u64>> = (0..BATCH_COUNT)
+            .map(|_| {
+                pattern_provider(test_len)
+                    .into_iter()
+                    .map(|val| val as u64)
+                    .collect()
+            })
+            .collect();
+
+        bench_pipeline(c, &batches);
+    }
+}
@@ -0,0 +1,107 @@
+//! Sorts one large u64 input with ips4o pools that place their threads differently, see
+//! `ThreadPlacement`. Where the threads run decides which of them share a core, a last level cache
+//! or a memory controller, which matters most when the pool has fewer threads than the machine
+//! has CPUs, e.g. on multi-CCX Zen parts or two socket Xeons.
+//!
+//! `BENCH_PLACEMENT_THREADS` is a comma separated list of pool sizes, by default only
+//! `SORT_NUM_THREADS`. `BENCH_THREAD_PLACEMENT` restricts the placements, by name.
+
+use std::env;
+
+use criterion::{black_box, BatchSize, Criterion, Throughput};
+
+#[allow(unused_imports)]
+use sort_research_rs::unstable;
+
+#[allow(unused_imports)]
+use crate::modules::util::should_run_benchmark;
+
+// Well beyond the last level cache, but unlike the NUMA benchmark small enough to sweep many
+// configurations.
+const DEFAULT_PLACEMENT_LEN: usize = 100_000_000;
+
+#[allow(unused)]
+fn placement_len() -> usize {
+    env::var("BENCH_PLACEMENT_LEN")
+        .map(|val| val.parse().expect("BENCH_PLACEMENT_LEN must be a number"))
+        .unwrap_or(DEFAULT_PLACEMENT_LEN)
+}
+
+#[cfg(feature = "cpp_ips4o_parallel")]
+fn bench_thread_placement(c: &mut Criterion) {
+    use sort_research_rs::ffi_util;
+    use unstable::cpp_ips4o_pool::{Ips4oPool, ThreadPlacement};
+
+    let test_len = placement_len();
+
+    let thread_counts = env::var("BENCH_PLACEMENT_THREADS")
+        .map(|val| {
+            val.split(',')
+                .map(|count| count.parse().expect("BENCH_PLACEMENT_THREADS must be numbers"))
+                .collect::<Vec<usize>>()
+        })
+        .unwrap_or_else(|_| vec![ffi_util::num_threads()]);
+
+    let placements = env::var("BENCH_THREAD_PLACEMENT")
+        .map(|val| {
+            val.split(',')
+                .map(|name| {
+                    ThreadPlacement::from_name(name)
+                        .unwrap_or_else(|| panic!("Unknown thread placement: {name}"))
+                })
+                .collect::<Vec<_>>()
+        })
+        .unwrap_or_else(|_| ThreadPlacement::ALL.to_vec());
+
+    let mut input = None;
+
+    for num_threads in thread_counts {
+        let group_name = format!("placement_t{num_threads}-hot-u64-random-{test_len}");
+        let mut group = c.benchmark_group(&group_name);
+        group.sample_size(10);
+        group.throughput(Throughput::Elements(test_len as u64));
+
+        for &placement in &placements {
+            let pool_name = format!("cpp_ips4o_pool_{}", placement.name());
+            if !should_run_benchmark(&format!("{group_name}/{pool_name}")) {
+                continue;
+            }
+
+            // Only generated if at least one pool runs, it takes a while.
+            let input = input.get_or_insert_with(|| crate::modules::numa::random_u64(test_len));
+            let mut pool = Ips4oPool::new_placed(num_threads, placement);
+
+            group.bench_function(&pool_name, |b| {
+                b.iter_batched_ref(
+                    || input.clone(),
+                    |test_data| {
+                        pool.sort_u64(black_box(test_data.as_mut_slice()));
+                        black_box(test_data); // side-effect
+                    },
+                    BatchSize::LargeInput,
+                )
+            });
+        }
+
+        group.finish();
+    }
+}
+
+#[allow(unused)]
+pub fn bench<T: Ord + std::fmt::Debug>(
+    c: &mut Criterion,
+    test_len: usize,
+    transform_name: &str,
+    transform: &fn(Vec<i32>) -> Vec<T>,
+    pattern_name: &str,
+    pattern_provider: &fn(usize) -> Vec<i32>,
+) {
+    // The length is fixed, run once instead of once per size and pattern. The pools pin their own
+    // threads, pinning the bench thread would get in the way.
+    if test_len != 0 || transform_name != "u64" || pattern_name != "random" {
+        return;
+    }
+
+    #[cfg(feature = "cpp_ips4o_parallel")]
+    bench_thread_placement(c);
+}
@@ -0,0 +1,114 @@
+//! Package and DRAM energy from the RAPL counters, via the powercap sysfs interface of the
+//! intel_rapl driver, which also covers AMD CPUs since Linux 5.8. The counters cover whole
+//! packages and their DRAM, not only the benchmark thread, so everything else running on the
+//! machine is measured too. Most AMD CPUs have no DRAM domain.
+//!
+//! Since CVE-2020-8694 energy_uj is only readable by root. Without any readable domain
+//! `Rapl::new` returns `None`.
+
+use std::fs;
+use std::path::{Path, PathBuf};
+
+/// The reported energies, every domain adds to one of them, e.g. all packages of a multi socket
+/// machine to package.
+pub const NAMES: [&str; 2] = ["package", "dram"];
+
+const POWERCAP_DIR: &str = "/sys/class/powercap";
+
+struct Domain {
+    name_idx: usize,
+    energy_path: PathBuf,
+    max_energy_range_uj: u64,
+}
+
+pub struct Rapl {
+    domains: Vec<Domain>,
+    // Indices into NAMES with at least one domain.
+    name_idxs: Vec<usize>,
+}
+
+fn read_u64(path: &Path) -> Option<u64> {
+    fs::read_to_string(path).ok()?.trim().parse().ok()
+}
+
+impl Rapl {
+    pub fn new() -> Option<Self> {
+        let mut domains = Vec::new();
+
+        for entry in fs::read_dir(POWERCAP_DIR).ok()?.flatten() {
+            // intel-rapl:<package> and intel-rapl:<package>:<subzone>, the intel-rapl control type
+            // and the intel-rapl-mmio duplicates of the packages are skipped.
+            if !entry
+                .file_name()
+                .to_string_lossy()
+                .starts_with("intel-rapl:")
+            {
+                continue;
+            }
+
+            let dir = entry.path();
+            let Ok(name) = fs::read_to_string(dir.join("name")) else {
+                continue;
+            };
+            let name_idx = match name.trim() {
+                name if name.starts_with("package") => 0,
+                "dram" => 1,
+                _ => continue,
+            };
+
+            let energy_path = dir.join("energy_uj");
+            let (Some(_), Some(max_energy_range_uj)) = (
+                read_u64(&energy_path),
+                read_u64(&dir.join("max_energy_range_uj")),
+            ) else {
+                continue;
+            };
+
+            domains.push(Domain {
+                name_idx,
+                energy_path,
+                max_energy_range_uj,
+            });
+        }
+
+        let name_idxs = (0..NAMES.len())
+            .filter(|name_idx| domains.iter().any(|d| d.name_idx == *name_idx))
+            .collect::<Vec<_>>();
+
+        (!domains.is_empty()).then_some(Self { domains, name_idxs })
+    }
+
+    /// The names of `NAMES` this machine has domains for, in the order of `joules`.
+    pub fn names(&self) -> Vec<&'static str> {
+        self.name_idxs
+            .iter()
+            .map(|name_idx| NAMES[*name_idx])
+            .collect()
+    }
+
+    /// The raw counter of every domain, pass two of them to `joules`.
+    pub fn read(&self) -> Vec<u64> {
+        self.domains
+            .iter()
+            .map(|domain| read_u64(&domain.energy_path).unwrap_or(0))
+            .collect()
+    }
+
+    /// Energy per name of `names` between the `read` results `start` and `end`. The counters wrap
+    /// around after max_energy_range_uj, which takes minutes, so at most once in between.
+    pub fn joules(&self, start: &[u64], end: &[u64]) -> Vec<f64> {
+        let mut uj = [0u64; NAMES.len()];
+        for ((domain, start), end) in self.domains.iter().zip(start).zip(end) {
+            uj[domain.name_idx] += if end >= start {
+                end - start
+            } else {
+                domain.max_energy_range_uj - start + end
+            };
+        }
+
+        self.name_idxs
+            .iter()
+            .map(|name_idx| uj[*name_idx] as f64 / 1e6)
+            .collect()
+    }
+}
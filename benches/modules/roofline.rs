@@ -0,0 +1,139 @@
+//! Memory bandwidth reference for the benchmarks with inputs larger than the LLC. Streaming read,
+//! write and copy over a buffer the size of the input, on one thread and on one thread per core,
+//! turn the time of a sort into equivalent passes over memory: how many times each kernel could
+//! have streamed through the input in the time the sort took. A sort that takes few passes is
+//! bound by bandwidth and can only get faster by touching memory less often.
+
+use std::collections::HashMap;
+use std::sync::{Barrier, Mutex};
+use std::time::{Duration, Instant};
+
+use criterion::black_box;
+
+use once_cell::sync::OnceCell;
+
+pub const KERNELS: [&str; 3] = ["read", "write", "copy"];
+
+// Fastest of these many runs of every kernel.
+const RUNS: usize = 5;
+
+/// Bytes per second of every kernel in `KERNELS`, copy counts the bytes copied, not the bytes read
+/// plus written.
+#[derive(Copy, Clone)]
+pub struct Bandwidth {
+    pub single_thread: [f64; KERNELS.len()],
+    pub multi_thread: [f64; KERNELS.len()],
+    pub threads: usize,
+}
+
+fn run_kernel(kernel: usize, src: &[u64], dst: &mut [u64]) {
+    match kernel {
+        0 => {
+            black_box(src.iter().fold(0u64, |acc, val| acc.wrapping_add(*val)));
+        }
+        1 => {
+            dst.fill(black_box(3));
+            black_box(dst.as_ptr());
+        }
+        _ => {
+            dst.copy_from_slice(src);
+            black_box(dst.as_ptr());
+        }
+    }
+}
+
+// Fastest time of running the kernel over src and dst, split into one chunk per thread.
+fn time_kernel(kernel: usize, src: &[u64], dst: &mut [u64], threads: usize) -> Duration {
+    let core_ids = core_affinity::get_core_ids().unwrap_or_default();
+    let chunk_len = src.len().div_ceil(threads);
+    let chunk_count = src.len().div_ceil(chunk_len);
+
+    (0..RUNS)
+        .map(|_| {
+            if threads == 1 {
+                let start = Instant::now();
+                run_kernel(kernel, src, dst);
+                return start.elapsed();
+            }
+
+            // From the first thread starting to the last one finishing, without the spawns.
+            let barrier = Barrier::new(chunk_count);
+            std::thread::scope(|s| {
+                let workers = src
+                    .chunks(chunk_len)
+                    .zip(dst.chunks_mut(chunk_len))
+                    .enumerate()
+                    .map(|(thread_idx, (src, dst))| {
+                        let barrier = &barrier;
+                        let core_id = core_ids.get(thread_idx % core_ids.len().max(1)).copied();
+
+                        s.spawn(move || {
+                            // Spawned threads inherit the affinity of the pinned bench thread.
+                            if let Some(core_id) = core_id {
+                                core_affinity::set_for_current(core_id);
+                            }
+
+                            barrier.wait();
+                            let start = Instant::now();
+                            run_kernel(kernel, src, dst);
+                            (start, Instant::now())
+                        })
+                    })
+                    .collect::<Vec<_>>();
+
+                let intervals = workers
+                    .into_iter()
+                    .map(|worker| worker.join().unwrap())
+                    .collect::<Vec<_>>();
+                let start = intervals.iter().map(|(start, _)| *start).min().unwrap();
+                let end = intervals.iter().map(|(_, end)| *end).max().unwrap();
+                end - start
+            })
+        })
+        .min()
+        .unwrap()
+}
+
+fn measure(bytes: usize) -> Bandwidth {
+    let len = (bytes / std::mem::size_of::<u64>()).max(1);
+    let bytes = (len * std::mem::size_of::<u64>()) as f64;
+
+    // Not zero, so that all pages are faulted in before the measurements.
+    let src = vec![1u64; len];
+    let mut dst = vec![2u64; len];
+
+    let threads = core_affinity::get_core_ids().map_or(1, |ids| ids.len().max(1));
+    let mut bandwidth_of =
+        |kernel, threads| bytes / time_kernel(kernel, &src, &mut dst, threads).as_secs_f64();
+
+    let mut bandwidth = Bandwidth {
+        single_thread: [0.0; KERNELS.len()],
+        multi_thread: [0.0; KERNELS.len()],
+        threads,
+    };
+    for kernel in 0..KERNELS.len() {
+        bandwidth.single_thread[kernel] = bandwidth_of(kernel, 1);
+        bandwidth.multi_thread[kernel] = bandwidth_of(kernel, threads);
+    }
+
+    bandwidth
+}
+
+/// Bandwidth over a buffer of `bytes`, measured once per size.
+pub fn bandwidth(bytes: usize) -> Bandwidth {
+    static CACHE: OnceCell<Mutex<HashMap<usize, Bandwidth>>> = OnceCell::new();
+
+    let cache = CACHE.get_or_init(|| Mutex::new(HashMap::new()));
+    if let Some(bandwidth) = cache.lock().unwrap().get(&bytes) {
+        return *bandwidth;
+    }
+
+    let bandwidth = measure(bytes);
+    cache.lock().unwrap().insert(bytes, bandwidth);
+    bandwidth
+}
+
+/// Times a kernel with `bandwidth` could have streamed through `bytes` in `sort_time`.
+pub fn passes(sort_time: Duration, bytes: usize, bandwidth: f64) -> f64 {
+    sort_time.as_secs_f64() * bandwidth / bytes as f64
+}
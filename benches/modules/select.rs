@@ -0,0 +1,173 @@
+use criterion::{black_box, BatchSize, Criterion};
+
+#[allow(unused_imports)]
+use sort_research_rs::{other, unstable};
+
+#[allow(unused_imports)]
+use sort_test_tools::Sort;
+
+use crate::modules::util::{pin_thread_to_core, should_run_benchmark};
+
+// k as fraction of the input len, in per mille. From a short leaderboard up to a full sort.
+const K_PER_MILLE: [usize; 6] = [1, 10, 50, 100, 500, 1000];
+
+#[allow(unused)]
+fn bench_select_impl<T: Ord + std::fmt::Debug>(
+    c: &mut Criterion,
+    test_len: usize,
+    transform_name: &str,
+    transform: &fn(Vec<i32>) -> Vec<T>,
+    pattern_name: &str,
+    pattern_provider: &fn(usize) -> Vec<i32>,
+    sort_name: &str,
+    op_name: &str,
+    select: impl Fn(&mut [T], usize),
+) {
+    // Pin the benchmark to the same core to improve repeatability.
+    pin_thread_to_core();
+
+    let group_name = format!("{sort_name}-hot-{transform_name}-{pattern_name}-{test_len}");
+    let mut group = c.benchmark_group(&group_name);
+
+    let mut last_k = None;
+    for k_per_mille in K_PER_MILLE {
+        let k = ((test_len * k_per_mille) / 1000).max(1);
+
+        // Small inputs map several ratios to the same k.
+        if last_k == Some(k) {
+            continue;
+        }
+        last_k = Some(k);
+
+        // select_nth_unstable takes an index, pick the last element of the top k.
+        let k_arg = if op_name == "select_nth_unstable" {
+            k - 1
+        } else {
+            k
+        };
+
+        let bench_name = format!("{op_name}_k{k_per_mille}pm");
+        if !should_run_benchmark(&format!("{group_name}/{bench_name}")) {
+            continue;
+        }
+
+        group.bench_function(&bench_name, |b| {
+            b.iter_batched_ref(
+                || transform(pattern_provider(test_len)),
+                |test_data| {
+                    select(black_box(test_data.as_mut_slice()), k_arg);
+                    black_box(test_data); // side-effect
+                },
+                BatchSize::LargeInput,
+            )
+        });
+    }
+
+    group.finish();
+}
+
+#[allow(unused)]
+pub fn bench<T: Ord + std::fmt::Debug>(
+    c: &mut Criterion,
+    test_len: usize,
+    transform_name: &str,
+    transform: &fn(Vec<i32>) -> Vec<T>,
+    pattern_name: &str,
+    pattern_provider: &fn(usize) -> Vec<i32>,
+) {
+    // The FFI entry points only exist for these types.
+    if !matches!(transform_name, "i32" | "u64" | "string" | "f128") || test_len == 0 {
+        return;
+    }
+
+    #[allow(unused_macros)]
+    macro_rules! bench_inst {
+        ($sort_impl_path:path, $($op_name:ident),+) => {{
+            use $sort_impl_path::*;
+
+            $(
+                bench_select_impl(
+                    c,
+                    test_len,
+                    transform_name,
+                    transform,
+                    pattern_name,
+                    pattern_provider,
+                    <SortImpl as Sort>::name().as_str(),
+                    stringify!($op_name),
+                    $op_name::<T>,
+                );
+            )+
+        }};
+    }
+
+    #[cfg(feature = "cpp_std_sys")]
+    bench_inst!(unstable::cpp_std_sys, partial_sort, select_nth_unstable);
+
+    #[cfg(feature = "cpp_std_libcxx")]
+    bench_inst!(unstable::cpp_std_libcxx, partial_sort, select_nth_unstable);
+
+    #[cfg(feature = "cpp_pdqsort")]
+    {
+        bench_inst!(unstable::cpp_pdqsort, partial_sort);
+
+        // Time to read the first k elements in order, with k = len the total time, once sorting
+        // lazily and once sorting everything up front.
+        let sort_name = <unstable::cpp_pdqsort::SortImpl as Sort>::name();
+        let mut bench_first_k = |op_name: &str, first_k: fn(&mut [T], usize)| {
+            bench_select_impl(
+                c,
+                test_len,
+                transform_name,
+                transform,
+                pattern_name,
+                pattern_provider,
+                sort_name.as_str(),
+                op_name,
+                first_k,
+            );
+        };
+
+        bench_first_k("sort_lazy", |v, k| {
+            unstable::cpp_pdqsort::sort_lazy(v).take(k).for_each(|val| {
+                black_box(val);
+            });
+        });
+        bench_first_k("sort_then_iter", |v, k| {
+            <unstable::cpp_pdqsort::SortImpl as Sort>::sort(v);
+            v[..k].iter().for_each(|val| {
+                black_box(val);
+            });
+        });
+    }
+
+    #[cfg(feature = "cpp_ips4o")]
+    bench_inst!(unstable::cpp_ips4o, partial_sort);
+
+    // The SIMD selections only support 32-bit and 64-bit integer keys.
+    let is_int_key = matches!(transform_name, "i32" | "u64");
+
+    #[cfg(feature = "cpp_vqsort")]
+    if is_int_key {
+        bench_inst!(other::cpp_vqsort, select_nth_unstable);
+    }
+
+    #[cfg(all(feature = "cpp_intel_avx512", target_arch = "x86_64"))]
+    if is_int_key {
+        bench_inst!(other::cpp_intel_avx512, select_nth_unstable);
+    }
+
+    #[cfg(feature = "selection")]
+    {
+        bench_inst!(
+            other::selection::rust_std,
+            partial_sort,
+            select_nth_unstable
+        );
+        bench_inst!(
+            other::selection::rust_ipnsort,
+            partial_sort,
+            select_nth_unstable
+        );
+    }
+}
@@ -0,0 +1,99 @@
+//! The generated sorting networks of other::cpp_network_sort, against the small-sorts of other
+//! implementations. Up to len 32 ipnsort, pdqsort and nanosort go straight to their small-sort, so
+//! those are called with their regular entry point.
+
+use criterion::{black_box, BatchSize, Criterion};
+
+use sort_research_rs::other::cpp_network_sort;
+#[allow(unused_imports)]
+use sort_research_rs::unstable;
+
+use sort_test_tools::Sort;
+
+use crate::modules::util::{pin_thread_to_core, should_run_benchmark};
+
+fn sort_u64_n<const N: usize>(data: &mut [u64]) {
+    cpp_network_sort::sort_u64_n::<N>(data.try_into().unwrap());
+}
+
+// The const len variant for test_len, every instance is a direct call of its network.
+fn sort_u64_n_for_len(test_len: usize) -> fn(&mut [u64]) {
+    macro_rules! for_each_len {
+        ($($n:literal)*) => {
+            match test_len {
+                $($n => sort_u64_n::<$n>,)*
+                _ => unreachable!(),
+            }
+        };
+    }
+
+    for_each_len!(
+        2 3 4 5 6 7 8 9 10 11 12 13 14 15 16 17 18 19 20 21 22 23 24 25 26 27 28 29 30 31 32
+    )
+}
+
+#[allow(unused)]
+pub fn bench<T: Ord + std::fmt::Debug>(
+    c: &mut Criterion,
+    test_len: usize,
+    transform_name: &str,
+    transform: &fn(Vec<i32>) -> Vec<T>,
+    pattern_name: &str,
+    pattern_provider: &fn(usize) -> Vec<i32>,
+) {
+    // The networks only exist for u64 and len 2 to MAX_LEN.
+    if transform_name != "u64" || !(2..=cpp_network_sort::MAX_LEN).contains(&test_len) {
+        return;
+    }
+
+    let mut sorts: Vec<(String, fn(&mut [u64]))> = vec![
+        ("cpp_network_sort".into(), cpp_network_sort::sort_u64),
+        ("cpp_network_sort_n".into(), sort_u64_n_for_len(test_len)),
+    ];
+
+    macro_rules! add_sort {
+        ($sort_impl_path:path) => {{
+            use $sort_impl_path::*;
+
+            sorts.push((<SortImpl as Sort>::name(), <SortImpl as Sort>::sort::<u64>));
+        }};
+    }
+
+    add_sort!(unstable::rust_ipnsort);
+
+    #[cfg(feature = "cpp_pdqsort")]
+    add_sort!(unstable::cpp_pdqsort);
+
+    #[cfg(feature = "cpp_nanosort")]
+    add_sort!(unstable::cpp_nanosort);
+
+    // Pin the benchmark to the same core to improve repeatability.
+    pin_thread_to_core();
+
+    let group_name = format!("small_network-hot-u64-{pattern_name}-{test_len}");
+    let mut group = c.benchmark_group(&group_name);
+
+    for (sort_name, sort) in sorts {
+        if !should_run_benchmark(&format!("{group_name}/{sort_name}")) {
+            continue;
+        }
+
+        group.bench_function(&sort_name, |b| {
+            b.iter_batched_ref(
+                || {
+                    pattern_provider(test_len)
+                        .into_iter()
+                        .map(|val| val as u64)
+                        .collect::<Vec<_>>()
+                },
+                |test_data| {
+                    sort(black_box(test_data.as_mut_slice()));
+                    black_box(test_data); // side-effect
+                },
+                BatchSize::SmallInput,
+            )
+        });
+    }
+
+    group.finish();
+}
@@ -1,23 +1,21 @@
 use std::env;
+use std::panic;
 
 use criterion::{black_box, Criterion};
 
-use sort_test_tools::Sort;
+use once_cell::sync::OnceCell;
+
+#[allow(unused_imports)]
+use sort_test_tools::ffi_types::KeyDescriptor;
+use sort_test_tools::{patterns, Sort};
 
 #[allow(unused_imports)]
 use sort_research_rs::{other, stable, unstable};
 
-use crate::modules::util;
+use crate::modules::{throughput, util};
 
-fn measure_comp_count<S: Sort, T: Ord + std::fmt::Debug>(
-    name: &str,
-    test_len: usize,
-    transform: &fn(Vec<i32>) -> Vec<T>,
-    pattern_provider: impl Fn(usize) -> Vec<i32>,
-) {
-    // Measure how many comparisons are performed by a specific implementation and input
-    // combination.
-    let run_count: usize = if test_len <= 20 {
+fn comp_run_count(test_len: usize) -> usize {
+    if test_len <= 20 {
         100_000
     } else if test_len < 10_000 {
         3000
@@ -27,7 +25,18 @@ fn measure_comp_count<S: Sort, T: Ord + std::fmt::Debug>(
         100
     } else {
         10
-    };
+    }
+}
+
+fn measure_comp_count<S: Sort, T: Ord + std::fmt::Debug>(
+    name: &str,
+    test_len: usize,
+    transform: &fn(Vec<i32>) -> Vec<T>,
+    pattern_provider: impl Fn(usize) -> Vec<i32>,
+) {
+    // Measure how many comparisons are performed by a specific implementation and input
+    // combination.
+    let run_count = comp_run_count(test_len);
 
     let mut comp_count = 0u64;
 
@@ -47,13 +56,108 @@ fn measure_comp_count<S: Sort, T: Ord + std::fmt::Debug>(
     println!("{name}: mean comparisons: {total}");
 }
 
+#[cfg(feature = "measure_alloc")]
+fn measure_alloc_usage<S: Sort, T: Ord + std::fmt::Debug>(
+    name: &str,
+    test_len: usize,
+    transform: &fn(Vec<i32>) -> Vec<T>,
+    pattern_provider: impl Fn(usize) -> Vec<i32>,
+) {
+    use crate::modules::alloc_count;
+
+    // Allocation behavior is mostly input independent, a couple of runs is enough to catch the
+    // pattern dependent ones.
+    let run_count: usize = if test_len <= 20 {
+        1000
+    } else if test_len < 100_000 {
+        100
+    } else {
+        5
+    };
+
+    let mut peak_bytes = 0;
+    let mut alloc_count = 0;
+
+    for _ in 0..run_count {
+        let mut test_data = transform(pattern_provider(test_len));
+        let stats = alloc_count::measure(|| S::sort(black_box(test_data.as_mut_slice())));
+
+        peak_bytes = peak_bytes.max(stats.peak_bytes);
+        alloc_count += stats.alloc_count;
+    }
+
+    let mean_alloc_count = alloc_count as f64 / run_count as f64;
+    println!("{name}: peak bytes: {peak_bytes} mean allocations: {mean_alloc_count:.2}");
+}
+
+#[cfg(not(feature = "measure_alloc"))]
+fn measure_alloc_usage<S: Sort, T: Ord + std::fmt::Debug>(
+    _name: &str,
+    _test_len: usize,
+    _transform: &fn(Vec<i32>) -> Vec<T>,
+    _pattern_provider: impl Fn(usize) -> Vec<i32>,
+) {
+    panic!("MEASURE_ALLOC needs the measure_alloc feature");
+}
+
+fn supports_sort_by<S: Sort>() -> bool {
+    // The FFI sorts without comparison function support panic in sort_by, keep that quiet.
+    let prev_hook = panic::take_hook();
+    panic::set_hook(Box::new(|_| {}));
+    let supported = panic::catch_unwind(|| S::sort_by(&mut [1, 0], |a: &i32, b| a.cmp(b))).is_ok();
+    panic::set_hook(prev_hook);
+
+    supported
+}
+
 pub fn bench_fn<S: Sort, T: Ord + std::fmt::Debug>(
     c: &mut Criterion,
     test_len: usize,
     transform_name: &str,
     transform: &fn(Vec<i32>) -> Vec<T>,
     pattern_name: &str,
-    pattern_provider: impl Fn(usize) -> Vec<i32>,
+    pattern_provider: impl Fn(usize) -> Vec<i32> + Sync,
+) {
+    if pattern_name == "antiqsort" {
+        // The adversary has to play against the sort that is measured, the generic pattern
+        // provider only knows Rust's sort_unstable. Generated once on first use, it's O(n^2) for
+        // the sorts it defeats.
+        if !supports_sort_by::<S>() {
+            return;
+        }
+
+        let input = OnceCell::new();
+        return bench_fn_impl::<S, T>(
+            c,
+            test_len,
+            transform_name,
+            transform,
+            pattern_name,
+            |len| {
+                input
+                    .get_or_init(|| patterns::antiqsort(len, |v, compare| S::sort_by(v, compare)))
+                    .clone()
+            },
+        );
+    }
+
+    bench_fn_impl::<S, T>(
+        c,
+        test_len,
+        transform_name,
+        transform,
+        pattern_name,
+        pattern_provider,
+    );
+}
+
+fn bench_fn_impl<S: Sort, T: Ord + std::fmt::Debug>(
+    c: &mut Criterion,
+    test_len: usize,
+    transform_name: &str,
+    transform: &fn(Vec<i32>) -> Vec<T>,
+    pattern_name: &str,
+    pattern_provider: impl Fn(usize) -> Vec<i32> + Sync,
 ) {
     let bench_name = S::name();
 
@@ -66,6 +170,27 @@ pub fn bench_fn<S: Sort, T: Ord + std::fmt::Debug>(
         if util::should_run_benchmark(&name) {
             measure_comp_count::<S, T>(&name, test_len, transform, pattern_provider);
         }
+    } else if env::var("MEASURE_ALLOC").is_ok() {
+        let name = format!(
+            "{}-alloc-{}-{}-{}",
+            bench_name, transform_name, pattern_name, test_len
+        );
+
+        if util::should_run_benchmark(&name) {
+            measure_alloc_usage::<S, T>(&name, test_len, transform, pattern_provider);
+        }
+    } else if let Some(num_threads) = throughput::num_threads() {
+        throughput::bench_fn(
+            c,
+            num_threads,
+            test_len,
+            transform_name,
+            transform,
+            pattern_name,
+            &pattern_provider,
+            &bench_name,
+            S::sort,
+        );
     } else {
         util::bench_fn(
             c,
@@ -80,143 +205,1316 @@ pub fn bench_fn<S: Sort, T: Ord + std::fmt::Debug>(
     }
 }
 
-pub fn bench<T: Ord + std::fmt::Debug>(
+#[cfg(feature = "cpp_vqsort")]
+fn bench_vqsort_key_value(
     c: &mut Criterion,
     test_len: usize,
-    transform_name: &str,
-    transform: &fn(Vec<i32>) -> Vec<T>,
     pattern_name: &str,
     pattern_provider: &fn(usize) -> Vec<i32>,
 ) {
-    macro_rules! bench_inst {
-        ($sort_impl_path:path) => {{
-            use $sort_impl_path::*;
+    // Sorting (key, row-id) pairs. Compares the dedicated vqsort key-value paths against
+    // packing key and row-id into a u128 and sorting that.
+    let transform_name = "u64_kv";
 
-            bench_fn::<SortImpl, T>(
-                c,
-                test_len,
-                transform_name,
-                transform,
-                pattern_name,
-                pattern_provider,
-            );
-        }};
+    fn to_key(val: i32) -> u64 {
+        (val as i64 - i32::MIN as i64) as u64
     }
 
-    // --- Stable sorts ---
-
-    bench_inst!(stable::rust_std);
-
-    #[cfg(feature = "cpp_std_sys")]
-    bench_inst!(stable::cpp_std_sys);
-
-    #[cfg(feature = "cpp_std_libcxx")]
-    bench_inst!(stable::cpp_std_libcxx);
-
-    #[cfg(feature = "cpp_std_gcc4_3")]
-    bench_inst!(stable::cpp_std_gcc4_3);
+    let kv_transform: fn(Vec<i32>) -> Vec<other::cpp_vqsort::K64V64> = |values| {
+        values
+            .into_iter()
+            .enumerate()
+            .map(|(i, val)| other::cpp_vqsort::K64V64::new(to_key(val), i as u64))
+            .collect()
+    };
 
-    #[cfg(feature = "cpp_powersort")]
-    bench_inst!(stable::cpp_powersort);
+    let key_transform: fn(Vec<i32>) -> Vec<u64> = |values| values.into_iter().map(to_key).collect();
 
-    #[cfg(feature = "cpp_powersort")]
-    bench_inst!(stable::cpp_powersort_4way);
+    let packed_transform: fn(Vec<i32>) -> Vec<u128> = |values| {
+        values
+            .into_iter()
+            .enumerate()
+            .map(|(i, val)| ((to_key(val) as u128) << 64) | i as u128)
+            .collect()
+    };
 
-    #[cfg(feature = "cpp_wikisort")]
-    bench_inst!(stable::cpp_wikisort);
+    util::bench_fn(
+        c,
+        test_len,
+        transform_name,
+        &kv_transform,
+        pattern_name,
+        pattern_provider,
+        "cpp_vqsort_kv",
+        other::cpp_vqsort::sort_kv_u64,
+    );
 
-    #[cfg(feature = "c_fluxsort")]
-    bench_inst!(stable::c_fluxsort);
+    util::bench_fn(
+        c,
+        test_len,
+        transform_name,
+        &key_transform,
+        pattern_name,
+        pattern_provider,
+        "cpp_vqsort_argsort",
+        |keys: &mut [u64]| {
+            black_box(other::cpp_vqsort::argsort_u64(keys));
+        },
+    );
 
-    #[cfg(feature = "golang_std")]
-    bench_inst!(stable::golang_std);
+    util::bench_fn(
+        c,
+        test_len,
+        transform_name,
+        &packed_transform,
+        pattern_name,
+        pattern_provider,
+        "rust_ipnsort_u128_packed",
+        <unstable::rust_ipnsort::SortImpl as Sort>::sort::<u128>,
+    );
 
-    #[cfg(feature = "rust_wpwoodjr")]
-    bench_inst!(stable::rust_wpwoodjr);
+    util::bench_fn(
+        c,
+        test_len,
+        transform_name,
+        &packed_transform,
+        pattern_name,
+        pattern_provider,
+        "rust_std_unstable_u128_packed",
+        <unstable::rust_std::SortImpl as Sort>::sort::<u128>,
+    );
+}
 
-    #[cfg(feature = "rust_glidesort")]
-    bench_inst!(stable::rust_glidesort);
+#[cfg(feature = "cpp_radix")]
+fn bench_radix_payload(
+    c: &mut Criterion,
+    test_len: usize,
+    pattern_name: &str,
+    pattern_provider: &fn(usize) -> Vec<i32>,
+) {
+    // Same keys and transform name as bench_vqsort_key_value, so the results line up with the
+    // vqsort key-value paths. The row-ids are written as part of the measurement, like the
+    // argsort indices.
+    let key_transform: fn(Vec<i32>) -> Vec<u64> = |values| {
+        values
+            .into_iter()
+            .map(|val| (val as i64 - i32::MIN as i64) as u64)
+            .collect()
+    };
 
-    // #[cfg(feature = "rust_driftsort")]
-    // bench_inst!(stable::rust_driftsort);
+    util::bench_fn(
+        c,
+        test_len,
+        "u64_kv",
+        &key_transform,
+        pattern_name,
+        pattern_provider,
+        "cpp_radix_payload",
+        |keys: &mut [u64]| {
+            let mut row_ids = (0..keys.len() as u64).collect::<Vec<_>>();
+            other::cpp_radix::sort_with_payload_u64(keys, &mut row_ids);
+            black_box(row_ids);
+        },
+    );
+}
 
-    #[cfg(feature = "rust_tinysort")]
-    bench_inst!(stable::rust_tinysort);
+#[cfg(feature = "cpp_gpu_sort")]
+fn bench_gpu_sort_payload(
+    c: &mut Criterion,
+    test_len: usize,
+    pattern_name: &str,
+    pattern_provider: &fn(usize) -> Vec<i32>,
+) {
+    // Same setup as bench_radix_payload.
+    let key_transform: fn(Vec<i32>) -> Vec<u64> = |values| {
+        values
+            .into_iter()
+            .map(|val| (val as i64 - i32::MIN as i64) as u64)
+            .collect()
+    };
 
-    #[cfg(feature = "rust_grailsort")]
-    bench_inst!(stable::rust_grailsort);
+    util::bench_fn(
+        c,
+        test_len,
+        "u64_kv",
+        &key_transform,
+        pattern_name,
+        pattern_provider,
+        "cpp_gpu_sort_payload",
+        |keys: &mut [u64]| {
+            let mut row_ids = (0..keys.len() as u64).collect::<Vec<_>>();
+            other::cpp_gpu_sort::sort_with_payload_u64(keys, &mut row_ids);
+            black_box(row_ids);
+        },
+    );
+}
 
-    // --- Unstable sorts ---
+#[cfg(all(feature = "cpp_intel_avx512", target_arch = "x86_64"))]
+fn bench_intel_avx512_key_value(
+    c: &mut Criterion,
+    test_len: usize,
+    pattern_name: &str,
+    pattern_provider: &fn(usize) -> Vec<i32>,
+) {
+    // Same setup as bench_radix_payload.
+    let key_transform: fn(Vec<i32>) -> Vec<u64> = |values| {
+        values
+            .into_iter()
+            .map(|val| (val as i64 - i32::MIN as i64) as u64)
+            .collect()
+    };
 
-    bench_inst!(unstable::rust_ipnsort);
+    util::bench_fn(
+        c,
+        test_len,
+        "u64_kv",
+        &key_transform,
+        pattern_name,
+        pattern_provider,
+        "cpp_intel_avx512_kv",
+        |keys: &mut [u64]| {
+            let mut row_ids = (0..keys.len() as u64).collect::<Vec<_>>();
+            other::cpp_intel_avx512::sort_with_payload_u64(keys, &mut row_ids);
+            black_box(row_ids);
+        },
+    );
+}
 
-    bench_inst!(unstable::rust_std);
+#[cfg(any(
+    feature = "cpp_vqsort",
+    feature = "cpp_intel_avx512",
+    feature = "singeli_singelisort"
+))]
+fn bench_packed_records(
+    c: &mut Criterion,
+    test_len: usize,
+    pattern_name: &str,
+    pattern_provider: &fn(usize) -> Vec<i32>,
+) {
+    // Two field records ordered by (key, row-id). The packed sorts turn them into integer words,
+    // the comparison sorts use the derived Ord of the record.
+    use sort_test_tools::ffi_types::{KeyPayloadU32, KeyPayloadU64};
 
-    #[cfg(feature = "rust_dmsort")]
-    bench_inst!(unstable::rust_dmsort);
+    let u32_transform: fn(Vec<i32>) -> Vec<KeyPayloadU32> = |values| {
+        values
+            .into_iter()
+            .enumerate()
+            .map(|(i, val)| KeyPayloadU32::new(val.wrapping_sub(i32::MIN) as u32, i as u32))
+            .collect()
+    };
 
-    #[cfg(feature = "rust_crumsort_rs")]
-    bench_inst!(unstable::rust_crumsort_rs);
+    let u64_transform: fn(Vec<i32>) -> Vec<KeyPayloadU64> = |values| {
+        values
+            .into_iter()
+            .enumerate()
+            .map(|(i, val)| KeyPayloadU64::new((val as i64 - i32::MIN as i64) as u64, i as u64))
+            .collect()
+    };
 
-    #[cfg(feature = "rust_tinysort")]
-    bench_inst!(unstable::rust_tinysort);
+    macro_rules! bench_packed_inst {
+        ($transform_name:expr, $transform:expr, $bench_name:expr, $sort_fn:expr) => {
+            util::bench_fn(
+                c,
+                test_len,
+                $transform_name,
+                $transform,
+                pattern_name,
+                pattern_provider,
+                $bench_name,
+                $sort_fn,
+            );
+        };
+    }
 
-    #[cfg(feature = "rust_introsort")]
-    bench_inst!(unstable::rust_introsort);
+    #[cfg(feature = "cpp_vqsort")]
+    bench_packed_inst!(
+        "key_payload_u32",
+        &u32_transform,
+        "cpp_vqsort_packed",
+        other::cpp_vqsort::sort_packed::<KeyPayloadU32>
+    );
 
-    #[cfg(feature = "cpp_pdqsort")]
-    bench_inst!(unstable::cpp_pdqsort);
+    #[cfg(all(feature = "cpp_intel_avx512", target_arch = "x86_64"))]
+    bench_packed_inst!(
+        "key_payload_u32",
+        &u32_transform,
+        "cpp_intel_avx512_packed",
+        other::cpp_intel_avx512::sort_packed::<KeyPayloadU32>
+    );
 
-    #[cfg(feature = "cpp_ips4o")]
-    bench_inst!(unstable::cpp_ips4o);
+    #[cfg(feature = "singeli_singelisort")]
+    bench_packed_inst!(
+        "key_payload_u32",
+        &u32_transform,
+        "singeli_singelisort_packed",
+        other::singeli_singelisort::sort_packed::<KeyPayloadU32>
+    );
 
-    #[cfg(feature = "cpp_blockquicksort")]
-    bench_inst!(unstable::cpp_blockquicksort);
+    #[cfg(feature = "cpp_vqsort")]
+    bench_packed_inst!(
+        "key_payload_u64",
+        &u64_transform,
+        "cpp_vqsort_packed",
+        other::cpp_vqsort::sort_packed::<KeyPayloadU64>
+    );
 
-    #[cfg(feature = "cpp_gerbens_qsort")]
-    bench_inst!(unstable::cpp_gerbens_qsort);
+    bench_packed_inst!(
+        "key_payload_u32",
+        &u32_transform,
+        "rust_ipnsort_unstable",
+        <unstable::rust_ipnsort::SortImpl as Sort>::sort::<KeyPayloadU32>
+    );
+    bench_packed_inst!(
+        "key_payload_u32",
+        &u32_transform,
+        "rust_std_unstable",
+        <unstable::rust_std::SortImpl as Sort>::sort::<KeyPayloadU32>
+    );
+    bench_packed_inst!(
+        "key_payload_u64",
+        &u64_transform,
+        "rust_ipnsort_unstable",
+        <unstable::rust_ipnsort::SortImpl as Sort>::sort::<KeyPayloadU64>
+    );
+    bench_packed_inst!(
+        "key_payload_u64",
+        &u64_transform,
+        "rust_std_unstable",
+        <unstable::rust_std::SortImpl as Sort>::sort::<KeyPayloadU64>
+    );
+}
 
-    #[cfg(feature = "cpp_nanosort")]
-    bench_inst!(unstable::cpp_nanosort);
+#[cfg(feature = "cpp_powersort_parallel")]
+fn bench_powersort_parallel_scaling<T: Ord + std::fmt::Debug>(
+    c: &mut Criterion,
+    test_len: usize,
+    transform_name: &str,
+    transform: &fn(Vec<i32>) -> Vec<T>,
+    pattern_name: &str,
+    pattern_provider: &fn(usize) -> Vec<i32>,
+) {
+    // Thread count sweep 1, 2, 4, ... up to the configured number of threads. Needs
+    // BENCH_NO_PIN, otherwise all worker threads share the pinned core.
+    use sort_research_rs::ffi_util;
 
-    #[cfg(feature = "c_std_sys")]
-    bench_inst!(unstable::c_std_sys);
+    let max_threads = ffi_util::num_threads();
 
-    #[cfg(feature = "c_crumsort")]
-    bench_inst!(unstable::c_crumsort);
+    let mut num_threads = 1;
+    while num_threads <= max_threads {
+        ffi_util::set_num_threads(num_threads);
 
-    #[cfg(feature = "cpp_std_sys")]
-    bench_inst!(unstable::cpp_std_sys);
+        util::bench_fn(
+            c,
+            test_len,
+            transform_name,
+            transform,
+            pattern_name,
+            pattern_provider,
+            &format!("cpp_powersort_parallel_t{num_threads}"),
+            <stable::cpp_powersort_parallel::SortImpl as Sort>::sort::<T>,
+        );
 
-    #[cfg(feature = "cpp_std_libcxx")]
-    bench_inst!(unstable::cpp_std_libcxx);
+        num_threads *= 2;
+    }
 
-    #[cfg(feature = "cpp_std_gcc4_3")]
-    bench_inst!(unstable::cpp_std_gcc4_3);
+    ffi_util::set_num_threads(max_threads);
+}
 
-    #[cfg(feature = "golang_std")]
-    bench_inst!(unstable::golang_std);
+#[cfg(feature = "cpp_gerbens_qsort")]
+fn bench_gerbens_qsort_scratch_sweep<T: Ord + std::fmt::Debug>(
+    c: &mut Criterion,
+    test_len: usize,
+    transform_name: &str,
+    transform: &fn(Vec<i32>) -> Vec<T>,
+    pattern_name: &str,
+    pattern_provider: &fn(usize) -> Vec<i32>,
+) {
+    // Scratch buffer size sweep, s_auto is the size picked based on the L1 cache size.
+    use unstable::cpp_gerbens_qsort;
 
-    // --- Other sorts ---
+    for scratch_size in cpp_gerbens_qsort::SCRATCH_SIZES.into_iter().chain([0]) {
+        let name = if scratch_size == 0 {
+            "cpp_gerbens_qsort_unstable_s_auto".to_string()
+        } else {
+            format!("cpp_gerbens_qsort_unstable_s{scratch_size}")
+        };
 
-    #[cfg(feature = "rust_radsort")]
-    bench_inst!(other::rust_radsort);
+        util::bench_fn(
+            c,
+            test_len,
+            transform_name,
+            transform,
+            pattern_name,
+            pattern_provider,
+            &name,
+            |data: &mut [T]| cpp_gerbens_qsort::sort_scratch(data, scratch_size),
+        );
+    }
+}
 
-    #[cfg(feature = "rust_afsort")]
-    bench_inst!(other::rust_afsort);
+#[cfg(feature = "c_crumsort")]
+fn bench_crumsort_swap_sweep<T: Ord + std::fmt::Debug>(
+    c: &mut Criterion,
+    test_len: usize,
+    transform_name: &str,
+    transform: &fn(Vec<i32>) -> Vec<T>,
+    pattern_name: &str,
+    pattern_provider: &fn(usize) -> Vec<i32>,
+) {
+    // Caller provided swap sizes from 512 B to 64 KiB. The swap needs room for at least 128
+    // elements, for 1k that's 128 KiB, so 1k starts at 64 KiB, the smallest fallback, and goes up to
+    // 1 MiB instead.
+    use std::cell::RefCell;
+    use std::mem::MaybeUninit;
 
-    #[cfg(feature = "cpp_simdsort")]
-    bench_inst!(other::cpp_simdsort);
+    use unstable::c_crumsort;
 
-    #[cfg(feature = "cpp_vqsort")]
-    bench_inst!(other::cpp_vqsort);
+    let swap_bytes_log2 = if transform_name == "1k" {
+        16..=20
+    } else {
+        9..=16
+    };
 
-    #[cfg(feature = "cpp_intel_avx512")]
-    bench_inst!(other::cpp_intel_avx512);
+    for swap_bytes in swap_bytes_log2.map(|log2| 1usize << log2) {
+        // u64 elements keep the buffer aligned for every supported type.
+        let buf = RefCell::new(vec![MaybeUninit::<u64>::uninit(); swap_bytes / 8]);
+
+        util::bench_fn(
+            c,
+            test_len,
+            transform_name,
+            transform,
+            pattern_name,
+            pattern_provider,
+            &format!("c_crumsort_unstable_swap{swap_bytes}"),
+            |data: &mut [T]| {
+                let mut buf = buf.borrow_mut();
+                let buf_bytes = unsafe {
+                    std::slice::from_raw_parts_mut(
+                        buf.as_mut_ptr() as *mut MaybeUninit<u8>,
+                        swap_bytes,
+                    )
+                };
+                c_crumsort::sort_with_buf(data, buf_bytes);
+            },
+        );
+    }
+}
+
+#[cfg(feature = "cpp_wikisort")]
+fn bench_wikisort_cache_modes<T: Ord + std::fmt::Debug>(
+    c: &mut Criterion,
+    test_len: usize,
+    transform_name: &str,
+    transform: &fn(Vec<i32>) -> Vec<T>,
+    pattern_name: &str,
+    pattern_provider: &fn(usize) -> Vec<i32>,
+) {
+    // In-place versus buffered merging, from no cache at all to a full n / 2 cache.
+    use stable::cpp_wikisort::{self, CacheMode};
+
+    let modes = [
+        ("none", CacheMode::Fixed(0)),
+        ("fixed4096", CacheMode::Fixed(4096)),
+        ("sqrt", CacheMode::Sqrt),
+        ("half", CacheMode::Half),
+    ];
+
+    for (mode_name, mode) in modes {
+        util::bench_fn(
+            c,
+            test_len,
+            transform_name,
+            transform,
+            pattern_name,
+            pattern_provider,
+            &format!("cpp_wikisort_stable_cache_{mode_name}"),
+            |data: &mut [T]| cpp_wikisort::sort_cache_mode(data, mode),
+        );
+    }
+}
+
+// Only changes anything for f128 and 1k, the default mode is covered by the plain benchmark of
+// the sort.
+#[cfg(any(feature = "cpp_powersort", feature = "cpp_wikisort"))]
+fn bench_merge_modes<T: Ord + std::fmt::Debug, M: Copy>(
+    c: &mut Criterion,
+    test_len: usize,
+    transform_name: &str,
+    transform: &fn(Vec<i32>) -> Vec<T>,
+    pattern_name: &str,
+    pattern_provider: &fn(usize) -> Vec<i32>,
+    sort_name: &str,
+    modes: [(&str, M); 2],
+    sort_merge_mode: fn(&mut [T], M),
+) {
+    for (mode_name, mode) in modes {
+        util::bench_fn(
+            c,
+            test_len,
+            transform_name,
+            transform,
+            pattern_name,
+            pattern_provider,
+            &format!("{sort_name}_merge_{mode_name}"),
+            |data: &mut [T]| sort_merge_mode(data, mode),
+        );
+    }
+}
+
+#[cfg(feature = "cpp_ips4o")]
+fn bench_ips4o_sort_into<T: Ord + std::fmt::Debug>(
+    c: &mut Criterion,
+    test_len: usize,
+    transform_name: &str,
+    transform: &fn(Vec<i32>) -> Vec<T>,
+    pattern_name: &str,
+    pattern_provider: &fn(usize) -> Vec<i32>,
+) {
+    // The destination is allocated once up front, like a buffer that is about to be replaced,
+    // so that its page faults don't count towards the sort.
+    use std::cell::RefCell;
+    use unstable::cpp_ips4o;
+
+    let dst = RefCell::new(transform(pattern_provider(test_len)));
+
+    util::bench_fn(
+        c,
+        test_len,
+        transform_name,
+        transform,
+        pattern_name,
+        pattern_provider,
+        "cpp_ips4o_unstable_into",
+        |src: &mut [T]| cpp_ips4o::sort_into(src, dst.borrow_mut().as_mut_slice()),
+    );
+}
+
+// Every tuned ips4o configuration, see Ips4oProfile. cpp_ips4o_unstable is the default profile.
+#[cfg(feature = "cpp_ips4o")]
+fn bench_ips4o_profiles<T: Ord + std::fmt::Debug>(
+    c: &mut Criterion,
+    test_len: usize,
+    transform_name: &str,
+    transform: &fn(Vec<i32>) -> Vec<T>,
+    pattern_name: &str,
+    pattern_provider: &fn(usize) -> Vec<i32>,
+) {
+    use unstable::cpp_ips4o::{self, Ips4oProfile};
+
+    for profile in Ips4oProfile::ALL {
+        if profile == Ips4oProfile::Default {
+            continue;
+        }
+
+        util::bench_fn(
+            c,
+            test_len,
+            transform_name,
+            transform,
+            pattern_name,
+            pattern_provider,
+            &format!("cpp_ips4o_unstable_{}", profile.name()),
+            |data: &mut [T]| cpp_ips4o::sort_profile(data, profile),
+        );
+    }
+}
+
+// Same as measure_comp_count, but with the element copies and moves counted by the C++ side, see
+// CountingWrapper in shared.h.
+#[allow(unused)]
+fn measure_op_counts<T: Ord>(
+    name: &str,
+    test_len: usize,
+    transform: &fn(Vec<i32>) -> Vec<T>,
+    pattern_provider: &fn(usize) -> Vec<i32>,
+    sort_counted: fn(&mut [T]) -> sort_test_tools::ffi_types::OpCounts,
+) {
+    let run_count = comp_run_count(test_len);
+
+    let mut comparisons = 0u64;
+    let mut copies = 0u64;
+    let mut moves = 0u64;
+
+    for _ in 0..run_count {
+        let mut test_data = transform(pattern_provider(test_len));
+        let counts = sort_counted(black_box(test_data.as_mut_slice()));
+
+        comparisons += counts.comparisons;
+        copies += counts.copies;
+        moves += counts.moves;
+    }
+
+    let run_count = run_count as u64;
+    println!(
+        "{name}: comparisons: {} copies: {} moves: {}",
+        comparisons / run_count,
+        copies / run_count,
+        moves / run_count
+    );
+}
+
+#[allow(unused)]
+fn print_phase_times(name: &str, phases: &[&str], phase_times: &[std::time::Duration]) {
+    // The first phase is the total, the others are reported as share of their sum. For parallel
+    // implementations they are summed across threads, and can exceed the total.
+    let phase_sum = phase_times[1..].iter().sum::<std::time::Duration>();
+    if phase_sum.is_zero() {
+        return; // Filtered out or never reached the instrumented code.
+    }
+
+    let shares = phases[1..]
+        .iter()
+        .zip(&phase_times[1..])
+        .map(|(phase, time)| {
+            format!(
+                "{phase} {:.1}%",
+                time.as_secs_f64() / phase_sum.as_secs_f64() * 100.0
+            )
+        })
+        .collect::<Vec<_>>();
+
+    println!(
+        "{name}: total {:.3}s, phase sum {:.3}s: {}",
+        phase_times[0].as_secs_f64(),
+        phase_sum.as_secs_f64(),
+        shares.join(", ")
+    );
+}
+
+pub fn bench<T: Ord + std::fmt::Debug>(
+    c: &mut Criterion,
+    test_len: usize,
+    transform_name: &str,
+    transform: &fn(Vec<i32>) -> Vec<T>,
+    pattern_name: &str,
+    pattern_provider: &fn(usize) -> Vec<i32>,
+) {
+    macro_rules! bench_inst {
+        ($sort_impl_path:path) => {{
+            use $sort_impl_path::*;
+
+            bench_fn::<SortImpl, T>(
+                c,
+                test_len,
+                transform_name,
+                transform,
+                pattern_name,
+                pattern_provider,
+            );
+        }};
+    }
+
+    // Follows the benchmark with the split of its time into the phases of the implementation.
+    #[allow(unused_macros)]
+    macro_rules! bench_inst_phase_times {
+        ($sort_impl_path:path) => {{
+            use $sort_impl_path::*;
+
+            reset_phase_times();
+            bench_inst!($sort_impl_path);
+
+            print_phase_times(
+                &format!(
+                    "{}-phases-{transform_name}-{pattern_name}-{test_len}",
+                    <SortImpl as Sort>::name()
+                ),
+                PHASES,
+                &phase_times(),
+            );
+        }};
+    }
+
+    // Follows the comparison count of implementations that provide sort_counted with their
+    // element copies and moves.
+    #[allow(unused_macros)]
+    macro_rules! bench_inst_op_counts {
+        ($sort_impl_path:path) => {{
+            use $sort_impl_path::*;
+
+            let name = format!(
+                "{}-ops-{transform_name}-{pattern_name}-{test_len}",
+                <SortImpl as Sort>::name()
+            );
+
+            // The _counted entry points only exist for i32, u64 and 1k.
+            if env::var("MEASURE_COMP").is_ok()
+                && matches!(transform_name, "i32" | "u64" | "1k")
+                && util::should_run_benchmark(&name)
+            {
+                measure_op_counts::<T>(
+                    &name,
+                    test_len,
+                    transform,
+                    pattern_provider,
+                    sort_counted::<T>,
+                );
+            }
+        }};
+    }
+
+    // --- Stable sorts ---
+
+    bench_inst!(stable::rust_std);
+
+    #[cfg(feature = "cpp_std_sys")]
+    bench_inst!(stable::cpp_std_sys);
+
+    #[cfg(feature = "cpp_std_sys")]
+    bench_inst_op_counts!(stable::cpp_std_sys);
+
+    #[cfg(feature = "cpp_std_libcxx")]
+    bench_inst!(stable::cpp_std_libcxx);
+
+    #[cfg(feature = "cpp_std_libcxx")]
+    bench_inst_op_counts!(stable::cpp_std_libcxx);
+
+    #[cfg(feature = "cpp_std_gcc4_3")]
+    bench_inst!(stable::cpp_std_gcc4_3);
+
+    #[cfg(feature = "cpp_powersort")]
+    bench_inst!(stable::cpp_powersort);
+
+    #[cfg(feature = "cpp_powersort")]
+    bench_inst_op_counts!(stable::cpp_powersort);
+
+    #[cfg(feature = "cpp_powersort")]
+    if matches!(transform_name, "f128" | "1k") {
+        use stable::cpp_powersort::{self, MergeMode};
+
+        bench_merge_modes(
+            c,
+            test_len,
+            transform_name,
+            transform,
+            pattern_name,
+            pattern_provider,
+            "cpp_powersort_stable",
+            [
+                ("prefetch", MergeMode::Prefetch),
+                ("blockwise", MergeMode::Blockwise),
+            ],
+            cpp_powersort::sort_merge_mode::<T>,
+        );
+    }
+
+    #[cfg(feature = "cpp_powersort")]
+    bench_inst!(stable::cpp_powersort_4way);
+
+    #[cfg(feature = "cpp_powersort_parallel")]
+    bench_inst!(stable::cpp_powersort_parallel);
+
+    #[cfg(feature = "cpp_std_sys_parallel")]
+    bench_inst!(stable::cpp_std_sys_parallel);
+
+    #[cfg(feature = "cpp_powersort_parallel")]
+    if pattern_name == "saw_ascending" || pattern_name == "saw_mixed" {
+        bench_powersort_parallel_scaling(
+            c,
+            test_len,
+            transform_name,
+            transform,
+            pattern_name,
+            pattern_provider,
+        );
+    }
+
+    #[cfg(feature = "cpp_wikisort")]
+    bench_inst!(stable::cpp_wikisort);
+
+    #[cfg(feature = "cpp_wikisort")]
+    if pattern_name == "random" && matches!(transform_name, "i32" | "u64" | "f128" | "1k") {
+        bench_wikisort_cache_modes(
+            c,
+            test_len,
+            transform_name,
+            transform,
+            pattern_name,
+            pattern_provider,
+        );
+    }
+
+    #[cfg(feature = "cpp_wikisort")]
+    if matches!(transform_name, "f128" | "1k") {
+        use stable::cpp_wikisort::{self, MergeMode};
+
+        bench_merge_modes(
+            c,
+            test_len,
+            transform_name,
+            transform,
+            pattern_name,
+            pattern_provider,
+            "cpp_wikisort_stable",
+            [
+                ("prefetch", MergeMode::Prefetch),
+                ("blockwise", MergeMode::Blockwise),
+            ],
+            cpp_wikisort::sort_merge_mode::<T>,
+        );
+    }
+
+    #[cfg(feature = "c_fluxsort")]
+    bench_inst!(stable::c_fluxsort);
+
+    // Only i32 and u64 are supported.
+    #[cfg(feature = "c_fluxsort")]
+    if matches!(transform_name, "i32" | "u64") {
+        bench_inst!(stable::c_fluxsort_parallel);
+    }
+
+    // Only i32 and u64 keys are supported.
+    #[cfg(feature = "cpp_vqsort")]
+    if matches!(transform_name, "i32" | "u64") {
+        bench_inst!(stable::cpp_vqsort_stable);
+    }
+
+    #[cfg(feature = "golang_std")]
+    bench_inst!(stable::golang_std);
+
+    // 1k is not supported.
+    #[cfg(feature = "golang_std")]
+    if transform_name != "1k" {
+        bench_inst!(stable::golang_std_parallel);
+    }
+
+    #[cfg(feature = "rust_wpwoodjr")]
+    bench_inst!(stable::rust_wpwoodjr);
+
+    #[cfg(feature = "rust_glidesort")]
+    bench_inst!(stable::rust_glidesort);
+
+    // #[cfg(feature = "rust_driftsort")]
+    // bench_inst!(stable::rust_driftsort);
+
+    #[cfg(feature = "rust_tinysort")]
+    bench_inst!(stable::rust_tinysort);
+
+    #[cfg(feature = "rust_grailsort")]
+    bench_inst!(stable::rust_grailsort);
+
+    // --- Unstable sorts ---
+
+    bench_inst!(unstable::rust_ipnsort);
+
+    // Same as rust_ipnsort, except that the comparison closure rules out the SIMD sorting networks
+    // in the small-sort, to show their effect on the total sort time.
+    if transform_name == "i32" || transform_name == "u64" {
+        util::bench_fn(
+            c,
+            test_len,
+            transform_name,
+            transform,
+            pattern_name,
+            pattern_provider,
+            "rust_ipnsort_scalar_small_sort",
+            |v: &mut [T]| <unstable::rust_ipnsort::SortImpl as Sort>::sort_by(v, |a, b| a.cmp(b)),
+        );
+    }
+
+    #[cfg(feature = "rust_ipnsort_parallel")]
+    bench_inst!(unstable::rust_ipnsort_parallel);
+
+    bench_inst!(unstable::rust_std);
+
+    #[cfg(feature = "rust_dmsort")]
+    bench_inst!(unstable::rust_dmsort);
+
+    #[cfg(feature = "rust_crumsort_rs")]
+    bench_inst!(unstable::rust_crumsort_rs);
+
+    #[cfg(feature = "rust_tinysort")]
+    bench_inst!(unstable::rust_tinysort);
+
+    #[cfg(feature = "rust_introsort")]
+    bench_inst!(unstable::rust_introsort);
+
+    #[cfg(feature = "cpp_pdqsort")]
+    bench_inst!(unstable::cpp_pdqsort);
+
+    #[cfg(feature = "cpp_pdqsort")]
+    bench_inst_op_counts!(unstable::cpp_pdqsort);
+
+    #[cfg(feature = "cpp_pdqsort")]
+    bench_inst!(unstable::cpp_pdqsort_branchy);
+
+    #[cfg(feature = "cpp_pdqsort")]
+    bench_inst!(unstable::cpp_pdqsort_branchless);
+
+    #[cfg(feature = "cpp_pdqsort")]
+    bench_inst!(unstable::cpp_pdqsort_lomcyc);
+
+    #[cfg(feature = "cpp_adaptive")]
+    bench_inst!(unstable::cpp_adaptive);
+
+    #[cfg(all(feature = "cpp_ips4o", not(feature = "cpp_ips4o_timer")))]
+    bench_inst!(unstable::cpp_ips4o);
+
+    #[cfg(all(feature = "cpp_ips4o", feature = "cpp_ips4o_timer"))]
+    bench_inst_phase_times!(unstable::cpp_ips4o);
+
+    #[cfg(feature = "cpp_ips4o")]
+    bench_inst_op_counts!(unstable::cpp_ips4o);
+
+    #[cfg(feature = "cpp_ips4o")]
+    if pattern_name == "random" && (transform_name == "i32" || transform_name == "u64") {
+        bench_ips4o_sort_into(
+            c,
+            test_len,
+            transform_name,
+            transform,
+            pattern_name,
+            pattern_provider,
+        );
+    }
+
+    #[cfg(feature = "cpp_ips4o")]
+    if matches!(transform_name, "i32" | "u64" | "f128" | "1k") {
+        bench_ips4o_profiles(
+            c,
+            test_len,
+            transform_name,
+            transform,
+            pattern_name,
+            pattern_provider,
+        );
+    }
+
+    #[cfg(all(feature = "cpp_ips4o_parallel", not(feature = "cpp_ips4o_timer")))]
+    bench_inst!(unstable::cpp_ips4o_parallel);
+
+    #[cfg(all(feature = "cpp_ips4o_parallel", feature = "cpp_ips4o_timer"))]
+    bench_inst_phase_times!(unstable::cpp_ips4o_parallel);
+
+    #[cfg(feature = "cpp_ips4o_parallel")]
+    bench_inst!(unstable::cpp_ips4o_pool);
+
+    #[cfg(feature = "cpp_blockquicksort")]
+    bench_inst!(unstable::cpp_blockquicksort);
+
+    #[cfg(feature = "cpp_blockquicksort")]
+    bench_inst!(unstable::cpp_blockquicksort_simple);
+
+    #[cfg(feature = "cpp_blockquicksort")]
+    bench_inst!(unstable::cpp_blockquicksort_mo3);
+
+    #[cfg(feature = "cpp_blockquicksort")]
+    bench_inst!(unstable::cpp_blockquicksort_mosqrt);
+
+    #[cfg(feature = "cpp_blockquicksort")]
+    bench_inst!(unstable::cpp_blockquicksort_dual_pivot);
+
+    #[cfg(feature = "cpp_blockquicksort")]
+    bench_inst!(unstable::cpp_blockquicksort_mo3_check);
+
+    #[cfg(feature = "cpp_gerbens_qsort")]
+    bench_inst!(unstable::cpp_gerbens_qsort);
+
+    #[cfg(feature = "cpp_gerbens_qsort")]
+    if pattern_name == "random" && matches!(transform_name, "i32" | "u64" | "f128" | "1k") {
+        bench_gerbens_qsort_scratch_sweep(
+            c,
+            test_len,
+            transform_name,
+            transform,
+            pattern_name,
+            pattern_provider,
+        );
+    }
+
+    #[cfg(feature = "cpp_gerbens_qsort")]
+    bench_inst!(unstable::cpp_gerbens_qsort_fat);
+
+    #[cfg(feature = "cpp_nanosort")]
+    bench_inst!(unstable::cpp_nanosort);
+
+    #[cfg(feature = "cpp_nanosort")]
+    bench_inst!(unstable::cpp_nanosort_fat);
+
+    #[cfg(feature = "c_std_sys")]
+    bench_inst!(unstable::c_std_sys);
+
+    #[cfg(feature = "c_fast_qsort")]
+    bench_inst!(unstable::c_fast_qsort);
+
+    #[cfg(feature = "c_crumsort")]
+    bench_inst!(unstable::c_crumsort);
+
+    #[cfg(feature = "c_crumsort")]
+    if pattern_name == "random" && matches!(transform_name, "u64" | "f128" | "1k") {
+        bench_crumsort_swap_sweep(
+            c,
+            test_len,
+            transform_name,
+            transform,
+            pattern_name,
+            pattern_provider,
+        );
+    }
+
+    #[cfg(feature = "cpp_std_sys")]
+    bench_inst!(unstable::cpp_std_sys);
+
+    #[cfg(feature = "cpp_std_sys")]
+    bench_inst_op_counts!(unstable::cpp_std_sys);
+
+    #[cfg(feature = "cpp_std_libcxx")]
+    bench_inst!(unstable::cpp_std_libcxx);
+
+    #[cfg(feature = "cpp_std_libcxx")]
+    bench_inst_op_counts!(unstable::cpp_std_libcxx);
+
+    #[cfg(feature = "cpp_std_gcc4_3")]
+    bench_inst!(unstable::cpp_std_gcc4_3);
+
+    #[cfg(feature = "golang_std")]
+    bench_inst!(unstable::golang_std);
+
+    // 1k is not supported.
+    #[cfg(feature = "golang_std")]
+    if transform_name != "1k" {
+        bench_inst!(unstable::golang_std_parallel);
+    }
+
+    // --- Other sorts ---
+
+    #[cfg(feature = "rust_radsort")]
+    bench_inst!(other::rust_radsort);
+
+    #[cfg(feature = "rust_afsort")]
+    bench_inst!(other::rust_afsort);
+
+    // The x86 only SIMD sorts are skipped on other architectures, where they would measure their
+    // std::sort fallback.
+    #[cfg(all(feature = "cpp_simdsort", target_arch = "x86_64"))]
+    bench_inst!(other::cpp_simdsort);
+
+    #[cfg(feature = "cpp_vqsort")]
+    bench_inst!(other::cpp_vqsort);
+
+    #[cfg(feature = "cpp_vqsort")]
+    if transform_name == "u64" {
+        bench_vqsort_key_value(c, test_len, pattern_name, pattern_provider);
+    }
+
+    #[cfg(all(feature = "cpp_intel_avx512", target_arch = "x86_64"))]
+    bench_inst!(other::cpp_intel_avx512);
+
+    #[cfg(all(feature = "cpp_intel_avx512", target_arch = "x86_64"))]
+    if transform_name == "u64" {
+        bench_intel_avx512_key_value(c, test_len, pattern_name, pattern_provider);
+    }
+
+    // Only i32 and u64 keys and FFIString are supported.
+    #[cfg(feature = "cpp_radix")]
+    if matches!(transform_name, "i32" | "u64" | "string" | "dataset_string") {
+        bench_inst!(other::cpp_radix);
+    }
+
+    #[cfg(feature = "cpp_radix")]
+    if matches!(transform_name, "string" | "dataset_string") {
+        bench_inst!(other::cpp_radix_parallel);
+    }
+
+    #[cfg(feature = "cpp_radix")]
+    if transform_name == "u64" {
+        bench_radix_payload(c, test_len, pattern_name, pattern_provider);
+    }
+
+    // Only i32 and u64 are supported. The time includes the transfers to and from the GPU.
+    #[cfg(feature = "cpp_gpu_sort")]
+    if matches!(transform_name, "i32" | "u64") {
+        bench_inst!(other::cpp_gpu_sort);
+    }
+
+    #[cfg(feature = "cpp_gpu_sort")]
+    if transform_name == "u64" {
+        bench_gpu_sort_payload(c, test_len, pattern_name, pattern_provider);
+    }
 
     #[cfg(feature = "singeli_singelisort")]
     bench_inst!(other::singeli_singelisort);
 
+    #[cfg(feature = "singeli_singelisort")]
+    bench_inst!(other::singeli_singelisort_scratch);
+
+    #[cfg(feature = "singeli_singelisort")]
+    bench_inst!(other::singeli_singelisort_tls);
+
+    #[cfg(feature = "singeli_singelisort")]
+    if transform_name == "i32" {
+        util::bench_fn(
+            c,
+            test_len,
+            transform_name,
+            transform,
+            pattern_name,
+            pattern_provider,
+            "singeli_singelisort_rhsort",
+            other::singeli_singelisort::sort_robin_hood,
+        );
+    }
+
+    #[cfg(feature = "singeli_singelisort")]
+    if matches!(transform_name, "u8" | "i16" | "u16") {
+        util::bench_fn(
+            c,
+            test_len,
+            transform_name,
+            transform,
+            pattern_name,
+            pattern_provider,
+            "singeli_singelisort_grade",
+            |keys: &mut [T]| {
+                black_box(other::singeli_singelisort::grade(keys));
+            },
+        );
+    }
+
+    #[cfg(any(
+        feature = "cpp_vqsort",
+        feature = "cpp_intel_avx512",
+        feature = "singeli_singelisort"
+    ))]
+    if transform_name == "u64" {
+        bench_packed_records(c, test_len, pattern_name, pattern_provider);
+    }
+
+    // --- Descending sorts ---
+
+    #[allow(unused_macros)]
+    macro_rules! bench_descending_inst {
+        ($bench_name:expr, $sort_fn:expr) => {{
+            util::bench_fn(
+                c,
+                test_len,
+                transform_name,
+                transform,
+                pattern_name,
+                pattern_provider,
+                $bench_name,
+                $sort_fn,
+            );
+        }};
+    }
+
+    if transform_name == "i32" || transform_name == "u64" {
+        #[cfg(feature = "cpp_vqsort")]
+        bench_descending_inst!("cpp_vqsort_desc", other::cpp_vqsort::sort_descending::<T>);
+
+        #[cfg(all(feature = "cpp_intel_avx512", target_arch = "x86_64"))]
+        bench_descending_inst!(
+            "cpp_intel_avx512_desc",
+            other::cpp_intel_avx512::sort_descending::<T>
+        );
+
+        // Baseline, reversed comparator.
+        #[cfg(any(feature = "cpp_vqsort", feature = "cpp_intel_avx512"))]
+        bench_descending_inst!("rust_ipnsort_desc", |v: &mut [T]| {
+            <unstable::rust_ipnsort::SortImpl as Sort>::sort_by(v, |a, b| b.cmp(a))
+        });
+    }
+
+    // --- Indirect sorts ---
+
+    // Sort pointers to the elements and move every element into place once afterwards.
+    #[allow(unused_macros)]
+    macro_rules! bench_indirect_inst {
+        ($sort_impl_path:path) => {{
+            use $sort_impl_path::*;
+
+            util::bench_fn(
+                c,
+                test_len,
+                transform_name,
+                transform,
+                pattern_name,
+                pattern_provider,
+                &format!("{}_indirect", <SortImpl as Sort>::name()),
+                sort_indirect::<T>,
+            );
+        }};
+    }
+
+    if transform_name == "1k" {
+        #[cfg(feature = "cpp_std_sys")]
+        bench_indirect_inst!(stable::cpp_std_sys);
+
+        #[cfg(feature = "cpp_std_sys")]
+        bench_indirect_inst!(unstable::cpp_std_sys);
+
+        #[cfg(feature = "cpp_std_libcxx")]
+        bench_indirect_inst!(stable::cpp_std_libcxx);
+
+        #[cfg(feature = "cpp_std_libcxx")]
+        bench_indirect_inst!(unstable::cpp_std_libcxx);
+
+        #[cfg(feature = "cpp_pdqsort")]
+        bench_indirect_inst!(unstable::cpp_pdqsort);
+
+        #[cfg(feature = "cpp_ips4o")]
+        bench_indirect_inst!(unstable::cpp_ips4o);
+
+        #[cfg(feature = "cpp_powersort")]
+        bench_indirect_inst!(stable::cpp_powersort);
+
+        #[cfg(feature = "c_fluxsort")]
+        bench_indirect_inst!(stable::c_fluxsort);
+    }
+
+    // --- Decorated sorts ---
+
+    // Compute every key once and sort the keys together with the element indices, compare with
+    // the comparison sorts above.
+    #[allow(unused_macros)]
+    macro_rules! bench_decorated_inst {
+        ($sort_impl_path:path) => {{
+            use $sort_impl_path::*;
+
+            util::bench_fn(
+                c,
+                test_len,
+                transform_name,
+                transform,
+                pattern_name,
+                pattern_provider,
+                &format!("{}_decorated", <SortImpl as Sort>::name()),
+                sort_decorated::<T>,
+            );
+        }};
+    }
+
+    if transform_name == "f128" || transform_name == "1k" {
+        #[cfg(feature = "cpp_radix")]
+        bench_decorated_inst!(other::cpp_radix);
+
+        #[cfg(feature = "cpp_vqsort")]
+        bench_decorated_inst!(other::cpp_vqsort);
+    }
+
+    // --- Sorts with comparison function ---
+
+    // Goes through the `_by` FFI entry points, which call back into Rust for every comparison.
+    // cpp_powersort_4way still passes the comparison function via thread locals, the others
+    // carry it in the comparator.
+    #[allow(unused_macros)]
+    macro_rules! bench_by_inst {
+        ($sort_impl_path:path) => {{
+            use $sort_impl_path::*;
+
+            util::bench_fn(
+                c,
+                test_len,
+                transform_name,
+                transform,
+                pattern_name,
+                pattern_provider,
+                &format!("{}_by", <SortImpl as Sort>::name()),
+                |v: &mut [T]| <SortImpl as Sort>::sort_by(v, |a, b| a.cmp(b)),
+            );
+        }};
+    }
+
+    #[cfg(feature = "cpp_std_sys")]
+    bench_by_inst!(unstable::cpp_std_sys);
+
+    #[cfg(feature = "cpp_pdqsort")]
+    bench_by_inst!(unstable::cpp_pdqsort);
+
+    #[cfg(feature = "cpp_powersort")]
+    bench_by_inst!(stable::cpp_powersort);
+
+    #[cfg(feature = "cpp_powersort")]
+    bench_by_inst!(stable::cpp_powersort_4way);
+
+    #[cfg(feature = "cpp_blockquicksort")]
+    bench_by_inst!(unstable::cpp_blockquicksort);
+
+    #[cfg(feature = "c_std_sys")]
+    bench_by_inst!(unstable::c_std_sys);
+
+    #[cfg(feature = "c_fast_qsort")]
+    bench_by_inst!(unstable::c_fast_qsort);
+
+    // --- Sorts by known key ---
+
+    // Goes through the `_by_key` FFI entry points, which compare the integer key described by a
+    // KeyDescriptor inline. Compare with the `_by` benchmarks of the same sort, which call back
+    // into Rust for every comparison. The whole value is the key.
+    #[allow(unused_macros)]
+    macro_rules! bench_by_known_key_inst {
+        ($sort_impl_path:path) => {{
+            use $sort_impl_path::*;
+
+            let key = KeyDescriptor::new(
+                0,
+                std::mem::size_of::<T>() as u8,
+                transform_name == "i32",
+                false,
+            );
+
+            util::bench_fn(
+                c,
+                test_len,
+                transform_name,
+                transform,
+                pattern_name,
+                pattern_provider,
+                &format!("{}_by_known_key", <SortImpl as Sort>::name()),
+                |v: &mut [T]| sort_by_known_key(v, key),
+            );
+        }};
+    }
+
+    if matches!(transform_name, "i32" | "u64") {
+        #[cfg(feature = "cpp_std_sys")]
+        bench_by_known_key_inst!(stable::cpp_std_sys);
+
+        #[cfg(feature = "cpp_std_sys")]
+        bench_by_known_key_inst!(unstable::cpp_std_sys);
+
+        #[cfg(feature = "cpp_pdqsort")]
+        bench_by_known_key_inst!(unstable::cpp_pdqsort);
+
+        #[cfg(feature = "cpp_ips4o")]
+        bench_by_known_key_inst!(unstable::cpp_ips4o);
+
+        // The `_by` counterparts not covered above.
+        #[cfg(feature = "cpp_std_sys")]
+        bench_by_inst!(stable::cpp_std_sys);
+
+        #[cfg(feature = "cpp_ips4o")]
+        bench_by_inst!(unstable::cpp_ips4o);
+    }
+
+    // The `_by` entry points of both panic modes, throwing out of the comparator and the sticky
+    // flag of `sort_by_nothrow`.
+    #[allow(unused_macros)]
+    macro_rules! bench_by_nothrow_inst {
+        ($sort_impl_path:path) => {{
+            use $sort_impl_path::*;
+
+            bench_by_inst!($sort_impl_path);
+
+            util::bench_fn(
+                c,
+                test_len,
+                transform_name,
+                transform,
+                pattern_name,
+                pattern_provider,
+                &format!("{}_by_nothrow", <SortImpl as Sort>::name()),
+                |v: &mut [T]| sort_by_nothrow(v, |a, b| a.cmp(b)),
+            );
+        }};
+    }
+
+    #[cfg(feature = "cpp_nanosort")]
+    bench_by_nothrow_inst!(unstable::cpp_nanosort);
+
+    #[cfg(feature = "cpp_gerbens_qsort")]
+    bench_by_nothrow_inst!(unstable::cpp_gerbens_qsort);
+
     #[cfg(feature = "evolution")]
     {
         bench_inst!(other::sort_evolution::stable::timsort_evo0);
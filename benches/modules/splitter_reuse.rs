@@ -0,0 +1,136 @@
+//! ips4o with the top level splitters kept across sorts, see unstable::cpp_ips4o_splitters, against
+//! plain ips4o, enabled with `BENCH_OTHER=splitter_reuse`. Every iteration sorts a fresh input of
+//! the same pattern, so the kept splitters come from an earlier input, like for batches of the same
+//! distribution arriving one after another. The splitters are primed with one sort before
+//! measuring. Only i32 and u64, from 100k elements on, below that ips4o partitions at most once.
+
+use criterion::{black_box, BatchSize, Criterion};
+
+#[allow(unused_imports)]
+use sort_research_rs::unstable;
+
+use crate::modules::util::{pin_thread_to_core, should_run_benchmark};
+
+const MIN_LEN: usize = 100_000;
+
+#[allow(unused)]
+pub fn bench<T: Ord + std::fmt::Debug>(
+    c: &mut Criterion,
+    test_len: usize,
+    transform_name: &str,
+    transform: &fn(Vec<i32>) -> Vec<T>,
+    pattern_name: &str,
+    pattern_provider: &fn(usize) -> Vec<i32>,
+) {
+    if test_len < MIN_LEN {
+        return;
+    }
+
+    match transform_name {
+        "i32" => bench_type(c, test_len, "i32", pattern_name, || {
+            pattern_provider(test_len)
+        }),
+        "u64" => bench_type(c, test_len, "u64", pattern_name, || {
+            pattern_provider(test_len)
+                .into_iter()
+                .map(|val| val as u64)
+                .collect()
+        }),
+        _ => {}
+    }
+}
+
+#[allow(unused)]
+fn bench_type<T: unstable::cpp_ips4o_splitters::SplitterElem + Ord>(
+    c: &mut Criterion,
+    test_len: usize,
+    transform_name: &str,
+    pattern_name: &str,
+    make_input: impl Fn() -> Vec<T>,
+) {
+    use unstable::cpp_ips4o_splitters::Ips4oSplitters;
+
+    #[cfg(feature = "cpp_ips4o")]
+    {
+        // Pin the benchmark to the same core to improve repeatability.
+        pin_thread_to_core();
+
+        let group_name = format!("splitter_reuse-hot-{transform_name}-{pattern_name}-{test_len}");
+        let mut group = c.benchmark_group(&group_name);
+
+        if should_run_benchmark(&format!("{group_name}/cpp_ips4o_unstable")) {
+            group.bench_function("cpp_ips4o_unstable", |b| {
+                b.iter_batched_ref(
+                    &make_input,
+                    |test_data| {
+                        unstable::cpp_ips4o::sort(black_box(test_data.as_mut_slice()));
+                        black_box(test_data); // side-effect
+                    },
+                    BatchSize::LargeInput,
+                )
+            });
+        }
+
+        if should_run_benchmark(&format!("{group_name}/cpp_ips4o_splitters_unstable")) {
+            let mut splitters = Ips4oSplitters::new();
+            splitters.sort(&mut make_input());
+
+            group.bench_function("cpp_ips4o_splitters_unstable", |b| {
+                b.iter_batched_ref(
+                    &make_input,
+                    |test_data| {
+                        splitters.sort(black_box(test_data.as_mut_slice()));
+                        black_box(test_data); // side-effect
+                    },
+                    BatchSize::LargeInput,
+                )
+            });
+
+            println!("{group_name}: {:?}", splitters.stats());
+        }
+
+        group.finish();
+    }
+
+    #[cfg(feature = "cpp_ips4o_parallel")]
+    {
+        let group_name =
+            format!("splitter_reuse_parallel-hot-{transform_name}-{pattern_name}-{test_len}");
+        let mut group = c.benchmark_group(&group_name);
+
+        if should_run_benchmark(&format!("{group_name}/cpp_ips4o_parallel_unstable")) {
+            group.bench_function("cpp_ips4o_parallel_unstable", |b| {
+                b.iter_batched_ref(
+                    &make_input,
+                    |test_data| {
+                        unstable::cpp_ips4o_parallel::sort(black_box(test_data.as_mut_slice()));
+                        black_box(test_data); // side-effect
+                    },
+                    BatchSize::LargeInput,
+                )
+            });
+        }
+
+        if should_run_benchmark(&format!(
+            "{group_name}/cpp_ips4o_splitters_parallel_unstable"
+        )) {
+            let mut splitters = Ips4oSplitters::new();
+            splitters.sort_parallel(&mut make_input());
+
+            group.bench_function("cpp_ips4o_splitters_parallel_unstable", |b| {
+                b.iter_batched_ref(
+                    &make_input,
+                    |test_data| {
+                        splitters.sort_parallel(black_box(test_data.as_mut_slice()));
+                        black_box(test_data); // side-effect
+                    },
+                    BatchSize::LargeInput,
+                )
+            });
+
+            println!("{group_name}: {:?}", splitters.stats());
+        }
+
+        group.finish();
+    }
+}
@@ -0,0 +1,88 @@
+//! Dumps the pivot and partition telemetry of the C++ sorts, instead of measuring them. Every sort
+//! built with the SORT_TELEMETRY hooks sorts every pattern once, and its events are written to
+//! `<BENCH_TELEMETRY_DIR>/<sort>-<type>-<pattern>-<len>.txt`, by default in `telemetry`. The
+//! names are matched against `BENCH_REGEX`, and the files can be fed to
+//! util/analyze_pivot_quality.py and util/analyze_pivot_data.py.
+
+use std::env;
+use std::fs;
+use std::io::Write;
+use std::path::PathBuf;
+
+use criterion::Criterion;
+
+#[allow(unused_imports)]
+use sort_research_rs::{ffi_util::Telemetry, unstable};
+
+use crate::modules::util::should_run_benchmark;
+
+fn write_events(name: &str, telemetry: Telemetry) {
+    let dir = env::var("BENCH_TELEMETRY_DIR")
+        .map(PathBuf::from)
+        .unwrap_or_else(|_| PathBuf::from("telemetry"));
+    fs::create_dir_all(&dir).expect("Failed to create the telemetry dir");
+
+    let file = fs::File::create(dir.join(format!("{name}.txt")))
+        .expect("Failed to create the telemetry file");
+    let mut file = std::io::BufWriter::new(file);
+
+    if telemetry.dropped != 0 {
+        writeln!(file, "dropped: {}", telemetry.dropped).unwrap();
+    }
+    for event in &telemetry.events {
+        writeln!(file, "{event}").unwrap();
+    }
+}
+
+pub fn bench<T: Ord + std::fmt::Debug>(
+    _c: &mut Criterion,
+    test_len: usize,
+    transform_name: &str,
+    transform: &fn(Vec<i32>) -> Vec<T>,
+    pattern_name: &str,
+    pattern_provider: &fn(usize) -> Vec<i32>,
+) {
+    // All sorts get the same input, also for the random patterns.
+    let input = pattern_provider(test_len);
+
+    #[allow(unused)]
+    let dump = |sort_name: &str, sort: fn(&mut [T]), reset: fn(), telemetry: fn() -> Telemetry| {
+        let name = format!("{sort_name}-{transform_name}-{pattern_name}-{test_len}");
+        if !should_run_benchmark(&name) {
+            return;
+        }
+
+        let mut v = transform(input.clone());
+        reset();
+        sort(&mut v);
+        write_events(&name, telemetry());
+    };
+
+    macro_rules! dump_sort {
+        ($sort_impl_path:path) => {{
+            use $sort_impl_path::*;
+
+            dump(
+                &<SortImpl as sort_test_tools::Sort>::name(),
+                sort,
+                reset_telemetry,
+                telemetry,
+            );
+        }};
+    }
+
+    #[cfg(feature = "cpp_pdqsort")]
+    dump_sort!(unstable::cpp_pdqsort);
+
+    #[cfg(feature = "cpp_blockquicksort")]
+    dump_sort!(unstable::cpp_blockquicksort);
+
+    #[cfg(feature = "c_crumsort")]
+    dump_sort!(unstable::c_crumsort);
+
+    #[cfg(feature = "cpp_ips4o")]
+    dump_sort!(unstable::cpp_ips4o);
+
+    #[cfg(feature = "cpp_ips4o_parallel")]
+    dump_sort!(unstable::cpp_ips4o_parallel);
+}
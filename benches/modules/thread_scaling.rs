@@ -0,0 +1,230 @@
+//! Thread count sweep for the parallel implementations, 1, 2, 4, ... up to all cores, once with
+//! one thread per physical core and once filling up the SMT siblings of each core first.
+//!
+//! The parallel sorts spawn their workers per call, and on Linux new threads inherit the affinity
+//! of the bench thread. So restricting the bench thread to the first N CPUs of the respective
+//! order pins the workers of a call with N threads.
+//!
+//! Results are named `<sort>_t<N>` and `<sort>_t<N>_smt`, graph_bench_result/thread_scaling.py
+//! derives speedup and parallel efficiency from them.
+
+#[allow(unused_imports)]
+use sort_test_tools::Sort;
+
+#[allow(unused_imports)]
+use sort_research_rs::{other, stable, unstable};
+
+use criterion::Criterion;
+
+#[allow(unused_imports)]
+use crate::modules::util;
+
+#[cfg(target_os = "linux")]
+mod sys {
+    use std::fs;
+    use std::os::raw::c_int;
+
+    // Large enough for 1024 CPUs, same as glibc's cpu_set_t.
+    const CPU_SET_WORDS: usize = 16;
+
+    extern "C" {
+        fn sched_getaffinity(pid: c_int, cpusetsize: usize, mask: *mut u64) -> c_int;
+        fn sched_setaffinity(pid: c_int, cpusetsize: usize, mask: *const u64) -> c_int;
+    }
+
+    // Parses sysfs CPU lists such as "0-3,8-11".
+    fn read_cpu_list(path: &str) -> Option<Vec<usize>> {
+        let content = fs::read_to_string(path).ok()?;
+        let mut cpus = Vec::new();
+
+        for range in content.trim().split(',').filter(|range| !range.is_empty()) {
+            let (first, last) = range.split_once('-').unwrap_or((range, range));
+            cpus.extend(first.parse::<usize>().ok()?..=last.parse::<usize>().ok()?);
+        }
+
+        Some(cpus)
+    }
+
+    /// The SMT siblings of every physical core, ordered by their lowest CPU id.
+    pub fn physical_cores() -> Option<Vec<Vec<usize>>> {
+        let mut cores: Vec<Vec<usize>> = Vec::new();
+
+        for cpu in read_cpu_list("/sys/devices/system/cpu/online")? {
+            let siblings = read_cpu_list(&format!(
+                "/sys/devices/system/cpu/cpu{cpu}/topology/thread_siblings_list"
+            ))
+            .unwrap_or_else(|| vec![cpu]);
+
+            if !cores.contains(&siblings) {
+                cores.push(siblings);
+            }
+        }
+
+        cores.sort_by_key(|siblings| siblings.iter().min().copied());
+        (!cores.is_empty()).then_some(cores)
+    }
+
+    pub type Affinity = [u64; CPU_SET_WORDS];
+
+    pub fn get_affinity() -> Option<Affinity> {
+        let mut mask = [0u64; CPU_SET_WORDS];
+        // SAFETY: mask is a writable buffer of the given size, pid 0 is the calling thread.
+        let ret = unsafe { sched_getaffinity(0, std::mem::size_of_val(&mask), mask.as_mut_ptr()) };
+        (ret == 0).then_some(mask)
+    }
+
+    pub fn set_affinity(mask: &Affinity) {
+        // SAFETY: mask is a readable buffer of the given size, pid 0 is the calling thread.
+        unsafe {
+            sched_setaffinity(0, std::mem::size_of_val(mask), mask.as_ptr());
+        }
+    }
+
+    pub fn affinity_of(cpus: &[usize]) -> Affinity {
+        let mut mask = [0u64; CPU_SET_WORDS];
+        for &cpu in cpus.iter().filter(|&&cpu| cpu < CPU_SET_WORDS * 64) {
+            mask[cpu / 64] |= 1 << (cpu % 64);
+        }
+        mask
+    }
+}
+
+#[cfg(not(target_os = "linux"))]
+mod sys {
+    pub fn physical_cores() -> Option<Vec<Vec<usize>>> {
+        None
+    }
+
+    pub type Affinity = ();
+
+    pub fn get_affinity() -> Option<Affinity> {
+        None
+    }
+
+    pub fn set_affinity(_mask: &Affinity) {}
+
+    pub fn affinity_of(_cpus: &[usize]) -> Affinity {}
+}
+
+/// CPU orders to sweep through, with the name suffix of their results. Without topology
+/// information the CPU ids are assumed to be 0..N.
+#[allow(unused)]
+fn cpu_orders() -> Vec<(&'static str, Vec<usize>)> {
+    let Some(cores) = sys::physical_cores() else {
+        let num_cpus = std::thread::available_parallelism().map_or(1, |val| val.get());
+        return vec![("", (0..num_cpus).collect())];
+    };
+
+    let mut orders = vec![("", cores.iter().map(|siblings| siblings[0]).collect())];
+
+    if cores.iter().any(|siblings| siblings.len() > 1) {
+        orders.push(("_smt", cores.concat()));
+    }
+
+    orders
+}
+
+/// 1, 2, 4, ... and the maximum itself if it's not a power of two.
+#[allow(unused)]
+fn thread_counts(max_threads: usize) -> Vec<usize> {
+    let mut counts = std::iter::successors(Some(1usize), |n| n.checked_mul(2))
+        .take_while(|&n| n < max_threads)
+        .collect::<Vec<_>>();
+    counts.push(max_threads.max(1));
+    counts
+}
+
+#[allow(unused)]
+fn bench_sweep<T: Ord + std::fmt::Debug>(
+    c: &mut Criterion,
+    test_len: usize,
+    transform_name: &str,
+    transform: &fn(Vec<i32>) -> Vec<T>,
+    pattern_name: &str,
+    pattern_provider: &fn(usize) -> Vec<i32>,
+    sort_name: &str,
+    sort_fn: fn(&mut [T]),
+) {
+    use sort_research_rs::ffi_util;
+
+    // Pins the bench thread once up-front, later calls to util::bench_fn leave the affinity set
+    // below alone.
+    util::pin_thread_to_core();
+
+    let saved_affinity = sys::get_affinity();
+    let default_threads = ffi_util::num_threads();
+
+    for (suffix, cpus) in cpu_orders() {
+        for num_threads in thread_counts(cpus.len()) {
+            sys::set_affinity(&sys::affinity_of(&cpus[..num_threads]));
+            ffi_util::set_num_threads(num_threads);
+
+            util::bench_fn(
+                c,
+                test_len,
+                transform_name,
+                transform,
+                pattern_name,
+                pattern_provider,
+                &format!("{sort_name}_t{num_threads}{suffix}"),
+                sort_fn,
+            );
+        }
+    }
+
+    ffi_util::set_num_threads(default_threads);
+    if let Some(mask) = saved_affinity {
+        sys::set_affinity(&mask);
+    }
+}
+
+#[allow(unused)]
+pub fn bench<T: Ord + std::fmt::Debug>(
+    c: &mut Criterion,
+    test_len: usize,
+    transform_name: &str,
+    transform: &fn(Vec<i32>) -> Vec<T>,
+    pattern_name: &str,
+    pattern_provider: &fn(usize) -> Vec<i32>,
+) {
+    macro_rules! bench_inst {
+        ($sort_impl_path:path) => {{
+            use $sort_impl_path::*;
+
+            bench_sweep(
+                c,
+                test_len,
+                transform_name,
+                transform,
+                pattern_name,
+                pattern_provider,
+                &<SortImpl as Sort>::name(),
+                <SortImpl as Sort>::sort::<T>,
+            );
+        }};
+    }
+
+    #[cfg(feature = "cpp_powersort_parallel")]
+    bench_inst!(stable::cpp_powersort_parallel);
+
+    // TBB keeps its workers around between calls, so they keep the affinity of the sweep step that
+    // created them, and are not pinned as tightly as the sorts that spawn threads per call.
+    #[cfg(feature = "c_fluxsort")]
+    if matches!(transform_name, "i32" | "u64") {
+        bench_inst!(stable::c_fluxsort_parallel);
+    }
+
+    #[cfg(feature = "cpp_std_sys_parallel")]
+    bench_inst!(stable::cpp_std_sys_parallel);
+
+    #[cfg(feature = "cpp_radix")]
+    if matches!(transform_name, "string" | "dataset_string") {
+        bench_inst!(other::cpp_radix_parallel);
+    }
+
+    #[cfg(feature = "cpp_ips4o_parallel")]
+    bench_inst!(unstable::cpp_ips4o_parallel);
+
+    #[cfg(feature = "rust_ipnsort_parallel")]
+    bench_inst!(unstable::rust_ipnsort_parallel);
+}
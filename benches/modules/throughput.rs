@@ -0,0 +1,125 @@
+//! Runs the same sort on several pinned threads at once, each with its own inputs, to expose
+//! memory bandwidth and shared cache contention that single threaded benchmarks hide.
+
+use std::env;
+use std::sync::Barrier;
+use std::time::{Duration, Instant};
+
+use criterion::{black_box, Criterion};
+
+use once_cell::sync::OnceCell;
+
+use crate::modules::util::should_run_benchmark;
+
+/// Number of concurrent sorts, set via BENCH_THROUGHPUT_THREADS. `all` uses one thread per core.
+pub fn num_threads() -> Option<usize> {
+    static NUM_THREADS: OnceCell<Option<usize>> = OnceCell::new();
+
+    *NUM_THREADS.get_or_init(|| {
+        env::var("BENCH_THROUGHPUT_THREADS").ok().map(|val| {
+            if val == "all" {
+                core_affinity::get_core_ids().map_or(1, |ids| ids.len())
+            } else {
+                val.parse()
+                    .expect("BENCH_THROUGHPUT_THREADS must be a number or 'all'")
+            }
+        })
+    })
+}
+
+// Every thread sorts at least this many elements between two synchronization points, so that
+// the barriers don't dominate short inputs.
+const MIN_ELEMS_PER_ROUND: usize = 65_536;
+
+#[inline(never)]
+pub fn bench_fn<T: Ord + std::fmt::Debug>(
+    c: &mut Criterion,
+    num_threads: usize,
+    test_len: usize,
+    transform_name: &str,
+    transform: &fn(Vec<i32>) -> Vec<T>,
+    pattern_name: &str,
+    pattern_provider: &(impl Fn(usize) -> Vec<i32> + Sync),
+    bench_name: &str,
+    test_fn: fn(&mut [T]),
+) {
+    let bench_name = format!(
+        "{bench_name}-throughput_t{num_threads}-{transform_name}-{pattern_name}-{test_len}"
+    );
+
+    if !should_run_benchmark(&bench_name) {
+        return;
+    }
+
+    let core_ids = core_affinity::get_core_ids().unwrap_or_default();
+    let sorts_per_round = (MIN_ELEMS_PER_ROUND / test_len.max(1)).max(1);
+
+    // Reported time is that of one set of num_threads concurrent sorts.
+    let mut total_rounds = 0u64;
+    let mut total_time = Duration::ZERO;
+
+    c.bench_function(&bench_name, |b| {
+        b.iter_custom(|iters| {
+            let rounds = iters.div_ceil(sorts_per_round as u64);
+            let barrier = Barrier::new(num_threads);
+
+            let elapsed = std::thread::scope(|s| {
+                let workers = (0..num_threads)
+                    .map(|thread_idx| {
+                        let barrier = &barrier;
+                        let core_id = core_ids.get(thread_idx % core_ids.len().max(1)).copied();
+
+                        s.spawn(move || {
+                            if let Some(core_id) = core_id {
+                                core_affinity::set_for_current(core_id);
+                            }
+
+                            let mut elapsed = Duration::ZERO;
+                            for _ in 0..rounds {
+                                // The inputs are generated by every thread for itself, so they
+                                // start out in its own caches and local memory.
+                                let mut inputs = (0..sorts_per_round)
+                                    .map(|_| transform(pattern_provider(test_len)))
+                                    .collect::<Vec<_>>();
+
+                                barrier.wait();
+                                let start = Instant::now();
+
+                                for input in inputs.iter_mut() {
+                                    test_fn(black_box(input.as_mut_slice()));
+                                }
+
+                                barrier.wait();
+                                elapsed += start.elapsed();
+
+                                black_box(inputs); // side-effect
+                            }
+
+                            elapsed
+                        })
+                    })
+                    .collect::<Vec<_>>();
+
+                // All threads leave the second barrier at about the same time, so their views
+                // only differ by the wake up latency.
+                workers
+                    .into_iter()
+                    .map(|worker| worker.join().unwrap())
+                    .max()
+                    .unwrap()
+            });
+
+            total_rounds += rounds;
+            total_time += elapsed;
+
+            elapsed.mul_f64(iters as f64 / (rounds * sorts_per_round as u64) as f64)
+        })
+    });
+
+    let elems_per_round = (num_threads * sorts_per_round * test_len) as f64;
+    let elems_per_sec = (total_rounds as f64 * elems_per_round) / total_time.as_secs_f64();
+    println!(
+        "{bench_name}: aggregate {:.3} Melem/s",
+        elems_per_sec / 1_000_000.0
+    );
+}
@@ -0,0 +1,337 @@
+//! Cycles per sort for inputs of 2 to 32 elements, enabled with `BENCH_OTHER=tiny`. At these
+//! lengths a sort takes some tens of nanoseconds, about as long as the per-iteration overhead of
+//! criterion and the batch setup of `iter_batched_ref`. Instead every sample here times a batch of
+//! thousands of independent inputs laid out back to back, between fenced reads of the TSC, and
+//! subtracts the time of the same loop with a sort that does nothing. The batch is refilled with a
+//! bitwise copy of its pristine inputs outside of the measured region, like in input_cache.rs.
+//!
+//! The result goes to criterion as the time of a single sort, named
+//! `<sort>-tiny-<type>-<pattern>-<len>`, and the median TSC ticks per sort are printed. With
+//! `TINY_CYCLES=<path>` they are also appended to <path> as one JSON object per line, which
+//! run_benchmarks.py merges into its results. TSC ticks are reference cycles, they only match core
+//! cycles with a fixed frequency, see the frequency settings warned about by run_benchmarks.py.
+//! Other targets than x86-64 use `Instant`, and report nanoseconds.
+
+use std::env;
+use std::ptr;
+use std::time::{Duration, Instant};
+
+use criterion::{black_box, Criterion};
+
+use once_cell::sync::OnceCell;
+
+#[allow(unused_imports)]
+use sort_research_rs::{other, stable, unstable};
+
+use sort_test_tools::Sort;
+
+use crate::modules::util::{pin_thread_to_core, should_run_benchmark};
+
+pub const MAX_LEN: usize = 32;
+
+// The median of this many batches of the empty loop is subtracted from every batch.
+const BASELINE_SAMPLES: usize = 101;
+
+// Batches for the printed cycles, after the criterion measurement.
+const CYCLES_SAMPLES: usize = 201;
+
+#[cfg(target_arch = "x86_64")]
+mod tsc {
+    use std::arch::x86_64::{__rdtscp, _mm_lfence, _rdtsc};
+
+    // The fences keep earlier instructions from finishing after the read, and the measured ones
+    // from starting before it.
+    #[inline(always)]
+    pub fn start() -> u64 {
+        // SAFETY: rdtsc and lfence are part of x86-64.
+        unsafe {
+            _mm_lfence();
+            let ticks = _rdtsc();
+            _mm_lfence();
+            ticks
+        }
+    }
+
+    // rdtscp waits for all earlier instructions, the fence keeps later ones from starting early.
+    #[inline(always)]
+    pub fn stop() -> u64 {
+        let mut aux = 0;
+        // SAFETY: rdtscp is available on every x86-64 CPU with an invariant TSC.
+        unsafe {
+            let ticks = __rdtscp(&mut aux);
+            _mm_lfence();
+            ticks
+        }
+    }
+}
+
+#[cfg(not(target_arch = "x86_64"))]
+mod tsc {
+    use std::time::Instant;
+
+    use once_cell::sync::OnceCell;
+
+    fn now() -> u64 {
+        static EPOCH: OnceCell<Instant> = OnceCell::new();
+        EPOCH.get_or_init(Instant::now).elapsed().as_nanos() as u64
+    }
+
+    #[inline(always)]
+    pub fn start() -> u64 {
+        now()
+    }
+
+    #[inline(always)]
+    pub fn stop() -> u64 {
+        now()
+    }
+}
+
+fn ticks_per_ns() -> f64 {
+    static TICKS_PER_NS: OnceCell<f64> = OnceCell::new();
+
+    *TICKS_PER_NS.get_or_init(|| {
+        let start_time = Instant::now();
+        let start = tsc::start();
+        while start_time.elapsed() < Duration::from_millis(100) {}
+        let end = tsc::stop();
+        let elapsed = start_time.elapsed();
+
+        (end - start) as f64 / elapsed.as_nanos() as f64
+    })
+}
+
+fn tiny_cycles_path() -> Option<&'static str> {
+    static TINY_CYCLES_PATH: OnceCell<Option<String>> = OnceCell::new();
+
+    TINY_CYCLES_PATH
+        .get_or_init(|| env::var("TINY_CYCLES").ok().filter(|path| !path.is_empty()))
+        .as_deref()
+}
+
+// Inputs per batch, as many as fit into 256KiB so that the batch stays in L2, but at least 1024
+// so that the fences and the loop are spread over enough sorts.
+fn inputs_per_batch<T>() -> usize {
+    ((256 * 1024) / (MAX_LEN * std::mem::size_of::<T>()).max(1)).clamp(1024, 4096)
+}
+
+struct Batch<T> {
+    test_len: usize,
+    pristine: Vec<T>,
+    // Bitwise copy of pristine, see Drop.
+    work: Vec<T>,
+}
+
+impl<T> Batch<T> {
+    fn new(
+        test_len: usize,
+        transform: &fn(Vec<i32>) -> Vec<T>,
+        pattern_provider: &fn(usize) -> Vec<i32>,
+    ) -> Self {
+        let count = inputs_per_batch::<T>();
+        let mut pristine = Vec::with_capacity(count * test_len);
+        for _ in 0..count {
+            pristine.extend(transform(pattern_provider(test_len)));
+        }
+
+        Self {
+            test_len,
+            work: Vec::with_capacity(pristine.len()),
+            pristine,
+        }
+    }
+
+    fn count(&self) -> usize {
+        self.pristine.len() / self.test_len
+    }
+
+    fn refill(&mut self) {
+        // SAFETY: The copies are forgotten before the next refill or drop, so every value is only
+        // ever dropped through pristine. A sort only permutes the values of its input.
+        unsafe {
+            self.work.set_len(0);
+            ptr::copy_nonoverlapping(
+                self.pristine.as_ptr(),
+                self.work.as_mut_ptr(),
+                self.pristine.len(),
+            );
+            self.work.set_len(self.pristine.len());
+        }
+    }
+
+    // TSC ticks for sorting every input of the batch once.
+    #[inline(never)]
+    fn time(&mut self, sort: fn(&mut [T])) -> u64 {
+        self.refill();
+        // Called through the pointer, like the empty baseline.
+        let sort = black_box(sort);
+
+        let start = tsc::start();
+        for input in self.work.chunks_exact_mut(self.test_len) {
+            sort(black_box(input));
+        }
+        let end = tsc::stop();
+
+        black_box(&mut self.work); // side-effect
+        end - start
+    }
+
+    fn median_ticks(&mut self, sort: fn(&mut [T]), samples: usize) -> u64 {
+        let mut ticks = (0..samples).map(|_| self.time(sort)).collect::<Vec<_>>();
+        ticks.sort_unstable();
+        ticks[ticks.len() / 2]
+    }
+}
+
+impl<T> Drop for Batch<T> {
+    fn drop(&mut self) {
+        // SAFETY: See refill, also covers a panicking sort.
+        unsafe { self.work.set_len(0) };
+    }
+}
+
+#[inline(never)]
+fn empty_sort<T>(v: &mut [T]) {
+    black_box(v);
+}
+
+#[allow(unused)]
+pub fn bench<T: Ord + std::fmt::Debug>(
+    c: &mut Criterion,
+    test_len: usize,
+    transform_name: &str,
+    transform: &fn(Vec<i32>) -> Vec<T>,
+    pattern_name: &str,
+    pattern_provider: &fn(usize) -> Vec<i32>,
+) {
+    if !(2..=MAX_LEN).contains(&test_len) {
+        return;
+    }
+
+    let mut sorts: Vec<(String, fn(&mut [T]))> = Vec::new();
+
+    macro_rules! add_sort {
+        ($sort_impl_path:path) => {{
+            use $sort_impl_path::*;
+
+            sorts.push((<SortImpl as Sort>::name(), <SortImpl as Sort>::sort::<T>));
+        }};
+    }
+
+    add_sort!(unstable::rust_ipnsort);
+    add_sort!(stable::rust_std);
+
+    #[cfg(feature = "cpp_pdqsort")]
+    add_sort!(unstable::cpp_pdqsort);
+
+    #[cfg(feature = "cpp_blockquicksort")]
+    add_sort!(unstable::cpp_blockquicksort);
+
+    #[cfg(feature = "cpp_gerbens_qsort")]
+    add_sort!(unstable::cpp_gerbens_qsort);
+
+    #[cfg(feature = "cpp_nanosort")]
+    add_sort!(unstable::cpp_nanosort);
+
+    #[cfg(feature = "cpp_std_sys")]
+    {
+        add_sort!(unstable::cpp_std_sys);
+        add_sort!(stable::cpp_std_sys);
+    }
+
+    #[cfg(feature = "cpp_powersort")]
+    add_sort!(stable::cpp_powersort);
+
+    // The experiments only sort their own len.
+    #[cfg(feature = "small_sort")]
+    {
+        if test_len == 4 {
+            add_sort!(other::small_sort::sort4_unstable_cmp_swap);
+            add_sort!(other::small_sort::sort4_unstable_ptr_select);
+            add_sort!(other::small_sort::sort4_unstable_branchy);
+            add_sort!(other::small_sort::sort4_stable_orson);
+        }
+        if test_len == 10 {
+            add_sort!(other::small_sort::sort10_unstable_cmp_swaps);
+            add_sort!(other::small_sort::sort10_unstable_experimental);
+            add_sort!(other::small_sort::sort10_unstable_ptr_select);
+        }
+    }
+
+    let sorts = sorts
+        .into_iter()
+        .map(|(sort_name, sort)| {
+            let bench_name = format!("{sort_name}-tiny-{transform_name}-{pattern_name}-{test_len}");
+            (bench_name, sort)
+        })
+        .filter(|(bench_name, _)| should_run_benchmark(bench_name))
+        .collect::<Vec<_>>();
+
+    if sorts.is_empty() {
+        return;
+    }
+
+    // Pin the benchmark to the same core to improve repeatability.
+    pin_thread_to_core();
+
+    let ticks_per_ns = ticks_per_ns();
+    let mut batch = Batch::new(test_len, transform, pattern_provider);
+    let count = batch.count();
+    let baseline = batch.median_ticks(empty_sort::<T>, BASELINE_SAMPLES);
+
+    for (bench_name, sort) in sorts {
+        c.bench_function(&bench_name, |b| {
+            b.iter_custom(|iters| {
+                let batches = (iters as usize).div_ceil(count);
+                let ticks = (0..batches)
+                    .map(|_| batch.time(sort).saturating_sub(baseline))
+                    .sum::<u64>();
+
+                // Scaled to the requested number of sorts, the last batch is always full.
+                let ns = ticks as f64 / ticks_per_ns * iters as f64 / (batches * count) as f64;
+                Duration::from_nanos(ns as u64)
+            })
+        });
+
+        let ticks = batch.median_ticks(sort, CYCLES_SAMPLES);
+        let per_sort = ticks.saturating_sub(baseline) as f64 / count as f64;
+        let baseline_per_sort = baseline as f64 / count as f64;
+        println!(
+            "{bench_name}: {per_sort:.1} ticks per sort, {baseline_per_sort:.1} baseline, {count} inputs per batch"
+        );
+
+        if let Some(out_path) = tiny_cycles_path() {
+            write_cycles(
+                out_path,
+                &bench_name,
+                test_len,
+                count,
+                per_sort,
+                baseline_per_sort,
+            );
+        }
+    }
+}
+
+fn write_cycles(
+    out_path: &str,
+    bench_name: &str,
+    test_len: usize,
+    count: usize,
+    per_sort: f64,
+    baseline_per_sort: f64,
+) {
+    use std::io::Write;
+
+    let mut out_file = std::fs::OpenOptions::new()
+        .create(true)
+        .append(true)
+        .open(out_path)
+        .unwrap_or_else(|err| panic!("Failed to open TINY_CYCLES file {out_path}: {err}"));
+    writeln!(
+        out_file,
+        "{{\"name\": \"{bench_name}\", \"len\": {test_len}, \"cycles\": {{\"per_sort\": {per_sort}, \"baseline_per_sort\": {baseline_per_sort}, \"inputs_per_batch\": {count}, \"ticks_per_ns\": {}}}}}",
+        ticks_per_ns()
+    )
+    .unwrap();
+}
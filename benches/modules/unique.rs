@@ -0,0 +1,87 @@
+//! Fused sort and dedup, against sorting followed by a separate dedup or run-length counting pass
+//! over the sorted output. Only patterns with many duplicates are interesting here.
+
+use criterion::{black_box, Criterion};
+
+use sort_research_rs::unstable::cpp_pdqsort;
+
+use sort_test_tools::Sort;
+
+use crate::modules::util::bench_fn;
+
+// Same as std::unique, but swaps so that the duplicates stay in the slice, like sort_unique.
+fn dedup_sorted<T: Ord>(data: &mut [T]) -> usize {
+    if data.is_empty() {
+        return 0;
+    }
+
+    let mut unique_len = 1;
+    for i in 1..data.len() {
+        if data[i] != data[unique_len - 1] {
+            data.swap(unique_len, i);
+            unique_len += 1;
+        }
+    }
+
+    unique_len
+}
+
+// dedup_sorted that also counts the occurrences of every unique value.
+fn count_runs_sorted<T: Ord>(data: &mut [T]) -> Vec<usize> {
+    let mut counts = Vec::<usize>::new();
+
+    for i in 0..data.len() {
+        if !counts.is_empty() && data[i] == data[counts.len() - 1] {
+            *counts.last_mut().unwrap() += 1;
+        } else {
+            data.swap(counts.len(), i);
+            counts.push(1);
+        }
+    }
+
+    counts
+}
+
+pub fn bench<T: Ord + std::fmt::Debug>(
+    c: &mut Criterion,
+    test_len: usize,
+    transform_name: &str,
+    transform: &fn(Vec<i32>) -> Vec<T>,
+    pattern_name: &str,
+    pattern_provider: &fn(usize) -> Vec<i32>,
+) {
+    // The fused entry points exist for these types.
+    if !matches!(transform_name, "i32" | "u64" | "string")
+        || !matches!(pattern_name, "random_d20" | "random_z1")
+    {
+        return;
+    }
+
+    let mut bench_dedup = |bench_name: &str, test_fn: fn(&mut [T])| {
+        bench_fn(
+            c,
+            test_len,
+            transform_name,
+            transform,
+            pattern_name,
+            pattern_provider,
+            bench_name,
+            test_fn,
+        );
+    };
+
+    bench_dedup("cpp_pdqsort_unique", |v| {
+        black_box(cpp_pdqsort::sort_unique(v));
+    });
+    bench_dedup("cpp_pdqsort_then_dedup", |v| {
+        <cpp_pdqsort::SortImpl as Sort>::sort(v);
+        black_box(dedup_sorted(v));
+    });
+    bench_dedup("cpp_pdqsort_count_runs", |v| {
+        black_box(cpp_pdqsort::sort_count_runs(v));
+    });
+    bench_dedup("cpp_pdqsort_then_count_runs", |v| {
+        <cpp_pdqsort::SortImpl as Sort>::sort(v);
+        black_box(count_runs_sorted(v));
+    });
+}
@@ -1,4 +1,5 @@
 use std::env;
+use std::fs;
 use std::str::FromStr;
 
 use regex::Regex;
@@ -7,12 +8,29 @@ use criterion::{black_box, BatchSize, Criterion};
 
 use once_cell::sync::OnceCell;
 
+use crate::modules::input_cache::{self, InputCache};
+
 pub fn pin_thread_to_core() {
     use std::cell::Cell;
-    let pin_core_id: usize = 2;
+
+    // Core 2 by default, away from core 0 which tends to handle most interrupts. BENCH_PIN_CORE
+    // picks another one, e.g. one on the node or CCX a parallel benchmark leaves idle.
+    static PIN_CORE_ID: OnceCell<usize> = OnceCell::new();
+    let pin_core_id = *PIN_CORE_ID.get_or_init(|| {
+        env::var("BENCH_PIN_CORE")
+            .map(|val| val.parse().expect("BENCH_PIN_CORE must be a number"))
+            .unwrap_or(2)
+    });
 
     thread_local! {static AFFINITY_ALREADY_SET: Cell<bool> = Cell::new(false); }
 
+    // Threads spawned by the sort inherit the affinity of the bench thread, which serializes
+    // parallel implementations on a single core. Set BENCH_NO_PIN to measure those.
+    static NO_PIN: OnceCell<bool> = OnceCell::new();
+    if *NO_PIN.get_or_init(|| env::var("BENCH_NO_PIN").is_ok()) {
+        return;
+    }
+
     // Set affinity only once per thread.
     AFFINITY_ALREADY_SET.with(|affinity_already_set| {
         if !affinity_already_set.get() {
@@ -44,6 +62,38 @@ pub fn cpu_max_freq_hz() -> Option<f64> {
         })
 }
 
+// Used if the cache sizes can't be read from sysfs.
+const DEFAULT_LLC_BYTES: usize = 32 * 1024 * 1024;
+
+fn parse_cache_size(val: &str) -> Option<usize> {
+    let val = val.trim();
+    let (digits, mult) = match val.as_bytes().last()? {
+        b'K' => (&val[..val.len() - 1], 1024),
+        b'M' => (&val[..val.len() - 1], 1024 * 1024),
+        _ => (val, 1),
+    };
+
+    digits.parse::<usize>().ok().map(|size| size * mult)
+}
+
+// Largest cache of cpu0, that's the last level cache on all common topologies.
+pub fn llc_bytes() -> usize {
+    static LLC_BYTES: OnceCell<usize> = OnceCell::new();
+
+    *LLC_BYTES.get_or_init(|| {
+        (0..8)
+            .filter_map(|index| {
+                fs::read_to_string(format!(
+                    "/sys/devices/system/cpu/cpu0/cache/index{index}/size"
+                ))
+                .ok()
+                .and_then(|val| parse_cache_size(&val))
+            })
+            .max()
+            .unwrap_or(DEFAULT_LLC_BYTES)
+    })
+}
+
 pub fn should_run_benchmark(name: &str) -> bool {
     static FILTER_REGEX: OnceCell<Option<regex::Regex>> = OnceCell::new();
 
@@ -59,6 +109,275 @@ pub fn should_run_benchmark(name: &str) -> bool {
         .unwrap_or(true)
 }
 
+// With PERF_COUNTERS=<path> set, every hot benchmark is followed by a run under hardware
+// performance counters. The counts per element are printed, and appended to <path> as one JSON
+// object per line, which run_benchmarks.py merges into its results.
+fn perf_counters_path() -> Option<&'static str> {
+    static PERF_COUNTERS_PATH: OnceCell<Option<String>> = OnceCell::new();
+
+    PERF_COUNTERS_PATH
+        .get_or_init(|| {
+            env::var("PERF_COUNTERS")
+                .ok()
+                .filter(|path| !path.is_empty())
+        })
+        .as_deref()
+}
+
+fn measure_perf_counters<T>(
+    out_path: &str,
+    bench_name: &str,
+    test_len: usize,
+    make_input: impl Fn() -> Vec<T>,
+    test_fn: &impl Fn(&mut [T]),
+) {
+    use std::io::Write;
+
+    use crate::modules::perf_counters::Counters;
+
+    let Some(mut counters) = Counters::new() else {
+        static WARN_ONCE: OnceCell<()> = OnceCell::new();
+        WARN_ONCE.get_or_init(|| {
+            eprintln!("PERF_COUNTERS: perf_event_open failed, check kernel.perf_event_paranoid");
+        });
+        return;
+    };
+
+    // Enough runs to keep the fixed cost of enabling and reading the counters out of the small
+    // sizes, without making the large ones take forever.
+    let run_count = (10_000_000 / test_len.max(1)).clamp(10, 10_000);
+
+    let names = counters.names();
+    let mut totals = vec![0.0; names.len()];
+    for _ in 0..run_count {
+        let mut test_data = make_input();
+        let counts = counters.measure(|| test_fn(black_box(test_data.as_mut_slice())));
+        black_box(test_data);
+
+        for (total, count) in totals.iter_mut().zip(counts) {
+            *total += count;
+        }
+    }
+
+    let per_elem = totals
+        .iter()
+        .map(|total| total / (run_count * test_len.max(1)) as f64)
+        .collect::<Vec<_>>();
+
+    let summary = names
+        .iter()
+        .zip(&per_elem)
+        .map(|(name, val)| format!("{name}: {val:.3}"))
+        .collect::<Vec<_>>()
+        .join(" ");
+    println!("{bench_name}: perf counters per element: {summary}");
+
+    // NaN marks events that were never scheduled, JSON has no NaN.
+    let json_counters = names
+        .iter()
+        .zip(&per_elem)
+        .map(|(name, val)| {
+            if val.is_nan() {
+                format!("\"{name}\": null")
+            } else {
+                format!("\"{name}\": {val}")
+            }
+        })
+        .collect::<Vec<_>>()
+        .join(", ");
+
+    let mut out_file = std::fs::OpenOptions::new()
+        .create(true)
+        .append(true)
+        .open(out_path)
+        .unwrap_or_else(|err| panic!("Failed to open PERF_COUNTERS file {out_path}: {err}"));
+    writeln!(
+        out_file,
+        "{{\"name\": \"{bench_name}\", \"len\": {test_len}, \"runs\": {run_count}, \"counters\": {{{json_counters}}}}}"
+    )
+    .unwrap();
+}
+
+// With RAPL_ENERGY=<path> set, every hot benchmark is also followed by a run between reads of the
+// RAPL package and DRAM energy counters. The energy per element and the average power are printed,
+// and appended to <path> as one JSON object per line, which run_benchmarks.py merges into its
+// results.
+fn rapl_energy_path() -> Option<&'static str> {
+    static RAPL_ENERGY_PATH: OnceCell<Option<String>> = OnceCell::new();
+
+    RAPL_ENERGY_PATH
+        .get_or_init(|| env::var("RAPL_ENERGY").ok().filter(|path| !path.is_empty()))
+        .as_deref()
+}
+
+fn measure_rapl_energy<T>(
+    out_path: &str,
+    bench_name: &str,
+    test_len: usize,
+    make_input: impl Fn() -> Vec<T>,
+    test_fn: &impl Fn(&mut [T]),
+) {
+    use std::io::Write;
+    use std::time::{Duration, Instant};
+
+    use crate::modules::rapl::Rapl;
+
+    static RAPL: OnceCell<Option<Rapl>> = OnceCell::new();
+    let Some(rapl) = RAPL.get_or_init(Rapl::new) else {
+        static WARN_ONCE: OnceCell<()> = OnceCell::new();
+        WARN_ONCE.get_or_init(|| {
+            eprintln!("RAPL_ENERGY: no readable RAPL domain in /sys/class/powercap, run as root");
+        });
+        return;
+    };
+
+    // The counters are updated about every millisecond in steps of some microjoules, measure long
+    // enough for that not to matter. The inputs are made in batches of up to 64 MiB outside of the
+    // measured region, so that it only contains the sort calls.
+    const MIN_MEASURED: Duration = Duration::from_secs(1);
+    let input_bytes = (test_len * std::mem::size_of::<T>()).max(1);
+    let batch_len = ((64 << 20) / input_bytes).clamp(1, 10_000);
+
+    let names = rapl.names();
+    let mut totals = vec![0.0; names.len()];
+    let mut measured = Duration::ZERO;
+    let mut run_count = 0;
+    while measured < MIN_MEASURED {
+        let mut batch = (0..batch_len).map(|_| make_input()).collect::<Vec<_>>();
+
+        let start_time = Instant::now();
+        let start = rapl.read();
+        for test_data in &mut batch {
+            test_fn(black_box(test_data.as_mut_slice()));
+        }
+        let end = rapl.read();
+        measured += start_time.elapsed();
+        black_box(batch);
+
+        for (total, joules) in totals.iter_mut().zip(rapl.joules(&start, &end)) {
+            *total += joules;
+        }
+        run_count += batch_len;
+    }
+
+    let elem_count = (run_count * test_len.max(1)) as f64;
+    let summary = names
+        .iter()
+        .zip(&totals)
+        .map(|(name, total)| {
+            format!(
+                "{name}: {:.3}nJ ({:.1}W)",
+                total / elem_count * 1e9,
+                total / measured.as_secs_f64()
+            )
+        })
+        .collect::<Vec<_>>()
+        .join(" ");
+    println!("{bench_name}: energy per element: {summary}");
+
+    let json_energy = names
+        .iter()
+        .zip(&totals)
+        .map(|(name, total)| format!("\"{name}\": {}", total / elem_count))
+        .collect::<Vec<_>>()
+        .join(", ");
+
+    let mut out_file = std::fs::OpenOptions::new()
+        .create(true)
+        .append(true)
+        .open(out_path)
+        .unwrap_or_else(|err| panic!("Failed to open RAPL_ENERGY file {out_path}: {err}"));
+    writeln!(
+        out_file,
+        "{{\"name\": \"{bench_name}\", \"len\": {test_len}, \"runs\": {run_count}, \"seconds\": {}, \"energy\": {{{json_energy}}}}}",
+        measured.as_secs_f64()
+    )
+    .unwrap();
+}
+
+// With ROOFLINE=<path> set, every hot benchmark with an input larger than the LLC is also timed
+// against the streaming bandwidth of the memory, see roofline.rs. Its time as equivalent passes
+// over memory is printed, and appended to <path> as one JSON object per line, which
+// run_benchmarks.py merges into its results.
+fn roofline_path() -> Option<&'static str> {
+    static ROOFLINE_PATH: OnceCell<Option<String>> = OnceCell::new();
+
+    ROOFLINE_PATH
+        .get_or_init(|| env::var("ROOFLINE").ok().filter(|path| !path.is_empty()))
+        .as_deref()
+}
+
+fn measure_roofline<T>(
+    out_path: &str,
+    bench_name: &str,
+    test_len: usize,
+    make_input: impl Fn() -> Vec<T>,
+    test_fn: &impl Fn(&mut [T]),
+) {
+    use std::io::Write;
+    use std::time::{Duration, Instant};
+
+    use crate::modules::roofline::{self, KERNELS};
+
+    let bytes = test_len * std::mem::size_of::<T>();
+    if bytes <= llc_bytes() {
+        return;
+    }
+
+    // Median of a few runs, like the criterion estimate. The inputs are not part of it.
+    let mut times = (0..3)
+        .map(|_| {
+            let mut test_data = make_input();
+            let start = Instant::now();
+            test_fn(black_box(test_data.as_mut_slice()));
+            let elapsed = start.elapsed();
+            black_box(test_data);
+            elapsed
+        })
+        .collect::<Vec<Duration>>();
+    times.sort();
+    let sort_time = times[times.len() / 2];
+
+    let bandwidth = roofline::bandwidth(bytes);
+    let threads = bandwidth.threads;
+
+    let mut summary = Vec::new();
+    let mut json_bandwidth = Vec::new();
+    let mut json_passes = Vec::new();
+    for (kernel, name) in KERNELS.iter().enumerate() {
+        let single = bandwidth.single_thread[kernel];
+        let multi = bandwidth.multi_thread[kernel];
+        let passes_single = roofline::passes(sort_time, bytes, single);
+        let passes_multi = roofline::passes(sort_time, bytes, multi);
+
+        summary.push(format!(
+            "{name}: {passes_single:.2} (1t) {passes_multi:.2} ({threads}t)"
+        ));
+        json_bandwidth.push(format!("\"{name}_st\": {single}, \"{name}_mt\": {multi}"));
+        json_passes.push(format!(
+            "\"{name}_st\": {passes_single}, \"{name}_mt\": {passes_multi}"
+        ));
+    }
+    println!(
+        "{bench_name}: equivalent passes over memory: {}",
+        summary.join(" ")
+    );
+
+    let mut out_file = std::fs::OpenOptions::new()
+        .create(true)
+        .append(true)
+        .open(out_path)
+        .unwrap_or_else(|err| panic!("Failed to open ROOFLINE file {out_path}: {err}"));
+    writeln!(
+        out_file,
+        "{{\"name\": \"{bench_name}\", \"len\": {test_len}, \"roofline\": {{\"bytes\": {bytes}, \"sort_ns\": {}, \"threads\": {threads}, \"bandwidth\": {{{}}}, \"passes\": {{{}}}}}}}",
+        sort_time.as_nanos(),
+        json_bandwidth.join(", "),
+        json_passes.join(", ")
+    )
+    .unwrap();
+}
+
 #[inline(never)]
 pub fn bench_fn<T: Ord + std::fmt::Debug>(
     c: &mut Criterion,
@@ -66,7 +385,7 @@ pub fn bench_fn<T: Ord + std::fmt::Debug>(
     transform_name: &str,
     transform: &fn(Vec<i32>) -> Vec<T>,
     pattern_name: &str,
-    pattern_provider: impl Fn(usize) -> Vec<i32>,
+    pattern_provider: impl Fn(usize) -> Vec<i32> + Sync,
     bench_name: &str,
     test_fn: impl Fn(&mut [T]),
 ) {
@@ -99,7 +418,22 @@ pub fn bench_fn<T: Ord + std::fmt::Debug>(
         format!("{bech_name_with_overwrite}-hot-{transform_name}-{pattern_name}-{test_len}");
 
     if should_run_benchmark(&bench_name_hot) {
+        let mut input_cache = input_cache::count()
+            .map(|count| InputCache::new(count, test_len, transform, &pattern_provider));
+
         c.bench_function(&bench_name_hot_with_overwrite, |b| {
+            if let Some(input_cache) = input_cache.as_mut() {
+                // Same number of inputs per timed batch as iter_batched_ref.
+                b.iter_custom(|iters| {
+                    let inputs_per_batch = match batch_size {
+                        BatchSize::SmallInput => iters.div_ceil(10),
+                        _ => iters.div_ceil(1000),
+                    };
+                    input_cache.time(iters, inputs_per_batch as usize, &test_fn)
+                });
+                return;
+            }
+
             b.iter_batched_ref(
                 || transform(pattern_provider(test_len)),
                 |test_data| {
@@ -109,6 +443,36 @@ pub fn bench_fn<T: Ord + std::fmt::Debug>(
                 batch_size,
             )
         });
+
+        if let Some(out_path) = perf_counters_path() {
+            measure_perf_counters(
+                out_path,
+                &bench_name_hot_with_overwrite,
+                test_len,
+                || transform(pattern_provider(test_len)),
+                &test_fn,
+            );
+        }
+
+        if let Some(out_path) = rapl_energy_path() {
+            measure_rapl_energy(
+                out_path,
+                &bench_name_hot_with_overwrite,
+                test_len,
+                || transform(pattern_provider(test_len)),
+                &test_fn,
+            );
+        }
+
+        if let Some(out_path) = roofline_path() {
+            measure_roofline(
+                out_path,
+                &bench_name_hot_with_overwrite,
+                test_len,
+                || transform(pattern_provider(test_len)),
+                &test_fn,
+            );
+        }
     }
 
     #[cfg(feature = "cold_benchmarks")]
@@ -118,29 +482,56 @@ pub fn bench_fn<T: Ord + std::fmt::Debug>(
         let bench_name_cold_with_overwrite =
             format!("{bech_name_with_overwrite}-cold-{transform_name}-{pattern_name}-{test_len}");
 
+        let cold_input = || {
+            let mut test_ints = pattern_provider(test_len);
+
+            if test_ints.len() == 0 {
+                return vec![];
+            }
+
+            // Try as best as possible to trash all prediction state in the CPU, to
+            // simulate calling the benchmark function as part of a larger program.
+            // Caveat, memory caches. We don't want to benchmark how expensive it is to
+            // load something from main memory.
+            let first_val = black_box(crate::trash_prediction::trash_prediction_state(black_box(
+                test_ints[0],
+            )));
+
+            // Limit the optimizer in getting rid of trash_prediction_state,
+            // by tying its output to the test input.
+            test_ints[0] = first_val;
+
+            transform(test_ints)
+        };
+
         if should_run_benchmark(&bench_name_cold) {
             c.bench_function(&bench_name_cold_with_overwrite, |b| {
                 b.iter_batched_ref(
-                    || {
-                        let mut test_ints = pattern_provider(test_len);
-
-                        if test_ints.len() == 0 {
-                            return vec![];
-                        }
-
-                        // Try as best as possible to trash all prediction state in the CPU, to
-                        // simulate calling the benchmark function as part of a larger program.
-                        // Caveat, memory caches. We don't want to benchmark how expensive it is to
-                        // load something from main memory.
-                        let first_val = black_box(crate::trash_prediction::trash_prediction_state(
-                            black_box(test_ints[0]),
-                        ));
+                    cold_input,
+                    |test_data| {
+                        test_fn(black_box(test_data.as_mut_slice()));
+                        black_box(test_data); // side-effect
+                    },
+                    BatchSize::PerIteration,
+                )
+            });
+        }
 
-                        // Limit the optimizer in getting rid of trash_prediction_state,
-                        // by tying its output to the test input.
-                        test_ints[0] = first_val;
+        // Same as cold, but the input and the code of the sort also start out in main memory.
+        let bench_name_cold_data =
+            format!("{bench_name}-cold_data-{transform_name}-{pattern_name}-{test_len}");
+        let bench_name_cold_data_with_overwrite = format!(
+            "{bech_name_with_overwrite}-cold_data-{transform_name}-{pattern_name}-{test_len}"
+        );
 
-                        transform(test_ints)
+        if crate::modules::cache_evict::is_enabled() && should_run_benchmark(&bench_name_cold_data)
+        {
+            c.bench_function(&bench_name_cold_data_with_overwrite, |b| {
+                b.iter_batched_ref(
+                    || {
+                        let test_data = cold_input();
+                        crate::modules::cache_evict::evict(&test_data);
+                        test_data
                     },
                     |test_data| {
                         test_fn(black_box(test_data.as_mut_slice()));
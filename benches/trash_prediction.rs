@@ -1,7 +1,7 @@
 use rand::{thread_rng, Rng};
 use std::fs;
 
-use criterion::black_box;
+use std::hint::black_box;
 
 #[inline(never)]
 pub fn trash_prediction_state(input: i32) -> i32 {
@@ -1,10 +1,23 @@
 use std::env;
 use std::path::PathBuf;
+use std::sync::Mutex;
 
 // Adjust this if you have a custom clang build, or path.
 #[allow(unused)]
 const CLANG_PATH: &str = "clang++";
 
+// Adjust this if it doesn't match the LLVM version of CLANG_PATH.
+#[allow(unused)]
+const LLVM_PROFDATA_PATH: &str = "llvm-profdata";
+
+// Static libraries built so far, the native bench driver links against all of them.
+#[allow(dead_code)]
+static BUILT_ARTIFACTS: Mutex<Vec<String>> = Mutex::new(Vec::new());
+
+// Linker arguments for the profiling runtimes of the CPP_PGO=generate objects built so far.
+#[allow(dead_code)]
+static PGO_RUNTIME_LINK_ARGS: Mutex<Vec<String>> = Mutex::new(Vec::new());
+
 #[allow(dead_code)]
 fn build_and_link_cpp_sort(
     file_name: &str,
@@ -20,14 +33,35 @@ fn build_and_link_cpp_sort(
     // Tell Cargo that if the given file changes, to rerun this build script.
     println!("cargo:rerun-if-changed={}", file_path.display());
 
-    println!(
-        "cargo:rerun-if-changed={}",
-        manifest_dir
-            .join("src")
-            .join("cpp")
-            .join("shared.h")
-            .display()
-    );
+    for header in [
+        "shared.h",
+        "cpu_features.h",
+        "small_sort_network.h",
+        "small_sort_network-inl.h",
+        "numa_util.h",
+        "cpu_topology.h",
+        "ips4o_out_of_place.h",
+        "ips4o_timer.h",
+        "ips4o_splitters.h",
+        "sort_telemetry.h",
+        "sort_usdt.h",
+        "run_accumulator.h",
+        "parallel_util.h",
+        "fixed_network_sort.h",
+        "lomcyc_partition.h",
+        "ips4o_instantiation.h",
+        "run_prepass.h",
+        "key_encoder.h",
+        "simd_classifier.h",
+        "simd_classifier-inl.h",
+        "sortedness.h",
+        "sortedness-inl.h",
+    ] {
+        println!(
+            "cargo:rerun-if-changed={}",
+            manifest_dir.join("src").join("cpp").join(header).display()
+        );
+    }
 
     let out_dir = PathBuf::from(env::var("OUT_DIR").unwrap());
 
@@ -47,6 +81,20 @@ fn build_and_link_cpp_sort(
         .debug(false)
         .opt_level(3);
 
+    if cfg!(feature = "cross_language_lto") {
+        // Before specialize_fn, sorts that need a specific compiler keep it.
+        builder.compiler(CLANG_PATH);
+    }
+
+    if is_wasm32() {
+        configure_wasm32(&mut builder);
+    }
+
+    if cfg!(feature = "cpp_sort_usdt") {
+        // The USDT probes of sort_usdt.h around every entry point.
+        builder.define("SORT_USDT", None);
+    }
+
     let mut artifact_name = file_name.to_string();
     if let Some(spec_fn) = specialize_fn {
         if let Some(artifact_name_override) = spec_fn(&mut builder) {
@@ -54,15 +102,278 @@ fn build_and_link_cpp_sort(
         }
     }
 
+    if cfg!(feature = "cross_language_lto") {
+        enable_cross_language_lto(&mut builder);
+    }
+
+    apply_cpp_pgo(&mut builder);
+
     builder.compile(&artifact_name);
 
     println!("cargo:rustc-link-search={}", out_dir.display());
-    println!("cargo:rustc-link-lib=static={}", artifact_name);
+    if !cfg!(feature = "cpp_shared_lib") {
+        println!("cargo:rustc-link-lib=static={}", artifact_name);
+    }
+
+    BUILT_ARTIFACTS.lock().unwrap().push(artifact_name);
+}
+
+// Emits LLVM bitcode instead of machine code, which the linker optimizes together with the Rust
+// bitcode of -Clinker-plugin-lto. Compilers that don't support -flto=thin, like the custom gcc of
+// cpp_std_gcc4_3, still produce regular objects that link as before.
+#[allow(dead_code)]
+fn enable_cross_language_lto(builder: &mut cc::Build) {
+    let rustflags = env::var("CARGO_ENCODED_RUSTFLAGS").unwrap_or_default();
+    assert!(
+        rustflags
+            .split('\x1f')
+            .any(|flag| flag.contains("linker-plugin-lto")),
+        "cross_language_lto requires RUSTFLAGS=\"-Clinker-plugin-lto -Clinker=clang \
+         -Clink-arg=-fuse-ld=lld\", see README.md"
+    );
+
+    // GNU ar doesn't index the symbols of bitcode objects.
+    builder.flag_if_supported("-flto=thin").archiver("llvm-ar");
+}
+
+#[allow(dead_code)]
+fn has_target_feature(feature: &str) -> bool {
+    env::var("CARGO_CFG_TARGET_FEATURE")
+        .is_ok_and(|features| features.split(',').any(|f| f == feature))
+}
+
+fn target_arch() -> String {
+    env::var("CARGO_CFG_TARGET_ARCH").unwrap()
+}
+
+fn is_wasm32() -> bool {
+    target_arch() == "wasm32"
+}
+
+fn is_x86() -> bool {
+    matches!(target_arch().as_str(), "x86" | "x86_64")
+}
+
+// The features that only add x86 kernels. Elsewhere their wrappers still build, with the scalar
+// fallback they use on x86 CPUs without the instruction set, but measuring them would only measure
+// that fallback. The benchmarks and cpp_bench_driver skip them, and the vectorized networks and
+// classifier are not compiled in.
+const X86_ONLY_FEATURES: [(bool, &str); 4] = [
+    (cfg!(feature = "cpp_simdsort"), "cpp_simdsort"),
+    (cfg!(feature = "cpp_intel_avx512"), "cpp_intel_avx512"),
+    (
+        cfg!(feature = "cpp_small_sort_network"),
+        "cpp_small_sort_network",
+    ),
+    (
+        cfg!(feature = "cpp_ips4o_simd_classifier"),
+        "cpp_ips4o_simd_classifier",
+    ),
+];
+
+fn warn_x86_only_features() {
+    if is_x86() {
+        return;
+    }
+
+    for (_, feature) in X86_ONLY_FEATURES.iter().filter(|(enabled, _)| *enabled) {
+        println!(
+            "cargo:warning={feature} only has x86 kernels, it is disabled on {}",
+            target_arch()
+        );
+    }
+}
+
+// WebAssembly builds, e.g. --target wasm32-wasip1, see util/run_wasm_benchmarks.py. Only clang
+// targets wasm, with the C and C++ standard libraries of the wasi-sdk sysroot in WASI_SYSROOT.
+// Everything is compiled for SIMD128, which all current runtimes support, there is no runtime
+// dispatch. Wrappers that need threads or x86 intrinsics don't build for wasm.
+fn configure_wasm32(builder: &mut cc::Build) {
+    builder
+        .compiler(CLANG_PATH)
+        .flag("-msimd128")
+        // Linked once for all wrappers, see link_wasm32_cpp_runtime.
+        .cpp_link_stdlib(None);
+
+    if let Ok(sysroot) = env::var("WASI_SYSROOT") {
+        builder.flag(format!("--sysroot={sysroot}"));
+    }
+}
+
+fn link_wasm32_cpp_runtime() {
+    println!("cargo:rerun-if-env-changed=WASI_SYSROOT");
+
+    if !is_wasm32() || BUILT_ARTIFACTS.lock().unwrap().is_empty() {
+        return;
+    }
+
+    let sysroot = PathBuf::from(
+        env::var("WASI_SYSROOT").expect("wasm builds of the C and C++ sorts need WASI_SYSROOT"),
+    );
+    let target = env::var("TARGET").unwrap();
+    println!(
+        "cargo:rustc-link-search=native={}",
+        sysroot.join("lib").join(target).display()
+    );
+    println!("cargo:rustc-link-lib=static=c++");
+    println!("cargo:rustc-link-lib=static=c++abi");
+}
+
+// Profile guided optimization of the C and C++ sorts, see util/run_cpp_pgo.py. CPP_PGO=generate
+// builds instrumented objects that write their profiles to target/<profile>/cpp_pgo when the
+// program exits, CPP_PGO=use rebuilds them with these profiles. Both builds have to use the same
+// features, gcc finds the profile of an object by its path in OUT_DIR.
+#[derive(Clone, Copy, PartialEq)]
+enum CppPgo {
+    Off,
+    Generate,
+    Use,
+}
+
+fn cpp_pgo_mode() -> CppPgo {
+    match env::var("CPP_PGO").as_deref() {
+        Err(_) | Ok("") => CppPgo::Off,
+        Ok("generate") => CppPgo::Generate,
+        Ok("use") => CppPgo::Use,
+        Ok(other) => panic!("Unknown CPP_PGO={other}, expected generate or use"),
+    }
+}
+
+#[allow(dead_code)]
+fn cpp_pgo_dir() -> PathBuf {
+    let out_dir = PathBuf::from(env::var("OUT_DIR").unwrap());
+
+    // OUT_DIR is target/<profile>/build/<pkg>-<hash>/out.
+    out_dir.ancestors().nth(3).unwrap().join("cpp_pgo")
+}
+
+// The clang profiling runtime lives next to its builtins library.
+#[allow(dead_code)]
+fn clang_profile_runtime(compiler: &cc::Tool) -> String {
+    let output = std::process::Command::new(compiler.path())
+        .args(["-rtlib=compiler-rt", "-print-libgcc-file-name"])
+        .output()
+        .expect("Failed to run clang");
+    let builtins_path = String::from_utf8(output.stdout).unwrap();
+
+    builtins_path
+        .trim()
+        .replace("libclang_rt.builtins", "libclang_rt.profile")
+}
+
+// clang reads a single indexed profile, merged once from all the raw ones.
+#[allow(dead_code)]
+fn merged_clang_profile() -> PathBuf {
+    static MERGED_PATH: std::sync::OnceLock<PathBuf> = std::sync::OnceLock::new();
+
+    MERGED_PATH
+        .get_or_init(|| {
+            let pgo_dir = cpp_pgo_dir();
+            let raw_profiles = std::fs::read_dir(&pgo_dir)
+                .map(|entries| {
+                    entries
+                        .map(|entry| entry.unwrap().path())
+                        .filter(|path| path.extension().is_some_and(|ext| ext == "profraw"))
+                        .collect::<Vec<_>>()
+                })
+                .unwrap_or_default();
+            assert!(
+                !raw_profiles.is_empty(),
+                "CPP_PGO=use found no profiles in {}, run CPP_PGO=generate first",
+                pgo_dir.display()
+            );
+
+            let merged_path = pgo_dir.join("merged.profdata");
+            let status = std::process::Command::new(LLVM_PROFDATA_PATH)
+                .arg("merge")
+                .arg("-o")
+                .arg(&merged_path)
+                .args(&raw_profiles)
+                .status()
+                .expect("Failed to run llvm-profdata");
+            assert!(status.success(), "Failed to merge the clang profiles");
+
+            merged_path
+        })
+        .clone()
+}
+
+#[allow(dead_code)]
+fn apply_cpp_pgo(builder: &mut cc::Build) {
+    let mode = cpp_pgo_mode();
+    if mode == CppPgo::Off {
+        return;
+    }
+
+    let compiler = builder.get_compiler();
+    let is_clang = compiler.is_like_clang();
+    let pgo_dir = cpp_pgo_dir();
+
+    if mode == CppPgo::Generate {
+        // The parallel sorts update the counters from multiple threads.
+        builder
+            .flag(format!("-fprofile-generate={}", pgo_dir.display()))
+            .flag("-fprofile-update=atomic");
+
+        let runtime_link_arg = if is_clang {
+            clang_profile_runtime(&compiler)
+        } else {
+            "-lgcov".to_string()
+        };
+
+        let mut runtime_link_args = PGO_RUNTIME_LINK_ARGS.lock().unwrap();
+        if !runtime_link_args.contains(&runtime_link_arg) {
+            runtime_link_args.push(runtime_link_arg);
+        }
+    } else if is_clang {
+        builder.flag(format!(
+            "-fprofile-use={}",
+            merged_clang_profile().display()
+        ));
+    } else {
+        // Code the training run didn't reach is optimized as without profile, instead of for
+        // size.
+        builder
+            .flag(format!("-fprofile-use={}", pgo_dir.display()))
+            .flag_if_supported("-fprofile-partial-training");
+    }
+}
+
+fn link_cpp_pgo_runtime() {
+    println!("cargo:rerun-if-env-changed=CPP_PGO");
+
+    for link_arg in PGO_RUNTIME_LINK_ARGS.lock().unwrap().iter() {
+        println!("cargo:rustc-link-arg={link_arg}");
+    }
+}
+
+// Replaces the scalar base case of the wrappers that call this with the vectorized networks of
+// small_sort_network.h.
+#[allow(dead_code)]
+fn define_small_sort_network(builder: &mut cc::Build) {
+    if cfg!(feature = "cpp_small_sort_network") && is_x86() {
+        builder.define("SMALL_SORT_NETWORK", None);
+    }
+}
+
+// Puts the presortedness detection of run_prepass.h in front of the wrappers that call this.
+#[allow(dead_code)]
+fn define_run_prepass(builder: &mut cc::Build) {
+    if cfg!(feature = "cpp_run_prepass") {
+        builder.define("RUN_PREPASS", None);
+    }
 }
 
 #[cfg(feature = "cpp_pdqsort")]
 fn build_and_link_cpp_pdqsort() {
-    build_and_link_cpp_sort("cpp_pdqsort", None);
+    build_and_link_cpp_sort(
+        "cpp_pdqsort",
+        Some(|builder: &mut cc::Build| {
+            define_small_sort_network(builder);
+            define_sort_telemetry(builder);
+            None
+        }),
+    );
 }
 
 #[cfg(not(feature = "cpp_pdqsort"))]
@@ -76,35 +387,147 @@ fn build_and_link_cpp_powersort() {
 #[cfg(not(feature = "cpp_powersort"))]
 fn build_and_link_cpp_powersort() {}
 
-#[cfg(feature = "cpp_simdsort")]
-fn build_and_link_cpp_simdsort() {
+#[cfg(feature = "cpp_powersort_parallel")]
+fn build_and_link_cpp_powersort_parallel() {
     build_and_link_cpp_sort(
-        "cpp_simdsort",
+        "cpp_powersort_parallel",
         Some(|builder: &mut cc::Build| {
-            // Make an exception for march=native here because AVX2 will not work without it.
-            builder.flag_if_supported("-march=native");
-
+            builder.flag("-pthread");
             None
         }),
     );
 }
 
+#[cfg(not(feature = "cpp_powersort_parallel"))]
+fn build_and_link_cpp_powersort_parallel() {}
+
+#[cfg(feature = "cpp_simdsort")]
+fn build_and_link_cpp_simdsort() {
+    // No -march=native, the AVX2 kernel is compiled with target attributes and selected at
+    // runtime, see cpu_features.h.
+    build_and_link_cpp_sort("cpp_simdsort", None);
+}
+
 #[cfg(not(feature = "cpp_simdsort"))]
 fn build_and_link_cpp_simdsort() {}
 
+// Enables the phase timers of ips4o_timer.h.
+#[allow(dead_code)]
+fn define_ips4o_timer(builder: &mut cc::Build) {
+    if cfg!(feature = "cpp_ips4o_timer") {
+        builder.define("IPS4O_TIMER", None);
+    }
+}
+
+// Enables the pivot and partition telemetry of sort_telemetry.h.
+#[allow(dead_code)]
+fn define_sort_telemetry(builder: &mut cc::Build) {
+    if cfg!(feature = "cpp_sort_telemetry") {
+        builder.define("SORT_TELEMETRY", None);
+    }
+}
+
+// Replaces the scalar i32 and u64 classification of ips4o with the vectorized one of
+// simd_classifier.h.
+#[allow(dead_code)]
+fn define_ips4o_simd_classifier(builder: &mut cc::Build) {
+    if cfg!(feature = "cpp_ips4o_simd_classifier") && is_x86() {
+        builder.define("IPS4O_SIMD_CLASSIFIER", None);
+    }
+}
+
+// Compiles the expensive template instantiations of a wrapper in the separate translation unit
+// `file_name`, see cpp_split_instantiation in Cargo.toml.
+#[allow(dead_code)]
+fn split_instantiation(builder: &mut cc::Build, file_name: &str) {
+    if !cfg!(feature = "cpp_split_instantiation") {
+        return;
+    }
+
+    let file_path = PathBuf::from(env::var("CARGO_MANIFEST_DIR").unwrap())
+        .join("src")
+        .join("cpp")
+        .join(format!("{file_name}.cpp"));
+    println!("cargo:rerun-if-changed={}", file_path.display());
+
+    builder
+        .file(file_path)
+        .define("CPP_SPLIT_INSTANTIATION", None);
+}
+
 #[cfg(feature = "cpp_ips4o")]
 fn build_and_link_cpp_ips4o() {
-    build_and_link_cpp_sort("cpp_ips4o", None);
+    build_and_link_cpp_sort(
+        "cpp_ips4o",
+        Some(|builder: &mut cc::Build| {
+            define_ips4o_timer(builder);
+            define_ips4o_simd_classifier(builder);
+            define_sort_telemetry(builder);
+            // The phase timers and the telemetry are per translation unit.
+            if !cfg!(feature = "cpp_ips4o_timer") && !cfg!(feature = "cpp_sort_telemetry") {
+                split_instantiation(builder, "cpp_ips4o_inst");
+            }
+            None
+        }),
+    );
 }
 
+#[cfg(feature = "cpp_ips4o_parallel")]
+fn build_and_link_cpp_ips4o_parallel() {
+    build_and_link_cpp_sort(
+        "cpp_ips4o",
+        Some(|builder: &mut cc::Build| {
+            // The parallel code is only available with _REENTRANT, which -pthread defines. The
+            // bucket pointers use 16 byte atomics, and the task queue comes from TBB.
+            builder
+                .define("IPS4O_PARALLEL", None)
+                .flag("-pthread")
+                .flag_if_supported("-mcx16");
+            define_ips4o_timer(builder);
+            define_ips4o_simd_classifier(builder);
+            define_sort_telemetry(builder);
+
+            println!("cargo:rustc-link-lib=tbb");
+            println!("cargo:rustc-link-lib=atomic");
+
+            Some("cpp_ips4o_parallel".into())
+        }),
+    );
+}
+
+#[cfg(not(feature = "cpp_ips4o_parallel"))]
+fn build_and_link_cpp_ips4o_parallel() {}
+
 #[cfg(feature = "cpp_vqsort")]
 fn build_and_link_cpp_vqsort() {
     build_and_link_cpp_sort(
         "cpp_vqsort",
         Some(|builder: &mut cc::Build| {
-            // Make an exception for march=native here because AVX2 will not work without it.
-            builder.flag("-march=native");
-            builder.compiler(CLANG_PATH); // gcc yields significantly worse code-gen here.
+            // No -march=native, Highway compiles every x86 or Arm target and dispatches at runtime.
+            // The vendored Highway only supports runtime dispatch on Arm with gcc, with clang it
+            // would be limited to NEON.
+            if target_arch() != "aarch64" {
+                builder.compiler(CLANG_PATH); // gcc yields significantly worse code-gen here.
+            }
+
+            // On RISC-V the vendored Highway has no runtime dispatch, RVV is the static target if
+            // the V extension is enabled for the whole build, e.g. with
+            // RUSTFLAGS="-C target-feature=+v", so that ipnsort is compiled for it too. Needs
+            // clang 16 or later. Without it, and on POWER, where the vendored Highway has no VSX
+            // target yet, vqsort uses the portable EMU128 target.
+            if target_arch() == "riscv64" && has_target_feature("v") {
+                builder.flag("-march=rv64gcv");
+            }
+
+            // On wasm the static target is WASM, the 128 bit SIMD of -msimd128.
+            // VQSORT_WASM_EMU256=1 picks WASM_EMU256 instead, which emulates 256 bit vectors with
+            // pairs of them.
+            println!("cargo:rerun-if-env-changed=VQSORT_WASM_EMU256");
+            if is_wasm32() && env::var("VQSORT_WASM_EMU256").is_ok_and(|val| val == "1") {
+                builder.define("HWY_WANT_WASM2", None);
+            }
+
+            split_instantiation(builder, "cpp_vqsort_inst");
 
             None
         }),
@@ -119,8 +542,8 @@ fn build_and_link_cpp_intel_avx512() {
     build_and_link_cpp_sort(
         "cpp_intel_avx512",
         Some(|builder: &mut cc::Build| {
-            // Make an exception for march=native here because AVX512 will not work without it.
-            builder.flag("-march=native");
+            // No -march=native, the AVX-512 kernels are compiled with target attributes and
+            // selected at runtime, see cpu_features.h.
             builder.compiler(CLANG_PATH); // gcc yields significantly worse code-gen here.
 
             None
@@ -131,6 +554,123 @@ fn build_and_link_cpp_intel_avx512() {
 #[cfg(not(feature = "cpp_intel_avx512"))]
 fn build_and_link_cpp_intel_avx512() {}
 
+#[cfg(feature = "cpp_radix")]
+fn build_and_link_cpp_radix() {
+    build_and_link_cpp_sort(
+        "cpp_radix",
+        Some(|builder: &mut cc::Build| {
+            // For the threads of radix_parallel_ffi_string.
+            builder.flag("-pthread");
+
+            None
+        }),
+    );
+}
+
+#[cfg(not(feature = "cpp_radix"))]
+fn build_and_link_cpp_radix() {}
+
+// Directory and name of the GPU runtime library of cpp_gpu_sort. GPU_SORT_PLATFORM=hip builds it
+// with hipcc and hipCUB for AMD GPUs, the default is CUDA. CUDA_PATH and ROCM_PATH point to
+// non-default installations.
+#[allow(dead_code)]
+fn gpu_sort_runtime() -> (PathBuf, &'static str) {
+    println!("cargo:rerun-if-env-changed=GPU_SORT_PLATFORM");
+
+    match env::var("GPU_SORT_PLATFORM").as_deref() {
+        Err(_) | Ok("") | Ok("cuda") => (cuda_path().join("lib64"), "cudart"),
+        Ok("hip") => (rocm_path().join("lib"), "amdhip64"),
+        Ok(other) => panic!("Unknown GPU_SORT_PLATFORM={other}, expected cuda or hip"),
+    }
+}
+
+#[allow(dead_code)]
+fn cuda_path() -> PathBuf {
+    PathBuf::from(env::var("CUDA_PATH").unwrap_or_else(|_| "/usr/local/cuda".to_string()))
+}
+
+#[allow(dead_code)]
+fn rocm_path() -> PathBuf {
+    PathBuf::from(env::var("ROCM_PATH").unwrap_or_else(|_| "/opt/rocm".to_string()))
+}
+
+// Linker arguments for the GPU runtime, for the bench driver and the shared library.
+#[allow(dead_code)]
+fn gpu_sort_runtime_link_args() -> Vec<String> {
+    if !cfg!(feature = "cpp_gpu_sort") {
+        return Vec::new();
+    }
+
+    let (lib_dir, lib_name) = gpu_sort_runtime();
+    vec![format!("-L{}", lib_dir.display()), format!("-l{lib_name}")]
+}
+
+#[cfg(feature = "cpp_gpu_sort")]
+fn build_and_link_cpp_gpu_sort() {
+    assert!(
+        cpp_pgo_mode() == CppPgo::Off,
+        "cpp_gpu_sort can't be combined with CPP_PGO, nvcc and hipcc don't take the gcc and clang \
+         profile flags"
+    );
+
+    let (lib_dir, lib_name) = gpu_sort_runtime();
+
+    if lib_name == "cudart" {
+        build_and_link_cpp_sort(
+            "cpp_gpu_sort",
+            Some(|builder: &mut cc::Build| {
+                // nvcc compiles .cpp files as host-only code without -x cu.
+                builder
+                    .cuda(true)
+                    .compiler(cuda_path().join("bin").join("nvcc"))
+                    .flag("-x")
+                    .flag("cu");
+
+                None
+            }),
+        );
+    } else {
+        build_and_link_cpp_sort(
+            "cpp_gpu_sort",
+            Some(|builder: &mut cc::Build| {
+                builder
+                    .compiler(rocm_path().join("bin").join("hipcc"))
+                    .define("GPU_SORT_HIP", None);
+
+                None
+            }),
+        );
+    }
+
+    println!("cargo:rustc-link-search={}", lib_dir.display());
+    println!("cargo:rustc-link-lib=dylib={lib_name}");
+}
+
+#[cfg(not(feature = "cpp_gpu_sort"))]
+fn build_and_link_cpp_gpu_sort() {}
+
+// Routes to the entry points of the other wrappers, see cpp_adaptive.cpp. Every enabled optional
+// backend defines ADAPTIVE_<FEATURE>.
+#[cfg(feature = "cpp_adaptive")]
+fn build_and_link_cpp_adaptive() {
+    build_and_link_cpp_sort(
+        "cpp_adaptive",
+        Some(|builder: &mut cc::Build| {
+            if cfg!(feature = "cpp_radix") {
+                builder.define("ADAPTIVE_CPP_RADIX", None);
+            }
+            if cfg!(feature = "cpp_vqsort") {
+                builder.define("ADAPTIVE_CPP_VQSORT", None);
+            }
+
+            None
+        }),
+    );
+}
+
+#[cfg(not(feature = "cpp_adaptive"))]
+fn build_and_link_cpp_adaptive() {}
+
 #[cfg(feature = "singeli_singelisort")]
 fn build_and_link_singelisort() {
     build_and_link_cpp_sort(
@@ -209,7 +749,15 @@ fn build_and_link_cpp_ips4o() {}
 
 #[cfg(feature = "cpp_blockquicksort")]
 fn build_and_link_cpp_blockquicksort() {
-    build_and_link_cpp_sort("cpp_blockquicksort", None);
+    build_and_link_cpp_sort(
+        "cpp_blockquicksort",
+        Some(|builder: &mut cc::Build| {
+            define_small_sort_network(builder);
+            define_run_prepass(builder);
+            define_sort_telemetry(builder);
+            None
+        }),
+    );
 }
 
 #[cfg(not(feature = "cpp_blockquicksort"))]
@@ -221,6 +769,8 @@ fn build_and_link_cpp_gerbens_qsort() {
         "cpp_gerbens_qsort",
         Some(|builder: &mut cc::Build| {
             builder.compiler(CLANG_PATH); // gcc yields significantly worse code-gen here.
+            define_small_sort_network(builder);
+            define_run_prepass(builder);
 
             None
         }),
@@ -236,6 +786,8 @@ fn build_and_link_cpp_nanosort() {
         "cpp_nanosort",
         Some(|builder: &mut cc::Build| {
             builder.compiler(CLANG_PATH); // gcc yields significantly worse code-gen here.
+            define_small_sort_network(builder);
+            define_run_prepass(builder);
 
             None
         }),
@@ -245,6 +797,24 @@ fn build_and_link_cpp_nanosort() {
 #[cfg(not(feature = "cpp_nanosort"))]
 fn build_and_link_cpp_nanosort() {}
 
+#[cfg(feature = "cpp_network_sort")]
+fn build_and_link_cpp_network_sort() {
+    build_and_link_cpp_sort("cpp_network_sort", None);
+}
+
+#[cfg(not(feature = "cpp_network_sort"))]
+fn build_and_link_cpp_network_sort() {}
+
+#[cfg(feature = "cpp_sortedness")]
+fn build_and_link_cpp_sortedness() {
+    // No -march=native, the descent counting is compiled for AVX2 and AVX-512 with target
+    // attributes and selected at runtime, see cpu_features.h.
+    build_and_link_cpp_sort("cpp_sortedness", None);
+}
+
+#[cfg(not(feature = "cpp_sortedness"))]
+fn build_and_link_cpp_sortedness() {}
+
 #[cfg(feature = "cpp_wikisort")]
 fn build_and_link_cpp_wikisort() {
     build_and_link_cpp_sort(
@@ -269,12 +839,31 @@ fn build_and_link_c_std_sys() {
 #[cfg(not(feature = "c_std_sys"))]
 fn build_and_link_c_std_sys() {}
 
+// Calls the vqsort entry points for i32 and u64 if cpp_vqsort is enabled, see c_fast_qsort.cpp.
+#[cfg(feature = "c_fast_qsort")]
+fn build_and_link_c_fast_qsort() {
+    build_and_link_cpp_sort(
+        "c_fast_qsort",
+        Some(|builder: &mut cc::Build| {
+            if cfg!(feature = "cpp_vqsort") {
+                builder.define("FAST_QSORT_CPP_VQSORT", None);
+            }
+
+            None
+        }),
+    );
+}
+
+#[cfg(not(feature = "c_fast_qsort"))]
+fn build_and_link_c_fast_qsort() {}
+
 #[cfg(feature = "c_crumsort")]
 fn build_and_link_c_crumsort() {
     build_and_link_cpp_sort(
         "c_crumsort",
         Some(|builder: &mut cc::Build| {
             builder.compiler(CLANG_PATH); // clang can generate cmov which yields better perf.
+            define_sort_telemetry(builder);
 
             None
         }),
@@ -289,6 +878,8 @@ fn build_and_link_c_fluxsort() {
     build_and_link_cpp_sort(
         "c_fluxsort",
         Some(|builder: &mut cc::Build| {
+            // For the threads of fluxsort_parallel_stable.
+            builder.flag("-pthread");
             builder.compiler(CLANG_PATH); // clang can generate cmov which yields better perf.
 
             None
@@ -314,6 +905,25 @@ fn build_and_link_cpp_std_sys() {
 #[cfg(not(feature = "cpp_std_sys"))]
 fn build_and_link_cpp_std_sys() {}
 
+#[cfg(feature = "cpp_std_sys_parallel")]
+fn build_and_link_cpp_std_sys_parallel() {
+    build_and_link_cpp_sort(
+        "cpp_std_parallel",
+        Some(|builder: &mut cc::Build| {
+            // libstdc++ implements std::execution::par with TBB, and the wrapper limits the
+            // worker count with tbb::global_control.
+            builder.flag("-pthread");
+
+            println!("cargo:rustc-link-lib=tbb");
+
+            None
+        }),
+    );
+}
+
+#[cfg(not(feature = "cpp_std_sys_parallel"))]
+fn build_and_link_cpp_std_sys_parallel() {}
+
 #[cfg(feature = "cpp_std_libcxx")]
 fn build_and_link_cpp_std_libcxx() {
     build_and_link_cpp_sort(
@@ -347,6 +957,7 @@ fn build_and_link_cpp_std_gcc4_3() {
                 .join("g++-4.3");
 
             builder.compiler(compiler_path).flag("-std=gnu++0x");
+            define_run_prepass(builder);
 
             None
         }),
@@ -356,6 +967,166 @@ fn build_and_link_cpp_std_gcc4_3() {
 #[cfg(not(feature = "cpp_std_gcc4_3"))]
 fn build_and_link_cpp_std_gcc4_3() {}
 
+// Links src/cpp/bench_driver.cpp against the wrappers built above, into
+// target/<profile>/cpp_bench_driver. Wrappers built against libcxx, and the parallel ones that take
+// a thread count, are not part of the driver.
+#[cfg(feature = "cpp_bench_driver")]
+fn build_cpp_bench_driver() {
+    let manifest_dir = PathBuf::from(env::var("CARGO_MANIFEST_DIR").unwrap());
+    let out_dir = PathBuf::from(env::var("OUT_DIR").unwrap());
+
+    let driver_path = manifest_dir
+        .join("src")
+        .join("cpp")
+        .join("bench_driver.cpp");
+    println!("cargo:rerun-if-changed={}", driver_path.display());
+
+    // OUT_DIR is target/<profile>/build/<pkg>-<hash>/out.
+    let exe_path = out_dir.ancestors().nth(3).unwrap().join("cpp_bench_driver");
+
+    let driver_features = [
+        (cfg!(feature = "cpp_std_sys"), "BENCH_CPP_STD_SYS"),
+        (cfg!(feature = "cpp_pdqsort"), "BENCH_CPP_PDQSORT"),
+        (cfg!(feature = "cpp_powersort"), "BENCH_CPP_POWERSORT"),
+        (
+            cfg!(feature = "cpp_simdsort") && is_x86(),
+            "BENCH_CPP_SIMDSORT",
+        ),
+        (cfg!(feature = "cpp_radix"), "BENCH_CPP_RADIX"),
+        (cfg!(feature = "cpp_ips4o"), "BENCH_CPP_IPS4O"),
+        (
+            cfg!(feature = "cpp_blockquicksort"),
+            "BENCH_CPP_BLOCKQUICKSORT",
+        ),
+        (
+            cfg!(feature = "cpp_gerbens_qsort"),
+            "BENCH_CPP_GERBENS_QSORT",
+        ),
+        (cfg!(feature = "cpp_nanosort"), "BENCH_CPP_NANOSORT"),
+        (cfg!(feature = "cpp_wikisort"), "BENCH_CPP_WIKISORT"),
+        (cfg!(feature = "c_std_sys"), "BENCH_C_STD_SYS"),
+        (cfg!(feature = "c_fast_qsort"), "BENCH_C_FAST_QSORT"),
+        (cfg!(feature = "c_crumsort"), "BENCH_C_CRUMSORT"),
+        (cfg!(feature = "c_fluxsort"), "BENCH_C_FLUXSORT"),
+        (
+            cfg!(feature = "singeli_singelisort"),
+            "BENCH_SINGELI_SINGELISORT",
+        ),
+    ];
+
+    let mut driver_builder = cc::Build::new();
+    driver_builder.cpp(true).opt_level(3).debug(false);
+    if cfg!(feature = "cross_language_lto") {
+        // The wrapper archives contain bitcode, only clang and lld can link them.
+        driver_builder.compiler(CLANG_PATH);
+    }
+    let compiler = driver_builder.get_compiler();
+
+    let mut cmd = compiler.to_command();
+    cmd.arg(&driver_path)
+        .arg("-std=c++20")
+        .arg("-DNDEBUG")
+        .arg("-o")
+        .arg(&exe_path)
+        .arg(format!("-L{}", out_dir.display()));
+
+    if cfg!(feature = "cross_language_lto") {
+        cmd.arg("-flto=thin").arg("-fuse-ld=lld");
+    }
+
+    for (_, define) in driver_features.iter().filter(|(enabled, _)| *enabled) {
+        cmd.arg(format!("-D{define}"));
+    }
+
+    if cfg!(feature = "cpp_shared_lib") {
+        // Next to the driver, see build_cpp_shared_lib.
+        let lib_dir = exe_path.parent().unwrap();
+        cmd.arg(format!("-L{}", lib_dir.display()))
+            .arg(format!("-l{CPP_SHARED_LIB_NAME}"))
+            .arg(format!("-Wl,-rpath,{}", lib_dir.display()));
+    } else {
+        for artifact_name in BUILT_ARTIFACTS.lock().unwrap().iter() {
+            cmd.arg(format!("-l{artifact_name}"));
+        }
+    }
+
+    // Same system libraries the wrappers ask cargo to link.
+    cmd.arg("-pthread");
+    cmd.args(PGO_RUNTIME_LINK_ARGS.lock().unwrap().iter());
+    cmd.args(gpu_sort_runtime_link_args());
+    if cfg!(feature = "cpp_ips4o_parallel") {
+        cmd.arg("-ltbb").arg("-latomic");
+    }
+
+    let status = cmd.status().expect("Failed to run the C++ compiler");
+    assert!(status.success(), "Failed to build {}", exe_path.display());
+}
+
+#[cfg(not(feature = "cpp_bench_driver"))]
+fn build_cpp_bench_driver() {}
+
+#[allow(dead_code)]
+const CPP_SHARED_LIB_NAME: &str = "sort_research_cpp";
+
+// Links the static libraries of all wrappers into one shared library, that the Rust binaries link
+// instead of the static libraries. Only the extern "C" entry points are exported, everything with a
+// mangled C++ name stays internal. The template instantiations the wrappers have in common, like
+// the comparison wrappers of shared.h and the std::sort fallbacks, are then kept once.
+#[cfg(feature = "cpp_shared_lib")]
+fn build_cpp_shared_lib() {
+    assert!(
+        !cfg!(feature = "cross_language_lto"),
+        "cpp_shared_lib can't be combined with cross_language_lto, the Rust code has to be linked \
+         together with the bitcode of the wrappers"
+    );
+
+    let out_dir = PathBuf::from(env::var("OUT_DIR").unwrap());
+
+    // OUT_DIR is target/<profile>/build/<pkg>-<hash>/out.
+    let lib_dir = out_dir.ancestors().nth(3).unwrap().to_path_buf();
+    let lib_path = lib_dir.join(format!("lib{CPP_SHARED_LIB_NAME}.so"));
+
+    let version_script_path = out_dir.join("cpp_shared_lib.map");
+    std::fs::write(&version_script_path, "{ global: *; local: _Z*; };\n").unwrap();
+
+    let compiler = cc::Build::new().cpp(true).get_compiler();
+
+    let mut cmd = compiler.to_command();
+    cmd.arg("-shared")
+        .arg("-o")
+        .arg(&lib_path)
+        .arg(format!("-L{}", out_dir.display()))
+        .arg(format!(
+            "-Wl,--version-script={}",
+            version_script_path.display()
+        ))
+        .arg("-Wl,--whole-archive");
+
+    for artifact_name in BUILT_ARTIFACTS.lock().unwrap().iter() {
+        cmd.arg(format!("-l{artifact_name}"));
+    }
+
+    cmd.arg("-Wl,--no-whole-archive");
+
+    // Same system libraries the wrappers ask cargo to link.
+    cmd.arg("-pthread");
+    cmd.args(PGO_RUNTIME_LINK_ARGS.lock().unwrap().iter());
+    cmd.args(gpu_sort_runtime_link_args());
+    if cfg!(feature = "cpp_ips4o_parallel") {
+        cmd.arg("-ltbb").arg("-latomic");
+    }
+
+    let status = cmd.status().expect("Failed to run the C++ compiler");
+    assert!(status.success(), "Failed to link the C++ shared library");
+
+    println!("cargo:rustc-link-search={}", lib_dir.display());
+    println!("cargo:rustc-link-lib=dylib={CPP_SHARED_LIB_NAME}");
+    println!("cargo:rustc-link-arg=-Wl,-rpath,{}", lib_dir.display());
+}
+
+#[cfg(not(feature = "cpp_shared_lib"))]
+fn build_cpp_shared_lib() {}
+
 fn main() {
     let manifest_dir = PathBuf::from(env::var("CARGO_MANIFEST_DIR").unwrap());
     let build_rs_path = manifest_dir.join("build.rs").canonicalize().unwrap();
@@ -363,22 +1134,42 @@ fn main() {
     // By default without this line, cargo re-runs the build script for all source changes.
     println!("cargo:rerun-if-changed={}", build_rs_path.display());
 
+    // Static libraries are searched in link order, the one that calls into the others has to come
+    // first.
+    build_and_link_cpp_adaptive();
+
     build_and_link_cpp_pdqsort();
     build_and_link_cpp_powersort();
+    build_and_link_cpp_powersort_parallel();
     build_and_link_cpp_simdsort();
     build_and_link_cpp_vqsort();
     build_and_link_cpp_intel_avx512();
+    build_and_link_cpp_radix();
+    build_and_link_cpp_gpu_sort();
     build_and_link_singelisort();
     build_and_link_golang_std();
     build_and_link_cpp_ips4o();
+    build_and_link_cpp_ips4o_parallel();
     build_and_link_cpp_blockquicksort();
     build_and_link_cpp_gerbens_qsort();
     build_and_link_cpp_nanosort();
+    build_and_link_cpp_network_sort();
+    build_and_link_cpp_sortedness();
     build_and_link_cpp_wikisort();
     build_and_link_c_std_sys();
+    build_and_link_c_fast_qsort();
     build_and_link_c_crumsort();
     build_and_link_c_fluxsort();
     build_and_link_cpp_std_sys();
+    build_and_link_cpp_std_sys_parallel();
     build_and_link_cpp_std_libcxx();
     build_and_link_cpp_std_gcc4_3();
+
+    link_cpp_pgo_runtime();
+    link_wasm32_cpp_runtime();
+    warn_x86_only_features();
+
+    // Has to come last, they link the artifacts of all the other steps.
+    build_cpp_shared_lib();
+    build_cpp_bench_driver();
 }
@@ -0,0 +1,34 @@
+#![no_main]
+
+use std::sync::Mutex;
+
+use libfuzzer_sys::fuzz_target;
+use once_cell::sync::Lazy;
+
+use sort_research_rs_fuzz::perf::{self, Config, Corpus};
+use sort_research_rs_fuzz::util;
+
+static STATE: Lazy<Mutex<(Config, Corpus)>> = Lazy::new(|| {
+    let config = Config::from_env();
+    let corpus = Corpus::open(&config);
+    Mutex::new((config, corpus))
+});
+
+fuzz_target!(|data: &[u8]| {
+    let v: Vec<i32> = util::u8_as_x(data);
+    let mut state = STATE.lock().unwrap();
+    let (config, corpus) = &mut *state;
+
+    let input_score = perf::score(perf::cost(config, &v), v.len());
+    perf::feedback(v.len(), input_score);
+
+    if corpus.offer(&v, input_score) {
+        println!(
+            "{} len {}: new slowest input, {:.2} {:?} per n * log2(n)",
+            config.target.name,
+            v.len(),
+            input_score,
+            config.metric
+        );
+    }
+});
@@ -1 +1,2 @@
+pub mod perf;
 pub mod util;
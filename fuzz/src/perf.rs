@@ -0,0 +1,295 @@
+//! Performance guided fuzzing, looking for inputs that make a sort slow instead of wrong.
+//!
+//! The cost of sorting an input is either its number of comparisons, counted like `MEASURE_COMP`
+//! through `sort_by`, or the cycles of the fastest of a few runs of `sort`. Divided by n * log2(n)
+//! it gives a score that is comparable across lengths. `feedback` turns the score into coverage
+//! libFuzzer can see, so inputs that are slower than any before are kept and mutated further.
+//!
+//! The slowest input of every power of two length bucket is stored in the corpus directory, as
+//! native endian i32 values in `<len>.i32`. The `perf_corpus` bench pattern replays them.
+
+use std::cmp::Ordering;
+use std::collections::HashMap;
+use std::env;
+use std::fs;
+use std::hint::black_box;
+use std::path::{Path, PathBuf};
+
+#[allow(unused_imports)]
+use sort_research_rs::{other, unstable};
+use sort_test_tools::Sort;
+
+type SortByFn = fn(&mut [i32], &mut dyn FnMut(&i32, &i32) -> Ordering);
+
+pub struct Target {
+    pub name: String,
+    pub sort: fn(&mut [i32]),
+    /// `None` for the sorts without comparison function support, they can only be timed.
+    pub sort_by: Option<SortByFn>,
+}
+
+/// The sorts enabled via the features of the fuzz crate.
+pub fn targets() -> Vec<Target> {
+    let mut targets = Vec::new();
+
+    macro_rules! add_target {
+        ($sort_impl_path:path) => {{
+            use $sort_impl_path::*;
+
+            targets.push(Target {
+                name: <SortImpl as Sort>::name(),
+                sort: <SortImpl as Sort>::sort::<i32>,
+                sort_by: Some(|data, compare| <SortImpl as Sort>::sort_by(data, compare)),
+            });
+        }};
+        ($sort_impl_path:path, timed_only) => {{
+            use $sort_impl_path::*;
+
+            targets.push(Target {
+                name: <SortImpl as Sort>::name(),
+                sort: <SortImpl as Sort>::sort::<i32>,
+                sort_by: None,
+            });
+        }};
+    }
+
+    add_target!(unstable::rust_ipnsort);
+
+    #[cfg(feature = "cpp_pdqsort")]
+    add_target!(unstable::cpp_pdqsort);
+
+    #[cfg(feature = "cpp_nanosort")]
+    add_target!(unstable::cpp_nanosort);
+
+    #[cfg(feature = "cpp_gerbens_qsort")]
+    add_target!(unstable::cpp_gerbens_qsort);
+
+    #[cfg(feature = "cpp_blockquicksort")]
+    add_target!(unstable::cpp_blockquicksort);
+
+    #[cfg(feature = "cpp_ips4o")]
+    add_target!(unstable::cpp_ips4o);
+
+    #[cfg(feature = "c_crumsort")]
+    add_target!(unstable::c_crumsort);
+
+    #[cfg(feature = "cpp_vqsort")]
+    add_target!(other::cpp_vqsort, timed_only);
+
+    #[cfg(feature = "cpp_intel_avx512")]
+    add_target!(other::cpp_intel_avx512, timed_only);
+
+    #[cfg(feature = "cpp_simdsort")]
+    add_target!(other::cpp_simdsort, timed_only);
+
+    #[cfg(feature = "cpp_radix")]
+    add_target!(other::cpp_radix, timed_only);
+
+    targets
+}
+
+#[derive(Copy, Clone, Debug, PartialEq, Eq)]
+pub enum Metric {
+    Comparisons,
+    Cycles,
+}
+
+pub struct Config {
+    pub target: Target,
+    pub metric: Metric,
+    pub corpus_dir: PathBuf,
+}
+
+impl Config {
+    /// Configured via environment variables, libFuzzer owns the command line:
+    /// - `FUZZ_PERF_SORT`, the `Sort::name` of the target, by default ipnsort.
+    /// - `FUZZ_PERF_METRIC`, `comparisons` or `cycles`. By default comparisons if the target
+    ///   supports a comparison function.
+    /// - `FUZZ_PERF_CORPUS`, the directory the slowest inputs are stored in, by default
+    ///   `perf_corpus/<sort>`.
+    pub fn from_env() -> Self {
+        let sort_name =
+            env::var("FUZZ_PERF_SORT").unwrap_or_else(|_| "rust_ipnsort_unstable".into());
+        let target = targets()
+            .into_iter()
+            .find(|target| target.name == sort_name)
+            .unwrap_or_else(|| {
+                let names: Vec<String> = targets().into_iter().map(|target| target.name).collect();
+                panic!("Unknown FUZZ_PERF_SORT '{sort_name}', enabled are: {names:?}")
+            });
+
+        let metric = match env::var("FUZZ_PERF_METRIC").as_deref() {
+            Ok("comparisons") => {
+                assert!(
+                    target.sort_by.is_some(),
+                    "{sort_name} doesn't support comparison functions, use FUZZ_PERF_METRIC=cycles"
+                );
+                Metric::Comparisons
+            }
+            Ok("cycles") => Metric::Cycles,
+            Ok(other) => panic!("Unknown FUZZ_PERF_METRIC '{other}'"),
+            Err(_) if target.sort_by.is_some() => Metric::Comparisons,
+            Err(_) => Metric::Cycles,
+        };
+
+        let corpus_dir = env::var("FUZZ_PERF_CORPUS")
+            .map(PathBuf::from)
+            .unwrap_or_else(|_| Path::new("perf_corpus").join(&sort_name));
+
+        Self {
+            target,
+            metric,
+            corpus_dir,
+        }
+    }
+}
+
+fn read_cycles() -> u64 {
+    #[cfg(target_arch = "x86_64")]
+    {
+        // SAFETY: rdtsc is available on every x86_64 CPU.
+        unsafe { std::arch::x86_64::_rdtsc() }
+    }
+
+    #[cfg(not(target_arch = "x86_64"))]
+    {
+        use std::time::Instant;
+
+        static START: std::sync::OnceLock<Instant> = std::sync::OnceLock::new();
+        START.get_or_init(Instant::now).elapsed().as_nanos() as u64
+    }
+}
+
+/// Comparisons or cycles of sorting `data`.
+pub fn cost(config: &Config, data: &[i32]) -> u64 {
+    match config.metric {
+        Metric::Comparisons => {
+            let sort_by = config.target.sort_by.unwrap();
+            let mut v = data.to_vec();
+            let mut comp_count = 0u64;
+            sort_by(&mut v, &mut |a: &i32, b: &i32| {
+                comp_count += 1;
+                a.cmp(b)
+            });
+            comp_count
+        }
+        Metric::Cycles => {
+            // Fastest of a few runs, the first one also pays for the page faults.
+            (0..3)
+                .map(|_| {
+                    let mut v = data.to_vec();
+                    let start = read_cycles();
+                    (config.target.sort)(black_box(&mut v));
+                    read_cycles().saturating_sub(start)
+                })
+                .min()
+                .unwrap()
+        }
+    }
+}
+
+/// `cost` per n * log2(n).
+pub fn score(cost: u64, len: usize) -> f64 {
+    let len = len.max(2) as f64;
+    cost as f64 / (len * len.log2())
+}
+
+/// Power of two length bucket of `len`.
+pub fn len_bucket(len: usize) -> usize {
+    len.max(1).ilog2() as usize
+}
+
+// Every bucket gets its own copy of the loop, so that the edge counters of one bucket are not
+// saturated by another.
+#[inline(never)]
+fn spin<const BUCKET: usize>(iterations: usize) {
+    for i in 0..iterations {
+        black_box(i);
+    }
+}
+
+/// Turns `score` into coverage. libFuzzer counts how often every edge is hit, in buckets of 1, 2,
+/// 3, 4-7, 8-15, 16-31, 32-127 and 128+. Looping once per eighth of the score crosses into a new
+/// bucket, and so a new feature, whenever the score grows past 1/8, 1/4, 3/8, 1/2, 1, 2, 4 and
+/// 16.
+pub fn feedback(len: usize, score: f64) {
+    let iterations = ((score * 8.0) as usize).min(255);
+
+    macro_rules! spin_bucket {
+        ($($bucket:literal)*) => {
+            match len_bucket(len) {
+                $($bucket => spin::<$bucket>(iterations),)*
+                _ => spin::<32>(iterations),
+            }
+        };
+    }
+
+    spin_bucket!(0 1 2 3 4 5 6 7 8 9 10 11 12 13 14 15 16 17 18 19 20 21 22 23 24);
+}
+
+/// The slowest input seen so far for every length bucket, mirrored in the corpus directory.
+pub struct Corpus {
+    dir: PathBuf,
+    best: HashMap<usize, (f64, PathBuf)>,
+}
+
+/// Reads native endian i32 values, ignoring a trailing partial value.
+pub fn read_values(bytes: &[u8]) -> Vec<i32> {
+    bytes
+        .chunks_exact(4)
+        .map(|chunk| i32::from_ne_bytes(chunk.try_into().unwrap()))
+        .collect()
+}
+
+impl Corpus {
+    /// Opens the corpus in `config.corpus_dir`, and scores the inputs already in it.
+    pub fn open(config: &Config) -> Self {
+        fs::create_dir_all(&config.corpus_dir).expect("Failed to create the perf corpus dir");
+
+        let mut corpus = Self {
+            dir: config.corpus_dir.clone(),
+            best: HashMap::new(),
+        };
+
+        for entry in fs::read_dir(&config.corpus_dir).unwrap().flatten() {
+            let path = entry.path();
+            if path.extension().map_or(true, |ext| ext != "i32") {
+                continue;
+            }
+
+            let data = read_values(&fs::read(&path).unwrap());
+            let input_score = score(cost(config, &data), data.len());
+            let bucket = len_bucket(data.len());
+            match corpus.best.get(&bucket) {
+                Some((best_score, _)) if *best_score >= input_score => {}
+                _ => {
+                    corpus.best.insert(bucket, (input_score, path));
+                }
+            }
+        }
+
+        corpus
+    }
+
+    /// Stores `data` if it's the slowest input of its length bucket. Returns true if it was.
+    pub fn offer(&mut self, data: &[i32], input_score: f64) -> bool {
+        let bucket = len_bucket(data.len());
+        if let Some((best_score, _)) = self.best.get(&bucket) {
+            if *best_score >= input_score {
+                return false;
+            }
+        }
+
+        let path = self.dir.join(format!("{}.i32", data.len()));
+        let bytes: Vec<u8> = data.iter().flat_map(|val| val.to_ne_bytes()).collect();
+        fs::write(&path, bytes).expect("Failed to write perf corpus input");
+
+        if let Some((_, old_path)) = self.best.insert(bucket, (input_score, path.clone())) {
+            if old_path != path {
+                let _ = fs::remove_file(old_path);
+            }
+        }
+
+        true
+    }
+}
@@ -7,7 +7,10 @@
     specialization,
     core_intrinsics,
     sized_type_properties,
-    const_mut_refs
+    const_mut_refs,
+    portable_simd,
+    unboxed_closures,
+    fn_traits
 )]
 
 use core::cmp::Ordering;
@@ -17,6 +20,7 @@ use core::mem::SizedTypeProperties;
 mod heapsort;
 mod pivot;
 mod quicksort;
+mod simd_network;
 mod smallsort;
 
 /// Sorts the slice, but might not preserve the order of equal elements.
@@ -50,7 +54,7 @@ pub fn sort<T>(arr: &mut [T])
 where
     T: Ord,
 {
-    unstable_sort(arr, |a, b| a.lt(b));
+    unstable_sort(arr, NaturalLess);
 }
 
 /// Sorts the slice with a comparator function, but might not preserve the order of equal
@@ -107,8 +111,67 @@ where
     unstable_sort(arr, |a, b| compare(a, b) == Ordering::Less);
 }
 
+/// Sorts the slice in parallel with up to `num_threads` threads, but might not preserve the order
+/// of equal elements.
+///
+/// Uses the same algorithm as [`sort`]. After each partition the two sides are independent and
+/// are sorted by separate threads, until every thread has its own part of the slice. Slices that
+/// are too short to benefit, or `num_threads <= 1`, are sorted on the calling thread.
+#[inline(always)]
+pub fn par_sort<T>(arr: &mut [T], num_threads: usize)
+where
+    T: Ord + Send + Sync,
+{
+    par_unstable_sort(arr, &NaturalLess, num_threads);
+}
+
+/// Sorts the slice in parallel with a comparator function, but might not preserve the order of
+/// equal elements.
+///
+/// See [`par_sort`] and [`sort_by`]. The comparator function is shared between the threads.
+#[inline(always)]
+pub fn par_sort_by<T, F>(arr: &mut [T], compare: F, num_threads: usize)
+where
+    T: Send + Sync,
+    F: Fn(&T, &T) -> Ordering + Sync,
+{
+    par_unstable_sort(
+        arr,
+        &|a: &T, b: &T| compare(a, b) == Ordering::Less,
+        num_threads,
+    );
+}
+
 // --- IMPL ---
 
+/// `is_less` of the natural order, `a.lt(b)`. Unlike a closure it is a named type, which allows
+/// the small-sort to recognize it and use SIMD sorting networks for primitive integers.
+#[derive(Copy, Clone)]
+struct NaturalLess;
+
+impl<T: Ord> FnOnce<(&T, &T)> for NaturalLess {
+    type Output = bool;
+
+    #[inline(always)]
+    extern "rust-call" fn call_once(self, (a, b): (&T, &T)) -> bool {
+        a.lt(b)
+    }
+}
+
+impl<T: Ord> FnMut<(&T, &T)> for NaturalLess {
+    #[inline(always)]
+    extern "rust-call" fn call_mut(&mut self, (a, b): (&T, &T)) -> bool {
+        a.lt(b)
+    }
+}
+
+impl<T: Ord> Fn<(&T, &T)> for NaturalLess {
+    #[inline(always)]
+    extern "rust-call" fn call(&self, (a, b): (&T, &T)) -> bool {
+        a.lt(b)
+    }
+}
+
 /// Sorts `v` using pattern-defeating quicksort, which is *O*(*n* \* log(*n*)) worst-case.
 #[inline(always)]
 fn unstable_sort<T, F>(v: &mut [T], mut is_less: F)
@@ -170,6 +233,50 @@ where
     crate::quicksort::quicksort(v, None, limit, is_less);
 }
 
+/// Parallel version of [`unstable_sort`].
+#[inline(always)]
+fn par_unstable_sort<T, F>(v: &mut [T], is_less: &F, num_threads: usize)
+where
+    T: Send + Sync,
+    F: Fn(&T, &T) -> bool + Sync,
+{
+    if T::IS_ZST {
+        return;
+    }
+
+    if num_threads <= 1 || v.len() < crate::quicksort::MIN_PARALLEL_LEN {
+        unstable_sort(v, is_less);
+        return;
+    }
+
+    par_ipnsort(v, is_less, num_threads);
+}
+
+/// Parallel version of [`ipnsort`].
+#[inline(never)]
+fn par_ipnsort<T, F>(v: &mut [T], is_less: &F, num_threads: usize)
+where
+    T: Send + Sync,
+    F: Fn(&T, &T) -> bool + Sync,
+{
+    let len = v.len();
+    let (run_len, was_reversed) = find_existing_run(v, &mut { is_less });
+
+    // SAFETY: find_existing_run promises to return a valid run_len.
+    unsafe { intrinsics::assume(run_len <= len) };
+
+    if run_len == len {
+        if was_reversed {
+            v.reverse();
+        }
+
+        return;
+    }
+
+    let limit = 2 * (len | 1).ilog2();
+    crate::quicksort::par_quicksort(v, None, limit, is_less, num_threads);
+}
+
 /// Finds a run of sorted elements starting at the beginning of the slice.
 ///
 /// Returns the length of the run, and a bool that is false when the run
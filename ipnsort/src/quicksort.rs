@@ -77,6 +77,91 @@ pub(crate) fn quicksort<'a, T, F>(
     }
 }
 
+/// Slices shorter than this are not worth handing to another thread, spawning one costs about as
+/// much as sorting a few thousand integers.
+pub(crate) const MIN_PARALLEL_LEN: usize = 16_384;
+
+/// Parallel version of [`quicksort`], using up to `num_threads` threads.
+///
+/// The two sides of a partition are independent, so the left side is sorted by a new thread that
+/// gets a share of `num_threads` proportional to its length, while the current thread continues
+/// with the right side and the rest. Sides that are left with a single thread are sorted with
+/// [`quicksort`].
+pub(crate) fn par_quicksort<T, F>(
+    v: &mut [T],
+    ancestor_pivot: Option<&T>,
+    limit: u32,
+    is_less: &F,
+    num_threads: usize,
+) where
+    T: Send + Sync,
+    F: Fn(&T, &T) -> bool + Sync,
+{
+    std::thread::scope(|scope| {
+        par_quicksort_loop(scope, v, ancestor_pivot, limit, is_less, num_threads);
+    });
+}
+
+fn par_quicksort_loop<'scope, 'env, T, F>(
+    scope: &'scope std::thread::Scope<'scope, 'env>,
+    mut v: &'env mut [T],
+    mut ancestor_pivot: Option<&'env T>,
+    mut limit: u32,
+    is_less: &'env F,
+    mut num_threads: usize,
+) where
+    T: Send + Sync,
+    F: Fn(&T, &T) -> bool + Sync,
+{
+    let mut is_less_mut = is_less;
+
+    loop {
+        if num_threads <= 1 || v.len() < MIN_PARALLEL_LEN || limit == 0 {
+            quicksort(v, ancestor_pivot, limit, &mut is_less_mut);
+            return;
+        }
+
+        limit -= 1;
+
+        // Same pivot selection and handling of equal elements as in `quicksort`.
+        let pivot_pos = crate::pivot::choose_pivot(v, &mut is_less_mut);
+
+        if let Some(p) = ancestor_pivot {
+            // SAFETY: We assume choose_pivot yields an in-bounds position.
+            if !is_less(p, unsafe { v.get_unchecked(pivot_pos) }) {
+                let num_lt = partition(v, pivot_pos, &mut |a, b| !is_less(b, a));
+                v = &mut v[(num_lt + 1)..];
+                ancestor_pivot = None;
+                continue;
+            }
+        }
+
+        let num_lt = partition(v, pivot_pos, &mut is_less_mut);
+        // SAFETY: partition ensures that `num_lt` will be in-bounds.
+        unsafe { intrinsics::assume(num_lt < v.len()) };
+
+        let len = v.len();
+        let (left, right) = v.split_at_mut(num_lt);
+        let (pivot, right) = right.split_at_mut(1);
+        let pivot = &pivot[0];
+
+        // Rounded to the nearest, and the current thread always keeps one for the right side.
+        let left_threads = ((num_threads * left.len() + len / 2) / len).min(num_threads - 1);
+
+        if left_threads == 0 {
+            quicksort(left, ancestor_pivot, limit, &mut is_less_mut);
+        } else {
+            scope.spawn(move || {
+                par_quicksort_loop(scope, left, ancestor_pivot, limit, is_less, left_threads);
+            });
+            num_threads -= left_threads;
+        }
+
+        v = right;
+        ancestor_pivot = Some(pivot);
+    }
+}
+
 // TODO move to main docs.
 // Instead of swapping one pair at the time, it is more efficient to perform a cyclic
 // permutation. This is not strictly equivalent to swapping, but produces a similar
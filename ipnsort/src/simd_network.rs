@@ -0,0 +1,169 @@
+//! Bitonic sorting networks in SIMD registers for the small-sort of primitive integers.
+//!
+//! Unlike the scalar networks in `smallsort`, these don't call `is_less` and are only valid for the
+//! natural order of the type, see [`NaturalLess`]. Inputs of up to 32 elements are padded with
+//! `MAX` to 8, 16 or 32 lanes, the padding sorts to the end and is dropped afterwards. Written with
+//! portable SIMD, so they compile to NEON on aarch64. On x86_64 they are used with AVX2 for 32-bit
+//! and with AVX-512 for 64-bit integers.
+
+use core::simd::cmp::SimdOrd;
+use core::simd::{simd_swizzle, Mask, Simd, SimdElement};
+
+use crate::NaturalLess;
+
+/// Sorts `v` with a SIMD sorting network if `Self` is the natural order of `T`, and returns
+/// whether it did.
+pub(crate) trait SimdSmallSort<T> {
+    fn small_sort_simd(v: &mut [T]) -> bool;
+}
+
+impl<T, F> SimdSmallSort<T> for F {
+    #[inline(always)]
+    default fn small_sort_simd(_v: &mut [T]) -> bool {
+        false
+    }
+}
+
+impl<T: SimdNetworkKey> SimdSmallSort<T> for NaturalLess {
+    #[inline(always)]
+    fn small_sort_simd(v: &mut [T]) -> bool {
+        sort_network(v)
+    }
+}
+
+// The parallel sort shares the comparison function by reference.
+impl<T, F: SimdSmallSort<T>> SimdSmallSort<T> for &F {
+    #[inline(always)]
+    fn small_sort_simd(v: &mut [T]) -> bool {
+        F::small_sort_simd(v)
+    }
+}
+
+/// Max input length of the networks.
+pub(crate) const SIMD_NETWORK_MAX_LEN: usize = 32;
+
+pub(crate) trait SimdNetworkKey: Sized {
+    /// Sorts `v`, which must not be longer than `SIMD_NETWORK_MAX_LEN`.
+    fn sort_network(v: &mut [Self]);
+}
+
+#[inline(always)]
+fn sort_network<T: SimdNetworkKey>(v: &mut [T]) -> bool {
+    if v.len() > SIMD_NETWORK_MAX_LEN {
+        return false;
+    }
+
+    // AVX2 has no 64-bit min and max, emulating them costs about as much as the networks save.
+    #[cfg(target_arch = "x86_64")]
+    if core::mem::size_of::<T>() == 8 {
+        if std::is_x86_feature_detected!("avx512f") {
+            // SAFETY: We checked that AVX-512 is available.
+            unsafe { sort_network_avx512(v) };
+            return true;
+        }
+    } else if std::is_x86_feature_detected!("avx2") {
+        // SAFETY: We checked that AVX2 is available.
+        unsafe { sort_network_avx2(v) };
+        return true;
+    }
+
+    #[cfg(target_arch = "aarch64")]
+    {
+        T::sort_network(v);
+        return true;
+    }
+
+    #[allow(unreachable_code)]
+    false
+}
+
+#[cfg(target_arch = "x86_64")]
+#[target_feature(enable = "avx2")]
+unsafe fn sort_network_avx2<T: SimdNetworkKey>(v: &mut [T]) {
+    T::sort_network(v);
+}
+
+#[cfg(target_arch = "x86_64")]
+#[target_feature(enable = "avx512f")]
+unsafe fn sort_network_avx512<T: SimdNetworkKey>(v: &mut [T]) {
+    T::sort_network(v);
+}
+
+/// Lane `i` is compared with lane `i ^ j`.
+const fn partner_lanes<const N: usize>(j: usize) -> [usize; N] {
+    let mut lanes = [0; N];
+    let mut i = 0;
+    while i < N {
+        lanes[i] = i ^ j;
+        i += 1;
+    }
+    lanes
+}
+
+/// In step `(k, j)` of a bitonic sort the blocks of `k` lanes alternate between ascending and
+/// descending order, the lower lane of each pair keeps the min in the ascending ones.
+const fn min_lanes<const N: usize>(k: usize, j: usize) -> [bool; N] {
+    let mut lanes = [false; N];
+    let mut i = 0;
+    while i < N {
+        lanes[i] = ((i & k) == 0) == ((i & j) == 0);
+        i += 1;
+    }
+    lanes
+}
+
+macro_rules! bitonic_sort {
+    ($v:expr, $type:ty, $lanes:literal, [$(($k:literal, $j:literal)),+]) => {{
+        let v: &mut [$type] = $v;
+        let len = v.len();
+
+        let mut padded = [<$type>::MAX; $lanes];
+        padded[..len].copy_from_slice(v);
+        let mut vec = Simd::<$type, $lanes>::from_array(padded);
+
+        $(
+            vec = {
+                const PARTNER_LANES: [usize; $lanes] = partner_lanes::<$lanes>($j);
+                const MIN_LANES: [bool; $lanes] = min_lanes::<$lanes>($k, $j);
+
+                let partner = simd_swizzle!(vec, PARTNER_LANES);
+                Mask::<<$type as SimdElement>::Mask, $lanes>::from_array(MIN_LANES)
+                    .select(vec.simd_min(partner), vec.simd_max(partner))
+            };
+        )+
+
+        v.copy_from_slice(&vec.to_array()[..len]);
+    }};
+}
+
+macro_rules! simd_network_key_impl {
+    ($($type:ty),+) => {
+        $(
+            impl SimdNetworkKey for $type {
+                #[inline(always)]
+                fn sort_network(v: &mut [Self]) {
+                    let len = v.len();
+
+                    if len <= 8 {
+                        bitonic_sort!(v, $type, 8, [
+                            (2, 1), (4, 2), (4, 1), (8, 4), (8, 2), (8, 1)
+                        ]);
+                    } else if len <= 16 {
+                        bitonic_sort!(v, $type, 16, [
+                            (2, 1), (4, 2), (4, 1), (8, 4), (8, 2), (8, 1),
+                            (16, 8), (16, 4), (16, 2), (16, 1)
+                        ]);
+                    } else {
+                        bitonic_sort!(v, $type, 32, [
+                            (2, 1), (4, 2), (4, 1), (8, 4), (8, 2), (8, 1),
+                            (16, 8), (16, 4), (16, 2), (16, 1),
+                            (32, 16), (32, 8), (32, 4), (32, 2), (32, 1)
+                        ]);
+                    }
+                }
+            }
+        )+
+    };
+}
+
+simd_network_key_impl!(i32, u32, i64, u64);
@@ -3,6 +3,7 @@ use core::mem::{self, ManuallyDrop, MaybeUninit};
 use core::ptr;
 use core::slice;
 
+use crate::simd_network::SimdSmallSort;
 use crate::Freeze;
 
 /// Using a trait allows us to specialize on `Freeze` which in turn allows us to make safe
@@ -45,6 +46,10 @@ impl<T: Freeze> UnstableSmallSortTypeImpl for T {
     where
         F: FnMut(&T, &T) -> bool,
     {
+        if <F as SimdSmallSort<T>>::small_sort_simd(v) {
+            return;
+        }
+
         // This construct is used to limit the LLVM IR generated, which saves large amounts of
         // compile-time by only instantiating the code that is needed. Idea by Frank Steffahn.
         (const { inst_unstable_small_sort::<T, F>() })(v, is_less);
@@ -1,7 +1,8 @@
 use std::cmp::Ordering;
-use std::ffi::c_char;
+use std::ffi::{c_char, c_void};
 use std::ptr;
 use std::str;
+use std::sync::Arc;
 
 #[repr(C)]
 pub struct CompResult {
@@ -9,6 +10,202 @@ pub struct CompResult {
     pub is_panic: bool,
 }
 
+/// Describes a plain integer key embedded in a value. Allows the C++ side to generate a fully
+/// inlined comparison function, instead of calling back into Rust for every comparison.
+#[repr(C)]
+#[derive(Copy, Clone, Debug, PartialEq, Eq)]
+pub struct KeyDescriptor {
+    pub offset: usize, // Byte offset of the key inside the value.
+    pub width: u8,     // Size of the key in bytes, one of 1, 2, 4 or 8.
+    pub is_signed: bool,
+    pub is_descending: bool,
+}
+
+impl KeyDescriptor {
+    pub fn new(offset: usize, width: u8, is_signed: bool, is_descending: bool) -> Self {
+        Self {
+            offset,
+            width,
+            is_signed,
+            is_descending,
+        }
+    }
+
+    /// Returns true if the described key lies within a value of type `T`.
+    pub fn is_valid_for<T>(&self) -> bool {
+        matches!(self.width, 1 | 2 | 4 | 8)
+            && self
+                .offset
+                .checked_add(self.width as usize)
+                .is_some_and(|end| end <= std::mem::size_of::<T>())
+    }
+}
+
+/// The values of one column of a columnar table.
+#[derive(Copy, Clone, Debug)]
+pub enum Column<'a> {
+    U32(&'a [u32]),
+    U64(&'a [u64]),
+    I32(&'a [i32]),
+    I64(&'a [i64]),
+    F32(&'a [f32]),
+    F64(&'a [f64]),
+    String(&'a [FFIString]),
+}
+
+impl Column<'_> {
+    pub fn len(&self) -> usize {
+        match self {
+            Column::U32(values) => values.len(),
+            Column::U64(values) => values.len(),
+            Column::I32(values) => values.len(),
+            Column::I64(values) => values.len(),
+            Column::F32(values) => values.len(),
+            Column::F64(values) => values.len(),
+            Column::String(values) => values.len(),
+        }
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.len() == 0
+    }
+}
+
+/// One column of the sort key of a columnar sort.
+#[derive(Copy, Clone, Debug)]
+pub struct SortColumn<'a> {
+    pub column: Column<'a>,
+    pub is_descending: bool,
+    /// Float columns only. NaNs sort before all other values if set, after them otherwise,
+    /// regardless of `is_descending`.
+    pub is_nan_first: bool,
+}
+
+impl<'a> SortColumn<'a> {
+    pub fn new(column: Column<'a>, is_descending: bool) -> Self {
+        Self {
+            column,
+            is_descending,
+            is_nan_first: false,
+        }
+    }
+
+    pub fn nans_first(self) -> Self {
+        Self {
+            is_nan_first: true,
+            ..self
+        }
+    }
+
+    /// Compares two rows by this column, the order the columnar sorts use. -0.0 and 0.0 are
+    /// equal, and so are all NaNs.
+    pub fn compare(&self, a: usize, b: usize) -> Ordering {
+        fn compare_float<F: PartialOrd>(a: F, b: F, is_nan_first: bool) -> Option<Ordering> {
+            // NaNs are the only values that aren't equal to themselves.
+            #[allow(clippy::eq_op)]
+            let (a_is_nan, b_is_nan) = (a != a, b != b);
+            match (a_is_nan, b_is_nan) {
+                (false, false) => None,
+                _ if is_nan_first => Some(b_is_nan.cmp(&a_is_nan)),
+                _ => Some(a_is_nan.cmp(&b_is_nan)),
+            }
+        }
+
+        // NaN placement doesn't depend on the direction.
+        let nan_ordering = match self.column {
+            Column::F32(values) => compare_float(values[a], values[b], self.is_nan_first),
+            Column::F64(values) => compare_float(values[a], values[b], self.is_nan_first),
+            _ => None,
+        };
+        if let Some(ordering) = nan_ordering {
+            return ordering;
+        }
+
+        let ordering = match self.column {
+            Column::U32(values) => values[a].cmp(&values[b]),
+            Column::U64(values) => values[a].cmp(&values[b]),
+            Column::I32(values) => values[a].cmp(&values[b]),
+            Column::I64(values) => values[a].cmp(&values[b]),
+            Column::F32(values) => values[a].partial_cmp(&values[b]).unwrap(),
+            Column::F64(values) => values[a].partial_cmp(&values[b]).unwrap(),
+            Column::String(values) => values[a].cmp(&values[b]),
+        };
+
+        if self.is_descending {
+            ordering.reverse()
+        } else {
+            ordering
+        }
+    }
+
+    /// The C++ side view of the column, only valid as long as the column is borrowed.
+    pub fn descriptor(&self) -> ColumnDescriptor {
+        let (data, kind) = match self.column {
+            Column::U32(values) => (values.as_ptr() as *const c_void, 0),
+            Column::U64(values) => (values.as_ptr() as *const c_void, 1),
+            Column::I32(values) => (values.as_ptr() as *const c_void, 2),
+            Column::I64(values) => (values.as_ptr() as *const c_void, 3),
+            Column::String(values) => (values.as_ptr() as *const c_void, 4),
+            Column::F32(values) => (values.as_ptr() as *const c_void, 5),
+            Column::F64(values) => (values.as_ptr() as *const c_void, 6),
+        };
+
+        ColumnDescriptor {
+            data,
+            kind,
+            is_descending: self.is_descending,
+            is_nan_first: self.is_nan_first,
+        }
+    }
+}
+
+/// Same layout as `ColumnDescriptor` in shared.h, `kind` is one of its `ColumnKind` values.
+#[repr(C)]
+pub struct ColumnDescriptor {
+    pub data: *const c_void,
+    pub kind: u8,
+    pub is_descending: bool,
+    pub is_nan_first: bool,
+}
+
+/// Element operations performed by one call to a `_counted` entry point.
+#[repr(C)]
+#[derive(Copy, Clone, Debug, Default, PartialEq, Eq)]
+pub struct OpCounts {
+    pub comparisons: u64,
+    pub copies: u64,
+    pub moves: u64,
+}
+
+/// Two field record, ordered by `key` then `payload`. Same layout as `KeyPayloadU32` in shared.h.
+#[repr(C)]
+#[derive(Copy, Clone, Debug, Default, PartialEq, Eq, PartialOrd, Ord)]
+pub struct KeyPayloadU32 {
+    pub key: u32,
+    pub payload: u32,
+}
+
+impl KeyPayloadU32 {
+    pub fn new(key: u32, payload: u32) -> Self {
+        Self { key, payload }
+    }
+}
+
+/// Two field record, ordered by `key` then `payload`. Same layout as `KeyPayloadU64` in shared.h,
+/// aligned like a 128-bit integer so it can be sorted as one in place.
+#[repr(C, align(16))]
+#[derive(Copy, Clone, Debug, Default, PartialEq, Eq, PartialOrd, Ord)]
+pub struct KeyPayloadU64 {
+    pub key: u64,
+    pub payload: u64,
+}
+
+impl KeyPayloadU64 {
+    pub fn new(key: u64, payload: u64) -> Self {
+        Self { key, payload }
+    }
+}
+
 #[repr(C)]
 pub struct FFIString {
     data: *mut c_char,
@@ -101,6 +298,115 @@ impl Drop for FFIString {
     }
 }
 
+/// String stored in an arena shared by many values, with its first 8 bytes inlined as a big-endian
+/// integer zero padded at the end. Comparisons that are decided by the prefix never dereference
+/// the arena, unlike `FFIString` where every comparison reads a separate heap allocation.
+#[repr(C)]
+pub struct FFIArenaString {
+    prefix: u64,
+    data: *const u8,
+    len: usize,
+    arena: *const c_void, // Obtained from `Arc::<Vec<u8>>::into_raw`.
+}
+
+// SAFETY: The arena is immutable and its lifetime is managed with an `Arc`.
+unsafe impl Send for FFIArenaString {}
+unsafe impl Sync for FFIArenaString {}
+
+impl FFIArenaString {
+    /// Copies the strings into a single arena, which is freed once all returned values are
+    /// dropped.
+    pub fn from_strs<S: AsRef<str>>(strs: &[S]) -> Vec<Self> {
+        let arena_len = strs.iter().map(|val| val.as_ref().len()).sum();
+        let mut bytes = Vec::with_capacity(arena_len);
+        for val in strs {
+            bytes.extend_from_slice(val.as_ref().as_bytes());
+        }
+
+        let arena = Arc::new(bytes);
+        let mut offset = 0;
+
+        strs.iter()
+            .map(|val| {
+                let len = val.as_ref().len();
+                let data = arena[offset..offset + len].as_ptr();
+                offset += len;
+
+                let mut prefix_bytes = [0u8; 8];
+                let prefix_len = len.min(8);
+                prefix_bytes[..prefix_len].copy_from_slice(&val.as_ref().as_bytes()[..prefix_len]);
+
+                Self {
+                    prefix: u64::from_be_bytes(prefix_bytes),
+                    data,
+                    len,
+                    arena: Arc::into_raw(Arc::clone(&arena)) as *const c_void,
+                }
+            })
+            .collect()
+    }
+
+    pub fn as_str(&self) -> &str {
+        // SAFETY: `data` and `len` describe a valid UTF-8 sub-slice of the arena, which is kept
+        // alive by the reference count this value holds.
+        unsafe { str::from_utf8_unchecked(&*ptr::slice_from_raw_parts(self.data, self.len)) }
+    }
+}
+
+impl PartialEq for FFIArenaString {
+    fn eq(&self, other: &Self) -> bool {
+        self.prefix == other.prefix && self.as_str() == other.as_str()
+    }
+}
+
+impl Eq for FFIArenaString {}
+
+impl PartialOrd for FFIArenaString {
+    fn partial_cmp(&self, other: &Self) -> Option<Ordering> {
+        Some(self.cmp(other))
+    }
+}
+
+impl Ord for FFIArenaString {
+    fn cmp(&self, other: &Self) -> Ordering {
+        match self.prefix.cmp(&other.prefix) {
+            Ordering::Equal => {
+                // Equal prefixes imply that the leading bytes covered by both prefixes are equal.
+                let skip = self.len.min(other.len).min(8);
+                self.as_str().as_bytes()[skip..].cmp(&other.as_str().as_bytes()[skip..])
+            }
+            ord => ord,
+        }
+    }
+}
+
+impl std::fmt::Debug for FFIArenaString {
+    fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
+        write!(f, "{:?}", self.as_str())
+    }
+}
+
+impl Clone for FFIArenaString {
+    fn clone(&self) -> Self {
+        // SAFETY: `arena` was obtained with `Arc::into_raw` and this value holds a count.
+        unsafe { Arc::increment_strong_count(self.arena as *const Vec<u8>) };
+
+        Self {
+            prefix: self.prefix,
+            data: self.data,
+            len: self.len,
+            arena: self.arena,
+        }
+    }
+}
+
+impl Drop for FFIArenaString {
+    fn drop(&mut self) {
+        // SAFETY: See `clone`, every value releases exactly the count it holds.
+        unsafe { Arc::decrement_strong_count(self.arena as *const Vec<u8>) };
+    }
+}
+
 // Very large stack value.
 #[repr(C)]
 #[derive(PartialEq, Eq, Debug, Clone)]
@@ -120,6 +426,18 @@ impl FFIOneKibiByte {
         Self { values }
     }
 
+    /// Starts with `prefix`, the remaining values are zero. Unlike with `new`, the values are
+    /// free to use, e.g. for the fields of a row, and only compared by custom comparisons.
+    pub fn from_prefix(prefix: &[i64]) -> Self {
+        let mut values = [0i64; 128];
+        values[..prefix.len()].copy_from_slice(prefix);
+        Self { values }
+    }
+
+    pub fn values(&self) -> &[i64; 128] {
+        &self.values
+    }
+
     fn as_i64(&self) -> i64 {
         self.values[11] + self.values[55] + self.values[77]
     }
@@ -183,3 +501,45 @@ impl Ord for F128 {
         self.partial_cmp(other).unwrap()
     }
 }
+
+// Floats with a total order. All NaNs compare equal and greater than any other value, -0.0 and
+// 0.0 compare equal. Matches FloatCpp on the C++ side.
+macro_rules! ffi_float_impl {
+    ($name:ident, $float_type:ty) => {
+        #[repr(C)]
+        #[derive(Debug, Clone, Copy)]
+        pub struct $name(pub $float_type);
+
+        impl $name {
+            pub fn new(val: i32) -> Self {
+                Self(val as $float_type)
+            }
+        }
+
+        impl PartialEq for $name {
+            fn eq(&self, other: &Self) -> bool {
+                self.cmp(other) == Ordering::Equal
+            }
+        }
+
+        impl Eq for $name {}
+
+        impl PartialOrd for $name {
+            fn partial_cmp(&self, other: &Self) -> Option<Ordering> {
+                Some(self.cmp(other))
+            }
+        }
+
+        impl Ord for $name {
+            fn cmp(&self, other: &Self) -> Ordering {
+                match self.0.partial_cmp(&other.0) {
+                    Some(ord) => ord,
+                    None => self.0.is_nan().cmp(&other.0.is_nan()),
+                }
+            }
+        }
+    };
+}
+
+ffi_float_impl!(F32, f32);
+ffi_float_impl!(F64, f64);
@@ -212,6 +212,174 @@ pub fn pipe_organ(size: usize) -> Vec<i32> {
     vals
 }
 
+pub fn median_of_3_killer(size: usize) -> Vec<i32> {
+    // Musser's median-of-3 killer, see "Introspective Sorting and Selection Algorithms". A
+    // quicksort that picks the median of the first, middle and last element as pivot only splits
+    // off two elements per partition, and degrades to O(n^2). The construction needs a multiple of
+    // four, the remaining largest values are appended.
+
+    let killer_len = size - (size % 4);
+    let half = killer_len / 2;
+    let mut vals = vec![0; killer_len];
+
+    for i in 1..=half {
+        if i % 2 == 1 {
+            vals[i - 1] = i as i32;
+            vals[i] = (half + i) as i32;
+        }
+        vals[half + i - 1] = (2 * i) as i32;
+    }
+
+    vals.extend(((killer_len + 1)..=size).map(|val| val as i32));
+    vals
+}
+
+pub fn antiqsort(
+    size: usize,
+    sort_by: impl FnOnce(&mut [i32], &mut dyn FnMut(&i32, &i32) -> std::cmp::Ordering),
+) -> Vec<i32> {
+    // McIlroy's adversary, see "A Killer Adversary for Quicksort". Sorts the indices 0..size with
+    // `sort_by`, deciding the values only as the comparisons ask for them. All values start out as
+    // "gas", larger than every decided value. Comparing two gas values freezes one of them to the
+    // next smallest value, preferring the one that looks like the pivot candidate, because it was
+    // the last gas value compared. A quicksort then partitions around the smallest remaining value
+    // over and over again. The result is the input as the sort saw it, and so only adversarial for
+    // the sort that `sort_by` calls, as long as it is deterministic.
+
+    let gas = size as i32;
+    let mut vals = vec![gas; size];
+    let mut solid_count = 0;
+    let mut candidate = 0;
+
+    let mut indices = (0..size as i32).collect::<Vec<_>>();
+    sort_by(&mut indices, &mut |a: &i32, b: &i32| {
+        let (a, b) = (*a as usize, *b as usize);
+
+        if vals[a] == gas && vals[b] == gas {
+            let freeze = if a == candidate { a } else { b };
+            vals[freeze] = solid_count;
+            solid_count += 1;
+        }
+
+        if vals[a] == gas {
+            candidate = a;
+        } else if vals[b] == gas {
+            candidate = b;
+        }
+
+        vals[a].cmp(&vals[b])
+    });
+
+    // Values the sort never had to decide, their order doesn't matter.
+    for val in vals.iter_mut().filter(|val| **val == gas) {
+        *val = solid_count;
+        solid_count += 1;
+    }
+
+    vals
+}
+
+/// Name of the dataset pattern, if a dataset file is given via BENCH_DATASET. Derived from the file
+/// name, e.g. `dataset_access_log` for `/data/access_log.txt`.
+pub fn dataset_name() -> Option<&'static str> {
+    static DATASET_NAME: OnceCell<Option<String>> = OnceCell::new();
+
+    DATASET_NAME
+        .get_or_init(|| {
+            let path = env::var("BENCH_DATASET").ok()?;
+            let stem = std::path::Path::new(&path).file_stem()?.to_string_lossy();
+
+            // Pattern names must not contain '-', the result tooling splits on it.
+            let stem = stem
+                .chars()
+                .map(|c| if c.is_ascii_alphanumeric() { c } else { '_' })
+                .collect::<String>();
+
+            Some(format!("dataset_{stem}"))
+        })
+        .as_deref()
+}
+
+pub fn dataset(size: usize) -> Vec<i32> {
+    // Contiguous window of the file given via BENCH_DATASET, starting at a random position and
+    // wrapping around at the end.
+    //
+    // BENCH_DATASET_FORMAT selects how the file is read:
+    // - `i32`, native endian binary i32 values, used as they are.
+    // - `u64`, native endian binary u64 values.
+    // - `lines`, the default, one value per line. Compared as integers if all of them parse as
+    //    such, and bytewise otherwise, e.g. for URLs or formatted timestamps.
+    //
+    // Everything but `i32` is mapped to the dense rank of each value among all distinct values of
+    // the file. That keeps the order and duplicates of the original data, which is all a
+    // comparison sort can observe, and lets the regular type transforms work on top of it. Radix
+    // sorts in contrast see a smaller key range than the original.
+
+    if size == 0 {
+        return Vec::new();
+    }
+
+    let values = dataset_values();
+    assert!(!values.is_empty(), "BENCH_DATASET file is empty");
+
+    let mut rng = rand::rngs::StdRng::from(new_seed());
+    let start = rng.gen_range(0..values.len());
+
+    values[start..]
+        .iter()
+        .chain(values.iter().cycle())
+        .take(size)
+        .copied()
+        .collect()
+}
+
+/// Name of the perf corpus pattern, if a corpus directory is given via BENCH_PERF_CORPUS.
+/// Derived from the directory name, e.g. `perf_corpus_cpp_nanosort_unstable` for the corpus the
+/// perf fuzz target wrote for nanosort.
+pub fn perf_corpus_name() -> Option<&'static str> {
+    static PERF_CORPUS_NAME: OnceCell<Option<String>> = OnceCell::new();
+
+    PERF_CORPUS_NAME
+        .get_or_init(|| {
+            let path = env::var("BENCH_PERF_CORPUS").ok()?;
+            let name = std::path::Path::new(&path).file_name()?.to_string_lossy();
+
+            // Pattern names must not contain '-', the result tooling splits on it.
+            let name = name
+                .chars()
+                .map(|c| if c.is_ascii_alphanumeric() { c } else { '_' })
+                .collect::<String>();
+
+            Some(format!("perf_corpus_{name}"))
+        })
+        .as_deref()
+}
+
+pub fn perf_corpus(size: usize) -> Vec<i32> {
+    // Replays the slowest inputs found by the perf fuzz target, see fuzz/src/perf.rs. The corpus
+    // holds one `<len>.i32` file of native endian i32 values per power of two length bucket. The
+    // longest input that is not longer than `size` is used, or the shortest if all are longer, and
+    // repeated or cut to `size`. Only exact length matches replay the input as it was found.
+
+    if size == 0 {
+        return Vec::new();
+    }
+
+    let inputs = perf_corpus_inputs();
+    assert!(
+        !inputs.is_empty(),
+        "BENCH_PERF_CORPUS contains no .i32 inputs"
+    );
+
+    let input = inputs
+        .iter()
+        .rev()
+        .find(|input| input.len() <= size)
+        .unwrap_or(&inputs[0]);
+
+    input.iter().cycle().take(size).copied().collect()
+}
+
 static USE_FIXED_SEED: AtomicBool = AtomicBool::new(true);
 
 pub fn disable_fixed_seed() {
@@ -247,6 +415,176 @@ fn new_seed() -> StdRng {
     rand::SeedableRng::seed_from_u64(random_init_seed())
 }
 
+fn perf_corpus_inputs() -> &'static [Vec<i32>] {
+    static INPUTS: OnceCell<Vec<Vec<i32>>> = OnceCell::new();
+
+    INPUTS.get_or_init(|| {
+        let dir =
+            env::var("BENCH_PERF_CORPUS").expect("perf corpus pattern requires BENCH_PERF_CORPUS");
+
+        let mut inputs = std::fs::read_dir(&dir)
+            .unwrap_or_else(|err| panic!("Failed to read BENCH_PERF_CORPUS {dir}: {err}"))
+            .flatten()
+            .map(|entry| entry.path())
+            .filter(|path| path.extension().map_or(false, |ext| ext == "i32"))
+            .map(|path| {
+                std::fs::read(&path)
+                    .unwrap()
+                    .chunks_exact(4)
+                    .map(|chunk| i32::from_ne_bytes(chunk.try_into().unwrap()))
+                    .collect::<Vec<i32>>()
+            })
+            .filter(|input| !input.is_empty())
+            .collect::<Vec<_>>();
+
+        // Shortest first.
+        inputs.sort_by_key(|input| input.len());
+        inputs
+    })
+}
+
+// Distinct lines of the dataset in sorted order, only set for non-integer lines.
+static DATASET_LINES: OnceCell<&'static [&'static [u8]]> = OnceCell::new();
+
+/// The distinct lines of the BENCH_DATASET file in sorted order, if it is read as `lines` and they
+/// don't all parse as integers, e.g. URLs. The values of the dataset pattern are indices into it.
+pub fn dataset_lines() -> Option<&'static [&'static [u8]]> {
+    dataset_name()?;
+    dataset_values();
+
+    DATASET_LINES.get().copied()
+}
+
+fn dataset_values() -> &'static [i32] {
+    static VALUES: OnceCell<&'static [i32]> = OnceCell::new();
+
+    VALUES.get_or_init(|| {
+        let path = env::var("BENCH_DATASET").expect("dataset pattern requires BENCH_DATASET");
+        let format = env::var("BENCH_DATASET_FORMAT").unwrap_or_else(|_| "lines".into());
+
+        // Never unmapped, the values are used for the whole run.
+        let bytes = map_file(&path);
+
+        match format.as_str() {
+            "i32" => {
+                // SAFETY: The mapping is page aligned, and any bit pattern is a valid i32.
+                let (prefix, values, _) = unsafe { bytes.align_to::<i32>() };
+                assert!(prefix.is_empty());
+                values
+            }
+            "u64" => {
+                // SAFETY: The mapping is page aligned, and any bit pattern is a valid u64.
+                let (prefix, values, _) = unsafe { bytes.align_to::<u64>() };
+                assert!(prefix.is_empty());
+                Vec::leak(dense_ranks(values))
+            }
+            "lines" => {
+                let lines = bytes
+                    .split(|&b| b == b'\n')
+                    .map(|line| line.strip_suffix(b"\r").unwrap_or(line))
+                    .filter(|line| !line.is_empty())
+                    .collect::<Vec<_>>();
+
+                let ints = lines
+                    .iter()
+                    .map(|line| std::str::from_utf8(line).ok()?.trim().parse::<i64>().ok())
+                    .collect::<Option<Vec<_>>>();
+
+                Vec::leak(match ints {
+                    Some(ints) => dense_ranks(&ints),
+                    None => {
+                        let distinct = sorted_distinct(&lines);
+                        let ranks = ranks_in(&lines, &distinct);
+                        DATASET_LINES
+                            .set(Vec::leak(distinct.into_iter().copied().collect()))
+                            .unwrap();
+                        ranks
+                    }
+                })
+            }
+            _ => panic!("Unknown BENCH_DATASET_FORMAT '{format}', expected i32, u64 or lines"),
+        }
+    })
+}
+
+fn dense_ranks<T: Ord>(values: &[T]) -> Vec<i32> {
+    ranks_in(values, &sorted_distinct(values))
+}
+
+fn sorted_distinct<T: Ord>(values: &[T]) -> Vec<&T> {
+    let mut distinct = values.iter().collect::<Vec<_>>();
+    distinct.sort_unstable();
+    distinct.dedup();
+
+    assert!(distinct.len() <= i32::MAX as usize);
+
+    distinct
+}
+
+fn ranks_in<T: Ord>(values: &[T], distinct: &[&T]) -> Vec<i32> {
+    values
+        .iter()
+        .map(|val| distinct.binary_search(&val).unwrap() as i32)
+        .collect()
+}
+
+#[cfg(unix)]
+fn map_file(path: &str) -> &'static [u8] {
+    use std::os::raw::{c_int, c_long, c_void};
+    use std::os::unix::io::AsRawFd;
+
+    extern "C" {
+        fn mmap(
+            addr: *mut c_void,
+            len: usize,
+            prot: c_int,
+            flags: c_int,
+            fd: c_int,
+            offset: c_long,
+        ) -> *mut c_void;
+    }
+
+    const PROT_READ: c_int = 1;
+    const MAP_PRIVATE: c_int = 2;
+    const MAP_FAILED: *mut c_void = !0 as *mut c_void;
+
+    let file = std::fs::File::open(path).unwrap_or_else(|err| panic!("{path}: {err}"));
+    let len = file.metadata().unwrap().len() as usize;
+
+    if len == 0 {
+        return &[];
+    }
+
+    // SAFETY: Maps the whole file read-only, the mapping stays valid after the file is closed.
+    // Modifying the file while it's in use is not supported.
+    unsafe {
+        let ptr = mmap(
+            std::ptr::null_mut(),
+            len,
+            PROT_READ,
+            MAP_PRIVATE,
+            file.as_raw_fd(),
+            0,
+        );
+        assert!(ptr != MAP_FAILED, "{path}: mmap failed");
+
+        std::slice::from_raw_parts(ptr as *const u8, len)
+    }
+}
+
+#[cfg(not(unix))]
+fn map_file(path: &str) -> &'static [u8] {
+    let bytes = std::fs::read(path).unwrap_or_else(|err| panic!("{path}: {err}"));
+
+    // Copied into u64 storage, so that the binary formats can be read in place.
+    let mut storage = vec![0u64; bytes.len().div_ceil(8)];
+    // SAFETY: storage holds at least bytes.len() bytes.
+    unsafe {
+        std::ptr::copy_nonoverlapping(bytes.as_ptr(), storage.as_mut_ptr() as *mut u8, bytes.len());
+        std::slice::from_raw_parts(Vec::leak(storage).as_ptr() as *const u8, bytes.len())
+    }
+}
+
 fn random_vec(size: usize) -> Vec<i32> {
     let mut rng = rand::rngs::StdRng::from(new_seed());
 
@@ -5,10 +5,15 @@ use std::fmt::Debug;
 use std::fs;
 use std::io::{self, Write};
 use std::panic::{self, AssertUnwindSafe};
+use std::path::{Path, PathBuf};
 use std::rc::Rc;
+use std::sync::atomic::{AtomicUsize, Ordering as AtomicOrdering};
 use std::sync::Mutex;
 
-use crate::ffi_types::{FFIOneKibiByte, FFIString, F128};
+use crate::ffi_types::{
+    Column, FFIArenaString, FFIOneKibiByte, FFIString, KeyDescriptor, KeyPayloadU32, KeyPayloadU64,
+    OpCounts, SortColumn, F128, F32, F64,
+};
 use crate::patterns;
 use crate::Sort;
 
@@ -97,13 +102,27 @@ fn sort_comp<T: Ord + Clone + Debug, S: Sort>(v: &mut [T]) {
 }
 
 fn test_impl<T: Ord + Clone + Debug, S: Sort>(pattern_fn: impl Fn(usize) -> Vec<T>) {
-    for test_len in TEST_SIZES {
+    test_impl_lens::<T, S>(TEST_SIZES, pattern_fn);
+}
+
+fn test_impl_lens<T: Ord + Clone + Debug, S: Sort>(
+    test_lens: &[usize],
+    pattern_fn: impl Fn(usize) -> Vec<T>,
+) {
+    for test_len in test_lens {
         let mut test_data = pattern_fn(*test_len);
         sort_comp::<T, S>(test_data.as_mut_slice());
     }
 }
 
-fn test_impl_custom(mut test_fn: impl FnMut(usize, fn(usize) -> Vec<i32>)) {
+fn test_impl_custom(test_fn: impl FnMut(usize, fn(usize) -> Vec<i32>)) {
+    test_impl_custom_lens(&TEST_SIZES[..TEST_SIZES.len() - 2], test_fn);
+}
+
+fn test_impl_custom_lens(
+    test_lens: &[usize],
+    mut test_fn: impl FnMut(usize, fn(usize) -> Vec<i32>),
+) {
     let test_pattern_fns: Vec<fn(usize) -> Vec<i32>> = vec![
         patterns::random,
         |size| patterns::random_uniform(size, 0..=(((size as f64).log2().round()) as i32) as i32),
@@ -124,7 +143,7 @@ fn test_impl_custom(mut test_fn: impl FnMut(usize, fn(usize) -> Vec<i32>)) {
     ];
 
     for test_pattern_fn in test_pattern_fns {
-        for test_len in &TEST_SIZES[..TEST_SIZES.len() - 2] {
+        for test_len in test_lens {
             if *test_len < 2 {
                 continue;
             }
@@ -233,6 +252,246 @@ pub fn random_type_u128<S: Sort>() {
     });
 }
 
+pub fn random_type_i8<S: Sort>() {
+    test_impl::<i8, S>(|size| {
+        patterns::random(size)
+            .iter()
+            .map(|val| *val as i8)
+            .collect()
+    });
+}
+
+pub fn random_type_u8<S: Sort>() {
+    test_impl::<u8, S>(|size| {
+        patterns::random(size)
+            .iter()
+            .map(|val| *val as u8)
+            .collect()
+    });
+}
+
+pub fn random_type_i16<S: Sort>() {
+    test_impl::<i16, S>(|size| {
+        patterns::random(size)
+            .iter()
+            .map(|val| *val as i16)
+            .collect()
+    });
+}
+
+pub fn random_type_u16<S: Sort>() {
+    test_impl::<u16, S>(|size| {
+        patterns::random(size)
+            .iter()
+            .map(|val| *val as u16)
+            .collect()
+    });
+}
+
+// For entry points outside of the Sort trait, for example a fixed code path of a sort that
+// otherwise picks one at runtime.
+fn sort_fn_impl<T: Ord + Clone + Debug>(
+    sort: impl Fn(&mut [T]),
+    transform: impl Fn(i32) -> T,
+    edge_values: &[T],
+) {
+    let sort_fn_comp = |mut test_data: Vec<T>| {
+        let mut expected = test_data.clone();
+        expected.sort();
+
+        sort(&mut test_data);
+        assert_eq!(test_data, expected);
+    };
+
+    sort_fn_comp(Vec::new());
+
+    test_impl_custom(|test_len, pattern_fn| {
+        sort_fn_comp(pattern_fn(test_len).into_iter().map(&transform).collect());
+    });
+
+    let mut with_edges: Vec<T> = patterns::random(TEST_SIZES[TEST_SIZES.len() - 2])
+        .into_iter()
+        .map(&transform)
+        .collect();
+    with_edges.extend_from_slice(edge_values);
+    with_edges.extend_from_slice(edge_values);
+    sort_fn_comp(with_edges);
+
+    sort_fn_comp(edge_values.to_vec());
+}
+
+pub fn sort_fn_i32(sort: impl Fn(&mut [i32])) {
+    sort_fn_impl(sort, |val| val, &[i32::MIN, i32::MAX, 0, -1, 1]);
+}
+
+pub fn sort_fn_u64(sort: impl Fn(&mut [u64])) {
+    sort_fn_impl(
+        sort,
+        |val| val as u64,
+        &[u64::MIN, u64::MAX, u64::MAX - 1, 1 << 63],
+    );
+}
+
+pub fn sort_fn_i16(sort: impl Fn(&mut [i16])) {
+    sort_fn_impl(sort, |val| val as i16, &[i16::MIN, i16::MAX, 0, -1, 1]);
+}
+
+pub fn sort_fn_u16(sort: impl Fn(&mut [u16])) {
+    sort_fn_impl(
+        sort,
+        |val| val as u16,
+        &[u16::MIN, u16::MAX, u16::MAX - 1, 1 << 15],
+    );
+}
+
+pub fn sort_fn_f128(sort: impl Fn(&mut [F128])) {
+    sort_fn_impl(sort, F128::new, &[F128::new(i32::MIN), F128::new(i32::MAX)]);
+}
+
+pub fn sort_fn_large_val(sort: impl Fn(&mut [FFIOneKibiByte])) {
+    sort_fn_impl(
+        sort,
+        FFIOneKibiByte::new,
+        &[FFIOneKibiByte::new(i32::MIN), FFIOneKibiByte::new(i32::MAX)],
+    );
+}
+
+/// Same as `sort_fn_large_val` for `test_lens`, but every value also carries its original index
+/// outside of the compared fields, so that the result only equals the one of `slice::sort` if
+/// `sort` is stable.
+pub fn stability_fn_large_val_lens(sort: impl Fn(&mut [FFIOneKibiByte]), test_lens: &[usize]) {
+    for &test_len in test_lens {
+        let mut test_data: Vec<FFIOneKibiByte> = patterns::random_uniform(test_len, 0..=9)
+            .into_iter()
+            .enumerate()
+            .map(|(i, val)| {
+                // Only values[11], values[55] and values[77] are compared.
+                let mut prefix = [0i64; 12];
+                prefix[0] = i as i64;
+                prefix[11] = val as i64;
+                FFIOneKibiByte::from_prefix(&prefix)
+            })
+            .collect();
+        let mut expected = test_data.clone();
+        expected.sort();
+
+        sort(&mut test_data);
+        assert_eq!(test_data, expected, "test_len: {test_len}");
+    }
+}
+
+fn sort_with_buf_impl<T: Ord + Clone + Debug>(
+    sort_with_buf: impl Fn(&mut [T], &mut [std::mem::MaybeUninit<u8>]),
+    transform: impl Fn(i32) -> T,
+    buf_len: impl Fn(usize) -> usize,
+) {
+    let elem_size = std::mem::size_of::<T>();
+
+    let sort_with_buf_comp = |test_data: Vec<T>| {
+        let mut expected = test_data.clone();
+        expected.sort();
+
+        // Over-allocated, so that both an aligned and a misaligned buffer of the same size fit.
+        let buf_bytes = buf_len(test_data.len()) * elem_size;
+        let mut buf = vec![std::mem::MaybeUninit::<u8>::uninit(); buf_bytes + 2 * elem_size];
+        let aligned = buf.as_ptr().align_offset(std::mem::align_of::<T>());
+
+        let buf_ranges = [
+            ("exact", aligned..(aligned + buf_bytes)),
+            (
+                "one_too_small",
+                aligned..(aligned + buf_bytes.saturating_sub(elem_size)),
+            ),
+            ("misaligned", (aligned + 1)..(aligned + 1 + buf_bytes)),
+            ("empty", aligned..aligned),
+        ];
+
+        for (buf_name, buf_range) in buf_ranges {
+            let mut data = test_data.clone();
+            sort_with_buf(&mut data, &mut buf[buf_range]);
+            assert_eq!(data, expected, "len: {}, buf: {buf_name}", test_data.len());
+        }
+    };
+
+    sort_with_buf_comp(Vec::new());
+    sort_with_buf_comp(vec![transform(0)]);
+
+    test_impl_custom(|test_len, pattern_fn| {
+        sort_with_buf_comp(pattern_fn(test_len).into_iter().map(&transform).collect());
+    });
+}
+
+/// Sorts through `sort_with_buf` with a buffer of exactly `buf_len(len)` elements, one that is one
+/// element too small, one that is misaligned by one byte and an empty one. Equal i32 values can't
+/// be told apart, so matching `slice::sort` also covers the order of equal elements.
+pub fn sort_with_buf_i32(
+    sort_with_buf: impl Fn(&mut [i32], &mut [std::mem::MaybeUninit<u8>]),
+    buf_len: impl Fn(usize) -> usize,
+) {
+    sort_with_buf_impl(sort_with_buf, |val| val, buf_len);
+}
+
+/// Same as `sort_with_buf_i32` for u64.
+pub fn sort_with_buf_u64(
+    sort_with_buf: impl Fn(&mut [u64], &mut [std::mem::MaybeUninit<u8>]),
+    buf_len: impl Fn(usize) -> usize,
+) {
+    sort_with_buf_impl(sort_with_buf, |val| val as u64, buf_len);
+}
+
+// Random values with about one in eight replaced by NaN, infinity or a signed zero.
+fn random_with_float_specials<T: Copy>(
+    size: usize,
+    from_i32: impl Fn(i32) -> T,
+    specials: &[T],
+) -> Vec<T> {
+    patterns::random(size)
+        .into_iter()
+        .map(|val| {
+            let special_i = val.unsigned_abs() as usize;
+            if special_i % 8 == 0 {
+                specials[(special_i / 8) % specials.len()]
+            } else {
+                from_i32(val)
+            }
+        })
+        .collect()
+}
+
+pub fn random_type_f32<S: Sort>() {
+    test_impl::<F32, S>(|size| {
+        random_with_float_specials(
+            size,
+            |val| F32(val as f32 / 1000.0),
+            &[
+                F32(f32::NAN),
+                F32(-f32::NAN),
+                F32(f32::INFINITY),
+                F32(f32::NEG_INFINITY),
+                F32(0.0),
+                F32(-0.0),
+            ],
+        )
+    });
+}
+
+pub fn random_type_f64<S: Sort>() {
+    test_impl::<F64, S>(|size| {
+        random_with_float_specials(
+            size,
+            |val| F64(val as f64 / 1000.0),
+            &[
+                F64(f64::NAN),
+                F64(-f64::NAN),
+                F64(f64::INFINITY),
+                F64(f64::NEG_INFINITY),
+                F64(0.0),
+                F64(-0.0),
+            ],
+        )
+    });
+}
+
 pub fn random_cell_i32<S: Sort>() {
     test_impl::<Cell<i32>, S>(|size| {
         patterns::random(size)
@@ -400,6 +659,12 @@ pub fn pipe_organ<S: Sort>() {
     test_impl::<i32, S>(patterns::pipe_organ);
 }
 
+pub fn adversarial<S: Sort>() {
+    // Inputs built to drive quicksorts into O(n^2), the antiqsort one against this very sort.
+    test_impl::<i32, S>(patterns::median_of_3_killer);
+    test_impl::<i32, S>(|size| patterns::antiqsort(size, |v, compare| S::sort_by(v, compare)));
+}
+
 pub fn stability<S: Sort>() {
     let _seed = get_or_init_random_seed::<S>();
 
@@ -476,6 +741,10 @@ pub fn stability<S: Sort>() {
 }
 
 pub fn stability_with_patterns<S: Sort>() {
+    stability_with_patterns_impl::<S>(&TEST_SIZES[..TEST_SIZES.len() - 2]);
+}
+
+fn stability_with_patterns_impl<S: Sort>(test_lens: &[usize]) {
     let _seed = get_or_init_random_seed::<S>();
 
     if <S as Sort>::name().contains("unstable") {
@@ -539,7 +808,7 @@ pub fn stability_with_patterns<S: Sort>() {
             .all(|w| i32_tup_from_u64(w[0]) <= i32_tup_from_u64(w[1])));
     };
 
-    test_impl_custom(test_fn);
+    test_impl_custom_lens(test_lens, test_fn);
 }
 
 pub fn random_ffi_str<S: Sort>() {
@@ -551,6 +820,37 @@ pub fn random_ffi_str<S: Sort>() {
     });
 }
 
+pub fn url_like_ffi_str<S: Sort>() {
+    // Long common prefixes, with few distinct ones, and many duplicates.
+    test_impl::<FFIString, S>(|test_len| {
+        patterns::random_uniform(test_len, 0..(test_len as i32 / 4 + 1))
+            .into_iter()
+            .map(|val| {
+                let host = ["https://www.example.com/", "https://www.example.org/wiki/"]
+                    [(val % 2) as usize];
+                FFIString::new(format!("{host}{}/page{}", val / 7, val % 7))
+            })
+            .collect::<Vec<_>>()
+    });
+}
+
+pub fn random_arena_str<S: Sort>() {
+    test_impl::<FFIArenaString, S>(|test_len| {
+        // Mix short strings, that are fully covered by the inline prefix, with long ones that share
+        // the prefix and differ only in the arena.
+        let strs = patterns::random(test_len)
+            .into_iter()
+            .map(|val| match val.rem_euclid(3) {
+                0 => format!("{}", val % 1000),
+                1 => format!("{:010}", val.saturating_abs()),
+                _ => format!("long_str_{}", val),
+            })
+            .collect::<Vec<_>>();
+
+        FFIArenaString::from_strs(&strs)
+    });
+}
+
 pub fn random_f128<S: Sort>() {
     test_impl::<F128, S>(|test_len| {
         patterns::random(test_len)
@@ -872,6 +1172,18 @@ fn should_test_for_strong_exception_safety() -> bool {
 pub fn panic_retain_original_set_impl<S: Sort, T: Ord + Clone>(
     type_into_fn: impl Fn(i32) -> T + Copy,
     type_from_fn: impl Fn(&T) -> i32,
+) {
+    panic_retain_original_set_lens_impl::<S, T>(
+        &TEST_SIZES[..TEST_SIZES.len() - 2],
+        type_into_fn,
+        type_from_fn,
+    );
+}
+
+fn panic_retain_original_set_lens_impl<S: Sort, T: Ord + Clone>(
+    test_lens: &[usize],
+    type_into_fn: impl Fn(i32) -> T + Copy,
+    type_from_fn: impl Fn(&T) -> i32,
 ) {
     let _seed = get_or_init_random_seed::<S>();
 
@@ -916,7 +1228,7 @@ pub fn panic_retain_original_set_impl<S: Sort, T: Ord + Clone>(
         // show up as double-free here.
     };
 
-    test_impl_custom(test_fn);
+    test_impl_custom_lens(test_lens, test_fn);
 }
 
 pub fn panic_retain_original_set_i32<S: Sort>() {
@@ -934,6 +1246,97 @@ pub fn panic_retain_original_set_cell_i32<S: Sort>() {
     panic_retain_original_set_impl::<S, Cell<i32>>(|val| Cell::new(val), |val| val.get());
 }
 
+// --- Caller picked lengths ---
+//
+// Parallel sorts only split their input above some minimum length, usually above every one of
+// TEST_SIZES. These run the same checks as their namesakes for the given lengths instead.
+
+pub fn random_lens<S: Sort>(test_lens: &[usize]) {
+    test_impl_lens::<i32, S>(test_lens, patterns::random);
+}
+
+pub fn random_ffi_str_lens<S: Sort>(test_lens: &[usize]) {
+    test_impl_lens::<FFIString, S>(test_lens, |test_len| {
+        patterns::random(test_len)
+            .into_iter()
+            .map(|val| FFIString::new(format!("{:010}", val.saturating_abs())))
+            .collect::<Vec<_>>()
+    });
+}
+
+pub fn saw_mixed_lens<S: Sort>(test_lens: &[usize]) {
+    test_impl_lens::<i32, S>(test_lens, |test_len| {
+        patterns::saw_mixed(test_len, ((test_len as f64).log2().round()) as usize)
+    });
+}
+
+pub fn stability_lens<S: Sort>(test_lens: &[usize]) {
+    stability_with_patterns_impl::<S>(test_lens);
+}
+
+pub fn panic_retain_original_set_i32_lens<S: Sort>(test_lens: &[usize]) {
+    panic_retain_original_set_lens_impl::<S, i32>(test_lens, |val| val, |val| *val);
+}
+
+pub fn panic_retain_original_set_ffi_string_lens<S: Sort>(test_lens: &[usize]) {
+    panic_retain_original_set_lens_impl::<S, FFIString>(
+        test_lens,
+        |val| FFIString::new(format!("{:010}", val.saturating_abs())),
+        |val| val.as_str().unwrap().parse::<i32>().unwrap(),
+    );
+}
+
+/// Same as `panic_retain_original_set_ffi_string_lens`, for parallel sorts that share the
+/// comparison function between their threads, `Sort::sort_by` only hands out a `FnMut`.
+pub fn panic_retain_original_set_sync_ffi_string_lens<S: Sort>(
+    test_lens: &[usize],
+    sort_by: impl Fn(&mut [FFIString], &(dyn Fn(&FFIString, &FFIString) -> Ordering + Sync)),
+) {
+    let _seed = get_or_init_random_seed::<S>();
+
+    let should_test_for_strong_exception_safety = should_test_for_strong_exception_safety();
+
+    let type_from_fn = |val: &FFIString| val.as_str().unwrap().parse::<i32>().unwrap();
+
+    let test_fn = |test_len: usize, pattern_fn: fn(usize) -> Vec<i32>| {
+        let mut test_data: Vec<FFIString> = pattern_fn(test_len)
+            .into_iter()
+            .map(|val| FFIString::new(format!("{:010}", val.saturating_abs())))
+            .collect();
+
+        let sum_before: i64 = test_data.iter().map(|x| type_from_fn(x) as i64).sum();
+
+        let comp_counter = AtomicUsize::new(0);
+        sort_by(&mut test_data.clone(), &|a, b| {
+            comp_counter.fetch_add(1, AtomicOrdering::Relaxed);
+            a.cmp(b)
+        });
+        let required_comps = comp_counter.swap(0, AtomicOrdering::Relaxed);
+        let panic_threshold =
+            patterns::random_uniform(1, 1..=required_comps as i32)[0] as usize - 1;
+
+        let res = panic::catch_unwind(AssertUnwindSafe(|| {
+            sort_by(&mut test_data, &|a, b| {
+                // Only one thread runs into it, the others carry on with their part.
+                if comp_counter.fetch_add(1, AtomicOrdering::Relaxed) == panic_threshold {
+                    panic!();
+                }
+
+                a.cmp(b)
+            });
+        }));
+
+        assert!(res.is_err());
+
+        if should_test_for_strong_exception_safety {
+            let sum_after: i64 = test_data.iter().map(|x| type_from_fn(x) as i64).sum();
+            assert_eq!(sum_before, sum_after);
+        }
+    };
+
+    test_impl_custom_lens(test_lens, test_fn);
+}
+
 fn panic_observable_is_less_impl<S: Sort, T: Ord + Clone>(
     type_into_fn: impl Fn(i32) -> T + Copy,
     type_from_fn: impl Fn(&T) -> i32,
@@ -1366,6 +1769,1090 @@ pub fn int_edge<S: Sort>() {
     sort_comp::<i32, S>(&mut large);
 }
 
+// --- Descending sorts ---
+//
+// Some implementations provide dedicated descending sorts outside of the `Sort` interface. These
+// take the sort function directly.
+
+fn sort_descending_comp<T: Ord + Clone + Debug>(sort_descending: &impl Fn(&mut [T]), v: &mut [T]) {
+    let original_clone = v.to_vec();
+
+    let mut expected = v.to_vec();
+    expected.sort_by(|a, b| b.cmp(a));
+
+    sort_descending(v);
+
+    if expected.as_slice() != v {
+        if v.len() <= 100 {
+            eprintln!("Orginal:  {:?}", original_clone);
+            eprintln!("Expected: {:?}", expected);
+            eprintln!("Got:      {:?}", v);
+        }
+
+        panic!("Test assertion failed!")
+    }
+}
+
+fn sort_descending_impl<T: Ord + Clone + Debug>(
+    sort_descending: impl Fn(&mut [T]),
+    transform: impl Fn(i32) -> T,
+    edge_values: &[T],
+) {
+    sort_descending_comp(&sort_descending, &mut []);
+
+    test_impl_custom(|test_len, pattern_fn| {
+        let mut test_data: Vec<T> = pattern_fn(test_len).into_iter().map(&transform).collect();
+        sort_descending_comp(&sort_descending, &mut test_data);
+    });
+
+    let mut with_edges: Vec<T> = patterns::random(TEST_SIZES[TEST_SIZES.len() - 2])
+        .into_iter()
+        .map(&transform)
+        .collect();
+    with_edges.extend_from_slice(edge_values);
+    with_edges.extend_from_slice(edge_values);
+    sort_descending_comp(&sort_descending, &mut with_edges);
+
+    let mut only_edges = edge_values.to_vec();
+    sort_descending_comp(&sort_descending, &mut only_edges);
+}
+
+pub fn sort_descending_i32(sort_descending: impl Fn(&mut [i32])) {
+    sort_descending_impl(sort_descending, |val| val, &[i32::MIN, i32::MAX, 0, -1, 1]);
+}
+
+pub fn sort_descending_u64(sort_descending: impl Fn(&mut [u64])) {
+    sort_descending_impl(
+        sort_descending,
+        |val| (((val as i64) + (i32::MAX as i64) + 1) as u64) * (i32::MAX as u64),
+        &[u64::MIN, u64::MAX, u64::MAX - 3, 1 << 63, (1 << 63) - 1],
+    );
+}
+
+pub fn sort_descending_u128(sort_descending: impl Fn(&mut [u128])) {
+    sort_descending_impl(
+        sort_descending,
+        |val| (((val as i128) + (i64::MAX as i128) + 1) as u128) * (i64::MAX as u128),
+        &[u128::MIN, u128::MAX, u64::MAX as u128, 1 << 64, 1 << 127],
+    );
+}
+
+pub fn sort_batch_u64(sort_batch: impl Fn(&mut [u64], &[usize])) {
+    sort_batch(&mut [], &[]);
+    sort_batch(&mut [], &[0]);
+
+    test_impl_custom(|test_len, pattern_fn| {
+        let test_data: Vec<u64> = pattern_fn(test_len)
+            .into_iter()
+            .map(|val| val as u64)
+            .collect();
+
+        // Empty, single element and short slices, leaving the first and last element outside of
+        // any slice.
+        let mut offsets = vec![1];
+        for slice_len in patterns::random_uniform(test_len, 0..=64) {
+            let slice_end = offsets.last().unwrap() + slice_len as usize;
+            if slice_end >= test_len {
+                break;
+            }
+            offsets.push(slice_end);
+        }
+
+        let mut expected = test_data.clone();
+        for bounds in offsets.windows(2) {
+            expected[bounds[0]..bounds[1]].sort();
+        }
+
+        let mut actual = test_data;
+        sort_batch(&mut actual, &offsets);
+        assert_eq!(expected, actual);
+    });
+}
+
+pub fn sort_batch_skewed_u64(sort_batch: impl Fn(&mut [u64], &[usize])) {
+    // Mostly short segments, with a few that are long enough to be split across threads by a
+    // parallel implementation.
+    let test_len = 400_000;
+    let test_data: Vec<u64> = patterns::random(test_len)
+        .into_iter()
+        .map(|val| val as u64)
+        .collect();
+
+    let mut offsets = vec![0];
+    for (i, slice_len) in patterns::random_uniform(test_len, 0..=300)
+        .into_iter()
+        .enumerate()
+    {
+        let slice_len = if i % 97 == 5 {
+            50_000
+        } else {
+            slice_len as usize
+        };
+        let slice_end = offsets.last().unwrap() + slice_len;
+        if slice_end >= test_len {
+            break;
+        }
+        offsets.push(slice_end);
+    }
+
+    let mut expected = test_data.clone();
+    for bounds in offsets.windows(2) {
+        expected[bounds[0]..bounds[1]].sort();
+    }
+
+    let mut actual = test_data;
+    sort_batch(&mut actual, &offsets);
+    assert_eq!(expected, actual);
+}
+
+/// Offsets at the edges of what's valid, and invalid ones that have to be rejected before any
+/// element is touched.
+pub fn sort_batch_offsets_u64(sort_batch: impl Fn(&mut [u64], &[usize])) {
+    let test_data: Vec<u64> = patterns::random(100)
+        .into_iter()
+        .map(|val| val as u64)
+        .collect();
+
+    let valid_offsets: [&[usize]; 5] = [
+        &[0, 100],
+        &[0, 0, 0, 100, 100],
+        &[7, 7, 8, 9, 50],
+        &[99, 100],
+        &[100],
+    ];
+    for offsets in valid_offsets {
+        let mut expected = test_data.clone();
+        for bounds in offsets.windows(2) {
+            expected[bounds[0]..bounds[1]].sort();
+        }
+
+        let mut actual = test_data.clone();
+        sort_batch(&mut actual, offsets);
+        assert_eq!(expected, actual);
+    }
+
+    let invalid_offsets: [&[usize]; 4] = [&[0, 50, 49], &[10, 0], &[0, 101], &[101]];
+    for offsets in invalid_offsets {
+        let mut actual = test_data.clone();
+        let res = panic::catch_unwind(AssertUnwindSafe(|| {
+            sort_batch(&mut actual, offsets);
+        }));
+        assert!(res.is_err(), "offsets {offsets:?} were accepted");
+        assert_eq!(actual, test_data);
+    }
+}
+
+fn merge_sorted_runs_impl<T: Ord + Clone + Debug>(
+    merge_sorted_runs: impl Fn(&mut [T], &[usize]),
+    type_into_fn: impl Fn(i32) -> T + Copy,
+) {
+    merge_sorted_runs(&mut [], &[]);
+    merge_sorted_runs(&mut [], &[0]);
+
+    test_impl_custom(|test_len, pattern_fn| {
+        let test_data: Vec<T> = pattern_fn(test_len).into_iter().map(type_into_fn).collect();
+
+        for run_count in [1, 2, 3, 8, 61, 256] {
+            // Random run bounds, including empty runs.
+            let mut offsets = patterns::random_uniform(run_count - 1, 0..=(test_len as i32))
+                .into_iter()
+                .map(|val| val as usize)
+                .collect::<Vec<_>>();
+            offsets.push(0);
+            offsets.push(test_len);
+            offsets.sort();
+
+            let mut actual = test_data.clone();
+            for bounds in offsets.windows(2) {
+                actual[bounds[0]..bounds[1]].sort();
+            }
+
+            let mut expected = test_data.clone();
+            expected.sort();
+
+            merge_sorted_runs(&mut actual, &offsets);
+            assert_eq!(expected, actual);
+        }
+    });
+}
+
+pub fn merge_sorted_runs_u64(merge_sorted_runs: impl Fn(&mut [u64], &[usize])) {
+    merge_sorted_runs_impl(merge_sorted_runs, |val| val as u64);
+}
+
+pub fn merge_sorted_runs_ffi_string(merge_sorted_runs: impl Fn(&mut [FFIString], &[usize])) {
+    merge_sorted_runs_impl(merge_sorted_runs, |val| {
+        FFIString::new(format!("{:010}", val.saturating_abs()))
+    });
+}
+
+pub fn merge_sorted_runs_f128(merge_sorted_runs: impl Fn(&mut [F128], &[usize])) {
+    merge_sorted_runs_impl(merge_sorted_runs, F128::new);
+}
+
+pub fn run_accumulator_u64<A>(
+    new: impl Fn() -> A,
+    append: impl Fn(&mut A, &[u64]),
+    copy_in_order: impl Fn(&A) -> Vec<u64>,
+    finalize: impl Fn(&mut A) -> Vec<u64>,
+) {
+    let mut acc = new();
+    assert!(copy_in_order(&acc).is_empty());
+    assert!(finalize(&mut acc).is_empty());
+
+    test_impl_custom(|test_len, pattern_fn| {
+        let test_data: Vec<u64> = pattern_fn(test_len)
+            .into_iter()
+            .map(|val| val as u64)
+            .collect();
+
+        // Empty and single element batches mixed in with longer ones.
+        let batch_lens = patterns::random_uniform(test_len, 0..=64);
+
+        let mut acc = new();
+        let mut expected = Vec::new();
+        let mut rest = test_data.as_slice();
+        for (i, batch_len) in batch_lens.into_iter().enumerate() {
+            let (batch, tail) = rest.split_at((batch_len as usize).min(rest.len()));
+            append(&mut acc, batch);
+            expected.extend_from_slice(batch);
+            rest = tail;
+
+            if i % 7 == 0 {
+                let mut sorted = expected.clone();
+                sorted.sort();
+                assert_eq!(sorted, copy_in_order(&acc));
+            }
+
+            // Appending after finalize continues from the merged run.
+            if i == 10 {
+                let mut sorted = expected.clone();
+                sorted.sort();
+                assert_eq!(sorted, finalize(&mut acc));
+            }
+
+            if rest.is_empty() {
+                break;
+            }
+        }
+        append(&mut acc, rest);
+        expected.extend_from_slice(rest);
+
+        expected.sort();
+        assert_eq!(expected, copy_in_order(&acc));
+        assert_eq!(expected, finalize(&mut acc));
+    });
+}
+
+pub fn sort_into_u64(sort_into: impl Fn(&mut [u64], &mut [u64])) {
+    sort_into(&mut [], &mut []);
+
+    let check = |test_data: Vec<u64>| {
+        let mut expected = test_data.clone();
+        expected.sort();
+
+        let mut src = test_data;
+        let mut dst = vec![0; src.len()];
+        sort_into(&mut src, &mut dst);
+        assert_eq!(expected, dst);
+
+        // src is used as scratch space, but must not lose elements.
+        src.sort();
+        assert_eq!(expected, src);
+    };
+
+    test_impl_custom(|test_len, pattern_fn| {
+        check(
+            pattern_fn(test_len)
+                .into_iter()
+                .map(|val| val as u64)
+                .collect(),
+        );
+    });
+
+    // Implementations that only distribute out-of-place once the input exceeds the cache.
+    let test_len = 2_000_000;
+    check(
+        patterns::random(test_len)
+            .into_iter()
+            .map(|val| val as u64)
+            .collect(),
+    );
+    check(
+        patterns::random_uniform(test_len, 0..20)
+            .into_iter()
+            .map(|val| val as u64)
+            .collect(),
+    );
+}
+
+// Compares sort_fn against the std sort, for entry points that only support a few types.
+fn sort_matches_std<T: Ord + Clone + Debug>(sort_fn: impl Fn(&mut [T]), make_val: fn(i32) -> T) {
+    sort_fn(&mut []);
+
+    test_impl_custom(|test_len, pattern_fn| {
+        let mut test_data = pattern_fn(test_len)
+            .into_iter()
+            .map(make_val)
+            .collect::<Vec<_>>();
+
+        let mut expected = test_data.clone();
+        expected.sort();
+
+        sort_fn(&mut test_data);
+        assert_eq!(expected, test_data);
+    });
+}
+
+pub fn sort_indirect_1k(sort_indirect: impl Fn(&mut [FFIOneKibiByte])) {
+    sort_matches_std(sort_indirect, FFIOneKibiByte::new);
+}
+
+pub fn sort_decorated_f128(sort_decorated: impl Fn(&mut [F128])) {
+    sort_matches_std(sort_decorated, F128::new);
+}
+
+pub fn sort_decorated_1k(sort_decorated: impl Fn(&mut [FFIOneKibiByte])) {
+    sort_matches_std(sort_decorated, FFIOneKibiByte::new);
+}
+
+fn sort_counted_impl<T: Ord + Clone + Debug>(
+    sort_counted: impl Fn(&mut [T]) -> OpCounts,
+    make_val: fn(i32) -> T,
+) {
+    for test_len in [0, 1] {
+        let mut test_data = (0..test_len).map(make_val).collect::<Vec<_>>();
+        let counts = sort_counted(&mut test_data);
+        assert_eq!(counts, OpCounts::default(), "test_len: {test_len}");
+    }
+
+    test_impl_custom(|test_len, pattern_fn| {
+        let test_data = pattern_fn(test_len)
+            .into_iter()
+            .map(make_val)
+            .collect::<Vec<_>>();
+
+        let mut expected = test_data.clone();
+        expected.sort();
+
+        let mut sorted = test_data.clone();
+        let counts = sort_counted(&mut sorted);
+        assert_eq!(expected, sorted);
+        assert!(counts.comparisons > 0, "test_len: {test_len}");
+
+        // Same input, same operations.
+        let mut sorted_again = test_data;
+        let counts_again = sort_counted(&mut sorted_again);
+        assert_eq!(counts, counts_again, "test_len: {test_len}");
+    });
+}
+
+pub fn sort_counted_i32(sort_counted: impl Fn(&mut [i32]) -> OpCounts) {
+    sort_counted_impl(sort_counted, |val| val);
+}
+
+pub fn sort_counted_u64(sort_counted: impl Fn(&mut [u64]) -> OpCounts) {
+    sort_counted_impl(sort_counted, |val| val as u64);
+}
+
+pub fn sort_counted_1k(sort_counted: impl Fn(&mut [FFIOneKibiByte]) -> OpCounts) {
+    sort_counted_impl(sort_counted, FFIOneKibiByte::new);
+}
+
+/// Few distinct keys, so the payload decides most comparisons, with the top bits of both fields
+/// in use.
+pub fn sort_packed_key_payload_u32(sort_packed: impl Fn(&mut [KeyPayloadU32])) {
+    sort_matches_std(sort_packed, |val| {
+        let bits = val as u32;
+        KeyPayloadU32::new(
+            (bits & 15) << 28 | (bits & 15),
+            bits.wrapping_mul(0x9E37_79B9),
+        )
+    });
+}
+
+pub fn sort_packed_key_payload_u64(sort_packed: impl Fn(&mut [KeyPayloadU64])) {
+    sort_matches_std(sort_packed, |val| {
+        let bits = val as i64 as u64;
+        KeyPayloadU64::new(
+            (bits & 15) << 60 | (bits & 15),
+            bits.wrapping_mul(0x9E37_79B9_7F4A_7C15),
+        )
+    });
+}
+
+/// Columns with few distinct values, so that the later columns and the row index decide many
+/// comparisons, and a u64 column wide enough that the normalized key can't hold all of it.
+pub fn sort_columns(sort_columns: impl Fn(&[SortColumn]) -> Vec<usize>) {
+    assert!(sort_columns(&[]).is_empty());
+
+    test_impl_custom(|test_len, pattern_fn| {
+        let table = ColumnsTable::new(test_len, pattern_fn);
+
+        for is_descending in [false, true] {
+            let columns = table.sort_columns(is_descending);
+
+            for n_columns in 1..=columns.len() {
+                let columns = &columns[..n_columns];
+
+                // Stable, equal rows keep their order.
+                let mut expected = (0..test_len).collect::<Vec<_>>();
+                expected.sort_by(|a, b| compare_rows(columns, *a, *b));
+
+                assert_eq!(sort_columns(columns), expected);
+            }
+        }
+    });
+}
+
+/// `encode_columns(columns)` returns one key per row and the number of leading columns whose
+/// order the keys fully capture, like the `encode_columns_*` functions of the columnar sorts.
+pub fn encode_columns<K: Ord>(encode_columns: impl Fn(&[SortColumn]) -> (Vec<K>, usize)) {
+    test_impl_custom(|test_len, pattern_fn| {
+        let table = ColumnsTable::new(test_len, pattern_fn);
+
+        for is_descending in [false, true] {
+            let columns = table.sort_columns(is_descending);
+
+            for n_columns in 1..=columns.len() {
+                let columns = &columns[..n_columns];
+                let (keys, exact_columns) = encode_columns(columns);
+                assert_eq!(keys.len(), test_len);
+                assert!(exact_columns <= n_columns);
+
+                // Sorting by key, ties broken by the remaining columns, is sorting by all.
+                let mut perm = (0..test_len).collect::<Vec<_>>();
+                perm.sort_by(|a, b| {
+                    keys[*a]
+                        .cmp(&keys[*b])
+                        .then_with(|| compare_rows(&columns[exact_columns..], *a, *b))
+                });
+
+                let mut expected = (0..test_len).collect::<Vec<_>>();
+                expected.sort_by(|a, b| compare_rows(columns, *a, *b));
+
+                assert_eq!(perm, expected);
+            }
+        }
+    });
+}
+
+fn compare_rows(columns: &[SortColumn], a: usize, b: usize) -> Ordering {
+    columns
+        .iter()
+        .fold(Ordering::Equal, |ordering, column| {
+            ordering.then_with(|| column.compare(a, b))
+        })
+}
+
+struct ColumnsTable {
+    col_u32: Vec<u32>,
+    col_i64: Vec<i64>,
+    col_u64: Vec<u64>,
+    col_f64: Vec<f64>,
+    col_f32: Vec<f32>,
+    col_str: Vec<FFIString>,
+}
+
+impl ColumnsTable {
+    fn new(test_len: usize, pattern_fn: fn(usize) -> Vec<i32>) -> Self {
+        Self {
+            col_u32: patterns::random_uniform(test_len, 0..=3)
+                .into_iter()
+                .map(|val| val as u32)
+                .collect(),
+            col_i64: pattern_fn(test_len)
+                .into_iter()
+                .map(|val| (val as i64) << 20)
+                .collect(),
+            col_u64: patterns::random(test_len)
+                .into_iter()
+                .map(|val| (val as u64).rotate_right(7) | 1 << 63)
+                .collect(),
+            // NaNs, infinities and both zeros.
+            col_f64: patterns::random_uniform(test_len, -4..=4)
+                .into_iter()
+                .map(|val| match val {
+                    -4 => f64::NEG_INFINITY,
+                    -3 => -0.0,
+                    3 => f64::NAN,
+                    4 => f64::INFINITY,
+                    _ => val as f64 / 3.0,
+                })
+                .collect(),
+            col_f32: patterns::random_uniform(test_len, -2..=2)
+                .into_iter()
+                .map(|val| if val == 2 { f32::NAN } else { val as f32 })
+                .collect(),
+            // Empty strings, strings that are a prefix of others and ones with zero bytes.
+            col_str: patterns::random_uniform(test_len, 0..=20)
+                .into_iter()
+                .map(|val| FFIString::new("ab\0cab\0cab\0c"[..val as usize % 13].into()))
+                .collect(),
+        }
+    }
+
+    fn sort_columns(&self, is_descending: bool) -> [SortColumn<'_>; 6] {
+        [
+            SortColumn::new(Column::U32(&self.col_u32), false),
+            SortColumn::new(Column::F32(&self.col_f32), is_descending).nans_first(),
+            SortColumn::new(Column::F64(&self.col_f64), !is_descending),
+            SortColumn::new(Column::String(&self.col_str), is_descending),
+            SortColumn::new(Column::I64(&self.col_i64), is_descending),
+            SortColumn::new(Column::U64(&self.col_u64), false),
+        ]
+    }
+}
+
+// Input and output file of the sort_file tests, unique per test and process.
+fn sort_file_paths(test_name: &str) -> (PathBuf, PathBuf) {
+    let prefix = env::temp_dir().join(format!("{test_name}_{}", std::process::id()));
+    (prefix.with_extension("in"), prefix.with_extension("out"))
+}
+
+/// `sort_file(input, output)` sorts a file of little-endian u64 into another one. External sorts
+/// should be configured with small chunks, so that the larger test sizes need several runs and
+/// merge passes.
+pub fn sort_file_u64(sort_file: impl Fn(&Path, &Path)) {
+    let (input, output) = sort_file_paths("sort_file_u64");
+
+    let check = |test_data: Vec<u64>| {
+        let bytes = test_data
+            .iter()
+            .flat_map(|val| val.to_le_bytes())
+            .collect::<Vec<_>>();
+        fs::write(&input, bytes).unwrap();
+
+        sort_file(&input, &output);
+
+        let actual = fs::read(&output)
+            .unwrap()
+            .chunks_exact(8)
+            .map(|bytes| u64::from_le_bytes(bytes.try_into().unwrap()))
+            .collect::<Vec<_>>();
+
+        let mut expected = test_data;
+        expected.sort();
+        assert_eq!(expected, actual);
+    };
+
+    check(vec![]);
+    check(vec![3]);
+
+    test_impl_custom(|test_len, pattern_fn| {
+        check(
+            pattern_fn(test_len)
+                .into_iter()
+                .map(|val| val as u64)
+                .collect(),
+        );
+    });
+
+    let _ = fs::remove_file(&input);
+    let _ = fs::remove_file(&output);
+}
+
+/// Same as `sort_file_u64`, for files of newline separated strings.
+pub fn sort_file_ffi_string(sort_file: impl Fn(&Path, &Path)) {
+    let (input, output) = sort_file_paths("sort_file_ffi_string");
+
+    let check = |test_data: Vec<String>| {
+        let text = test_data
+            .iter()
+            .map(|line| format!("{line}\n"))
+            .collect::<String>();
+        fs::write(&input, text).unwrap();
+
+        sort_file(&input, &output);
+
+        let actual = fs::read_to_string(&output)
+            .unwrap()
+            .lines()
+            .map(|line| line.to_owned())
+            .collect::<Vec<_>>();
+
+        let mut expected = test_data;
+        expected.sort();
+        assert_eq!(expected, actual);
+    };
+
+    check(vec![]);
+    check(vec![String::new(), "b".into(), String::new()]);
+
+    test_impl_custom(|test_len, pattern_fn| {
+        check(
+            pattern_fn(test_len)
+                .into_iter()
+                .map(|val| format!("{:010}", val.saturating_abs()))
+                .collect(),
+        );
+    });
+
+    let _ = fs::remove_file(&input);
+    let _ = fs::remove_file(&output);
+}
+
+/// `sort_file(path, record_bytes, key)` sorts a file of fixed-width records in place by the
+/// little-endian integer key described by `key`. Records with equal keys may end up in any order.
+pub fn sort_record_file(sort_file: impl Fn(&Path, usize, KeyDescriptor)) {
+    let (path, _) = sort_file_paths("sort_record_file");
+
+    let key_of = |record: &[u8], key: KeyDescriptor| -> i128 {
+        let mut bytes = [0u8; 8];
+        bytes[..key.width as usize]
+            .copy_from_slice(&record[key.offset..key.offset + key.width as usize]);
+        let value = u64::from_le_bytes(bytes) as i128;
+
+        let bits = key.width as u32 * 8;
+        let value = if key.is_signed && value >= 1 << (bits - 1) {
+            value - (1 << bits)
+        } else {
+            value
+        };
+        if key.is_descending {
+            -value
+        } else {
+            value
+        }
+    };
+
+    let keys = [
+        KeyDescriptor::new(0, 8, false, false),
+        KeyDescriptor::new(4, 4, true, false),
+        KeyDescriptor::new(3, 2, false, true),
+        KeyDescriptor::new(8, 8, true, true),
+    ];
+
+    // Narrow records are sorted directly, wide ones and sizes without a direct instantiation
+    // indirectly.
+    for record_bytes in [16, 40, 64, 256] {
+        for key in keys {
+            test_impl_custom(|test_len, pattern_fn| {
+                // The largest test sizes would write gigabytes of wide records.
+                if test_len * record_bytes > 16 << 20 {
+                    return;
+                }
+
+                let records = pattern_fn(test_len)
+                    .into_iter()
+                    .enumerate()
+                    .flat_map(|(index, val)| {
+                        let mut record = vec![index as u8; record_bytes];
+                        let key_bytes = (val as i64).wrapping_mul(0x1_0001_0001).to_le_bytes();
+                        record[key.offset..key.offset + key.width as usize]
+                            .copy_from_slice(&key_bytes[..key.width as usize]);
+                        record
+                    })
+                    .collect::<Vec<_>>();
+                fs::write(&path, &records).unwrap();
+
+                sort_file(&path, record_bytes, key);
+
+                let actual = fs::read(&path).unwrap();
+                assert_eq!(actual.len(), records.len());
+
+                let mut expected_records = records.chunks(record_bytes).collect::<Vec<_>>();
+                let mut actual_records = actual.chunks(record_bytes).collect::<Vec<_>>();
+                assert!(actual_records
+                    .windows(2)
+                    .all(|pair| key_of(pair[0], key) <= key_of(pair[1], key)));
+
+                expected_records.sort();
+                actual_records.sort();
+                assert_eq!(expected_records, actual_records);
+            });
+        }
+    }
+
+    let _ = fs::remove_file(&path);
+}
+
+pub fn partial_sort_i32(partial_sort: impl Fn(&mut [i32], usize)) {
+    partial_sort(&mut [], 0);
+
+    test_impl_custom(|test_len, pattern_fn| {
+        let test_data = pattern_fn(test_len);
+
+        let mut sorted = test_data.clone();
+        sorted.sort();
+
+        for k in [0, 1, test_len / 10, test_len / 2, test_len - 1, test_len] {
+            let mut actual = test_data.clone();
+            partial_sort(&mut actual, k);
+            assert_eq!(&sorted[..k], &actual[..k]);
+
+            // The remaining elements must be a permutation of the rest of the input.
+            actual.sort();
+            assert_eq!(sorted, actual);
+        }
+    });
+}
+
+/// `first_k(data, k)` returns the first `k` elements of a lazily sorted iterator over `data`.
+pub fn sort_lazy_i32(first_k: impl Fn(&mut [i32], usize) -> Vec<i32>) {
+    assert!(first_k(&mut [], 0).is_empty());
+
+    test_impl_custom(|test_len, pattern_fn| {
+        let test_data = pattern_fn(test_len);
+
+        let mut sorted = test_data.clone();
+        sorted.sort();
+
+        for k in [0, 1, test_len / 10, test_len / 2, test_len - 1, test_len] {
+            let mut actual = test_data.clone();
+            assert_eq!(&sorted[..k], first_k(&mut actual, k));
+
+            // What has been read stays in place, the rest must be a permutation of the remaining
+            // input.
+            assert_eq!(&sorted[..k], &actual[..k]);
+            actual.sort();
+            assert_eq!(sorted, actual);
+        }
+    });
+}
+
+pub fn select_nth_unstable_i32(select_nth_unstable: impl Fn(&mut [i32], usize)) {
+    test_impl_custom(|test_len, pattern_fn| {
+        let test_data = pattern_fn(test_len);
+
+        let mut sorted = test_data.clone();
+        sorted.sort();
+
+        for index in [0, test_len / 3, test_len - 1] {
+            let mut actual = test_data.clone();
+            select_nth_unstable(&mut actual, index);
+            assert_eq!(sorted[index], actual[index]);
+            assert!(actual[..index].iter().all(|val| *val <= actual[index]));
+            assert!(actual[index + 1..].iter().all(|val| *val >= actual[index]));
+        }
+    });
+}
+
+// --- Argsort ---
+
+fn argsort_comp<T: Ord + Copy + Debug>(argsort: &impl Fn(&[T]) -> Vec<u32>, keys: &[T]) {
+    let indices = argsort(keys);
+    assert_eq!(indices.len(), keys.len());
+
+    // Every index exactly once, otherwise applying it could still look sorted.
+    let mut is_seen = vec![false; keys.len()];
+    for &idx in &indices {
+        assert!(!is_seen[idx as usize], "index {idx} returned twice");
+        is_seen[idx as usize] = true;
+    }
+
+    let mut expected = keys.to_vec();
+    expected.sort();
+
+    let permuted = indices
+        .iter()
+        .map(|&idx| keys[idx as usize])
+        .collect::<Vec<_>>();
+    assert!(permuted == expected);
+}
+
+fn argsort_impl<T: Ord + Copy + Debug>(
+    argsort: impl Fn(&[T]) -> Vec<u32>,
+    type_into_fn: impl Fn(i32) -> T,
+    edge_values: [T; 4],
+) {
+    argsort_comp(&argsort, &[]);
+
+    test_impl_custom(|test_len, pattern_fn| {
+        let keys = pattern_fn(test_len)
+            .into_iter()
+            .map(&type_into_fn)
+            .collect::<Vec<_>>();
+        argsort_comp(&argsort, &keys);
+    });
+
+    // Implementations that map the keys onto another type have to keep the order of the extremes.
+    argsort_comp(&argsort, &edge_values);
+    let mut reversed = edge_values;
+    reversed.reverse();
+    argsort_comp(&argsort, &reversed);
+
+    let keys = patterns::random_uniform(1_000, 0..4)
+        .into_iter()
+        .map(|val| edge_values[val as usize])
+        .collect::<Vec<_>>();
+    argsort_comp(&argsort, &keys);
+}
+
+pub fn argsort_i32(argsort: impl Fn(&[i32]) -> Vec<u32>) {
+    argsort_impl(argsort, |val| val, [i32::MIN, -1, 0, i32::MAX]);
+}
+
+pub fn argsort_u64(argsort: impl Fn(&[u64]) -> Vec<u32>) {
+    // Negative values cover the upper half of the range.
+    argsort_impl(argsort, |val| val as u64, [0, 1, u64::MAX - 1, u64::MAX]);
+}
+
+// --- Payload sorts ---
+
+fn sort_with_payload_comp(
+    sort_with_payload: &impl Fn(&mut [u64], &mut [u64]),
+    test_data: Vec<u64>,
+    is_stable: bool,
+) {
+    // The payload is the original position, which makes the expected result of a stable sort
+    // unambiguous.
+    let mut expected = test_data
+        .iter()
+        .copied()
+        .zip(0..test_data.len() as u64)
+        .collect::<Vec<_>>();
+    expected.sort();
+
+    let mut keys = test_data;
+    let mut payload = (0..keys.len() as u64).collect::<Vec<_>>();
+    sort_with_payload(&mut keys, &mut payload);
+
+    let mut actual = keys.into_iter().zip(payload).collect::<Vec<_>>();
+    if !is_stable {
+        // Any order of the payloads of equal keys is valid, as long as every key kept its own
+        // payload.
+        assert!(actual.windows(2).all(|w| w[0].0 <= w[1].0));
+        actual.sort();
+    }
+
+    assert!(actual == expected);
+}
+
+fn sort_with_payload_impl(sort_with_payload: impl Fn(&mut [u64], &mut [u64]), is_stable: bool) {
+    sort_with_payload(&mut [], &mut []);
+
+    test_impl_custom(|test_len, pattern_fn| {
+        let test_data = pattern_fn(test_len)
+            .into_iter()
+            .map(|val| val as u64)
+            .collect();
+        sort_with_payload_comp(&sort_with_payload, test_data, is_stable);
+    });
+
+    // Large enough to not fit into the cache, which some implementations handle differently.
+    let test_len = 300_000;
+    for test_data in [
+        patterns::random(test_len),
+        patterns::random_uniform(test_len, 0..20),
+        patterns::random_zipf(test_len, 1.0),
+    ] {
+        let test_data = test_data.into_iter().map(|val| val as u64).collect();
+        sort_with_payload_comp(&sort_with_payload, test_data, is_stable);
+    }
+
+    // The largest key, which vectorized implementations may use as padding.
+    let test_data = patterns::random_uniform(1_000, 0..4)
+        .into_iter()
+        .map(|val| if val == 0 { u64::MAX } else { val as u64 })
+        .collect();
+    sort_with_payload_comp(&sort_with_payload, test_data, is_stable);
+}
+
+pub fn sort_with_payload_u64(sort_with_payload: impl Fn(&mut [u64], &mut [u64])) {
+    sort_with_payload_impl(sort_with_payload, true);
+}
+
+pub fn sort_with_payload_unstable_u64(sort_with_payload: impl Fn(&mut [u64], &mut [u64])) {
+    sort_with_payload_impl(sort_with_payload, false);
+}
+
+fn sort_unique_comp<T: Ord + Clone + Debug>(
+    sort_unique: &impl Fn(&mut [T]) -> (usize, Option<Vec<usize>>),
+    test_data: Vec<T>,
+) {
+    let mut sorted = test_data.clone();
+    sorted.sort();
+
+    let mut expected_counts = Vec::<usize>::new();
+    let mut expected_unique = Vec::<T>::new();
+    for val in &sorted {
+        if expected_unique.last() == Some(val) {
+            *expected_counts.last_mut().unwrap() += 1;
+        } else {
+            expected_unique.push(val.clone());
+            expected_counts.push(1);
+        }
+    }
+
+    let mut actual = test_data;
+    let (unique_len, counts) = sort_unique(&mut actual);
+    assert_eq!(&actual[..unique_len], expected_unique.as_slice());
+    if let Some(counts) = counts {
+        assert_eq!(counts, expected_counts);
+    }
+
+    // The duplicates have to stay in the slice.
+    actual.sort();
+    assert!(actual == sorted);
+}
+
+fn sort_unique_impl<T: Ord + Clone + Debug>(
+    sort_unique: impl Fn(&mut [T]) -> (usize, Option<Vec<usize>>),
+    make_val: fn(i32) -> T,
+) {
+    let make_test_data = |pattern: Vec<i32>| pattern.into_iter().map(make_val).collect();
+
+    sort_unique(&mut []);
+
+    test_impl_custom(|test_len, pattern_fn| {
+        sort_unique_comp(&sort_unique, make_test_data(pattern_fn(test_len)));
+    });
+
+    let test_len = 100_000;
+    for test_data in [
+        patterns::random_uniform(test_len, 0..20),
+        patterns::random_zipf(test_len, 1.0),
+        patterns::random_uniform(test_len, 0..1),
+    ] {
+        sort_unique_comp(&sort_unique, make_test_data(test_data));
+    }
+}
+
+pub fn sort_unique_i32(sort_unique: impl Fn(&mut [i32]) -> usize) {
+    sort_unique_impl(|data: &mut [i32]| (sort_unique(data), None), |val| val);
+}
+
+pub fn sort_unique_ffi_str(sort_unique: impl Fn(&mut [FFIString]) -> usize) {
+    sort_unique_impl(
+        |data: &mut [FFIString]| (sort_unique(data), None),
+        |val| FFIString::new(format!("{:010}", val.saturating_abs())),
+    );
+}
+
+pub fn sort_count_runs_u64(sort_count_runs: impl Fn(&mut [u64]) -> Vec<usize>) {
+    sort_unique_impl(
+        |data: &mut [u64]| {
+            let counts = sort_count_runs(data);
+            (counts.len(), Some(counts))
+        },
+        |val| val as u64,
+    );
+}
+
+/// For sorts that only handle small inputs, every len up to and including `max_len`.
+pub fn small_len_u64(max_len: usize, sort: impl Fn(&mut [u64])) {
+    let test_pattern_fns: Vec<fn(usize) -> Vec<i32>> = vec![
+        patterns::random,
+        |size| patterns::random_uniform(size, 0..=1 as i32),
+        |size| patterns::random_uniform(size, 0..=3 as i32),
+        patterns::ascending,
+        patterns::descending,
+    ];
+
+    for test_len in 0..=max_len {
+        for test_pattern_fn in &test_pattern_fns {
+            // The random patterns need a couple of runs to hit the interesting permutations.
+            for _ in 0..100 {
+                let mut test_data = test_pattern_fn(test_len)
+                    .into_iter()
+                    .map(|val| val as u64)
+                    .collect::<Vec<_>>();
+
+                let mut expected = test_data.clone();
+                expected.sort();
+
+                sort(&mut test_data);
+                assert_eq!(test_data, expected);
+            }
+        }
+
+        // The largest key next to 0, in case it's mishandled as sentinel.
+        let mut test_data = (0..test_len as u64)
+            .map(|val| if val % 2 == 0 { u64::MAX } else { 0 })
+            .collect::<Vec<_>>();
+        sort(&mut test_data);
+        assert!(test_data.windows(2).all(|w| w[0] <= w[1]));
+    }
+}
+
+/// For `sort_by_nothrow` style entry points, where a panic in the comparison function is recorded
+/// and the sort runs to its end. Once it panicked the comparison function must not be called
+/// again, and the input has to come back as a permutation of itself.
+pub fn sort_by_nothrow_i32(
+    sort_by_nothrow: impl Fn(&mut [i32], &mut dyn FnMut(&i32, &i32) -> Ordering),
+) {
+    test_impl_custom(|test_len, pattern_fn| {
+        let mut test_data = pattern_fn(test_len);
+        let mut expected = test_data.clone();
+        expected.sort();
+
+        sort_by_nothrow(&mut test_data, &mut |a, b| a.cmp(b));
+        assert_eq!(test_data, expected);
+
+        for panic_at in [0, 1, test_len / 2] {
+            let mut test_data = pattern_fn(test_len);
+            let mut calls = 0;
+            let mut calls_after_panic = 0;
+
+            let res = panic::catch_unwind(AssertUnwindSafe(|| {
+                sort_by_nothrow(&mut test_data, &mut |a, b| {
+                    calls += 1;
+                    if calls == panic_at + 1 {
+                        panic!("Explicit panic");
+                    } else if calls > panic_at + 1 {
+                        calls_after_panic += 1;
+                    }
+
+                    a.cmp(b)
+                });
+            }));
+
+            // Shorter inputs might be sorted with fewer comparisons.
+            assert_eq!(res.is_err(), calls > panic_at);
+            assert_eq!(calls_after_panic, 0);
+
+            test_data.sort();
+            assert_eq!(test_data, expected);
+        }
+    });
+}
+
+/// Sorts by keys narrower than the value and signed keys, in both directions. With `is_stable` the
+/// order of elements with equal keys is checked too.
+pub fn sort_by_known_key_u64(
+    is_stable: bool,
+    sort_by_known_key: impl Fn(&mut [u64], KeyDescriptor),
+) {
+    // On little-endian targets offset 0 is the low half and offset 4 the high half.
+    let key_fns: Vec<(KeyDescriptor, fn(&u64) -> i128)> = vec![
+        (KeyDescriptor::new(0, 8, false, false), |val| *val as i128),
+        (KeyDescriptor::new(0, 2, false, false), |val| {
+            *val as u16 as i128
+        }),
+        (KeyDescriptor::new(4, 4, true, false), |val| {
+            (*val >> 32) as i32 as i128
+        }),
+        (KeyDescriptor::new(4, 4, true, true), |val| {
+            -((*val >> 32) as i32 as i128)
+        }),
+    ];
+
+    test_impl_custom(|test_len, pattern_fn| {
+        for (key, key_fn) in &key_fns {
+            let mut test_data = pattern_fn(test_len)
+                .into_iter()
+                .map(|val| (val as u64).rotate_left(29) ^ (val as u64 % 7))
+                .collect::<Vec<_>>();
+
+            let mut expected = test_data.clone();
+            expected.sort_by_key(key_fn);
+
+            sort_by_known_key(&mut test_data, *key);
+
+            if is_stable {
+                assert_eq!(test_data, expected);
+            } else {
+                assert!(test_data.windows(2).all(|w| key_fn(&w[0]) <= key_fn(&w[1])));
+
+                test_data.sort();
+                expected.sort();
+                assert_eq!(test_data, expected);
+            }
+        }
+    });
+}
+
 #[doc(hidden)]
 #[macro_export]
 macro_rules! instantiate_sort_test_impl_inner {
@@ -1406,6 +2893,7 @@ macro_rules! instantiate_sort_tests {
     ($sort_impl:ty) => {
         sort_test_tools::instantiate_sort_test_impl!(
             $sort_impl,
+            [miri_no, adversarial],
             [miri_no, all_equal],
             [miri_yes, ascending],
             [miri_no, saw_ascending],
@@ -0,0 +1,249 @@
+//! Benchmark driver for wasm32-wasip1 builds, run by util/run_wasm_benchmarks.py with wasmtime.
+//! criterion doesn't run on wasm, so this is the measurement loop of src/cpp/bench_driver.cpp in
+//! Rust: the same sizes and default patterns as benches/bench.rs, short inputs sorted in batches,
+//! the median of 10 to 100 samples, and the results written in the critcmp export format that
+//! util/graph_bench_result and util/analyze_bench_result.py read.
+//!
+//! Usage: wasm_bench_driver <result name> [--warm-up-time <s>] [--measurement-time <s>]
+//!
+//! Like the Rust benchmarks BENCH_REGEX filters the benchmarks by name, and OVERRIDE_SEED fixes the
+//! seed of every generated input. wasmtime only passes them on with --env.
+
+use std::env;
+use std::fs;
+use std::process;
+use std::time::{Duration, Instant};
+
+use sort_test_tools::patterns;
+use sort_test_tools::Sort;
+
+use sort_research_rs::{stable, unstable};
+
+struct SortEntry {
+    name: String,
+    sort_i32: fn(&mut [i32]),
+    sort_u64: fn(&mut [u64]),
+}
+
+fn sort_entry<S: Sort>() -> SortEntry {
+    SortEntry {
+        name: S::name(),
+        sort_i32: S::sort::<i32>,
+        sort_u64: S::sort::<u64>,
+    }
+}
+
+// Same names as cargo bench, so that the results of native and wasm runs line up.
+fn enabled_sorts() -> Vec<SortEntry> {
+    vec![
+        sort_entry::<stable::rust_std::SortImpl>(),
+        sort_entry::<unstable::rust_std::SortImpl>(),
+        sort_entry::<unstable::rust_ipnsort::SortImpl>(),
+        #[cfg(feature = "cpp_vqsort")]
+        sort_entry::<sort_research_rs::other::cpp_vqsort::SortImpl>(),
+        #[cfg(feature = "cpp_vqsort")]
+        sort_entry::<stable::cpp_vqsort_stable::SortImpl>(),
+    ]
+}
+
+// The default set of bench_patterns in benches/bench.rs.
+const PATTERNS: [(&str, fn(usize) -> Vec<i32>); 6] = [
+    ("random", patterns::random),
+    ("random_z1", |len| patterns::random_zipf(len, 1.0)),
+    ("random_d20", |len| patterns::random_uniform(len, 0..=19)),
+    ("random_s95", |len| patterns::random_sorted(len, 95.0)),
+    ("ascending", patterns::ascending),
+    ("descending", patterns::descending),
+];
+
+const TEST_SIZES: [usize; 30] = [
+    0, 1, 2, 3, 4, 6, 8, 10, 12, 17, 24, 35, 49, 70, 100, 200, 400, 900, 2_048, 4_833, 10_000,
+    22_367, 50_000, 100_000, 183_845, 400_000, 1_000_000, 2_000_000, 4_281_332, 10_000_000,
+];
+
+// Same transform as extend_i32_to_u64 in benches/bench.rs.
+fn extend_i32_to_u64(val: i32) -> u64 {
+    let shifted = (val as i64 + i32::MAX as i64 + 1) as u32;
+    shifted as u64 * i32::MAX as u64
+}
+
+trait BenchType: Copy + Default {
+    const NAME: &'static str;
+
+    fn from_pattern(values: Vec<i32>) -> Vec<Self>;
+    fn sort_fn(sort: &SortEntry) -> fn(&mut [Self]);
+}
+
+impl BenchType for i32 {
+    const NAME: &'static str = "i32";
+
+    fn from_pattern(values: Vec<i32>) -> Vec<Self> {
+        values
+    }
+
+    fn sort_fn(sort: &SortEntry) -> fn(&mut [Self]) {
+        sort.sort_i32
+    }
+}
+
+impl BenchType for u64 {
+    const NAME: &'static str = "u64";
+
+    fn from_pattern(values: Vec<i32>) -> Vec<Self> {
+        values.into_iter().map(extend_i32_to_u64).collect()
+    }
+
+    fn sort_fn(sort: &SortEntry) -> fn(&mut [Self]) {
+        sort.sort_u64
+    }
+}
+
+struct BenchConfig {
+    warm_up: Duration,
+    measurement: Duration,
+}
+
+// Short inputs are sorted in batches of copies laid out back to back, so that the clock resolution
+// doesn't dominate, wasmtime's monotonic clock is often no better than a microsecond.
+const MIN_BATCH_ELEMS: usize = 4096;
+const MIN_SAMPLES: usize = 10;
+const MAX_SAMPLES: usize = 100;
+
+fn measure<T: BenchType>(
+    sort_fn: fn(&mut [T]),
+    pattern_provider: fn(usize) -> Vec<i32>,
+    len: usize,
+    config: &BenchConfig,
+) -> f64 {
+    let batch = MIN_BATCH_ELEMS.div_ceil(len.max(1)).max(1);
+    let mut work = vec![T::default(); batch * len];
+
+    let mut run_sample = || {
+        // A new input per sample, like criterion's setup closure.
+        let input = T::from_pattern(pattern_provider(len));
+        for chunk in work.chunks_exact_mut(len.max(1)) {
+            chunk.copy_from_slice(&input);
+        }
+
+        let start = Instant::now();
+        for i in 0..batch {
+            sort_fn(std::hint::black_box(&mut work[i * len..(i + 1) * len]));
+        }
+        let elapsed = start.elapsed();
+
+        elapsed.as_nanos() as f64 / batch as f64
+    };
+
+    let warm_up_start = Instant::now();
+    while warm_up_start.elapsed() < config.warm_up {
+        run_sample();
+    }
+
+    let mut sample_ns = Vec::new();
+    let measurement_start = Instant::now();
+    while sample_ns.len() < MIN_SAMPLES
+        || (sample_ns.len() < MAX_SAMPLES && measurement_start.elapsed() < config.measurement)
+    {
+        sample_ns.push(run_sample());
+    }
+
+    let mid = sample_ns.len() / 2;
+    *sample_ns.select_nth_unstable_by(mid, f64::total_cmp).1
+}
+
+fn should_run_benchmark(name: &str, filter_regex: &Option<regex::Regex>) -> bool {
+    filter_regex
+        .as_ref()
+        .map_or(true, |regex| regex.is_match(name))
+}
+
+fn bench_type<T: BenchType>(
+    len: usize,
+    config: &BenchConfig,
+    filter_regex: &Option<regex::Regex>,
+    results: &mut Vec<(String, f64)>,
+) {
+    for (pattern_name, pattern_provider) in PATTERNS {
+        if len < 3 && pattern_name != "random" {
+            continue;
+        }
+
+        for sort in enabled_sorts() {
+            let name = format!("{}-hot-{}-{pattern_name}-{len}", sort.name, T::NAME);
+            if !should_run_benchmark(&name, filter_regex) {
+                continue;
+            }
+
+            let median_ns = measure(T::sort_fn(&sort), pattern_provider, len, config);
+            eprintln!("{name:<70} {median_ns:>14.1} ns");
+            results.push((name, median_ns));
+        }
+    }
+}
+
+// Only the fields of the critcmp export the result tools read.
+fn write_results(result_name: &str, results: &[(String, f64)]) {
+    let entries = results
+        .iter()
+        .map(|(name, median_ns)| {
+            format!(
+                "\n  \"{name}\": {{\"baseline\": \"{result_name}\", \"fullname\": \
+                 \"{result_name}/{name}\", \"criterion_estimates_v1\": {{\"median\": \
+                 {{\"point_estimate\": {median_ns:.3}}}}}}}"
+            )
+        })
+        .collect::<Vec<_>>()
+        .join(",");
+
+    let path = format!("{result_name}.json");
+    let json = format!("{{\"name\": \"{result_name}\", \"benchmarks\": {{{entries}\n}}}}\n");
+    fs::write(&path, json).unwrap_or_else(|err| {
+        eprintln!("Failed to write {path}: {err}");
+        process::exit(1);
+    });
+
+    eprintln!("\nWrote results to {path}");
+}
+
+fn main() {
+    let args = env::args().collect::<Vec<_>>();
+    if args.len() < 2 {
+        eprintln!(
+            "Usage: {} <result name> [--warm-up-time <s>] [--measurement-time <s>]",
+            args[0]
+        );
+        process::exit(1);
+    }
+
+    let result_name = &args[1];
+    let mut config = BenchConfig {
+        warm_up: Duration::from_secs(2),
+        measurement: Duration::from_secs(4),
+    };
+    for option in args[2..].chunks_exact(2) {
+        let secs = Duration::from_secs_f64(option[1].parse().expect("time must be in seconds"));
+        match option[0].as_str() {
+            "--warm-up-time" => config.warm_up = secs,
+            "--measurement-time" => config.measurement = secs,
+            unknown => {
+                eprintln!("Unknown argument {unknown}");
+                process::exit(1);
+            }
+        }
+    }
+
+    // Every sample gets a new input with a random seed, unless OVERRIDE_SEED is set.
+    patterns::disable_fixed_seed();
+
+    let filter_regex = env::var("BENCH_REGEX")
+        .ok()
+        .map(|val| regex::Regex::new(&val).expect("BENCH_REGEX must be a valid regex"));
+
+    let mut results = Vec::new();
+    for len in TEST_SIZES {
+        bench_type::<i32>(len, &config, &filter_regex, &mut results);
+        bench_type::<u64>(len, &config, &filter_regex, &mut results);
+    }
+
+    write_results(result_name, &results);
+}
@@ -0,0 +1,619 @@
+// Native benchmark driver, calls the C++ and C entry points directly instead
+// of going through Rust and criterion. Uses the same sizes, patterns, names
+// and random number generation as benches/bench.rs, and writes the results in
+// the critcmp export format that util/graph_bench_result and
+// util/analyze_bench_result.py read.
+//
+// Built and linked by build.rs with the cpp_bench_driver feature, every
+// enabled wrapper feature defines BENCH_<FEATURE>.
+//
+// Usage: cpp_bench_driver <result name> [--warm-up-time <s>]
+//                         [--measurement-time <s>]
+//
+// Like the Rust benchmarks BENCH_REGEX filters the benchmarks by name, and
+// OVERRIDE_SEED fixes the seed of every generated input. Without it each
+// sample gets a new random seed.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <optional>
+#include <random>
+#include <regex>
+#include <string>
+#include <vector>
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define DECLARE_SORT(prefix)                  \
+  void prefix##_i32(int32_t* data, size_t len); \
+  void prefix##_u64(uint64_t* data, size_t len);
+
+extern "C" {
+#if defined(BENCH_CPP_STD_SYS)
+DECLARE_SORT(sort_stable_sys)
+DECLARE_SORT(sort_unstable_sys)
+#endif
+#if defined(BENCH_CPP_PDQSORT)
+DECLARE_SORT(pdqsort_unstable)
+DECLARE_SORT(pdqsort_branchy_unstable)
+DECLARE_SORT(pdqsort_branchless_unstable)
+DECLARE_SORT(pdqsort_lomcyc_unstable)
+#endif
+#if defined(BENCH_CPP_POWERSORT)
+DECLARE_SORT(powersort_stable)
+DECLARE_SORT(powersort_4way_stable)
+#endif
+#if defined(BENCH_CPP_SIMDSORT)
+DECLARE_SORT(simdsort_avx2)
+#endif
+#if defined(BENCH_CPP_RADIX)
+DECLARE_SORT(radix)
+#endif
+#if defined(BENCH_CPP_IPS4O)
+DECLARE_SORT(ips4o_unstable)
+#endif
+#if defined(BENCH_CPP_BLOCKQUICKSORT)
+DECLARE_SORT(blockquicksort_unstable)
+#endif
+#if defined(BENCH_CPP_GERBENS_QSORT)
+DECLARE_SORT(gerbens_qsort_unstable)
+#endif
+#if defined(BENCH_CPP_NANOSORT)
+DECLARE_SORT(nanosort_unstable)
+#endif
+#if defined(BENCH_CPP_WIKISORT)
+DECLARE_SORT(wikisort_stable)
+#endif
+#if defined(BENCH_C_STD_SYS)
+DECLARE_SORT(qsort_unstable)
+#endif
+#if defined(BENCH_C_FAST_QSORT)
+DECLARE_SORT(fast_qsort_unstable)
+#endif
+#if defined(BENCH_C_CRUMSORT)
+DECLARE_SORT(crumsort_unstable)
+#endif
+#if defined(BENCH_C_FLUXSORT)
+DECLARE_SORT(fluxsort_stable)
+#endif
+#if defined(BENCH_SINGELI_SINGELISORT)
+DECLARE_SORT(singelisort)
+#endif
+}  // extern "C"
+
+namespace {
+
+struct SortEntry {
+  const char* name;
+  void (*sort_i32)(int32_t*, size_t);
+  void (*sort_u64)(uint64_t*, size_t);
+};
+
+#define SORT_ENTRY(name, prefix) \
+  SortEntry { name, prefix##_i32, prefix##_u64 }
+
+// Same names as the Rust side, so that the results line up with the ones of
+// cargo bench.
+std::vector<SortEntry> enabled_sorts() {
+  return {
+#if defined(BENCH_CPP_STD_SYS)
+      SORT_ENTRY("cpp_std_sys_stable", sort_stable_sys),
+      SORT_ENTRY("cpp_std_sys_unstable", sort_unstable_sys),
+#endif
+#if defined(BENCH_CPP_PDQSORT)
+      SORT_ENTRY("cpp_pdqsort_unstable", pdqsort_unstable),
+      SORT_ENTRY("cpp_pdqsort_branchy_unstable", pdqsort_branchy_unstable),
+      SORT_ENTRY("cpp_pdqsort_branchless_unstable",
+                 pdqsort_branchless_unstable),
+      SORT_ENTRY("cpp_pdqsort_lomcyc_unstable", pdqsort_lomcyc_unstable),
+#endif
+#if defined(BENCH_CPP_POWERSORT)
+      SORT_ENTRY("cpp_powersort_stable", powersort_stable),
+      SORT_ENTRY("cpp_powersort_4way_stable", powersort_4way_stable),
+#endif
+#if defined(BENCH_CPP_SIMDSORT)
+      SORT_ENTRY("cpp_simdsort", simdsort_avx2),
+#endif
+#if defined(BENCH_CPP_RADIX)
+      SORT_ENTRY("cpp_radix", radix),
+#endif
+#if defined(BENCH_CPP_IPS4O)
+      SORT_ENTRY("cpp_ips4o_unstable", ips4o_unstable),
+#endif
+#if defined(BENCH_CPP_BLOCKQUICKSORT)
+      SORT_ENTRY("cpp_blockquicksort_unstable", blockquicksort_unstable),
+#endif
+#if defined(BENCH_CPP_GERBENS_QSORT)
+      SORT_ENTRY("cpp_gerbens_qsort_unstable", gerbens_qsort_unstable),
+#endif
+#if defined(BENCH_CPP_NANOSORT)
+      SORT_ENTRY("cpp_nanosort_unstable", nanosort_unstable),
+#endif
+#if defined(BENCH_CPP_WIKISORT)
+      SORT_ENTRY("cpp_wikisort_stable", wikisort_stable),
+#endif
+#if defined(BENCH_C_STD_SYS)
+      SORT_ENTRY("c_std_sys_unstable", qsort_unstable),
+#endif
+#if defined(BENCH_C_FAST_QSORT)
+      SORT_ENTRY("c_fast_qsort_unstable", fast_qsort_unstable),
+#endif
+#if defined(BENCH_C_CRUMSORT)
+      SORT_ENTRY("c_crumsort_unstable", crumsort_unstable),
+#endif
+#if defined(BENCH_C_FLUXSORT)
+      SORT_ENTRY("c_fluxsort_stable", fluxsort_stable),
+#endif
+#if defined(BENCH_SINGELI_SINGELISORT)
+      SORT_ENTRY("singeli_singelisort", singelisort),
+#endif
+  };
+}
+
+// --- Random number generation ---
+
+// The Rust patterns use rand 0.8 StdRng, which is ChaCha12 seeded through
+// SeedableRng::seed_from_u64. Reproducing both here makes OVERRIDE_SEED yield
+// the same inputs in both drivers.
+class ChaCha12Rng {
+ public:
+  explicit ChaCha12Rng(uint64_t seed) noexcept {
+    // rand_core expands the u64 into the 32 byte key with PCG32.
+    for (uint32_t& word : _key) {
+      seed = seed * 6364136223846793005ull + 11634580027462260723ull;
+      const uint32_t xorshifted =
+          static_cast<uint32_t>(((seed >> 18) ^ seed) >> 27);
+      const uint32_t rot = static_cast<uint32_t>(seed >> 59);
+      word = (xorshifted >> rot) | (xorshifted << ((32 - rot) & 31));
+    }
+  }
+
+  uint32_t next_u32() noexcept {
+    if (_index == 16) {
+      refill();
+    }
+    return _block[_index++];
+  }
+
+  // Low word first, as rand_core's BlockRng does.
+  uint64_t next_u64() noexcept {
+    const uint64_t lo = next_u32();
+    const uint64_t hi = next_u32();
+    return (hi << 32) | lo;
+  }
+
+  // rand's Standard distribution for f64, uniformly in [0, 1).
+  double next_f64() noexcept {
+    return static_cast<double>(next_u64() >> 11) * 0x1.0p-53;
+  }
+
+ private:
+  static uint32_t rotl(uint32_t x, int n) noexcept {
+    return (x << n) | (x >> (32 - n));
+  }
+
+  static void quarter_round(uint32_t* s, int a, int b, int c, int d) noexcept {
+    s[a] += s[b];
+    s[d] = rotl(s[d] ^ s[a], 16);
+    s[c] += s[d];
+    s[b] = rotl(s[b] ^ s[c], 12);
+    s[a] += s[b];
+    s[d] = rotl(s[d] ^ s[a], 8);
+    s[c] += s[d];
+    s[b] = rotl(s[b] ^ s[c], 7);
+  }
+
+  void refill() noexcept {
+    uint32_t input[16] = {0x61707865, 0x3320646e, 0x79622d32, 0x6b206574};
+    std::memcpy(input + 4, _key, sizeof(_key));
+    input[12] = static_cast<uint32_t>(_counter);
+    input[13] = static_cast<uint32_t>(_counter >> 32);
+    // Words 14 and 15 are the stream id, always 0.
+
+    std::memcpy(_block, input, sizeof(input));
+    for (int i = 0; i < 6; ++i) {
+      quarter_round(_block, 0, 4, 8, 12);
+      quarter_round(_block, 1, 5, 9, 13);
+      quarter_round(_block, 2, 6, 10, 14);
+      quarter_round(_block, 3, 7, 11, 15);
+      quarter_round(_block, 0, 5, 10, 15);
+      quarter_round(_block, 1, 6, 11, 12);
+      quarter_round(_block, 2, 7, 8, 13);
+      quarter_round(_block, 3, 4, 9, 14);
+    }
+    for (int i = 0; i < 16; ++i) {
+      _block[i] += input[i];
+    }
+
+    ++_counter;
+    _index = 0;
+  }
+
+  uint32_t _key[8];
+  uint32_t _block[16];
+  uint64_t _counter = 0;
+  int _index = 16;
+};
+
+std::optional<uint64_t> override_seed() {
+  static const std::optional<uint64_t> seed =
+      []() -> std::optional<uint64_t> {
+    const char* val = std::getenv("OVERRIDE_SEED");
+    if (val == nullptr) {
+      return std::nullopt;
+    }
+    return std::strtoull(val, nullptr, 10);
+  }();
+  return seed;
+}
+
+ChaCha12Rng new_rng() {
+  if (const auto seed = override_seed()) {
+    return ChaCha12Rng{*seed};
+  }
+
+  static std::random_device random_device;
+  const uint64_t seed =
+      (static_cast<uint64_t>(random_device()) << 32) | random_device();
+  return ChaCha12Rng{seed};
+}
+
+// rand 0.8 UniformInt<i32>::sample, widening multiply with rejection zone.
+class UniformI32 {
+ public:
+  UniformI32(int32_t low, int32_t high_inclusive) noexcept
+      : _low{low},
+        _range{static_cast<uint32_t>(high_inclusive) -
+               static_cast<uint32_t>(low) + 1} {
+    const uint32_t ints_to_reject =
+        _range > 0 ? (UINT32_MAX - _range + 1) % _range : 0;
+    _zone = UINT32_MAX - ints_to_reject;
+  }
+
+  int32_t sample(ChaCha12Rng& rng) const noexcept {
+    if (_range == 0) {
+      return static_cast<int32_t>(rng.next_u32());
+    }
+
+    while (true) {
+      const uint64_t product = uint64_t{rng.next_u32()} * _range;
+      if (static_cast<uint32_t>(product) <= _zone) {
+        return static_cast<int32_t>(static_cast<uint32_t>(_low) +
+                                    static_cast<uint32_t>(product >> 32));
+      }
+    }
+  }
+
+ private:
+  int32_t _low;
+  uint32_t _range;
+  uint32_t _zone;
+};
+
+// zipf 7.0 ZipfDistribution, rejection inversion sampling.
+class ZipfDistribution {
+ public:
+  ZipfDistribution(size_t num_elements, double exponent) noexcept
+      : _num_elements{static_cast<double>(num_elements)},
+        _exponent{exponent},
+        _h_integral_x1{h_integral(1.5) - 1.0},
+        _h_integral_num_elements{h_integral(_num_elements + 0.5)},
+        _s{2.0 - h_integral_inv(h_integral(2.5) - h(2.0))} {}
+
+  size_t sample(ChaCha12Rng& rng) const noexcept {
+    const double hnum = _h_integral_num_elements;
+    while (true) {
+      const double u = hnum + rng.next_f64() * (_h_integral_x1 - hnum);
+      const double x = h_integral_inv(u);
+      const double k64 = std::min(std::max(x, 1.0), _num_elements);
+      const size_t k = std::max<size_t>(1, static_cast<size_t>(k64 + 0.5));
+      if (k64 - x <= _s || u >= h_integral(k64 + 0.5) - h(k64)) {
+        return k;
+      }
+    }
+  }
+
+ private:
+  static double helper1(double x) noexcept {
+    return std::abs(x) > 1e-8
+               ? std::log1p(x) / x
+               : 1.0 - x * (0.5 - x * (1.0 / 3.0 - 0.25 * x));
+  }
+
+  static double helper2(double x) noexcept {
+    return std::abs(x) > 1e-8
+               ? std::expm1(x) / x
+               : 1.0 + x * 0.5 * (1.0 + x * 1.0 / 3.0 * (1.0 + 0.25 * x));
+  }
+
+  double h_integral(double x) const noexcept {
+    const double log_x = std::log(x);
+    return helper2((1.0 - _exponent) * log_x) * log_x;
+  }
+
+  double h(double x) const noexcept {
+    return std::exp(-_exponent * std::log(x));
+  }
+
+  double h_integral_inv(double x) const noexcept {
+    const double t = std::max(x * (1.0 - _exponent), -1.0);
+    return std::exp(helper1(t) * x);
+  }
+
+  double _num_elements;
+  double _exponent;
+  double _h_integral_x1;
+  double _h_integral_num_elements;
+  double _s;
+};
+
+// --- Patterns, see sort_test_tools/src/patterns.rs ---
+
+std::vector<int32_t> random(size_t len) {
+  ChaCha12Rng rng = new_rng();
+  std::vector<int32_t> v(len);
+  for (int32_t& val : v) {
+    val = static_cast<int32_t>(rng.next_u32());
+  }
+  return v;
+}
+
+std::vector<int32_t> random_uniform(size_t len,
+                                    int32_t low,
+                                    int32_t high_inclusive) {
+  ChaCha12Rng rng = new_rng();
+  const UniformI32 dist{low, high_inclusive};
+  std::vector<int32_t> v(len);
+  for (int32_t& val : v) {
+    val = dist.sample(rng);
+  }
+  return v;
+}
+
+std::vector<int32_t> random_zipf(size_t len, double exponent) {
+  ChaCha12Rng rng = new_rng();
+  const ZipfDistribution dist{len, exponent};
+  std::vector<int32_t> v(len);
+  for (int32_t& val : v) {
+    val = static_cast<int32_t>(dist.sample(rng));
+  }
+  return v;
+}
+
+std::vector<int32_t> random_sorted(size_t len, double sorted_percent) {
+  std::vector<int32_t> v = random(len);
+  const auto sorted_len = static_cast<size_t>(
+      std::round(static_cast<double>(len) * (sorted_percent / 100.0)));
+  std::sort(v.begin(), v.begin() + sorted_len);
+  return v;
+}
+
+std::vector<int32_t> ascending(size_t len) {
+  std::vector<int32_t> v(len);
+  for (size_t i = 0; i < len; ++i) {
+    v[i] = static_cast<int32_t>(i);
+  }
+  return v;
+}
+
+std::vector<int32_t> descending(size_t len) {
+  std::vector<int32_t> v = ascending(len);
+  std::reverse(v.begin(), v.end());
+  return v;
+}
+
+struct Pattern {
+  const char* name;
+  std::vector<int32_t> (*provider)(size_t);
+};
+
+// The default set of bench_patterns in benches/bench.rs.
+const Pattern kPatterns[] = {
+    {"random", random},
+    {"random_z1", [](size_t len) { return random_zipf(len, 1.0); }},
+    {"random_d20", [](size_t len) { return random_uniform(len, 0, 19); }},
+    {"random_s95", [](size_t len) { return random_sorted(len, 95.0); }},
+    {"ascending", ascending},
+    {"descending", descending},
+};
+
+const size_t kTestSizes[] = {
+    0,       1,         2,         3,         4,          6,
+    8,       10,        12,        17,        24,         35,
+    49,      70,        100,       200,       400,        900,
+    2'048,   4'833,     10'000,    22'367,    50'000,     100'000,
+    183'845, 400'000,   1'000'000, 2'000'000, 4'281'332,  10'000'000,
+};
+
+// Same transform as extend_i32_to_u64 in benches/bench.rs.
+uint64_t extend_i32_to_u64(int32_t val) {
+  const uint32_t shifted = static_cast<uint32_t>(int64_t{val} + INT32_MAX + 1);
+  return uint64_t{shifted} * INT32_MAX;
+}
+
+std::vector<int32_t> transform_to(std::vector<int32_t> values, int32_t) {
+  return values;
+}
+
+std::vector<uint64_t> transform_to(const std::vector<int32_t>& values,
+                                   uint64_t) {
+  std::vector<uint64_t> result(values.size());
+  std::transform(values.begin(), values.end(), result.begin(),
+                 extend_i32_to_u64);
+  return result;
+}
+
+// --- Measurement ---
+
+using Clock = std::chrono::steady_clock;
+
+struct BenchConfig {
+  double warm_up_secs = 2.0;
+  double measurement_secs = 4.0;
+};
+
+// Short inputs are sorted in batches of copies laid out back to back, so that
+// the clock resolution doesn't dominate. Same idea as criterion's
+// iter_batched, without the per call closure and allocation.
+constexpr size_t kMinBatchElems = 4096;
+constexpr size_t kMinSamples = 10;
+constexpr size_t kMaxSamples = 100;
+
+template <typename T>
+double measure(void (*sort_fn)(T*, size_t),
+               const Pattern& pattern,
+               size_t len,
+               const BenchConfig& config) {
+  const size_t batch = len >= kMinBatchElems
+                           ? 1
+                           : (kMinBatchElems + std::max<size_t>(len, 1) - 1) /
+                                 std::max<size_t>(len, 1);
+  std::vector<T> work(batch * len);
+  std::vector<double> sample_ns;
+
+  const auto run_sample = [&] {
+    // A new input per sample, like criterion's setup closure.
+    const std::vector<T> input = transform_to(pattern.provider(len), T{});
+    for (size_t i = 0; i < batch; ++i) {
+      std::copy(input.begin(), input.end(), work.begin() + i * len);
+    }
+
+    const auto start = Clock::now();
+    for (size_t i = 0; i < batch; ++i) {
+      sort_fn(work.data() + i * len, len);
+    }
+    const auto end = Clock::now();
+
+    return std::chrono::duration<double, std::nano>(end - start).count() /
+           static_cast<double>(batch);
+  };
+
+  const auto elapsed_secs = [](Clock::time_point since) {
+    return std::chrono::duration<double>(Clock::now() - since).count();
+  };
+
+  const auto warm_up_start = Clock::now();
+  do {
+    run_sample();
+  } while (elapsed_secs(warm_up_start) < config.warm_up_secs);
+
+  const auto measurement_start = Clock::now();
+  while (sample_ns.size() < kMinSamples ||
+         (sample_ns.size() < kMaxSamples &&
+          elapsed_secs(measurement_start) < config.measurement_secs)) {
+    sample_ns.push_back(run_sample());
+  }
+
+  const auto mid = sample_ns.begin() + sample_ns.size() / 2;
+  std::nth_element(sample_ns.begin(), mid, sample_ns.end());
+  return *mid;
+}
+
+bool should_run_benchmark(const std::string& name) {
+  static const std::optional<std::regex> filter_regex =
+      []() -> std::optional<std::regex> {
+    const char* val = std::getenv("BENCH_REGEX");
+    if (val == nullptr) {
+      return std::nullopt;
+    }
+    return std::regex{val};
+  }();
+
+  return !filter_regex || std::regex_search(name, *filter_regex);
+}
+
+struct BenchResult {
+  std::string name;
+  double median_ns;
+};
+
+template <typename T>
+void bench_type(const char* type_name,
+                void (*SortEntry::*sort_fn)(T*, size_t),
+                size_t len,
+                const BenchConfig& config,
+                std::vector<BenchResult>& results) {
+  for (const Pattern& pattern : kPatterns) {
+    if (len < 3 && std::strcmp(pattern.name, "random") != 0) {
+      continue;
+    }
+
+    for (const SortEntry& sort : enabled_sorts()) {
+      const std::string name = std::string{sort.name} + "-hot-" + type_name +
+                               "-" + pattern.name + "-" + std::to_string(len);
+      if (!should_run_benchmark(name)) {
+        continue;
+      }
+
+      const double median_ns = measure(sort.*sort_fn, pattern, len, config);
+      std::fprintf(stderr, "%-70s %14.1f ns\n", name.c_str(), median_ns);
+      results.push_back({name, median_ns});
+    }
+  }
+}
+
+// Only the fields of the critcmp export the result tools read.
+void write_results(const std::string& result_name,
+                   const std::vector<BenchResult>& results) {
+  const std::string path = result_name + ".json";
+  FILE* file = std::fopen(path.c_str(), "w");
+  if (file == nullptr) {
+    std::fprintf(stderr, "Failed to open %s\n", path.c_str());
+    std::exit(1);
+  }
+
+  std::fprintf(file, "{\"name\": \"%s\", \"benchmarks\": {",
+               result_name.c_str());
+  for (size_t i = 0; i < results.size(); ++i) {
+    const BenchResult& result = results[i];
+    std::fprintf(file,
+                 "%s\n  \"%s\": {\"baseline\": \"%s\", \"fullname\": "
+                 "\"%s/%s\", \"criterion_estimates_v1\": {\"median\": "
+                 "{\"point_estimate\": %.3f}}}",
+                 i == 0 ? "" : ",", result.name.c_str(), result_name.c_str(),
+                 result_name.c_str(), result.name.c_str(), result.median_ns);
+  }
+  std::fprintf(file, "\n}}\n");
+  std::fclose(file);
+
+  std::fprintf(stderr, "\nWrote results to %s\n", path.c_str());
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    std::fprintf(stderr,
+                 "Usage: %s <result name> [--warm-up-time <s>] "
+                 "[--measurement-time <s>]\n",
+                 argv[0]);
+    return 1;
+  }
+
+  const std::string result_name = argv[1];
+  BenchConfig config;
+  for (int i = 2; i + 1 < argc; i += 2) {
+    if (std::strcmp(argv[i], "--warm-up-time") == 0) {
+      config.warm_up_secs = std::atof(argv[i + 1]);
+    } else if (std::strcmp(argv[i], "--measurement-time") == 0) {
+      config.measurement_secs = std::atof(argv[i + 1]);
+    } else {
+      std::fprintf(stderr, "Unknown argument %s\n", argv[i]);
+      return 1;
+    }
+  }
+
+  std::vector<BenchResult> results;
+  for (const size_t len : kTestSizes) {
+    bench_type<int32_t>("i32", &SortEntry::sort_i32, len, config, results);
+    bench_type<uint64_t>("u64", &SortEntry::sort_u64, len, config, results);
+  }
+
+  write_results(result_name, results);
+  return 0;
+}
@@ -1,18 +1,130 @@
+// Has to come before crumsort.h, the SORT_TELEMETRY hooks call into it.
+#include "sort_telemetry.h"
 #include "thirdparty/scandum/crumsort.h"
 
 #include <stdint.h>
+#include <algorithm>
+#include <bit>
+#include <memory>
 #include <stdexcept>
 
 #include "shared.h"
 
+// crumsort.h only instantiates the sort for scalar types, a 16 byte VAR would
+// be copied as long double. The records are instantiated the same way as
+// crumsort_r, with a context carrying comparison function, for the _with_buf
+// entry points.
+#define QUAD_CACHE 4294967295
+#define CMP_R
+#define CMPFUNC struct cmp_r
+#define cmp(a, b) (cmp->fn((a), (b), cmp->arg))
+
+#define VAR F128
+#define FUNC(NAME) NAME##_f128_r
+#include "thirdparty/scandum/quadsort.c"
+#include "thirdparty/scandum/crumsort.c"
+#undef VAR
+#undef FUNC
+
+#define VAR FFIOneKibiByte
+#define FUNC(NAME) NAME##_1k_r
+#include "thirdparty/scandum/quadsort.c"
+#include "thirdparty/scandum/crumsort.c"
+#undef VAR
+#undef FUNC
+
+#undef cmp
+#undef CMPFUNC
+#undef CMP_R
+#undef QUAD_CACHE
+
+// crumsort itself only ever picks a power of two swap of at least 128
+// elements. Other sizes can sort incorrectly or write past the swap, so the
+// caller provided buffer is rounded down to a power of two, and buffers with
+// room for fewer elements fall back to the regular entry points.
+constexpr size_t CRUM_MIN_SWAP_LEN = 128;
+
+// Largest power of two swap len that fits into buf_bytes, or 0 if that is
+// smaller than CRUM_MIN_SWAP_LEN.
+template <typename T>
+size_t crum_swap_len(size_t buf_bytes) {
+  const size_t max_len = buf_bytes / sizeof(T);
+  if (max_len < CRUM_MIN_SWAP_LEN) {
+    return 0;
+  }
+
+  return std::bit_floor(max_len);
+}
+
+// Sorts data with the caller provided swap if it has room for at least
+// CRUM_MIN_SWAP_LEN elements, with swap_fallback otherwise.
+template <typename T, typename F, typename Fallback>
+void crumsort_with_buf(T* data,
+                       size_t len,
+                       uint8_t* buf,
+                       size_t buf_bytes,
+                       F crumsort_swap,
+                       Fallback swap_fallback) {
+  if (len < 2) {
+    return;
+  }
+
+  const size_t swap_len = crum_swap_len<T>(buf_bytes);
+  T* swap = scratch_from_buf<T>(buf, buf_bytes, swap_len);
+
+  if (swap_len == 0 || swap == nullptr) {
+    swap_fallback();
+    return;
+  }
+
+  crumsort_swap(data, swap, swap_len, len);
+}
+
+// Sorts the records with crumsort_swap_r, the _f128_r or _1k_r instantiation.
+// crumsort itself would put a swap of CRUM_AUX elements on the stack, that's
+// half a MiB for the 1k records. The swap is allocated instead, and shorter
+// inputs get a shorter one.
+template <typename T, typename F>
+void crumsort_record(T* data,
+                     size_t len,
+                     struct cmp_r* cmp,
+                     F crumsort_swap_r) {
+  if (len < 2) {
+    return;
+  }
+
+  const size_t swap_len = std::clamp<size_t>(std::bit_ceil(len),
+                                             CRUM_MIN_SWAP_LEN, CRUM_AUX);
+  std::unique_ptr<T[]> swap{new T[swap_len]};
+  crumsort_swap_r(data, swap.get(), swap_len, len, cmp);
+}
+
+template <typename T, typename TCpp, typename F>
+void crumsort_record_with_buf(T* data,
+                              size_t len,
+                              uint8_t* buf,
+                              size_t buf_bytes,
+                              F crumsort_swap_r) {
+  struct cmp_r cmp_ctx = {record_compare_fn_r<TCpp>, nullptr};
+
+  crumsort_with_buf(
+      data, len, buf, buf_bytes,
+      [&](T* data, T* swap, size_t swap_len, size_t len) {
+        crumsort_swap_r(data, swap, swap_len, len, &cmp_ctx);
+      },
+      [&]() { crumsort_record(data, len, &cmp_ctx, crumsort_swap_r); });
+}
+
 template <typename T>
 uint32_t sort_by_impl(T* data,
                       size_t len,
                       CompResult (*cmp_fn)(const T&, const T&, uint8_t*),
                       uint8_t* ctx) noexcept {
+  CCompareCtx<T> cmp_ctx{cmp_fn, ctx};
+
   try {
-    crumsort(static_cast<void*>(data), len, sizeof(T),
-             make_compare_fn_c(cmp_fn, ctx));
+    crumsort_r(static_cast<void*>(data), len, sizeof(T), c_compare_fn_r<T>,
+               static_cast<void*>(&cmp_ctx));
   } catch (...) {
     return 1;
   }
@@ -20,10 +132,50 @@ uint32_t sort_by_impl(T* data,
   return 0;
 }
 
+// crumsort_r would pick its instantiation by the size of T, which breaks the
+// records, see crumsort_record.
+template <typename T, typename F>
+uint32_t sort_record_by_impl(T* data,
+                             size_t len,
+                             CompResult (*cmp_fn)(const T&, const T&, uint8_t*),
+                             uint8_t* ctx,
+                             F crumsort_swap_r) noexcept {
+  CCompareCtx<T> cmp_ctx{cmp_fn, ctx};
+  struct cmp_r cmp = {c_compare_fn_r<T>, static_cast<void*>(&cmp_ctx)};
+
+  try {
+    crumsort_record(data, len, &cmp, crumsort_swap_r);
+  } catch (...) {
+    return 1;
+  }
+
+  return 0;
+}
+
+// fulcrum_default_partition, the partition of fulcrum_partition, with the
+// smallest swap crumsort picks. It moves the elements less than or equal to the
+// pivot to the front. Inputs that fit into the swap are partitioned in there,
+// eight elements at a time, which needs at least eight of them.
+template <typename T, typename F>
+size_t partition_impl(T* data, size_t len, T pivot, F fulcrum_partition) {
+  return partition_le_as_lt(
+      data, len, pivot, [&](T* data, size_t len, T pivot) -> size_t {
+        if (len < 8) {
+          return std::partition(data, data + len,
+                                [&](T val) { return !(pivot < val); }) -
+                 data;
+        }
+
+        T swap[CRUM_MIN_SWAP_LEN];
+        return fulcrum_partition(data, swap, &pivot, CRUM_MIN_SWAP_LEN, len);
+      });
+}
+
 extern "C" {
 // --- i32 ---
 
 void crumsort_unstable_i32(int32_t* data, size_t len) {
+  SORT_USDT_PROBE(len);
   crumsort_prim(static_cast<void*>(data), len, /*signed int*/ 4);
 }
 
@@ -33,12 +185,27 @@ uint32_t crumsort_unstable_i32_by(int32_t* data,
                                                        const int32_t&,
                                                        uint8_t*),
                                   uint8_t* ctx) {
+  SORT_USDT_PROBE(len);
   return sort_by_impl(data, len, cmp_fn, ctx);
 }
 
+void crumsort_unstable_i32_with_buf(int32_t* data,
+                                    size_t len,
+                                    uint8_t* buf,
+                                    size_t buf_bytes) {
+  SORT_USDT_PROBE(len);
+  crumsort_with_buf(
+      data, len, buf, buf_bytes,
+      [](int32_t* data, int32_t* swap, size_t swap_len, size_t len) {
+        crumsort_swap_int32(data, swap, swap_len, len, nullptr);
+      },
+      [&]() { crumsort_unstable_i32(data, len); });
+}
+
 // --- u64 ---
 
 void crumsort_unstable_u64(uint64_t* data, size_t len) {
+  SORT_USDT_PROBE(len);
   crumsort_prim(static_cast<void*>(data), len, /*unsigned long long*/ 9);
 }
 
@@ -48,12 +215,29 @@ uint32_t crumsort_unstable_u64_by(uint64_t* data,
                                                        const uint64_t&,
                                                        uint8_t*),
                                   uint8_t* ctx) {
+  SORT_USDT_PROBE(len);
   return sort_by_impl(data, len, cmp_fn, ctx);
 }
 
+void crumsort_unstable_u64_with_buf(uint64_t* data,
+                                    size_t len,
+                                    uint8_t* buf,
+                                    size_t buf_bytes) {
+  SORT_USDT_PROBE(len);
+  crumsort_with_buf(
+      data, len, buf, buf_bytes,
+      [](uint64_t* data, uint64_t* swap, size_t swap_len, size_t len) {
+        crumsort_swap_uint64(reinterpret_cast<unsigned long long*>(data),
+                             reinterpret_cast<unsigned long long*>(swap),
+                             swap_len, len, nullptr);
+      },
+      [&]() { crumsort_unstable_u64(data, len); });
+}
+
 // --- ffi_string ---
 
 void crumsort_unstable_ffi_string(FFIString* data, size_t len) {
+  SORT_USDT_PROBE(len);
   // Value would have to be sorted by indirection.
   printf("Not supported\n");
 }
@@ -71,8 +255,9 @@ uint32_t crumsort_unstable_ffi_string_by(FFIString* data,
 // --- f128 ---
 
 void crumsort_unstable_f128(F128* data, size_t len) {
-  // Swaps values incorrectly, or my implementation is wrong.
-  printf("Not supported\n");
+  SORT_USDT_PROBE(len);
+  struct cmp_r cmp = {record_compare_fn_r<F128Cpp>, nullptr};
+  crumsort_record(data, len, &cmp, crumsort_swap_f128_r);
 }
 
 uint32_t crumsort_unstable_f128_by(F128* data,
@@ -81,15 +266,25 @@ uint32_t crumsort_unstable_f128_by(F128* data,
                                                         const F128&,
                                                         uint8_t*),
                                    uint8_t* ctx) {
-  printf("Not supported\n");
-  return 1;
+  SORT_USDT_PROBE(len);
+  return sort_record_by_impl(data, len, cmp_fn, ctx, crumsort_swap_f128_r);
+}
+
+void crumsort_unstable_f128_with_buf(F128* data,
+                                     size_t len,
+                                     uint8_t* buf,
+                                     size_t buf_bytes) {
+  SORT_USDT_PROBE(len);
+  crumsort_record_with_buf<F128, F128Cpp>(data, len, buf, buf_bytes,
+                                          crumsort_swap_f128_r);
 }
 
 // --- 1k ---
 
 void crumsort_unstable_1k(FFIOneKibiByte* data, size_t len) {
-  // Value would have to be sorted by indirection.
-  printf("Not supported\n");
+  SORT_USDT_PROBE(len);
+  struct cmp_r cmp = {record_compare_fn_r<FFIOneKiloByteCpp>, nullptr};
+  crumsort_record(data, len, &cmp, crumsort_swap_1k_r);
 }
 
 uint32_t crumsort_unstable_1k_by(FFIOneKibiByte* data,
@@ -98,7 +293,48 @@ uint32_t crumsort_unstable_1k_by(FFIOneKibiByte* data,
                                                       const FFIOneKibiByte&,
                                                       uint8_t*),
                                  uint8_t* ctx) {
-  printf("Not supported\n");
-  return 1;
+  SORT_USDT_PROBE(len);
+  return sort_record_by_impl(data, len, cmp_fn, ctx, crumsort_swap_1k_r);
+}
+
+void crumsort_unstable_1k_with_buf(FFIOneKibiByte* data,
+                                   size_t len,
+                                   uint8_t* buf,
+                                   size_t buf_bytes) {
+  SORT_USDT_PROBE(len);
+  crumsort_record_with_buf<FFIOneKibiByte, FFIOneKiloByteCpp>(
+      data, len, buf, buf_bytes, crumsort_swap_1k_r);
+}
+
+// --- partition ---
+
+size_t crumsort_partition_i32(int32_t* data, size_t len, const int32_t* pivot) {
+  SORT_USDT_PROBE(len);
+  return partition_impl(data, len, *pivot,
+                        [](int32_t* data, int32_t* swap, int32_t* pivot,
+                           size_t swap_len, size_t len) {
+                          return fulcrum_default_partition_int32(
+                              data, swap, data, pivot, swap_len, len, nullptr);
+                        });
+}
+
+size_t crumsort_partition_u64(uint64_t* data,
+                              size_t len,
+                              const uint64_t* pivot) {
+  SORT_USDT_PROBE(len);
+  return partition_impl(
+      data, len, *pivot,
+      [](uint64_t* data, uint64_t* swap, uint64_t* pivot, size_t swap_len,
+         size_t len) {
+        using VarT = unsigned long long;
+        return fulcrum_default_partition_uint64(
+            reinterpret_cast<VarT*>(data), reinterpret_cast<VarT*>(swap),
+            reinterpret_cast<VarT*>(data), reinterpret_cast<VarT*>(pivot),
+            swap_len, len, nullptr);
+      });
 }
 }  // extern "C"
+
+#if defined(SORT_TELEMETRY)
+SORT_TELEMETRY_EXPORT(crumsort_unstable)
+#endif
@@ -0,0 +1,352 @@
+// Drop-in replacement for qsort and the glibc qsort_r, see fast_qsort.h.
+//
+// qsort only sees bytes, every comparison is an indirect call and every move a
+// byte wise swap. fast_qsort looks up the comparison function by address and
+// element size among the ones known to be the natural order of a type. These
+// are int_cmp_func and cpp_type_cmp_func of shared.h and the ones registered
+// with fast_qsort_register. A known one sorts with pdqsort and inlined
+// comparisons instead, or with vqsort for i32 and u64 if cpp_vqsort is enabled,
+// which defines FAST_QSORT_CPP_VQSORT.
+//
+// Other comparison functions stay indirect calls. Elements of 1 to 32 bytes,
+// powers of two, are moved by pdqsort as a type of that size. Other sizes sort
+// an array of pointers and move every element once at the end, same as
+// sort_indirect.
+
+#include "thirdparty/pdqsort/pdqsort.h"
+
+#include <atomic>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include <stdint.h>
+
+#include "fast_qsort.h"
+#include "shared.h"
+
+#if defined(FAST_QSORT_CPP_VQSORT)
+extern "C" {
+void vqsort_i32(int32_t* data, size_t len);
+void vqsort_u64(uint64_t* data, size_t len);
+}
+#endif
+
+namespace {
+
+template <typename T>
+void sort_natural_order(void* base, size_t nmemb) {
+  T* data = static_cast<T*>(base);
+
+#if defined(FAST_QSORT_CPP_VQSORT)
+  if constexpr (std::is_same_v<T, int32_t>) {
+    vqsort_i32(data, nmemb);
+    return;
+  } else if constexpr (std::is_same_v<T, uint64_t>) {
+    vqsort_u64(data, nmemb);
+    return;
+  }
+#endif
+
+  if constexpr (std::is_integral_v<T>) {
+    pdqsort_branchless(data, data + nmemb);
+  } else if constexpr (sizeof(T) >= 512) {
+    // Same crossover as measured for sort_indirect.
+    sort_indirect(data, nmemb, [](auto begin, auto end, auto comp) {
+      pdqsort(begin, end, comp);
+    });
+  } else {
+    pdqsort(data, data + nmemb);
+  }
+}
+
+struct NaturalOrder {
+  CMPFUNC* cmp_fn;
+  size_t size;
+  void (*sort_fn)(void* base, size_t nmemb);
+};
+
+template <typename T, typename CppT = T>
+constexpr NaturalOrder natural_order(CMPFUNC* cmp_fn) {
+  return NaturalOrder{cmp_fn, sizeof(T), sort_natural_order<CppT>};
+}
+
+const NaturalOrder BUILTIN_NATURAL_ORDERS[] = {
+    natural_order<int32_t>(int_cmp_func<int32_t>),
+    natural_order<uint32_t>(int_cmp_func<uint32_t>),
+    natural_order<int64_t>(int_cmp_func<int64_t>),
+    natural_order<uint64_t>(int_cmp_func<uint64_t>),
+    natural_order<FFIString, FFIStringCpp>(cpp_type_cmp_func<FFIStringCpp>),
+    natural_order<F128, F128Cpp>(cpp_type_cmp_func<F128Cpp>),
+    natural_order<FFIOneKibiByte, FFIOneKiloByteCpp>(
+        cpp_type_cmp_func<FFIOneKiloByteCpp>),
+};
+
+// Entries below registered_len are never written again, so lookups only need
+// the acquire load of registered_len. Registrations take the mutex.
+constexpr size_t MAX_REGISTERED = 16;
+NaturalOrder registered[MAX_REGISTERED];
+std::atomic<size_t> registered_len{0};
+std::mutex register_mutex;
+
+using SortFn = void (*)(void* base, size_t nmemb);
+
+SortFn find_natural_order(CMPFUNC* compar, size_t size) {
+  for (const NaturalOrder& order : BUILTIN_NATURAL_ORDERS) {
+    if (order.cmp_fn == compar && order.size == size) {
+      return order.sort_fn;
+    }
+  }
+
+  const size_t len = registered_len.load(std::memory_order_acquire);
+  for (size_t i = 0; i < len; ++i) {
+    if (registered[i].cmp_fn == compar && registered[i].size == size) {
+      return registered[i].sort_fn;
+    }
+  }
+
+  return nullptr;
+}
+
+// Alignment of 1, base doesn't have to be aligned for the size.
+template <size_t N>
+struct Bytes {
+  unsigned char bytes[N];
+};
+
+template <typename E, typename Less>
+void sort_as(void* base, size_t nmemb, Less less) {
+  E* data = static_cast<E*>(base);
+  pdqsort(data, data + nmemb,
+          [less](const E& a, const E& b) { return less(&a, &b); });
+}
+
+template <typename Less>
+void sort_indirect_bytes(void* base, size_t nmemb, size_t size, Less less) {
+  char* data = static_cast<char*>(base);
+
+  std::vector<const char*> ptrs(nmemb);
+  for (size_t i = 0; i < nmemb; ++i) {
+    ptrs[i] = data + (i * size);
+  }
+
+  pdqsort(ptrs.begin(), ptrs.end(),
+          [less](const char* a, const char* b) { return less(a, b); });
+
+  // apply_permutation with the element size known only at runtime.
+  std::vector<char> tmp(size);
+  for (size_t i = 0; i < nmemb; ++i) {
+    if (ptrs[i] == data + (i * size)) {
+      continue;
+    }
+
+    std::memcpy(tmp.data(), data + (i * size), size);
+    size_t dst = i;
+    while (true) {
+      const size_t src = static_cast<size_t>(ptrs[dst] - data) / size;
+      ptrs[dst] = data + (dst * size);
+      if (src == i) {
+        break;
+      }
+
+      std::memcpy(data + (dst * size), data + (src * size), size);
+      dst = src;
+    }
+    std::memcpy(data + (dst * size), tmp.data(), size);
+  }
+}
+
+// less(a, b) takes pointers to two elements.
+template <typename Less>
+void sort_opaque(void* base, size_t nmemb, size_t size, Less less) {
+  switch (size) {
+    case 1:
+      return sort_as<Bytes<1>>(base, nmemb, less);
+    case 2:
+      return sort_as<Bytes<2>>(base, nmemb, less);
+    case 4:
+      return sort_as<Bytes<4>>(base, nmemb, less);
+    case 8:
+      return sort_as<Bytes<8>>(base, nmemb, less);
+    case 16:
+      return sort_as<Bytes<16>>(base, nmemb, less);
+    case 32:
+      return sort_as<Bytes<32>>(base, nmemb, less);
+    default:
+      return sort_indirect_bytes(base, nmemb, size, less);
+  }
+}
+
+template <typename T>
+uint32_t sort_by_impl(T* data,
+                      size_t len,
+                      CompResult (*cmp_fn)(const T&, const T&, uint8_t*),
+                      uint8_t* ctx) noexcept {
+  try {
+    CCompareCtx<T> cmp_ctx{cmp_fn, ctx};
+    fast_qsort_r(static_cast<void*>(data), len, sizeof(T), c_compare_fn_r<T>,
+                 static_cast<void*>(&cmp_ctx));
+  } catch (...) {
+    return 1;
+  }
+
+  return 0;
+}
+
+}  // namespace
+
+extern "C" {
+void fast_qsort(void* base,
+                size_t nmemb,
+                size_t size,
+                int (*compar)(const void*, const void*)) {
+  if (nmemb < 2 || size == 0) {
+    return;
+  }
+
+  if (const SortFn sort_fn = find_natural_order(compar, size)) {
+    sort_fn(base, nmemb);
+    return;
+  }
+
+  sort_opaque(base, nmemb, size, [compar](const void* a, const void* b) {
+    return compar(a, b) < 0;
+  });
+}
+
+void fast_qsort_r(void* base,
+                  size_t nmemb,
+                  size_t size,
+                  int (*compar)(const void*, const void*, void*),
+                  void* arg) {
+  if (nmemb < 2 || size == 0) {
+    return;
+  }
+
+  sort_opaque(base, nmemb, size, [compar, arg](const void* a, const void* b) {
+    return compar(a, b, arg) < 0;
+  });
+}
+
+int fast_qsort_register(int (*compar)(const void*, const void*),
+                        enum fast_qsort_type type) {
+  NaturalOrder order{};
+  switch (type) {
+    case FAST_QSORT_I32:
+      order = natural_order<int32_t>(compar);
+      break;
+    case FAST_QSORT_U32:
+      order = natural_order<uint32_t>(compar);
+      break;
+    case FAST_QSORT_I64:
+      order = natural_order<int64_t>(compar);
+      break;
+    case FAST_QSORT_U64:
+      order = natural_order<uint64_t>(compar);
+      break;
+    default:
+      return -1;
+  }
+
+  std::lock_guard<std::mutex> lock{register_mutex};
+  const size_t len = registered_len.load(std::memory_order_relaxed);
+  if (len == MAX_REGISTERED) {
+    return -1;
+  }
+
+  registered[len] = order;
+  registered_len.store(len + 1, std::memory_order_release);
+  return 0;
+}
+
+// --- i32 ---
+
+void fast_qsort_unstable_i32(int32_t* data, size_t len) {
+  SORT_USDT_PROBE(len);
+  fast_qsort(static_cast<void*>(data), len, sizeof(int32_t),
+             int_cmp_func<int32_t>);
+}
+
+uint32_t fast_qsort_unstable_i32_by(int32_t* data,
+                                    size_t len,
+                                    CompResult (*cmp_fn)(const int32_t&,
+                                                         const int32_t&,
+                                                         uint8_t*),
+                                    uint8_t* ctx) {
+  SORT_USDT_PROBE(len);
+  return sort_by_impl(data, len, cmp_fn, ctx);
+}
+
+// --- u64 ---
+
+void fast_qsort_unstable_u64(uint64_t* data, size_t len) {
+  SORT_USDT_PROBE(len);
+  fast_qsort(static_cast<void*>(data), len, sizeof(uint64_t),
+             int_cmp_func<uint64_t>);
+}
+
+uint32_t fast_qsort_unstable_u64_by(uint64_t* data,
+                                    size_t len,
+                                    CompResult (*cmp_fn)(const uint64_t&,
+                                                         const uint64_t&,
+                                                         uint8_t*),
+                                    uint8_t* ctx) {
+  SORT_USDT_PROBE(len);
+  return sort_by_impl(data, len, cmp_fn, ctx);
+}
+
+// --- ffi_string ---
+
+void fast_qsort_unstable_ffi_string(FFIString* data, size_t len) {
+  SORT_USDT_PROBE(len);
+  fast_qsort(static_cast<void*>(data), len, sizeof(FFIString),
+             cpp_type_cmp_func<FFIStringCpp>);
+}
+
+uint32_t fast_qsort_unstable_ffi_string_by(
+    FFIString* data,
+    size_t len,
+    CompResult (*cmp_fn)(const FFIString&, const FFIString&, uint8_t*),
+    uint8_t* ctx) {
+  SORT_USDT_PROBE(len);
+  return sort_by_impl(data, len, cmp_fn, ctx);
+}
+
+// --- f128 ---
+
+void fast_qsort_unstable_f128(F128* data, size_t len) {
+  SORT_USDT_PROBE(len);
+  fast_qsort(static_cast<void*>(data), len, sizeof(F128),
+             cpp_type_cmp_func<F128Cpp>);
+}
+
+uint32_t fast_qsort_unstable_f128_by(F128* data,
+                                     size_t len,
+                                     CompResult (*cmp_fn)(const F128&,
+                                                          const F128&,
+                                                          uint8_t*),
+                                     uint8_t* ctx) {
+  SORT_USDT_PROBE(len);
+  return sort_by_impl(data, len, cmp_fn, ctx);
+}
+
+// --- 1k ---
+
+void fast_qsort_unstable_1k(FFIOneKibiByte* data, size_t len) {
+  SORT_USDT_PROBE(len);
+  fast_qsort(static_cast<void*>(data), len, sizeof(FFIOneKibiByte),
+             cpp_type_cmp_func<FFIOneKiloByteCpp>);
+}
+
+uint32_t fast_qsort_unstable_1k_by(FFIOneKibiByte* data,
+                                   size_t len,
+                                   CompResult (*cmp_fn)(const FFIOneKibiByte&,
+                                                        const FFIOneKibiByte&,
+                                                        uint8_t*),
+                                   uint8_t* ctx) {
+  SORT_USDT_PROBE(len);
+  return sort_by_impl(data, len, cmp_fn, ctx);
+}
+}  // extern "C"
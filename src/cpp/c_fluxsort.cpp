@@ -1,19 +1,89 @@
 #include "thirdparty/scandum/fluxsort.h"
 
+#include <memory>
 #include <stdexcept>
+#include <vector>
 
 #include <stdint.h>
 
+#include "parallel_util.h"
 #include "shared.h"
 
+// fluxsort_r picks its instantiation by the size of the element and copies a
+// 16 byte VAR as long double. The records get their own instantiations with the
+// comparison function in a cmp_r context, so every move is a plain struct copy
+// of the full record. They live in an anonymous namespace, c_crumsort.cpp
+// instantiates quadsort for the same types under the same names.
+namespace {
+#define QUAD_CACHE 4294967295
+#define CMP_R
+#define CMPFUNC struct cmp_r
+#define cmp(a, b) (cmp->fn((a), (b), cmp->arg))
+
+#define VAR F128
+#define FUNC(NAME) NAME##_f128_r
+#include "thirdparty/scandum/quadsort.c"
+#include "thirdparty/scandum/fluxsort.c"
+#undef VAR
+#undef FUNC
+
+#define VAR FFIOneKibiByte
+#define FUNC(NAME) NAME##_1k_r
+#include "thirdparty/scandum/quadsort.c"
+#include "thirdparty/scandum/fluxsort.c"
+#undef VAR
+#undef FUNC
+
+#undef cmp
+#undef CMPFUNC
+#undef CMP_R
+#undef QUAD_CACHE
+}  // namespace
+
 template <typename T>
 uint32_t sort_by_impl(T* data,
                       size_t len,
                       CompResult (*cmp_fn)(const T&, const T&, uint8_t*),
                       uint8_t* ctx) noexcept {
+  CCompareCtx<T> cmp_ctx{cmp_fn, ctx};
+
+  try {
+    fluxsort_r(static_cast<void*>(data), len, sizeof(T), c_compare_fn_r<T>,
+               static_cast<void*>(&cmp_ctx));
+  } catch (...) {
+    return 1;
+  }
+
+  return 0;
+}
+
+// Sorts the records with fluxsort_swap_r, the _f128_r or _1k_r instantiation.
+// Unlike fluxsort, which falls back to quadsort for short inputs, that never
+// puts a swap of records on the stack.
+template <typename T, typename F>
+void fluxsort_record(T* data,
+                     size_t len,
+                     struct cmp_r* cmp,
+                     F fluxsort_swap_r) {
+  if (len < 2) {
+    return;
+  }
+
+  std::unique_ptr<T[]> swap{new T[len]};
+  fluxsort_swap_r(data, swap.get(), len, len, cmp);
+}
+
+template <typename T, typename F>
+uint32_t sort_record_by_impl(T* data,
+                             size_t len,
+                             CompResult (*cmp_fn)(const T&, const T&, uint8_t*),
+                             uint8_t* ctx,
+                             F fluxsort_swap_r) noexcept {
+  CCompareCtx<T> cmp_ctx{cmp_fn, ctx};
+  struct cmp_r cmp = {c_compare_fn_r<T>, static_cast<void*>(&cmp_ctx)};
+
   try {
-    fluxsort(static_cast<void*>(data), len, sizeof(T),
-             make_compare_fn_c(cmp_fn, ctx));
+    fluxsort_record(data, len, &cmp, fluxsort_swap_r);
   } catch (...) {
     return 1;
   }
@@ -21,10 +91,296 @@ uint32_t sort_by_impl(T* data,
   return 0;
 }
 
+// Three-way comparison of two of the pointers of sort_indirect, with the
+// comparator passed as arg.
+template <typename Ptr, typename Compare>
+int indirect_compare_fn_r(const void* a_ptr, const void* b_ptr, void* arg) {
+  Compare& comp = *static_cast<Compare*>(arg);
+  const Ptr a = *static_cast<const Ptr*>(a_ptr);
+  const Ptr b = *static_cast<const Ptr*>(b_ptr);
+
+  return static_cast<int>(comp(b, a)) - static_cast<int>(comp(a, b));
+}
+
+// Parallel driver around the single threaded fluxsort. All threads share one
+// aux buffer of len elements, every chunk sort and every merge uses the slice
+// of it that lines up with its part of data. The chunks are sorted with
+// fluxsort, and then neighbouring runs are merged in place with quadsort's
+// partial_backward_merge until a single run is left.
+//
+// Once there are fewer pairs than threads, every pair is split along the merge
+// path. The pieces of a part are not contiguous in data, so every part first
+// gathers them into its slice of the aux buffer, and after all parts are done
+// reading, copies them back into place and merges them there.
+//
+// sort_chunk(chunk, swap, chunk_len) and merge(array, swap, nmemb, block) are
+// the fluxsort and quadsort instantiations for T, comp is only used to find
+// the splits.
+template <typename T, typename SortChunkFn, typename MergeFn, typename Compare>
+bool fluxsort_parallel_impl(T* data,
+                            size_t len,
+                            size_t num_threads,
+                            SortChunkFn sort_chunk,
+                            MergeFn merge,
+                            Compare comp) {
+  if (len < 2) {
+    return true;
+  }
+
+  std::vector<T> buffer(len);
+  T* swap = buffer.data();
+
+  const size_t num_chunks = std::min(num_threads, len / PARALLEL_MIN_CHUNK_LEN);
+  if (num_chunks <= 1) {
+    return run_tasks(1, [&](size_t) { sort_chunk(data, swap, len); });
+  }
+
+  std::vector<size_t> bounds(num_chunks + 1);
+  for (size_t i = 0; i <= num_chunks; ++i) {
+    bounds[i] = (len * i) / num_chunks;
+  }
+
+  const bool sort_ok = run_tasks(num_chunks, [&](size_t i) {
+    sort_chunk(data + bounds[i], swap + bounds[i], bounds[i + 1] - bounds[i]);
+  });
+
+  if (!sort_ok) {
+    return false;
+  }
+
+  // Marks parts whose pair is already in order.
+  constexpr size_t SKIP_PART = static_cast<size_t>(-1);
+
+  while (bounds.size() > 2) {
+    const size_t num_runs = bounds.size() - 1;
+    const size_t num_pairs = num_runs / 2;
+    const size_t parts_per_pair = std::max<size_t>(num_threads / num_pairs, 1);
+
+    // An odd run at the end is already in place.
+    bool round_ok = true;
+    if (parts_per_pair == 1) {
+      round_ok = run_tasks(num_pairs, [&](size_t pair_i) {
+        const size_t begin = bounds[pair_i * 2];
+        const size_t mid = bounds[(pair_i * 2) + 1];
+        const size_t end = bounds[(pair_i * 2) + 2];
+        merge(data + begin, swap + begin, end - begin, mid - begin);
+      });
+    } else {
+      // Length of the piece of the left run, for every part.
+      std::vector<size_t> part_a_lens(num_pairs * parts_per_pair);
+
+      struct Part {
+        size_t begin;
+        size_t mid;
+        size_t end;
+        // Range of the merged pair covered by the part, relative to begin.
+        size_t out_begin;
+        size_t out_end;
+      };
+
+      auto get_part = [&bounds, parts_per_pair](size_t task_i) {
+        const size_t pair_i = task_i / parts_per_pair;
+        const size_t part_i = task_i % parts_per_pair;
+        const size_t begin = bounds[pair_i * 2];
+        const size_t end = bounds[(pair_i * 2) + 2];
+        return Part{begin, bounds[(pair_i * 2) + 1], end,
+                    ((end - begin) * part_i) / parts_per_pair,
+                    ((end - begin) * (part_i + 1)) / parts_per_pair};
+      };
+
+      round_ok = run_tasks(num_pairs * parts_per_pair, [&](size_t task_i) {
+        const auto [begin, mid, end, out_begin, out_end] = get_part(task_i);
+
+        // The comparator may be stateful and must not be shared between the
+        // threads.
+        Compare part_comp = comp;
+
+        if (!part_comp(data[mid], data[mid - 1])) {
+          part_a_lens[task_i] = SKIP_PART;
+          return;
+        }
+
+        const T* a = data + begin;
+        const T* b = data + mid;
+        const size_t a_len = mid - begin;
+        const size_t b_len = end - mid;
+
+        const size_t a_begin =
+            merge_path_split(a, a_len, b, b_len, out_begin, part_comp);
+        const size_t a_end =
+            merge_path_split(a, a_len, b, b_len, out_end, part_comp);
+
+        T* out = std::copy(a + a_begin, a + a_end, swap + begin + out_begin);
+        std::copy(b + (out_begin - a_begin), b + (out_end - a_end), out);
+        part_a_lens[task_i] = a_end - a_begin;
+      });
+
+      if (round_ok) {
+        round_ok = run_tasks(num_pairs * parts_per_pair, [&](size_t task_i) {
+          if (part_a_lens[task_i] == SKIP_PART) {
+            return;
+          }
+
+          const Part part_range = get_part(task_i);
+          const size_t part_len = part_range.out_end - part_range.out_begin;
+
+          T* part = data + part_range.begin + part_range.out_begin;
+          T* part_swap = swap + part_range.begin + part_range.out_begin;
+          std::copy(part_swap, part_swap + part_len, part);
+
+          // partial_backward_merge looks at the element before the right
+          // piece, which has to exist.
+          const size_t a_len = part_a_lens[task_i];
+          if (a_len != 0 && a_len != part_len) {
+            merge(part, part_swap, part_len, a_len);
+          }
+        });
+      }
+    }
+
+    if (!round_ok) {
+      return false;
+    }
+
+    std::vector<size_t> merged_bounds;
+    merged_bounds.reserve(num_pairs + 2);
+    for (size_t i = 0; i < bounds.size(); i += 2) {
+      merged_bounds.push_back(bounds[i]);
+    }
+    if (merged_bounds.back() != len) {
+      merged_bounds.push_back(len);
+    }
+
+    bounds = std::move(merged_bounds);
+  }
+
+  return true;
+}
+
+// VAR of the fluxsort instantiations is int and long long, which need not be
+// the same types as int32_t and uint64_t.
+template <typename T>
+void fluxsort_parallel_prim(T* data, size_t len, size_t num_threads) noexcept {
+  if constexpr (sizeof(T) == sizeof(int)) {
+    using Var = int;
+    fluxsort_parallel_impl(
+        reinterpret_cast<Var*>(data), len, num_threads,
+        [](Var* chunk, Var* swap, size_t chunk_len) {
+          fluxsort_swap_int32(chunk, swap, chunk_len, chunk_len, nullptr);
+        },
+        [](Var* array, Var* swap, size_t nmemb, size_t block) {
+          partial_backward_merge_int32(array, swap, nmemb, block, nullptr);
+        },
+        std::less<Var>{});
+  } else {
+    using Var = unsigned long long;
+    fluxsort_parallel_impl(
+        reinterpret_cast<Var*>(data), len, num_threads,
+        [](Var* chunk, Var* swap, size_t chunk_len) {
+          fluxsort_swap_uint64(chunk, swap, chunk_len, chunk_len, nullptr);
+        },
+        [](Var* array, Var* swap, size_t nmemb, size_t block) {
+          partial_backward_merge_uint64(array, swap, nmemb, block, nullptr);
+        },
+        std::less<Var>{});
+  }
+}
+
+// Same as sort_by_impl, a panic throws out of the comparison function. It's
+// caught on the thread that ran into it, see run_tasks.
+template <typename T>
+uint32_t fluxsort_parallel_by_impl(T* data,
+                                   size_t len,
+                                   CompResult (*cmp_fn)(const T&,
+                                                        const T&,
+                                                        uint8_t*),
+                                   uint8_t* ctx,
+                                   size_t num_threads) noexcept {
+  CCompareCtx<T> cmp_ctx{cmp_fn, ctx};
+  cmp_r cmp{c_compare_fn_r<T>, static_cast<void*>(&cmp_ctx)};
+  cmp_r* cmp_ptr = &cmp;
+
+  using Var = std::conditional_t<sizeof(T) == sizeof(int), int, long long>;
+
+  const auto comp = [cmp_ptr](const Var& a, const Var& b) {
+    return cmp_ptr->fn(&a, &b, cmp_ptr->arg) < 0;
+  };
+
+  bool sort_ok = false;
+  if constexpr (sizeof(T) == sizeof(int)) {
+    sort_ok = fluxsort_parallel_impl(
+        reinterpret_cast<Var*>(data), len, num_threads,
+        [cmp_ptr](Var* chunk, Var* swap, size_t chunk_len) {
+          fluxsort_swap32_r(chunk, swap, chunk_len, chunk_len, cmp_ptr);
+        },
+        [cmp_ptr](Var* array, Var* swap, size_t nmemb, size_t block) {
+          partial_backward_merge32_r(array, swap, nmemb, block, cmp_ptr);
+        },
+        comp);
+  } else {
+    sort_ok = fluxsort_parallel_impl(
+        reinterpret_cast<Var*>(data), len, num_threads,
+        [cmp_ptr](Var* chunk, Var* swap, size_t chunk_len) {
+          fluxsort_swap64_r(chunk, swap, chunk_len, chunk_len, cmp_ptr);
+        },
+        [cmp_ptr](Var* array, Var* swap, size_t nmemb, size_t block) {
+          partial_backward_merge64_r(array, swap, nmemb, block, cmp_ptr);
+        },
+        comp);
+  }
+
+  return sort_ok ? 0 : 1;
+}
+
+// fluxsort_parallel_by_impl for the records, with their own instantiations.
+// cmp is either the plain record comparison or a CCompareCtx one.
+template <typename T, typename SortSwapFn, typename MergeFn>
+uint32_t fluxsort_parallel_record_impl(
+    T* data,
+    size_t len,
+    struct cmp_r* cmp,
+    size_t num_threads,
+    SortSwapFn fluxsort_swap_r,
+    MergeFn partial_backward_merge_r) noexcept {
+  const auto comp = [cmp](const T& a, const T& b) {
+    return cmp->fn(&a, &b, cmp->arg) < 0;
+  };
+
+  const bool sort_ok = fluxsort_parallel_impl(
+      data, len, num_threads,
+      [&](T* chunk, T* swap, size_t chunk_len) {
+        fluxsort_swap_r(chunk, swap, chunk_len, chunk_len, cmp);
+      },
+      [&](T* array, T* swap, size_t nmemb, size_t block) {
+        partial_backward_merge_r(array, swap, nmemb, block, cmp);
+      },
+      comp);
+
+  return sort_ok ? 0 : 1;
+}
+
+template <typename T, typename SortSwapFn, typename MergeFn>
+uint32_t fluxsort_parallel_record_by_impl(
+    T* data,
+    size_t len,
+    CompResult (*cmp_fn)(const T&, const T&, uint8_t*),
+    uint8_t* ctx,
+    size_t num_threads,
+    SortSwapFn fluxsort_swap_r,
+    MergeFn partial_backward_merge_r) noexcept {
+  CCompareCtx<T> cmp_ctx{cmp_fn, ctx};
+  struct cmp_r cmp = {c_compare_fn_r<T>, static_cast<void*>(&cmp_ctx)};
+
+  return fluxsort_parallel_record_impl(data, len, &cmp, num_threads,
+                                       fluxsort_swap_r,
+                                       partial_backward_merge_r);
+}
+
 extern "C" {
 // --- i32 ---
 
 void fluxsort_stable_i32(int32_t* data, size_t len) {
+  SORT_USDT_PROBE(len);
   fluxsort_prim(static_cast<void*>(data), len, /*signed int*/ 4);
 }
 
@@ -34,12 +390,30 @@ uint32_t fluxsort_stable_i32_by(int32_t* data,
                                                      const int32_t&,
                                                      uint8_t*),
                                 uint8_t* ctx) {
+  SORT_USDT_PROBE(len);
   return sort_by_impl(data, len, cmp_fn, ctx);
 }
 
+void fluxsort_stable_i32_with_buf(int32_t* data,
+                                  size_t len,
+                                  uint8_t* buf,
+                                  size_t buf_bytes) {
+  SORT_USDT_PROBE(len);
+  // fluxsort partitions out-of-place and needs room for all len elements.
+  int32_t* swap = scratch_from_buf<int32_t>(buf, buf_bytes, len);
+  if (swap == nullptr || len < 2) {
+    fluxsort_stable_i32(data, len);
+    return;
+  }
+
+  fluxsort_swap_int32(static_cast<void*>(data), static_cast<void*>(swap), len,
+                      len, nullptr);
+}
+
 // --- u64 ---
 
 void fluxsort_stable_u64(uint64_t* data, size_t len) {
+  SORT_USDT_PROBE(len);
   fluxsort_prim(static_cast<void*>(data), len, /*unsigned long long*/ 9);
 }
 
@@ -49,12 +423,29 @@ uint32_t fluxsort_stable_u64_by(uint64_t* data,
                                                      const uint64_t&,
                                                      uint8_t*),
                                 uint8_t* ctx) {
+  SORT_USDT_PROBE(len);
   return sort_by_impl(data, len, cmp_fn, ctx);
 }
 
+void fluxsort_stable_u64_with_buf(uint64_t* data,
+                                  size_t len,
+                                  uint8_t* buf,
+                                  size_t buf_bytes) {
+  SORT_USDT_PROBE(len);
+  uint64_t* swap = scratch_from_buf<uint64_t>(buf, buf_bytes, len);
+  if (swap == nullptr || len < 2) {
+    fluxsort_stable_u64(data, len);
+    return;
+  }
+
+  fluxsort_swap_uint64(static_cast<void*>(data), static_cast<void*>(swap), len,
+                       len, nullptr);
+}
+
 // --- ffi_string ---
 
 void fluxsort_stable_ffi_string(FFIString* data, size_t len) {
+  SORT_USDT_PROBE(len);
   // Value would have to be sorted by indirection.
   printf("Not supported\n");
 }
@@ -72,8 +463,9 @@ uint32_t fluxsort_stable_ffi_string_by(FFIString* data,
 // --- f128 ---
 
 void fluxsort_stable_f128(F128* data, size_t len) {
-  // Swaps values incorrectly, or my implementation is wrong.
-  printf("Not supported\n");
+  SORT_USDT_PROBE(len);
+  struct cmp_r cmp = {record_compare_fn_r<F128Cpp>, nullptr};
+  fluxsort_record(data, len, &cmp, fluxsort_swap_f128_r);
 }
 
 uint32_t fluxsort_stable_f128_by(F128* data,
@@ -82,15 +474,16 @@ uint32_t fluxsort_stable_f128_by(F128* data,
                                                       const F128&,
                                                       uint8_t*),
                                  uint8_t* ctx) {
-  printf("Not supported\n");
-  return 1;
+  SORT_USDT_PROBE(len);
+  return sort_record_by_impl(data, len, cmp_fn, ctx, fluxsort_swap_f128_r);
 }
 
 // --- 1k ---
 
 void fluxsort_stable_1k(FFIOneKibiByte* data, size_t len) {
-  // Value would have to be sorted by indirection.
-  printf("Not supported\n");
+  SORT_USDT_PROBE(len);
+  struct cmp_r cmp = {record_compare_fn_r<FFIOneKiloByteCpp>, nullptr};
+  fluxsort_record(data, len, &cmp, fluxsort_swap_1k_r);
 }
 
 uint32_t fluxsort_stable_1k_by(FFIOneKibiByte* data,
@@ -99,7 +492,118 @@ uint32_t fluxsort_stable_1k_by(FFIOneKibiByte* data,
                                                     const FFIOneKibiByte&,
                                                     uint8_t*),
                                uint8_t* ctx) {
+  SORT_USDT_PROBE(len);
+  return sort_record_by_impl(data, len, cmp_fn, ctx, fluxsort_swap_1k_r);
+}
+
+// fluxsort_r sorts the pointers with its 64 bit instantiation.
+INDIRECT_SORT_IMPL(fluxsort_stable, [](auto begin, auto end, auto comp) {
+  using Ptr = std::remove_pointer_t<decltype(begin)>;
+  static_assert(sizeof(Ptr) == sizeof(long long));
+
+  fluxsort_r(static_cast<void*>(begin), end - begin, sizeof(Ptr),
+             indirect_compare_fn_r<Ptr, decltype(comp)>,
+             static_cast<void*>(&comp));
+})
+
+// --- parallel ---
+
+void fluxsort_parallel_stable_i32(int32_t* data,
+                                  size_t len,
+                                  size_t num_threads) {
+  SORT_USDT_PROBE(len);
+  fluxsort_parallel_prim(data, len, num_threads);
+}
+
+uint32_t fluxsort_parallel_stable_i32_by(int32_t* data,
+                                         size_t len,
+                                         CompResult (*cmp_fn)(const int32_t&,
+                                                              const int32_t&,
+                                                              uint8_t*),
+                                         uint8_t* ctx,
+                                         size_t num_threads) {
+  SORT_USDT_PROBE(len);
+  return fluxsort_parallel_by_impl(data, len, cmp_fn, ctx, num_threads);
+}
+
+void fluxsort_parallel_stable_u64(uint64_t* data,
+                                  size_t len,
+                                  size_t num_threads) {
+  SORT_USDT_PROBE(len);
+  fluxsort_parallel_prim(data, len, num_threads);
+}
+
+uint32_t fluxsort_parallel_stable_u64_by(uint64_t* data,
+                                         size_t len,
+                                         CompResult (*cmp_fn)(const uint64_t&,
+                                                              const uint64_t&,
+                                                              uint8_t*),
+                                         uint8_t* ctx,
+                                         size_t num_threads) {
+  SORT_USDT_PROBE(len);
+  return fluxsort_parallel_by_impl(data, len, cmp_fn, ctx, num_threads);
+}
+
+void fluxsort_parallel_stable_ffi_string(FFIString* data,
+                                         size_t len,
+                                         size_t num_threads) {
+  printf("Not supported\n");
+}
+
+uint32_t fluxsort_parallel_stable_ffi_string_by(
+    FFIString* data,
+    size_t len,
+    CompResult (*cmp_fn)(const FFIString&, const FFIString&, uint8_t*),
+    uint8_t* ctx,
+    size_t num_threads) {
   printf("Not supported\n");
   return 1;
 }
+
+void fluxsort_parallel_stable_f128(F128* data,
+                                   size_t len,
+                                   size_t num_threads) {
+  SORT_USDT_PROBE(len);
+  struct cmp_r cmp = {record_compare_fn_r<F128Cpp>, nullptr};
+  fluxsort_parallel_record_impl(data, len, &cmp, num_threads,
+                                fluxsort_swap_f128_r,
+                                partial_backward_merge_f128_r);
+}
+
+uint32_t fluxsort_parallel_stable_f128_by(F128* data,
+                                          size_t len,
+                                          CompResult (*cmp_fn)(const F128&,
+                                                               const F128&,
+                                                               uint8_t*),
+                                          uint8_t* ctx,
+                                          size_t num_threads) {
+  SORT_USDT_PROBE(len);
+  return fluxsort_parallel_record_by_impl(data, len, cmp_fn, ctx, num_threads,
+                                          fluxsort_swap_f128_r,
+                                          partial_backward_merge_f128_r);
+}
+
+void fluxsort_parallel_stable_1k(FFIOneKibiByte* data,
+                                 size_t len,
+                                 size_t num_threads) {
+  SORT_USDT_PROBE(len);
+  struct cmp_r cmp = {record_compare_fn_r<FFIOneKiloByteCpp>, nullptr};
+  fluxsort_parallel_record_impl(data, len, &cmp, num_threads,
+                                fluxsort_swap_1k_r,
+                                partial_backward_merge_1k_r);
+}
+
+uint32_t fluxsort_parallel_stable_1k_by(
+    FFIOneKibiByte* data,
+    size_t len,
+    CompResult (*cmp_fn)(const FFIOneKibiByte&,
+                         const FFIOneKibiByte&,
+                         uint8_t*),
+    uint8_t* ctx,
+    size_t num_threads) {
+  SORT_USDT_PROBE(len);
+  return fluxsort_parallel_record_by_impl(data, len, cmp_fn, ctx, num_threads,
+                                          fluxsort_swap_1k_r,
+                                          partial_backward_merge_1k_r);
+}
 }  // extern "C"
@@ -10,8 +10,15 @@ uint32_t sort_by_impl(T* data,
                       CompResult (*cmp_fn)(const T&, const T&, uint8_t*),
                       uint8_t* ctx) noexcept {
   try {
+#if defined(__GLIBC__)
+    // The BSD and macOS qsort_r take their arguments in a different order.
+    CCompareCtx<T> cmp_ctx{cmp_fn, ctx};
+    qsort_r(static_cast<void*>(data), len, sizeof(T), c_compare_fn_r<T>,
+            static_cast<void*>(&cmp_ctx));
+#else
     qsort(static_cast<void*>(data), len, sizeof(T),
           make_compare_fn_c(cmp_fn, ctx));
+#endif
   } catch (...) {
     return 1;
   }
@@ -23,6 +30,7 @@ extern "C" {
 // --- i32 ---
 
 void qsort_unstable_i32(int32_t* data, size_t len) {
+  SORT_USDT_PROBE(len);
   qsort(static_cast<void*>(data), len, sizeof(int32_t), int_cmp_func<int32_t>);
 }
 
@@ -32,12 +40,14 @@ uint32_t qsort_unstable_i32_by(int32_t* data,
                                                     const int32_t&,
                                                     uint8_t*),
                                uint8_t* ctx) {
+  SORT_USDT_PROBE(len);
   return sort_by_impl(data, len, cmp_fn, ctx);
 }
 
 // --- u64 ---
 
 void qsort_unstable_u64(uint64_t* data, size_t len) {
+  SORT_USDT_PROBE(len);
   qsort(static_cast<void*>(data), len, sizeof(uint64_t),
         int_cmp_func<uint64_t>);
 }
@@ -48,12 +58,14 @@ uint32_t qsort_unstable_u64_by(uint64_t* data,
                                                     const uint64_t&,
                                                     uint8_t*),
                                uint8_t* ctx) {
+  SORT_USDT_PROBE(len);
   return sort_by_impl(data, len, cmp_fn, ctx);
 }
 
 // --- ffi_string ---
 
 void qsort_unstable_ffi_string(FFIString* data, size_t len) {
+  SORT_USDT_PROBE(len);
   // Value would have to be sorted by indirection.
   printf("Not supported\n");
 }
@@ -71,8 +83,9 @@ uint32_t qsort_unstable_ffi_string_by(FFIString* data,
 // --- f128 ---
 
 void qsort_unstable_f128(F128* data, size_t len) {
-  // Swaps values incorrectly, or my implementation is wrong.
-  printf("Not supported\n");
+  SORT_USDT_PROBE(len);
+  qsort(static_cast<void*>(data), len, sizeof(F128),
+        cpp_type_cmp_func<F128Cpp>);
 }
 
 uint32_t qsort_unstable_f128_by(F128* data,
@@ -81,15 +94,16 @@ uint32_t qsort_unstable_f128_by(F128* data,
                                                      const F128&,
                                                      uint8_t*),
                                 uint8_t* ctx) {
-  printf("Not supported\n");
-  return 1;
+  SORT_USDT_PROBE(len);
+  return sort_by_impl(data, len, cmp_fn, ctx);
 }
 
 // --- 1k ---
 
 void qsort_unstable_1k(FFIOneKibiByte* data, size_t len) {
-  // Value would have to be sorted by indirection.
-  printf("Not supported\n");
+  SORT_USDT_PROBE(len);
+  qsort(static_cast<void*>(data), len, sizeof(FFIOneKibiByte),
+        cpp_type_cmp_func<FFIOneKiloByteCpp>);
 }
 
 uint32_t qsort_unstable_1k_by(FFIOneKibiByte* data,
@@ -98,7 +112,7 @@ uint32_t qsort_unstable_1k_by(FFIOneKibiByte* data,
                                                    const FFIOneKibiByte&,
                                                    uint8_t*),
                               uint8_t* ctx) {
-  printf("Not supported\n");
-  return 1;
+  SORT_USDT_PROBE(len);
+  return sort_by_impl(data, len, cmp_fn, ctx);
 }
 }  // extern "C"
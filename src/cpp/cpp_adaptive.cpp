@@ -0,0 +1,296 @@
+// Front-end that samples the input and routes it to the backend that usually
+// wins for its shape:
+//
+// - Input made of long ascending or descending runs goes to powersort, which
+//   merges the existing runs. A single run goes to pdqsort, which finds out in
+//   one pass.
+// - Integers with few distinct values go to pdqsort, which puts equal elements
+//   aside in a single partition.
+// - Other integers go to vqsort or the radix sort, if they are enabled.
+// - Everything else goes to pdqsort.
+//
+// The backends are the entry points of the other wrappers, built and linked by
+// build.rs. Every enabled optional backend defines ADAPTIVE_<FEATURE>, same as
+// the bench driver. Sampling looks at a fixed number of elements, independent
+// of len.
+
+#include <algorithm>
+#include <type_traits>
+
+#include <stdint.h>
+
+#include "shared.h"
+
+#define DECLARE_BACKEND(prefix, type_name, T)                   \
+  void prefix##_##type_name(T* data, size_t len);               \
+  uint32_t prefix##_##type_name##_by(                           \
+      T* data, size_t len,                                      \
+      CompResult (*cmp_fn)(const T&, const T&, uint8_t*), uint8_t* ctx);
+
+#define DECLARE_BACKEND_ALL_TYPES(prefix)        \
+  DECLARE_BACKEND(prefix, i32, int32_t)          \
+  DECLARE_BACKEND(prefix, u64, uint64_t)         \
+  DECLARE_BACKEND(prefix, ffi_string, FFIString) \
+  DECLARE_BACKEND(prefix, f128, F128)            \
+  DECLARE_BACKEND(prefix, 1k, FFIOneKibiByte)
+
+extern "C" {
+DECLARE_BACKEND_ALL_TYPES(pdqsort_unstable)
+DECLARE_BACKEND_ALL_TYPES(powersort_stable)
+#if defined(ADAPTIVE_CPP_RADIX)
+void radix_i32(int32_t* data, size_t len);
+void radix_u64(uint64_t* data, size_t len);
+#endif
+#if defined(ADAPTIVE_CPP_VQSORT)
+void vqsort_i32(int32_t* data, size_t len);
+void vqsort_u64(uint64_t* data, size_t len);
+#endif
+}
+
+namespace {
+
+enum class Backend {
+  kPdqsort,
+  kPowersort,
+  kRadix,
+  kVqsort,
+};
+
+// Entry points of one type, the integer only backends are null if they are not
+// enabled or don't support the type.
+template <typename T>
+struct Backends {
+  void (*pdqsort)(T*, size_t);
+  void (*powersort)(T*, size_t);
+  void (*radix)(T*, size_t);
+  void (*vqsort)(T*, size_t);
+};
+
+#if defined(ADAPTIVE_CPP_RADIX)
+#define RADIX_OR_NULL(fn) fn
+#else
+#define RADIX_OR_NULL(fn) nullptr
+#endif
+
+#if defined(ADAPTIVE_CPP_VQSORT)
+#define VQSORT_OR_NULL(fn) fn
+#else
+#define VQSORT_OR_NULL(fn) nullptr
+#endif
+
+const char* backend_name(Backend backend) {
+  switch (backend) {
+    case Backend::kPdqsort:
+      return "pdqsort";
+    case Backend::kPowersort:
+      return "powersort";
+    case Backend::kRadix:
+      return "radix";
+    case Backend::kVqsort:
+      return "vqsort";
+  }
+
+  return "unknown";
+}
+
+// Below this len sampling costs more than a wrong pick, pdqsort sorts it with
+// insertion sort anyway.
+constexpr size_t MIN_SAMPLE_LEN = 256;
+
+// Neighbouring pairs are looked at in this many windows spread across the
+// input. In random data about every second pair goes the other way than its
+// window.
+constexpr size_t RUN_WINDOWS = 16;
+constexpr size_t RUN_WINDOW_LEN = 16;
+
+// At most one in this many pairs against the direction of their window, for
+// the input to count as consisting of runs.
+constexpr size_t RUNS_RATIO = 8;
+
+enum class Runs {
+  // Every sampled pair in the same direction, most likely a single run.
+  kMonotone,
+  // Long ascending or descending runs, such as saw or pipe organ shapes.
+  kLong,
+  kNone,
+};
+
+// Distinct values are counted in this many elements, fewer than
+// LOW_CARDINALITY_DISTINCT counts as low cardinality.
+constexpr size_t DISTINCT_SAMPLE_LEN = 64;
+constexpr size_t LOW_CARDINALITY_DISTINCT = 16;
+
+template <typename T, typename Compare>
+Runs sample_runs(const T* data, size_t len, Compare comp) {
+  size_t descents = 0;
+  size_t ascents = 0;
+  size_t against_window = 0;
+
+  for (size_t window_i = 0; window_i < RUN_WINDOWS; ++window_i) {
+    const size_t begin =
+        ((len - RUN_WINDOW_LEN - 1) * window_i) / (RUN_WINDOWS - 1);
+
+    size_t window_descents = 0;
+    size_t window_ascents = 0;
+    for (size_t i = begin; i < begin + RUN_WINDOW_LEN; ++i) {
+      window_descents += comp(data[i + 1], data[i]);
+      window_ascents += comp(data[i], data[i + 1]);
+    }
+
+    descents += window_descents;
+    ascents += window_ascents;
+    against_window += std::min(window_descents, window_ascents);
+  }
+
+  // pdqsort recognizes an already sorted or reversed input in a single pass,
+  // that's faster than finding the runs with powersort.
+  if (descents == 0 || ascents == 0) {
+    return Runs::kMonotone;
+  }
+
+  if (against_window <= (RUN_WINDOWS * RUN_WINDOW_LEN) / RUNS_RATIO) {
+    return Runs::kLong;
+  }
+
+  return Runs::kNone;
+}
+
+template <typename T>
+bool is_low_cardinality(const T* data, size_t len) {
+  T sample[DISTINCT_SAMPLE_LEN];
+  for (size_t i = 0; i < DISTINCT_SAMPLE_LEN; ++i) {
+    // The jitter keeps the sample from lining up with periodic patterns.
+    sample[i] = data[(i * (len / DISTINCT_SAMPLE_LEN)) + (i % 5)];
+  }
+
+  std::sort(sample, sample + DISTINCT_SAMPLE_LEN);
+  const size_t distinct =
+      std::unique(sample, sample + DISTINCT_SAMPLE_LEN) - sample;
+
+  return distinct < LOW_CARDINALITY_DISTINCT;
+}
+
+// Maps the FFI types to the types that implement operator<.
+template <typename T>
+const auto* as_cpp(const T* data) {
+  if constexpr (std::is_same_v<T, FFIString>) {
+    return reinterpret_cast<const FFIStringCpp*>(data);
+  } else if constexpr (std::is_same_v<T, F128>) {
+    return reinterpret_cast<const F128Cpp*>(data);
+  } else if constexpr (std::is_same_v<T, FFIOneKibiByte>) {
+    return reinterpret_cast<const FFIOneKiloByteCpp*>(data);
+  } else {
+    return data;
+  }
+}
+
+template <typename T>
+Backend pick_backend(const T* data, size_t len, const Backends<T>& backends) {
+  if (len < MIN_SAMPLE_LEN) {
+    return Backend::kPdqsort;
+  }
+
+  switch (sample_runs(as_cpp(data), len, std::less<>{})) {
+    case Runs::kMonotone:
+      return Backend::kPdqsort;
+    case Runs::kLong:
+      return Backend::kPowersort;
+    case Runs::kNone:
+      break;
+  }
+
+  if constexpr (std::is_integral_v<T>) {
+    if (is_low_cardinality(data, len)) {
+      return Backend::kPdqsort;
+    }
+  }
+
+  if (backends.vqsort != nullptr) {
+    return Backend::kVqsort;
+  }
+  if (backends.radix != nullptr) {
+    return Backend::kRadix;
+  }
+
+  return Backend::kPdqsort;
+}
+
+template <typename T>
+void adaptive_sort(T* data, size_t len, const Backends<T>& backends) {
+  switch (pick_backend(data, len, backends)) {
+    case Backend::kPowersort:
+      backends.powersort(data, len);
+      return;
+    case Backend::kRadix:
+      backends.radix(data, len);
+      return;
+    case Backend::kVqsort:
+      backends.vqsort(data, len);
+      return;
+    case Backend::kPdqsort:
+      backends.pdqsort(data, len);
+      return;
+  }
+}
+
+// With a comparison function only the runs can be sampled, the other
+// properties need the keys.
+template <typename T, typename F, typename ByFn>
+uint32_t adaptive_sort_by(T* data,
+                          size_t len,
+                          F cmp_fn,
+                          uint8_t* ctx,
+                          ByFn pdqsort_by,
+                          ByFn powersort_by) {
+  bool long_runs = false;
+  try {
+    long_runs = len >= MIN_SAMPLE_LEN &&
+                sample_runs(data, len, make_compare_fn<T>(cmp_fn, ctx)) ==
+                    Runs::kLong;
+  } catch (...) {
+    return 1;
+  }
+
+  return long_runs ? powersort_by(data, len, cmp_fn, ctx)
+                   : pdqsort_by(data, len, cmp_fn, ctx);
+}
+
+}  // namespace
+
+#define ADAPTIVE_IMPL(type_name, T, RADIX_FN, VQSORT_FN)                    \
+  static constexpr Backends<T> backends_##type_name{                        \
+      pdqsort_unstable_##type_name, powersort_stable_##type_name, RADIX_FN, \
+      VQSORT_FN};                                                           \
+                                                                            \
+  void adaptive_unstable_##type_name(T* data, size_t len) {                 \
+    SORT_USDT_PROBE(len);                                                   \
+    adaptive_sort(data, len, backends_##type_name);                         \
+  }                                                                         \
+                                                                            \
+  uint32_t adaptive_unstable_##type_name##_by(                              \
+      T* data, size_t len,                                                  \
+      CompResult (*cmp_fn)(const T&, const T&, uint8_t*), uint8_t* ctx) {   \
+    SORT_USDT_PROBE(len);                                                   \
+    return adaptive_sort_by(data, len, cmp_fn, ctx,                         \
+                            pdqsort_unstable_##type_name##_by,              \
+                            powersort_stable_##type_name##_by);             \
+  }                                                                         \
+                                                                            \
+  const char* adaptive_unstable_##type_name##_backend(const T* data,        \
+                                                      size_t len) {         \
+    return backend_name(pick_backend(data, len, backends_##type_name));     \
+  }
+
+extern "C" {
+ADAPTIVE_IMPL(i32,
+              int32_t,
+              RADIX_OR_NULL(radix_i32),
+              VQSORT_OR_NULL(vqsort_i32))
+ADAPTIVE_IMPL(u64,
+              uint64_t,
+              RADIX_OR_NULL(radix_u64),
+              VQSORT_OR_NULL(vqsort_u64))
+ADAPTIVE_IMPL(ffi_string, FFIString, nullptr, nullptr)
+ADAPTIVE_IMPL(f128, F128, nullptr, nullptr)
+ADAPTIVE_IMPL(1k, FFIOneKibiByte, nullptr, nullptr)
+}  // extern "C"
@@ -1,28 +1,93 @@
+#ifdef SMALL_SORT_NETWORK
+#include "small_sort_network.h"
+#endif
+// Has to come before quicksort.h, the SORT_TELEMETRY hooks call into it.
+#include "sort_telemetry.h"
 #include "thirdparty/blockquicksort/blocked_double_pivot_check_mosqrt.h"
 
 #include <stdint.h>
 #include <stdexcept>
 
-// blockquicksort is implemented in a way that requires that T implements a by
-// ref copy constructor. That's incompatible with move only types such as
-// FFIStringCpp.
-#define SORT_INCOMPATIBLE_WITH_SEMANTIC_CPP_TYPE
-
 #include "shared.h"
 
-template <typename T, typename F>
-uint32_t sort_by_impl(T* data, size_t len, F cmp_fn, uint8_t* ctx) noexcept {
-  // BlockQuicksort does not provide a way to specify a custom comparator
-  // function, so we have to wrap it inside a type with custom comparison
-  // function.
-  CompWrapper<T, F>::cmp_fn_local = cmp_fn;
-  CompWrapper<T, F>::ctx_local = ctx;
+#ifdef RUN_PREPASS
+#include "run_prepass.h"
+#endif
+
+// Combinations of main loop, pivot selection and block partition from the
+// vendored quicksort.h, median.h and partition.h. blockquicksort_unstable uses
+// MosqrtCheck, the others get their own entry points
+// blockquicksort_<variant>_unstable_<type>.
+namespace variant {
+// Median-of-3 pivot and the plain block partition.
+struct Simple {
+  template <typename It, typename Compare>
+  static void sort(It begin, It end, Compare less) {
+    quicksort::qsort<partition::Hoare_block_partition_simple>(begin, end,
+                                                              less);
+  }
+};
+
+// Median-of-3 pivot and the unrolled block partition.
+struct Mo3 {
+  template <typename It, typename Compare>
+  static void sort(It begin, It end, Compare less) {
+    quicksort::qsort<partition::Hoare_block_partition>(begin, end, less);
+  }
+};
+
+// Median-of-sqrt(n) pivot above 20000 elements, medians of medians of 3 and 5
+// below, and the unrolled block partition.
+struct Mosqrt {
+  template <typename It, typename Compare>
+  static void sort(It begin, It end, Compare less) {
+    quicksort::qsort<partition::Hoare_block_partition_mosqrt>(begin, end,
+                                                              less);
+  }
+};
+
+// Two pivots from the tertiles of a sample of 3, split into three partitions
+// with a block partition.
+struct DualPivot {
+  template <typename It, typename Compare>
+  static void sort(It begin, It end, Compare less) {
+    quicksort::qsort_2_pivot<
+        partition::Multi_Pivot_Hoare_Block_partition_simple>(begin, end, less);
+  }
+};
+
+// Same as Mo3, with the duplicate check. Elements equal to the pivot are
+// gathered next to it and skipped by the recursion.
+struct Mo3Check {
+  template <typename It, typename Compare>
+  static void sort(It begin, It end, Compare less) {
+    quicksort::qsort_double_pivot_check<partition::Hoare_block_partition>(
+        begin, end, less);
+  }
+};
+
+// Same as Mosqrt, with the duplicate check.
+struct MosqrtCheck {
+  template <typename It, typename Compare>
+  static void sort(It begin, It end, Compare less) {
+    blocked_double_pivot_check_mosqrt::sort(begin, end, less);
+  }
+};
+}  // namespace variant
+
+template <typename Variant, typename T, typename Compare>
+void sort_impl(T* data, size_t len, Compare comp) {
+#ifdef RUN_PREPASS
+  run_prepass::sort<Variant>(data, len, comp);
+#else
+  Variant::sort(data, data + len, comp);
+#endif
+}
 
+template <typename Variant, typename T, typename F>
+uint32_t sort_by_impl(T* data, size_t len, F cmp_fn, uint8_t* ctx) noexcept {
   try {
-    blocked_double_pivot_check_mosqrt::sort(
-        reinterpret_cast<CompWrapper<T, F>*>(data),
-        reinterpret_cast<CompWrapper<T, F>*>(data) + len,
-        std::less<CompWrapper<T, F>>{});
+    sort_impl<Variant>(data, len, make_compare_fn<T>(cmp_fn, ctx));
   } catch (...) {
     return 1;
   }
@@ -30,12 +95,48 @@ uint32_t sort_by_impl(T* data, size_t len, F cmp_fn, uint8_t* ctx) noexcept {
   return 0;
 }
 
+#define VARIANT_IMPL(VARIANT_NAME, VARIANT, TYPE_NAME, TYPE, CPP_TYPE)       \
+  void blockquicksort_##VARIANT_NAME##_unstable_##TYPE_NAME(TYPE* data,      \
+                                                            size_t len) {    \
+    SORT_USDT_PROBE(len);                                                    \
+    sort_impl<variant::VARIANT>(reinterpret_cast<CPP_TYPE*>(data), len,      \
+                                std::less<CPP_TYPE>{});                      \
+  }                                                                          \
+                                                                             \
+  uint32_t blockquicksort_##VARIANT_NAME##_unstable_##TYPE_NAME##_by(        \
+      TYPE* data, size_t len,                                                \
+      CompResult (*cmp_fn)(const TYPE&, const TYPE&, uint8_t*),              \
+      uint8_t* ctx) {                                                        \
+    SORT_USDT_PROBE(len);                                                    \
+    return sort_by_impl<variant::VARIANT>(reinterpret_cast<CPP_TYPE*>(data), \
+                                          len, cmp_fn, ctx);                 \
+  }
+
+#define VARIANT_IMPL_ALL_TYPES(VARIANT_NAME, VARIANT)                        \
+  VARIANT_IMPL(VARIANT_NAME, VARIANT, i32, int32_t, int32_t)                 \
+  VARIANT_IMPL(VARIANT_NAME, VARIANT, u64, uint64_t, uint64_t)               \
+  VARIANT_IMPL(VARIANT_NAME, VARIANT, ffi_string, FFIString, FFIStringCpp)   \
+  VARIANT_IMPL(VARIANT_NAME, VARIANT, f128, F128, F128Cpp)                   \
+  VARIANT_IMPL(VARIANT_NAME, VARIANT, 1k, FFIOneKibiByte, FFIOneKiloByteCpp)
+
+// The unrolled block partition used by Mo3, Mosqrt and the default sort. It's
+// a Hoare partition, elements equal to the pivot can end up on either side.
+template <typename T>
+size_t partition_impl(T* data, size_t len, const T& pivot) {
+  return partition_with_pivot_at_begin(
+      data, len, pivot, [](T* data, size_t len) -> size_t {
+        return partition::hoare_block_partition_unroll_loop(
+                   data, data + len, data, std::less<T>{}) -
+               data;
+      });
+}
+
 extern "C" {
 // --- i32 ---
 
 void blockquicksort_unstable_i32(int32_t* data, size_t len) {
-  blocked_double_pivot_check_mosqrt::sort(data, data + len,
-                                          std::less<int32_t>{});
+  SORT_USDT_PROBE(len);
+  sort_impl<variant::MosqrtCheck>(data, len, std::less<int32_t>{});
 }
 
 uint32_t blockquicksort_unstable_i32_by(int32_t* data,
@@ -44,14 +145,15 @@ uint32_t blockquicksort_unstable_i32_by(int32_t* data,
                                                              const int32_t&,
                                                              uint8_t*),
                                         uint8_t* ctx) {
-  return sort_by_impl(data, len, cmp_fn, ctx);
+  SORT_USDT_PROBE(len);
+  return sort_by_impl<variant::MosqrtCheck>(data, len, cmp_fn, ctx);
 }
 
 // --- u64 ---
 
 void blockquicksort_unstable_u64(uint64_t* data, size_t len) {
-  blocked_double_pivot_check_mosqrt::sort(data, data + len,
-                                          std::less<uint64_t>{});
+  SORT_USDT_PROBE(len);
+  sort_impl<variant::MosqrtCheck>(data, len, std::less<uint64_t>{});
 }
 
 uint32_t blockquicksort_unstable_u64_by(uint64_t* data,
@@ -60,15 +162,16 @@ uint32_t blockquicksort_unstable_u64_by(uint64_t* data,
                                                              const uint64_t&,
                                                              uint8_t*),
                                         uint8_t* ctx) {
-  return sort_by_impl(data, len, cmp_fn, ctx);
+  SORT_USDT_PROBE(len);
+  return sort_by_impl<variant::MosqrtCheck>(data, len, cmp_fn, ctx);
 }
 
 // --- ffi_string ---
 
 void blockquicksort_unstable_ffi_string(FFIString* data, size_t len) {
-  blocked_double_pivot_check_mosqrt::sort(
-      reinterpret_cast<FFIStringCpp*>(data),
-      reinterpret_cast<FFIStringCpp*>(data) + len, std::less<FFIStringCpp>{});
+  SORT_USDT_PROBE(len);
+  sort_impl<variant::MosqrtCheck>(reinterpret_cast<FFIStringCpp*>(data), len,
+                                  std::less<FFIStringCpp>{});
 }
 
 uint32_t blockquicksort_unstable_ffi_string_by(
@@ -76,15 +179,17 @@ uint32_t blockquicksort_unstable_ffi_string_by(
     size_t len,
     CompResult (*cmp_fn)(const FFIString&, const FFIString&, uint8_t*),
     uint8_t* ctx) {
-  return sort_by_impl(reinterpret_cast<FFIStringCpp*>(data), len, cmp_fn, ctx);
+  SORT_USDT_PROBE(len);
+  return sort_by_impl<variant::MosqrtCheck>(
+      reinterpret_cast<FFIStringCpp*>(data), len, cmp_fn, ctx);
 }
 
 // --- f128 ---
 
 void blockquicksort_unstable_f128(F128* data, size_t len) {
-  blocked_double_pivot_check_mosqrt::sort(
-      reinterpret_cast<F128Cpp*>(data), reinterpret_cast<F128Cpp*>(data) + len,
-      std::less<F128Cpp>{});
+  SORT_USDT_PROBE(len);
+  sort_impl<variant::MosqrtCheck>(reinterpret_cast<F128Cpp*>(data), len,
+                                  std::less<F128Cpp>{});
 }
 
 uint32_t blockquicksort_unstable_f128_by(F128* data,
@@ -93,16 +198,17 @@ uint32_t blockquicksort_unstable_f128_by(F128* data,
                                                               const F128&,
                                                               uint8_t*),
                                          uint8_t* ctx) {
-  return sort_by_impl(reinterpret_cast<F128Cpp*>(data), len, cmp_fn, ctx);
+  SORT_USDT_PROBE(len);
+  return sort_by_impl<variant::MosqrtCheck>(reinterpret_cast<F128Cpp*>(data),
+                                            len, cmp_fn, ctx);
 }
 
 // --- 1k ---
 
 void blockquicksort_unstable_1k(FFIOneKibiByte* data, size_t len) {
-  blocked_double_pivot_check_mosqrt::sort(
-      reinterpret_cast<FFIOneKiloByteCpp*>(data),
-      reinterpret_cast<FFIOneKiloByteCpp*>(data) + len,
-      std::less<FFIOneKiloByteCpp>{});
+  SORT_USDT_PROBE(len);
+  sort_impl<variant::MosqrtCheck>(reinterpret_cast<FFIOneKiloByteCpp*>(data),
+                                  len, std::less<FFIOneKiloByteCpp>{});
 }
 
 uint32_t blockquicksort_unstable_1k_by(
@@ -112,7 +218,36 @@ uint32_t blockquicksort_unstable_1k_by(
                          const FFIOneKibiByte&,
                          uint8_t*),
     uint8_t* ctx) {
-  return sort_by_impl(reinterpret_cast<FFIOneKiloByteCpp*>(data), len, cmp_fn,
-                      ctx);
+  SORT_USDT_PROBE(len);
+  return sort_by_impl<variant::MosqrtCheck>(
+      reinterpret_cast<FFIOneKiloByteCpp*>(data), len, cmp_fn, ctx);
+}
+
+// --- partition ---
+
+size_t blockquicksort_partition_i32(int32_t* data,
+                                    size_t len,
+                                    const int32_t* pivot) {
+  SORT_USDT_PROBE(len);
+  return partition_impl(data, len, *pivot);
+}
+
+size_t blockquicksort_partition_u64(uint64_t* data,
+                                    size_t len,
+                                    const uint64_t* pivot) {
+  SORT_USDT_PROBE(len);
+  return partition_impl(data, len, *pivot);
 }
+
+// --- variants ---
+
+VARIANT_IMPL_ALL_TYPES(simple, Simple)
+VARIANT_IMPL_ALL_TYPES(mo3, Mo3)
+VARIANT_IMPL_ALL_TYPES(mosqrt, Mosqrt)
+VARIANT_IMPL_ALL_TYPES(dual_pivot, DualPivot)
+VARIANT_IMPL_ALL_TYPES(mo3_check, Mo3Check)
 }  // extern "C"
+
+#if defined(SORT_TELEMETRY)
+SORT_TELEMETRY_EXPORT(blockquicksort_unstable)
+#endif
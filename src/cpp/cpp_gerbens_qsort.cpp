@@ -1,5 +1,9 @@
+#ifdef SMALL_SORT_NETWORK
+#include "small_sort_network.h"
+#endif
 #include "thirdparty/gerbens_qsort/hybrid_qsort.h"
 
+#include <memory>
 #include <stdexcept>
 
 #include <stdint.h>
@@ -9,12 +13,125 @@
 // FFIStringCpp.
 #define SORT_INCOMPATIBLE_WITH_SEMANTIC_CPP_TYPE
 
+#include "cpu_features.h"
 #include "shared.h"
 
-template <typename T, typename F>
+#ifdef RUN_PREPASS
+#include "run_prepass.h"
+#endif
+
+namespace {
+// Keeps the scratch buffer within a quarter of L1, so that it stays cached
+// next to the block that is being partitioned.
+template <typename T>
+size_t auto_scratch_size() {
+  static const size_t result = [] {
+    const size_t l1d_bytes = cpu_features::l1d_cache_bytes();
+    if (l1d_bytes == 0) {
+      return static_cast<size_t>(exp_gerbens::SCRATCH_SIZE_DEFAULT);
+    }
+    size_t size = 32;
+    while (size < 4096 && (size * 2) * sizeof(T) <= l1d_bytes / 4) {
+      size *= 2;
+    }
+    return size;
+  }();
+  return result;
+}
+
+// QuickSort puts the scratch buffer on the stack, which is too much for the
+// larger sizes of large types. kFat picks QuickSortFat, with the equal element
+// handling of pdqsort.
+template <ptrdiff_t kScratchSize, bool kFat, typename T, typename Compare>
+void quick_sort_with(T* data, size_t len, Compare comp) {
+  if constexpr (kScratchSize * sizeof(T) <= 64 * 1024) {
+    if constexpr (kFat) {
+      exp_gerbens::QuickSortFat<kScratchSize>(data, data + len, comp);
+    } else {
+      exp_gerbens::QuickSort<kScratchSize>(data, data + len, comp);
+    }
+  } else {
+    std::unique_ptr<T[]> scratch{new T[kScratchSize]};
+    if constexpr (kFat) {
+      const T* no_ancestor = nullptr;
+      exp_gerbens::QuickSortFatImpl<kScratchSize>(data, data + len,
+                                                  scratch.get(), comp,
+                                                  no_ancestor);
+    } else {
+      exp_gerbens::QuickSortImpl<kScratchSize>(data, data + len,
+                                               scratch.get(), comp);
+    }
+  }
+}
+
+template <bool kFat, ptrdiff_t kScratchSize>
+struct QuickSort {
+  template <typename T, typename Compare>
+  static void sort(T* data, T* end, Compare comp) {
+    quick_sort_with<kScratchSize, kFat>(data, end - data, comp);
+  }
+};
+
+template <bool kFat = false,
+          ptrdiff_t kScratchSize = exp_gerbens::SCRATCH_SIZE_DEFAULT,
+          typename T,
+          typename Compare = std::less<>>
+void quick_sort(T* data, size_t len, Compare comp = {}) {
+#ifdef RUN_PREPASS
+  run_prepass::sort<QuickSort<kFat, kScratchSize>>(data, len, comp);
+#else
+  QuickSort<kFat, kScratchSize>::sort(data, data + len, comp);
+#endif
+}
+
+// Picks the instantiation of scratch_size, 0 picks a size based on the element
+// size and L1 cache. Returns 1 if scratch_size is not instantiated or the heap
+// scratch buffer of the larger sizes can't be allocated.
+template <typename T>
+uint32_t sort_scratch_impl(T* data, size_t len, size_t scratch_size) noexcept {
+  if (scratch_size == 0) {
+    scratch_size = auto_scratch_size<T>();
+  }
+
+  try {
+    switch (scratch_size) {
+      case 32:
+        quick_sort<false, 32>(data, len);
+        return 0;
+      case 64:
+        quick_sort<false, 64>(data, len);
+        return 0;
+      case 128:
+        quick_sort<false, 128>(data, len);
+        return 0;
+      case 256:
+        quick_sort<false, 256>(data, len);
+        return 0;
+      case 512:
+        quick_sort<false, 512>(data, len);
+        return 0;
+      case 1024:
+        quick_sort<false, 1024>(data, len);
+        return 0;
+      case 2048:
+        quick_sort<false, 2048>(data, len);
+        return 0;
+      case 4096:
+        quick_sort<false, 4096>(data, len);
+        return 0;
+      default:
+        return 1;
+    }
+  } catch (...) {
+    return 1;
+  }
+}
+}  // namespace
+
+template <bool kFat = false, typename T, typename F>
 uint32_t sort_by_impl(T* data, size_t len, F cmp_fn, uint8_t* ctx) noexcept {
   try {
-    exp_gerbens::QuickSort(data, data + len, make_compare_fn<T>(cmp_fn, ctx));
+    quick_sort<kFat>(data, len, make_compare_fn<T>(cmp_fn, ctx));
   } catch (...) {
     return 1;
   }
@@ -22,11 +139,28 @@ uint32_t sort_by_impl(T* data, size_t len, F cmp_fn, uint8_t* ctx) noexcept {
   return 0;
 }
 
+// Entry points gerbens_qsort_fat_unstable_<type>.
+#define FAT_IMPL(TYPE_NAME, TYPE, CPP_TYPE)                                   \
+  void gerbens_qsort_fat_unstable_##TYPE_NAME(TYPE* data, size_t len) {      \
+    SORT_USDT_PROBE(len);                                                    \
+    quick_sort<true>(reinterpret_cast<CPP_TYPE*>(data), len);                \
+  }                                                                          \
+                                                                             \
+  uint32_t gerbens_qsort_fat_unstable_##TYPE_NAME##_by(                      \
+      TYPE* data, size_t len,                                                \
+      CompResult (*cmp_fn)(const TYPE&, const TYPE&, uint8_t*),              \
+      uint8_t* ctx) {                                                        \
+    SORT_USDT_PROBE(len);                                                    \
+    return sort_by_impl<true>(reinterpret_cast<CPP_TYPE*>(data), len, cmp_fn, \
+                              ctx);                                          \
+  }
+
 extern "C" {
 // --- i32 ---
 
 void gerbens_qsort_unstable_i32(int32_t* data, size_t len) {
-  exp_gerbens::QuickSort(data, data + len);
+  SORT_USDT_PROBE(len);
+  quick_sort(data, len);
 }
 
 uint32_t gerbens_qsort_unstable_i32_by(int32_t* data,
@@ -35,13 +169,15 @@ uint32_t gerbens_qsort_unstable_i32_by(int32_t* data,
                                                             const int32_t&,
                                                             uint8_t*),
                                        uint8_t* ctx) {
+  SORT_USDT_PROBE(len);
   return sort_by_impl(data, len, cmp_fn, ctx);
 }
 
 // --- u64 ---
 
 void gerbens_qsort_unstable_u64(uint64_t* data, size_t len) {
-  exp_gerbens::QuickSort(data, data + len);
+  SORT_USDT_PROBE(len);
+  quick_sort(data, len);
 }
 
 uint32_t gerbens_qsort_unstable_u64_by(uint64_t* data,
@@ -50,14 +186,15 @@ uint32_t gerbens_qsort_unstable_u64_by(uint64_t* data,
                                                             const uint64_t&,
                                                             uint8_t*),
                                        uint8_t* ctx) {
+  SORT_USDT_PROBE(len);
   return sort_by_impl(data, len, cmp_fn, ctx);
 }
 
 // --- ffi_string ---
 
 void gerbens_qsort_unstable_ffi_string(FFIString* data, size_t len) {
-  exp_gerbens::QuickSort(reinterpret_cast<FFIStringCpp*>(data),
-                         reinterpret_cast<FFIStringCpp*>(data) + len);
+  SORT_USDT_PROBE(len);
+  quick_sort(reinterpret_cast<FFIStringCpp*>(data), len);
 }
 
 uint32_t gerbens_qsort_unstable_ffi_string_by(
@@ -65,14 +202,15 @@ uint32_t gerbens_qsort_unstable_ffi_string_by(
     size_t len,
     CompResult (*cmp_fn)(const FFIString&, const FFIString&, uint8_t*),
     uint8_t* ctx) {
+  SORT_USDT_PROBE(len);
   return sort_by_impl(reinterpret_cast<FFIStringCpp*>(data), len, cmp_fn, ctx);
 }
 
 // --- f128 ---
 
 void gerbens_qsort_unstable_f128(F128* data, size_t len) {
-  exp_gerbens::QuickSort(reinterpret_cast<F128Cpp*>(data),
-                         reinterpret_cast<F128Cpp*>(data) + len);
+  SORT_USDT_PROBE(len);
+  quick_sort(reinterpret_cast<F128Cpp*>(data), len);
 }
 
 uint32_t gerbens_qsort_unstable_f128_by(F128* data,
@@ -81,14 +219,15 @@ uint32_t gerbens_qsort_unstable_f128_by(F128* data,
                                                              const F128&,
                                                              uint8_t*),
                                         uint8_t* ctx) {
+  SORT_USDT_PROBE(len);
   return sort_by_impl(reinterpret_cast<F128Cpp*>(data), len, cmp_fn, ctx);
 }
 
 // --- 1k ---
 
 void gerbens_qsort_unstable_1k(FFIOneKibiByte* data, size_t len) {
-  exp_gerbens::QuickSort(reinterpret_cast<FFIOneKiloByteCpp*>(data),
-                         reinterpret_cast<FFIOneKiloByteCpp*>(data) + len);
+  SORT_USDT_PROBE(len);
+  quick_sort(reinterpret_cast<FFIOneKiloByteCpp*>(data), len);
 }
 
 uint32_t gerbens_qsort_unstable_1k_by(
@@ -98,7 +237,55 @@ uint32_t gerbens_qsort_unstable_1k_by(
                          const FFIOneKibiByte&,
                          uint8_t*),
     uint8_t* ctx) {
+  SORT_USDT_PROBE(len);
   return sort_by_impl(reinterpret_cast<FFIOneKiloByteCpp*>(data), len, cmp_fn,
                       ctx);
 }
+
+// --- scratch size per call ---
+
+uint32_t gerbens_qsort_unstable_i32_scratch(int32_t* data,
+                                            size_t len,
+                                            size_t scratch_size) {
+  SORT_USDT_PROBE(len);
+  return sort_scratch_impl(data, len, scratch_size);
+}
+
+uint32_t gerbens_qsort_unstable_u64_scratch(uint64_t* data,
+                                            size_t len,
+                                            size_t scratch_size) {
+  SORT_USDT_PROBE(len);
+  return sort_scratch_impl(data, len, scratch_size);
+}
+
+uint32_t gerbens_qsort_unstable_f128_scratch(F128* data,
+                                             size_t len,
+                                             size_t scratch_size) {
+  SORT_USDT_PROBE(len);
+  return sort_scratch_impl(reinterpret_cast<F128Cpp*>(data), len,
+                           scratch_size);
+}
+
+uint32_t gerbens_qsort_unstable_1k_scratch(FFIOneKibiByte* data,
+                                           size_t len,
+                                           size_t scratch_size) {
+  SORT_USDT_PROBE(len);
+  return sort_scratch_impl(reinterpret_cast<FFIOneKiloByteCpp*>(data), len,
+                           scratch_size);
+}
+
+// --- fat partition variant ---
+
+FAT_IMPL(i32, int32_t, int32_t)
+FAT_IMPL(u64, uint64_t, uint64_t)
+FAT_IMPL(ffi_string, FFIString, FFIStringCpp)
+FAT_IMPL(f128, F128, F128Cpp)
+FAT_IMPL(1k, FFIOneKibiByte, FFIOneKiloByteCpp)
+
+// --- nothrow ---
+
+NOTHROW_SORT_BY_IMPL(gerbens_qsort_unstable,
+                     [](auto begin, auto end, auto comp) {
+                       quick_sort(begin, end - begin, comp);
+                     })
 }  // extern "C"
@@ -0,0 +1,328 @@
+// CUB radix sort on the GPU, for i32 and u64 keys with an optional payload.
+// Every call copies the input to the device, sorts it there and copies it
+// back, the measured time is the end-to-end time a host caller sees.
+//
+// The copies go through two pinned staging buffers in chunks. Copying chunk
+// i + 1 into its staging buffer on the host overlaps with the DMA transfer of
+// chunk i, in both directions, without having to pin the caller's memory.
+// Device and staging buffers are kept between calls and only grow, so that
+// repeated sorts of the same size don't pay for the allocations.
+//
+// Built with nvcc, or with hipcc and hipCUB if GPU_SORT_HIP is defined.
+
+#ifdef GPU_SORT_HIP
+#include <hip/hip_runtime.h>
+#include <hipcub/hipcub.hpp>
+#define GPU(name) hip##name
+namespace gpu_cub = hipcub;
+#else
+#include <cub/cub.cuh>
+#include <cuda_runtime.h>
+#define GPU(name) cuda##name
+namespace gpu_cub = cub;
+#endif
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <type_traits>
+
+#include <stdint.h>
+
+#include "shared.h"
+
+namespace {
+// Large enough for the DMA engine to run at full speed, small enough that the
+// first chunk is in flight soon.
+constexpr size_t STAGING_CHUNK_BYTES = size_t{4} << 20;
+
+struct NoPayload {};
+
+template <typename P>
+constexpr bool HAS_PAYLOAD = !std::is_same_v<P, NoPayload>;
+
+// The void entry points have no way to report an error, and silently falling
+// back to a CPU sort would make the benchmark results meaningless.
+void check(GPU(Error_t) result, const char* what) {
+  if (result != GPU(Success)) {
+    fprintf(stderr, "cpp_gpu_sort: %s failed: %s\n", what,
+            GPU(GetErrorString)(result));
+    std::abort();
+  }
+}
+
+struct DeviceBuffer {
+  void* ptr = nullptr;
+  size_t capacity = 0;
+
+  template <typename T>
+  T* reserve(size_t len) {
+    const size_t bytes = len * sizeof(T);
+    if (bytes > capacity) {
+      if (ptr != nullptr) {
+        check(GPU(Free)(ptr), "Free");
+      }
+      check(GPU(Malloc)(&ptr, bytes), "Malloc");
+      capacity = bytes;
+    }
+
+    return static_cast<T*>(ptr);
+  }
+};
+
+class GpuContext {
+ public:
+  GpuContext() {
+    for (size_t i = 0; i < 2; ++i) {
+      check(GPU(StreamCreate)(&_streams[i]), "StreamCreate");
+      check(GPU(EventCreateWithFlags)(&_staging_free[i],
+                                      GPU(EventDisableTiming)),
+            "EventCreate");
+      check(GPU(MallocHost)(&_staging[i], STAGING_CHUNK_BYTES), "MallocHost");
+    }
+  }
+
+  GpuContext(const GpuContext&) = delete;
+  GpuContext& operator=(const GpuContext&) = delete;
+
+  // payload is null if P is NoPayload.
+  template <typename K, typename P>
+  void sort(K* keys, P* payload, size_t len) {
+    if (len < 2) {
+      return;
+    }
+
+    std::lock_guard<std::mutex> guard{_mutex};
+
+    gpu_cub::DoubleBuffer<K> d_keys{_keys[0].reserve<K>(len),
+                                    _keys[1].reserve<K>(len)};
+    copy_to_device(d_keys.Current(), keys, len);
+
+    gpu_cub::DoubleBuffer<P> d_payload;
+    if constexpr (HAS_PAYLOAD<P>) {
+      d_payload = gpu_cub::DoubleBuffer<P>{_payload[0].reserve<P>(len),
+                                           _payload[1].reserve<P>(len)};
+      copy_to_device(d_payload.Current(), payload, len);
+    }
+
+    size_t temp_bytes = 0;
+    radix_sort(nullptr, temp_bytes, d_keys, d_payload, len);
+    void* temp = _temp.reserve<uint8_t>(temp_bytes);
+    radix_sort(temp, temp_bytes, d_keys, d_payload, len);
+    check(GPU(StreamSynchronize)(_streams[0]), "StreamSynchronize");
+
+    copy_to_host(keys, d_keys.Current(), len);
+    if constexpr (HAS_PAYLOAD<P>) {
+      copy_to_host(payload, d_payload.Current(), len);
+    }
+  }
+
+ private:
+  // With temp null, only sets temp_bytes to the scratch space CUB needs.
+  template <typename K, typename P>
+  void radix_sort(void* temp,
+                  size_t& temp_bytes,
+                  gpu_cub::DoubleBuffer<K>& d_keys,
+                  gpu_cub::DoubleBuffer<P>& d_payload,
+                  size_t len) {
+    if constexpr (HAS_PAYLOAD<P>) {
+      check(gpu_cub::DeviceRadixSort::SortPairs(temp, temp_bytes, d_keys,
+                                                d_payload, len, 0,
+                                                sizeof(K) * 8, _streams[0]),
+            "SortPairs");
+    } else {
+      check(gpu_cub::DeviceRadixSort::SortKeys(temp, temp_bytes, d_keys, len,
+                                               0, sizeof(K) * 8, _streams[0]),
+            "SortKeys");
+    }
+  }
+
+  template <typename T>
+  void copy_to_device(T* dst, const T* src, size_t len) {
+    const size_t bytes = len * sizeof(T);
+    uint8_t* dst_bytes = reinterpret_cast<uint8_t*>(dst);
+    const uint8_t* src_bytes = reinterpret_cast<const uint8_t*>(src);
+
+    for (size_t offset = 0, i = 0; offset < bytes;
+         offset += STAGING_CHUNK_BYTES, ++i) {
+      const size_t slot = i % 2;
+      const size_t chunk_bytes = std::min(STAGING_CHUNK_BYTES, bytes - offset);
+
+      // The previous transfer out of this staging buffer has to be done.
+      check(GPU(EventSynchronize)(_staging_free[slot]), "EventSynchronize");
+      memcpy(_staging[slot], src_bytes + offset, chunk_bytes);
+      check(GPU(MemcpyAsync)(dst_bytes + offset, _staging[slot], chunk_bytes,
+                             GPU(MemcpyHostToDevice), _streams[slot]),
+            "MemcpyAsync");
+      check(GPU(EventRecord)(_staging_free[slot], _streams[slot]),
+            "EventRecord");
+    }
+
+    // The sort runs on the first stream only.
+    for (size_t slot = 0; slot < 2; ++slot) {
+      check(GPU(StreamSynchronize)(_streams[slot]), "StreamSynchronize");
+    }
+  }
+
+  template <typename T>
+  void copy_to_host(T* dst, const T* src, size_t len) {
+    const size_t bytes = len * sizeof(T);
+    uint8_t* dst_bytes = reinterpret_cast<uint8_t*>(dst);
+    const uint8_t* src_bytes = reinterpret_cast<const uint8_t*>(src);
+    const size_t chunk_count =
+        (bytes + STAGING_CHUNK_BYTES - 1) / STAGING_CHUNK_BYTES;
+
+    auto chunk_bytes = [&](size_t i) {
+      return std::min(STAGING_CHUNK_BYTES, bytes - i * STAGING_CHUNK_BYTES);
+    };
+
+    auto start_transfer = [&](size_t i) {
+      const size_t slot = i % 2;
+      check(GPU(MemcpyAsync)(_staging[slot],
+                             src_bytes + i * STAGING_CHUNK_BYTES,
+                             chunk_bytes(i), GPU(MemcpyDeviceToHost),
+                             _streams[slot]),
+            "MemcpyAsync");
+      check(GPU(EventRecord)(_staging_free[slot], _streams[slot]),
+            "EventRecord");
+    };
+
+    for (size_t i = 0; i < std::min(chunk_count, size_t{2}); ++i) {
+      start_transfer(i);
+    }
+
+    for (size_t i = 0; i < chunk_count; ++i) {
+      const size_t slot = i % 2;
+      check(GPU(EventSynchronize)(_staging_free[slot]), "EventSynchronize");
+      memcpy(dst_bytes + i * STAGING_CHUNK_BYTES, _staging[slot],
+             chunk_bytes(i));
+
+      if (i + 2 < chunk_count) {
+        start_transfer(i + 2);
+      }
+    }
+  }
+
+  std::mutex _mutex;
+  GPU(Stream_t) _streams[2];
+  GPU(Event_t) _staging_free[2];
+  void* _staging[2];
+  DeviceBuffer _keys[2];
+  DeviceBuffer _payload[2];
+  DeviceBuffer _temp;
+};
+
+GpuContext& gpu_context() {
+  // Never destroyed, the driver may already be shut down when static
+  // destructors run.
+  static GpuContext* context = new GpuContext{};
+  return *context;
+}
+
+template <typename K>
+void sort_keys(K* keys, size_t len) {
+  gpu_context().sort(keys, static_cast<NoPayload*>(nullptr), len);
+}
+}  // namespace
+
+extern "C" {
+// --- i32 ---
+
+void gpu_sort_unstable_i32(int32_t* data, size_t len) {
+  SORT_USDT_PROBE(len);
+  sort_keys(data, len);
+}
+
+uint32_t gpu_sort_unstable_i32_by(int32_t* data,
+                                  size_t len,
+                                  CompResult (*cmp_fn)(const int32_t&,
+                                                       const int32_t&,
+                                                       uint8_t*),
+                                  uint8_t* ctx) {
+  printf("Not supported\n");
+  return 1;
+}
+
+// The payload is permuted together with the keys. CUB's radix sort is
+// stable, equal keys keep the order of their payloads.
+void gpu_sort_unstable_i32_with_payload(int32_t* keys,
+                                        uint32_t* payload,
+                                        size_t len) {
+  SORT_USDT_PROBE(len);
+  gpu_context().sort(keys, payload, len);
+}
+
+// --- u64 ---
+
+void gpu_sort_unstable_u64(uint64_t* data, size_t len) {
+  SORT_USDT_PROBE(len);
+  sort_keys(data, len);
+}
+
+uint32_t gpu_sort_unstable_u64_by(uint64_t* data,
+                                  size_t len,
+                                  CompResult (*cmp_fn)(const uint64_t&,
+                                                       const uint64_t&,
+                                                       uint8_t*),
+                                  uint8_t* ctx) {
+  printf("Not supported\n");
+  return 1;
+}
+
+void gpu_sort_unstable_u64_with_payload(uint64_t* keys,
+                                        uint64_t* payload,
+                                        size_t len) {
+  SORT_USDT_PROBE(len);
+  gpu_context().sort(keys, payload, len);
+}
+
+// --- ffi_string ---
+
+void gpu_sort_unstable_ffi_string(FFIString* data, size_t len) {
+  printf("Not supported\n");
+}
+
+uint32_t gpu_sort_unstable_ffi_string_by(FFIString* data,
+                                         size_t len,
+                                         CompResult (*cmp_fn)(const FFIString&,
+                                                              const FFIString&,
+                                                              uint8_t*),
+                                         uint8_t* ctx) {
+  printf("Not supported\n");
+  return 1;
+}
+
+// --- f128 ---
+
+void gpu_sort_unstable_f128(F128* data, size_t len) {
+  printf("Not supported\n");
+}
+
+uint32_t gpu_sort_unstable_f128_by(F128* data,
+                                   size_t len,
+                                   CompResult (*cmp_fn)(const F128&,
+                                                        const F128&,
+                                                        uint8_t*),
+                                   uint8_t* ctx) {
+  printf("Not supported\n");
+  return 1;
+}
+
+// --- 1k ---
+
+void gpu_sort_unstable_1k(FFIOneKibiByte* data, size_t len) {
+  printf("Not supported\n");
+}
+
+uint32_t gpu_sort_unstable_1k_by(FFIOneKibiByte* data,
+                                 size_t len,
+                                 CompResult (*cmp_fn)(const FFIOneKibiByte&,
+                                                      const FFIOneKibiByte&,
+                                                      uint8_t*),
+                                 uint8_t* ctx) {
+  printf("Not supported\n");
+  return 1;
+}
+}  // extern "C"
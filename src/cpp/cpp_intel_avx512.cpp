@@ -1,17 +1,180 @@
-#include "thirdparty/intel_avx512/avx512-32bit-qsort.hpp"
-#include "thirdparty/intel_avx512/avx512-64bit-qsort.hpp"
-
+// The kernels are compiled for AVX-512 with target attributes, and the entry
+// points only call them if the CPU supports it. Standard headers are included
+// before the target region, so their code is not compiled for AVX-512 too.
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
 #include <stdexcept>
+#include <utility>
+#include <vector>
 
 #include <stdint.h>
 
+#include "cpu_features.h"
 #include "shared.h"
 
+#if SORT_ARCH_X86
+#include <immintrin.h>
+
+#if defined(__clang__)
+#pragma clang attribute push(                                   \
+    __attribute__((target("avx512f,avx512cd,avx512dq,avx512bw," \
+                          "avx512vl,bmi2,popcnt"))),             \
+    apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("avx512f,avx512cd,avx512dq,avx512bw", "avx512vl,bmi2,popcnt")
+#endif
+#include "thirdparty/intel_avx512/avx512-32bit-qsort.hpp"
+#include "thirdparty/intel_avx512/avx512-64bit-qsort.hpp"
+#include "intel_avx512_kv.h"
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+
+// The 16-bit kernel relies on the compress store from AVX512-VBMI2, and F16C
+// for the half precision conversions.
+#if defined(__clang__)
+#pragma clang attribute push(                                         \
+    __attribute__((target("avx512f,avx512cd,avx512dq,avx512bw,"       \
+                          "avx512vl,bmi2,popcnt,f16c,avx512vbmi2"))), \
+    apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("avx512f,avx512cd,avx512dq,avx512bw", \
+                   "avx512vl,bmi2,popcnt,f16c,avx512vbmi2")
+#endif
+#include "thirdparty/intel_avx512/avx512-16bit-qsort.hpp"
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+#endif  // SORT_ARCH_X86
+
+namespace {
+bool use_avx512() {
+  return cpu_features::has_avx512_skx();
+}
+
+bool use_avx512_16bit() {
+  return cpu_features::has_avx512_vbmi2();
+}
+
+template <typename T>
+void sort_impl(T* data, size_t len) {
+#if SORT_ARCH_X86
+  if (use_avx512()) {
+    avx512_qsort(data, len);
+    return;
+  }
+#endif
+  std::sort(data, data + len);
+}
+
+template <typename T>
+void select_impl(T* data, size_t len, size_t index) {
+#if SORT_ARCH_X86
+  if (use_avx512()) {
+    avx512_qselect(data, index, len);
+    return;
+  }
+#endif
+  std::nth_element(data, data + index, data + len);
+}
+
+template <typename T>
+size_t partition_impl(T* data, size_t len, T pivot) {
+#if SORT_ARCH_X86
+  if (use_avx512()) {
+    return static_cast<size_t>(
+        avx512_partition(data, static_cast<int64_t>(len), pivot));
+  }
+#endif
+  return std::partition(data, data + len,
+                        [pivot](T val) { return val < pivot; }) -
+         data;
+}
+
+// AllowSimd = false always takes the fallback, so that tests cover it on hosts
+// with AVX512-VBMI2 too.
+template <bool AllowSimd, typename T>
+void sort_16bit_impl(T* data, size_t len) {
+#if SORT_ARCH_X86
+  if (AllowSimd && use_avx512_16bit()) {
+    avx512_qsort(data, len);
+    return;
+  }
+#endif
+  std::sort(data, data + len);
+}
+
+// avx512_qsort replaces NaNs with infinity before sorting, and writes them back
+// at the end afterwards. The fallback uses the same total order through Cpp.
+template <typename Cpp, typename F, typename T>
+void sort_float_impl(F* data, size_t len) {
+#if SORT_ARCH_X86
+  if (use_avx512()) {
+    avx512_qsort(reinterpret_cast<T*>(data), len);
+    return;
+  }
+#endif
+  std::sort(reinterpret_cast<Cpp*>(data), reinterpret_cast<Cpp*>(data) + len);
+}
+
+void sort_kv_impl(uint64_t* keys, uint64_t* values, size_t len) {
+#if SORT_ARCH_X86
+  if (use_avx512()) {
+    avx512_kv::qsort(keys, values, static_cast<int64_t>(len));
+    return;
+  }
+#endif
+  std::vector<std::pair<uint64_t, uint64_t>> pairs(len);
+  for (size_t i = 0; i < len; ++i) {
+    pairs[i] = {keys[i], values[i]};
+  }
+  std::sort(pairs.begin(), pairs.end(),
+            [](const auto& a, const auto& b) { return a.first < b.first; });
+  for (size_t i = 0; i < len; ++i) {
+    keys[i] = pairs[i].first;
+    values[i] = pairs[i].second;
+  }
+}
+}  // namespace
+
 extern "C" {
+const char* intel_avx512_simd_target() {
+  return use_avx512() ? (use_avx512_16bit() ? "AVX512_VBMI2" : "AVX512")
+                      : "scalar";
+}
+
 // --- i32 ---
 
 void intel_avx512_i32(int32_t* data, size_t len) {
-  avx512_qsort(data, len);
+  SORT_USDT_PROBE(len);
+  sort_impl(data, len);
+}
+
+// The vendored x86-simd-sort only sorts ascending. Equal integers are
+// indistinguishable, so reversing the ascending result is a valid descending
+// sort at the cost of one extra linear pass.
+void intel_avx512_i32_desc(int32_t* data, size_t len) {
+  SORT_USDT_PROBE(len);
+  sort_impl(data, len);
+  std::reverse(data, data + len);
+}
+
+void intel_avx512_i32_select(int32_t* data, size_t len, size_t index) {
+  SORT_USDT_PROBE(len);
+  select_impl(data, len, index);
+}
+
+size_t intel_avx512_partition_i32(int32_t* data, size_t len, const int32_t* pivot) {
+  SORT_USDT_PROBE(len);
+  return partition_impl(data, len, *pivot);
 }
 
 uint32_t intel_avx512_i32_by(int32_t* data,
@@ -27,7 +190,40 @@ uint32_t intel_avx512_i32_by(int32_t* data,
 // --- u64 ---
 
 void intel_avx512_u64(uint64_t* data, size_t len) {
-  avx512_qsort(reinterpret_cast<int64_t*>(data), len);
+  SORT_USDT_PROBE(len);
+  sort_impl(data, len);
+}
+
+void intel_avx512_u64_desc(uint64_t* data, size_t len) {
+  SORT_USDT_PROBE(len);
+  sort_impl(data, len);
+  std::reverse(data, data + len);
+}
+
+void intel_avx512_u64_select(uint64_t* data, size_t len, size_t index) {
+  SORT_USDT_PROBE(len);
+  select_impl(data, len, index);
+}
+
+size_t intel_avx512_partition_u64(uint64_t* data, size_t len, const uint64_t* pivot) {
+  SORT_USDT_PROBE(len);
+  return partition_impl(data, len, *pivot);
+}
+
+// avx512_qsort already uses its bitonic networks for anything up to 128
+// elements.
+void intel_avx512_u64_batch(uint64_t* data,
+                            const size_t* offsets,
+                            size_t n_slices) {
+  sort_slices(data, offsets, n_slices, [](uint64_t* slice, size_t slice_len) {
+    sort_impl(slice, slice_len);
+  });
+}
+
+// Sorts keys and permutes values the same way. Not stable.
+void intel_avx512_kv_u64(uint64_t* keys, uint64_t* values, size_t len) {
+  SORT_USDT_PROBE(len);
+  sort_kv_impl(keys, values, len);
 }
 
 uint32_t intel_avx512_u64_by(uint64_t* data,
@@ -87,4 +283,86 @@ uint32_t intel_avx512_1k_by(FFIOneKibiByte* data,
   printf("Not supported\n");
   return 1;
 }
+
+// --- i16 ---
+
+void intel_avx512_i16(int16_t* data, size_t len) {
+  SORT_USDT_PROBE(len);
+  sort_16bit_impl<true>(data, len);
+}
+
+void intel_avx512_i16_fallback(int16_t* data, size_t len) {
+  sort_16bit_impl<false>(data, len);
+}
+
+uint32_t intel_avx512_i16_by(int16_t* data,
+                             size_t len,
+                             CompResult (*cmp_fn)(const int16_t&,
+                                                  const int16_t&,
+                                                  uint8_t*),
+                             uint8_t* ctx) {
+  printf("Not supported\n");
+  return 1;
+}
+
+// --- u16 ---
+
+void intel_avx512_u16(uint16_t* data, size_t len) {
+  SORT_USDT_PROBE(len);
+  sort_16bit_impl<true>(data, len);
+}
+
+void intel_avx512_u16_fallback(uint16_t* data, size_t len) {
+  sort_16bit_impl<false>(data, len);
+}
+
+uint32_t intel_avx512_u16_by(uint16_t* data,
+                             size_t len,
+                             CompResult (*cmp_fn)(const uint16_t&,
+                                                  const uint16_t&,
+                                                  uint8_t*),
+                             uint8_t* ctx) {
+  printf("Not supported\n");
+  return 1;
+}
+
+// --- f32 ---
+
+void intel_avx512_f32(F32* data, size_t len) {
+  SORT_USDT_PROBE(len);
+  sort_float_impl<F32Cpp, F32, float>(data, len);
+}
+
+uint32_t intel_avx512_f32_by(F32* data,
+                             size_t len,
+                             CompResult (*cmp_fn)(const F32&,
+                                                  const F32&,
+                                                  uint8_t*),
+                             uint8_t* ctx) {
+  printf("Not supported\n");
+  return 1;
+}
+
+// --- f64 ---
+
+void intel_avx512_f64(F64* data, size_t len) {
+  SORT_USDT_PROBE(len);
+  sort_float_impl<F64Cpp, F64, double>(data, len);
+}
+
+uint32_t intel_avx512_f64_by(F64* data,
+                             size_t len,
+                             CompResult (*cmp_fn)(const F64&,
+                                                  const F64&,
+                                                  uint8_t*),
+                             uint8_t* ctx) {
+  printf("Not supported\n");
+  return 1;
+}
+
+// --- packed records ---
+
+PACKED_SORT_IMPL_U64(intel_avx512, [](uint64_t* words, size_t len) {
+  sort_impl(words, len);
+})
 }  // extern "C"
@@ -1,15 +1,54 @@
+// Has to come before ips4o.hpp, see ips4o_timer.h.
+#include "ips4o_timer.h"
+// Has to come before ips4o.hpp, the SORT_TELEMETRY hooks call into it.
+#include "sort_telemetry.h"
+
+// Has to come before ips4o.hpp, the classifier calls into it.
+#ifdef IPS4O_SIMD_CLASSIFIER
+#include "simd_classifier.h"
+#endif
+
 #include "thirdparty/ips4o/ips4o.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <optional>
 #include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <variant>
+#include <vector>
 
 #include <stdint.h>
+#include <sys/mman.h>
 
-// ips4o is implemented in a way that requires that T implements a by ref copy
-// constructor. That's incompatible with move only types such as FFIStringCpp.
+// ips4o keeps copies of the splitters in the classifier while the elements they
+// were taken from stay in the input, so T has to be copy constructible. That's
+// incompatible with move only types such as FFIStringCpp.
 #define SORT_INCOMPATIBLE_WITH_SEMANTIC_CPP_TYPE
 
+#include "cpu_topology.h"
+#include "ips4o_out_of_place.h"
+#include "ips4o_splitters.h"
+#include "numa_util.h"
 #include "shared.h"
 
+// The parallel variant is built from this same file with IPS4O_PARALLEL
+// defined, see build.rs. Only one set of entry points is emitted per build to
+// avoid duplicate symbols when both features are enabled.
+#if !defined(IPS4O_PARALLEL)
+
+#if defined(CPP_SPLIT_INSTANTIATION)
+#include "ips4o_instantiation.h"
+
+IPS4O_INSTANTIATE_COMMON(extern)
+#endif
+
 template <typename T, typename F>
 uint32_t sort_by_impl(T* data, size_t len, F cmp_fn, uint8_t* ctx) noexcept {
   try {
@@ -21,10 +60,125 @@ uint32_t sort_by_impl(T* data, size_t len, F cmp_fn, uint8_t* ctx) noexcept {
   return 0;
 }
 
+template <typename T>
+uint32_t sort_by_key_impl(T* data, size_t len, KeyDescriptor key) noexcept {
+  const bool is_valid_key = with_key_compare<T>(
+      key, [data, len](auto comp) { ips4o::sort(data, data + len, comp); });
+
+  return is_valid_key ? 0 : 1;
+}
+
+// The quantiles hold ips4o_splitters::kQuantiles elements, see
+// cpp_ips4o_splitters.rs.
+static_assert(ips4o_splitters::kQuantiles == 255);
+
+template <typename T>
+uint32_t sort_splitters_impl(T* data,
+                             size_t len,
+                             T* quantiles,
+                             bool valid) noexcept {
+  return ips4o_splitters::sort(data, len, quantiles, valid,
+                               [](T* data, size_t len, auto comp) {
+                                 ips4o::sort(data, data + len, comp);
+                               });
+}
+
+// ips4o has no way to stop early, so the k smallest elements are selected
+// first and only those are sorted.
+template <typename T>
+void partial_sort_impl(T* data, size_t len, size_t k) noexcept {
+  std::nth_element(data, data + k, data + len);
+  ips4o::sort(data, data + k);
+}
+
+// ips4o::sort with a fixed sampling seed instead of one from
+// std::random_device, so that two sorts of the same input perform the same
+// operations, for the _counted entry points.
+template <typename It>
+void sort_fixed_seed(It begin, It end) {
+  using Cfg = ips4o::ExtendedConfig<It, std::less<>, ips4o::Config<>>;
+
+  if (ips4o::detail::sortSimpleCases(begin, end, std::less<>{})) {
+    return;
+  }
+
+  if (end - begin <= Cfg::kBaseCaseMultiplier * Cfg::kBaseCaseSize) {
+    ips4o::detail::baseCaseSort(begin, end, std::less<>{});
+    return;
+  }
+
+  ips4o::SequentialSorter<Cfg> sorter{false, std::less<>{}};
+  sorter.seed(0);
+  sorter(begin, end);
+}
+
+// Alternatives to ips4o::Config<> for specific classes of inputs, selected at
+// runtime through the _profile entry points. The template arguments of Config
+// are, in order: allow equal buckets, base case size, base case multiplier,
+// block size in bytes, bucket type, data alignment, equal buckets threshold,
+// log2 of the bucket count, min parallel blocks per thread, oversampling
+// factor in percent and classifier unroll factor.
+namespace ips4o_profile {
+// Same order as Ips4oProfile on the Rust side.
+enum Profile : uint32_t {
+  Default = 0,
+  SmallCache = 1,
+  LargeCache = 2,
+  Duplicates = 3,
+  LargeElements = 4,
+};
+
+// 256 buckets of 1KiB blocks, the buffers fit into a 256KiB L2, while the
+// default 512 buckets of 2KiB need 1MiB.
+using SmallCacheConfig = ips4o::Config<true, 16, 16, (1 << 10), std::ptrdiff_t,
+                                       (4 << 10), 5, 7, 4, 20, 7>;
+
+// 1024 buckets of 4KiB blocks, 4MiB of buffers that stay in a large L3. One
+// level of recursion less for inputs of a few hundred million elements.
+using LargeCacheConfig = ips4o::Config<true, 16, 16, (4 << 10), std::ptrdiff_t,
+                                       (4 << 10), 5, 9, 4, 20, 7>;
+
+// Equal buckets as soon as two splitters are equal instead of five, and a
+// larger sample, so that frequent values are found and split off early.
+using DuplicatesConfig = ips4o::Config<true, 16, 16, (2 << 10), std::ptrdiff_t,
+                                       (4 << 10), 2, 8, 4, 30, 7>;
+
+// For elements of hundreds of bytes, where a 2KiB block holds only a few.
+// 8KiB blocks in half the buckets keep the buffers at 2MiB. A smaller base
+// case, to save moves of whole elements in its insertion sort, was slower.
+using LargeElementsConfig = ips4o::Config<true, 16, 16, (8 << 10),
+                                          std::ptrdiff_t, (4 << 10), 5, 7, 4,
+                                          20, 7>;
+
+template <typename T>
+uint32_t sort(T* data, size_t len, uint32_t profile) noexcept {
+  switch (profile) {
+    case Default:
+      ips4o::sort<ips4o::Config<>>(data, data + len, std::less<>{});
+      return 0;
+    case SmallCache:
+      ips4o::sort<SmallCacheConfig>(data, data + len, std::less<>{});
+      return 0;
+    case LargeCache:
+      ips4o::sort<LargeCacheConfig>(data, data + len, std::less<>{});
+      return 0;
+    case Duplicates:
+      ips4o::sort<DuplicatesConfig>(data, data + len, std::less<>{});
+      return 0;
+    case LargeElements:
+      ips4o::sort<LargeElementsConfig>(data, data + len, std::less<>{});
+      return 0;
+    default:
+      return 1;
+  }
+}
+}  // namespace ips4o_profile
+
 extern "C" {
 // --- i32 ---
 
 void ips4o_unstable_i32(int32_t* data, size_t len) {
+  SORT_USDT_PROBE(len);
   ips4o::sort(data, data + len);
 }
 
@@ -34,12 +188,49 @@ uint32_t ips4o_unstable_i32_by(int32_t* data,
                                                     const int32_t&,
                                                     uint8_t*),
                                uint8_t* ctx) {
+  SORT_USDT_PROBE(len);
   return sort_by_impl(data, len, cmp_fn, ctx);
 }
 
+void ips4o_unstable_i32_partial(int32_t* data, size_t len, size_t k) {
+  SORT_USDT_PROBE(len);
+  partial_sort_impl(data, len, k);
+}
+
+uint32_t ips4o_unstable_i32_by_key(int32_t* data,
+                                   size_t len,
+                                   KeyDescriptor key) {
+  SORT_USDT_PROBE(len);
+  return sort_by_key_impl(data, len, key);
+}
+
+void ips4o_unstable_i32_into(int32_t* src, int32_t* dst, size_t len) {
+  SORT_USDT_PROBE(len);
+  ips4o_out_of_place::sort_into(src, dst, len);
+}
+
+// profile is one of ips4o_profile::Profile, returns 1 for unknown ones.
+uint32_t ips4o_unstable_i32_profile(int32_t* data,
+                                    size_t len,
+                                    uint32_t profile) {
+  SORT_USDT_PROBE(len);
+  return ips4o_profile::sort(data, len, profile);
+}
+
+// quantiles points to ips4o_splitters::kQuantiles elements, only read if valid.
+// Returns one of ips4o_splitters::Use.
+uint32_t ips4o_unstable_i32_splitters(int32_t* data,
+                                      size_t len,
+                                      int32_t* quantiles,
+                                      bool valid) {
+  SORT_USDT_PROBE(len);
+  return sort_splitters_impl(data, len, quantiles, valid);
+}
+
 // --- u64 ---
 
 void ips4o_unstable_u64(uint64_t* data, size_t len) {
+  SORT_USDT_PROBE(len);
   ips4o::sort(data, data + len);
 }
 
@@ -49,12 +240,46 @@ uint32_t ips4o_unstable_u64_by(uint64_t* data,
                                                     const uint64_t&,
                                                     uint8_t*),
                                uint8_t* ctx) {
+  SORT_USDT_PROBE(len);
   return sort_by_impl(data, len, cmp_fn, ctx);
 }
 
+void ips4o_unstable_u64_partial(uint64_t* data, size_t len, size_t k) {
+  SORT_USDT_PROBE(len);
+  partial_sort_impl(data, len, k);
+}
+
+uint32_t ips4o_unstable_u64_by_key(uint64_t* data,
+                                   size_t len,
+                                   KeyDescriptor key) {
+  SORT_USDT_PROBE(len);
+  return sort_by_key_impl(data, len, key);
+}
+
+void ips4o_unstable_u64_into(uint64_t* src, uint64_t* dst, size_t len) {
+  SORT_USDT_PROBE(len);
+  ips4o_out_of_place::sort_into(src, dst, len);
+}
+
+uint32_t ips4o_unstable_u64_profile(uint64_t* data,
+                                    size_t len,
+                                    uint32_t profile) {
+  SORT_USDT_PROBE(len);
+  return ips4o_profile::sort(data, len, profile);
+}
+
+uint32_t ips4o_unstable_u64_splitters(uint64_t* data,
+                                      size_t len,
+                                      uint64_t* quantiles,
+                                      bool valid) {
+  SORT_USDT_PROBE(len);
+  return sort_splitters_impl(data, len, quantiles, valid);
+}
+
 // --- ffi_string ---
 
 void ips4o_unstable_ffi_string(FFIString* data, size_t len) {
+  SORT_USDT_PROBE(len);
   ips4o::sort(reinterpret_cast<FFIStringCpp*>(data),
               reinterpret_cast<FFIStringCpp*>(data) + len);
 }
@@ -65,12 +290,38 @@ uint32_t ips4o_unstable_ffi_string_by(FFIString* data,
                                                            const FFIString&,
                                                            uint8_t*),
                                       uint8_t* ctx) {
+  SORT_USDT_PROBE(len);
   return sort_by_impl(reinterpret_cast<FFIStringCpp*>(data), len, cmp_fn, ctx);
 }
 
+void ips4o_unstable_ffi_string_partial(FFIString* data, size_t len, size_t k) {
+  SORT_USDT_PROBE(len);
+  partial_sort_impl(reinterpret_cast<FFIStringCpp*>(data), len, k);
+}
+
+// --- arena_string ---
+
+void ips4o_unstable_arena_string(FFIArenaString* data, size_t len) {
+  SORT_USDT_PROBE(len);
+  ips4o::sort(reinterpret_cast<FFIArenaStringCpp*>(data),
+              reinterpret_cast<FFIArenaStringCpp*>(data) + len);
+}
+
+uint32_t ips4o_unstable_arena_string_by(
+    FFIArenaString* data,
+    size_t len,
+    CompResult (*cmp_fn)(const FFIArenaString&,
+                         const FFIArenaString&,
+                         uint8_t*),
+    uint8_t* ctx) {
+  SORT_USDT_PROBE(len);
+  return sort_by_impl(data, len, cmp_fn, ctx);
+}
+
 // --- f128 ---
 
 void ips4o_unstable_f128(F128* data, size_t len) {
+  SORT_USDT_PROBE(len);
   ips4o::sort(reinterpret_cast<F128Cpp*>(data),
               reinterpret_cast<F128Cpp*>(data) + len);
 }
@@ -81,12 +332,24 @@ uint32_t ips4o_unstable_f128_by(F128* data,
                                                      const F128&,
                                                      uint8_t*),
                                 uint8_t* ctx) {
+  SORT_USDT_PROBE(len);
   return sort_by_impl(reinterpret_cast<F128Cpp*>(data), len, cmp_fn, ctx);
 }
 
+void ips4o_unstable_f128_partial(F128* data, size_t len, size_t k) {
+  SORT_USDT_PROBE(len);
+  partial_sort_impl(reinterpret_cast<F128Cpp*>(data), len, k);
+}
+
+uint32_t ips4o_unstable_f128_profile(F128* data, size_t len, uint32_t profile) {
+  SORT_USDT_PROBE(len);
+  return ips4o_profile::sort(reinterpret_cast<F128Cpp*>(data), len, profile);
+}
+
 // --- 1k ---
 
 void ips4o_unstable_1k(FFIOneKibiByte* data, size_t len) {
+  SORT_USDT_PROBE(len);
   ips4o::sort(reinterpret_cast<FFIOneKiloByteCpp*>(data),
               reinterpret_cast<FFIOneKiloByteCpp*>(data) + len);
 }
@@ -97,7 +360,639 @@ uint32_t ips4o_unstable_1k_by(FFIOneKibiByte* data,
                                                    const FFIOneKibiByte&,
                                                    uint8_t*),
                               uint8_t* ctx) {
+  SORT_USDT_PROBE(len);
   return sort_by_impl(reinterpret_cast<FFIOneKiloByteCpp*>(data), len, cmp_fn,
                       ctx);
 }
+
+uint32_t ips4o_unstable_1k_by_key(FFIOneKibiByte* data,
+                                  size_t len,
+                                  KeyDescriptor key) {
+  SORT_USDT_PROBE(len);
+  return sort_by_key_impl(reinterpret_cast<FFIOneKiloByteCpp*>(data), len, key);
+}
+
+uint32_t ips4o_unstable_1k_profile(FFIOneKibiByte* data,
+                                   size_t len,
+                                   uint32_t profile) {
+  SORT_USDT_PROBE(len);
+  return ips4o_profile::sort(reinterpret_cast<FFIOneKiloByteCpp*>(data), len,
+                             profile);
+}
+
+// --- counted ---
+
+COUNTED_SORT_IMPL(ips4o_unstable,
+                  [](auto begin, auto end) { sort_fixed_seed(begin, end); })
+
+// --- indirect ---
+
+INDIRECT_SORT_IMPL(ips4o_unstable, [](auto begin, auto end, auto comp) {
+  ips4o::sort(begin, end, comp);
+})
+}  // extern "C"
+
+#else  // IPS4O_PARALLEL
+
+#if !defined(_REENTRANT)
+#error "The parallel ips4o build requires -pthread"
+#endif
+
+template <typename T>
+void sort_parallel_impl(T* data, size_t len, size_t num_threads) noexcept {
+  ips4o::parallel::sort(data, data + len, std::less<>{},
+                        static_cast<int>(num_threads));
+}
+
+static_assert(ips4o_splitters::kQuantiles == 255);
+
+template <typename T>
+uint32_t sort_parallel_splitters_impl(T* data,
+                                      size_t len,
+                                      T* quantiles,
+                                      bool valid,
+                                      size_t num_threads) noexcept {
+  return ips4o_splitters::sort(
+      data, len, quantiles, valid,
+      [num_threads](T* data, size_t len, auto comp) {
+        ips4o::parallel::sort(data, data + len, comp,
+                              static_cast<int>(num_threads));
+      });
+}
+
+// The segments go through the task scheduler of a single parallel sorter, so a
+// skewed mix of tiny and huge segments still keeps all threads busy.
+template <typename T>
+void sort_batch_parallel_impl(T* data,
+                              const size_t* offsets,
+                              size_t n_slices,
+                              size_t num_threads) noexcept {
+  auto sorter = ips4o::parallel::make_sorter<T*>(static_cast<int>(num_threads));
+  sorter.sortSegments(data, offsets, n_slices);
+}
+
+template <typename T, typename F>
+uint32_t sort_parallel_by_impl(T* data,
+                               size_t len,
+                               F cmp_fn,
+                               uint8_t* ctx,
+                               size_t num_threads) noexcept {
+  // Exceptions can't cross the worker threads, see make_compare_fn_nothrow.
+  std::atomic<bool> did_panic{false};
+
+  ips4o::parallel::sort(data, data + len,
+                        make_compare_fn_nothrow<T>(cmp_fn, ctx, did_panic),
+                        static_cast<int>(num_threads));
+
+  return did_panic.load() ? 1 : 0;
+}
+
+// Puts each allocation of a sorter on the NUMA node of the thread that makes
+// it, or with kRemote on the next node over, to measure the cost of remote
+// buffers. Memory comes straight from mmap, the buffers are marked for
+// transparent huge pages. LocalData and SharedData are a few dozen KiB, too
+// small for a huge page.
+template <bool kRemote>
+struct NumaAllocator {
+  static constexpr size_t kPageSize = size_t{2} << 20;
+  static constexpr size_t kSmallPageSize = 4096;
+
+  static char* allocate(size_t bytes) {
+    const size_t map_bytes = round_up(bytes);
+    void* ptr = mmap(nullptr, map_bytes, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (ptr == MAP_FAILED) {
+      throw std::bad_alloc{};
+    }
+#if defined(MADV_HUGEPAGE)
+    if (map_bytes >= kPageSize) {
+      madvise(ptr, map_bytes, MADV_HUGEPAGE);
+    }
+#endif
+    numa_util::prefer_node(ptr, map_bytes, target_node(),
+                           /*move_pages=*/false);
+
+    return static_cast<char*>(ptr);
+  }
+
+  static void deallocate(char* ptr, size_t bytes) {
+    munmap(ptr, round_up(bytes));
+  }
+
+  // The buffer storage is allocated by the calling thread for all threads,
+  // each thread then claims its own part.
+  static void placeLocal(char* ptr, size_t bytes) {
+    numa_util::prefer_node(ptr, bytes, target_node(), /*move_pages=*/true);
+  }
+
+  static size_t round_up(size_t bytes) {
+    const size_t page = bytes >= kPageSize ? kPageSize : kSmallPageSize;
+    return (bytes + page - 1) / page * page;
+  }
+
+  static int target_node() {
+    const int node = numa_util::current_node();
+    return kRemote ? (node + 1) % numa_util::num_nodes() : node;
+  }
+};
+
+// Reusable parallel sorter state. Keeps the worker threads as well as the
+// per-thread LocalData and BufferStorage alive across calls, so repeated sorts
+// don't pay for thread creation and buffer allocation. The sorters are created
+// on first use per type, and all share the same threads. Must not be used from
+// multiple threads at the same time.
+template <typename Allocator>
+struct Ips4oPoolImpl {
+  static constexpr bool kIsNuma =
+      !std::is_same_v<Allocator, ips4o::DefaultAllocator>;
+
+  template <typename T>
+  using Sorter = ips4o::ParallelSorter<
+      ips4o::ExtendedConfig<T*, std::less<>, ips4o::Config<>,
+                            ips4o::StdThreadPool&, Allocator>>;
+
+  Ips4oPoolImpl(int num_threads, cpu_topology::Placement thread_placement)
+      : thread_pool{num_threads},
+        thread_cpus{cpu_topology::place_threads(thread_placement,
+                                                thread_pool.numThreads())} {
+    if (!thread_cpus.empty()) {
+      // Thread 0 is whichever thread calls sort, it is only pinned while it
+      // sorts.
+      thread_pool([this](int id, int) {
+        if (id != 0) {
+          cpu_topology::pin_thread_to_cpus(thread_cpus[id]);
+        }
+      });
+    } else if constexpr (kIsNuma) {
+      // Spread the workers evenly across the nodes, so that the node they
+      // allocate on stays the node they run on. The calling thread is only
+      // pinned while it sorts.
+      thread_pool([](int id, int pool_threads) {
+        if (id != 0) {
+          numa_util::pin_thread_to_node(id * numa_util::num_nodes() /
+                                        pool_threads);
+        }
+      });
+    }
+  }
+
+  template <typename T>
+  void sort(T* data, size_t len) {
+    std::optional<cpu_topology::ScopedCpuPin> caller_cpu_pin;
+    std::optional<numa_util::ScopedNodePin> caller_pin;
+    if (!thread_cpus.empty()) {
+      caller_cpu_pin.emplace(thread_cpus[0]);
+    } else if constexpr (kIsNuma) {
+      caller_pin.emplace(numa_util::current_node());
+    }
+
+    auto& sorter = sorter_for<T>();
+    if (!sorter) {
+      sorter.emplace(std::less<>{}, thread_pool, /*check_sorted=*/true);
+    }
+
+    (*sorter)(data, data + len);
+  }
+
+  template <typename T>
+  std::optional<Sorter<T>>& sorter_for() {
+    if constexpr (std::is_same_v<T, int32_t>) {
+      return sorter_i32;
+    } else {
+      return sorter_u64;
+    }
+  }
+
+  ips4o::StdThreadPool thread_pool;
+  // The CPUs of every thread of the pool, empty if they are not pinned.
+  std::vector<std::vector<int>> thread_cpus;
+  std::optional<Sorter<int32_t>> sorter_i32;
+  std::optional<Sorter<uint64_t>> sorter_u64;
+};
+
+struct Ips4oPool {
+  enum Placement : uint32_t { Default = 0, NumaLocal = 1, NumaRemote = 2 };
+
+  Ips4oPool(int num_threads, Placement placement,
+            cpu_topology::Placement thread_placement =
+                cpu_topology::Placement::None)
+      : impl{make_impl(num_threads, placement, thread_placement)} {}
+
+  template <typename T>
+  void sort(T* data, size_t len) {
+    std::visit([data, len](auto& pool) { pool->sort(data, len); }, impl);
+  }
+
+  using Impl =
+      std::variant<std::unique_ptr<Ips4oPoolImpl<ips4o::DefaultAllocator>>,
+                   std::unique_ptr<Ips4oPoolImpl<NumaAllocator<false>>>,
+                   std::unique_ptr<Ips4oPoolImpl<NumaAllocator<true>>>>;
+
+  static Impl make_impl(int num_threads, Placement placement,
+                        cpu_topology::Placement thread_placement) {
+    switch (placement) {
+      case NumaLocal:
+        return std::make_unique<Ips4oPoolImpl<NumaAllocator<false>>>(
+            num_threads, thread_placement);
+      case NumaRemote:
+        return std::make_unique<Ips4oPoolImpl<NumaAllocator<true>>>(
+            num_threads, thread_placement);
+      default:
+        return std::make_unique<Ips4oPoolImpl<ips4o::DefaultAllocator>>(
+            num_threads, thread_placement);
+    }
+  }
+
+  Impl impl;
+};
+
+struct Ips4oAsyncJob {
+  enum Kind : uint32_t { I32 = 0, U64 = 1 };
+
+  Kind kind;
+  void* data;
+  size_t len;
+  void (*notify)(void*);
+  void* notify_ctx;
+
+  std::atomic<bool> done{false};
+  bool failed = false;
+
+  // Held by the submitter and the dispatcher, each gives up its reference
+  // once it no longer touches the job.
+  std::atomic<uint32_t> refs{2};
+
+  void unref() {
+    if (refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      delete this;
+    }
+  }
+};
+
+// Sorts submitted from any thread, queued and run one after the other on an
+// Ips4oPool by a dispatcher thread. The submitting thread only enqueues, it
+// can poll or wait for the job, or pass a callback that the dispatcher calls
+// once the job is done, e.g. to wake the task of an async runtime. Destroying
+// it finishes the queued jobs first.
+class Ips4oAsync {
+ public:
+  explicit Ips4oAsync(int num_threads)
+      : _pool{num_threads, Ips4oPool::Default},
+        _dispatcher{[this] { run(); }} {}
+
+  ~Ips4oAsync() {
+    {
+      std::lock_guard<std::mutex> lock{_mutex};
+      _stopping = true;
+    }
+    _queue_changed.notify_one();
+    _dispatcher.join();
+  }
+
+  void submit(Ips4oAsyncJob* job) {
+    {
+      std::lock_guard<std::mutex> lock{_mutex};
+      _queue.push_back(job);
+    }
+    _queue_changed.notify_one();
+  }
+
+ private:
+  void run() {
+    while (true) {
+      Ips4oAsyncJob* job;
+      {
+        std::unique_lock<std::mutex> lock{_mutex};
+        _queue_changed.wait(lock,
+                            [this] { return _stopping || !_queue.empty(); });
+        if (_queue.empty()) {
+          return;
+        }
+        job = _queue.front();
+        _queue.pop_front();
+      }
+
+      try {
+        if (job->kind == Ips4oAsyncJob::I32) {
+          _pool.sort(static_cast<int32_t*>(job->data), job->len);
+        } else {
+          _pool.sort(static_cast<uint64_t*>(job->data), job->len);
+        }
+      } catch (...) {
+        job->failed = true;
+      }
+
+      job->done.store(true, std::memory_order_release);
+      job->done.notify_all();
+
+      if (job->notify != nullptr) {
+        job->notify(job->notify_ctx);
+      }
+      job->unref();
+    }
+  }
+
+  Ips4oPool _pool;
+  std::mutex _mutex;
+  std::condition_variable _queue_changed;
+  std::deque<Ips4oAsyncJob*> _queue;
+  bool _stopping = false;
+  // Last, it uses all of the above.
+  std::thread _dispatcher;
+};
+
+extern "C" {
+// --- pool ---
+
+Ips4oPool* ips4o_pool_create(size_t num_threads) {
+  try {
+    return new Ips4oPool{static_cast<int>(num_threads), Ips4oPool::Default};
+  } catch (...) {
+    return nullptr;
+  }
+}
+
+// placement is one of Ips4oPool::Placement.
+Ips4oPool* ips4o_pool_create_numa(size_t num_threads, uint32_t placement) {
+  if (placement > Ips4oPool::NumaRemote) {
+    return nullptr;
+  }
+
+  try {
+    return new Ips4oPool{static_cast<int>(num_threads),
+                         static_cast<Ips4oPool::Placement>(placement)};
+  } catch (...) {
+    return nullptr;
+  }
+}
+
+// thread_placement is one of cpu_topology::Placement, the pool memory is
+// allocated as with Ips4oPool::Default.
+Ips4oPool* ips4o_pool_create_placed(size_t num_threads,
+                                    uint32_t thread_placement) {
+  if (thread_placement >
+      static_cast<uint32_t>(cpu_topology::Placement::PerCache)) {
+    return nullptr;
+  }
+
+  try {
+    return new Ips4oPool{
+        static_cast<int>(num_threads), Ips4oPool::Default,
+        static_cast<cpu_topology::Placement>(thread_placement)};
+  } catch (...) {
+    return nullptr;
+  }
+}
+
+void ips4o_pool_destroy(Ips4oPool* pool) {
+  delete pool;
+}
+
+// Returns 0 if the data was sorted, 1 if the sort failed, which leaves the data
+// in an unspecified order.
+uint32_t ips4o_pool_sort_i32(Ips4oPool* pool, int32_t* data, size_t len) {
+  SORT_USDT_PROBE(len);
+  try {
+    pool->sort(data, len);
+  } catch (...) {
+    return 1;
+  }
+
+  return 0;
+}
+
+uint32_t ips4o_pool_sort_u64(Ips4oPool* pool, uint64_t* data, size_t len) {
+  SORT_USDT_PROBE(len);
+  try {
+    pool->sort(data, len);
+  } catch (...) {
+    return 1;
+  }
+
+  return 0;
+}
+
+// --- async ---
+
+Ips4oAsync* ips4o_async_create(size_t num_threads) {
+  try {
+    return new Ips4oAsync{static_cast<int>(num_threads)};
+  } catch (...) {
+    return nullptr;
+  }
+}
+
+void ips4o_async_destroy(Ips4oAsync* async) {
+  delete async;
+}
+
+// kind is one of Ips4oAsyncJob::Kind, data points to len elements of that
+// type, which have to stay valid until the job is done. notify may be null,
+// otherwise it is called with notify_ctx from the dispatcher thread, after the
+// job is done. Returns null if kind is invalid or the job can't be allocated.
+Ips4oAsyncJob* ips4o_async_submit(Ips4oAsync* async,
+                                  uint32_t kind,
+                                  void* data,
+                                  size_t len,
+                                  void (*notify)(void*),
+                                  void* notify_ctx) {
+  if (kind > Ips4oAsyncJob::U64) {
+    return nullptr;
+  }
+
+  Ips4oAsyncJob* job = new (std::nothrow) Ips4oAsyncJob{
+      static_cast<Ips4oAsyncJob::Kind>(kind), data, len, notify, notify_ctx};
+  if (job == nullptr) {
+    return nullptr;
+  }
+
+  try {
+    async->submit(job);
+  } catch (...) {
+    delete job;
+    return nullptr;
+  }
+
+  return job;
+}
+
+bool ips4o_async_poll(const Ips4oAsyncJob* job) {
+  return job->done.load(std::memory_order_acquire);
+}
+
+// Blocks until the job is done. Returns 0 if it was sorted, 1 if the sort
+// failed, which leaves the data in an unspecified order.
+uint32_t ips4o_async_wait(const Ips4oAsyncJob* job) {
+  job->done.wait(false, std::memory_order_acquire);
+  return job->failed ? 1 : 0;
+}
+
+// The job must not be used afterwards. Releasing a job that isn't done yet
+// is fine, its data still has to stay valid until it is.
+void ips4o_async_release(Ips4oAsyncJob* job) {
+  job->unref();
+}
+
+// --- i32 ---
+
+void ips4o_parallel_unstable_i32(int32_t* data,
+                                 size_t len,
+                                 size_t num_threads) {
+  SORT_USDT_PROBE(len);
+  sort_parallel_impl(data, len, num_threads);
+}
+
+uint32_t ips4o_parallel_unstable_i32_by(int32_t* data,
+                                        size_t len,
+                                        CompResult (*cmp_fn)(const int32_t&,
+                                                             const int32_t&,
+                                                             uint8_t*),
+                                        uint8_t* ctx,
+                                        size_t num_threads) {
+  SORT_USDT_PROBE(len);
+  return sort_parallel_by_impl(data, len, cmp_fn, ctx, num_threads);
+}
+
+// See ips4o_unstable_i32_splitters.
+uint32_t ips4o_parallel_unstable_i32_splitters(int32_t* data,
+                                               size_t len,
+                                               int32_t* quantiles,
+                                               bool valid,
+                                               size_t num_threads) {
+  SORT_USDT_PROBE(len);
+  return sort_parallel_splitters_impl(data, len, quantiles, valid,
+                                      num_threads);
+}
+
+// --- u64 ---
+
+void ips4o_parallel_unstable_u64(uint64_t* data,
+                                 size_t len,
+                                 size_t num_threads) {
+  SORT_USDT_PROBE(len);
+  sort_parallel_impl(data, len, num_threads);
+}
+
+uint32_t ips4o_parallel_unstable_u64_by(uint64_t* data,
+                                        size_t len,
+                                        CompResult (*cmp_fn)(const uint64_t&,
+                                                             const uint64_t&,
+                                                             uint8_t*),
+                                        uint8_t* ctx,
+                                        size_t num_threads) {
+  SORT_USDT_PROBE(len);
+  return sort_parallel_by_impl(data, len, cmp_fn, ctx, num_threads);
+}
+
+uint32_t ips4o_parallel_unstable_u64_splitters(uint64_t* data,
+                                               size_t len,
+                                               uint64_t* quantiles,
+                                               bool valid,
+                                               size_t num_threads) {
+  SORT_USDT_PROBE(len);
+  return sort_parallel_splitters_impl(data, len, quantiles, valid,
+                                      num_threads);
+}
+
+void ips4o_parallel_unstable_u64_batch(uint64_t* data,
+                                       const size_t* offsets,
+                                       size_t n_slices,
+                                       size_t num_threads) {
+  sort_batch_parallel_impl(data, offsets, n_slices, num_threads);
+}
+
+// --- ffi_string ---
+
+void ips4o_parallel_unstable_ffi_string(FFIString* data,
+                                        size_t len,
+                                        size_t num_threads) {
+  SORT_USDT_PROBE(len);
+  sort_parallel_impl(reinterpret_cast<FFIStringCpp*>(data), len, num_threads);
+}
+
+uint32_t ips4o_parallel_unstable_ffi_string_by(
+    FFIString* data,
+    size_t len,
+    CompResult (*cmp_fn)(const FFIString&, const FFIString&, uint8_t*),
+    uint8_t* ctx,
+    size_t num_threads) {
+  SORT_USDT_PROBE(len);
+  return sort_parallel_by_impl(reinterpret_cast<FFIStringCpp*>(data), len,
+                               cmp_fn, ctx, num_threads);
+}
+
+// --- f128 ---
+
+void ips4o_parallel_unstable_f128(F128* data, size_t len, size_t num_threads) {
+  SORT_USDT_PROBE(len);
+  sort_parallel_impl(reinterpret_cast<F128Cpp*>(data), len, num_threads);
+}
+
+uint32_t ips4o_parallel_unstable_f128_by(F128* data,
+                                         size_t len,
+                                         CompResult (*cmp_fn)(const F128&,
+                                                              const F128&,
+                                                              uint8_t*),
+                                         uint8_t* ctx,
+                                         size_t num_threads) {
+  SORT_USDT_PROBE(len);
+  return sort_parallel_by_impl(reinterpret_cast<F128Cpp*>(data), len, cmp_fn,
+                               ctx, num_threads);
+}
+
+// --- 1k ---
+
+void ips4o_parallel_unstable_1k(FFIOneKibiByte* data,
+                                size_t len,
+                                size_t num_threads) {
+  SORT_USDT_PROBE(len);
+  sort_parallel_impl(reinterpret_cast<FFIOneKiloByteCpp*>(data), len,
+                     num_threads);
+}
+
+uint32_t ips4o_parallel_unstable_1k_by(
+    FFIOneKibiByte* data,
+    size_t len,
+    CompResult (*cmp_fn)(const FFIOneKibiByte&,
+                         const FFIOneKibiByte&,
+                         uint8_t*),
+    uint8_t* ctx,
+    size_t num_threads) {
+  SORT_USDT_PROBE(len);
+  return sort_parallel_by_impl(reinterpret_cast<FFIOneKiloByteCpp*>(data), len,
+                               cmp_fn, ctx, num_threads);
+}
 }  // extern "C"
+
+#endif  // IPS4O_PARALLEL
+
+#if defined(IPS4O_TIMER)
+
+#if defined(IPS4O_PARALLEL)
+#define IPS4O_TIMER_FN(name) ips4o_parallel_unstable_timer_##name
+#else
+#define IPS4O_TIMER_FN(name) ips4o_unstable_timer_##name
+#endif
+
+extern "C" {
+// phase_ns has to hold ips4o_timer::kNumPhases values.
+void IPS4O_TIMER_FN(read)(uint64_t* phase_ns) {
+  ips4o_timer::read(phase_ns);
+}
+
+void IPS4O_TIMER_FN(reset)() {
+  ips4o_timer::reset();
+}
+}  // extern "C"
+
+#endif  // IPS4O_TIMER
+
+#if defined(SORT_TELEMETRY)
+
+#if defined(IPS4O_PARALLEL)
+SORT_TELEMETRY_EXPORT(ips4o_parallel_unstable)
+#else
+SORT_TELEMETRY_EXPORT(ips4o_unstable)
+#endif
+
+#endif  // SORT_TELEMETRY
@@ -0,0 +1,7 @@
+// The instantiations of ips4o_instantiation.h, compiled separately from
+// cpp_ips4o.cpp with CPP_SPLIT_INSTANTIATION. Changes to the wrapper then don't
+// recompile them, and both compile in parallel.
+
+#include "ips4o_instantiation.h"
+
+IPS4O_INSTANTIATE_COMMON()
@@ -1,5 +1,14 @@
+#ifdef SMALL_SORT_NETWORK
+#include "small_sort_network.h"
+#endif
 #include "thirdparty/nanosort/nanosort.hpp"
 
+#ifdef SMALL_SORT_NETWORK
+template <typename T>
+struct small_sort_network::is_natural_less<nanosort_detail::Less, T>
+    : std::true_type {};
+#endif
+
 #include <stdexcept>
 
 #include <stdint.h>
@@ -11,10 +20,42 @@
 
 #include "shared.h"
 
-template <typename T, typename F>
+#ifdef RUN_PREPASS
+#include "run_prepass.h"
+#endif
+
+namespace {
+struct Nanosort {
+  template <typename It, typename Compare>
+  static void sort(It begin, It end, Compare comp) {
+    nanosort(begin, end, comp);
+  }
+};
+
+// nanosort with the equal element handling of pdqsort, see sort_fat.
+struct NanosortFat {
+  template <typename It, typename Compare>
+  static void sort(It begin, It end, Compare comp) {
+    nanosort_fat(begin, end, comp);
+  }
+};
+
+template <typename Sort = Nanosort,
+          typename T,
+          typename Compare = nanosort_detail::Less>
+void sort_impl(T* data, size_t len, Compare comp = {}) {
+#ifdef RUN_PREPASS
+  run_prepass::sort<Sort>(data, len, comp);
+#else
+  Sort::sort(data, data + len, comp);
+#endif
+}
+}  // namespace
+
+template <typename Sort = Nanosort, typename T, typename F>
 uint32_t sort_by_impl(T* data, size_t len, F cmp_fn, uint8_t* ctx) noexcept {
   try {
-    nanosort(data, data + len, make_compare_fn<T>(cmp_fn, ctx));
+    sort_impl<Sort>(data, len, make_compare_fn<T>(cmp_fn, ctx));
   } catch (...) {
     return 1;
   }
@@ -22,11 +63,28 @@ uint32_t sort_by_impl(T* data, size_t len, F cmp_fn, uint8_t* ctx) noexcept {
   return 0;
 }
 
+// Entry points nanosort_fat_unstable_<type>.
+#define FAT_IMPL(TYPE_NAME, TYPE, CPP_TYPE)                               \
+  void nanosort_fat_unstable_##TYPE_NAME(TYPE* data, size_t len) {       \
+    SORT_USDT_PROBE(len);                                                \
+    sort_impl<NanosortFat>(reinterpret_cast<CPP_TYPE*>(data), len);      \
+  }                                                                      \
+                                                                         \
+  uint32_t nanosort_fat_unstable_##TYPE_NAME##_by(                       \
+      TYPE* data, size_t len,                                            \
+      CompResult (*cmp_fn)(const TYPE&, const TYPE&, uint8_t*),          \
+      uint8_t* ctx) {                                                    \
+    SORT_USDT_PROBE(len);                                                \
+    return sort_by_impl<NanosortFat>(reinterpret_cast<CPP_TYPE*>(data),  \
+                                     len, cmp_fn, ctx);                  \
+  }
+
 extern "C" {
 // --- i32 ---
 
 void nanosort_unstable_i32(int32_t* data, size_t len) {
-  nanosort(data, data + len);
+  SORT_USDT_PROBE(len);
+  sort_impl(data, len);
 }
 
 uint32_t nanosort_unstable_i32_by(int32_t* data,
@@ -35,13 +93,15 @@ uint32_t nanosort_unstable_i32_by(int32_t* data,
                                                        const int32_t&,
                                                        uint8_t*),
                                   uint8_t* ctx) {
+  SORT_USDT_PROBE(len);
   return sort_by_impl(data, len, cmp_fn, ctx);
 }
 
 // --- u64 ---
 
 void nanosort_unstable_u64(uint64_t* data, size_t len) {
-  nanosort(data, data + len);
+  SORT_USDT_PROBE(len);
+  sort_impl(data, len);
 }
 
 uint32_t nanosort_unstable_u64_by(uint64_t* data,
@@ -50,14 +110,15 @@ uint32_t nanosort_unstable_u64_by(uint64_t* data,
                                                        const uint64_t&,
                                                        uint8_t*),
                                   uint8_t* ctx) {
+  SORT_USDT_PROBE(len);
   return sort_by_impl(data, len, cmp_fn, ctx);
 }
 
 // --- ffi_string ---
 
 void nanosort_unstable_ffi_string(FFIString* data, size_t len) {
-  nanosort(reinterpret_cast<FFIStringCpp*>(data),
-           reinterpret_cast<FFIStringCpp*>(data) + len);
+  SORT_USDT_PROBE(len);
+  sort_impl(reinterpret_cast<FFIStringCpp*>(data), len);
 }
 
 uint32_t nanosort_unstable_ffi_string_by(FFIString* data,
@@ -66,14 +127,15 @@ uint32_t nanosort_unstable_ffi_string_by(FFIString* data,
                                                               const FFIString&,
                                                               uint8_t*),
                                          uint8_t* ctx) {
+  SORT_USDT_PROBE(len);
   return sort_by_impl(reinterpret_cast<FFIStringCpp*>(data), len, cmp_fn, ctx);
 }
 
 // --- f128 ---
 
 void nanosort_unstable_f128(F128* data, size_t len) {
-  nanosort(reinterpret_cast<F128Cpp*>(data),
-           reinterpret_cast<F128Cpp*>(data) + len);
+  SORT_USDT_PROBE(len);
+  sort_impl(reinterpret_cast<F128Cpp*>(data), len);
 }
 
 uint32_t nanosort_unstable_f128_by(F128* data,
@@ -82,14 +144,15 @@ uint32_t nanosort_unstable_f128_by(F128* data,
                                                         const F128&,
                                                         uint8_t*),
                                    uint8_t* ctx) {
+  SORT_USDT_PROBE(len);
   return sort_by_impl(reinterpret_cast<F128Cpp*>(data), len, cmp_fn, ctx);
 }
 
 // --- 1k ---
 
 void nanosort_unstable_1k(FFIOneKibiByte* data, size_t len) {
-  nanosort(reinterpret_cast<FFIOneKiloByteCpp*>(data),
-           reinterpret_cast<FFIOneKiloByteCpp*>(data) + len);
+  SORT_USDT_PROBE(len);
+  sort_impl(reinterpret_cast<FFIOneKiloByteCpp*>(data), len);
 }
 
 uint32_t nanosort_unstable_1k_by(FFIOneKibiByte* data,
@@ -98,7 +161,22 @@ uint32_t nanosort_unstable_1k_by(FFIOneKibiByte* data,
                                                       const FFIOneKibiByte&,
                                                       uint8_t*),
                                  uint8_t* ctx) {
+  SORT_USDT_PROBE(len);
   return sort_by_impl(reinterpret_cast<FFIOneKiloByteCpp*>(data), len, cmp_fn,
                       ctx);
 }
+
+// --- fat partition variant ---
+
+FAT_IMPL(i32, int32_t, int32_t)
+FAT_IMPL(u64, uint64_t, uint64_t)
+FAT_IMPL(ffi_string, FFIString, FFIStringCpp)
+FAT_IMPL(f128, F128, F128Cpp)
+FAT_IMPL(1k, FFIOneKibiByte, FFIOneKiloByteCpp)
+
+// --- nothrow ---
+
+NOTHROW_SORT_BY_IMPL(nanosort_unstable, [](auto begin, auto end, auto comp) {
+  sort_impl(begin, end - begin, comp);
+})
 }  // extern "C"
@@ -0,0 +1,23 @@
+// Entry points for the generated fixed length sorting networks, see
+// fixed_network_sort.h. One per length, for call sites that know the length at
+// compile time, and a dispatch over the length for the others.
+
+#include <stdint.h>
+
+#include "fixed_network_sort.h"
+#include "sort_usdt.h"
+
+#define NETWORK_SORT_U64_N(N)                  \
+  void network_sort_u64_n##N(uint64_t* data) { \
+    fixed_network_sort::sort<N>(data);         \
+  }
+
+extern "C" {
+FIXED_NETWORK_SORT_FOR_EACH_LEN(NETWORK_SORT_U64_N)
+
+// Returns 1 without touching data if len is larger than FIXED_NETWORK_MAX_LEN.
+uint32_t network_sort_u64(uint64_t* data, size_t len) {
+  SORT_USDT_PROBE(len);
+  return fixed_network_sort::sort_dispatch(data, len) ? 0 : 1;
+}
+}  // extern "C"
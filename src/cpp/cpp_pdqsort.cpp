@@ -1,9 +1,18 @@
+#ifdef SMALL_SORT_NETWORK
+#include "small_sort_network.h"
+#endif
+// Has to come before pdqsort.h, the SORT_TELEMETRY hooks call into it.
+#include "sort_telemetry.h"
 #include "thirdparty/pdqsort/pdqsort.h"
 
+#include <algorithm>
 #include <stdexcept>
+#include <vector>
 
 #include <stdint.h>
 
+#include "lomcyc_partition.h"
+#include "run_accumulator.h"
 #include "shared.h"
 
 template <typename T, typename F>
@@ -17,10 +26,692 @@ uint32_t sort_by_impl(T* data, size_t len, F cmp_fn, uint8_t* ctx) noexcept {
   return 0;
 }
 
+template <typename T>
+uint32_t sort_by_key_impl(T* data, size_t len, KeyDescriptor key) noexcept {
+  const bool is_valid_key = with_key_compare<T>(
+      key, [data, len](auto comp) { pdqsort(data, data + len, comp); });
+
+  return is_valid_key ? 0 : 1;
+}
+
+// Same loop as pdqsort_loop, with the lomcyc partition of lomcyc_partition.h
+// instead of partition_right.
+template <typename T, typename Compare>
+void pdqsort_lomcyc_loop(T* begin,
+                         T* end,
+                         Compare comp,
+                         int bad_allowed,
+                         bool leftmost = true) {
+  using namespace pdqsort_detail;
+
+  while (true) {
+    const ptrdiff_t size = end - begin;
+
+    if (size < insertion_sort_threshold) {
+#ifdef SMALL_SORT_NETWORK
+      if (small_sort_network::try_sort(begin, end, comp)) {
+        return;
+      }
+#endif
+      if (leftmost) {
+        insertion_sort(begin, end, comp);
+      } else {
+        unguarded_insertion_sort(begin, end, comp);
+      }
+      return;
+    }
+
+    const ptrdiff_t s2 = size / 2;
+    if (size > ninther_threshold) {
+      sort3(begin, begin + s2, end - 1, comp);
+      sort3(begin + 1, begin + (s2 - 1), end - 2, comp);
+      sort3(begin + 2, begin + (s2 + 1), end - 3, comp);
+      sort3(begin + (s2 - 1), begin + s2, begin + (s2 + 1), comp);
+      std::iter_swap(begin, begin + s2);
+    } else {
+      sort3(begin + s2, begin, end - 1, comp);
+    }
+
+    if (!leftmost && !comp(*(begin - 1), *begin)) {
+      begin = partition_left(begin, end, comp) + 1;
+      continue;
+    }
+
+    const std::pair<T*, bool> part_result =
+        lomcyc::partition_right(begin, end, comp);
+    T* pivot_pos = part_result.first;
+    const bool already_partitioned = part_result.second;
+
+    const ptrdiff_t l_size = pivot_pos - begin;
+    const ptrdiff_t r_size = end - (pivot_pos + 1);
+
+    if (l_size < size / 8 || r_size < size / 8) {
+      if (--bad_allowed == 0) {
+        std::make_heap(begin, end, comp);
+        std::sort_heap(begin, end, comp);
+        return;
+      }
+
+      if (l_size >= insertion_sort_threshold) {
+        std::iter_swap(begin, begin + l_size / 4);
+        std::iter_swap(pivot_pos - 1, pivot_pos - l_size / 4);
+
+        if (l_size > ninther_threshold) {
+          std::iter_swap(begin + 1, begin + (l_size / 4 + 1));
+          std::iter_swap(begin + 2, begin + (l_size / 4 + 2));
+          std::iter_swap(pivot_pos - 2, pivot_pos - (l_size / 4 + 1));
+          std::iter_swap(pivot_pos - 3, pivot_pos - (l_size / 4 + 2));
+        }
+      }
+
+      if (r_size >= insertion_sort_threshold) {
+        std::iter_swap(pivot_pos + 1, pivot_pos + (1 + r_size / 4));
+        std::iter_swap(end - 1, end - r_size / 4);
+
+        if (r_size > ninther_threshold) {
+          std::iter_swap(pivot_pos + 2, pivot_pos + (2 + r_size / 4));
+          std::iter_swap(pivot_pos + 3, pivot_pos + (3 + r_size / 4));
+          std::iter_swap(end - 2, end - (1 + r_size / 4));
+          std::iter_swap(end - 3, end - (2 + r_size / 4));
+        }
+      }
+    } else if (already_partitioned &&
+               partial_insertion_sort(begin, pivot_pos, comp) &&
+               partial_insertion_sort(pivot_pos + 1, end, comp)) {
+      return;
+    }
+
+    pdqsort_lomcyc_loop(begin, pivot_pos, comp, bad_allowed, leftmost);
+    begin = pivot_pos + 1;
+    leftmost = false;
+  }
+}
+
+enum class ForcedPartition { Branchy, Branchless, Lomcyc };
+
+// pdqsort only picks the branchless partition for arithmetic types with the
+// default comparison, this forces one partition for any type and comparison.
+template <ForcedPartition Partition,
+          typename T,
+          typename Compare = std::less<T>>
+void pdqsort_forced(T* data, size_t len, Compare comp = {}) {
+  if (len == 0) {
+    return;
+  }
+
+  const int bad_allowed = pdqsort_detail::log2(static_cast<ptrdiff_t>(len));
+  if constexpr (Partition == ForcedPartition::Lomcyc) {
+    pdqsort_lomcyc_loop(data, data + len, comp, bad_allowed);
+  } else {
+    pdqsort_detail::pdqsort_loop<T*, Compare,
+                                 Partition == ForcedPartition::Branchless>(
+        data, data + len, comp, bad_allowed);
+  }
+}
+
+template <ForcedPartition Partition, typename T, typename F>
+uint32_t sort_forced_by_impl(T* data,
+                             size_t len,
+                             F cmp_fn,
+                             uint8_t* ctx) noexcept {
+  try {
+    pdqsort_forced<Partition>(data, len, make_compare_fn<T>(cmp_fn, ctx));
+  } catch (...) {
+    return 1;
+  }
+
+  return 0;
+}
+
+// Entry points pdqsort_branchy_unstable_<type>,
+// pdqsort_branchless_unstable_<type> and pdqsort_lomcyc_unstable_<type>.
+#define FORCED_IMPL(VARIANT, PARTITION, TYPE_NAME, TYPE, CPP_TYPE)           \
+  void pdqsort_##VARIANT##_unstable_##TYPE_NAME(TYPE* data, size_t len) {    \
+    SORT_USDT_PROBE(len);                                                    \
+    pdqsort_forced<PARTITION>(reinterpret_cast<CPP_TYPE*>(data), len);       \
+  }                                                                          \
+                                                                             \
+  uint32_t pdqsort_##VARIANT##_unstable_##TYPE_NAME##_by(                    \
+      TYPE* data, size_t len,                                                \
+      CompResult (*cmp_fn)(const TYPE&, const TYPE&, uint8_t*),              \
+      uint8_t* ctx) {                                                        \
+    SORT_USDT_PROBE(len);                                                    \
+    return sort_forced_by_impl<PARTITION>(reinterpret_cast<CPP_TYPE*>(data), \
+                                          len, cmp_fn, ctx);                 \
+  }
+
+#define FORCED_IMPL_ALL_TYPES(VARIANT, PARTITION)                        \
+  FORCED_IMPL(VARIANT, PARTITION, i32, int32_t, int32_t)                 \
+  FORCED_IMPL(VARIANT, PARTITION, u64, uint64_t, uint64_t)               \
+  FORCED_IMPL(VARIANT, PARTITION, ffi_string, FFIString, FFIStringCpp)   \
+  FORCED_IMPL(VARIANT, PARTITION, f128, F128, F128Cpp)                   \
+  FORCED_IMPL(VARIANT, PARTITION, 1k, FFIOneKibiByte, FFIOneKiloByteCpp) \
+  FORCED_IMPL(VARIANT, PARTITION, i16, int16_t, int16_t)                 \
+  FORCED_IMPL(VARIANT, PARTITION, u16, uint16_t, uint16_t)               \
+  FORCED_IMPL(VARIANT, PARTITION, f32, F32, F32Cpp)                      \
+  FORCED_IMPL(VARIANT, PARTITION, f64, F64, F64Cpp)
+
+template <typename T, typename F>
+uint32_t lomcyc_partition_by_impl(T* data,
+                                  size_t len,
+                                  const T* pivot,
+                                  F cmp_fn,
+                                  uint8_t* ctx,
+                                  size_t* lt_count) noexcept {
+  try {
+    *lt_count = lomcyc::partition(data, data + len, *pivot,
+                                  make_compare_fn<T>(cmp_fn, ctx));
+  } catch (...) {
+    return 1;
+  }
+
+  return 0;
+}
+
+// Entry points lomcyc_partition_<type>, used by the partition benchmarks.
+#define LOMCYC_PARTITION_IMPL(TYPE_NAME, TYPE, CPP_TYPE)                      \
+  size_t lomcyc_partition_##TYPE_NAME(TYPE* data, size_t len,                 \
+                                      const TYPE* pivot) {                    \
+    SORT_USDT_PROBE(len);                                                     \
+    return lomcyc::partition(reinterpret_cast<CPP_TYPE*>(data),               \
+                             reinterpret_cast<CPP_TYPE*>(data) + len,         \
+                             *reinterpret_cast<const CPP_TYPE*>(pivot),       \
+                             std::less<CPP_TYPE>{});                          \
+  }                                                                           \
+                                                                              \
+  uint32_t lomcyc_partition_##TYPE_NAME##_by(                                 \
+      TYPE* data, size_t len, const TYPE* pivot,                              \
+      CompResult (*cmp_fn)(const TYPE&, const TYPE&, uint8_t*), uint8_t* ctx, \
+      size_t* lt_count) {                                                     \
+    SORT_USDT_PROBE(len);                                                     \
+    return lomcyc_partition_by_impl(data, len, pivot, cmp_fn, ctx, lt_count); \
+  }
+
+// partition_right_branchless relies on the median of 3 to leave an element
+// that is not less than the pivot behind it, which stops the first scan.
+template <typename T>
+size_t pdqsort_partition_impl(T* data, size_t len, const T& pivot) {
+  return partition_with_pivot_at_begin(
+      data, len, pivot, [](T* data, size_t len) -> size_t {
+        T* last = data + len - 1;
+        T* sentinel = last;
+        while (sentinel > data && *sentinel < data[0]) {
+          --sentinel;
+        }
+
+        if (sentinel == data) {
+          // Every other element is less than the pivot.
+          std::iter_swap(data, last);
+          return len - 1;
+        }
+
+        std::iter_swap(sentinel, last);
+        return pdqsort_detail::partition_right_branchless(data, data + len,
+                                                          std::less<T>{})
+                   .first -
+               data;
+      });
+}
+
+// Same loop as pdqsort_loop, except that it only descends into the partitions
+// that overlap [begin, k_end). Partitions that lie fully inside of the prefix
+// are handed to the regular pdqsort loop, everything past k_end is left as is.
+template <typename T, typename Compare, bool Branchless>
+void pdqsort_partial_loop(T* begin,
+                          T* end,
+                          T* k_end,
+                          Compare comp,
+                          int bad_allowed,
+                          bool leftmost = true) {
+  using namespace pdqsort_detail;
+
+  while (true) {
+    const ptrdiff_t size = end - begin;
+
+    if (size < insertion_sort_threshold) {
+#ifdef SMALL_SORT_NETWORK
+      if (small_sort_network::try_sort(begin, end, comp)) {
+        return;
+      }
+#endif
+      if (leftmost) {
+        insertion_sort(begin, end, comp);
+      } else {
+        unguarded_insertion_sort(begin, end, comp);
+      }
+      return;
+    }
+
+    const ptrdiff_t s2 = size / 2;
+    if (size > ninther_threshold) {
+      sort3(begin, begin + s2, end - 1, comp);
+      sort3(begin + 1, begin + (s2 - 1), end - 2, comp);
+      sort3(begin + 2, begin + (s2 + 1), end - 3, comp);
+      sort3(begin + (s2 - 1), begin + s2, begin + (s2 + 1), comp);
+      std::iter_swap(begin, begin + s2);
+    } else {
+      sort3(begin + s2, begin, end - 1, comp);
+    }
+
+    // Everything left of the new begin is equal to *(begin - 1) and as such
+    // already in its final position.
+    if (!leftmost && !comp(*(begin - 1), *begin)) {
+      begin = partition_left(begin, end, comp) + 1;
+      if (begin >= k_end) {
+        return;
+      }
+      continue;
+    }
+
+    const std::pair<T*, bool> part_result =
+        Branchless ? partition_right_branchless(begin, end, comp)
+                   : partition_right(begin, end, comp);
+    T* pivot_pos = part_result.first;
+
+    const ptrdiff_t l_size = pivot_pos - begin;
+    const ptrdiff_t r_size = end - (pivot_pos + 1);
+
+    if (l_size < size / 8 || r_size < size / 8) {
+      if (--bad_allowed == 0) {
+        std::partial_sort(begin, std::min(k_end, end), end, comp);
+        return;
+      }
+
+      if (l_size >= insertion_sort_threshold) {
+        std::iter_swap(begin, begin + l_size / 4);
+        std::iter_swap(pivot_pos - 1, pivot_pos - l_size / 4);
+      }
+
+      if (r_size >= insertion_sort_threshold) {
+        std::iter_swap(pivot_pos + 1, pivot_pos + (1 + r_size / 4));
+        std::iter_swap(end - 1, end - r_size / 4);
+      }
+    }
+
+    if (pivot_pos >= k_end) {
+      // The prefix ends inside of the left partition.
+      end = pivot_pos;
+      continue;
+    }
+
+    pdqsort_loop<T*, Compare, Branchless>(begin, pivot_pos, comp, bad_allowed,
+                                          leftmost);
+
+    begin = pivot_pos + 1;
+    leftmost = false;
+    if (begin >= k_end) {
+      return;
+    }
+  }
+}
+
+// Sorts the k smallest elements into [data, data + k), the order of the
+// remaining elements is unspecified.
+template <typename T>
+void partial_sort_impl(T* data, size_t len, size_t k) noexcept {
+  if (k == 0) {
+    return;
+  }
+
+  using Compare = std::less<T>;
+  constexpr bool branchless = std::is_arithmetic<T>::value;
+
+  pdqsort_partial_loop<T, Compare, branchless>(
+      data, data + len, data + k, Compare{},
+      pdqsort_detail::log2(static_cast<ptrdiff_t>(len)));
+}
+
+// Incremental quicksort, sorting on demand. Every call to advance() refines
+// only the leftmost unsorted partition, until at least the next element of the
+// sorted order is in place. Reading the first k elements of n costs about
+// O(n + k log k), reading all of them about as much as a full pdqsort.
+template <typename T>
+class LazySort {
+ public:
+  LazySort(T* data, size_t len) : _data{data}, _len{len} {
+    if (len > 0) {
+      _bounds.push_back(
+          {len, pdqsort_detail::log2(static_cast<ptrdiff_t>(len))});
+    }
+  }
+
+  // Extends the sorted prefix by at least one element, unless it covers the
+  // whole input already, and returns its new length. The sorted prefix is
+  // never touched again.
+  size_t advance() {
+    using namespace pdqsort_detail;
+    using Compare = std::less<T>;
+    constexpr bool branchless = std::is_arithmetic<T>::value;
+    const Compare comp{};
+
+    const size_t sorted_end = _sorted_end;
+    while (_sorted_end == sorted_end && !_bounds.empty()) {
+      T* begin = _data + _sorted_end;
+      T* end = _data + _bounds.back().end;
+      const ptrdiff_t size = end - begin;
+      // Otherwise *(begin - 1) is in place and not greater than anything in
+      // the partition, the same invariant pdqsort_loop relies on.
+      const bool leftmost = _sorted_end == 0;
+
+      if (size < insertion_sort_threshold) {
+        if (leftmost) {
+          insertion_sort(begin, end, comp);
+        } else {
+          unguarded_insertion_sort(begin, end, comp);
+        }
+        finish_up_to(end);
+        continue;
+      }
+
+      const ptrdiff_t s2 = size / 2;
+      if (size > ninther_threshold) {
+        sort3(begin, begin + s2, end - 1, comp);
+        sort3(begin + 1, begin + (s2 - 1), end - 2, comp);
+        sort3(begin + 2, begin + (s2 + 1), end - 3, comp);
+        sort3(begin + (s2 - 1), begin + s2, begin + (s2 + 1), comp);
+        std::iter_swap(begin, begin + s2);
+      } else {
+        sort3(begin + s2, begin, end - 1, comp);
+      }
+
+      // Everything left of the returned pivot is equal to *(begin - 1).
+      if (!leftmost && !comp(*(begin - 1), *begin)) {
+        finish_up_to(partition_left(begin, end, comp) + 1);
+        continue;
+      }
+
+      const std::pair<T*, bool> part_result =
+          branchless ? partition_right_branchless(begin, end, comp)
+                     : partition_right(begin, end, comp);
+      T* pivot_pos = part_result.first;
+      const bool already_partitioned = part_result.second;
+
+      const ptrdiff_t l_size = pivot_pos - begin;
+      const ptrdiff_t r_size = end - (pivot_pos + 1);
+
+      if (l_size < size / 8 || r_size < size / 8) {
+        if (--_bounds.back().bad_allowed == 0) {
+          // Gives up on laziness for this partition, pdqsort keeps the whole
+          // thing O(n log n).
+          pdqsort_loop<T*, Compare, branchless>(begin, end, comp,
+                                                pdqsort_detail::log2(size),
+                                                leftmost);
+          finish_up_to(end);
+          continue;
+        }
+
+        if (l_size >= insertion_sort_threshold) {
+          std::iter_swap(begin, begin + l_size / 4);
+          std::iter_swap(pivot_pos - 1, pivot_pos - l_size / 4);
+        }
+
+        if (r_size >= insertion_sort_threshold) {
+          std::iter_swap(pivot_pos + 1, pivot_pos + (1 + r_size / 4));
+          std::iter_swap(end - 1, end - r_size / 4);
+        }
+      } else if (already_partitioned &&
+                 partial_insertion_sort(begin, pivot_pos, comp)) {
+        // The right partition is left for later.
+        finish_up_to(pivot_pos + 1);
+        continue;
+      }
+
+      // The left partition goes on top, both continue with what is left of
+      // the bad partitions allowance, as in pdqsort_loop.
+      _bounds.push_back(
+          {static_cast<size_t>(pivot_pos - _data), _bounds.back().bad_allowed});
+      finish_up_to(begin);
+    }
+
+    return _sorted_end;
+  }
+
+ private:
+  // Everything before sorted_end is in place. Drops the partitions that
+  // became empty, and the pivots that end them.
+  void finish_up_to(T* sorted_end) {
+    _sorted_end = sorted_end - _data;
+    while (!_bounds.empty() && _bounds.back().end == _sorted_end) {
+      _bounds.pop_back();
+      // Every bound but the last one is the position of a pivot.
+      if (_sorted_end < _len) {
+        _sorted_end += 1;
+      }
+    }
+  }
+
+  struct Bound {
+    size_t end;
+    int bad_allowed;
+  };
+
+  T* _data;
+  size_t _len;
+  size_t _sorted_end = 0;
+  // Ends of the partitions after the sorted prefix, the leftmost one on top.
+  // No element of a partition is less than any element before it.
+  std::vector<Bound> _bounds;
+};
+
+// Entry points pdqsort_unstable_<type>_lazy_{new,advance,free}. The data must
+// outlive the lazy sort and must not be modified in between.
+#define LAZY_SORT_IMPL(TYPE_NAME, TYPE, CPP_TYPE)                             \
+  void* pdqsort_unstable_##TYPE_NAME##_lazy_new(TYPE* data, size_t len) {     \
+    return new LazySort<CPP_TYPE>{reinterpret_cast<CPP_TYPE*>(data), len};    \
+  }                                                                           \
+                                                                              \
+  size_t pdqsort_unstable_##TYPE_NAME##_lazy_advance(void* lazy) {            \
+    return static_cast<LazySort<CPP_TYPE>*>(lazy)->advance();                 \
+  }                                                                           \
+                                                                              \
+  void pdqsort_unstable_##TYPE_NAME##_lazy_free(void* lazy) {                 \
+    delete static_cast<LazySort<CPP_TYPE>*>(lazy);                            \
+  }
+
+// Compacts the already sorted output of pdqsort_unique_loop to the front of
+// the input. Every element is swapped instead of overwritten, so the input
+// stays a permutation, with the duplicates behind the unique values. With
+// CountRuns counts[i] is the number of occurrences of the i-th unique value.
+template <typename T, typename Compare, bool CountRuns>
+class UniqueSink {
+ public:
+  UniqueSink(T* begin, Compare comp, size_t* counts)
+      : _begin{begin}, _out{begin}, _comp{comp}, _counts{counts} {}
+
+  // *it is not smaller than any previously emitted element, and it is not
+  // before the current output position.
+  void emit(T* it) {
+    const bool is_new = _out == _begin || _comp(*(_out - 1), *it);
+    // A no-op if nothing was dropped yet, otherwise puts the duplicate at _out
+    // behind the unique values.
+    std::iter_swap(_out, it);
+    _out += is_new;
+
+    if constexpr (CountRuns) {
+      const size_t last = unique_len() - 1;
+      _counts[last] = is_new ? 1 : _counts[last] + 1;
+    }
+  }
+
+  void emit_sorted(T* begin, T* end) {
+    for (; begin < end; ++begin) {
+      emit(begin);
+    }
+  }
+
+  // n elements that compare equal to the last emitted one.
+  void skip_duplicates(size_t n) {
+    if constexpr (CountRuns) {
+      _counts[unique_len() - 1] += n;
+    }
+  }
+
+  size_t unique_len() const { return _out - _begin; }
+
+ private:
+  T* _begin;
+  T* _out;
+  Compare _comp;
+  size_t* _counts;
+};
+
+// Same loop as pdqsort_loop, except that every finished part is handed to the
+// sink right away, while it's still in cache. pdqsort finishes the input
+// strictly from left to right: the left partition, the pivot, the right
+// partition. So the sink sees the sorted sequence in order, and the runs of
+// elements equal to the previous pivot that partition_left puts aside are
+// dropped without looking at them again.
+//
+// The sink only writes to positions left of begin. The element at begin - 1
+// may change, but only to a value that is not larger and compares equal to
+// the new pivot only if the old one did, that keeps partition_left and the
+// unguarded insertion sort correct.
+template <typename T, typename Compare, bool Branchless, typename Sink>
+void pdqsort_unique_loop(T* begin,
+                         T* end,
+                         Compare comp,
+                         int bad_allowed,
+                         Sink& sink,
+                         bool leftmost = true) {
+  using namespace pdqsort_detail;
+
+  while (true) {
+    const ptrdiff_t size = end - begin;
+
+    if (size < insertion_sort_threshold) {
+#ifdef SMALL_SORT_NETWORK
+      if (!small_sort_network::try_sort(begin, end, comp))
+#endif
+      {
+        if (leftmost) {
+          insertion_sort(begin, end, comp);
+        } else {
+          unguarded_insertion_sort(begin, end, comp);
+        }
+      }
+      sink.emit_sorted(begin, end);
+      return;
+    }
+
+    const ptrdiff_t s2 = size / 2;
+    if (size > ninther_threshold) {
+      sort3(begin, begin + s2, end - 1, comp);
+      sort3(begin + 1, begin + (s2 - 1), end - 2, comp);
+      sort3(begin + 2, begin + (s2 + 1), end - 3, comp);
+      sort3(begin + (s2 - 1), begin + s2, begin + (s2 + 1), comp);
+      std::iter_swap(begin, begin + s2);
+    } else {
+      sort3(begin + s2, begin, end - 1, comp);
+    }
+
+    // Everything left of the new begin is equal to *(begin - 1), the last
+    // emitted element.
+    if (!leftmost && !comp(*(begin - 1), *begin)) {
+      T* const equal_end = partition_left(begin, end, comp) + 1;
+      sink.skip_duplicates(equal_end - begin);
+      begin = equal_end;
+      continue;
+    }
+
+    const std::pair<T*, bool> part_result =
+        Branchless ? partition_right_branchless(begin, end, comp)
+                   : partition_right(begin, end, comp);
+    T* pivot_pos = part_result.first;
+    const bool already_partitioned = part_result.second;
+
+    const ptrdiff_t l_size = pivot_pos - begin;
+    const ptrdiff_t r_size = end - (pivot_pos + 1);
+
+    if (l_size < size / 8 || r_size < size / 8) {
+      if (--bad_allowed == 0) {
+        std::make_heap(begin, end, comp);
+        std::sort_heap(begin, end, comp);
+        sink.emit_sorted(begin, end);
+        return;
+      }
+
+      if (l_size >= insertion_sort_threshold) {
+        std::iter_swap(begin, begin + l_size / 4);
+        std::iter_swap(pivot_pos - 1, pivot_pos - l_size / 4);
+      }
+
+      if (r_size >= insertion_sort_threshold) {
+        std::iter_swap(pivot_pos + 1, pivot_pos + (1 + r_size / 4));
+        std::iter_swap(end - 1, end - r_size / 4);
+      }
+    } else if (already_partitioned &&
+               partial_insertion_sort(begin, pivot_pos, comp) &&
+               partial_insertion_sort(pivot_pos + 1, end, comp)) {
+      sink.emit_sorted(begin, end);
+      return;
+    }
+
+    pdqsort_unique_loop<T, Compare, Branchless>(begin, pivot_pos, comp,
+                                                bad_allowed, sink, leftmost);
+    sink.emit(pivot_pos);
+
+    begin = pivot_pos + 1;
+    leftmost = false;
+  }
+}
+
+// Sorts data and moves the unique values to [data, data + unique_len), in
+// order. With counts, counts[i] is set to the number of occurrences of
+// data[i], it must have room for len values. Returns unique_len.
+template <typename T>
+size_t sort_unique_impl(T* data, size_t len, size_t* counts) noexcept {
+  if (len == 0) {
+    return 0;
+  }
+
+  using Compare = std::less<T>;
+  constexpr bool branchless = std::is_arithmetic<T>::value;
+  const int bad_allowed = pdqsort_detail::log2(static_cast<ptrdiff_t>(len));
+
+  if (counts == nullptr) {
+    UniqueSink<T, Compare, false> sink{data, Compare{}, nullptr};
+    pdqsort_unique_loop<T, Compare, branchless>(data, data + len, Compare{},
+                                                bad_allowed, sink);
+    return sink.unique_len();
+  }
+
+  UniqueSink<T, Compare, true> sink{data, Compare{}, counts};
+  pdqsort_unique_loop<T, Compare, branchless>(data, data + len, Compare{},
+                                              bad_allowed, sink);
+  return sink.unique_len();
+}
+
+// Entry points pdqsort_unstable_<type>_sort_unique and
+// pdqsort_unstable_<type>_sort_count_runs.
+#define SORT_UNIQUE_IMPL(TYPE_NAME, TYPE, CPP_TYPE)                       \
+  size_t pdqsort_unstable_##TYPE_NAME##_sort_unique(TYPE* data,           \
+                                                    size_t len) {         \
+    SORT_USDT_PROBE(len);                                                 \
+    return sort_unique_impl(reinterpret_cast<CPP_TYPE*>(data), len,       \
+                            nullptr);                                     \
+  }                                                                       \
+                                                                          \
+  size_t pdqsort_unstable_##TYPE_NAME##_sort_count_runs(                  \
+      TYPE* data, size_t len, size_t* counts) {                           \
+    SORT_USDT_PROBE(len);                                                 \
+    return sort_unique_impl(reinterpret_cast<CPP_TYPE*>(data), len,       \
+                            counts);                                      \
+  }
+
 extern "C" {
+SORT_UNIQUE_IMPL(i32, int32_t, int32_t)
+SORT_UNIQUE_IMPL(u64, uint64_t, uint64_t)
+SORT_UNIQUE_IMPL(ffi_string, FFIString, FFIStringCpp)
+
+LAZY_SORT_IMPL(i32, int32_t, int32_t)
+LAZY_SORT_IMPL(u64, uint64_t, uint64_t)
+LAZY_SORT_IMPL(ffi_string, FFIString, FFIStringCpp)
+LAZY_SORT_IMPL(f128, F128, F128Cpp)
+
 // --- i32 ---
 
 void pdqsort_unstable_i32(int32_t* data, size_t len) {
+  SORT_USDT_PROBE(len);
   pdqsort(data, data + len);
 }
 
@@ -30,12 +721,26 @@ uint32_t pdqsort_unstable_i32_by(int32_t* data,
                                                       const int32_t&,
                                                       uint8_t*),
                                  uint8_t* ctx) {
+  SORT_USDT_PROBE(len);
   return sort_by_impl(data, len, cmp_fn, ctx);
 }
 
+void pdqsort_unstable_i32_partial(int32_t* data, size_t len, size_t k) {
+  SORT_USDT_PROBE(len);
+  partial_sort_impl(data, len, k);
+}
+
+uint32_t pdqsort_unstable_i32_by_key(int32_t* data,
+                                     size_t len,
+                                     KeyDescriptor key) {
+  SORT_USDT_PROBE(len);
+  return sort_by_key_impl(data, len, key);
+}
+
 // --- u64 ---
 
 void pdqsort_unstable_u64(uint64_t* data, size_t len) {
+  SORT_USDT_PROBE(len);
   pdqsort(data, data + len);
 }
 
@@ -45,12 +750,38 @@ uint32_t pdqsort_unstable_u64_by(uint64_t* data,
                                                       const uint64_t&,
                                                       uint8_t*),
                                  uint8_t* ctx) {
+  SORT_USDT_PROBE(len);
   return sort_by_impl(data, len, cmp_fn, ctx);
 }
 
+uint32_t pdqsort_unstable_u64_by_key(uint64_t* data,
+                                     size_t len,
+                                     KeyDescriptor key) {
+  SORT_USDT_PROBE(len);
+  return sort_by_key_impl(data, len, key);
+}
+
+void pdqsort_unstable_u64_batch(uint64_t* data,
+                                const size_t* offsets,
+                                size_t n_slices) {
+  sort_slices(data, offsets, n_slices, [](uint64_t* slice, size_t slice_len) {
+    pdqsort(slice, slice + slice_len);
+  });
+}
+
+RUN_ACCUMULATOR_IMPL(pdqsort_unstable, [](uint64_t* data, size_t len) {
+  pdqsort(data, data + len);
+})
+
+void pdqsort_unstable_u64_partial(uint64_t* data, size_t len, size_t k) {
+  SORT_USDT_PROBE(len);
+  partial_sort_impl(data, len, k);
+}
+
 // --- ffi_string ---
 
 void pdqsort_unstable_ffi_string(FFIString* data, size_t len) {
+  SORT_USDT_PROBE(len);
   pdqsort(reinterpret_cast<FFIStringCpp*>(data),
           reinterpret_cast<FFIStringCpp*>(data) + len);
 }
@@ -61,12 +792,40 @@ uint32_t pdqsort_unstable_ffi_string_by(FFIString* data,
                                                              const FFIString&,
                                                              uint8_t*),
                                         uint8_t* ctx) {
+  SORT_USDT_PROBE(len);
   return sort_by_impl(reinterpret_cast<FFIStringCpp*>(data), len, cmp_fn, ctx);
 }
 
+void pdqsort_unstable_ffi_string_partial(FFIString* data,
+                                         size_t len,
+                                         size_t k) {
+  SORT_USDT_PROBE(len);
+  partial_sort_impl(reinterpret_cast<FFIStringCpp*>(data), len, k);
+}
+
+// --- arena_string ---
+
+void pdqsort_unstable_arena_string(FFIArenaString* data, size_t len) {
+  SORT_USDT_PROBE(len);
+  pdqsort(reinterpret_cast<FFIArenaStringCpp*>(data),
+          reinterpret_cast<FFIArenaStringCpp*>(data) + len);
+}
+
+uint32_t pdqsort_unstable_arena_string_by(
+    FFIArenaString* data,
+    size_t len,
+    CompResult (*cmp_fn)(const FFIArenaString&,
+                         const FFIArenaString&,
+                         uint8_t*),
+    uint8_t* ctx) {
+  SORT_USDT_PROBE(len);
+  return sort_by_impl(data, len, cmp_fn, ctx);
+}
+
 // --- f128 ---
 
 void pdqsort_unstable_f128(F128* data, size_t len) {
+  SORT_USDT_PROBE(len);
   pdqsort(reinterpret_cast<F128Cpp*>(data),
           reinterpret_cast<F128Cpp*>(data) + len);
 }
@@ -77,12 +836,19 @@ uint32_t pdqsort_unstable_f128_by(F128* data,
                                                        const F128&,
                                                        uint8_t*),
                                   uint8_t* ctx) {
+  SORT_USDT_PROBE(len);
   return sort_by_impl(reinterpret_cast<F128Cpp*>(data), len, cmp_fn, ctx);
 }
 
+void pdqsort_unstable_f128_partial(F128* data, size_t len, size_t k) {
+  SORT_USDT_PROBE(len);
+  partial_sort_impl(reinterpret_cast<F128Cpp*>(data), len, k);
+}
+
 // --- 1k ---
 
 void pdqsort_unstable_1k(FFIOneKibiByte* data, size_t len) {
+  SORT_USDT_PROBE(len);
   pdqsort(reinterpret_cast<FFIOneKiloByteCpp*>(data),
           reinterpret_cast<FFIOneKiloByteCpp*>(data) + len);
 }
@@ -93,7 +859,130 @@ uint32_t pdqsort_unstable_1k_by(FFIOneKibiByte* data,
                                                      const FFIOneKibiByte&,
                                                      uint8_t*),
                                 uint8_t* ctx) {
+  SORT_USDT_PROBE(len);
   return sort_by_impl(reinterpret_cast<FFIOneKiloByteCpp*>(data), len, cmp_fn,
                       ctx);
 }
+
+uint32_t pdqsort_unstable_1k_by_key(FFIOneKibiByte* data,
+                                    size_t len,
+                                    KeyDescriptor key) {
+  SORT_USDT_PROBE(len);
+  return sort_by_key_impl(reinterpret_cast<FFIOneKiloByteCpp*>(data), len, key);
+}
+
+// --- i16 ---
+
+void pdqsort_unstable_i16(int16_t* data, size_t len) {
+  SORT_USDT_PROBE(len);
+  pdqsort(data, data + len);
+}
+
+uint32_t pdqsort_unstable_i16_by(int16_t* data,
+                                 size_t len,
+                                 CompResult (*cmp_fn)(const int16_t&,
+                                                      const int16_t&,
+                                                      uint8_t*),
+                                 uint8_t* ctx) {
+  SORT_USDT_PROBE(len);
+  return sort_by_impl(data, len, cmp_fn, ctx);
+}
+
+// --- u16 ---
+
+void pdqsort_unstable_u16(uint16_t* data, size_t len) {
+  SORT_USDT_PROBE(len);
+  pdqsort(data, data + len);
+}
+
+uint32_t pdqsort_unstable_u16_by(uint16_t* data,
+                                 size_t len,
+                                 CompResult (*cmp_fn)(const uint16_t&,
+                                                      const uint16_t&,
+                                                      uint8_t*),
+                                 uint8_t* ctx) {
+  SORT_USDT_PROBE(len);
+  return sort_by_impl(data, len, cmp_fn, ctx);
+}
+
+// --- f32 ---
+
+// pdqsort only picks the branchless partition for arithmetic types on its own,
+// the total order comparison is cheap and branch free as well.
+void pdqsort_unstable_f32(F32* data, size_t len) {
+  SORT_USDT_PROBE(len);
+  pdqsort_branchless(reinterpret_cast<F32Cpp*>(data),
+                     reinterpret_cast<F32Cpp*>(data) + len);
+}
+
+uint32_t pdqsort_unstable_f32_by(F32* data,
+                                 size_t len,
+                                 CompResult (*cmp_fn)(const F32&,
+                                                      const F32&,
+                                                      uint8_t*),
+                                 uint8_t* ctx) {
+  SORT_USDT_PROBE(len);
+  return sort_by_impl(data, len, cmp_fn, ctx);
+}
+
+// --- f64 ---
+
+void pdqsort_unstable_f64(F64* data, size_t len) {
+  SORT_USDT_PROBE(len);
+  pdqsort_branchless(reinterpret_cast<F64Cpp*>(data),
+                     reinterpret_cast<F64Cpp*>(data) + len);
+}
+
+uint32_t pdqsort_unstable_f64_by(F64* data,
+                                 size_t len,
+                                 CompResult (*cmp_fn)(const F64&,
+                                                      const F64&,
+                                                      uint8_t*),
+                                 uint8_t* ctx) {
+  SORT_USDT_PROBE(len);
+  return sort_by_impl(data, len, cmp_fn, ctx);
+}
+
+// --- forced partition variants ---
+
+FORCED_IMPL_ALL_TYPES(branchy, ForcedPartition::Branchy)
+FORCED_IMPL_ALL_TYPES(branchless, ForcedPartition::Branchless)
+FORCED_IMPL_ALL_TYPES(lomcyc, ForcedPartition::Lomcyc)
+
+// --- lomcyc partition ---
+
+LOMCYC_PARTITION_IMPL(i32, int32_t, int32_t)
+LOMCYC_PARTITION_IMPL(u64, uint64_t, uint64_t)
+LOMCYC_PARTITION_IMPL(ffi_string, FFIString, FFIStringCpp)
+LOMCYC_PARTITION_IMPL(f128, F128, F128Cpp)
+LOMCYC_PARTITION_IMPL(1k, FFIOneKibiByte, FFIOneKiloByteCpp)
+
+// --- partition ---
+
+size_t pdqsort_partition_i32(int32_t* data, size_t len, const int32_t* pivot) {
+  SORT_USDT_PROBE(len);
+  return pdqsort_partition_impl(data, len, *pivot);
+}
+
+size_t pdqsort_partition_u64(uint64_t* data,
+                             size_t len,
+                             const uint64_t* pivot) {
+  SORT_USDT_PROBE(len);
+  return pdqsort_partition_impl(data, len, *pivot);
+}
+
+// --- counted ---
+
+COUNTED_SORT_IMPL(pdqsort_unstable,
+                  [](auto begin, auto end) { pdqsort(begin, end); })
+
+// --- indirect ---
+
+INDIRECT_SORT_IMPL(pdqsort_unstable, [](auto begin, auto end, auto comp) {
+  pdqsort(begin, end, comp);
+})
 }  // extern "C"
+
+#if defined(SORT_TELEMETRY)
+SORT_TELEMETRY_EXPORT(pdqsort_unstable)
+#endif
@@ -7,41 +7,99 @@
 
 #include <stdint.h>
 
-// powersort is implemented in a way that requires that T is default
-// constructible and implements a by ref copy operator. That's incompatible with
-// move only types such as FFIStringCpp.
-#define SORT_INCOMPATIBLE_WITH_SEMANTIC_CPP_TYPE
-
 #include "shared.h"
 
-template <typename T>
-using powersort = algorithms::powersort<
+template <typename T,
+          typename Compare,
+          // Same result as COPY_BOTH, but merges from both ends without
+          // branches.
+          algorithms::merging_methods MergingMethod =
+              algorithms::merging_methods::COPY_BOTH_BIDIRECTIONAL>
+using powersort_by = algorithms::powersort<
     /*Iterator=*/T,
     /*minRunLen=*/24,
-    /*mergingMethod*/ algorithms::merging_methods::COPY_BOTH,
+    /*mergingMethod*/ MergingMethod,
     /*onlyIncreasingRuns=*/false,
     /*nodePowerImplementation=*/algorithms::MOST_SIGNIFICANT_SET_BIT,
-    /*usePowerIndexedStack=*/false>;
+    /*usePowerIndexedStack=*/false,
+    /*Compare=*/Compare>;
+
+template <typename T>
+using powersort = powersort_by<T, std::less<>>;
 
 template <typename T>
 using powersort_4way = algorithms::powersort_4way<
     /*Iterator=*/T,
     /*minRunLen=*/24,
-    // For faster perf use WILLEM_TUNED but this can't sort slices with custom
-    // types anymore, and it can't correctly sort slices that contain the
-    // sentinel. GENERAL_BY_STAGES works without sentinel requirement.
-    /*mergingMethod*/ algorithms::merging4way_methods::GENERAL_BY_STAGES,
+    // WILLEM_TUNED can't sort slices with custom types, and it can't correctly
+    // sort slices that contain the sentinel. GENERAL_BIDIRECTIONAL works
+    // without sentinel requirement, and is faster than both WILLEM_TUNED and
+    // GENERAL_BY_STAGES.
+    /*mergingMethod*/ algorithms::merging4way_methods::GENERAL_BIDIRECTIONAL,
     /*onlyIncreasingRuns=*/false,
     /*nodePowerImplementation=*/algorithms::MOST_SIGNIFICANT_SET_BIT4,
     /*useParallelArraysForStack=*/false,
     /*useCheckFirstMergeLoop=*/true,
     /*useSpecialized3wayMerge=*/true>;
 
+namespace {
+// How the _merge_mode entry points of f128 and 1k merge, all other entry
+// points use COPY_BOTH_BIDIRECTIONAL. Same order as MergeMode on the Rust side.
+enum class LargeMergeMode : uint32_t {
+  // COPY_BOTH_BIDIRECTIONAL.
+  Bidirectional = 0,
+  // COPY_BOTH_PREFETCH, prefetches ahead of both runs and the output.
+  Prefetch = 1,
+  // COPY_BOTH_BLOCKWISE, moves stretches taken from the same run at once.
+  Blockwise = 2,
+};
+
+// Returns 1 for unknown modes.
+template <typename T>
+uint32_t sort_merge_mode_impl(T* data, size_t len, uint32_t mode) noexcept {
+  using algorithms::merging_methods;
+  switch (static_cast<LargeMergeMode>(mode)) {
+    case LargeMergeMode::Bidirectional:
+      powersort_by<T*, std::less<>, merging_methods::COPY_BOTH_BIDIRECTIONAL>{}
+          .sort(data, data + len);
+      return 0;
+    case LargeMergeMode::Prefetch:
+      powersort_by<T*, std::less<>, merging_methods::COPY_BOTH_PREFETCH>{}.sort(
+          data, data + len);
+      return 0;
+    case LargeMergeMode::Blockwise:
+      powersort_by<T*, std::less<>, merging_methods::COPY_BOTH_BLOCKWISE>{}
+          .sort(data, data + len);
+      return 0;
+    default:
+      return 1;
+  }
+}
+}  // namespace
+
+// The comparison function and its context are carried by the comparator, so
+// unlike CompWrapper this needs no thread locals and can be used concurrently.
+template <typename T, typename F>
+uint32_t powersort_by_impl(T* data,
+                           size_t len,
+                           F cmp_fn,
+                           uint8_t* ctx) noexcept {
+  try {
+    auto comp = make_compare_fn<T>(cmp_fn, ctx);
+    powersort_by<T*, decltype(comp)>{comp}.sort(data, data + len);
+  } catch (...) {
+    return 1;
+  }
+
+  return 0;
+}
+
 template <typename T, template <typename> class SortT, typename F>
 uint32_t sort_by_impl(T* data, size_t len, F cmp_fn, uint8_t* ctx) noexcept {
   try {
-    // Powersort does not provide a way to specify a custom comparator function,
-    // so we have to wrap it inside a type with custom comparison function.
+    // Powersort 4way does not provide a way to specify a custom comparator
+    // function, so we have to wrap it inside a type with custom comparison
+    // function.
     CompWrapper<T, F>::cmp_fn_local = cmp_fn;
     CompWrapper<T, F>::ctx_local = ctx;
 
@@ -59,10 +117,28 @@ uint32_t sort_by_impl(T* data, size_t len, F cmp_fn, uint8_t* ctx) noexcept {
   return 0;
 }
 
+template <typename T, typename Compare>
+void powersort_with_comp(T* begin, T* end, Compare comp) {
+  powersort_by<T*, Compare>{comp}.sort(begin, end);
+}
+
+// Both powersort variants need a merge buffer of len + 4 elements at most.
+template <typename T, template <typename> class SortT>
+void sort_with_buf_impl(T* data, size_t len, uint8_t* buf, size_t buf_bytes) {
+  T* merge_buffer = scratch_from_buf<T>(buf, buf_bytes, len + 4);
+  if (merge_buffer == nullptr) {
+    SortT<T*>{}.sort(data, data + len);
+    return;
+  }
+
+  SortT<T*>{}.sort_with_buffer(data, data + len, merge_buffer);
+}
+
 extern "C" {
 // --- i32 ---
 
 void powersort_stable_i32(int32_t* data, size_t len) {
+  SORT_USDT_PROBE(len);
   // Uses default configuration.
   powersort<int32_t*>{}.sort(data, data + len);
 }
@@ -73,12 +149,22 @@ uint32_t powersort_stable_i32_by(int32_t* data,
                                                       const int32_t&,
                                                       uint8_t*),
                                  uint8_t* ctx) {
-  return sort_by_impl<int32_t, powersort>(data, len, cmp_fn, ctx);
+  SORT_USDT_PROBE(len);
+  return powersort_by_impl(data, len, cmp_fn, ctx);
+}
+
+void powersort_stable_i32_with_buf(int32_t* data,
+                                   size_t len,
+                                   uint8_t* buf,
+                                   size_t buf_bytes) {
+  SORT_USDT_PROBE(len);
+  sort_with_buf_impl<int32_t, powersort>(data, len, buf, buf_bytes);
 }
 
 // --- u64 ---
 
 void powersort_stable_u64(uint64_t* data, size_t len) {
+  SORT_USDT_PROBE(len);
   // Uses default configuration.
   powersort<uint64_t*>{}.sort(data, data + len);
 }
@@ -89,12 +175,22 @@ uint32_t powersort_stable_u64_by(uint64_t* data,
                                                       const uint64_t&,
                                                       uint8_t*),
                                  uint8_t* ctx) {
-  return sort_by_impl<uint64_t, powersort>(data, len, cmp_fn, ctx);
+  SORT_USDT_PROBE(len);
+  return powersort_by_impl(data, len, cmp_fn, ctx);
+}
+
+void powersort_stable_u64_with_buf(uint64_t* data,
+                                   size_t len,
+                                   uint8_t* buf,
+                                   size_t buf_bytes) {
+  SORT_USDT_PROBE(len);
+  sort_with_buf_impl<uint64_t, powersort>(data, len, buf, buf_bytes);
 }
 
 // --- ffi_string ---
 
 void powersort_stable_ffi_string(FFIString* data, size_t len) {
+  SORT_USDT_PROBE(len);
   powersort<FFIStringCpp*>{}.sort(reinterpret_cast<FFIStringCpp*>(data),
                                   reinterpret_cast<FFIStringCpp*>(data) + len);
 }
@@ -105,13 +201,34 @@ uint32_t powersort_stable_ffi_string_by(FFIString* data,
                                                              const FFIString&,
                                                              uint8_t*),
                                         uint8_t* ctx) {
-  return sort_by_impl<FFIString, powersort>(
-      reinterpret_cast<FFIStringCpp*>(data), len, cmp_fn, ctx);
+  SORT_USDT_PROBE(len);
+  return powersort_by_impl(data, len, cmp_fn, ctx);
+}
+
+// --- arena_string ---
+
+void powersort_stable_arena_string(FFIArenaString* data, size_t len) {
+  SORT_USDT_PROBE(len);
+  powersort<FFIArenaStringCpp*>{}.sort(
+      reinterpret_cast<FFIArenaStringCpp*>(data),
+      reinterpret_cast<FFIArenaStringCpp*>(data) + len);
+}
+
+uint32_t powersort_stable_arena_string_by(
+    FFIArenaString* data,
+    size_t len,
+    CompResult (*cmp_fn)(const FFIArenaString&,
+                         const FFIArenaString&,
+                         uint8_t*),
+    uint8_t* ctx) {
+  SORT_USDT_PROBE(len);
+  return powersort_by_impl(data, len, cmp_fn, ctx);
 }
 
 // --- f128 ---
 
 void powersort_stable_f128(F128* data, size_t len) {
+  SORT_USDT_PROBE(len);
   powersort<F128Cpp*>{}.sort(reinterpret_cast<F128Cpp*>(data),
                              reinterpret_cast<F128Cpp*>(data) + len);
 }
@@ -122,13 +239,22 @@ uint32_t powersort_stable_f128_by(F128* data,
                                                        const F128&,
                                                        uint8_t*),
                                   uint8_t* ctx) {
-  return sort_by_impl<F128, powersort>(reinterpret_cast<F128Cpp*>(data), len,
-                                       cmp_fn, ctx);
+  SORT_USDT_PROBE(len);
+  return powersort_by_impl(data, len, cmp_fn, ctx);
+}
+
+// mode is one of LargeMergeMode, returns 1 for unknown ones.
+uint32_t powersort_stable_f128_merge_mode(F128* data,
+                                           size_t len,
+                                           uint32_t mode) {
+  SORT_USDT_PROBE(len);
+  return sort_merge_mode_impl(reinterpret_cast<F128Cpp*>(data), len, mode);
 }
 
 // --- 1k ---
 
 void powersort_stable_1k(FFIOneKibiByte* data, size_t len) {
+  SORT_USDT_PROBE(len);
   powersort<FFIOneKiloByteCpp*>{}.sort(
       reinterpret_cast<FFIOneKiloByteCpp*>(data),
       reinterpret_cast<FFIOneKiloByteCpp*>(data) + len);
@@ -140,8 +266,17 @@ uint32_t powersort_stable_1k_by(FFIOneKibiByte* data,
                                                      const FFIOneKibiByte&,
                                                      uint8_t*),
                                 uint8_t* ctx) {
-  return sort_by_impl<FFIOneKibiByte, powersort>(
-      reinterpret_cast<FFIOneKiloByteCpp*>(data), len, cmp_fn, ctx);
+  SORT_USDT_PROBE(len);
+  return powersort_by_impl(data, len, cmp_fn, ctx);
+}
+
+// mode is one of LargeMergeMode, returns 1 for unknown ones.
+uint32_t powersort_stable_1k_merge_mode(FFIOneKibiByte* data,
+                                        size_t len,
+                                        uint32_t mode) {
+  SORT_USDT_PROBE(len);
+  return sort_merge_mode_impl(reinterpret_cast<FFIOneKiloByteCpp*>(data), len,
+                              mode);
 }
 
 // --- 4 way merging ---
@@ -149,6 +284,7 @@ uint32_t powersort_stable_1k_by(FFIOneKibiByte* data,
 // --- i32 ---
 
 void powersort_4way_stable_i32(int32_t* data, size_t len) {
+  SORT_USDT_PROBE(len);
   // Uses default configuration.
   powersort_4way<int32_t*>{}.sort(data, data + len);
 }
@@ -159,12 +295,22 @@ uint32_t powersort_4way_stable_i32_by(int32_t* data,
                                                            const int32_t&,
                                                            uint8_t*),
                                       uint8_t* ctx) {
+  SORT_USDT_PROBE(len);
   return sort_by_impl<int32_t, powersort_4way>(data, len, cmp_fn, ctx);
 }
 
+void powersort_4way_stable_i32_with_buf(int32_t* data,
+                                        size_t len,
+                                        uint8_t* buf,
+                                        size_t buf_bytes) {
+  SORT_USDT_PROBE(len);
+  sort_with_buf_impl<int32_t, powersort_4way>(data, len, buf, buf_bytes);
+}
+
 // --- u64 ---
 
 void powersort_4way_stable_u64(uint64_t* data, size_t len) {
+  SORT_USDT_PROBE(len);
   // Uses default configuration.
   powersort_4way<uint64_t*>{}.sort(data, data + len);
 }
@@ -175,12 +321,22 @@ uint32_t powersort_4way_stable_u64_by(uint64_t* data,
                                                            const uint64_t&,
                                                            uint8_t*),
                                       uint8_t* ctx) {
+  SORT_USDT_PROBE(len);
   return sort_by_impl<uint64_t, powersort_4way>(data, len, cmp_fn, ctx);
 }
 
+void powersort_4way_stable_u64_with_buf(uint64_t* data,
+                                        size_t len,
+                                        uint8_t* buf,
+                                        size_t buf_bytes) {
+  SORT_USDT_PROBE(len);
+  sort_with_buf_impl<uint64_t, powersort_4way>(data, len, buf, buf_bytes);
+}
+
 // --- ffi_string ---
 
 void powersort_4way_stable_ffi_string(FFIString* data, size_t len) {
+  SORT_USDT_PROBE(len);
   powersort_4way<FFIStringCpp*>{}.sort(
       reinterpret_cast<FFIStringCpp*>(data),
       reinterpret_cast<FFIStringCpp*>(data) + len);
@@ -191,6 +347,7 @@ uint32_t powersort_4way_stable_ffi_string_by(
     size_t len,
     CompResult (*cmp_fn)(const FFIString&, const FFIString&, uint8_t*),
     uint8_t* ctx) {
+  SORT_USDT_PROBE(len);
   return sort_by_impl<FFIString, powersort_4way>(
       reinterpret_cast<FFIStringCpp*>(data), len, cmp_fn, ctx);
 }
@@ -198,6 +355,7 @@ uint32_t powersort_4way_stable_ffi_string_by(
 // --- f128 ---
 
 void powersort_4way_stable_f128(F128* data, size_t len) {
+  SORT_USDT_PROBE(len);
   powersort_4way<F128Cpp*>{}.sort(reinterpret_cast<F128Cpp*>(data),
                                   reinterpret_cast<F128Cpp*>(data) + len);
 }
@@ -208,6 +366,7 @@ uint32_t powersort_4way_stable_f128_by(F128* data,
                                                             const F128&,
                                                             uint8_t*),
                                        uint8_t* ctx) {
+  SORT_USDT_PROBE(len);
   return sort_by_impl<F128, powersort_4way>(reinterpret_cast<F128Cpp*>(data),
                                             len, cmp_fn, ctx);
 }
@@ -215,6 +374,7 @@ uint32_t powersort_4way_stable_f128_by(F128* data,
 // --- 1k ---
 
 void powersort_4way_stable_1k(FFIOneKibiByte* data, size_t len) {
+  SORT_USDT_PROBE(len);
   powersort_4way<FFIOneKiloByteCpp*>{}.sort(
       reinterpret_cast<FFIOneKiloByteCpp*>(data),
       reinterpret_cast<FFIOneKiloByteCpp*>(data) + len);
@@ -226,7 +386,20 @@ uint32_t powersort_4way_stable_1k_by(FFIOneKibiByte* data,
                                                           const FFIOneKibiByte&,
                                                           uint8_t*),
                                      uint8_t* ctx) {
+  SORT_USDT_PROBE(len);
   return sort_by_impl<FFIOneKibiByte, powersort_4way>(
       reinterpret_cast<FFIOneKiloByteCpp*>(data), len, cmp_fn, ctx);
 }
+
+// --- counted ---
+
+COUNTED_SORT_IMPL(powersort_stable, [](auto begin, auto end) {
+  powersort<decltype(begin)>{}.sort(begin, end);
+})
+
+// --- indirect ---
+
+INDIRECT_SORT_IMPL(powersort_stable, [](auto begin, auto end, auto comp) {
+  powersort_with_comp(begin, end, comp);
+})
 }  // extern "C"
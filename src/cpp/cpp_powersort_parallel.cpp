@@ -0,0 +1,539 @@
+#include "thirdparty/powersort/powersort.h"
+
+#include <algorithm>
+#include <compare>
+#include <stdexcept>
+#include <vector>
+
+#include <stdint.h>
+
+// powersort is implemented in a way that requires that T is default
+// constructible and implements a by ref copy operator. That's incompatible with
+// move only types such as FFIStringCpp.
+#define SORT_INCOMPATIBLE_WITH_SEMANTIC_CPP_TYPE
+
+#include "parallel_util.h"
+#include "shared.h"
+
+#if !defined(_REENTRANT)
+#error "The parallel powersort build requires -pthread"
+#endif
+
+template <typename T, typename Compare>
+using powersort = algorithms::powersort<
+    /*Iterator=*/T,
+    /*minRunLen=*/24,
+    /*mergingMethod*/ algorithms::merging_methods::COPY_BOTH,
+    /*onlyIncreasingRuns=*/false,
+    /*nodePowerImplementation=*/algorithms::MOST_SIGNIFICANT_SET_BIT,
+    /*usePowerIndexedStack=*/false,
+    /*Compare=*/Compare>;
+
+// Sorts each chunk with powersort, which picks up the natural runs inside of
+// the chunks, and then merges pairs of neighbouring chunks until a single run
+// is left. Every merge round is split along the merge path so that all threads
+// stay busy, even in the last round that only merges two runs. Neighbouring
+// runs that are already in order, as it is common for concatenated pre-sorted
+// shards, are copied instead of merged.
+//
+// If comp throws, data is left holding a permutation of its input. The chunk
+// sorts keep their chunk a permutation, and every merge round only reads src,
+// so a failed round copies src back if it was writing into data. Elements such
+// as FFIStringCpp are plain copies of an owning handle here, so anything else
+// would hand duplicated and lost handles back to the caller.
+template <typename T, typename Compare>
+bool sort_parallel_impl(T* data,
+                        size_t len,
+                        size_t num_threads,
+                        Compare comp) {
+  const size_t num_chunks = std::min(num_threads, len / PARALLEL_MIN_CHUNK_LEN);
+  if (num_chunks <= 1) {
+    return run_tasks(1, [data, len, comp](size_t) {
+      powersort<T*, Compare>{comp}.sort(data, data + len);
+    });
+  }
+
+  // The sequential powersort needs up to 4 extra elements of merge buffer per
+  // chunk. The merge rounds only use the first len elements.
+  std::vector<T> buffer(len + (num_chunks * 4));
+
+  std::vector<size_t> bounds(num_chunks + 1);
+  for (size_t i = 0; i <= num_chunks; ++i) {
+    bounds[i] = (len * i) / num_chunks;
+  }
+
+  const bool sort_ok =
+      run_tasks(num_chunks, [data, comp, &buffer, &bounds](size_t i) {
+        powersort<T*, Compare>{comp}.sort_with_buffer(
+            data + bounds[i], data + bounds[i + 1],
+            buffer.data() + bounds[i] + (i * 4));
+      });
+
+  if (!sort_ok) {
+    return false;
+  }
+
+  T* src = data;
+  T* dst = buffer.data();
+
+  while (bounds.size() > 2) {
+    const size_t num_runs = bounds.size() - 1;
+    const size_t num_pairs = num_runs / 2;
+    const size_t parts_per_pair = std::max<size_t>(num_threads / num_pairs, 1);
+
+    // An odd run at the end is carried over as is, by the last part.
+    const bool round_ok = run_tasks(
+        (num_pairs * parts_per_pair) + (num_runs % 2),
+        [src, dst, comp, &bounds, num_pairs, parts_per_pair](size_t task_i) {
+          const size_t pair_i = task_i / parts_per_pair;
+          if (pair_i == num_pairs) {
+            std::copy(src + bounds[pair_i * 2], src + bounds.back(),
+                      dst + bounds[pair_i * 2]);
+            return;
+          }
+
+          const size_t begin = bounds[pair_i * 2];
+          const size_t mid = bounds[(pair_i * 2) + 1];
+          const size_t end = bounds[(pair_i * 2) + 2];
+          const size_t part_i = task_i % parts_per_pair;
+
+          const size_t pair_len = end - begin;
+          const size_t out_begin = (pair_len * part_i) / parts_per_pair;
+          const size_t out_end = (pair_len * (part_i + 1)) / parts_per_pair;
+
+          // The comparator may be stateful and must not be shared between
+          // the threads.
+          Compare part_comp = comp;
+
+          if (!part_comp(src[mid], src[mid - 1])) {
+            std::copy(src + begin + out_begin, src + begin + out_end,
+                      dst + begin + out_begin);
+            return;
+          }
+
+          const T* a = src + begin;
+          const T* b = src + mid;
+          const size_t a_len = mid - begin;
+          const size_t b_len = end - mid;
+
+          const size_t a_begin =
+              merge_path_split(a, a_len, b, b_len, out_begin, part_comp);
+          const size_t a_end =
+              merge_path_split(a, a_len, b, b_len, out_end, part_comp);
+
+          std::merge(a + a_begin, a + a_end, b + (out_begin - a_begin),
+                     b + (out_end - a_end), dst + begin + out_begin, part_comp);
+        });
+
+    if (!round_ok) {
+      if (dst == data) {
+        std::copy(src, src + len, data);
+      }
+      return false;
+    }
+
+    std::vector<size_t> merged_bounds;
+    merged_bounds.reserve(num_pairs + 2);
+    for (size_t i = 0; i < bounds.size(); i += 2) {
+      merged_bounds.push_back(bounds[i]);
+    }
+    if (merged_bounds.back() != len) {
+      merged_bounds.push_back(len);
+    }
+
+    bounds = std::move(merged_bounds);
+    std::swap(src, dst);
+  }
+
+  if (src != data) {
+    std::copy(src, src + len, data);
+  }
+
+  return true;
+}
+
+template <typename T>
+void sort_parallel(T* data, size_t len, size_t num_threads) noexcept {
+  sort_parallel_impl(data, len, num_threads, std::less<>{});
+}
+
+template <typename T, typename F>
+uint32_t sort_parallel_by_impl(T* data,
+                               size_t len,
+                               F cmp_fn,
+                               uint8_t* ctx,
+                               size_t num_threads) noexcept {
+  // A panic in the comparison function throws, and is caught again on the
+  // thread that ran into it, see run_tasks.
+  const bool sort_ok = sort_parallel_impl(data, len, num_threads,
+                                          make_compare_fn<T>(cmp_fn, ctx));
+
+  return sort_ok ? 0 : 1;
+}
+
+// Merges k runs with a tree of losers, about log2(k) comparisons per element.
+// Ties go to the run with the lower index, which keeps the merge stable.
+template <typename T, typename Compare>
+class LoserTree {
+ public:
+  LoserTree(std::vector<const T*> heads,
+            std::vector<const T*> ends,
+            Compare comp)
+      : _heads{std::move(heads)},
+        _ends{std::move(ends)},
+        _done(_heads.size()),
+        _tree(_heads.size()),
+        _comp{comp} {
+    for (size_t i = 0; i < _heads.size(); ++i) {
+      _done[i] = _heads[i] == _ends[i];
+    }
+    _tree[0] = build(1);
+  }
+
+  // Writes the next len elements of the merge to out.
+  void merge_into(T* out, size_t len) {
+    size_t winner = _tree[0];
+
+    for (size_t i = 0; i < len; ++i) {
+      out[i] = *_heads[winner]++;
+      _done[winner] = _heads[winner] == _ends[winner];
+
+      // Replay the matches on the path from the winner's leaf to the root,
+      // without branching on their outcome, that's not predictable.
+      for (size_t node = (winner + _heads.size()) / 2; node != 0; node /= 2) {
+        const size_t loser = _tree[node];
+        const bool loser_wins = beats(loser, winner);
+        _tree[node] = loser_wins ? winner : loser;
+        winner = loser_wins ? loser : winner;
+      }
+    }
+
+    _tree[0] = winner;
+  }
+
+ private:
+  bool beats(size_t a, size_t b) const {
+    if (_done[a] || _done[b]) {
+      return _done[b] && !_done[a];
+    }
+
+    // On ties the lower index wins.
+    return a < b ? !_comp(*_heads[b], *_heads[a]) : _comp(*_heads[a], *_heads[b]);
+  }
+
+  // Node i has the children 2i and 2i + 1, the leaves k..2k-1 are the runs.
+  // Returns the winner of the subtree and stores the losers.
+  size_t build(size_t node) {
+    if (node >= _heads.size()) {
+      return node - _heads.size();
+    }
+
+    const size_t left = build(2 * node);
+    const size_t right = build((2 * node) + 1);
+    if (beats(left, right)) {
+      _tree[node] = right;
+      return left;
+    }
+
+    _tree[node] = left;
+    return right;
+  }
+
+  std::vector<const T*> _heads;
+  std::vector<const T*> _ends;
+  // Exhausted runs lose every match.
+  std::vector<uint8_t> _done;
+  // _tree[0] is the overall winner, the inner nodes hold the losers.
+  std::vector<size_t> _tree;
+  Compare _comp;
+};
+
+// Writes to cuts, for every run, where the elements end that come before the
+// element at position pos of run split_run in the stable merge, and returns
+// their total count. That's the merge path split of two runs, generalized to
+// k runs.
+template <typename T, typename Compare>
+size_t co_rank(const T* data,
+               const size_t* offsets,
+               size_t num_runs,
+               size_t split_run,
+               size_t pos,
+               Compare comp,
+               size_t* cuts) {
+  size_t rank = 0;
+
+  for (size_t i = 0; i < num_runs; ++i) {
+    const T* begin = data + offsets[i];
+    const T* end = data + offsets[i + 1];
+
+    if (i < split_run) {
+      cuts[i] = std::upper_bound(begin, end, data[pos], comp) - data;
+    } else if (i > split_run) {
+      cuts[i] = std::lower_bound(begin, end, data[pos], comp) - data;
+    } else {
+      cuts[i] = pos;
+    }
+
+    rank += cuts[i] - offsets[i];
+  }
+
+  return rank;
+}
+
+// Splits are picked from this many samples per run and part. The closest
+// sample to the ideal split is at most len / (SAMPLES_PER_PART * num_parts)
+// elements off, a few percent of a part.
+constexpr size_t SAMPLES_PER_PART = 64;
+
+// Merges the already sorted runs data[offsets[i]..offsets[i + 1]] in place.
+// The output is split into one part per thread, and every part is merged on
+// its own with a loser tree, after co-ranking the part bounds in all runs.
+template <typename T, typename Compare>
+bool merge_sorted_runs_impl(T* data,
+                            const size_t* offsets,
+                            size_t num_runs,
+                            size_t num_threads,
+                            Compare comp) {
+  if (num_runs <= 1) {
+    return true;
+  }
+
+  const size_t len = offsets[num_runs] - offsets[0];
+  const size_t num_parts =
+      std::max<size_t>(std::min(num_threads, len / PARALLEL_MIN_CHUNK_LEN), 1);
+
+  // part_cuts[p * num_runs + i] is where part p starts in run i.
+  std::vector<size_t> part_cuts((num_parts + 1) * num_runs);
+  std::vector<size_t> part_ranks(num_parts + 1);
+  std::copy(offsets, offsets + num_runs, part_cuts.begin());
+  std::copy(offsets + 1, offsets + num_runs + 1,
+            part_cuts.begin() + (num_parts * num_runs));
+  part_ranks[num_parts] = len;
+
+  if (num_parts > 1) {
+    struct Sample {
+      size_t run;
+      size_t pos;
+    };
+
+    const size_t samples_per_run = SAMPLES_PER_PART * num_parts;
+    std::vector<Sample> samples;
+    samples.reserve(num_runs * samples_per_run);
+    for (size_t i = 0; i < num_runs; ++i) {
+      const size_t run_len = offsets[i + 1] - offsets[i];
+      for (size_t j = 0; j < std::min(samples_per_run, run_len); ++j) {
+        samples.push_back({i, offsets[i] + ((run_len * j) / samples_per_run)});
+      }
+    }
+
+    // Same order as the stable merge.
+    std::sort(samples.begin(), samples.end(),
+              [data, comp](const Sample& a, const Sample& b) {
+                if (comp(data[a.pos], data[b.pos])) {
+                  return true;
+                }
+                if (comp(data[b.pos], data[a.pos])) {
+                  return false;
+                }
+                return a.run < b.run || (a.run == b.run && a.pos < b.pos);
+              });
+
+    const bool split_ok = run_tasks(
+        num_parts - 1, [data, offsets, num_runs, num_parts, len, comp,
+                        &samples, &part_cuts, &part_ranks](size_t task_i) {
+          const size_t part_i = task_i + 1;
+          const size_t target_rank = (len * part_i) / num_parts;
+          size_t* cuts = part_cuts.data() + (part_i * num_runs);
+          Compare part_comp = comp;
+
+          // First sample that doesn't start before the ideal split.
+          size_t lo = 0;
+          size_t hi = samples.size();
+          while (lo < hi) {
+            const size_t mid = lo + (hi - lo) / 2;
+            const size_t rank =
+                co_rank(data, offsets, num_runs, samples[mid].run,
+                        samples[mid].pos, part_comp, cuts);
+            if (rank < target_rank) {
+              lo = mid + 1;
+            } else {
+              hi = mid;
+            }
+          }
+
+          if (lo == samples.size()) {
+            std::copy(offsets + 1, offsets + num_runs + 1, cuts);
+            part_ranks[part_i] = len;
+          } else {
+            part_ranks[part_i] =
+                co_rank(data, offsets, num_runs, samples[lo].run,
+                        samples[lo].pos, part_comp, cuts);
+          }
+        });
+
+    if (!split_ok) {
+      return false;
+    }
+  }
+
+  std::vector<T> buffer(len);
+  T* out = buffer.data();
+
+  const bool merge_ok = run_tasks(
+      num_parts, [data, out, num_runs, comp, &part_cuts,
+                  &part_ranks](size_t part_i) {
+        std::vector<const T*> heads(num_runs);
+        std::vector<const T*> ends(num_runs);
+        for (size_t i = 0; i < num_runs; ++i) {
+          heads[i] = data + part_cuts[(part_i * num_runs) + i];
+          ends[i] = data + part_cuts[((part_i + 1) * num_runs) + i];
+        }
+
+        LoserTree<T, Compare>{std::move(heads), std::move(ends), comp}
+            .merge_into(out + part_ranks[part_i],
+                        part_ranks[part_i + 1] - part_ranks[part_i]);
+      });
+
+  if (!merge_ok) {
+    return false;
+  }
+
+  // Only after all parts are done, each of them reads from all over data.
+  return run_tasks(num_parts, [data, offsets, out, &part_ranks](size_t part_i) {
+    std::copy(out + part_ranks[part_i], out + part_ranks[part_i + 1],
+              data + offsets[0] + part_ranks[part_i]);
+  });
+}
+
+template <typename T>
+void merge_sorted_runs(T* data,
+                       const size_t* offsets,
+                       size_t num_runs,
+                       size_t num_threads) noexcept {
+  merge_sorted_runs_impl(data, offsets, num_runs, num_threads, std::less<>{});
+}
+
+extern "C" {
+// --- i32 ---
+
+void powersort_parallel_stable_i32(int32_t* data,
+                                   size_t len,
+                                   size_t num_threads) {
+  SORT_USDT_PROBE(len);
+  sort_parallel(data, len, num_threads);
+}
+
+uint32_t powersort_parallel_stable_i32_by(int32_t* data,
+                                          size_t len,
+                                          CompResult (*cmp_fn)(const int32_t&,
+                                                               const int32_t&,
+                                                               uint8_t*),
+                                          uint8_t* ctx,
+                                          size_t num_threads) {
+  SORT_USDT_PROBE(len);
+  return sort_parallel_by_impl(data, len, cmp_fn, ctx, num_threads);
+}
+
+// --- u64 ---
+
+void powersort_parallel_stable_u64(uint64_t* data,
+                                   size_t len,
+                                   size_t num_threads) {
+  SORT_USDT_PROBE(len);
+  sort_parallel(data, len, num_threads);
+}
+
+uint32_t powersort_parallel_stable_u64_by(uint64_t* data,
+                                          size_t len,
+                                          CompResult (*cmp_fn)(const uint64_t&,
+                                                               const uint64_t&,
+                                                               uint8_t*),
+                                          uint8_t* ctx,
+                                          size_t num_threads) {
+  SORT_USDT_PROBE(len);
+  return sort_parallel_by_impl(data, len, cmp_fn, ctx, num_threads);
+}
+
+void powersort_parallel_stable_u64_merge(uint64_t* data,
+                                         const size_t* offsets,
+                                         size_t num_runs,
+                                         size_t num_threads) {
+  merge_sorted_runs(data, offsets, num_runs, num_threads);
+}
+
+// --- ffi_string ---
+
+void powersort_parallel_stable_ffi_string(FFIString* data,
+                                          size_t len,
+                                          size_t num_threads) {
+  SORT_USDT_PROBE(len);
+  sort_parallel(reinterpret_cast<FFIStringCpp*>(data), len, num_threads);
+}
+
+uint32_t powersort_parallel_stable_ffi_string_by(
+    FFIString* data,
+    size_t len,
+    CompResult (*cmp_fn)(const FFIString&, const FFIString&, uint8_t*),
+    uint8_t* ctx,
+    size_t num_threads) {
+  SORT_USDT_PROBE(len);
+  return sort_parallel_by_impl(data, len, cmp_fn, ctx, num_threads);
+}
+
+void powersort_parallel_stable_ffi_string_merge(FFIString* data,
+                                                const size_t* offsets,
+                                                size_t num_runs,
+                                                size_t num_threads) {
+  merge_sorted_runs(reinterpret_cast<FFIStringCpp*>(data), offsets, num_runs,
+                    num_threads);
+}
+
+// --- f128 ---
+
+void powersort_parallel_stable_f128(F128* data,
+                                    size_t len,
+                                    size_t num_threads) {
+  SORT_USDT_PROBE(len);
+  sort_parallel(reinterpret_cast<F128Cpp*>(data), len, num_threads);
+}
+
+uint32_t powersort_parallel_stable_f128_by(F128* data,
+                                           size_t len,
+                                           CompResult (*cmp_fn)(const F128&,
+                                                                const F128&,
+                                                                uint8_t*),
+                                           uint8_t* ctx,
+                                           size_t num_threads) {
+  SORT_USDT_PROBE(len);
+  return sort_parallel_by_impl(data, len, cmp_fn, ctx, num_threads);
+}
+
+void powersort_parallel_stable_f128_merge(F128* data,
+                                          const size_t* offsets,
+                                          size_t num_runs,
+                                          size_t num_threads) {
+  merge_sorted_runs(reinterpret_cast<F128Cpp*>(data), offsets, num_runs,
+                    num_threads);
+}
+
+// --- 1k ---
+
+void powersort_parallel_stable_1k(FFIOneKibiByte* data,
+                                  size_t len,
+                                  size_t num_threads) {
+  SORT_USDT_PROBE(len);
+  sort_parallel(reinterpret_cast<FFIOneKiloByteCpp*>(data), len, num_threads);
+}
+
+uint32_t powersort_parallel_stable_1k_by(
+    FFIOneKibiByte* data,
+    size_t len,
+    CompResult (*cmp_fn)(const FFIOneKibiByte&,
+                         const FFIOneKibiByte&,
+                         uint8_t*),
+    uint8_t* ctx,
+    size_t num_threads) {
+  SORT_USDT_PROBE(len);
+  return sort_parallel_by_impl(data, len, cmp_fn, ctx, num_threads);
+}
+}  // extern "C"
@@ -0,0 +1,852 @@
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include <stdint.h>
+
+#include "parallel_util.h"
+#include "shared.h"
+
+// Stable LSD/MSD hybrid radix sort for integer keys, with an optional payload
+// that is permuted together with the keys.
+//
+// A single pass over the input counts all digits at once. Digits that are the
+// same for every key are skipped, which makes inputs with few distinct values
+// or a small value range cheap. Inputs that fit in L2 together with the
+// scratch buffer are sorted with LSD passes. Larger inputs are first split on
+// their most significant non-trivial digit, going through one cache line sized
+// write-combining buffer per bucket, so that the scatter writes full lines
+// instead of touching 256 partially written lines at once.
+
+namespace {
+
+constexpr size_t RADIX_BITS = 8;
+constexpr size_t RADIX = size_t{1} << RADIX_BITS;
+
+constexpr size_t INSERTION_SORT_THRESHOLD = 64;
+
+// Input plus scratch buffer for u64 keys take up 1MiB at this len.
+constexpr size_t LSD_THRESHOLD = size_t{1} << 16;
+
+constexpr size_t WC_LINE_BYTES = 64;
+constexpr size_t WC_MIN_BUCKETS = 64;
+
+struct NoPayload {};
+
+template <typename P>
+constexpr bool HAS_PAYLOAD = !std::is_same_v<P, NoPayload>;
+
+// Maps the order of K onto the unsigned order of the returned value.
+template <typename K>
+std::make_unsigned_t<K> radix_key(K key) {
+  using U = std::make_unsigned_t<K>;
+
+  if constexpr (std::is_signed_v<K>) {
+    return static_cast<U>(key) ^ (U{1} << (sizeof(K) * 8 - 1));
+  } else {
+    return key;
+  }
+}
+
+template <typename K>
+size_t digit(K key, size_t digit_i) {
+  return (radix_key(key) >> (digit_i * RADIX_BITS)) & (RADIX - 1);
+}
+
+// The payload pointers are null if there is no payload.
+template <typename P>
+P* advance(P* ptr, size_t n) {
+  if constexpr (HAS_PAYLOAD<P>) {
+    return ptr + n;
+  } else {
+    return ptr;
+  }
+}
+
+template <typename K, typename P>
+void copy_elements(const K* keys,
+                   const P* payload,
+                   K* keys_dst,
+                   P* payload_dst,
+                   size_t len) {
+  std::memcpy(keys_dst, keys, len * sizeof(K));
+
+  if constexpr (HAS_PAYLOAD<P>) {
+    std::memcpy(payload_dst, payload, len * sizeof(P));
+  }
+}
+
+template <typename K, typename P>
+void insertion_sort(K* keys, P* payload, size_t len) {
+  for (size_t i = 1; i < len; ++i) {
+    const K key = keys[i];
+    P value{};
+    if constexpr (HAS_PAYLOAD<P>) {
+      value = payload[i];
+    }
+
+    size_t j = i;
+    for (; j > 0 && key < keys[j - 1]; --j) {
+      keys[j] = keys[j - 1];
+      if constexpr (HAS_PAYLOAD<P>) {
+        payload[j] = payload[j - 1];
+      }
+    }
+
+    keys[j] = key;
+    if constexpr (HAS_PAYLOAD<P>) {
+      payload[j] = value;
+    }
+  }
+}
+
+void exclusive_prefix_sum(const size_t* counts, size_t* offsets) {
+  size_t sum = 0;
+  for (size_t i = 0; i < RADIX; ++i) {
+    offsets[i] = sum;
+    sum += counts[i];
+  }
+}
+
+template <typename K, typename P>
+void scatter(const K* keys,
+             const P* payload,
+             K* keys_dst,
+             P* payload_dst,
+             size_t len,
+             size_t digit_i,
+             size_t* offsets) {
+  for (size_t i = 0; i < len; ++i) {
+    const size_t pos = offsets[digit(keys[i], digit_i)]++;
+    keys_dst[pos] = keys[i];
+    if constexpr (HAS_PAYLOAD<P>) {
+      payload_dst[pos] = payload[i];
+    }
+  }
+}
+
+// Same as scatter, but elements are gathered per bucket until a full cache
+// line of keys can be written out. Lines are counted from the start of the
+// destination, which makes the position inside the line fall out of the bucket
+// offset.
+template <typename K, typename P>
+void scatter_write_combined(const K* keys,
+                            const P* payload,
+                            K* keys_dst,
+                            P* payload_dst,
+                            size_t len,
+                            size_t digit_i,
+                            size_t* offsets) {
+  constexpr size_t LINE_LEN = WC_LINE_BYTES / sizeof(K);
+  constexpr size_t PAYLOAD_LINES = HAS_PAYLOAD<P> ? RADIX : 1;
+
+  alignas(WC_LINE_BYTES) K key_lines[RADIX][LINE_LEN];
+  alignas(WC_LINE_BYTES) P payload_lines[PAYLOAD_LINES][LINE_LEN];
+
+  size_t bucket_starts[RADIX];
+  std::copy_n(offsets, RADIX, bucket_starts);
+
+  // Writes out the gathered elements of bucket, up to but excluding end.
+  const auto flush = [&](size_t bucket, size_t end) {
+    const size_t line_start = (end - 1) & ~(LINE_LEN - 1);
+    const size_t first = std::max(line_start, bucket_starts[bucket]);
+    const size_t first_i = first - line_start;
+
+    copy_elements(key_lines[bucket] + first_i,
+                  payload_lines[HAS_PAYLOAD<P> ? bucket : 0] + first_i,
+                  keys_dst + first, advance(payload_dst, first), end - first);
+  };
+
+  for (size_t i = 0; i < len; ++i) {
+    const size_t bucket = digit(keys[i], digit_i);
+    const size_t pos = offsets[bucket]++;
+    const size_t line_i = pos & (LINE_LEN - 1);
+
+    key_lines[bucket][line_i] = keys[i];
+    if constexpr (HAS_PAYLOAD<P>) {
+      payload_lines[bucket][line_i] = payload[i];
+    }
+
+    if (line_i == LINE_LEN - 1) {
+      const size_t line_start = pos + 1 - LINE_LEN;
+      if (line_start >= bucket_starts[bucket]) {
+        copy_elements(key_lines[bucket],
+                      payload_lines[HAS_PAYLOAD<P> ? bucket : 0],
+                      keys_dst + line_start, advance(payload_dst, line_start),
+                      LINE_LEN);
+      } else {
+        flush(bucket, pos + 1);
+      }
+    }
+  }
+
+  for (size_t bucket = 0; bucket < RADIX; ++bucket) {
+    const size_t end = offsets[bucket];
+    if (end != bucket_starts[bucket] && (end & (LINE_LEN - 1)) != 0) {
+      flush(bucket, end);
+    }
+  }
+}
+
+// Sorts keys by their lowest `num_digits` digits, all higher digits are equal.
+// The result ends up in keys_buf if `to_buf` is set, otherwise in keys.
+template <typename K, typename P>
+void radix_sort_impl(K* keys,
+                     P* payload,
+                     K* keys_buf,
+                     P* payload_buf,
+                     size_t len,
+                     size_t num_digits,
+                     bool to_buf) {
+  if (len < INSERTION_SORT_THRESHOLD) {
+    insertion_sort(keys, payload, len);
+    if (to_buf) {
+      copy_elements(keys, payload, keys_buf, payload_buf, len);
+    }
+    return;
+  }
+
+  size_t counts[sizeof(K)][RADIX] = {};
+  for (size_t i = 0; i < len; ++i) {
+    const auto key = radix_key(keys[i]);
+    for (size_t digit_i = 0; digit_i < num_digits; ++digit_i) {
+      counts[digit_i][(key >> (digit_i * RADIX_BITS)) & (RADIX - 1)] += 1;
+    }
+  }
+
+  size_t sort_digits[sizeof(K)];
+  size_t num_sort_digits = 0;
+  for (size_t digit_i = 0; digit_i < num_digits; ++digit_i) {
+    if (counts[digit_i][digit(keys[0], digit_i)] != len) {
+      sort_digits[num_sort_digits++] = digit_i;
+    }
+  }
+
+  size_t offsets[RADIX];
+
+  if (num_sort_digits == 0 || len <= LSD_THRESHOLD) {
+    K* src_keys = keys;
+    P* src_payload = payload;
+    K* dst_keys = keys_buf;
+    P* dst_payload = payload_buf;
+
+    for (size_t i = 0; i < num_sort_digits; ++i) {
+      const size_t digit_i = sort_digits[i];
+      exclusive_prefix_sum(counts[digit_i], offsets);
+      scatter(src_keys, src_payload, dst_keys, dst_payload, len, digit_i,
+              offsets);
+
+      std::swap(src_keys, dst_keys);
+      std::swap(src_payload, dst_payload);
+    }
+
+    if ((src_keys == keys_buf) != to_buf) {
+      copy_elements(src_keys, src_payload, dst_keys, dst_payload, len);
+    }
+    return;
+  }
+
+  const size_t msd_digit = sort_digits[num_sort_digits - 1];
+  exclusive_prefix_sum(counts[msd_digit], offsets);
+  // With few buckets the hardware keeps up with the write streams on its own,
+  // and the buffering only adds work.
+  const size_t num_buckets =
+      RADIX - std::count(counts[msd_digit], counts[msd_digit] + RADIX, 0);
+  if (num_buckets >= WC_MIN_BUCKETS) {
+    scatter_write_combined(keys, payload, keys_buf, payload_buf, len,
+                           msd_digit, offsets);
+  } else {
+    scatter(keys, payload, keys_buf, payload_buf, len, msd_digit, offsets);
+  }
+
+  // The buckets now live in keys_buf, so the roles of the buffers swap.
+  size_t bucket_start = 0;
+  for (size_t bucket = 0; bucket < RADIX; ++bucket) {
+    const size_t bucket_len = counts[msd_digit][bucket];
+    if (bucket_len != 0) {
+      radix_sort_impl(keys_buf + bucket_start,
+                      advance(payload_buf, bucket_start), keys + bucket_start,
+                      advance(payload, bucket_start), bucket_len, msd_digit,
+                      !to_buf);
+    }
+    bucket_start += bucket_len;
+  }
+}
+
+template <typename K, typename P>
+void radix_sort(K* keys, P* payload, size_t len) {
+  static_assert(std::is_integral_v<K>);
+
+  if (len < INSERTION_SORT_THRESHOLD) {
+    insertion_sort(keys, payload, len);
+    return;
+  }
+
+  std::unique_ptr<K[]> keys_buf{new K[len]};
+  std::unique_ptr<P[]> payload_buf{};
+  if constexpr (HAS_PAYLOAD<P>) {
+    payload_buf.reset(new P[len]);
+  }
+
+  radix_sort_impl(keys, payload, keys_buf.get(), payload_buf.get(), len,
+                  sizeof(K), false);
+}
+
+// MSD radix sort for strings, that hands small buckets to a multikey
+// quicksort. Both look at one character position at a time and never compare
+// the common prefix of a bucket again, unlike comparison sorts that re-compare
+// it at every level. The values are permuted as their raw FFIString
+// representation, C++ never creates or destroys strings.
+//
+// The radix passes first skip the prefix common to the whole bucket, then read
+// the character at the current depth of each string once into a cache, so that
+// counting and scattering do not chase the string pointers a second time.
+
+// Bucket 0 holds the strings that end before the current depth.
+constexpr size_t STRING_RADIX = RADIX + 1;
+
+constexpr size_t STRING_MKQS_THRESHOLD = 256;
+constexpr size_t STRING_INSERTION_SORT_THRESHOLD = 16;
+
+// Returns the character at depth plus one, or 0 if the string is shorter.
+uint16_t char_at(const FFIString& str, size_t depth) {
+  return depth < str.len ? static_cast<uint8_t>(str.data[depth]) + 1 : 0;
+}
+
+// All strings passed along with a depth are at least depth long.
+std::string_view suffix(const FFIString& str, size_t depth) {
+  return std::string_view{str.data + depth, str.len - depth};
+}
+
+void string_insertion_sort(FFIString* data, size_t len, size_t depth) {
+  for (size_t i = 1; i < len; ++i) {
+    const FFIString str = data[i];
+    const std::string_view str_suffix = suffix(str, depth);
+
+    size_t j = i;
+    for (; j > 0 && str_suffix < suffix(data[j - 1], depth); --j) {
+      data[j] = data[j - 1];
+    }
+    data[j] = str;
+  }
+}
+
+uint16_t median_of_3(uint16_t a, uint16_t b, uint16_t c) {
+  return std::max(std::min(a, b), std::min(std::max(a, b), c));
+}
+
+void multikey_quicksort(FFIString* data, size_t len, size_t depth) {
+  while (len > STRING_INSERTION_SORT_THRESHOLD) {
+    const uint16_t pivot =
+        median_of_3(char_at(data[0], depth), char_at(data[len / 2], depth),
+                    char_at(data[len - 1], depth));
+
+    // Three-way partition on the character at depth.
+    size_t lt = 0;
+    size_t gt = len;
+    for (size_t i = 0; i < gt;) {
+      const uint16_t c = char_at(data[i], depth);
+      if (c < pivot) {
+        std::swap(data[lt++], data[i++]);
+      } else if (c > pivot) {
+        std::swap(data[i], data[--gt]);
+      } else {
+        ++i;
+      }
+    }
+
+    multikey_quicksort(data, lt, depth);
+    multikey_quicksort(data + gt, len - gt, depth);
+
+    if (pivot == 0) {
+      // The strings equal to the pivot have all ended and are equal.
+      return;
+    }
+
+    data += lt;
+    len = gt - lt;
+    ++depth;
+  }
+
+  string_insertion_sort(data, len, depth);
+}
+
+// buf and chars are scratch space of at least len elements, they are only used
+// before recursing, so all levels share them.
+void string_radix_sort_impl(FFIString* data,
+                            FFIString* buf,
+                            uint16_t* chars,
+                            size_t len,
+                            size_t depth) {
+  if (len < STRING_MKQS_THRESHOLD) {
+    multikey_quicksort(data, len, depth);
+    return;
+  }
+
+  // Skip the prefix common to all strings in one pass, that stops comparing as
+  // soon as the first mismatch at depth is found for random inputs.
+  const std::string_view first = suffix(data[0], depth);
+  size_t common_len = first.size();
+  for (size_t i = 1; i < len && common_len != 0; ++i) {
+    const std::string_view other = suffix(data[i], depth);
+    const size_t max_len = std::min(common_len, other.size());
+    common_len = std::mismatch(first.begin(), first.begin() + max_len,
+                               other.begin())
+                     .first -
+                 first.begin();
+  }
+  depth += common_len;
+
+  size_t counts[STRING_RADIX] = {};
+  for (size_t i = 0; i < len; ++i) {
+    chars[i] = char_at(data[i], depth);
+    counts[chars[i]] += 1;
+  }
+
+  if (counts[0] == len) {
+    // All strings are equal.
+    return;
+  }
+
+  size_t offsets[STRING_RADIX];
+  size_t sum = 0;
+  for (size_t bucket = 0; bucket < STRING_RADIX; ++bucket) {
+    offsets[bucket] = sum;
+    sum += counts[bucket];
+  }
+
+  for (size_t i = 0; i < len; ++i) {
+    buf[offsets[chars[i]]++] = data[i];
+  }
+  std::copy_n(buf, len, data);
+
+  size_t bucket_start = counts[0];
+  for (size_t bucket = 1; bucket < STRING_RADIX; ++bucket) {
+    const size_t bucket_len = counts[bucket];
+    if (bucket_len > 1) {
+      string_radix_sort_impl(data + bucket_start, buf, chars, bucket_len,
+                             depth + 1);
+    }
+    bucket_start += bucket_len;
+  }
+}
+
+void string_radix_sort(FFIString* data, size_t len) {
+  if (len < STRING_MKQS_THRESHOLD) {
+    multikey_quicksort(data, len, 0);
+    return;
+  }
+
+  std::unique_ptr<FFIString[]> buf{new FFIString[len]};
+  std::unique_ptr<uint16_t[]> chars{new uint16_t[len]};
+
+  string_radix_sort_impl(data, buf.get(), chars.get(), len, 0);
+}
+
+// Parallel string sample sort. A sorted random sample of the input provides
+// the splitters, every thread classifies a contiguous chunk of the input by
+// binary search over them, and the strings are scattered into one bucket per
+// gap between two splitters, plus one per splitter for the strings equal to
+// it. The equal buckets are done, the others are sorted independently with
+// string_radix_sort_impl, largest first, every thread with its own scratch
+// space.
+//
+// Comparison sorts look at the whole common prefix in every classification
+// step. Here, a string that lies between two splitters shares at least the
+// shorter of its common prefixes with them with every splitter in between, so
+// the binary search skips that part. And all strings of the gap between two
+// splitters share the common prefix of those, the radix sort of the bucket
+// starts at that depth.
+
+// Below this many strings per thread, the sequential radix sort is faster.
+constexpr size_t STRING_PARALLEL_MIN_CHUNK_LEN = 4096;
+
+constexpr size_t STRING_SPLITTERS_PER_THREAD = 32;
+constexpr size_t STRING_OVERSAMPLING = 8;
+
+// The bucket of every string is kept as uint16_t between classification and
+// scatter.
+constexpr size_t STRING_MAX_SPLITTERS = 4095;
+
+size_t common_prefix_len(std::string_view a, std::string_view b) {
+  const size_t max_len = std::min(a.size(), b.size());
+  return std::mismatch(a.begin(), a.begin() + max_len, b.begin()).first -
+         a.begin();
+}
+
+struct StringSplitters {
+  // Sorted and distinct. They point into the strings of the input, which stay
+  // in place, only the FFIString values are moved.
+  std::vector<std::string_view> splitters;
+  // Common prefix length of the splitters around every gap, gap i lies between
+  // splitters i - 1 and i. 0 for the first and last gap, that are open.
+  std::vector<size_t> gap_depths;
+
+  size_t num_buckets() const { return (splitters.size() * 2) + 1; }
+
+  // Even buckets are gaps, odd ones hold the strings equal to a splitter.
+  uint16_t classify(std::string_view str) const {
+    size_t lo = 0;
+    size_t hi = splitters.size();
+    // Common prefix length of str with splitters lo - 1 and hi.
+    size_t lo_lcp = 0;
+    size_t hi_lcp = 0;
+
+    while (lo < hi) {
+      const size_t mid = lo + ((hi - lo) / 2);
+      const std::string_view splitter = splitters[mid];
+
+      const size_t skip = std::min(lo_lcp, hi_lcp);
+      const size_t lcp =
+          skip + common_prefix_len(str.substr(skip), splitter.substr(skip));
+
+      if (lcp == str.size() && lcp == splitter.size()) {
+        return static_cast<uint16_t>((mid * 2) + 1);
+      }
+
+      const bool is_less =
+          lcp == str.size() ||
+          (lcp != splitter.size() && static_cast<uint8_t>(str[lcp]) <
+                                         static_cast<uint8_t>(splitter[lcp]));
+      if (is_less) {
+        hi = mid;
+        hi_lcp = lcp;
+      } else {
+        lo = mid + 1;
+        lo_lcp = lcp;
+      }
+    }
+
+    return static_cast<uint16_t>(lo * 2);
+  }
+};
+
+StringSplitters sample_splitters(const FFIString* data,
+                                 size_t len,
+                                 size_t num_threads) {
+  const size_t max_splitters = std::min(
+      (num_threads * STRING_SPLITTERS_PER_THREAD) - 1, STRING_MAX_SPLITTERS);
+  const size_t sample_len =
+      std::min((max_splitters + 1) * STRING_OVERSAMPLING, len);
+
+  // Fixed seed, so that the same input is always split the same way.
+  std::minstd_rand rng{static_cast<uint32_t>(len)};
+  std::vector<FFIString> sample(sample_len);
+  for (FFIString& str : sample) {
+    str = data[rng() % len];
+  }
+  string_radix_sort(sample.data(), sample_len);
+
+  StringSplitters result;
+  for (size_t i = 1; i <= max_splitters; ++i) {
+    const std::string_view splitter =
+        suffix(sample[(i * sample_len) / (max_splitters + 1)], 0);
+    if (result.splitters.empty() || result.splitters.back() != splitter) {
+      result.splitters.push_back(splitter);
+    }
+  }
+
+  const size_t num_splitters = result.splitters.size();
+  result.gap_depths.resize(num_splitters + 1);
+  for (size_t i = 1; i < num_splitters; ++i) {
+    result.gap_depths[i] =
+        common_prefix_len(result.splitters[i - 1], result.splitters[i]);
+  }
+
+  return result;
+}
+
+void string_sample_sort_parallel(FFIString* data,
+                                 size_t len,
+                                 size_t num_threads) {
+  const size_t num_chunks =
+      std::min(num_threads, len / STRING_PARALLEL_MIN_CHUNK_LEN);
+  if (num_chunks <= 1) {
+    string_radix_sort(data, len);
+    return;
+  }
+
+  const StringSplitters splitters = sample_splitters(data, len, num_chunks);
+  const size_t num_buckets = splitters.num_buckets();
+
+  std::unique_ptr<FFIString[]> buf{new FFIString[len]};
+  std::unique_ptr<uint16_t[]> buckets{new uint16_t[len]};
+  // Per chunk bucket sizes, and after the prefix sum the write offsets, at
+  // [chunk_i * num_buckets + bucket].
+  std::vector<size_t> offsets(num_chunks * num_buckets);
+
+  const auto chunk_bounds = [len, num_chunks](size_t chunk_i) {
+    return std::pair{(len * chunk_i) / num_chunks,
+                     (len * (chunk_i + 1)) / num_chunks};
+  };
+
+  run_tasks(num_chunks, [&](size_t chunk_i) {
+    const auto [begin, end] = chunk_bounds(chunk_i);
+    size_t* chunk_counts = offsets.data() + (chunk_i * num_buckets);
+    for (size_t i = begin; i < end; ++i) {
+      buckets[i] = splitters.classify(suffix(data[i], 0));
+      chunk_counts[buckets[i]] += 1;
+    }
+  });
+
+  // Every chunk writes its part of a bucket after the ones of the chunks
+  // before it.
+  std::vector<size_t> bucket_starts(num_buckets + 1);
+  size_t sum = 0;
+  for (size_t bucket = 0; bucket < num_buckets; ++bucket) {
+    bucket_starts[bucket] = sum;
+    for (size_t chunk_i = 0; chunk_i < num_chunks; ++chunk_i) {
+      size_t& offset = offsets[(chunk_i * num_buckets) + bucket];
+      const size_t count = offset;
+      offset = sum;
+      sum += count;
+    }
+  }
+  bucket_starts[num_buckets] = len;
+
+  run_tasks(num_chunks, [&](size_t chunk_i) {
+    const auto [begin, end] = chunk_bounds(chunk_i);
+    size_t* chunk_offsets = offsets.data() + (chunk_i * num_buckets);
+    for (size_t i = begin; i < end; ++i) {
+      buf[chunk_offsets[buckets[i]]++] = data[i];
+    }
+  });
+
+  const auto bucket_len_of = [&bucket_starts](size_t bucket) {
+    return bucket_starts[bucket + 1] - bucket_starts[bucket];
+  };
+
+  std::vector<size_t> order(num_buckets);
+  std::iota(order.begin(), order.end(), size_t{0});
+  std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+    return bucket_len_of(a) > bucket_len_of(b);
+  });
+
+  std::atomic<size_t> next_bucket{0};
+  run_tasks(num_chunks, [&](size_t) {
+    std::vector<FFIString> scratch;
+    std::vector<uint16_t> chars;
+
+    for (size_t order_i = next_bucket.fetch_add(1); order_i < num_buckets;
+         order_i = next_bucket.fetch_add(1)) {
+      const size_t bucket = order[order_i];
+      const size_t bucket_len = bucket_len_of(bucket);
+      if (bucket_len == 0) {
+        // The remaining ones are empty too.
+        break;
+      }
+
+      FFIString* bucket_data = buf.get() + bucket_starts[bucket];
+      if (bucket % 2 == 0) {
+        const size_t depth = splitters.gap_depths[bucket / 2];
+        if (bucket_len < STRING_MKQS_THRESHOLD) {
+          multikey_quicksort(bucket_data, bucket_len, depth);
+        } else {
+          scratch.resize(std::max(scratch.size(), bucket_len));
+          chars.resize(std::max(chars.size(), bucket_len));
+          string_radix_sort_impl(bucket_data, scratch.data(), chars.data(),
+                                 bucket_len, depth);
+        }
+      }
+
+      std::copy_n(bucket_data, bucket_len, data + bucket_starts[bucket]);
+    }
+  });
+}
+}  // namespace
+
+extern "C" {
+// --- i32 ---
+
+void radix_i32(int32_t* data, size_t len) {
+  SORT_USDT_PROBE(len);
+  radix_sort<int32_t, NoPayload>(data, nullptr, len);
+}
+
+void radix_i32_with_payload(int32_t* keys, uint32_t* payload, size_t len) {
+  SORT_USDT_PROBE(len);
+  radix_sort(keys, payload, len);
+}
+
+uint32_t radix_i32_by(int32_t* data,
+                      size_t len,
+                      CompResult (*cmp_fn)(const int32_t&,
+                                           const int32_t&,
+                                           uint8_t*),
+                      uint8_t* ctx) {
+  printf("Not supported\n");
+  return 1;
+}
+
+// --- u64 ---
+
+void radix_u64(uint64_t* data, size_t len) {
+  SORT_USDT_PROBE(len);
+  radix_sort<uint64_t, NoPayload>(data, nullptr, len);
+}
+
+void radix_u64_with_payload(uint64_t* keys, uint64_t* payload, size_t len) {
+  SORT_USDT_PROBE(len);
+  radix_sort(keys, payload, len);
+}
+
+uint32_t radix_u64_by(uint64_t* data,
+                      size_t len,
+                      CompResult (*cmp_fn)(const uint64_t&,
+                                           const uint64_t&,
+                                           uint8_t*),
+                      uint8_t* ctx) {
+  printf("Not supported\n");
+  return 1;
+}
+
+// --- ffi_string ---
+
+void radix_ffi_string(FFIString* data, size_t len) {
+  SORT_USDT_PROBE(len);
+  string_radix_sort(data, len);
+}
+
+uint32_t radix_ffi_string_by(FFIString* data,
+                             size_t len,
+                             CompResult (*cmp_fn)(const FFIString&,
+                                                  const FFIString&,
+                                                  uint8_t*),
+                             uint8_t* ctx) {
+  printf("Not supported\n");
+  return 1;
+}
+
+// --- f128 ---
+
+void radix_f128(F128* data, size_t len) {
+  printf("Not supported\n");
+}
+
+uint32_t radix_f128_by(F128* data,
+                       size_t len,
+                       CompResult (*cmp_fn)(const F128&,
+                                            const F128&,
+                                            uint8_t*),
+                       uint8_t* ctx) {
+  printf("Not supported\n");
+  return 1;
+}
+
+// --- 1k ---
+
+void radix_1k(FFIOneKibiByte* data, size_t len) {
+  printf("Not supported\n");
+}
+
+uint32_t radix_1k_by(FFIOneKibiByte* data,
+                     size_t len,
+                     CompResult (*cmp_fn)(const FFIOneKibiByte&,
+                                          const FFIOneKibiByte&,
+                                          uint8_t*),
+                     uint8_t* ctx) {
+  printf("Not supported\n");
+  return 1;
+}
+
+// --- parallel ---
+
+// Only strings are sorted in parallel, see string_sample_sort_parallel.
+
+void radix_parallel_i32(int32_t* data, size_t len, size_t num_threads) {
+  printf("Not supported\n");
+}
+
+uint32_t radix_parallel_i32_by(int32_t* data,
+                               size_t len,
+                               CompResult (*cmp_fn)(const int32_t&,
+                                                    const int32_t&,
+                                                    uint8_t*),
+                               uint8_t* ctx,
+                               size_t num_threads) {
+  printf("Not supported\n");
+  return 1;
+}
+
+void radix_parallel_u64(uint64_t* data, size_t len, size_t num_threads) {
+  printf("Not supported\n");
+}
+
+uint32_t radix_parallel_u64_by(uint64_t* data,
+                               size_t len,
+                               CompResult (*cmp_fn)(const uint64_t&,
+                                                    const uint64_t&,
+                                                    uint8_t*),
+                               uint8_t* ctx,
+                               size_t num_threads) {
+  printf("Not supported\n");
+  return 1;
+}
+
+void radix_parallel_ffi_string(FFIString* data,
+                               size_t len,
+                               size_t num_threads) {
+  SORT_USDT_PROBE(len);
+  string_sample_sort_parallel(data, len, num_threads);
+}
+
+uint32_t radix_parallel_ffi_string_by(FFIString* data,
+                                      size_t len,
+                                      CompResult (*cmp_fn)(const FFIString&,
+                                                           const FFIString&,
+                                                           uint8_t*),
+                                      uint8_t* ctx,
+                                      size_t num_threads) {
+  printf("Not supported\n");
+  return 1;
+}
+
+void radix_parallel_f128(F128* data, size_t len, size_t num_threads) {
+  printf("Not supported\n");
+}
+
+uint32_t radix_parallel_f128_by(F128* data,
+                                size_t len,
+                                CompResult (*cmp_fn)(const F128&,
+                                                     const F128&,
+                                                     uint8_t*),
+                                uint8_t* ctx,
+                                size_t num_threads) {
+  printf("Not supported\n");
+  return 1;
+}
+
+void radix_parallel_1k(FFIOneKibiByte* data, size_t len, size_t num_threads) {
+  printf("Not supported\n");
+}
+
+uint32_t radix_parallel_1k_by(FFIOneKibiByte* data,
+                              size_t len,
+                              CompResult (*cmp_fn)(const FFIOneKibiByte&,
+                                                   const FFIOneKibiByte&,
+                                                   uint8_t*),
+                              uint8_t* ctx,
+                              size_t num_threads) {
+  printf("Not supported\n");
+  return 1;
+}
+
+// --- decorated ---
+
+// The radix sort is stable, equal keys keep their original order.
+DECORATED_SORT_IMPL(radix, [](uint64_t* keys, uint64_t* indices, size_t len) {
+  radix_sort(keys, indices, len);
+})
+
+// --- columnar ---
+
+COLUMNAR_SORT_IMPL(radix, [](uint64_t* keys, uint64_t* indices, size_t len) {
+  radix_sort(keys, indices, len);
+})
+}  // extern "C"
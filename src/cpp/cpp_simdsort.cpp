@@ -1,20 +1,56 @@
 // These includes are a mess. Order is important.
 
-#include "thirdparty/simdsort/common.h"
-
-#include "thirdparty/simdsort/avx2-altquicksort.h"
-
+// The kernel is compiled for AVX2 with target attributes, and only called if
+// the CPU supports it. Standard headers are included before the target region,
+// so their code is not compiled for AVX2 too.
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
 #include <stdexcept>
+#include <utility>
 
 #include <stdint.h>
 
+#include "cpu_features.h"
 #include "shared.h"
 
+#if SORT_ARCH_X86
+#include <x86intrin.h>
+
+#include "thirdparty/simdsort/common.h"
+
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx2,popcnt"))), \
+                             apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("avx2,popcnt")
+#endif
+#include "thirdparty/simdsort/avx2-altquicksort.h"
+#include "simdsort_avx2_generic.h"
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+#endif  // SORT_ARCH_X86
+
 extern "C" {
+const char* simdsort_avx2_simd_target() {
+  return cpu_features::has_avx2() ? "AVX2" : "scalar";
+}
+
 // --- i32 ---
 
 void simdsort_avx2_i32(int32_t* data, size_t len) {
-  avx2_pivotonlast_sort(data, len);
+  SORT_USDT_PROBE(len);
+#if SORT_ARCH_X86
+  if (cpu_features::has_avx2()) {
+    avx2_pivotonlast_sort(data, len);
+    return;
+  }
+#endif
+  std::sort(data, data + len);
 }
 
 uint32_t simdsort_avx2_i32_by(int32_t* data,
@@ -30,7 +66,14 @@ uint32_t simdsort_avx2_i32_by(int32_t* data,
 // --- u64 ---
 
 void simdsort_avx2_u64(uint64_t* data, size_t len) {
-  printf("Not supported\n");
+  SORT_USDT_PROBE(len);
+#if SORT_ARCH_X86
+  if (cpu_features::has_avx2()) {
+    simdsort_avx2::pivot_on_last_sort<simdsort_avx2::U64Lanes>(data, len);
+    return;
+  }
+#endif
+  std::sort(data, data + len);
 }
 
 uint32_t simdsort_avx2_u64_by(uint64_t* data,
@@ -90,4 +133,33 @@ uint32_t simdsort_avx2_1k_by(FFIOneKibiByte* data,
   printf("Not supported\n");
   return 1;
 }
+
+// --- f32 ---
+
+// The partition compares with ordered greater than, which is only a valid
+// order without NaNs.
+void simdsort_avx2_f32(F32* data, size_t len) {
+  SORT_USDT_PROBE(len);
+  float* floats = reinterpret_cast<float*>(data);
+#if SORT_ARCH_X86
+  if (cpu_features::has_avx2()) {
+    const size_t non_nan_len = move_nan_to_end(floats, len);
+    simdsort_avx2::pivot_on_last_sort<simdsort_avx2::F32Lanes>(floats,
+                                                               non_nan_len);
+    return;
+  }
+#endif
+  std::sort(reinterpret_cast<F32Cpp*>(data),
+            reinterpret_cast<F32Cpp*>(data) + len);
+}
+
+uint32_t simdsort_avx2_f32_by(F32* data,
+                              size_t len,
+                              CompResult (*cmp_fn)(const F32&,
+                                                   const F32&,
+                                                   uint8_t*),
+                              uint8_t* ctx) {
+  printf("Not supported\n");
+  return 1;
+}
 }  // extern "C"
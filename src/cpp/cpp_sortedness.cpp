@@ -0,0 +1,27 @@
+// Entry points for the presortedness metrics of sortedness.h. f32 and f64 are
+// the F32 and F64 FFI types, in the order of FloatCpp.
+
+#include <stdint.h>
+
+#include "shared.h"
+#include "sort_usdt.h"
+#include "sortedness.h"
+
+#define SORTEDNESS_IMPL(type_name, T, Key)                                    \
+  bool sortedness_is_sorted_##type_name(const T* data, size_t len) {         \
+    SORT_USDT_PROBE(len);                                                     \
+    return sortedness::is_sorted(reinterpret_cast<const Key*>(data), len);   \
+  }                                                                           \
+                                                                              \
+  void sortedness_measure_##type_name(const T* data, size_t len,             \
+                                      sortedness::Metrics* metrics) {        \
+    SORT_USDT_PROBE(len);                                                     \
+    *metrics = sortedness::measure(reinterpret_cast<const Key*>(data), len); \
+  }
+
+extern "C" {
+SORTEDNESS_IMPL(i32, int32_t, int32_t)
+SORTEDNESS_IMPL(u64, uint64_t, uint64_t)
+SORTEDNESS_IMPL(f32, F32, float)
+SORTEDNESS_IMPL(f64, F64, double)
+}  // extern "C"
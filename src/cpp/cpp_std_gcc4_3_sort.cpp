@@ -3,12 +3,40 @@
 // So limit this to integers.
 
 #include <algorithm>
+#include <functional>
 #include <stdexcept>
 
 #include <stdint.h>
 
 #include "shared.h"
 
+#ifdef RUN_PREPASS
+#include "run_prepass.h"
+#endif
+
+struct StableSort {
+  template <typename T, typename Compare>
+  static void sort(T* begin, T* end, Compare comp) {
+    std::stable_sort(begin, end, comp);
+  }
+};
+
+struct UnstableSort {
+  template <typename T, typename Compare>
+  static void sort(T* begin, T* end, Compare comp) {
+    std::sort(begin, end, comp);
+  }
+};
+
+template <typename Backend, typename T, typename Compare>
+void sort_impl(T* data, size_t len, Compare comp) {
+#ifdef RUN_PREPASS
+  run_prepass::sort<Backend>(data, len, comp);
+#else
+  Backend::sort(data, data + len, comp);
+#endif
+}
+
 template <typename T>
 struct CompareLambda {
   CompareLambda(CompResult (*i_cmp_fn)(const T&, const T&, uint8_t*),
@@ -35,7 +63,7 @@ uint32_t sort_stable_by_impl(T* data,
                              CompResult (*cmp_fn)(const T&, const T&, uint8_t*),
                              uint8_t* ctx) {
   try {
-    std::stable_sort(data, data + len, CompareLambda<T>(cmp_fn, ctx));
+    sort_impl<StableSort>(data, len, CompareLambda<T>(cmp_fn, ctx));
   } catch (...) {
     return 1;
   }
@@ -51,7 +79,7 @@ uint32_t sort_unstable_by_impl(T* data,
                                                     uint8_t*),
                                uint8_t* ctx) {
   try {
-    std::sort(data, data + len, CompareLambda<T>(cmp_fn, ctx));
+    sort_impl<UnstableSort>(data, len, CompareLambda<T>(cmp_fn, ctx));
   } catch (...) {
     return 1;
   }
@@ -65,7 +93,8 @@ extern "C" {
 // --- i32 ---
 
 void MAKE_FUNC_NAME(sort_stable, i32)(int32_t* data, size_t len) {
-  std::stable_sort(data, data + len);
+  SORT_USDT_PROBE(len);
+  sort_impl<StableSort>(data, len, std::less<int32_t>());
 }
 
 uint32_t MAKE_FUNC_NAME(sort_stable, i32_by)(
@@ -73,11 +102,23 @@ uint32_t MAKE_FUNC_NAME(sort_stable, i32_by)(
     size_t len,
     CompResult (*cmp_fn)(const int32_t&, const int32_t&, uint8_t*),
     uint8_t* ctx) {
+  SORT_USDT_PROBE(len);
   return sort_stable_by_impl(data, len, cmp_fn, ctx);
 }
 
+void MAKE_FUNC_NAME(sort_stable, i32_with_buf)(int32_t* data,
+                                               size_t len,
+                                               uint8_t* /*buf*/,
+                                               size_t /*buf_bytes*/) {
+  SORT_USDT_PROBE(len);
+  // std::stable_sort offers no way to pass in the temporary buffer, it always
+  // acquires its own.
+  MAKE_FUNC_NAME(sort_stable, i32)(data, len);
+}
+
 void MAKE_FUNC_NAME(sort_unstable, i32)(int32_t* data, size_t len) {
-  std::sort(data, data + len);
+  SORT_USDT_PROBE(len);
+  sort_impl<UnstableSort>(data, len, std::less<int32_t>());
 }
 
 uint32_t MAKE_FUNC_NAME(sort_unstable, i32_by)(
@@ -85,13 +126,15 @@ uint32_t MAKE_FUNC_NAME(sort_unstable, i32_by)(
     size_t len,
     CompResult (*cmp_fn)(const int32_t&, const int32_t&, uint8_t*),
     uint8_t* ctx) {
+  SORT_USDT_PROBE(len);
   return sort_unstable_by_impl(data, len, cmp_fn, ctx);
 }
 
 // --- u64 ---
 
 void MAKE_FUNC_NAME(sort_stable, u64)(uint64_t* data, size_t len) {
-  std::stable_sort(data, data + len);
+  SORT_USDT_PROBE(len);
+  sort_impl<StableSort>(data, len, std::less<uint64_t>());
 }
 
 uint32_t MAKE_FUNC_NAME(sort_stable, u64_by)(
@@ -99,11 +142,21 @@ uint32_t MAKE_FUNC_NAME(sort_stable, u64_by)(
     size_t len,
     CompResult (*cmp_fn)(const uint64_t&, const uint64_t&, uint8_t*),
     uint8_t* ctx) {
+  SORT_USDT_PROBE(len);
   return sort_stable_by_impl(data, len, cmp_fn, ctx);
 }
 
+void MAKE_FUNC_NAME(sort_stable, u64_with_buf)(uint64_t* data,
+                                               size_t len,
+                                               uint8_t* /*buf*/,
+                                               size_t /*buf_bytes*/) {
+  SORT_USDT_PROBE(len);
+  MAKE_FUNC_NAME(sort_stable, u64)(data, len);
+}
+
 void MAKE_FUNC_NAME(sort_unstable, u64)(uint64_t* data, size_t len) {
-  std::sort(data, data + len);
+  SORT_USDT_PROBE(len);
+  sort_impl<UnstableSort>(data, len, std::less<uint64_t>());
 }
 
 uint32_t MAKE_FUNC_NAME(sort_unstable, u64_by)(
@@ -111,6 +164,7 @@ uint32_t MAKE_FUNC_NAME(sort_unstable, u64_by)(
     size_t len,
     CompResult (*cmp_fn)(const uint64_t&, const uint64_t&, uint8_t*),
     uint8_t* ctx) {
+  SORT_USDT_PROBE(len);
   return sort_unstable_by_impl(data, len, cmp_fn, ctx);
 }
 
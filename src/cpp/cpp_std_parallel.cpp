@@ -0,0 +1,136 @@
+// std::stable_sort with std::execution::par. libstdc++ implements the parallel
+// algorithms on top of TBB, an explicit tbb::global_control caps the worker
+// count to num_threads for the duration of one sort. Without TBB, libstdc++
+// silently falls back to the sequential algorithm.
+
+#include <algorithm>
+#include <atomic>
+#include <execution>
+
+#include <stdint.h>
+
+#include <tbb/global_control.h>
+
+#include "shared.h"
+
+template <typename T>
+void sort_stable_par(T* data, size_t len, size_t num_threads) noexcept {
+  const tbb::global_control limit{
+      tbb::global_control::max_allowed_parallelism, num_threads};
+  std::stable_sort(std::execution::par, data, data + len);
+}
+
+// An exception thrown by the comparison function inside a parallel algorithm
+// calls std::terminate, so the panic is recorded instead, see
+// make_compare_fn_nothrow.
+template <typename T, typename F>
+uint32_t sort_stable_par_by_impl(T* data,
+                                 size_t len,
+                                 F cmp_fn,
+                                 uint8_t* ctx,
+                                 size_t num_threads) noexcept {
+  const tbb::global_control limit{
+      tbb::global_control::max_allowed_parallelism, num_threads};
+  std::atomic<bool> did_panic{false};
+  std::stable_sort(std::execution::par, data, data + len,
+                   make_compare_fn_nothrow<T>(cmp_fn, ctx, did_panic));
+
+  return did_panic.load() ? 1 : 0;
+}
+
+extern "C" {
+// --- i32 ---
+
+void sort_stable_sys_par_i32(int32_t* data, size_t len, size_t num_threads) {
+  SORT_USDT_PROBE(len);
+  sort_stable_par(data, len, num_threads);
+}
+
+uint32_t sort_stable_sys_par_i32_by(int32_t* data,
+                                    size_t len,
+                                    CompResult (*cmp_fn)(const int32_t&,
+                                                         const int32_t&,
+                                                         uint8_t*),
+                                    uint8_t* ctx,
+                                    size_t num_threads) {
+  SORT_USDT_PROBE(len);
+  return sort_stable_par_by_impl(data, len, cmp_fn, ctx, num_threads);
+}
+
+// --- u64 ---
+
+void sort_stable_sys_par_u64(uint64_t* data, size_t len, size_t num_threads) {
+  SORT_USDT_PROBE(len);
+  sort_stable_par(data, len, num_threads);
+}
+
+uint32_t sort_stable_sys_par_u64_by(uint64_t* data,
+                                    size_t len,
+                                    CompResult (*cmp_fn)(const uint64_t&,
+                                                         const uint64_t&,
+                                                         uint8_t*),
+                                    uint8_t* ctx,
+                                    size_t num_threads) {
+  SORT_USDT_PROBE(len);
+  return sort_stable_par_by_impl(data, len, cmp_fn, ctx, num_threads);
+}
+
+// --- ffi_string ---
+
+void sort_stable_sys_par_ffi_string(FFIString* data,
+                                    size_t len,
+                                    size_t num_threads) {
+  SORT_USDT_PROBE(len);
+  sort_stable_par(reinterpret_cast<FFIStringCpp*>(data), len, num_threads);
+}
+
+uint32_t sort_stable_sys_par_ffi_string_by(
+    FFIString* data,
+    size_t len,
+    CompResult (*cmp_fn)(const FFIString&, const FFIString&, uint8_t*),
+    uint8_t* ctx,
+    size_t num_threads) {
+  SORT_USDT_PROBE(len);
+  return sort_stable_par_by_impl(data, len, cmp_fn, ctx, num_threads);
+}
+
+// --- f128 ---
+
+void sort_stable_sys_par_f128(F128* data, size_t len, size_t num_threads) {
+  SORT_USDT_PROBE(len);
+  sort_stable_par(reinterpret_cast<F128Cpp*>(data), len, num_threads);
+}
+
+uint32_t sort_stable_sys_par_f128_by(F128* data,
+                                     size_t len,
+                                     CompResult (*cmp_fn)(const F128&,
+                                                          const F128&,
+                                                          uint8_t*),
+                                     uint8_t* ctx,
+                                     size_t num_threads) {
+  SORT_USDT_PROBE(len);
+  return sort_stable_par_by_impl(data, len, cmp_fn, ctx, num_threads);
+}
+
+// --- 1k ---
+
+void sort_stable_sys_par_1k(FFIOneKibiByte* data,
+                            size_t len,
+                            size_t num_threads) {
+  SORT_USDT_PROBE(len);
+  sort_stable_par(reinterpret_cast<FFIOneKiloByteCpp*>(data), len,
+                  num_threads);
+}
+
+uint32_t sort_stable_sys_par_1k_by(
+    FFIOneKibiByte* data,
+    size_t len,
+    CompResult (*cmp_fn)(const FFIOneKibiByte&,
+                         const FFIOneKibiByte&,
+                         uint8_t*),
+    uint8_t* ctx,
+    size_t num_threads) {
+  SORT_USDT_PROBE(len);
+  return sort_stable_par_by_impl(data, len, cmp_fn, ctx, num_threads);
+}
+}  // extern "C"
@@ -33,6 +33,28 @@ uint32_t sort_unstable_by_impl(T* data,
   return 0;
 }
 
+template <typename T>
+uint32_t sort_stable_by_key_impl(T* data,
+                                 size_t len,
+                                 KeyDescriptor key) noexcept {
+  const bool is_valid_key =
+      with_key_compare<T>(key, [data, len](auto comp) {
+        std::stable_sort(data, data + len, comp);
+      });
+
+  return is_valid_key ? 0 : 1;
+}
+
+template <typename T>
+uint32_t sort_unstable_by_key_impl(T* data,
+                                   size_t len,
+                                   KeyDescriptor key) noexcept {
+  const bool is_valid_key = with_key_compare<T>(
+      key, [data, len](auto comp) { std::sort(data, data + len, comp); });
+
+  return is_valid_key ? 0 : 1;
+}
+
 #if defined(STD_LIB_SYS)
 #define MAKE_FUNC_NAME(name, suffix) name##_sys_##suffix
 #elif defined(STD_LIB_LIBCXX)
@@ -43,6 +65,7 @@ extern "C" {
 // --- i32 ---
 
 void MAKE_FUNC_NAME(sort_stable, i32)(int32_t* data, size_t len) {
+  SORT_USDT_PROBE(len);
   std::stable_sort(data, data + len);
 }
 
@@ -51,10 +74,22 @@ uint32_t MAKE_FUNC_NAME(sort_stable, i32_by)(
     size_t len,
     CompResult (*cmp_fn)(const int32_t&, const int32_t&, uint8_t*),
     uint8_t* ctx) {
+  SORT_USDT_PROBE(len);
   return sort_stable_by_impl(data, len, cmp_fn, ctx);
 }
 
+void MAKE_FUNC_NAME(sort_stable, i32_with_buf)(int32_t* data,
+                                               size_t len,
+                                               uint8_t* /*buf*/,
+                                               size_t /*buf_bytes*/) {
+  SORT_USDT_PROBE(len);
+  // std::stable_sort offers no way to pass in the temporary buffer, it always
+  // acquires its own.
+  MAKE_FUNC_NAME(sort_stable, i32)(data, len);
+}
+
 void MAKE_FUNC_NAME(sort_unstable, i32)(int32_t* data, size_t len) {
+  SORT_USDT_PROBE(len);
   std::sort(data, data + len);
 }
 
@@ -63,12 +98,42 @@ uint32_t MAKE_FUNC_NAME(sort_unstable, i32_by)(
     size_t len,
     CompResult (*cmp_fn)(const int32_t&, const int32_t&, uint8_t*),
     uint8_t* ctx) {
+  SORT_USDT_PROBE(len);
   return sort_unstable_by_impl(data, len, cmp_fn, ctx);
 }
 
+void MAKE_FUNC_NAME(sort_unstable, i32_partial)(int32_t* data,
+                                                size_t len,
+                                                size_t k) {
+  SORT_USDT_PROBE(len);
+  std::partial_sort(data, data + k, data + len);
+}
+
+void MAKE_FUNC_NAME(sort_unstable, i32_select)(int32_t* data,
+                                               size_t len,
+                                               size_t index) {
+  SORT_USDT_PROBE(len);
+  std::nth_element(data, data + index, data + len);
+}
+
+uint32_t MAKE_FUNC_NAME(sort_stable, i32_by_key)(int32_t* data,
+                                               size_t len,
+                                               KeyDescriptor key) {
+  SORT_USDT_PROBE(len);
+  return sort_stable_by_key_impl(data, len, key);
+}
+
+uint32_t MAKE_FUNC_NAME(sort_unstable, i32_by_key)(int32_t* data,
+                                                 size_t len,
+                                                 KeyDescriptor key) {
+  SORT_USDT_PROBE(len);
+  return sort_unstable_by_key_impl(data, len, key);
+}
+
 // --- u64 ---
 
 void MAKE_FUNC_NAME(sort_stable, u64)(uint64_t* data, size_t len) {
+  SORT_USDT_PROBE(len);
   std::stable_sort(data, data + len);
 }
 
@@ -77,10 +142,20 @@ uint32_t MAKE_FUNC_NAME(sort_stable, u64_by)(
     size_t len,
     CompResult (*cmp_fn)(const uint64_t&, const uint64_t&, uint8_t*),
     uint8_t* ctx) {
+  SORT_USDT_PROBE(len);
   return sort_stable_by_impl(data, len, cmp_fn, ctx);
 }
 
+void MAKE_FUNC_NAME(sort_stable, u64_with_buf)(uint64_t* data,
+                                               size_t len,
+                                               uint8_t* /*buf*/,
+                                               size_t /*buf_bytes*/) {
+  SORT_USDT_PROBE(len);
+  MAKE_FUNC_NAME(sort_stable, u64)(data, len);
+}
+
 void MAKE_FUNC_NAME(sort_unstable, u64)(uint64_t* data, size_t len) {
+  SORT_USDT_PROBE(len);
   std::sort(data, data + len);
 }
 
@@ -89,12 +164,50 @@ uint32_t MAKE_FUNC_NAME(sort_unstable, u64_by)(
     size_t len,
     CompResult (*cmp_fn)(const uint64_t&, const uint64_t&, uint8_t*),
     uint8_t* ctx) {
+  SORT_USDT_PROBE(len);
   return sort_unstable_by_impl(data, len, cmp_fn, ctx);
 }
 
+void MAKE_FUNC_NAME(sort_unstable, u64_batch)(uint64_t* data,
+                                              const size_t* offsets,
+                                              size_t n_slices) {
+  sort_slices(data, offsets, n_slices, [](uint64_t* slice, size_t slice_len) {
+    std::sort(slice, slice + slice_len);
+  });
+}
+
+void MAKE_FUNC_NAME(sort_unstable, u64_partial)(uint64_t* data,
+                                                size_t len,
+                                                size_t k) {
+  SORT_USDT_PROBE(len);
+  std::partial_sort(data, data + k, data + len);
+}
+
+void MAKE_FUNC_NAME(sort_unstable, u64_select)(uint64_t* data,
+                                               size_t len,
+                                               size_t index) {
+  SORT_USDT_PROBE(len);
+  std::nth_element(data, data + index, data + len);
+}
+
+uint32_t MAKE_FUNC_NAME(sort_stable, u64_by_key)(uint64_t* data,
+                                               size_t len,
+                                               KeyDescriptor key) {
+  SORT_USDT_PROBE(len);
+  return sort_stable_by_key_impl(data, len, key);
+}
+
+uint32_t MAKE_FUNC_NAME(sort_unstable, u64_by_key)(uint64_t* data,
+                                                 size_t len,
+                                                 KeyDescriptor key) {
+  SORT_USDT_PROBE(len);
+  return sort_unstable_by_key_impl(data, len, key);
+}
+
 // --- FFIString ---
 
 void MAKE_FUNC_NAME(sort_stable, ffi_string)(FFIString* data, size_t len) {
+  SORT_USDT_PROBE(len);
   std::stable_sort(reinterpret_cast<FFIStringCpp*>(data),
                    reinterpret_cast<FFIStringCpp*>(data) + len);
 }
@@ -104,11 +217,13 @@ uint32_t MAKE_FUNC_NAME(sort_stable, ffi_string_by)(
     size_t len,
     CompResult (*cmp_fn)(const FFIString&, const FFIString&, uint8_t*),
     uint8_t* ctx) {
+  SORT_USDT_PROBE(len);
   return sort_stable_by_impl(reinterpret_cast<FFIStringCpp*>(data), len, cmp_fn,
                              ctx);
 }
 
 void MAKE_FUNC_NAME(sort_unstable, ffi_string)(FFIString* data, size_t len) {
+  SORT_USDT_PROBE(len);
   std::sort(reinterpret_cast<FFIStringCpp*>(data),
             reinterpret_cast<FFIStringCpp*>(data) + len);
 }
@@ -118,13 +233,69 @@ uint32_t MAKE_FUNC_NAME(sort_unstable, ffi_string_by)(
     size_t len,
     CompResult (*cmp_fn)(const FFIString&, const FFIString&, uint8_t*),
     uint8_t* ctx) {
+  SORT_USDT_PROBE(len);
   return sort_unstable_by_impl(reinterpret_cast<FFIStringCpp*>(data), len,
                                cmp_fn, ctx);
 }
 
+void MAKE_FUNC_NAME(sort_unstable, ffi_string_partial)(FFIString* data,
+                                                       size_t len,
+                                                       size_t k) {
+  SORT_USDT_PROBE(len);
+  FFIStringCpp* data_cpp = reinterpret_cast<FFIStringCpp*>(data);
+  std::partial_sort(data_cpp, data_cpp + k, data_cpp + len);
+}
+
+void MAKE_FUNC_NAME(sort_unstable, ffi_string_select)(FFIString* data,
+                                                      size_t len,
+                                                      size_t index) {
+  SORT_USDT_PROBE(len);
+  FFIStringCpp* data_cpp = reinterpret_cast<FFIStringCpp*>(data);
+  std::nth_element(data_cpp, data_cpp + index, data_cpp + len);
+}
+
+// --- arena_string ---
+
+void MAKE_FUNC_NAME(sort_stable, arena_string)(FFIArenaString* data,
+                                               size_t len) {
+  SORT_USDT_PROBE(len);
+  std::stable_sort(reinterpret_cast<FFIArenaStringCpp*>(data),
+                   reinterpret_cast<FFIArenaStringCpp*>(data) + len);
+}
+
+uint32_t MAKE_FUNC_NAME(sort_stable, arena_string_by)(
+    FFIArenaString* data,
+    size_t len,
+    CompResult (*cmp_fn)(const FFIArenaString&,
+                         const FFIArenaString&,
+                         uint8_t*),
+    uint8_t* ctx) {
+  SORT_USDT_PROBE(len);
+  return sort_stable_by_impl(data, len, cmp_fn, ctx);
+}
+
+void MAKE_FUNC_NAME(sort_unstable, arena_string)(FFIArenaString* data,
+                                                 size_t len) {
+  SORT_USDT_PROBE(len);
+  std::sort(reinterpret_cast<FFIArenaStringCpp*>(data),
+            reinterpret_cast<FFIArenaStringCpp*>(data) + len);
+}
+
+uint32_t MAKE_FUNC_NAME(sort_unstable, arena_string_by)(
+    FFIArenaString* data,
+    size_t len,
+    CompResult (*cmp_fn)(const FFIArenaString&,
+                         const FFIArenaString&,
+                         uint8_t*),
+    uint8_t* ctx) {
+  SORT_USDT_PROBE(len);
+  return sort_unstable_by_impl(data, len, cmp_fn, ctx);
+}
+
 // --- f128 ---
 
 void MAKE_FUNC_NAME(sort_stable, f128)(F128* data, size_t len) {
+  SORT_USDT_PROBE(len);
   std::stable_sort(reinterpret_cast<F128Cpp*>(data),
                    reinterpret_cast<F128Cpp*>(data) + len);
 }
@@ -135,11 +306,13 @@ uint32_t MAKE_FUNC_NAME(sort_stable, f128_by)(F128* data,
                                                                    const F128&,
                                                                    uint8_t*),
                                               uint8_t* ctx) {
+  SORT_USDT_PROBE(len);
   return sort_stable_by_impl(reinterpret_cast<F128Cpp*>(data), len, cmp_fn,
                              ctx);
 }
 
 void MAKE_FUNC_NAME(sort_unstable, f128)(F128* data, size_t len) {
+  SORT_USDT_PROBE(len);
   std::sort(reinterpret_cast<F128Cpp*>(data),
             reinterpret_cast<F128Cpp*>(data) + len);
 }
@@ -149,13 +322,95 @@ uint32_t MAKE_FUNC_NAME(sort_unstable, f128_by)(
     size_t len,
     CompResult (*cmp_fn)(const F128&, const F128&, uint8_t*),
     uint8_t* ctx) {
+  SORT_USDT_PROBE(len);
   return sort_unstable_by_impl(reinterpret_cast<F128Cpp*>(data), len, cmp_fn,
                                ctx);
 }
 
+void MAKE_FUNC_NAME(sort_unstable, f128_partial)(F128* data,
+                                                 size_t len,
+                                                 size_t k) {
+  SORT_USDT_PROBE(len);
+  F128Cpp* data_cpp = reinterpret_cast<F128Cpp*>(data);
+  std::partial_sort(data_cpp, data_cpp + k, data_cpp + len);
+}
+
+void MAKE_FUNC_NAME(sort_unstable, f128_select)(F128* data,
+                                                size_t len,
+                                                size_t index) {
+  SORT_USDT_PROBE(len);
+  F128Cpp* data_cpp = reinterpret_cast<F128Cpp*>(data);
+  std::nth_element(data_cpp, data_cpp + index, data_cpp + len);
+}
+
+// --- f32 ---
+
+void MAKE_FUNC_NAME(sort_stable, f32)(F32* data, size_t len) {
+  SORT_USDT_PROBE(len);
+  std::stable_sort(reinterpret_cast<F32Cpp*>(data),
+                   reinterpret_cast<F32Cpp*>(data) + len);
+}
+
+uint32_t MAKE_FUNC_NAME(sort_stable, f32_by)(
+    F32* data,
+    size_t len,
+    CompResult (*cmp_fn)(const F32&, const F32&, uint8_t*),
+    uint8_t* ctx) {
+  SORT_USDT_PROBE(len);
+  return sort_stable_by_impl(data, len, cmp_fn, ctx);
+}
+
+void MAKE_FUNC_NAME(sort_unstable, f32)(F32* data, size_t len) {
+  SORT_USDT_PROBE(len);
+  std::sort(reinterpret_cast<F32Cpp*>(data),
+            reinterpret_cast<F32Cpp*>(data) + len);
+}
+
+uint32_t MAKE_FUNC_NAME(sort_unstable, f32_by)(
+    F32* data,
+    size_t len,
+    CompResult (*cmp_fn)(const F32&, const F32&, uint8_t*),
+    uint8_t* ctx) {
+  SORT_USDT_PROBE(len);
+  return sort_unstable_by_impl(data, len, cmp_fn, ctx);
+}
+
+// --- f64 ---
+
+void MAKE_FUNC_NAME(sort_stable, f64)(F64* data, size_t len) {
+  SORT_USDT_PROBE(len);
+  std::stable_sort(reinterpret_cast<F64Cpp*>(data),
+                   reinterpret_cast<F64Cpp*>(data) + len);
+}
+
+uint32_t MAKE_FUNC_NAME(sort_stable, f64_by)(
+    F64* data,
+    size_t len,
+    CompResult (*cmp_fn)(const F64&, const F64&, uint8_t*),
+    uint8_t* ctx) {
+  SORT_USDT_PROBE(len);
+  return sort_stable_by_impl(data, len, cmp_fn, ctx);
+}
+
+void MAKE_FUNC_NAME(sort_unstable, f64)(F64* data, size_t len) {
+  SORT_USDT_PROBE(len);
+  std::sort(reinterpret_cast<F64Cpp*>(data),
+            reinterpret_cast<F64Cpp*>(data) + len);
+}
+
+uint32_t MAKE_FUNC_NAME(sort_unstable, f64_by)(
+    F64* data,
+    size_t len,
+    CompResult (*cmp_fn)(const F64&, const F64&, uint8_t*),
+    uint8_t* ctx) {
+  SORT_USDT_PROBE(len);
+  return sort_unstable_by_impl(data, len, cmp_fn, ctx);
+}
+
 // --- 1k ---
 
 void MAKE_FUNC_NAME(sort_stable, 1k)(FFIOneKibiByte* data, size_t len) {
+  SORT_USDT_PROBE(len);
   std::stable_sort(reinterpret_cast<FFIOneKiloByteCpp*>(data),
                    reinterpret_cast<FFIOneKiloByteCpp*>(data) + len);
 }
@@ -167,11 +422,13 @@ uint32_t MAKE_FUNC_NAME(sort_stable,
                                                     const FFIOneKibiByte&,
                                                     uint8_t*),
                                uint8_t* ctx) {
+  SORT_USDT_PROBE(len);
   return sort_stable_by_impl(reinterpret_cast<FFIOneKiloByteCpp*>(data), len,
                              cmp_fn, ctx);
 }
 
 void MAKE_FUNC_NAME(sort_unstable, 1k)(FFIOneKibiByte* data, size_t len) {
+  SORT_USDT_PROBE(len);
   std::sort(reinterpret_cast<FFIOneKiloByteCpp*>(data),
             reinterpret_cast<FFIOneKiloByteCpp*>(data) + len);
 }
@@ -183,7 +440,58 @@ uint32_t MAKE_FUNC_NAME(sort_unstable,
                                                     const FFIOneKibiByte&,
                                                     uint8_t*),
                                uint8_t* ctx) {
+  SORT_USDT_PROBE(len);
   return sort_unstable_by_impl(reinterpret_cast<FFIOneKiloByteCpp*>(data), len,
                                cmp_fn, ctx);
 }
+
+uint32_t MAKE_FUNC_NAME(sort_stable, 1k_by_key)(FFIOneKibiByte* data,
+                                               size_t len,
+                                               KeyDescriptor key) {
+  SORT_USDT_PROBE(len);
+  return sort_stable_by_key_impl(reinterpret_cast<FFIOneKiloByteCpp*>(data),
+                                 len, key);
+}
+
+uint32_t MAKE_FUNC_NAME(sort_unstable, 1k_by_key)(FFIOneKibiByte* data,
+                                                 size_t len,
+                                                 KeyDescriptor key) {
+  SORT_USDT_PROBE(len);
+  return sort_unstable_by_key_impl(reinterpret_cast<FFIOneKiloByteCpp*>(data),
+                                   len, key);
+}
+
+// --- counted ---
+
+#if defined(STD_LIB_SYS)
+COUNTED_SORT_IMPL(sort_stable_sys, [](auto begin, auto end) {
+  std::stable_sort(begin, end);
+})
+COUNTED_SORT_IMPL(sort_unstable_sys,
+                  [](auto begin, auto end) { std::sort(begin, end); })
+#elif defined(STD_LIB_LIBCXX)
+COUNTED_SORT_IMPL(sort_stable_libcxx, [](auto begin, auto end) {
+  std::stable_sort(begin, end);
+})
+COUNTED_SORT_IMPL(sort_unstable_libcxx,
+                  [](auto begin, auto end) { std::sort(begin, end); })
+#endif
+
+// --- indirect ---
+
+#if defined(STD_LIB_SYS)
+INDIRECT_SORT_IMPL(sort_stable_sys, [](auto begin, auto end, auto comp) {
+  std::stable_sort(begin, end, comp);
+})
+INDIRECT_SORT_IMPL(sort_unstable_sys, [](auto begin, auto end, auto comp) {
+  std::sort(begin, end, comp);
+})
+#elif defined(STD_LIB_LIBCXX)
+INDIRECT_SORT_IMPL(sort_stable_libcxx, [](auto begin, auto end, auto comp) {
+  std::stable_sort(begin, end, comp);
+})
+INDIRECT_SORT_IMPL(sort_unstable_libcxx, [](auto begin, auto end, auto comp) {
+  std::sort(begin, end, comp);
+})
+#endif
 }  // extern "C"
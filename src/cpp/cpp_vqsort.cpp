@@ -1,18 +1,260 @@
+// With CPP_SPLIT_INSTANTIATION the sorts for every Highway target are compiled
+// in cpp_vqsort_inst.cpp, see build.rs.
+#if defined(CPP_SPLIT_INSTANTIATION)
+#define VQSORT_DECLARATIONS_ONLY
+#endif
+
 #include "thirdparty/highway/sort/vqsort.h"
+#include "thirdparty/highway/targets.h"
 
+#include <cstdlib>
+#include <limits>
 #include <stdexcept>
+#include <type_traits>
+#include <vector>
 
 #include <stdint.h>
 
+#include "cpu_features.h"
+#include "run_accumulator.h"
 #include "shared.h"
 
+// The vendored Highway does not include targets.cc, which normally provides
+// runtime target detection for HWY_DYNAMIC_DISPATCH. The wrapper is the only
+// translation unit using Highway, so a minimal version lives here.
+namespace hwy {
+int64_t SupportedTargets() {
+  int64_t targets = HWY_STATIC_TARGET | HWY_EMU128 | HWY_SCALAR;
+#if SORT_ARCH_X86
+  targets |= HWY_SSE2;
+  if (cpu_features::has_ssse3()) {
+    targets |= HWY_SSSE3;
+  }
+  if (cpu_features::has_sse4()) {
+    targets |= HWY_SSE4;
+  }
+  if (cpu_features::has_avx2()) {
+    targets |= HWY_AVX2;
+  }
+  // VQSORT_NO_AVX512 caps the dispatch at AVX2, to compare against the AVX2
+  // only sorts on a machine that has AVX-512.
+  static const bool no_avx512 = std::getenv("VQSORT_NO_AVX512") != nullptr;
+  if (cpu_features::has_avx512_skx() && !no_avx512) {
+    targets |= HWY_AVX3;
+  }
+  if (cpu_features::has_avx512_icl() && !no_avx512) {
+    targets |= HWY_AVX3_DL;
+  }
+#elif defined(__aarch64__)
+  // All AArch64 server CPUs have the AES extension HWY_NEON assumes.
+  targets |= HWY_NEON;
+  // The fixed length targets generate better code, but are only valid if the
+  // vector length matches.
+  if (cpu_features::has_sve()) {
+    targets |= HWY_SVE;
+    if (cpu_features::sve_vector_bytes() == 32) {
+      targets |= HWY_SVE_256;
+    }
+  }
+  if (cpu_features::has_sve2()) {
+    targets |= HWY_SVE2;
+    if (cpu_features::sve_vector_bytes() == 16) {
+      targets |= HWY_SVE2_128;
+    }
+  }
+#endif
+  // RISC-V and POWER have no runtime dispatch in the vendored Highway, the
+  // static target is RVV if built with the V extension, see build.rs.
+  return targets;
+}
+
+ChosenTarget& GetChosenTarget() {
+  static ChosenTarget chosen;
+  return chosen;
+}
+}  // namespace hwy
+
+// The vendored vqsort pads partial vectors with the largest key and value,
+// which overwrites the payload of pairs whose key is the largest one. Those are
+// moved to the end and only the remaining prefix is handed to vqsort.
+template <typename P>
+void sort_pairs(P* pairs, size_t len) {
+  using K = decltype(P::key);
+  const size_t below_max_len = move_to_end(pairs, len, [](const P& pair) {
+    return pair.key == std::numeric_limits<K>::max();
+  });
+  hwy::Sorter{}(pairs, below_max_len, hwy::SortAscending{});
+}
+
+// Packs each key together with its index, sorts the pairs by key only and
+// writes out the resulting permutation. The order of equal keys is
+// unspecified.
+template <typename P, typename K, typename F>
+uint32_t argsort_impl(const K* keys, size_t len, uint32_t* indices, F to_key) {
+  try {
+    std::vector<P> pairs(len);
+    for (size_t i = 0; i < len; ++i) {
+      pairs[i].key = to_key(keys[i]);
+      pairs[i].value = static_cast<uint32_t>(i);
+    }
+
+    sort_pairs(pairs.data(), len);
+
+    for (size_t i = 0; i < len; ++i) {
+      indices[i] = static_cast<uint32_t>(pairs[i].value);
+    }
+  } catch (...) {
+    return 1;
+  }
+
+  return 0;
+}
+
+// The vendored vqsort pads partial vectors with the largest finite value, which
+// sorts below infinity and would displace it. NaNs and positive infinities are
+// moved to the end and only the remaining prefix is handed to vqsort.
+template <typename T>
+void sort_float(T* keys, size_t len) {
+  const size_t non_nan_len = move_nan_to_end(keys, len);
+  const size_t finite_len = move_to_end(keys, non_nan_len, [](T key) {
+    return key == std::numeric_limits<T>::infinity();
+  });
+  hwy::Sorter{}(keys, finite_len, hwy::SortAscending{});
+}
+
+// vqsort is unstable. The stable variants pack every key together with its
+// index into a twice as wide integer, key in the upper half, and sort those.
+// Equal keys are then ordered by their index, which makes the whole sort
+// stable, at the cost of a temporary buffer of the packed values. i32 keys and
+// indices fit into a u64 for any len below 2^32, everything else is packed into
+// a hwy::uint128_t.
+inline uint64_t to_ordered_bits(int32_t key) {
+  // Flipping the sign bit maps i32 order onto u32 order.
+  return static_cast<uint32_t>(key) ^ 0x8000'0000u;
+}
+
+inline uint64_t to_ordered_bits(uint64_t key) { return key; }
+
+template <typename K>
+K from_ordered_bits(uint64_t bits) {
+  if constexpr (sizeof(K) == 4) {
+    return static_cast<K>(static_cast<uint32_t>(bits) ^ 0x8000'0000u);
+  } else {
+    return static_cast<K>(bits);
+  }
+}
+
+template <typename Packed>
+Packed pack(uint64_t key_bits, size_t index) {
+  if constexpr (std::is_same_v<Packed, hwy::uint128_t>) {
+    return hwy::uint128_t{static_cast<uint64_t>(index), key_bits};
+  } else {
+    return (key_bits << 32) | static_cast<uint64_t>(index);
+  }
+}
+
+template <typename Packed>
+uint64_t packed_key(Packed packed) {
+  if constexpr (std::is_same_v<Packed, hwy::uint128_t>) {
+    return packed.hi;
+  } else {
+    return packed >> 32;
+  }
+}
+
+template <typename Packed>
+size_t packed_index(Packed packed) {
+  if constexpr (std::is_same_v<Packed, hwy::uint128_t>) {
+    return static_cast<size_t>(packed.lo);
+  } else {
+    return static_cast<size_t>(packed & 0xFFFF'FFFFu);
+  }
+}
+
+// payload may be null, otherwise it is permuted the same way as keys.
+template <typename Packed, typename K, typename P>
+void stable_sort_packed(K* keys, P* payload, size_t len) {
+  std::vector<Packed> packed(len);
+  for (size_t i = 0; i < len; ++i) {
+    packed[i] = pack<Packed>(to_ordered_bits(keys[i]), i);
+  }
+
+  hwy::Sorter{}(packed.data(), len, hwy::SortAscending{});
+
+  for (size_t i = 0; i < len; ++i) {
+    keys[i] = from_ordered_bits<K>(packed_key(packed[i]));
+  }
+
+  if (payload != nullptr) {
+    const std::vector<P> original_payload(payload, payload + len);
+    for (size_t i = 0; i < len; ++i) {
+      payload[i] = original_payload[packed_index(packed[i])];
+    }
+  }
+}
+
+template <typename K, typename P = uint64_t>
+void stable_sort(K* keys, size_t len, P* payload = nullptr) {
+  if constexpr (sizeof(K) == 4) {
+    if (len <= std::numeric_limits<uint32_t>::max()) {
+      stable_sort_packed<uint64_t>(keys, payload, len);
+      return;
+    }
+  }
+
+  stable_sort_packed<hwy::uint128_t>(keys, payload, len);
+}
+
+// For sort_decorated. Sorting every key together with its index as one 128 bit
+// integer costs about the same as sorting hwy::K64V64 by key, and breaks ties
+// by index, which makes it stable.
+void sort_decorated_pairs(uint64_t* keys, uint64_t* indices, size_t len) {
+  std::vector<hwy::uint128_t> packed(len);
+  for (size_t i = 0; i < len; ++i) {
+    packed[i] = pack<hwy::uint128_t>(keys[i], indices[i]);
+  }
+
+  hwy::Sorter{}(packed.data(), len, hwy::SortAscending{});
+
+  for (size_t i = 0; i < len; ++i) {
+    indices[i] = packed_index(packed[i]);
+  }
+}
+
 extern "C" {
+// Name of the Highway target the sorts dispatch to on this machine, the best
+// one that was both compiled in and is supported by the CPU.
+const char* vqsort_simd_target() {
+  const int64_t targets = hwy::SupportedTargets() & HWY_TARGETS;
+  return hwy::TargetName(targets & -targets);
+}
+
 // --- i32 ---
 
 void vqsort_i32(int32_t* data, size_t len) {
+  SORT_USDT_PROBE(len);
   hwy::Sorter{}(data, len, hwy::SortAscending{});
 }
 
+void vqsort_i32_desc(int32_t* data, size_t len) {
+  SORT_USDT_PROBE(len);
+  hwy::Sorter{}(data, len, hwy::SortDescending{});
+}
+
+void vqsort_i32_select(int32_t* data, size_t len, size_t index) {
+  SORT_USDT_PROBE(len);
+  hwy::VQSelect(data, len, index, hwy::SortAscending{});
+}
+
+size_t vqsort_partition_i32(int32_t* data, size_t len, const int32_t* pivot) {
+  SORT_USDT_PROBE(len);
+  return partition_le_as_lt(data, len, *pivot,
+                            [](int32_t* data, size_t len, int32_t pivot) {
+                              return hwy::VQPartition(data, len, pivot,
+                                                      hwy::SortAscending{});
+                            });
+}
+
 uint32_t vqsort_i32_by(int32_t* data,
                        size_t len,
                        CompResult (*cmp_fn)(const int32_t&,
@@ -26,9 +268,43 @@ uint32_t vqsort_i32_by(int32_t* data,
 // --- u64 ---
 
 void vqsort_u64(uint64_t* data, size_t len) {
+  SORT_USDT_PROBE(len);
   hwy::Sorter{}(data, len, hwy::SortAscending{});
 }
 
+void vqsort_u64_desc(uint64_t* data, size_t len) {
+  SORT_USDT_PROBE(len);
+  hwy::Sorter{}(data, len, hwy::SortDescending{});
+}
+
+void vqsort_u64_select(uint64_t* data, size_t len, size_t index) {
+  SORT_USDT_PROBE(len);
+  hwy::VQSelect(data, len, index, hwy::SortAscending{});
+}
+
+size_t vqsort_partition_u64(uint64_t* data, size_t len, const uint64_t* pivot) {
+  SORT_USDT_PROBE(len);
+  return partition_le_as_lt(data, len, *pivot,
+                            [](uint64_t* data, size_t len, uint64_t pivot) {
+                              return hwy::VQPartition(data, len, pivot,
+                                                      hwy::SortAscending{});
+                            });
+}
+
+// No need to special case the short slices, vqsort sends everything up to its
+// base case size straight to the sorting networks.
+void vqsort_u64_batch(uint64_t* data, const size_t* offsets, size_t n_slices) {
+  const hwy::Sorter sorter{};
+  sort_slices(data, offsets, n_slices,
+              [&sorter](uint64_t* slice, size_t slice_len) {
+                sorter(slice, slice_len, hwy::SortAscending{});
+              });
+}
+
+RUN_ACCUMULATOR_IMPL(vqsort, [](uint64_t* data, size_t len) {
+  hwy::Sorter{}(data, len, hwy::SortAscending{});
+})
+
 uint32_t vqsort_u64_by(uint64_t* data,
                        size_t len,
                        CompResult (*cmp_fn)(const uint64_t&,
@@ -86,4 +362,219 @@ uint32_t vqsort_1k_by(FFIOneKibiByte* data,
   printf("Not supported\n");
   return 1;
 }
+
+// --- i16 ---
+
+void vqsort_i16(int16_t* data, size_t len) {
+  SORT_USDT_PROBE(len);
+  hwy::Sorter{}(data, len, hwy::SortAscending{});
+}
+
+uint32_t vqsort_i16_by(int16_t* data,
+                       size_t len,
+                       CompResult (*cmp_fn)(const int16_t&,
+                                            const int16_t&,
+                                            uint8_t*),
+                       uint8_t* ctx) {
+  printf("Not supported\n");
+  return 1;
+}
+
+// --- u16 ---
+
+void vqsort_u16(uint16_t* data, size_t len) {
+  SORT_USDT_PROBE(len);
+  hwy::Sorter{}(data, len, hwy::SortAscending{});
+}
+
+uint32_t vqsort_u16_by(uint16_t* data,
+                       size_t len,
+                       CompResult (*cmp_fn)(const uint16_t&,
+                                            const uint16_t&,
+                                            uint8_t*),
+                       uint8_t* ctx) {
+  printf("Not supported\n");
+  return 1;
+}
+
+// --- f32 ---
+
+void vqsort_f32(F32* data, size_t len) {
+  SORT_USDT_PROBE(len);
+  sort_float(reinterpret_cast<float*>(data), len);
+}
+
+uint32_t vqsort_f32_by(F32* data,
+                       size_t len,
+                       CompResult (*cmp_fn)(const F32&,
+                                            const F32&,
+                                            uint8_t*),
+                       uint8_t* ctx) {
+  printf("Not supported\n");
+  return 1;
+}
+
+// --- f64 ---
+
+void vqsort_f64(F64* data, size_t len) {
+  SORT_USDT_PROBE(len);
+  sort_float(reinterpret_cast<double*>(data), len);
+}
+
+uint32_t vqsort_f64_by(F64* data,
+                       size_t len,
+                       CompResult (*cmp_fn)(const F64&,
+                                            const F64&,
+                                            uint8_t*),
+                       uint8_t* ctx) {
+  printf("Not supported\n");
+  return 1;
+}
+
+// --- u128 ---
+
+void vqsort_u128(hwy::uint128_t* data, size_t len) {
+  SORT_USDT_PROBE(len);
+  hwy::Sorter{}(data, len, hwy::SortAscending{});
+}
+
+void vqsort_u128_desc(hwy::uint128_t* data, size_t len) {
+  SORT_USDT_PROBE(len);
+  hwy::Sorter{}(data, len, hwy::SortDescending{});
+}
+
+// --- key-value ---
+
+void vqsort_kv_u64(hwy::K64V64* data, size_t len) {
+  SORT_USDT_PROBE(len);
+  sort_pairs(data, len);
+}
+
+uint32_t vqsort_argsort_i32(const int32_t* keys,
+                            size_t len,
+                            uint32_t* indices) {
+  SORT_USDT_PROBE(len);
+  // Flipping the sign bit maps i32 order onto u32 order.
+  return argsort_impl<hwy::K32V32>(keys, len, indices, [](int32_t key) {
+    return static_cast<uint32_t>(key) ^ 0x8000'0000u;
+  });
+}
+
+uint32_t vqsort_argsort_u64(const uint64_t* keys,
+                            size_t len,
+                            uint32_t* indices) {
+  SORT_USDT_PROBE(len);
+  return argsort_impl<hwy::K64V64>(keys, len, indices,
+                                   [](uint64_t key) { return key; });
+}
+
+// --- decorated ---
+
+DECORATED_SORT_IMPL(vqsort, sort_decorated_pairs)
+
+// --- columnar ---
+
+COLUMNAR_SORT_IMPL(vqsort, sort_decorated_pairs)
+
+// --- packed records ---
+
+// unsigned __int128 has the layout of hwy::uint128_t on little-endian targets,
+// the low half first.
+PACKED_SORT_IMPL_U128(
+    vqsort,
+    [](uint64_t* words, size_t len) {
+      hwy::Sorter{}(words, len, hwy::SortAscending{});
+    },
+    [](unsigned __int128* words, size_t len) {
+      hwy::Sorter{}(reinterpret_cast<hwy::uint128_t*>(words), len,
+                    hwy::SortAscending{});
+    })
+
+// --- stable ---
+
+void vqsort_stable_i32(int32_t* data, size_t len) {
+  SORT_USDT_PROBE(len);
+  stable_sort(data, len);
+}
+
+void vqsort_stable_i32_with_payload(int32_t* keys,
+                                    uint32_t* payload,
+                                    size_t len) {
+  SORT_USDT_PROBE(len);
+  stable_sort(keys, len, payload);
+}
+
+uint32_t vqsort_stable_i32_by(int32_t* data,
+                              size_t len,
+                              CompResult (*cmp_fn)(const int32_t&,
+                                                   const int32_t&,
+                                                   uint8_t*),
+                              uint8_t* ctx) {
+  printf("Not supported\n");
+  return 1;
+}
+
+void vqsort_stable_u64(uint64_t* data, size_t len) {
+  SORT_USDT_PROBE(len);
+  stable_sort(data, len);
+}
+
+void vqsort_stable_u64_with_payload(uint64_t* keys,
+                                    uint64_t* payload,
+                                    size_t len) {
+  SORT_USDT_PROBE(len);
+  stable_sort(keys, len, payload);
+}
+
+uint32_t vqsort_stable_u64_by(uint64_t* data,
+                              size_t len,
+                              CompResult (*cmp_fn)(const uint64_t&,
+                                                   const uint64_t&,
+                                                   uint8_t*),
+                              uint8_t* ctx) {
+  printf("Not supported\n");
+  return 1;
+}
+
+void vqsort_stable_ffi_string(FFIString* data, size_t len) {
+  printf("Not supported\n");
+}
+
+uint32_t vqsort_stable_ffi_string_by(FFIString* data,
+                                     size_t len,
+                                     CompResult (*cmp_fn)(const FFIString&,
+                                                          const FFIString&,
+                                                          uint8_t*),
+                                     uint8_t* ctx) {
+  printf("Not supported\n");
+  return 1;
+}
+
+void vqsort_stable_f128(F128* data, size_t len) {
+  printf("Not supported\n");
+}
+
+uint32_t vqsort_stable_f128_by(F128* data,
+                               size_t len,
+                               CompResult (*cmp_fn)(const F128&,
+                                                    const F128&,
+                                                    uint8_t*),
+                               uint8_t* ctx) {
+  printf("Not supported\n");
+  return 1;
+}
+
+void vqsort_stable_1k(FFIOneKibiByte* data, size_t len) {
+  printf("Not supported\n");
+}
+
+uint32_t vqsort_stable_1k_by(FFIOneKibiByte* data,
+                             size_t len,
+                             CompResult (*cmp_fn)(const FFIOneKibiByte&,
+                                                  const FFIOneKibiByte&,
+                                                  uint8_t*),
+                             uint8_t* ctx) {
+  printf("Not supported\n");
+  return 1;
+}
 }  // extern "C"
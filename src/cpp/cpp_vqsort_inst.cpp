@@ -0,0 +1,5 @@
+// The definitions of vqsort.h for every Highway target, compiled separately
+// from cpp_vqsort.cpp with CPP_SPLIT_INSTANTIATION. Changes to the wrapper then
+// don't recompile them, and both compile in parallel.
+
+#include "thirdparty/highway/sort/vqsort.h"
@@ -1,5 +1,9 @@
 #include "thirdparty/wikisort/WikiSort.h"
 
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <new>
 #include <stdexcept>
 
 #include <stdint.h>
@@ -10,10 +14,141 @@
 
 #include "shared.h"
 
+namespace {
+// Where the cache of WikiSort comes from and how large it is, in elements.
+enum class CacheMode : uint32_t {
+  // 512 elements on the stack, the vendored default.
+  Stack = 0,
+  // CacheConfig::fixed_len elements on the heap, 0 disables the cache.
+  Fixed = 1,
+  // sqrt((n + 1) / 2) + 1, the size of the A blocks at the largest level of
+  // merges, enough to never fall back to the internal buffer or in-place
+  // merges.
+  Sqrt = 2,
+  // (n + 1) / 2, everything fits and it turns into a standard merge sort.
+  Half = 3,
+};
+
+// The cache of a single sort.
+struct CacheConfig {
+  CacheMode mode = CacheMode::Stack;
+  // Only used by CacheMode::Fixed.
+  size_t fixed_len = 0;
+  // Heap caches of more elements fail to allocate, to test the fallbacks.
+  size_t max_alloc_len = SIZE_MAX;
+};
+
+size_t heap_cache_len(const CacheConfig& cache, size_t len) {
+  const size_t half_len = (len + 1) / 2;
+  switch (cache.mode) {
+    case CacheMode::Fixed:
+      return std::min(cache.fixed_len, half_len);
+    case CacheMode::Sqrt:
+      return static_cast<size_t>(std::sqrt(half_len)) + 1;
+    default:
+      return half_len;
+  }
+}
+
+template <typename T>
+std::unique_ptr<T[]> alloc_cache(size_t cache_len, size_t max_alloc_len) {
+  if (cache_len == 0 || cache_len > max_alloc_len) {
+    return nullptr;
+  }
+  return std::unique_ptr<T[]>{new (std::nothrow) T[cache_len]};
+}
+
+template <Wiki::MergeMode merge_mode = Wiki::MergeMode::Plain,
+          typename T,
+          typename Compare = std::less<>>
+void wiki_sort(T* data,
+               size_t len,
+               Compare comp = {},
+               const CacheConfig& cache = {}) {
+  if (cache.mode == CacheMode::Stack || len < 8) {
+    Wiki::Sort<merge_mode>(data, data + len, comp);
+    return;
+  }
+
+  // Same fallbacks as the DYNAMIC_CACHE version of WikiSort, if the
+  // allocation fails try 512 and then no cache at all.
+  size_t cache_len = heap_cache_len(cache, len);
+  std::unique_ptr<T[]> cache_buf =
+      alloc_cache<T>(cache_len, cache.max_alloc_len);
+  if (!cache_buf && cache_len > 512) {
+    cache_len = 512;
+    cache_buf = alloc_cache<T>(cache_len, cache.max_alloc_len);
+  }
+  if (!cache_buf) {
+    cache_len = 0;
+  }
+
+  Wiki::SortWithCache<merge_mode>(data, data + len, comp, cache_buf.get(),
+                                  cache_len);
+}
+
+// How the merges through the cache of the _merge_mode entry points of f128 and
+// 1k move elements, all other entry points use Wiki::MergeMode::Plain. Same
+// order as Wiki::MergeMode and MergeMode on the Rust side, returns 1 for
+// unknown modes.
+template <typename T>
+uint32_t sort_merge_mode_impl(T* data, size_t len, uint32_t mode) noexcept {
+  using Wiki::MergeMode;
+  switch (static_cast<MergeMode>(mode)) {
+    case MergeMode::Plain:
+      wiki_sort<MergeMode::Plain>(data, len);
+      return 0;
+    case MergeMode::Prefetch:
+      wiki_sort<MergeMode::Prefetch>(data, len);
+      return 0;
+    case MergeMode::Blockwise:
+      wiki_sort<MergeMode::Blockwise>(data, len);
+      return 0;
+    default:
+      return 1;
+  }
+}
+
+// The cache of the _cache_mode entry points, mode is one of CacheMode and
+// fixed_len is only used by CacheMode::Fixed. Returns 1 for unknown modes.
+template <typename T>
+uint32_t sort_cache_mode_impl(T* data,
+                              size_t len,
+                              uint32_t mode,
+                              size_t fixed_len,
+                              size_t max_alloc_len) noexcept {
+  if (mode > static_cast<uint32_t>(CacheMode::Half)) {
+    return 1;
+  }
+
+  wiki_sort(data, len, std::less<>{},
+            CacheConfig{static_cast<CacheMode>(mode), fixed_len,
+                        max_alloc_len});
+  return 0;
+}
+
+// Uses the caller provided buffer as cache, WikiSort copies elements into it
+// so this is only valid for trivial types.
+template <typename T>
+void sort_with_buf_impl(T* data, size_t len, uint8_t* buf, size_t buf_bytes) {
+  void* cache_ptr = buf;
+  size_t space = buf_bytes;
+  if (buf == nullptr ||
+      std::align(alignof(T), sizeof(T), cache_ptr, space) == nullptr) {
+    space = 0;
+  }
+  const size_t cache_len = std::min(space / sizeof(T), (len + 1) / 2);
+
+  Wiki::SortWithCache(data, data + len, std::less<>{},
+                      cache_len > 0 ? static_cast<T*>(cache_ptr) : nullptr,
+                      cache_len);
+}
+}  // namespace
+
 template <typename T, typename F>
 uint32_t sort_by_impl(T* data, size_t len, F cmp_fn, uint8_t* ctx) noexcept {
   try {
-    Wiki::Sort(data, data + len, make_compare_fn<T>(cmp_fn, ctx));
+    wiki_sort(data, len, make_compare_fn<T>(cmp_fn, ctx));
   } catch (...) {
     return 1;
   }
@@ -25,7 +160,8 @@ extern "C" {
 // --- i32 ---
 
 void wikisort_stable_i32(int32_t* data, size_t len) {
-  Wiki::Sort(data, data + len);
+  SORT_USDT_PROBE(len);
+  wiki_sort(data, len);
 }
 
 uint32_t wikisort_stable_i32_by(int32_t* data,
@@ -34,13 +170,34 @@ uint32_t wikisort_stable_i32_by(int32_t* data,
                                                      const int32_t&,
                                                      uint8_t*),
                                 uint8_t* ctx) {
+  SORT_USDT_PROBE(len);
   return sort_by_impl(data, len, cmp_fn, ctx);
 }
 
+void wikisort_stable_i32_with_buf(int32_t* data,
+                                  size_t len,
+                                  uint8_t* buf,
+                                  size_t buf_bytes) {
+  SORT_USDT_PROBE(len);
+  sort_with_buf_impl(data, len, buf, buf_bytes);
+}
+
+// mode is one of CacheMode, returns 1 for unknown ones.
+uint32_t wikisort_stable_i32_cache_mode(int32_t* data,
+                                        size_t len,
+                                        uint32_t mode,
+                                        size_t fixed_len,
+                                        size_t max_alloc_len) {
+  SORT_USDT_PROBE(len);
+  return sort_cache_mode_impl(data, len, mode, fixed_len,
+                              max_alloc_len);
+}
+
 // --- u64 ---
 
 void wikisort_stable_u64(uint64_t* data, size_t len) {
-  Wiki::Sort(data, data + len);
+  SORT_USDT_PROBE(len);
+  wiki_sort(data, len);
 }
 
 uint32_t wikisort_stable_u64_by(uint64_t* data,
@@ -49,14 +206,34 @@ uint32_t wikisort_stable_u64_by(uint64_t* data,
                                                      const uint64_t&,
                                                      uint8_t*),
                                 uint8_t* ctx) {
+  SORT_USDT_PROBE(len);
   return sort_by_impl(data, len, cmp_fn, ctx);
 }
 
+void wikisort_stable_u64_with_buf(uint64_t* data,
+                                  size_t len,
+                                  uint8_t* buf,
+                                  size_t buf_bytes) {
+  SORT_USDT_PROBE(len);
+  sort_with_buf_impl(data, len, buf, buf_bytes);
+}
+
+// mode is one of CacheMode, returns 1 for unknown ones.
+uint32_t wikisort_stable_u64_cache_mode(uint64_t* data,
+                                        size_t len,
+                                        uint32_t mode,
+                                        size_t fixed_len,
+                                        size_t max_alloc_len) {
+  SORT_USDT_PROBE(len);
+  return sort_cache_mode_impl(data, len, mode, fixed_len,
+                              max_alloc_len);
+}
+
 // --- ffi_string ---
 
 void wikisort_stable_ffi_string(FFIString* data, size_t len) {
-  Wiki::Sort(reinterpret_cast<FFIStringCpp*>(data),
-             reinterpret_cast<FFIStringCpp*>(data) + len);
+  SORT_USDT_PROBE(len);
+  wiki_sort(reinterpret_cast<FFIStringCpp*>(data), len);
 }
 
 uint32_t wikisort_stable_ffi_string_by(FFIString* data,
@@ -65,14 +242,15 @@ uint32_t wikisort_stable_ffi_string_by(FFIString* data,
                                                             const FFIString&,
                                                             uint8_t*),
                                        uint8_t* ctx) {
+  SORT_USDT_PROBE(len);
   return sort_by_impl(reinterpret_cast<FFIStringCpp*>(data), len, cmp_fn, ctx);
 }
 
 // --- f128 ---
 
 void wikisort_stable_f128(F128* data, size_t len) {
-  Wiki::Sort(reinterpret_cast<F128Cpp*>(data),
-             reinterpret_cast<F128Cpp*>(data) + len);
+  SORT_USDT_PROBE(len);
+  wiki_sort(reinterpret_cast<F128Cpp*>(data), len);
 }
 
 uint32_t wikisort_stable_f128_by(F128* data,
@@ -81,14 +259,34 @@ uint32_t wikisort_stable_f128_by(F128* data,
                                                       const F128&,
                                                       uint8_t*),
                                  uint8_t* ctx) {
+  SORT_USDT_PROBE(len);
   return sort_by_impl(reinterpret_cast<F128Cpp*>(data), len, cmp_fn, ctx);
 }
 
+// mode is one of CacheMode, returns 1 for unknown ones.
+uint32_t wikisort_stable_f128_cache_mode(F128* data,
+                                         size_t len,
+                                         uint32_t mode,
+                                         size_t fixed_len,
+                                         size_t max_alloc_len) {
+  SORT_USDT_PROBE(len);
+  return sort_cache_mode_impl(reinterpret_cast<F128Cpp*>(data), len, mode,
+                              fixed_len, max_alloc_len);
+}
+
+// mode is one of Wiki::MergeMode, returns 1 for unknown ones.
+uint32_t wikisort_stable_f128_merge_mode(F128* data,
+                                         size_t len,
+                                         uint32_t mode) {
+  SORT_USDT_PROBE(len);
+  return sort_merge_mode_impl(reinterpret_cast<F128Cpp*>(data), len, mode);
+}
+
 // --- 1k ---
 
 void wikisort_stable_1k(FFIOneKibiByte* data, size_t len) {
-  Wiki::Sort(reinterpret_cast<FFIOneKiloByteCpp*>(data),
-             reinterpret_cast<FFIOneKiloByteCpp*>(data) + len);
+  SORT_USDT_PROBE(len);
+  wiki_sort(reinterpret_cast<FFIOneKiloByteCpp*>(data), len);
 }
 
 uint32_t wikisort_stable_1k_by(FFIOneKibiByte* data,
@@ -97,7 +295,28 @@ uint32_t wikisort_stable_1k_by(FFIOneKibiByte* data,
                                                     const FFIOneKibiByte&,
                                                     uint8_t*),
                                uint8_t* ctx) {
+  SORT_USDT_PROBE(len);
   return sort_by_impl(reinterpret_cast<FFIOneKiloByteCpp*>(data), len, cmp_fn,
                       ctx);
 }
+
+// mode is one of CacheMode, returns 1 for unknown ones.
+uint32_t wikisort_stable_1k_cache_mode(FFIOneKibiByte* data,
+                                       size_t len,
+                                       uint32_t mode,
+                                       size_t fixed_len,
+                                       size_t max_alloc_len) {
+  SORT_USDT_PROBE(len);
+  return sort_cache_mode_impl(reinterpret_cast<FFIOneKiloByteCpp*>(data), len,
+                              mode, fixed_len, max_alloc_len);
+}
+
+// mode is one of Wiki::MergeMode, returns 1 for unknown ones.
+uint32_t wikisort_stable_1k_merge_mode(FFIOneKibiByte* data,
+                                       size_t len,
+                                       uint32_t mode) {
+  SORT_USDT_PROBE(len);
+  return sort_merge_mode_impl(reinterpret_cast<FFIOneKiloByteCpp*>(data), len,
+                              mode);
+}
 }  // extern "C"
@@ -0,0 +1,155 @@
+#pragma once
+
+// Runtime CPU feature detection for the SIMD wrappers. The kernels are compiled
+// for their instruction set with target attributes instead of -march=native,
+// so that one binary works on any x86-64 or AArch64 host, and are only called
+// if the CPU running the binary supports them.
+
+#if defined(__x86_64__) || defined(__i386__)
+#define SORT_ARCH_X86 1
+#else
+#define SORT_ARCH_X86 0
+#endif
+
+#include <cstddef>
+
+#if defined(__aarch64__) && defined(__linux__)
+#include <sys/auxv.h>
+#include <sys/prctl.h>
+#endif
+
+#if defined(__linux__)
+#include <unistd.h>
+#endif
+
+namespace cpu_features {
+
+inline bool has_ssse3() noexcept {
+#if SORT_ARCH_X86
+  __builtin_cpu_init();
+  static const bool result = __builtin_cpu_supports("ssse3");
+  return result;
+#else
+  return false;
+#endif
+}
+
+inline bool has_sse4() noexcept {
+#if SORT_ARCH_X86
+  __builtin_cpu_init();
+  static const bool result =
+      has_ssse3() && __builtin_cpu_supports("sse4.1") &&
+      __builtin_cpu_supports("sse4.2") && __builtin_cpu_supports("pclmul") &&
+      __builtin_cpu_supports("aes");
+  return result;
+#else
+  return false;
+#endif
+}
+
+// Haswell and Zen 1 and newer.
+inline bool has_avx2() noexcept {
+#if SORT_ARCH_X86
+  __builtin_cpu_init();
+  static const bool result =
+      has_sse4() && __builtin_cpu_supports("avx2") &&
+      __builtin_cpu_supports("bmi") && __builtin_cpu_supports("bmi2") &&
+      __builtin_cpu_supports("fma") && __builtin_cpu_supports("f16c");
+  return result;
+#else
+  return false;
+#endif
+}
+
+// Skylake-X and Zen 4 and newer. Baseline of the x86-simd-sort 32 and 64-bit
+// kernels and of the Highway AVX3 target.
+inline bool has_avx512_skx() noexcept {
+#if SORT_ARCH_X86
+  __builtin_cpu_init();
+  static const bool result =
+      has_avx2() && __builtin_cpu_supports("avx512f") &&
+      __builtin_cpu_supports("avx512cd") && __builtin_cpu_supports("avx512dq") &&
+      __builtin_cpu_supports("avx512bw") && __builtin_cpu_supports("avx512vl");
+  return result;
+#else
+  return false;
+#endif
+}
+
+// The compress store the x86-simd-sort 16-bit kernel needs, Icelake and Zen 4
+// and newer.
+inline bool has_avx512_vbmi2() noexcept {
+#if SORT_ARCH_X86
+  __builtin_cpu_init();
+  static const bool result =
+      has_avx512_skx() && __builtin_cpu_supports("avx512vbmi2");
+  return result;
+#else
+  return false;
+#endif
+}
+
+// Icelake and Zen 4 and newer. Baseline of the Highway AVX3_DL target.
+inline bool has_avx512_icl() noexcept {
+#if SORT_ARCH_X86
+  __builtin_cpu_init();
+  static const bool result = has_avx512_vbmi2() &&
+                             __builtin_cpu_supports("avx512vbmi") &&
+                             __builtin_cpu_supports("avx512vnni") &&
+                             __builtin_cpu_supports("avx512bitalg") &&
+                             __builtin_cpu_supports("avx512vpopcntdq") &&
+                             __builtin_cpu_supports("vpclmulqdq") &&
+                             __builtin_cpu_supports("vaes") &&
+                             __builtin_cpu_supports("gfni");
+  return result;
+#else
+  return false;
+#endif
+}
+
+// Graviton 3 and newer.
+inline bool has_sve() noexcept {
+#if defined(__aarch64__) && defined(__linux__) && defined(HWCAP_SVE)
+  static const bool result = (getauxval(AT_HWCAP) & HWCAP_SVE) != 0;
+  return result;
+#else
+  return false;
+#endif
+}
+
+// Graviton 4 and newer.
+inline bool has_sve2() noexcept {
+#if defined(__aarch64__) && defined(__linux__) && defined(HWCAP2_SVE2)
+  static const bool result = (getauxval(AT_HWCAP2) & HWCAP2_SVE2) != 0;
+  return result;
+#else
+  return false;
+#endif
+}
+
+// Current SVE vector length in bytes, 0 without SVE. 32 on Graviton 3, 16 on
+// Graviton 4.
+inline int sve_vector_bytes() noexcept {
+#if defined(__aarch64__) && defined(__linux__) && defined(PR_SVE_GET_VL)
+  static const int result =
+      has_sve() ? (prctl(PR_SVE_GET_VL) & PR_SVE_VL_LEN_MASK) : 0;
+  return result;
+#else
+  return 0;
+#endif
+}
+
+// Size of the L1 data cache in bytes, 0 if unknown.
+inline size_t l1d_cache_bytes() noexcept {
+#if defined(__linux__) && defined(_SC_LEVEL1_DCACHE_SIZE)
+  static const size_t result = [] {
+    const long bytes = sysconf(_SC_LEVEL1_DCACHE_SIZE);
+    return bytes > 0 ? static_cast<size_t>(bytes) : size_t{0};
+  }();
+  return result;
+#else
+  return 0;
+#endif
+}
+
+}  // namespace cpu_features
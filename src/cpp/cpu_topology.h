@@ -0,0 +1,276 @@
+#pragma once
+
+// Thread placement policies on top of the CPU topology in sysfs, the CPUs,
+// their SMT siblings, the last level cache they share and their NUMA node.
+// Like numa_util.h it doesn't depend on libnuma, elsewhere than Linux there is
+// no topology and placement requests are ignored.
+//
+// A placement maps thread ids 0 to num_threads - 1 to the CPUs each thread
+// may run on:
+// - Compact fills all SMT siblings of a core, then the cores of one last
+//   level cache, then the caches of one node, before moving on.
+// - Scatter spreads consecutive threads across nodes first, then across the
+//   last level caches of a node, then across cores. SMT siblings are only
+//   used once every core has a thread.
+// - PhysicalCores puts one thread on every core, in compact order, and only
+//   then starts over on the second SMT sibling of each.
+// - PerCache spreads the threads evenly across the last level caches, the
+//   CCXs of AMD Zen, and lets each run on any CPU of its cache.
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+#include "numa_util.h"
+
+namespace cpu_topology {
+
+enum class Placement : uint32_t {
+  None = 0,  // Threads run wherever the scheduler puts them.
+  Compact = 1,
+  Scatter = 2,
+  PhysicalCores = 3,
+  PerCache = 4,
+};
+
+struct Cpu {
+  int id;
+  int node;
+  int package;
+  int cache;      // Lowest CPU id that shares the last level cache.
+  int core;       // Lowest CPU id of the SMT siblings.
+  int smt_index;  // Position among the SMT siblings.
+};
+
+namespace detail {
+inline std::vector<int> read_list(const std::string& path) {
+  std::vector<int> ids;
+  numa_util::detail::for_each_in_sysfs_list(
+      path.c_str(), [&ids](int id) { ids.push_back(id); });
+  return ids;
+}
+
+inline int read_int(const std::string& path, int fallback) {
+  FILE* file = std::fopen(path.c_str(), "r");
+  if (file == nullptr) {
+    return fallback;
+  }
+
+  int value = fallback;
+  if (std::fscanf(file, "%d", &value) != 1) {
+    value = fallback;
+  }
+  std::fclose(file);
+  return value;
+}
+
+// Lowest CPU id sharing the highest level cache of cpu, or -1.
+inline int last_level_cache(const std::string& cpu_dir) {
+  int best_level = 0;
+  int cache = -1;
+  for (int index = 0;; ++index) {
+    const std::string index_dir =
+        cpu_dir + "/cache/index" + std::to_string(index);
+    const int level = read_int(index_dir + "/level", -1);
+    if (level < 0) {
+      break;
+    }
+
+    const std::vector<int> shared = read_list(index_dir + "/shared_cpu_list");
+    if (level > best_level && !shared.empty()) {
+      best_level = level;
+      cache = *std::min_element(shared.begin(), shared.end());
+    }
+  }
+  return cache;
+}
+}  // namespace detail
+
+// The online CPUs, ordered by id. Empty if the topology can't be read.
+// sysfs_root is only ever changed by tests.
+inline std::vector<Cpu> read_cpus(
+    const std::string& sysfs_root = "/sys/devices/system") {
+  std::vector<Cpu> cpus;
+
+  for (int id : detail::read_list(sysfs_root + "/cpu/online")) {
+    const std::string cpu_dir = sysfs_root + "/cpu/cpu" + std::to_string(id);
+
+    std::vector<int> siblings =
+        detail::read_list(cpu_dir + "/topology/thread_siblings_list");
+    if (siblings.empty()) {
+      siblings.push_back(id);
+    }
+    std::sort(siblings.begin(), siblings.end());
+
+    Cpu cpu{};
+    cpu.id = id;
+    cpu.package =
+        detail::read_int(cpu_dir + "/topology/physical_package_id", 0);
+    cpu.core = siblings.front();
+    cpu.smt_index = static_cast<int>(
+        std::find(siblings.begin(), siblings.end(), id) - siblings.begin());
+    cpu.cache = detail::last_level_cache(cpu_dir);
+    if (cpu.cache < 0) {
+      cpu.cache = cpu.core;
+    }
+    cpus.push_back(cpu);
+  }
+
+  for (int node = 0; node < numa_util::kMaxNodes; ++node) {
+    const std::vector<int> node_cpus = detail::read_list(
+        sysfs_root + "/node/node" + std::to_string(node) + "/cpulist");
+    for (Cpu& cpu : cpus) {
+      if (std::find(node_cpus.begin(), node_cpus.end(), cpu.id) !=
+          node_cpus.end()) {
+        cpu.node = node;
+      }
+    }
+  }
+
+  return cpus;
+}
+
+// The CPUs of every thread, empty for Placement::None or if cpus is empty.
+inline std::vector<std::vector<int>> place_threads(std::vector<Cpu> cpus,
+                                                   Placement placement,
+                                                   int num_threads) {
+  std::vector<std::vector<int>> thread_cpus;
+  if (placement == Placement::None || cpus.empty() || num_threads <= 0) {
+    return thread_cpus;
+  }
+
+  const auto compact_key = [](const Cpu& cpu) {
+    return std::make_tuple(cpu.node, cpu.package, cpu.cache, cpu.core,
+                           cpu.smt_index);
+  };
+  std::sort(cpus.begin(), cpus.end(), [&](const Cpu& a, const Cpu& b) {
+    return compact_key(a) < compact_key(b);
+  });
+
+  if (placement == Placement::PerCache) {
+    std::vector<std::vector<int>> caches;
+    for (size_t i = 0; i < cpus.size(); ++i) {
+      if (i == 0 || cpus[i].cache != cpus[i - 1].cache ||
+          cpus[i].node != cpus[i - 1].node) {
+        caches.emplace_back();
+      }
+      caches.back().push_back(cpus[i].id);
+    }
+
+    // Consecutive threads share a cache if there are more threads than
+    // caches, otherwise every thread gets its own.
+    for (int thread = 0; thread < num_threads; ++thread) {
+      thread_cpus.push_back(caches[thread * caches.size() / num_threads]);
+    }
+    return thread_cpus;
+  }
+
+  if (placement == Placement::PhysicalCores) {
+    std::stable_sort(cpus.begin(), cpus.end(), [](const Cpu& a, const Cpu& b) {
+      return a.smt_index < b.smt_index;
+    });
+  } else if (placement == Placement::Scatter) {
+    // Rank of every CPU's core within its cache, and of its cache within its
+    // node, in compact order.
+    std::vector<std::tuple<int, int, int, int, int>> keys;
+    int core_rank = 0;
+    int cache_rank = 0;
+    for (size_t i = 0; i < cpus.size(); ++i) {
+      const Cpu& cpu = cpus[i];
+      if (i > 0) {
+        const Cpu& prev = cpus[i - 1];
+        if (cpu.node != prev.node) {
+          cache_rank = 0;
+          core_rank = 0;
+        } else if (cpu.cache != prev.cache) {
+          ++cache_rank;
+          core_rank = 0;
+        } else if (cpu.core != prev.core) {
+          ++core_rank;
+        }
+      }
+      keys.emplace_back(cpu.smt_index, core_rank, cache_rank, cpu.node,
+                        cpu.id);
+    }
+
+    std::sort(keys.begin(), keys.end());
+    for (size_t i = 0; i < keys.size(); ++i) {
+      cpus[i].id = std::get<4>(keys[i]);
+    }
+  }
+
+  for (int thread = 0; thread < num_threads; ++thread) {
+    thread_cpus.push_back({cpus[thread % cpus.size()].id});
+  }
+  return thread_cpus;
+}
+
+// The CPUs of every thread on this machine, see place_threads.
+inline std::vector<std::vector<int>> place_threads(Placement placement,
+                                                   int num_threads) {
+  static const std::vector<Cpu> cpus = read_cpus();
+  return place_threads(cpus, placement, num_threads);
+}
+
+// Restricts the calling thread to cpus. Does nothing for an empty list.
+inline bool pin_thread_to_cpus(const std::vector<int>& cpus) noexcept {
+#if defined(__linux__)
+  if (cpus.empty()) {
+    return false;
+  }
+
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (int cpu : cpus) {
+    if (cpu < CPU_SETSIZE) {
+      CPU_SET(cpu, &set);
+    }
+  }
+  return sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+  (void)cpus;
+  return false;
+#endif
+}
+
+// Pins the calling thread to cpus for the lifetime of the object, and
+// restores the previous affinity afterwards.
+class ScopedCpuPin {
+ public:
+  explicit ScopedCpuPin(const std::vector<int>& cpus) noexcept {
+#if defined(__linux__)
+    _has_saved = !cpus.empty() &&
+                 sched_getaffinity(0, sizeof(_saved), &_saved) == 0;
+    if (_has_saved) {
+      pin_thread_to_cpus(cpus);
+    }
+#else
+    (void)cpus;
+#endif
+  }
+
+  ScopedCpuPin(const ScopedCpuPin&) = delete;
+  ScopedCpuPin& operator=(const ScopedCpuPin&) = delete;
+
+  ~ScopedCpuPin() {
+#if defined(__linux__)
+    if (_has_saved) {
+      sched_setaffinity(0, sizeof(_saved), &_saved);
+    }
+#endif
+  }
+
+ private:
+#if defined(__linux__)
+  cpu_set_t _saved;
+  bool _has_saved = false;
+#endif
+};
+
+}  // namespace cpu_topology
@@ -0,0 +1,46 @@
+#pragma once
+
+// qsort compatible sorts for C code, see c_fast_qsort.cpp. Calls to qsort and
+// the glibc qsort_r can be replaced by fast_qsort and fast_qsort_r without
+// other changes.
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Element types with a natural order that fast_qsort can sort with inlined
+// comparisons.
+enum fast_qsort_type {
+  FAST_QSORT_I32,
+  FAST_QSORT_U32,
+  FAST_QSORT_I64,
+  FAST_QSORT_U64,
+};
+
+// Same arguments and result as qsort.
+void fast_qsort(void* base,
+                size_t nmemb,
+                size_t size,
+                int (*compar)(const void*, const void*));
+
+// Same arguments and result as the glibc qsort_r, arg is passed on as the last
+// argument of compar.
+void fast_qsort_r(void* base,
+                  size_t nmemb,
+                  size_t size,
+                  int (*compar)(const void*, const void*, void*),
+                  void* arg);
+
+// Tells fast_qsort that compar is the natural order of type, ascending. Calls
+// with compar and elements of that size then sort without calling compar. Meant
+// to be called at startup, it's safe to call concurrently with fast_qsort.
+// Returns 0 on success and -1 if type is unknown or too many comparison
+// functions are registered already.
+int fast_qsort_register(int (*compar)(const void*, const void*),
+                        enum fast_qsort_type type);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,3281 @@
+#pragma once
+
+// Generated by util/generate_cpp_network.py, do not edit.
+//
+// Sorting networks for the lengths 2 to FIXED_NETWORK_MAX_LEN, with the length
+// known at compile time. All compare-exchanges are branchless, so the time is
+// independent of the input order.
+
+#include <cstddef>
+
+namespace fixed_network_sort {
+
+constexpr size_t FIXED_NETWORK_MAX_LEN = 32;
+
+template <typename T>
+inline void cmp_swap(T* v, size_t a, size_t b) noexcept {
+  const T x = v[a];
+  const T y = v[b];
+  const bool should_swap = y < x;
+  v[a] = should_swap ? y : x;
+  v[b] = should_swap ? x : y;
+}
+
+template <size_t N>
+struct FixedNetwork;
+
+template <>
+struct FixedNetwork<0> {
+  template <typename T>
+  static void sort(T*) noexcept {}
+};
+
+template <>
+struct FixedNetwork<1> {
+  template <typename T>
+  static void sort(T*) noexcept {}
+};
+
+template <>
+struct FixedNetwork<2> {
+  template <typename T>
+  static void sort(T* v) noexcept {
+    // 1 compare-exchanges, depth 1.
+    cmp_swap(v, 0, 1);
+  }
+};
+
+template <>
+struct FixedNetwork<3> {
+  template <typename T>
+  static void sort(T* v) noexcept {
+    // 3 compare-exchanges, depth 3.
+    cmp_swap(v, 0, 2);
+
+    cmp_swap(v, 0, 1);
+
+    cmp_swap(v, 1, 2);
+  }
+};
+
+template <>
+struct FixedNetwork<4> {
+  template <typename T>
+  static void sort(T* v) noexcept {
+    // 5 compare-exchanges, depth 3.
+    cmp_swap(v, 0, 2);
+    cmp_swap(v, 1, 3);
+
+    cmp_swap(v, 0, 1);
+    cmp_swap(v, 2, 3);
+
+    cmp_swap(v, 1, 2);
+  }
+};
+
+template <>
+struct FixedNetwork<5> {
+  template <typename T>
+  static void sort(T* v) noexcept {
+    // 9 compare-exchanges, depth 6.
+    cmp_swap(v, 0, 4);
+
+    cmp_swap(v, 0, 2);
+    cmp_swap(v, 1, 3);
+
+    cmp_swap(v, 2, 4);
+
+    cmp_swap(v, 0, 1);
+    cmp_swap(v, 2, 3);
+
+    cmp_swap(v, 1, 4);
+
+    cmp_swap(v, 1, 2);
+    cmp_swap(v, 3, 4);
+  }
+};
+
+template <>
+struct FixedNetwork<6> {
+  template <typename T>
+  static void sort(T* v) noexcept {
+    // 12 compare-exchanges, depth 6.
+    cmp_swap(v, 0, 4);
+    cmp_swap(v, 1, 5);
+
+    cmp_swap(v, 0, 2);
+    cmp_swap(v, 1, 3);
+
+    cmp_swap(v, 2, 4);
+    cmp_swap(v, 3, 5);
+
+    cmp_swap(v, 0, 1);
+    cmp_swap(v, 2, 3);
+    cmp_swap(v, 4, 5);
+
+    cmp_swap(v, 1, 4);
+
+    cmp_swap(v, 1, 2);
+    cmp_swap(v, 3, 4);
+  }
+};
+
+template <>
+struct FixedNetwork<7> {
+  template <typename T>
+  static void sort(T* v) noexcept {
+    // 16 compare-exchanges, depth 6.
+    cmp_swap(v, 0, 4);
+    cmp_swap(v, 1, 5);
+    cmp_swap(v, 2, 6);
+
+    cmp_swap(v, 0, 2);
+    cmp_swap(v, 1, 3);
+    cmp_swap(v, 4, 6);
+
+    cmp_swap(v, 2, 4);
+    cmp_swap(v, 3, 5);
+
+    cmp_swap(v, 0, 1);
+    cmp_swap(v, 2, 3);
+    cmp_swap(v, 4, 5);
+
+    cmp_swap(v, 1, 4);
+    cmp_swap(v, 3, 6);
+
+    cmp_swap(v, 1, 2);
+    cmp_swap(v, 3, 4);
+    cmp_swap(v, 5, 6);
+  }
+};
+
+template <>
+struct FixedNetwork<8> {
+  template <typename T>
+  static void sort(T* v) noexcept {
+    // 19 compare-exchanges, depth 6.
+    cmp_swap(v, 0, 4);
+    cmp_swap(v, 1, 5);
+    cmp_swap(v, 2, 6);
+    cmp_swap(v, 3, 7);
+
+    cmp_swap(v, 0, 2);
+    cmp_swap(v, 1, 3);
+    cmp_swap(v, 4, 6);
+    cmp_swap(v, 5, 7);
+
+    cmp_swap(v, 2, 4);
+    cmp_swap(v, 3, 5);
+
+    cmp_swap(v, 0, 1);
+    cmp_swap(v, 2, 3);
+    cmp_swap(v, 4, 5);
+    cmp_swap(v, 6, 7);
+
+    cmp_swap(v, 1, 4);
+    cmp_swap(v, 3, 6);
+
+    cmp_swap(v, 1, 2);
+    cmp_swap(v, 3, 4);
+    cmp_swap(v, 5, 6);
+  }
+};
+
+template <>
+struct FixedNetwork<9> {
+  template <typename T>
+  static void sort(T* v) noexcept {
+    // 26 compare-exchanges, depth 10.
+    cmp_swap(v, 0, 8);
+
+    cmp_swap(v, 0, 4);
+    cmp_swap(v, 1, 5);
+    cmp_swap(v, 2, 6);
+    cmp_swap(v, 3, 7);
+
+    cmp_swap(v, 4, 8);
+
+    cmp_swap(v, 0, 2);
+    cmp_swap(v, 1, 3);
+    cmp_swap(v, 4, 6);
+    cmp_swap(v, 5, 7);
+
+    cmp_swap(v, 2, 8);
+
+    cmp_swap(v, 2, 4);
+    cmp_swap(v, 3, 5);
+    cmp_swap(v, 6, 8);
+
+    cmp_swap(v, 0, 1);
+    cmp_swap(v, 2, 3);
+    cmp_swap(v, 4, 5);
+    cmp_swap(v, 6, 7);
+
+    cmp_swap(v, 1, 8);
+
+    cmp_swap(v, 1, 4);
+    cmp_swap(v, 3, 6);
+    cmp_swap(v, 5, 8);
+
+    cmp_swap(v, 1, 2);
+    cmp_swap(v, 3, 4);
+    cmp_swap(v, 5, 6);
+    cmp_swap(v, 7, 8);
+  }
+};
+
+template <>
+struct FixedNetwork<10> {
+  template <typename T>
+  static void sort(T* v) noexcept {
+    // 29 compare-exchanges, depth 8.
+    cmp_swap(v, 0, 8);
+    cmp_swap(v, 1, 9);
+    cmp_swap(v, 2, 7);
+    cmp_swap(v, 3, 5);
+    cmp_swap(v, 4, 6);
+
+    cmp_swap(v, 0, 2);
+    cmp_swap(v, 1, 4);
+    cmp_swap(v, 5, 8);
+    cmp_swap(v, 7, 9);
+
+    cmp_swap(v, 0, 3);
+    cmp_swap(v, 2, 4);
+    cmp_swap(v, 5, 7);
+    cmp_swap(v, 6, 9);
+
+    cmp_swap(v, 0, 1);
+    cmp_swap(v, 3, 6);
+    cmp_swap(v, 8, 9);
+
+    cmp_swap(v, 1, 5);
+    cmp_swap(v, 2, 3);
+    cmp_swap(v, 4, 8);
+    cmp_swap(v, 6, 7);
+
+    cmp_swap(v, 1, 2);
+    cmp_swap(v, 3, 5);
+    cmp_swap(v, 4, 6);
+    cmp_swap(v, 7, 8);
+
+    cmp_swap(v, 2, 3);
+    cmp_swap(v, 4, 5);
+    cmp_swap(v, 6, 7);
+
+    cmp_swap(v, 3, 4);
+    cmp_swap(v, 5, 6);
+  }
+};
+
+template <>
+struct FixedNetwork<11> {
+  template <typename T>
+  static void sort(T* v) noexcept {
+    // 37 compare-exchanges, depth 10.
+    cmp_swap(v, 0, 8);
+    cmp_swap(v, 1, 9);
+    cmp_swap(v, 2, 10);
+
+    cmp_swap(v, 0, 4);
+    cmp_swap(v, 1, 5);
+    cmp_swap(v, 2, 6);
+    cmp_swap(v, 3, 7);
+
+    cmp_swap(v, 4, 8);
+    cmp_swap(v, 5, 9);
+    cmp_swap(v, 6, 10);
+
+    cmp_swap(v, 0, 2);
+    cmp_swap(v, 1, 3);
+    cmp_swap(v, 4, 6);
+    cmp_swap(v, 5, 7);
+    cmp_swap(v, 8, 10);
+
+    cmp_swap(v, 2, 8);
+    cmp_swap(v, 3, 9);
+
+    cmp_swap(v, 2, 4);
+    cmp_swap(v, 3, 5);
+    cmp_swap(v, 6, 8);
+    cmp_swap(v, 7, 9);
+
+    cmp_swap(v, 0, 1);
+    cmp_swap(v, 2, 3);
+    cmp_swap(v, 4, 5);
+    cmp_swap(v, 6, 7);
+    cmp_swap(v, 8, 9);
+
+    cmp_swap(v, 1, 8);
+    cmp_swap(v, 3, 10);
+
+    cmp_swap(v, 1, 4);
+    cmp_swap(v, 3, 6);
+    cmp_swap(v, 5, 8);
+    cmp_swap(v, 7, 10);
+
+    cmp_swap(v, 1, 2);
+    cmp_swap(v, 3, 4);
+    cmp_swap(v, 5, 6);
+    cmp_swap(v, 7, 8);
+    cmp_swap(v, 9, 10);
+  }
+};
+
+template <>
+struct FixedNetwork<12> {
+  template <typename T>
+  static void sort(T* v) noexcept {
+    // 41 compare-exchanges, depth 10.
+    cmp_swap(v, 0, 8);
+    cmp_swap(v, 1, 9);
+    cmp_swap(v, 2, 10);
+    cmp_swap(v, 3, 11);
+
+    cmp_swap(v, 0, 4);
+    cmp_swap(v, 1, 5);
+    cmp_swap(v, 2, 6);
+    cmp_swap(v, 3, 7);
+
+    cmp_swap(v, 4, 8);
+    cmp_swap(v, 5, 9);
+    cmp_swap(v, 6, 10);
+    cmp_swap(v, 7, 11);
+
+    cmp_swap(v, 0, 2);
+    cmp_swap(v, 1, 3);
+    cmp_swap(v, 4, 6);
+    cmp_swap(v, 5, 7);
+    cmp_swap(v, 8, 10);
+    cmp_swap(v, 9, 11);
+
+    cmp_swap(v, 2, 8);
+    cmp_swap(v, 3, 9);
+
+    cmp_swap(v, 2, 4);
+    cmp_swap(v, 3, 5);
+    cmp_swap(v, 6, 8);
+    cmp_swap(v, 7, 9);
+
+    cmp_swap(v, 0, 1);
+    cmp_swap(v, 2, 3);
+    cmp_swap(v, 4, 5);
+    cmp_swap(v, 6, 7);
+    cmp_swap(v, 8, 9);
+    cmp_swap(v, 10, 11);
+
+    cmp_swap(v, 1, 8);
+    cmp_swap(v, 3, 10);
+
+    cmp_swap(v, 1, 4);
+    cmp_swap(v, 3, 6);
+    cmp_swap(v, 5, 8);
+    cmp_swap(v, 7, 10);
+
+    cmp_swap(v, 1, 2);
+    cmp_swap(v, 3, 4);
+    cmp_swap(v, 5, 6);
+    cmp_swap(v, 7, 8);
+    cmp_swap(v, 9, 10);
+  }
+};
+
+template <>
+struct FixedNetwork<13> {
+  template <typename T>
+  static void sort(T* v) noexcept {
+    // 48 compare-exchanges, depth 10.
+    cmp_swap(v, 0, 8);
+    cmp_swap(v, 1, 9);
+    cmp_swap(v, 2, 10);
+    cmp_swap(v, 3, 11);
+    cmp_swap(v, 4, 12);
+
+    cmp_swap(v, 0, 4);
+    cmp_swap(v, 1, 5);
+    cmp_swap(v, 2, 6);
+    cmp_swap(v, 3, 7);
+    cmp_swap(v, 8, 12);
+
+    cmp_swap(v, 4, 8);
+    cmp_swap(v, 5, 9);
+    cmp_swap(v, 6, 10);
+    cmp_swap(v, 7, 11);
+
+    cmp_swap(v, 0, 2);
+    cmp_swap(v, 1, 3);
+    cmp_swap(v, 4, 6);
+    cmp_swap(v, 5, 7);
+    cmp_swap(v, 8, 10);
+    cmp_swap(v, 9, 11);
+
+    cmp_swap(v, 2, 8);
+    cmp_swap(v, 3, 9);
+    cmp_swap(v, 6, 12);
+
+    cmp_swap(v, 2, 4);
+    cmp_swap(v, 3, 5);
+    cmp_swap(v, 6, 8);
+    cmp_swap(v, 7, 9);
+    cmp_swap(v, 10, 12);
+
+    cmp_swap(v, 0, 1);
+    cmp_swap(v, 2, 3);
+    cmp_swap(v, 4, 5);
+    cmp_swap(v, 6, 7);
+    cmp_swap(v, 8, 9);
+    cmp_swap(v, 10, 11);
+
+    cmp_swap(v, 1, 8);
+    cmp_swap(v, 3, 10);
+    cmp_swap(v, 5, 12);
+
+    cmp_swap(v, 1, 4);
+    cmp_swap(v, 3, 6);
+    cmp_swap(v, 5, 8);
+    cmp_swap(v, 7, 10);
+    cmp_swap(v, 9, 12);
+
+    cmp_swap(v, 1, 2);
+    cmp_swap(v, 3, 4);
+    cmp_swap(v, 5, 6);
+    cmp_swap(v, 7, 8);
+    cmp_swap(v, 9, 10);
+    cmp_swap(v, 11, 12);
+  }
+};
+
+template <>
+struct FixedNetwork<14> {
+  template <typename T>
+  static void sort(T* v) noexcept {
+    // 53 compare-exchanges, depth 10.
+    cmp_swap(v, 0, 8);
+    cmp_swap(v, 1, 9);
+    cmp_swap(v, 2, 10);
+    cmp_swap(v, 3, 11);
+    cmp_swap(v, 4, 12);
+    cmp_swap(v, 5, 13);
+
+    cmp_swap(v, 0, 4);
+    cmp_swap(v, 1, 5);
+    cmp_swap(v, 2, 6);
+    cmp_swap(v, 3, 7);
+    cmp_swap(v, 8, 12);
+    cmp_swap(v, 9, 13);
+
+    cmp_swap(v, 4, 8);
+    cmp_swap(v, 5, 9);
+    cmp_swap(v, 6, 10);
+    cmp_swap(v, 7, 11);
+
+    cmp_swap(v, 0, 2);
+    cmp_swap(v, 1, 3);
+    cmp_swap(v, 4, 6);
+    cmp_swap(v, 5, 7);
+    cmp_swap(v, 8, 10);
+    cmp_swap(v, 9, 11);
+
+    cmp_swap(v, 2, 8);
+    cmp_swap(v, 3, 9);
+    cmp_swap(v, 6, 12);
+    cmp_swap(v, 7, 13);
+
+    cmp_swap(v, 2, 4);
+    cmp_swap(v, 3, 5);
+    cmp_swap(v, 6, 8);
+    cmp_swap(v, 7, 9);
+    cmp_swap(v, 10, 12);
+    cmp_swap(v, 11, 13);
+
+    cmp_swap(v, 0, 1);
+    cmp_swap(v, 2, 3);
+    cmp_swap(v, 4, 5);
+    cmp_swap(v, 6, 7);
+    cmp_swap(v, 8, 9);
+    cmp_swap(v, 10, 11);
+    cmp_swap(v, 12, 13);
+
+    cmp_swap(v, 1, 8);
+    cmp_swap(v, 3, 10);
+    cmp_swap(v, 5, 12);
+
+    cmp_swap(v, 1, 4);
+    cmp_swap(v, 3, 6);
+    cmp_swap(v, 5, 8);
+    cmp_swap(v, 7, 10);
+    cmp_swap(v, 9, 12);
+
+    cmp_swap(v, 1, 2);
+    cmp_swap(v, 3, 4);
+    cmp_swap(v, 5, 6);
+    cmp_swap(v, 7, 8);
+    cmp_swap(v, 9, 10);
+    cmp_swap(v, 11, 12);
+  }
+};
+
+template <>
+struct FixedNetwork<15> {
+  template <typename T>
+  static void sort(T* v) noexcept {
+    // 59 compare-exchanges, depth 10.
+    cmp_swap(v, 0, 8);
+    cmp_swap(v, 1, 9);
+    cmp_swap(v, 2, 10);
+    cmp_swap(v, 3, 11);
+    cmp_swap(v, 4, 12);
+    cmp_swap(v, 5, 13);
+    cmp_swap(v, 6, 14);
+
+    cmp_swap(v, 0, 4);
+    cmp_swap(v, 1, 5);
+    cmp_swap(v, 2, 6);
+    cmp_swap(v, 3, 7);
+    cmp_swap(v, 8, 12);
+    cmp_swap(v, 9, 13);
+    cmp_swap(v, 10, 14);
+
+    cmp_swap(v, 4, 8);
+    cmp_swap(v, 5, 9);
+    cmp_swap(v, 6, 10);
+    cmp_swap(v, 7, 11);
+
+    cmp_swap(v, 0, 2);
+    cmp_swap(v, 1, 3);
+    cmp_swap(v, 4, 6);
+    cmp_swap(v, 5, 7);
+    cmp_swap(v, 8, 10);
+    cmp_swap(v, 9, 11);
+    cmp_swap(v, 12, 14);
+
+    cmp_swap(v, 2, 8);
+    cmp_swap(v, 3, 9);
+    cmp_swap(v, 6, 12);
+    cmp_swap(v, 7, 13);
+
+    cmp_swap(v, 2, 4);
+    cmp_swap(v, 3, 5);
+    cmp_swap(v, 6, 8);
+    cmp_swap(v, 7, 9);
+    cmp_swap(v, 10, 12);
+    cmp_swap(v, 11, 13);
+
+    cmp_swap(v, 0, 1);
+    cmp_swap(v, 2, 3);
+    cmp_swap(v, 4, 5);
+    cmp_swap(v, 6, 7);
+    cmp_swap(v, 8, 9);
+    cmp_swap(v, 10, 11);
+    cmp_swap(v, 12, 13);
+
+    cmp_swap(v, 1, 8);
+    cmp_swap(v, 3, 10);
+    cmp_swap(v, 5, 12);
+    cmp_swap(v, 7, 14);
+
+    cmp_swap(v, 1, 4);
+    cmp_swap(v, 3, 6);
+    cmp_swap(v, 5, 8);
+    cmp_swap(v, 7, 10);
+    cmp_swap(v, 9, 12);
+    cmp_swap(v, 11, 14);
+
+    cmp_swap(v, 1, 2);
+    cmp_swap(v, 3, 4);
+    cmp_swap(v, 5, 6);
+    cmp_swap(v, 7, 8);
+    cmp_swap(v, 9, 10);
+    cmp_swap(v, 11, 12);
+    cmp_swap(v, 13, 14);
+  }
+};
+
+template <>
+struct FixedNetwork<16> {
+  template <typename T>
+  static void sort(T* v) noexcept {
+    // 63 compare-exchanges, depth 10.
+    cmp_swap(v, 0, 8);
+    cmp_swap(v, 1, 9);
+    cmp_swap(v, 2, 10);
+    cmp_swap(v, 3, 11);
+    cmp_swap(v, 4, 12);
+    cmp_swap(v, 5, 13);
+    cmp_swap(v, 6, 14);
+    cmp_swap(v, 7, 15);
+
+    cmp_swap(v, 0, 4);
+    cmp_swap(v, 1, 5);
+    cmp_swap(v, 2, 6);
+    cmp_swap(v, 3, 7);
+    cmp_swap(v, 8, 12);
+    cmp_swap(v, 9, 13);
+    cmp_swap(v, 10, 14);
+    cmp_swap(v, 11, 15);
+
+    cmp_swap(v, 4, 8);
+    cmp_swap(v, 5, 9);
+    cmp_swap(v, 6, 10);
+    cmp_swap(v, 7, 11);
+
+    cmp_swap(v, 0, 2);
+    cmp_swap(v, 1, 3);
+    cmp_swap(v, 4, 6);
+    cmp_swap(v, 5, 7);
+    cmp_swap(v, 8, 10);
+    cmp_swap(v, 9, 11);
+    cmp_swap(v, 12, 14);
+    cmp_swap(v, 13, 15);
+
+    cmp_swap(v, 2, 8);
+    cmp_swap(v, 3, 9);
+    cmp_swap(v, 6, 12);
+    cmp_swap(v, 7, 13);
+
+    cmp_swap(v, 2, 4);
+    cmp_swap(v, 3, 5);
+    cmp_swap(v, 6, 8);
+    cmp_swap(v, 7, 9);
+    cmp_swap(v, 10, 12);
+    cmp_swap(v, 11, 13);
+
+    cmp_swap(v, 0, 1);
+    cmp_swap(v, 2, 3);
+    cmp_swap(v, 4, 5);
+    cmp_swap(v, 6, 7);
+    cmp_swap(v, 8, 9);
+    cmp_swap(v, 10, 11);
+    cmp_swap(v, 12, 13);
+    cmp_swap(v, 14, 15);
+
+    cmp_swap(v, 1, 8);
+    cmp_swap(v, 3, 10);
+    cmp_swap(v, 5, 12);
+    cmp_swap(v, 7, 14);
+
+    cmp_swap(v, 1, 4);
+    cmp_swap(v, 3, 6);
+    cmp_swap(v, 5, 8);
+    cmp_swap(v, 7, 10);
+    cmp_swap(v, 9, 12);
+    cmp_swap(v, 11, 14);
+
+    cmp_swap(v, 1, 2);
+    cmp_swap(v, 3, 4);
+    cmp_swap(v, 5, 6);
+    cmp_swap(v, 7, 8);
+    cmp_swap(v, 9, 10);
+    cmp_swap(v, 11, 12);
+    cmp_swap(v, 13, 14);
+  }
+};
+
+template <>
+struct FixedNetwork<17> {
+  template <typename T>
+  static void sort(T* v) noexcept {
+    // 74 compare-exchanges, depth 15.
+    cmp_swap(v, 0, 16);
+
+    cmp_swap(v, 0, 8);
+    cmp_swap(v, 1, 9);
+    cmp_swap(v, 2, 10);
+    cmp_swap(v, 3, 11);
+    cmp_swap(v, 4, 12);
+    cmp_swap(v, 5, 13);
+    cmp_swap(v, 6, 14);
+    cmp_swap(v, 7, 15);
+
+    cmp_swap(v, 8, 16);
+
+    cmp_swap(v, 0, 4);
+    cmp_swap(v, 1, 5);
+    cmp_swap(v, 2, 6);
+    cmp_swap(v, 3, 7);
+    cmp_swap(v, 8, 12);
+    cmp_swap(v, 9, 13);
+    cmp_swap(v, 10, 14);
+    cmp_swap(v, 11, 15);
+
+    cmp_swap(v, 4, 16);
+
+    cmp_swap(v, 4, 8);
+    cmp_swap(v, 5, 9);
+    cmp_swap(v, 6, 10);
+    cmp_swap(v, 7, 11);
+    cmp_swap(v, 12, 16);
+
+    cmp_swap(v, 0, 2);
+    cmp_swap(v, 1, 3);
+    cmp_swap(v, 4, 6);
+    cmp_swap(v, 5, 7);
+    cmp_swap(v, 8, 10);
+    cmp_swap(v, 9, 11);
+    cmp_swap(v, 12, 14);
+    cmp_swap(v, 13, 15);
+
+    cmp_swap(v, 2, 16);
+
+    cmp_swap(v, 2, 8);
+    cmp_swap(v, 3, 9);
+    cmp_swap(v, 6, 12);
+    cmp_swap(v, 7, 13);
+    cmp_swap(v, 10, 16);
+
+    cmp_swap(v, 2, 4);
+    cmp_swap(v, 3, 5);
+    cmp_swap(v, 6, 8);
+    cmp_swap(v, 7, 9);
+    cmp_swap(v, 10, 12);
+    cmp_swap(v, 11, 13);
+    cmp_swap(v, 14, 16);
+
+    cmp_swap(v, 0, 1);
+    cmp_swap(v, 2, 3);
+    cmp_swap(v, 4, 5);
+    cmp_swap(v, 6, 7);
+    cmp_swap(v, 8, 9);
+    cmp_swap(v, 10, 11);
+    cmp_swap(v, 12, 13);
+    cmp_swap(v, 14, 15);
+
+    cmp_swap(v, 1, 16);
+
+    cmp_swap(v, 1, 8);
+    cmp_swap(v, 3, 10);
+    cmp_swap(v, 5, 12);
+    cmp_swap(v, 7, 14);
+    cmp_swap(v, 9, 16);
+
+    cmp_swap(v, 1, 4);
+    cmp_swap(v, 3, 6);
+    cmp_swap(v, 5, 8);
+    cmp_swap(v, 7, 10);
+    cmp_swap(v, 9, 12);
+    cmp_swap(v, 11, 14);
+    cmp_swap(v, 13, 16);
+
+    cmp_swap(v, 1, 2);
+    cmp_swap(v, 3, 4);
+    cmp_swap(v, 5, 6);
+    cmp_swap(v, 7, 8);
+    cmp_swap(v, 9, 10);
+    cmp_swap(v, 11, 12);
+    cmp_swap(v, 13, 14);
+    cmp_swap(v, 15, 16);
+  }
+};
+
+template <>
+struct FixedNetwork<18> {
+  template <typename T>
+  static void sort(T* v) noexcept {
+    // 82 compare-exchanges, depth 15.
+    cmp_swap(v, 0, 16);
+    cmp_swap(v, 1, 17);
+
+    cmp_swap(v, 0, 8);
+    cmp_swap(v, 1, 9);
+    cmp_swap(v, 2, 10);
+    cmp_swap(v, 3, 11);
+    cmp_swap(v, 4, 12);
+    cmp_swap(v, 5, 13);
+    cmp_swap(v, 6, 14);
+    cmp_swap(v, 7, 15);
+
+    cmp_swap(v, 8, 16);
+    cmp_swap(v, 9, 17);
+
+    cmp_swap(v, 0, 4);
+    cmp_swap(v, 1, 5);
+    cmp_swap(v, 2, 6);
+    cmp_swap(v, 3, 7);
+    cmp_swap(v, 8, 12);
+    cmp_swap(v, 9, 13);
+    cmp_swap(v, 10, 14);
+    cmp_swap(v, 11, 15);
+
+    cmp_swap(v, 4, 16);
+    cmp_swap(v, 5, 17);
+
+    cmp_swap(v, 4, 8);
+    cmp_swap(v, 5, 9);
+    cmp_swap(v, 6, 10);
+    cmp_swap(v, 7, 11);
+    cmp_swap(v, 12, 16);
+    cmp_swap(v, 13, 17);
+
+    cmp_swap(v, 0, 2);
+    cmp_swap(v, 1, 3);
+    cmp_swap(v, 4, 6);
+    cmp_swap(v, 5, 7);
+    cmp_swap(v, 8, 10);
+    cmp_swap(v, 9, 11);
+    cmp_swap(v, 12, 14);
+    cmp_swap(v, 13, 15);
+
+    cmp_swap(v, 2, 16);
+    cmp_swap(v, 3, 17);
+
+    cmp_swap(v, 2, 8);
+    cmp_swap(v, 3, 9);
+    cmp_swap(v, 6, 12);
+    cmp_swap(v, 7, 13);
+    cmp_swap(v, 10, 16);
+    cmp_swap(v, 11, 17);
+
+    cmp_swap(v, 2, 4);
+    cmp_swap(v, 3, 5);
+    cmp_swap(v, 6, 8);
+    cmp_swap(v, 7, 9);
+    cmp_swap(v, 10, 12);
+    cmp_swap(v, 11, 13);
+    cmp_swap(v, 14, 16);
+    cmp_swap(v, 15, 17);
+
+    cmp_swap(v, 0, 1);
+    cmp_swap(v, 2, 3);
+    cmp_swap(v, 4, 5);
+    cmp_swap(v, 6, 7);
+    cmp_swap(v, 8, 9);
+    cmp_swap(v, 10, 11);
+    cmp_swap(v, 12, 13);
+    cmp_swap(v, 14, 15);
+    cmp_swap(v, 16, 17);
+
+    cmp_swap(v, 1, 16);
+
+    cmp_swap(v, 1, 8);
+    cmp_swap(v, 3, 10);
+    cmp_swap(v, 5, 12);
+    cmp_swap(v, 7, 14);
+    cmp_swap(v, 9, 16);
+
+    cmp_swap(v, 1, 4);
+    cmp_swap(v, 3, 6);
+    cmp_swap(v, 5, 8);
+    cmp_swap(v, 7, 10);
+    cmp_swap(v, 9, 12);
+    cmp_swap(v, 11, 14);
+    cmp_swap(v, 13, 16);
+
+    cmp_swap(v, 1, 2);
+    cmp_swap(v, 3, 4);
+    cmp_swap(v, 5, 6);
+    cmp_swap(v, 7, 8);
+    cmp_swap(v, 9, 10);
+    cmp_swap(v, 11, 12);
+    cmp_swap(v, 13, 14);
+    cmp_swap(v, 15, 16);
+  }
+};
+
+template <>
+struct FixedNetwork<19> {
+  template <typename T>
+  static void sort(T* v) noexcept {
+    // 91 compare-exchanges, depth 15.
+    cmp_swap(v, 0, 16);
+    cmp_swap(v, 1, 17);
+    cmp_swap(v, 2, 18);
+
+    cmp_swap(v, 0, 8);
+    cmp_swap(v, 1, 9);
+    cmp_swap(v, 2, 10);
+    cmp_swap(v, 3, 11);
+    cmp_swap(v, 4, 12);
+    cmp_swap(v, 5, 13);
+    cmp_swap(v, 6, 14);
+    cmp_swap(v, 7, 15);
+
+    cmp_swap(v, 8, 16);
+    cmp_swap(v, 9, 17);
+    cmp_swap(v, 10, 18);
+
+    cmp_swap(v, 0, 4);
+    cmp_swap(v, 1, 5);
+    cmp_swap(v, 2, 6);
+    cmp_swap(v, 3, 7);
+    cmp_swap(v, 8, 12);
+    cmp_swap(v, 9, 13);
+    cmp_swap(v, 10, 14);
+    cmp_swap(v, 11, 15);
+
+    cmp_swap(v, 4, 16);
+    cmp_swap(v, 5, 17);
+    cmp_swap(v, 6, 18);
+
+    cmp_swap(v, 4, 8);
+    cmp_swap(v, 5, 9);
+    cmp_swap(v, 6, 10);
+    cmp_swap(v, 7, 11);
+    cmp_swap(v, 12, 16);
+    cmp_swap(v, 13, 17);
+    cmp_swap(v, 14, 18);
+
+    cmp_swap(v, 0, 2);
+    cmp_swap(v, 1, 3);
+    cmp_swap(v, 4, 6);
+    cmp_swap(v, 5, 7);
+    cmp_swap(v, 8, 10);
+    cmp_swap(v, 9, 11);
+    cmp_swap(v, 12, 14);
+    cmp_swap(v, 13, 15);
+    cmp_swap(v, 16, 18);
+
+    cmp_swap(v, 2, 16);
+    cmp_swap(v, 3, 17);
+
+    cmp_swap(v, 2, 8);
+    cmp_swap(v, 3, 9);
+    cmp_swap(v, 6, 12);
+    cmp_swap(v, 7, 13);
+    cmp_swap(v, 10, 16);
+    cmp_swap(v, 11, 17);
+
+    cmp_swap(v, 2, 4);
+    cmp_swap(v, 3, 5);
+    cmp_swap(v, 6, 8);
+    cmp_swap(v, 7, 9);
+    cmp_swap(v, 10, 12);
+    cmp_swap(v, 11, 13);
+    cmp_swap(v, 14, 16);
+    cmp_swap(v, 15, 17);
+
+    cmp_swap(v, 0, 1);
+    cmp_swap(v, 2, 3);
+    cmp_swap(v, 4, 5);
+    cmp_swap(v, 6, 7);
+    cmp_swap(v, 8, 9);
+    cmp_swap(v, 10, 11);
+    cmp_swap(v, 12, 13);
+    cmp_swap(v, 14, 15);
+    cmp_swap(v, 16, 17);
+
+    cmp_swap(v, 1, 16);
+    cmp_swap(v, 3, 18);
+
+    cmp_swap(v, 1, 8);
+    cmp_swap(v, 3, 10);
+    cmp_swap(v, 5, 12);
+    cmp_swap(v, 7, 14);
+    cmp_swap(v, 9, 16);
+    cmp_swap(v, 11, 18);
+
+    cmp_swap(v, 1, 4);
+    cmp_swap(v, 3, 6);
+    cmp_swap(v, 5, 8);
+    cmp_swap(v, 7, 10);
+    cmp_swap(v, 9, 12);
+    cmp_swap(v, 11, 14);
+    cmp_swap(v, 13, 16);
+    cmp_swap(v, 15, 18);
+
+    cmp_swap(v, 1, 2);
+    cmp_swap(v, 3, 4);
+    cmp_swap(v, 5, 6);
+    cmp_swap(v, 7, 8);
+    cmp_swap(v, 9, 10);
+    cmp_swap(v, 11, 12);
+    cmp_swap(v, 13, 14);
+    cmp_swap(v, 15, 16);
+    cmp_swap(v, 17, 18);
+  }
+};
+
+template <>
+struct FixedNetwork<20> {
+  template <typename T>
+  static void sort(T* v) noexcept {
+    // 91 compare-exchanges, depth 12.
+    cmp_swap(v, 0, 3);
+    cmp_swap(v, 1, 7);
+    cmp_swap(v, 2, 5);
+    cmp_swap(v, 4, 8);
+    cmp_swap(v, 6, 9);
+    cmp_swap(v, 10, 13);
+    cmp_swap(v, 11, 15);
+    cmp_swap(v, 12, 18);
+    cmp_swap(v, 14, 17);
+    cmp_swap(v, 16, 19);
+
+    cmp_swap(v, 0, 14);
+    cmp_swap(v, 1, 11);
+    cmp_swap(v, 2, 16);
+    cmp_swap(v, 3, 17);
+    cmp_swap(v, 4, 12);
+    cmp_swap(v, 5, 19);
+    cmp_swap(v, 6, 10);
+    cmp_swap(v, 7, 15);
+    cmp_swap(v, 8, 18);
+    cmp_swap(v, 9, 13);
+
+    cmp_swap(v, 0, 4);
+    cmp_swap(v, 1, 2);
+    cmp_swap(v, 3, 8);
+    cmp_swap(v, 5, 7);
+    cmp_swap(v, 11, 16);
+    cmp_swap(v, 12, 14);
+    cmp_swap(v, 15, 19);
+    cmp_swap(v, 17, 18);
+
+    cmp_swap(v, 1, 6);
+    cmp_swap(v, 2, 12);
+    cmp_swap(v, 3, 5);
+    cmp_swap(v, 4, 11);
+    cmp_swap(v, 7, 17);
+    cmp_swap(v, 8, 15);
+    cmp_swap(v, 13, 18);
+    cmp_swap(v, 14, 16);
+
+    cmp_swap(v, 0, 1);
+    cmp_swap(v, 2, 6);
+    cmp_swap(v, 7, 10);
+    cmp_swap(v, 9, 12);
+    cmp_swap(v, 13, 17);
+    cmp_swap(v, 18, 19);
+
+    cmp_swap(v, 1, 6);
+    cmp_swap(v, 5, 9);
+    cmp_swap(v, 7, 11);
+    cmp_swap(v, 8, 12);
+    cmp_swap(v, 10, 14);
+    cmp_swap(v, 13, 18);
+
+    cmp_swap(v, 3, 5);
+    cmp_swap(v, 4, 7);
+    cmp_swap(v, 8, 10);
+    cmp_swap(v, 9, 11);
+    cmp_swap(v, 12, 15);
+    cmp_swap(v, 14, 16);
+
+    cmp_swap(v, 1, 3);
+    cmp_swap(v, 2, 4);
+    cmp_swap(v, 5, 7);
+    cmp_swap(v, 6, 10);
+    cmp_swap(v, 9, 13);
+    cmp_swap(v, 12, 14);
+    cmp_swap(v, 15, 17);
+    cmp_swap(v, 16, 18);
+
+    cmp_swap(v, 1, 2);
+    cmp_swap(v, 3, 4);
+    cmp_swap(v, 6, 7);
+    cmp_swap(v, 8, 9);
+    cmp_swap(v, 10, 11);
+    cmp_swap(v, 12, 13);
+    cmp_swap(v, 15, 16);
+    cmp_swap(v, 17, 18);
+
+    cmp_swap(v, 2, 3);
+    cmp_swap(v, 4, 6);
+    cmp_swap(v, 5, 8);
+    cmp_swap(v, 7, 9);
+    cmp_swap(v, 10, 12);
+    cmp_swap(v, 11, 14);
+    cmp_swap(v, 13, 15);
+    cmp_swap(v, 16, 17);
+
+    cmp_swap(v, 4, 5);
+    cmp_swap(v, 6, 8);
+    cmp_swap(v, 7, 10);
+    cmp_swap(v, 9, 12);
+    cmp_swap(v, 11, 13);
+    cmp_swap(v, 14, 15);
+
+    cmp_swap(v, 3, 4);
+    cmp_swap(v, 5, 6);
+    cmp_swap(v, 7, 8);
+    cmp_swap(v, 9, 10);
+    cmp_swap(v, 11, 12);
+    cmp_swap(v, 13, 14);
+    cmp_swap(v, 15, 16);
+  }
+};
+
+template <>
+struct FixedNetwork<21> {
+  template <typename T>
+  static void sort(T* v) noexcept {
+    // 107 compare-exchanges, depth 15.
+    cmp_swap(v, 0, 16);
+    cmp_swap(v, 1, 17);
+    cmp_swap(v, 2, 18);
+    cmp_swap(v, 3, 19);
+    cmp_swap(v, 4, 20);
+
+    cmp_swap(v, 0, 8);
+    cmp_swap(v, 1, 9);
+    cmp_swap(v, 2, 10);
+    cmp_swap(v, 3, 11);
+    cmp_swap(v, 4, 12);
+    cmp_swap(v, 5, 13);
+    cmp_swap(v, 6, 14);
+    cmp_swap(v, 7, 15);
+
+    cmp_swap(v, 8, 16);
+    cmp_swap(v, 9, 17);
+    cmp_swap(v, 10, 18);
+    cmp_swap(v, 11, 19);
+    cmp_swap(v, 12, 20);
+
+    cmp_swap(v, 0, 4);
+    cmp_swap(v, 1, 5);
+    cmp_swap(v, 2, 6);
+    cmp_swap(v, 3, 7);
+    cmp_swap(v, 8, 12);
+    cmp_swap(v, 9, 13);
+    cmp_swap(v, 10, 14);
+    cmp_swap(v, 11, 15);
+    cmp_swap(v, 16, 20);
+
+    cmp_swap(v, 4, 16);
+    cmp_swap(v, 5, 17);
+    cmp_swap(v, 6, 18);
+    cmp_swap(v, 7, 19);
+
+    cmp_swap(v, 4, 8);
+    cmp_swap(v, 5, 9);
+    cmp_swap(v, 6, 10);
+    cmp_swap(v, 7, 11);
+    cmp_swap(v, 12, 16);
+    cmp_swap(v, 13, 17);
+    cmp_swap(v, 14, 18);
+    cmp_swap(v, 15, 19);
+
+    cmp_swap(v, 0, 2);
+    cmp_swap(v, 1, 3);
+    cmp_swap(v, 4, 6);
+    cmp_swap(v, 5, 7);
+    cmp_swap(v, 8, 10);
+    cmp_swap(v, 9, 11);
+    cmp_swap(v, 12, 14);
+    cmp_swap(v, 13, 15);
+    cmp_swap(v, 16, 18);
+    cmp_swap(v, 17, 19);
+
+    cmp_swap(v, 2, 16);
+    cmp_swap(v, 3, 17);
+    cmp_swap(v, 6, 20);
+
+    cmp_swap(v, 2, 8);
+    cmp_swap(v, 3, 9);
+    cmp_swap(v, 6, 12);
+    cmp_swap(v, 7, 13);
+    cmp_swap(v, 10, 16);
+    cmp_swap(v, 11, 17);
+    cmp_swap(v, 14, 20);
+
+    cmp_swap(v, 2, 4);
+    cmp_swap(v, 3, 5);
+    cmp_swap(v, 6, 8);
+    cmp_swap(v, 7, 9);
+    cmp_swap(v, 10, 12);
+    cmp_swap(v, 11, 13);
+    cmp_swap(v, 14, 16);
+    cmp_swap(v, 15, 17);
+    cmp_swap(v, 18, 20);
+
+    cmp_swap(v, 0, 1);
+    cmp_swap(v, 2, 3);
+    cmp_swap(v, 4, 5);
+    cmp_swap(v, 6, 7);
+    cmp_swap(v, 8, 9);
+    cmp_swap(v, 10, 11);
+    cmp_swap(v, 12, 13);
+    cmp_swap(v, 14, 15);
+    cmp_swap(v, 16, 17);
+    cmp_swap(v, 18, 19);
+
+    cmp_swap(v, 1, 16);
+    cmp_swap(v, 3, 18);
+    cmp_swap(v, 5, 20);
+
+    cmp_swap(v, 1, 8);
+    cmp_swap(v, 3, 10);
+    cmp_swap(v, 5, 12);
+    cmp_swap(v, 7, 14);
+    cmp_swap(v, 9, 16);
+    cmp_swap(v, 11, 18);
+    cmp_swap(v, 13, 20);
+
+    cmp_swap(v, 1, 4);
+    cmp_swap(v, 3, 6);
+    cmp_swap(v, 5, 8);
+    cmp_swap(v, 7, 10);
+    cmp_swap(v, 9, 12);
+    cmp_swap(v, 11, 14);
+    cmp_swap(v, 13, 16);
+    cmp_swap(v, 15, 18);
+    cmp_swap(v, 17, 20);
+
+    cmp_swap(v, 1, 2);
+    cmp_swap(v, 3, 4);
+    cmp_swap(v, 5, 6);
+    cmp_swap(v, 7, 8);
+    cmp_swap(v, 9, 10);
+    cmp_swap(v, 11, 12);
+    cmp_swap(v, 13, 14);
+    cmp_swap(v, 15, 16);
+    cmp_swap(v, 17, 18);
+    cmp_swap(v, 19, 20);
+  }
+};
+
+template <>
+struct FixedNetwork<22> {
+  template <typename T>
+  static void sort(T* v) noexcept {
+    // 114 compare-exchanges, depth 15.
+    cmp_swap(v, 0, 16);
+    cmp_swap(v, 1, 17);
+    cmp_swap(v, 2, 18);
+    cmp_swap(v, 3, 19);
+    cmp_swap(v, 4, 20);
+    cmp_swap(v, 5, 21);
+
+    cmp_swap(v, 0, 8);
+    cmp_swap(v, 1, 9);
+    cmp_swap(v, 2, 10);
+    cmp_swap(v, 3, 11);
+    cmp_swap(v, 4, 12);
+    cmp_swap(v, 5, 13);
+    cmp_swap(v, 6, 14);
+    cmp_swap(v, 7, 15);
+
+    cmp_swap(v, 8, 16);
+    cmp_swap(v, 9, 17);
+    cmp_swap(v, 10, 18);
+    cmp_swap(v, 11, 19);
+    cmp_swap(v, 12, 20);
+    cmp_swap(v, 13, 21);
+
+    cmp_swap(v, 0, 4);
+    cmp_swap(v, 1, 5);
+    cmp_swap(v, 2, 6);
+    cmp_swap(v, 3, 7);
+    cmp_swap(v, 8, 12);
+    cmp_swap(v, 9, 13);
+    cmp_swap(v, 10, 14);
+    cmp_swap(v, 11, 15);
+    cmp_swap(v, 16, 20);
+    cmp_swap(v, 17, 21);
+
+    cmp_swap(v, 4, 16);
+    cmp_swap(v, 5, 17);
+    cmp_swap(v, 6, 18);
+    cmp_swap(v, 7, 19);
+
+    cmp_swap(v, 4, 8);
+    cmp_swap(v, 5, 9);
+    cmp_swap(v, 6, 10);
+    cmp_swap(v, 7, 11);
+    cmp_swap(v, 12, 16);
+    cmp_swap(v, 13, 17);
+    cmp_swap(v, 14, 18);
+    cmp_swap(v, 15, 19);
+
+    cmp_swap(v, 0, 2);
+    cmp_swap(v, 1, 3);
+    cmp_swap(v, 4, 6);
+    cmp_swap(v, 5, 7);
+    cmp_swap(v, 8, 10);
+    cmp_swap(v, 9, 11);
+    cmp_swap(v, 12, 14);
+    cmp_swap(v, 13, 15);
+    cmp_swap(v, 16, 18);
+    cmp_swap(v, 17, 19);
+
+    cmp_swap(v, 2, 16);
+    cmp_swap(v, 3, 17);
+    cmp_swap(v, 6, 20);
+    cmp_swap(v, 7, 21);
+
+    cmp_swap(v, 2, 8);
+    cmp_swap(v, 3, 9);
+    cmp_swap(v, 6, 12);
+    cmp_swap(v, 7, 13);
+    cmp_swap(v, 10, 16);
+    cmp_swap(v, 11, 17);
+    cmp_swap(v, 14, 20);
+    cmp_swap(v, 15, 21);
+
+    cmp_swap(v, 2, 4);
+    cmp_swap(v, 3, 5);
+    cmp_swap(v, 6, 8);
+    cmp_swap(v, 7, 9);
+    cmp_swap(v, 10, 12);
+    cmp_swap(v, 11, 13);
+    cmp_swap(v, 14, 16);
+    cmp_swap(v, 15, 17);
+    cmp_swap(v, 18, 20);
+    cmp_swap(v, 19, 21);
+
+    cmp_swap(v, 0, 1);
+    cmp_swap(v, 2, 3);
+    cmp_swap(v, 4, 5);
+    cmp_swap(v, 6, 7);
+    cmp_swap(v, 8, 9);
+    cmp_swap(v, 10, 11);
+    cmp_swap(v, 12, 13);
+    cmp_swap(v, 14, 15);
+    cmp_swap(v, 16, 17);
+    cmp_swap(v, 18, 19);
+    cmp_swap(v, 20, 21);
+
+    cmp_swap(v, 1, 16);
+    cmp_swap(v, 3, 18);
+    cmp_swap(v, 5, 20);
+
+    cmp_swap(v, 1, 8);
+    cmp_swap(v, 3, 10);
+    cmp_swap(v, 5, 12);
+    cmp_swap(v, 7, 14);
+    cmp_swap(v, 9, 16);
+    cmp_swap(v, 11, 18);
+    cmp_swap(v, 13, 20);
+
+    cmp_swap(v, 1, 4);
+    cmp_swap(v, 3, 6);
+    cmp_swap(v, 5, 8);
+    cmp_swap(v, 7, 10);
+    cmp_swap(v, 9, 12);
+    cmp_swap(v, 11, 14);
+    cmp_swap(v, 13, 16);
+    cmp_swap(v, 15, 18);
+    cmp_swap(v, 17, 20);
+
+    cmp_swap(v, 1, 2);
+    cmp_swap(v, 3, 4);
+    cmp_swap(v, 5, 6);
+    cmp_swap(v, 7, 8);
+    cmp_swap(v, 9, 10);
+    cmp_swap(v, 11, 12);
+    cmp_swap(v, 13, 14);
+    cmp_swap(v, 15, 16);
+    cmp_swap(v, 17, 18);
+    cmp_swap(v, 19, 20);
+  }
+};
+
+template <>
+struct FixedNetwork<23> {
+  template <typename T>
+  static void sort(T* v) noexcept {
+    // 122 compare-exchanges, depth 15.
+    cmp_swap(v, 0, 16);
+    cmp_swap(v, 1, 17);
+    cmp_swap(v, 2, 18);
+    cmp_swap(v, 3, 19);
+    cmp_swap(v, 4, 20);
+    cmp_swap(v, 5, 21);
+    cmp_swap(v, 6, 22);
+
+    cmp_swap(v, 0, 8);
+    cmp_swap(v, 1, 9);
+    cmp_swap(v, 2, 10);
+    cmp_swap(v, 3, 11);
+    cmp_swap(v, 4, 12);
+    cmp_swap(v, 5, 13);
+    cmp_swap(v, 6, 14);
+    cmp_swap(v, 7, 15);
+
+    cmp_swap(v, 8, 16);
+    cmp_swap(v, 9, 17);
+    cmp_swap(v, 10, 18);
+    cmp_swap(v, 11, 19);
+    cmp_swap(v, 12, 20);
+    cmp_swap(v, 13, 21);
+    cmp_swap(v, 14, 22);
+
+    cmp_swap(v, 0, 4);
+    cmp_swap(v, 1, 5);
+    cmp_swap(v, 2, 6);
+    cmp_swap(v, 3, 7);
+    cmp_swap(v, 8, 12);
+    cmp_swap(v, 9, 13);
+    cmp_swap(v, 10, 14);
+    cmp_swap(v, 11, 15);
+    cmp_swap(v, 16, 20);
+    cmp_swap(v, 17, 21);
+    cmp_swap(v, 18, 22);
+
+    cmp_swap(v, 4, 16);
+    cmp_swap(v, 5, 17);
+    cmp_swap(v, 6, 18);
+    cmp_swap(v, 7, 19);
+
+    cmp_swap(v, 4, 8);
+    cmp_swap(v, 5, 9);
+    cmp_swap(v, 6, 10);
+    cmp_swap(v, 7, 11);
+    cmp_swap(v, 12, 16);
+    cmp_swap(v, 13, 17);
+    cmp_swap(v, 14, 18);
+    cmp_swap(v, 15, 19);
+
+    cmp_swap(v, 0, 2);
+    cmp_swap(v, 1, 3);
+    cmp_swap(v, 4, 6);
+    cmp_swap(v, 5, 7);
+    cmp_swap(v, 8, 10);
+    cmp_swap(v, 9, 11);
+    cmp_swap(v, 12, 14);
+    cmp_swap(v, 13, 15);
+    cmp_swap(v, 16, 18);
+    cmp_swap(v, 17, 19);
+    cmp_swap(v, 20, 22);
+
+    cmp_swap(v, 2, 16);
+    cmp_swap(v, 3, 17);
+    cmp_swap(v, 6, 20);
+    cmp_swap(v, 7, 21);
+
+    cmp_swap(v, 2, 8);
+    cmp_swap(v, 3, 9);
+    cmp_swap(v, 6, 12);
+    cmp_swap(v, 7, 13);
+    cmp_swap(v, 10, 16);
+    cmp_swap(v, 11, 17);
+    cmp_swap(v, 14, 20);
+    cmp_swap(v, 15, 21);
+
+    cmp_swap(v, 2, 4);
+    cmp_swap(v, 3, 5);
+    cmp_swap(v, 6, 8);
+    cmp_swap(v, 7, 9);
+    cmp_swap(v, 10, 12);
+    cmp_swap(v, 11, 13);
+    cmp_swap(v, 14, 16);
+    cmp_swap(v, 15, 17);
+    cmp_swap(v, 18, 20);
+    cmp_swap(v, 19, 21);
+
+    cmp_swap(v, 0, 1);
+    cmp_swap(v, 2, 3);
+    cmp_swap(v, 4, 5);
+    cmp_swap(v, 6, 7);
+    cmp_swap(v, 8, 9);
+    cmp_swap(v, 10, 11);
+    cmp_swap(v, 12, 13);
+    cmp_swap(v, 14, 15);
+    cmp_swap(v, 16, 17);
+    cmp_swap(v, 18, 19);
+    cmp_swap(v, 20, 21);
+
+    cmp_swap(v, 1, 16);
+    cmp_swap(v, 3, 18);
+    cmp_swap(v, 5, 20);
+    cmp_swap(v, 7, 22);
+
+    cmp_swap(v, 1, 8);
+    cmp_swap(v, 3, 10);
+    cmp_swap(v, 5, 12);
+    cmp_swap(v, 7, 14);
+    cmp_swap(v, 9, 16);
+    cmp_swap(v, 11, 18);
+    cmp_swap(v, 13, 20);
+    cmp_swap(v, 15, 22);
+
+    cmp_swap(v, 1, 4);
+    cmp_swap(v, 3, 6);
+    cmp_swap(v, 5, 8);
+    cmp_swap(v, 7, 10);
+    cmp_swap(v, 9, 12);
+    cmp_swap(v, 11, 14);
+    cmp_swap(v, 13, 16);
+    cmp_swap(v, 15, 18);
+    cmp_swap(v, 17, 20);
+    cmp_swap(v, 19, 22);
+
+    cmp_swap(v, 1, 2);
+    cmp_swap(v, 3, 4);
+    cmp_swap(v, 5, 6);
+    cmp_swap(v, 7, 8);
+    cmp_swap(v, 9, 10);
+    cmp_swap(v, 11, 12);
+    cmp_swap(v, 13, 14);
+    cmp_swap(v, 15, 16);
+    cmp_swap(v, 17, 18);
+    cmp_swap(v, 19, 20);
+    cmp_swap(v, 21, 22);
+  }
+};
+
+template <>
+struct FixedNetwork<24> {
+  template <typename T>
+  static void sort(T* v) noexcept {
+    // 127 compare-exchanges, depth 15.
+    cmp_swap(v, 0, 16);
+    cmp_swap(v, 1, 17);
+    cmp_swap(v, 2, 18);
+    cmp_swap(v, 3, 19);
+    cmp_swap(v, 4, 20);
+    cmp_swap(v, 5, 21);
+    cmp_swap(v, 6, 22);
+    cmp_swap(v, 7, 23);
+
+    cmp_swap(v, 0, 8);
+    cmp_swap(v, 1, 9);
+    cmp_swap(v, 2, 10);
+    cmp_swap(v, 3, 11);
+    cmp_swap(v, 4, 12);
+    cmp_swap(v, 5, 13);
+    cmp_swap(v, 6, 14);
+    cmp_swap(v, 7, 15);
+
+    cmp_swap(v, 8, 16);
+    cmp_swap(v, 9, 17);
+    cmp_swap(v, 10, 18);
+    cmp_swap(v, 11, 19);
+    cmp_swap(v, 12, 20);
+    cmp_swap(v, 13, 21);
+    cmp_swap(v, 14, 22);
+    cmp_swap(v, 15, 23);
+
+    cmp_swap(v, 0, 4);
+    cmp_swap(v, 1, 5);
+    cmp_swap(v, 2, 6);
+    cmp_swap(v, 3, 7);
+    cmp_swap(v, 8, 12);
+    cmp_swap(v, 9, 13);
+    cmp_swap(v, 10, 14);
+    cmp_swap(v, 11, 15);
+    cmp_swap(v, 16, 20);
+    cmp_swap(v, 17, 21);
+    cmp_swap(v, 18, 22);
+    cmp_swap(v, 19, 23);
+
+    cmp_swap(v, 4, 16);
+    cmp_swap(v, 5, 17);
+    cmp_swap(v, 6, 18);
+    cmp_swap(v, 7, 19);
+
+    cmp_swap(v, 4, 8);
+    cmp_swap(v, 5, 9);
+    cmp_swap(v, 6, 10);
+    cmp_swap(v, 7, 11);
+    cmp_swap(v, 12, 16);
+    cmp_swap(v, 13, 17);
+    cmp_swap(v, 14, 18);
+    cmp_swap(v, 15, 19);
+
+    cmp_swap(v, 0, 2);
+    cmp_swap(v, 1, 3);
+    cmp_swap(v, 4, 6);
+    cmp_swap(v, 5, 7);
+    cmp_swap(v, 8, 10);
+    cmp_swap(v, 9, 11);
+    cmp_swap(v, 12, 14);
+    cmp_swap(v, 13, 15);
+    cmp_swap(v, 16, 18);
+    cmp_swap(v, 17, 19);
+    cmp_swap(v, 20, 22);
+    cmp_swap(v, 21, 23);
+
+    cmp_swap(v, 2, 16);
+    cmp_swap(v, 3, 17);
+    cmp_swap(v, 6, 20);
+    cmp_swap(v, 7, 21);
+
+    cmp_swap(v, 2, 8);
+    cmp_swap(v, 3, 9);
+    cmp_swap(v, 6, 12);
+    cmp_swap(v, 7, 13);
+    cmp_swap(v, 10, 16);
+    cmp_swap(v, 11, 17);
+    cmp_swap(v, 14, 20);
+    cmp_swap(v, 15, 21);
+
+    cmp_swap(v, 2, 4);
+    cmp_swap(v, 3, 5);
+    cmp_swap(v, 6, 8);
+    cmp_swap(v, 7, 9);
+    cmp_swap(v, 10, 12);
+    cmp_swap(v, 11, 13);
+    cmp_swap(v, 14, 16);
+    cmp_swap(v, 15, 17);
+    cmp_swap(v, 18, 20);
+    cmp_swap(v, 19, 21);
+
+    cmp_swap(v, 0, 1);
+    cmp_swap(v, 2, 3);
+    cmp_swap(v, 4, 5);
+    cmp_swap(v, 6, 7);
+    cmp_swap(v, 8, 9);
+    cmp_swap(v, 10, 11);
+    cmp_swap(v, 12, 13);
+    cmp_swap(v, 14, 15);
+    cmp_swap(v, 16, 17);
+    cmp_swap(v, 18, 19);
+    cmp_swap(v, 20, 21);
+    cmp_swap(v, 22, 23);
+
+    cmp_swap(v, 1, 16);
+    cmp_swap(v, 3, 18);
+    cmp_swap(v, 5, 20);
+    cmp_swap(v, 7, 22);
+
+    cmp_swap(v, 1, 8);
+    cmp_swap(v, 3, 10);
+    cmp_swap(v, 5, 12);
+    cmp_swap(v, 7, 14);
+    cmp_swap(v, 9, 16);
+    cmp_swap(v, 11, 18);
+    cmp_swap(v, 13, 20);
+    cmp_swap(v, 15, 22);
+
+    cmp_swap(v, 1, 4);
+    cmp_swap(v, 3, 6);
+    cmp_swap(v, 5, 8);
+    cmp_swap(v, 7, 10);
+    cmp_swap(v, 9, 12);
+    cmp_swap(v, 11, 14);
+    cmp_swap(v, 13, 16);
+    cmp_swap(v, 15, 18);
+    cmp_swap(v, 17, 20);
+    cmp_swap(v, 19, 22);
+
+    cmp_swap(v, 1, 2);
+    cmp_swap(v, 3, 4);
+    cmp_swap(v, 5, 6);
+    cmp_swap(v, 7, 8);
+    cmp_swap(v, 9, 10);
+    cmp_swap(v, 11, 12);
+    cmp_swap(v, 13, 14);
+    cmp_swap(v, 15, 16);
+    cmp_swap(v, 17, 18);
+    cmp_swap(v, 19, 20);
+    cmp_swap(v, 21, 22);
+  }
+};
+
+template <>
+struct FixedNetwork<25> {
+  template <typename T>
+  static void sort(T* v) noexcept {
+    // 138 compare-exchanges, depth 15.
+    cmp_swap(v, 0, 16);
+    cmp_swap(v, 1, 17);
+    cmp_swap(v, 2, 18);
+    cmp_swap(v, 3, 19);
+    cmp_swap(v, 4, 20);
+    cmp_swap(v, 5, 21);
+    cmp_swap(v, 6, 22);
+    cmp_swap(v, 7, 23);
+    cmp_swap(v, 8, 24);
+
+    cmp_swap(v, 0, 8);
+    cmp_swap(v, 1, 9);
+    cmp_swap(v, 2, 10);
+    cmp_swap(v, 3, 11);
+    cmp_swap(v, 4, 12);
+    cmp_swap(v, 5, 13);
+    cmp_swap(v, 6, 14);
+    cmp_swap(v, 7, 15);
+    cmp_swap(v, 16, 24);
+
+    cmp_swap(v, 8, 16);
+    cmp_swap(v, 9, 17);
+    cmp_swap(v, 10, 18);
+    cmp_swap(v, 11, 19);
+    cmp_swap(v, 12, 20);
+    cmp_swap(v, 13, 21);
+    cmp_swap(v, 14, 22);
+    cmp_swap(v, 15, 23);
+
+    cmp_swap(v, 0, 4);
+    cmp_swap(v, 1, 5);
+    cmp_swap(v, 2, 6);
+    cmp_swap(v, 3, 7);
+    cmp_swap(v, 8, 12);
+    cmp_swap(v, 9, 13);
+    cmp_swap(v, 10, 14);
+    cmp_swap(v, 11, 15);
+    cmp_swap(v, 16, 20);
+    cmp_swap(v, 17, 21);
+    cmp_swap(v, 18, 22);
+    cmp_swap(v, 19, 23);
+
+    cmp_swap(v, 4, 16);
+    cmp_swap(v, 5, 17);
+    cmp_swap(v, 6, 18);
+    cmp_swap(v, 7, 19);
+    cmp_swap(v, 12, 24);
+
+    cmp_swap(v, 4, 8);
+    cmp_swap(v, 5, 9);
+    cmp_swap(v, 6, 10);
+    cmp_swap(v, 7, 11);
+    cmp_swap(v, 12, 16);
+    cmp_swap(v, 13, 17);
+    cmp_swap(v, 14, 18);
+    cmp_swap(v, 15, 19);
+    cmp_swap(v, 20, 24);
+
+    cmp_swap(v, 0, 2);
+    cmp_swap(v, 1, 3);
+    cmp_swap(v, 4, 6);
+    cmp_swap(v, 5, 7);
+    cmp_swap(v, 8, 10);
+    cmp_swap(v, 9, 11);
+    cmp_swap(v, 12, 14);
+    cmp_swap(v, 13, 15);
+    cmp_swap(v, 16, 18);
+    cmp_swap(v, 17, 19);
+    cmp_swap(v, 20, 22);
+    cmp_swap(v, 21, 23);
+
+    cmp_swap(v, 2, 16);
+    cmp_swap(v, 3, 17);
+    cmp_swap(v, 6, 20);
+    cmp_swap(v, 7, 21);
+    cmp_swap(v, 10, 24);
+
+    cmp_swap(v, 2, 8);
+    cmp_swap(v, 3, 9);
+    cmp_swap(v, 6, 12);
+    cmp_swap(v, 7, 13);
+    cmp_swap(v, 10, 16);
+    cmp_swap(v, 11, 17);
+    cmp_swap(v, 14, 20);
+    cmp_swap(v, 15, 21);
+    cmp_swap(v, 18, 24);
+
+    cmp_swap(v, 2, 4);
+    cmp_swap(v, 3, 5);
+    cmp_swap(v, 6, 8);
+    cmp_swap(v, 7, 9);
+    cmp_swap(v, 10, 12);
+    cmp_swap(v, 11, 13);
+    cmp_swap(v, 14, 16);
+    cmp_swap(v, 15, 17);
+    cmp_swap(v, 18, 20);
+    cmp_swap(v, 19, 21);
+    cmp_swap(v, 22, 24);
+
+    cmp_swap(v, 0, 1);
+    cmp_swap(v, 2, 3);
+    cmp_swap(v, 4, 5);
+    cmp_swap(v, 6, 7);
+    cmp_swap(v, 8, 9);
+    cmp_swap(v, 10, 11);
+    cmp_swap(v, 12, 13);
+    cmp_swap(v, 14, 15);
+    cmp_swap(v, 16, 17);
+    cmp_swap(v, 18, 19);
+    cmp_swap(v, 20, 21);
+    cmp_swap(v, 22, 23);
+
+    cmp_swap(v, 1, 16);
+    cmp_swap(v, 3, 18);
+    cmp_swap(v, 5, 20);
+    cmp_swap(v, 7, 22);
+    cmp_swap(v, 9, 24);
+
+    cmp_swap(v, 1, 8);
+    cmp_swap(v, 3, 10);
+    cmp_swap(v, 5, 12);
+    cmp_swap(v, 7, 14);
+    cmp_swap(v, 9, 16);
+    cmp_swap(v, 11, 18);
+    cmp_swap(v, 13, 20);
+    cmp_swap(v, 15, 22);
+    cmp_swap(v, 17, 24);
+
+    cmp_swap(v, 1, 4);
+    cmp_swap(v, 3, 6);
+    cmp_swap(v, 5, 8);
+    cmp_swap(v, 7, 10);
+    cmp_swap(v, 9, 12);
+    cmp_swap(v, 11, 14);
+    cmp_swap(v, 13, 16);
+    cmp_swap(v, 15, 18);
+    cmp_swap(v, 17, 20);
+    cmp_swap(v, 19, 22);
+    cmp_swap(v, 21, 24);
+
+    cmp_swap(v, 1, 2);
+    cmp_swap(v, 3, 4);
+    cmp_swap(v, 5, 6);
+    cmp_swap(v, 7, 8);
+    cmp_swap(v, 9, 10);
+    cmp_swap(v, 11, 12);
+    cmp_swap(v, 13, 14);
+    cmp_swap(v, 15, 16);
+    cmp_swap(v, 17, 18);
+    cmp_swap(v, 19, 20);
+    cmp_swap(v, 21, 22);
+    cmp_swap(v, 23, 24);
+  }
+};
+
+template <>
+struct FixedNetwork<26> {
+  template <typename T>
+  static void sort(T* v) noexcept {
+    // 146 compare-exchanges, depth 15.
+    cmp_swap(v, 0, 16);
+    cmp_swap(v, 1, 17);
+    cmp_swap(v, 2, 18);
+    cmp_swap(v, 3, 19);
+    cmp_swap(v, 4, 20);
+    cmp_swap(v, 5, 21);
+    cmp_swap(v, 6, 22);
+    cmp_swap(v, 7, 23);
+    cmp_swap(v, 8, 24);
+    cmp_swap(v, 9, 25);
+
+    cmp_swap(v, 0, 8);
+    cmp_swap(v, 1, 9);
+    cmp_swap(v, 2, 10);
+    cmp_swap(v, 3, 11);
+    cmp_swap(v, 4, 12);
+    cmp_swap(v, 5, 13);
+    cmp_swap(v, 6, 14);
+    cmp_swap(v, 7, 15);
+    cmp_swap(v, 16, 24);
+    cmp_swap(v, 17, 25);
+
+    cmp_swap(v, 8, 16);
+    cmp_swap(v, 9, 17);
+    cmp_swap(v, 10, 18);
+    cmp_swap(v, 11, 19);
+    cmp_swap(v, 12, 20);
+    cmp_swap(v, 13, 21);
+    cmp_swap(v, 14, 22);
+    cmp_swap(v, 15, 23);
+
+    cmp_swap(v, 0, 4);
+    cmp_swap(v, 1, 5);
+    cmp_swap(v, 2, 6);
+    cmp_swap(v, 3, 7);
+    cmp_swap(v, 8, 12);
+    cmp_swap(v, 9, 13);
+    cmp_swap(v, 10, 14);
+    cmp_swap(v, 11, 15);
+    cmp_swap(v, 16, 20);
+    cmp_swap(v, 17, 21);
+    cmp_swap(v, 18, 22);
+    cmp_swap(v, 19, 23);
+
+    cmp_swap(v, 4, 16);
+    cmp_swap(v, 5, 17);
+    cmp_swap(v, 6, 18);
+    cmp_swap(v, 7, 19);
+    cmp_swap(v, 12, 24);
+    cmp_swap(v, 13, 25);
+
+    cmp_swap(v, 4, 8);
+    cmp_swap(v, 5, 9);
+    cmp_swap(v, 6, 10);
+    cmp_swap(v, 7, 11);
+    cmp_swap(v, 12, 16);
+    cmp_swap(v, 13, 17);
+    cmp_swap(v, 14, 18);
+    cmp_swap(v, 15, 19);
+    cmp_swap(v, 20, 24);
+    cmp_swap(v, 21, 25);
+
+    cmp_swap(v, 0, 2);
+    cmp_swap(v, 1, 3);
+    cmp_swap(v, 4, 6);
+    cmp_swap(v, 5, 7);
+    cmp_swap(v, 8, 10);
+    cmp_swap(v, 9, 11);
+    cmp_swap(v, 12, 14);
+    cmp_swap(v, 13, 15);
+    cmp_swap(v, 16, 18);
+    cmp_swap(v, 17, 19);
+    cmp_swap(v, 20, 22);
+    cmp_swap(v, 21, 23);
+
+    cmp_swap(v, 2, 16);
+    cmp_swap(v, 3, 17);
+    cmp_swap(v, 6, 20);
+    cmp_swap(v, 7, 21);
+    cmp_swap(v, 10, 24);
+    cmp_swap(v, 11, 25);
+
+    cmp_swap(v, 2, 8);
+    cmp_swap(v, 3, 9);
+    cmp_swap(v, 6, 12);
+    cmp_swap(v, 7, 13);
+    cmp_swap(v, 10, 16);
+    cmp_swap(v, 11, 17);
+    cmp_swap(v, 14, 20);
+    cmp_swap(v, 15, 21);
+    cmp_swap(v, 18, 24);
+    cmp_swap(v, 19, 25);
+
+    cmp_swap(v, 2, 4);
+    cmp_swap(v, 3, 5);
+    cmp_swap(v, 6, 8);
+    cmp_swap(v, 7, 9);
+    cmp_swap(v, 10, 12);
+    cmp_swap(v, 11, 13);
+    cmp_swap(v, 14, 16);
+    cmp_swap(v, 15, 17);
+    cmp_swap(v, 18, 20);
+    cmp_swap(v, 19, 21);
+    cmp_swap(v, 22, 24);
+    cmp_swap(v, 23, 25);
+
+    cmp_swap(v, 0, 1);
+    cmp_swap(v, 2, 3);
+    cmp_swap(v, 4, 5);
+    cmp_swap(v, 6, 7);
+    cmp_swap(v, 8, 9);
+    cmp_swap(v, 10, 11);
+    cmp_swap(v, 12, 13);
+    cmp_swap(v, 14, 15);
+    cmp_swap(v, 16, 17);
+    cmp_swap(v, 18, 19);
+    cmp_swap(v, 20, 21);
+    cmp_swap(v, 22, 23);
+    cmp_swap(v, 24, 25);
+
+    cmp_swap(v, 1, 16);
+    cmp_swap(v, 3, 18);
+    cmp_swap(v, 5, 20);
+    cmp_swap(v, 7, 22);
+    cmp_swap(v, 9, 24);
+
+    cmp_swap(v, 1, 8);
+    cmp_swap(v, 3, 10);
+    cmp_swap(v, 5, 12);
+    cmp_swap(v, 7, 14);
+    cmp_swap(v, 9, 16);
+    cmp_swap(v, 11, 18);
+    cmp_swap(v, 13, 20);
+    cmp_swap(v, 15, 22);
+    cmp_swap(v, 17, 24);
+
+    cmp_swap(v, 1, 4);
+    cmp_swap(v, 3, 6);
+    cmp_swap(v, 5, 8);
+    cmp_swap(v, 7, 10);
+    cmp_swap(v, 9, 12);
+    cmp_swap(v, 11, 14);
+    cmp_swap(v, 13, 16);
+    cmp_swap(v, 15, 18);
+    cmp_swap(v, 17, 20);
+    cmp_swap(v, 19, 22);
+    cmp_swap(v, 21, 24);
+
+    cmp_swap(v, 1, 2);
+    cmp_swap(v, 3, 4);
+    cmp_swap(v, 5, 6);
+    cmp_swap(v, 7, 8);
+    cmp_swap(v, 9, 10);
+    cmp_swap(v, 11, 12);
+    cmp_swap(v, 13, 14);
+    cmp_swap(v, 15, 16);
+    cmp_swap(v, 17, 18);
+    cmp_swap(v, 19, 20);
+    cmp_swap(v, 21, 22);
+    cmp_swap(v, 23, 24);
+  }
+};
+
+template <>
+struct FixedNetwork<27> {
+  template <typename T>
+  static void sort(T* v) noexcept {
+    // 155 compare-exchanges, depth 15.
+    cmp_swap(v, 0, 16);
+    cmp_swap(v, 1, 17);
+    cmp_swap(v, 2, 18);
+    cmp_swap(v, 3, 19);
+    cmp_swap(v, 4, 20);
+    cmp_swap(v, 5, 21);
+    cmp_swap(v, 6, 22);
+    cmp_swap(v, 7, 23);
+    cmp_swap(v, 8, 24);
+    cmp_swap(v, 9, 25);
+    cmp_swap(v, 10, 26);
+
+    cmp_swap(v, 0, 8);
+    cmp_swap(v, 1, 9);
+    cmp_swap(v, 2, 10);
+    cmp_swap(v, 3, 11);
+    cmp_swap(v, 4, 12);
+    cmp_swap(v, 5, 13);
+    cmp_swap(v, 6, 14);
+    cmp_swap(v, 7, 15);
+    cmp_swap(v, 16, 24);
+    cmp_swap(v, 17, 25);
+    cmp_swap(v, 18, 26);
+
+    cmp_swap(v, 8, 16);
+    cmp_swap(v, 9, 17);
+    cmp_swap(v, 10, 18);
+    cmp_swap(v, 11, 19);
+    cmp_swap(v, 12, 20);
+    cmp_swap(v, 13, 21);
+    cmp_swap(v, 14, 22);
+    cmp_swap(v, 15, 23);
+
+    cmp_swap(v, 0, 4);
+    cmp_swap(v, 1, 5);
+    cmp_swap(v, 2, 6);
+    cmp_swap(v, 3, 7);
+    cmp_swap(v, 8, 12);
+    cmp_swap(v, 9, 13);
+    cmp_swap(v, 10, 14);
+    cmp_swap(v, 11, 15);
+    cmp_swap(v, 16, 20);
+    cmp_swap(v, 17, 21);
+    cmp_swap(v, 18, 22);
+    cmp_swap(v, 19, 23);
+
+    cmp_swap(v, 4, 16);
+    cmp_swap(v, 5, 17);
+    cmp_swap(v, 6, 18);
+    cmp_swap(v, 7, 19);
+    cmp_swap(v, 12, 24);
+    cmp_swap(v, 13, 25);
+    cmp_swap(v, 14, 26);
+
+    cmp_swap(v, 4, 8);
+    cmp_swap(v, 5, 9);
+    cmp_swap(v, 6, 10);
+    cmp_swap(v, 7, 11);
+    cmp_swap(v, 12, 16);
+    cmp_swap(v, 13, 17);
+    cmp_swap(v, 14, 18);
+    cmp_swap(v, 15, 19);
+    cmp_swap(v, 20, 24);
+    cmp_swap(v, 21, 25);
+    cmp_swap(v, 22, 26);
+
+    cmp_swap(v, 0, 2);
+    cmp_swap(v, 1, 3);
+    cmp_swap(v, 4, 6);
+    cmp_swap(v, 5, 7);
+    cmp_swap(v, 8, 10);
+    cmp_swap(v, 9, 11);
+    cmp_swap(v, 12, 14);
+    cmp_swap(v, 13, 15);
+    cmp_swap(v, 16, 18);
+    cmp_swap(v, 17, 19);
+    cmp_swap(v, 20, 22);
+    cmp_swap(v, 21, 23);
+    cmp_swap(v, 24, 26);
+
+    cmp_swap(v, 2, 16);
+    cmp_swap(v, 3, 17);
+    cmp_swap(v, 6, 20);
+    cmp_swap(v, 7, 21);
+    cmp_swap(v, 10, 24);
+    cmp_swap(v, 11, 25);
+
+    cmp_swap(v, 2, 8);
+    cmp_swap(v, 3, 9);
+    cmp_swap(v, 6, 12);
+    cmp_swap(v, 7, 13);
+    cmp_swap(v, 10, 16);
+    cmp_swap(v, 11, 17);
+    cmp_swap(v, 14, 20);
+    cmp_swap(v, 15, 21);
+    cmp_swap(v, 18, 24);
+    cmp_swap(v, 19, 25);
+
+    cmp_swap(v, 2, 4);
+    cmp_swap(v, 3, 5);
+    cmp_swap(v, 6, 8);
+    cmp_swap(v, 7, 9);
+    cmp_swap(v, 10, 12);
+    cmp_swap(v, 11, 13);
+    cmp_swap(v, 14, 16);
+    cmp_swap(v, 15, 17);
+    cmp_swap(v, 18, 20);
+    cmp_swap(v, 19, 21);
+    cmp_swap(v, 22, 24);
+    cmp_swap(v, 23, 25);
+
+    cmp_swap(v, 0, 1);
+    cmp_swap(v, 2, 3);
+    cmp_swap(v, 4, 5);
+    cmp_swap(v, 6, 7);
+    cmp_swap(v, 8, 9);
+    cmp_swap(v, 10, 11);
+    cmp_swap(v, 12, 13);
+    cmp_swap(v, 14, 15);
+    cmp_swap(v, 16, 17);
+    cmp_swap(v, 18, 19);
+    cmp_swap(v, 20, 21);
+    cmp_swap(v, 22, 23);
+    cmp_swap(v, 24, 25);
+
+    cmp_swap(v, 1, 16);
+    cmp_swap(v, 3, 18);
+    cmp_swap(v, 5, 20);
+    cmp_swap(v, 7, 22);
+    cmp_swap(v, 9, 24);
+    cmp_swap(v, 11, 26);
+
+    cmp_swap(v, 1, 8);
+    cmp_swap(v, 3, 10);
+    cmp_swap(v, 5, 12);
+    cmp_swap(v, 7, 14);
+    cmp_swap(v, 9, 16);
+    cmp_swap(v, 11, 18);
+    cmp_swap(v, 13, 20);
+    cmp_swap(v, 15, 22);
+    cmp_swap(v, 17, 24);
+    cmp_swap(v, 19, 26);
+
+    cmp_swap(v, 1, 4);
+    cmp_swap(v, 3, 6);
+    cmp_swap(v, 5, 8);
+    cmp_swap(v, 7, 10);
+    cmp_swap(v, 9, 12);
+    cmp_swap(v, 11, 14);
+    cmp_swap(v, 13, 16);
+    cmp_swap(v, 15, 18);
+    cmp_swap(v, 17, 20);
+    cmp_swap(v, 19, 22);
+    cmp_swap(v, 21, 24);
+    cmp_swap(v, 23, 26);
+
+    cmp_swap(v, 1, 2);
+    cmp_swap(v, 3, 4);
+    cmp_swap(v, 5, 6);
+    cmp_swap(v, 7, 8);
+    cmp_swap(v, 9, 10);
+    cmp_swap(v, 11, 12);
+    cmp_swap(v, 13, 14);
+    cmp_swap(v, 15, 16);
+    cmp_swap(v, 17, 18);
+    cmp_swap(v, 19, 20);
+    cmp_swap(v, 21, 22);
+    cmp_swap(v, 23, 24);
+    cmp_swap(v, 25, 26);
+  }
+};
+
+template <>
+struct FixedNetwork<28> {
+  template <typename T>
+  static void sort(T* v) noexcept {
+    // 161 compare-exchanges, depth 15.
+    cmp_swap(v, 0, 16);
+    cmp_swap(v, 1, 17);
+    cmp_swap(v, 2, 18);
+    cmp_swap(v, 3, 19);
+    cmp_swap(v, 4, 20);
+    cmp_swap(v, 5, 21);
+    cmp_swap(v, 6, 22);
+    cmp_swap(v, 7, 23);
+    cmp_swap(v, 8, 24);
+    cmp_swap(v, 9, 25);
+    cmp_swap(v, 10, 26);
+    cmp_swap(v, 11, 27);
+
+    cmp_swap(v, 0, 8);
+    cmp_swap(v, 1, 9);
+    cmp_swap(v, 2, 10);
+    cmp_swap(v, 3, 11);
+    cmp_swap(v, 4, 12);
+    cmp_swap(v, 5, 13);
+    cmp_swap(v, 6, 14);
+    cmp_swap(v, 7, 15);
+    cmp_swap(v, 16, 24);
+    cmp_swap(v, 17, 25);
+    cmp_swap(v, 18, 26);
+    cmp_swap(v, 19, 27);
+
+    cmp_swap(v, 8, 16);
+    cmp_swap(v, 9, 17);
+    cmp_swap(v, 10, 18);
+    cmp_swap(v, 11, 19);
+    cmp_swap(v, 12, 20);
+    cmp_swap(v, 13, 21);
+    cmp_swap(v, 14, 22);
+    cmp_swap(v, 15, 23);
+
+    cmp_swap(v, 0, 4);
+    cmp_swap(v, 1, 5);
+    cmp_swap(v, 2, 6);
+    cmp_swap(v, 3, 7);
+    cmp_swap(v, 8, 12);
+    cmp_swap(v, 9, 13);
+    cmp_swap(v, 10, 14);
+    cmp_swap(v, 11, 15);
+    cmp_swap(v, 16, 20);
+    cmp_swap(v, 17, 21);
+    cmp_swap(v, 18, 22);
+    cmp_swap(v, 19, 23);
+
+    cmp_swap(v, 4, 16);
+    cmp_swap(v, 5, 17);
+    cmp_swap(v, 6, 18);
+    cmp_swap(v, 7, 19);
+    cmp_swap(v, 12, 24);
+    cmp_swap(v, 13, 25);
+    cmp_swap(v, 14, 26);
+    cmp_swap(v, 15, 27);
+
+    cmp_swap(v, 4, 8);
+    cmp_swap(v, 5, 9);
+    cmp_swap(v, 6, 10);
+    cmp_swap(v, 7, 11);
+    cmp_swap(v, 12, 16);
+    cmp_swap(v, 13, 17);
+    cmp_swap(v, 14, 18);
+    cmp_swap(v, 15, 19);
+    cmp_swap(v, 20, 24);
+    cmp_swap(v, 21, 25);
+    cmp_swap(v, 22, 26);
+    cmp_swap(v, 23, 27);
+
+    cmp_swap(v, 0, 2);
+    cmp_swap(v, 1, 3);
+    cmp_swap(v, 4, 6);
+    cmp_swap(v, 5, 7);
+    cmp_swap(v, 8, 10);
+    cmp_swap(v, 9, 11);
+    cmp_swap(v, 12, 14);
+    cmp_swap(v, 13, 15);
+    cmp_swap(v, 16, 18);
+    cmp_swap(v, 17, 19);
+    cmp_swap(v, 20, 22);
+    cmp_swap(v, 21, 23);
+    cmp_swap(v, 24, 26);
+    cmp_swap(v, 25, 27);
+
+    cmp_swap(v, 2, 16);
+    cmp_swap(v, 3, 17);
+    cmp_swap(v, 6, 20);
+    cmp_swap(v, 7, 21);
+    cmp_swap(v, 10, 24);
+    cmp_swap(v, 11, 25);
+
+    cmp_swap(v, 2, 8);
+    cmp_swap(v, 3, 9);
+    cmp_swap(v, 6, 12);
+    cmp_swap(v, 7, 13);
+    cmp_swap(v, 10, 16);
+    cmp_swap(v, 11, 17);
+    cmp_swap(v, 14, 20);
+    cmp_swap(v, 15, 21);
+    cmp_swap(v, 18, 24);
+    cmp_swap(v, 19, 25);
+
+    cmp_swap(v, 2, 4);
+    cmp_swap(v, 3, 5);
+    cmp_swap(v, 6, 8);
+    cmp_swap(v, 7, 9);
+    cmp_swap(v, 10, 12);
+    cmp_swap(v, 11, 13);
+    cmp_swap(v, 14, 16);
+    cmp_swap(v, 15, 17);
+    cmp_swap(v, 18, 20);
+    cmp_swap(v, 19, 21);
+    cmp_swap(v, 22, 24);
+    cmp_swap(v, 23, 25);
+
+    cmp_swap(v, 0, 1);
+    cmp_swap(v, 2, 3);
+    cmp_swap(v, 4, 5);
+    cmp_swap(v, 6, 7);
+    cmp_swap(v, 8, 9);
+    cmp_swap(v, 10, 11);
+    cmp_swap(v, 12, 13);
+    cmp_swap(v, 14, 15);
+    cmp_swap(v, 16, 17);
+    cmp_swap(v, 18, 19);
+    cmp_swap(v, 20, 21);
+    cmp_swap(v, 22, 23);
+    cmp_swap(v, 24, 25);
+    cmp_swap(v, 26, 27);
+
+    cmp_swap(v, 1, 16);
+    cmp_swap(v, 3, 18);
+    cmp_swap(v, 5, 20);
+    cmp_swap(v, 7, 22);
+    cmp_swap(v, 9, 24);
+    cmp_swap(v, 11, 26);
+
+    cmp_swap(v, 1, 8);
+    cmp_swap(v, 3, 10);
+    cmp_swap(v, 5, 12);
+    cmp_swap(v, 7, 14);
+    cmp_swap(v, 9, 16);
+    cmp_swap(v, 11, 18);
+    cmp_swap(v, 13, 20);
+    cmp_swap(v, 15, 22);
+    cmp_swap(v, 17, 24);
+    cmp_swap(v, 19, 26);
+
+    cmp_swap(v, 1, 4);
+    cmp_swap(v, 3, 6);
+    cmp_swap(v, 5, 8);
+    cmp_swap(v, 7, 10);
+    cmp_swap(v, 9, 12);
+    cmp_swap(v, 11, 14);
+    cmp_swap(v, 13, 16);
+    cmp_swap(v, 15, 18);
+    cmp_swap(v, 17, 20);
+    cmp_swap(v, 19, 22);
+    cmp_swap(v, 21, 24);
+    cmp_swap(v, 23, 26);
+
+    cmp_swap(v, 1, 2);
+    cmp_swap(v, 3, 4);
+    cmp_swap(v, 5, 6);
+    cmp_swap(v, 7, 8);
+    cmp_swap(v, 9, 10);
+    cmp_swap(v, 11, 12);
+    cmp_swap(v, 13, 14);
+    cmp_swap(v, 15, 16);
+    cmp_swap(v, 17, 18);
+    cmp_swap(v, 19, 20);
+    cmp_swap(v, 21, 22);
+    cmp_swap(v, 23, 24);
+    cmp_swap(v, 25, 26);
+  }
+};
+
+template <>
+struct FixedNetwork<29> {
+  template <typename T>
+  static void sort(T* v) noexcept {
+    // 171 compare-exchanges, depth 15.
+    cmp_swap(v, 0, 16);
+    cmp_swap(v, 1, 17);
+    cmp_swap(v, 2, 18);
+    cmp_swap(v, 3, 19);
+    cmp_swap(v, 4, 20);
+    cmp_swap(v, 5, 21);
+    cmp_swap(v, 6, 22);
+    cmp_swap(v, 7, 23);
+    cmp_swap(v, 8, 24);
+    cmp_swap(v, 9, 25);
+    cmp_swap(v, 10, 26);
+    cmp_swap(v, 11, 27);
+    cmp_swap(v, 12, 28);
+
+    cmp_swap(v, 0, 8);
+    cmp_swap(v, 1, 9);
+    cmp_swap(v, 2, 10);
+    cmp_swap(v, 3, 11);
+    cmp_swap(v, 4, 12);
+    cmp_swap(v, 5, 13);
+    cmp_swap(v, 6, 14);
+    cmp_swap(v, 7, 15);
+    cmp_swap(v, 16, 24);
+    cmp_swap(v, 17, 25);
+    cmp_swap(v, 18, 26);
+    cmp_swap(v, 19, 27);
+    cmp_swap(v, 20, 28);
+
+    cmp_swap(v, 8, 16);
+    cmp_swap(v, 9, 17);
+    cmp_swap(v, 10, 18);
+    cmp_swap(v, 11, 19);
+    cmp_swap(v, 12, 20);
+    cmp_swap(v, 13, 21);
+    cmp_swap(v, 14, 22);
+    cmp_swap(v, 15, 23);
+
+    cmp_swap(v, 0, 4);
+    cmp_swap(v, 1, 5);
+    cmp_swap(v, 2, 6);
+    cmp_swap(v, 3, 7);
+    cmp_swap(v, 8, 12);
+    cmp_swap(v, 9, 13);
+    cmp_swap(v, 10, 14);
+    cmp_swap(v, 11, 15);
+    cmp_swap(v, 16, 20);
+    cmp_swap(v, 17, 21);
+    cmp_swap(v, 18, 22);
+    cmp_swap(v, 19, 23);
+    cmp_swap(v, 24, 28);
+
+    cmp_swap(v, 4, 16);
+    cmp_swap(v, 5, 17);
+    cmp_swap(v, 6, 18);
+    cmp_swap(v, 7, 19);
+    cmp_swap(v, 12, 24);
+    cmp_swap(v, 13, 25);
+    cmp_swap(v, 14, 26);
+    cmp_swap(v, 15, 27);
+
+    cmp_swap(v, 4, 8);
+    cmp_swap(v, 5, 9);
+    cmp_swap(v, 6, 10);
+    cmp_swap(v, 7, 11);
+    cmp_swap(v, 12, 16);
+    cmp_swap(v, 13, 17);
+    cmp_swap(v, 14, 18);
+    cmp_swap(v, 15, 19);
+    cmp_swap(v, 20, 24);
+    cmp_swap(v, 21, 25);
+    cmp_swap(v, 22, 26);
+    cmp_swap(v, 23, 27);
+
+    cmp_swap(v, 0, 2);
+    cmp_swap(v, 1, 3);
+    cmp_swap(v, 4, 6);
+    cmp_swap(v, 5, 7);
+    cmp_swap(v, 8, 10);
+    cmp_swap(v, 9, 11);
+    cmp_swap(v, 12, 14);
+    cmp_swap(v, 13, 15);
+    cmp_swap(v, 16, 18);
+    cmp_swap(v, 17, 19);
+    cmp_swap(v, 20, 22);
+    cmp_swap(v, 21, 23);
+    cmp_swap(v, 24, 26);
+    cmp_swap(v, 25, 27);
+
+    cmp_swap(v, 2, 16);
+    cmp_swap(v, 3, 17);
+    cmp_swap(v, 6, 20);
+    cmp_swap(v, 7, 21);
+    cmp_swap(v, 10, 24);
+    cmp_swap(v, 11, 25);
+    cmp_swap(v, 14, 28);
+
+    cmp_swap(v, 2, 8);
+    cmp_swap(v, 3, 9);
+    cmp_swap(v, 6, 12);
+    cmp_swap(v, 7, 13);
+    cmp_swap(v, 10, 16);
+    cmp_swap(v, 11, 17);
+    cmp_swap(v, 14, 20);
+    cmp_swap(v, 15, 21);
+    cmp_swap(v, 18, 24);
+    cmp_swap(v, 19, 25);
+    cmp_swap(v, 22, 28);
+
+    cmp_swap(v, 2, 4);
+    cmp_swap(v, 3, 5);
+    cmp_swap(v, 6, 8);
+    cmp_swap(v, 7, 9);
+    cmp_swap(v, 10, 12);
+    cmp_swap(v, 11, 13);
+    cmp_swap(v, 14, 16);
+    cmp_swap(v, 15, 17);
+    cmp_swap(v, 18, 20);
+    cmp_swap(v, 19, 21);
+    cmp_swap(v, 22, 24);
+    cmp_swap(v, 23, 25);
+    cmp_swap(v, 26, 28);
+
+    cmp_swap(v, 0, 1);
+    cmp_swap(v, 2, 3);
+    cmp_swap(v, 4, 5);
+    cmp_swap(v, 6, 7);
+    cmp_swap(v, 8, 9);
+    cmp_swap(v, 10, 11);
+    cmp_swap(v, 12, 13);
+    cmp_swap(v, 14, 15);
+    cmp_swap(v, 16, 17);
+    cmp_swap(v, 18, 19);
+    cmp_swap(v, 20, 21);
+    cmp_swap(v, 22, 23);
+    cmp_swap(v, 24, 25);
+    cmp_swap(v, 26, 27);
+
+    cmp_swap(v, 1, 16);
+    cmp_swap(v, 3, 18);
+    cmp_swap(v, 5, 20);
+    cmp_swap(v, 7, 22);
+    cmp_swap(v, 9, 24);
+    cmp_swap(v, 11, 26);
+    cmp_swap(v, 13, 28);
+
+    cmp_swap(v, 1, 8);
+    cmp_swap(v, 3, 10);
+    cmp_swap(v, 5, 12);
+    cmp_swap(v, 7, 14);
+    cmp_swap(v, 9, 16);
+    cmp_swap(v, 11, 18);
+    cmp_swap(v, 13, 20);
+    cmp_swap(v, 15, 22);
+    cmp_swap(v, 17, 24);
+    cmp_swap(v, 19, 26);
+    cmp_swap(v, 21, 28);
+
+    cmp_swap(v, 1, 4);
+    cmp_swap(v, 3, 6);
+    cmp_swap(v, 5, 8);
+    cmp_swap(v, 7, 10);
+    cmp_swap(v, 9, 12);
+    cmp_swap(v, 11, 14);
+    cmp_swap(v, 13, 16);
+    cmp_swap(v, 15, 18);
+    cmp_swap(v, 17, 20);
+    cmp_swap(v, 19, 22);
+    cmp_swap(v, 21, 24);
+    cmp_swap(v, 23, 26);
+    cmp_swap(v, 25, 28);
+
+    cmp_swap(v, 1, 2);
+    cmp_swap(v, 3, 4);
+    cmp_swap(v, 5, 6);
+    cmp_swap(v, 7, 8);
+    cmp_swap(v, 9, 10);
+    cmp_swap(v, 11, 12);
+    cmp_swap(v, 13, 14);
+    cmp_swap(v, 15, 16);
+    cmp_swap(v, 17, 18);
+    cmp_swap(v, 19, 20);
+    cmp_swap(v, 21, 22);
+    cmp_swap(v, 23, 24);
+    cmp_swap(v, 25, 26);
+    cmp_swap(v, 27, 28);
+  }
+};
+
+template <>
+struct FixedNetwork<30> {
+  template <typename T>
+  static void sort(T* v) noexcept {
+    // 178 compare-exchanges, depth 15.
+    cmp_swap(v, 0, 16);
+    cmp_swap(v, 1, 17);
+    cmp_swap(v, 2, 18);
+    cmp_swap(v, 3, 19);
+    cmp_swap(v, 4, 20);
+    cmp_swap(v, 5, 21);
+    cmp_swap(v, 6, 22);
+    cmp_swap(v, 7, 23);
+    cmp_swap(v, 8, 24);
+    cmp_swap(v, 9, 25);
+    cmp_swap(v, 10, 26);
+    cmp_swap(v, 11, 27);
+    cmp_swap(v, 12, 28);
+    cmp_swap(v, 13, 29);
+
+    cmp_swap(v, 0, 8);
+    cmp_swap(v, 1, 9);
+    cmp_swap(v, 2, 10);
+    cmp_swap(v, 3, 11);
+    cmp_swap(v, 4, 12);
+    cmp_swap(v, 5, 13);
+    cmp_swap(v, 6, 14);
+    cmp_swap(v, 7, 15);
+    cmp_swap(v, 16, 24);
+    cmp_swap(v, 17, 25);
+    cmp_swap(v, 18, 26);
+    cmp_swap(v, 19, 27);
+    cmp_swap(v, 20, 28);
+    cmp_swap(v, 21, 29);
+
+    cmp_swap(v, 8, 16);
+    cmp_swap(v, 9, 17);
+    cmp_swap(v, 10, 18);
+    cmp_swap(v, 11, 19);
+    cmp_swap(v, 12, 20);
+    cmp_swap(v, 13, 21);
+    cmp_swap(v, 14, 22);
+    cmp_swap(v, 15, 23);
+
+    cmp_swap(v, 0, 4);
+    cmp_swap(v, 1, 5);
+    cmp_swap(v, 2, 6);
+    cmp_swap(v, 3, 7);
+    cmp_swap(v, 8, 12);
+    cmp_swap(v, 9, 13);
+    cmp_swap(v, 10, 14);
+    cmp_swap(v, 11, 15);
+    cmp_swap(v, 16, 20);
+    cmp_swap(v, 17, 21);
+    cmp_swap(v, 18, 22);
+    cmp_swap(v, 19, 23);
+    cmp_swap(v, 24, 28);
+    cmp_swap(v, 25, 29);
+
+    cmp_swap(v, 4, 16);
+    cmp_swap(v, 5, 17);
+    cmp_swap(v, 6, 18);
+    cmp_swap(v, 7, 19);
+    cmp_swap(v, 12, 24);
+    cmp_swap(v, 13, 25);
+    cmp_swap(v, 14, 26);
+    cmp_swap(v, 15, 27);
+
+    cmp_swap(v, 4, 8);
+    cmp_swap(v, 5, 9);
+    cmp_swap(v, 6, 10);
+    cmp_swap(v, 7, 11);
+    cmp_swap(v, 12, 16);
+    cmp_swap(v, 13, 17);
+    cmp_swap(v, 14, 18);
+    cmp_swap(v, 15, 19);
+    cmp_swap(v, 20, 24);
+    cmp_swap(v, 21, 25);
+    cmp_swap(v, 22, 26);
+    cmp_swap(v, 23, 27);
+
+    cmp_swap(v, 0, 2);
+    cmp_swap(v, 1, 3);
+    cmp_swap(v, 4, 6);
+    cmp_swap(v, 5, 7);
+    cmp_swap(v, 8, 10);
+    cmp_swap(v, 9, 11);
+    cmp_swap(v, 12, 14);
+    cmp_swap(v, 13, 15);
+    cmp_swap(v, 16, 18);
+    cmp_swap(v, 17, 19);
+    cmp_swap(v, 20, 22);
+    cmp_swap(v, 21, 23);
+    cmp_swap(v, 24, 26);
+    cmp_swap(v, 25, 27);
+
+    cmp_swap(v, 2, 16);
+    cmp_swap(v, 3, 17);
+    cmp_swap(v, 6, 20);
+    cmp_swap(v, 7, 21);
+    cmp_swap(v, 10, 24);
+    cmp_swap(v, 11, 25);
+    cmp_swap(v, 14, 28);
+    cmp_swap(v, 15, 29);
+
+    cmp_swap(v, 2, 8);
+    cmp_swap(v, 3, 9);
+    cmp_swap(v, 6, 12);
+    cmp_swap(v, 7, 13);
+    cmp_swap(v, 10, 16);
+    cmp_swap(v, 11, 17);
+    cmp_swap(v, 14, 20);
+    cmp_swap(v, 15, 21);
+    cmp_swap(v, 18, 24);
+    cmp_swap(v, 19, 25);
+    cmp_swap(v, 22, 28);
+    cmp_swap(v, 23, 29);
+
+    cmp_swap(v, 2, 4);
+    cmp_swap(v, 3, 5);
+    cmp_swap(v, 6, 8);
+    cmp_swap(v, 7, 9);
+    cmp_swap(v, 10, 12);
+    cmp_swap(v, 11, 13);
+    cmp_swap(v, 14, 16);
+    cmp_swap(v, 15, 17);
+    cmp_swap(v, 18, 20);
+    cmp_swap(v, 19, 21);
+    cmp_swap(v, 22, 24);
+    cmp_swap(v, 23, 25);
+    cmp_swap(v, 26, 28);
+    cmp_swap(v, 27, 29);
+
+    cmp_swap(v, 0, 1);
+    cmp_swap(v, 2, 3);
+    cmp_swap(v, 4, 5);
+    cmp_swap(v, 6, 7);
+    cmp_swap(v, 8, 9);
+    cmp_swap(v, 10, 11);
+    cmp_swap(v, 12, 13);
+    cmp_swap(v, 14, 15);
+    cmp_swap(v, 16, 17);
+    cmp_swap(v, 18, 19);
+    cmp_swap(v, 20, 21);
+    cmp_swap(v, 22, 23);
+    cmp_swap(v, 24, 25);
+    cmp_swap(v, 26, 27);
+    cmp_swap(v, 28, 29);
+
+    cmp_swap(v, 1, 16);
+    cmp_swap(v, 3, 18);
+    cmp_swap(v, 5, 20);
+    cmp_swap(v, 7, 22);
+    cmp_swap(v, 9, 24);
+    cmp_swap(v, 11, 26);
+    cmp_swap(v, 13, 28);
+
+    cmp_swap(v, 1, 8);
+    cmp_swap(v, 3, 10);
+    cmp_swap(v, 5, 12);
+    cmp_swap(v, 7, 14);
+    cmp_swap(v, 9, 16);
+    cmp_swap(v, 11, 18);
+    cmp_swap(v, 13, 20);
+    cmp_swap(v, 15, 22);
+    cmp_swap(v, 17, 24);
+    cmp_swap(v, 19, 26);
+    cmp_swap(v, 21, 28);
+
+    cmp_swap(v, 1, 4);
+    cmp_swap(v, 3, 6);
+    cmp_swap(v, 5, 8);
+    cmp_swap(v, 7, 10);
+    cmp_swap(v, 9, 12);
+    cmp_swap(v, 11, 14);
+    cmp_swap(v, 13, 16);
+    cmp_swap(v, 15, 18);
+    cmp_swap(v, 17, 20);
+    cmp_swap(v, 19, 22);
+    cmp_swap(v, 21, 24);
+    cmp_swap(v, 23, 26);
+    cmp_swap(v, 25, 28);
+
+    cmp_swap(v, 1, 2);
+    cmp_swap(v, 3, 4);
+    cmp_swap(v, 5, 6);
+    cmp_swap(v, 7, 8);
+    cmp_swap(v, 9, 10);
+    cmp_swap(v, 11, 12);
+    cmp_swap(v, 13, 14);
+    cmp_swap(v, 15, 16);
+    cmp_swap(v, 17, 18);
+    cmp_swap(v, 19, 20);
+    cmp_swap(v, 21, 22);
+    cmp_swap(v, 23, 24);
+    cmp_swap(v, 25, 26);
+    cmp_swap(v, 27, 28);
+  }
+};
+
+template <>
+struct FixedNetwork<31> {
+  template <typename T>
+  static void sort(T* v) noexcept {
+    // 186 compare-exchanges, depth 15.
+    cmp_swap(v, 0, 16);
+    cmp_swap(v, 1, 17);
+    cmp_swap(v, 2, 18);
+    cmp_swap(v, 3, 19);
+    cmp_swap(v, 4, 20);
+    cmp_swap(v, 5, 21);
+    cmp_swap(v, 6, 22);
+    cmp_swap(v, 7, 23);
+    cmp_swap(v, 8, 24);
+    cmp_swap(v, 9, 25);
+    cmp_swap(v, 10, 26);
+    cmp_swap(v, 11, 27);
+    cmp_swap(v, 12, 28);
+    cmp_swap(v, 13, 29);
+    cmp_swap(v, 14, 30);
+
+    cmp_swap(v, 0, 8);
+    cmp_swap(v, 1, 9);
+    cmp_swap(v, 2, 10);
+    cmp_swap(v, 3, 11);
+    cmp_swap(v, 4, 12);
+    cmp_swap(v, 5, 13);
+    cmp_swap(v, 6, 14);
+    cmp_swap(v, 7, 15);
+    cmp_swap(v, 16, 24);
+    cmp_swap(v, 17, 25);
+    cmp_swap(v, 18, 26);
+    cmp_swap(v, 19, 27);
+    cmp_swap(v, 20, 28);
+    cmp_swap(v, 21, 29);
+    cmp_swap(v, 22, 30);
+
+    cmp_swap(v, 8, 16);
+    cmp_swap(v, 9, 17);
+    cmp_swap(v, 10, 18);
+    cmp_swap(v, 11, 19);
+    cmp_swap(v, 12, 20);
+    cmp_swap(v, 13, 21);
+    cmp_swap(v, 14, 22);
+    cmp_swap(v, 15, 23);
+
+    cmp_swap(v, 0, 4);
+    cmp_swap(v, 1, 5);
+    cmp_swap(v, 2, 6);
+    cmp_swap(v, 3, 7);
+    cmp_swap(v, 8, 12);
+    cmp_swap(v, 9, 13);
+    cmp_swap(v, 10, 14);
+    cmp_swap(v, 11, 15);
+    cmp_swap(v, 16, 20);
+    cmp_swap(v, 17, 21);
+    cmp_swap(v, 18, 22);
+    cmp_swap(v, 19, 23);
+    cmp_swap(v, 24, 28);
+    cmp_swap(v, 25, 29);
+    cmp_swap(v, 26, 30);
+
+    cmp_swap(v, 4, 16);
+    cmp_swap(v, 5, 17);
+    cmp_swap(v, 6, 18);
+    cmp_swap(v, 7, 19);
+    cmp_swap(v, 12, 24);
+    cmp_swap(v, 13, 25);
+    cmp_swap(v, 14, 26);
+    cmp_swap(v, 15, 27);
+
+    cmp_swap(v, 4, 8);
+    cmp_swap(v, 5, 9);
+    cmp_swap(v, 6, 10);
+    cmp_swap(v, 7, 11);
+    cmp_swap(v, 12, 16);
+    cmp_swap(v, 13, 17);
+    cmp_swap(v, 14, 18);
+    cmp_swap(v, 15, 19);
+    cmp_swap(v, 20, 24);
+    cmp_swap(v, 21, 25);
+    cmp_swap(v, 22, 26);
+    cmp_swap(v, 23, 27);
+
+    cmp_swap(v, 0, 2);
+    cmp_swap(v, 1, 3);
+    cmp_swap(v, 4, 6);
+    cmp_swap(v, 5, 7);
+    cmp_swap(v, 8, 10);
+    cmp_swap(v, 9, 11);
+    cmp_swap(v, 12, 14);
+    cmp_swap(v, 13, 15);
+    cmp_swap(v, 16, 18);
+    cmp_swap(v, 17, 19);
+    cmp_swap(v, 20, 22);
+    cmp_swap(v, 21, 23);
+    cmp_swap(v, 24, 26);
+    cmp_swap(v, 25, 27);
+    cmp_swap(v, 28, 30);
+
+    cmp_swap(v, 2, 16);
+    cmp_swap(v, 3, 17);
+    cmp_swap(v, 6, 20);
+    cmp_swap(v, 7, 21);
+    cmp_swap(v, 10, 24);
+    cmp_swap(v, 11, 25);
+    cmp_swap(v, 14, 28);
+    cmp_swap(v, 15, 29);
+
+    cmp_swap(v, 2, 8);
+    cmp_swap(v, 3, 9);
+    cmp_swap(v, 6, 12);
+    cmp_swap(v, 7, 13);
+    cmp_swap(v, 10, 16);
+    cmp_swap(v, 11, 17);
+    cmp_swap(v, 14, 20);
+    cmp_swap(v, 15, 21);
+    cmp_swap(v, 18, 24);
+    cmp_swap(v, 19, 25);
+    cmp_swap(v, 22, 28);
+    cmp_swap(v, 23, 29);
+
+    cmp_swap(v, 2, 4);
+    cmp_swap(v, 3, 5);
+    cmp_swap(v, 6, 8);
+    cmp_swap(v, 7, 9);
+    cmp_swap(v, 10, 12);
+    cmp_swap(v, 11, 13);
+    cmp_swap(v, 14, 16);
+    cmp_swap(v, 15, 17);
+    cmp_swap(v, 18, 20);
+    cmp_swap(v, 19, 21);
+    cmp_swap(v, 22, 24);
+    cmp_swap(v, 23, 25);
+    cmp_swap(v, 26, 28);
+    cmp_swap(v, 27, 29);
+
+    cmp_swap(v, 0, 1);
+    cmp_swap(v, 2, 3);
+    cmp_swap(v, 4, 5);
+    cmp_swap(v, 6, 7);
+    cmp_swap(v, 8, 9);
+    cmp_swap(v, 10, 11);
+    cmp_swap(v, 12, 13);
+    cmp_swap(v, 14, 15);
+    cmp_swap(v, 16, 17);
+    cmp_swap(v, 18, 19);
+    cmp_swap(v, 20, 21);
+    cmp_swap(v, 22, 23);
+    cmp_swap(v, 24, 25);
+    cmp_swap(v, 26, 27);
+    cmp_swap(v, 28, 29);
+
+    cmp_swap(v, 1, 16);
+    cmp_swap(v, 3, 18);
+    cmp_swap(v, 5, 20);
+    cmp_swap(v, 7, 22);
+    cmp_swap(v, 9, 24);
+    cmp_swap(v, 11, 26);
+    cmp_swap(v, 13, 28);
+    cmp_swap(v, 15, 30);
+
+    cmp_swap(v, 1, 8);
+    cmp_swap(v, 3, 10);
+    cmp_swap(v, 5, 12);
+    cmp_swap(v, 7, 14);
+    cmp_swap(v, 9, 16);
+    cmp_swap(v, 11, 18);
+    cmp_swap(v, 13, 20);
+    cmp_swap(v, 15, 22);
+    cmp_swap(v, 17, 24);
+    cmp_swap(v, 19, 26);
+    cmp_swap(v, 21, 28);
+    cmp_swap(v, 23, 30);
+
+    cmp_swap(v, 1, 4);
+    cmp_swap(v, 3, 6);
+    cmp_swap(v, 5, 8);
+    cmp_swap(v, 7, 10);
+    cmp_swap(v, 9, 12);
+    cmp_swap(v, 11, 14);
+    cmp_swap(v, 13, 16);
+    cmp_swap(v, 15, 18);
+    cmp_swap(v, 17, 20);
+    cmp_swap(v, 19, 22);
+    cmp_swap(v, 21, 24);
+    cmp_swap(v, 23, 26);
+    cmp_swap(v, 25, 28);
+    cmp_swap(v, 27, 30);
+
+    cmp_swap(v, 1, 2);
+    cmp_swap(v, 3, 4);
+    cmp_swap(v, 5, 6);
+    cmp_swap(v, 7, 8);
+    cmp_swap(v, 9, 10);
+    cmp_swap(v, 11, 12);
+    cmp_swap(v, 13, 14);
+    cmp_swap(v, 15, 16);
+    cmp_swap(v, 17, 18);
+    cmp_swap(v, 19, 20);
+    cmp_swap(v, 21, 22);
+    cmp_swap(v, 23, 24);
+    cmp_swap(v, 25, 26);
+    cmp_swap(v, 27, 28);
+    cmp_swap(v, 29, 30);
+  }
+};
+
+template <>
+struct FixedNetwork<32> {
+  template <typename T>
+  static void sort(T* v) noexcept {
+    // 191 compare-exchanges, depth 15.
+    cmp_swap(v, 0, 16);
+    cmp_swap(v, 1, 17);
+    cmp_swap(v, 2, 18);
+    cmp_swap(v, 3, 19);
+    cmp_swap(v, 4, 20);
+    cmp_swap(v, 5, 21);
+    cmp_swap(v, 6, 22);
+    cmp_swap(v, 7, 23);
+    cmp_swap(v, 8, 24);
+    cmp_swap(v, 9, 25);
+    cmp_swap(v, 10, 26);
+    cmp_swap(v, 11, 27);
+    cmp_swap(v, 12, 28);
+    cmp_swap(v, 13, 29);
+    cmp_swap(v, 14, 30);
+    cmp_swap(v, 15, 31);
+
+    cmp_swap(v, 0, 8);
+    cmp_swap(v, 1, 9);
+    cmp_swap(v, 2, 10);
+    cmp_swap(v, 3, 11);
+    cmp_swap(v, 4, 12);
+    cmp_swap(v, 5, 13);
+    cmp_swap(v, 6, 14);
+    cmp_swap(v, 7, 15);
+    cmp_swap(v, 16, 24);
+    cmp_swap(v, 17, 25);
+    cmp_swap(v, 18, 26);
+    cmp_swap(v, 19, 27);
+    cmp_swap(v, 20, 28);
+    cmp_swap(v, 21, 29);
+    cmp_swap(v, 22, 30);
+    cmp_swap(v, 23, 31);
+
+    cmp_swap(v, 8, 16);
+    cmp_swap(v, 9, 17);
+    cmp_swap(v, 10, 18);
+    cmp_swap(v, 11, 19);
+    cmp_swap(v, 12, 20);
+    cmp_swap(v, 13, 21);
+    cmp_swap(v, 14, 22);
+    cmp_swap(v, 15, 23);
+
+    cmp_swap(v, 0, 4);
+    cmp_swap(v, 1, 5);
+    cmp_swap(v, 2, 6);
+    cmp_swap(v, 3, 7);
+    cmp_swap(v, 8, 12);
+    cmp_swap(v, 9, 13);
+    cmp_swap(v, 10, 14);
+    cmp_swap(v, 11, 15);
+    cmp_swap(v, 16, 20);
+    cmp_swap(v, 17, 21);
+    cmp_swap(v, 18, 22);
+    cmp_swap(v, 19, 23);
+    cmp_swap(v, 24, 28);
+    cmp_swap(v, 25, 29);
+    cmp_swap(v, 26, 30);
+    cmp_swap(v, 27, 31);
+
+    cmp_swap(v, 4, 16);
+    cmp_swap(v, 5, 17);
+    cmp_swap(v, 6, 18);
+    cmp_swap(v, 7, 19);
+    cmp_swap(v, 12, 24);
+    cmp_swap(v, 13, 25);
+    cmp_swap(v, 14, 26);
+    cmp_swap(v, 15, 27);
+
+    cmp_swap(v, 4, 8);
+    cmp_swap(v, 5, 9);
+    cmp_swap(v, 6, 10);
+    cmp_swap(v, 7, 11);
+    cmp_swap(v, 12, 16);
+    cmp_swap(v, 13, 17);
+    cmp_swap(v, 14, 18);
+    cmp_swap(v, 15, 19);
+    cmp_swap(v, 20, 24);
+    cmp_swap(v, 21, 25);
+    cmp_swap(v, 22, 26);
+    cmp_swap(v, 23, 27);
+
+    cmp_swap(v, 0, 2);
+    cmp_swap(v, 1, 3);
+    cmp_swap(v, 4, 6);
+    cmp_swap(v, 5, 7);
+    cmp_swap(v, 8, 10);
+    cmp_swap(v, 9, 11);
+    cmp_swap(v, 12, 14);
+    cmp_swap(v, 13, 15);
+    cmp_swap(v, 16, 18);
+    cmp_swap(v, 17, 19);
+    cmp_swap(v, 20, 22);
+    cmp_swap(v, 21, 23);
+    cmp_swap(v, 24, 26);
+    cmp_swap(v, 25, 27);
+    cmp_swap(v, 28, 30);
+    cmp_swap(v, 29, 31);
+
+    cmp_swap(v, 2, 16);
+    cmp_swap(v, 3, 17);
+    cmp_swap(v, 6, 20);
+    cmp_swap(v, 7, 21);
+    cmp_swap(v, 10, 24);
+    cmp_swap(v, 11, 25);
+    cmp_swap(v, 14, 28);
+    cmp_swap(v, 15, 29);
+
+    cmp_swap(v, 2, 8);
+    cmp_swap(v, 3, 9);
+    cmp_swap(v, 6, 12);
+    cmp_swap(v, 7, 13);
+    cmp_swap(v, 10, 16);
+    cmp_swap(v, 11, 17);
+    cmp_swap(v, 14, 20);
+    cmp_swap(v, 15, 21);
+    cmp_swap(v, 18, 24);
+    cmp_swap(v, 19, 25);
+    cmp_swap(v, 22, 28);
+    cmp_swap(v, 23, 29);
+
+    cmp_swap(v, 2, 4);
+    cmp_swap(v, 3, 5);
+    cmp_swap(v, 6, 8);
+    cmp_swap(v, 7, 9);
+    cmp_swap(v, 10, 12);
+    cmp_swap(v, 11, 13);
+    cmp_swap(v, 14, 16);
+    cmp_swap(v, 15, 17);
+    cmp_swap(v, 18, 20);
+    cmp_swap(v, 19, 21);
+    cmp_swap(v, 22, 24);
+    cmp_swap(v, 23, 25);
+    cmp_swap(v, 26, 28);
+    cmp_swap(v, 27, 29);
+
+    cmp_swap(v, 0, 1);
+    cmp_swap(v, 2, 3);
+    cmp_swap(v, 4, 5);
+    cmp_swap(v, 6, 7);
+    cmp_swap(v, 8, 9);
+    cmp_swap(v, 10, 11);
+    cmp_swap(v, 12, 13);
+    cmp_swap(v, 14, 15);
+    cmp_swap(v, 16, 17);
+    cmp_swap(v, 18, 19);
+    cmp_swap(v, 20, 21);
+    cmp_swap(v, 22, 23);
+    cmp_swap(v, 24, 25);
+    cmp_swap(v, 26, 27);
+    cmp_swap(v, 28, 29);
+    cmp_swap(v, 30, 31);
+
+    cmp_swap(v, 1, 16);
+    cmp_swap(v, 3, 18);
+    cmp_swap(v, 5, 20);
+    cmp_swap(v, 7, 22);
+    cmp_swap(v, 9, 24);
+    cmp_swap(v, 11, 26);
+    cmp_swap(v, 13, 28);
+    cmp_swap(v, 15, 30);
+
+    cmp_swap(v, 1, 8);
+    cmp_swap(v, 3, 10);
+    cmp_swap(v, 5, 12);
+    cmp_swap(v, 7, 14);
+    cmp_swap(v, 9, 16);
+    cmp_swap(v, 11, 18);
+    cmp_swap(v, 13, 20);
+    cmp_swap(v, 15, 22);
+    cmp_swap(v, 17, 24);
+    cmp_swap(v, 19, 26);
+    cmp_swap(v, 21, 28);
+    cmp_swap(v, 23, 30);
+
+    cmp_swap(v, 1, 4);
+    cmp_swap(v, 3, 6);
+    cmp_swap(v, 5, 8);
+    cmp_swap(v, 7, 10);
+    cmp_swap(v, 9, 12);
+    cmp_swap(v, 11, 14);
+    cmp_swap(v, 13, 16);
+    cmp_swap(v, 15, 18);
+    cmp_swap(v, 17, 20);
+    cmp_swap(v, 19, 22);
+    cmp_swap(v, 21, 24);
+    cmp_swap(v, 23, 26);
+    cmp_swap(v, 25, 28);
+    cmp_swap(v, 27, 30);
+
+    cmp_swap(v, 1, 2);
+    cmp_swap(v, 3, 4);
+    cmp_swap(v, 5, 6);
+    cmp_swap(v, 7, 8);
+    cmp_swap(v, 9, 10);
+    cmp_swap(v, 11, 12);
+    cmp_swap(v, 13, 14);
+    cmp_swap(v, 15, 16);
+    cmp_swap(v, 17, 18);
+    cmp_swap(v, 19, 20);
+    cmp_swap(v, 21, 22);
+    cmp_swap(v, 23, 24);
+    cmp_swap(v, 25, 26);
+    cmp_swap(v, 27, 28);
+    cmp_swap(v, 29, 30);
+  }
+};
+
+// Sorts v[0..N).
+template <size_t N, typename T>
+inline void sort(T* v) noexcept {
+  static_assert(N <= FIXED_NETWORK_MAX_LEN, "No sorting network for N");
+  FixedNetwork<N>::sort(v);
+}
+
+// Runtime dispatch to the network for len, returns false if len is larger than
+// FIXED_NETWORK_MAX_LEN.
+template <typename T>
+inline bool sort_dispatch(T* v, size_t len) noexcept {
+  switch (len) {
+    case 0:
+      sort<0>(v);
+      return true;
+    case 1:
+      sort<1>(v);
+      return true;
+    case 2:
+      sort<2>(v);
+      return true;
+    case 3:
+      sort<3>(v);
+      return true;
+    case 4:
+      sort<4>(v);
+      return true;
+    case 5:
+      sort<5>(v);
+      return true;
+    case 6:
+      sort<6>(v);
+      return true;
+    case 7:
+      sort<7>(v);
+      return true;
+    case 8:
+      sort<8>(v);
+      return true;
+    case 9:
+      sort<9>(v);
+      return true;
+    case 10:
+      sort<10>(v);
+      return true;
+    case 11:
+      sort<11>(v);
+      return true;
+    case 12:
+      sort<12>(v);
+      return true;
+    case 13:
+      sort<13>(v);
+      return true;
+    case 14:
+      sort<14>(v);
+      return true;
+    case 15:
+      sort<15>(v);
+      return true;
+    case 16:
+      sort<16>(v);
+      return true;
+    case 17:
+      sort<17>(v);
+      return true;
+    case 18:
+      sort<18>(v);
+      return true;
+    case 19:
+      sort<19>(v);
+      return true;
+    case 20:
+      sort<20>(v);
+      return true;
+    case 21:
+      sort<21>(v);
+      return true;
+    case 22:
+      sort<22>(v);
+      return true;
+    case 23:
+      sort<23>(v);
+      return true;
+    case 24:
+      sort<24>(v);
+      return true;
+    case 25:
+      sort<25>(v);
+      return true;
+    case 26:
+      sort<26>(v);
+      return true;
+    case 27:
+      sort<27>(v);
+      return true;
+    case 28:
+      sort<28>(v);
+      return true;
+    case 29:
+      sort<29>(v);
+      return true;
+    case 30:
+      sort<30>(v);
+      return true;
+    case 31:
+      sort<31>(v);
+      return true;
+    case 32:
+      sort<32>(v);
+      return true;
+    default:
+      return false;
+  }
+}
+
+}  // namespace fixed_network_sort
+
+// Calls X(N) for every N that has a network, for defining per length entry
+// points.
+#define FIXED_NETWORK_SORT_FOR_EACH_LEN(X) \
+  X(2) X(3) X(4) X(5) X(6) X(7) X(8) X(9) \
+  X(10) X(11) X(12) X(13) X(14) X(15) X(16) X(17) \
+  X(18) X(19) X(20) X(21) X(22) X(23) X(24) X(25) \
+  X(26) X(27) X(28) X(29) X(30) X(31) X(32)
@@ -1,9 +1,16 @@
 #include <stdexcept>
+#include <type_traits>
+#include <vector>
 
 #include <stdint.h>
+#include <string.h>
 
 #include "shared.h"
 
+extern "C" {
+#include <golang_std_ffi_lib.h>
+}
+
 template <typename T>
 using cmp_fn_ptr_t = int64_t (*)(T, T);
 
@@ -33,6 +40,70 @@ cmp_fn_ptr_t<T> make_compare_fn_go(CompResult (*cmp_fn)(const T&,
   };
 }
 
+template <typename T>
+int64_t by_ctx_bridge(uintptr_t cmp_fn, uintptr_t ctx, T a, T b) {
+  const auto comp_result =
+      reinterpret_cast<CompResult (*)(const T&, const T&, uint8_t*)>(cmp_fn)(
+          a, b, reinterpret_cast<uint8_t*>(ctx));
+
+  if (comp_result.is_panic) {
+    return PANIC_MAGIC_NUMBER;
+  }
+
+  return comp_result.cmp_result;
+}
+
+template <typename T>
+GoSlice as_go_slice(T* data, size_t len) {
+  return GoSlice{/*data:*/ reinterpret_cast<void*>(data),
+                 /*len:*/ static_cast<GoInt>(len),
+                 /*cap:*/ static_cast<GoInt>(len)};
+}
+
+// Maps the key to an unsigned integer with the same order, so that the go side
+// only needs a single key type.
+template <typename T, typename K, bool IS_DESCENDING>
+uint64_t go_sort_key(const KeyCompare<T, K, IS_DESCENDING>& comp,
+                     const T& val) {
+  uint64_t key = 0;
+  if constexpr (std::is_signed_v<K>) {
+    key = static_cast<uint64_t>(static_cast<int64_t>(comp.key(val))) ^
+          (uint64_t{1} << 63);
+  } else {
+    key = static_cast<uint64_t>(comp.key(val));
+  }
+
+  return IS_DESCENDING ? ~key : key;
+}
+
+// Extracts every key once, sorts the keys in go with a native comparison and
+// then moves the elements into key order. Compared to the _by variants that is
+// a single cgo call instead of one per comparison.
+template <typename T>
+uint32_t sort_by_key_go(T* data,
+                        size_t len,
+                        KeyDescriptor key,
+                        void (*sort_keyed)(GoSlice)) {
+  static_assert(std::is_trivially_copyable_v<T>);
+
+  const bool is_valid_key = with_key_compare<T>(key, [&](auto comp) {
+    std::vector<GoKeyIdx> keys(len);
+    for (size_t i = 0; i < len; ++i) {
+      keys[i] = GoKeyIdx{go_sort_key(comp, data[i]), i};
+    }
+
+    sort_keyed(as_go_slice(keys.data(), len));
+
+    std::vector<T> sorted(len);
+    for (size_t i = 0; i < len; ++i) {
+      memcpy(&sorted[i], &data[keys[i].idx], sizeof(T));
+    }
+    memcpy(data, sorted.data(), len * sizeof(T));
+  });
+
+  return is_valid_key ? 0 : 1;
+}
+
 #define NOT_IMPL(STABILITY, TYPE_NAME, TYPE)                          \
   void golang_std_##STABILITY##_##TYPE_NAME(TYPE* data, size_t len) { \
     printf("Not supported\n");                                        \
@@ -48,20 +119,17 @@ cmp_fn_ptr_t<T> make_compare_fn_go(CompResult (*cmp_fn)(const T&,
 
 #define IMPL(STABILITY, TYPE_NAME, TYPE, SORT_NAME_BASE)                    \
   void golang_std_##STABILITY##_##TYPE_NAME(TYPE* data, size_t len) {       \
-    SORT_NAME_BASE(GoSlice{/*data:*/ reinterpret_cast<void*>(data),         \
-                           /*len:*/ static_cast<GoInt>(len),                \
-                           /*cap:*/ static_cast<GoInt>(len)});              \
+    SORT_USDT_PROBE(len);                                                   \
+    SORT_NAME_BASE(as_go_slice(data, len));                                 \
   }                                                                         \
                                                                             \
   uint32_t golang_std_##STABILITY##_##TYPE_NAME##_by(                       \
       TYPE* data, size_t len,                                               \
       CompResult (*cmp_fn)(const TYPE&, const TYPE&, uint8_t*),             \
       uint8_t* ctx) {                                                       \
-    const auto did_panic =                                                  \
-        SORT_NAME_BASE##By(GoSlice{/*data:*/ reinterpret_cast<void*>(data), \
-                                   /*len:*/ static_cast<GoInt>(len),        \
-                                   /*cap:*/ static_cast<GoInt>(len)},       \
-                           make_compare_fn_go(cmp_fn, ctx));                \
+    SORT_USDT_PROBE(len);                                                   \
+    const auto did_panic = SORT_NAME_BASE##By(                              \
+        as_go_slice(data, len), make_compare_fn_go(cmp_fn, ctx));           \
                                                                             \
     if (did_panic) {                                                        \
       return 1;                                                             \
@@ -70,9 +138,87 @@ cmp_fn_ptr_t<T> make_compare_fn_go(CompResult (*cmp_fn)(const T&,
     return 0;                                                               \
   }
 
-extern "C" {
-#include <golang_std_ffi_lib.h>
+// Types that go compares natively, but that have no cgo bridge for a user
+// provided comparison function.
+#define NATIVE_IMPL(STABILITY, TYPE_NAME, TYPE, SORT_NAME_BASE)         \
+  void golang_std_##STABILITY##_##TYPE_NAME(TYPE* data, size_t len) { \
+    SORT_USDT_PROBE(len);                                             \
+    SORT_NAME_BASE(as_go_slice(data, len));                           \
+  }                                                                   \
+                                                                      \
+  uint32_t golang_std_##STABILITY##_##TYPE_NAME##_by(                 \
+      TYPE* data, size_t len,                                         \
+      CompResult (*cmp_fn)(const TYPE&, const TYPE&, uint8_t*),       \
+      uint8_t* ctx) {                                                 \
+    printf("Not supported\n");                                        \
+    return 1;                                                         \
+  }
+
+#define BY_KEY_IMPL(STABILITY, TYPE_NAME, TYPE, KEYED_SORT_NAME) \
+  uint32_t golang_std_##STABILITY##_##TYPE_NAME##_by_key(          \
+      TYPE* data, size_t len, KeyDescriptor key) {                 \
+    SORT_USDT_PROBE(len);                                          \
+    return sort_by_key_go(data, len, key, KEYED_SORT_NAME);        \
+  }
+
+// The parallel sample sort calls the comparison function from goroutines that
+// run on other threads than the caller, so instead of make_compare_fn_go the
+// function and its context are passed along with every call.
+#define PARALLEL_IMPL(STABILITY, TYPE_NAME, TYPE, SORT_NAME_BASE)          \
+  void golang_std_parallel_##STABILITY##_##TYPE_NAME(                      \
+      TYPE* data, size_t len, size_t num_threads) {                        \
+    SORT_USDT_PROBE(len);                                                  \
+    SORT_NAME_BASE(as_go_slice(data, len),                                 \
+                   static_cast<GoInt>(num_threads));                       \
+  }                                                                        \
+                                                                           \
+  uint32_t golang_std_parallel_##STABILITY##_##TYPE_NAME##_by(             \
+      TYPE* data, size_t len,                                              \
+      CompResult (*cmp_fn)(const TYPE&, const TYPE&, uint8_t*),            \
+      uint8_t* ctx, size_t num_threads) {                                  \
+    SORT_USDT_PROBE(len);                                                  \
+    const auto did_panic = SORT_NAME_BASE##By(                             \
+        as_go_slice(data, len), reinterpret_cast<uintptr_t>(cmp_fn),       \
+        reinterpret_cast<uintptr_t>(ctx), static_cast<GoInt>(num_threads)); \
+                                                                           \
+    if (did_panic) {                                                       \
+      return 1;                                                            \
+    }                                                                      \
+                                                                           \
+    return 0;                                                              \
+  }
 
+#define PARALLEL_NATIVE_IMPL(STABILITY, TYPE_NAME, TYPE, SORT_NAME_BASE)   \
+  void golang_std_parallel_##STABILITY##_##TYPE_NAME(                      \
+      TYPE* data, size_t len, size_t num_threads) {                        \
+    SORT_USDT_PROBE(len);                                                  \
+    SORT_NAME_BASE(as_go_slice(data, len),                                 \
+                   static_cast<GoInt>(num_threads));                       \
+  }                                                                        \
+                                                                           \
+  uint32_t golang_std_parallel_##STABILITY##_##TYPE_NAME##_by(             \
+      TYPE* data, size_t len,                                              \
+      CompResult (*cmp_fn)(const TYPE&, const TYPE&, uint8_t*),            \
+      uint8_t* ctx, size_t num_threads) {                                  \
+    printf("Not supported\n");                                             \
+    return 1;                                                              \
+  }
+
+#define PARALLEL_NOT_IMPL(STABILITY, TYPE_NAME, TYPE)                \
+  void golang_std_parallel_##STABILITY##_##TYPE_NAME(                \
+      TYPE* data, size_t len, size_t num_threads) {                  \
+    printf("Not supported\n");                                       \
+  }                                                                  \
+                                                                     \
+  uint32_t golang_std_parallel_##STABILITY##_##TYPE_NAME##_by(       \
+      TYPE* data, size_t len,                                        \
+      CompResult (*cmp_fn)(const TYPE&, const TYPE&, uint8_t*),      \
+      uint8_t* ctx, size_t num_threads) {                            \
+    printf("Not supported\n");                                       \
+    return 1;                                                        \
+  }
+
+extern "C" {
 int64_t i32_by_bridge(cmp_fn_ptr_t<int32_t> fn_ptr, int32_t a, int32_t b) {
   return fn_ptr(a, b);
 }
@@ -81,16 +227,56 @@ int64_t u64_by_bridge(cmp_fn_ptr_t<uint64_t> fn_ptr, uint64_t a, uint64_t b) {
   return fn_ptr(a, b);
 }
 
+int64_t i32_by_ctx_bridge(uintptr_t cmp_fn,
+                          uintptr_t ctx,
+                          int32_t a,
+                          int32_t b) {
+  return by_ctx_bridge(cmp_fn, ctx, a, b);
+}
+
+int64_t u64_by_ctx_bridge(uintptr_t cmp_fn,
+                          uintptr_t ctx,
+                          uint64_t a,
+                          uint64_t b) {
+  return by_ctx_bridge(cmp_fn, ctx, a, b);
+}
+
 IMPL(unstable, i32, int32_t, UnstableSortI32);
 IMPL(unstable, u64, uint64_t, UnstableSortU64);
-NOT_IMPL(unstable, ffi_string, FFIString);
-NOT_IMPL(unstable, f128, F128);
+NATIVE_IMPL(unstable, ffi_string, FFIString, UnstableSortFFIString);
+NATIVE_IMPL(unstable, f128, F128, UnstableSortF128);
 NOT_IMPL(unstable, 1k, FFIOneKibiByte);
 
+BY_KEY_IMPL(unstable, i32, int32_t, UnstableSortKeyed);
+BY_KEY_IMPL(unstable, u64, uint64_t, UnstableSortKeyed);
+BY_KEY_IMPL(unstable, 1k, FFIOneKibiByte, UnstableSortKeyed);
+
 IMPL(stable, i32, int32_t, StableSortI32);
 IMPL(stable, u64, uint64_t, StableSortU64);
-NOT_IMPL(stable, ffi_string, FFIString);
-NOT_IMPL(stable, f128, F128);
+NATIVE_IMPL(stable, ffi_string, FFIString, StableSortFFIString);
+NATIVE_IMPL(stable, f128, F128, StableSortF128);
 NOT_IMPL(stable, 1k, FFIOneKibiByte);
 
+BY_KEY_IMPL(stable, i32, int32_t, StableSortKeyed);
+BY_KEY_IMPL(stable, u64, uint64_t, StableSortKeyed);
+BY_KEY_IMPL(stable, 1k, FFIOneKibiByte, StableSortKeyed);
+
+PARALLEL_IMPL(unstable, i32, int32_t, ParallelUnstableSortI32);
+PARALLEL_IMPL(unstable, u64, uint64_t, ParallelUnstableSortU64);
+PARALLEL_NATIVE_IMPL(unstable,
+                     ffi_string,
+                     FFIString,
+                     ParallelUnstableSortFFIString);
+PARALLEL_NATIVE_IMPL(unstable, f128, F128, ParallelUnstableSortF128);
+PARALLEL_NOT_IMPL(unstable, 1k, FFIOneKibiByte);
+
+PARALLEL_IMPL(stable, i32, int32_t, ParallelStableSortI32);
+PARALLEL_IMPL(stable, u64, uint64_t, ParallelStableSortU64);
+PARALLEL_NATIVE_IMPL(stable,
+                     ffi_string,
+                     FFIString,
+                     ParallelStableSortFFIString);
+PARALLEL_NATIVE_IMPL(stable, f128, F128, ParallelStableSortF128);
+PARALLEL_NOT_IMPL(stable, 1k, FFIOneKibiByte);
+
 }  // extern "C"
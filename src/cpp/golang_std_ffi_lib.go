@@ -8,16 +8,65 @@ int64_t i32_by_bridge(i32_by_cmp_fn_ptr_t fn_ptr, int32_t a, int32_t b);
 
 typedef int64_t (*u64_by_cmp_fn_ptr_t) (uint64_t, uint64_t);
 int64_t u64_by_bridge(u64_by_cmp_fn_ptr_t fn_ptr, uint64_t a, uint64_t b);
+
+// Same as the bridges above, but with the comparison function and its context
+// passed along on each call, which lets goroutines on other threads call it.
+// Both are passed as integers, so that Go doesn't check them as pointers on
+// every call.
+int64_t i32_by_ctx_bridge(uintptr_t cmp_fn, uintptr_t ctx, int32_t a, int32_t b);
+int64_t u64_by_ctx_bridge(uintptr_t cmp_fn, uintptr_t ctx, uint64_t a, uint64_t b);
+
+// Same layout as FFIString, F128 in shared.h. Named differently because the
+// generated header is included next to shared.h.
+typedef struct {
+	char* data;
+	size_t len;
+	size_t capacity;
+} GoFFIString;
+
+typedef struct {
+	double x;
+	double y;
+} GoF128;
+
+// Order preserving key and the position of its element before the sort.
+typedef struct {
+	uint64_t key;
+	uint64_t idx;
+} GoKeyIdx;
 */
 import "C"
 
 import (
+	"bytes"
 	"cmp"
 	"slices"
+	"sync"
+	"sync/atomic"
+	"unsafe"
 )
 
 const PANIC_MAGIC_NUMBER = 777;
 
+// The comparison functions below are plain Go and only read the memory owned
+// by Rust, so unlike the By variants none of them cross the cgo boundary.
+
+func ffiStringBytes(s *C.GoFFIString) []byte {
+	return unsafe.Slice((*byte)(unsafe.Pointer(s.data)), int(s.len))
+}
+
+func compareFFIString(a, b C.GoFFIString) int {
+	return bytes.Compare(ffiStringBytes(&a), ffiStringBytes(&b))
+}
+
+func compareF128(a, b C.GoF128) int {
+	return cmp.Compare(float64(a.x)/float64(a.y), float64(b.x)/float64(b.y))
+}
+
+func compareKeyIdx(a, b C.GoKeyIdx) int {
+	return cmp.Compare(a.key, b.key)
+}
+
 //export StableSortI32
 func StableSortI32(v []int32) {
 	slices.SortStableFunc(v, func(a, b int32) int {
@@ -80,6 +129,21 @@ func StableSortU64By(v []uint64, cmp C.u64_by_cmp_fn_ptr_t) bool {
 	return did_panic
 }
 
+//export StableSortFFIString
+func StableSortFFIString(v []C.GoFFIString) {
+	slices.SortStableFunc(v, compareFFIString)
+}
+
+//export StableSortF128
+func StableSortF128(v []C.GoF128) {
+	slices.SortStableFunc(v, compareF128)
+}
+
+//export StableSortKeyed
+func StableSortKeyed(v []C.GoKeyIdx) {
+	slices.SortStableFunc(v, compareKeyIdx)
+}
+
 //export UnstableSortI32
 func UnstableSortI32(v []int32) {
 	slices.Sort(v)
@@ -138,6 +202,282 @@ func UnstableSortU64By(v []uint64, cmp C.u64_by_cmp_fn_ptr_t) bool {
 	return did_panic
 }
 
+//export UnstableSortFFIString
+func UnstableSortFFIString(v []C.GoFFIString) {
+	slices.SortFunc(v, compareFFIString)
+}
 
+//export UnstableSortF128
+func UnstableSortF128(v []C.GoF128) {
+	slices.SortFunc(v, compareF128)
+}
+
+//export UnstableSortKeyed
+func UnstableSortKeyed(v []C.GoKeyIdx) {
+	slices.SortFunc(v, compareKeyIdx)
+}
+
+// --- parallel ---
+
+// Below this len the parallel sort sorts sequentially, starting the goroutines
+// costs more than they save.
+const PARALLEL_MIN_LEN = 1 << 14
+
+// Sample elements per splitter. More than one bucket per goroutine evens out
+// the bucket sizes, the bucket ids have to fit into an uint8.
+const SAMPLE_OVERSAMPLING = 16
+const BUCKETS_PER_GOROUTINE = 4
+const MAX_SPLITTERS = 127
+
+func runGoroutines(numGoroutines int, fn func(goroutineIdx int)) {
+	var wg sync.WaitGroup
+	wg.Add(numGoroutines)
+	for i := 0; i < numGoroutines; i++ {
+		go func(goroutineIdx int) {
+			defer wg.Done()
+			fn(goroutineIdx)
+		}(i)
+	}
+	wg.Wait()
+}
+
+// A panic can't be recovered from another goroutine, so every goroutine
+// recovers its own and reports it through didPanic.
+func recoverPanic(didPanic *atomic.Bool, fn func()) {
+	defer func() {
+		if r := recover(); r != nil {
+			didPanic.Store(true)
+		}
+	}()
+
+	fn()
+}
+
+// Even numbered buckets hold the elements between two splitters, odd numbered
+// ones the elements equal to a splitter. With many duplicates that keeps all
+// copies of a value out of the buckets that still need sorting.
+func classify[T any](val T, splitters []T, cmp func(a, b T) int) int {
+	lo, hi := 0, len(splitters)
+	for lo < hi {
+		mid := int(uint(lo+hi) >> 1)
+		if cmp(val, splitters[mid]) > 0 {
+			lo = mid + 1
+		} else {
+			hi = mid
+		}
+	}
+
+	if lo < len(splitters) && cmp(val, splitters[lo]) == 0 {
+		return 2*lo + 1
+	}
+
+	return 2 * lo
+}
+
+// Sample sort over numGoroutines goroutines. The goroutines classify one chunk
+// each, scatter their chunk into a buffer, sort the buckets in the buffer with
+// sortSequential and copy it back. Every chunk keeps its order inside a bucket,
+// so with a stable sortSequential the result is stable as well.
+//
+// Returns true if cmp panicked. v is left untouched if that happens during
+// classification, and is a permutation of the input otherwise.
+func parallelSampleSort[T any](v []T, cmp func(a, b T) int, sortSequential func(s []T), numGoroutines int) bool {
+	var didPanic atomic.Bool
+
+	n := len(v)
+	if numGoroutines <= 1 || n < PARALLEL_MIN_LEN {
+		recoverPanic(&didPanic, func() { sortSequential(v) })
+		return didPanic.Load()
+	}
+
+	numSplitters := min(numGoroutines*BUCKETS_PER_GOROUTINE, MAX_SPLITTERS)
+	sample := make([]T, numSplitters*SAMPLE_OVERSAMPLING)
+	var rngState uint64 = 0x9e3779b97f4a7c15
+	for i := range sample {
+		rngState ^= rngState << 13
+		rngState ^= rngState >> 7
+		rngState ^= rngState << 17
+		sample[i] = v[rngState%uint64(n)]
+	}
+
+	recoverPanic(&didPanic, func() { slices.SortFunc(sample, cmp) })
+	if didPanic.Load() {
+		return true
+	}
+
+	splitters := make([]T, 0, numSplitters)
+	for i := 1; i <= numSplitters; i++ {
+		splitter := sample[i*SAMPLE_OVERSAMPLING-1]
+		// Duplicate splitters would only produce empty buckets.
+		if len(splitters) == 0 || cmp(splitters[len(splitters)-1], splitter) != 0 {
+			splitters = append(splitters, splitter)
+		}
+	}
+
+	numBuckets := 2*len(splitters) + 1
+	chunkLen := (n + numGoroutines - 1) / numGoroutines
+	chunkBounds := func(goroutineIdx int) (int, int) {
+		return min(goroutineIdx*chunkLen, n), min((goroutineIdx+1)*chunkLen, n)
+	}
+
+	bucketIds := make([]uint8, n)
+	counts := make([]int, numGoroutines*numBuckets)
+	runGoroutines(numGoroutines, func(goroutineIdx int) {
+		recoverPanic(&didPanic, func() {
+			lo, hi := chunkBounds(goroutineIdx)
+			chunkCounts := counts[goroutineIdx*numBuckets : (goroutineIdx+1)*numBuckets]
+			for i := lo; i < hi; i++ {
+				bucketIdx := classify(v[i], splitters, cmp)
+				bucketIds[i] = uint8(bucketIdx)
+				chunkCounts[bucketIdx]++
+			}
+		})
+	})
+
+	if didPanic.Load() {
+		return true
+	}
+
+	// Each chunk gets its own range in every bucket, in chunk order.
+	bucketStarts := make([]int, numBuckets+1)
+	offsets := make([]int, numGoroutines*numBuckets)
+	pos := 0
+	for bucketIdx := 0; bucketIdx < numBuckets; bucketIdx++ {
+		bucketStarts[bucketIdx] = pos
+		for goroutineIdx := 0; goroutineIdx < numGoroutines; goroutineIdx++ {
+			offsets[goroutineIdx*numBuckets+bucketIdx] = pos
+			pos += counts[goroutineIdx*numBuckets+bucketIdx]
+		}
+	}
+	bucketStarts[numBuckets] = n
+
+	buf := make([]T, n)
+	runGoroutines(numGoroutines, func(goroutineIdx int) {
+		lo, hi := chunkBounds(goroutineIdx)
+		chunkOffsets := offsets[goroutineIdx*numBuckets : (goroutineIdx+1)*numBuckets]
+		for i := lo; i < hi; i++ {
+			bucketIdx := bucketIds[i]
+			buf[chunkOffsets[bucketIdx]] = v[i]
+			chunkOffsets[bucketIdx]++
+		}
+	})
+
+	var nextBucketIdx atomic.Int64
+	runGoroutines(numGoroutines, func(int) {
+		for {
+			bucketIdx := int(nextBucketIdx.Add(1) - 1)
+			if bucketIdx >= numBuckets {
+				break
+			}
+
+			if bucketIdx%2 == 0 {
+				bucket := buf[bucketStarts[bucketIdx]:bucketStarts[bucketIdx+1]]
+				recoverPanic(&didPanic, func() { sortSequential(bucket) })
+			}
+		}
+	})
+
+	// Copied back even after a panic, buf always holds all elements.
+	runGoroutines(numGoroutines, func(goroutineIdx int) {
+		lo, hi := chunkBounds(goroutineIdx)
+		copy(v[lo:hi], buf[lo:hi])
+	})
+
+	return didPanic.Load()
+}
+
+func sortFuncOf[T any](cmp func(a, b T) int) func(s []T) {
+	return func(s []T) { slices.SortFunc(s, cmp) }
+}
+
+func sortStableFuncOf[T any](cmp func(a, b T) int) func(s []T) {
+	return func(s []T) { slices.SortStableFunc(s, cmp) }
+}
+
+func i32ByCtx(cmp_fn, ctx C.uintptr_t) func(a, b int32) int {
+	return func(a, b int32) int {
+		var cmp_result = int(C.i32_by_ctx_bridge(cmp_fn, ctx, C.int32_t(a), C.int32_t(b)))
+		if cmp_result == PANIC_MAGIC_NUMBER {
+			panic("")
+		}
+
+		return cmp_result
+	}
+}
+
+func u64ByCtx(cmp_fn, ctx C.uintptr_t) func(a, b uint64) int {
+	return func(a, b uint64) int {
+		var cmp_result = int(C.u64_by_ctx_bridge(cmp_fn, ctx, C.uint64_t(a), C.uint64_t(b)))
+		if cmp_result == PANIC_MAGIC_NUMBER {
+			panic("")
+		}
+
+		return cmp_result
+	}
+}
+
+//export ParallelStableSortI32
+func ParallelStableSortI32(v []int32, numGoroutines int) {
+	parallelSampleSort(v, cmp.Compare[int32], sortStableFuncOf(cmp.Compare[int32]), numGoroutines)
+}
+
+//export ParallelStableSortI32By
+func ParallelStableSortI32By(v []int32, cmp_fn, ctx C.uintptr_t, numGoroutines int) bool {
+	compare := i32ByCtx(cmp_fn, ctx)
+	return parallelSampleSort(v, compare, sortStableFuncOf(compare), numGoroutines)
+}
+
+//export ParallelStableSortU64
+func ParallelStableSortU64(v []uint64, numGoroutines int) {
+	parallelSampleSort(v, cmp.Compare[uint64], sortStableFuncOf(cmp.Compare[uint64]), numGoroutines)
+}
+
+//export ParallelStableSortU64By
+func ParallelStableSortU64By(v []uint64, cmp_fn, ctx C.uintptr_t, numGoroutines int) bool {
+	compare := u64ByCtx(cmp_fn, ctx)
+	return parallelSampleSort(v, compare, sortStableFuncOf(compare), numGoroutines)
+}
+
+//export ParallelStableSortFFIString
+func ParallelStableSortFFIString(v []C.GoFFIString, numGoroutines int) {
+	parallelSampleSort(v, compareFFIString, sortStableFuncOf(compareFFIString), numGoroutines)
+}
+
+//export ParallelStableSortF128
+func ParallelStableSortF128(v []C.GoF128, numGoroutines int) {
+	parallelSampleSort(v, compareF128, sortStableFuncOf(compareF128), numGoroutines)
+}
+
+//export ParallelUnstableSortI32
+func ParallelUnstableSortI32(v []int32, numGoroutines int) {
+	parallelSampleSort(v, cmp.Compare[int32], slices.Sort[[]int32], numGoroutines)
+}
+
+//export ParallelUnstableSortI32By
+func ParallelUnstableSortI32By(v []int32, cmp_fn, ctx C.uintptr_t, numGoroutines int) bool {
+	compare := i32ByCtx(cmp_fn, ctx)
+	return parallelSampleSort(v, compare, sortFuncOf(compare), numGoroutines)
+}
+
+//export ParallelUnstableSortU64
+func ParallelUnstableSortU64(v []uint64, numGoroutines int) {
+	parallelSampleSort(v, cmp.Compare[uint64], slices.Sort[[]uint64], numGoroutines)
+}
+
+//export ParallelUnstableSortU64By
+func ParallelUnstableSortU64By(v []uint64, cmp_fn, ctx C.uintptr_t, numGoroutines int) bool {
+	compare := u64ByCtx(cmp_fn, ctx)
+	return parallelSampleSort(v, compare, sortFuncOf(compare), numGoroutines)
+}
+
+//export ParallelUnstableSortFFIString
+func ParallelUnstableSortFFIString(v []C.GoFFIString, numGoroutines int) {
+	parallelSampleSort(v, compareFFIString, sortFuncOf(compareFFIString), numGoroutines)
+}
+
+//export ParallelUnstableSortF128
+func ParallelUnstableSortF128(v []C.GoF128, numGoroutines int) {
+	parallelSampleSort(v, compareF128, sortFuncOf(compareF128), numGoroutines)
+}
 
 func main() {}
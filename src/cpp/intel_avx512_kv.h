@@ -0,0 +1,362 @@
+#pragma once
+
+// Key-value quicksort for 64-bit keys with a 64-bit payload, stored as two
+// separate arrays. Built on the vector types, pivot selection and sorting
+// network layout of the vendored x86-simd-sort 64-bit kernel. Every
+// permutation and compress store applied to the keys is applied to the values
+// with the same index vector or mask. Not stable.
+//
+// Must be included after avx512-64bit-qsort.hpp, inside the same AVX-512
+// target region.
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace avx512_kv {
+
+using vtype_val = zmm_vector<uint64_t>;
+using zmm_val_t = vtype_val::zmm_t;
+
+// Compare-exchange of in1 with in2, with the min in the lanes that are 0 in
+// mask. The lanes that kept their own key keep their own value, so equal keys
+// never duplicate or lose a value.
+template <typename vtype, typename zmm_t = typename vtype::zmm_t>
+X86_SIMD_SORT_INLINE zmm_t cmp_merge(zmm_t in1,
+                                     zmm_t in2,
+                                     zmm_val_t& val1,
+                                     zmm_val_t val2,
+                                     typename vtype::opmask_t mask) {
+  zmm_t keys = ::cmp_merge<vtype>(in1, in2, mask);
+  val1 = vtype_val::mask_mov(val2, _mm512_cmpeq_epi64_mask(keys, in1), val1);
+  return keys;
+}
+
+template <typename vtype, typename zmm_t = typename vtype::zmm_t>
+X86_SIMD_SORT_INLINE void coex(zmm_t& key1,
+                               zmm_t& key2,
+                               zmm_val_t& val1,
+                               zmm_val_t& val2) {
+  const zmm_t key_min = vtype::min(key1, key2);
+  const zmm_t key_max = vtype::max(key1, key2);
+  const __mmask8 kept = _mm512_cmpeq_epi64_mask(key_min, key1);
+  const zmm_val_t val_min = vtype_val::mask_mov(val2, kept, val1);
+  const zmm_val_t val_max = vtype_val::mask_mov(val1, kept, val2);
+  key1 = key_min;
+  key2 = key_max;
+  val1 = val_min;
+  val2 = val_max;
+}
+
+// Applies the same lane permutation to key and value.
+template <typename vtype, typename zmm_t = typename vtype::zmm_t>
+X86_SIMD_SORT_INLINE zmm_t merge_permuted(zmm_t key,
+                                          zmm_val_t& val,
+                                          __m512i index,
+                                          __mmask8 mask) {
+  return cmp_merge<vtype>(key, vtype::permutexvar(index, key), val,
+                          vtype_val::permutexvar(index, val), mask);
+}
+
+template <typename vtype, typename zmm_t = typename vtype::zmm_t>
+X86_SIMD_SORT_INLINE zmm_t merge_swapped(zmm_t key, zmm_val_t& val) {
+  return cmp_merge<vtype>(
+      key, vtype::template shuffle<SHUFFLE_MASK(1, 1, 1, 1)>(key), val,
+      vtype_val::template shuffle<SHUFFLE_MASK(1, 1, 1, 1)>(val), 0xAA);
+}
+
+// Same network as sort_zmm_64bit.
+template <typename vtype, typename zmm_t = typename vtype::zmm_t>
+X86_SIMD_SORT_INLINE zmm_t sort_zmm(zmm_t key, zmm_val_t& val) {
+  key = merge_swapped<vtype>(key, val);
+  key = merge_permuted<vtype>(key, val, _mm512_set_epi64(NETWORK_64BIT_1),
+                              0xCC);
+  key = merge_swapped<vtype>(key, val);
+  key = merge_permuted<vtype>(key, val, _mm512_set_epi64(NETWORK_64BIT_2),
+                              0xF0);
+  key = merge_permuted<vtype>(key, val, _mm512_set_epi64(NETWORK_64BIT_3),
+                              0xCC);
+  key = merge_swapped<vtype>(key, val);
+  return key;
+}
+
+// Same network as bitonic_merge_zmm_64bit.
+template <typename vtype, typename zmm_t = typename vtype::zmm_t>
+X86_SIMD_SORT_INLINE zmm_t bitonic_merge_zmm(zmm_t key, zmm_val_t& val) {
+  key = merge_permuted<vtype>(key, val, _mm512_set_epi64(NETWORK_64BIT_4),
+                              0xF0);
+  key = merge_permuted<vtype>(key, val, _mm512_set_epi64(NETWORK_64BIT_3),
+                              0xCC);
+  key = merge_swapped<vtype>(key, val);
+  return key;
+}
+
+// Merges two sorted runs of num_regs / 2 registers each, the generalization of
+// bitonic_merge_{two,four,eight}_zmm_64bit.
+template <typename vtype, int num_regs, typename zmm_t = typename vtype::zmm_t>
+X86_SIMD_SORT_INLINE void bitonic_merge_regs(zmm_t* key, zmm_val_t* val) {
+  const __m512i rev_index = _mm512_set_epi64(NETWORK_64BIT_2);
+  for (int i = 0; i < num_regs / 2; ++i) {
+    const int j = num_regs - 1 - i;
+    zmm_t key_rev = vtype::permutexvar(rev_index, key[j]);
+    zmm_val_t val_rev = vtype_val::permutexvar(rev_index, val[j]);
+    coex<vtype>(key[i], key_rev, val[i], val_rev);
+    key[j] = vtype::permutexvar(rev_index, key_rev);
+    val[j] = vtype_val::permutexvar(rev_index, val_rev);
+  }
+  for (int stride = num_regs / 4; stride > 0; stride /= 2) {
+    for (int i = 0; i < num_regs; ++i) {
+      if ((i & stride) == 0) {
+        coex<vtype>(key[i], key[i + stride], val[i], val[i + stride]);
+      }
+    }
+  }
+  for (int i = 0; i < num_regs; ++i) {
+    key[i] = bitonic_merge_zmm<vtype>(key[i], val[i]);
+  }
+}
+
+// Sorts up to num_regs * 8 elements. The tail is padded with the maximum key,
+// which must not occur in the input. Otherwise padding and real elements would
+// be indistinguishable and a padding value could be stored.
+template <typename vtype, int num_regs, typename type_t>
+X86_SIMD_SORT_INLINE void sort_regs(type_t* keys, uint64_t* vals, int32_t n) {
+  using zmm_t = typename vtype::zmm_t;
+  zmm_t key[num_regs];
+  zmm_val_t val[num_regs];
+  __mmask8 masks[num_regs];
+  for (int i = 0; i < num_regs; ++i) {
+    const int32_t remaining = n - i * 8;
+    masks[i] = remaining >= 8  ? 0xFF
+               : remaining > 0 ? static_cast<__mmask8>((1 << remaining) - 1)
+                               : 0;
+    key[i] = vtype::mask_loadu(vtype::zmm_max(), masks[i], keys + i * 8);
+    val[i] = vtype_val::mask_loadu(vtype_val::zmm_max(), masks[i],
+                                   vals + i * 8);
+    key[i] = sort_zmm<vtype>(key[i], val[i]);
+  }
+  if constexpr (num_regs >= 2) {
+    for (int i = 0; i < num_regs; i += 2) {
+      bitonic_merge_regs<vtype, 2>(key + i, val + i);
+    }
+  }
+  if constexpr (num_regs >= 4) {
+    for (int i = 0; i < num_regs; i += 4) {
+      bitonic_merge_regs<vtype, 4>(key + i, val + i);
+    }
+  }
+  if constexpr (num_regs >= 8) {
+    bitonic_merge_regs<vtype, 8>(key, val);
+  }
+  for (int i = 0; i < num_regs; ++i) {
+    vtype::mask_storeu(keys + i * 8, masks[i], key[i]);
+    vtype_val::mask_storeu(vals + i * 8, masks[i], val[i]);
+  }
+}
+
+// Base case, both arrays take 8 registers each at 64 elements.
+template <typename vtype, typename type_t>
+X86_SIMD_SORT_INLINE void sort_64(type_t* keys, uint64_t* vals, int32_t n) {
+  if (n <= 8) {
+    sort_regs<vtype, 1>(keys, vals, n);
+  } else if (n <= 16) {
+    sort_regs<vtype, 2>(keys, vals, n);
+  } else if (n <= 32) {
+    sort_regs<vtype, 4>(keys, vals, n);
+  } else {
+    sort_regs<vtype, 8>(keys, vals, n);
+  }
+}
+
+// Same as partition_vec, with the value vector stored through the same masks.
+template <typename vtype, typename type_t, typename zmm_t>
+static inline int32_t partition_vec(type_t* keys,
+                                    uint64_t* vals,
+                                    int64_t left,
+                                    int64_t right,
+                                    const zmm_t curr_key,
+                                    const zmm_val_t curr_val,
+                                    const zmm_t pivot_vec,
+                                    zmm_t* smallest_vec,
+                                    zmm_t* biggest_vec) {
+  const typename vtype::opmask_t gt_mask = vtype::ge(curr_key, pivot_vec);
+  const typename vtype::opmask_t le_mask = vtype::knot_opmask(gt_mask);
+  const int32_t amount_gt_pivot = _mm_popcnt_u32(static_cast<int32_t>(gt_mask));
+  vtype::mask_compressstoreu(keys + left, le_mask, curr_key);
+  vtype_val::mask_compressstoreu(vals + left, le_mask, curr_val);
+  vtype::mask_compressstoreu(keys + right - amount_gt_pivot, gt_mask,
+                             curr_key);
+  vtype_val::mask_compressstoreu(vals + right - amount_gt_pivot, gt_mask,
+                                 curr_val);
+  *smallest_vec = vtype::min(curr_key, *smallest_vec);
+  *biggest_vec = vtype::max(curr_key, *biggest_vec);
+  return amount_gt_pivot;
+}
+
+// Same as partition_avx512, moving the values along with the keys.
+template <typename vtype, typename type_t>
+static inline int64_t partition(type_t* keys,
+                                uint64_t* vals,
+                                int64_t left,
+                                int64_t right,
+                                type_t pivot,
+                                type_t* smallest,
+                                type_t* biggest) {
+  for (int32_t i = (right - left) % vtype::numlanes; i > 0; --i) {
+    *smallest = std::min(*smallest, keys[left]);
+    *biggest = std::max(*biggest, keys[left]);
+    if (keys[left] >= pivot) {
+      --right;
+      std::swap(keys[left], keys[right]);
+      std::swap(vals[left], vals[right]);
+    } else {
+      ++left;
+    }
+  }
+
+  if (left == right) {
+    return left;
+  }
+
+  using zmm_t = typename vtype::zmm_t;
+  const zmm_t pivot_vec = vtype::set1(pivot);
+  zmm_t min_vec = vtype::set1(*smallest);
+  zmm_t max_vec = vtype::set1(*biggest);
+
+  if (right - left == vtype::numlanes) {
+    const zmm_t key = vtype::loadu(keys + left);
+    const zmm_val_t val = vtype_val::loadu(vals + left);
+    const int32_t amount_gt_pivot =
+        partition_vec<vtype>(keys, vals, left, left + vtype::numlanes, key,
+                             val, pivot_vec, &min_vec, &max_vec);
+    *smallest = vtype::reducemin(min_vec);
+    *biggest = vtype::reducemax(max_vec);
+    return left + (vtype::numlanes - amount_gt_pivot);
+  }
+
+  // The first and last vectors are partitioned at the end, which frees up the
+  // space the others are stored into.
+  const zmm_t key_left = vtype::loadu(keys + left);
+  const zmm_val_t val_left = vtype_val::loadu(vals + left);
+  const zmm_t key_right = vtype::loadu(keys + (right - vtype::numlanes));
+  const zmm_val_t val_right =
+      vtype_val::loadu(vals + (right - vtype::numlanes));
+  int64_t r_store = right - vtype::numlanes;
+  int64_t l_store = left;
+  left += vtype::numlanes;
+  right -= vtype::numlanes;
+  while (right - left != 0) {
+    zmm_t curr_key;
+    zmm_val_t curr_val;
+    if ((r_store + vtype::numlanes) - right < left - l_store) {
+      right -= vtype::numlanes;
+      curr_key = vtype::loadu(keys + right);
+      curr_val = vtype_val::loadu(vals + right);
+    } else {
+      curr_key = vtype::loadu(keys + left);
+      curr_val = vtype_val::loadu(vals + left);
+      left += vtype::numlanes;
+    }
+    const int32_t amount_gt_pivot = partition_vec<vtype>(
+        keys, vals, l_store, r_store + vtype::numlanes, curr_key, curr_val,
+        pivot_vec, &min_vec, &max_vec);
+    r_store -= amount_gt_pivot;
+    l_store += (vtype::numlanes - amount_gt_pivot);
+  }
+
+  int32_t amount_gt_pivot = partition_vec<vtype>(
+      keys, vals, l_store, r_store + vtype::numlanes, key_left, val_left,
+      pivot_vec, &min_vec, &max_vec);
+  l_store += (vtype::numlanes - amount_gt_pivot);
+  amount_gt_pivot = partition_vec<vtype>(keys, vals, l_store,
+                                         l_store + vtype::numlanes, key_right,
+                                         val_right, pivot_vec, &min_vec,
+                                         &max_vec);
+  l_store += (vtype::numlanes - amount_gt_pivot);
+  *smallest = vtype::reducemin(min_vec);
+  *biggest = vtype::reducemax(max_vec);
+  return l_store;
+}
+
+// Used if the quicksort isn't making progress.
+template <typename type_t>
+void fallback_sort(type_t* keys, uint64_t* vals, int64_t len) {
+  std::vector<std::pair<type_t, uint64_t>> pairs(len);
+  for (int64_t i = 0; i < len; ++i) {
+    pairs[i] = {keys[i], vals[i]};
+  }
+  std::sort(pairs.begin(), pairs.end(),
+            [](const auto& a, const auto& b) { return a.first < b.first; });
+  for (int64_t i = 0; i < len; ++i) {
+    keys[i] = pairs[i].first;
+    vals[i] = pairs[i].second;
+  }
+}
+
+template <typename vtype, typename type_t>
+static void qsort_(type_t* keys,
+                   uint64_t* vals,
+                   int64_t left,
+                   int64_t right,
+                   int64_t max_iters) {
+  if (max_iters <= 0) {
+    fallback_sort(keys + left, vals + left, right + 1 - left);
+    return;
+  }
+  if (right + 1 - left <= 64) {
+    sort_64<vtype>(keys + left, vals + left,
+                   static_cast<int32_t>(right + 1 - left));
+    return;
+  }
+
+  const type_t pivot = get_pivot_64bit<vtype>(keys, left, right);
+  type_t smallest = vtype::type_max();
+  type_t biggest = vtype::type_min();
+  const int64_t pivot_index = partition<vtype>(keys, vals, left, right + 1,
+                                               pivot, &smallest, &biggest);
+  if (pivot != smallest) {
+    qsort_<vtype>(keys, vals, left, pivot_index - 1, max_iters - 1);
+  }
+  if (pivot != biggest) {
+    qsort_<vtype>(keys, vals, pivot_index, right, max_iters - 1);
+  }
+}
+
+// Moves all elements with the maximum key to the end and returns how many
+// remain in front, so the networks can pad with the maximum key.
+template <typename vtype, typename type_t>
+int64_t move_max_keys_to_end(type_t* keys, uint64_t* vals, int64_t len) {
+  const typename vtype::zmm_t max_vec = vtype::zmm_max();
+  __mmask8 found = 0;
+  int64_t i = 0;
+  for (; i + 8 <= len; i += 8) {
+    found |= _mm512_cmpeq_epi64_mask(vtype::loadu(keys + i), max_vec);
+  }
+  for (; i < len; ++i) {
+    found |= keys[i] == vtype::type_max();
+  }
+  if (found == 0) {
+    return len;
+  }
+
+  int64_t end = len;
+  for (int64_t j = len - 1; j >= 0; --j) {
+    if (keys[j] == vtype::type_max()) {
+      --end;
+      std::swap(keys[j], keys[end]);
+      std::swap(vals[j], vals[end]);
+    }
+  }
+  return end;
+}
+
+template <typename type_t>
+void qsort(type_t* keys, uint64_t* vals, int64_t len) {
+  using vtype = zmm_vector<type_t>;
+  len = move_max_keys_to_end<vtype>(keys, vals, len);
+  if (len > 1) {
+    qsort_<vtype>(keys, vals, 0, len - 1, 2 * static_cast<int64_t>(log2(len)));
+  }
+}
+
+}  // namespace avx512_kv
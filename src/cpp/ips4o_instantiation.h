@@ -0,0 +1,24 @@
+#pragma once
+
+// Has to come before ips4o.hpp, the classifier calls into it.
+#ifdef IPS4O_SIMD_CLASSIFIER
+#include "simd_classifier.h"
+#endif
+
+#include "thirdparty/ips4o/ips4o.hpp"
+
+#include <functional>
+
+#include <stdint.h>
+
+// The sequential ips4o::sort of the primitive types, the most used and most
+// expensive instantiations of cpp_ips4o.cpp. With CPP_SPLIT_INSTANTIATION the
+// wrapper declares them with IPS4O_INSTANTIATE_COMMON(extern) and
+// cpp_ips4o_inst.cpp defines them, see build.rs.
+#define IPS4O_INSTANTIATE_SORT(prefix, T)                                  \
+  prefix template void ips4o::sort<ips4o::Config<>, T*, std::less<>>(T*, T*, \
+                                                                     std::less<>);
+
+#define IPS4O_INSTANTIATE_COMMON(prefix) \
+  IPS4O_INSTANTIATE_SORT(prefix, int32_t)  \
+  IPS4O_INSTANTIATE_SORT(prefix, uint64_t)
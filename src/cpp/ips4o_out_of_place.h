@@ -0,0 +1,221 @@
+#pragma once
+
+// Out-of-place variant of the ips4o partitioning step, in the style of S4o and
+// the distribution of IPS2Ra. Instead of the in-place block permutation, each
+// level classifies its input once with the ips4o decision tree, remembers the
+// bucket of every element in an oracle array, and scatters the elements into
+// the other array. Levels ping-pong between the source and destination, and
+// once a bucket fits into the cache it is sorted in place with ips4o.
+//
+// Costs an extra array of len elements, and the oracle of two bytes per
+// element, but moves every element exactly once per level.
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "thirdparty/ips4o/ips4o.hpp"
+
+namespace ips4o_out_of_place {
+
+// Below this size a bucket is sorted in place, it is no longer limited by
+// memory bandwidth.
+constexpr size_t kInPlaceBytes = size_t{1} << 20;
+
+template <typename T, typename Compare>
+class OutOfPlaceSorter {
+  using Cfg = ips4o::ExtendedConfig<T*, Compare, ips4o::Config<>>;
+  using Classifier = typename ips4o::detail::Sorter<Cfg>::Classifier;
+  using diff_t = typename Cfg::difference_type;
+  using bucket_t = uint16_t;
+
+  static_assert(Cfg::kMaxBuckets <= UINT16_MAX, "Oracle type too small");
+
+ public:
+  explicit OutOfPlaceSorter(Compare comp)
+      : _comp{comp},
+        _leaf_sorter{/*check_sorted=*/false, comp},
+        _classifier{std::make_unique<Classifier>(comp)},
+        _write_buffers{std::make_unique<WriteBuffer[]>(Cfg::kMaxBuckets)} {}
+
+  // Sorts [src, src + len) into dst. The contents of src are left in an
+  // unspecified order.
+  void sort_into(T* src, T* dst, size_t len) {
+    if (len * sizeof(T) <= kInPlaceBytes) {
+      std::move(src, src + len, dst);
+      _leaf_sorter(dst, dst + len);
+      return;
+    }
+
+    _oracle.reset(new bucket_t[len]);
+    sort_rec(src, dst, _oracle.get(), static_cast<diff_t>(len),
+             /*want_other=*/true);
+  }
+
+ private:
+  // data holds the elements, the sorted result belongs into data if
+  // want_other is false, and into other if it is true.
+  void sort_rec(T* data,
+                T* other,
+                bucket_t* oracle,
+                diff_t len,
+                bool want_other) {
+    if (static_cast<size_t>(len) * sizeof(T) <= kInPlaceBytes) {
+      _leaf_sorter(data, data + len);
+      if (want_other) {
+        std::move(data, data + len, other);
+      }
+      return;
+    }
+
+    diff_t bucket_start[Cfg::kMaxBuckets + 1];
+    const auto [num_buckets, equal_buckets] =
+        distribute(data, other, oracle, len, bucket_start);
+
+    for (int b = 0; b < num_buckets; ++b) {
+      const diff_t start = bucket_start[b];
+      const diff_t bucket_len = bucket_start[b + 1] - start;
+      // Every odd bucket but the last holds copies of a single splitter.
+      const bool is_equal_bucket =
+          equal_buckets && (b % 2 == 1) && b != num_buckets - 1;
+
+      if (is_equal_bucket) {
+        if (!want_other) {
+          std::move(other + start, other + start + bucket_len, data + start);
+        }
+      } else if (bucket_len > 0) {
+        sort_rec(other + start, data + start, oracle + start, bucket_len,
+                 !want_other);
+      }
+    }
+  }
+
+  // Moves the elements of data into other, grouped by bucket. Same sampling
+  // and splitter selection as Sorter::buildClassifier, except that the sample
+  // is copied out instead of being swapped to the front of data.
+  std::pair<int, bool> distribute(T* data,
+                                  T* other,
+                                  bucket_t* oracle,
+                                  diff_t len,
+                                  diff_t* bucket_start) {
+    int log_buckets = Cfg::logBuckets(len);
+    int num_buckets = 1 << log_buckets;
+    const diff_t step =
+        std::max<diff_t>(1, static_cast<diff_t>(Cfg::oversamplingFactor(len)));
+    const diff_t num_samples = std::min(step * num_buckets - 1, len / 2);
+
+    _sample.clear();
+    std::uniform_int_distribution<diff_t> dist{0, len - 1};
+    for (diff_t i = 0; i < num_samples; ++i) {
+      _sample.push_back(data[dist(_random)]);
+    }
+    ips4o::sort(_sample.begin(), _sample.end(), _comp);
+
+    _classifier->reset();
+    T* sorted_splitters = _classifier->getSortedSplitters();
+    auto splitter = _sample.begin() + step - 1;
+    new (sorted_splitters) T(*splitter);
+    for (int i = 2; i < num_buckets; ++i) {
+      splitter += step;
+      if (_comp(*sorted_splitters, *splitter)) {
+        new (++sorted_splitters) T(*splitter);
+      }
+    }
+
+    const diff_t diff_splitters =
+        sorted_splitters - _classifier->getSortedSplitters() + 1;
+    const bool use_equal_buckets =
+        Cfg::kAllowEqualBuckets &&
+        num_buckets - 1 - diff_splitters >= Cfg::kEqualBucketsThreshold;
+
+    log_buckets = ips4o::detail::log2(diff_splitters) + 1;
+    num_buckets = 1 << log_buckets;
+    for (diff_t i = diff_splitters + 1; i < num_buckets; ++i) {
+      new (++sorted_splitters) T(*splitter);
+    }
+    _classifier->build(log_buckets);
+
+    const int used_buckets = num_buckets * (1 + use_equal_buckets);
+    std::fill(bucket_start, bucket_start + used_buckets + 1, 0);
+
+    // bucket_start[b + 1] counts the elements of bucket b.
+    const auto count = [&](auto bucket, T* it) {
+      oracle[it - data] = static_cast<bucket_t>(bucket);
+      ++bucket_start[bucket + 1];
+    };
+    if (use_equal_buckets) {
+      _classifier->template classify<true>(data, data + len, count);
+    } else {
+      _classifier->template classify<false>(data, data + len, count);
+    }
+
+    for (int b = 0; b < used_buckets; ++b) {
+      bucket_start[b + 1] += bucket_start[b];
+    }
+    scatter(data, other, oracle, len, bucket_start, used_buckets);
+
+    return {used_buckets, use_equal_buckets};
+  }
+
+  // Writes go through a cache line sized buffer per bucket, so that the
+  // scatter into up to 512 buckets writes whole lines instead of touching a
+  // line of every bucket for every element.
+  void scatter(T* data,
+               T* other,
+               const bucket_t* oracle,
+               diff_t len,
+               const diff_t* bucket_start,
+               int num_buckets) {
+    diff_t write_pos[Cfg::kMaxBuckets];
+    int fill[Cfg::kMaxBuckets];
+    for (int b = 0; b < num_buckets; ++b) {
+      write_pos[b] = bucket_start[b];
+      fill[b] = 0;
+    }
+
+    for (diff_t i = 0; i < len; ++i) {
+      const bucket_t b = oracle[i];
+      T* buffer = _write_buffers[b].elems;
+      buffer[fill[b]++] = std::move(data[i]);
+      if (fill[b] == kBufferLen) {
+        std::move(buffer, buffer + kBufferLen, other + write_pos[b]);
+        write_pos[b] += kBufferLen;
+        fill[b] = 0;
+      }
+    }
+
+    for (int b = 0; b < num_buckets; ++b) {
+      T* buffer = _write_buffers[b].elems;
+      std::move(buffer, buffer + fill[b], other + write_pos[b]);
+    }
+  }
+
+  static constexpr int kBufferLen =
+      sizeof(T) >= 64 ? 1 : static_cast<int>(64 / sizeof(T));
+
+  struct alignas(64) WriteBuffer {
+    T elems[kBufferLen];
+  };
+
+  Compare _comp;
+  // Reused for all buckets, ips4o::sort allocates its buffers on every call.
+  ips4o::SequentialSorter<Cfg> _leaf_sorter;
+  std::unique_ptr<Classifier> _classifier;
+  std::unique_ptr<WriteBuffer[]> _write_buffers;
+  std::unique_ptr<bucket_t[]> _oracle;
+  std::vector<T> _sample;
+  std::minstd_rand _random{std::random_device{}()};
+};
+
+template <typename T>
+void sort_into(T* src, T* dst, size_t len) {
+  OutOfPlaceSorter<T, std::less<>>{std::less<>{}}.sort_into(src, dst, len);
+}
+
+}  // namespace ips4o_out_of_place
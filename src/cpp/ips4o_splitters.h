@@ -0,0 +1,153 @@
+#pragma once
+
+// Reuse of the top level splitters of ips4o across sorts of inputs with the
+// same distribution, e.g. batches that arrive every few milliseconds. ips4o
+// otherwise selects and sorts a new sample of up to a few thousand elements on
+// every call, with a cache miss for every element of it.
+//
+// The splitters are kept as kQuantiles evenly spaced quantiles of an earlier
+// sorted input, the caller owns them. The next sorts hand them to the top
+// level partition as its sample through the presetSample hook of the
+// comparator, see thirdparty/ips4o/sampling.hpp, the levels below sample as
+// usual. Before that, kCheckSamples elements of the new input are counted
+// into kCheckGroups ranges between the quantiles. If the counts are unlikely
+// for the distribution the quantiles came from, the input is sorted with a
+// fresh sample instead, and the quantiles are replaced by those of the
+// result. Skewed splitters never make the result wrong, only the buckets
+// uneven.
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+
+#include "thirdparty/ips4o/ips4o.hpp"
+
+namespace ips4o_splitters {
+
+// Same values as SplitterUse on the Rust side.
+enum Use : uint32_t {
+  // Sorted with the quantiles.
+  Reused = 0,
+  // Sorted with a fresh sample, the quantiles are now those of the result.
+  Resampled = 1,
+  // Too short to partition more than once, sorted as usual and the quantiles
+  // are left alone.
+  TooShort = 2,
+};
+
+// One sample element per splitter at the maximum number of buckets, every
+// level with fewer buckets takes every second, fourth, ... of them.
+constexpr size_t kQuantiles = (size_t{1} << ips4o::Config<>::kLogBuckets) - 1;
+
+constexpr size_t kCheckGroups = 16;
+constexpr size_t kCheckSamples = 256;
+
+// Critical value of the chi-squared distribution with kCheckGroups - 1 degrees
+// of freedom for p = 1e-4, about one in 10^4 checks rejects quantiles that
+// still fit.
+constexpr double kCheckThreshold = 44.3;
+
+static_assert((kQuantiles + 1) % kCheckGroups == 0);
+
+// std::less<> that hands out the quantiles for the whole input, and nothing
+// for the ranges below it.
+template <typename T>
+class PresetLess {
+ public:
+  PresetLess(const T* begin, const T* end, const T* quantiles)
+      : _begin{begin}, _end{end}, _quantiles{quantiles} {}
+
+  bool operator()(const T& a, const T& b) const { return a < b; }
+
+  const T* presetSample(const T* begin, const T* end) const {
+    return begin == _begin && end == _end ? _quantiles : nullptr;
+  }
+
+ private:
+  const T* _begin;
+  const T* _end;
+  const T* _quantiles;
+};
+
+template <typename T>
+void take_quantiles(const T* sorted, size_t len, T* quantiles) {
+  for (size_t i = 0; i < kQuantiles; ++i) {
+    quantiles[i] = sorted[(i + 1) * len / (kQuantiles + 1)];
+  }
+}
+
+// Whether a sample of data looks like it comes from the distribution of
+// quantiles, by a chi-squared test of its counts per group of quantiles.
+template <typename T>
+bool fits(const T* data, size_t len, const T* quantiles) {
+  constexpr size_t kPerGroup = (kQuantiles + 1) / kCheckGroups;
+
+  // Group g holds the values up to and including bounds[g]. The fraction of
+  // the original input in it follows from the rank of the last quantile equal
+  // to its bound, which also covers runs of equal quantiles.
+  T bounds[kCheckGroups - 1];
+  double expected[kCheckGroups];
+  double below = 0.0;
+  for (size_t g = 0; g < kCheckGroups - 1; ++g) {
+    size_t last = (g + 1) * kPerGroup - 1;
+    bounds[g] = quantiles[last];
+    while (last + 1 < kQuantiles && !(bounds[g] < quantiles[last + 1])) {
+      ++last;
+    }
+    const double up_to = static_cast<double>(last + 1) / (kQuantiles + 1);
+    expected[g] = (up_to - below) * kCheckSamples;
+    below = up_to;
+  }
+  expected[kCheckGroups - 1] = (1.0 - below) * kCheckSamples;
+
+  // One element of every stratum, at a pseudo random offset, like the
+  // distinct estimate of sortedness.h.
+  size_t counts[kCheckGroups] = {};
+  const size_t stratum = len / kCheckSamples;
+  for (size_t i = 0; i < kCheckSamples; ++i) {
+    uint64_t offset = (i + 1) * 0x9e3779b97f4a7c15ull;
+    offset ^= offset >> 29;
+    const T& value = data[i * stratum + offset % stratum];
+    counts[std::lower_bound(bounds, bounds + kCheckGroups - 1, value) -
+           bounds] += 1;
+  }
+
+  double chi_squared = 0.0;
+  for (size_t g = 0; g < kCheckGroups; ++g) {
+    const double diff = counts[g] - expected[g];
+    chi_squared += diff * diff / std::max(expected[g], 1.0);
+  }
+
+  return chi_squared <= kCheckThreshold;
+}
+
+// Sorts data with sort_fn(data, len, comp), which has to run ips4o with comp.
+// quantiles holds kQuantiles elements, which are only read if valid.
+template <typename T, typename SortFn>
+Use sort(T* data, size_t len, T* quantiles, bool valid, SortFn sort_fn) {
+  if (len <= static_cast<size_t>(ips4o::Config<>::kSingleLevelThreshold)) {
+    sort_fn(data, len, std::less<>{});
+    return TooShort;
+  }
+
+  if (valid && fits(data, len, quantiles)) {
+    sort_fn(data, len, PresetLess<T>{data, data + len, quantiles});
+    return Reused;
+  }
+
+  sort_fn(data, len, std::less<>{});
+  take_quantiles(data, len, quantiles);
+  return Resampled;
+}
+
+}  // namespace ips4o_splitters
+
+#if defined(IPS4O_SIMD_CLASSIFIER)
+namespace small_sort_network {
+// Keeps the vectorized classification, PresetLess compares like std::less<>.
+template <typename T>
+struct is_natural_less<ips4o_splitters::PresetLess<T>, T> : std::true_type {};
+}  // namespace small_sort_network
+#endif
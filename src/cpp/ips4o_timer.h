@@ -0,0 +1,111 @@
+#pragma once
+
+// Phase timers behind the IPS4O_TIMER hooks in thirdparty/ips4o. The hooks
+// refer to the g_* globals unqualified, so this has to be included before
+// ips4o.hpp.
+//
+// Every thread times its own intervals, a stop without a matching start on the
+// same thread is ignored. In the parallel build the phases are summed across
+// all threads, so they can add up to more than the wall time of a sort.
+
+#if defined(IPS4O_TIMER)
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace ips4o_timer {
+
+// Same order as the PHASES list on the Rust side.
+enum Phase : size_t {
+  kTotal,
+  kOverhead,
+  kSampling,
+  kClassification,
+  kEmptyBlock,
+  kPermutation,
+  kCleanup,
+  kBaseCase,
+  kNumPhases,
+};
+
+static std::atomic<uint64_t> g_phase_ns[kNumPhases];
+
+class PhaseTimer {
+ public:
+  explicit constexpr PhaseTimer(Phase phase) : phase_{phase} {}
+
+  void start() const {
+    State& state = thread_state();
+    state.running = true;
+    state.start = std::chrono::steady_clock::now();
+  }
+
+  void stop() const {
+    const auto now = std::chrono::steady_clock::now();
+
+    State& state = thread_state();
+    if (!state.running) {
+      return;
+    }
+    state.running = false;
+
+    const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        now - state.start);
+    g_phase_ns[phase_].fetch_add(static_cast<uint64_t>(elapsed.count()),
+                                 std::memory_order_relaxed);
+  }
+
+  // Some hooks pass the length and a label, only used by the upstream
+  // benchmark timers.
+  template <typename Len>
+  void stop(Len, const char*) const {
+    stop();
+  }
+
+ private:
+  struct State {
+    std::chrono::steady_clock::time_point start;
+    bool running = false;
+  };
+
+  State& thread_state() const {
+    thread_local State states[kNumPhases];
+    return states[phase_];
+  }
+
+  Phase phase_;
+};
+
+inline void read(uint64_t* phase_ns) {
+  for (size_t i = 0; i < kNumPhases; ++i) {
+    phase_ns[i] = g_phase_ns[i].load(std::memory_order_relaxed);
+  }
+}
+
+inline void reset() {
+  for (auto& ns : g_phase_ns) {
+    ns.store(0, std::memory_order_relaxed);
+  }
+}
+
+}  // namespace ips4o_timer
+
+static constexpr ips4o_timer::PhaseTimer g_total{ips4o_timer::kTotal};
+static constexpr ips4o_timer::PhaseTimer g_overhead{ips4o_timer::kOverhead};
+static constexpr ips4o_timer::PhaseTimer g_sampling{ips4o_timer::kSampling};
+static constexpr ips4o_timer::PhaseTimer g_classification{
+    ips4o_timer::kClassification};
+static constexpr ips4o_timer::PhaseTimer g_empty_block{
+    ips4o_timer::kEmptyBlock};
+static constexpr ips4o_timer::PhaseTimer g_permutation{
+    ips4o_timer::kPermutation};
+static constexpr ips4o_timer::PhaseTimer g_cleanup{ips4o_timer::kCleanup};
+static constexpr ips4o_timer::PhaseTimer g_base_case{ips4o_timer::kBaseCase};
+
+// Written by the hooks, but not needed for the phase split.
+static thread_local int g_active_counters = 0;
+static thread_local int g_ips4o_level = 0;
+
+#endif  // IPS4O_TIMER
@@ -0,0 +1,429 @@
+#pragma once
+
+// Order-preserving normalized keys. Unsigned and signed integers, floats and
+// string prefixes are mapped onto unsigned integers, whose integer order, and
+// the memcmp order of their big-endian bytes, is the order of the values.
+// Composite keys concatenate such fields, the most significant first, into
+// uint64_t or unsigned __int128 words or into byte strings, which any of the
+// integer sorts, or a byte string sort, can then sort in place of the values.
+//
+// Fields are encoded one at a time, with a branchless loop over all rows that
+// the compiler vectorizes, instead of assembling the key of one row after the
+// other. Only string prefixes are gathered element by element.
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+namespace key_encoder {
+
+enum class NanOrder : uint8_t { First, Last };
+
+// Maps the order of the value onto the order of an unsigned integer of the
+// same width.
+
+inline uint32_t ordered_bits(uint32_t value) noexcept {
+  return value;
+}
+
+inline uint64_t ordered_bits(uint64_t value) noexcept {
+  return value;
+}
+
+inline uint32_t ordered_bits(int32_t value) noexcept {
+  return static_cast<uint32_t>(value) ^ (uint32_t{1} << 31);
+}
+
+inline uint64_t ordered_bits(int64_t value) noexcept {
+  return static_cast<uint64_t>(value) ^ (uint64_t{1} << 63);
+}
+
+// Negative floats have all bits flipped, positive ones only the sign bit.
+// -0.0 and 0.0 map to the same bits, NaNs are placed by the caller.
+template <typename Float, typename Bits>
+Bits ordered_float_bits(Float value) noexcept {
+  constexpr int SIGN_SHIFT = sizeof(Bits) * 8 - 1;
+
+  const Float normalized = value + Float{0};
+  Bits bits;
+  memcpy(&bits, &normalized, sizeof(bits));
+
+  const Bits sign_mask = Bits{0} - (bits >> SIGN_SHIFT);
+  return bits ^ (sign_mask | (Bits{1} << SIGN_SHIFT));
+}
+
+inline uint32_t ordered_bits(float value) noexcept {
+  return ordered_float_bits<float, uint32_t>(value);
+}
+
+inline uint64_t ordered_bits(double value) noexcept {
+  return ordered_float_bits<double, uint64_t>(value);
+}
+
+enum class FieldKind : uint8_t { U32, U64, I32, I64, F32, F64, String };
+
+// One field of a composite key.
+struct Field {
+  FieldKind kind;
+  const void* data;
+  // Integers and floats: all bits of the value, XORed with flip. Strings: the
+  // big-endian prefix of string_len bytes, starting at string_offset.
+  uint64_t flip;
+  uint64_t value_mask;
+  NanOrder nan_order;
+  size_t string_offset;
+  uint64_t (*string_prefix)(const void* data,
+                            size_t row,
+                            size_t offset,
+                            size_t n_bytes);
+  // Added by add_* calls with the same column belong to one column.
+  size_t column;
+  // The part of the value in the key: (value - min) >> drop_bits, bits wide.
+  uint64_t min;
+  size_t drop_bits;
+  size_t bits;
+};
+
+// The key of a value, all ordered bits of it XORed with flip. NaNs become 0
+// or value_mask, after flipping, so that nan_order holds in either direction.
+template <typename T>
+uint64_t flipped_key(T value,
+                     uint64_t flip,
+                     uint64_t value_mask,
+                     NanOrder nan_order) noexcept {
+  uint64_t bits = uint64_t{ordered_bits(value)} ^ flip;
+  if constexpr (std::is_floating_point_v<T>) {
+    const uint64_t nan_bits = nan_order == NanOrder::Last ? value_mask : 0;
+    bits = value != value ? nan_bits : bits;
+  }
+
+  return bits;
+}
+
+// The full width key of a single value, for comparing values the way the
+// fields of KeyEncoder order them.
+template <typename T>
+uint64_t ordered_key(T value, bool is_descending, NanOrder nan_order) noexcept {
+  constexpr uint64_t VALUE_MASK = ~uint64_t{0} >> (64 - sizeof(T) * 8);
+  return flipped_key(value, is_descending ? VALUE_MASK : 0, VALUE_MASK,
+                     nan_order);
+}
+
+// The value of an integer or float field, before subtracting min.
+template <typename T>
+uint64_t field_value(const Field& field, T value) noexcept {
+  return flipped_key(value, field.flip, field.value_mask, field.nan_order);
+}
+
+// Word is uint64_t or unsigned __int128.
+template <typename Word>
+class KeyEncoder {
+ public:
+  static constexpr size_t WORD_BITS = sizeof(Word) * 8;
+
+  // T is one of uint32_t, uint64_t, int32_t and int64_t.
+  template <typename T>
+  void add_int(const T* values, bool is_descending) {
+    static_assert(std::is_integral_v<T>);
+    add_number(field_kind<T>(), values, sizeof(T), is_descending,
+               NanOrder::Last);
+  }
+
+  // T is float or double. nan_order holds regardless of the direction.
+  template <typename T>
+  void add_float(const T* values, bool is_descending, NanOrder nan_order) {
+    static_assert(std::is_floating_point_v<T>);
+    add_number(field_kind<T>(), values, sizeof(T), is_descending, nan_order);
+  }
+
+  // The first n_bytes of every string, zero padded, strings shorter than that
+  // compare equal to the same string padded with zero bytes. Str needs data
+  // and len members, like FFIString.
+  template <typename Str>
+  void add_string_prefix(const Str* values,
+                         size_t n_bytes,
+                         bool is_descending) {
+    const size_t column = next_column();
+    for (size_t offset = 0; offset < n_bytes; offset += 8) {
+      const size_t chunk_bytes = std::min<size_t>(8, n_bytes - offset);
+
+      Field field{};
+      field.kind = FieldKind::String;
+      field.data = values;
+      field.flip = is_descending ? low_bits(chunk_bytes * 8) : 0;
+      field.value_mask = low_bits(chunk_bytes * 8);
+      field.string_offset = offset;
+      field.string_prefix = &string_prefix_of<Str>;
+      field.column = column;
+      field.bits = chunk_bytes * 8;
+      _fields.push_back(field);
+    }
+  }
+
+  // Narrows every integer and float field to the range of its first len
+  // values. Fields with a single distinct value drop out of the key.
+  void compress(size_t len) {
+    for (Field& field : _fields) {
+      if (field.kind == FieldKind::String || len == 0) {
+        continue;
+      }
+
+      uint64_t min = ~uint64_t{0};
+      uint64_t max = 0;
+      visit_values(field, [&](const auto* values) {
+        for (size_t row = 0; row < len; ++row) {
+          const uint64_t value = field_value(field, values[row]);
+          min = std::min(min, value);
+          max = std::max(max, value);
+        }
+      });
+
+      field.min = min;
+      field.drop_bits = 0;
+      field.bits = max == min ? 0 : 64 - __builtin_clzll(max - min);
+    }
+  }
+
+  // Truncates the key to WORD_BITS. The first field that doesn't fit keeps
+  // its most significant bits, a string keeps as many whole bytes as fit, and
+  // all fields of later columns are dropped. Returns the first column that
+  // is not fully part of the key, string columns never are, or the number of
+  // columns if all are.
+  size_t fit() {
+    size_t free_bits = WORD_BITS;
+    size_t partial_column = next_column();
+
+    size_t field_i = 0;
+    for (; field_i < _fields.size(); ++field_i) {
+      Field& field = _fields[field_i];
+      if (field.column > partial_column) {
+        break;
+      }
+
+      if (field.kind == FieldKind::String) {
+        partial_column = field.column;
+        const size_t chunk_bytes = std::min(field.bits, free_bits) / 8;
+        if (chunk_bytes == 0) {
+          break;
+        }
+        field.bits = chunk_bytes * 8;
+        field.value_mask = low_bits(field.bits);
+        field.flip &= field.value_mask;
+      } else if (field.bits > free_bits) {
+        partial_column = field.column;
+        if (free_bits == 0) {
+          break;
+        }
+        field.drop_bits = field.bits - free_bits;
+        field.bits = free_bits;
+      }
+
+      free_bits -= field.bits;
+    }
+
+    _fields.resize(field_i);
+    return partial_column;
+  }
+
+  size_t key_bits() const noexcept {
+    size_t bits = 0;
+    for (const Field& field : _fields) {
+      bits += field.bits;
+    }
+    return bits;
+  }
+
+  // Bytes per row written by encode_bytes, every field is rounded up to
+  // whole bytes.
+  size_t key_bytes() const noexcept {
+    size_t bytes = 0;
+    for (const Field& field : _fields) {
+      bytes += (field.bits + 7) / 8;
+    }
+    return bytes;
+  }
+
+  // Writes the keys of the first len rows to out, right-aligned. Requires
+  // key_bits() <= WORD_BITS, see fit.
+  void encode(size_t len, Word* out) const {
+    std::fill(out, out + len, Word{0});
+
+    for (const Field& field : _fields) {
+      if (field.bits == 0) {
+        continue;
+      }
+
+      const size_t bits = field.bits;
+      for_each_field_value(field, len, [out, bits](size_t row, uint64_t value) {
+        out[row] = bits == WORD_BITS ? Word{value} : (out[row] << bits) | value;
+      });
+    }
+  }
+
+  // The key of a single row, the same as encode writes.
+  Word encode_row(size_t row) const {
+    Word key{0};
+    for (const Field& field : _fields) {
+      if (field.bits == 0) {
+        continue;
+      }
+
+      const uint64_t value = field_bits(field, row);
+      key = field.bits == WORD_BITS ? Word{value} : (key << field.bits) | value;
+    }
+    return key;
+  }
+
+  // Writes key_bytes() big-endian bytes per row to out, their memcmp order
+  // is the order of the rows. Any number of fields.
+  void encode_bytes(size_t len, uint8_t* out) const {
+    const size_t stride = key_bytes();
+
+    size_t field_offset = 0;
+    for (const Field& field : _fields) {
+      const size_t field_bytes = (field.bits + 7) / 8;
+      if (field_bytes == 0) {
+        continue;
+      }
+
+      uint8_t* field_out = out + field_offset;
+      for_each_field_value(field, len, [=](size_t row, uint64_t value) {
+        uint8_t* row_out = field_out + row * stride;
+        for (size_t i = 0; i < field_bytes; ++i) {
+          const size_t shift = (field_bytes - 1 - i) * 8;
+          row_out[i] = static_cast<uint8_t>(value >> shift);
+        }
+      });
+      field_offset += field_bytes;
+    }
+  }
+
+ private:
+  template <typename T>
+  static constexpr FieldKind field_kind() {
+    if constexpr (std::is_same_v<T, uint32_t>) {
+      return FieldKind::U32;
+    } else if constexpr (std::is_same_v<T, uint64_t>) {
+      return FieldKind::U64;
+    } else if constexpr (std::is_same_v<T, int32_t>) {
+      return FieldKind::I32;
+    } else if constexpr (std::is_same_v<T, int64_t>) {
+      return FieldKind::I64;
+    } else if constexpr (std::is_same_v<T, float>) {
+      return FieldKind::F32;
+    } else {
+      static_assert(std::is_same_v<T, double>);
+      return FieldKind::F64;
+    }
+  }
+
+  static uint64_t low_bits(size_t n) noexcept {
+    return n >= 64 ? ~uint64_t{0} : (uint64_t{1} << n) - 1;
+  }
+
+  template <typename Str>
+  static uint64_t string_prefix_of(const void* data,
+                                   size_t row,
+                                   size_t offset,
+                                   size_t n_bytes) noexcept {
+    const Str& str = static_cast<const Str*>(data)[row];
+
+    uint64_t prefix = 0;
+    for (size_t i = offset; i < offset + n_bytes; ++i) {
+      const uint8_t byte =
+          i < str.len ? static_cast<uint8_t>(str.data[i]) : uint8_t{0};
+      prefix = (prefix << 8) | byte;
+    }
+    return prefix;
+  }
+
+  size_t next_column() const noexcept {
+    return _fields.empty() ? 0 : _fields.back().column + 1;
+  }
+
+  void add_number(FieldKind kind,
+                  const void* values,
+                  size_t value_bytes,
+                  bool is_descending,
+                  NanOrder nan_order) {
+    Field field{};
+    field.kind = kind;
+    field.data = values;
+    field.value_mask = low_bits(value_bytes * 8);
+    field.flip = is_descending ? field.value_mask : 0;
+    field.nan_order = nan_order;
+    field.column = next_column();
+    field.bits = value_bytes * 8;
+    _fields.push_back(field);
+  }
+
+  // Calls f with the values of an integer or float field as typed pointer.
+  template <typename F>
+  static void visit_values(const Field& field, F f) {
+    switch (field.kind) {
+      case FieldKind::U32:
+        f(static_cast<const uint32_t*>(field.data));
+        break;
+      case FieldKind::U64:
+        f(static_cast<const uint64_t*>(field.data));
+        break;
+      case FieldKind::I32:
+        f(static_cast<const int32_t*>(field.data));
+        break;
+      case FieldKind::I64:
+        f(static_cast<const int64_t*>(field.data));
+        break;
+      case FieldKind::F32:
+        f(static_cast<const float*>(field.data));
+        break;
+      case FieldKind::F64:
+        f(static_cast<const double*>(field.data));
+        break;
+      case FieldKind::String:
+        break;
+    }
+  }
+
+  // Calls f(row, part) for the first len rows, part being what the field
+  // contributes to the key of the row.
+  template <typename F>
+  static void for_each_field_value(const Field& field, size_t len, F f) {
+    if (field.kind == FieldKind::String) {
+      for (size_t row = 0; row < len; ++row) {
+        f(row, field.string_prefix(field.data, row, field.string_offset,
+                                   field.bits / 8) ^
+                   field.flip);
+      }
+      return;
+    }
+
+    const uint64_t min = field.min;
+    const size_t drop_bits = field.drop_bits;
+    visit_values(field, [&](const auto* values) {
+      for (size_t row = 0; row < len; ++row) {
+        f(row, (field_value(field, values[row]) - min) >> drop_bits);
+      }
+    });
+  }
+
+  static uint64_t field_bits(const Field& field, size_t row) {
+    if (field.kind == FieldKind::String) {
+      return field.string_prefix(field.data, row, field.string_offset,
+                                 field.bits / 8) ^
+             field.flip;
+    }
+
+    uint64_t bits = 0;
+    visit_values(field, [&](const auto* values) {
+      bits = (field_value(field, values[row]) - field.min) >> field.drop_bits;
+    });
+    return bits;
+  }
+
+  std::vector<Field> _fields;
+};
+
+}  // namespace key_encoder
@@ -0,0 +1,134 @@
+#pragma once
+
+// Branchless Lomuto partition paired with a cyclic permutation, C++ port of
+// src/other/partition/lomuto_branchless_cyclic_opt.rs, see
+// writeup/lomcyc_partition.
+//
+// The first element is taken out, which leaves a gap. Every step moves the
+// element at the current left end of the less-than side into the gap, the
+// current element into its place, and the current element leaves the new gap
+// behind. Both moves happen regardless of the comparison result, only the left
+// end advances by it. The element taken out is processed last and fills the
+// final gap.
+
+#include <algorithm>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+namespace lomcyc {
+
+namespace detail {
+
+// Writes the element that was taken out back into the gap if the comparison
+// throws, so the input stays a permutation.
+template <typename T>
+struct GapGuard {
+  T* pos;
+  T value;
+  bool is_armed = true;
+
+  ~GapGuard() {
+    if (is_armed) {
+      *pos = std::move(value);
+    }
+  }
+};
+
+// Moves the element at left into the gap. left and gap are the same element
+// as long as every element so far was less than the pivot. Self move
+// assignment is fine for trivially copyable types, for all others it's
+// skipped.
+template <typename T>
+inline void fill_gap(T* gap, T* left) {
+  if constexpr (std::is_trivially_copyable_v<T>) {
+    *gap = std::move(*left);
+  } else {
+    if (gap != left) {
+      *gap = std::move(*left);
+    }
+  }
+}
+
+}  // namespace detail
+
+// Reorders [begin, end) so that the elements that are less than pivot come
+// first, and returns their number. pivot must not be part of [begin, end).
+template <typename T, typename Compare>
+size_t partition(T* begin, T* end, const T& pivot, Compare comp) {
+  const size_t len = static_cast<size_t>(end - begin);
+  if (len == 0) {
+    return 0;
+  }
+
+  detail::GapGuard<T> gap{begin, std::move(*begin)};
+  size_t lt_count = 0;
+  T* right = begin + 1;
+
+  auto loop_body = [&]() {
+    const bool right_is_lt = comp(*right, pivot);
+    T* left = begin + lt_count;
+
+    detail::fill_gap(gap.pos, left);
+    *left = std::move(*right);
+
+    gap.pos = right;
+    lt_count += right_is_lt;
+    ++right;
+  };
+
+  // Manually unrolled, only x86 gets auto-unrolling but not Arm.
+  constexpr size_t unroll_len = sizeof(T) <= 16 ? 2 : 1;
+
+  T* const unroll_end = begin + (len - (unroll_len - 1));
+  while (right < unroll_end) {
+    for (size_t i = 0; i < unroll_len; ++i) {
+      loop_body();
+    }
+  }
+
+  while (right < end) {
+    loop_body();
+  }
+
+  // The element that was taken out first fills the last gap.
+  const bool value_is_lt = comp(gap.value, pivot);
+  T* left = begin + lt_count;
+
+  detail::fill_gap(gap.pos, left);
+  *left = std::move(gap.value);
+  gap.is_armed = false;
+
+  return lt_count + value_is_lt;
+}
+
+// Drop-in replacement for pdqsort_detail::partition_right, with the pivot at
+// begin. Elements equal to the pivot go to the right side. Returns the final
+// position of the pivot, and whether the input already was partitioned.
+template <typename T, typename Compare>
+std::pair<T*, bool> partition_right(T* begin, T* end, Compare comp) {
+  // Elements that already are on the correct side at either end don't have
+  // to be moved. Finding them also tells if the input is partitioned, which
+  // pdqsort uses to try a partial insertion sort.
+  T* first = begin + 1;
+  while (first < end && comp(*first, *begin)) {
+    ++first;
+  }
+
+  T* last = end;
+  while (last > first && !comp(*(last - 1), *begin)) {
+    --last;
+  }
+
+  const bool already_partitioned = first == last;
+  const size_t lt_count = partition(first, last, *begin, comp);
+
+  T* pivot_pos = first - 1 + lt_count;
+  if (pivot_pos != begin) {
+    std::iter_swap(begin, pivot_pos);
+  }
+
+  return std::make_pair(pivot_pos, already_partitioned);
+}
+
+}  // namespace lomcyc
@@ -0,0 +1,155 @@
+#pragma once
+
+// Minimal NUMA support on top of the Linux syscalls and sysfs, so that the
+// wrappers don't depend on libnuma. Elsewhere everything behaves like a single
+// node machine and placement requests are ignored.
+
+#include <cstddef>
+#include <cstdio>
+
+#if defined(__linux__)
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace numa_util {
+
+// Node masks are passed to the kernel as a single unsigned long.
+constexpr int kMaxNodes = 64;
+
+namespace detail {
+// Calls visit for every id in a sysfs list such as "0-3,8-11". Returns false
+// if the file can't be read.
+template <typename F>
+bool for_each_in_sysfs_list(const char* path, F visit) {
+  FILE* file = std::fopen(path, "r");
+  if (file == nullptr) {
+    return false;
+  }
+
+  int first = 0;
+  bool has_any = false;
+  while (std::fscanf(file, "%d", &first) == 1) {
+    int last = first;
+    const int next = std::fgetc(file);
+    if (next == '-') {
+      if (std::fscanf(file, "%d", &last) != 1) {
+        break;
+      }
+      std::fgetc(file);  // Separator.
+    }
+    for (int id = first; id <= last; ++id) {
+      visit(id);
+    }
+    has_any = true;
+  }
+
+  std::fclose(file);
+  return has_any;
+}
+}  // namespace detail
+
+inline int num_nodes() noexcept {
+  static const int result = [] {
+    int max_node = 0;
+    detail::for_each_in_sysfs_list("/sys/devices/system/node/online",
+                                   [&](int node) {
+                                     if (node > max_node) {
+                                       max_node = node;
+                                     }
+                                   });
+    return max_node + 1 < kMaxNodes ? max_node + 1 : kMaxNodes;
+  }();
+  return result;
+}
+
+// Node of the CPU the calling thread currently runs on.
+inline int current_node() noexcept {
+#if defined(__linux__) && defined(SYS_getcpu)
+  unsigned cpu = 0;
+  unsigned node = 0;
+  if (syscall(SYS_getcpu, &cpu, &node, nullptr) == 0 &&
+      static_cast<int>(node) < num_nodes()) {
+    return static_cast<int>(node);
+  }
+#endif
+  return 0;
+}
+
+// Restricts the calling thread to the CPUs of node.
+inline bool pin_thread_to_node(int node) noexcept {
+#if defined(__linux__)
+  char path[64];
+  std::snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist",
+                node);
+
+  cpu_set_t cpus;
+  CPU_ZERO(&cpus);
+  const bool has_cpus = detail::for_each_in_sysfs_list(path, [&](int cpu) {
+    if (cpu < CPU_SETSIZE) {
+      CPU_SET(cpu, &cpus);
+    }
+  });
+
+  return has_cpus && sched_setaffinity(0, sizeof(cpus), &cpus) == 0;
+#else
+  return false;
+#endif
+}
+
+// Asks the kernel to back [ptr, ptr + bytes) with memory of node, with
+// move_pages it also migrates pages that have already been touched. ptr has to
+// be page aligned.
+inline bool prefer_node(void* ptr,
+                        size_t bytes,
+                        int node,
+                        bool move_pages) noexcept {
+#if defined(__linux__) && defined(SYS_mbind)
+  if (node < 0 || node >= kMaxNodes || num_nodes() < 2) {
+    return false;
+  }
+
+  constexpr int kMpolPreferred = 1;
+  constexpr unsigned kMpolMfMove = 1 << 1;
+
+  const unsigned long node_mask = 1ul << node;
+  return syscall(SYS_mbind, ptr, bytes, kMpolPreferred, &node_mask,
+                 kMaxNodes + 1, move_pages ? kMpolMfMove : 0) == 0;
+#else
+  return false;
+#endif
+}
+
+// Pins the calling thread to a node for the lifetime of the object, and
+// restores the previous affinity afterwards.
+class ScopedNodePin {
+ public:
+  explicit ScopedNodePin(int node) noexcept {
+#if defined(__linux__)
+    _has_saved = sched_getaffinity(0, sizeof(_saved), &_saved) == 0;
+    if (_has_saved) {
+      pin_thread_to_node(node);
+    }
+#endif
+  }
+
+  ScopedNodePin(const ScopedNodePin&) = delete;
+  ScopedNodePin& operator=(const ScopedNodePin&) = delete;
+
+  ~ScopedNodePin() {
+#if defined(__linux__)
+    if (_has_saved) {
+      sched_setaffinity(0, sizeof(_saved), &_saved);
+    }
+#endif
+  }
+
+ private:
+#if defined(__linux__)
+  cpu_set_t _saved;
+  bool _has_saved = false;
+#endif
+};
+
+}  // namespace numa_util
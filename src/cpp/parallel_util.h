@@ -0,0 +1,67 @@
+#pragma once
+
+// Building blocks shared by the parallel wrappers, that spawn their threads
+// per call.
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+// Below this many elements per thread, the thread startup and the extra merge
+// rounds cost more than they save.
+constexpr size_t PARALLEL_MIN_CHUNK_LEN = 8192;
+
+// Runs task(i) for every i in [0, num_tasks), each on its own thread, and waits
+// for all of them. Returns false if any of them threw.
+template <typename F>
+bool run_tasks(size_t num_tasks, F task) {
+  std::atomic<bool> did_throw{false};
+
+  auto run = [&task, &did_throw](size_t i) {
+    try {
+      task(i);
+    } catch (...) {
+      did_throw.store(true);
+    }
+  };
+
+  std::vector<std::thread> threads;
+  threads.reserve(num_tasks - 1);
+  for (size_t i = 1; i < num_tasks; ++i) {
+    threads.emplace_back(run, i);
+  }
+
+  run(0);
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  return !did_throw.load();
+}
+
+// Returns how many of the first out_pos elements of the stable merge of a and b
+// come from a. Ties are taken from a first, same as std::merge.
+template <typename T, typename Compare>
+size_t merge_path_split(const T* a,
+                        size_t a_len,
+                        const T* b,
+                        size_t b_len,
+                        size_t out_pos,
+                        Compare comp) {
+  size_t lo = out_pos > b_len ? out_pos - b_len : 0;
+  size_t hi = std::min(out_pos, a_len);
+
+  while (lo < hi) {
+    const size_t mid = lo + (hi - lo) / 2;
+    if (comp(b[out_pos - mid - 1], a[mid])) {
+      hi = mid;
+    } else {
+      lo = mid + 1;
+    }
+  }
+
+  return lo;
+}
@@ -0,0 +1,168 @@
+#pragma once
+
+// Sorted view over data that arrives in batches. Every appended batch is
+// sorted on its own and becomes a run, runs are merged lazily following the
+// node power merge policy of powersort. That keeps the number of runs
+// logarithmic in the number of batches, and every element is merged about
+// log2(batches) times in total, instead of re-sorting the whole buffer on
+// every append.
+
+#include "thirdparty/powersort/powersort.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+template <typename T, typename SortFn>
+class RunAccumulator {
+ public:
+  explicit RunAccumulator(SortFn sort_fn = {}) : _sort_fn{sort_fn} {}
+
+  // Copies data[0..len) to the end of the buffer and sorts it as a new run.
+  void append(const T* data, size_t len) {
+    if (len == 0) {
+      return;
+    }
+
+    const size_t begin = _data.size();
+    _data.insert(_data.end(), data, data + len);
+    _sort_fn(_data.data() + begin, len);
+
+    const Run run_b{begin, begin + len};
+    if (!_runs.empty()) {
+      // Same as power_sort_paper, with the most recent run playing runA. The
+      // powers on the stack below it are increasing from bottom to top.
+      const algorithms::power_t power =
+          node_power(_runs.back().begin, run_b.begin, run_b.end);
+      while (_runs.size() >= 2 && _runs[_runs.size() - 2].power > power) {
+        merge_top_two();
+      }
+      _runs.back().power = power;
+    }
+
+    _runs.push_back(run_b);
+  }
+
+  // Merges all runs, afterwards data() is sorted. Appending afterwards is
+  // fine, the merged run continues as bottom of the stack.
+  void finalize() {
+    while (_runs.size() >= 2) {
+      merge_top_two();
+    }
+  }
+
+  // Calls f(value) for every element in sorted order, without merging the
+  // runs. Ties between runs go to the older one.
+  template <typename F>
+  void for_each_in_order(F f) const {
+    if (_runs.size() == 1) {
+      std::for_each(_data.begin(), _data.end(), f);
+      return;
+    }
+
+    // Min-heap of the run heads, there are only logarithmically many.
+    std::vector<Run> heads{_runs.begin(), _runs.end()};
+    const auto is_greater = [this](const Run& a, const Run& b) {
+      return _data[b.begin] < _data[a.begin] ||
+             (!(_data[a.begin] < _data[b.begin]) && b.begin < a.begin);
+    };
+    std::make_heap(heads.begin(), heads.end(), is_greater);
+
+    while (!heads.empty()) {
+      std::pop_heap(heads.begin(), heads.end(), is_greater);
+      Run& head = heads.back();
+      f(_data[head.begin]);
+
+      if (++head.begin == head.end) {
+        heads.pop_back();
+      } else {
+        std::push_heap(heads.begin(), heads.end(), is_greater);
+      }
+    }
+  }
+
+  // Only in sorted order if run_count() <= 1.
+  const T* data() const noexcept { return _data.data(); }
+
+  size_t size() const noexcept { return _data.size(); }
+
+  size_t run_count() const noexcept { return _runs.size(); }
+
+ private:
+  struct Run {
+    size_t begin;
+    size_t end;
+    // Power of the node between this run and the next one on the stack.
+    algorithms::power_t power = 0;
+  };
+
+  // node_power_clz of powersort.h needs the final length n, which is unknown
+  // while batches keep arriving. For n a power of two the power only depends
+  // on the common prefix of the scaled run midpoints, and for any n above all
+  // run ends the merge decisions are the same. So this uses n = 2^63, where
+  // the scaling is a no-op.
+  static algorithms::power_t node_power(size_t begin_a,
+                                        size_t begin_b,
+                                        size_t end_b) noexcept {
+    static_assert(sizeof(unsigned long long) == 8);
+    const unsigned long long l2 = begin_a + begin_b;  // 2 * midpoint of A
+    const unsigned long long r2 = begin_b + end_b;    // 2 * midpoint of B
+    return static_cast<algorithms::power_t>(__builtin_clzll(l2 ^ r2));
+  }
+
+  void merge_top_two() {
+    Run run_b = _runs.back();
+    _runs.pop_back();
+    Run& run_a = _runs.back();
+
+    T* data = _data.data();
+    algorithms::merge_runs<algorithms::merging_methods::COPY_BOTH>(
+        data + run_a.begin, data + run_b.begin, data + run_b.end,
+        _merge_buffer.reserve(run_b.end - run_a.begin));
+
+    run_a.end = run_b.end;
+  }
+
+  SortFn _sort_fn;
+  std::vector<T> _data;
+  algorithms::merge_buffer<T> _merge_buffer;
+  std::vector<Run> _runs;
+};
+
+// Defines the <PREFIX>_u64_accumulator_* entry points for an accumulator that
+// sorts its batches with SORT_FN(uint64_t* data, size_t len), a lambda without
+// captures. Use inside extern "C".
+#define RUN_ACCUMULATOR_IMPL(PREFIX, SORT_FN)                                \
+  using PREFIX##_u64_accumulator_t =                                         \
+      RunAccumulator<uint64_t, decltype(SORT_FN)>;                           \
+  void* PREFIX##_u64_accumulator_new() {                                     \
+    return new PREFIX##_u64_accumulator_t{};                                 \
+  }                                                                          \
+  void PREFIX##_u64_accumulator_free(void* acc) {                            \
+    delete static_cast<PREFIX##_u64_accumulator_t*>(acc);                    \
+  }                                                                          \
+  void PREFIX##_u64_accumulator_append(void* acc, const uint64_t* data,      \
+                                       size_t len) {                         \
+    SORT_USDT_PROBE(len);                                                    \
+    static_cast<PREFIX##_u64_accumulator_t*>(acc)->append(data, len);        \
+  }                                                                          \
+  const uint64_t* PREFIX##_u64_accumulator_finalize(void* acc,               \
+                                                    size_t* len) {           \
+    auto* typed_acc = static_cast<PREFIX##_u64_accumulator_t*>(acc);         \
+    typed_acc->finalize();                                                   \
+    *len = typed_acc->size();                                                \
+    return typed_acc->data();                                                \
+  }                                                                          \
+  void PREFIX##_u64_accumulator_copy_in_order(const void* acc,               \
+                                              uint64_t* out) {               \
+    static_cast<const PREFIX##_u64_accumulator_t*>(acc)->for_each_in_order(  \
+        [&out](uint64_t val) { *out++ = val; });                             \
+  }                                                                          \
+  size_t PREFIX##_u64_accumulator_len(const void* acc) {                     \
+    return static_cast<const PREFIX##_u64_accumulator_t*>(acc)->size();      \
+  }                                                                          \
+  size_t PREFIX##_u64_accumulator_run_count(const void* acc) {               \
+    return static_cast<const PREFIX##_u64_accumulator_t*>(acc)->run_count(); \
+  }
@@ -0,0 +1,72 @@
+#pragma once
+
+// Presortedness detection in front of sorts that have none, the same check as
+// find_existing_run in ipnsort. A fully ascending or strictly descending input
+// is done in O(n). A sorted or strictly descending prefix of at least half the
+// input, as in random_s95, is kept, the rest is sorted by the backend and
+// merged into it. Everything else goes to the backend, after the two or three
+// comparisons it takes to see that the input does not start with a run.
+//
+// Kept to C++03 so that cpp_std_gcc4_3_sort.cpp can use it too.
+
+#include <algorithm>
+#include <cstddef>
+
+namespace run_prepass {
+// Returns the length of the run at the start of data, and sets
+// strictly_descending if it is one. Only strictly descending runs are
+// reversed, so that equal elements keep their order. With a stable backend the
+// result is stable as well.
+template <typename T, typename Compare>
+std::size_t find_existing_run(T* data,
+                              std::size_t len,
+                              Compare& comp,
+                              bool& strictly_descending) {
+  strictly_descending = false;
+  if (len < 2) {
+    return len;
+  }
+
+  std::size_t run_len = 2;
+  strictly_descending = comp(data[1], data[0]);
+  if (strictly_descending) {
+    while (run_len < len && comp(data[run_len], data[run_len - 1])) {
+      run_len += 1;
+    }
+  } else {
+    while (run_len < len && !comp(data[run_len], data[run_len - 1])) {
+      run_len += 1;
+    }
+  }
+
+  return run_len;
+}
+
+// Backend is a type with a static sort(T* begin, T* end, Compare comp), such
+// as the variants of cpp_blockquicksort.cpp.
+template <typename Backend, typename T, typename Compare>
+void sort(T* data, std::size_t len, Compare comp) {
+  bool strictly_descending;
+  const std::size_t run_len =
+      find_existing_run(data, len, comp, strictly_descending);
+
+  if (run_len == len) {
+    if (strictly_descending) {
+      std::reverse(data, data + len);
+    }
+    return;
+  }
+
+  // Below half of the input the merge costs about as much as it saves.
+  if (run_len < len / 2) {
+    Backend::sort(data, data + len, comp);
+    return;
+  }
+
+  if (strictly_descending) {
+    std::reverse(data, data + run_len);
+  }
+  Backend::sort(data + run_len, data + len, comp);
+  std::inplace_merge(data, data + run_len, data + len, comp);
+}
+}  // namespace run_prepass
@@ -3,6 +3,8 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include "sort_usdt.h"
+
 extern "C" {
 struct CompResult {
   int8_t cmp_result;
@@ -15,18 +17,81 @@ struct FFIString {
   size_t capacity;
 };
 
+struct FFIArenaString {
+  uint64_t prefix;  // First 8 bytes as big-endian integer, zero padded.
+  const char* data;
+  size_t len;
+  const void* arena;  // Owned by Rust, never touched by C++.
+};
+
 struct F128 {
   double x;
   double y;
 };
 
+struct F32 {
+  float val;
+};
+
+struct F64 {
+  double val;
+};
+
 struct FFIOneKibiByte {
   int64_t values[128];
 };
+
+// Describes a plain integer key embedded in an element. This allows the C++
+// side to generate a fully inlined comparison function, instead of calling
+// back into Rust for every comparison.
+struct KeyDescriptor {
+  size_t offset;  // Byte offset of the key inside the element.
+  uint8_t width;  // Size of the key in bytes, one of 1, 2, 4 or 8.
+  bool is_signed;
+  bool is_descending;
+};
+
+// One column of a columnar sort, see sort_columns.
+struct ColumnDescriptor {
+  const void* data;  // The values of all rows, of the type given by kind.
+  uint8_t kind;      // One of ColumnKind.
+  bool is_descending;
+  bool is_nan_first;  // Float columns only, regardless of the direction.
+};
+
+// Two field records, ordered by key and then by payload. The integer sorts
+// sort them as single packed words, see sort_packed.
+struct KeyPayloadU32 {
+  uint32_t key;
+  uint32_t payload;
+};
+
+struct alignas(16) KeyPayloadU64 {
+  uint64_t key;
+  uint64_t payload;
+};
+
+// Element operations performed by a single sort, see CountingWrapper.
+struct OpCounts {
+  uint64_t comparisons;
+  uint64_t copies;  // Copy constructions and assignments.
+  uint64_t moves;   // Move constructions and assignments.
+};
 }
 
 #if __cplusplus >= 201703L
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
 #include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <string.h>
+
+#include "key_encoder.h"
 
 // This should have the same layout as FFIString so that it can be
 // reinterpret_cast.
@@ -95,6 +160,38 @@ struct FFIStringCpp : public FFIString {
   }
 };
 
+// Trivially copyable, the Rust side reference counts the arena and C++ sorts
+// only ever permute the values.
+struct FFIArenaStringCpp : public FFIArenaString {
+  // Only valid if both prefixes are equal, in which case the leading bytes
+  // covered by both prefixes are equal as well.
+  int compare_tail(const FFIArenaStringCpp& other) const noexcept {
+    const size_t skip = std::min({len, other.len, size_t{8}});
+    return std::string_view{data + skip, len - skip}.compare(
+        std::string_view{other.data + skip, other.len - skip});
+  }
+
+  bool operator<(const FFIArenaStringCpp& other) const noexcept {
+    if (prefix != other.prefix) {
+      return prefix < other.prefix;
+    }
+    return compare_tail(other) < 0;
+  }
+  bool operator<=(const FFIArenaStringCpp& other) const noexcept {
+    return !(other < *this);
+  }
+  bool operator>(const FFIArenaStringCpp& other) const noexcept {
+    return other < *this;
+  }
+  bool operator>=(const FFIArenaStringCpp& other) const noexcept {
+    return !(*this < other);
+  }
+  bool operator==(const FFIArenaStringCpp& other) const noexcept {
+    return prefix == other.prefix && len == other.len &&
+           compare_tail(other) == 0;
+  }
+};
+
 struct F128Cpp : public F128 {
   double as_div_val() const noexcept { return x / y; }
 
@@ -115,6 +212,63 @@ struct F128Cpp : public F128 {
   }
 };
 
+// All NaNs compare equal and greater than any other value, -0.0 and 0.0
+// compare equal. Same order as F32 and F64 on the Rust side.
+template <typename F>
+struct FloatCpp : public F {
+  using T = decltype(F::val);
+
+  static bool total_less(T a, T b) noexcept {
+    return a < b || (std::isnan(b) && !std::isnan(a));
+  }
+
+  bool operator<(const FloatCpp& other) const noexcept {
+    return total_less(this->val, other.val);
+  }
+  bool operator<=(const FloatCpp& other) const noexcept {
+    return !total_less(other.val, this->val);
+  }
+  bool operator>(const FloatCpp& other) const noexcept {
+    return total_less(other.val, this->val);
+  }
+  bool operator>=(const FloatCpp& other) const noexcept {
+    return !total_less(this->val, other.val);
+  }
+  bool operator==(const FloatCpp& other) const noexcept {
+    return !total_less(this->val, other.val) &&
+           !total_less(other.val, this->val);
+  }
+};
+
+using F32Cpp = FloatCpp<F32>;
+using F64Cpp = FloatCpp<F64>;
+
+// Moves all elements matching pred to the end, returns the number of elements
+// that do not match. The relative order of the remaining prefix is preserved.
+template <typename T, typename F>
+size_t move_to_end(T* data, size_t len, F pred) noexcept {
+  size_t keep_len = 0;
+  while (keep_len < len && !pred(data[keep_len])) {
+    ++keep_len;
+  }
+
+  for (size_t i = keep_len + 1; i < len; ++i) {
+    if (!pred(data[i])) {
+      std::swap(data[keep_len], data[i]);
+      ++keep_len;
+    }
+  }
+
+  return keep_len;
+}
+
+// SIMD float kernels leave the position of NaNs unspecified. Moving them to the
+// end and sorting only the returned prefix yields the order of FloatCpp.
+template <typename T>
+size_t move_nan_to_end(T* data, size_t len) noexcept {
+  return move_to_end(data, len, [](T val) { return std::isnan(val); });
+}
+
 struct FFIOneKiloByteCpp : public FFIOneKibiByte {
   int64_t as_i64() const noexcept {
     return values[11] + values[55] + values[77];
@@ -137,6 +291,9 @@ struct FFIOneKiloByteCpp : public FFIOneKibiByte {
   }
 };
 
+// Only for sorts that can't take a comparator and compare elements with
+// operator< directly. Prefer passing make_compare_fn, the thread locals cost a
+// lookup per comparison and rule out nested sorts of the same T.
 template <typename T, typename F>
 struct CompWrapper {
   // Not a big fan of this approach, but it works.
@@ -178,15 +335,921 @@ auto make_compare_fn(F cmp_fn, uint8_t* ctx) {
   };
 }
 
+// Parallel sorts call the comparison function from worker threads that can't
+// propagate exceptions back to the caller. Instead of throwing, the first panic
+// is recorded in did_panic and every following comparison reports false, and
+// the caller reports the panic once the sort is done. That only finishes
+// without UB in sorts that bound all their loops by iterators, like parallel
+// ips4o and the libstdc++ parallel merge sort that use this. Not safe for
+// sorts with sentinel loops, pdqsort's partition_left for example loops on
+// !comp(pivot, *--last), which never stops once comp only reports false.
+template <typename T, typename F>
+auto make_compare_fn_nothrow(F cmp_fn,
+                             uint8_t* ctx,
+                             std::atomic<bool>& did_panic) {
+  return [cmp_fn, ctx, &did_panic](const T& a, const T& b) noexcept -> bool {
+    if (did_panic.load(std::memory_order_relaxed)) {
+      return false;
+    }
+
+    const auto comp_result = cmp_fn(a, b, ctx);
+
+    if (comp_result.is_panic) {
+      did_panic.store(true, std::memory_order_relaxed);
+      return false;
+    }
+
+    return comp_result.cmp_result == -1;
+  };
+}
+
+// Sequential counterpart of make_compare_fn_nothrow, with a plain bool. Meant
+// for branchless sorts, where the throw of make_compare_fn stands between the
+// comparison and the cmov, and every inlined comparison needs a landing pad.
+// Once did_panic is set cmp_fn isn't called again and every comparison reports
+// false. Only for sorts that bound all their loops by iterators, a sentinel
+// that was established by an earlier answer doesn't hold anymore.
+template <typename T, typename F>
+auto make_compare_fn_flag(F cmp_fn, uint8_t* ctx, bool& did_panic) {
+  return [cmp_fn, ctx, &did_panic](const T& a, const T& b) noexcept -> bool {
+    if (did_panic) {
+      return false;
+    }
+
+    const auto comp_result = cmp_fn(a, b, ctx);
+
+    if (comp_result.is_panic) {
+      did_panic = true;
+      return false;
+    }
+
+    return comp_result.cmp_result == -1;
+  };
+}
+
+// Calls sort_fn(begin, end, comp) with make_compare_fn_flag, returns 1 if
+// cmp_fn panicked and 0 otherwise, like the _by entry points.
+template <typename T, typename F, typename S>
+uint32_t sort_by_flag(T* data,
+                      size_t len,
+                      F cmp_fn,
+                      uint8_t* ctx,
+                      S sort_fn) noexcept {
+  bool did_panic = false;
+  sort_fn(data, data + len, make_compare_fn_flag<T>(cmp_fn, ctx, did_panic));
+
+  return did_panic ? 1 : 0;
+}
+
+// Defines the <PREFIX>_{i32,u64,ffi_string,f128,1k}_by_nothrow entry points,
+// SORT_FN is a generic callable taking a begin and end pointer and a
+// comparison function. Use inside extern "C".
+#define NOTHROW_SORT_BY_IMPL(PREFIX, SORT_FN)                                  \
+  uint32_t PREFIX##_i32_by_nothrow(                                            \
+      int32_t* data, size_t len,                                               \
+      CompResult (*cmp_fn)(const int32_t&, const int32_t&, uint8_t*),          \
+      uint8_t* ctx) {                                                          \
+    SORT_USDT_PROBE(len);                                                      \
+    return sort_by_flag(data, len, cmp_fn, ctx, SORT_FN);                      \
+  }                                                                            \
+  uint32_t PREFIX##_u64_by_nothrow(                                            \
+      uint64_t* data, size_t len,                                              \
+      CompResult (*cmp_fn)(const uint64_t&, const uint64_t&, uint8_t*),        \
+      uint8_t* ctx) {                                                          \
+    SORT_USDT_PROBE(len);                                                      \
+    return sort_by_flag(data, len, cmp_fn, ctx, SORT_FN);                      \
+  }                                                                            \
+  uint32_t PREFIX##_ffi_string_by_nothrow(                                     \
+      FFIString* data, size_t len,                                             \
+      CompResult (*cmp_fn)(const FFIString&, const FFIString&, uint8_t*),      \
+      uint8_t* ctx) {                                                          \
+    SORT_USDT_PROBE(len);                                                      \
+    return sort_by_flag(reinterpret_cast<FFIStringCpp*>(data), len, cmp_fn,    \
+                        ctx, SORT_FN);                                         \
+  }                                                                            \
+  uint32_t PREFIX##_f128_by_nothrow(                                           \
+      F128* data, size_t len,                                                  \
+      CompResult (*cmp_fn)(const F128&, const F128&, uint8_t*),                \
+      uint8_t* ctx) {                                                          \
+    SORT_USDT_PROBE(len);                                                      \
+    return sort_by_flag(reinterpret_cast<F128Cpp*>(data), len, cmp_fn, ctx,    \
+                        SORT_FN);                                              \
+  }                                                                            \
+  uint32_t PREFIX##_1k_by_nothrow(                                             \
+      FFIOneKibiByte* data, size_t len,                                        \
+      CompResult (*cmp_fn)(const FFIOneKibiByte&, const FFIOneKibiByte&,       \
+                           uint8_t*),                                          \
+      uint8_t* ctx) {                                                          \
+    SORT_USDT_PROBE(len);                                                      \
+    return sort_by_flag(reinterpret_cast<FFIOneKiloByteCpp*>(data), len,       \
+                        cmp_fn, ctx, SORT_FN);                                 \
+  }
+
+template <typename T, typename K, bool IS_DESCENDING>
+struct KeyCompare {
+  K key(const T& val) const noexcept {
+    K key_val;
+    memcpy(&key_val, reinterpret_cast<const char*>(&val) + offset, sizeof(K));
+    return key_val;
+  }
+
+  bool operator()(const T& a, const T& b) const noexcept {
+    if constexpr (IS_DESCENDING) {
+      return key(b) < key(a);
+    } else {
+      return key(a) < key(b);
+    }
+  }
+
+  size_t offset;
+};
+
+inline bool is_valid_key_descriptor(KeyDescriptor key, size_t elem_size) {
+  const bool is_valid_width =
+      key.width == 1 || key.width == 2 || key.width == 4 || key.width == 8;
+
+  return is_valid_width && key.offset <= elem_size &&
+         key.width <= elem_size - key.offset;
+}
+
+// Calls sort_fn with the KeyCompare instantiation that matches key. The
+// dispatch happens once per sort, the comparisons themselves are inlined.
+// Returns false if key does not describe a key inside of T.
+template <typename T, typename F>
+bool with_key_compare(KeyDescriptor key, F sort_fn) {
+  if (!is_valid_key_descriptor(key, sizeof(T))) {
+    return false;
+  }
+
+  const auto with_direction = [key, &sort_fn](auto key_type_tag) {
+    using K = decltype(key_type_tag);
+
+    if (key.is_descending) {
+      sort_fn(KeyCompare<T, K, true>{key.offset});
+    } else {
+      sort_fn(KeyCompare<T, K, false>{key.offset});
+    }
+  };
+
+  switch (key.width) {
+    case 1:
+      key.is_signed ? with_direction(int8_t{}) : with_direction(uint8_t{});
+      break;
+    case 2:
+      key.is_signed ? with_direction(int16_t{}) : with_direction(uint16_t{});
+      break;
+    case 4:
+      key.is_signed ? with_direction(int32_t{}) : with_direction(uint32_t{});
+      break;
+    case 8:
+      key.is_signed ? with_direction(int64_t{}) : with_direction(uint64_t{});
+      break;
+  }
+
+  return true;
+}
+
+// --- Caller supplied scratch ---
+
+// The *_with_buf entry points take a caller owned buffer of buf_bytes, so that
+// repeated sorts can reuse one pre-sized allocation. Returns buf as T* if it
+// has room for capacity elements and is suitably aligned, and nullptr
+// otherwise, in which case the sort falls back to allocating internally.
+template <typename T>
+T* scratch_from_buf(uint8_t* buf, size_t buf_bytes, size_t capacity) {
+  static_assert(std::is_trivially_copyable_v<T>);
+
+  const bool is_aligned = reinterpret_cast<uintptr_t>(buf) % alignof(T) == 0;
+  if (buf == nullptr || !is_aligned || buf_bytes / sizeof(T) < capacity) {
+    return nullptr;
+  }
+
+  return reinterpret_cast<T*>(buf);
+}
+
+// --- Operation counting ---
+
+// Counts comparisons, copies and moves of the wrapped T, for the *_counted
+// entry points. The counters are thread local, only sequential sorts are
+// counted correctly. Wrapping makes T non-trivially copyable, so block copies
+// that would otherwise be a memmove are counted per element.
+template <typename T>
+struct CountingWrapper {
+  thread_local static inline OpCounts counts;
+
+  CountingWrapper() = default;
+
+  CountingWrapper(const CountingWrapper& other) : _value{other._value} {
+    ++counts.copies;
+  }
+  CountingWrapper(CountingWrapper&& other) noexcept
+      : _value{std::move(other._value)} {
+    ++counts.moves;
+  }
+
+  CountingWrapper& operator=(const CountingWrapper& other) {
+    _value = other._value;
+    ++counts.copies;
+    return *this;
+  }
+  CountingWrapper& operator=(CountingWrapper&& other) noexcept {
+    _value = std::move(other._value);
+    ++counts.moves;
+    return *this;
+  }
+
+  bool operator<(const CountingWrapper& other) const noexcept {
+    ++counts.comparisons;
+    return _value < other._value;
+  }
+  bool operator<=(const CountingWrapper& other) const noexcept {
+    ++counts.comparisons;
+    return _value <= other._value;
+  }
+  bool operator>(const CountingWrapper& other) const noexcept {
+    ++counts.comparisons;
+    return _value > other._value;
+  }
+  bool operator>=(const CountingWrapper& other) const noexcept {
+    ++counts.comparisons;
+    return _value >= other._value;
+  }
+  bool operator==(const CountingWrapper& other) const noexcept {
+    ++counts.comparisons;
+    return _value == other._value;
+  }
+
+  T _value;
+};
+
+// Calls sort_fn(begin, end) on data viewed as CountingWrapper<T> and writes
+// the operations it performed to counts.
+template <typename T, typename F>
+void sort_counted(T* data, size_t len, OpCounts* counts, F sort_fn) {
+  using W = CountingWrapper<T>;
+  static_assert(sizeof(W) == sizeof(T) && alignof(W) == alignof(T));
+
+  W::counts = OpCounts{};
+  W* begin = reinterpret_cast<W*>(data);
+  sort_fn(begin, begin + len);
+  *counts = W::counts;
+}
+
+// Defines the <PREFIX>_{i32,u64,1k}_counted entry points, SORT_FN is a generic
+// callable taking a begin and end pointer. Use inside extern "C".
+#define COUNTED_SORT_IMPL(PREFIX, SORT_FN)                                   \
+  void PREFIX##_i32_counted(int32_t* data, size_t len, OpCounts* counts) {   \
+    SORT_USDT_PROBE(len);                                                    \
+    sort_counted(data, len, counts, SORT_FN);                                \
+  }                                                                          \
+  void PREFIX##_u64_counted(uint64_t* data, size_t len, OpCounts* counts) {  \
+    SORT_USDT_PROBE(len);                                                    \
+    sort_counted(data, len, counts, SORT_FN);                                \
+  }                                                                          \
+  void PREFIX##_1k_counted(FFIOneKibiByte* data, size_t len,                 \
+                           OpCounts* counts) {                               \
+    SORT_USDT_PROBE(len);                                                    \
+    sort_counted(reinterpret_cast<FFIOneKiloByteCpp*>(data), len, counts,    \
+                 SORT_FN);                                                   \
+  }
+
+// --- Indirect sorting ---
+
+// Moves every element of data to its position in perm, where perm[i] is the
+// source of position i, either as pointer into data or as index. Every cycle of
+// the permutation is followed once, with a single temporary, so every element
+// is moved once and the temporary once per cycle. Resets perm to the identity
+// along the way, as marker for the finished positions.
+template <typename T, typename P>
+void apply_permutation(T* data, P* perm, size_t len) {
+  const auto src_of = [data, perm](size_t dst) -> size_t {
+    if constexpr (std::is_pointer_v<P>) {
+      return static_cast<size_t>(perm[dst] - data);
+    } else {
+      return static_cast<size_t>(perm[dst]);
+    }
+  };
+  const auto mark_done = [data, perm](size_t dst) {
+    if constexpr (std::is_pointer_v<P>) {
+      perm[dst] = data + dst;
+    } else {
+      perm[dst] = static_cast<P>(dst);
+    }
+  };
+
+  for (size_t i = 0; i < len; ++i) {
+    if (src_of(i) == i) {
+      continue;
+    }
+
+    T tmp = std::move(data[i]);
+    size_t dst = i;
+    while (true) {
+      const size_t src = src_of(dst);
+      mark_done(dst);
+      if (src == i) {
+        break;
+      }
+
+      data[dst] = std::move(data[src]);
+      dst = src;
+    }
+    data[dst] = std::move(tmp);
+  }
+}
+
+// Sorts data by calling sort_fn(begin, end, comp) on an array of pointers to
+// its elements, where comp compares the pointed to elements, and then moves the
+// elements into place with apply_permutation. A stable sort_fn keeps equal
+// elements in their original order, the pointers start out in address order.
+// Takes len pointers of scratch memory.
+//
+// Every comparison is an indirect load, which only pays off once moving the
+// elements costs more than that. With std::sort and pdqsort on random input of
+// 1e4 and 1e5 elements, that's from an element size of 512 bytes on, 256 byte
+// elements are still about 10% slower. 1k elements sort about 1.7x faster.
+template <typename T, typename F>
+void sort_indirect(T* data, size_t len, F sort_fn) {
+  if (len < 2) {
+    return;
+  }
+
+  std::vector<T*> ptrs(len);
+  for (size_t i = 0; i < len; ++i) {
+    ptrs[i] = data + i;
+  }
+
+  sort_fn(ptrs.data(), ptrs.data() + len,
+          [](const T* a, const T* b) { return *a < *b; });
+
+  apply_permutation(data, ptrs.data(), len);
+}
+
+// Defines the <PREFIX>_1k_indirect entry point, SORT_FN is a generic callable
+// taking a begin and end pointer and a comparator. Use inside extern "C".
+#define INDIRECT_SORT_IMPL(PREFIX, SORT_FN)                                   \
+  void PREFIX##_1k_indirect(FFIOneKibiByte* data, size_t len) {               \
+    SORT_USDT_PROBE(len);                                                     \
+    sort_indirect(reinterpret_cast<FFIOneKiloByteCpp*>(data), len, SORT_FN); \
+  }
+
+// --- Decorated sorting ---
+
+// Maps the order of the key onto the order of the returned unsigned integer.
+// Negative doubles have all bits flipped, positive ones only the sign bit.
+inline uint64_t sortable_key_bits(double key) noexcept {
+  // -0.0 and 0.0 compare equal, adding 0.0 turns -0.0 into 0.0. The order
+  // of NaNs is unspecified, same as for the comparison based sorts.
+  const double normalized = key + 0.0;
+  uint64_t bits;
+  memcpy(&bits, &normalized, sizeof(bits));
+
+  return bits ^ ((bits >> 63) != 0 ? ~uint64_t{0} : uint64_t{1} << 63);
+}
+
+inline uint64_t sortable_key_bits(int64_t key) noexcept {
+  return static_cast<uint64_t>(key) ^ (uint64_t{1} << 63);
+}
+
+// The key the comparison of F128Cpp and FFIOneKiloByteCpp is based on, as
+// sortable bits.
+inline uint64_t sortable_key_bits(const F128Cpp& val) noexcept {
+  return sortable_key_bits(val.as_div_val());
+}
+
+inline uint64_t sortable_key_bits(const FFIOneKiloByteCpp& val) noexcept {
+  return sortable_key_bits(val.as_i64());
+}
+
+// Decorate-sort-undecorate. Computes the key of every element once, calls
+// sort_pairs(keys, indices, len) to put the indices, which start out as 0..len,
+// in the order of their keys, and moves the elements into place with
+// apply_permutation. sort_pairs may leave keys in any state. The order is exactly the order
+// of operator<, the comparisons of the sort no longer recompute the key or
+// touch the elements. Equal keys keep their original order if sort_pairs is
+// stable. Takes 16 bytes of scratch memory per element.
+template <typename T, typename F>
+void sort_decorated(T* data, size_t len, F sort_pairs) {
+  if (len < 2) {
+    return;
+  }
+
+  std::vector<uint64_t> keys(len);
+  std::vector<uint64_t> indices(len);
+  for (size_t i = 0; i < len; ++i) {
+    keys[i] = sortable_key_bits(data[i]);
+    indices[i] = i;
+  }
+
+  sort_pairs(keys.data(), indices.data(), len);
+
+  apply_permutation(data, indices.data(), len);
+}
+
+// Defines the <PREFIX>_{f128,1k}_decorated entry points, SORT_PAIRS_FN is a
+// callable taking a uint64_t array of keys, a uint64_t array of indices and
+// len. Use inside extern "C".
+#define DECORATED_SORT_IMPL(PREFIX, SORT_PAIRS_FN)                        \
+  void PREFIX##_f128_decorated(F128* data, size_t len) {                  \
+    SORT_USDT_PROBE(len);                                                 \
+    sort_decorated(reinterpret_cast<F128Cpp*>(data), len, SORT_PAIRS_FN); \
+  }                                                                       \
+  void PREFIX##_1k_decorated(FFIOneKibiByte* data, size_t len) {          \
+    SORT_USDT_PROBE(len);                                                 \
+    sort_decorated(reinterpret_cast<FFIOneKiloByteCpp*>(data), len,       \
+                   SORT_PAIRS_FN);                                        \
+  }
+
+// --- Packed key sorting ---
+
+// Maps an integer field onto an unsigned integer of the same width with the
+// same order, and back. Signed fields get their sign bit flipped.
+template <typename F>
+std::make_unsigned_t<F> packed_field_bits(F field) noexcept {
+  using U = std::make_unsigned_t<F>;
+  constexpr U kFlip = std::is_signed_v<F> ? U{1} << (sizeof(U) * 8 - 1) : 0;
+  return static_cast<U>(field) ^ kFlip;
+}
+
+template <typename F>
+F unpacked_field(std::make_unsigned_t<F> bits) noexcept {
+  using U = std::make_unsigned_t<F>;
+  constexpr U kFlip = std::is_signed_v<F> ? U{1} << (sizeof(U) * 8 - 1) : 0;
+  return static_cast<F>(static_cast<U>(bits ^ kFlip));
+}
+
+// Recognizes records T with integer members key and payload, that together
+// fit into a single uint64_t or unsigned __int128 Word, and packs them with
+// the key in the high bits. The order of the words is the order of key and
+// then payload, any integer sort can sort the words in place of the records.
+// Floats are left out, their order preserving bits don't round trip -0.0.
+template <typename T, typename = void>
+struct PackedRecord {
+  static constexpr bool kIsPackable = false;
+};
+
+template <typename T>
+struct PackedRecord<
+    T,
+    std::enable_if_t<std::is_trivially_copyable_v<T> &&
+                     std::is_integral_v<decltype(T::key)> &&
+                     std::is_integral_v<decltype(T::payload)> &&
+                     !std::is_same_v<decltype(T::key), bool> &&
+                     !std::is_same_v<decltype(T::payload), bool> &&
+                     sizeof(T::key) + sizeof(T::payload) <= 16>> {
+  using Key = decltype(T::key);
+  using Payload = decltype(T::payload);
+  using Word = std::conditional_t<sizeof(Key) + sizeof(Payload) <= 8,
+                                  uint64_t,
+                                  unsigned __int128>;
+
+  static constexpr bool kIsPackable = true;
+  static constexpr int kPayloadBits = sizeof(Payload) * 8;
+
+  static Word pack(const T& record) noexcept {
+    return (static_cast<Word>(packed_field_bits(record.key)) << kPayloadBits) |
+           static_cast<Word>(packed_field_bits(record.payload));
+  }
+
+  static void unpack(Word word, T& record) noexcept {
+    using PayloadBits = std::make_unsigned_t<Payload>;
+    record.key = unpacked_field<Key>(
+        static_cast<std::make_unsigned_t<Key>>(word >> kPayloadBits));
+    record.payload = unpacked_field<Payload>(static_cast<PayloadBits>(word));
+  }
+};
+
+// Sorts records recognized by PackedRecord by calling sort_words(words, len)
+// on their packed words. Records of the same size and alignment as Word are
+// packed in place, others go through a buffer of len words. The result is the
+// same as sorting by key and then payload with a comparison, but the sort
+// runs on plain integers, eg. with the SIMD kernels of vqsort.
+template <typename T, typename F>
+void sort_packed(T* data, size_t len, F sort_words) {
+  using Packed = PackedRecord<T>;
+  static_assert(Packed::kIsPackable, "Record can't be packed into a word");
+  using Word = typename Packed::Word;
+
+  if (len < 2) {
+    return;
+  }
+
+  if constexpr (sizeof(T) == sizeof(Word) && alignof(T) >= alignof(Word)) {
+    Word* words = reinterpret_cast<Word*>(data);
+    for (size_t i = 0; i < len; ++i) {
+      const Word word = Packed::pack(data[i]);
+      memcpy(words + i, &word, sizeof(Word));
+    }
+
+    sort_words(words, len);
+
+    for (size_t i = 0; i < len; ++i) {
+      Word word;
+      memcpy(&word, words + i, sizeof(Word));
+      Packed::unpack(word, data[i]);
+    }
+  } else {
+    std::vector<Word> words(len);
+    for (size_t i = 0; i < len; ++i) {
+      words[i] = Packed::pack(data[i]);
+    }
+
+    sort_words(words.data(), len);
+
+    for (size_t i = 0; i < len; ++i) {
+      Packed::unpack(words[i], data[i]);
+    }
+  }
+}
+
+// Defines the <PREFIX>_key_payload_u32_packed entry point, SORT_U64_FN is a
+// callable taking a uint64_t array and len. Use inside extern "C".
+#define PACKED_SORT_IMPL_U64(PREFIX, SORT_U64_FN)                             \
+  void PREFIX##_key_payload_u32_packed(KeyPayloadU32* data, size_t len) {     \
+    SORT_USDT_PROBE(len);                                                     \
+    sort_packed(data, len, SORT_U64_FN);                                      \
+  }
+
+// Same as PACKED_SORT_IMPL_U64, plus <PREFIX>_key_payload_u64_packed sorted
+// with SORT_U128_FN, a callable taking an unsigned __int128 array and len.
+#define PACKED_SORT_IMPL_U128(PREFIX, SORT_U64_FN, SORT_U128_FN)              \
+  PACKED_SORT_IMPL_U64(PREFIX, SORT_U64_FN)                                   \
+  void PREFIX##_key_payload_u64_packed(KeyPayloadU64* data, size_t len) {     \
+    SORT_USDT_PROBE(len);                                                     \
+    sort_packed(data, len, SORT_U128_FN);                                     \
+  }
+
+// --- Columnar sorting ---
+
+enum class ColumnKind : uint8_t {
+  U32 = 0,
+  U64 = 1,
+  I32 = 2,
+  I64 = 3,
+  String = 4,  // FFIString
+  F32 = 5,
+  F64 = 6,
+};
+
+// A column of sort_columns and encode_columns, in the order of the
+// normalized keys of key_encoder.h.
+class SortColumn {
+ public:
+  // Returns false if desc.kind is not a ColumnKind.
+  bool init(ColumnDescriptor desc) noexcept {
+    if (desc.kind > static_cast<uint8_t>(ColumnKind::F64)) {
+      return false;
+    }
+
+    _data = desc.data;
+    _kind = static_cast<ColumnKind>(desc.kind);
+    _is_descending = desc.is_descending;
+    _nan_order = desc.is_nan_first ? key_encoder::NanOrder::First
+                                   : key_encoder::NanOrder::Last;
+    return true;
+  }
+
+  bool is_string() const noexcept { return _kind == ColumnKind::String; }
+
+  // Adds the column as the next field, strings with a prefix of
+  // string_prefix_bytes.
+  template <typename Word>
+  void add_to(key_encoder::KeyEncoder<Word>& encoder,
+              size_t string_prefix_bytes) const {
+    switch (_kind) {
+      case ColumnKind::U32:
+        encoder.add_int(static_cast<const uint32_t*>(_data), _is_descending);
+        break;
+      case ColumnKind::U64:
+        encoder.add_int(static_cast<const uint64_t*>(_data), _is_descending);
+        break;
+      case ColumnKind::I32:
+        encoder.add_int(static_cast<const int32_t*>(_data), _is_descending);
+        break;
+      case ColumnKind::I64:
+        encoder.add_int(static_cast<const int64_t*>(_data), _is_descending);
+        break;
+      case ColumnKind::String:
+        encoder.add_string_prefix(static_cast<const FFIString*>(_data),
+                                  string_prefix_bytes, _is_descending);
+        break;
+      case ColumnKind::F32:
+        encoder.add_float(static_cast<const float*>(_data), _is_descending,
+                          _nan_order);
+        break;
+      case ColumnKind::F64:
+        encoder.add_float(static_cast<const double*>(_data), _is_descending,
+                          _nan_order);
+        break;
+    }
+  }
+
+  // Three-way comparison of two rows.
+  int compare(size_t a, size_t b) const noexcept {
+    int result;
+    if (is_string()) {
+      const FFIString* strs = static_cast<const FFIString*>(_data);
+      const std::string_view str_a{strs[a].data, strs[a].len};
+      const std::string_view str_b{strs[b].data, strs[b].len};
+      const int cmp = str_a.compare(str_b);
+      result = (cmp > 0) - (cmp < 0);
+      result = _is_descending ? -result : result;
+    } else {
+      const uint64_t key_a = number_key(a);
+      const uint64_t key_b = number_key(b);
+      result = (key_a > key_b) - (key_a < key_b);
+    }
+
+    return result;
+  }
+
+ private:
+  uint64_t number_key(size_t row) const noexcept {
+    switch (_kind) {
+      case ColumnKind::U32:
+        return value_key(static_cast<const uint32_t*>(_data)[row]);
+      case ColumnKind::U64:
+        return value_key(static_cast<const uint64_t*>(_data)[row]);
+      case ColumnKind::I32:
+        return value_key(static_cast<const int32_t*>(_data)[row]);
+      case ColumnKind::I64:
+        return value_key(static_cast<const int64_t*>(_data)[row]);
+      case ColumnKind::F32:
+        return value_key(static_cast<const float*>(_data)[row]);
+      case ColumnKind::F64:
+        return value_key(static_cast<const double*>(_data)[row]);
+      case ColumnKind::String:
+        break;
+    }
+    return 0;
+  }
+
+  template <typename T>
+  uint64_t value_key(T value) const noexcept {
+    return key_encoder::ordered_key(value, _is_descending, _nan_order);
+  }
+
+  const void* _data = nullptr;
+  ColumnKind _kind = ColumnKind::U32;
+  bool _is_descending = false;
+  key_encoder::NanOrder _nan_order = key_encoder::NanOrder::Last;
+};
+
+// Reads the column descriptors and adds the columns to encoder, up to the
+// first string column, after which the key can't decide the order. Returns
+// false if a column descriptor is invalid.
+template <typename Word>
+bool init_columns(const ColumnDescriptor* descs,
+                  size_t n_columns,
+                  size_t string_prefix_bytes,
+                  std::vector<SortColumn>& columns,
+                  key_encoder::KeyEncoder<Word>& encoder) {
+  columns.resize(n_columns);
+  for (size_t col = 0; col < n_columns; ++col) {
+    if (!columns[col].init(descs[col])) {
+      return false;
+    }
+  }
+
+  for (const SortColumn& column : columns) {
+    column.add_to(encoder, string_prefix_bytes);
+    if (column.is_string()) {
+      break;
+    }
+  }
+
+  return true;
+}
+
+// Sorts the rows of a columnar table lexicographically by the given columns,
+// without materializing the rows. Writes the row indices in sorted order to
+// perm, which needs room for len values. Returns false if a column
+// descriptor is invalid.
+//
+// The leading columns are encoded into one normalized uint64_t key per row,
+// each integer and float column with as many bits as the range of its values
+// needs, see KeyEncoder, and sorted with sort_pairs(keys, indices, len), see
+// sort_decorated. The encoding stops at the first column that doesn't fit
+// into the remaining bits, of which it only gets the most significant ones,
+// or at the first string column, which gets as many of its leading bytes as
+// fit. Only rows whose keys are equal are then compared column by column,
+// from that column on. Ties are broken by row index, with a stable
+// sort_pairs the whole sort is stable.
+template <typename F>
+bool sort_columns(const ColumnDescriptor* descs,
+                  size_t n_columns,
+                  size_t len,
+                  uint64_t* perm,
+                  F sort_pairs) {
+  std::vector<SortColumn> columns;
+  key_encoder::KeyEncoder<uint64_t> encoder;
+  if (!init_columns(descs, n_columns, sizeof(uint64_t), columns, encoder)) {
+    return false;
+  }
+
+  for (size_t row = 0; row < len; ++row) {
+    perm[row] = row;
+  }
+  if (len < 2) {
+    return true;
+  }
+
+  encoder.compress(len);
+  const size_t tie_col = encoder.fit();
+
+  std::vector<uint64_t> keys(len);
+  encoder.encode(len, keys.data());
+
+  sort_pairs(keys.data(), perm, len);
+
+  if (tie_col == n_columns) {
+    return true;
+  }
+
+  const auto row_less = [&columns, tie_col, n_columns](uint64_t a,
+                                                       uint64_t b) {
+    for (size_t col = tie_col; col < n_columns; ++col) {
+      const int result = columns[col].compare(a, b);
+      if (result != 0) {
+        return result < 0;
+      }
+    }
+    return a < b;
+  };
+
+  // sort_pairs may leave keys in any state, they are computed once more.
+  size_t run_start = 0;
+  uint64_t run_key = encoder.encode_row(perm[0]);
+  for (size_t i = 1; i <= len; ++i) {
+    const uint64_t key = i < len ? encoder.encode_row(perm[i]) : 0;
+    if (i == len || key != run_key) {
+      if (i - run_start > 1) {
+        std::sort(perm + run_start, perm + i, row_less);
+      }
+      run_start = i;
+      run_key = key;
+    }
+  }
+
+  return true;
+}
+
+// Encodes the leading columns into one normalized key per row, as
+// sort_columns does, for sorting them with any integer sort. Returns the
+// first column that is not fully part of the keys, n_columns if all are, or
+// SIZE_MAX if a column descriptor is invalid.
+template <typename Word>
+size_t encode_columns(const ColumnDescriptor* descs,
+                      size_t n_columns,
+                      size_t len,
+                      Word* out) {
+  std::vector<SortColumn> columns;
+  key_encoder::KeyEncoder<Word> encoder;
+  if (!init_columns(descs, n_columns, sizeof(Word), columns, encoder)) {
+    return SIZE_MAX;
+  }
+
+  encoder.compress(len);
+  const size_t tie_col = encoder.fit();
+  encoder.encode(len, out);
+
+  return tie_col;
+}
+
+// Encodes the leading columns into key_bytes big-endian bytes per row, whose
+// memcmp order is the order of the rows. Integers and floats keep their full
+// width, strings string_prefix_bytes bytes. Writes the key width to
+// key_bytes, and the keys to out unless it's null. Returns as encode_columns.
+inline size_t encode_columns_bytes(const ColumnDescriptor* descs,
+                                   size_t n_columns,
+                                   size_t len,
+                                   size_t string_prefix_bytes,
+                                   uint8_t* out,
+                                   size_t* key_bytes) {
+  std::vector<SortColumn> columns;
+  key_encoder::KeyEncoder<uint64_t> encoder;
+  if (!init_columns(descs, n_columns, string_prefix_bytes, columns,
+                    encoder)) {
+    return SIZE_MAX;
+  }
+
+  *key_bytes = encoder.key_bytes();
+  if (out != nullptr) {
+    encoder.encode_bytes(len, out);
+  }
+
+  size_t tie_col = 0;
+  while (tie_col < n_columns && !columns[tie_col].is_string()) {
+    ++tie_col;
+  }
+  return tie_col;
+}
+
+// Defines the <PREFIX>_sort_columns entry point, SORT_PAIRS_FN as for
+// DECORATED_SORT_IMPL, and the <PREFIX>_encode_columns_{u64,u128,bytes} entry
+// points. sort_columns returns 0 on success and 1 for an invalid column
+// descriptor. Use inside extern "C".
+#define COLUMNAR_SORT_IMPL(PREFIX, SORT_PAIRS_FN)                           \
+  uint32_t PREFIX##_sort_columns(const ColumnDescriptor* columns,           \
+                                 size_t n_columns, size_t len,              \
+                                 uint64_t* perm) {                          \
+    SORT_USDT_PROBE(len);                                                   \
+    return sort_columns(columns, n_columns, len, perm, SORT_PAIRS_FN) ? 0   \
+                                                                      : 1;  \
+  }                                                                         \
+                                                                            \
+  size_t PREFIX##_encode_columns_u64(const ColumnDescriptor* columns,       \
+                                     size_t n_columns, size_t len,          \
+                                     uint64_t* out) {                       \
+    SORT_USDT_PROBE(len);                                                   \
+    return encode_columns(columns, n_columns, len, out);                    \
+  }                                                                         \
+                                                                            \
+  size_t PREFIX##_encode_columns_u128(const ColumnDescriptor* columns,      \
+                                      size_t n_columns, size_t len,         \
+                                      unsigned __int128* out) {             \
+    SORT_USDT_PROBE(len);                                                   \
+    return encode_columns(columns, n_columns, len, out);                    \
+  }                                                                         \
+                                                                            \
+  size_t PREFIX##_encode_columns_bytes(                                     \
+      const ColumnDescriptor* columns, size_t n_columns, size_t len,        \
+      size_t string_prefix_bytes, uint8_t* out, size_t* key_bytes) {        \
+    SORT_USDT_PROBE(len);                                                   \
+    return encode_columns_bytes(columns, n_columns, len,                    \
+                                string_prefix_bytes, out, key_bytes);       \
+  }
+
+// --- Partition ---
+
+// The <PREFIX>_partition_<type> entry points reorder data such that the
+// elements less than pivot come first, and return their number. pivot is not
+// part of data.
+
+// Adapts a partition that expects its pivot at data[0] and returns the final
+// position of it, like the ones inside of quicksorts. A copy of pivot
+// temporarily takes the place of data[0], and that element fills its final
+// position afterwards.
+template <typename T, typename F>
+size_t partition_with_pivot_at_begin(T* data,
+                                     size_t len,
+                                     const T& pivot,
+                                     F partition_fn) {
+  static_assert(std::is_trivially_copyable_v<T>);
+
+  if (len == 0) {
+    return 0;
+  }
+
+  const T displaced = data[0];
+  data[0] = pivot;
+
+  const size_t pivot_pos = partition_fn(data, len);
+  data[pivot_pos] = displaced;
+
+  return pivot_pos + static_cast<size_t>(displaced < pivot);
+}
+
+// Adapts a partition that puts the elements less than or equal to its pivot
+// first. For integers, the ones less than or equal to pivot - 1 are the ones
+// less than pivot.
+template <typename T, typename F>
+size_t partition_le_as_lt(T* data, size_t len, T pivot, F partition_le_fn) {
+  static_assert(std::is_integral_v<T>);
+
+  if (pivot == std::numeric_limits<T>::min()) {
+    return 0;
+  }
+
+  return partition_le_fn(data, len, static_cast<T>(pivot - 1));
+}
+
 // --- C ---
 
+// Calls sort_fn(slice, slice_len) for each of the n_slices slices
+// data[offsets[i]..offsets[i + 1]]. Slices with less than two elements are
+// skipped, batches are typically dominated by tiny slices.
+template <typename T, typename F>
+void sort_slices(T* data, const size_t* offsets, size_t n_slices, F sort_fn) {
+  for (size_t i = 0; i < n_slices; ++i) {
+    const size_t slice_len = offsets[i + 1] - offsets[i];
+    if (slice_len >= 2) {
+      sort_fn(data + offsets[i], slice_len);
+    }
+  }
+}
+
 typedef int CMPFUNC(const void* a, const void* b);
 
 template <typename T>
-CMPFUNC* make_compare_fn_c(CompResult (*cmp_fn)(const T&, const T&, uint8_t*),
-                           uint8_t* ctx) {
-  thread_local static CompResult (*cmp_fn_local)(const T&, const T&, uint8_t*) =
-      nullptr;
+using c_cmp_fn_ptr_t = CompResult (*)(const T&, const T&, uint8_t*);
+
+// Copies both values out of the sort buffer before calling the comparison
+// function. That's free for small types, but for FFIOneKibiByte it would be
+// 2KiB of memcpy per comparison.
+template <typename T>
+CMPFUNC* make_compare_fn_c_by_value(c_cmp_fn_ptr_t<T> cmp_fn, uint8_t* ctx) {
+  thread_local static c_cmp_fn_ptr_t<T> cmp_fn_local = nullptr;
   thread_local static uint8_t* ctx_local = nullptr;
 
   cmp_fn_local = cmp_fn;
@@ -206,6 +1269,84 @@ CMPFUNC* make_compare_fn_c(CompResult (*cmp_fn)(const T&, const T&, uint8_t*),
   };
 }
 
+// Passes the elements in-place to the comparison function, which takes them by
+// reference anyway.
+template <typename T>
+CMPFUNC* make_compare_fn_c_by_ref(c_cmp_fn_ptr_t<T> cmp_fn, uint8_t* ctx) {
+  thread_local static c_cmp_fn_ptr_t<T> cmp_fn_local = nullptr;
+  thread_local static uint8_t* ctx_local = nullptr;
+
+  cmp_fn_local = cmp_fn;
+  ctx_local = ctx;
+
+  return [](const void* a_ptr, const void* b_ptr) -> int {
+    const T& a = *static_cast<const T*>(a_ptr);
+    const T& b = *static_cast<const T*>(b_ptr);
+
+    const auto comp_result = cmp_fn_local(a, b, ctx_local);
+
+    if (comp_result.is_panic) {
+      throw std::runtime_error{"panic in Rust comparison function"};
+    }
+
+    return comp_result.cmp_result;
+  };
+}
+
+// Largest element size that is still copied into a local before comparison.
+static constexpr size_t C_CMP_BY_VALUE_MAX_SIZE = sizeof(uint64_t);
+
+// Picks the adapter based on the element size at compile time. Keeping the
+// by value version for word sized types, keeps the code-gen for the i32 and
+// u64 benchmarks the same as before, everything larger avoids the copies.
+template <typename T>
+CMPFUNC* make_compare_fn_c(c_cmp_fn_ptr_t<T> cmp_fn, uint8_t* ctx) {
+  if constexpr (sizeof(T) <= C_CMP_BY_VALUE_MAX_SIZE) {
+    return make_compare_fn_c_by_value<T>(cmp_fn, ctx);
+  } else {
+    return make_compare_fn_c_by_ref<T>(cmp_fn, ctx);
+  }
+}
+
+// Comparison function and context for c_compare_fn_r.
+template <typename T>
+struct CCompareCtx {
+  c_cmp_fn_ptr_t<T> cmp_fn;
+  uint8_t* ctx;
+};
+
+// Context carrying counterpart of make_compare_fn_c, for C sorts with a qsort_r
+// style interface that pass a CCompareCtx<T> as arg. Nothing is kept in thread
+// locals, so any number of these sorts can run concurrently, even on the same
+// thread.
+template <typename T>
+int c_compare_fn_r(const void* a_ptr, const void* b_ptr, void* arg) {
+  using Elem = std::conditional_t<sizeof(T) <= C_CMP_BY_VALUE_MAX_SIZE, const T,
+                                  const T&>;
+
+  const auto* cmp_ctx = static_cast<const CCompareCtx<T>*>(arg);
+  Elem a = *static_cast<const T*>(a_ptr);
+  Elem b = *static_cast<const T*>(b_ptr);
+
+  const auto comp_result = cmp_ctx->cmp_fn(a, b, cmp_ctx->ctx);
+
+  if (comp_result.is_panic) {
+    throw std::runtime_error{"panic in Rust comparison function"};
+  }
+
+  return comp_result.cmp_result;
+}
+
+// qsort_r style three-way comparison of two TCpp records with their operator<,
+// for the record instantiations of the C sorts. arg is unused.
+template <typename TCpp>
+int record_compare_fn_r(const void* a_ptr, const void* b_ptr, void*) {
+  const auto& a = *static_cast<const TCpp*>(a_ptr);
+  const auto& b = *static_cast<const TCpp*>(b_ptr);
+
+  return (b < a) - (a < b);
+}
+
 template <typename T>
 int int_cmp_func(const void* a_ptr, const void* b_ptr) {
   const T a = *static_cast<const T*>(a_ptr);
@@ -229,6 +1370,18 @@ int int_cmp_func(const void* a_ptr, const void* b_ptr) {
   return (is_less * -1) + (is_more * 1);
 }
 
+// qsort moves elements with memcpy style swaps, so any trivially copyable type
+// works. Compares in-place without copying the elements.
+template <typename T>
+int cpp_type_cmp_func(const void* a_ptr, const void* b_ptr) {
+  const T& a = *static_cast<const T*>(a_ptr);
+  const T& b = *static_cast<const T*>(b_ptr);
+
+  const bool is_less = a < b;
+  const bool is_more = a > b;
+  return (is_less * -1) + (is_more * 1);
+}
+
 // This is broken, crumsort and fluxsort break the individual F128 values.
 //
 // static constexpr bool F128_SUPPORT = sizeof(F128) == sizeof(long double) &&
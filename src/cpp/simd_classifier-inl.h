@@ -0,0 +1,59 @@
+// Included once per instruction set by simd_classifier.h, inside a namespace
+// compiled for that target, so that the intrinsics of Ops inline into the loop.
+// No include guard on purpose.
+
+// Buckets are computed as in the scalar classifier, starting at node 1 every
+// level doubles the node index and adds 1 if the splitter is less than the
+// element. With equal buckets, a last step adds 1 if the element is not less
+// than its upper splitter. Ops provides the lanes and the comparisons.
+template <typename Ops, int kLogBuckets, bool kEqualBuckets, typename T,
+          typename Yield>
+inline T* classify_blocks(const T* tree,
+                          const T* sorted,
+                          T* begin,
+                          T* end,
+                          Yield& yield) {
+  using V = typename Ops::V;
+  using Lane = typename Ops::Lane;
+  constexpr int kUnroll = Ops::kUnroll;
+  constexpr ptrdiff_t kBlock = Ops::kLanes * kUnroll;
+  constexpr Lane kNumBuckets = Lane{1} << (kLogBuckets + kEqualBuckets);
+
+  const V root = Ops::set1(tree[1]);
+  const V one = Ops::broadcast(1);
+  alignas(64) Lane buckets[kBlock];
+
+  for (; end - begin >= kBlock; begin += kBlock) {
+    V values[kUnroll];
+    V nodes[kUnroll];
+    for (int i = 0; i < kUnroll; ++i) {
+      values[i] = Ops::load(begin + i * Ops::kLanes);
+      nodes[i] = Ops::descend(one, root, values[i]);
+    }
+
+    for (int level = 1; level < kLogBuckets; ++level) {
+      for (int i = 0; i < kUnroll; ++i) {
+        nodes[i] =
+            Ops::descend(nodes[i], Ops::gather(tree, nodes[i]), values[i]);
+      }
+    }
+
+    if constexpr (kEqualBuckets) {
+      const V leaf_offset = Ops::broadcast(kNumBuckets / 2);
+      for (int i = 0; i < kUnroll; ++i) {
+        const V upper =
+            Ops::gather(sorted, Ops::sub(nodes[i], leaf_offset));
+        nodes[i] = Ops::descend_not_less(nodes[i], upper, values[i]);
+      }
+    }
+
+    for (int i = 0; i < kUnroll; ++i) {
+      Ops::store(buckets + i * Ops::kLanes, nodes[i]);
+    }
+    for (ptrdiff_t i = 0; i < kBlock; ++i) {
+      yield(buckets[i] - kNumBuckets, begin + i);
+    }
+  }
+
+  return begin;
+}
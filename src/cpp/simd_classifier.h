@@ -0,0 +1,235 @@
+#pragma once
+
+// Vectorized classification for ips4o. The scalar classifier walks the
+// implicit splitter tree of every element with one load and comparison per
+// level, kUnrollClassifier elements interleaved. For i32 and u64 elements
+// sorted with the natural order this walks 8 or 16 elements per vector
+// instead, a gather fetches the next splitter of every lane and a vector
+// comparison picks the child. Several vectors are interleaved to hide the
+// latency of the gathers. The first level is a broadcast of the root. u64 is
+// only vectorized with AVX-512.
+//
+// Wrappers opt in by defining IPS4O_SIMD_CLASSIFIER, see the
+// cpp_ips4o_simd_classifier feature. The classifier calls classify in front of
+// its unrolled scalar loop, which then only classifies the remainder, and
+// everything the vector versions don't cover.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <type_traits>
+
+#include "cpu_features.h"
+#include "small_sort_network.h"
+
+#if SORT_ARCH_X86
+#include <immintrin.h>
+#endif
+
+namespace simd_classifier {
+
+template <typename It, typename Compare>
+struct is_supported : std::false_type {};
+
+template <typename T, typename Compare>
+struct is_supported<T*, Compare>
+    : std::bool_constant<
+          small_sort_network::is_natural_less<Compare, T>::value &&
+          (std::is_same_v<T, int32_t> || std::is_same_v<T, uint64_t>)> {};
+
+#if SORT_ARCH_X86
+namespace detail {
+
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx2"))), \
+                             apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#endif
+namespace avx2 {
+#include "simd_classifier-inl.h"
+
+struct Avx2I32 {
+  using V = __m256i;
+  using Lane = int32_t;
+  static constexpr int kLanes = 8;
+  static constexpr int kUnroll = 8;
+
+  static V broadcast(Lane lane) { return _mm256_set1_epi32(lane); }
+  static V set1(int32_t splitter) { return _mm256_set1_epi32(splitter); }
+  static V load(const int32_t* ptr) {
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr));
+  }
+  static V gather(const int32_t* base, V index) {
+    return _mm256_i32gather_epi32(base, index, 4);
+  }
+  static V sub(V a, V b) { return _mm256_sub_epi32(a, b); }
+  // 2 * node + (splitter < value), the comparison is -1 if true.
+  static V descend(V node, V splitter, V value) {
+    return _mm256_sub_epi32(_mm256_add_epi32(node, node),
+                            _mm256_cmpgt_epi32(value, splitter));
+  }
+  // 2 * node + !(value < splitter).
+  static V descend_not_less(V node, V splitter, V value) {
+    const V doubled = _mm256_add_epi32(node, node);
+    return _mm256_add_epi32(_mm256_add_epi32(doubled, broadcast(1)),
+                            _mm256_cmpgt_epi32(splitter, value));
+  }
+  static void store(Lane* ptr, V node) {
+    _mm256_store_si256(reinterpret_cast<__m256i*>(ptr), node);
+  }
+};
+
+template <int kLogBuckets, bool kEqualBuckets, typename Yield>
+inline int32_t* classify(const int32_t* tree,
+                         const int32_t* sorted,
+                         int32_t* begin,
+                         int32_t* end,
+                         Yield& yield) {
+  return classify_blocks<Avx2I32, kLogBuckets, kEqualBuckets>(
+      tree, sorted, begin, end, yield);
+}
+}  // namespace avx2
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+
+#if defined(__clang__)
+#pragma clang attribute push(                                   \
+    __attribute__((target("avx2,avx512f,avx512dq,avx512vl"))), \
+    apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("avx2,avx512f,avx512dq,avx512vl")
+#endif
+namespace avx512 {
+#include "simd_classifier-inl.h"
+
+// The comparisons produce masks, descending adds 1 to the doubled node of
+// every lane whose bit is set.
+struct Avx512I32 {
+  using V = __m512i;
+  using Lane = int32_t;
+  static constexpr int kLanes = 16;
+  static constexpr int kUnroll = 8;
+
+  static V broadcast(Lane lane) { return _mm512_set1_epi32(lane); }
+  static V set1(int32_t splitter) { return _mm512_set1_epi32(splitter); }
+  static V load(const int32_t* ptr) { return _mm512_loadu_si512(ptr); }
+  static V gather(const int32_t* base, V index) {
+    return _mm512_i32gather_epi32(index, base, 4);
+  }
+  static V sub(V a, V b) { return _mm512_sub_epi32(a, b); }
+  static V descend(V node, V splitter, V value) {
+    const V doubled = _mm512_add_epi32(node, node);
+    return _mm512_mask_add_epi32(doubled,
+                                 _mm512_cmplt_epi32_mask(splitter, value),
+                                 doubled, broadcast(1));
+  }
+  static V descend_not_less(V node, V splitter, V value) {
+    const V doubled = _mm512_add_epi32(node, node);
+    return _mm512_mask_add_epi32(doubled,
+                                 _mm512_cmple_epi32_mask(splitter, value),
+                                 doubled, broadcast(1));
+  }
+  static void store(Lane* ptr, V node) { _mm512_store_si512(ptr, node); }
+};
+
+struct Avx512U64 {
+  using V = __m512i;
+  using Lane = int64_t;
+  static constexpr int kLanes = 8;
+  static constexpr int kUnroll = 8;
+
+  static V broadcast(Lane lane) { return _mm512_set1_epi64(lane); }
+  static V set1(uint64_t splitter) {
+    return _mm512_set1_epi64(static_cast<int64_t>(splitter));
+  }
+  static V load(const uint64_t* ptr) { return _mm512_loadu_si512(ptr); }
+  static V gather(const uint64_t* base, V index) {
+    return _mm512_i64gather_epi64(index, base, 8);
+  }
+  static V sub(V a, V b) { return _mm512_sub_epi64(a, b); }
+  static V descend(V node, V splitter, V value) {
+    const V doubled = _mm512_add_epi64(node, node);
+    return _mm512_mask_add_epi64(doubled,
+                                 _mm512_cmplt_epu64_mask(splitter, value),
+                                 doubled, broadcast(1));
+  }
+  static V descend_not_less(V node, V splitter, V value) {
+    const V doubled = _mm512_add_epi64(node, node);
+    return _mm512_mask_add_epi64(doubled,
+                                 _mm512_cmple_epu64_mask(splitter, value),
+                                 doubled, broadcast(1));
+  }
+  static void store(Lane* ptr, V node) { _mm512_store_si512(ptr, node); }
+};
+
+template <int kLogBuckets, bool kEqualBuckets, typename Yield>
+inline int32_t* classify(const int32_t* tree,
+                         const int32_t* sorted,
+                         int32_t* begin,
+                         int32_t* end,
+                         Yield& yield) {
+  return classify_blocks<Avx512I32, kLogBuckets, kEqualBuckets>(
+      tree, sorted, begin, end, yield);
+}
+
+template <int kLogBuckets, bool kEqualBuckets, typename Yield>
+inline uint64_t* classify(const uint64_t* tree,
+                          const uint64_t* sorted,
+                          uint64_t* begin,
+                          uint64_t* end,
+                          Yield& yield) {
+  return classify_blocks<Avx512U64, kLogBuckets, kEqualBuckets>(
+      tree, sorted, begin, end, yield);
+}
+}  // namespace avx512
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+
+}  // namespace detail
+#endif  // SORT_ARCH_X86
+
+// Classifies whole vector blocks of [begin, end) and calls yield(bucket, it)
+// for each element, like the scalar classifier. tree is the implicit search
+// tree indexed from 1, sorted the sorted splitters. Returns where the caller
+// has to continue, begin if it has to classify everything itself.
+template <int kLogBuckets, bool kEqualBuckets, typename T, typename Yield>
+inline T* classify(const T* tree,
+                   const T* sorted,
+                   T* begin,
+                   T* end,
+                   Yield& yield) {
+#if SORT_ARCH_X86
+  if constexpr (kLogBuckets > 0) {
+    // IPS4O_SIMD_CLASSIFIER_NO_AVX512 caps the dispatch at AVX2, to measure
+    // the AVX2 version on a machine that has AVX-512.
+    static const bool no_avx512 =
+        std::getenv("IPS4O_SIMD_CLASSIFIER_NO_AVX512") != nullptr;
+    if (cpu_features::has_avx512_skx() && !no_avx512) {
+      return detail::avx512::classify<kLogBuckets, kEqualBuckets>(
+          tree, sorted, begin, end, yield);
+    }
+    // With four u64 lanes and the sign flip for the unsigned comparison, the
+    // AVX2 version is slower than the scalar classifier.
+    if constexpr (std::is_same_v<T, int32_t>) {
+      if (cpu_features::has_avx2()) {
+        return detail::avx2::classify<kLogBuckets, kEqualBuckets>(
+            tree, sorted, begin, end, yield);
+      }
+    }
+  }
+#endif
+  return begin;
+}
+
+}  // namespace simd_classifier
@@ -0,0 +1,170 @@
+#pragma once
+
+// The pivot on last value partition of avx2-altquicksort.h, generalized over
+// the element type so that it also covers u64 and f32. Same scheme, the
+// elements of each vector that are greater than the pivot are permuted to the
+// back of the vector, and the vector is swapped with the first white one.
+//
+// Must be included after avx2-altquicksort.h, inside the same AVX2 target
+// region.
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+namespace simdsort_avx2 {
+
+// AVX2 only has a signed 64-bit compare, flipping the sign bit of both sides
+// turns it into an unsigned one.
+struct U64Lanes {
+  using T = uint64_t;
+  using V = __m256i;
+  static constexpr size_t kLanes = 4;
+
+  static V load(const T* ptr) {
+    return _mm256_lddqu_si256(reinterpret_cast<const __m256i*>(ptr));
+  }
+  static void store(T* ptr, V v) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(ptr), v);
+  }
+  static V set1(T val) {
+    return _mm256_set1_epi64x(static_cast<int64_t>(val ^ (uint64_t{1} << 63)));
+  }
+  static int gt_mask(V v, V flipped_pivot) {
+    const V flipped = _mm256_xor_si256(v, _mm256_set1_epi64x(INT64_MIN));
+    return _mm256_movemask_pd(
+        _mm256_castsi256_pd(_mm256_cmpgt_epi64(flipped, flipped_pivot)));
+  }
+  static V black_then_white(V v, int mask) {
+    // Each 64-bit lane is moved as a pair of 32-bit lanes, so the 8 lane
+    // table entry for the expanded mask does the job.
+    return _mm256_permutevar8x32_epi32(v,
+                                       get_permutation_vector(kExpand[mask]));
+  }
+
+  static constexpr uint8_t kExpand[16] = {
+      0x00, 0x03, 0x0C, 0x0F, 0x30, 0x33, 0x3C, 0x3F,
+      0xC0, 0xC3, 0xCC, 0xCF, 0xF0, 0xF3, 0xFC, 0xFF,
+  };
+};
+
+// Only valid for input without NaNs, -0.0 and 0.0 are treated as equal.
+struct F32Lanes {
+  using T = float;
+  using V = __m256;
+  static constexpr size_t kLanes = 8;
+
+  static V load(const T* ptr) { return _mm256_loadu_ps(ptr); }
+  static void store(T* ptr, V v) { _mm256_storeu_ps(ptr, v); }
+  static V set1(T val) { return _mm256_set1_ps(val); }
+  static int gt_mask(V v, V pivot) {
+    return _mm256_movemask_ps(_mm256_cmp_ps(v, pivot, _CMP_GT_OQ));
+  }
+  static V black_then_white(V v, int mask) {
+    return _mm256_permutevar8x32_ps(v, get_permutation_vector(mask));
+  }
+};
+
+// Returns the position one past the pivot, everything before it is less than
+// or equal to the pivot, everything after it greater.
+template <typename L>
+size_t partition_pivot_on_last(typename L::T* array, size_t length) {
+  using T = typename L::T;
+  constexpr size_t kLanes = L::kLanes;
+  constexpr int kAllGreater = (1 << kLanes) - 1;
+
+  if (length <= 1) {
+    return 1;
+  }
+  // The middle value is a better pivot for already sorted input.
+  std::swap(array[length / 2], array[length - 1]);
+
+  size_t boundary = 0;
+  size_t i = 0;
+  const T pivot = array[length - 1];
+  const typename L::V pivot_vec = L::set1(pivot);
+
+  // As long as there is no white element yet, vectors can be permuted in
+  // place.
+  while (i + kLanes + 1 <= length) {
+    const typename L::V all_grey = L::load(array + i);
+    const int mask = L::gt_mask(all_grey, pivot_vec);
+    if (mask == 0) {
+      i += kLanes;
+      boundary = i;
+    } else if (mask == kAllGreater) {
+      boundary = i;
+      i += kLanes;
+      break;
+    } else {
+      L::store(array + i, L::black_then_white(all_grey, mask));
+      i += kLanes - __builtin_popcount(mask);
+      boundary = i;
+    }
+  }
+  for (; i + kLanes + 1 <= length; i += kLanes) {
+    const typename L::V all_grey = L::load(array + i);
+    const int mask = L::gt_mask(all_grey, pivot_vec);
+    if (mask != kAllGreater) {
+      const typename L::V all_white = L::load(array + boundary);
+      L::store(array + boundary, L::black_then_white(all_grey, mask));
+      L::store(array + i, all_white);
+      boundary += kLanes - __builtin_popcount(mask);
+    }
+  }
+  for (; i + 1 < length; ++i) {
+    if (array[i] <= pivot) {
+      std::swap(array[i], array[boundary]);
+      ++boundary;
+    }
+  }
+  std::swap(array[length - 1], array[boundary]);
+  return boundary + 1;
+}
+
+// Fallback if the pivot is the largest value.
+template <typename T>
+void scalar_quicksort(T* array, ptrdiff_t left, ptrdiff_t right) {
+  ptrdiff_t i = left;
+  ptrdiff_t j = right;
+  const T pivot = array[(i + j) / 2];
+  while (i <= j) {
+    while (array[i] < pivot) {
+      ++i;
+    }
+    while (array[j] > pivot) {
+      --j;
+    }
+    if (i <= j) {
+      std::swap(array[i], array[j]);
+      ++i;
+      --j;
+    }
+  }
+  if (left < j) {
+    scalar_quicksort(array, left, j);
+  }
+  if (i < right) {
+    scalar_quicksort(array, i, right);
+  }
+}
+
+// Same recursion as avx2_pivotonlast_sort.
+template <typename L>
+void pivot_on_last_sort(typename L::T* array, size_t length) {
+  const size_t sep = partition_pivot_on_last<L>(array, length);
+  if (sep == length) {
+    if (length > 1) {
+      scalar_quicksort(array, 0, static_cast<ptrdiff_t>(length) - 1);
+    }
+  } else {
+    if (sep > 2) {
+      pivot_on_last_sort<L>(array, sep - 1);
+    }
+    if (sep + 1 < length) {
+      pivot_on_last_sort<L>(array + sep, length - sep);
+    }
+  }
+}
+
+}  // namespace simdsort_avx2
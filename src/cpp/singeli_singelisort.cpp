@@ -1,6 +1,8 @@
 #include "thirdparty/singelisort/sort.c"
 
+#include <algorithm>
 #include <stdexcept>
+#include <type_traits>
 #include <vector>
 
 #include <stdint.h>
@@ -11,10 +13,98 @@ size_t aux_alloc_size(size_t len) {
   return len + 4 * (len < 1 << 16 ? len : 1 << 16);
 }
 
+// Per-thread scratch that only ever grows, so repeated sorts of similar size
+// neither allocate nor page fault after the first call. Stored as uint64_t to
+// satisfy the alignment of all supported element types.
+template <typename T>
+T* thread_local_aux(size_t len) {
+  static_assert(alignof(T) <= alignof(uint64_t));
+
+  thread_local std::vector<uint64_t> aux_memory{};
+
+  const size_t aux_bytes = aux_alloc_size(len) * sizeof(T);
+  const size_t aux_words =
+      (aux_bytes + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+  if (aux_memory.size() < aux_words) {
+    aux_memory.resize(aux_words);
+  }
+
+  return reinterpret_cast<T*>(aux_memory.data());
+}
+
+// Scratch of the sorts and grades of 8 and 16 bit keys. They count into one
+// u64 per key value. Shorter 16 bit inputs go through radix passes instead,
+// which need a copy of the keys, and of the indices for grades.
+size_t counting_aux_bytes(size_t len, size_t key_bits) {
+  return (size_t{1} << key_bits) * sizeof(uint64_t) +
+         len * (sizeof(int16_t) + sizeof(uint64_t)) + sizeof(uint64_t);
+}
+
+// Robin Hood sort either counts into one u64 per value of the range, if that
+// is below 4 * len, or inserts into a table of up to 5 * len + 32 slots.
+size_t rhsort_aux_len(size_t len) {
+  return 8 * len + 64;
+}
+
+// The signed kernels sort unsigned keys with the top bit flipped.
+template <typename U>
+void flip_sign_bit(U* data, size_t len) {
+  constexpr U kSignBit = U{1} << (sizeof(U) * 8 - 1);
+  for (size_t i = 0; i < len; ++i) {
+    data[i] ^= kSignBit;
+  }
+}
+
+template <typename S, typename U, typename Sort>
+void sort_unsigned(U* data, size_t len, Sort sort) {
+  flip_sign_bit(data, len);
+  sort(reinterpret_cast<S*>(data), len);
+  flip_sign_bit(data, len);
+}
+
+template <typename T>
+std::vector<T> reserve_aux(size_t aux_bytes) {
+  std::vector<T> aux_memory{};
+  aux_memory.reserve((aux_bytes + sizeof(T) - 1) / sizeof(T));
+  return aux_memory;
+}
+
+void sort_i8(int8_t* data, size_t len) {
+  auto aux_memory = reserve_aux<uint64_t>(counting_aux_bytes(len, 8));
+  sort8(data, static_cast<uint64_t>(len), aux_memory.data());
+}
+
+void sort_i16(int16_t* data, size_t len) {
+  auto aux_memory = reserve_aux<uint64_t>(counting_aux_bytes(len, 16));
+  sort16(data, static_cast<uint64_t>(len), aux_memory.data());
+}
+
+// The grade kernels sort the keys along with the indices, so they work on a
+// copy, with the top bit flipped for unsigned keys.
+template <typename S, typename T, typename Grade>
+void grade(const T* keys, size_t len, uint64_t* indices, Grade grade_fn) {
+  // The kernel writes the key instead of index 0 for a single element.
+  if (len < 2) {
+    std::fill(indices, indices + len, 0);
+    return;
+  }
+
+  std::vector<T> sorted_keys(keys, keys + len);
+  if constexpr (std::is_unsigned_v<T>) {
+    flip_sign_bit(sorted_keys.data(), len);
+  }
+
+  auto aux_memory =
+      reserve_aux<uint64_t>(counting_aux_bytes(len, sizeof(T) * 8));
+  grade_fn(indices, reinterpret_cast<S*>(sorted_keys.data()),
+           static_cast<uint64_t>(len), aux_memory.data());
+}
+
 extern "C" {
 // --- i32 ---
 
 void singelisort_i32(int32_t* data, size_t len) {
+  SORT_USDT_PROBE(len);
   std::vector<int32_t> aux_memory{};
   aux_memory.reserve(aux_alloc_size(len));
   sort32(data, static_cast<uint64_t>(len), aux_memory.data(),
@@ -34,6 +124,7 @@ uint32_t singelisort_i32_by(int32_t* data,
 // --- u64 ---
 
 void singelisort_u64(uint64_t* data, size_t len) {
+  SORT_USDT_PROBE(len);
   std::vector<uint64_t> aux_memory{};
   aux_memory.reserve(aux_alloc_size(len));
   sort_u64(data, static_cast<uint64_t>(len), aux_memory.data(),
@@ -50,6 +141,52 @@ uint32_t singelisort_u64_by(uint64_t* data,
   return 1;
 }
 
+// --- scratch ---
+
+// Number of elements the scratch passed to singelisort_*_with_aux must hold.
+size_t singelisort_aux_len(size_t len) {
+  SORT_USDT_PROBE(len);
+  return aux_alloc_size(len);
+}
+
+uint32_t singelisort_i32_with_aux(int32_t* data,
+                                  size_t len,
+                                  int32_t* aux,
+                                  size_t aux_len) {
+  SORT_USDT_PROBE(len);
+  if (aux_len < aux_alloc_size(len)) {
+    return 1;
+  }
+
+  sort32(data, static_cast<uint64_t>(len), aux, aux_len * sizeof(int32_t));
+  return 0;
+}
+
+uint32_t singelisort_u64_with_aux(uint64_t* data,
+                                  size_t len,
+                                  uint64_t* aux,
+                                  size_t aux_len) {
+  SORT_USDT_PROBE(len);
+  if (aux_len < aux_alloc_size(len)) {
+    return 1;
+  }
+
+  sort_u64(data, static_cast<uint64_t>(len), aux, aux_len * sizeof(uint64_t));
+  return 0;
+}
+
+void singelisort_i32_tls(int32_t* data, size_t len) {
+  SORT_USDT_PROBE(len);
+  sort32(data, static_cast<uint64_t>(len), thread_local_aux<int32_t>(len),
+         aux_alloc_size(len) * sizeof(int32_t));
+}
+
+void singelisort_u64_tls(uint64_t* data, size_t len) {
+  SORT_USDT_PROBE(len);
+  sort_u64(data, static_cast<uint64_t>(len), thread_local_aux<uint64_t>(len),
+           aux_alloc_size(len) * sizeof(uint64_t));
+}
+
 // --- ffi_string ---
 
 void singelisort_ffi_string(FFIString* data, size_t len) {
@@ -97,4 +234,98 @@ uint32_t singelisort_1k_by(FFIOneKibiByte* data,
   printf("Not supported\n");
   return 1;
 }
+
+// --- f64 ---
+
+void singelisort_f64(F64* data, size_t len) {
+  SORT_USDT_PROBE(len);
+  double* keys = reinterpret_cast<double*>(data);
+  const size_t sort_len = move_nan_to_end(keys, len);
+
+  std::vector<double> aux_memory{};
+  aux_memory.reserve(aux_alloc_size(sort_len));
+  sort_f64(keys, static_cast<uint64_t>(sort_len), aux_memory.data(),
+           aux_memory.capacity() * sizeof(double));
+}
+
+uint32_t singelisort_f64_by(F64* data,
+                            size_t len,
+                            CompResult (*cmp_fn)(const F64&,
+                                                 const F64&,
+                                                 uint8_t*),
+                            uint8_t* ctx) {
+  printf("Not supported\n");
+  return 1;
+}
+
+// --- 8 and 16 bit counting sorts ---
+
+void singelisort_i8(int8_t* data, size_t len) {
+  SORT_USDT_PROBE(len);
+  sort_i8(data, len);
+}
+
+void singelisort_u8(uint8_t* data, size_t len) {
+  SORT_USDT_PROBE(len);
+  sort_unsigned<int8_t>(data, len, sort_i8);
+}
+
+void singelisort_i16(int16_t* data, size_t len) {
+  SORT_USDT_PROBE(len);
+  sort_i16(data, len);
+}
+
+void singelisort_u16(uint16_t* data, size_t len) {
+  SORT_USDT_PROBE(len);
+  sort_unsigned<int16_t>(data, len, sort_i16);
+}
+
+// --- grade ---
+
+// Writes the permutation that sorts keys to indices, which has room for len
+// elements.
+void singelisort_grade_i8(const int8_t* keys, size_t len, uint64_t* indices) {
+  SORT_USDT_PROBE(len);
+  grade<int8_t>(keys, len, indices, grade8_64);
+}
+
+void singelisort_grade_u8(const uint8_t* keys, size_t len, uint64_t* indices) {
+  SORT_USDT_PROBE(len);
+  grade<int8_t>(keys, len, indices, grade8_64);
+}
+
+void singelisort_grade_i16(const int16_t* keys,
+                           size_t len,
+                           uint64_t* indices) {
+  SORT_USDT_PROBE(len);
+  grade<int16_t>(keys, len, indices, grade16_64);
+}
+
+void singelisort_grade_u16(const uint16_t* keys,
+                           size_t len,
+                           uint64_t* indices) {
+  SORT_USDT_PROBE(len);
+  grade<int16_t>(keys, len, indices, grade16_64);
+}
+
+// --- Robin Hood sort ---
+
+void singelisort_rhsort_i32(int32_t* data, size_t len) {
+  SORT_USDT_PROBE(len);
+  // rhsort32 reads the first element unconditionally.
+  if (len < 2) {
+    return;
+  }
+
+  auto aux_memory =
+      reserve_aux<int32_t>(rhsort_aux_len(len) * sizeof(int32_t));
+  rhsort32(data, static_cast<uint64_t>(len), aux_memory.data());
+}
+
+// --- packed records ---
+
+PACKED_SORT_IMPL_U64(singelisort, [](uint64_t* words, size_t len) {
+  sort_u64(words, static_cast<uint64_t>(len), thread_local_aux<uint64_t>(len),
+           aux_alloc_size(len) * sizeof(uint64_t));
+})
 }  // extern "C"
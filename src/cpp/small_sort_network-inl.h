@@ -0,0 +1,72 @@
+// Bitonic network over kRegs registers described by a lane traits struct L.
+// Included once per target region by small_sort_network.h, so that the network
+// is compiled for the instruction set of the traits it is instantiated with.
+// No include guard on purpose.
+
+template <typename L, int kRegs, int k, int j>
+inline void bitonic_step(typename L::V* v) {
+  constexpr int kLanes = L::kLanes;
+  if constexpr (j >= kLanes) {
+    constexpr int kStride = j / kLanes;
+    for (int r = 0; r < kRegs; ++r) {
+      if ((r & kStride) == 0) {
+        const typename L::V lo = L::min(v[r], v[r + kStride]);
+        const typename L::V hi = L::max(v[r], v[r + kStride]);
+        const bool is_descending = ((r * kLanes) & k) != 0;
+        v[r] = is_descending ? hi : lo;
+        v[r + kStride] = is_descending ? lo : hi;
+      }
+    }
+  } else {
+    constexpr uint32_t kMaxLanes = max_lanes(kLanes, k, j);
+    for (int r = 0; r < kRegs; ++r) {
+      const typename L::V partner = L::template partner<j>(v[r]);
+      const typename L::V lo = L::min(v[r], partner);
+      const typename L::V hi = L::max(v[r], partner);
+      const bool is_descending = k >= kLanes && ((r * kLanes) & k) != 0;
+      v[r] = is_descending ? L::template select<kMaxLanes>(hi, lo)
+                           : L::template select<kMaxLanes>(lo, hi);
+    }
+  }
+  if constexpr (j > 1) {
+    bitonic_step<L, kRegs, k, j / 2>(v);
+  }
+}
+
+template <typename L, int kRegs, int k = 2>
+inline void bitonic_sort(typename L::V* v) {
+  bitonic_step<L, kRegs, k, k / 2>(v);
+  if constexpr (k < kRegs * L::kLanes) {
+    bitonic_sort<L, kRegs, k * 2>(v);
+  }
+}
+
+template <typename L, int kRegs>
+inline void sort_regs(typename L::T* data, size_t len) {
+  typename L::V v[kRegs];
+  for (int r = 0; r < kRegs; ++r) {
+    v[r] = L::load_padded(data + r * L::kLanes,
+                          static_cast<ptrdiff_t>(len) - r * L::kLanes);
+  }
+  bitonic_sort<L, kRegs>(v);
+  for (int r = 0; r < kRegs; ++r) {
+    L::store_partial(data + r * L::kLanes, v[r],
+                     static_cast<ptrdiff_t>(len) - r * L::kLanes);
+  }
+}
+
+template <typename L>
+inline void sort_lanes(typename L::T* data, size_t len) {
+  constexpr size_t kLanes = L::kLanes;
+  if (len <= kLanes) {
+    sort_regs<L, 1>(data, len);
+  } else if (len <= 2 * kLanes) {
+    sort_regs<L, 2>(data, len);
+  } else if constexpr (kMaxLen > 2 * kLanes) {
+    if (len <= 4 * kLanes) {
+      sort_regs<L, 4>(data, len);
+    } else if constexpr (kMaxLen > 4 * kLanes) {
+      sort_regs<L, 8>(data, len);
+    }
+  }
+}
@@ -0,0 +1,291 @@
+#pragma once
+
+// Vectorized base case for the quicksort hybrids. Inputs of up to kMaxLen i32
+// or u64 elements, sorted with the natural order, are loaded into registers
+// padded with the maximum value, and sorted with a bitonic network. Padding is
+// indistinguishable from real maximum values, and the masked store only writes
+// the first len elements back.
+//
+// Wrappers opt in by defining SMALL_SORT_NETWORK, see the
+// cpp_small_sort_network feature. The vendored sorts call try_sort in front of
+// their scalar base case, which falls through to the scalar code for other
+// types, custom comparisons, longer inputs and CPUs without AVX2.
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+
+#include "cpu_features.h"
+
+#if SORT_ARCH_X86
+#include <immintrin.h>
+#endif
+
+namespace small_sort_network {
+
+constexpr ptrdiff_t kMaxLen = 32;
+
+// Comparison functions that are known to be the natural order of T.
+// Specialize for the default comparison of a vendored sort.
+template <typename Compare, typename T>
+struct is_natural_less : std::false_type {};
+
+template <typename T>
+struct is_natural_less<std::less<T>, T> : std::true_type {};
+
+template <typename T>
+struct is_natural_less<std::less<>, T> : std::true_type {};
+
+#if SORT_ARCH_X86
+namespace detail {
+
+// Lane i has to take the max of itself and lane i ^ j, if it is the upper lane
+// of the pair in an ascending block of size k, or the lower one in a
+// descending block. Blocks spanning multiple registers have the same direction
+// for all lanes, that case is handled per register.
+constexpr uint32_t max_lanes(int lanes, int k, int j) {
+  uint32_t bits = 0;
+  for (int lane = 0; lane < lanes; ++lane) {
+    const bool is_upper = (lane & j) != 0;
+    const bool is_descending = k < lanes && (lane & k) != 0;
+    if (is_upper != is_descending) {
+      bits |= uint32_t{1} << lane;
+    }
+  }
+  return bits;
+}
+
+// Each bit of a 64-bit lane mask covers two 32-bit lanes.
+constexpr uint32_t expand_to_32bit_lanes(uint32_t bits) {
+  uint32_t result = 0;
+  for (int lane = 0; lane < 16; ++lane) {
+    if ((bits >> lane) & 1) {
+      result |= uint32_t{3} << (2 * lane);
+    }
+  }
+  return result;
+}
+
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx2"))), \
+                             apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#endif
+namespace avx2 {
+#include "small_sort_network-inl.h"
+
+inline __m256i avx2_lane_mask(ptrdiff_t valid, __m256i lane_index) {
+  const ptrdiff_t clamped = valid < 0 ? 0 : (valid > 8 ? 8 : valid);
+  return _mm256_cmpgt_epi32(_mm256_set1_epi32(static_cast<int32_t>(clamped)),
+                            lane_index);
+}
+
+struct Avx2I32 {
+  using T = int32_t;
+  using V = __m256i;
+  static constexpr int kLanes = 8;
+
+  static V mask(ptrdiff_t valid) {
+    return avx2_lane_mask(valid, _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+  }
+  static V load_padded(const T* ptr, ptrdiff_t valid) {
+    const V m = mask(valid);
+    const V loaded = _mm256_maskload_epi32(ptr, m);
+    return _mm256_blendv_epi8(_mm256_set1_epi32(INT32_MAX), loaded, m);
+  }
+  static void store_partial(T* ptr, V v, ptrdiff_t valid) {
+    _mm256_maskstore_epi32(ptr, mask(valid), v);
+  }
+  static V min(V a, V b) { return _mm256_min_epi32(a, b); }
+  static V max(V a, V b) { return _mm256_max_epi32(a, b); }
+  template <int j>
+  static V partner(V v) {
+    if constexpr (j == 1) {
+      return _mm256_shuffle_epi32(v, 0xB1);
+    } else if constexpr (j == 2) {
+      return _mm256_shuffle_epi32(v, 0x4E);
+    } else {
+      return _mm256_permute2x128_si256(v, v, 0x01);
+    }
+  }
+  template <uint32_t kBits>
+  static V select(V lo, V hi) {
+    return _mm256_blend_epi32(lo, hi, kBits);
+  }
+};
+
+// AVX2 has neither an unsigned nor a 64-bit min and max, they are built from
+// the signed 64-bit compare on sign flipped values.
+struct Avx2U64 {
+  using T = uint64_t;
+  using V = __m256i;
+  static constexpr int kLanes = 4;
+
+  static V mask(ptrdiff_t valid) {
+    return avx2_lane_mask(valid, _mm256_setr_epi32(0, 0, 1, 1, 2, 2, 3, 3));
+  }
+  static V load_padded(const T* ptr, ptrdiff_t valid) {
+    const V m = mask(valid);
+    const V loaded =
+        _mm256_maskload_epi64(reinterpret_cast<const long long*>(ptr), m);
+    return _mm256_blendv_epi8(_mm256_set1_epi64x(-1), loaded, m);
+  }
+  static void store_partial(T* ptr, V v, ptrdiff_t valid) {
+    _mm256_maskstore_epi64(reinterpret_cast<long long*>(ptr), mask(valid), v);
+  }
+  static V greater(V a, V b) {
+    const V sign = _mm256_set1_epi64x(INT64_MIN);
+    return _mm256_cmpgt_epi64(_mm256_xor_si256(a, sign),
+                              _mm256_xor_si256(b, sign));
+  }
+  static V min(V a, V b) { return _mm256_blendv_epi8(a, b, greater(a, b)); }
+  static V max(V a, V b) { return _mm256_blendv_epi8(b, a, greater(a, b)); }
+  template <int j>
+  static V partner(V v) {
+    if constexpr (j == 1) {
+      return _mm256_shuffle_epi32(v, 0x4E);
+    } else {
+      return _mm256_permute4x64_epi64(v, 0x4E);
+    }
+  }
+  template <uint32_t kBits>
+  static V select(V lo, V hi) {
+    return _mm256_blend_epi32(lo, hi, expand_to_32bit_lanes(kBits));
+  }
+};
+
+inline void sort(int32_t* data, size_t len) {
+  sort_lanes<Avx2I32>(data, len);
+}
+
+inline void sort(uint64_t* data, size_t len) {
+  sort_lanes<Avx2U64>(data, len);
+}
+}  // namespace avx2
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+
+#if defined(__clang__)
+#pragma clang attribute push(                                   \
+    __attribute__((target("avx2,avx512f,avx512dq,avx512vl"))), \
+    apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("avx2,avx512f,avx512dq,avx512vl")
+#endif
+namespace avx512 {
+#include "small_sort_network-inl.h"
+
+template <int kLanes>
+inline uint32_t avx512_lane_mask(ptrdiff_t valid) {
+  if (valid >= kLanes) {
+    return (uint32_t{1} << kLanes) - 1;
+  }
+  return valid > 0 ? (uint32_t{1} << valid) - 1 : 0;
+}
+
+struct Avx512I32 {
+  using T = int32_t;
+  using V = __m512i;
+  static constexpr int kLanes = 16;
+
+  static V load_padded(const T* ptr, ptrdiff_t valid) {
+    return _mm512_mask_loadu_epi32(_mm512_set1_epi32(INT32_MAX),
+                                   avx512_lane_mask<kLanes>(valid), ptr);
+  }
+  static void store_partial(T* ptr, V v, ptrdiff_t valid) {
+    _mm512_mask_storeu_epi32(ptr, avx512_lane_mask<kLanes>(valid), v);
+  }
+  static V min(V a, V b) { return _mm512_min_epi32(a, b); }
+  static V max(V a, V b) { return _mm512_max_epi32(a, b); }
+  template <int j>
+  static V partner(V v) {
+    return _mm512_permutexvar_epi32(
+        _mm512_set_epi32(15 ^ j, 14 ^ j, 13 ^ j, 12 ^ j, 11 ^ j, 10 ^ j, 9 ^ j,
+                         8 ^ j, 7 ^ j, 6 ^ j, 5 ^ j, 4 ^ j, 3 ^ j, 2 ^ j,
+                         1 ^ j, 0 ^ j),
+        v);
+  }
+  template <uint32_t kBits>
+  static V select(V lo, V hi) {
+    return _mm512_mask_blend_epi32(static_cast<__mmask16>(kBits), lo, hi);
+  }
+};
+
+struct Avx512U64 {
+  using T = uint64_t;
+  using V = __m512i;
+  static constexpr int kLanes = 8;
+
+  static V load_padded(const T* ptr, ptrdiff_t valid) {
+    return _mm512_mask_loadu_epi64(_mm512_set1_epi64(-1),
+                                   avx512_lane_mask<kLanes>(valid), ptr);
+  }
+  static void store_partial(T* ptr, V v, ptrdiff_t valid) {
+    _mm512_mask_storeu_epi64(ptr, avx512_lane_mask<kLanes>(valid), v);
+  }
+  static V min(V a, V b) { return _mm512_min_epu64(a, b); }
+  static V max(V a, V b) { return _mm512_max_epu64(a, b); }
+  template <int j>
+  static V partner(V v) {
+    return _mm512_permutexvar_epi64(
+        _mm512_set_epi64(7 ^ j, 6 ^ j, 5 ^ j, 4 ^ j, 3 ^ j, 2 ^ j, 1 ^ j,
+                         0 ^ j),
+        v);
+  }
+  template <uint32_t kBits>
+  static V select(V lo, V hi) {
+    return _mm512_mask_blend_epi64(static_cast<__mmask8>(kBits), lo, hi);
+  }
+};
+
+inline void sort(int32_t* data, size_t len) {
+  sort_lanes<Avx512I32>(data, len);
+}
+
+inline void sort(uint64_t* data, size_t len) {
+  sort_lanes<Avx512U64>(data, len);
+}
+}  // namespace avx512
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+
+}  // namespace detail
+#endif  // SORT_ARCH_X86
+
+// Returns false if the caller has to sort [first, last) itself.
+template <typename It, typename Compare>
+inline bool try_sort(It first, It last, Compare comp) {
+  using T = std::remove_cv_t<std::remove_reference_t<decltype(*first)>>;
+#if SORT_ARCH_X86
+  if constexpr (std::is_pointer_v<It> && is_natural_less<Compare, T>::value &&
+                (std::is_same_v<T, int32_t> || std::is_same_v<T, uint64_t>)) {
+    const ptrdiff_t len = last - first;
+    if (len > kMaxLen) {
+      return false;
+    }
+    if (cpu_features::has_avx512_skx()) {
+      detail::avx512::sort(first, static_cast<size_t>(len));
+      return true;
+    }
+    if (cpu_features::has_avx2()) {
+      detail::avx2::sort(first, static_cast<size_t>(len));
+      return true;
+    }
+  }
+#endif
+  return false;
+}
+
+}  // namespace small_sort_network
@@ -0,0 +1,284 @@
+#pragma once
+
+// Header-only C++ interface to the vendored sort implementations, for C++
+// callers that want the comparator inlined instead of going through the
+// extern "C" entry points and their CompResult function pointers. The
+// implementations are the same headers in thirdparty/ the wrappers compile for
+// the Rust side, with their default configuration:
+//
+//   std::vector<FFIStringCpp> v = ...;
+//   sort_research::sort<sort_research::Pdqsort>(std::span{v});
+//   sort_research::stable_sort<sort_research::Powersort>(
+//       std::span{v}, [](const auto& a, const auto& b) { return a < b; });
+//
+// Needs C++20 and -I src/cpp. What an algorithm can do is described by
+// sort_research::traits<Algo>, calls it can't handle fail to compile:
+//
+//   is_stable            equal elements keep their order, required by
+//                        stable_sort.
+//   supports_comparator  takes any strict weak ordering, otherwise only
+//                        std::less<> and std::less<T> are accepted.
+//   is_simd              vectorized kernel for the types of supports_type.
+//   supports_type<T>     element types it can sort, e.g. nanosort needs
+//                        copyable types.
+//
+// IntelAvx512 is only available if the caller is compiled for AVX-512, e.g.
+// with -march=skylake-avx512, it has no runtime dispatch like the
+// cpp_intel_avx512 wrapper.
+
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <new>
+#include <span>
+#include <type_traits>
+
+// Has to come before pdqsort.h and the blockquicksort headers, see
+// sort_telemetry.h.
+#include "sort_telemetry.h"
+#include "thirdparty/blockquicksort/blocked_double_pivot_check_mosqrt.h"
+#include "thirdparty/gerbens_qsort/hybrid_qsort.h"
+#include "thirdparty/ips4o/ips4o.hpp"
+#include "thirdparty/nanosort/nanosort.hpp"
+#include "thirdparty/pdqsort/pdqsort.h"
+#include "thirdparty/powersort/powersort.h"
+#include "thirdparty/wikisort/WikiSort.h"
+
+#if defined(__AVX512F__) && defined(__AVX512CD__) && defined(__AVX512DQ__) && \
+    defined(__AVX512BW__) && defined(__AVX512VL__)
+#define SORT_RESEARCH_HAS_AVX512
+#include "thirdparty/intel_avx512/avx512-32bit-qsort.hpp"
+#include "thirdparty/intel_avx512/avx512-64bit-qsort.hpp"
+#endif
+
+namespace sort_research {
+
+// Types that keep their value when move assigned to themselves, which
+// BlockQuicksort relies on. Specialize it for other such types, e.g.
+// FFIStringCpp, std::string is not one of them.
+template <typename T>
+struct is_self_move_safe : std::is_trivially_copyable<T> {};
+
+namespace detail {
+template <typename T>
+constexpr bool kMovable =
+    std::is_move_constructible_v<T> && std::is_move_assignable_v<T>;
+
+template <typename T>
+constexpr bool kCopyable =
+    std::is_copy_constructible_v<T> && std::is_copy_assignable_v<T>;
+
+template <typename T, typename... Ts>
+constexpr bool kOneOf = (std::is_same_v<T, Ts> || ...);
+
+template <typename T, typename Comp>
+constexpr bool kIsNaturalLess =
+    std::is_same_v<Comp, std::less<>> || std::is_same_v<Comp, std::less<T>>;
+
+// Algorithms that sort with their own comparator get std::less<> instead.
+struct GeneralAlgorithm {
+  static constexpr bool supports_comparator = true;
+  static constexpr bool is_simd = false;
+
+  template <typename T>
+  static constexpr bool supports_type = kMovable<T>;
+};
+}  // namespace detail
+
+// The algorithms, named like the Rust modules and entry points without
+// their language prefix.
+
+// std::sort.
+struct Std : detail::GeneralAlgorithm {
+  static constexpr bool is_stable = false;
+
+  template <typename T, typename Comp>
+  static void sort(T* begin, T* end, Comp comp) {
+    std::sort(begin, end, comp);
+  }
+};
+
+// std::stable_sort.
+struct StdStable : detail::GeneralAlgorithm {
+  static constexpr bool is_stable = true;
+
+  template <typename T, typename Comp>
+  static void sort(T* begin, T* end, Comp comp) {
+    std::stable_sort(begin, end, comp);
+  }
+};
+
+// pdqsort, picks the branchless partition for arithmetic types and natural
+// comparisons, like the pdqsort_unstable entry points.
+struct Pdqsort : detail::GeneralAlgorithm {
+  static constexpr bool is_stable = false;
+
+  template <typename T, typename Comp>
+  static void sort(T* begin, T* end, Comp comp) {
+    pdqsort(begin, end, comp);
+  }
+};
+
+// Median-of-sqrt(n) pivot with the duplicate check, like the
+// blockquicksort_unstable entry points. Move assigns elements to themselves.
+struct BlockQuicksort : detail::GeneralAlgorithm {
+  static constexpr bool is_stable = false;
+
+  template <typename T>
+  static constexpr bool supports_type =
+      detail::kMovable<T> && is_self_move_safe<T>::value;
+
+  template <typename T, typename Comp>
+  static void sort(T* begin, T* end, Comp comp) {
+    blocked_double_pivot_check_mosqrt::sort(begin, end, comp);
+  }
+};
+
+// Sequential ips4o, copies the samples.
+struct Ips4o : detail::GeneralAlgorithm {
+  static constexpr bool is_stable = false;
+
+  template <typename T>
+  static constexpr bool supports_type = detail::kCopyable<T>;
+
+  template <typename T, typename Comp>
+  static void sort(T* begin, T* end, Comp comp) {
+    ips4o::sort(begin, end, comp);
+  }
+};
+
+// Keeps the pivot and the scratch buffer by value.
+struct GerbensQsort : detail::GeneralAlgorithm {
+  static constexpr bool is_stable = false;
+
+  template <typename T>
+  static constexpr bool supports_type =
+      detail::kCopyable<T> && std::is_default_constructible_v<T>;
+
+  template <typename T, typename Comp>
+  static void sort(T* begin, T* end, Comp comp) {
+    constexpr ptrdiff_t kScratchSize = exp_gerbens::SCRATCH_SIZE_DEFAULT;
+
+    // QuickSort puts the scratch buffer on the stack.
+    if constexpr (kScratchSize * sizeof(T) <= 64 * 1024) {
+      exp_gerbens::QuickSort<kScratchSize>(begin, end, comp);
+    } else {
+      std::unique_ptr<T[]> scratch{new T[kScratchSize]};
+      exp_gerbens::QuickSortImpl<kScratchSize>(begin, end, scratch.get(),
+                                               comp);
+    }
+  }
+};
+
+// Needs a by ref copy constructor, see cpp_nanosort.cpp.
+struct Nanosort : detail::GeneralAlgorithm {
+  static constexpr bool is_stable = false;
+
+  template <typename T>
+  static constexpr bool supports_type = detail::kCopyable<T>;
+
+  template <typename T, typename Comp>
+  static void sort(T* begin, T* end, Comp comp) {
+    nanosort(begin, end, comp);
+  }
+};
+
+// Same configuration as the powersort_stable entry points.
+struct Powersort : detail::GeneralAlgorithm {
+  static constexpr bool is_stable = true;
+
+  template <typename T, typename Comp>
+  static void sort(T* begin, T* end, Comp comp) {
+    algorithms::powersort<
+        /*Iterator=*/T*,
+        /*minRunLen=*/24,
+        /*mergingMethod*/ algorithms::merging_methods::COPY_BOTH_BIDIRECTIONAL,
+        /*onlyIncreasingRuns=*/false,
+        /*nodePowerImplementation=*/algorithms::MOST_SIGNIFICANT_SET_BIT,
+        /*usePowerIndexedStack=*/false,
+        /*Compare=*/Comp>{comp}
+        .sort(begin, end);
+  }
+};
+
+// With a heap cache of half the input, falls back to the in-place merges if
+// that allocation fails. Copies elements into the cache.
+struct Wikisort : detail::GeneralAlgorithm {
+  static constexpr bool is_stable = true;
+
+  template <typename T>
+  static constexpr bool supports_type =
+      detail::kCopyable<T> && std::is_default_constructible_v<T>;
+
+  template <typename T, typename Comp>
+  static void sort(T* begin, T* end, Comp comp) {
+    const size_t len = end - begin;
+    const size_t cache_len = (len + 1) / 2;
+
+    std::unique_ptr<T[]> cache{len >= 8 ? new (std::nothrow) T[cache_len]
+                                        : nullptr};
+    Wiki::SortWithCache(begin, end, comp, cache.get(),
+                        cache ? cache_len : 0);
+  }
+};
+
+#if defined(SORT_RESEARCH_HAS_AVX512)
+// The AVX-512 quicksort of x86-simd-sort, floats are ordered by the IEEE
+// comparison, NaNs are not supported.
+struct IntelAvx512 {
+  static constexpr bool is_stable = false;
+  static constexpr bool supports_comparator = false;
+  static constexpr bool is_simd = true;
+
+  template <typename T>
+  static constexpr bool supports_type =
+      detail::kOneOf<T, int32_t, uint32_t, float, int64_t, uint64_t, double>;
+
+  template <typename T, typename Comp>
+  static void sort(T* begin, T* end, Comp) {
+    avx512_qsort<T>(begin, static_cast<int64_t>(end - begin));
+  }
+};
+#endif
+
+template <typename Algo>
+struct traits {
+  static constexpr bool is_stable = Algo::is_stable;
+  static constexpr bool supports_comparator = Algo::supports_comparator;
+  static constexpr bool is_simd = Algo::is_simd;
+
+  template <typename T>
+  static constexpr bool supports_type =
+      Algo::template supports_type<std::remove_const_t<T>>;
+};
+
+template <typename Algo, typename T, typename Comp = std::less<>>
+void sort(std::span<T> v, Comp comp = {}) {
+  static_assert(!std::is_const_v<T>, "can't sort a span of const elements");
+  static_assert(traits<Algo>::template supports_type<T>,
+                "the algorithm can't sort this element type");
+  static_assert(traits<Algo>::supports_comparator ||
+                    detail::kIsNaturalLess<T, Comp>,
+                "the algorithm only sorts with std::less");
+  static_assert(std::predicate<Comp&, const T&, const T&>,
+                "the comparator has to compare two elements");
+
+  if (v.size() < 2) {
+    return;
+  }
+
+  Algo::sort(v.data(), v.data() + v.size(), comp);
+}
+
+template <typename Algo, typename T, typename Comp = std::less<>>
+void stable_sort(std::span<T> v, Comp comp = {}) {
+  static_assert(traits<Algo>::is_stable,
+                "the algorithm does not preserve the order of equal elements");
+
+  sort<Algo>(v, comp);
+}
+
+}  // namespace sort_research
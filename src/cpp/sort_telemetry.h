@@ -0,0 +1,137 @@
+#pragma once
+
+// Pivot and partition telemetry behind the SORT_TELEMETRY hooks in
+// thirdparty/pdqsort, blockquicksort, scandum/crumsort and ips4o. Every
+// partition step and every fallback to the worst case sort is recorded into a
+// ring buffer that keeps the newest kCapacity events, read via the functions
+// SORT_TELEMETRY_EXPORT defines.
+//
+// Everything lives in an unnamed namespace, so every wrapper translation unit
+// records into its own buffer, also when all of them are linked into one shared
+// library.
+
+#if defined(SORT_TELEMETRY)
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace sort_telemetry {
+namespace {
+
+// Same values as TelemetryKind on the Rust side.
+enum Kind : uint32_t {
+  // Partition around a single pivot, rank is the length of the left side,
+  // the number of elements less than the pivot.
+  kPartition,
+  // Partition into buckets, rank is the length of the largest bucket.
+  kMultiwayPartition,
+  // Too many bad partitions, the len elements are sorted by the worst case
+  // fallback, heapsort or for crumsort quadsort.
+  kFallback,
+};
+
+// Same layout as TelemetryEvent on the Rust side.
+struct Event {
+  uint64_t len;
+  uint64_t rank;
+  uint64_t buckets;
+  uint32_t kind;
+  uint32_t depth;
+};
+
+constexpr size_t kCapacity = size_t{1} << 18;
+
+Event g_events[kCapacity];
+std::atomic<uint64_t> g_count{0};
+
+// Recursion depth of the sorts that recurse, maintained by DepthScope.
+thread_local uint32_t g_depth = 0;
+
+class DepthScope {
+ public:
+  DepthScope() { ++g_depth; }
+  ~DepthScope() { --g_depth; }
+
+  DepthScope(const DepthScope&) = delete;
+  DepthScope& operator=(const DepthScope&) = delete;
+};
+
+// Depth of the innermost DepthScope, 0 for the outermost call and outside of
+// any, e.g. for the top levels of parallel ips4o.
+inline uint32_t depth() {
+  return g_depth == 0 ? 0 : g_depth - 1;
+}
+
+inline void record(Kind kind,
+                   uint64_t len,
+                   uint64_t rank,
+                   uint64_t buckets,
+                   uint32_t depth) {
+  const uint64_t i = g_count.fetch_add(1, std::memory_order_relaxed);
+  g_events[i % kCapacity] = Event{len, rank, buckets, kind, depth};
+}
+
+inline void partition(uint64_t len, uint64_t rank, uint32_t depth) {
+  record(kPartition, len, rank, 2, depth);
+}
+
+// bucket_start holds num_buckets + 1 offsets.
+template <typename Diff>
+inline void multiway_partition(uint64_t len,
+                               const Diff* bucket_start,
+                               int num_buckets,
+                               uint32_t depth) {
+  uint64_t largest = 0;
+  for (int i = 0; i < num_buckets; ++i) {
+    const uint64_t bucket_len = bucket_start[i + 1] - bucket_start[i];
+    largest = std::max(largest, bucket_len);
+  }
+  record(kMultiwayPartition, len, largest, static_cast<uint64_t>(num_buckets),
+         depth);
+}
+
+inline void fallback(uint64_t len, uint32_t depth) {
+  record(kFallback, len, 0, 0, depth);
+}
+
+// Copies the newest min(recorded, kCapacity, out_len) events into out, oldest
+// first, and returns how many. total receives the number of events recorded
+// since the last reset.
+inline size_t read(Event* out, size_t out_len, uint64_t* total) {
+  const uint64_t count = g_count.load(std::memory_order_relaxed);
+  const uint64_t kept =
+      std::min<uint64_t>({count, uint64_t{kCapacity}, uint64_t{out_len}});
+
+  for (uint64_t i = 0; i < kept; ++i) {
+    out[i] = g_events[(count - kept + i) % kCapacity];
+  }
+
+  *total = count;
+  return static_cast<size_t>(kept);
+}
+
+inline void reset() {
+  g_count.store(0, std::memory_order_relaxed);
+}
+
+}  // namespace
+}  // namespace sort_telemetry
+
+// Defines PREFIX_telemetry_capacity, PREFIX_telemetry_read and
+// PREFIX_telemetry_reset for the buffer of the including translation unit.
+#define SORT_TELEMETRY_EXPORT(PREFIX)                                   \
+  extern "C" size_t PREFIX##_telemetry_capacity() {                     \
+    return sort_telemetry::kCapacity;                                   \
+  }                                                                     \
+  extern "C" size_t PREFIX##_telemetry_read(sort_telemetry::Event* out, \
+                                            size_t out_len,             \
+                                            uint64_t* total) {          \
+    return sort_telemetry::read(out, out_len, total);                   \
+  }                                                                     \
+  extern "C" void PREFIX##_telemetry_reset() {                          \
+    sort_telemetry::reset();                                            \
+  }
+
+#endif  // SORT_TELEMETRY
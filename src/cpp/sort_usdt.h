@@ -0,0 +1,68 @@
+#pragma once
+
+// USDT probes around the C and C++ entry points, behind SORT_USDT. Every entry
+// point starts with SORT_USDT_PROBE(len), which fires
+//
+//   sort_research:sort_entry(const char* entry_point, uint64_t len)
+//   sort_research:sort_exit(const char* entry_point, uint64_t len,
+//                           uint64_t cycles)
+//
+// when the entry point is called and when it returns. entry_point is the name
+// of the exported function, <algorithm>_<type>[_<variant>], e.g.
+// pdqsort_unstable_u64_by. cycles are TSC cycles on x86-64, nanoseconds
+// elsewhere. Like all USDT probes they are a NOP until a tracer attaches, see
+// util/sort_usdt.bt. Without SORT_USDT SORT_USDT_PROBE expands to nothing.
+
+#if defined(SORT_USDT)
+
+#include <stdint.h>
+#include <time.h>
+
+#include <sys/sdt.h>
+
+// Also included by the gcc 4.3 build of cpp_std_gcc4_3_sort, so no C++11.
+namespace sort_usdt {
+
+inline uint64_t read_cycles() {
+#if defined(__x86_64__)
+  uint32_t lo, hi;
+  __asm__ __volatile__("rdtsc" : "=a"(lo), "=d"(hi));
+  return (static_cast<uint64_t>(hi) << 32) | lo;
+#else
+  timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return static_cast<uint64_t>(now.tv_sec) * 1000000000 + now.tv_nsec;
+#endif
+}
+
+class Probe {
+ public:
+  Probe(const char* entry_point, uint64_t len)
+      : entry_point_(entry_point), len_(len), start_(read_cycles()) {
+    DTRACE_PROBE2(sort_research, sort_entry, entry_point_, len_);
+  }
+
+  ~Probe() {
+    const uint64_t cycles = read_cycles() - start_;
+    DTRACE_PROBE3(sort_research, sort_exit, entry_point_, len_, cycles);
+  }
+
+ private:
+  Probe(const Probe&);
+  Probe& operator=(const Probe&);
+
+  const char* entry_point_;
+  uint64_t len_;
+  uint64_t start_;
+};
+
+}  // namespace sort_usdt
+
+#define SORT_USDT_PROBE(len) \
+  const sort_usdt::Probe sort_usdt_probe(__func__, static_cast<uint64_t>(len))
+
+#else
+
+#define SORT_USDT_PROBE(len) static_cast<void>(0)
+
+#endif  // SORT_USDT
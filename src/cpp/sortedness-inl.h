@@ -0,0 +1,136 @@
+// Included once per instruction set by sortedness.h, inside a namespace
+// compiled for that target, so that the descent counting loop is vectorized
+// for it. No include guard on purpose.
+
+// The order of shared.h, NaNs are greater than every other value.
+template <typename T>
+inline bool is_descent(T prev, T next) {
+  if constexpr (std::is_floating_point_v<T>) {
+    return next < prev || (prev != prev && next == next);
+  } else {
+    return next < prev;
+  }
+}
+
+// Number of i in [begin, end) with data[i + 1] < data[i]. Branchless, with a
+// counter as wide as T, so that the compiler turns it into vector comparisons
+// and subtractions of the masks. end - begin has to fit into the counter.
+template <typename T>
+inline size_t count_descents(const T* data, size_t begin, size_t end) {
+  using Count = std::conditional_t<sizeof(T) == 4, uint32_t, uint64_t>;
+
+  Count count = 0;
+  for (size_t i = begin; i < end; ++i) {
+    count += is_descent(data[i], data[i + 1]);
+  }
+  return count;
+}
+
+template <typename T>
+inline bool is_sorted(const T* data, size_t len) {
+  if (len < 2) {
+    return true;
+  }
+
+  // Pair i compares the elements i and i + 1.
+  const size_t pairs = len - 1;
+  for (size_t begin = 0; begin < pairs; begin += kBlockPairs) {
+    const size_t end = std::min(begin + kBlockPairs, pairs);
+    if (count_descents(data, begin, end) != 0) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+// Bit j is set if flags[j] is, for 64 flags of 0 or 1.
+inline uint64_t descent_mask(const uint8_t* flags) {
+  uint64_t mask = 0;
+  for (int byte = 0; byte < 8; ++byte) {
+    uint64_t word;
+    std::memcpy(&word, flags + byte * 8, sizeof(word));
+    // Gathers the low bit of every byte into the top byte, the first flag
+    // into its lowest bit.
+    mask |= ((word * 0x0102040810204080ull) >> 56) << (byte * 8);
+  }
+  return mask;
+}
+
+// Updates run_start and longest_run with the 64 pairs from base, where mask
+// has the bits of the descents. Of the runs between two descents only those
+// that can be longer than longest_run are looked at one by one, found with
+// log2(longest_run) shifts.
+inline void update_runs(uint64_t mask,
+                        size_t base,
+                        size_t& run_start,
+                        size_t& longest_run) {
+  const int first = std::countr_zero(mask);
+  const int last = 63 - std::countl_zero(mask);
+
+  // The run that continues from the pairs before ends at the first descent.
+  longest_run = std::max(longest_run, base + first + 1 - run_start);
+  run_start = base + last + 1;
+
+  // A run between the descents p and q is q - p long, longer than
+  // longest_run if there are at least longest_run pairs without descent in
+  // between.
+  if (first == last || static_cast<size_t>(last - first) <= longest_run) {
+    return;
+  }
+  uint64_t stretch = ~mask & ((uint64_t{1} << last) - 1) & ~((uint64_t{2} << first) - 1);
+  for (size_t covered = 1; covered < longest_run && stretch != 0;) {
+    const size_t shift = std::min(covered, longest_run - covered);
+    stretch &= stretch >> shift;
+    covered += shift;
+  }
+  if (stretch == 0) {
+    return;
+  }
+
+  for (uint64_t rest = mask & (mask - 1); rest != 0; rest &= rest - 1) {
+    const int next = std::countr_zero(rest);
+    const int prev = 63 - std::countl_zero(mask & ((uint64_t{1} << next) - 1));
+    longest_run = std::max(longest_run, static_cast<size_t>(next - prev));
+  }
+}
+
+// Blocks without descents are skipped after counting them. In the others the
+// descents are turned into bit masks, so that the runs are found with bit
+// operations instead of a loop that depends on every comparison.
+template <typename T>
+inline void measure_runs(const T* data, size_t len, Metrics& metrics) {
+  metrics.descents = 0;
+  metrics.longest_run = len;
+  if (len < 2) {
+    return;
+  }
+
+  size_t run_start = 0;
+  size_t longest_run = 0;
+  alignas(64) uint8_t flags[kBlockPairs];
+
+  const size_t pairs = len - 1;
+  for (size_t begin = 0; begin < pairs; begin += kBlockPairs) {
+    const size_t block_len = std::min(kBlockPairs, pairs - begin);
+    if (count_descents(data, begin, begin + block_len) == 0) {
+      continue;
+    }
+
+    for (size_t i = 0; i < block_len; ++i) {
+      flags[i] = is_descent(data[begin + i], data[begin + i + 1]);
+    }
+    const size_t words = (block_len + 63) / 64;
+    std::fill(flags + block_len, flags + words * 64, uint8_t{0});
+
+    for (size_t word = 0; word < words; ++word) {
+      const uint64_t mask = descent_mask(flags + word * 64);
+      if (mask != 0) {
+        metrics.descents += std::popcount(mask);
+        update_runs(mask, begin + word * 64, run_start, longest_run);
+      }
+    }
+  }
+
+  metrics.longest_run = std::max(longest_run, len - run_start);
+}
@@ -0,0 +1,168 @@
+#pragma once
+
+// Vectorized presortedness metrics for i32, u64, f32 and f64, in the order of
+// shared.h, where NaNs are greater than every other value:
+//
+//   is_sorted          no element is less than the one before it. Stops at
+//                      the first block with a descent.
+//   descents           number of neighbouring pairs in descending order, 0 for
+//                      sorted input and len - 1 for strictly descending input.
+//   longest_run        length of the longest non-descending run.
+//   distinct_estimate  number of distinct values, exact up to kDistinctSample
+//                      elements, above that estimated from a stratified sample
+//                      of that many with the bias-corrected Chao1 estimator.
+//                      Accurate for few distinct values, which is what the
+//                      sorts care about, a lower bound for many.
+//
+// The descents are counted over blocks of kBlockPairs pairs, with AVX2 or
+// AVX-512 selected at runtime on x86, so that all metrics take a single
+// streaming pass over the input. The distinct estimate only looks at the
+// sample. Used by the cpp_sortedness wrapper.
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include "cpu_features.h"
+
+namespace sortedness {
+
+struct Metrics {
+  uint64_t descents;
+  uint64_t longest_run;
+  uint64_t distinct_estimate;
+};
+
+namespace detail {
+
+// 4KiB of i32, small enough that is_sorted doesn't read much past the first
+// descent, large enough that the per block work doesn't matter.
+constexpr size_t kBlockPairs = 1024;
+
+// Compiled for the baseline of the build, SSE2 on x86-64 and NEON on AArch64.
+namespace baseline {
+#include "sortedness-inl.h"
+}  // namespace baseline
+
+#if SORT_ARCH_X86
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx2"))), \
+                             apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#endif
+namespace avx2 {
+#include "sortedness-inl.h"
+}  // namespace avx2
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+
+#if defined(__clang__)
+#pragma clang attribute push(                                 \
+    __attribute__((target("avx2,avx512f,avx512bw,avx512vl"))), \
+    apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("avx2,avx512f,avx512bw,avx512vl")
+#endif
+namespace avx512 {
+#include "sortedness-inl.h"
+}  // namespace avx512
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+#endif  // SORT_ARCH_X86
+
+constexpr size_t kDistinctSample = 1024;
+
+template <typename T>
+bool total_less(T a, T b) {
+  return baseline::is_descent(b, a);
+}
+
+// One element of every stratum of len / kDistinctSample elements, at a pseudo
+// random offset, so that the sample doesn't line up with periodic patterns.
+inline size_t sample_index(size_t i, size_t len) {
+  uint64_t offset = (i + 1) * 0x9e3779b97f4a7c15ull;
+  offset ^= offset >> 29;
+  return (i * len) / kDistinctSample + offset % (len / kDistinctSample);
+}
+
+template <typename T>
+uint64_t estimate_distinct(const T* data, size_t len) {
+  const size_t sample_len = std::min(len, kDistinctSample);
+  T sample[kDistinctSample];
+  for (size_t i = 0; i < sample_len; ++i) {
+    sample[i] = len <= kDistinctSample ? data[i] : data[sample_index(i, len)];
+  }
+  std::sort(sample, sample + sample_len, total_less<T>);
+
+  // Distinct values in the sample, and those seen exactly once and twice.
+  size_t distinct = 0;
+  size_t once = 0;
+  size_t twice = 0;
+  for (size_t i = 0; i < sample_len;) {
+    size_t j = i + 1;
+    while (j < sample_len && !total_less(sample[i], sample[j])) {
+      ++j;
+    }
+    distinct += 1;
+    once += j - i == 1;
+    twice += j - i == 2;
+    i = j;
+  }
+
+  if (len <= kDistinctSample) {
+    return distinct;
+  }
+
+  // Many values seen once compared to twice means many values were not seen.
+  const double unseen =
+      static_cast<double>(once) * (once - 1) / (2.0 * (twice + 1));
+  return std::min<uint64_t>(distinct + std::llround(unseen), len);
+}
+
+}  // namespace detail
+
+template <typename T>
+bool is_sorted(const T* data, size_t len) {
+#if SORT_ARCH_X86
+  if (cpu_features::has_avx512_skx()) {
+    return detail::avx512::is_sorted(data, len);
+  }
+  if (cpu_features::has_avx2()) {
+    return detail::avx2::is_sorted(data, len);
+  }
+#endif
+  return detail::baseline::is_sorted(data, len);
+}
+
+template <typename T>
+Metrics measure(const T* data, size_t len) {
+  Metrics metrics;
+#if SORT_ARCH_X86
+  if (cpu_features::has_avx512_skx()) {
+    detail::avx512::measure_runs(data, len, metrics);
+  } else if (cpu_features::has_avx2()) {
+    detail::avx2::measure_runs(data, len, metrics);
+  } else {
+    detail::baseline::measure_runs(data, len, metrics);
+  }
+#else
+  detail::baseline::measure_runs(data, len, metrics);
+#endif
+  metrics.distinct_estimate = detail::estimate_distinct(data, len);
+  return metrics;
+}
+
+}  // namespace sortedness
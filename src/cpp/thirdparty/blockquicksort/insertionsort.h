@@ -131,6 +131,9 @@ namespace insertionsort {
 			_RandomAccessIterator last, _Compare comp)
 	{
 		if (first == last) return;
+#ifdef SMALL_SORT_NETWORK
+		if (small_sort_network::try_sort(first, last, comp)) return;
+#endif
 
 		for (_RandomAccessIterator i = first + 1; i != last; ++i)
 		{
@@ -31,9 +31,11 @@ namespace median {
 	inline void sort_pair(iter i1, iter i2, Compare less) {
 		typedef typename std::iterator_traits<iter>::value_type T;
 		bool smaller = less(*i2, *i1);
-		T temp = std::move(smaller ? *i1 : temp);
+		// Sets the larger one aside. Reading temp in its own initializer, as the
+		// original did, is undefined and breaks types that own memory.
+		T temp = std::move(smaller ? *i1 : *i2);
 		*i1 = std::move(smaller ? *i2 : *i1);
-		*i2 = std::move(smaller ? temp : *i2);
+		*i2 = std::move(temp);
 	}
 
 	template<typename iter, typename Compare>
@@ -55,9 +55,11 @@ namespace partition {
 	inline void leanswap(iter i1, iter i2, Compare less) {
 		using t = typename std::iterator_traits<iter>::value_type;
 		bool smaller = less(*i2, *i1);
-		t temp = std::move(smaller ? *i1 : temp);
+		// Sets the larger one aside. Reading temp in its own initializer, as the
+		// original did, is undefined and breaks types that own memory.
+		t temp = std::move(smaller ? *i1 : *i2);
 		*i1 = std::move(smaller ? *i2 : *i1);
-		*i2 = std::move(smaller ? temp : *i2);
+		*i2 = std::move(temp);
 	}
 
 	//pivot choice for Tuned Quicksort by Elmasry, Katajainen, and Stenmark
@@ -256,7 +258,6 @@ namespace partition {
 		t pivot = std::move(*pivot_pos);
 		*pivot_pos = std::move(*last);
 		iter hole = last;
-		t temp;
 		last--;
 
 		int num_left = 0;
@@ -463,7 +464,7 @@ namespace partition {
 			{
 				upper--; lowerI--;
 			}
-			temp = std::move(*(begin + upper));
+			t temp = std::move(*(begin + upper));
 			while (lowerI >= start_left)
 			{
 				*(begin + upper) = std::move(*(begin + indexL[lowerI]));
@@ -519,7 +520,6 @@ namespace partition {
 		t pivot = std::move(*pivot_pos);
 		*pivot_pos = std::move(*last);
 		iter hole = last;
-		t temp;
 		last--;
 
 		int num_left = 0;
@@ -676,7 +676,7 @@ namespace partition {
 			{
 				upper--; lowerI--;
 			}
-			temp = std::move(*(begin + upper));
+			t temp = std::move(*(begin + upper));
 			while (lowerI >= start_left)
 			{
 				*(begin + upper) = std::move(*(begin + indexL[lowerI]));
@@ -813,7 +813,6 @@ namespace partition {
 
 			t q = std::move(*begin);
 			mid = begin++;
-			t temp;
 			last--;
 			int iL = 0;
 			int iR = 0;
@@ -838,7 +837,7 @@ namespace partition {
 				}
 				num = std::min(iL, iR);
 				if (num != 0) {
-					temp = std::move(*(begin + indexL[sL]));
+					t temp = std::move(*(begin + indexL[sL]));
 					*(begin + indexL[sL]) = std::move(*(last - indexR[sR]));
 					for (j = 1; j < num; j++) {
 						*(last - indexR[sR + j - 1]) = std::move(*(begin + indexL[sL + j]));
@@ -84,6 +84,9 @@ namespace quicksort {
 				iter pivot;
 				int pivot_length = 1;
 				pivot = Partitioner< iter, Compare>::partition(begin, end, less, pivot_length);
+#ifdef SORT_TELEMETRY
+				sort_telemetry::partition(end - begin, pivot - begin, depth);
+#endif
 				if (pivot - begin > end - pivot) {
 					*s = begin;
 					*(s + 1) = pivot;
@@ -104,7 +107,10 @@ namespace quicksort {
 #ifdef PARTIAL_SORT_COUNT
 					partial_sort_count++;
 #endif
-					std::partial_sort(begin, end, end);
+#ifdef SORT_TELEMETRY
+					sort_telemetry::fallback(end - begin, depth);
+#endif
+					std::partial_sort(begin, end, end, less);
 				}
 				else
 					insertionsort::insertion_sort(begin, end, less); // copy of std::__insertion_sort (GCC 4.7.2)
@@ -189,6 +195,9 @@ namespace quicksort {
 
 				iter pivot;
 				pivot = Partitioner< iter, Compare>::partition(begin, end, less);
+#ifdef SORT_TELEMETRY
+				sort_telemetry::partition(end - begin, pivot - begin, depth);
+#endif
 			//	std::cout << "pivot - begin " << (pivot - begin) << std::endl; 
 				if (pivot - begin > end - pivot) {
 					*s = begin;
@@ -212,7 +221,10 @@ namespace quicksort {
 #ifdef PARTIAL_SORT_COUNT
 					partial_sort_count++;
 #endif
-					std::partial_sort(begin, end, end);
+#ifdef SORT_TELEMETRY
+					sort_telemetry::fallback(end - begin, depth);
+#endif
+					std::partial_sort(begin, end, end, less);
 				}
 #ifndef NOINSERTIONSORT
 				else
@@ -360,7 +372,7 @@ namespace quicksort {
 #ifdef PARTIAL_SORT_COUNT
 					partial_sort_count++;
 #endif
-					std::partial_sort(begin, end, end);
+					std::partial_sort(begin, end, end, less);
 				}
 #ifndef NOINSERTIONSORT
 				else {
@@ -511,7 +523,7 @@ namespace quicksort {
 #ifdef PARTIAL_SORT_COUNT
 					partial_sort_count++;
 #endif
-					std::partial_sort(begin, end, end);
+					std::partial_sort(begin, end, end, less);
 				}
 #ifndef NOINSERTIONSORT
 				else {
@@ -598,7 +610,7 @@ namespace quicksort {
 #ifdef PARTIAL_SORT_COUNT
 					partial_sort_count++;
 #endif
-					std::partial_sort(begin, end, end);
+					std::partial_sort(begin, end, end, less);
 				}
 #ifndef NOINSERTIONSORT
 				else {
@@ -715,7 +727,7 @@ namespace quicksort {
 #ifdef PARTIAL_SORT_COUNT
 					partial_sort_count++;
 #endif
-					std::partial_sort(begin, end, end);
+					std::partial_sort(begin, end, end, less);
 				}
 #ifndef NOINSERTIONSORT
 				else {
@@ -848,7 +860,7 @@ namespace quicksort {
 #ifdef PARTIAL_SORT_COUNT
 					partial_sort_count++;
 #endif
-					std::partial_sort(begin, end, end);
+					std::partial_sort(begin, end, end, less);
 				}
 #ifndef NOINSERTIONSORT
 				else {
@@ -917,7 +929,7 @@ inline void qsort_2_pivot(iter begin, iter end, Compare less) {
 		}
 		else {
 			if(end-begin > 20) { 
-				std::partial_sort(begin, end, end);
+				std::partial_sort(begin, end, end, less);
 			}
 			else
 				insertionsort::insertion_sort(begin, end, less);
@@ -110,6 +110,10 @@ void BubbleSort2(RandomIt first, RandomIt last, Compare comp = std::less<>{}) {
 
 template <typename RandomIt, typename Compare>
 void SmallSort(RandomIt first, RandomIt last, Compare comp) {
+#ifdef SMALL_SORT_NETWORK
+  if (small_sort_network::try_sort(first, last, comp))
+    return;
+#endif
   BubbleSort2(first, last, comp);
 }
 
@@ -337,6 +341,52 @@ void QuickSortImpl(RandomIt first, RandomIt last, T* scratch, Compare comp) {
   QuickSortScratch(first, last, scratch, comp);
 }
 
+// QuickSortImpl with the equal element handling of pdqsort. ancestor is the
+// pivot of a partition [first, last) is on the right side of, or nullptr for
+// the leftmost ranges. No element is smaller than it, so a pivot that is not
+// larger than the ancestor equals it. The same hybrid partition with x <= pivot
+// then moves all elements equal to the pivot to the left, where they are done.
+template <ptrdiff_t kScratchSize,
+          typename RandomIt,
+          typename T,
+          typename Compare>
+void QuickSortFatImpl(RandomIt first,
+                      RandomIt last,
+                      T* scratch,
+                      Compare comp,
+                      const T* ancestor) {
+  // Ancestor of the right side, once the loop continues there.
+  T bound;
+  while (last - first > kScratchSize) {
+    auto pivot = MedianOfThree(first, last, comp);
+    if (ancestor != nullptr && !comp(*ancestor, pivot)) {
+      first = HoareLomutoHybridPartition<kScratchSize>(
+          pivot, first, last, scratch,
+          [&](const T& a, const T& b) { return !comp(b, a); });
+      continue;
+    }
+
+    auto res = HoareLomutoHybridPartition<kScratchSize>(pivot, first, last,
+                                                        scratch, comp);
+    auto mid = res;
+    if (res - first < ((last - first) >> 3)) {
+      mid = std::partition(res, last,
+                           [&](const T& p) { return !comp(pivot, p); });
+    }
+
+    if (res - first <= last - mid) {
+      QuickSortFatImpl<kScratchSize>(first, res, scratch, comp, ancestor);
+      first = mid;
+      bound = pivot;
+      ancestor = &bound;
+    } else {
+      QuickSortFatImpl<kScratchSize>(mid, last, scratch, comp, &pivot);
+      last = res;
+    }
+  }
+  QuickSortScratch(first, last, scratch, comp);
+}
+
 constexpr ptrdiff_t SCRATCH_SIZE_DEFAULT = 128;
 
 template <ptrdiff_t kScratchSize = SCRATCH_SIZE_DEFAULT,
@@ -354,6 +404,17 @@ void QuickSort(RandomIt first, RandomIt last) {
   QuickSort<kScratchSize>(first, last, std::less<>{});
 }
 
+template <ptrdiff_t kScratchSize = SCRATCH_SIZE_DEFAULT,
+          typename RandomIt,
+          typename Compare>
+void QuickSortFat(RandomIt first, RandomIt last, Compare comp) {
+  static_assert(kScratchSize > 0, "Must have a positive scratch space size");
+  using T = typename std::decay<decltype(*first)>::type;
+  T scratch[kScratchSize];
+  QuickSortFatImpl<kScratchSize>(first, last, scratch, comp,
+                                 static_cast<const T*>(nullptr));
+}
+
 }  // namespace exp_gerbens
 
 #endif  // EXPERIMENTAL_USERS_GERBENS_HYBRID_QSORT_H_
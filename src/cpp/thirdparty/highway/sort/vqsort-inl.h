@@ -1926,39 +1926,26 @@ HWY_NOINLINE void PrintMinMax(D d,
   }
 }
 
+// Draws samples and chooses the pivot for keys[0, num). Returns true if the
+// keys are already sorted, because they are all equal or hold only two values
+// that were partitioned in the process.
 template <class D, class Traits, typename T>
-HWY_NOINLINE void Recurse(D d,
-                          Traits st,
-                          T* HWY_RESTRICT keys,
-                          const size_t num,
-                          T* HWY_RESTRICT buf,
-                          uint64_t* HWY_RESTRICT state,
-                          const size_t remaining_levels) {
-  HWY_DASSERT(num != 0);
-
-  const size_t N = Lanes(d);
-  constexpr size_t kLPK = st.LanesPerKey();
-  if (HWY_UNLIKELY(num <= Constants::BaseCaseNumLanes<kLPK>(N))) {
-    BaseCase(d, st, keys, num, buf);
-    return;
-  }
-
-  // Move after BaseCase so we skip printing for small subarrays.
-  if (VQSORT_PRINT >= 1) {
-    fprintf(stderr, "\n\n=== Recurse depth=%zu len=%zu\n", remaining_levels,
-            num);
-    PrintMinMax(d, st, keys, num, buf);
-  }
-
+HWY_INLINE bool ChoosePivotOrFinish(D d,
+                                    Traits st,
+                                    T* HWY_RESTRICT keys,
+                                    const size_t num,
+                                    T* HWY_RESTRICT buf,
+                                    uint64_t* HWY_RESTRICT state,
+                                    Vec<D>& pivot,
+                                    PivotResult& result) {
   DrawSamples(d, st, keys, num, buf, state);
 
-  Vec<D> pivot;
-  PivotResult result = PivotResult::kNormal;
+  result = PivotResult::kNormal;
   if (HWY_UNLIKELY(UnsortedSampleEqual(d, st, buf))) {
     pivot = st.SetKey(d, buf);
     size_t idx_second = 0;
     if (HWY_UNLIKELY(AllEqual(d, st, pivot, keys, num, &idx_second))) {
-      return;
+      return true;
     }
     HWY_DASSERT(idx_second % st.LanesPerKey() == 0);
     // Must capture the value before PartitionIfTwoKeys may overwrite it.
@@ -1972,7 +1959,7 @@ HWY_NOINLINE void Recurse(D d,
     if (HWY_UNLIKELY(!st.IsKV() &&
                      PartitionIfTwoKeys(d, st, pivot, keys, num, idx_second,
                                         second, third, buf))) {
-      return;  // Done, skip recursion because each side has all-equal keys.
+      return true;  // Done, skip recursion because each side has all-equal keys.
     }
 
     // We can no longer start scanning from idx_second because
@@ -1989,12 +1976,45 @@ HWY_NOINLINE void Recurse(D d,
     // but not interchangeable (their values may differ).
     if (HWY_UNLIKELY(!st.IsKV() &&
                      PartitionIfTwoSamples(d, st, keys, num, buf))) {
-      return;
+      return true;
     }
 
     pivot = ChoosePivotByRank(d, st, buf);
   }
 
+  return false;
+}
+
+template <class D, class Traits, typename T>
+HWY_NOINLINE void Recurse(D d,
+                          Traits st,
+                          T* HWY_RESTRICT keys,
+                          const size_t num,
+                          T* HWY_RESTRICT buf,
+                          uint64_t* HWY_RESTRICT state,
+                          const size_t remaining_levels) {
+  HWY_DASSERT(num != 0);
+
+  const size_t N = Lanes(d);
+  constexpr size_t kLPK = st.LanesPerKey();
+  if (HWY_UNLIKELY(num <= Constants::BaseCaseNumLanes<kLPK>(N))) {
+    BaseCase(d, st, keys, num, buf);
+    return;
+  }
+
+  // Move after BaseCase so we skip printing for small subarrays.
+  if (VQSORT_PRINT >= 1) {
+    fprintf(stderr, "\n\n=== Recurse depth=%zu len=%zu\n", remaining_levels,
+            num);
+    PrintMinMax(d, st, keys, num, buf);
+  }
+
+  Vec<D> pivot;
+  PivotResult result;
+  if (ChoosePivotOrFinish(d, st, keys, num, buf, state, pivot, result)) {
+    return;
+  }
+
   // Too many recursions. This is unlikely to happen because we select pivots
   // from large (though still O(1)) samples.
   if (HWY_UNLIKELY(remaining_levels == 0)) {
@@ -2028,6 +2048,63 @@ HWY_NOINLINE void Recurse(D d,
   }
 }
 
+// Same as Recurse, except that it only descends into the partition that holds
+// the lane k, which leaves keys[k] at its sorted position.
+template <class D, class Traits, typename T>
+HWY_NOINLINE void RecurseSelect(D d,
+                                Traits st,
+                                T* HWY_RESTRICT keys,
+                                size_t num,
+                                size_t k,
+                                T* HWY_RESTRICT buf,
+                                uint64_t* HWY_RESTRICT state,
+                                size_t remaining_levels) {
+  const size_t N = Lanes(d);
+  constexpr size_t kLPK = st.LanesPerKey();
+
+  while (true) {
+    HWY_DASSERT(k < num);
+
+    if (HWY_UNLIKELY(num <= Constants::BaseCaseNumLanes<kLPK>(N))) {
+      BaseCase(d, st, keys, num, buf);
+      return;
+    }
+
+    Vec<D> pivot;
+    PivotResult result;
+    if (ChoosePivotOrFinish(d, st, keys, num, buf, state, pivot, result)) {
+      return;
+    }
+
+    if (HWY_UNLIKELY(remaining_levels == 0)) {
+      HeapSort(st, keys, num);  // Slow but N*logN.
+      return;
+    }
+
+    const size_t bound = Partition(d, st, keys, num, pivot, buf);
+    HWY_DASSERT(bound != 0);
+    HWY_DASSERT(bound != num || result == PivotResult::kWasLast);
+
+    // kIsFirst and kWasLast mean that the respective side only holds keys
+    // equal to the pivot, and is as such already in order.
+    if (k < bound) {
+      if (HWY_UNLIKELY(result == PivotResult::kIsFirst)) {
+        return;
+      }
+      num = bound;
+    } else {
+      if (HWY_UNLIKELY(result == PivotResult::kWasLast)) {
+        return;
+      }
+      keys += bound;
+      num -= bound;
+      k -= bound;
+    }
+
+    remaining_levels -= 1;
+  }
+}
+
 // Returns true if sorting is finished.
 template <class D, class Traits, typename T>
 HWY_INLINE bool HandleSpecialCases(D d,
@@ -2114,6 +2191,89 @@ void Sort(D d,
 #endif  // VQSORT_ENABLED
 }
 
+// Reorders `keys[0..num-1]` such that the key at index `k` is the one that
+// would be there after sorting, with no key before it that is ordered after it
+// and vice versa. Same requirements on `buf` as Sort.
+template <class D, class Traits, typename T>
+void Select(D d,
+            Traits st,
+            T* HWY_RESTRICT keys,
+            size_t num,
+            size_t k,
+            T* HWY_RESTRICT buf) {
+#if VQSORT_ENABLED || HWY_IDE
+  if (detail::HandleSpecialCases(d, st, keys, num, buf))
+    return;
+
+#if HWY_MAX_BYTES > 64
+  // sorting_networks-inl and traits assume no more than 512 bit vectors.
+  if (HWY_UNLIKELY(Lanes(d) > 64 / sizeof(T))) {
+    return Select(CappedTag<T, 64 / sizeof(T)>(), st, keys, num, k, buf);
+  }
+#endif  // HWY_MAX_BYTES > 64
+
+  uint64_t* HWY_RESTRICT state = GetGeneratorState();
+  const size_t max_levels = 50;
+  detail::RecurseSelect(d, st, keys, num, k * st.LanesPerKey(), buf, state,
+                        max_levels);
+#else   // !VQSORT_ENABLED
+  (void)d;
+  (void)buf;
+  (void)k;
+  return detail::HeapSort(st, keys, num);
+#endif  // VQSORT_ENABLED
+}
+
+template <class D, class Traits, typename T>
+HWY_API void Select(D d,
+                    Traits st,
+                    T* HWY_RESTRICT keys,
+                    size_t num,
+                    size_t k) {
+  constexpr size_t kLPK = st.LanesPerKey();
+  HWY_ALIGN T buf[SortConstants::BufBytes<T, kLPK>(HWY_MAX_BYTES) / sizeof(T)];
+  return Select(d, st, keys, num, k, buf);
+}
+
+// Reorders `keys[0..num-1]` such that the keys not ordered after `pivot` come
+// first, and returns their number. This is the partition Sort uses, for
+// OrderAscending it puts the keys less than or equal to `pivot` first. Only
+// for traits with one lane per key.
+template <class D, class Traits, typename T>
+HWY_API size_t PartitionKeys(D d,
+                             Traits st,
+                             T* HWY_RESTRICT keys,
+                             size_t num,
+                             T pivot) {
+  static_assert(st.LanesPerKey() == 1, "Only for single lane keys");
+
+#if VQSORT_ENABLED || HWY_IDE
+#if HWY_MAX_BYTES > 64
+  // sorting_networks-inl and traits assume no more than 512 bit vectors.
+  if (HWY_UNLIKELY(Lanes(d) > 64 / sizeof(T))) {
+    return PartitionKeys(CappedTag<T, 64 / sizeof(T)>(), st, keys, num, pivot);
+  }
+#endif  // HWY_MAX_BYTES > 64
+
+  // Partition loads at least two vectors.
+  if (num > 2 * Lanes(d)) {
+    HWY_ALIGN T buf[SortConstants::BufBytes<T, 1>(HWY_MAX_BYTES) / sizeof(T)];
+    return detail::Partition(d, st, keys, num, st.SetKey(d, &pivot), buf);
+  }
+#else   // !VQSORT_ENABLED
+  (void)d;
+#endif  // VQSORT_ENABLED
+
+  size_t num_left = 0;
+  for (size_t i = 0; i < num; ++i) {
+    if (!st.Compare1(&pivot, keys + i)) {
+      st.Swap(keys + num_left, keys + i);
+      ++num_left;
+    }
+  }
+  return num_left;
+}
+
 // Sorts `keys[0..num-1]` according to the order defined by `st.Compare`.
 // In-place i.e. O(1) additional storage. Worst-case N*logN comparisons.
 // Non-stable (order of equal keys may change), except for the common case where
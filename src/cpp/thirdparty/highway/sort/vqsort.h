@@ -53,6 +53,20 @@ class HWY_CONTRIB_DLLEXPORT Sorter {
   // and does not allocate memory.
   void operator()(uint64_t* HWY_RESTRICT keys, size_t n, SortAscending) const;
   void operator()(int32_t* HWY_RESTRICT keys, size_t n, SortAscending) const;
+  void operator()(uint64_t* HWY_RESTRICT keys, size_t n, SortDescending) const;
+  void operator()(int32_t* HWY_RESTRICT keys, size_t n, SortDescending) const;
+  void operator()(uint16_t* HWY_RESTRICT keys, size_t n, SortAscending) const;
+  void operator()(int16_t* HWY_RESTRICT keys, size_t n, SortAscending) const;
+  void operator()(float* HWY_RESTRICT keys, size_t n, SortAscending) const;
+  void operator()(double* HWY_RESTRICT keys, size_t n, SortAscending) const;
+
+  // 128-bit keys, compared as unsigned integers.
+  void operator()(uint128_t* HWY_RESTRICT keys, size_t n, SortAscending) const;
+  void operator()(uint128_t* HWY_RESTRICT keys, size_t n, SortDescending) const;
+
+  // Key-value pairs, only the key field is compared.
+  void operator()(K64V64* HWY_RESTRICT keys, size_t n, SortAscending) const;
+  void operator()(K32V32* HWY_RESTRICT keys, size_t n, SortAscending) const;
 
   // Unused
   static void Fill24Bytes(const void*, size_t, void*) {}
@@ -76,17 +90,44 @@ class HWY_CONTRIB_DLLEXPORT Sorter {
 #endif
 };
 
+// Reorders keys[0, n) such that keys[k] is the key that would be there after
+// sorting, with no larger key before and no smaller key after it. Requires
+// k < n.
+HWY_CONTRIB_DLLEXPORT void VQSelect(int32_t* HWY_RESTRICT keys,
+                                    size_t n,
+                                    size_t k,
+                                    SortAscending);
+HWY_CONTRIB_DLLEXPORT void VQSelect(uint64_t* HWY_RESTRICT keys,
+                                    size_t n,
+                                    size_t k,
+                                    SortAscending);
+
+// Reorders keys[0, n) such that the keys less than or equal to pivot come
+// first, and returns their number. Same partition as the sorts use.
+HWY_CONTRIB_DLLEXPORT size_t VQPartition(int32_t* HWY_RESTRICT keys,
+                                         size_t n,
+                                         int32_t pivot,
+                                         SortAscending);
+HWY_CONTRIB_DLLEXPORT size_t VQPartition(uint64_t* HWY_RESTRICT keys,
+                                         size_t n,
+                                         uint64_t pivot,
+                                         SortAscending);
+
 // Internal use only
 HWY_CONTRIB_DLLEXPORT uint64_t* GetGeneratorState();
 
 }  // namespace hwy
 
+// The rest defines the functions declared above for every target, by far the
+// most expensive part to compile. With VQSORT_DECLARATIONS_ONLY that is left to
+// another translation unit, see cpp_vqsort_inst.cpp.
+#if !defined(VQSORT_DECLARATIONS_ONLY)
+
 #include <time.h>
 
 #include <cstdint>
 
 #include "../base.h"
-#include "shared-inl.h"
 
 // Check if we have sys/random.h. First skip some systems on which the check
 // itself (features.h) might be problematic.
@@ -191,48 +232,131 @@ uint64_t* GetGeneratorState() {
 
 }  // namespace hwy
 
-#include "traits-inl.h"
-#include "vqsort-inl.h"
+#undef HWY_TARGET_INCLUDE
+#define HWY_TARGET_INCLUDE "sort/vqsort_targets-inl.h"
+#include "../foreach_target.h"  // IWYU pragma: keep
+#include "vqsort_targets-inl.h"
 
-HWY_BEFORE_NAMESPACE();
 namespace hwy {
-namespace HWY_NAMESPACE {
+namespace {
+HWY_EXPORT(SortI32Asc);
+HWY_EXPORT(SortU64Asc);
+HWY_EXPORT(SortU16Asc);
+HWY_EXPORT(SortI16Asc);
+HWY_EXPORT(SortF32Asc);
+HWY_EXPORT(SortF64Asc);
+HWY_EXPORT(SortI32Desc);
+HWY_EXPORT(SortU64Desc);
+HWY_EXPORT(SortU128Asc);
+HWY_EXPORT(SortU128Desc);
+HWY_EXPORT(SortKV128Asc);
+HWY_EXPORT(SortKV64Asc);
+HWY_EXPORT(SelectI32Asc);
+HWY_EXPORT(SelectU64Asc);
+HWY_EXPORT(PartitionI32Asc);
+HWY_EXPORT(PartitionU64Asc);
+}  // namespace
 
-void SortI32Asc(int32_t* HWY_RESTRICT keys, size_t num) {
-  SortTag<int32_t> d;
-  detail::SharedTraits<detail::TraitsLane<detail::OrderAscending<int32_t>>> st;
-  Sort(d, st, keys, num);
+void Sorter::operator()(int32_t* HWY_RESTRICT keys,
+                        size_t n,
+                        SortAscending) const {
+  HWY_DYNAMIC_DISPATCH(SortI32Asc)(keys, n);
 }
 
-void SortU64Asc(uint64_t* HWY_RESTRICT keys, size_t num) {
-  SortTag<uint64_t> d;
-  detail::SharedTraits<detail::TraitsLane<detail::OrderAscending<uint64_t>>> st;
-  Sort(d, st, keys, num);
+void Sorter::operator()(uint64_t* HWY_RESTRICT keys,
+                        size_t n,
+                        SortAscending) const {
+  HWY_DYNAMIC_DISPATCH(SortU64Asc)(keys, n);
 }
 
-// NOLINTNEXTLINE(google-readability-namespace-comments)
-}  // namespace HWY_NAMESPACE
-}  // namespace hwy
-HWY_AFTER_NAMESPACE();
+void Sorter::operator()(uint16_t* HWY_RESTRICT keys,
+                        size_t n,
+                        SortAscending) const {
+  HWY_DYNAMIC_DISPATCH(SortU16Asc)(keys, n);
+}
 
-// #if HWY_ONCE
-namespace hwy {
-// namespace {
-// HWY_EXPORT(SortI32Asc);
-// }  // namespace
+void Sorter::operator()(int16_t* HWY_RESTRICT keys,
+                        size_t n,
+                        SortAscending) const {
+  HWY_DYNAMIC_DISPATCH(SortI16Asc)(keys, n);
+}
 
-void Sorter::operator()(int32_t* HWY_RESTRICT keys,
+void Sorter::operator()(float* HWY_RESTRICT keys,
+                        size_t n,
+                        SortAscending) const {
+  HWY_DYNAMIC_DISPATCH(SortF32Asc)(keys, n);
+}
+
+void Sorter::operator()(double* HWY_RESTRICT keys,
                         size_t n,
                         SortAscending) const {
-  // HWY_DYNAMIC_DISPATCH(SortI32Asc)(keys, n, Get<int32_t>());
-  hwy::HWY_NAMESPACE::SortI32Asc(keys, n);
+  HWY_DYNAMIC_DISPATCH(SortF64Asc)(keys, n);
+}
+
+void Sorter::operator()(int32_t* HWY_RESTRICT keys,
+                        size_t n,
+                        SortDescending) const {
+  HWY_DYNAMIC_DISPATCH(SortI32Desc)(keys, n);
 }
 
 void Sorter::operator()(uint64_t* HWY_RESTRICT keys,
+                        size_t n,
+                        SortDescending) const {
+  HWY_DYNAMIC_DISPATCH(SortU64Desc)(keys, n);
+}
+
+void Sorter::operator()(uint128_t* HWY_RESTRICT keys,
+                        size_t n,
+                        SortAscending) const {
+  HWY_DYNAMIC_DISPATCH(SortU128Asc)(keys, n);
+}
+
+void Sorter::operator()(uint128_t* HWY_RESTRICT keys,
+                        size_t n,
+                        SortDescending) const {
+  HWY_DYNAMIC_DISPATCH(SortU128Desc)(keys, n);
+}
+
+void Sorter::operator()(K64V64* HWY_RESTRICT keys,
                         size_t n,
                         SortAscending) const {
-  // HWY_DYNAMIC_DISPATCH(SortU64Asc)(keys, n, Get<uint64_t>());
-  hwy::HWY_NAMESPACE::SortU64Asc(keys, n);
+  HWY_DYNAMIC_DISPATCH(SortKV128Asc)(keys, n);
+}
+
+void Sorter::operator()(K32V32* HWY_RESTRICT keys,
+                        size_t n,
+                        SortAscending) const {
+  HWY_DYNAMIC_DISPATCH(SortKV64Asc)(keys, n);
+}
+
+void VQSelect(int32_t* HWY_RESTRICT keys,
+              size_t n,
+              size_t k,
+              SortAscending) {
+  HWY_DYNAMIC_DISPATCH(SelectI32Asc)(keys, n, k);
+}
+
+void VQSelect(uint64_t* HWY_RESTRICT keys,
+              size_t n,
+              size_t k,
+              SortAscending) {
+  HWY_DYNAMIC_DISPATCH(SelectU64Asc)(keys, n, k);
+}
+
+size_t VQPartition(int32_t* HWY_RESTRICT keys,
+                   size_t n,
+                   int32_t pivot,
+                   SortAscending) {
+  return HWY_DYNAMIC_DISPATCH(PartitionI32Asc)(keys, n, pivot);
+}
+
+size_t VQPartition(uint64_t* HWY_RESTRICT keys,
+                   size_t n,
+                   uint64_t pivot,
+                   SortAscending) {
+  return HWY_DYNAMIC_DISPATCH(PartitionU64Asc)(keys, n, pivot);
 }
 
 }  // namespace hwy
+
+#endif  // !VQSORT_DECLARATIONS_ONLY
@@ -0,0 +1,159 @@
+// Copyright 2022 Google LLC
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Per-target sort functions, vqsort.h includes this once for every target via
+// foreach_target.h and exports them for dynamic dispatch.
+
+// Per-target include guard
+#if defined(HIGHWAY_HWY_CONTRIB_SORT_VQSORT_TARGETS_TOGGLE) == \
+    defined(HWY_TARGET_TOGGLE)
+#ifdef HIGHWAY_HWY_CONTRIB_SORT_VQSORT_TARGETS_TOGGLE
+#undef HIGHWAY_HWY_CONTRIB_SORT_VQSORT_TARGETS_TOGGLE
+#else
+#define HIGHWAY_HWY_CONTRIB_SORT_VQSORT_TARGETS_TOGGLE
+#endif
+
+#include "traits-inl.h"
+#include "traits128-inl.h"
+#include "vqsort-inl.h"
+
+#include <algorithm>
+#include <functional>
+
+HWY_BEFORE_NAMESPACE();
+namespace hwy {
+namespace HWY_NAMESPACE {
+
+void SortI32Asc(int32_t* HWY_RESTRICT keys, size_t num) {
+  SortTag<int32_t> d;
+  detail::SharedTraits<detail::TraitsLane<detail::OrderAscending<int32_t>>> st;
+  Sort(d, st, keys, num);
+}
+
+void SortU64Asc(uint64_t* HWY_RESTRICT keys, size_t num) {
+  SortTag<uint64_t> d;
+  detail::SharedTraits<detail::TraitsLane<detail::OrderAscending<uint64_t>>> st;
+  Sort(d, st, keys, num);
+}
+
+void SortU16Asc(uint16_t* HWY_RESTRICT keys, size_t num) {
+  SortTag<uint16_t> d;
+  detail::SharedTraits<detail::TraitsLane<detail::OrderAscending<uint16_t>>> st;
+  Sort(d, st, keys, num);
+}
+
+void SortI16Asc(int16_t* HWY_RESTRICT keys, size_t num) {
+  SortTag<int16_t> d;
+  detail::SharedTraits<detail::TraitsLane<detail::OrderAscending<int16_t>>> st;
+  Sort(d, st, keys, num);
+}
+
+void SortF32Asc(float* HWY_RESTRICT keys, size_t num) {
+  SortTag<float> d;
+  detail::SharedTraits<detail::TraitsLane<detail::OrderAscending<float>>> st;
+  Sort(d, st, keys, num);
+}
+
+void SortF64Asc(double* HWY_RESTRICT keys, size_t num) {
+  SortTag<double> d;
+  detail::SharedTraits<detail::TraitsLane<detail::OrderAscending<double>>> st;
+  Sort(d, st, keys, num);
+}
+
+void SortI32Desc(int32_t* HWY_RESTRICT keys, size_t num) {
+  SortTag<int32_t> d;
+  detail::SharedTraits<detail::TraitsLane<detail::OrderDescending<int32_t>>> st;
+  Sort(d, st, keys, num);
+}
+
+void SortU64Desc(uint64_t* HWY_RESTRICT keys, size_t num) {
+  SortTag<uint64_t> d;
+  detail::SharedTraits<detail::TraitsLane<detail::OrderDescending<uint64_t>>>
+      st;
+  Sort(d, st, keys, num);
+}
+
+void SortU128Asc(uint128_t* HWY_RESTRICT keys, size_t num) {
+#if VQSORT_ENABLED
+  SortTag<uint64_t> d;
+  detail::SharedTraits<detail::Traits128<detail::OrderAscending128>> st;
+  Sort(d, st, reinterpret_cast<uint64_t*>(keys), num * 2);
+#else
+  std::sort(keys, keys + num);
+#endif
+}
+
+void SortU128Desc(uint128_t* HWY_RESTRICT keys, size_t num) {
+#if VQSORT_ENABLED
+  SortTag<uint64_t> d;
+  detail::SharedTraits<detail::Traits128<detail::OrderDescending128>> st;
+  Sort(d, st, reinterpret_cast<uint64_t*>(keys), num * 2);
+#else
+  std::sort(keys, keys + num, std::greater<uint128_t>{});
+#endif
+}
+
+void SortKV128Asc(K64V64* HWY_RESTRICT keys, size_t num) {
+#if VQSORT_ENABLED
+  SortTag<uint64_t> d;
+  detail::SharedTraits<detail::Traits128<detail::OrderAscendingKV128>> st;
+  Sort(d, st, reinterpret_cast<uint64_t*>(keys), num * 2);
+#else
+  std::sort(keys, keys + num);
+#endif
+}
+
+void SortKV64Asc(K32V32* HWY_RESTRICT keys, size_t num) {
+#if VQSORT_ENABLED
+  SortTag<uint64_t> d;
+  detail::SharedTraits<detail::TraitsLane<detail::OrderAscendingKV64>> st;
+  Sort(d, st, reinterpret_cast<uint64_t*>(keys), num);
+#else
+  std::sort(keys, keys + num);
+#endif
+}
+
+void SelectI32Asc(int32_t* HWY_RESTRICT keys, size_t num, size_t k) {
+  SortTag<int32_t> d;
+  detail::SharedTraits<detail::TraitsLane<detail::OrderAscending<int32_t>>> st;
+  Select(d, st, keys, num, k);
+}
+
+void SelectU64Asc(uint64_t* HWY_RESTRICT keys, size_t num, size_t k) {
+  SortTag<uint64_t> d;
+  detail::SharedTraits<detail::TraitsLane<detail::OrderAscending<uint64_t>>> st;
+  Select(d, st, keys, num, k);
+}
+
+size_t PartitionI32Asc(int32_t* HWY_RESTRICT keys, size_t num, int32_t pivot) {
+  SortTag<int32_t> d;
+  detail::SharedTraits<detail::TraitsLane<detail::OrderAscending<int32_t>>> st;
+  return PartitionKeys(d, st, keys, num, pivot);
+}
+
+size_t PartitionU64Asc(uint64_t* HWY_RESTRICT keys,
+                       size_t num,
+                       uint64_t pivot) {
+  SortTag<uint64_t> d;
+  detail::SharedTraits<detail::TraitsLane<detail::OrderAscending<uint64_t>>> st;
+  return PartitionKeys(d, st, keys, num, pivot);
+}
+
+// NOLINTNEXTLINE(google-readability-namespace-comments)
+}  // namespace HWY_NAMESPACE
+}  // namespace hwy
+HWY_AFTER_NAMESPACE();
+
+#endif  // HIGHWAY_HWY_CONTRIB_SORT_VQSORT_TARGETS_TOGGLE
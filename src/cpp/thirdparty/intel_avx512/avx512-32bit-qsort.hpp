@@ -656,6 +656,47 @@ qsort_32bit_(type_t *arr, int64_t left, int64_t right, int64_t max_iters)
         qsort_32bit_<vtype>(arr, pivot_index, right, max_iters - 1);
 }
 
+/*
+ * Same as qsort_32bit_, except that it only recurses into the side that
+ * holds pos.
+ */
+template <typename vtype, typename type_t>
+static void qselect_32bit_(type_t *arr,
+                            int64_t pos,
+                            int64_t left,
+                            int64_t right,
+                            int64_t max_iters)
+{
+    /*
+     * Resort to std::sort if quickselect isnt making any progress
+     */
+    if (max_iters <= 0) {
+        std::sort(arr + left, arr + right + 1);
+        return;
+    }
+    /*
+     * Base case: use bitonic networks to sort arrays <= 128
+     */
+    if (right + 1 - left <= 128) {
+        sort_128_32bit<vtype>(arr + left, (int32_t)(right + 1 - left));
+        return;
+    }
+
+    type_t pivot = get_pivot_32bit<vtype>(arr, left, right);
+    type_t smallest = vtype::type_max();
+    type_t biggest = vtype::type_min();
+    int64_t pivot_index = partition_avx512<vtype>(
+            arr, left, right + 1, pivot, &smallest, &biggest);
+    /*
+     * If pivot == smallest the left side is empty, if pivot == biggest the
+     * right side only holds copies of the pivot and is done.
+     */
+    if ((pivot != smallest) && (pos < pivot_index))
+        qselect_32bit_<vtype>(arr, pos, left, pivot_index - 1, max_iters - 1);
+    else if ((pivot != biggest) && (pos >= pivot_index))
+        qselect_32bit_<vtype>(arr, pos, pivot_index, right, max_iters - 1);
+}
+
 X86_SIMD_SORT_INLINE int64_t replace_nan_with_inf(float *arr, int64_t arrsize)
 {
     int64_t nan_count = 0;
@@ -710,4 +751,41 @@ void avx512_qsort<float>(float *arr, int64_t arrsize)
     }
 }
 
+template <>
+void avx512_qselect<int32_t>(int32_t *arr, int64_t k, int64_t arrsize)
+{
+    if (arrsize > 1) {
+        qselect_32bit_<zmm_vector<int32_t>, int32_t>(
+                arr, k, 0, arrsize - 1, 2 * (int64_t)log2(arrsize));
+    }
+}
+
+template <>
+void avx512_qselect<uint32_t>(uint32_t *arr, int64_t k, int64_t arrsize)
+{
+    if (arrsize > 1) {
+        qselect_32bit_<zmm_vector<uint32_t>, uint32_t>(
+                arr, k, 0, arrsize - 1, 2 * (int64_t)log2(arrsize));
+    }
+}
+
+template <>
+int64_t avx512_partition<int32_t>(int32_t *arr, int64_t arrsize, int32_t pivot)
+{
+    int32_t smallest = zmm_vector<int32_t>::type_max();
+    int32_t biggest = zmm_vector<int32_t>::type_min();
+    return partition_avx512<zmm_vector<int32_t>>(
+            arr, 0, arrsize, pivot, &smallest, &biggest);
+}
+
+template <>
+int64_t
+avx512_partition<uint32_t>(uint32_t *arr, int64_t arrsize, uint32_t pivot)
+{
+    uint32_t smallest = zmm_vector<uint32_t>::type_max();
+    uint32_t biggest = zmm_vector<uint32_t>::type_min();
+    return partition_avx512<zmm_vector<uint32_t>>(
+            arr, 0, arrsize, pivot, &smallest, &biggest);
+}
+
 #endif //AVX512_QSORT_32BIT
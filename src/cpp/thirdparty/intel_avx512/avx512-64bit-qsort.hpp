@@ -769,6 +769,47 @@ qsort_64bit_(type_t *arr, int64_t left, int64_t right, int64_t max_iters)
         qsort_64bit_<vtype>(arr, pivot_index, right, max_iters - 1);
 }
 
+/*
+ * Same as qsort_64bit_, except that it only recurses into the side that
+ * holds pos.
+ */
+template <typename vtype, typename type_t>
+static void qselect_64bit_(type_t *arr,
+                            int64_t pos,
+                            int64_t left,
+                            int64_t right,
+                            int64_t max_iters)
+{
+    /*
+     * Resort to std::sort if quickselect isnt making any progress
+     */
+    if (max_iters <= 0) {
+        std::sort(arr + left, arr + right + 1);
+        return;
+    }
+    /*
+     * Base case: use bitonic networks to sort arrays <= 128
+     */
+    if (right + 1 - left <= 128) {
+        sort_128_64bit<vtype>(arr + left, (int32_t)(right + 1 - left));
+        return;
+    }
+
+    type_t pivot = get_pivot_64bit<vtype>(arr, left, right);
+    type_t smallest = vtype::type_max();
+    type_t biggest = vtype::type_min();
+    int64_t pivot_index = partition_avx512<vtype>(
+            arr, left, right + 1, pivot, &smallest, &biggest);
+    /*
+     * If pivot == smallest the left side is empty, if pivot == biggest the
+     * right side only holds copies of the pivot and is done.
+     */
+    if ((pivot != smallest) && (pos < pivot_index))
+        qselect_64bit_<vtype>(arr, pos, left, pivot_index - 1, max_iters - 1);
+    else if ((pivot != biggest) && (pos >= pivot_index))
+        qselect_64bit_<vtype>(arr, pos, pivot_index, right, max_iters - 1);
+}
+
 X86_SIMD_SORT_INLINE int64_t replace_nan_with_inf(double *arr, int64_t arrsize)
 {
     int64_t nan_count = 0;
@@ -822,4 +863,42 @@ void avx512_qsort<double>(double *arr, int64_t arrsize)
         replace_inf_with_nan(arr, arrsize, nan_count);
     }
 }
+
+template <>
+void avx512_qselect<int64_t>(int64_t *arr, int64_t k, int64_t arrsize)
+{
+    if (arrsize > 1) {
+        qselect_64bit_<zmm_vector<int64_t>, int64_t>(
+                arr, k, 0, arrsize - 1, 2 * (int64_t)log2(arrsize));
+    }
+}
+
+template <>
+void avx512_qselect<uint64_t>(uint64_t *arr, int64_t k, int64_t arrsize)
+{
+    if (arrsize > 1) {
+        qselect_64bit_<zmm_vector<uint64_t>, uint64_t>(
+                arr, k, 0, arrsize - 1, 2 * (int64_t)log2(arrsize));
+    }
+}
+
+template <>
+int64_t avx512_partition<int64_t>(int64_t *arr, int64_t arrsize, int64_t pivot)
+{
+    int64_t smallest = zmm_vector<int64_t>::type_max();
+    int64_t biggest = zmm_vector<int64_t>::type_min();
+    return partition_avx512<zmm_vector<int64_t>>(
+            arr, 0, arrsize, pivot, &smallest, &biggest);
+}
+
+template <>
+int64_t
+avx512_partition<uint64_t>(uint64_t *arr, int64_t arrsize, uint64_t pivot)
+{
+    uint64_t smallest = zmm_vector<uint64_t>::type_max();
+    uint64_t biggest = zmm_vector<uint64_t>::type_min();
+    return partition_avx512<zmm_vector<uint64_t>>(
+            arr, 0, arrsize, pivot, &smallest, &biggest);
+}
+
 #endif // AVX512_QSORT_64BIT
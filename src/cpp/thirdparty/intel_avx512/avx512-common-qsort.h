@@ -87,6 +87,22 @@ struct zmm_vector;
 template <typename T>
 void avx512_qsort(T *arr, int64_t arrsize);
 
+/*
+ * Reorders arr such that arr[k] is the element that would be there if arr was
+ * sorted, with no bigger element before and no smaller element after it. Only
+ * provided for the integer types, there is no NaN handling.
+ */
+template <typename T>
+void avx512_qselect(T *arr, int64_t k, int64_t arrsize);
+
+/*
+ * Moves the elements less than pivot to the front of arr and returns their
+ * number, with the same partition qsort uses. Only provided for the integer
+ * types.
+ */
+template <typename T>
+int64_t avx512_partition(T *arr, int64_t arrsize, T pivot);
+
 template <typename vtype, typename T = typename vtype::type_t>
 bool comparison_func(const T &a, const T &b)
 {
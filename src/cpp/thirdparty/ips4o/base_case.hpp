@@ -97,7 +97,7 @@ inline bool isSorted(It begin, It end, Comp&& comp, ThreadPool& thread_pool) {
 
 template <class It, class Comp>
 inline bool sortSimpleCases(It begin, It end, Comp&& comp) {
-    if (begin == end) {
+    if (end - begin < 2) {
         return true;
     }
 
@@ -143,6 +143,13 @@ class Sorter<Cfg>::Classifier {
         IPS4OML_ASSUME_NOT(begin >= end);
         IPS4OML_ASSUME_NOT(begin > (end - kUnroll));
 
+#ifdef IPS4O_SIMD_CLASSIFIER
+        if constexpr (simd_classifier::is_supported<iterator, less>::value) {
+            begin = simd_classifier::classify<kLogBuckets, kEqualBuckets>(
+                    &splitter(0), &sortedSplitter(0), begin, end, yield);
+        }
+#endif
+
         bucket_type b[kUnroll];
         for (auto cutoff = end - kUnroll; begin <= cutoff; begin += kUnroll) {
             for (int i = 0; i < kUnroll; ++i)
@@ -203,9 +203,25 @@ struct Config {
     }
 };
 
+/**
+ * Allocates the buffers and the thread local and shared data of a sorter.
+ * placeLocal is called by each thread for the part of the buffers it owns.
+ * Buffers of different threads start kPageSize bytes apart at least.
+ */
+struct DefaultAllocator {
+    static constexpr std::size_t kPageSize = 1;
+
+    static char* allocate(std::size_t bytes) { return new char[bytes]; }
+
+    static void deallocate(char* ptr, std::size_t) { delete[] ptr; }
+
+    static void placeLocal(char*, std::size_t) {}
+};
+
 template <class It_, class Comp_, class Cfg = Config<>
 #if defined(_REENTRANT)
           , class ThreadPool_ = DefaultThreadPool
+          , class Alloc_ = DefaultAllocator
 #endif
         >
 struct ExtendedConfig : public Cfg {
@@ -239,6 +255,11 @@ struct ExtendedConfig : public Cfg {
 
     using SubThreadPool = ThreadJoiningThreadPool;
 
+    /**
+     * Memory allocation policy.
+     */
+    using Allocator = Alloc_;
+
     /**
      * Synchronization support for parallel algorithm.
      */
@@ -252,6 +273,8 @@ struct ExtendedConfig : public Cfg {
         constexpr void single(F&&) const {}
     };
 
+    using Allocator = DefaultAllocator;
+
     /**
      * Dummy thread pool.
      */
@@ -101,6 +101,8 @@ class Sorter {
                                     int num_threads);
 
     void setShared(SharedData* shared_);
+
+    void processSmallTasks(iterator begin);
 #endif
 
  private:
@@ -123,6 +125,10 @@ class Sorter {
     std::pair<int, bool> buildClassifier(iterator begin, iterator end,
                                          Classifier& classifier);
 
+    template <class SampleIt>
+    std::pair<int, bool> chooseSplitters(SampleIt splitter, diff_t step, int num_buckets,
+                                         Classifier& classifier);
+
     template <bool kEqualBuckets>
     __attribute__((flatten)) diff_t classifyLocally(iterator my_begin, iterator my_end);
 
@@ -153,8 +159,6 @@ class Sorter {
     std::pair<int, bool> partition(iterator begin, iterator end, diff_t* bucket_start,
                                    int my_id, int num_threads);
 
-    void processSmallTasks(iterator begin);
-
     void processBigTasks(const iterator begin, const diff_t stripe, const int my_id,
                          BufferStorage& buffer_storage,
                          std::vector<std::shared_ptr<SubThreadPool>>& tp_trash);
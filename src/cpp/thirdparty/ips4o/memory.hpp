@@ -70,32 +70,35 @@ static T* alignPointer(T* ptr, std::size_t alignment) {
 /**
  * Constructs an object at the specified alignment.
  */
-template <class T>
+template <class T, class Alloc = DefaultAllocator>
 class AlignedPtr {
  public:
     AlignedPtr() {}
 
     template <class... Args>
     explicit AlignedPtr(std::size_t alignment, Args&&... args)
-        : alloc_(new char[sizeof(T) + alignment])
-        , value_(new (alignPointer(alloc_, alignment)) T(std::forward<Args>(args)...)) {}
+        : alloc_(Alloc::allocate(sizeof(T) + alignment))
+        , value_(new (alignPointer(alloc_, alignment)) T(std::forward<Args>(args)...))
+        , size_(sizeof(T) + alignment) {}
 
     AlignedPtr(const AlignedPtr&) = delete;
     AlignedPtr& operator=(const AlignedPtr&) = delete;
 
-    AlignedPtr(AlignedPtr&& rhs) : alloc_(rhs.alloc_), value_(rhs.value_) {
+    AlignedPtr(AlignedPtr&& rhs)
+        : alloc_(rhs.alloc_), value_(rhs.value_), size_(rhs.size_) {
         rhs.alloc_ = nullptr;
     }
     AlignedPtr& operator=(AlignedPtr&& rhs) {
         std::swap(alloc_, rhs.alloc_);
         std::swap(value_, rhs.value_);
+        std::swap(size_, rhs.size_);
         return *this;
     }
 
     ~AlignedPtr() {
         if (alloc_) {
             value_->~T();
-            delete[] alloc_;
+            Alloc::deallocate(alloc_, size_);
         }
     }
 
@@ -104,35 +107,40 @@ class AlignedPtr {
  private:
     char* alloc_ = nullptr;
     T* value_;
+    std::size_t size_ = 0;
 };
 
 /**
  * Provides aligned storage without constructing an object.
  */
-template <>
-class AlignedPtr<void> {
+template <class Alloc>
+class AlignedPtr<void, Alloc> {
  public:
     AlignedPtr() {}
 
     template <class... Args>
     explicit AlignedPtr(std::size_t alignment, std::size_t size)
-        : alloc_(new char[size + alignment]), value_(alignPointer(alloc_, alignment)) {}
+        : alloc_(Alloc::allocate(size + alignment))
+        , value_(alignPointer(alloc_, alignment))
+        , size_(size + alignment) {}
 
     AlignedPtr(const AlignedPtr&) = delete;
     AlignedPtr& operator=(const AlignedPtr&) = delete;
 
-    AlignedPtr(AlignedPtr&& rhs) : alloc_(rhs.alloc_), value_(rhs.value_) {
+    AlignedPtr(AlignedPtr&& rhs)
+        : alloc_(rhs.alloc_), value_(rhs.value_), size_(rhs.size_) {
         rhs.alloc_ = nullptr;
     }
     AlignedPtr& operator=(AlignedPtr&& rhs) {
         std::swap(alloc_, rhs.alloc_);
         std::swap(value_, rhs.value_);
+        std::swap(size_, rhs.size_);
         return *this;
     }
 
     ~AlignedPtr() {
         if (alloc_) {
-            delete[] alloc_;
+            Alloc::deallocate(alloc_, size_);
         }
     }
 
@@ -141,23 +149,32 @@ class AlignedPtr<void> {
  private:
     char* alloc_ = nullptr;
     char* value_;
+    std::size_t size_ = 0;
 };
 
 /**
  * Aligned storage for use in buffers.
  */
 template <class Cfg>
-class Sorter<Cfg>::BufferStorage : public AlignedPtr<void> {
+class Sorter<Cfg>::BufferStorage
+        : public AlignedPtr<void, typename Cfg::Allocator> {
  public:
     static constexpr const auto kPerThread =
             Cfg::kBlockSizeInBytes * Cfg::kMaxBuckets * (1 + Cfg::kAllowEqualBuckets);
 
+    // Rounded up so that the buffers of different threads don't share a page.
+    static constexpr const std::size_t kStride =
+            (kPerThread + Cfg::Allocator::kPageSize - 1) / Cfg::Allocator::kPageSize
+            * Cfg::Allocator::kPageSize;
+
     BufferStorage() {}
 
     explicit BufferStorage(int num_threads)
-        : AlignedPtr<void>(Cfg::kDataAlignment, num_threads * kPerThread) {}
+        : AlignedPtr<void, typename Cfg::Allocator>(
+                std::max<std::size_t>(Cfg::kDataAlignment, Cfg::Allocator::kPageSize),
+                num_threads * kStride) {}
 
-    char* forThread(int id) { return this->get() + id * kPerThread; }
+    char* forThread(int id) { return this->get() + id * kStride; }
 };
 
 /**
@@ -205,11 +205,14 @@ void Sorter<Cfg>::processBigTaskPrimary(
     auto partial_thread_pool = shared_->thread_pools[id];
 
     using Sorter =
-            Sorter<ExtendedConfig<iterator, decltype(shared_->classifier.getComparator()),
-                                  Config<>, SubThreadPool>>;
+            Sorter<ExtendedConfig<iterator,
+                                  std::remove_reference_t<decltype(
+                                          shared_->classifier.getComparator())>,
+                                  Config<>, SubThreadPool,
+                                  typename Cfg::Allocator>>;
 
     // Create shared data.
-    detail::AlignedPtr<typename Sorter::SharedData> partial_shared_ptr(
+    detail::AlignedPtr<typename Sorter::SharedData, typename Cfg::Allocator> partial_shared_ptr(
             Cfg::kDataAlignment, shared_->classifier.getComparator(),
             partial_thread_pool->sync(), partial_thread_pool->numThreads());
     auto& partial_shared = partial_shared_ptr.get();
@@ -217,12 +220,12 @@ void Sorter<Cfg>::processBigTaskPrimary(
     // Create local data.
     typename Sorter::BufferStorage partial_buffer_storage(
             partial_thread_pool->numThreads());
-    std::unique_ptr<detail::AlignedPtr<typename Sorter::LocalData>[]> partial_local_ptrs(
-            new detail::AlignedPtr<
-                    typename Sorter::LocalData>[partial_thread_pool->numThreads()]);
+    using LocalPtr = detail::AlignedPtr<typename Sorter::LocalData, typename Cfg::Allocator>;
+    std::unique_ptr<LocalPtr[]> partial_local_ptrs(
+            new LocalPtr[partial_thread_pool->numThreads()]);
 
     for (int i = 0; i != partial_thread_pool->numThreads(); ++i) {
-        partial_local_ptrs[i] = detail::AlignedPtr<typename Sorter::LocalData>(
+        partial_local_ptrs[i] = LocalPtr(
                 Cfg::kDataAlignment, shared_->classifier.getComparator(),
                 buffer_storage.forThread(task.root_thread + i));
         partial_shared.local[i] = &partial_local_ptrs[i].get();
@@ -349,6 +352,7 @@ template <class Cfg>
 class ParallelSorter {
     using Sorter = detail::Sorter<Cfg>;
     using iterator = typename Cfg::iterator;
+    using LocalPtr = detail::AlignedPtr<typename Sorter::LocalData, typename Cfg::Allocator>;
 
  public:
     /**
@@ -361,13 +365,14 @@ class ParallelSorter {
         , shared_ptr_(Cfg::kDataAlignment, std::move(comp), thread_pool_.sync(),
                       thread_pool_.numThreads())
         , buffer_storage_(thread_pool_.numThreads())
-        , local_ptrs_(new detail::AlignedPtr<
-                      typename Sorter::LocalData>[thread_pool_.numThreads()])
+        , local_ptrs_(new LocalPtr[thread_pool_.numThreads()])
     {
         // Allocate local data and reuse memory of the previous recursion level
         thread_pool_([this](int my_id, int) {
             auto& shared = this->shared_ptr_.get();
-            this->local_ptrs_[my_id] = detail::AlignedPtr<typename Sorter::LocalData>(
+            Cfg::Allocator::placeLocal(buffer_storage_.forThread(my_id),
+                                       Sorter::BufferStorage::kStride);
+            this->local_ptrs_[my_id] = LocalPtr(
                     Cfg::kDataAlignment, shared.classifier.getComparator(),
                     buffer_storage_.forThread(my_id));
             shared.local[my_id] = &this->local_ptrs_[my_id].get();
@@ -412,12 +417,71 @@ class ParallelSorter {
                 num_threads);
     }
 
+    /**
+     * Sorts each segment [begin + offsets[i], begin + offsets[i + 1]) on its
+     * own. Segments larger than a thread's share of the total are sorted one
+     * after another using all threads. The other segments are queued as small
+     * tasks, which the scheduler balances across the threads.
+     */
+    template <class Offset>
+    void sortSegments(iterator begin, const Offset* offsets, std::size_t num_segments) {
+        using diff_t = typename Cfg::difference_type;
+
+        if (num_segments == 0) return;
+
+        const int num_threads = thread_pool_.numThreads();
+        const diff_t first = offsets[0];
+        const diff_t stripe =
+                (static_cast<diff_t>(offsets[num_segments]) - first + num_threads - 1)
+                / num_threads;
+
+        const auto is_big = [&](std::size_t i) {
+            return num_threads > 1
+                   && static_cast<diff_t>(offsets[i + 1] - offsets[i]) > stripe;
+        };
+
+        // The big segments use the task queues themselves, so they have to be
+        // done before any small task is queued.
+        for (std::size_t i = 0; i != num_segments; ++i) {
+            if (is_big(i)) (*this)(begin + offsets[i], begin + offsets[i + 1]);
+        }
+
+        auto& shared = shared_ptr_.get();
+        bool has_small_tasks = false;
+
+        for (std::size_t i = 0; i != num_segments; ++i) {
+            const diff_t segment_begin = offsets[i];
+            const diff_t segment_end = offsets[i + 1];
+
+            if (segment_end - segment_begin < 2 || is_big(i)) continue;
+
+            // Queue at the thread whose stripe the segment starts in, like
+            // queueTasks does, so that neighbouring segments stay on the same
+            // thread.
+            const auto thread = (segment_begin - first) / stripe;
+            shared.local[thread]->seq_task_queue.emplace(segment_begin, segment_end);
+            has_small_tasks = true;
+        }
+
+        if (!has_small_tasks) return;
+
+        shared.reset();
+        thread_pool_(
+                [this, begin](int my_id, int) {
+                    auto& shared = this->shared_ptr_.get();
+                    Sorter sorter(*shared.local[my_id]);
+                    sorter.setShared(&shared);
+                    sorter.processSmallTasks(begin);
+                },
+                num_threads);
+    }
+
  private:
     const bool check_sorted_;
     typename Cfg::ThreadPool thread_pool_;
-    detail::AlignedPtr<typename Sorter::SharedData> shared_ptr_;
+    detail::AlignedPtr<typename Sorter::SharedData, typename Cfg::Allocator> shared_ptr_;
     typename Sorter::BufferStorage buffer_storage_;
-    std::unique_ptr<detail::AlignedPtr<typename Sorter::LocalData>[]> local_ptrs_;
+    std::unique_ptr<LocalPtr[]> local_ptrs_;
 };
 
 }  // namespace ips4o
@@ -159,6 +159,13 @@ std::pair<int, bool> Sorter<Cfg>::partition(const iterator begin, const iterator
     g_overhead.start();
 #endif
 
+#ifdef SORT_TELEMETRY
+    if (my_id == 0) {
+        sort_telemetry::multiway_partition(end - begin, bucket_start, this->num_buckets_,
+                                           sort_telemetry::depth());
+    }
+#endif
+
     return {this->num_buckets_, use_equal_buckets};
 }
 
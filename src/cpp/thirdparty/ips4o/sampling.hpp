@@ -37,6 +37,7 @@
 
 #include <iterator>
 #include <random>
+#include <type_traits>
 #include <utility>
 
 #include "ips4o_fwd.hpp"
@@ -65,6 +66,20 @@ void selectSample(It begin, const It end,
     }
 }
 
+/**
+ * Comparators with a presetSample(begin, end) member can hand out a sorted
+ * sample of (1 << Cfg::kLogBuckets) - 1 elements for a range, which is used
+ * instead of sampling it. See ips4o_splitters.h of the wrappers.
+ */
+template <class Less, class It, class = void>
+struct HasPresetSample : std::false_type {};
+
+template <class Less, class It>
+struct HasPresetSample<Less, It,
+                       std::void_t<decltype(std::declval<const Less&>().presetSample(
+                               std::declval<It>(), std::declval<It>()))>>
+    : std::true_type {};
+
 /**
  * Builds the classifer.
  * Number of used_buckets is a power of two and at least two.
@@ -74,8 +89,19 @@ std::pair<int, bool> Sorter<Cfg>::buildClassifier(const iterator begin,
                                                   const iterator end,
                                                   Classifier& classifier) {
     const auto n = end - begin;
-    int log_buckets = Cfg::logBuckets(n);
-    int num_buckets = 1 << log_buckets;
+    const int log_buckets = Cfg::logBuckets(n);
+    const int num_buckets = 1 << log_buckets;
+
+    // A preset sample is only used above the last level, where the buckets
+    // are partitioned again instead of going to the base case in any case.
+    if constexpr (HasPresetSample<typename Cfg::less, iterator>::value) {
+        const auto* preset = classifier.getComparator().presetSample(begin, end);
+        if (preset != nullptr && n > Cfg::kSingleLevelThreshold) {
+            const auto step = diff_t{1} << (Cfg::kLogBuckets - log_buckets);
+            return chooseSplitters(preset + step - 1, step, num_buckets, classifier);
+        }
+    }
+
     const auto step = std::max<diff_t>(1, Cfg::oversamplingFactor(n));
     const auto num_samples = std::min(step * num_buckets - 1, n / 2);
 
@@ -84,7 +110,18 @@ std::pair<int, bool> Sorter<Cfg>::buildClassifier(const iterator begin,
 
     // Sort the sample
     sequential(begin, begin + num_samples);
-    auto splitter = begin + step - 1;
+    return chooseSplitters(begin + step - 1, step, num_buckets, classifier);
+}
+
+/**
+ * Takes every step-th element of a sorted sample as splitter, starting at
+ * splitter, and builds the classifier from them.
+ */
+template <class Cfg>
+template <class SampleIt>
+std::pair<int, bool> Sorter<Cfg>::chooseSplitters(SampleIt splitter, const diff_t step,
+                                                  int num_buckets,
+                                                  Classifier& classifier) {
     auto sorted_splitters = classifier.getSortedSplitters();
     auto comp = classifier.getComparator();
 
@@ -106,7 +143,7 @@ std::pair<int, bool> Sorter<Cfg>::buildClassifier(const iterator begin,
             && num_buckets - 1 - diff_splitters >= Cfg::kEqualBucketsThreshold;
 
     // Fill the array to the next power of two
-    log_buckets = log2(diff_splitters) + 1;
+    const int log_buckets = log2(diff_splitters) + 1;
     num_buckets = 1 << log_buckets;
     for (int i = diff_splitters + 1; i < num_buckets; ++i) {
         IPS4OML_ASSUME_NOT(sorted_splitters + 1 == nullptr);
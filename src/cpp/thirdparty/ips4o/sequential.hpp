@@ -125,6 +125,10 @@ void Sorter<Cfg>::sequential_rec(const iterator begin, const iterator end) {
     const auto n = end - begin;
     IPS4OML_IS_NOT(n <= 2 * Cfg::kBaseCaseSize);
 
+#ifdef SORT_TELEMETRY
+    sort_telemetry::DepthScope depth_scope;
+#endif
+
     diff_t bucket_start[Cfg::kMaxBuckets + 1];
 
     // Do the partitioning
@@ -192,10 +196,16 @@ class SequentialSorter {
         Sorter(local_ptr_.get()).sequential(std::move(begin), std::move(end));
     }
 
+    /**
+     * Reseeds the random generator used for sampling, which is seeded from
+     * std::random_device otherwise.
+     */
+    void seed(std::uintptr_t seed) { local_ptr_.get().random_generator.seed(seed); }
+
  private:
     const bool check_sorted_;
     typename Sorter::BufferStorage buffer_storage_;
-    detail::AlignedPtr<typename Sorter::LocalData> local_ptr_;
+    detail::AlignedPtr<typename Sorter::LocalData, typename Cfg::Allocator> local_ptr_;
 };
 
 }  // namespace ips4o
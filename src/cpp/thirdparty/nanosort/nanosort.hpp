@@ -149,6 +149,9 @@ void heap_sort(It first, It last, Compare comp) {
 
 template <typename T, typename It, typename Compare>
 void small_sort(It first, It last, Compare comp) {
+#ifdef SMALL_SORT_NETWORK
+  if (small_sort_network::try_sort(first, last, comp)) return;
+#endif
   size_t n = last - first;
 
   for (size_t i = n; i > 1; i -= 2) {
@@ -206,6 +209,61 @@ void sort(It first, It last, size_t limit, Compare comp) {
   }
 }
 
+// Same as sort, with the equal element handling of pdqsort. ancestor is the
+// pivot of a partition [first, last) is on the right side of, or null for the
+// leftmost ranges. No element is smaller than it, so a pivot that is not larger
+// than the ancestor equals it. All elements equal to the pivot then go to the
+// left in a single partition_rev, and are done.
+template <typename T, typename It, typename Compare>
+void sort_fat(It first, It last, size_t limit, Compare comp,
+              const T* ancestor) {
+  if (last - first < 16) {
+    small_sort<T>(first, last, comp);
+    return;
+  }
+
+  // Ancestor of the right side, once the loop continues there.
+  T bound(first[0]);
+
+  for (;;) {
+    if (last - first < 16) {
+      small_sort<T>(first, last, comp);
+      return;
+    }
+
+    if (NANOSORT_UNLIKELY(limit == 0)) {
+      heap_sort(first, last, comp);
+      return;
+    }
+
+    T pivot = median5<T>(first, last, comp);
+
+    if (ancestor && !comp(*ancestor, pivot)) {
+      first = partition_rev(pivot, first, last, comp);
+      continue;
+    }
+
+    It mid = partition(pivot, first, last, comp);
+
+    It midr = mid;
+    if (NANOSORT_UNLIKELY(mid - first <= (last - first) >> 3)) {
+      midr = partition_rev(pivot, mid, last, comp);
+    }
+
+    limit = (limit >> 1) + (limit >> 2);
+
+    if (mid - first <= last - midr) {
+      sort_fat<T>(first, mid, limit, comp, ancestor);
+      first = midr;
+      bound = NANOSORT_MOVE(pivot);
+      ancestor = &bound;
+    } else {
+      sort_fat<T>(midr, last, limit, comp, &pivot);
+      last = mid;
+    }
+  }
+}
+
 }  // namespace nanosort_detail
 
 template <typename It, typename Compare>
@@ -220,6 +278,13 @@ void nanosort(It first, It last) {
   nanosort_detail::sort<T>(first, last, last - first, nanosort_detail::Less());
 }
 
+template <typename It, typename Compare>
+void nanosort_fat(It first, It last, Compare comp) {
+  typedef typename nanosort_detail::IteratorTraits<It>::value_type T;
+  nanosort_detail::sort_fat<T>(first, last, last - first, comp,
+                               static_cast<const T*>(0));
+}
+
 /**
  * Copyright (c) 2021 Arseny Kapoulkine
  *
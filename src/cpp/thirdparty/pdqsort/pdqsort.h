@@ -400,12 +400,19 @@ namespace pdqsort_detail {
     inline void pdqsort_loop(Iter begin, Iter end, Compare comp, int bad_allowed, bool leftmost = true) {
         typedef typename std::iterator_traits<Iter>::difference_type diff_t;
 
+#ifdef SORT_TELEMETRY
+        sort_telemetry::DepthScope depth_scope;
+#endif
+
         // Use a while loop for tail recursion elimination.
         while (true) {
             diff_t size = end - begin;
 
             // Insertion sort is faster for small arrays.
             if (size < insertion_sort_threshold) {
+#ifdef SMALL_SORT_NETWORK
+                if (small_sort_network::try_sort(begin, end, comp)) return;
+#endif
                 if (leftmost) insertion_sort(begin, end, comp);
                 else unguarded_insertion_sort(begin, end, comp);
                 return;
@@ -442,11 +449,17 @@ namespace pdqsort_detail {
             diff_t l_size = pivot_pos - begin;
             diff_t r_size = end - (pivot_pos + 1);
             bool highly_unbalanced = l_size < size / 8 || r_size < size / 8;
+#ifdef SORT_TELEMETRY
+            sort_telemetry::partition(size, l_size, sort_telemetry::depth());
+#endif
 
             // If we got a highly unbalanced partition we shuffle elements to break many patterns.
             if (highly_unbalanced) {
                 // If we had too many bad partitions, switch to heapsort to guarantee O(n log n).
                 if (--bad_allowed == 0) {
+#ifdef SORT_TELEMETRY
+                    sort_telemetry::fallback(size, sort_telemetry::depth());
+#endif
                     std::make_heap(begin, end, comp);
                     std::sort_heap(begin, end, comp);
                     return;
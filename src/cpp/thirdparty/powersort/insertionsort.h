@@ -7,6 +7,8 @@
 #include <iterator>
 #include <algorithm>
 #include <cassert>
+#include <functional>
+#include <utility>
 
 namespace algorithms
 {
@@ -15,18 +17,24 @@ namespace algorithms
 	 * sorts [begin,end) using insertionsort, assuming that [begin,beginUnsorted)
 	 * is already in order.
 	 **/
-	template<typename Iter>
-	void insertionsort(Iter begin, Iter end, Iter beginUnsorted)
+	template<typename Iter, typename Compare = std::less<>>
+	void insertionsort(Iter begin, Iter end, Iter beginUnsorted, Compare comp = {})
 	{
 		assert(begin <= beginUnsorted && begin <= end);
 		for (Iter i = beginUnsorted; i < end; ++i) {
-			Iter j = i; const auto v = *i;
-			while (v < *(j-1)) {
-				*j = *(j-1);
-				--j;
-				if (j <= begin) break;
+			Iter j = i; auto v = std::move(*i);
+			try {
+				while (comp(v, *(j-1))) {
+					*j = std::move(*(j-1));
+					--j;
+					if (j <= begin) break;
+				}
+			} catch (...) {
+				// Fill the hole, so a throwing comp leaves a permutation of the input behind.
+				*j = std::move(v);
+				throw;
 			}
-			*j = v;
+			*j = std::move(v);
 		}
 	}
 
@@ -34,10 +42,10 @@ namespace algorithms
 	 * sorts [begin,end) using insertionsort, assuming that the first
 	 * nPresorted elements are already in sorted order.
 	 **/
-	template<typename Iter>
-	inline void insertionsort(Iter begin, Iter end, size_t nPresorted = 1)
+	template<typename Iter, typename Compare = std::less<>>
+	inline void insertionsort(Iter begin, Iter end, size_t nPresorted = 1, Compare comp = {})
 	{
-		insertionsort(begin, end, begin + nPresorted);
+		insertionsort(begin, end, begin + nPresorted, comp);
 	}
 
 
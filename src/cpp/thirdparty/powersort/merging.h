@@ -4,6 +4,10 @@
 #define MERGESORTS_MERGING_H
 
 #include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <type_traits>
 
 namespace algorithms {
 
@@ -12,8 +16,8 @@ namespace algorithms {
 #else
 	const bool COUNT_MERGE_COSTS = false;
 #endif
-	long long totalMergeCosts = 0;
-	long long totalBufferCosts = 0;
+	inline long long totalMergeCosts = 0;
+	inline long long totalBufferCosts = 0;
 
     /**
      * A sentinel value used by some merging method;
@@ -33,16 +37,49 @@ namespace algorithms {
 
 
 
+    /**
+     * Uninitialized storage for the merge buffer. The merges construct the elements they
+     * move there and destroy them again, so T needs neither a default constructor nor a copy
+     * constructor.
+     */
+    template<typename T>
+    class merge_buffer {
+    public:
+        merge_buffer() = default;
+        merge_buffer(const merge_buffer&) = delete;
+        merge_buffer& operator=(const merge_buffer&) = delete;
+        ~merge_buffer() {
+            if (_data != nullptr) std::allocator<T>{}.deallocate(_data, _len);
+        }
+
+        /** Returns storage for at least len elements, reusing the previous one if it fits. */
+        T* reserve(size_t len) {
+            if (len > _len) {
+                if (_data != nullptr) std::allocator<T>{}.deallocate(_data, _len);
+                _data = std::allocator<T>{}.allocate(len);
+                _len = len;
+            }
+            return _data;
+        }
+
+    private:
+        T* _data = nullptr;
+        size_t _len = 0;
+    };
+
     enum merging_methods {
         UNSTABLE_BITONIC_MERGE  /** @deprecated */,
         UNSTABLE_BITONIC_MERGE_MANUAL_COPY  /** @deprecated not faster */,
         UNSTABLE_BITONIC_MERGE_BRANCHLESS  /** @deprecated not faster */,
         COPY_SMALLER,
         COPY_BOTH,
+        COPY_BOTH_BIDIRECTIONAL,
+        COPY_BOTH_PREFETCH,
+        COPY_BOTH_BLOCKWISE,
         // COPY_BOTH_WITH_SENTINELS
     };
 
-    std::string to_string(merging_methods mergingMethod) {
+    inline std::string to_string(merging_methods mergingMethod) {
         switch (mergingMethod) {
             case UNSTABLE_BITONIC_MERGE:
                 return "UNSTABLE_BITONIC_MERGE";
@@ -54,6 +91,12 @@ namespace algorithms {
                 return "COPY_SMALLER";
             case COPY_BOTH:
                 return "COPY_BOTH";
+            case COPY_BOTH_BIDIRECTIONAL:
+                return "COPY_BOTH_BIDIRECTIONAL";
+            case COPY_BOTH_PREFETCH:
+                return "COPY_BOTH_PREFETCH";
+            case COPY_BOTH_BLOCKWISE:
+                return "COPY_BOTH_BLOCKWISE";
             // case COPY_BOTH_WITH_SENTINELS:
             //     return "COPY_BOTH_WITH_SENTINELS";
             default:
@@ -71,15 +114,15 @@ namespace algorithms {
 	 * This method is not stable as is;
 	 * it could be made so using an infinity-sentinel between the runs.
 	 */
-	template<typename Iter, typename Iter2>
-	void merge_runs_bitonic(Iter l, Iter m, Iter r, Iter2 B) {
+	template<typename Iter, typename Iter2, typename Compare = std::less<>>
+	void merge_runs_bitonic(Iter l, Iter m, Iter r, Iter2 B, Compare comp = {}) {
 		if (COUNT_MERGE_COSTS) totalMergeCosts += (r-l);
 		std::copy_backward(l,m,B+(m-l));
         std::reverse_copy(m,r,B+(m-l));
         if (COUNT_MERGE_COSTS) totalBufferCosts += (r-l);
         auto i = B, j = B+(r-l-1);
 		for (auto k = l; k < r; ++k)
-			*k = *j < *i ? *j-- : *i++;
+			*k = comp(*j, *i) ? *j-- : *i++;
 	}
 
 	/**
@@ -90,8 +133,8 @@ namespace algorithms {
 	 *
 	 * (same as above, but with manual copy in loops; slightly slower than above)
 	 */
-	template<typename Iter, typename Iter2>
-	void merge_runs_bitonic_manual_copy(Iter l, Iter m, Iter r, Iter2 B) {
+	template<typename Iter, typename Iter2, typename Compare = std::less<>>
+	void merge_runs_bitonic_manual_copy(Iter l, Iter m, Iter r, Iter2 B, Compare comp = {}) {
 		Iter i1, j1; Iter2 b;
 		if (COUNT_MERGE_COSTS) totalMergeCosts += (r-l);
 		for (i1 = m-1, b = B+(m-1-l); i1 >= l;) *b-- = *i1--;
@@ -99,7 +142,7 @@ namespace algorithms {
         if (COUNT_MERGE_COSTS) totalBufferCosts += (r-l);
 		auto i = B, j = B+(r-l-1);
 		for (auto k = l; k < r; ++k)
-			*k = *j < *i ? *j-- : *i++;
+			*k = comp(*j, *i) ? *j-- : *i++;
 	}
 
 	/**
@@ -112,15 +155,15 @@ namespace algorithms {
 	 * and apparently not needed; recent compilers seem to compile above
 	 * to branchless code, as well.)
 	 */
-	template<typename Iter, typename Iter2>
-	void merge_runs_bitonic_branchless(Iter l, Iter m, Iter r, Iter2 B) {
+	template<typename Iter, typename Iter2, typename Compare = std::less<>>
+	void merge_runs_bitonic_branchless(Iter l, Iter m, Iter r, Iter2 B, Compare comp = {}) {
 		if (COUNT_MERGE_COSTS) totalMergeCosts += (r-l);
 		std::copy_backward(l,m,B+(m-l));
 		std::reverse_copy(m,r,B+(m-l));
         if (COUNT_MERGE_COSTS) totalBufferCosts += (r-l);
 		Iter2 i = B, j = B+(r-l-1);
 		for (auto k = l; k < r; ++k) {
-			bool const cmp = *j < *i;
+			bool const cmp = comp(*j, *i);
 			*k = cmp ? *j : *i;
 			j -= cmp ? 1 : 0;
 			i += cmp ? 0 : 1;
@@ -133,8 +176,8 @@ namespace algorithms {
 	 * merging back into A.
 	 * B must have space at least min(m-l,r-m+1)
 	 */
-	template<typename Iter, typename Iter2>
-	void merge_runs_copy_half(Iter l, Iter m, Iter r, Iter2 B) {
+	template<typename Iter, typename Iter2, typename Compare = std::less<>>
+	void merge_runs_copy_half(Iter l, Iter m, Iter r, Iter2 B, Compare comp = {}) {
 		auto n1 = m-l, n2 = r-m;
 		if (COUNT_MERGE_COSTS) totalMergeCosts += (n1+n2);
         if (n1 <= n2) {
@@ -143,7 +186,7 @@ namespace algorithms {
             auto c1 = B, e1 = B + n1;
             auto c2 = m, e2 = r, o = l;
             while (c1 < e1 && c2 < e2)
-                *o++ = *c1 <= *c2 ? *c1++ : *c2++;
+                *o++ = !comp(*c2, *c1) ? *c1++ : *c2++;
             while (c1 < e1) *o++ = *c1++;
         } else {
             std::copy(m,r,B);
@@ -151,28 +194,197 @@ namespace algorithms {
             auto c1 = m-1, s1 = l, o = r-1;
             auto c2 = B+n2-1, s2 = B;
             while (c1 >= s1 && c2 >= s2)
-                *o-- = *c1 <= *c2 ? *c2-- : *c1--;
+                *o-- = !comp(*c2, *c1) ? *c2-- : *c1--;
             while (c2 >= s2) *o-- = *c2--;
         }
 	}
 
 	/**
 	 * Merges runs A[l..m) and A[m..r) in-place into A[l..r)
-	 * by copying both to buffer B and merging back into A.
+	 * by moving both to uninitialized buffer B and merging back into A.
 	 * B must have space at least r-l.
 	 */
-	template<typename Iter, typename Iter2>
-	void merge_runs_basic(Iter l, Iter m, Iter r, Iter2 B) {
+	template<typename Iter, typename Iter2, typename Compare = std::less<>>
+	void merge_runs_basic(Iter l, Iter m, Iter r, Iter2 B, Compare comp = {}) {
 		auto n1 = m-l, n2 = r-m;
 		if (COUNT_MERGE_COSTS) totalMergeCosts += (n1+n2);
-        std::copy(l,r,B);
+        std::uninitialized_move(l,r,B);
         if (COUNT_MERGE_COSTS) totalBufferCosts += (n1+n2);
         auto c1 = B, e1 = B + n1, c2 = e1, e2 = e1 + n2;
         auto o = l;
-        while (c1 < e1 && c2 < e2)
-            *o++ = *c1 <= *c2 ? *c1++ : *c2++;
-        while (c1 < e1) *o++ = *c1++;
-        while (c2 < e2) *o++ = *c2++;
+        try {
+            while (c1 < e1 && c2 < e2)
+                *o++ = std::move(!comp(*c2, *c1) ? *c1++ : *c2++);
+        } catch (...) {
+            // Move back what is left, so a throwing comp leaves a permutation of A[l..r) behind.
+            o = std::move(c1, e1, o);
+            std::move(c2, e2, o);
+            std::destroy(B, B + (n1+n2));
+            throw;
+        }
+        o = std::move(c1, e1, o);
+        std::move(c2, e2, o);
+        std::destroy(B, B + (n1+n2));
+	}
+
+	/**
+	 * Merges the runs [l1..e1) and [l2..e2) into [o..), checking both bounds in every step.
+	 */
+	template<typename Iter, typename Iter2, typename Compare = std::less<>>
+	Iter2 merge_forward_checked(Iter l1, Iter e1, Iter l2, Iter e2, Iter2 o, Compare comp = {}) {
+		while (l1 < e1 && l2 < e2)
+			*o++ = comp(*l2, *l1) ? *l2++ : *l1++;
+		o = std::copy(l1, e1, o);
+		return std::copy(l2, e2, o);
+	}
+
+	/**
+	 * Merges runs [l..m) and [m..r) into [o..o+(r-l)), the input is left untouched.
+	 *
+	 * Every step writes one element at the front, the smaller of the two run heads,
+	 * and one at the back, the larger of the two run tails, without branches or sentinels.
+	 * For min(m-l, r-m) steps neither end can leave its runs, whatever comp returns, so
+	 * that part needs no bounds checks. What is left in the middle is merged with checks.
+	 *
+	 * If comp is not a strict weak ordering both ends may have taken the same element,
+	 * then the output is redone with a plain merge to keep it a permutation of the input.
+	 */
+	template<typename Iter, typename Iter2, typename Compare = std::less<>>
+	void merge_bidirectional(Iter l, Iter m, Iter r, Iter2 o, Compare comp = {}) {
+		const auto steps = std::min(m - l, r - m);
+		Iter c1 = l, c2 = m; // heads
+		Iter e1 = m, e2 = r; // one past the tails
+		Iter2 o_front = o, o_back = o + (r - l);
+		for (auto i = steps; i > 0; --i) {
+			const bool take2 = comp(*c2, *c1);
+			*o_front++ = *(take2 ? c2 : c1);
+			c2 += take2;
+			c1 += !take2;
+
+			const bool take1 = comp(*(e2 - 1), *(e1 - 1));
+			*--o_back = *(take1 ? e1 - 1 : e2 - 1);
+			e1 -= take1;
+			e2 -= !take1;
+		}
+
+		if (c1 > e1 || c2 > e2) {
+			merge_forward_checked(l, m, m, r, o, comp);
+			return;
+		}
+		merge_forward_checked(c1, e1, c2, e2, o_front, comp);
+	}
+
+	/**
+	 * Merges runs A[l..m) and A[m..r) in-place into A[l..r)
+	 * by copying both to buffer B and merging back into A from both ends, see merge_bidirectional.
+	 * Same result as merge_runs_basic, without its sentinel requirements.
+	 * B must have space at least r-l.
+	 */
+	template<typename Iter, typename Iter2, typename Compare = std::less<>>
+	void merge_runs_bidirectional(Iter l, Iter m, Iter r, Iter2 B, Compare comp = {}) {
+		typedef typename std::iterator_traits<Iter>::value_type T;
+		if constexpr (!std::is_trivially_copyable_v<T>) {
+			// merge_bidirectional reads the input again if comp is inconsistent, moving
+			// from it would leave that empty. Take the plain merge instead.
+			merge_runs_basic(l, m, r, B, comp);
+		} else {
+			auto n1 = m-l, n2 = r-m;
+			if (COUNT_MERGE_COSTS) totalMergeCosts += (n1+n2);
+			std::copy(l,r,B);
+			if (COUNT_MERGE_COSTS) totalBufferCosts += (n1+n2);
+			merge_bidirectional(B, B + n1, B + (n1+n2), l, comp);
+		}
+	}
+
+	/**
+	 * Bytes the prefetching merges read ahead of the run heads and write ahead of the output, a
+	 * few cache lines, but at least one element.
+	 */
+	inline constexpr size_t MERGE_PREFETCH_BYTES = 256;
+
+	/** Prefetches the cache lines of the element at p, at most MERGE_PREFETCH_BYTES of it. */
+	template<int rw, typename T>
+	inline void prefetch_elem(const T* p) {
+		constexpr size_t lines = (std::min(sizeof(T), MERGE_PREFETCH_BYTES) + 63) / 64;
+		const char* bytes = reinterpret_cast<const char*>(p);
+		for (size_t i = 0; i < lines; ++i) __builtin_prefetch(bytes + i * 64, rw);
+	}
+
+	/**
+	 * Merges runs A[l..m) and A[m..r) in-place into A[l..r)
+	 * like merge_runs_basic, but for large elements. Every step prefetches the element
+	 * MERGE_PREFETCH_BYTES ahead of both run heads and of the output, so the loads of the
+	 * comparison and the stores of the move don't wait for memory.
+	 * B must have space at least r-l.
+	 */
+	template<typename Iter, typename Iter2, typename Compare = std::less<>>
+	void merge_runs_prefetch(Iter l, Iter m, Iter r, Iter2 B, Compare comp = {}) {
+		typedef typename std::iterator_traits<Iter>::value_type T;
+		if constexpr (!std::is_trivially_copyable_v<T>) {
+			merge_runs_basic(l, m, r, B, comp);
+		} else {
+			constexpr ptrdiff_t ahead = std::max<size_t>(MERGE_PREFETCH_BYTES / sizeof(T), 1);
+			auto n1 = m-l, n2 = r-m;
+			if (COUNT_MERGE_COSTS) totalMergeCosts += (n1+n2);
+			std::copy(l,r,B);
+			if (COUNT_MERGE_COSTS) totalBufferCosts += (n1+n2);
+			auto c1 = B, e1 = B + n1, c2 = e1, e2 = e1 + n2;
+			auto o = l;
+			while (c1 < e1 && c2 < e2) {
+				// Prefetching past the end of a run is harmless, it never faults.
+				prefetch_elem<0>(&*c1 + ahead);
+				prefetch_elem<0>(&*c2 + ahead);
+				prefetch_elem<1>(&*o + ahead);
+				const bool take2 = comp(*c2, *c1);
+				*o++ = *(take2 ? c2 : c1);
+				c2 += take2;
+				c1 += !take2;
+			}
+			o = std::copy(c1, e1, o);
+			std::copy(c2, e2, o);
+		}
+	}
+
+	/**
+	 * Merges runs A[l..m) and A[m..r) in-place into A[l..r)
+	 * like merge_runs_basic, but moves every stretch of consecutive elements taken from the same
+	 * run with a single std::copy, a memmove for trivial types. After a stretch ends the other
+	 * run is known to go next, so this needs no more comparisons than the plain merge.
+	 * B must have space at least r-l.
+	 */
+	template<typename Iter, typename Iter2, typename Compare = std::less<>>
+	void merge_runs_blockwise(Iter l, Iter m, Iter r, Iter2 B, Compare comp = {}) {
+		typedef typename std::iterator_traits<Iter>::value_type T;
+		if constexpr (!std::is_trivially_copyable_v<T>) {
+			merge_runs_basic(l, m, r, B, comp);
+		} else {
+			auto n1 = m-l, n2 = r-m;
+			if (COUNT_MERGE_COSTS) totalMergeCosts += (n1+n2);
+			std::copy(l,r,B);
+			if (COUNT_MERGE_COSTS) totalBufferCosts += (n1+n2);
+			auto c1 = B, e1 = B + n1, c2 = e1, e2 = e1 + n2;
+			auto o = l;
+			if (c1 < e1 && c2 < e2) {
+				bool take2 = comp(*c2, *c1);
+				while (true) {
+					if (take2) {
+						auto s2 = c2;
+						do ++c2; while (c2 < e2 && comp(*c2, *c1));
+						o = std::copy(s2, c2, o);
+						if (c2 == e2) break;
+					} else {
+						// Ties go to the left run.
+						auto s1 = c1;
+						do ++c1; while (c1 < e1 && !comp(*c2, *c1));
+						o = std::copy(s1, c1, o);
+						if (c1 == e1) break;
+					}
+					take2 = !take2;
+				}
+			}
+			o = std::copy(c1, e1, o);
+			std::copy(c2, e2, o);
+		}
 	}
 
 	/**
@@ -199,76 +411,76 @@ namespace algorithms {
 
 #ifdef USE_OLD_RUN_DETECTION_LOOPS_WITH_IF_IN_BODY
 /** returns maximal i <= end s.t. [begin,i) is weakly increasing */
-	template<typename Iterator>
-	Iterator weaklyIncreasingPrefix(Iterator begin, Iterator end) {
+	template<typename Iterator, typename Compare = std::less<>>
+	Iterator weaklyIncreasingPrefix(Iterator begin, Iterator end, Compare comp = {}) {
 		while (begin + 1 < end)
-			if (*begin <= *(begin + 1)) ++begin;
+			if (!comp(*(begin + 1), *begin)) ++begin;
 			else break;
 		return begin + 1;
 	}
 
 	/** returns minimal i >= begin s.t. [i, end) is weakly increasing */
-	template<typename Iterator>
-	Iterator weaklyIncreasingSuffix(Iterator begin, Iterator end) {
+	template<typename Iterator, typename Compare = std::less<>>
+	Iterator weaklyIncreasingSuffix(Iterator begin, Iterator end, Compare comp = {}) {
 		while (end - 1 > begin)
-			if (*(end - 2) <= *(end - 1)) --end;
+			if (!comp(*(end - 1), *(end - 2))) --end;
 			else break;
 		return end - 1;
 	}
 
-	template<typename Iterator>
-	Iterator strictlyDecreasingPrefix(Iterator begin, Iterator end) {
+	template<typename Iterator, typename Compare = std::less<>>
+	Iterator strictlyDecreasingPrefix(Iterator begin, Iterator end, Compare comp = {}) {
 		while (begin + 1 < end)
-			if (*begin > *(begin + 1)) ++begin;
+			if (comp(*(begin + 1), *begin)) ++begin;
 			else break;
 		return begin + 1;
 	}
 
-	template<typename Iterator>
-	Iterator strictlyDecreasingSuffix(Iterator begin, Iterator end) {
+	template<typename Iterator, typename Compare = std::less<>>
+	Iterator strictlyDecreasingSuffix(Iterator begin, Iterator end, Compare comp = {}) {
 		while (end - 1 > begin)
-			if (*(end - 2) > *(end - 1)) --end;
+			if (comp(*(end - 1), *(end - 2))) --end;
 			else break;
 		return end - 1;
 	}
 #else
 	/** returns maximal i <= end s.t. [begin,i) is weakly increasing */
-	template<typename Iterator>
-	Iterator weaklyIncreasingPrefix(Iterator begin, Iterator end) {
-		while (begin + 1 < end && *begin <= *(begin + 1)) ++begin;
+	template<typename Iterator, typename Compare = std::less<>>
+	Iterator weaklyIncreasingPrefix(Iterator begin, Iterator end, Compare comp = {}) {
+		while (begin + 1 < end && !comp(*(begin + 1), *begin)) ++begin;
 		return begin + 1;
 	}
 
 	/** returns minimal i >= begin s.t. [i, end) is weakly increasing */
-	template<typename Iterator>
-	Iterator weaklyIncreasingSuffix(Iterator begin, Iterator end) {
-		while (end - 1 > begin && *(end - 2) <= *(end - 1)) --end;
+	template<typename Iterator, typename Compare = std::less<>>
+	Iterator weaklyIncreasingSuffix(Iterator begin, Iterator end, Compare comp = {}) {
+		while (end - 1 > begin && !comp(*(end - 1), *(end - 2))) --end;
 		return end - 1;
 	}
 
-	template<typename Iterator>
-	Iterator strictlyDecreasingPrefix(Iterator begin, Iterator end) {
-		while (begin + 1 < end &&  *begin > *(begin + 1)) ++begin;
+	template<typename Iterator, typename Compare = std::less<>>
+	Iterator strictlyDecreasingPrefix(Iterator begin, Iterator end, Compare comp = {}) {
+		while (begin + 1 < end && comp(*(begin + 1), *begin)) ++begin;
 		return begin + 1;
 	}
 
-	template<typename Iterator>
-	Iterator strictlyDecreasingSuffix(Iterator begin, Iterator end) {
-		while (end - 1 > begin && *(end - 2) > *(end - 1)) --end;
+	template<typename Iterator, typename Compare = std::less<>>
+	Iterator strictlyDecreasingSuffix(Iterator begin, Iterator end, Compare comp = {}) {
+		while (end - 1 > begin && comp(*(end - 1), *(end - 2))) --end;
 		return end - 1;
 	}
 #endif // USE_OLD_RUN_DETECTION_LOOPS_WITH_IF_IN_BODY
 
-	template<typename Iterator>
-	Iterator extend_and_reverse_run_right(Iterator begin, Iterator end) {
+	template<typename Iterator, typename Compare = std::less<>>
+	Iterator extend_and_reverse_run_right(Iterator begin, Iterator end, Compare comp = {}) {
 		Iterator j = begin;
 		if (j == end) return j;
 		if (j+1 == end) return j+1;
-		if (*j > *(j+1)) {
-			j = strictlyDecreasingPrefix(begin, end);
+		if (comp(*(j+1), *j)) {
+			j = strictlyDecreasingPrefix(begin, end, comp);
 			std::reverse(begin, j);
 		} else {
-			j = weaklyIncreasingPrefix(begin, end);
+			j = weaklyIncreasingPrefix(begin, end, comp);
 		}
 		return j;
 	}
@@ -276,25 +488,29 @@ namespace algorithms {
 
     /** Merges runs [l..m) and [m..r) in-place into [l..r) */
     template<merging_methods mergingMethod,
-            typename Iter, typename Iter2>
-    void merge_runs(Iter l, Iter m, Iter r, Iter2 B) {
-        switch(mergingMethod) {
-            case UNSTABLE_BITONIC_MERGE:
-                return merge_runs_bitonic(l, m, r, B);
-            case UNSTABLE_BITONIC_MERGE_MANUAL_COPY:
-                return merge_runs_bitonic_manual_copy(l, m, r, B);
-            case UNSTABLE_BITONIC_MERGE_BRANCHLESS:
-                return merge_runs_bitonic_branchless(l, m, r, B);
-            case COPY_SMALLER:
-                return merge_runs_copy_half(l, m, r, B);
-            case COPY_BOTH:
-                return merge_runs_basic(l, m, r, B);
-            // case COPY_BOTH_WITH_SENTINELS:
-            //     return merge_runs_basic_sentinels(l, m, r, B);
-            default:
-                assert(false);
-                __builtin_unreachable();
-        }
+            typename Iter, typename Iter2, typename Compare = std::less<>>
+    void merge_runs(Iter l, Iter m, Iter r, Iter2 B, Compare comp = {}) {
+        // Only the picked method is instantiated, the others need copyable elements.
+        if constexpr (mergingMethod == UNSTABLE_BITONIC_MERGE)
+            return merge_runs_bitonic(l, m, r, B, comp);
+        else if constexpr (mergingMethod == UNSTABLE_BITONIC_MERGE_MANUAL_COPY)
+            return merge_runs_bitonic_manual_copy(l, m, r, B, comp);
+        else if constexpr (mergingMethod == UNSTABLE_BITONIC_MERGE_BRANCHLESS)
+            return merge_runs_bitonic_branchless(l, m, r, B, comp);
+        else if constexpr (mergingMethod == COPY_SMALLER)
+            return merge_runs_copy_half(l, m, r, B, comp);
+        else if constexpr (mergingMethod == COPY_BOTH)
+            return merge_runs_basic(l, m, r, B, comp);
+        else if constexpr (mergingMethod == COPY_BOTH_BIDIRECTIONAL)
+            return merge_runs_bidirectional(l, m, r, B, comp);
+        else if constexpr (mergingMethod == COPY_BOTH_PREFETCH)
+            return merge_runs_prefetch(l, m, r, B, comp);
+        else if constexpr (mergingMethod == COPY_BOTH_BLOCKWISE)
+            return merge_runs_blockwise(l, m, r, B, comp);
+        // else if constexpr (mergingMethod == COPY_BOTH_WITH_SENTINELS)
+        //     return merge_runs_basic_sentinels(l, m, r, B);
+        else
+            static_assert(mergingMethod != mergingMethod, "Unknown merging method");
     }
 
 
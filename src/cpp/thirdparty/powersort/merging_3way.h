@@ -257,6 +257,7 @@ namespace algorithms {
             case merging4way_methods::GENERAL_INDICES:
             case merging4way_methods::GENERAL_BY_STAGES:
             case merging4way_methods::FOR_NUMERIC_DATA_PLAIN_MIN:
+            case merging4way_methods::GENERAL_BIDIRECTIONAL:
                 return false;
             default:
                 assert(false);
@@ -270,20 +271,17 @@ namespace algorithms {
        */
     template<merging4way_methods mergingMethod, typename Iter, typename Iter2>
     void merge_3runs(Iter l, Iter g1, Iter g2, Iter r, Iter2 B) {
-        switch (mergingMethod) {
-            case merging4way_methods::WILLEM_WITH_INDICES:
-                merge_3runs_numeric_willem_a(l, g1, g2, r, B);
-                break;
-            case merging4way_methods::WILLEM_TUNED:
-                merge_3runs_numeric_willem_tuned(l, g1, g2, r, B);
-                break;
-            case merging4way_methods::GENERAL_BY_STAGES_SPLIT:
-                merge_3runs_by_stages_split(l, g1, g2, r, B);
-                break;
-            default:
-                // use 4way with empty 4th run
-                assert(!has_specialized_3way_merge<mergingMethod>());
-                merge_4runs<mergingMethod>(l, g1, g2, r, r, B);
+        // Only the picked method is instantiated, same as merge_4runs.
+        if constexpr (mergingMethod == merging4way_methods::WILLEM_WITH_INDICES) {
+            merge_3runs_numeric_willem_a(l, g1, g2, r, B);
+        } else if constexpr (mergingMethod == merging4way_methods::WILLEM_TUNED) {
+            merge_3runs_numeric_willem_tuned(l, g1, g2, r, B);
+        } else if constexpr (mergingMethod == merging4way_methods::GENERAL_BY_STAGES_SPLIT) {
+            merge_3runs_by_stages_split(l, g1, g2, r, B);
+        } else {
+            // use 4way with empty 4th run
+            assert(!has_specialized_3way_merge<mergingMethod>());
+            merge_4runs<mergingMethod>(l, g1, g2, r, r, B);
         }
     }
 
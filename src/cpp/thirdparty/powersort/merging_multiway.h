@@ -9,6 +9,7 @@
 #include <limits>
 #include <cassert>
 #include <tuple>
+#include <type_traits>
 
 
 
@@ -723,6 +724,36 @@ namespace algorithms {
     }
 
 
+    /**
+     * 4way merge as two stages of branchless 2way merges from both ends; does not require a sentinel value.
+     *
+     * Merges runs [l..g1) and [g1..g2) and [g2..g3) and [g3..r) in-place into [l..r)
+     * using a buffer at B of length at least r-l.
+     *
+     * The pairs are merged into B, and the two results back into [l..r), see merge_bidirectional.
+     * That moves every element twice, same as copying to B and merging back with a tournament tree,
+     * and also takes two comparisons per element.
+     */
+    template<typename Iter, typename Iter2>
+    void merge_4runs_bidirectional(Iter l, Iter g1, Iter g2, Iter g3, Iter r, Iter2 B) {
+        typedef typename std::iterator_traits<Iter>::value_type T;
+        if constexpr (!std::is_trivially_copyable_v<T>) {
+            // Same plain merges as merge_runs_bidirectional takes for these types, the pairs
+            // and then both halves, which moves every element four times instead of twice.
+            merge_runs_basic(l, g1, g2, B);
+            merge_runs_basic(g2, g3, r, B);
+            merge_runs_basic(l, g2, r, B);
+        } else {
+            const auto n = r - l;
+            if (COUNT_MERGE_COSTS) totalMergeCosts += n;
+            merge_bidirectional(l, g1, g2, B);
+            merge_bidirectional(g2, g3, r, B + (g2 - l));
+            if (COUNT_MERGE_COSTS) totalBufferCosts += n;
+            merge_bidirectional(B, B + (g2 - l), B + n, l);
+        }
+    }
+
+
     /** Helper methods for merge_4runs_explicit_nodes */
     namespace private_explicit_nodes_ {
         template<typename Iter2>
@@ -810,7 +841,8 @@ namespace algorithms {
         GENERAL_NO_SENTINELS  /** @deprecated */,
         GENERAL_INDICES  /** @deprecated */,
         GENERAL_BY_STAGES,
-        GENERAL_BY_STAGES_SPLIT
+        GENERAL_BY_STAGES_SPLIT,
+        GENERAL_BIDIRECTIONAL
     };
 
     std::string to_string(merging4way_methods implementation) {
@@ -835,6 +867,8 @@ namespace algorithms {
                 return "FOR_NUMERIC_DATA_PLAIN_MIN";
             case GENERAL_BY_STAGES_SPLIT:
                 return "GENERAL_BY_STAGES_SPLIT";
+            case GENERAL_BIDIRECTIONAL:
+                return "GENERAL_BIDIRECTIONAL";
         }
         assert(false);
         __builtin_unreachable();
@@ -846,32 +880,31 @@ namespace algorithms {
      */
     template<merging4way_methods mergingMethod, typename Iter, typename Iter2>
     void merge_4runs(Iter l, Iter g1, Iter g2, Iter g3, Iter r, Iter2 B) {
-        switch (mergingMethod) {
-            case merging4way_methods::FOR_NUMERIC_DATA:
-                return merge_4runs_numeric(l, g1, g2, g3, r, B);
-            case merging4way_methods::GENERAL_NO_SENTINELS:
-                return merge_4runs_explicit_nodes(l, g1, g2, g3, r, B);
-            case merging4way_methods::WILLEM:
-                return merge_4runs_numeric_willem(l, g1, g2, g3, r, B);
-            case merging4way_methods::WILLEM_TUNED:
-                return merge_4runs_numeric_willem_tuned(l, g1, g2, g3, r, B);
-            case merging4way_methods::WILLEM_VALUES:
-                return wb_merge4way3(l, g1, g2, g3, r, B);
-            case merging4way_methods::WILLEM_WITH_INDICES:
-                return merge_4runs_numeric_willem_a(l, g1, g2, g3, r, B);
-            case merging4way_methods::GENERAL_INDICES:
-                return merge_4runs_indices(l, g1, g2, g3, r, B);
-            case merging4way_methods::GENERAL_BY_STAGES:
-                return merge_4runs_by_stages(l, g1, g2, g3, r, B);
-            case merging4way_methods::FOR_NUMERIC_DATA_PLAIN_MIN:
-                return merge_4runs_numeric_plain_min(l, g1, g2, g3, r, B);
-            case merging4way_methods::GENERAL_BY_STAGES_SPLIT:
-                return merge_4runs_by_stages_split(l, g1, g2, g3, r, B);
-            default:
-                assert(false);
-                __builtin_unreachable();
-        }
-
+        // Only the picked method is instantiated, the others need copyable elements.
+        if constexpr (mergingMethod == merging4way_methods::FOR_NUMERIC_DATA)
+            return merge_4runs_numeric(l, g1, g2, g3, r, B);
+        else if constexpr (mergingMethod == merging4way_methods::GENERAL_NO_SENTINELS)
+            return merge_4runs_explicit_nodes(l, g1, g2, g3, r, B);
+        else if constexpr (mergingMethod == merging4way_methods::WILLEM)
+            return merge_4runs_numeric_willem(l, g1, g2, g3, r, B);
+        else if constexpr (mergingMethod == merging4way_methods::WILLEM_TUNED)
+            return merge_4runs_numeric_willem_tuned(l, g1, g2, g3, r, B);
+        else if constexpr (mergingMethod == merging4way_methods::WILLEM_VALUES)
+            return wb_merge4way3(l, g1, g2, g3, r, B);
+        else if constexpr (mergingMethod == merging4way_methods::WILLEM_WITH_INDICES)
+            return merge_4runs_numeric_willem_a(l, g1, g2, g3, r, B);
+        else if constexpr (mergingMethod == merging4way_methods::GENERAL_INDICES)
+            return merge_4runs_indices(l, g1, g2, g3, r, B);
+        else if constexpr (mergingMethod == merging4way_methods::GENERAL_BY_STAGES)
+            return merge_4runs_by_stages(l, g1, g2, g3, r, B);
+        else if constexpr (mergingMethod == merging4way_methods::FOR_NUMERIC_DATA_PLAIN_MIN)
+            return merge_4runs_numeric_plain_min(l, g1, g2, g3, r, B);
+        else if constexpr (mergingMethod == merging4way_methods::GENERAL_BY_STAGES_SPLIT)
+            return merge_4runs_by_stages_split(l, g1, g2, g3, r, B);
+        else if constexpr (mergingMethod == merging4way_methods::GENERAL_BIDIRECTIONAL)
+            return merge_4runs_bidirectional(l, g1, g2, g3, r, B);
+        else
+            static_assert(mergingMethod != mergingMethod, "Unknown merging method");
     }
 
 }
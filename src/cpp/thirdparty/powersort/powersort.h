@@ -25,7 +25,7 @@ namespace algorithms {
 		BITWISE_LOOP,
 		MOST_SIGNIFICANT_SET_BIT,
 	};
-	std::string to_string(node_power_implementations implementation) {
+	inline std::string to_string(node_power_implementations implementation) {
 		switch (implementation) {
 			case TRIVIAL: return "TRIVIAL";
 			case DIVISION_LOOP: return "DIVISION_LOOP";
@@ -37,7 +37,7 @@ namespace algorithms {
 	};
 
 
-	power_t node_power_trivial(size_t begin, size_t end,
+	inline power_t node_power_trivial(size_t begin, size_t end,
 	                            size_t beginA, size_t beginB, size_t endB) {
 		size_t n = end - begin;
 		size_t n1 = beginB - beginA, n2 = endB - beginB;
@@ -52,7 +52,7 @@ namespace algorithms {
 		return k;
 	}
 
-    power_t node_power_div(size_t begin, size_t end,
+    inline power_t node_power_div(size_t begin, size_t end,
 	                        size_t beginA, size_t beginB, size_t endB) {
 		size_t twoN = 2*(end - begin); // 2*n
 		size_t n1 = beginB - beginA, n2 = endB - beginB; // lengths of runs
@@ -67,7 +67,7 @@ namespace algorithms {
 		return k;
 	}
 
-    power_t node_power_bitwise(size_t begin, size_t end,
+    inline power_t node_power_bitwise(size_t begin, size_t end,
 	                            size_t beginA, size_t beginB, size_t endB) {
 		size_t n = end - begin;
 		assert (n < (1L << 63));
@@ -88,7 +88,7 @@ namespace algorithms {
 		return nCommonBits + 1;
 	}
 
-    power_t node_power_clz(size_t begin, size_t end,
+    inline power_t node_power_clz(size_t begin, size_t end,
 	                        size_t beginA, size_t beginB, size_t endB) {
 		size_t n = end - begin;
 		assert(n <= (1L << 31));
@@ -100,7 +100,7 @@ namespace algorithms {
 	}
 
 	// not precise enough for large powers ...
-    power_t node_power_clz_unconstrained(ptrdiff_t begin, ptrdiff_t end,
+    inline power_t node_power_clz_unconstrained(ptrdiff_t begin, ptrdiff_t end,
 	                                      ptrdiff_t beginA, ptrdiff_t beginB, ptrdiff_t endB) {
 		assert(begin <= beginA && beginA <= beginB && beginB <= endB && endB <= end);
 		auto n = static_cast<size_t>(end - begin);
@@ -129,12 +129,12 @@ namespace algorithms {
 		}
 	}
 
-	unsigned floor_log2(unsigned int n) {
+	inline unsigned floor_log2(unsigned int n) {
 		if (n <= 0) return 0;
 		return 31 - __builtin_clz( n );
 	}
 
-	unsigned floor_log2(unsigned long n) {
+	inline unsigned floor_log2(unsigned long n) {
 		if (n <= 0) return 0;
 		return 63 - __builtin_clzl( n );
 	}
@@ -150,6 +150,8 @@ namespace algorithms {
 	 * a most-significant-bit trick;
 	 * otherwise a loop is used.
 	 * If onlyIncreasingRuns is true, only weakly increasing runs are picked up.
+	 * Elements are ordered by Compare, which may carry state, eg. a comparison
+	 * function together with its context.
 	 *
 	 * @author Sebastian Wild (wild@liverpool.ac.uk)
 	 */
@@ -158,14 +160,17 @@ namespace algorithms {
             merging_methods mergingMethod = merging_methods::COPY_BOTH,
             bool onlyIncreasingRuns = false,
 			node_power_implementations nodePowerImplementation = MOST_SIGNIFICANT_SET_BIT /** very little difference */,
-            bool usePowerIndexedStack = false /** no measurable difference */
+            bool usePowerIndexedStack = false /** no measurable difference */,
+            typename Compare = std::less<>
 	>
 	class powersort final : public sorter<Iterator> {
 	private:
 		using typename sorter<Iterator>::elem_t;
 		using typename sorter<Iterator>::diff_t;
-		std::vector<elem_t> _buffer;
+		merge_buffer<elem_t> _buffer;
+		elem_t* _merge_buffer = nullptr;
 		Iterator globalBegin, globalEnd;
+		Compare _comp;
 
         struct run {
 			Iterator begin; Iterator end;
@@ -197,8 +202,19 @@ namespace algorithms {
 
 	public:
 
+        powersort() = default;
+        explicit powersort(Compare comp) : _comp(comp) {}
+
         void sort(Iterator begin, Iterator end) override {
-            _buffer.resize(end - begin + 2);
+            sort_with_buffer(begin, end, _buffer.reserve(end - begin + 2));
+        }
+
+        /**
+         * Same as sort, but merges through the caller provided buffer, which
+         * must hold at least (end - begin + 2) elements.
+         */
+        void sort_with_buffer(Iterator begin, Iterator end, elem_t* buffer) {
+            _merge_buffer = buffer;
             globalBegin = begin; globalEnd = end;
             if (usePowerIndexedStack)
                 power_sort(begin, end);
@@ -236,21 +252,21 @@ namespace algorithms {
 			assert(runStack[0] == NULL_RUN && runStack[lgnPlus2-1] == NULL_RUN);
 			unsigned top = 0;
 
-			run runA = {begin, extend_and_reverse_run_right(begin, end)};
+			run runA = {begin, extend_and_reverse_run_right(begin, end, _comp)};
 			//extend to minRunLen
 			diff_t lenA = runA.end - runA.begin;
 			if (lenA < minRunLen) {
 				runA.end = std::min(end, runA.begin + minRunLen);
-				insertionsort(runA.begin, runA.end, lenA);
+				insertionsort(runA.begin, runA.end, lenA, _comp);
 			}
 
 			while (runA.end < end) {
-				run runB = {runA.end, extend_and_reverse_run_right(runA.end, end)};
+				run runB = {runA.end, extend_and_reverse_run_right(runA.end, end, _comp)};
 				//extend to minRunLen
 				size_t lenB = runB.end - runB.begin;
 				if (lenB < minRunLen) {
 					runB.end = std::min(end, runB.begin + minRunLen);
-					insertionsort(runB.begin, runB.end, lenB);
+					insertionsort(runB.begin, runB.end, lenB, _comp);
 				}
 				unsigned k = node_power(0, n,
 				                        (size_t) (runA.begin-begin),
@@ -259,7 +275,7 @@ namespace algorithms {
 				assert( k != top );
 				for (unsigned l = top; l > k; --l) {
 					if (runStack[l] == NULL_RUN) continue;
-					merge_runs<mergingMethod>(runStack[l].begin, runStack[l].end, runA.end, _buffer.begin());
+					merge_runs<mergingMethod>(runStack[l].begin, runStack[l].end, runA.end, _merge_buffer, _comp);
 					runA.begin = runStack[l].begin;
 					runStack[l] = NULL_RUN;
 				}
@@ -271,7 +287,7 @@ namespace algorithms {
 			assert(runA.end == end);
 			for (unsigned l = top; l > 0; --l) {
 				if (runStack[l] != NULL_RUN)
-					merge_runs<mergingMethod>(runStack[l].begin, runStack[l].end, end, _buffer.begin());
+					merge_runs<mergingMethod>(runStack[l].begin, runStack[l].end, end, _merge_buffer, _comp);
 			}
 		}
 
@@ -287,18 +303,18 @@ namespace algorithms {
             run_begin_n_power stack[maxStackHeight];
             unsigned top = 0; // topmost occupied entry in stack; keep on NULL_RUN_N_POWER in stack[0]
 
-            run_n_power runA = {begin, extend_and_reverse_run_right(begin, end), 0};
+            run_n_power runA = {begin, extend_and_reverse_run_right(begin, end, _comp), 0};
             //extend to minRunLen
             if (diff_t lenA = runA.end - runA.begin < minRunLen) {
                 runA.end = std::min(end, runA.begin + minRunLen);
-                insertionsort(runA.begin, runA.end, lenA);
+                insertionsort(runA.begin, runA.end, lenA, _comp);
             }
             while (runA.end < end) {
-                run runB = {runA.end, extend_and_reverse_run_right(runA.end, end)};
+                run runB = {runA.end, extend_and_reverse_run_right(runA.end, end, _comp)};
                 // extend to minRunLen
                 if (size_t lenB = runB.end - runB.begin < minRunLen) {
                     runB.end = std::min(end, runB.begin + minRunLen);
-                    insertionsort(runB.begin, runB.end, lenB);
+                    insertionsort(runB.begin, runB.end, lenB, _comp);
                 }
                 runA.power = node_power(0, n,
                                         (size_t) (runA.begin-begin),
@@ -307,7 +323,7 @@ namespace algorithms {
                 // Invariant: powers on stack must be increasing from bottom to top
                 while (stack[top].power > runA.power) {
                     auto top_run = stack[top--]; // pop
-                    merge_runs<mergingMethod>(top_run.begin, runA.begin, runA.end, _buffer.begin());
+                    merge_runs<mergingMethod>(top_run.begin, runA.begin, runA.end, _merge_buffer, _comp);
                     runA.begin = top_run.begin;
                 }
                 // store updated runA to be merged with runB at power k
@@ -317,7 +333,7 @@ namespace algorithms {
             assert(runA.end == end);
             while (top > 0) {
                 auto top_run = stack[top--]; // pop
-                merge_runs<mergingMethod>(top_run.begin, runA.begin, end, _buffer.begin());
+                merge_runs<mergingMethod>(top_run.begin, runA.begin, end, _merge_buffer, _comp);
                 runA.begin = top_run.begin;
             }
         }
@@ -155,7 +155,8 @@ class powersort_4way final : public sorter<Iterator> {
  private:
   using typename sorter<Iterator>::elem_t;
   using typename sorter<Iterator>::diff_t;
-  std::vector<elem_t> _buffer;
+  merge_buffer<elem_t> _buffer;
+  elem_t* _merge_buffer = nullptr;
   Iterator globalBegin, globalEnd;
 
   struct run_begin_n_power {
@@ -176,9 +177,22 @@ class powersort_4way final : public sorter<Iterator> {
 
   run_begin_n_power NULL_RUN_N_POWER{};
 
+  // 2way merges use the bidirectional merge too if it's picked for 4way.
+  static constexpr merging_methods merging2wayMethod =
+      mergingMethod == GENERAL_BIDIRECTIONAL ? COPY_BOTH_BIDIRECTIONAL
+                                             : COPY_BOTH;
+
  public:
   void sort(Iterator begin, Iterator end) override {
-    _buffer.resize(end - begin + 4);
+    sort_with_buffer(begin, end, _buffer.reserve(end - begin + 4));
+  }
+
+  /**
+   * Same as sort, but merges through the caller provided buffer, which must
+   * hold at least (end - begin + 4) elements.
+   */
+  void sort_with_buffer(Iterator begin, Iterator end, elem_t* buffer) {
+    _merge_buffer = buffer;
     globalBegin = begin;
     globalEnd = end;
     if (useParallelArraysForStack)
@@ -286,7 +300,8 @@ class powersort_4way final : public sorter<Iterator> {
       ++nRunsSamePower;
     if (nRunsSamePower == 1) {  // 2way
       Iterator g[] = {top_of_stack->begin};
-      merge_runs<COPY_BOTH>(g[0], runA.begin, runA.end, _buffer.begin());
+      merge_runs<merging2wayMethod>(g[0], runA.begin, runA.end,
+                                    _merge_buffer);
       runA.begin = g[0];
 #ifdef PRINT_MERGES_AND_MERGECOST_PER_K
       ++nMerges2;
@@ -296,10 +311,10 @@ class powersort_4way final : public sorter<Iterator> {
       Iterator g[] = {(top_of_stack - 1)->begin, top_of_stack->begin};
       if (useSpecialized3wayMerge)
         merge_3runs<mergingMethod>(g[0], g[1], runA.begin, runA.end,
-                                   _buffer.begin());
+                                   _merge_buffer);
       else
         merge_4runs<mergingMethod>(g[0], g[1], runA.begin, runA.end, runA.end,
-                                   _buffer.begin());
+                                   _merge_buffer);
       runA.begin = g[0];
 #ifdef PRINT_MERGES_AND_MERGECOST_PER_K
       ++nMerges3;
@@ -310,7 +325,7 @@ class powersort_4way final : public sorter<Iterator> {
       Iterator g[] = {(top_of_stack - 2)->begin, (top_of_stack - 1)->begin,
                       top_of_stack->begin};
       merge_4runs<mergingMethod>(g[0], g[1], g[2], runA.begin, runA.end,
-                                 _buffer.begin());
+                                 _merge_buffer);
       runA.begin = g[0];
 #ifdef PRINT_MERGES_AND_MERGECOST_PER_K
       ++nMerges4;
@@ -327,7 +342,8 @@ class powersort_4way final : public sorter<Iterator> {
     g[2] = topRun.begin;
     if (top_of_stack->power != topRun.power) {  // 2way
       // use specialized method (had no measurable effect for rp ...)
-      merge_runs<COPY_BOTH>(g[2], runA.begin, runA.end, _buffer.begin());
+      merge_runs<merging2wayMethod>(g[2], runA.begin, runA.end,
+                                    _merge_buffer);
       runA.begin = g[2];
 #ifdef PRINT_MERGES_AND_MERGECOST_PER_K
       ++nMerges2;
@@ -337,10 +353,10 @@ class powersort_4way final : public sorter<Iterator> {
       g[1] = (top_of_stack--)->begin;                        // pop
       if (useSpecialized3wayMerge)
         merge_3runs<mergingMethod>(g[1], g[2], runA.begin, runA.end,
-                                   _buffer.begin());
+                                   _merge_buffer);
       else
         merge_4runs<mergingMethod>(g[1], g[2], runA.begin, runA.end, runA.end,
-                                   _buffer.begin());
+                                   _merge_buffer);
       runA.begin = g[1];
 #ifdef PRINT_MERGES_AND_MERGECOST_PER_K
       ++nMerges3;
@@ -350,7 +366,7 @@ class powersort_4way final : public sorter<Iterator> {
       g[1] = (top_of_stack--)->begin;  // pop
       g[0] = (top_of_stack--)->begin;  // pop
       merge_4runs<mergingMethod>(g[0], g[1], g[2], runA.begin, runA.end,
-                                 _buffer.begin());
+                                 _merge_buffer);
       runA.begin = g[0];
 #ifdef PRINT_MERGES_AND_MERGECOST_PER_K
       ++nMerges4;
@@ -374,11 +390,11 @@ class powersort_4way final : public sorter<Iterator> {
         if (useSpecialized3wayMerge)
           merge_3runs<mergingMethod>((top_of_stack - 1)->begin,
                                      top_of_stack->begin, runA.begin, runA.end,
-                                     _buffer.begin());
+                                     _merge_buffer);
         else
           merge_4runs<mergingMethod>((top_of_stack - 1)->begin,
                                      top_of_stack->begin, runA.begin, runA.end,
-                                     runA.end, _buffer.begin());
+                                     runA.end, _merge_buffer);
         runA.begin = (top_of_stack - 1)->begin;
 #ifdef PRINT_MERGES_AND_MERGECOST_PER_K
         ++nMerges3;
@@ -387,8 +403,8 @@ class powersort_4way final : public sorter<Iterator> {
         top_of_stack -= 2;
         break;
       case 2:  // merge topmost 2 runs
-        merge_runs<COPY_BOTH>(top_of_stack->begin, runA.begin, runA.end,
-                              _buffer.begin());
+        merge_runs<merging2wayMethod>(top_of_stack->begin, runA.begin,
+                                      runA.end, _merge_buffer);
         runA.begin = top_of_stack->begin;
 #ifdef PRINT_MERGES_AND_MERGECOST_PER_K
         ++nMerges2;
@@ -404,7 +420,7 @@ class powersort_4way final : public sorter<Iterator> {
     while (top_of_stack > begin_of_stack) {
       merge_4runs<mergingMethod>((top_of_stack - 2)->begin,
                                  (top_of_stack - 1)->begin, top_of_stack->begin,
-                                 runA.begin, runA.end, _buffer.begin());
+                                 runA.begin, runA.end, _merge_buffer);
       runA.begin = (top_of_stack - 2)->begin;
 #ifdef PRINT_MERGES_AND_MERGECOST_PER_K
       ++nMerges4;
@@ -503,7 +519,8 @@ class powersort_4way final : public sorter<Iterator> {
       ++nRunsSamePower;
     if (nRunsSamePower == 1) {  // 2way
       Iterator g[] = {*top_of_stack_run};
-      merge_runs<COPY_BOTH>(g[0], runA.begin, runA.end, _buffer.begin());
+      merge_runs<merging2wayMethod>(g[0], runA.begin, runA.end,
+                                    _merge_buffer);
       runA.begin = g[0];
 #ifdef PRINT_MERGES_AND_MERGECOST_PER_K
       ++nMerges2;
@@ -513,10 +530,10 @@ class powersort_4way final : public sorter<Iterator> {
       Iterator g[] = {*(top_of_stack_run - 1), *top_of_stack_run};
       if (useSpecialized3wayMerge)
         merge_3runs<mergingMethod>(g[0], g[1], runA.begin, runA.end,
-                                   _buffer.begin());
+                                   _merge_buffer);
       else
         merge_4runs<mergingMethod>(g[0], g[1], runA.begin, runA.end, runA.end,
-                                   _buffer.begin());
+                                   _merge_buffer);
       runA.begin = g[0];
 #ifdef PRINT_MERGES_AND_MERGECOST_PER_K
       ++nMerges3;
@@ -527,7 +544,7 @@ class powersort_4way final : public sorter<Iterator> {
       Iterator g[] = {*(top_of_stack_run - 2), *(top_of_stack_run - 1),
                       *top_of_stack_run};
       merge_4runs<mergingMethod>(g[0], g[1], g[2], runA.begin, runA.end,
-                                 _buffer.begin());
+                                 _merge_buffer);
       runA.begin = g[0];
 #ifdef PRINT_MERGES_AND_MERGECOST_PER_K
       ++nMerges4;
@@ -552,11 +569,11 @@ class powersort_4way final : public sorter<Iterator> {
         assert(nRuns >= 3);
         if (useSpecialized3wayMerge)
           merge_3runs<mergingMethod>(*(top_of_stack_run - 1), *top_of_stack_run,
-                                     runA.begin, runA.end, _buffer.begin());
+                                     runA.begin, runA.end, _merge_buffer);
         else
           merge_4runs<mergingMethod>(*(top_of_stack_run - 1), *top_of_stack_run,
                                      runA.begin, runA.end, runA.end,
-                                     _buffer.begin());
+                                     _merge_buffer);
         runA.begin = *(top_of_stack_run - 1);
 #ifdef PRINT_MERGES_AND_MERGECOST_PER_K
         ++nMerges3;
@@ -565,8 +582,8 @@ class powersort_4way final : public sorter<Iterator> {
         top_of_stack_run -= 2;
         break;
       case 2:  // merge topmost 2 runs
-        merge_runs<COPY_BOTH>(*top_of_stack_run, runA.begin, runA.end,
-                              _buffer.begin());
+        merge_runs<merging2wayMethod>(*top_of_stack_run, runA.begin,
+                                      runA.end, _merge_buffer);
         runA.begin = *top_of_stack_run;
 #ifdef PRINT_MERGES_AND_MERGECOST_PER_K
         ++nMerges2;
@@ -582,7 +599,7 @@ class powersort_4way final : public sorter<Iterator> {
     while (top_of_stack_run > begin_of_stack_run) {
       merge_4runs<mergingMethod>(*(top_of_stack_run - 2),
                                  *(top_of_stack_run - 1), *top_of_stack_run,
-                                 runA.begin, runA.end, _buffer.begin());
+                                 runA.begin, runA.end, _merge_buffer);
       runA.begin = *(top_of_stack_run - 2);
 #ifdef PRINT_MERGES_AND_MERGECOST_PER_K
       ++nMerges4;
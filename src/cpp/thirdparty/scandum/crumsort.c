@@ -131,7 +131,7 @@ void FUNC(crum_analyze)(VAR *array, VAR *swap, size_t swap_size, size_t nmemb, C
 		if (dsum && dbalance) {FUNC(quad_reversal)(ptc + 1, ptd); dbalance = 0;}
 	}
 
-#ifdef cmp
+#if defined cmp && !defined CMP_R
 	cnt = nmemb / 256; // switch to quadsort if at least 50% ordered
 #else
 	cnt = nmemb / 512; // switch to quadsort if at least 25% ordered
@@ -141,7 +141,7 @@ void FUNC(crum_analyze)(VAR *array, VAR *swap, size_t swap_size, size_t nmemb, C
 	csum = cstreaks > cnt;
 	dsum = dstreaks > cnt;
 
-#ifndef cmp
+#if !defined cmp || defined CMP_R
 	if (quad1 > QUAD_CACHE)
 	{
 		asum = bsum = csum = dsum = 1;
@@ -469,6 +469,9 @@ void FUNC(fulcrum_partition)(VAR *array, VAR *swap, VAR *max, size_t swap_size,
 {
 	size_t a_size, s_size;
 	VAR *ptp, piv;
+#ifdef SORT_TELEMETRY
+	sort_telemetry::DepthScope depth_scope;
+#endif
 
 	while (1)
 	{
@@ -487,9 +490,15 @@ void FUNC(fulcrum_partition)(VAR *array, VAR *swap, VAR *max, size_t swap_size,
 		{
 			a_size = FUNC(fulcrum_reverse_partition)(array, swap, array, &piv, swap_size, nmemb, cmp);
 			s_size = nmemb - a_size;
+#ifdef SORT_TELEMETRY
+			sort_telemetry::partition(nmemb, a_size, sort_telemetry::depth());
+#endif
 
 			if (s_size <= a_size / 16 || a_size <= CRUM_OUT)
 			{
+#ifdef SORT_TELEMETRY
+				if (a_size > CRUM_OUT) sort_telemetry::fallback(a_size, sort_telemetry::depth());
+#endif
 				return FUNC(quadsort_swap)(array, swap, swap_size, a_size, cmp);
 			}
 			nmemb = a_size; max = NULL;
@@ -499,6 +508,9 @@ void FUNC(fulcrum_partition)(VAR *array, VAR *swap, VAR *max, size_t swap_size,
 
 		a_size = FUNC(fulcrum_default_partition)(array, swap, array, &piv, swap_size, nmemb, cmp);
 		s_size = nmemb - a_size;
+#ifdef SORT_TELEMETRY
+		sort_telemetry::partition(nmemb + 1, a_size, sort_telemetry::depth());
+#endif
 
 		ptp = array + a_size; array[nmemb] = *ptp; *ptp = piv;
 
@@ -506,17 +518,29 @@ void FUNC(fulcrum_partition)(VAR *array, VAR *swap, VAR *max, size_t swap_size,
 		{
 			if (s_size == 0)
 			{
+#ifdef SORT_TELEMETRY
+				const size_t reverse_len = a_size;
+#endif
 				a_size = FUNC(fulcrum_reverse_partition)(array, swap, array, &piv, swap_size, a_size, cmp);
 				s_size = nmemb - a_size;
+#ifdef SORT_TELEMETRY
+				sort_telemetry::partition(reverse_len, a_size, sort_telemetry::depth());
+#endif
 
 				if (s_size <= a_size / 16 || a_size <= CRUM_OUT)
 				{
+#ifdef SORT_TELEMETRY
+					if (a_size > CRUM_OUT) sort_telemetry::fallback(a_size, sort_telemetry::depth());
+#endif
 					return FUNC(quadsort_swap)(array, swap, swap_size, a_size, cmp);
 				}
 				max = NULL;
 				nmemb = a_size;
 				continue;
 			}
+#ifdef SORT_TELEMETRY
+			if (s_size > CRUM_OUT) sort_telemetry::fallback(s_size, sort_telemetry::depth());
+#endif
 			FUNC(quadsort_swap)(ptp + 1, swap, swap_size, s_size, cmp);
 		}
 		else
@@ -526,6 +550,9 @@ void FUNC(fulcrum_partition)(VAR *array, VAR *swap, VAR *max, size_t swap_size,
 
 		if (s_size <= a_size / 32 || a_size <= CRUM_OUT)
 		{
+#ifdef SORT_TELEMETRY
+			if (a_size > CRUM_OUT) sort_telemetry::fallback(a_size, sort_telemetry::depth());
+#endif
 			return FUNC(quadsort_swap)(array, swap, swap_size, a_size, cmp);
 		}
 		max = ptp;
@@ -152,6 +152,30 @@ typedef int CMPFUNC (const void *a, const void *b);
 #undef VAR
 #undef FUNC
 
+// crumsort_r
+
+#ifndef cmp
+  #define CMP_R
+  #define CMPFUNC struct cmp_r
+  #define cmp(a,b) (cmp->fn((a), (b), cmp->arg))
+
+  #define VAR int
+  #define FUNC(NAME) NAME##32_r
+    #include "crumsort.c"
+  #undef VAR
+  #undef FUNC
+
+  #define VAR long long
+  #define FUNC(NAME) NAME##64_r
+    #include "crumsort.c"
+  #undef VAR
+  #undef FUNC
+
+  #undef cmp
+  #undef CMPFUNC
+  #undef CMP_R
+#endif
+
 // This section is outside of 32/64 bit pointer territory, so no cache checks
 // necessary, unless sorting 32+ byte structures.
 
@@ -335,6 +359,35 @@ void crumsort_prim(void *array, size_t nmemb, size_t size)
 	}
 }
 
+// Like crumsort(), but passes arg to every call of the comparison function, just
+// like qsort_r(). Only 32 and 64 bit elements are supported.
+
+#ifndef cmp
+void crumsort_r(void *array, size_t nmemb, size_t size, CMPFUNC_R *cmp, void *arg)
+{
+	struct cmp_r ctx = {cmp, arg};
+
+	if (nmemb < 2)
+	{
+		return;
+	}
+
+	switch (size)
+	{
+		case sizeof(int):
+			crumsort32_r(array, nmemb, &ctx);
+			return;
+
+		case sizeof(long long):
+			crumsort64_r(array, nmemb, &ctx);
+			return;
+
+		default:
+			assert(size == sizeof(int) || size == sizeof(long long));
+	}
+}
+#endif
+
 #undef QUAD_CACHE
 
 #endif
\ No newline at end of file
@@ -131,7 +131,7 @@ void FUNC(flux_analyze)(VAR *array, VAR *swap, size_t swap_size, size_t nmemb, C
 		if (dsum && dbalance) {FUNC(quad_reversal)(ptc + 1, ptd); dbalance = 0;}
 	}
 
-#ifdef cmp
+#if defined cmp && !defined CMP_R
 	cnt = nmemb / 256; // switch to quadsort if at least 50% ordered
 #else
 	cnt = nmemb / 512; // switch to quadsort if at least 25% ordered
@@ -141,7 +141,7 @@ void FUNC(flux_analyze)(VAR *array, VAR *swap, size_t swap_size, size_t nmemb, C
 	csum = cstreaks > cnt;
 	dsum = dstreaks > cnt;
 
-#ifndef cmp
+#if !defined cmp || defined CMP_R
 	if (quad1 > QUAD_CACHE)
 	{
 		asum = bsum = csum = dsum = 1;
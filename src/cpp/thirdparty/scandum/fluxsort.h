@@ -147,6 +147,30 @@ typedef int CMPFUNC (const void *a, const void *b);
 #undef VAR
 #undef FUNC
 
+// fluxsort_r
+
+#ifndef cmp
+  #define CMP_R
+  #define CMPFUNC struct cmp_r
+  #define cmp(a,b) (cmp->fn((a), (b), cmp->arg))
+
+  #define VAR int
+  #define FUNC(NAME) NAME##32_r
+    #include "fluxsort.c"
+  #undef VAR
+  #undef FUNC
+
+  #define VAR long long
+  #define FUNC(NAME) NAME##64_r
+    #include "fluxsort.c"
+  #undef VAR
+  #undef FUNC
+
+  #undef cmp
+  #undef CMPFUNC
+  #undef CMP_R
+#endif
+
 // This section is outside of 32/64 bit pointer territory, so no cache checks
 // necessary, unless sorting 32+ byte structures.
 
@@ -291,6 +315,35 @@ void fluxsort_prim(void *array, size_t nmemb, size_t size)
 	}
 }
 
+// Like fluxsort(), but passes arg to every call of the comparison function, just
+// like qsort_r(). Only 32 and 64 bit elements are supported.
+
+#ifndef cmp
+void fluxsort_r(void *array, size_t nmemb, size_t size, CMPFUNC_R *cmp, void *arg)
+{
+	struct cmp_r ctx = {cmp, arg};
+
+	if (nmemb < 2)
+	{
+		return;
+	}
+
+	switch (size)
+	{
+		case sizeof(int):
+			fluxsort32_r(array, nmemb, &ctx);
+			return;
+
+		case sizeof(long long):
+			fluxsort64_r(array, nmemb, &ctx);
+			return;
+
+		default:
+			assert(size == sizeof(int) || size == sizeof(long long));
+	}
+}
+#endif
+
 #undef QUAD_CACHE
 
 #endif
\ No newline at end of file
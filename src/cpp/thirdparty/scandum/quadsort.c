@@ -173,7 +173,7 @@ void FUNC(parity_merge)(VAR *dest, VAR *from, size_t left, size_t right, CMPFUNC
 
 	*ptd++ = cmp(ptl, ptr) <= 0 ? *ptl++ : *ptr++;
 
-#if !defined cmp && !defined __clang__ // cache limit workaround for gcc
+#if (!defined cmp || defined CMP_R) && !defined __clang__ // cache limit workaround for gcc
 	if (left > QUAD_CACHE)
 	{
 		while (--left)
@@ -521,7 +521,7 @@ void FUNC(cross_merge)(VAR *dest, VAR *from, size_t left, size_t right, CMPFUNC
 			if (tpl - ptl > 8) {goto tpl8_tpr;} break;
 		}
 
-#if !defined cmp && !defined __clang__
+#if (!defined cmp || defined CMP_R) && !defined __clang__
 		if (left > QUAD_CACHE)
 		{
 			loop = 8; do
@@ -208,6 +208,45 @@ typedef int CMPFUNC (const void *a, const void *b);
 #undef VAR
 #undef FUNC
 
+// quadsort_r, fluxsort_r and crumsort_r
+
+// qsort_r style variants that hand a context pointer to the comparison
+// function, so nothing has to be kept in globals and any number of sorts with
+// different comparison functions can run at the same time. CMPFUNC is swapped
+// for a struct with the function and its argument that cmp() calls through.
+// CMP_R keeps the heuristics tuned for an opaque comparison function, instead
+// of the ones meant for an inlined cmp() macro.
+
+typedef int CMPFUNC_R (const void *a, const void *b, void *arg);
+
+struct cmp_r
+{
+	CMPFUNC_R *fn;
+	void *arg;
+};
+
+#ifndef cmp
+  #define CMP_R
+  #define CMPFUNC struct cmp_r
+  #define cmp(a,b) (cmp->fn((a), (b), cmp->arg))
+
+  #define VAR int
+  #define FUNC(NAME) NAME##32_r
+    #include "quadsort.c"
+  #undef VAR
+  #undef FUNC
+
+  #define VAR long long
+  #define FUNC(NAME) NAME##64_r
+    #include "quadsort.c"
+  #undef VAR
+  #undef FUNC
+
+  #undef cmp
+  #undef CMPFUNC
+  #undef CMP_R
+#endif
+
 // This section is outside of 32/64 bit pointer territory, so no cache checks
 // necessary, unless sorting 32+ byte structures.
 
@@ -391,6 +430,35 @@ void quadsort_prim(void *array, size_t nmemb, size_t size)
 	}
 }
 
+// Like quadsort(), but passes arg to every call of the comparison function, just
+// like qsort_r(). Only 32 and 64 bit elements are supported.
+
+#ifndef cmp
+void quadsort_r(void *array, size_t nmemb, size_t size, CMPFUNC_R *cmp, void *arg)
+{
+	struct cmp_r ctx = {cmp, arg};
+
+	if (nmemb < 2)
+	{
+		return;
+	}
+
+	switch (size)
+	{
+		case sizeof(int):
+			quadsort32_r(array, nmemb, &ctx);
+			return;
+
+		case sizeof(long long):
+			quadsort64_r(array, nmemb, &ctx);
+			return;
+
+		default:
+			assert(size == sizeof(int) || size == sizeof(long long));
+	}
+}
+#endif
+
 #undef QUAD_CACHE
 
 #endif
\ No newline at end of file
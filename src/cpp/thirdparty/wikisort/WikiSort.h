@@ -188,8 +188,125 @@ void InsertionSort(BidirectionalIterator first,
 }
 
 namespace Wiki {
+// how the merges that go through the cache move the elements, only worth
+// changing for large elements
+enum class MergeMode {
+  // one element at a time, the original code
+  Plain,
+  // one element at a time, prefetching PrefetchBytes ahead of both inputs and
+  // of the output
+  Prefetch,
+  // every stretch of elements taken from the same input is moved with a single
+  // std::copy
+  Blockwise,
+};
+
+const std::size_t PrefetchBytes = 256;
+
+// prefetch the cache lines of the element at p, at most PrefetchBytes of it
+template <int rw, typename T>
+void PrefetchElement(const T* p) {
+  const std::size_t lines = (std::min(sizeof(T), PrefetchBytes) + 63) / 64;
+  const char* bytes = reinterpret_cast<const char*>(p);
+  for (std::size_t i = 0; i < lines; ++i) {
+    __builtin_prefetch(bytes + i * 64, rw);
+  }
+}
+
+// merge from [first1, last1) and [first2, last2) into out until one of them is
+// empty, advancing first1, first2 and out past what was merged. out may overlap
+// the second range as long as it never gets ahead of first2, like it does in
+// MergeExternal. neither range may be empty
+template <MergeMode mode,
+          typename Iterator1,
+          typename Iterator2,
+          typename OutputIterator,
+          typename Comparison>
+void MergeUntilEmpty(Iterator1& first1,
+                     Iterator1 last1,
+                     Iterator2& first2,
+                     Iterator2 last2,
+                     OutputIterator& out,
+                     Comparison compare) {
+  if (mode == MergeMode::Blockwise) {
+    // once a stretch ends the other range is known to go next, so this does
+    // the same comparisons as the element at a time merge
+    bool take2 = compare(*first2, *first1);
+    while (true) {
+      if (take2) {
+        Iterator2 start = first2;
+        do {
+          ++first2;
+        } while (first2 != last2 && compare(*first2, *first1));
+        out = std::copy(start, first2, out);
+        if (first2 == last2)
+          break;
+      } else {
+        Iterator1 start = first1;
+        do {
+          ++first1;
+        } while (first1 != last1 && !compare(*first2, *first1));
+        out = std::copy(start, first1, out);
+        if (first1 == last1)
+          break;
+      }
+      take2 = !take2;
+    }
+    return;
+  }
+
+  typedef typename std::iterator_traits<Iterator1>::value_type T;
+  const std::ptrdiff_t ahead =
+      std::max<std::ptrdiff_t>(PrefetchBytes / sizeof(T), 1);
+  while (true) {
+    if (mode == MergeMode::Prefetch) {
+      // prefetching past the end of a range is harmless, it never faults
+      PrefetchElement<0>(&*first1 + ahead);
+      PrefetchElement<0>(&*first2 + ahead);
+      PrefetchElement<1>(&*out + ahead);
+    }
+    if (!compare(*first2, *first1)) {
+      *out = *first1;
+      ++first1;
+      ++out;
+      if (first1 == last1)
+        break;
+    } else {
+      *out = *first2;
+      ++first2;
+      ++out;
+      if (first2 == last2)
+        break;
+    }
+  }
+}
+
+// std::merge for MergeMode::Plain, MergeUntilEmpty otherwise
+template <MergeMode mode,
+          typename Iterator1,
+          typename Iterator2,
+          typename OutputIterator,
+          typename Comparison>
+OutputIterator Merge(Iterator1 first1,
+                     Iterator1 last1,
+                     Iterator2 first2,
+                     Iterator2 last2,
+                     OutputIterator out,
+                     Comparison compare) {
+  if (mode == MergeMode::Plain) {
+    return std::merge(first1, last1, first2, last2, out, compare);
+  }
+
+  if (first1 != last1 && first2 != last2) {
+    MergeUntilEmpty<mode>(first1, last1, first2, last2, out, compare);
+  }
+  out = std::copy(first1, last1, out);
+  return std::copy(first2, last2, out);
+}
+
 // merge operation using an external buffer
-template <typename RandomAccessIterator1,
+template <MergeMode mode = MergeMode::Plain,
+          typename RandomAccessIterator1,
           typename RandomAccessIterator2,
           typename Comparison>
 void MergeExternal(RandomAccessIterator1 first1,
@@ -205,7 +322,13 @@ void MergeExternal(RandomAccessIterator1 first1,
   RandomAccessIterator1 B_last = last2;
   RandomAccessIterator1 insert_index = first1;
 
-  if (last2 - first2 > 0 && last1 - first1 > 0) {
+  if (mode != MergeMode::Plain) {
+    // the rest of B is already where it belongs
+    if (last2 - first2 > 0 && last1 - first1 > 0) {
+      MergeUntilEmpty<mode>(A_index, A_last, B_index, B_last, insert_index,
+                            compare);
+    }
+  } else if (last2 - first2 > 0 && last1 - first1 > 0) {
     while (true) {
       if (!compare(*B_index, *A_index)) {
         *insert_index = *A_index;
@@ -421,12 +544,17 @@ void Sort(RandomAccessIterator first, RandomAccessIterator last) {
   Sort(first, last, [](const auto& a, const auto& b) -> bool { return a < b; });
 }
 
-// bottom-up merge sort combined with an in-place merge algorithm for O(1)
-// memory use
-template <typename RandomAccessIterator, typename Comparison>
-void Sort(RandomAccessIterator first,
-          RandomAccessIterator last,
-          Comparison compare) {
+// same as Sort, with cache_size elements of scratch memory at cache provided by
+// the caller, cache may be null if cache_size is 0
+template <MergeMode mode = MergeMode::Plain,
+          typename RandomAccessIterator,
+          typename Comparison>
+void SortWithCache(
+    RandomAccessIterator first,
+    RandomAccessIterator last,
+    Comparison compare,
+    typename std::iterator_traits<RandomAccessIterator>::value_type* cache,
+    const std::size_t cache_size) {
   // map first and last to a C-style array, so we don't have to change the rest
   // of the code (bit of a nasty hack, but it's good enough for now...)
   typedef typename std::iterator_traits<RandomAccessIterator>::value_type T;
@@ -547,21 +675,6 @@ void Sort(RandomAccessIterator first,
   if (size < 8)
     return;
 
-// use a small cache to speed up some of the operations
-#if DYNAMIC_CACHE
-  Cache<T> cache_obj(size);
-  T* cache = cache_obj.cache;
-  const std::size_t cache_size = cache_obj.cache_size;
-#else
-  // since the cache size is fixed, it's still O(1) memory!
-  // just keep in mind that making it too small ruins the point (nothing will
-  // fit into it), and making it too large also ruins the point (so much for
-  // "low memory"!) removing the cache entirely still gives 75% of the
-  // performance of a standard merge
-  const std::size_t cache_size = 512;
-  T cache[cache_size];
-#endif
-
   // then merge sort the higher levels, which can be 8-15, 16-31, 32-63, 64-127,
   // etc.
   while (true) {
@@ -590,7 +703,7 @@ void Sort(RandomAccessIterator first,
           } else if (compare(*B1.start, *(A1.end - 1))) {
             // these two ranges weren't already in order, so merge them into the
             // cache
-            std::merge(A1.start, A1.end, B1.start, B1.end, cache, compare);
+            Merge<mode>(A1.start, A1.end, B1.start, B1.end, cache, compare);
           } else {
             // if A1, B1, A2, and B2 are all in order, skip doing anything else
             if (!compare(*B2.start, *(A2.end - 1)) &&
@@ -611,8 +724,8 @@ void Sort(RandomAccessIterator first,
           } else if (compare(*B2.start, *(A2.end - 1))) {
             // these two ranges weren't already in order, so merge them into the
             // cache
-            std::merge(A2.start, A2.end, B2.start, B2.end, cache + A1.length(),
-                       compare);
+            Merge<mode>(A2.start, A2.end, B2.start, B2.end,
+                        cache + A1.length(), compare);
           } else {
             // copy A2 and B2 into the cache in the same order at once
             std::copy(A2.start, B2.end, cache + A1.length());
@@ -631,7 +744,7 @@ void Sort(RandomAccessIterator first,
           } else if (compare(*B3.start, *(A3.end - 1))) {
             // these two ranges weren't already in order, so merge them back
             // into the array
-            std::merge(A3.start, A3.end, B3.start, B3.end, A1.start, compare);
+            Merge<mode>(A3.start, A3.end, B3.start, B3.end, A1.start, compare);
           } else {
             // copy A3 and B3 into the array in the same order at once
             std::copy(A3.start, B3.end, A1.start);
@@ -657,7 +770,7 @@ void Sort(RandomAccessIterator first,
             // these two ranges weren't already in order, so we'll need to merge
             // them!
             std::copy(A.start, A.end, cache);
-            MergeExternal(A.start, A.end, B.start, B.end, cache, compare);
+            MergeExternal<mode>(A.start, A.end, B.start, B.end, cache, compare);
           }
         }
       }
@@ -1012,8 +1125,8 @@ void Sort(RandomAccessIterator first,
                 // exists we'll use that (with MergeInternal), or failing that
                 // we'll use a strictly in-place merge algorithm (MergeInPlace)
                 if (lastA.length() <= cache_size) {
-                  MergeExternal(lastA.start, lastA.end, lastA.end, B_split,
-                                cache, compare);
+                  MergeExternal<mode>(lastA.start, lastA.end, lastA.end,
+                                      B_split, cache, compare);
                 } else if (buffer2.length() > 0) {
                   MergeInternal(lastA.start, lastA.end, lastA.end, B_split,
                                 buffer2.start, compare);
@@ -1094,8 +1207,8 @@ void Sort(RandomAccessIterator first,
 
           // merge the last A block with the remaining B values
           if (lastA.length() <= cache_size) {
-            MergeExternal(lastA.start, lastA.end, lastA.end, B.end, cache,
-                          compare);
+            MergeExternal<mode>(lastA.start, lastA.end, lastA.end, B.end,
+                                cache, compare);
           } else if (buffer2.length() > 0) {
             MergeInternal(lastA.start, lastA.end, lastA.end, B.end,
                           buffer2.start, compare);
@@ -1159,4 +1272,32 @@ void Sort(RandomAccessIterator first,
       break;
   }
 }
+
+// bottom-up merge sort combined with an in-place merge algorithm for O(1)
+// memory use
+template <MergeMode mode = MergeMode::Plain,
+          typename RandomAccessIterator,
+          typename Comparison>
+void Sort(RandomAccessIterator first,
+          RandomAccessIterator last,
+          Comparison compare) {
+  typedef typename std::iterator_traits<RandomAccessIterator>::value_type T;
+
+// use a small cache to speed up some of the operations
+#if DYNAMIC_CACHE
+  Cache<T> cache_obj(std::distance(first, last));
+  T* cache = cache_obj.cache;
+  const std::size_t cache_size = cache_obj.cache_size;
+#else
+  // since the cache size is fixed, it's still O(1) memory!
+  // just keep in mind that making it too small ruins the point (nothing will
+  // fit into it), and making it too large also ruins the point (so much for
+  // "low memory"!) removing the cache entirely still gives 75% of the
+  // performance of a standard merge
+  const std::size_t cache_size = 512;
+  T cache[cache_size];
+#endif
+
+  SortWithCache<mode>(first, last, compare, cache, cache_size);
+}
 }  // namespace Wiki
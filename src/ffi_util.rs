@@ -1,6 +1,8 @@
 #![allow(dead_code, unused_macros)] // Dependent on optional features.
 
 use std::cmp::Ordering;
+use std::env;
+use std::sync::atomic::{AtomicUsize, Ordering as AtomicOrdering};
 
 use sort_test_tools::ffi_types::CompResult;
 
@@ -30,6 +32,80 @@ pub(crate) unsafe extern "C" fn rust_fn_cmp<T, F: FnMut(&T, &T) -> Ordering>(
     }
 }
 
+/// Same as `rust_fn_cmp` but only ever creates shared references to the compare function, which
+/// makes it sound to call concurrently from multiple threads.
+pub(crate) unsafe extern "C" fn rust_fn_cmp_sync<T, F: Fn(&T, &T) -> Ordering + Sync>(
+    a: &T,
+    b: &T,
+    ctx: *mut u8,
+) -> CompResult {
+    let compare_fn = &*(ctx as *const F);
+
+    match std::panic::catch_unwind(std::panic::AssertUnwindSafe(|| compare_fn(a, b))) {
+        Ok(val) => CompResult {
+            cmp_result: match val {
+                Ordering::Less => -1,
+                Ordering::Equal => 0,
+                Ordering::Greater => 1,
+            },
+            is_panic: false,
+        },
+        Err(err) => {
+            eprintln!("Panic during compare call: {err:?}");
+            CompResult {
+                cmp_result: 0,
+                is_panic: true,
+            }
+        }
+    }
+}
+
+static NUM_THREADS: AtomicUsize = AtomicUsize::new(0);
+
+/// Number of threads used by parallel sort implementations.
+///
+/// Defaults to the `SORT_NUM_THREADS` environment variable if set, and the available parallelism
+/// otherwise. Can be changed at runtime with `set_num_threads`, eg. for scaling benchmarks.
+pub fn num_threads() -> usize {
+    let num_threads = NUM_THREADS.load(AtomicOrdering::Relaxed);
+    if num_threads != 0 {
+        return num_threads;
+    }
+
+    let num_threads = env::var("SORT_NUM_THREADS")
+        .ok()
+        .map(|val| {
+            val.parse::<usize>()
+                .expect("SORT_NUM_THREADS must be a positive integer")
+        })
+        .unwrap_or_else(|| {
+            std::thread::available_parallelism()
+                .map(|val| val.get())
+                .unwrap_or(1)
+        })
+        .max(1);
+
+    NUM_THREADS.store(num_threads, AtomicOrdering::Relaxed);
+    num_threads
+}
+
+pub fn set_num_threads(num_threads: usize) {
+    assert!(num_threads > 0);
+    NUM_THREADS.store(num_threads, AtomicOrdering::Relaxed);
+}
+
+/// Number of threads the parallel sort `sort_name` uses for `len` elements of `T`. That's
+/// `num_threads`, or with the `parallel_cutover` feature the calibrated choice of this host,
+/// capped by it.
+#[allow(unused_variables)]
+pub fn num_threads_for<T>(sort_name: &str, len: usize) -> usize {
+    #[cfg(feature = "parallel_cutover")]
+    return crate::other::parallel_cutover::threads_for::<T>(sort_name, len, num_threads());
+
+    #[cfg(not(feature = "parallel_cutover"))]
+    num_threads()
+}
+
 macro_rules! make_cpp_sort_by {
     ($name:ident, $data:expr, $compare:expr, $type:ty) => {
         unsafe {
@@ -188,3 +264,1861 @@ macro_rules! ffi_sort_impl {
         } // paste
     };
 }
+
+macro_rules! make_cpp_parallel_sort_by {
+    ($name:ident, $data:expr, $compare:expr, $type:ty) => {{
+        // The compare function is called concurrently from the worker threads, but the Sort
+        // interface only provides FnMut. Serialize the calls, this keeps sort_by correct for
+        // testing and comparison counting, performance measurements should use sort.
+        struct SerializedCompare<F>(std::sync::Mutex<F>);
+
+        // SAFETY: All access to the inner compare function goes through the mutex.
+        unsafe impl<F> Sync for SerializedCompare<F> {}
+
+        impl<F> SerializedCompare<F> {
+            fn lock(&self) -> std::sync::MutexGuard<'_, F> {
+                match self.0.lock() {
+                    Ok(guard) => guard,
+                    Err(poisoned) => poisoned.into_inner(),
+                }
+            }
+        }
+
+        let serialized_compare = SerializedCompare(std::sync::Mutex::new($compare));
+        let sync_compare = |a: &$type, b: &$type| -> Ordering {
+            let mut compare = serialized_compare.lock();
+            (*compare)(a, b)
+        };
+
+        fn sync_cmp_fn_of<T, G: Fn(&T, &T) -> Ordering + Sync>(
+            _compare: &G,
+        ) -> unsafe extern "C" fn(&T, &T, *mut u8) -> CompResult {
+            crate::ffi_util::rust_fn_cmp_sync::<T, G>
+        }
+
+        unsafe {
+            let ret_code = $name(
+                $data.as_mut_ptr(),
+                $data.len(),
+                sync_cmp_fn_of::<$type, _>(&sync_compare),
+                &sync_compare as *const _ as *mut u8,
+                crate::ffi_util::num_threads(),
+            );
+
+            if ret_code != 0 {
+                panic!("Panic in comparison function");
+            }
+        }
+    }};
+}
+
+/// Same as `ffi_sort_impl` for parallel implementations, that take the number of threads as
+/// additional trailing parameter. See `num_threads`.
+macro_rules! ffi_parallel_sort_impl {
+    (
+        $name:expr,
+        $sort_name_prefix:ident
+    ) => {
+        use std::cmp::Ordering;
+
+        use sort_test_tools::ffi_types::{CompResult, FFIOneKibiByte, FFIString, F128};
+
+        sort_impl!($name);
+
+        paste::paste! {
+            extern "C" {
+                fn [<$sort_name_prefix _i32>](data: *mut i32, len: usize, num_threads: usize);
+                fn [<$sort_name_prefix _i32_by>](
+                    data: *mut i32,
+                    len: usize,
+                    cmp_fn: unsafe extern "C" fn(&i32, &i32, *mut u8) -> CompResult,
+                    cmp_fn_ctx: *mut u8,
+                    num_threads: usize,
+                ) -> u32;
+                fn [<$sort_name_prefix _u64>](data: *mut u64, len: usize, num_threads: usize);
+                fn [<$sort_name_prefix _u64_by>](
+                    data: *mut u64,
+                    len: usize,
+                    cmp_fn: unsafe extern "C" fn(&u64, &u64, *mut u8) -> CompResult,
+                    cmp_fn_ctx: *mut u8,
+                    num_threads: usize,
+                ) -> u32;
+                fn [<$sort_name_prefix _ffi_string>](
+                    data: *mut FFIString,
+                    len: usize,
+                    num_threads: usize,
+                );
+                fn [<$sort_name_prefix _ffi_string_by>](
+                    data: *mut FFIString,
+                    len: usize,
+                    cmp_fn: unsafe extern "C" fn(&FFIString, &FFIString, *mut u8) -> CompResult,
+                    cmp_fn_ctx: *mut u8,
+                    num_threads: usize,
+                ) -> u32;
+                fn [<$sort_name_prefix _f128>](data: *mut F128, len: usize, num_threads: usize);
+                fn [<$sort_name_prefix _f128_by>](
+                    data: *mut F128,
+                    len: usize,
+                    cmp_fn: unsafe extern "C" fn(&F128, &F128, *mut u8) -> CompResult,
+                    cmp_fn_ctx: *mut u8,
+                    num_threads: usize,
+                ) -> u32;
+                fn [<$sort_name_prefix _1k>](
+                    data: *mut FFIOneKibiByte,
+                    len: usize,
+                    num_threads: usize,
+                );
+                fn [<$sort_name_prefix _1k_by>](
+                    data: *mut FFIOneKibiByte,
+                    len: usize,
+                    cmp_fn: unsafe extern "C" fn(&FFIOneKibiByte, &FFIOneKibiByte, *mut u8) -> CompResult,
+                    cmp_fn_ctx: *mut u8,
+                    num_threads: usize,
+                ) -> u32;
+            }
+
+            trait CppSort: Sized {
+                fn sort(data: &mut [Self]);
+                fn sort_by<F: FnMut(&Self, &Self) -> Ordering>(data: &mut [Self], compare: F);
+            }
+
+            impl<T> CppSort for T {
+                default fn sort(_data: &mut [T]) {
+                    panic!("Type not supported");
+                }
+
+                default fn sort_by<F: FnMut(&T, &T) -> Ordering>(_data: &mut [T], _compare: F) {
+                    panic!("Type not supported");
+                }
+            }
+
+            impl CppSort for i32 {
+                fn sort(data: &mut [Self]) {
+                    unsafe {
+                        [<$sort_name_prefix _i32>](
+                            data.as_mut_ptr(),
+                            data.len(),
+                            crate::ffi_util::num_threads_for::<Self>($name, data.len()),
+                        );
+                    }
+                }
+
+                fn sort_by<F: FnMut(&Self, &Self) -> Ordering>(data: &mut [Self], compare: F) {
+                    make_cpp_parallel_sort_by!([<$sort_name_prefix _i32_by>], data, compare, Self);
+                }
+            }
+
+            impl CppSort for u64 {
+                fn sort(data: &mut [Self]) {
+                    unsafe {
+                        [<$sort_name_prefix _u64>](
+                            data.as_mut_ptr(),
+                            data.len(),
+                            crate::ffi_util::num_threads_for::<Self>($name, data.len()),
+                        );
+                    }
+                }
+
+                fn sort_by<F: FnMut(&Self, &Self) -> Ordering>(data: &mut [Self], compare: F) {
+                    make_cpp_parallel_sort_by!([<$sort_name_prefix _u64_by>], data, compare, Self);
+                }
+            }
+
+            impl CppSort for FFIString {
+                fn sort(data: &mut [Self]) {
+                    unsafe {
+                        [<$sort_name_prefix _ffi_string>](
+                            data.as_mut_ptr(),
+                            data.len(),
+                            crate::ffi_util::num_threads_for::<Self>($name, data.len()),
+                        );
+                    }
+                }
+
+                fn sort_by<F: FnMut(&Self, &Self) -> Ordering>(data: &mut [Self], compare: F) {
+                    make_cpp_parallel_sort_by!(
+                        [<$sort_name_prefix _ffi_string_by>],
+                        data,
+                        compare,
+                        Self
+                    );
+                }
+            }
+
+            impl CppSort for F128 {
+                fn sort(data: &mut [Self]) {
+                    unsafe {
+                        [<$sort_name_prefix _f128>](
+                            data.as_mut_ptr(),
+                            data.len(),
+                            crate::ffi_util::num_threads_for::<Self>($name, data.len()),
+                        );
+                    }
+                }
+
+                fn sort_by<F: FnMut(&Self, &Self) -> Ordering>(data: &mut [Self], compare: F) {
+                    make_cpp_parallel_sort_by!([<$sort_name_prefix _f128_by>], data, compare, Self);
+                }
+            }
+
+            impl CppSort for FFIOneKibiByte {
+                fn sort(data: &mut [Self]) {
+                    unsafe {
+                        [<$sort_name_prefix _1k>](
+                            data.as_mut_ptr(),
+                            data.len(),
+                            crate::ffi_util::num_threads_for::<Self>($name, data.len()),
+                        );
+                    }
+                }
+
+                fn sort_by<F: FnMut(&Self, &Self) -> Ordering>(data: &mut [Self], compare: F) {
+                    make_cpp_parallel_sort_by!([<$sort_name_prefix _1k_by>], data, compare, Self);
+                }
+            }
+
+            pub fn sort<T: Ord>(data: &mut [T]) {
+                CppSort::sort(data);
+            }
+
+            pub fn sort_by<T, F: FnMut(&T, &T) -> Ordering>(data: &mut [T], compare: F) {
+                CppSort::sort_by(data, compare);
+            }
+        } // paste
+    };
+}
+
+/// Adds `sort_by_known_key` to a module that uses `ffi_sort_impl`, for implementations that provide
+/// `_by_key` entry points. See `KeyDescriptor`.
+macro_rules! ffi_sort_by_key_impl {
+    ($sort_name_prefix:ident) => {
+        use sort_test_tools::ffi_types::KeyDescriptor;
+
+        paste::paste! {
+            extern "C" {
+                fn [<$sort_name_prefix _i32_by_key>](
+                    data: *mut i32,
+                    len: usize,
+                    key: KeyDescriptor,
+                ) -> u32;
+                fn [<$sort_name_prefix _u64_by_key>](
+                    data: *mut u64,
+                    len: usize,
+                    key: KeyDescriptor,
+                ) -> u32;
+                fn [<$sort_name_prefix _1k_by_key>](
+                    data: *mut FFIOneKibiByte,
+                    len: usize,
+                    key: KeyDescriptor,
+                ) -> u32;
+            }
+
+            trait CppSortByKey: Sized {
+                fn sort_by_known_key(data: &mut [Self], key: KeyDescriptor) -> u32;
+            }
+
+            impl<T> CppSortByKey for T {
+                default fn sort_by_known_key(_data: &mut [T], _key: KeyDescriptor) -> u32 {
+                    panic!("Type not supported");
+                }
+            }
+
+            impl CppSortByKey for i32 {
+                fn sort_by_known_key(data: &mut [Self], key: KeyDescriptor) -> u32 {
+                    unsafe { [<$sort_name_prefix _i32_by_key>](data.as_mut_ptr(), data.len(), key) }
+                }
+            }
+
+            impl CppSortByKey for u64 {
+                fn sort_by_known_key(data: &mut [Self], key: KeyDescriptor) -> u32 {
+                    unsafe { [<$sort_name_prefix _u64_by_key>](data.as_mut_ptr(), data.len(), key) }
+                }
+            }
+
+            impl CppSortByKey for FFIOneKibiByte {
+                fn sort_by_known_key(data: &mut [Self], key: KeyDescriptor) -> u32 {
+                    unsafe { [<$sort_name_prefix _1k_by_key>](data.as_mut_ptr(), data.len(), key) }
+                }
+            }
+
+            /// Sorts `data` by the integer key described by `key`, without calling back into Rust.
+            pub fn sort_by_known_key<T>(data: &mut [T], key: KeyDescriptor) {
+                assert!(key.is_valid_for::<T>(), "Invalid key descriptor {key:?}");
+
+                let ret_code = CppSortByKey::sort_by_known_key(data, key);
+                assert_eq!(ret_code, 0, "Key descriptor rejected by C++ side");
+            }
+        } // paste
+    };
+}
+
+/// Adds `sort_by_nothrow` to a module that uses `ffi_sort_impl`, for implementations that provide
+/// `_by_nothrow` entry points. See `NOTHROW_SORT_BY_IMPL` in shared.h.
+macro_rules! ffi_sort_by_nothrow_impl {
+    ($sort_name_prefix:ident) => {
+        paste::paste! {
+            extern "C" {
+                fn [<$sort_name_prefix _i32_by_nothrow>](
+                    data: *mut i32,
+                    len: usize,
+                    cmp_fn: unsafe extern "C" fn(&i32, &i32, *mut u8) -> CompResult,
+                    cmp_fn_ctx: *mut u8,
+                ) -> u32;
+                fn [<$sort_name_prefix _u64_by_nothrow>](
+                    data: *mut u64,
+                    len: usize,
+                    cmp_fn: unsafe extern "C" fn(&u64, &u64, *mut u8) -> CompResult,
+                    cmp_fn_ctx: *mut u8,
+                ) -> u32;
+                fn [<$sort_name_prefix _ffi_string_by_nothrow>](
+                    data: *mut FFIString,
+                    len: usize,
+                    cmp_fn: unsafe extern "C" fn(&FFIString, &FFIString, *mut u8) -> CompResult,
+                    cmp_fn_ctx: *mut u8,
+                ) -> u32;
+                fn [<$sort_name_prefix _f128_by_nothrow>](
+                    data: *mut F128,
+                    len: usize,
+                    cmp_fn: unsafe extern "C" fn(&F128, &F128, *mut u8) -> CompResult,
+                    cmp_fn_ctx: *mut u8,
+                ) -> u32;
+                fn [<$sort_name_prefix _1k_by_nothrow>](
+                    data: *mut FFIOneKibiByte,
+                    len: usize,
+                    cmp_fn: unsafe extern "C" fn(&FFIOneKibiByte, &FFIOneKibiByte, *mut u8) -> CompResult,
+                    cmp_fn_ctx: *mut u8,
+                ) -> u32;
+            }
+
+            trait CppSortByNothrow: Sized {
+                fn sort_by_nothrow<F: FnMut(&Self, &Self) -> Ordering>(
+                    data: &mut [Self],
+                    compare: F,
+                );
+            }
+
+            impl<T> CppSortByNothrow for T {
+                default fn sort_by_nothrow<F: FnMut(&T, &T) -> Ordering>(
+                    _data: &mut [T],
+                    _compare: F,
+                ) {
+                    panic!("Type not supported");
+                }
+            }
+
+            impl CppSortByNothrow for i32 {
+                fn sort_by_nothrow<F: FnMut(&Self, &Self) -> Ordering>(
+                    data: &mut [Self],
+                    compare: F,
+                ) {
+                    make_cpp_sort_by!([<$sort_name_prefix _i32_by_nothrow>], data, compare, Self);
+                }
+            }
+
+            impl CppSortByNothrow for u64 {
+                fn sort_by_nothrow<F: FnMut(&Self, &Self) -> Ordering>(
+                    data: &mut [Self],
+                    compare: F,
+                ) {
+                    make_cpp_sort_by!([<$sort_name_prefix _u64_by_nothrow>], data, compare, Self);
+                }
+            }
+
+            impl CppSortByNothrow for FFIString {
+                fn sort_by_nothrow<F: FnMut(&Self, &Self) -> Ordering>(
+                    data: &mut [Self],
+                    compare: F,
+                ) {
+                    make_cpp_sort_by!(
+                        [<$sort_name_prefix _ffi_string_by_nothrow>],
+                        data,
+                        compare,
+                        Self
+                    );
+                }
+            }
+
+            impl CppSortByNothrow for F128 {
+                fn sort_by_nothrow<F: FnMut(&Self, &Self) -> Ordering>(
+                    data: &mut [Self],
+                    compare: F,
+                ) {
+                    make_cpp_sort_by!([<$sort_name_prefix _f128_by_nothrow>], data, compare, Self);
+                }
+            }
+
+            impl CppSortByNothrow for FFIOneKibiByte {
+                fn sort_by_nothrow<F: FnMut(&Self, &Self) -> Ordering>(
+                    data: &mut [Self],
+                    compare: F,
+                ) {
+                    make_cpp_sort_by!([<$sort_name_prefix _1k_by_nothrow>], data, compare, Self);
+                }
+            }
+
+            /// Same as `sort_by`, but a panic in `compare` doesn't throw through the C++ sort. From
+            /// then on all elements compare as equal without calling `compare`, the sort runs to
+            /// its end and the panic is reported like by `sort_by`.
+            pub fn sort_by_nothrow<T, F: FnMut(&T, &T) -> Ordering>(data: &mut [T], compare: F) {
+                CppSortByNothrow::sort_by_nothrow(data, compare);
+            }
+        } // paste
+    };
+}
+
+/// Adds `sort_counted` to a module that uses `ffi_sort_impl`, for sequential implementations that
+/// provide `_counted` entry points. See `COUNTED_SORT_IMPL` in shared.h.
+macro_rules! ffi_sort_counted_impl {
+    ($sort_name_prefix:ident) => {
+        use sort_test_tools::ffi_types::OpCounts;
+
+        paste::paste! {
+            extern "C" {
+                fn [<$sort_name_prefix _i32_counted>](
+                    data: *mut i32,
+                    len: usize,
+                    counts: *mut OpCounts,
+                );
+                fn [<$sort_name_prefix _u64_counted>](
+                    data: *mut u64,
+                    len: usize,
+                    counts: *mut OpCounts,
+                );
+                fn [<$sort_name_prefix _1k_counted>](
+                    data: *mut FFIOneKibiByte,
+                    len: usize,
+                    counts: *mut OpCounts,
+                );
+            }
+
+            trait CppSortCounted: Sized {
+                fn sort_counted(data: &mut [Self]) -> OpCounts;
+            }
+
+            impl<T> CppSortCounted for T {
+                default fn sort_counted(_data: &mut [T]) -> OpCounts {
+                    panic!("Type not supported");
+                }
+            }
+
+            impl CppSortCounted for i32 {
+                fn sort_counted(data: &mut [Self]) -> OpCounts {
+                    let mut counts = OpCounts::default();
+                    unsafe {
+                        [<$sort_name_prefix _i32_counted>](
+                            data.as_mut_ptr(),
+                            data.len(),
+                            &mut counts,
+                        );
+                    }
+                    counts
+                }
+            }
+
+            impl CppSortCounted for u64 {
+                fn sort_counted(data: &mut [Self]) -> OpCounts {
+                    let mut counts = OpCounts::default();
+                    unsafe {
+                        [<$sort_name_prefix _u64_counted>](
+                            data.as_mut_ptr(),
+                            data.len(),
+                            &mut counts,
+                        );
+                    }
+                    counts
+                }
+            }
+
+            impl CppSortCounted for FFIOneKibiByte {
+                fn sort_counted(data: &mut [Self]) -> OpCounts {
+                    let mut counts = OpCounts::default();
+                    unsafe {
+                        [<$sort_name_prefix _1k_counted>](
+                            data.as_mut_ptr(),
+                            data.len(),
+                            &mut counts,
+                        );
+                    }
+                    counts
+                }
+            }
+
+            /// Sorts `data` with the natural order of the type and returns the comparisons,
+            /// copies and moves of elements the implementation performed.
+            pub fn sort_counted<T: Ord>(data: &mut [T]) -> OpCounts {
+                CppSortCounted::sort_counted(data)
+            }
+        } // paste
+    };
+}
+
+/// Adds `sort_indirect` to a module that uses `ffi_sort_impl`, for implementations that provide a
+/// `_1k_indirect` entry point. See `INDIRECT_SORT_IMPL` in shared.h.
+macro_rules! ffi_sort_indirect_impl {
+    ($sort_name_prefix:ident) => {
+        paste::paste! {
+            extern "C" {
+                fn [<$sort_name_prefix _1k_indirect>](data: *mut FFIOneKibiByte, len: usize);
+            }
+
+            trait CppSortIndirect: Sized {
+                fn sort_indirect(data: &mut [Self]);
+            }
+
+            impl<T> CppSortIndirect for T {
+                default fn sort_indirect(_data: &mut [T]) {
+                    panic!("Type not supported");
+                }
+            }
+
+            impl CppSortIndirect for FFIOneKibiByte {
+                fn sort_indirect(data: &mut [Self]) {
+                    unsafe {
+                        [<$sort_name_prefix _1k_indirect>](data.as_mut_ptr(), data.len());
+                    }
+                }
+            }
+
+            /// Sorts `data` by sorting pointers to its elements and then moving every element
+            /// into place once. Only implemented for `FFIOneKibiByte`, where moving the elements
+            /// dominates the sort.
+            pub fn sort_indirect<T: Ord>(data: &mut [T]) {
+                CppSortIndirect::sort_indirect(data);
+            }
+        } // paste
+    };
+}
+
+/// Adds `sort_decorated` to a module that uses `ffi_sort_impl`, for implementations that provide
+/// `_f128_decorated` and `_1k_decorated` entry points. See `DECORATED_SORT_IMPL` in shared.h.
+macro_rules! ffi_sort_decorated_impl {
+    ($sort_name_prefix:ident) => {
+        paste::paste! {
+            extern "C" {
+                fn [<$sort_name_prefix _f128_decorated>](data: *mut F128, len: usize);
+                fn [<$sort_name_prefix _1k_decorated>](data: *mut FFIOneKibiByte, len: usize);
+            }
+
+            trait CppSortDecorated: Sized {
+                fn sort_decorated(data: &mut [Self]);
+            }
+
+            impl<T> CppSortDecorated for T {
+                default fn sort_decorated(_data: &mut [T]) {
+                    panic!("Type not supported");
+                }
+            }
+
+            impl CppSortDecorated for F128 {
+                fn sort_decorated(data: &mut [Self]) {
+                    unsafe {
+                        [<$sort_name_prefix _f128_decorated>](data.as_mut_ptr(), data.len());
+                    }
+                }
+            }
+
+            impl CppSortDecorated for FFIOneKibiByte {
+                fn sort_decorated(data: &mut [Self]) {
+                    unsafe {
+                        [<$sort_name_prefix _1k_decorated>](data.as_mut_ptr(), data.len());
+                    }
+                }
+            }
+
+            /// Sorts `data` by computing the comparison key of every element once, sorting the
+            /// keys together with the element indices and then moving every element into place
+            /// once. Stable. Only implemented for `F128` and `FFIOneKibiByte`, whose comparisons
+            /// recompute the key every time.
+            pub fn sort_decorated<T: Ord>(data: &mut [T]) {
+                CppSortDecorated::sort_decorated(data);
+            }
+        } // paste
+    };
+}
+
+/// The descriptors of the columns and their common length, see `ffi_sort_columns_impl`.
+///
+/// Panics if the columns differ in length.
+pub(crate) fn column_descriptors(
+    columns: &[sort_test_tools::ffi_types::SortColumn],
+) -> (Vec<sort_test_tools::ffi_types::ColumnDescriptor>, usize) {
+    let len = columns.first().map_or(0, |column| column.column.len());
+    assert!(
+        columns.iter().all(|column| column.column.len() == len),
+        "All columns must have the same length"
+    );
+
+    let descriptors = columns.iter().map(|column| column.descriptor()).collect();
+    (descriptors, len)
+}
+
+/// Adds `sort_columns` and the `encode_columns_*` functions to a module, for implementations
+/// that provide the `_sort_columns` and `_encode_columns_*` entry points. See
+/// `COLUMNAR_SORT_IMPL` in shared.h.
+macro_rules! ffi_sort_columns_impl {
+    ($sort_name_prefix:ident) => {
+        paste::paste! {
+            extern "C" {
+                fn [<$sort_name_prefix _sort_columns>](
+                    columns: *const sort_test_tools::ffi_types::ColumnDescriptor,
+                    n_columns: usize,
+                    len: usize,
+                    perm: *mut u64,
+                ) -> u32;
+                fn [<$sort_name_prefix _encode_columns_u64>](
+                    columns: *const sort_test_tools::ffi_types::ColumnDescriptor,
+                    n_columns: usize,
+                    len: usize,
+                    out: *mut u64,
+                ) -> usize;
+                fn [<$sort_name_prefix _encode_columns_u128>](
+                    columns: *const sort_test_tools::ffi_types::ColumnDescriptor,
+                    n_columns: usize,
+                    len: usize,
+                    out: *mut u128,
+                ) -> usize;
+                fn [<$sort_name_prefix _encode_columns_bytes>](
+                    columns: *const sort_test_tools::ffi_types::ColumnDescriptor,
+                    n_columns: usize,
+                    len: usize,
+                    string_prefix_bytes: usize,
+                    out: *mut u8,
+                    key_bytes: *mut usize,
+                ) -> usize;
+            }
+
+            /// Returns the row indices of a columnar table in the lexicographic order of the
+            /// given columns, without building the rows. Stable. The leading columns are encoded
+            /// into one normalized integer key per row and sorted as such, only rows with equal
+            /// keys are compared column by column.
+            ///
+            /// Panics if the columns differ in length.
+            pub fn sort_columns(
+                columns: &[sort_test_tools::ffi_types::SortColumn],
+            ) -> Vec<usize> {
+                const { assert!(std::mem::size_of::<usize>() == std::mem::size_of::<u64>()) };
+
+                let (descriptors, len) = crate::ffi_util::column_descriptors(columns);
+                let mut perm = Vec::<usize>::with_capacity(len);
+
+                // SAFETY: The descriptors point to `len` values each, borrowed for the whole
+                // call. `perm` has room for `len` values, which are all written on success.
+                unsafe {
+                    let ret_code = [<$sort_name_prefix _sort_columns>](
+                        descriptors.as_ptr(),
+                        descriptors.len(),
+                        len,
+                        perm.as_mut_ptr() as *mut u64,
+                    );
+                    assert_eq!(ret_code, 0, "Invalid column descriptor");
+                    perm.set_len(len);
+                }
+
+                perm
+            }
+
+            /// Encodes the leading columns into one order-preserving u64 key per row, the way
+            /// `sort_columns` does, so that any u64 sort can sort them. Returns the keys and the
+            /// number of leading columns whose order they fully capture, rows with equal keys
+            /// still need comparing by the columns from there on.
+            ///
+            /// Panics if the columns differ in length.
+            pub fn encode_columns_u64(
+                columns: &[sort_test_tools::ffi_types::SortColumn],
+            ) -> (Vec<u64>, usize) {
+                let (descriptors, len) = crate::ffi_util::column_descriptors(columns);
+                let mut keys = Vec::<u64>::with_capacity(len);
+
+                // SAFETY: See `sort_columns`, all `len` keys are written on success.
+                unsafe {
+                    let exact_columns = [<$sort_name_prefix _encode_columns_u64>](
+                        descriptors.as_ptr(),
+                        descriptors.len(),
+                        len,
+                        keys.as_mut_ptr(),
+                    );
+                    assert_ne!(exact_columns, usize::MAX, "Invalid column descriptor");
+                    keys.set_len(len);
+
+                    (keys, exact_columns)
+                }
+            }
+
+            /// Same as `encode_columns_u64`, with room for twice the bits.
+            pub fn encode_columns_u128(
+                columns: &[sort_test_tools::ffi_types::SortColumn],
+            ) -> (Vec<u128>, usize) {
+                let (descriptors, len) = crate::ffi_util::column_descriptors(columns);
+                let mut keys = Vec::<u128>::with_capacity(len);
+
+                // SAFETY: See `sort_columns`, all `len` keys are written on success.
+                unsafe {
+                    let exact_columns = [<$sort_name_prefix _encode_columns_u128>](
+                        descriptors.as_ptr(),
+                        descriptors.len(),
+                        len,
+                        keys.as_mut_ptr(),
+                    );
+                    assert_ne!(exact_columns, usize::MAX, "Invalid column descriptor");
+                    keys.set_len(len);
+
+                    (keys, exact_columns)
+                }
+            }
+
+            /// Encodes the leading columns into byte strings of equal width, whose `memcmp`
+            /// order is the order of the rows. Integers and floats keep their full width,
+            /// strings `string_prefix_bytes` of their leading bytes. Returns the keys of all
+            /// rows back to back, the width of one key, and the number of columns as
+            /// `encode_columns_u64`.
+            ///
+            /// Panics if the columns differ in length.
+            pub fn encode_columns_bytes(
+                columns: &[sort_test_tools::ffi_types::SortColumn],
+                string_prefix_bytes: usize,
+            ) -> (Vec<u8>, usize, usize) {
+                let (descriptors, len) = crate::ffi_util::column_descriptors(columns);
+                let mut key_bytes = 0;
+
+                // SAFETY: See `sort_columns`. A null `out` only queries the key width, the second
+                // call writes all `len * key_bytes` bytes on success.
+                unsafe {
+                    let exact_columns = [<$sort_name_prefix _encode_columns_bytes>](
+                        descriptors.as_ptr(),
+                        descriptors.len(),
+                        len,
+                        string_prefix_bytes,
+                        std::ptr::null_mut(),
+                        &mut key_bytes,
+                    );
+                    assert_ne!(exact_columns, usize::MAX, "Invalid column descriptor");
+
+                    let mut keys = Vec::<u8>::with_capacity(len * key_bytes);
+                    [<$sort_name_prefix _encode_columns_bytes>](
+                        descriptors.as_ptr(),
+                        descriptors.len(),
+                        len,
+                        string_prefix_bytes,
+                        keys.as_mut_ptr(),
+                        &mut key_bytes,
+                    );
+                    keys.set_len(len * key_bytes);
+
+                    (keys, key_bytes, exact_columns)
+                }
+            }
+        } // paste
+    };
+}
+
+/// Adds `sort_descending` to a module, for implementations that provide `_<type>_desc` entry
+/// points.
+macro_rules! ffi_sort_descending_impl {
+    ($sort_name_prefix:ident, $($type:ident),+) => {
+        paste::paste! {
+            extern "C" {
+                $(
+                    fn [<$sort_name_prefix _ $type _desc>](data: *mut $type, len: usize);
+                )+
+            }
+
+            trait CppSortDescending: Sized {
+                fn sort_descending(data: &mut [Self]);
+            }
+
+            impl<T> CppSortDescending for T {
+                default fn sort_descending(_data: &mut [T]) {
+                    panic!("Type not supported");
+                }
+            }
+
+            $(
+                impl CppSortDescending for $type {
+                    fn sort_descending(data: &mut [Self]) {
+                        unsafe {
+                            [<$sort_name_prefix _ $type _desc>](data.as_mut_ptr(), data.len());
+                        }
+                    }
+                }
+            )+
+
+            /// Sorts `data` in descending order, without going through a reversed comparator.
+            pub fn sort_descending<T: Ord>(data: &mut [T]) {
+                CppSortDescending::sort_descending(data);
+            }
+        } // paste
+    };
+}
+
+/// Adds `sort_packed` to a module, for implementations that provide `_<type_name>_packed` entry
+/// points for the listed `sort_test_tools::ffi_types` records, eg.
+/// `ffi_sort_packed_impl!(prefix, [KeyPayloadU32 => key_payload_u32])`. The records are sorted as
+/// integer words made of their fields, with the integer sort of the implementation.
+macro_rules! ffi_sort_packed_impl {
+    ($sort_name_prefix:ident, [$($type:ident => $type_name:ident),+]) => {
+        $(
+            use sort_test_tools::ffi_types::$type;
+        )+
+
+        paste::paste! {
+            extern "C" {
+                $(
+                    fn [<$sort_name_prefix _ $type_name _packed>](data: *mut $type, len: usize);
+                )+
+            }
+
+            trait CppSortPacked: Sized {
+                fn sort_packed(data: &mut [Self]);
+            }
+
+            impl<T> CppSortPacked for T {
+                default fn sort_packed(_data: &mut [T]) {
+                    panic!("Type not supported");
+                }
+            }
+
+            $(
+                impl CppSortPacked for $type {
+                    fn sort_packed(data: &mut [Self]) {
+                        unsafe {
+                            [<$sort_name_prefix _ $type_name _packed>](
+                                data.as_mut_ptr(),
+                                data.len(),
+                            );
+                        }
+                    }
+                }
+            )+
+
+            /// Sorts records by their fields in declaration order, as packed integer words.
+            pub fn sort_packed<T: Ord>(data: &mut [T]) {
+                CppSortPacked::sort_packed(data);
+            }
+        } // paste
+    };
+}
+
+/// Adds i16 and u16 support to a module that uses `ffi_sort_impl`. Kept separate because only a
+/// few of the C++ implementations provide 16-bit entry points.
+macro_rules! ffi_sort_16bit_impl {
+    ($sort_name_prefix:ident) => {
+        paste::paste! {
+            extern "C" {
+                fn [<$sort_name_prefix _i16>](data: *mut i16, len: usize);
+                fn [<$sort_name_prefix _i16_by>](
+                    data: *mut i16,
+                    len: usize,
+                    cmp_fn: unsafe extern "C" fn(&i16, &i16, *mut u8) -> CompResult,
+                    cmp_fn_ctx: *mut u8,
+                ) -> u32;
+                fn [<$sort_name_prefix _u16>](data: *mut u16, len: usize);
+                fn [<$sort_name_prefix _u16_by>](
+                    data: *mut u16,
+                    len: usize,
+                    cmp_fn: unsafe extern "C" fn(&u16, &u16, *mut u8) -> CompResult,
+                    cmp_fn_ctx: *mut u8,
+                ) -> u32;
+            }
+
+            impl CppSort for i16 {
+                fn sort(data: &mut [Self]) {
+                    unsafe {
+                        [<$sort_name_prefix _i16>](data.as_mut_ptr(), data.len());
+                    }
+                }
+
+                fn sort_by<F: FnMut(&Self, &Self) -> Ordering>(data: &mut [Self], compare: F) {
+                    make_cpp_sort_by!([<$sort_name_prefix _i16_by>], data, compare, Self);
+                }
+            }
+
+            impl CppSort for u16 {
+                fn sort(data: &mut [Self]) {
+                    unsafe {
+                        [<$sort_name_prefix _u16>](data.as_mut_ptr(), data.len());
+                    }
+                }
+
+                fn sort_by<F: FnMut(&Self, &Self) -> Ordering>(data: &mut [Self], compare: F) {
+                    make_cpp_sort_by!([<$sort_name_prefix _u16_by>], data, compare, Self);
+                }
+            }
+        } // paste
+    };
+}
+
+/// Adds the `F32` and `F64` float types to a module that uses `ffi_sort_impl`, or only the listed
+/// ones, eg. `ffi_sort_float_impl!(prefix, [F64 => f64])`.
+macro_rules! ffi_sort_float_impl {
+    ($sort_name_prefix:ident) => {
+        ffi_sort_float_impl!($sort_name_prefix, [F32 => f32, F64 => f64]);
+    };
+    ($sort_name_prefix:ident, [$($type:ident => $type_name:ident),+]) => {
+        ffi_sort_types_impl!($sort_name_prefix, [$($type => $type_name),+]);
+    };
+}
+
+/// Adds the `FFIArenaString` type to a module that uses `ffi_sort_impl`.
+macro_rules! ffi_sort_arena_string_impl {
+    ($sort_name_prefix:ident) => {
+        ffi_sort_types_impl!($sort_name_prefix, [FFIArenaString => arena_string]);
+    };
+}
+
+/// Adds opt-in `sort_test_tools::ffi_types` types with `<prefix>_<type_name>` and
+/// `<prefix>_<type_name>_by` entry points to a module that uses `ffi_sort_impl`.
+macro_rules! ffi_sort_types_impl {
+    ($sort_name_prefix:ident, [$($type:ident => $type_name:ident),+]) => {
+        $(
+            use sort_test_tools::ffi_types::$type;
+        )+
+
+        paste::paste! {
+            extern "C" {
+                $(
+                    fn [<$sort_name_prefix _ $type_name>](data: *mut $type, len: usize);
+                    fn [<$sort_name_prefix _ $type_name _by>](
+                        data: *mut $type,
+                        len: usize,
+                        cmp_fn: unsafe extern "C" fn(&$type, &$type, *mut u8) -> CompResult,
+                        cmp_fn_ctx: *mut u8,
+                    ) -> u32;
+                )+
+            }
+
+            $(
+                impl CppSort for $type {
+                    fn sort(data: &mut [Self]) {
+                        unsafe {
+                            [<$sort_name_prefix _ $type_name>](data.as_mut_ptr(), data.len());
+                        }
+                    }
+
+                    fn sort_by<F: FnMut(&Self, &Self) -> Ordering>(
+                        data: &mut [Self],
+                        compare: F,
+                    ) {
+                        make_cpp_sort_by!(
+                            [<$sort_name_prefix _ $type_name _by>],
+                            data,
+                            compare,
+                            Self
+                        );
+                    }
+                }
+            )+
+        } // paste
+    };
+}
+
+/// Adds `sort_with_buf` to a module that uses `ffi_sort_impl`, for implementations that provide
+/// `_with_buf` entry points. Implementations that have no use for the buffer fall back to their
+/// regular allocation strategy. With `records` the f128 and 1k entry points are used too.
+macro_rules! ffi_sort_with_buf_impl {
+    ($sort_name_prefix:ident, records) => {
+        ffi_sort_with_buf_impl!($sort_name_prefix);
+
+        paste::paste! {
+            extern "C" {
+                fn [<$sort_name_prefix _f128_with_buf>](
+                    data: *mut F128,
+                    len: usize,
+                    buf: *mut u8,
+                    buf_bytes: usize,
+                );
+                fn [<$sort_name_prefix _1k_with_buf>](
+                    data: *mut FFIOneKibiByte,
+                    len: usize,
+                    buf: *mut u8,
+                    buf_bytes: usize,
+                );
+            }
+
+            impl CppSortWithBuf for F128 {
+                fn sort_with_buf(data: &mut [Self], buf: &mut [std::mem::MaybeUninit<u8>]) {
+                    unsafe {
+                        [<$sort_name_prefix _f128_with_buf>](
+                            data.as_mut_ptr(),
+                            data.len(),
+                            buf.as_mut_ptr() as *mut u8,
+                            buf.len(),
+                        );
+                    }
+                }
+            }
+
+            impl CppSortWithBuf for FFIOneKibiByte {
+                fn sort_with_buf(data: &mut [Self], buf: &mut [std::mem::MaybeUninit<u8>]) {
+                    unsafe {
+                        [<$sort_name_prefix _1k_with_buf>](
+                            data.as_mut_ptr(),
+                            data.len(),
+                            buf.as_mut_ptr() as *mut u8,
+                            buf.len(),
+                        );
+                    }
+                }
+            }
+        } // paste
+    };
+    ($sort_name_prefix:ident) => {
+        paste::paste! {
+            extern "C" {
+                fn [<$sort_name_prefix _i32_with_buf>](
+                    data: *mut i32,
+                    len: usize,
+                    buf: *mut u8,
+                    buf_bytes: usize,
+                );
+                fn [<$sort_name_prefix _u64_with_buf>](
+                    data: *mut u64,
+                    len: usize,
+                    buf: *mut u8,
+                    buf_bytes: usize,
+                );
+            }
+
+            trait CppSortWithBuf: Sized {
+                fn sort_with_buf(data: &mut [Self], buf: &mut [std::mem::MaybeUninit<u8>]);
+            }
+
+            impl<T> CppSortWithBuf for T {
+                default fn sort_with_buf(_data: &mut [T], _buf: &mut [std::mem::MaybeUninit<u8>]) {
+                    panic!("Type not supported");
+                }
+            }
+
+            impl CppSortWithBuf for i32 {
+                fn sort_with_buf(data: &mut [Self], buf: &mut [std::mem::MaybeUninit<u8>]) {
+                    unsafe {
+                        [<$sort_name_prefix _i32_with_buf>](
+                            data.as_mut_ptr(),
+                            data.len(),
+                            buf.as_mut_ptr() as *mut u8,
+                            buf.len(),
+                        );
+                    }
+                }
+            }
+
+            impl CppSortWithBuf for u64 {
+                fn sort_with_buf(data: &mut [Self], buf: &mut [std::mem::MaybeUninit<u8>]) {
+                    unsafe {
+                        [<$sort_name_prefix _u64_with_buf>](
+                            data.as_mut_ptr(),
+                            data.len(),
+                            buf.as_mut_ptr() as *mut u8,
+                            buf.len(),
+                        );
+                    }
+                }
+            }
+
+            /// Size in bytes of a buffer that is large enough for `sort_with_buf` to sort `len`
+            /// elements of `T` without allocating.
+            pub fn buf_bytes_for<T>(len: usize) -> usize {
+                (len + 4) * std::mem::size_of::<T>()
+            }
+
+            /// Sorts `data` using the caller provided scratch `buf`. If `buf` is too small or not
+            /// aligned for `T`, the implementation silently falls back to allocating.
+            pub fn sort_with_buf<T: Ord>(data: &mut [T], buf: &mut [std::mem::MaybeUninit<u8>]) {
+                CppSortWithBuf::sort_with_buf(data, buf);
+            }
+        } // paste
+    };
+}
+
+/// Adds `sort_into` to a module that uses `ffi_sort_impl`, for implementations that provide
+/// `_into` entry points, which sort out-of-place from one slice into another.
+macro_rules! ffi_sort_into_impl {
+    ($sort_name_prefix:ident) => {
+        paste::paste! {
+            extern "C" {
+                fn [<$sort_name_prefix _i32_into>](src: *mut i32, dst: *mut i32, len: usize);
+                fn [<$sort_name_prefix _u64_into>](src: *mut u64, dst: *mut u64, len: usize);
+            }
+
+            trait CppSortInto: Sized {
+                fn sort_into(src: &mut [Self], dst: &mut [Self]);
+            }
+
+            impl<T> CppSortInto for T {
+                default fn sort_into(_src: &mut [T], _dst: &mut [T]) {
+                    panic!("Type not supported");
+                }
+            }
+
+            impl CppSortInto for i32 {
+                fn sort_into(src: &mut [Self], dst: &mut [Self]) {
+                    unsafe {
+                        [<$sort_name_prefix _i32_into>](
+                            src.as_mut_ptr(),
+                            dst.as_mut_ptr(),
+                            src.len(),
+                        );
+                    }
+                }
+            }
+
+            impl CppSortInto for u64 {
+                fn sort_into(src: &mut [Self], dst: &mut [Self]) {
+                    unsafe {
+                        [<$sort_name_prefix _u64_into>](
+                            src.as_mut_ptr(),
+                            dst.as_mut_ptr(),
+                            src.len(),
+                        );
+                    }
+                }
+            }
+
+            /// Writes the elements of `src` to `dst` in sorted order. `src` is used as scratch
+            /// space and is left holding the same elements in an unspecified order.
+            ///
+            /// Panics if the lengths differ.
+            pub fn sort_into<T: Ord>(src: &mut [T], dst: &mut [T]) {
+                assert_eq!(src.len(), dst.len(), "src and dst lengths differ");
+
+                CppSortInto::sort_into(src, dst);
+            }
+        } // paste
+    };
+}
+
+/// Adds `sort_batch` to a module that uses `ffi_sort_impl` or `ffi_parallel_sort_impl`, for
+/// implementations that provide a `_u64_batch` entry point. Sorting many short slices with a
+/// single call avoids paying for the FFI transition once per slice. Parallel implementations take
+/// the thread count as trailing argument, same as their other entry points.
+macro_rules! ffi_sort_batch_impl {
+    ($sort_name_prefix:ident) => {
+        ffi_sort_batch_impl!(@impl $sort_name_prefix, []);
+    };
+    ($sort_name_prefix:ident, parallel) => {
+        ffi_sort_batch_impl!(
+            @impl $sort_name_prefix,
+            [num_threads: usize = crate::ffi_util::num_threads()]
+        );
+    };
+    (@impl $sort_name_prefix:ident, [$($arg:ident: $arg_type:ty = $arg_val:expr)?]) => {
+        paste::paste! {
+            extern "C" {
+                fn [<$sort_name_prefix _u64_batch>](
+                    data: *mut u64,
+                    offsets: *const usize,
+                    n_slices: usize,
+                    $($arg: $arg_type)?
+                );
+            }
+
+            trait CppSortBatch: Sized {
+                fn sort_batch(data: &mut [Self], offsets: &[usize]);
+            }
+
+            impl<T> CppSortBatch for T {
+                default fn sort_batch(_data: &mut [T], _offsets: &[usize]) {
+                    panic!("Type not supported");
+                }
+            }
+
+            impl CppSortBatch for u64 {
+                fn sort_batch(data: &mut [Self], offsets: &[usize]) {
+                    unsafe {
+                        [<$sort_name_prefix _u64_batch>](
+                            data.as_mut_ptr(),
+                            offsets.as_ptr(),
+                            offsets.len().saturating_sub(1),
+                            $($arg_val)?
+                        );
+                    }
+                }
+            }
+
+            /// Sorts each of the slices `data[offsets[i]..offsets[i + 1]]` on its own. Elements
+            /// outside of the slices are left untouched.
+            ///
+            /// Panics if `offsets` is not ascending or points past the end of `data`.
+            pub fn sort_batch<T: Ord>(data: &mut [T], offsets: &[usize]) {
+                assert!(
+                    offsets.windows(2).all(|w| w[0] <= w[1]),
+                    "offsets must be ascending"
+                );
+                assert!(
+                    offsets.last().map_or(true, |end| *end <= data.len()),
+                    "offsets out of bounds"
+                );
+
+                CppSortBatch::sort_batch(data, offsets);
+            }
+        } // paste
+    };
+}
+
+/// Adds `merge_sorted_runs` to a module that uses `ffi_parallel_sort_impl`, for implementations
+/// that provide `_merge` entry points for u64, FFIString and F128.
+macro_rules! ffi_merge_sorted_runs_impl {
+    ($sort_name_prefix:ident) => {
+        ffi_merge_sorted_runs_impl!(
+            @impl $sort_name_prefix,
+            [u64 => u64, FFIString => ffi_string, F128 => f128]
+        );
+    };
+    (@impl $sort_name_prefix:ident, [$($type:ident => $type_name:ident),+]) => {
+        paste::paste! {
+            extern "C" {
+                $(
+                    fn [<$sort_name_prefix _ $type_name _merge>](
+                        data: *mut $type,
+                        offsets: *const usize,
+                        num_runs: usize,
+                        num_threads: usize,
+                    );
+                )+
+            }
+
+            trait CppMergeSortedRuns: Sized {
+                fn merge_sorted_runs(data: &mut [Self], offsets: &[usize]);
+            }
+
+            impl<T> CppMergeSortedRuns for T {
+                default fn merge_sorted_runs(_data: &mut [T], _offsets: &[usize]) {
+                    panic!("Type not supported");
+                }
+            }
+
+            $(
+                impl CppMergeSortedRuns for $type {
+                    fn merge_sorted_runs(data: &mut [Self], offsets: &[usize]) {
+                        unsafe {
+                            [<$sort_name_prefix _ $type_name _merge>](
+                                data.as_mut_ptr(),
+                                offsets.as_ptr(),
+                                offsets.len().saturating_sub(1),
+                                crate::ffi_util::num_threads(),
+                            );
+                        }
+                    }
+                }
+            )+
+
+            /// Merges the already sorted runs `data[offsets[i]..offsets[i + 1]]` into one sorted
+            /// sequence. Equal elements keep their order, with runs in the order of `offsets`.
+            /// The result is unspecified if one of the runs is not sorted.
+            ///
+            /// Panics if `offsets` is not ascending, or doesn't start at 0 and end at `data.len()`.
+            pub fn merge_sorted_runs<T: Ord>(data: &mut [T], offsets: &[usize]) {
+                assert!(
+                    offsets.windows(2).all(|w| w[0] <= w[1]),
+                    "offsets must be ascending"
+                );
+                assert!(
+                    offsets.first().map_or(true, |begin| *begin == 0)
+                        && offsets.last().map_or(data.is_empty(), |end| *end == data.len()),
+                    "offsets must cover data"
+                );
+
+                CppMergeSortedRuns::merge_sorted_runs(data, offsets);
+            }
+        } // paste
+    };
+}
+
+/// Adds `RunAccumulator` to a module, for implementations that provide `_u64_accumulator_*` entry
+/// points, see run_accumulator.h.
+macro_rules! ffi_run_accumulator_impl {
+    ($sort_name_prefix:ident) => {
+        paste::paste! {
+            extern "C" {
+                fn [<$sort_name_prefix _u64_accumulator_new>]() -> *mut std::ffi::c_void;
+                fn [<$sort_name_prefix _u64_accumulator_free>](acc: *mut std::ffi::c_void);
+                fn [<$sort_name_prefix _u64_accumulator_append>](
+                    acc: *mut std::ffi::c_void,
+                    data: *const u64,
+                    len: usize,
+                );
+                fn [<$sort_name_prefix _u64_accumulator_finalize>](
+                    acc: *mut std::ffi::c_void,
+                    len: *mut usize,
+                ) -> *const u64;
+                fn [<$sort_name_prefix _u64_accumulator_copy_in_order>](
+                    acc: *const std::ffi::c_void,
+                    out: *mut u64,
+                );
+                fn [<$sort_name_prefix _u64_accumulator_len>](acc: *const std::ffi::c_void) -> usize;
+                fn [<$sort_name_prefix _u64_accumulator_run_count>](
+                    acc: *const std::ffi::c_void,
+                ) -> usize;
+            }
+
+            /// Collects u64 that arrive in batches. Every batch is sorted on its own and the sorted
+            /// runs are merged lazily with the powersort merge policy, so keeping the data sorted
+            /// doesn't mean re-sorting all of it on every append.
+            pub struct RunAccumulator {
+                acc: *mut std::ffi::c_void,
+            }
+
+            impl RunAccumulator {
+                pub fn new() -> Self {
+                    Self {
+                        acc: unsafe { [<$sort_name_prefix _u64_accumulator_new>]() },
+                    }
+                }
+
+                /// Copies `batch` and adds it as a new sorted run.
+                pub fn append(&mut self, batch: &[u64]) {
+                    unsafe {
+                        [<$sort_name_prefix _u64_accumulator_append>](
+                            self.acc,
+                            batch.as_ptr(),
+                            batch.len(),
+                        );
+                    }
+                }
+
+                /// Merges all runs and returns everything appended so far in sorted order.
+                /// Appending afterwards is fine.
+                pub fn finalize(&mut self) -> &[u64] {
+                    let mut len = 0;
+                    // SAFETY: The returned pointer stays valid until the next call that takes
+                    // `&mut self`.
+                    unsafe {
+                        let data = [<$sort_name_prefix _u64_accumulator_finalize>](
+                            self.acc,
+                            &mut len,
+                        );
+                        if len == 0 {
+                            return &[];
+                        }
+                        std::slice::from_raw_parts(data, len)
+                    }
+                }
+
+                /// Everything appended so far in sorted order, without merging the runs.
+                pub fn copy_in_order(&self) -> Vec<u64> {
+                    let len = self.len();
+                    let mut out = Vec::with_capacity(len);
+                    // SAFETY: The C++ side writes exactly len values.
+                    unsafe {
+                        [<$sort_name_prefix _u64_accumulator_copy_in_order>](
+                            self.acc,
+                            out.as_mut_ptr(),
+                        );
+                        out.set_len(len);
+                    }
+
+                    out
+                }
+
+                pub fn len(&self) -> usize {
+                    unsafe { [<$sort_name_prefix _u64_accumulator_len>](self.acc) }
+                }
+
+                pub fn is_empty(&self) -> bool {
+                    self.len() == 0
+                }
+
+                /// Number of sorted runs that are not merged yet, logarithmic in the number of
+                /// appended batches.
+                pub fn run_count(&self) -> usize {
+                    unsafe { [<$sort_name_prefix _u64_accumulator_run_count>](self.acc) }
+                }
+            }
+
+            impl Default for RunAccumulator {
+                fn default() -> Self {
+                    Self::new()
+                }
+            }
+
+            impl Drop for RunAccumulator {
+                fn drop(&mut self) {
+                    unsafe {
+                        [<$sort_name_prefix _u64_accumulator_free>](self.acc);
+                    }
+                }
+            }
+
+            // SAFETY: The C++ object is not tied to the thread that created it.
+            unsafe impl Send for RunAccumulator {}
+        } // paste
+    };
+}
+
+/// Adds `partial_sort` to a module that uses `ffi_sort_impl`, for implementations that provide
+/// `_partial` entry points.
+macro_rules! ffi_sort_partial_impl {
+    ($sort_name_prefix:ident) => {
+        ffi_sort_with_k_impl!(
+            $sort_name_prefix, partial, CppPartialSort, partial_sort,
+            [i32 => i32, u64 => u64, FFIString => ffi_string, F128 => f128]
+        );
+
+        /// Sorts the `k` smallest elements of `data` into `data[..k]`. The order of the
+        /// remaining elements is unspecified.
+        ///
+        /// Panics if `k > data.len()`.
+        pub fn partial_sort<T: Ord>(data: &mut [T], k: usize) {
+            assert!(k <= data.len(), "k {k} out of bounds for len {}", data.len());
+
+            CppPartialSort::partial_sort(data, k);
+        }
+    };
+}
+
+/// Adds `sort_unique` and `sort_count_runs` to a module that uses `ffi_sort_impl`, for
+/// implementations that provide `_sort_unique` and `_sort_count_runs` entry points for i32, u64
+/// and FFIString.
+macro_rules! ffi_sort_unique_impl {
+    ($sort_name_prefix:ident) => {
+        ffi_sort_unique_impl!(
+            @impl $sort_name_prefix,
+            [i32 => i32, u64 => u64, FFIString => ffi_string]
+        );
+    };
+    (@impl $sort_name_prefix:ident, [$($type:ident => $type_name:ident),+]) => {
+        paste::paste! {
+            extern "C" {
+                $(
+                    fn [<$sort_name_prefix _ $type_name _sort_unique>](
+                        data: *mut $type,
+                        len: usize,
+                    ) -> usize;
+                    fn [<$sort_name_prefix _ $type_name _sort_count_runs>](
+                        data: *mut $type,
+                        len: usize,
+                        counts: *mut usize,
+                    ) -> usize;
+                )+
+            }
+
+            trait CppSortUnique: Sized {
+                fn sort_unique(data: &mut [Self]) -> usize;
+                fn sort_count_runs(data: &mut [Self], counts: *mut usize) -> usize;
+            }
+
+            impl<T> CppSortUnique for T {
+                default fn sort_unique(_data: &mut [T]) -> usize {
+                    panic!("Type not supported");
+                }
+
+                default fn sort_count_runs(_data: &mut [T], _counts: *mut usize) -> usize {
+                    panic!("Type not supported");
+                }
+            }
+
+            $(
+                impl CppSortUnique for $type {
+                    fn sort_unique(data: &mut [Self]) -> usize {
+                        unsafe {
+                            [<$sort_name_prefix _ $type_name _sort_unique>](
+                                data.as_mut_ptr(),
+                                data.len(),
+                            )
+                        }
+                    }
+
+                    fn sort_count_runs(data: &mut [Self], counts: *mut usize) -> usize {
+                        unsafe {
+                            [<$sort_name_prefix _ $type_name _sort_count_runs>](
+                                data.as_mut_ptr(),
+                                data.len(),
+                                counts,
+                            )
+                        }
+                    }
+                }
+            )+
+
+            /// Sorts `data` and moves every distinct value once to the front, in order, like
+            /// `sort_unstable` followed by `partition_dedup`, in a single pass over memory.
+            /// Returns the number of distinct values. The duplicates follow in unspecified order.
+            pub fn sort_unique<T: Ord>(data: &mut [T]) -> usize {
+                CppSortUnique::sort_unique(data)
+            }
+
+            /// Same as `sort_unique`, and returns the number of occurrences of each of the
+            /// distinct values at the front of `data`.
+            pub fn sort_count_runs<T: Ord>(data: &mut [T]) -> Vec<usize> {
+                // Only the pages for the actual number of distinct values get touched.
+                let mut counts = Vec::<usize>::with_capacity(data.len());
+                let unique_len = CppSortUnique::sort_count_runs(data, counts.as_mut_ptr());
+
+                // SAFETY: The first unique_len counts were written.
+                unsafe {
+                    counts.set_len(unique_len);
+                }
+
+                counts
+            }
+        } // paste
+    };
+}
+
+/// Adds `sort_lazy` to a module that uses `ffi_sort_impl`, for implementations that provide
+/// `_lazy_new`, `_lazy_advance` and `_lazy_free` entry points for i32, u64, FFIString and F128.
+macro_rules! ffi_sort_lazy_impl {
+    ($sort_name_prefix:ident) => {
+        ffi_sort_lazy_impl!(
+            @impl $sort_name_prefix,
+            [i32 => i32, u64 => u64, FFIString => ffi_string, F128 => f128]
+        );
+    };
+    (@impl $sort_name_prefix:ident, [$($type:ident => $type_name:ident),+]) => {
+        paste::paste! {
+            extern "C" {
+                $(
+                    fn [<$sort_name_prefix _ $type_name _lazy_new>](
+                        data: *mut $type,
+                        len: usize,
+                    ) -> *mut std::ffi::c_void;
+                    fn [<$sort_name_prefix _ $type_name _lazy_advance>](
+                        lazy: *mut std::ffi::c_void,
+                    ) -> usize;
+                    fn [<$sort_name_prefix _ $type_name _lazy_free>](lazy: *mut std::ffi::c_void);
+                )+
+            }
+
+            trait CppSortLazy: Sized {
+                fn lazy_new(data: &mut [Self]) -> *mut std::ffi::c_void;
+                fn lazy_advance(lazy: *mut std::ffi::c_void) -> usize;
+                fn lazy_free(lazy: *mut std::ffi::c_void);
+            }
+
+            impl<T> CppSortLazy for T {
+                default fn lazy_new(_data: &mut [T]) -> *mut std::ffi::c_void {
+                    panic!("Type not supported");
+                }
+
+                default fn lazy_advance(_lazy: *mut std::ffi::c_void) -> usize {
+                    unreachable!();
+                }
+
+                default fn lazy_free(_lazy: *mut std::ffi::c_void) {
+                    unreachable!();
+                }
+            }
+
+            $(
+                impl CppSortLazy for $type {
+                    fn lazy_new(data: &mut [Self]) -> *mut std::ffi::c_void {
+                        unsafe {
+                            [<$sort_name_prefix _ $type_name _lazy_new>](
+                                data.as_mut_ptr(),
+                                data.len(),
+                            )
+                        }
+                    }
+
+                    fn lazy_advance(lazy: *mut std::ffi::c_void) -> usize {
+                        unsafe { [<$sort_name_prefix _ $type_name _lazy_advance>](lazy) }
+                    }
+
+                    fn lazy_free(lazy: *mut std::ffi::c_void) {
+                        unsafe { [<$sort_name_prefix _ $type_name _lazy_free>](lazy) }
+                    }
+                }
+            )+
+
+            /// Iterator over a slice in sorted order, see `sort_lazy`.
+            pub struct SortedIter<'a, T> {
+                data: *const T,
+                len: usize,
+                pos: usize,
+                sorted_end: usize,
+                lazy: *mut std::ffi::c_void,
+                _data: std::marker::PhantomData<&'a mut [T]>,
+            }
+
+            impl<'a, T> Iterator for SortedIter<'a, T> {
+                type Item = &'a T;
+
+                fn next(&mut self) -> Option<&'a T> {
+                    if self.pos == self.sorted_end {
+                        if self.pos == self.len {
+                            return None;
+                        }
+                        self.sorted_end = T::lazy_advance(self.lazy);
+                    }
+
+                    // SAFETY: Everything before `sorted_end` is in its final position and never
+                    // moved again, while the iterator keeps `data` borrowed.
+                    let val = unsafe { &*self.data.add(self.pos) };
+                    self.pos += 1;
+                    Some(val)
+                }
+
+                fn size_hint(&self) -> (usize, Option<usize>) {
+                    (self.len - self.pos, Some(self.len - self.pos))
+                }
+            }
+
+            impl<T> ExactSizeIterator for SortedIter<'_, T> {}
+
+            impl<T> Drop for SortedIter<'_, T> {
+                fn drop(&mut self) {
+                    T::lazy_free(self.lazy);
+                }
+            }
+
+            /// Returns the elements of `data` in ascending order, sorting only as much as has been
+            /// read. Taking the first `k` of `n` elements costs about as much as `partial_sort`
+            /// with that `k`, without having to know `k` up front. Once the iterator is dropped
+            /// `data` starts with the elements read so far, in order, the order of the rest is
+            /// unspecified.
+            pub fn sort_lazy<T: Ord>(data: &mut [T]) -> SortedIter<'_, T> {
+                let lazy = T::lazy_new(data);
+
+                SortedIter {
+                    data: data.as_ptr(),
+                    len: data.len(),
+                    pos: 0,
+                    sorted_end: 0,
+                    lazy,
+                    _data: std::marker::PhantomData,
+                }
+            }
+        } // paste
+    };
+}
+
+/// Adds `select_nth_unstable` to a module that uses `ffi_sort_impl`, for implementations that
+/// provide `_select` entry points. Optionally takes the list of supported types, by default i32,
+/// u64, FFIString and F128.
+macro_rules! ffi_select_nth_impl {
+    ($sort_name_prefix:ident) => {
+        ffi_select_nth_impl!(
+            $sort_name_prefix,
+            [i32 => i32, u64 => u64, FFIString => ffi_string, F128 => f128]
+        );
+    };
+    ($sort_name_prefix:ident, [$($type:ident => $type_name:ident),+]) => {
+        ffi_sort_with_k_impl!(
+            $sort_name_prefix, select, CppSelectNth, select_nth_unstable,
+            [$($type => $type_name),+]
+        );
+
+        /// Reorders `data` such that the element at `index` is at its final sorted position, with
+        /// no larger element before and no smaller element after it.
+        ///
+        /// Panics if `index >= data.len()`.
+        pub fn select_nth_unstable<T: Ord>(data: &mut [T], index: usize) {
+            assert!(index < data.len(), "index {index} out of bounds for len {}", data.len());
+
+            CppSelectNth::select_nth_unstable(data, index);
+        }
+    };
+}
+
+// Shared by ffi_sort_partial_impl and ffi_select_nth_impl, both call an entry point of the form
+// `fn(data, len, k)` per type.
+macro_rules! ffi_sort_with_k_impl {
+    (
+        $sort_name_prefix:ident, $suffix:ident, $trait_name:ident, $fn_name:ident,
+        [$($type:ident => $type_name:ident),+]
+    ) => {
+        paste::paste! {
+            extern "C" {
+                $(
+                    fn [<$sort_name_prefix _ $type_name _ $suffix>](
+                        data: *mut $type,
+                        len: usize,
+                        k: usize,
+                    );
+                )+
+            }
+
+            trait $trait_name: Sized {
+                fn $fn_name(data: &mut [Self], k: usize);
+            }
+
+            impl<T> $trait_name for T {
+                default fn $fn_name(_data: &mut [T], _k: usize) {
+                    panic!("Type not supported");
+                }
+            }
+
+            $(
+                impl $trait_name for $type {
+                    fn $fn_name(data: &mut [Self], k: usize) {
+                        unsafe {
+                            [<$sort_name_prefix _ $type_name _ $suffix>](
+                                data.as_mut_ptr(),
+                                data.len(),
+                                k,
+                            );
+                        }
+                    }
+                }
+            )+
+        } // paste
+    };
+}
+
+/// Adds `simd_target` to a module, for SIMD implementations that pick their instruction set at
+/// runtime and provide a `_simd_target` entry point naming it.
+macro_rules! ffi_simd_target_impl {
+    ($sort_name_prefix:ident) => {
+        paste::paste! {
+            extern "C" {
+                fn [<$sort_name_prefix _simd_target>]() -> *const std::ffi::c_char;
+            }
+
+            /// Name of the instruction set the sort dispatches to on the current machine.
+            pub fn simd_target() -> &'static str {
+                // SAFETY: The C++ side returns a pointer to a static null terminated string.
+                unsafe { std::ffi::CStr::from_ptr([<$sort_name_prefix _simd_target>]()) }
+                    .to_str()
+                    .unwrap()
+            }
+        } // paste
+    };
+}
+
+/// Kind of a `TelemetryEvent`, same values as `sort_telemetry::Kind` in sort_telemetry.h.
+#[derive(Copy, Clone, Debug, PartialEq, Eq)]
+pub enum TelemetryKind {
+    /// Partition around a single pivot.
+    Partition,
+    /// Partition into buckets, by ips4o.
+    MultiwayPartition,
+    /// Too many bad partitions, the sub-slice is sorted by the worst case fallback.
+    Fallback,
+}
+
+/// One event of the SORT_TELEMETRY hooks, same layout as `sort_telemetry::Event`.
+#[repr(C)]
+#[derive(Copy, Clone, Debug, Default, PartialEq, Eq)]
+pub struct TelemetryEvent {
+    /// Length of the sub-slice.
+    pub len: u64,
+    /// For partitions the number of elements left of the pivot, for multiway partitions the
+    /// length of the largest bucket.
+    pub rank: u64,
+    pub buckets: u64,
+    kind: u32,
+    /// Recursion depth, 0 for the first partition.
+    pub depth: u32,
+}
+
+impl TelemetryEvent {
+    pub fn kind(&self) -> TelemetryKind {
+        match self.kind {
+            0 => TelemetryKind::Partition,
+            1 => TelemetryKind::MultiwayPartition,
+            2 => TelemetryKind::Fallback,
+            kind => panic!("Unknown telemetry kind {kind}"),
+        }
+    }
+}
+
+// Partitions use the `len: <len>, is_less: <rank>` lines of the instrumented Rust sorts, so that
+// util/analyze_pivot_quality.py and util/analyze_pivot_data.py work on them as well.
+impl std::fmt::Display for TelemetryEvent {
+    fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
+        match self.kind() {
+            TelemetryKind::Partition => write!(
+                f,
+                "len: {}, is_less: {}, depth: {}",
+                self.len, self.rank, self.depth
+            ),
+            TelemetryKind::MultiwayPartition => write!(
+                f,
+                "len: {}, buckets: {}, largest_bucket: {}, depth: {}",
+                self.len, self.buckets, self.rank, self.depth
+            ),
+            TelemetryKind::Fallback => {
+                write!(f, "fallback len: {}, depth: {}", self.len, self.depth)
+            }
+        }
+    }
+}
+
+pub struct Telemetry {
+    /// The newest events, oldest first.
+    pub events: Vec<TelemetryEvent>,
+    /// Events that were overwritten in the ring buffer before they could be read.
+    pub dropped: u64,
+}
+
+/// Adds `telemetry` and `reset_telemetry` to a module, for implementations built with the
+/// SORT_TELEMETRY hooks of sort_telemetry.h.
+#[allow(unused_macros)]
+macro_rules! ffi_telemetry_impl {
+    ($sort_name_prefix:ident) => {
+        paste::paste! {
+            extern "C" {
+                fn [<$sort_name_prefix _telemetry_capacity>]() -> usize;
+                fn [<$sort_name_prefix _telemetry_read>](
+                    out: *mut crate::ffi_util::TelemetryEvent,
+                    out_len: usize,
+                    total: *mut u64,
+                ) -> usize;
+                fn [<$sort_name_prefix _telemetry_reset>]();
+            }
+
+            /// Events recorded since the last `reset_telemetry`, by all sorts of this wrapper.
+            pub fn telemetry() -> crate::ffi_util::Telemetry {
+                // SAFETY: The C++ side writes at most out_len events, and sets total.
+                unsafe {
+                    let capacity = [<$sort_name_prefix _telemetry_capacity>]();
+                    let mut events = vec![crate::ffi_util::TelemetryEvent::default(); capacity];
+                    let mut total = 0u64;
+                    let len = [<$sort_name_prefix _telemetry_read>](
+                        events.as_mut_ptr(),
+                        events.len(),
+                        &mut total,
+                    );
+                    events.truncate(len);
+
+                    crate::ffi_util::Telemetry {
+                        dropped: total - len as u64,
+                        events,
+                    }
+                }
+            }
+
+            pub fn reset_telemetry() {
+                unsafe {
+                    [<$sort_name_prefix _telemetry_reset>]();
+                }
+            }
+        } // paste
+    };
+}
+
+/// Adds `PHASES`, `phase_times` and `reset_phase_times` to a module, for implementations built with
+/// phase timers that provide `_timer_read` and `_timer_reset` entry points.
+#[allow(unused_macros)]
+macro_rules! ffi_phase_timer_impl {
+    ($sort_name_prefix:ident, [$($phase_name:literal),+ $(,)?]) => {
+        paste::paste! {
+            extern "C" {
+                fn [<$sort_name_prefix _timer_read>](phase_ns: *mut u64);
+                fn [<$sort_name_prefix _timer_reset>]();
+            }
+
+            /// Names of the phases reported by `phase_times`, in the same order.
+            pub const PHASES: &[&str] = &[$($phase_name),+];
+
+            /// Time spent in each phase since the last `reset_phase_times`, summed across threads.
+            pub fn phase_times() -> Vec<std::time::Duration> {
+                let mut phase_ns = vec![0u64; PHASES.len()];
+                // SAFETY: The C++ side writes exactly one value per phase.
+                unsafe {
+                    [<$sort_name_prefix _timer_read>](phase_ns.as_mut_ptr());
+                }
+
+                phase_ns
+                    .into_iter()
+                    .map(std::time::Duration::from_nanos)
+                    .collect()
+            }
+
+            pub fn reset_phase_times() {
+                unsafe {
+                    [<$sort_name_prefix _timer_reset>]();
+                }
+            }
+        } // paste
+    };
+}
@@ -0,0 +1,477 @@
+//! Per host choice of the unstable sort, calibrated with short benchmarks.
+//!
+//! Which sort is fastest depends on the machine, see the different CPUs in `results/`. `calibrate`
+//! times every compiled-in single threaded unstable sort on a few representative patterns, for
+//! every supported type and power of ten length bucket, and records the winner of each in a
+//! `Table`. The winner of a bucket has the lowest sum of its times relative to the fastest sort of
+//! each pattern, so no single pattern dominates.
+//!
+//! Tables are stored as text files keyed by the CPU model, see `table_path`. `sort` looks up the
+//! table of the host the first time it's called, and calibrates and stores it if there is none
+//! yet. Calibrating ahead of time, e.g. with `BENCH_OTHER=auto_tune`, or installing a table with
+//! `set_table` avoids the calibration in production. Types other than i32 and u64, and `sort_by`,
+//! always use ipnsort.
+
+use std::env;
+use std::fs;
+use std::hint::black_box;
+use std::io::{self, BufRead, BufReader, Write};
+use std::path::{Path, PathBuf};
+use std::time::{Duration, Instant};
+
+use once_cell::sync::OnceCell;
+
+use sort_test_tools::patterns;
+use sort_test_tools::Sort;
+
+#[allow(unused_imports)]
+use crate::{other, unstable};
+
+sort_impl!("auto_tune_unstable");
+
+/// Element type the table has entries for.
+pub trait Tunable: Ord + Copy + 'static {
+    const TYPE_NAME: &'static str;
+
+    /// Maps the i32 values of the calibration patterns to `Self`, preserving their order.
+    fn from_pattern(val: i32) -> Self;
+
+    /// The resolved table entries of the type, see `resolve`.
+    fn sorts() -> &'static [fn(&mut [Self])];
+}
+
+impl Tunable for i32 {
+    const TYPE_NAME: &'static str = "i32";
+
+    fn from_pattern(val: i32) -> Self {
+        val
+    }
+
+    fn sorts() -> &'static [fn(&mut [Self])] {
+        static SORTS: OnceCell<Vec<fn(&mut [i32])>> = OnceCell::new();
+        SORTS.get_or_init(|| resolve(table()))
+    }
+}
+
+impl Tunable for u64 {
+    const TYPE_NAME: &'static str = "u64";
+
+    // Same as the u64 transform of the benchmarks.
+    fn from_pattern(val: i32) -> Self {
+        let shifted = (val as i64 - i32::MIN as i64) as u64;
+        shifted * i32::MAX as u64
+    }
+
+    fn sorts() -> &'static [fn(&mut [Self])] {
+        static SORTS: OnceCell<Vec<fn(&mut [u64])>> = OnceCell::new();
+        SORTS.get_or_init(|| resolve(table()))
+    }
+}
+
+/// The compiled-in sorts that support `T`, by their `Sort::name`. The parallel sorts are left
+/// out, their winner would depend on the load of the machine.
+pub fn candidates<T: Tunable>() -> Vec<(String, fn(&mut [T]))> {
+    let mut candidates: Vec<(String, fn(&mut [T]))> = Vec::new();
+
+    macro_rules! add_sort {
+        ($sort_impl_path:path) => {{
+            use $sort_impl_path::*;
+
+            candidates.push((<SortImpl as Sort>::name(), <SortImpl as Sort>::sort::<T>));
+        }};
+    }
+
+    add_sort!(unstable::rust_std);
+    add_sort!(unstable::rust_ipnsort);
+
+    #[cfg(feature = "cpp_std_sys")]
+    add_sort!(unstable::cpp_std_sys);
+
+    #[cfg(feature = "cpp_pdqsort")]
+    add_sort!(unstable::cpp_pdqsort);
+
+    #[cfg(feature = "cpp_ips4o")]
+    add_sort!(unstable::cpp_ips4o);
+
+    #[cfg(feature = "cpp_blockquicksort")]
+    add_sort!(unstable::cpp_blockquicksort);
+
+    #[cfg(feature = "cpp_adaptive")]
+    add_sort!(unstable::cpp_adaptive);
+
+    #[cfg(feature = "c_crumsort")]
+    add_sort!(unstable::c_crumsort);
+
+    #[cfg(feature = "cpp_vqsort")]
+    add_sort!(other::cpp_vqsort);
+
+    #[cfg(feature = "cpp_simdsort")]
+    add_sort!(other::cpp_simdsort);
+
+    #[cfg(feature = "cpp_intel_avx512")]
+    add_sort!(other::cpp_intel_avx512);
+
+    #[cfg(feature = "cpp_radix")]
+    add_sort!(other::cpp_radix);
+
+    #[cfg(feature = "singeli_singelisort")]
+    add_sort!(other::singeli_singelisort);
+
+    candidates
+}
+
+/// Length bucket of `len`, its number of decimal digits minus one.
+pub fn bucket(len: usize) -> usize {
+    len.checked_ilog10().unwrap_or(0) as usize
+}
+
+#[derive(Copy, Clone, Debug)]
+pub struct Config {
+    /// Largest length that is calibrated. Longer inputs use the winner of its bucket.
+    pub max_len: usize,
+    /// Every sort and pattern is timed this many times, the fastest run counts.
+    pub runs: usize,
+    /// Short inputs are sorted in batches of copies with at least this many elements in total, to
+    /// get above the resolution of the clock.
+    pub batch_elements: usize,
+}
+
+impl Default for Config {
+    fn default() -> Self {
+        Self {
+            max_len: 1_000_000,
+            runs: 5,
+            batch_elements: 16_384,
+        }
+    }
+}
+
+impl Config {
+    /// The default config, with `max_len` overridden by `SORT_AUTO_TUNE_MAX_LEN`.
+    pub fn from_env() -> Self {
+        let mut config = Self::default();
+        if let Ok(val) = env::var("SORT_AUTO_TUNE_MAX_LEN") {
+            config.max_len = val
+                .parse()
+                .expect("SORT_AUTO_TUNE_MAX_LEN must be a number");
+        }
+
+        config
+    }
+}
+
+#[derive(Clone, Debug, PartialEq, Eq)]
+pub struct Entry {
+    pub type_name: String,
+    pub bucket: usize,
+    pub sort_name: String,
+}
+
+/// The winner of every calibrated type and length bucket on one CPU model.
+#[derive(Clone, Debug, PartialEq, Eq)]
+pub struct Table {
+    pub cpu: String,
+    pub entries: Vec<Entry>,
+}
+
+const TABLE_HEADER: &str = "# sort-research-rs auto_tune table, see other::auto_tune.";
+
+impl Table {
+    /// The winner for `type_name` at `len`, from the largest calibrated bucket not above the
+    /// bucket of `len`.
+    pub fn winner(&self, type_name: &str, len: usize) -> Option<&str> {
+        self.entries
+            .iter()
+            .filter(|entry| entry.type_name == type_name && entry.bucket <= bucket(len))
+            .max_by_key(|entry| entry.bucket)
+            .map(|entry| entry.sort_name.as_str())
+    }
+
+    pub fn save(&self, path: &Path) -> io::Result<()> {
+        if let Some(dir) = path.parent() {
+            fs::create_dir_all(dir)?;
+        }
+
+        // Written to a temporary file first, so that concurrent processes never read a partial
+        // table.
+        let tmp_path = path.with_extension(format!("tmp{}", std::process::id()));
+        let mut file = fs::File::create(&tmp_path)?;
+        writeln!(file, "{TABLE_HEADER}")?;
+        writeln!(file, "cpu {}", self.cpu)?;
+        for entry in &self.entries {
+            writeln!(
+                file,
+                "{} {} {}",
+                entry.type_name, entry.bucket, entry.sort_name
+            )?;
+        }
+        file.sync_all()?;
+        drop(file);
+
+        fs::rename(&tmp_path, path)
+    }
+
+    pub fn load(path: &Path) -> io::Result<Self> {
+        let invalid = |line: &str| {
+            io::Error::new(
+                io::ErrorKind::InvalidData,
+                format!("invalid auto_tune table line: '{line}'"),
+            )
+        };
+
+        let mut table = Table {
+            cpu: String::new(),
+            entries: Vec::new(),
+        };
+
+        for line in BufReader::new(fs::File::open(path)?).lines() {
+            let line = line?;
+            if line.is_empty() || line.starts_with('#') {
+                continue;
+            }
+
+            if let Some(cpu) = line.strip_prefix("cpu ") {
+                table.cpu = cpu.to_string();
+                continue;
+            }
+
+            let fields: Vec<&str> = line.split_whitespace().collect();
+            let [type_name, bucket, sort_name] = fields[..] else {
+                return Err(invalid(&line));
+            };
+            table.entries.push(Entry {
+                type_name: type_name.to_string(),
+                bucket: bucket.parse().map_err(|_| invalid(&line))?,
+                sort_name: sort_name.to_string(),
+            });
+        }
+
+        Ok(table)
+    }
+}
+
+/// The CPU model, "model name" in /proc/cpuinfo. Arm CPUs on Linux only list their part number,
+/// which is mapped to the names `util/graph_bench_result/cpu_info.py` uses.
+pub fn cpu_model() -> String {
+    #[cfg(target_os = "linux")]
+    if let Ok(cpuinfo) = fs::read_to_string("/proc/cpuinfo") {
+        let field = |name: &str| {
+            cpuinfo.lines().find_map(|line| {
+                let (key, val) = line.split_once(':')?;
+                (key.trim() == name).then(|| val.trim().to_string())
+            })
+        };
+
+        if let Some(model_name) = field("model name") {
+            return model_name;
+        }
+
+        if let Some(part) = field("CPU part") {
+            return match part.as_str() {
+                "0xd03" => "Cortex-A53".into(),
+                "0xd0c" => "Neoverse N1".into(),
+                "0xd40" => "Neoverse V1".into(),
+                "0xd4f" => "Neoverse V2".into(),
+                _ => format!("{} part {part}", env::consts::ARCH),
+            };
+        }
+    }
+
+    #[cfg(target_os = "macos")]
+    if let Ok(output) = std::process::Command::new("sysctl")
+        .args(["-n", "machdep.cpu.brand_string"])
+        .output()
+    {
+        let brand = String::from_utf8_lossy(&output.stdout).trim().to_string();
+        if !brand.is_empty() {
+            return brand;
+        }
+    }
+
+    env::consts::ARCH.into()
+}
+
+/// Where the table of `cpu` is stored, see `cache_path`.
+pub fn table_path(cpu: &str) -> PathBuf {
+    cache_path("auto_tune", cpu)
+}
+
+/// A file of per host results named `<kind>-<cpu>.txt`: in `SORT_AUTO_TUNE_DIR`, or else the
+/// user's cache directory.
+pub fn cache_path(kind: &str, cpu: &str) -> PathBuf {
+    let dir = env::var_os("SORT_AUTO_TUNE_DIR")
+        .map(PathBuf::from)
+        .or_else(|| {
+            env::var_os("XDG_CACHE_HOME").map(|dir| PathBuf::from(dir).join("sort-research-rs"))
+        })
+        .or_else(|| {
+            env::var_os("HOME").map(|dir| PathBuf::from(dir).join(".cache/sort-research-rs"))
+        })
+        .unwrap_or_else(|| env::temp_dir().join("sort-research-rs"));
+
+    let file_name: String = cpu
+        .chars()
+        .map(|c| {
+            if c.is_ascii_alphanumeric() {
+                c.to_ascii_lowercase()
+            } else {
+                '_'
+            }
+        })
+        .collect();
+
+    dir.join(format!("{kind}-{file_name}.txt"))
+}
+
+type PatternFn = fn(usize) -> Vec<i32>;
+
+// A subset of the benchmark patterns: random, few distinct values, almost sorted and runs.
+const PATTERNS: [(&str, PatternFn); 4] = [
+    ("random", patterns::random),
+    ("random_d20", |len| patterns::random_uniform(len, 0..20)),
+    ("random_s95", |len| patterns::random_sorted(len, 95.0)),
+    ("saw_mixed", |len| {
+        patterns::saw_mixed(len, ((len as f64).log2().round()) as usize)
+    }),
+];
+
+// Fastest of `config.runs` runs of sorting copies of `input`, per copy.
+fn time_sort<T: Tunable>(config: &Config, sort: fn(&mut [T]), input: &[T]) -> Duration {
+    let len = input.len();
+    let copies = (config.batch_elements / len).max(1);
+    let batch: Vec<T> = input.iter().copied().cycle().take(len * copies).collect();
+    let mut data = batch.clone();
+
+    (0..config.runs.max(1))
+        .map(|_| {
+            data.copy_from_slice(&batch);
+
+            let start = Instant::now();
+            for chunk in data.chunks_exact_mut(len) {
+                sort(black_box(chunk));
+            }
+            black_box(&data);
+            start.elapsed() / copies as u32
+        })
+        .min()
+        .unwrap()
+}
+
+fn calibrate_type<T: Tunable>(config: &Config, entries: &mut Vec<Entry>) {
+    let candidates = candidates::<T>();
+
+    for bucket in 0..=bucket(config.max_len.max(1)) {
+        // Somewhere in the middle of the bucket on a log scale.
+        let len = (3 * 10usize.pow(bucket as u32)).min(config.max_len.max(1));
+
+        let mut scores = vec![0.0; candidates.len()];
+        for (_, pattern) in PATTERNS {
+            let input: Vec<T> = pattern(len).into_iter().map(T::from_pattern).collect();
+            let times: Vec<f64> = candidates
+                .iter()
+                .map(|(_, sort)| time_sort(config, *sort, &input).as_secs_f64())
+                .collect();
+
+            let fastest = times.iter().copied().fold(f64::INFINITY, f64::min);
+            for (score, time) in scores.iter_mut().zip(times) {
+                *score += time / fastest.max(f64::MIN_POSITIVE);
+            }
+        }
+
+        let (winner, _) = candidates
+            .iter()
+            .zip(scores)
+            .min_by(|(_, a), (_, b)| a.total_cmp(b))
+            .unwrap();
+
+        entries.push(Entry {
+            type_name: T::TYPE_NAME.into(),
+            bucket,
+            sort_name: winner.0.clone(),
+        });
+    }
+}
+
+/// Times the candidates of every type and length bucket up to `config.max_len` on this machine.
+pub fn calibrate(config: &Config) -> Table {
+    let mut entries = Vec::new();
+    calibrate_type::<i32>(config, &mut entries);
+    calibrate_type::<u64>(config, &mut entries);
+
+    Table {
+        cpu: cpu_model(),
+        entries,
+    }
+}
+
+static TABLE: OnceCell<Table> = OnceCell::new();
+
+/// Installs `table` as the table `sort` uses. Fails if `sort` already picked one.
+pub fn set_table(table: Table) -> Result<(), Table> {
+    TABLE.set(table)
+}
+
+/// The table `sort` uses. Unless one was installed with `set_table`, the table of this CPU model
+/// is loaded from `table_path`. If there is none, the machine is calibrated with
+/// `Config::from_env` and the result stored for the next process.
+pub fn table() -> &'static Table {
+    TABLE.get_or_init(|| {
+        let cpu = cpu_model();
+        let path = table_path(&cpu);
+
+        match Table::load(&path) {
+            Ok(table) if table.cpu == cpu => table,
+            _ => {
+                let table = calibrate(&Config::from_env());
+                if let Err(err) = table.save(&path) {
+                    eprintln!("Failed to store auto_tune table {}: {err}", path.display());
+                }
+                table
+            }
+        }
+    })
+}
+
+/// The sort of every length bucket of `T` in `table`. Buckets without a winner, or with one that
+/// isn't compiled in, use ipnsort.
+pub fn resolve<T: Tunable>(table: &Table) -> Vec<fn(&mut [T])> {
+    let candidates = candidates::<T>();
+
+    (0..=bucket(usize::MAX))
+        .map(|bucket| {
+            let len = 10usize.saturating_pow(bucket as u32);
+            table
+                .winner(T::TYPE_NAME, len)
+                .and_then(|name| candidates.iter().find(|(candidate, _)| candidate == name))
+                .map_or(
+                    unstable::rust_ipnsort::sort::<T> as fn(&mut [T]),
+                    |(_, sort)| *sort,
+                )
+        })
+        .collect()
+}
+
+trait AutoTuneSort: Sized {
+    fn auto_tune_sort(data: &mut [Self]);
+}
+
+impl<T: Ord> AutoTuneSort for T {
+    default fn auto_tune_sort(data: &mut [T]) {
+        unstable::rust_ipnsort::sort(data);
+    }
+}
+
+impl<T: Tunable> AutoTuneSort for T {
+    fn auto_tune_sort(data: &mut [T]) {
+        let sorts = T::sorts();
+        sorts[bucket(data.len()).min(sorts.len() - 1)](data);
+    }
+}
+
+pub fn sort<T: Ord>(data: &mut [T]) {
+    T::auto_tune_sort(data);
+}
+
+pub fn sort_by<T, F: FnMut(&T, &T) -> std::cmp::Ordering>(data: &mut [T], compare: F) {
+    unstable::rust_ipnsort::sort_by(data, compare);
+}
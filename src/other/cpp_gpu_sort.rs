@@ -0,0 +1,34 @@
+ffi_sort_impl!("cpp_gpu_sort_unstable", gpu_sort_unstable);
+
+extern "C" {
+    fn gpu_sort_unstable_i32_with_payload(keys: *mut i32, payload: *mut u32, len: usize);
+    fn gpu_sort_unstable_u64_with_payload(keys: *mut u64, payload: *mut u64, len: usize);
+}
+
+macro_rules! sort_with_payload_impl {
+    ($name:ident, $key_type:ty, $payload_type:ty, $ffi_fn:ident) => {
+        /// Sorts `keys` and applies the same permutation to `payload`, on the GPU. Stable, equal
+        /// keys keep the relative order of their payloads.
+        pub fn $name(keys: &mut [$key_type], payload: &mut [$payload_type]) {
+            assert_eq!(keys.len(), payload.len());
+
+            // SAFETY: Both slices are valid for `keys.len()` elements.
+            unsafe {
+                $ffi_fn(keys.as_mut_ptr(), payload.as_mut_ptr(), keys.len());
+            }
+        }
+    };
+}
+
+sort_with_payload_impl!(
+    sort_with_payload_i32,
+    i32,
+    u32,
+    gpu_sort_unstable_i32_with_payload
+);
+sort_with_payload_impl!(
+    sort_with_payload_u64,
+    u64,
+    u64,
+    gpu_sort_unstable_u64_with_payload
+);
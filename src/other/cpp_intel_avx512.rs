@@ -1 +1,42 @@
 ffi_sort_impl!("cpp_intel_avx512", intel_avx512);
+ffi_sort_descending_impl!(intel_avx512, i32, u64);
+ffi_sort_16bit_impl!(intel_avx512);
+ffi_sort_float_impl!(intel_avx512);
+ffi_sort_batch_impl!(intel_avx512);
+ffi_select_nth_impl!(intel_avx512, [i32 => i32, u64 => u64]);
+ffi_simd_target_impl!(intel_avx512);
+ffi_sort_packed_impl!(intel_avx512, [KeyPayloadU32 => key_payload_u32]);
+
+extern "C" {
+    fn intel_avx512_kv_u64(keys: *mut u64, values: *mut u64, len: usize);
+    fn intel_avx512_i16_fallback(data: *mut i16, len: usize);
+    fn intel_avx512_u16_fallback(data: *mut u16, len: usize);
+}
+
+/// Sorts `keys` and applies the same permutation to `payload`, with the AVX-512 partition and
+/// networks of the u64 sort. Not stable, equal keys can end up with their payloads in any order.
+pub fn sort_with_payload_u64(keys: &mut [u64], payload: &mut [u64]) {
+    assert_eq!(keys.len(), payload.len());
+
+    // SAFETY: Both slices are valid for `keys.len()` elements.
+    unsafe {
+        intel_avx512_kv_u64(keys.as_mut_ptr(), payload.as_mut_ptr(), keys.len());
+    }
+}
+
+/// Sorts with the fallback that the 16-bit sorts use on CPUs without AVX512-VBMI2, also on those
+/// that have it.
+pub fn sort_i16_fallback(data: &mut [i16]) {
+    // SAFETY: `data` is valid for `data.len()` elements.
+    unsafe {
+        intel_avx512_i16_fallback(data.as_mut_ptr(), data.len());
+    }
+}
+
+/// See [`sort_i16_fallback`].
+pub fn sort_u16_fallback(data: &mut [u16]) {
+    // SAFETY: `data` is valid for `data.len()` elements.
+    unsafe {
+        intel_avx512_u16_fallback(data.as_mut_ptr(), data.len());
+    }
+}
@@ -0,0 +1,46 @@
+//! Sorting networks for the lengths up to `MAX_LEN`, generated by util/generate_cpp_network.py.
+//! Only u64 and not a `Sort` impl, every other length is out of scope.
+
+/// Largest len with a network, same as `FIXED_NETWORK_MAX_LEN`.
+pub const MAX_LEN: usize = 32;
+
+extern "C" {
+    fn network_sort_u64(data: *mut u64, len: usize) -> u32;
+}
+
+/// Sorts `data` with the network for its len, dispatched at runtime.
+///
+/// Panics if `data.len() > MAX_LEN`.
+pub fn sort_u64(data: &mut [u64]) {
+    // SAFETY: The network for `data.len()` only accesses `data[..data.len()]`.
+    let res = unsafe { network_sort_u64(data.as_mut_ptr(), data.len()) };
+    assert!(res == 0, "No sorting network for len {}", data.len());
+}
+
+macro_rules! sort_u64_n_impl {
+    ($($n:literal)*) => {
+        paste::paste! {
+            extern "C" {
+                $(fn [<network_sort_u64_n $n>](data: *mut u64);)*
+            }
+
+            /// Sorts `data` with the network for `N`, without dispatching on the len. After
+            /// monomorphization this is a direct call.
+            ///
+            /// Panics if `N > MAX_LEN`.
+            #[inline(always)]
+            pub fn sort_u64_n<const N: usize>(data: &mut [u64; N]) {
+                match N {
+                    0 | 1 => {}
+                    // SAFETY: The network for `N` only accesses `data[..N]`.
+                    $($n => unsafe { [<network_sort_u64_n $n>](data.as_mut_ptr()) },)*
+                    _ => panic!("No sorting network for len {N}"),
+                }
+            }
+        }
+    };
+}
+
+sort_u64_n_impl!(
+    2 3 4 5 6 7 8 9 10 11 12 13 14 15 16 17 18 19 20 21 22 23 24 25 26 27 28 29 30 31 32
+);
@@ -0,0 +1,26 @@
+ffi_sort_impl!("cpp_radix", radix);
+ffi_sort_decorated_impl!(radix);
+ffi_sort_columns_impl!(radix);
+
+extern "C" {
+    fn radix_i32_with_payload(keys: *mut i32, payload: *mut u32, len: usize);
+    fn radix_u64_with_payload(keys: *mut u64, payload: *mut u64, len: usize);
+}
+
+macro_rules! sort_with_payload_impl {
+    ($name:ident, $key_type:ty, $payload_type:ty, $ffi_fn:ident) => {
+        /// Sorts `keys` and applies the same permutation to `payload`. Stable, equal keys keep
+        /// the relative order of their payloads.
+        pub fn $name(keys: &mut [$key_type], payload: &mut [$payload_type]) {
+            assert_eq!(keys.len(), payload.len());
+
+            // SAFETY: Both slices are valid for `keys.len()` elements.
+            unsafe {
+                $ffi_fn(keys.as_mut_ptr(), payload.as_mut_ptr(), keys.len());
+            }
+        }
+    };
+}
+
+sort_with_payload_impl!(sort_with_payload_i32, i32, u32, radix_i32_with_payload);
+sort_with_payload_impl!(sort_with_payload_u64, u64, u64, radix_u64_with_payload);
@@ -0,0 +1 @@
+ffi_parallel_sort_impl!("cpp_radix_parallel", radix_parallel);
@@ -1 +1,3 @@
 ffi_sort_impl!("cpp_simdsort", simdsort_avx2);
+ffi_sort_float_impl!(simdsort_avx2, [F32 => f32]);
+ffi_simd_target_impl!(simdsort_avx2);
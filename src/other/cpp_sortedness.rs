@@ -0,0 +1,113 @@
+//! Presortedness metrics of i32, u64, `F32` and `F64` slices, vectorized in C++, see
+//! src/cpp/sortedness.h. Other `Ord` types get the same results from a scalar Rust fallback.
+
+use sort_test_tools::ffi_types::{F32, F64};
+
+/// Same layout as `sortedness::Metrics`.
+#[repr(C)]
+#[derive(Copy, Clone, Debug, Default, PartialEq, Eq)]
+pub struct Metrics {
+    /// Neighbouring pairs in descending order, 0 for sorted input.
+    pub descents: u64,
+    /// Length of the longest non-descending run.
+    pub longest_run: u64,
+    /// Exact up to 1024 elements, above that estimated from a sample of 1024. Accurate for few
+    /// distinct values, a lower bound for many.
+    pub distinct_estimate: u64,
+}
+
+trait CppSortedness: Sized {
+    fn is_sorted(data: &[Self]) -> bool;
+    fn measure(data: &[Self]) -> Metrics;
+}
+
+impl<T: Ord> CppSortedness for T {
+    default fn is_sorted(data: &[T]) -> bool {
+        data.windows(2).all(|w| w[0] <= w[1])
+    }
+
+    default fn measure(data: &[T]) -> Metrics {
+        let mut metrics = Metrics {
+            descents: 0,
+            longest_run: data.len() as u64,
+            distinct_estimate: data.len() as u64,
+        };
+        if data.len() < 2 {
+            return metrics;
+        }
+
+        let mut run_len = 1;
+        metrics.longest_run = 1;
+        for w in data.windows(2) {
+            if w[1] < w[0] {
+                metrics.descents += 1;
+                run_len = 1;
+            } else {
+                run_len += 1;
+                metrics.longest_run = metrics.longest_run.max(run_len);
+            }
+        }
+
+        // Exact up to 1024 elements, above that a lower bound.
+        let mut sample = data
+            .iter()
+            .step_by(data.len().div_ceil(1024))
+            .collect::<Vec<_>>();
+        sample.sort_unstable();
+        sample.dedup();
+        metrics.distinct_estimate = sample.len() as u64;
+
+        metrics
+    }
+}
+
+macro_rules! cpp_sortedness_impl {
+    ($($type:ident => $type_name:ident),+) => {
+        paste::paste! {
+            extern "C" {
+                $(
+                    fn [<sortedness_is_sorted_ $type_name>](data: *const $type, len: usize) -> bool;
+                    fn [<sortedness_measure_ $type_name>](
+                        data: *const $type,
+                        len: usize,
+                        metrics: *mut Metrics,
+                    );
+                )+
+            }
+
+            $(
+                impl CppSortedness for $type {
+                    fn is_sorted(data: &[Self]) -> bool {
+                        // SAFETY: Only reads data[..data.len()].
+                        unsafe { [<sortedness_is_sorted_ $type_name>](data.as_ptr(), data.len()) }
+                    }
+
+                    fn measure(data: &[Self]) -> Metrics {
+                        let mut metrics = Metrics::default();
+                        // SAFETY: Only reads data[..data.len()] and writes metrics.
+                        unsafe {
+                            [<sortedness_measure_ $type_name>](
+                                data.as_ptr(),
+                                data.len(),
+                                &mut metrics,
+                            )
+                        };
+                        metrics
+                    }
+                }
+            )+
+        }
+    };
+}
+
+cpp_sortedness_impl!(i32 => i32, u64 => u64, F32 => f32, F64 => f64);
+
+/// `data.is_sorted()`, vectorized for the C++ types.
+pub fn is_sorted<T: Ord>(data: &[T]) -> bool {
+    CppSortedness::is_sorted(data)
+}
+
+/// Descents, longest run and distinct values of `data`, in one pass for the C++ types.
+pub fn measure<T: Ord>(data: &[T]) -> Metrics {
+    CppSortedness::measure(data)
+}
@@ -1 +1,100 @@
 ffi_sort_impl!("cpp_vqsort", vqsort);
+ffi_sort_descending_impl!(vqsort, i32, u64, u128);
+ffi_sort_16bit_impl!(vqsort);
+ffi_sort_float_impl!(vqsort);
+ffi_sort_batch_impl!(vqsort);
+ffi_run_accumulator_impl!(vqsort);
+ffi_select_nth_impl!(vqsort, [i32 => i32, u64 => u64]);
+ffi_simd_target_impl!(vqsort);
+ffi_sort_decorated_impl!(vqsort);
+ffi_sort_columns_impl!(vqsort);
+ffi_sort_packed_impl!(
+    vqsort,
+    [KeyPayloadU32 => key_payload_u32, KeyPayloadU64 => key_payload_u64]
+);
+
+extern "C" {
+    fn vqsort_u128(data: *mut u128, len: usize);
+}
+
+// u128 matches the layout of hwy::uint128_t, on little-endian targets with 16 byte alignment.
+const _: () = assert!(cfg!(target_endian = "little") && std::mem::align_of::<u128>() == 16);
+
+impl CppSort for u128 {
+    fn sort(data: &mut [Self]) {
+        unsafe {
+            vqsort_u128(data.as_mut_ptr(), data.len());
+        }
+    }
+
+    fn sort_by<F: FnMut(&Self, &Self) -> Ordering>(_data: &mut [Self], _compare: F) {
+        panic!("Type not supported");
+    }
+}
+
+/// 64 bit key plus 64 bit payload, with the same layout as `hwy::K64V64`. Only the key takes part
+/// in sorting.
+#[repr(C, align(16))]
+#[derive(Copy, Clone, Debug, PartialEq, Eq)]
+pub struct K64V64 {
+    pub value: u64,
+    pub key: u64,
+}
+
+impl K64V64 {
+    pub fn new(key: u64, value: u64) -> Self {
+        Self { value, key }
+    }
+}
+
+impl PartialOrd for K64V64 {
+    fn partial_cmp(&self, other: &Self) -> Option<Ordering> {
+        Some(self.cmp(other))
+    }
+}
+
+impl Ord for K64V64 {
+    fn cmp(&self, other: &Self) -> Ordering {
+        // The value only acts as tie-breaker to satisfy the Ord contract, vqsort ignores it.
+        (self.key, self.value).cmp(&(other.key, other.value))
+    }
+}
+
+extern "C" {
+    fn vqsort_kv_u64(data: *mut K64V64, len: usize);
+    fn vqsort_argsort_i32(keys: *const i32, len: usize, indices: *mut u32) -> u32;
+    fn vqsort_argsort_u64(keys: *const u64, len: usize, indices: *mut u32) -> u32;
+}
+
+/// Sorts `data` by key. Not stable, the payload order of equal keys is unspecified.
+pub fn sort_kv_u64(data: &mut [K64V64]) {
+    // SAFETY: K64V64 matches the C++ layout.
+    unsafe {
+        vqsort_kv_u64(data.as_mut_ptr(), data.len());
+    }
+}
+
+macro_rules! argsort_impl {
+    ($name:ident, $key_type:ty, $ffi_fn:ident) => {
+        /// Returns the permutation that sorts `keys`. The relative order of indices with equal
+        /// keys is unspecified.
+        pub fn $name(keys: &[$key_type]) -> Vec<u32> {
+            assert!(keys.len() <= u32::MAX as usize);
+
+            let mut indices = Vec::with_capacity(keys.len());
+
+            // SAFETY: `indices` has capacity for `keys.len()` elements, which are all written by
+            // the C++ side on success.
+            unsafe {
+                let ret_code = $ffi_fn(keys.as_ptr(), keys.len(), indices.as_mut_ptr());
+                assert_eq!(ret_code, 0, "argsort failed");
+                indices.set_len(keys.len());
+            }
+
+            indices
+        }
+    };
+}
+
+argsort_impl!(argsort_i32, i32, vqsort_argsort_i32);
+argsort_impl!(argsort_u64, u64, vqsort_argsort_u64);
@@ -0,0 +1,485 @@
+//! External merge sort for inputs that don't fit into memory, built on top of the in-memory sorts.
+//!
+//! The input file is read in chunks of `Config::chunk_bytes`, each chunk is sorted with the
+//! in-memory sort `S` and written out as a run. The runs are then merged with a loser tree, in
+//! several passes if there are more than `Config::fan_in` of them. Writing a run happens on a
+//! separate thread, overlapped with reading and sorting the next chunk. The same goes for writing
+//! the output during the merge.
+//!
+//! u64 files are plain little-endian 8 byte values, string files newline separated UTF-8 lines.
+
+use std::env;
+use std::fs::{self, File};
+use std::io::{self, BufRead, BufReader, BufWriter, Write};
+use std::mem;
+use std::path::{Path, PathBuf};
+use std::process;
+use std::sync::atomic::{AtomicUsize, Ordering as AtomicOrdering};
+use std::sync::mpsc;
+use std::thread;
+
+use sort_test_tools::ffi_types::FFIString;
+use sort_test_tools::Sort;
+
+/// Element type that can be stored in run files.
+pub trait Record: Ord + Send + Sized + 'static {
+    /// Reads the next record, `None` at the end of the input.
+    fn read_from(reader: &mut impl BufRead) -> io::Result<Option<Self>>;
+
+    fn write_to(&self, writer: &mut impl Write) -> io::Result<()>;
+
+    /// Memory used by the record, including the heap memory it owns.
+    fn mem_size(&self) -> usize;
+
+    /// Appends records to the empty `chunk` until they use `chunk_bytes` or the input ends.
+    fn read_chunk(
+        reader: &mut impl BufRead,
+        chunk_bytes: usize,
+        chunk: &mut Vec<Self>,
+    ) -> io::Result<()> {
+        let mut chunk_size = 0;
+        while chunk_size < chunk_bytes {
+            match Self::read_from(reader)? {
+                Some(record) => {
+                    chunk_size += record.mem_size();
+                    chunk.push(record);
+                }
+                None => break,
+            }
+        }
+
+        Ok(())
+    }
+
+    fn write_records(records: &[Self], writer: &mut impl Write) -> io::Result<()> {
+        records
+            .iter()
+            .try_for_each(|record| record.write_to(writer))
+    }
+}
+
+impl Record for u64 {
+    fn read_from(reader: &mut impl BufRead) -> io::Result<Option<Self>> {
+        if reader.fill_buf()?.is_empty() {
+            return Ok(None);
+        }
+
+        let mut bytes = [0u8; 8];
+        reader.read_exact(&mut bytes)?;
+        Ok(Some(u64::from_le_bytes(bytes)))
+    }
+
+    fn write_to(&self, writer: &mut impl Write) -> io::Result<()> {
+        writer.write_all(&self.to_le_bytes())
+    }
+
+    fn mem_size(&self) -> usize {
+        mem::size_of::<Self>()
+    }
+
+    // Reads the whole chunk with a single copy out of the page cache.
+    fn read_chunk(
+        reader: &mut impl BufRead,
+        chunk_bytes: usize,
+        chunk: &mut Vec<Self>,
+    ) -> io::Result<()> {
+        let len = (chunk_bytes / mem::size_of::<Self>()).max(1);
+        chunk.resize(len, 0);
+
+        // SAFETY: u64 has neither padding nor invalid bit patterns.
+        let bytes = unsafe {
+            std::slice::from_raw_parts_mut(
+                chunk.as_mut_ptr() as *mut u8,
+                len * mem::size_of::<Self>(),
+            )
+        };
+
+        let mut read_len = 0;
+        while read_len < bytes.len() {
+            match reader.read(&mut bytes[read_len..]) {
+                Ok(0) => break,
+                Ok(n) => read_len += n,
+                Err(err) if err.kind() == io::ErrorKind::Interrupted => {}
+                Err(err) => return Err(err),
+            }
+        }
+
+        if read_len % mem::size_of::<Self>() != 0 {
+            return Err(io::Error::new(
+                io::ErrorKind::InvalidData,
+                "u64 input length is not a multiple of 8 bytes",
+            ));
+        }
+
+        chunk.truncate(read_len / mem::size_of::<Self>());
+        for val in chunk.iter_mut() {
+            *val = u64::from_le(*val);
+        }
+
+        Ok(())
+    }
+
+    fn write_records(records: &[Self], writer: &mut impl Write) -> io::Result<()> {
+        if cfg!(target_endian = "big") {
+            return records
+                .iter()
+                .try_for_each(|record| record.write_to(writer));
+        }
+
+        // SAFETY: u64 has no padding, and on little-endian targets the in-memory representation
+        // is the file format.
+        let bytes = unsafe {
+            std::slice::from_raw_parts(records.as_ptr() as *const u8, mem::size_of_val(records))
+        };
+        writer.write_all(bytes)
+    }
+}
+
+impl Record for FFIString {
+    fn read_from(reader: &mut impl BufRead) -> io::Result<Option<Self>> {
+        let mut line = Vec::new();
+        if reader.read_until(b'\n', &mut line)? == 0 {
+            return Ok(None);
+        }
+
+        if line.last() == Some(&b'\n') {
+            line.pop();
+        }
+
+        String::from_utf8(line)
+            .map(|val| Some(FFIString::new(val)))
+            .map_err(|err| io::Error::new(io::ErrorKind::InvalidData, err))
+    }
+
+    fn write_to(&self, writer: &mut impl Write) -> io::Result<()> {
+        writer.write_all(self.as_str().unwrap().as_bytes())?;
+        writer.write_all(b"\n")
+    }
+
+    fn mem_size(&self) -> usize {
+        mem::size_of::<Self>() + self.as_str().unwrap().len()
+    }
+}
+
+#[derive(Clone, Debug)]
+pub struct Config {
+    /// Memory used by a chunk. While one chunk is written out the next one is read and sorted, so
+    /// this needs about twice that, plus whatever the in-memory sort allocates.
+    pub chunk_bytes: usize,
+    /// Maximum number of runs merged at once.
+    pub fan_in: usize,
+    /// Buffer size of every file that is read or written.
+    pub io_buffer_bytes: usize,
+    /// Where the runs are written to.
+    pub temp_dir: PathBuf,
+}
+
+impl Default for Config {
+    fn default() -> Self {
+        Self {
+            chunk_bytes: 1 << 30,
+            fan_in: 64,
+            io_buffer_bytes: 4 << 20,
+            temp_dir: env::temp_dir(),
+        }
+    }
+}
+
+#[derive(Copy, Clone, Debug, Default, PartialEq, Eq)]
+pub struct Stats {
+    /// Runs written by the in-memory sort.
+    pub run_count: usize,
+    /// Merge passes over the whole data, including the final one into the output.
+    pub merge_passes: usize,
+}
+
+/// Sorts the records of the file `input` into the file `output`, using `S` for the in-memory
+/// sorts. `input` and `output` may be the same file.
+pub fn sort_file<S: Sort, T: Record>(
+    input: &Path,
+    output: &Path,
+    config: &Config,
+) -> io::Result<Stats> {
+    assert!(config.chunk_bytes > 0 && config.fan_in >= 2);
+
+    let mut runs = create_runs::<S, T>(input, config)?;
+    let mut stats = Stats {
+        run_count: runs.paths.len(),
+        merge_passes: 0,
+    };
+
+    while runs.paths.len() > config.fan_in {
+        let mut next_runs = RunFiles::new(config);
+        for group in runs.paths.chunks(config.fan_in) {
+            let run_path = next_runs.add();
+            merge_runs::<T>(group, &run_path, config)?;
+        }
+
+        // Deletes the runs of the previous pass.
+        runs = next_runs;
+        stats.merge_passes += 1;
+    }
+
+    merge_runs::<T>(&runs.paths, output, config)?;
+    stats.merge_passes += 1;
+
+    Ok(stats)
+}
+
+// Temporary run files, deleted on drop.
+struct RunFiles {
+    prefix: PathBuf,
+    paths: Vec<PathBuf>,
+}
+
+impl RunFiles {
+    fn new(config: &Config) -> Self {
+        static NEXT_ID: AtomicUsize = AtomicUsize::new(0);
+
+        let id = NEXT_ID.fetch_add(1, AtomicOrdering::Relaxed);
+        Self {
+            prefix: config
+                .temp_dir
+                .join(format!("external_sort_{}_{id}", process::id())),
+            paths: Vec::new(),
+        }
+    }
+
+    fn add(&mut self) -> PathBuf {
+        let mut path = self.prefix.clone().into_os_string();
+        path.push(format!("_{}.run", self.paths.len()));
+
+        self.paths.push(path.into());
+        self.paths.last().unwrap().clone()
+    }
+}
+
+impl Drop for RunFiles {
+    fn drop(&mut self) {
+        for path in &self.paths {
+            // The run may not have been created, if an earlier one failed.
+            let _ = fs::remove_file(path);
+        }
+    }
+}
+
+// Writes batches of records to `path` on a separate thread. The batches are handed back through
+// `free_batches` once written, to reuse their allocation.
+struct AsyncWriter<T> {
+    batches: Option<mpsc::SyncSender<Vec<T>>>,
+    free_batches: mpsc::Receiver<Vec<T>>,
+    thread: Option<thread::JoinHandle<io::Result<()>>>,
+}
+
+impl<T: Record> AsyncWriter<T> {
+    fn new(path: &Path, io_buffer_bytes: usize) -> io::Result<Self> {
+        let mut writer = BufWriter::with_capacity(io_buffer_bytes, File::create(path)?);
+
+        // Rendezvous channel, at most one batch is written while the next one is filled.
+        let (batch_tx, batch_rx) = mpsc::sync_channel::<Vec<T>>(0);
+        let (free_tx, free_rx) = mpsc::channel();
+
+        let thread = thread::spawn(move || {
+            for mut batch in batch_rx {
+                T::write_records(&batch, &mut writer)?;
+                batch.clear();
+                let _ = free_tx.send(batch);
+            }
+
+            writer.flush()
+        });
+
+        Ok(Self {
+            batches: Some(batch_tx),
+            free_batches: free_rx,
+            thread: Some(thread),
+        })
+    }
+
+    /// Queues `batch` and returns an empty one to fill next. Errors of the writer thread are only
+    /// reported by `finish`.
+    fn write(&mut self, batch: Vec<T>) -> Vec<T> {
+        let _ = self.batches.as_ref().unwrap().send(batch);
+        self.free_batches.try_recv().unwrap_or_default()
+    }
+
+    /// Waits for all batches to be written, and returns the allocation of the last one.
+    fn finish(mut self) -> io::Result<Vec<T>> {
+        drop(self.batches.take());
+        self.thread
+            .take()
+            .unwrap()
+            .join()
+            .expect("Writer thread panicked")?;
+
+        Ok(self.free_batches.try_iter().last().unwrap_or_default())
+    }
+}
+
+impl<T> Drop for AsyncWriter<T> {
+    fn drop(&mut self) {
+        drop(self.batches.take());
+        if let Some(thread) = self.thread.take() {
+            let _ = thread.join();
+        }
+    }
+}
+
+fn create_runs<S: Sort, T: Record>(input: &Path, config: &Config) -> io::Result<RunFiles> {
+    let mut reader = BufReader::with_capacity(config.io_buffer_bytes, File::open(input)?);
+    let mut runs = RunFiles::new(config);
+
+    // Two chunks that take turns, one is read and sorted while the other one is written.
+    let mut chunk = Vec::new();
+    let mut spare_chunk = Vec::new();
+    let mut pending_run: Option<AsyncWriter<T>> = None;
+
+    loop {
+        T::read_chunk(&mut reader, config.chunk_bytes, &mut chunk)?;
+        if chunk.is_empty() {
+            break;
+        }
+
+        S::sort(&mut chunk);
+
+        // Only one run is written at a time, this keeps the memory bounded and the writes
+        // sequential.
+        if let Some(run_writer) = pending_run.take() {
+            spare_chunk = run_writer.finish()?;
+        }
+
+        let mut run_writer = AsyncWriter::new(&runs.add(), config.io_buffer_bytes)?;
+        run_writer.write(chunk);
+        chunk = mem::take(&mut spare_chunk);
+        pending_run = Some(run_writer);
+    }
+
+    if let Some(run_writer) = pending_run {
+        run_writer.finish()?;
+    }
+
+    Ok(runs)
+}
+
+/// Tournament tree of losers over the current head of every run, see Knuth TAOCP Vol. 3 5.4.1.
+/// Replacing the winner takes one comparison per level, against the losers on the path from its
+/// leaf to the root. Exhausted runs compare greater than everything else.
+struct LoserTree<T> {
+    heads: Vec<Option<T>>,
+    // nodes[0] is the overall winner, nodes[1..k] the losers of the internal nodes. Leaf i is
+    // node k + i.
+    nodes: Vec<usize>,
+}
+
+impl<T: Ord> LoserTree<T> {
+    fn new(heads: Vec<Option<T>>) -> Self {
+        const EMPTY: usize = usize::MAX;
+
+        let k = heads.len();
+        let mut tree = Self {
+            heads,
+            nodes: vec![EMPTY; k.max(1)],
+        };
+
+        // Every internal node has two children, the first one to arrive waits as loser for the
+        // second one.
+        for leaf in 0..k {
+            let mut winner = leaf;
+            let mut node = (k + leaf) / 2;
+
+            loop {
+                if node == 0 {
+                    tree.nodes[0] = winner;
+                    break;
+                }
+
+                if tree.nodes[node] == EMPTY {
+                    tree.nodes[node] = winner;
+                    break;
+                }
+
+                if tree.is_less(tree.nodes[node], winner) {
+                    mem::swap(&mut tree.nodes[node], &mut winner);
+                }
+                node /= 2;
+            }
+        }
+
+        tree
+    }
+
+    // Ties go to the lower run, which keeps the merge deterministic.
+    fn is_less(&self, a: usize, b: usize) -> bool {
+        match (&self.heads[a], &self.heads[b]) {
+            (Some(head_a), Some(head_b)) => (head_a, a) < (head_b, b),
+            (Some(_), None) => true,
+            (None, _) => false,
+        }
+    }
+
+    fn winner(&self) -> Option<usize> {
+        let winner = self.nodes[0];
+        self.heads
+            .get(winner)
+            .and_then(|head| head.as_ref())
+            .map(|_| winner)
+    }
+
+    /// Replaces the head of the winning run with `next` and returns the previous head.
+    fn replace_winner(&mut self, next: Option<T>) -> Option<T> {
+        let k = self.heads.len();
+        let leaf = self.nodes[0];
+        let prev = mem::replace(&mut self.heads[leaf], next);
+
+        let mut winner = leaf;
+        let mut node = (k + leaf) / 2;
+        while node > 0 {
+            if self.is_less(self.nodes[node], winner) {
+                mem::swap(&mut self.nodes[node], &mut winner);
+            }
+            node /= 2;
+        }
+        self.nodes[0] = winner;
+
+        prev
+    }
+}
+
+fn merge_runs<T: Record>(inputs: &[PathBuf], output: &Path, config: &Config) -> io::Result<()> {
+    // Large enough to amortize the channel handoff, small enough to stay in the cache.
+    const BATCH_LEN: usize = 64 * 1024;
+
+    let mut readers = inputs
+        .iter()
+        .map(|path| {
+            Ok(BufReader::with_capacity(
+                config.io_buffer_bytes,
+                File::open(path)?,
+            ))
+        })
+        .collect::<io::Result<Vec<_>>>()?;
+
+    let heads = readers
+        .iter_mut()
+        .map(|reader| T::read_from(reader))
+        .collect::<io::Result<Vec<_>>>()?;
+    let mut tree = LoserTree::new(heads);
+
+    let mut writer = AsyncWriter::new(output, config.io_buffer_bytes)?;
+    let mut batch = Vec::with_capacity(BATCH_LEN);
+
+    while let Some(winner) = tree.winner() {
+        let next = T::read_from(&mut readers[winner])?;
+        batch.push(tree.replace_winner(next).unwrap());
+
+        if batch.len() == BATCH_LEN {
+            batch = writer.write(batch);
+        }
+    }
+
+    if !batch.is_empty() {
+        writer.write(batch);
+    }
+
+    writer.finish().map(|_| ())
+}
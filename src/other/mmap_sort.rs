@@ -0,0 +1,403 @@
+//! In-place sort of files of fixed-width binary records, through a shared memory mapping of the
+//! file. Sorting the mapping skips reading the file into a buffer and writing it back, and the
+//! memory for that buffer.
+//!
+//! Records narrower than `Config::indirect_min_bytes` are sorted directly with ipnsort, which
+//! compares their keys inline. Wider records are sorted indirectly. Each key is packed with its
+//! record index into a u64, or a u128 if both don't fit, and those are sorted with the in-memory
+//! sort `S`. The records are then moved to their final position by following the cycles of the
+//! permutation, so each record is copied once. The indirect sort is stable.
+//!
+//! The key is an integer field described by a `KeyDescriptor`, stored little-endian in the file.
+//! The mapping is advised for the access pattern of every phase: sequential while keys are
+//! extracted, random while records are moved.
+
+use std::fs::{self, File, OpenOptions};
+use std::io;
+use std::os::unix::io::AsRawFd;
+use std::path::Path;
+
+use sort_test_tools::ffi_types::KeyDescriptor;
+use sort_test_tools::Sort;
+
+#[derive(Copy, Clone, Debug)]
+pub struct Config {
+    /// Records of at least this many bytes are sorted indirectly.
+    pub indirect_min_bytes: usize,
+    /// Faults in the whole file when it's mapped (`MAP_POPULATE`), instead of on first access.
+    pub populate: bool,
+    /// Asks for transparent huge pages on the mapping (`MADV_HUGEPAGE`), and for the pages
+    /// already in memory to be collapsed into huge pages (`MADV_COLLAPSE`, Linux 6.1). Only file
+    /// systems with huge page support, like tmpfs mounted with `huge=`, back file mappings with
+    /// huge pages. Elsewhere this is a no-op.
+    pub huge_pages: bool,
+}
+
+impl Default for Config {
+    fn default() -> Self {
+        Self {
+            indirect_min_bytes: 64,
+            populate: false,
+            huge_pages: false,
+        }
+    }
+}
+
+#[derive(Copy, Clone, Debug, Default, PartialEq, Eq)]
+pub struct Stats {
+    pub record_count: usize,
+    /// The records were sorted indirectly, by packed key and index.
+    pub is_indirect: bool,
+}
+
+mod sys {
+    use std::os::raw::{c_int, c_long, c_void};
+
+    extern "C" {
+        fn mmap(
+            addr: *mut c_void,
+            len: usize,
+            prot: c_int,
+            flags: c_int,
+            fd: c_int,
+            offset: c_long,
+        ) -> *mut c_void;
+        fn munmap(addr: *mut c_void, len: usize) -> c_int;
+        fn madvise(addr: *mut c_void, len: usize, advice: c_int) -> c_int;
+    }
+
+    const PROT_READ: c_int = 1;
+    const PROT_WRITE: c_int = 2;
+    const MAP_SHARED: c_int = 1;
+    const MAP_POPULATE: c_int = 0x8000;
+    const MAP_FAILED: *mut c_void = !0 as *mut c_void;
+
+    pub const MADV_RANDOM: c_int = 1;
+    pub const MADV_SEQUENTIAL: c_int = 2;
+    pub const MADV_WILLNEED: c_int = 3;
+    pub const MADV_HUGEPAGE: c_int = 14;
+    pub const MADV_COLLAPSE: c_int = 25;
+
+    /// Shared read-write mapping of the first `len` bytes of the file `fd`, `len` > 0.
+    pub fn map_file(fd: c_int, len: usize, populate: bool) -> std::io::Result<*mut u8> {
+        let flags = if populate {
+            MAP_SHARED | MAP_POPULATE
+        } else {
+            MAP_SHARED
+        };
+
+        // SAFETY: No memory is touched, failure is reported through the return value.
+        let ptr = unsafe {
+            mmap(
+                std::ptr::null_mut(),
+                len,
+                PROT_READ | PROT_WRITE,
+                flags,
+                fd,
+                0,
+            )
+        };
+
+        if ptr == MAP_FAILED {
+            return Err(std::io::Error::last_os_error());
+        }
+
+        Ok(ptr as *mut u8)
+    }
+
+    pub unsafe fn unmap_file(ptr: *mut u8, len: usize) {
+        munmap(ptr as *mut c_void, len);
+    }
+
+    /// Only a hint, failures are ignored.
+    pub unsafe fn advise(ptr: *mut u8, len: usize, advice: c_int) {
+        madvise(ptr as *mut c_void, len, advice);
+    }
+}
+
+struct FileMapping {
+    ptr: *mut u8,
+    len: usize,
+}
+
+impl FileMapping {
+    fn new(file: &File, len: usize, config: &Config) -> io::Result<Self> {
+        let mapping = Self {
+            ptr: sys::map_file(file.as_raw_fd(), len, config.populate)?,
+            len,
+        };
+
+        if config.huge_pages {
+            mapping.advise(sys::MADV_HUGEPAGE);
+            mapping.advise(sys::MADV_COLLAPSE);
+        }
+
+        Ok(mapping)
+    }
+
+    fn advise(&self, advice: std::os::raw::c_int) {
+        // SAFETY: ptr and len are the mapping, advice doesn't change its contents.
+        unsafe { sys::advise(self.ptr, self.len, advice) };
+    }
+
+    fn as_mut_slice(&mut self) -> &mut [u8] {
+        // SAFETY: ptr points to len mapped bytes, only accessed through self.
+        unsafe { std::slice::from_raw_parts_mut(self.ptr, self.len) }
+    }
+}
+
+impl Drop for FileMapping {
+    fn drop(&mut self) {
+        // SAFETY: ptr and len are the ones returned by map_file.
+        unsafe { sys::unmap_file(self.ptr, self.len) };
+    }
+}
+
+/// Access pattern of the upcoming sort phase, see `sort_records_advised`.
+#[derive(Copy, Clone, Debug, PartialEq, Eq)]
+enum Access {
+    Sequential,
+    Random,
+}
+
+/// Sorts the records of the file at `path` in place, through a shared mapping of the file.
+/// `S` sorts the packed keys of wide records and needs to support u64, and u128 unless the
+/// key and the record index fit into 64 bits.
+///
+/// Panics if `key` doesn't describe a key inside of a record.
+pub fn sort_file_in_place<S: Sort>(
+    path: &Path,
+    record_bytes: usize,
+    key: KeyDescriptor,
+    config: &Config,
+) -> io::Result<Stats> {
+    let file = OpenOptions::new().read(true).write(true).open(path)?;
+    let len = file_len(&file, record_bytes)?;
+    if len == 0 {
+        // mmap rejects empty mappings.
+        return Ok(sort_records::<S>(&mut [], record_bytes, key, config));
+    }
+
+    let mut mapping = FileMapping::new(&file, len, config)?;
+    mapping.advise(sys::MADV_WILLNEED);
+
+    let (ptr, mapped_len) = (mapping.ptr, mapping.len);
+    let stats = sort_records_advised::<S>(
+        mapping.as_mut_slice(),
+        record_bytes,
+        key,
+        config,
+        |access| {
+            let advice = match access {
+                Access::Sequential => sys::MADV_SEQUENTIAL,
+                Access::Random => sys::MADV_RANDOM,
+            };
+            // SAFETY: The mapping outlives the sort, advice doesn't change its contents.
+            unsafe { sys::advise(ptr, mapped_len, advice) };
+        },
+    );
+
+    Ok(stats)
+}
+
+/// Same result as `sort_file_in_place`, by reading the whole file into a buffer, sorting that
+/// and writing it back. The baseline of `BENCH_OTHER=mmap`.
+pub fn sort_file_buffered<S: Sort>(
+    path: &Path,
+    record_bytes: usize,
+    key: KeyDescriptor,
+    config: &Config,
+) -> io::Result<Stats> {
+    let mut records = fs::read(path)?;
+    if records.len() % record_bytes != 0 {
+        return Err(record_len_error(record_bytes));
+    }
+
+    let stats = sort_records::<S>(&mut records, record_bytes, key, config);
+    fs::write(path, &records)?;
+
+    Ok(stats)
+}
+
+/// Sorts the records of `record_bytes` each, back to back in `records`, by their key. Chooses
+/// between the direct and the indirect sort like `sort_file_in_place`. Only the indirect sort is
+/// stable.
+///
+/// Panics if `records` is not a whole number of records or `key` doesn't describe a key inside of
+/// a record.
+pub fn sort_records<S: Sort>(
+    records: &mut [u8],
+    record_bytes: usize,
+    key: KeyDescriptor,
+    config: &Config,
+) -> Stats {
+    sort_records_advised::<S>(records, record_bytes, key, config, |_| {})
+}
+
+fn sort_records_advised<S: Sort>(
+    records: &mut [u8],
+    record_bytes: usize,
+    key: KeyDescriptor,
+    config: &Config,
+    mut advise: impl FnMut(Access),
+) -> Stats {
+    assert!(record_bytes > 0 && records.len() % record_bytes == 0);
+    assert!(
+        matches!(key.width, 1 | 2 | 4 | 8)
+            && key.offset + key.width as usize <= record_bytes,
+        "Invalid key descriptor {key:?} for records of {record_bytes} bytes"
+    );
+
+    let record_count = records.len() / record_bytes;
+    let is_indirect = record_bytes >= config.indirect_min_bytes
+        || !sort_direct_dispatch(records, record_bytes, key, &mut advise);
+
+    if is_indirect && record_count > 1 {
+        advise(Access::Sequential);
+        let perm = sorted_indices::<S>(records, record_bytes, key);
+
+        advise(Access::Random);
+        apply_permutation(records, record_bytes, perm);
+    }
+
+    Stats {
+        record_count,
+        is_indirect,
+    }
+}
+
+fn file_len(file: &File, record_bytes: usize) -> io::Result<usize> {
+    let len = file.metadata()?.len() as usize;
+    if len % record_bytes != 0 {
+        return Err(record_len_error(record_bytes));
+    }
+
+    Ok(len)
+}
+
+fn record_len_error(record_bytes: usize) -> io::Error {
+    io::Error::new(
+        io::ErrorKind::InvalidData,
+        format!("File length is not a multiple of the record size {record_bytes}"),
+    )
+}
+
+/// The key of a record, as u64 in the order of the sort.
+#[inline(always)]
+fn key_bits(record: &[u8], key: KeyDescriptor) -> u64 {
+    let width = key.width as usize;
+    let mut bytes = [0u8; 8];
+    bytes[..width].copy_from_slice(&record[key.offset..key.offset + width]);
+
+    let bits = width as u32 * 8;
+    let mut value = u64::from_le_bytes(bytes);
+    if key.is_signed {
+        value ^= 1 << (bits - 1);
+    }
+    if key.is_descending {
+        value ^= u64::MAX >> (64 - bits);
+    }
+
+    value
+}
+
+#[repr(transparent)]
+struct Record<const N: usize>([u8; N]);
+
+fn sort_direct<const N: usize>(records: &mut [u8], key: KeyDescriptor) {
+    // SAFETY: Record<N> is N bytes without alignment requirement, records holds whole records.
+    let records = unsafe {
+        std::slice::from_raw_parts_mut(
+            records.as_mut_ptr() as *mut Record<N>,
+            records.len() / N,
+        )
+    };
+
+    ipnsort::sort_by(records, |a, b| key_bits(&a.0, key).cmp(&key_bits(&b.0, key)));
+}
+
+/// Sorts the records directly if there is an instantiation for their size, returns false
+/// otherwise.
+fn sort_direct_dispatch(
+    records: &mut [u8],
+    record_bytes: usize,
+    key: KeyDescriptor,
+    advise: &mut impl FnMut(Access),
+) -> bool {
+    let sort_fn: fn(&mut [u8], KeyDescriptor) = match record_bytes {
+        8 => sort_direct::<8>,
+        12 => sort_direct::<12>,
+        16 => sort_direct::<16>,
+        24 => sort_direct::<24>,
+        32 => sort_direct::<32>,
+        48 => sort_direct::<48>,
+        64 => sort_direct::<64>,
+        96 => sort_direct::<96>,
+        128 => sort_direct::<128>,
+        _ => return false,
+    };
+
+    advise(Access::Random);
+    sort_fn(records, key);
+    true
+}
+
+/// Indices of the records in sorted order, ties in record order.
+fn sorted_indices<S: Sort>(records: &[u8], record_bytes: usize, key: KeyDescriptor) -> Vec<usize> {
+    let record_count = records.len() / record_bytes;
+    let index_bits = usize::BITS - (record_count - 1).leading_zeros();
+    let key_width_bits = key.width as u32 * 8;
+
+    let keys = records
+        .chunks_exact(record_bytes)
+        .map(|record| key_bits(record, key));
+
+    if key_width_bits + index_bits <= 64 {
+        let mut packed = keys
+            .enumerate()
+            .map(|(index, key)| (key << index_bits) | index as u64)
+            .collect::<Vec<u64>>();
+        S::sort(&mut packed);
+
+        let index_mask = (1u64 << index_bits) - 1;
+        packed
+            .into_iter()
+            .map(|val| (val & index_mask) as usize)
+            .collect()
+    } else {
+        let mut packed = keys
+            .enumerate()
+            .map(|(index, key)| ((key as u128) << 64) | index as u128)
+            .collect::<Vec<u128>>();
+        S::sort(&mut packed);
+
+        packed.into_iter().map(|val| val as u64 as usize).collect()
+    }
+}
+
+/// Moves the record at `perm[i]` to position `i`, one cycle of the permutation after the other.
+fn apply_permutation(records: &mut [u8], record_bytes: usize, mut perm: Vec<usize>) {
+    let mut displaced = vec![0u8; record_bytes];
+
+    for start in 0..perm.len() {
+        if perm[start] == start {
+            continue;
+        }
+
+        displaced.copy_from_slice(&records[start * record_bytes..][..record_bytes]);
+        let mut dst = start;
+        loop {
+            let src = perm[dst];
+            // Done positions map to themselves, which ends their cycle for the outer loop.
+            perm[dst] = dst;
+
+            if src == start {
+                records[dst * record_bytes..][..record_bytes].copy_from_slice(&displaced);
+                break;
+            }
+
+            records.copy_within(src * record_bytes..(src + 1) * record_bytes, dst * record_bytes);
+            dst = src;
+        }
+    }
+}
@@ -16,10 +16,38 @@ pub mod cpp_vqsort;
 #[cfg(feature = "cpp_intel_avx512")]
 pub mod cpp_intel_avx512;
 
+// Call radix sort via FFI.
+#[cfg(feature = "cpp_radix")]
+pub mod cpp_radix;
+
+// Call the parallel string sample sort via FFI, only FFIString is supported.
+#[cfg(feature = "cpp_radix")]
+pub mod cpp_radix_parallel;
+
+// Call the CUB GPU radix sort via FFI.
+#[cfg(feature = "cpp_gpu_sort")]
+pub mod cpp_gpu_sort;
+
 // Call singelisort sort via FFI.
 #[cfg(feature = "singeli_singelisort")]
 pub mod singeli_singelisort;
 
+// Call singelisort via FFI, with pooled scratch memory.
+#[cfg(feature = "singeli_singelisort")]
+pub mod singeli_singelisort_scratch;
+
+// Call singelisort via FFI, with a per-thread scratch arena.
+#[cfg(feature = "singeli_singelisort")]
+pub mod singeli_singelisort_tls;
+
+// Call the generated fixed length sorting networks via FFI.
+#[cfg(feature = "cpp_network_sort")]
+pub mod cpp_network_sort;
+
+// Vectorized is_sorted and presortedness metrics via FFI.
+#[cfg(feature = "cpp_sortedness")]
+pub mod cpp_sortedness;
+
 #[cfg(feature = "evolution")]
 pub mod sort_evolution;
 
@@ -34,3 +62,15 @@ pub mod partition;
 
 #[cfg(feature = "selection")]
 pub mod selection;
+
+#[cfg(feature = "external_sort")]
+pub mod external_sort;
+
+#[cfg(all(feature = "mmap_sort", target_os = "linux"))]
+pub mod mmap_sort;
+
+#[cfg(feature = "auto_tune")]
+pub mod auto_tune;
+
+#[cfg(feature = "parallel_cutover")]
+pub mod parallel_cutover;
@@ -0,0 +1,394 @@
+//! Per host choice between the sequential and the parallel path of the parallel sorts, and of
+//! their thread count, calibrated with short benchmarks.
+//!
+//! The built-in cutovers don't fit every machine: ips4o only goes parallel once every thread gets
+//! `kMinParallelBlocksPerThread` blocks, so on many cores mid-size inputs stay sequential, while
+//! powersort and ipnsort spawn every thread as soon as the input can be split, which wastes the
+//! wakeups on small inputs. `calibrate` times cpp_ips4o_parallel, cpp_powersort_parallel and
+//! rust_ipnsort_parallel, as far as enabled, with 1, 2, 4, ... up to `ffi_util::num_threads()`
+//! threads on random i32 and u64 inputs of every power of ten length bucket. The fewest threads
+//! within `Config::tolerance` of the fastest win the bucket, 1 thread is the sequential path.
+//!
+//! With the `parallel_cutover` feature these sorts get their thread count from `threads_for`, by
+//! sort, element size and length. Other element sizes use the entries of the closest calibrated
+//! size below, at the length with the same number of bytes. Inputs shorter than the first
+//! calibrated bucket are sorted sequentially, `ffi_util::num_threads()` stays the upper limit.
+//!
+//! Tables are stored next to the ones of `auto_tune`, see `auto_tune::cache_path`, and loaded or
+//! calibrated the first time one of the sorts runs.
+
+use std::cell::Cell;
+use std::env;
+use std::fs;
+use std::hint::black_box;
+use std::io::{self, BufRead, BufReader, Write};
+use std::path::{Path, PathBuf};
+use std::time::{Duration, Instant};
+
+use once_cell::sync::OnceCell;
+
+use sort_test_tools::patterns;
+use sort_test_tools::Sort;
+
+use crate::ffi_util;
+use crate::other::auto_tune::{self, bucket, Tunable};
+#[allow(unused_imports)]
+use crate::{stable, unstable};
+
+/// The compiled-in parallel sorts the table has entries for, by their `Sort::name`.
+pub fn candidates<T: Tunable>() -> Vec<(String, fn(&mut [T]))> {
+    #[allow(unused_mut)]
+    let mut candidates: Vec<(String, fn(&mut [T]))> = Vec::new();
+
+    #[allow(unused_macros)]
+    macro_rules! add_sort {
+        ($sort_impl_path:path) => {{
+            use $sort_impl_path::*;
+
+            candidates.push((<SortImpl as Sort>::name(), <SortImpl as Sort>::sort::<T>));
+        }};
+    }
+
+    #[cfg(feature = "cpp_ips4o_parallel")]
+    add_sort!(unstable::cpp_ips4o_parallel);
+
+    #[cfg(feature = "cpp_powersort_parallel")]
+    add_sort!(stable::cpp_powersort_parallel);
+
+    #[cfg(feature = "rust_ipnsort_parallel")]
+    add_sort!(unstable::rust_ipnsort_parallel);
+
+    candidates
+}
+
+// Buckets below have too little work for a second thread on any machine, and timing them with
+// every thread count would only make the calibration slower.
+const MIN_BUCKET: usize = 2;
+
+#[derive(Copy, Clone, Debug)]
+pub struct Config {
+    /// Largest length that is calibrated. Longer inputs use the choice of its bucket.
+    pub max_len: usize,
+    /// Every sort and thread count is timed this many times, the fastest run counts.
+    pub runs: usize,
+    /// Short inputs are sorted in batches of copies with at least this many elements in total, to
+    /// get above the resolution of the clock.
+    pub batch_elements: usize,
+    /// More threads have to be at least this much faster, relative to the fastest, to be picked.
+    pub tolerance: f64,
+}
+
+impl Default for Config {
+    fn default() -> Self {
+        Self {
+            max_len: 1_000_000,
+            runs: 3,
+            batch_elements: 4_096,
+            tolerance: 0.05,
+        }
+    }
+}
+
+impl Config {
+    /// The default config, with `max_len` overridden by `SORT_PARALLEL_CUTOVER_MAX_LEN`.
+    pub fn from_env() -> Self {
+        let mut config = Self::default();
+        if let Ok(val) = env::var("SORT_PARALLEL_CUTOVER_MAX_LEN") {
+            config.max_len = val
+                .parse()
+                .expect("SORT_PARALLEL_CUTOVER_MAX_LEN must be a number");
+        }
+
+        config
+    }
+}
+
+#[derive(Clone, Debug, PartialEq, Eq)]
+pub struct Entry {
+    pub sort_name: String,
+    pub elem_size: usize,
+    pub bucket: usize,
+    pub threads: usize,
+}
+
+/// The thread count of every calibrated sort, element size and length bucket on one CPU model.
+#[derive(Clone, Debug, PartialEq, Eq)]
+pub struct Table {
+    pub cpu: String,
+    /// The most threads that were timed.
+    pub max_threads: usize,
+    pub entries: Vec<Entry>,
+}
+
+const TABLE_HEADER: &str =
+    "# sort-research-rs parallel_cutover table, see other::parallel_cutover.";
+
+impl Table {
+    /// The threads for `len` elements of `elem_size` bytes, `None` if `sort_name` has no entries.
+    pub fn threads(&self, sort_name: &str, elem_size: usize, len: usize) -> Option<usize> {
+        let sizes = || {
+            self.entries
+                .iter()
+                .filter(move |entry| entry.sort_name == sort_name)
+                .map(|entry| entry.elem_size)
+        };
+        let calibrated_size = sizes()
+            .filter(|&size| size <= elem_size)
+            .max()
+            .or_else(|| sizes().min())?;
+
+        // The length with the same number of bytes in elements of the calibrated size.
+        let scaled_len = len.saturating_mul(elem_size) / calibrated_size.max(1);
+
+        let threads = self
+            .entries
+            .iter()
+            .filter(|entry| {
+                entry.sort_name == sort_name
+                    && entry.elem_size == calibrated_size
+                    && entry.bucket <= bucket(scaled_len)
+            })
+            .max_by_key(|entry| entry.bucket)
+            .map_or(1, |entry| entry.threads);
+
+        Some(threads)
+    }
+
+    pub fn save(&self, path: &Path) -> io::Result<()> {
+        if let Some(dir) = path.parent() {
+            fs::create_dir_all(dir)?;
+        }
+
+        // Written to a temporary file first, so that concurrent processes never read a partial
+        // table.
+        let tmp_path = path.with_extension(format!("tmp{}", std::process::id()));
+        let mut file = fs::File::create(&tmp_path)?;
+        writeln!(file, "{TABLE_HEADER}")?;
+        writeln!(file, "cpu {}", self.cpu)?;
+        writeln!(file, "max_threads {}", self.max_threads)?;
+        for entry in &self.entries {
+            writeln!(
+                file,
+                "{} {} {} {}",
+                entry.sort_name, entry.elem_size, entry.bucket, entry.threads
+            )?;
+        }
+        file.sync_all()?;
+        drop(file);
+
+        fs::rename(&tmp_path, path)
+    }
+
+    pub fn load(path: &Path) -> io::Result<Self> {
+        let invalid = |line: &str| {
+            io::Error::new(
+                io::ErrorKind::InvalidData,
+                format!("invalid parallel_cutover table line: '{line}'"),
+            )
+        };
+
+        let mut table = Table {
+            cpu: String::new(),
+            max_threads: 0,
+            entries: Vec::new(),
+        };
+
+        for line in BufReader::new(fs::File::open(path)?).lines() {
+            let line = line?;
+            if line.is_empty() || line.starts_with('#') {
+                continue;
+            }
+
+            if let Some(cpu) = line.strip_prefix("cpu ") {
+                table.cpu = cpu.to_string();
+                continue;
+            }
+
+            if let Some(max_threads) = line.strip_prefix("max_threads ") {
+                table.max_threads = max_threads.parse().map_err(|_| invalid(&line))?;
+                continue;
+            }
+
+            let fields: Vec<&str> = line.split_whitespace().collect();
+            let [sort_name, elem_size, bucket, threads] = fields[..] else {
+                return Err(invalid(&line));
+            };
+            table.entries.push(Entry {
+                sort_name: sort_name.to_string(),
+                elem_size: elem_size.parse().map_err(|_| invalid(&line))?,
+                bucket: bucket.parse().map_err(|_| invalid(&line))?,
+                threads: threads.parse().map_err(|_| invalid(&line))?,
+            });
+        }
+
+        Ok(table)
+    }
+}
+
+/// Where the table of `cpu` is stored, see `auto_tune::cache_path`.
+pub fn table_path(cpu: &str) -> PathBuf {
+    auto_tune::cache_path("parallel_cutover", cpu)
+}
+
+thread_local! {
+    static FIXED_THREADS: Cell<Option<usize>> = const { Cell::new(None) };
+}
+
+/// Runs `f` with the calibrated sorts using exactly `num_threads` threads on this thread, e.g.
+/// `ffi_util::num_threads()` to compare against the choice of the table.
+pub fn with_threads<R>(num_threads: usize, f: impl FnOnce() -> R) -> R {
+    struct Restore(Option<usize>);
+
+    impl Drop for Restore {
+        fn drop(&mut self) {
+            FIXED_THREADS.with(|fixed| fixed.set(self.0));
+        }
+    }
+
+    let _restore = Restore(FIXED_THREADS.with(|fixed| fixed.replace(Some(num_threads.max(1)))));
+    f()
+}
+
+/// 1, 2, 4, ... and the maximum itself if it's not a power of two.
+fn thread_counts(max_threads: usize) -> Vec<usize> {
+    let mut counts = std::iter::successors(Some(1usize), |n| n.checked_mul(2))
+        .take_while(|&n| n < max_threads)
+        .collect::<Vec<_>>();
+    counts.push(max_threads.max(1));
+    counts
+}
+
+// Fastest of `config.runs` runs of sorting copies of `input` with `num_threads`, per copy.
+fn time_sort<T: Tunable>(
+    config: &Config,
+    sort: fn(&mut [T]),
+    input: &[T],
+    num_threads: usize,
+) -> Duration {
+    let len = input.len();
+    let copies = (config.batch_elements / len).max(1);
+    let batch: Vec<T> = input.iter().copied().cycle().take(len * copies).collect();
+    let mut data = batch.clone();
+
+    with_threads(num_threads, || {
+        (0..config.runs.max(1))
+            .map(|_| {
+                data.copy_from_slice(&batch);
+
+                let start = Instant::now();
+                for chunk in data.chunks_exact_mut(len) {
+                    sort(black_box(chunk));
+                }
+                black_box(&data);
+                start.elapsed() / copies as u32
+            })
+            .min()
+            .unwrap()
+    })
+}
+
+fn calibrate_type<T: Tunable>(config: &Config, max_threads: usize, entries: &mut Vec<Entry>) {
+    let thread_counts = thread_counts(max_threads);
+
+    for (sort_name, sort) in candidates::<T>() {
+        for bucket in MIN_BUCKET..=bucket(config.max_len.max(1)) {
+            // Somewhere in the middle of the bucket on a log scale.
+            let len = (3 * 10usize.pow(bucket as u32)).min(config.max_len.max(1));
+            let input: Vec<T> = patterns::random(len)
+                .into_iter()
+                .map(T::from_pattern)
+                .collect();
+
+            let times: Vec<f64> = thread_counts
+                .iter()
+                .map(|&num_threads| time_sort(config, sort, &input, num_threads).as_secs_f64())
+                .collect();
+
+            let fastest = times.iter().copied().fold(f64::INFINITY, f64::min);
+            let threads = thread_counts
+                .iter()
+                .zip(&times)
+                .find(|(_, &time)| time <= fastest * (1.0 + config.tolerance))
+                .map_or(max_threads, |(&num_threads, _)| num_threads);
+
+            entries.push(Entry {
+                sort_name: sort_name.clone(),
+                elem_size: std::mem::size_of::<T>(),
+                bucket,
+                threads,
+            });
+        }
+    }
+}
+
+/// Times the candidates with every thread count up to `ffi_util::num_threads()`, for every type
+/// and length bucket up to `config.max_len` on this machine.
+pub fn calibrate(config: &Config) -> Table {
+    let max_threads = ffi_util::num_threads();
+
+    let mut entries = Vec::new();
+    calibrate_type::<i32>(config, max_threads, &mut entries);
+    calibrate_type::<u64>(config, max_threads, &mut entries);
+
+    Table {
+        cpu: auto_tune::cpu_model(),
+        max_threads,
+        entries,
+    }
+}
+
+static TABLE: OnceCell<Table> = OnceCell::new();
+
+/// Installs `table` as the table `threads_for` uses. Fails if it already picked one.
+pub fn set_table(table: Table) -> Result<(), Table> {
+    TABLE.set(table)
+}
+
+/// The table `threads_for` uses. Unless one was installed with `set_table`, the table of this CPU
+/// model is loaded from `table_path`. If there is none, or it was calibrated with fewer threads
+/// than are available now, the machine is calibrated with `Config::from_env` and the result stored
+/// for the next process.
+pub fn table() -> &'static Table {
+    TABLE.get_or_init(|| {
+        let cpu = auto_tune::cpu_model();
+        let path = table_path(&cpu);
+
+        match Table::load(&path) {
+            Ok(table) if table.cpu == cpu && table.max_threads >= ffi_util::num_threads() => table,
+            _ => {
+                let table = calibrate(&Config::from_env());
+                if let Err(err) = table.save(&path) {
+                    eprintln!(
+                        "Failed to store parallel_cutover table {}: {err}",
+                        path.display()
+                    );
+                }
+                table
+            }
+        }
+    })
+}
+
+/// The threads `sort_name` uses for `len` elements of `T`, at most `max_threads`. Sorts without
+/// entries use `max_threads`, inside of `with_threads` every sort uses the given count.
+pub fn threads_for<T>(sort_name: &str, len: usize, max_threads: usize) -> usize {
+    if let Some(num_threads) = FIXED_THREADS.with(Cell::get) {
+        return num_threads;
+    }
+
+    // Only the candidates load the table, the other parallel sorts never need it.
+    static NAMES: OnceCell<Vec<String>> = OnceCell::new();
+    let names = NAMES.get_or_init(|| {
+        candidates::<i32>()
+            .into_iter()
+            .map(|(name, _)| name)
+            .collect()
+    });
+    if !names.iter().any(|name| name == sort_name) {
+        return max_threads;
+    }
+
+    table()
+        .threads(sort_name, std::mem::size_of::<T>(), len)
+        .map_or(max_threads, |threads| threads.min(max_threads))
+}
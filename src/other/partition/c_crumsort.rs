@@ -0,0 +1,5 @@
+//! The fulcrum partition of crumsort via FFI, fulcrum_default_partition in crumsort.c.
+//!
+//! Only i32 and u64 are supported.
+
+ffi_partition_impl!("c_crumsort", crumsort);
@@ -0,0 +1,9 @@
+//! The unrolled block partition of BlockQuicksort via FFI, hoare_block_partition_unroll_loop in
+//! partition.h.
+//!
+//! It's a Hoare partition, unlike the other ones elements equal to the pivot can end up on either
+//! side.
+//!
+//! Only i32 and u64 are supported.
+
+ffi_partition_impl!("cpp_blockquicksort", blockquicksort);
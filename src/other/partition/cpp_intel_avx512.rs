@@ -0,0 +1,7 @@
+//! The AVX-512 partition of x86-simd-sort via FFI, partition_avx512 in avx512-common-qsort.h.
+//!
+//! Falls back to std::partition if the CPU doesn't support AVX-512.
+//!
+//! Only i32 and u64 are supported.
+
+ffi_partition_impl!("cpp_intel_avx512", intel_avx512);
@@ -0,0 +1,139 @@
+//! C++ port of lomuto_branchless_cyclic_opt via FFI, see src/cpp/lomcyc_partition.h.
+//!
+//! Only i32, u64, FFIString, F128 and FFIOneKibiByte are supported.
+
+use std::cmp::Ordering;
+
+use sort_test_tools::ffi_types::{CompResult, FFIOneKibiByte, FFIString, F128};
+
+pub struct PartitionImpl;
+
+impl crate::other::partition::Partition for PartitionImpl {
+    fn name() -> String {
+        "cpp_lomcyc".into()
+    }
+
+    fn is_supported<T>() -> bool {
+        <T as CppPartition>::is_supported()
+    }
+
+    #[inline]
+    fn partition<T: Ord>(arr: &mut [T], pivot: &T) -> usize {
+        CppPartition::partition(arr, pivot)
+    }
+
+    #[inline]
+    fn partition_by<T, F: FnMut(&T, &T) -> bool>(
+        arr: &mut [T],
+        pivot: &T,
+        is_less: &mut F,
+    ) -> usize {
+        // The C++ side only looks at less-than.
+        CppPartition::partition_by(arr, pivot, |a: &T, b: &T| {
+            if is_less(a, b) {
+                Ordering::Less
+            } else {
+                Ordering::Greater
+            }
+        })
+    }
+}
+
+trait CppPartition: Sized {
+    fn is_supported() -> bool;
+    fn partition(arr: &mut [Self], pivot: &Self) -> usize;
+    fn partition_by<F: FnMut(&Self, &Self) -> Ordering>(
+        arr: &mut [Self],
+        pivot: &Self,
+        compare: F,
+    ) -> usize;
+}
+
+impl<T> CppPartition for T {
+    default fn is_supported() -> bool {
+        false
+    }
+
+    default fn partition(_arr: &mut [T], _pivot: &T) -> usize {
+        panic!("Type not supported");
+    }
+
+    default fn partition_by<F: FnMut(&T, &T) -> Ordering>(
+        _arr: &mut [T],
+        _pivot: &T,
+        _compare: F,
+    ) -> usize {
+        panic!("Type not supported");
+    }
+}
+
+macro_rules! cpp_partition_impl {
+    ($($type:ident => $fn_name:ident),+) => {
+        paste::paste! {
+            extern "C" {
+                $(
+                    fn $fn_name(
+                        data: *mut $type,
+                        len: usize,
+                        pivot: *const $type,
+                    ) -> usize;
+                    fn [<$fn_name _by>](
+                        data: *mut $type,
+                        len: usize,
+                        pivot: *const $type,
+                        cmp_fn: unsafe extern "C" fn(&$type, &$type, *mut u8) -> CompResult,
+                        cmp_fn_ctx: *mut u8,
+                        lt_count: *mut usize,
+                    ) -> u32;
+                )+
+            }
+
+            $(
+                impl CppPartition for $type {
+                    fn is_supported() -> bool {
+                        true
+                    }
+
+                    fn partition(arr: &mut [Self], pivot: &Self) -> usize {
+                        unsafe { $fn_name(arr.as_mut_ptr(), arr.len(), pivot) }
+                    }
+
+                    fn partition_by<F: FnMut(&Self, &Self) -> Ordering>(
+                        arr: &mut [Self],
+                        pivot: &Self,
+                        mut compare: F,
+                    ) -> usize {
+                        let mut lt_count = 0;
+
+                        // SAFETY: compare outlives the call, and the C++ side only calls it with
+                        // elements of arr and pivot.
+                        let ret_code = unsafe {
+                            [<$fn_name _by>](
+                                arr.as_mut_ptr(),
+                                arr.len(),
+                                pivot,
+                                crate::ffi_util::rust_fn_cmp::<Self, F>,
+                                &mut compare as *mut F as *mut u8,
+                                &mut lt_count,
+                            )
+                        };
+
+                        if ret_code != 0 {
+                            panic!("Panic in comparison function");
+                        }
+
+                        lt_count
+                    }
+                }
+            )+
+        } // paste
+    };
+}
+
+cpp_partition_impl!(
+    i32 => lomcyc_partition_i32,
+    u64 => lomcyc_partition_u64,
+    FFIString => lomcyc_partition_ffi_string,
+    F128 => lomcyc_partition_f128,
+    FFIOneKibiByte => lomcyc_partition_1k
+);
@@ -0,0 +1,5 @@
+//! The branchless block partition of pdqsort via FFI, partition_right_branchless in pdqsort.h.
+//!
+//! Only i32 and u64 are supported.
+
+ffi_partition_impl!("cpp_pdqsort", pdqsort);
@@ -0,0 +1,5 @@
+//! The vectorized partition of vqsort via FFI, Partition in vqsort-inl.h.
+//!
+//! Only i32 and u64 are supported.
+
+ffi_partition_impl!("cpp_vqsort", vqsort);
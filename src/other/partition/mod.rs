@@ -7,6 +7,11 @@ use std::ptr::NonNull;
 pub trait Partition {
     fn name() -> String;
 
+    /// Implementations called via FFI only support some types.
+    fn is_supported<T>() -> bool {
+        true
+    }
+
     fn partition<T: Ord>(arr: &mut [T], pivot: &T) -> usize;
 
     fn partition_by<T, F: FnMut(&T, &T) -> bool>(
@@ -44,6 +49,83 @@ macro_rules! partition_impl {
     };
 }
 
+/// Partition of a C++ sort via FFI, the `<prefix>_partition_{i32,u64}` entry points. The
+/// partitions of the SIMD sorts can't call a comparison function, so only the natural order of i32
+/// and u64 is supported.
+#[allow(unused_macros)]
+macro_rules! ffi_partition_impl {
+    ($name:expr, $prefix:ident) => {
+        pub struct PartitionImpl;
+
+        impl crate::other::partition::Partition for PartitionImpl {
+            fn name() -> String {
+                $name.into()
+            }
+
+            fn is_supported<T>() -> bool {
+                <T as FfiPartition>::is_supported()
+            }
+
+            #[inline]
+            fn partition<T: Ord>(arr: &mut [T], pivot: &T) -> usize {
+                FfiPartition::partition(arr, pivot)
+            }
+
+            fn partition_by<T, F: FnMut(&T, &T) -> bool>(
+                _arr: &mut [T],
+                _pivot: &T,
+                _is_less: &mut F,
+            ) -> usize {
+                panic!("Comparison function not supported");
+            }
+        }
+
+        trait FfiPartition: Sized {
+            fn is_supported() -> bool;
+            fn partition(arr: &mut [Self], pivot: &Self) -> usize;
+        }
+
+        impl<T> FfiPartition for T {
+            default fn is_supported() -> bool {
+                false
+            }
+
+            default fn partition(_arr: &mut [T], _pivot: &T) -> usize {
+                panic!("Type not supported");
+            }
+        }
+
+        paste::paste! {
+            extern "C" {
+                fn [<$prefix _partition_i32>](data: *mut i32, len: usize, pivot: *const i32)
+                    -> usize;
+                fn [<$prefix _partition_u64>](data: *mut u64, len: usize, pivot: *const u64)
+                    -> usize;
+            }
+
+            impl FfiPartition for i32 {
+                fn is_supported() -> bool {
+                    true
+                }
+
+                fn partition(arr: &mut [Self], pivot: &Self) -> usize {
+                    unsafe { [<$prefix _partition_i32>](arr.as_mut_ptr(), arr.len(), pivot) }
+                }
+            }
+
+            impl FfiPartition for u64 {
+                fn is_supported() -> bool {
+                    true
+                }
+
+                fn partition(arr: &mut [Self], pivot: &Self) -> usize {
+                    unsafe { [<$prefix _partition_u64>](arr.as_mut_ptr(), arr.len(), pivot) }
+                }
+            }
+        } // paste
+    };
+}
+
 /// Returns a guaranteed non-null pointer to an allocation suitable for `layout`.
 ///
 /// As long as this function is called consecutively with the same `layout`, it will re-use the same
@@ -92,6 +174,18 @@ pub fn get_or_alloc_tls_scratch(layout: alloc::Layout) -> NonNull<u8> {
     })
 }
 
+#[cfg(feature = "c_crumsort")]
+pub mod c_crumsort;
+#[cfg(feature = "cpp_blockquicksort")]
+pub mod cpp_blockquicksort;
+#[cfg(feature = "cpp_intel_avx512")]
+pub mod cpp_intel_avx512;
+#[cfg(feature = "cpp_pdqsort")]
+pub mod cpp_lomcyc;
+#[cfg(feature = "cpp_pdqsort")]
+pub mod cpp_pdqsort;
+#[cfg(feature = "cpp_vqsort")]
+pub mod cpp_vqsort;
 pub mod hoare_block;
 pub mod hoare_block_butterfly;
 pub mod hoare_branchy;
@@ -0,0 +1,104 @@
+//! Searches an Eytzinger layout, the sorted elements stored in the order of a breadth first
+//! traversal of the implicit binary search tree. The children of node i are 2i + 1 and 2i + 2, so
+//! the first levels of the tree share a handful of cache lines, and the 16 descendants four levels
+//! below a node are adjacent. Prefetching them four steps ahead hides most of the latency of the
+//! later levels. Like in `interleaved`, `BATCH_LANES` searches are advanced in lockstep.
+//!
+//! The results are positions in the layout, not in the sorted slice.
+
+use super::{prefetch, BatchPartitionPoint, BATCH_LANES};
+
+pub struct PartitionPointImpl;
+
+impl BatchPartitionPoint for PartitionPointImpl {
+    fn name() -> String {
+        "eytzinger".into()
+    }
+
+    fn build_index<T: Clone>(arr: &[T]) -> Vec<T> {
+        build_layout(arr)
+    }
+
+    #[inline]
+    fn partition_point_batch<T: Ord>(index: &[T], vals: &[T], out: &mut [usize]) {
+        partition_point_batch(index, vals, out);
+    }
+}
+
+/// Returns the Eytzinger layout of the sorted `arr`.
+pub fn build_layout<T: Clone>(arr: &[T]) -> Vec<T> {
+    // An in-order traversal of the tree visits the nodes in sorted order.
+    fn assign_ranks(ranks: &mut [usize], node: usize, next_rank: &mut usize) {
+        if node < ranks.len() {
+            assign_ranks(ranks, 2 * node + 1, next_rank);
+            ranks[node] = *next_rank;
+            *next_rank += 1;
+            assign_ranks(ranks, 2 * node + 2, next_rank);
+        }
+    }
+
+    let mut ranks = vec![0; arr.len()];
+    assign_ranks(&mut ranks, 0, &mut 0);
+
+    ranks.iter().map(|&rank| arr[rank].clone()).collect()
+}
+
+pub fn partition_point_batch<T: Ord>(layout: &[T], vals: &[T], out: &mut [usize]) {
+    assert_eq!(vals.len(), out.len());
+
+    if layout.is_empty() {
+        out.fill(0);
+        return;
+    }
+
+    let mut val_chunks = vals.chunks_exact(BATCH_LANES);
+    let mut out_chunks = out.chunks_exact_mut(BATCH_LANES);
+
+    for (vals, out) in (&mut val_chunks).zip(&mut out_chunks) {
+        search_lanes(layout, vals, out);
+    }
+
+    search_lanes(layout, val_chunks.remainder(), out_chunks.into_remainder());
+}
+
+#[inline(always)]
+fn search_lanes<T: Ord>(layout: &[T], vals: &[T], out: &mut [usize]) {
+    debug_assert!(!layout.is_empty() && vals.len() <= BATCH_LANES && vals.len() == out.len());
+
+    let len = layout.len();
+    let layout_ptr = layout.as_ptr();
+
+    let mut node_storage = [0usize; BATCH_LANES];
+    let node = &mut node_storage[..vals.len()];
+
+    // The first full_levels levels of the tree are complete, so every lane can descend through
+    // them without checking for the end of the layout.
+    let full_levels = (len + 1).ilog2();
+
+    for _ in 0..full_levels {
+        for (n, val) in node.iter_mut().zip(vals) {
+            // The first of the 16 descendants four levels down.
+            prefetch(layout_ptr.wrapping_add(16 * *n + 15));
+
+            // SAFETY: n is on one of the complete levels.
+            let is_less = unsafe { layout.get_unchecked(*n) < val };
+            *n = 2 * *n + 1 + is_less as usize;
+        }
+    }
+
+    for ((out, n), val) in out.iter_mut().zip(node.iter()).zip(vals) {
+        let mut n = *n;
+
+        // The last level may be partially filled.
+        if n < len {
+            n = 2 * n + 1 + (layout[n] < *val) as usize;
+        }
+
+        // n + 1 encodes the path from the root, a 0 bit for every step to the left. The result is
+        // the node of the last step to the left, undo that step and the steps to the right after
+        // it. If there was none, all elements are less than val.
+        let path = n + 1;
+        let result = path >> (path.trailing_ones() + 1);
+        *out = if result == 0 { len } else { result - 1 };
+    }
+}
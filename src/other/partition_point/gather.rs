@@ -0,0 +1,260 @@
+//! Runs one branchless binary search per SIMD lane, loading the elements with gather instructions.
+//! Uses AVX-512 if available, otherwise AVX2, for i32, u32, i64 and u64. Everything else, and CPUs
+//! without AVX2, use `interleaved`.
+
+use super::{interleaved, BatchPartitionPoint};
+
+pub struct PartitionPointImpl;
+
+impl BatchPartitionPoint for PartitionPointImpl {
+    fn name() -> String {
+        "gather".into()
+    }
+
+    #[inline]
+    fn partition_point_batch<T: Ord>(index: &[T], vals: &[T], out: &mut [usize]) {
+        GatherPartitionPoint::partition_point_batch(index, vals, out);
+    }
+}
+
+trait GatherPartitionPoint: Sized {
+    fn partition_point_batch(arr: &[Self], vals: &[Self], out: &mut [usize]);
+}
+
+impl<T: Ord> GatherPartitionPoint for T {
+    default fn partition_point_batch(arr: &[T], vals: &[T], out: &mut [usize]) {
+        interleaved::partition_point_batch(arr, vals, out);
+    }
+}
+
+macro_rules! gather_partition_point_impl {
+    ($type:ty, $lane_type:ty, $flip:expr, $avx512_fn:ident, $avx2_fn:ident) => {
+        impl GatherPartitionPoint for $type {
+            fn partition_point_batch(arr: &[Self], vals: &[Self], out: &mut [usize]) {
+                assert_eq!(vals.len(), out.len());
+
+                #[allow(unused_mut)]
+                let mut done = 0;
+
+                // The lanes hold the positions, so they have to fit.
+                #[cfg(target_arch = "x86_64")]
+                if !arr.is_empty() && arr.len() <= <$lane_type>::MAX as usize {
+                    let arr_ptr = arr.as_ptr() as *const $lane_type;
+                    // SAFETY: $type and $lane_type have the same layout.
+                    let vals_as_lanes = unsafe {
+                        core::slice::from_raw_parts(vals.as_ptr() as *const $lane_type, vals.len())
+                    };
+
+                    // SAFETY: The target features were checked, and arr fits the lanes.
+                    if std::is_x86_feature_detected!("avx512f") {
+                        done = unsafe {
+                            x86::$avx512_fn(arr_ptr, arr.len(), vals_as_lanes, out, $flip)
+                        };
+                    } else if std::is_x86_feature_detected!("avx2") {
+                        done =
+                            unsafe { x86::$avx2_fn(arr_ptr, arr.len(), vals_as_lanes, out, $flip) };
+                    }
+                }
+
+                interleaved::partition_point_batch(arr, &vals[done..], &mut out[done..]);
+            }
+        }
+    };
+}
+
+// The unsigned types are compared as signed after flipping their sign bit.
+gather_partition_point_impl!(i32, i32, 0, avx512_32, avx2_32);
+gather_partition_point_impl!(u32, i32, i32::MIN, avx512_32, avx2_32);
+gather_partition_point_impl!(i64, i64, 0, avx512_64, avx2_64);
+gather_partition_point_impl!(u64, i64, i64::MIN, avx512_64, avx2_64);
+
+/// The kernels search for the full vectors of `vals` and return how many values they handled.
+/// `arr` must not be empty and its positions must fit into the lanes. Elements and values are
+/// XORed with `flip` before comparing them as signed integers.
+#[cfg(target_arch = "x86_64")]
+mod x86 {
+    use core::arch::x86_64::*;
+
+    #[target_feature(enable = "avx2")]
+    pub unsafe fn avx2_32(
+        arr: *const i32,
+        len: usize,
+        vals: &[i32],
+        out: &mut [usize],
+        flip: i32,
+    ) -> usize {
+        const LANES: usize = 8;
+
+        let flip = _mm256_set1_epi32(flip);
+        let mut done = 0;
+
+        while done + LANES <= vals.len() {
+            let keys = _mm256_xor_si256(
+                _mm256_loadu_si256(vals.as_ptr().add(done) as *const __m256i),
+                flip,
+            );
+            let load = |pos: __m256i| _mm256_xor_si256(_mm256_i32gather_epi32::<4>(arr, pos), flip);
+
+            let mut base = _mm256_setzero_si256();
+            let mut n = len;
+
+            while n > 1 {
+                let half = n / 2;
+                let mid = _mm256_add_epi32(base, _mm256_set1_epi32(half as i32));
+                let is_less = _mm256_cmpgt_epi32(keys, load(mid));
+                base = _mm256_blendv_epi8(base, mid, is_less);
+                n -= half;
+            }
+
+            // is_less is -1 in the lanes that have to step past base.
+            base = _mm256_sub_epi32(base, _mm256_cmpgt_epi32(keys, load(base)));
+
+            let mut result = [0u32; LANES];
+            _mm256_storeu_si256(result.as_mut_ptr() as *mut __m256i, base);
+            for (out, pos) in out[done..(done + LANES)].iter_mut().zip(result) {
+                *out = pos as usize;
+            }
+
+            done += LANES;
+        }
+
+        done
+    }
+
+    #[target_feature(enable = "avx2")]
+    pub unsafe fn avx2_64(
+        arr: *const i64,
+        len: usize,
+        vals: &[i64],
+        out: &mut [usize],
+        flip: i64,
+    ) -> usize {
+        const LANES: usize = 4;
+
+        let flip = _mm256_set1_epi64x(flip);
+        let mut done = 0;
+
+        while done + LANES <= vals.len() {
+            let keys = _mm256_xor_si256(
+                _mm256_loadu_si256(vals.as_ptr().add(done) as *const __m256i),
+                flip,
+            );
+            let load = |pos: __m256i| _mm256_xor_si256(_mm256_i64gather_epi64::<8>(arr, pos), flip);
+
+            let mut base = _mm256_setzero_si256();
+            let mut n = len;
+
+            while n > 1 {
+                let half = n / 2;
+                let mid = _mm256_add_epi64(base, _mm256_set1_epi64x(half as i64));
+                let is_less = _mm256_cmpgt_epi64(keys, load(mid));
+                base = _mm256_blendv_epi8(base, mid, is_less);
+                n -= half;
+            }
+
+            base = _mm256_sub_epi64(base, _mm256_cmpgt_epi64(keys, load(base)));
+
+            let mut result = [0u64; LANES];
+            _mm256_storeu_si256(result.as_mut_ptr() as *mut __m256i, base);
+            for (out, pos) in out[done..(done + LANES)].iter_mut().zip(result) {
+                *out = pos as usize;
+            }
+
+            done += LANES;
+        }
+
+        done
+    }
+
+    #[target_feature(enable = "avx512f")]
+    pub unsafe fn avx512_32(
+        arr: *const i32,
+        len: usize,
+        vals: &[i32],
+        out: &mut [usize],
+        flip: i32,
+    ) -> usize {
+        const LANES: usize = 16;
+
+        let flip = _mm512_set1_epi32(flip);
+        let mut done = 0;
+
+        while done + LANES <= vals.len() {
+            let keys = _mm512_xor_si512(
+                _mm512_loadu_si512(vals.as_ptr().add(done) as *const __m512i),
+                flip,
+            );
+            let load = |pos: __m512i| _mm512_xor_si512(_mm512_i32gather_epi32::<4>(pos, arr), flip);
+
+            let mut base = _mm512_setzero_si512();
+            let mut n = len;
+
+            while n > 1 {
+                let half = n / 2;
+                let mid = _mm512_add_epi32(base, _mm512_set1_epi32(half as i32));
+                let is_less = _mm512_cmplt_epi32_mask(load(mid), keys);
+                base = _mm512_mask_mov_epi32(base, is_less, mid);
+                n -= half;
+            }
+
+            let is_less = _mm512_cmplt_epi32_mask(load(base), keys);
+            base = _mm512_mask_add_epi32(base, is_less, base, _mm512_set1_epi32(1));
+
+            let mut result = [0u32; LANES];
+            _mm512_storeu_si512(result.as_mut_ptr() as *mut __m512i, base);
+            for (out, pos) in out[done..(done + LANES)].iter_mut().zip(result) {
+                *out = pos as usize;
+            }
+
+            done += LANES;
+        }
+
+        done
+    }
+
+    #[target_feature(enable = "avx512f")]
+    pub unsafe fn avx512_64(
+        arr: *const i64,
+        len: usize,
+        vals: &[i64],
+        out: &mut [usize],
+        flip: i64,
+    ) -> usize {
+        const LANES: usize = 8;
+
+        let flip = _mm512_set1_epi64(flip);
+        let mut done = 0;
+
+        while done + LANES <= vals.len() {
+            let keys = _mm512_xor_si512(
+                _mm512_loadu_si512(vals.as_ptr().add(done) as *const __m512i),
+                flip,
+            );
+            let load = |pos: __m512i| _mm512_xor_si512(_mm512_i64gather_epi64::<8>(pos, arr), flip);
+
+            let mut base = _mm512_setzero_si512();
+            let mut n = len;
+
+            while n > 1 {
+                let half = n / 2;
+                let mid = _mm512_add_epi64(base, _mm512_set1_epi64(half as i64));
+                let is_less = _mm512_cmplt_epi64_mask(load(mid), keys);
+                base = _mm512_mask_mov_epi64(base, is_less, mid);
+                n -= half;
+            }
+
+            let is_less = _mm512_cmplt_epi64_mask(load(base), keys);
+            base = _mm512_mask_add_epi64(base, is_less, base, _mm512_set1_epi64(1));
+
+            let mut result = [0u64; LANES];
+            _mm512_storeu_si512(result.as_mut_ptr() as *mut __m512i, base);
+            for (out, pos) in out[done..(done + LANES)].iter_mut().zip(result) {
+                *out = pos as usize;
+            }
+
+            done += LANES;
+        }
+
+        done
+    }
+}
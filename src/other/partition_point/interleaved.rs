@@ -0,0 +1,72 @@
+//! Advances `BATCH_LANES` branchless binary searches in lockstep. A single search is a chain of
+//! dependent loads, so its speed is bound by memory latency. Interleaving independent searches
+//! keeps several cache misses in flight at once, and prefetching both candidates of the next step
+//! starts each load one step early.
+
+use super::{prefetch, BatchPartitionPoint, BATCH_LANES};
+
+pub struct PartitionPointImpl;
+
+impl BatchPartitionPoint for PartitionPointImpl {
+    fn name() -> String {
+        "interleaved".into()
+    }
+
+    #[inline]
+    fn partition_point_batch<T: Ord>(index: &[T], vals: &[T], out: &mut [usize]) {
+        partition_point_batch(index, vals, out);
+    }
+}
+
+pub fn partition_point_batch<T: Ord>(arr: &[T], vals: &[T], out: &mut [usize]) {
+    assert_eq!(vals.len(), out.len());
+
+    if arr.is_empty() {
+        out.fill(0);
+        return;
+    }
+
+    let mut val_chunks = vals.chunks_exact(BATCH_LANES);
+    let mut out_chunks = out.chunks_exact_mut(BATCH_LANES);
+
+    for (vals, out) in (&mut val_chunks).zip(&mut out_chunks) {
+        search_lanes(arr, vals, out);
+    }
+
+    search_lanes(arr, val_chunks.remainder(), out_chunks.into_remainder());
+}
+
+#[inline(always)]
+fn search_lanes<T: Ord>(arr: &[T], vals: &[T], out: &mut [usize]) {
+    debug_assert!(!arr.is_empty() && vals.len() <= BATCH_LANES && vals.len() == out.len());
+
+    let arr_ptr = arr.as_ptr();
+
+    let mut base_storage = [0usize; BATCH_LANES];
+    let base = &mut base_storage[..vals.len()];
+
+    // Invariant: the result of each lane lies in [base, base + n], and base + n <= arr.len().
+    let mut n = arr.len();
+
+    while n > 1 {
+        let half = n / 2;
+
+        for (b, val) in base.iter_mut().zip(vals) {
+            // The next step looks at either half of [b, b + half) or [b + half, b + n).
+            prefetch(arr_ptr.wrapping_add(*b + half / 2));
+            prefetch(arr_ptr.wrapping_add(*b + half + half / 2));
+
+            let mid = *b + half;
+            // SAFETY: mid < base + n <= arr.len().
+            let is_less = unsafe { arr.get_unchecked(mid) < val };
+            *b = if is_less { mid } else { *b };
+        }
+
+        n -= half;
+    }
+
+    for ((out, b), val) in out.iter_mut().zip(base.iter()).zip(vals) {
+        // SAFETY: n == 1 so b < arr.len().
+        *out = *b + unsafe { arr.get_unchecked(*b) < val } as usize;
+    }
+}
@@ -38,6 +38,63 @@ macro_rules! partition_point_impl {
     };
 }
 
+/// Looks up many values in the same sorted slice at once, the main use of a sorted slice besides
+/// iterating it.
+pub trait BatchPartitionPoint {
+    fn name() -> String;
+
+    /// Builds the slice searched by `partition_point_batch` out of the sorted `arr`. By default
+    /// that's `arr` itself.
+    fn build_index<T: Clone>(arr: &[T]) -> Vec<T> {
+        arr.to_vec()
+    }
+
+    /// Sets `out[i]` to the position of the first element in `index` that is not less than
+    /// `vals[i]`, or `index.len()` if there is none. For a sorted `index` that's
+    /// `index.partition_point(|elem| elem < &vals[i])`.
+    fn partition_point_batch<T: Ord>(index: &[T], vals: &[T], out: &mut [usize]);
+}
+
+/// Looks up one value after the other with a `PartitionPoint` impl, the baseline for the batched
+/// searches.
+pub struct Sequential<P: PartitionPoint>(pub core::marker::PhantomData<P>);
+
+impl<P: PartitionPoint> BatchPartitionPoint for Sequential<P> {
+    fn name() -> String {
+        format!("{}_sequential", P::name())
+    }
+
+    #[inline]
+    fn partition_point_batch<T: Ord>(index: &[T], vals: &[T], out: &mut [usize]) {
+        assert_eq!(vals.len(), out.len());
+
+        for (val, out) in vals.iter().zip(out.iter_mut()) {
+            *out = P::partition_point(index, val);
+        }
+    }
+}
+
+/// Number of searches the batched impls advance in lockstep. Enough to keep the memory system
+/// busy with independent loads once the slice is larger than the caches.
+const BATCH_LANES: usize = 16;
+
+/// Hints the CPU to load the cache line of `ptr`. `ptr` may be out of bounds, prefetching never
+/// faults.
+#[inline(always)]
+fn prefetch<T>(ptr: *const T) {
+    #[cfg(target_arch = "x86_64")]
+    // SAFETY: prefetch doesn't access memory in an observable way.
+    unsafe {
+        core::arch::x86_64::_mm_prefetch::<{ core::arch::x86_64::_MM_HINT_T0 }>(ptr as *const i8);
+    }
+
+    #[cfg(not(target_arch = "x86_64"))]
+    let _ = ptr;
+}
+
 pub mod branchless_bitwise;
 pub mod branchless_clean;
+pub mod eytzinger;
+pub mod gather;
+pub mod interleaved;
 pub mod std;
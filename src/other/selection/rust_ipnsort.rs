@@ -27,6 +27,24 @@ where
     }
 }
 
+/// Reorder the slice such that the element at `index` is at its final sorted position.
+#[inline]
+pub fn select_nth_unstable<T: Ord>(v: &mut [T], index: usize) {
+    partition_at_index(v, index, |a, b| a.lt(b));
+}
+
+/// Sorts the `k` smallest elements into `v[..k]`, the order of the remaining elements is
+/// unspecified.
+#[inline]
+pub fn partial_sort<T: Ord>(v: &mut [T], k: usize) {
+    if k == 0 {
+        return;
+    }
+
+    let (left, _, _) = partition_at_index(v, k - 1, |a, b| a.lt(b));
+    left.sort_unstable();
+}
+
 /// Reorder the slice such that the element at `index` is at its final sorted position.
 fn partition_at_index<T, F>(
     v: &mut [T],
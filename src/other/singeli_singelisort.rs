@@ -1 +1,182 @@
+use std::mem::MaybeUninit;
+
 ffi_sort_impl!("singeli_singelisort", singelisort);
+ffi_sort_float_impl!(singelisort, [F64 => f64]);
+ffi_sort_packed_impl!(singelisort, [KeyPayloadU32 => key_payload_u32]);
+
+extern "C" {
+    fn singelisort_aux_len(len: usize) -> usize;
+    fn singelisort_i32_with_aux(
+        data: *mut i32,
+        len: usize,
+        aux: *mut MaybeUninit<i32>,
+        aux_len: usize,
+    ) -> u32;
+    fn singelisort_u64_with_aux(
+        data: *mut u64,
+        len: usize,
+        aux: *mut MaybeUninit<u64>,
+        aux_len: usize,
+    ) -> u32;
+    fn singelisort_i32_tls(data: *mut i32, len: usize);
+    fn singelisort_u64_tls(data: *mut u64, len: usize);
+    fn singelisort_i8(data: *mut i8, len: usize);
+    fn singelisort_u8(data: *mut u8, len: usize);
+    fn singelisort_i16(data: *mut i16, len: usize);
+    fn singelisort_u16(data: *mut u16, len: usize);
+    fn singelisort_grade_i8(keys: *const i8, len: usize, indices: *mut u64);
+    fn singelisort_grade_u8(keys: *const u8, len: usize, indices: *mut u64);
+    fn singelisort_grade_i16(keys: *const i16, len: usize, indices: *mut u64);
+    fn singelisort_grade_u16(keys: *const u16, len: usize, indices: *mut u64);
+    fn singelisort_rhsort_i32(data: *mut i32, len: usize);
+}
+
+// The counting sorts of 8 and 16 bit keys. The comparison based entry points have no kernel for
+// these types, sort_by keeps panicking.
+macro_rules! counting_sort_impl {
+    ($type:ty, $ffi_fn:ident) => {
+        impl CppSort for $type {
+            fn sort(data: &mut [Self]) {
+                unsafe {
+                    $ffi_fn(data.as_mut_ptr(), data.len());
+                }
+            }
+        }
+    };
+}
+
+counting_sort_impl!(i8, singelisort_i8);
+counting_sort_impl!(u8, singelisort_u8);
+counting_sort_impl!(i16, singelisort_i16);
+counting_sort_impl!(u16, singelisort_u16);
+
+trait SingeliGrade: Sized {
+    fn grade(keys: &[Self], indices: &mut [MaybeUninit<u64>]);
+}
+
+impl<T> SingeliGrade for T {
+    default fn grade(_keys: &[T], _indices: &mut [MaybeUninit<u64>]) {
+        panic!("Type not supported");
+    }
+}
+
+macro_rules! grade_impl {
+    ($type:ty, $ffi_fn:ident) => {
+        impl SingeliGrade for $type {
+            fn grade(keys: &[Self], indices: &mut [MaybeUninit<u64>]) {
+                unsafe {
+                    $ffi_fn(keys.as_ptr(), keys.len(), indices.as_mut_ptr().cast());
+                }
+            }
+        }
+    };
+}
+
+grade_impl!(i8, singelisort_grade_i8);
+grade_impl!(u8, singelisort_grade_u8);
+grade_impl!(i16, singelisort_grade_i16);
+grade_impl!(u16, singelisort_grade_u16);
+
+trait SingeliRobinHood: Sized {
+    fn sort_robin_hood(data: &mut [Self]);
+}
+
+impl<T> SingeliRobinHood for T {
+    default fn sort_robin_hood(_data: &mut [T]) {
+        panic!("Type not supported");
+    }
+}
+
+impl SingeliRobinHood for i32 {
+    fn sort_robin_hood(data: &mut [Self]) {
+        unsafe {
+            singelisort_rhsort_i32(data.as_mut_ptr(), data.len());
+        }
+    }
+}
+
+/// Number of scratch elements `sort_with_aux` needs to sort `len` elements.
+pub fn aux_len(len: usize) -> usize {
+    // SAFETY: No preconditions.
+    unsafe { singelisort_aux_len(len) }
+}
+
+trait SingeliSortScratch: Sized {
+    fn sort_with_aux(data: &mut [Self], aux: &mut [MaybeUninit<Self>]) -> u32;
+    fn sort_thread_local_aux(data: &mut [Self]);
+}
+
+impl<T> SingeliSortScratch for T {
+    default fn sort_with_aux(_data: &mut [T], _aux: &mut [MaybeUninit<T>]) -> u32 {
+        panic!("Type not supported");
+    }
+
+    default fn sort_thread_local_aux(_data: &mut [T]) {
+        panic!("Type not supported");
+    }
+}
+
+impl SingeliSortScratch for i32 {
+    fn sort_with_aux(data: &mut [Self], aux: &mut [MaybeUninit<Self>]) -> u32 {
+        unsafe {
+            singelisort_i32_with_aux(data.as_mut_ptr(), data.len(), aux.as_mut_ptr(), aux.len())
+        }
+    }
+
+    fn sort_thread_local_aux(data: &mut [Self]) {
+        unsafe {
+            singelisort_i32_tls(data.as_mut_ptr(), data.len());
+        }
+    }
+}
+
+impl SingeliSortScratch for u64 {
+    fn sort_with_aux(data: &mut [Self], aux: &mut [MaybeUninit<Self>]) -> u32 {
+        unsafe {
+            singelisort_u64_with_aux(data.as_mut_ptr(), data.len(), aux.as_mut_ptr(), aux.len())
+        }
+    }
+
+    fn sort_thread_local_aux(data: &mut [Self]) {
+        unsafe {
+            singelisort_u64_tls(data.as_mut_ptr(), data.len());
+        }
+    }
+}
+
+/// Sorts `data` using the caller provided scratch `aux`, which must hold at least
+/// `aux_len(data.len())` elements. Allows amortizing the allocation across many sorts.
+pub fn sort_with_aux<T: Ord>(data: &mut [T], aux: &mut [MaybeUninit<T>]) {
+    assert!(aux.len() >= aux_len(data.len()), "Scratch too small");
+
+    let ret_code = SingeliSortScratch::sort_with_aux(data, aux);
+    assert_eq!(ret_code, 0);
+}
+
+/// Sorts `data` using a per-thread scratch buffer owned by the C++ side. The buffer grows to the
+/// largest size seen by the thread and is never released.
+pub fn sort_thread_local_aux<T: Ord>(data: &mut [T]) {
+    SingeliSortScratch::sort_thread_local_aux(data);
+}
+
+/// Returns the permutation that sorts `keys`, with the counting grade kernels. Equal keys keep
+/// their order. Only implemented for i8, u8, i16 and u16.
+pub fn grade<T: Ord>(keys: &[T]) -> Vec<u64> {
+    let mut indices = Vec::with_capacity(keys.len());
+
+    SingeliGrade::grade(keys, indices.spare_capacity_mut());
+    // SAFETY: The C++ side writes all `keys.len()` indices.
+    unsafe {
+        indices.set_len(keys.len());
+    }
+
+    indices
+}
+
+/// Sorts `data` with Robin Hood sort. Values with a range below four times their number are
+/// counted. Otherwise every value is inserted into a table at the position its distance from the
+/// minimum predicts, shifted down so that the table has at most five slots per value. Fast for
+/// narrow ranges, wide ones cause collisions. Only implemented for i32.
+pub fn sort_robin_hood<T: Ord>(data: &mut [T]) {
+    SingeliRobinHood::sort_robin_hood(data);
+}
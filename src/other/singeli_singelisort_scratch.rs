@@ -0,0 +1,53 @@
+//! singelisort with caller provided scratch, pooled on the Rust side.
+
+use std::cell::RefCell;
+use std::cmp::Ordering;
+use std::mem::MaybeUninit;
+
+use super::singeli_singelisort::{aux_len, sort_with_aux};
+
+sort_impl!("singeli_singelisort_scratch");
+
+trait PooledSort: Sized {
+    fn sort(data: &mut [Self]);
+}
+
+impl<T> PooledSort for T {
+    default fn sort(_data: &mut [T]) {
+        panic!("Type not supported");
+    }
+}
+
+macro_rules! pooled_sort_impl {
+    ($type:ty) => {
+        impl PooledSort for $type {
+            fn sort(data: &mut [Self]) {
+                thread_local! {
+                    static AUX: RefCell<Vec<MaybeUninit<$type>>> = RefCell::new(Vec::new());
+                }
+
+                AUX.with(|aux| {
+                    let mut aux = aux.borrow_mut();
+
+                    let required_len = aux_len(data.len());
+                    if aux.len() < required_len {
+                        aux.resize(required_len, MaybeUninit::uninit());
+                    }
+
+                    sort_with_aux(data, &mut aux);
+                });
+            }
+        }
+    };
+}
+
+pooled_sort_impl!(i32);
+pooled_sort_impl!(u64);
+
+pub fn sort<T: Ord>(data: &mut [T]) {
+    PooledSort::sort(data);
+}
+
+pub fn sort_by<T, F: FnMut(&T, &T) -> Ordering>(_data: &mut [T], _compare: F) {
+    panic!("Type not supported");
+}
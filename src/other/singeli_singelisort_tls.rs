@@ -0,0 +1,13 @@
+//! singelisort with a per-thread growable scratch arena instead of a fresh allocation per call.
+
+use std::cmp::Ordering;
+
+sort_impl!("singeli_singelisort_tls");
+
+pub fn sort<T: Ord>(data: &mut [T]) {
+    super::singeli_singelisort::sort_thread_local_aux(data);
+}
+
+pub fn sort_by<T, F: FnMut(&T, &T) -> Ordering>(_data: &mut [T], _compare: F) {
+    panic!("Type not supported");
+}
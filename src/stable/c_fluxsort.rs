@@ -1 +1,3 @@
 ffi_sort_impl!("c_fluxsort_stable", fluxsort_stable);
+ffi_sort_with_buf_impl!(fluxsort_stable);
+ffi_sort_indirect_impl!(fluxsort_stable);
@@ -0,0 +1 @@
+ffi_parallel_sort_impl!("c_fluxsort_parallel_stable", fluxsort_parallel_stable);
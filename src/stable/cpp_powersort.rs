@@ -1 +1,53 @@
 ffi_sort_impl!("cpp_powersort_stable", powersort_stable);
+ffi_sort_arena_string_impl!(powersort_stable);
+ffi_sort_with_buf_impl!(powersort_stable);
+ffi_sort_counted_impl!(powersort_stable);
+ffi_sort_indirect_impl!(powersort_stable);
+
+extern "C" {
+    fn powersort_stable_f128_merge_mode(data: *mut F128, len: usize, mode: u32) -> u32;
+    fn powersort_stable_1k_merge_mode(data: *mut FFIOneKibiByte, len: usize, mode: u32) -> u32;
+}
+
+/// How `sort_merge_mode` merges `F128` and `FFIOneKibiByte` runs.
+#[derive(Copy, Clone, Debug, PartialEq, Eq)]
+pub enum MergeMode {
+    /// Branchless merge from both ends, what `sort` uses.
+    Bidirectional,
+    /// Forward merge that prefetches a few cache lines ahead of both runs and the output.
+    Prefetch,
+    /// Forward merge that moves every stretch of elements taken from the same run with a single
+    /// copy.
+    Blockwise,
+}
+
+trait CppSortMergeMode: Sized {
+    fn sort_merge_mode(data: &mut [Self], mode: u32) -> u32;
+}
+
+impl<T> CppSortMergeMode for T {
+    default fn sort_merge_mode(_data: &mut [T], _mode: u32) -> u32 {
+        panic!("Type not supported");
+    }
+}
+
+impl CppSortMergeMode for F128 {
+    fn sort_merge_mode(data: &mut [Self], mode: u32) -> u32 {
+        // SAFETY: The pointer and length come from a valid slice.
+        unsafe { powersort_stable_f128_merge_mode(data.as_mut_ptr(), data.len(), mode) }
+    }
+}
+
+impl CppSortMergeMode for FFIOneKibiByte {
+    fn sort_merge_mode(data: &mut [Self], mode: u32) -> u32 {
+        // SAFETY: The pointer and length come from a valid slice.
+        unsafe { powersort_stable_1k_merge_mode(data.as_mut_ptr(), data.len(), mode) }
+    }
+}
+
+/// Sorts `data` with the merges of `mode`. Supports F128 and FFIOneKibiByte, `sort` and
+/// `sort_by` always use `Bidirectional`.
+pub fn sort_merge_mode<T: Ord>(data: &mut [T], mode: MergeMode) {
+    let result = CppSortMergeMode::sort_merge_mode(data, mode as u32);
+    assert_eq!(result, 0, "Invalid merge mode");
+}
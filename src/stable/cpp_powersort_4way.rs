@@ -1 +1,2 @@
 ffi_sort_impl!("cpp_powersort_4way_stable", powersort_4way_stable);
+ffi_sort_with_buf_impl!(powersort_4way_stable);
@@ -0,0 +1,2 @@
+ffi_parallel_sort_impl!("cpp_powersort_parallel_stable", powersort_parallel_stable);
+ffi_merge_sorted_runs_impl!(powersort_parallel_stable);
@@ -1 +1,2 @@
 ffi_sort_impl!("cpp_std_gcc4_3_stable", sort_stable_gcc4_3);
+ffi_sort_with_buf_impl!(sort_stable_gcc4_3);
@@ -1 +1,7 @@
 ffi_sort_impl!("cpp_std_libcxx_stable", sort_stable_libcxx);
+ffi_sort_by_key_impl!(sort_stable_libcxx);
+ffi_sort_float_impl!(sort_stable_libcxx);
+ffi_sort_arena_string_impl!(sort_stable_libcxx);
+ffi_sort_with_buf_impl!(sort_stable_libcxx);
+ffi_sort_counted_impl!(sort_stable_libcxx);
+ffi_sort_indirect_impl!(sort_stable_libcxx);
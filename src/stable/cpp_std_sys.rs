@@ -1 +1,7 @@
 ffi_sort_impl!("cpp_std_sys_stable", sort_stable_sys);
+ffi_sort_by_key_impl!(sort_stable_sys);
+ffi_sort_float_impl!(sort_stable_sys);
+ffi_sort_arena_string_impl!(sort_stable_sys);
+ffi_sort_with_buf_impl!(sort_stable_sys);
+ffi_sort_counted_impl!(sort_stable_sys);
+ffi_sort_indirect_impl!(sort_stable_sys);
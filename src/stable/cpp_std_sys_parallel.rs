@@ -0,0 +1 @@
+ffi_parallel_sort_impl!("cpp_std_sys_parallel_stable", sort_stable_sys_par);
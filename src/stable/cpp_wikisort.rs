@@ -1 +1,210 @@
 ffi_sort_impl!("cpp_wikisort_stable", wikisort_stable);
+ffi_sort_with_buf_impl!(wikisort_stable);
+
+extern "C" {
+    fn wikisort_stable_i32_cache_mode(
+        data: *mut i32,
+        len: usize,
+        mode: u32,
+        fixed_len: usize,
+        max_alloc_len: usize,
+    ) -> u32;
+    fn wikisort_stable_u64_cache_mode(
+        data: *mut u64,
+        len: usize,
+        mode: u32,
+        fixed_len: usize,
+        max_alloc_len: usize,
+    ) -> u32;
+    fn wikisort_stable_f128_cache_mode(
+        data: *mut F128,
+        len: usize,
+        mode: u32,
+        fixed_len: usize,
+        max_alloc_len: usize,
+    ) -> u32;
+    fn wikisort_stable_1k_cache_mode(
+        data: *mut FFIOneKibiByte,
+        len: usize,
+        mode: u32,
+        fixed_len: usize,
+        max_alloc_len: usize,
+    ) -> u32;
+}
+
+/// Where WikiSort takes its merge cache from, sizes are in elements.
+#[derive(Copy, Clone, Debug, PartialEq, Eq)]
+pub enum CacheMode {
+    /// 512 elements on the stack, the vendored default and what `sort` uses.
+    Stack,
+    /// A heap cache with a fixed number of elements, 0 disables the cache.
+    Fixed(usize),
+    /// sqrt((n + 1) / 2) + 1 elements on the heap, enough to avoid all in-place merges.
+    Sqrt,
+    /// (n + 1) / 2 elements on the heap, a standard buffered merge sort.
+    Half,
+}
+
+trait CppSortCacheMode: Sized {
+    fn sort_cache_mode(data: &mut [Self], mode: u32, fixed_len: usize, max_alloc_len: usize)
+        -> u32;
+}
+
+impl<T> CppSortCacheMode for T {
+    default fn sort_cache_mode(
+        _data: &mut [T],
+        _mode: u32,
+        _fixed_len: usize,
+        _max_alloc_len: usize,
+    ) -> u32 {
+        panic!("Type not supported");
+    }
+}
+
+impl CppSortCacheMode for i32 {
+    fn sort_cache_mode(
+        data: &mut [Self],
+        mode: u32,
+        fixed_len: usize,
+        max_alloc_len: usize,
+    ) -> u32 {
+        // SAFETY: The pointer and length come from a valid slice.
+        unsafe {
+            wikisort_stable_i32_cache_mode(
+                data.as_mut_ptr(),
+                data.len(),
+                mode,
+                fixed_len,
+                max_alloc_len,
+            )
+        }
+    }
+}
+
+impl CppSortCacheMode for u64 {
+    fn sort_cache_mode(
+        data: &mut [Self],
+        mode: u32,
+        fixed_len: usize,
+        max_alloc_len: usize,
+    ) -> u32 {
+        // SAFETY: The pointer and length come from a valid slice.
+        unsafe {
+            wikisort_stable_u64_cache_mode(
+                data.as_mut_ptr(),
+                data.len(),
+                mode,
+                fixed_len,
+                max_alloc_len,
+            )
+        }
+    }
+}
+
+impl CppSortCacheMode for F128 {
+    fn sort_cache_mode(
+        data: &mut [Self],
+        mode: u32,
+        fixed_len: usize,
+        max_alloc_len: usize,
+    ) -> u32 {
+        // SAFETY: The pointer and length come from a valid slice.
+        unsafe {
+            wikisort_stable_f128_cache_mode(
+                data.as_mut_ptr(),
+                data.len(),
+                mode,
+                fixed_len,
+                max_alloc_len,
+            )
+        }
+    }
+}
+
+impl CppSortCacheMode for FFIOneKibiByte {
+    fn sort_cache_mode(
+        data: &mut [Self],
+        mode: u32,
+        fixed_len: usize,
+        max_alloc_len: usize,
+    ) -> u32 {
+        // SAFETY: The pointer and length come from a valid slice.
+        unsafe {
+            wikisort_stable_1k_cache_mode(
+                data.as_mut_ptr(),
+                data.len(),
+                mode,
+                fixed_len,
+                max_alloc_len,
+            )
+        }
+    }
+}
+
+/// Sorts `data` with the merge cache of `mode`. Supports i32, u64, F128 and FFIOneKibiByte,
+/// `sort_with_buf` uses the provided buffer as cache instead.
+pub fn sort_cache_mode<T: Ord>(data: &mut [T], mode: CacheMode) {
+    sort_cache_mode_max_alloc(data, mode, usize::MAX);
+}
+
+/// Same as `sort_cache_mode`, but heap caches of more than `max_alloc_len` elements fail to
+/// allocate, which exercises the fallbacks to a 512 element cache and to no cache at all.
+pub fn sort_cache_mode_max_alloc<T: Ord>(data: &mut [T], mode: CacheMode, max_alloc_len: usize) {
+    let (mode_id, fixed_len) = match mode {
+        CacheMode::Stack => (0, 0),
+        CacheMode::Fixed(len) => (1, len),
+        CacheMode::Sqrt => (2, 0),
+        CacheMode::Half => (3, 0),
+    };
+
+    let result = CppSortCacheMode::sort_cache_mode(data, mode_id, fixed_len, max_alloc_len);
+    assert_eq!(result, 0, "Invalid cache mode");
+}
+
+extern "C" {
+    fn wikisort_stable_f128_merge_mode(data: *mut F128, len: usize, mode: u32) -> u32;
+    fn wikisort_stable_1k_merge_mode(data: *mut FFIOneKibiByte, len: usize, mode: u32) -> u32;
+}
+
+/// How the merges through the cache of `sort_merge_mode` move `F128` and `FFIOneKibiByte`
+/// elements.
+#[derive(Copy, Clone, Debug, PartialEq, Eq)]
+pub enum MergeMode {
+    /// One element at a time, the vendored default and what `sort` uses.
+    Plain,
+    /// One element at a time, prefetching a few cache lines ahead of both inputs and the output.
+    Prefetch,
+    /// Every stretch of elements taken from the same input is moved with a single copy.
+    Blockwise,
+}
+
+trait CppSortMergeMode: Sized {
+    fn sort_merge_mode(data: &mut [Self], mode: u32) -> u32;
+}
+
+impl<T> CppSortMergeMode for T {
+    default fn sort_merge_mode(_data: &mut [T], _mode: u32) -> u32 {
+        panic!("Type not supported");
+    }
+}
+
+impl CppSortMergeMode for F128 {
+    fn sort_merge_mode(data: &mut [Self], mode: u32) -> u32 {
+        // SAFETY: The pointer and length come from a valid slice.
+        unsafe { wikisort_stable_f128_merge_mode(data.as_mut_ptr(), data.len(), mode) }
+    }
+}
+
+impl CppSortMergeMode for FFIOneKibiByte {
+    fn sort_merge_mode(data: &mut [Self], mode: u32) -> u32 {
+        // SAFETY: The pointer and length come from a valid slice.
+        unsafe { wikisort_stable_1k_merge_mode(data.as_mut_ptr(), data.len(), mode) }
+    }
+}
+
+/// Sorts `data` with the merges of `mode`. Supports F128 and FFIOneKibiByte, `sort` and
+/// `sort_by` always use `Plain`.
+pub fn sort_merge_mode<T: Ord>(data: &mut [T], mode: MergeMode) {
+    let result = CppSortMergeMode::sort_merge_mode(data, mode as u32);
+    assert_eq!(result, 0, "Invalid merge mode");
+}
@@ -1 +1,2 @@
 ffi_sort_impl!("golang_std_stable", golang_std_stable);
+ffi_sort_by_key_impl!(golang_std_stable);
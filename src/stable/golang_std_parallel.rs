@@ -0,0 +1 @@
+ffi_parallel_sort_impl!("golang_std_parallel_stable", golang_std_parallel_stable);
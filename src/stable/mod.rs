@@ -19,6 +19,10 @@ pub mod rust_grailsort;
 #[cfg(feature = "cpp_std_sys")]
 pub mod cpp_std_sys;
 
+// Call stdlib std::stable_sort with std::execution::par via FFI.
+#[cfg(feature = "cpp_std_sys_parallel")]
+pub mod cpp_std_sys_parallel;
+
 // Call stdlib std::sort_stable sort via FFI.
 #[cfg(feature = "cpp_std_libcxx")]
 pub mod cpp_std_libcxx;
@@ -35,6 +39,14 @@ pub mod cpp_powersort;
 #[cfg(feature = "cpp_powersort")]
 pub mod cpp_powersort_4way;
 
+// Call parallel powersort via FFI.
+#[cfg(feature = "cpp_powersort_parallel")]
+pub mod cpp_powersort_parallel;
+
+// Stable vqsort, keys packed together with their index. Only i32 and u64.
+#[cfg(feature = "cpp_vqsort")]
+pub mod cpp_vqsort_stable;
+
 // Call wikisort via FFI.
 #[cfg(feature = "cpp_wikisort")]
 pub mod cpp_wikisort;
@@ -44,6 +56,14 @@ pub mod cpp_wikisort;
 #[cfg(feature = "c_fluxsort")]
 pub mod c_fluxsort;
 
+// Call the parallel fluxsort driver via FFI, same stability caveat as c_fluxsort.
+#[cfg(feature = "c_fluxsort")]
+pub mod c_fluxsort_parallel;
+
 // Call golang slices.SortStable
 #[cfg(feature = "golang_std")]
 pub mod golang_std;
+
+// Call a goroutine parallel sample sort, with slices.SortStableFunc for the buckets.
+#[cfg(feature = "golang_std")]
+pub mod golang_std_parallel;
@@ -1 +1,5 @@
 ffi_sort_impl!("c_crumsort_unstable", crumsort_unstable);
+ffi_sort_with_buf_impl!(crumsort_unstable, records);
+
+#[cfg(feature = "cpp_sort_telemetry")]
+ffi_telemetry_impl!(crumsort_unstable);
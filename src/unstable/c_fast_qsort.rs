@@ -0,0 +1 @@
+ffi_sort_impl!("c_fast_qsort_unstable", fast_qsort_unstable);
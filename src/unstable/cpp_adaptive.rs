@@ -0,0 +1,50 @@
+ffi_sort_impl!("cpp_adaptive_unstable", adaptive_unstable);
+
+extern "C" {
+    fn adaptive_unstable_i32_backend(data: *const i32, len: usize) -> *const std::ffi::c_char;
+    fn adaptive_unstable_u64_backend(data: *const u64, len: usize) -> *const std::ffi::c_char;
+    fn adaptive_unstable_ffi_string_backend(
+        data: *const FFIString,
+        len: usize,
+    ) -> *const std::ffi::c_char;
+    fn adaptive_unstable_f128_backend(data: *const F128, len: usize) -> *const std::ffi::c_char;
+    fn adaptive_unstable_1k_backend(
+        data: *const FFIOneKibiByte,
+        len: usize,
+    ) -> *const std::ffi::c_char;
+}
+
+trait CppBackend: Sized {
+    fn backend(data: &[Self]) -> *const std::ffi::c_char;
+}
+
+impl<T> CppBackend for T {
+    default fn backend(_data: &[T]) -> *const std::ffi::c_char {
+        panic!("Type not supported");
+    }
+}
+
+macro_rules! backend_impl {
+    ($type:ty, $ffi_fn:ident) => {
+        impl CppBackend for $type {
+            fn backend(data: &[Self]) -> *const std::ffi::c_char {
+                unsafe { $ffi_fn(data.as_ptr(), data.len()) }
+            }
+        }
+    };
+}
+
+backend_impl!(i32, adaptive_unstable_i32_backend);
+backend_impl!(u64, adaptive_unstable_u64_backend);
+backend_impl!(FFIString, adaptive_unstable_ffi_string_backend);
+backend_impl!(F128, adaptive_unstable_f128_backend);
+backend_impl!(FFIOneKibiByte, adaptive_unstable_1k_backend);
+
+/// Name of the backend `sort` routes `data` to, one of "pdqsort", "powersort", "radix" and
+/// "vqsort". Only samples the input, as `sort` does.
+pub fn backend<T: Ord>(data: &[T]) -> &'static str {
+    // SAFETY: The C++ side returns a pointer to a static null terminated string.
+    unsafe { std::ffi::CStr::from_ptr(CppBackend::backend(data)) }
+        .to_str()
+        .unwrap()
+}
@@ -1 +1,4 @@
 ffi_sort_impl!("cpp_blockquicksort_unstable", blockquicksort_unstable);
+
+#[cfg(feature = "cpp_sort_telemetry")]
+ffi_telemetry_impl!(blockquicksort_unstable);
@@ -0,0 +1,4 @@
+ffi_sort_impl!(
+    "cpp_blockquicksort_dual_pivot_unstable",
+    blockquicksort_dual_pivot_unstable
+);
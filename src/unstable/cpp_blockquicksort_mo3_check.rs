@@ -0,0 +1,4 @@
+ffi_sort_impl!(
+    "cpp_blockquicksort_mo3_check_unstable",
+    blockquicksort_mo3_check_unstable
+);
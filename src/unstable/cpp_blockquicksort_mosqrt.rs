@@ -0,0 +1,4 @@
+ffi_sort_impl!(
+    "cpp_blockquicksort_mosqrt_unstable",
+    blockquicksort_mosqrt_unstable
+);
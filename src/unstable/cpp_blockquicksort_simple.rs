@@ -0,0 +1,4 @@
+ffi_sort_impl!(
+    "cpp_blockquicksort_simple_unstable",
+    blockquicksort_simple_unstable
+);
@@ -1 +1,66 @@
 ffi_sort_impl!("cpp_gerbens_qsort_unstable", gerbens_qsort_unstable);
+ffi_sort_by_nothrow_impl!(gerbens_qsort_unstable);
+
+extern "C" {
+    fn gerbens_qsort_unstable_i32_scratch(data: *mut i32, len: usize, scratch_size: usize) -> u32;
+    fn gerbens_qsort_unstable_u64_scratch(data: *mut u64, len: usize, scratch_size: usize) -> u32;
+    fn gerbens_qsort_unstable_f128_scratch(data: *mut F128, len: usize, scratch_size: usize)
+        -> u32;
+    fn gerbens_qsort_unstable_1k_scratch(
+        data: *mut FFIOneKibiByte,
+        len: usize,
+        scratch_size: usize,
+    ) -> u32;
+}
+
+/// Scratch buffer sizes in elements the C++ side is instantiated with.
+pub const SCRATCH_SIZES: [usize; 8] = [32, 64, 128, 256, 512, 1024, 2048, 4096];
+
+/// Default scratch buffer size of the vendored implementation, what `sort` and `sort_by` use.
+pub const DEFAULT_SCRATCH_SIZE: usize = 128;
+
+trait CppSortScratch: Sized {
+    fn sort_scratch(data: &mut [Self], scratch_size: usize) -> u32;
+}
+
+impl<T> CppSortScratch for T {
+    default fn sort_scratch(_data: &mut [T], _scratch_size: usize) -> u32 {
+        panic!("Type not supported");
+    }
+}
+
+impl CppSortScratch for i32 {
+    fn sort_scratch(data: &mut [Self], scratch_size: usize) -> u32 {
+        // SAFETY: The pointer and length come from a valid slice.
+        unsafe { gerbens_qsort_unstable_i32_scratch(data.as_mut_ptr(), data.len(), scratch_size) }
+    }
+}
+
+impl CppSortScratch for u64 {
+    fn sort_scratch(data: &mut [Self], scratch_size: usize) -> u32 {
+        // SAFETY: The pointer and length come from a valid slice.
+        unsafe { gerbens_qsort_unstable_u64_scratch(data.as_mut_ptr(), data.len(), scratch_size) }
+    }
+}
+
+impl CppSortScratch for F128 {
+    fn sort_scratch(data: &mut [Self], scratch_size: usize) -> u32 {
+        // SAFETY: The pointer and length come from a valid slice.
+        unsafe { gerbens_qsort_unstable_f128_scratch(data.as_mut_ptr(), data.len(), scratch_size) }
+    }
+}
+
+impl CppSortScratch for FFIOneKibiByte {
+    fn sort_scratch(data: &mut [Self], scratch_size: usize) -> u32 {
+        // SAFETY: The pointer and length come from a valid slice.
+        unsafe { gerbens_qsort_unstable_1k_scratch(data.as_mut_ptr(), data.len(), scratch_size) }
+    }
+}
+
+/// Sorts `data` with a scratch buffer of `scratch_size` elements, one of `SCRATCH_SIZES`. 0 picks
+/// the largest size that fits into a quarter of the L1 data cache, for the element type. Supports
+/// i32, u64, F128 and FFIOneKibiByte.
+pub fn sort_scratch<T: Ord>(data: &mut [T], scratch_size: usize) {
+    let result = CppSortScratch::sort_scratch(data, scratch_size);
+    assert_eq!(result, 0, "Unsupported scratch size: {scratch_size}");
+}
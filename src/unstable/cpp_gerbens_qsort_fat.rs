@@ -0,0 +1 @@
+ffi_sort_impl!("cpp_gerbens_qsort_fat_unstable", gerbens_qsort_fat_unstable);
@@ -1 +1,121 @@
 ffi_sort_impl!("cpp_ips4o_unstable", ips4o_unstable);
+ffi_sort_by_key_impl!(ips4o_unstable);
+ffi_sort_arena_string_impl!(ips4o_unstable);
+ffi_sort_partial_impl!(ips4o_unstable);
+ffi_sort_into_impl!(ips4o_unstable);
+ffi_sort_counted_impl!(ips4o_unstable);
+ffi_sort_indirect_impl!(ips4o_unstable);
+
+#[cfg(feature = "cpp_ips4o_timer")]
+ffi_phase_timer_impl!(
+    ips4o_unstable,
+    [
+        "total",
+        "overhead",
+        "sampling",
+        "classification",
+        "empty_block",
+        "permutation",
+        "cleanup",
+        "base_case",
+    ]
+);
+
+#[cfg(feature = "cpp_sort_telemetry")]
+ffi_telemetry_impl!(ips4o_unstable);
+
+extern "C" {
+    fn ips4o_unstable_i32_profile(data: *mut i32, len: usize, profile: u32) -> u32;
+    fn ips4o_unstable_u64_profile(data: *mut u64, len: usize, profile: u32) -> u32;
+    fn ips4o_unstable_f128_profile(data: *mut F128, len: usize, profile: u32) -> u32;
+    fn ips4o_unstable_1k_profile(data: *mut FFIOneKibiByte, len: usize, profile: u32) -> u32;
+}
+
+/// Tuned ips4o configurations for specific classes of inputs, all compiled in and picked per call
+/// with `sort_profile`.
+#[derive(Copy, Clone, Debug, PartialEq, Eq)]
+pub enum Ips4oProfile {
+    /// The default configuration, same as `sort`.
+    Default,
+    /// Fewer buckets and smaller blocks, so that the buffers fit into a 256KiB L2.
+    SmallCache,
+    /// Twice the buckets and blocks of the default, for large inputs on CPUs with a large L3.
+    LargeCache,
+    /// Splits off equal elements earlier, for inputs with few distinct values.
+    Duplicates,
+    /// Four times larger blocks in half the buckets, for elements of hundreds of bytes.
+    LargeElements,
+}
+
+impl Ips4oProfile {
+    pub const ALL: [Ips4oProfile; 5] = [
+        Ips4oProfile::Default,
+        Ips4oProfile::SmallCache,
+        Ips4oProfile::LargeCache,
+        Ips4oProfile::Duplicates,
+        Ips4oProfile::LargeElements,
+    ];
+
+    pub fn name(self) -> &'static str {
+        match self {
+            Ips4oProfile::Default => "default",
+            Ips4oProfile::SmallCache => "small_cache",
+            Ips4oProfile::LargeCache => "large_cache",
+            Ips4oProfile::Duplicates => "duplicates",
+            Ips4oProfile::LargeElements => "large_elements",
+        }
+    }
+}
+
+trait CppSortProfile: Sized {
+    fn sort_profile(data: &mut [Self], profile: u32) -> u32;
+}
+
+impl<T> CppSortProfile for T {
+    default fn sort_profile(_data: &mut [T], _profile: u32) -> u32 {
+        panic!("Type not supported");
+    }
+}
+
+impl CppSortProfile for i32 {
+    fn sort_profile(data: &mut [Self], profile: u32) -> u32 {
+        // SAFETY: The pointer and length come from a valid slice.
+        unsafe { ips4o_unstable_i32_profile(data.as_mut_ptr(), data.len(), profile) }
+    }
+}
+
+impl CppSortProfile for u64 {
+    fn sort_profile(data: &mut [Self], profile: u32) -> u32 {
+        // SAFETY: The pointer and length come from a valid slice.
+        unsafe { ips4o_unstable_u64_profile(data.as_mut_ptr(), data.len(), profile) }
+    }
+}
+
+impl CppSortProfile for F128 {
+    fn sort_profile(data: &mut [Self], profile: u32) -> u32 {
+        // SAFETY: The pointer and length come from a valid slice.
+        unsafe { ips4o_unstable_f128_profile(data.as_mut_ptr(), data.len(), profile) }
+    }
+}
+
+impl CppSortProfile for FFIOneKibiByte {
+    fn sort_profile(data: &mut [Self], profile: u32) -> u32 {
+        // SAFETY: The pointer and length come from a valid slice.
+        unsafe { ips4o_unstable_1k_profile(data.as_mut_ptr(), data.len(), profile) }
+    }
+}
+
+/// Sorts `data` with the ips4o configuration of `profile`. Supports i32, u64, F128 and
+/// FFIOneKibiByte.
+pub fn sort_profile<T: Ord>(data: &mut [T], profile: Ips4oProfile) {
+    let profile_id = match profile {
+        Ips4oProfile::Default => 0,
+        Ips4oProfile::SmallCache => 1,
+        Ips4oProfile::LargeCache => 2,
+        Ips4oProfile::Duplicates => 3,
+        Ips4oProfile::LargeElements => 4,
+    };
+
+    let result = CppSortProfile::sort_profile(data, profile_id);
+    assert_eq!(result, 0, "Invalid ips4o profile");
+}
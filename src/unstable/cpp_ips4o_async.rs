@@ -0,0 +1,208 @@
+//! Asynchronous parallel ips4o. Sorts are submitted to a persistent thread pool and complete in
+//! the background, while the submitting thread goes on with I/O. A `SortJob` can be polled,
+//! waited on, or awaited as a `Future` from any async runtime without blocking an executor
+//! thread.
+
+use std::future::Future;
+use std::marker::PhantomData;
+use std::os::raw::c_void;
+use std::pin::Pin;
+use std::sync::{Arc, Mutex};
+use std::task::{Context, Poll, Waker};
+
+#[repr(C)]
+struct Ips4oAsyncFFI {
+    _private: [u8; 0],
+}
+
+#[repr(C)]
+struct Ips4oAsyncJobFFI {
+    _private: [u8; 0],
+}
+
+extern "C" {
+    fn ips4o_async_create(num_threads: usize) -> *mut Ips4oAsyncFFI;
+    fn ips4o_async_destroy(async_pool: *mut Ips4oAsyncFFI);
+    fn ips4o_async_submit(
+        async_pool: *mut Ips4oAsyncFFI,
+        kind: u32,
+        data: *mut c_void,
+        len: usize,
+        notify: Option<unsafe extern "C" fn(*mut c_void)>,
+        notify_ctx: *mut c_void,
+    ) -> *mut Ips4oAsyncJobFFI;
+    fn ips4o_async_poll(job: *const Ips4oAsyncJobFFI) -> bool;
+    fn ips4o_async_wait(job: *const Ips4oAsyncJobFFI) -> u32;
+    fn ips4o_async_release(job: *mut Ips4oAsyncJobFFI);
+}
+
+mod private {
+    pub trait Sealed {}
+
+    impl Sealed for i32 {}
+    impl Sealed for u64 {}
+}
+
+/// Element types the asynchronous sort supports.
+pub trait AsyncSortType: private::Sealed + Send + 'static {
+    #[doc(hidden)]
+    const KIND: u32;
+}
+
+impl AsyncSortType for i32 {
+    const KIND: u32 = 0;
+}
+
+impl AsyncSortType for u64 {
+    const KIND: u32 = 1;
+}
+
+/// Owning handle to the worker pool and the dispatcher thread that feeds it. Submitted sorts run
+/// one after the other, each on all worker threads. Dropping it finishes the submitted sorts
+/// first.
+pub struct Ips4oAsync {
+    async_pool: *mut Ips4oAsyncFFI,
+}
+
+// SAFETY: Submitting is thread-safe on the C++ side.
+unsafe impl Send for Ips4oAsync {}
+unsafe impl Sync for Ips4oAsync {}
+
+impl Ips4oAsync {
+    pub fn new(num_threads: usize) -> Self {
+        assert!(num_threads > 0);
+
+        // SAFETY: No preconditions.
+        let async_pool = unsafe { ips4o_async_create(num_threads) };
+        assert!(!async_pool.is_null(), "Failed to create ips4o async pool");
+
+        Self { async_pool }
+    }
+
+    /// Queues `data` for sorting and returns right away. The job owns `data` until it's done, and
+    /// hands it back sorted.
+    pub fn submit<T: AsyncSortType>(&self, mut data: Vec<T>) -> SortJob<'_, T> {
+        let waker_slot = Arc::new(WakerSlot::default());
+        let notify_ctx = Arc::into_raw(waker_slot.clone()) as *mut c_void;
+
+        // SAFETY: `data` stays allocated and untouched until the job is done, see `SortJob`.
+        // `notify_ctx` holds a reference that `wake_waker_slot` takes over.
+        let job = unsafe {
+            ips4o_async_submit(
+                self.async_pool,
+                T::KIND,
+                data.as_mut_ptr() as *mut c_void,
+                data.len(),
+                Some(wake_waker_slot),
+                notify_ctx,
+            )
+        };
+
+        if job.is_null() {
+            // SAFETY: The callback will never run, take back its reference.
+            unsafe { drop(Arc::from_raw(notify_ctx as *const WakerSlot)) };
+            panic!("Failed to submit ips4o async sort");
+        }
+
+        SortJob {
+            job,
+            data: Some(data),
+            waker_slot,
+            _async_pool: PhantomData,
+        }
+    }
+}
+
+impl Drop for Ips4oAsync {
+    fn drop(&mut self) {
+        // SAFETY: `self.async_pool` was created by `ips4o_async_create`, the jobs borrow it and are
+        // gone by now.
+        unsafe {
+            ips4o_async_destroy(self.async_pool);
+        }
+    }
+}
+
+#[derive(Default)]
+struct WakerSlot {
+    waker: Mutex<Option<Waker>>,
+}
+
+// Called on the dispatcher thread once the job is done.
+unsafe extern "C" fn wake_waker_slot(ctx: *mut c_void) {
+    let waker_slot = Arc::from_raw(ctx as *const WakerSlot);
+    let waker = waker_slot.waker.lock().unwrap().take();
+    if let Some(waker) = waker {
+        waker.wake();
+    }
+}
+
+/// A submitted sort. Dropping it before it's done blocks until it is, the C++ side still writes
+/// to the data until then.
+pub struct SortJob<'a, T> {
+    job: *mut Ips4oAsyncJobFFI,
+    data: Option<Vec<T>>,
+    waker_slot: Arc<WakerSlot>,
+    _async_pool: PhantomData<&'a Ips4oAsync>,
+}
+
+// SAFETY: The job handle can be polled, waited on and released from any thread.
+unsafe impl<T: Send> Send for SortJob<'_, T> {}
+
+impl<T> SortJob<'_, T> {
+    pub fn is_done(&self) -> bool {
+        // SAFETY: `self.job` is valid until `finish`.
+        unsafe { ips4o_async_poll(self.job) }
+    }
+
+    /// Blocks the calling thread until the sort is done.
+    pub fn wait(mut self) -> Vec<T> {
+        self.finish()
+    }
+
+    fn finish(&mut self) -> Vec<T> {
+        // SAFETY: `self.job` is valid, it's released exactly once here.
+        unsafe {
+            let ret_code = ips4o_async_wait(self.job);
+            ips4o_async_release(self.job);
+            self.job = std::ptr::null_mut();
+
+            assert_eq!(ret_code, 0, "ips4o async sort failed");
+        }
+
+        self.data.take().unwrap()
+    }
+}
+
+// Nothing is pinned structurally, the data is only ever reached through the heap pointer of the
+// Vec.
+impl<T> Unpin for SortJob<'_, T> {}
+
+impl<T> Future for SortJob<'_, T> {
+    type Output = Vec<T>;
+
+    fn poll(self: Pin<&mut Self>, cx: &mut Context<'_>) -> Poll<Vec<T>> {
+        let this = self.get_mut();
+
+        // Registered before checking, so that a sort finishing in between still wakes the task.
+        *this.waker_slot.waker.lock().unwrap() = Some(cx.waker().clone());
+
+        if this.is_done() {
+            Poll::Ready(this.finish())
+        } else {
+            Poll::Pending
+        }
+    }
+}
+
+impl<T> Drop for SortJob<'_, T> {
+    fn drop(&mut self) {
+        if !self.job.is_null() {
+            // SAFETY: Not yet released, see `finish`.
+            unsafe {
+                ips4o_async_wait(self.job);
+                ips4o_async_release(self.job);
+            }
+        }
+    }
+}
@@ -0,0 +1,20 @@
+ffi_parallel_sort_impl!("cpp_ips4o_parallel_unstable", ips4o_parallel_unstable);
+ffi_sort_batch_impl!(ips4o_parallel_unstable, parallel);
+
+#[cfg(feature = "cpp_ips4o_timer")]
+ffi_phase_timer_impl!(
+    ips4o_parallel_unstable,
+    [
+        "total",
+        "overhead",
+        "sampling",
+        "classification",
+        "empty_block",
+        "permutation",
+        "cleanup",
+        "base_case",
+    ]
+);
+
+#[cfg(feature = "cpp_sort_telemetry")]
+ffi_telemetry_impl!(ips4o_parallel_unstable);
@@ -0,0 +1,191 @@
+//! Parallel ips4o that reuses the same thread pool and buffers across calls.
+
+use std::cmp::Ordering;
+use std::sync::Mutex;
+
+use once_cell::sync::OnceCell;
+
+#[repr(C)]
+struct Ips4oPoolFFI {
+    _private: [u8; 0],
+}
+
+extern "C" {
+    fn ips4o_pool_create(num_threads: usize) -> *mut Ips4oPoolFFI;
+    fn ips4o_pool_create_numa(num_threads: usize, placement: u32) -> *mut Ips4oPoolFFI;
+    fn ips4o_pool_create_placed(num_threads: usize, thread_placement: u32) -> *mut Ips4oPoolFFI;
+    fn ips4o_pool_destroy(pool: *mut Ips4oPoolFFI);
+    fn ips4o_pool_sort_i32(pool: *mut Ips4oPoolFFI, data: *mut i32, len: usize) -> u32;
+    fn ips4o_pool_sort_u64(pool: *mut Ips4oPoolFFI, data: *mut u64, len: usize) -> u32;
+}
+
+/// Where a NUMA aware pool puts the per-thread buffers and LocalData, relative to the node of the
+/// thread that uses them.
+#[derive(Copy, Clone, Debug, PartialEq, Eq)]
+pub enum NumaPlacement {
+    Local,
+    /// The next node over, to measure the cost of remote buffers. Same as `Local` on single node
+    /// machines.
+    Remote,
+}
+
+/// Which CPUs the threads of a pool run on, derived from the CPU topology in sysfs. Thread 0 is
+/// the thread that calls sort, it is only pinned while it sorts. Only supported on Linux,
+/// elsewhere all placements behave like `None`.
+#[derive(Copy, Clone, Debug, PartialEq, Eq)]
+pub enum ThreadPlacement {
+    /// Left to the scheduler.
+    None,
+    /// Fills the SMT siblings of a core, then the cores sharing a last level cache, then the
+    /// caches of a NUMA node before moving on to the next.
+    Compact,
+    /// Spreads consecutive threads across NUMA nodes, then last level caches, then cores. SMT
+    /// siblings are only used once every core has a thread.
+    Scatter,
+    /// One thread per physical core in compact order, SMT siblings only once every core has one.
+    PhysicalCores,
+    /// Spreads the threads evenly across the last level caches, the CCXs of AMD Zen, each
+    /// thread may run on any CPU of its cache.
+    PerCache,
+}
+
+impl ThreadPlacement {
+    pub const ALL: [ThreadPlacement; 5] = [
+        ThreadPlacement::None,
+        ThreadPlacement::Compact,
+        ThreadPlacement::Scatter,
+        ThreadPlacement::PhysicalCores,
+        ThreadPlacement::PerCache,
+    ];
+
+    pub fn name(self) -> &'static str {
+        match self {
+            ThreadPlacement::None => "none",
+            ThreadPlacement::Compact => "compact",
+            ThreadPlacement::Scatter => "scatter",
+            ThreadPlacement::PhysicalCores => "physical_cores",
+            ThreadPlacement::PerCache => "per_cache",
+        }
+    }
+
+    pub fn from_name(name: &str) -> Option<Self> {
+        Self::ALL.into_iter().find(|placement| placement.name() == name)
+    }
+}
+
+/// Owning handle to an ips4o thread pool. The worker threads and per-thread buffers live as long
+/// as the handle, which amortizes their setup cost across many sorts.
+pub struct Ips4oPool {
+    pool: *mut Ips4oPoolFFI,
+}
+
+// SAFETY: The pool can be used from any thread, just not concurrently, which `&mut self` ensures.
+unsafe impl Send for Ips4oPool {}
+
+impl Ips4oPool {
+    pub fn new(num_threads: usize) -> Self {
+        assert!(num_threads > 0);
+
+        // SAFETY: No preconditions.
+        let pool = unsafe { ips4o_pool_create(num_threads) };
+        assert!(!pool.is_null(), "Failed to create ips4o thread pool");
+
+        Self { pool }
+    }
+
+    /// Like `new`, but spreads the worker threads evenly across the NUMA nodes and pins them
+    /// there. Each thread's buffers are allocated on the node given by `placement`, with
+    /// transparent huge pages.
+    pub fn new_numa(num_threads: usize, placement: NumaPlacement) -> Self {
+        assert!(num_threads > 0);
+
+        let placement_id = match placement {
+            NumaPlacement::Local => 1,
+            NumaPlacement::Remote => 2,
+        };
+
+        // SAFETY: No preconditions.
+        let pool = unsafe { ips4o_pool_create_numa(num_threads, placement_id) };
+        assert!(!pool.is_null(), "Failed to create ips4o thread pool");
+
+        Self { pool }
+    }
+
+    /// Like `new`, but pins the threads according to `thread_placement`.
+    pub fn new_placed(num_threads: usize, thread_placement: ThreadPlacement) -> Self {
+        assert!(num_threads > 0);
+
+        let placement_id = match thread_placement {
+            ThreadPlacement::None => 0,
+            ThreadPlacement::Compact => 1,
+            ThreadPlacement::Scatter => 2,
+            ThreadPlacement::PhysicalCores => 3,
+            ThreadPlacement::PerCache => 4,
+        };
+
+        // SAFETY: No preconditions.
+        let pool = unsafe { ips4o_pool_create_placed(num_threads, placement_id) };
+        assert!(!pool.is_null(), "Failed to create ips4o thread pool");
+
+        Self { pool }
+    }
+
+    pub fn sort_i32(&mut self, data: &mut [i32]) {
+        // SAFETY: `self.pool` is valid for the lifetime of `self`.
+        let ret_code = unsafe { ips4o_pool_sort_i32(self.pool, data.as_mut_ptr(), data.len()) };
+        assert_eq!(ret_code, 0, "ips4o pool sort failed");
+    }
+
+    pub fn sort_u64(&mut self, data: &mut [u64]) {
+        // SAFETY: `self.pool` is valid for the lifetime of `self`.
+        let ret_code = unsafe { ips4o_pool_sort_u64(self.pool, data.as_mut_ptr(), data.len()) };
+        assert_eq!(ret_code, 0, "ips4o pool sort failed");
+    }
+}
+
+impl Drop for Ips4oPool {
+    fn drop(&mut self) {
+        // SAFETY: `self.pool` was created by `ips4o_pool_create` and is not used afterwards.
+        unsafe {
+            ips4o_pool_destroy(self.pool);
+        }
+    }
+}
+
+sort_impl!("cpp_ips4o_pool_unstable");
+
+fn global_pool() -> &'static Mutex<Ips4oPool> {
+    static POOL: OnceCell<Mutex<Ips4oPool>> = OnceCell::new();
+
+    POOL.get_or_init(|| Mutex::new(Ips4oPool::new(crate::ffi_util::num_threads())))
+}
+
+trait PoolSort: Sized {
+    fn sort(data: &mut [Self]);
+}
+
+impl<T> PoolSort for T {
+    default fn sort(_data: &mut [T]) {
+        panic!("Type not supported");
+    }
+}
+
+impl PoolSort for i32 {
+    fn sort(data: &mut [Self]) {
+        global_pool().lock().unwrap().sort_i32(data);
+    }
+}
+
+impl PoolSort for u64 {
+    fn sort(data: &mut [Self]) {
+        global_pool().lock().unwrap().sort_u64(data);
+    }
+}
+
+pub fn sort<T: Ord>(data: &mut [T]) {
+    PoolSort::sort(data);
+}
+
+pub fn sort_by<T, F: FnMut(&T, &T) -> Ordering>(_data: &mut [T], _compare: F) {
+    panic!("Type not supported");
+}
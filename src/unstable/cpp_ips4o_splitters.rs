@@ -0,0 +1,201 @@
+//! ips4o that reuses the top level splitters of an earlier sort for inputs of the same
+//! distribution, see ips4o_splitters.h. Saves the selection and sort of the sample, which ips4o
+//! otherwise repeats for every input. Every input is checked against the kept splitters with a
+//! small sample first, and sorted with a fresh sample if they no longer fit.
+
+/// Number of quantiles a set of splitters is made of, `ips4o_splitters::kQuantiles`.
+pub const QUANTILES: usize = 255;
+
+extern "C" {
+    #[cfg(feature = "cpp_ips4o")]
+    fn ips4o_unstable_i32_splitters(
+        data: *mut i32,
+        len: usize,
+        quantiles: *mut i32,
+        valid: bool,
+    ) -> u32;
+    #[cfg(feature = "cpp_ips4o")]
+    fn ips4o_unstable_u64_splitters(
+        data: *mut u64,
+        len: usize,
+        quantiles: *mut u64,
+        valid: bool,
+    ) -> u32;
+    #[cfg(feature = "cpp_ips4o_parallel")]
+    fn ips4o_parallel_unstable_i32_splitters(
+        data: *mut i32,
+        len: usize,
+        quantiles: *mut i32,
+        valid: bool,
+        num_threads: usize,
+    ) -> u32;
+    #[cfg(feature = "cpp_ips4o_parallel")]
+    fn ips4o_parallel_unstable_u64_splitters(
+        data: *mut u64,
+        len: usize,
+        quantiles: *mut u64,
+        valid: bool,
+        num_threads: usize,
+    ) -> u32;
+}
+
+/// How a sort with `Ips4oSplitters` picked its top level splitters.
+#[derive(Copy, Clone, Debug, PartialEq, Eq)]
+pub enum SplitterUse {
+    /// The kept splitters.
+    Reused,
+    /// A fresh sample, because there were no splitters yet or they didn't fit the input. The kept
+    /// splitters are now those of this input.
+    Resampled,
+    /// The input is too short for more than one partitioning step, it was sorted as usual and the
+    /// kept splitters are unchanged.
+    TooShort,
+}
+
+impl SplitterUse {
+    fn from_ffi(val: u32) -> Self {
+        match val {
+            0 => SplitterUse::Reused,
+            1 => SplitterUse::Resampled,
+            2 => SplitterUse::TooShort,
+            _ => panic!("Unknown splitter use {val}"),
+        }
+    }
+}
+
+/// Number of sorts per `SplitterUse`.
+#[derive(Copy, Clone, Debug, Default, PartialEq, Eq)]
+pub struct SplitterStats {
+    pub reused: u64,
+    pub resampled: u64,
+    pub too_short: u64,
+}
+
+/// Element types ips4o can reuse splitters for.
+pub trait SplitterElem: Copy + Default + sealed::Sealed {
+    #[doc(hidden)]
+    unsafe fn sort_splitters(data: &mut [Self], quantiles: *mut Self, valid: bool) -> u32;
+
+    #[doc(hidden)]
+    unsafe fn sort_parallel_splitters(
+        data: &mut [Self],
+        quantiles: *mut Self,
+        valid: bool,
+        num_threads: usize,
+    ) -> u32;
+}
+
+mod sealed {
+    pub trait Sealed {}
+
+    impl Sealed for i32 {}
+    impl Sealed for u64 {}
+}
+
+macro_rules! splitter_elem_impl {
+    ($type:ty, $sort:ident, $sort_parallel:ident) => {
+        impl SplitterElem for $type {
+            #[allow(unused_variables)]
+            unsafe fn sort_splitters(data: &mut [Self], quantiles: *mut Self, valid: bool) -> u32 {
+                #[cfg(feature = "cpp_ips4o")]
+                {
+                    $sort(data.as_mut_ptr(), data.len(), quantiles, valid)
+                }
+                #[cfg(not(feature = "cpp_ips4o"))]
+                panic!("Sequential ips4o requires the cpp_ips4o feature");
+            }
+
+            #[allow(unused_variables)]
+            unsafe fn sort_parallel_splitters(
+                data: &mut [Self],
+                quantiles: *mut Self,
+                valid: bool,
+                num_threads: usize,
+            ) -> u32 {
+                #[cfg(feature = "cpp_ips4o_parallel")]
+                {
+                    $sort_parallel(data.as_mut_ptr(), data.len(), quantiles, valid, num_threads)
+                }
+                #[cfg(not(feature = "cpp_ips4o_parallel"))]
+                panic!("Parallel ips4o requires the cpp_ips4o_parallel feature");
+            }
+        }
+    };
+}
+
+splitter_elem_impl!(
+    i32,
+    ips4o_unstable_i32_splitters,
+    ips4o_parallel_unstable_i32_splitters
+);
+splitter_elem_impl!(
+    u64,
+    ips4o_unstable_u64_splitters,
+    ips4o_parallel_unstable_u64_splitters
+);
+
+/// The top level splitters of ips4o, kept across sorts. The first sort of an input long enough
+/// samples as usual and keeps the splitters, the following ones reuse them as long as they fit.
+/// The same splitters can be used by the sequential and the parallel sort.
+pub struct Ips4oSplitters<T: SplitterElem> {
+    quantiles: Vec<T>,
+    valid: bool,
+    stats: SplitterStats,
+}
+
+impl<T: SplitterElem> Ips4oSplitters<T> {
+    pub fn new() -> Self {
+        Self {
+            quantiles: vec![T::default(); QUANTILES],
+            valid: false,
+            stats: SplitterStats::default(),
+        }
+    }
+
+    /// Sorts `data` with sequential ips4o.
+    pub fn sort(&mut self, data: &mut [T]) -> SplitterUse {
+        // SAFETY: quantiles holds QUANTILES elements, only read if valid.
+        let use_val = unsafe { T::sort_splitters(data, self.quantiles.as_mut_ptr(), self.valid) };
+        self.record(SplitterUse::from_ffi(use_val))
+    }
+
+    /// Sorts `data` with parallel ips4o, on as many threads as `cpp_ips4o_parallel_unstable`.
+    pub fn sort_parallel(&mut self, data: &mut [T]) -> SplitterUse {
+        let num_threads =
+            crate::ffi_util::num_threads_for::<T>("cpp_ips4o_parallel_unstable", data.len());
+
+        // SAFETY: quantiles holds QUANTILES elements, only read if valid.
+        let use_val = unsafe {
+            T::sort_parallel_splitters(data, self.quantiles.as_mut_ptr(), self.valid, num_threads)
+        };
+        self.record(SplitterUse::from_ffi(use_val))
+    }
+
+    /// Forgets the splitters, the next sort samples again.
+    pub fn clear(&mut self) {
+        self.valid = false;
+    }
+
+    pub fn stats(&self) -> SplitterStats {
+        self.stats
+    }
+
+    fn record(&mut self, splitter_use: SplitterUse) -> SplitterUse {
+        match splitter_use {
+            SplitterUse::Reused => self.stats.reused += 1,
+            SplitterUse::Resampled => {
+                self.valid = true;
+                self.stats.resampled += 1;
+            }
+            SplitterUse::TooShort => self.stats.too_short += 1,
+        }
+
+        splitter_use
+    }
+}
+
+impl<T: SplitterElem> Default for Ips4oSplitters<T> {
+    fn default() -> Self {
+        Self::new()
+    }
+}
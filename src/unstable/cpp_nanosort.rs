@@ -1 +1,2 @@
 ffi_sort_impl!("cpp_nanosort_unstable", nanosort_unstable);
+ffi_sort_by_nothrow_impl!(nanosort_unstable);
@@ -0,0 +1 @@
+ffi_sort_impl!("cpp_nanosort_fat_unstable", nanosort_fat_unstable);
@@ -1 +1,15 @@
 ffi_sort_impl!("cpp_pdqsort_unstable", pdqsort_unstable);
+ffi_sort_by_key_impl!(pdqsort_unstable);
+ffi_sort_16bit_impl!(pdqsort_unstable);
+ffi_sort_float_impl!(pdqsort_unstable);
+ffi_sort_arena_string_impl!(pdqsort_unstable);
+ffi_sort_batch_impl!(pdqsort_unstable);
+ffi_run_accumulator_impl!(pdqsort_unstable);
+ffi_sort_partial_impl!(pdqsort_unstable);
+ffi_sort_unique_impl!(pdqsort_unstable);
+ffi_sort_counted_impl!(pdqsort_unstable);
+ffi_sort_indirect_impl!(pdqsort_unstable);
+ffi_sort_lazy_impl!(pdqsort_unstable);
+
+#[cfg(feature = "cpp_sort_telemetry")]
+ffi_telemetry_impl!(pdqsort_unstable);
@@ -0,0 +1,6 @@
+ffi_sort_impl!(
+    "cpp_pdqsort_branchless_unstable",
+    pdqsort_branchless_unstable
+);
+ffi_sort_16bit_impl!(pdqsort_branchless_unstable);
+ffi_sort_float_impl!(pdqsort_branchless_unstable);
@@ -0,0 +1,3 @@
+ffi_sort_impl!("cpp_pdqsort_lomcyc_unstable", pdqsort_lomcyc_unstable);
+ffi_sort_16bit_impl!(pdqsort_lomcyc_unstable);
+ffi_sort_float_impl!(pdqsort_lomcyc_unstable);
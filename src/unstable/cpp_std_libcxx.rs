@@ -1 +1,9 @@
 ffi_sort_impl!("cpp_std_libcxx_unstable", sort_unstable_libcxx);
+ffi_sort_by_key_impl!(sort_unstable_libcxx);
+ffi_sort_float_impl!(sort_unstable_libcxx);
+ffi_sort_arena_string_impl!(sort_unstable_libcxx);
+ffi_sort_batch_impl!(sort_unstable_libcxx);
+ffi_sort_partial_impl!(sort_unstable_libcxx);
+ffi_select_nth_impl!(sort_unstable_libcxx);
+ffi_sort_counted_impl!(sort_unstable_libcxx);
+ffi_sort_indirect_impl!(sort_unstable_libcxx);
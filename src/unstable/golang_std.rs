@@ -1 +1,2 @@
 ffi_sort_impl!("golang_std_unstable", golang_std_unstable);
+ffi_sort_by_key_impl!(golang_std_unstable);
@@ -1,6 +1,9 @@
 pub mod rust_ipnsort;
 pub mod rust_std;
 
+#[cfg(feature = "rust_ipnsort_parallel")]
+pub mod rust_ipnsort_parallel;
+
 #[cfg(feature = "rust_dmsort")]
 pub mod rust_dmsort;
 
@@ -17,26 +20,89 @@ pub mod rust_introsort;
 #[cfg(feature = "cpp_pdqsort")]
 pub mod cpp_pdqsort;
 
+// Call pdqsort with the branchy partition forced via FFI.
+#[cfg(feature = "cpp_pdqsort")]
+pub mod cpp_pdqsort_branchy;
+
+// Call pdqsort with the branchless partition forced via FFI.
+#[cfg(feature = "cpp_pdqsort")]
+pub mod cpp_pdqsort_branchless;
+
+// Call pdqsort with the lomcyc partition of lomcyc_partition.h via FFI.
+#[cfg(feature = "cpp_pdqsort")]
+pub mod cpp_pdqsort_lomcyc;
+
+// Call the sampling front-end that routes to the best enabled backend via FFI.
+#[cfg(feature = "cpp_adaptive")]
+pub mod cpp_adaptive;
+
 // Call ips4o sort via FFI.
 #[cfg(feature = "cpp_ips4o")]
 pub mod cpp_ips4o;
 
+// Call parallel ips4o sort via FFI.
+#[cfg(feature = "cpp_ips4o_parallel")]
+pub mod cpp_ips4o_parallel;
+
+// Call parallel ips4o sort with a persistent thread pool via FFI.
+#[cfg(feature = "cpp_ips4o_parallel")]
+pub mod cpp_ips4o_pool;
+
+// Submit parallel ips4o sorts to a persistent thread pool and await them, via FFI.
+#[cfg(feature = "cpp_ips4o_parallel")]
+pub mod cpp_ips4o_async;
+
+// Call sequential or parallel ips4o with the top level splitters of an earlier sort via FFI.
+#[cfg(any(feature = "cpp_ips4o", feature = "cpp_ips4o_parallel"))]
+pub mod cpp_ips4o_splitters;
+
 // Call blockquicksort sort via FFI.
 #[cfg(feature = "cpp_blockquicksort")]
 pub mod cpp_blockquicksort;
 
+// Call blockquicksort with the plain block partition and a median-of-3 pivot via FFI.
+#[cfg(feature = "cpp_blockquicksort")]
+pub mod cpp_blockquicksort_simple;
+
+// Call blockquicksort with the unrolled block partition and a median-of-3 pivot via FFI.
+#[cfg(feature = "cpp_blockquicksort")]
+pub mod cpp_blockquicksort_mo3;
+
+// Call blockquicksort with a median-of-sqrt(n) pivot, without the duplicate check via FFI.
+#[cfg(feature = "cpp_blockquicksort")]
+pub mod cpp_blockquicksort_mosqrt;
+
+// Call blockquicksort with two pivots and a three way block partition via FFI.
+#[cfg(feature = "cpp_blockquicksort")]
+pub mod cpp_blockquicksort_dual_pivot;
+
+// Call blockquicksort with a median-of-3 pivot and the duplicate check via FFI.
+#[cfg(feature = "cpp_blockquicksort")]
+pub mod cpp_blockquicksort_mo3_check;
+
 // Call gerbens quicksort sort via FFI.
 #[cfg(feature = "cpp_gerbens_qsort")]
 pub mod cpp_gerbens_qsort;
 
+// Call gerbens quicksort with the equal element handling of pdqsort via FFI.
+#[cfg(feature = "cpp_gerbens_qsort")]
+pub mod cpp_gerbens_qsort_fat;
+
 // Call nanosort via FFI.
 #[cfg(feature = "cpp_nanosort")]
 pub mod cpp_nanosort;
 
+// Call nanosort with the equal element handling of pdqsort via FFI.
+#[cfg(feature = "cpp_nanosort")]
+pub mod cpp_nanosort_fat;
+
 // Call qsort sort via FFI.
 #[cfg(feature = "c_std_sys")]
 pub mod c_std_sys;
 
+#[cfg(feature = "c_fast_qsort")]
+pub mod c_fast_qsort;
+
 // Call crumsort sort via FFI.
 #[cfg(feature = "c_crumsort")]
 pub mod c_crumsort;
@@ -56,3 +122,7 @@ pub mod cpp_std_gcc4_3;
 // Call golang slices.Sort
 #[cfg(feature = "golang_std")]
 pub mod golang_std;
+
+// Call a goroutine parallel sample sort, with slices.Sort or slices.SortFunc for the buckets.
+#[cfg(feature = "golang_std")]
+pub mod golang_std_parallel;
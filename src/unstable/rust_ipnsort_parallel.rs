@@ -0,0 +1,42 @@
+use std::cmp::Ordering;
+
+const NAME: &str = "rust_ipnsort_parallel_unstable";
+
+sort_impl!(NAME);
+
+pub fn sort<T: Ord>(data: &mut [T]) {
+    <T as ParallelSort>::sort(data);
+}
+
+pub fn sort_by<T, F: FnMut(&T, &T) -> Ordering>(data: &mut [T], compare: F) {
+    // A FnMut comparison function can't be shared between threads.
+    ipnsort::sort_by(data, compare);
+}
+
+/// Same as `sort_by`, but shares `compare` between the threads, the same way `sort` does.
+pub fn par_sort_by<T, F>(data: &mut [T], compare: F)
+where
+    T: Send + Sync,
+    F: Fn(&T, &T) -> Ordering + Sync,
+{
+    let num_threads = crate::ffi_util::num_threads_for::<T>(NAME, data.len());
+    ipnsort::par_sort_by(data, compare, num_threads);
+}
+
+/// Types that can't be shared between threads are sorted sequentially.
+trait ParallelSort: Sized {
+    fn sort(data: &mut [Self]);
+}
+
+impl<T: Ord> ParallelSort for T {
+    default fn sort(data: &mut [Self]) {
+        ipnsort::sort(data);
+    }
+}
+
+impl<T: Ord + Send + Sync> ParallelSort for T {
+    fn sort(data: &mut [Self]) {
+        let num_threads = crate::ffi_util::num_threads_for::<T>(NAME, data.len());
+        ipnsort::par_sort(data, num_threads);
+    }
+}
@@ -3,3 +3,2056 @@ use sort_test_tools::instantiate_sort_tests;
 type TestSort = sort_research_rs::unstable::rust_ipnsort::SortImpl;
 
 instantiate_sort_tests!(TestSort);
+
+/// Parallel sorts only split their input with more than one thread, raise the thread count so
+/// their tests cover that on small machines too. Every caller asks for the same count, so it
+/// doesn't matter which test gets there first.
+#[allow(dead_code)]
+fn use_at_least_4_threads() {
+    let num_threads = sort_research_rs::ffi_util::num_threads();
+    sort_research_rs::ffi_util::set_num_threads(num_threads.max(4));
+}
+
+#[cfg(feature = "cpp_vqsort")]
+mod cpp_vqsort {
+    use sort_research_rs::other::cpp_vqsort;
+
+    #[test]
+    fn random_type_u128() {
+        sort_test_tools::tests::random_type_u128::<cpp_vqsort::SortImpl>();
+    }
+
+    #[test]
+    fn random_type_f32() {
+        sort_test_tools::tests::random_type_f32::<cpp_vqsort::SortImpl>();
+    }
+
+    #[test]
+    fn random_type_f64() {
+        sort_test_tools::tests::random_type_f64::<cpp_vqsort::SortImpl>();
+    }
+
+    #[test]
+    fn random_type_i16() {
+        sort_test_tools::tests::random_type_i16::<cpp_vqsort::SortImpl>();
+    }
+
+    #[test]
+    fn random_type_u16() {
+        sort_test_tools::tests::random_type_u16::<cpp_vqsort::SortImpl>();
+    }
+
+    #[test]
+    fn sort_descending_i32() {
+        sort_test_tools::tests::sort_descending_i32(cpp_vqsort::sort_descending);
+    }
+
+    #[test]
+    fn sort_descending_u64() {
+        sort_test_tools::tests::sort_descending_u64(cpp_vqsort::sort_descending);
+    }
+
+    #[test]
+    fn sort_descending_u128() {
+        sort_test_tools::tests::sort_descending_u128(cpp_vqsort::sort_descending);
+    }
+
+    #[test]
+    fn sort_batch_u64() {
+        sort_test_tools::tests::sort_batch_u64(cpp_vqsort::sort_batch);
+    }
+
+    #[test]
+    fn run_accumulator_u64() {
+        sort_test_tools::tests::run_accumulator_u64(
+            cpp_vqsort::RunAccumulator::new,
+            cpp_vqsort::RunAccumulator::append,
+            cpp_vqsort::RunAccumulator::copy_in_order,
+            |acc| acc.finalize().to_vec(),
+        );
+    }
+
+    #[test]
+    fn select_nth_unstable_i32() {
+        sort_test_tools::tests::select_nth_unstable_i32(cpp_vqsort::select_nth_unstable);
+    }
+    #[test]
+    fn sort_decorated_f128() {
+        sort_test_tools::tests::sort_decorated_f128(cpp_vqsort::sort_decorated);
+    }
+
+    #[test]
+    fn sort_decorated_1k() {
+        sort_test_tools::tests::sort_decorated_1k(cpp_vqsort::sort_decorated);
+    }
+
+    #[test]
+    fn sort_columns() {
+        sort_test_tools::tests::sort_columns(cpp_vqsort::sort_columns);
+    }
+
+    #[test]
+    fn sort_packed() {
+        sort_test_tools::tests::sort_packed_key_payload_u32(cpp_vqsort::sort_packed);
+        sort_test_tools::tests::sort_packed_key_payload_u64(cpp_vqsort::sort_packed);
+    }
+
+    #[test]
+    fn sort_kv_u64() {
+        use cpp_vqsort::K64V64;
+
+        sort_test_tools::tests::sort_with_payload_unstable_u64(|keys, payload| {
+            let mut data = keys
+                .iter()
+                .zip(payload.iter())
+                .map(|(&key, &value)| K64V64::new(key, value))
+                .collect::<Vec<_>>();
+
+            cpp_vqsort::sort_kv_u64(&mut data);
+
+            for (i, kv) in data.into_iter().enumerate() {
+                keys[i] = kv.key;
+                payload[i] = kv.value;
+            }
+        });
+    }
+
+    #[test]
+    fn argsort_i32() {
+        sort_test_tools::tests::argsort_i32(cpp_vqsort::argsort_i32);
+    }
+
+    #[test]
+    fn argsort_u64() {
+        sort_test_tools::tests::argsort_u64(cpp_vqsort::argsort_u64);
+    }
+}
+
+#[cfg(feature = "cpp_vqsort")]
+mod cpp_vqsort_stable {
+    use sort_research_rs::stable::cpp_vqsort_stable;
+
+    #[test]
+    fn random_d4() {
+        sort_test_tools::tests::random_d4::<cpp_vqsort_stable::SortImpl>();
+    }
+
+    #[test]
+    fn saw_mixed() {
+        sort_test_tools::tests::saw_mixed::<cpp_vqsort_stable::SortImpl>();
+    }
+
+    #[test]
+    fn int_edge() {
+        sort_test_tools::tests::int_edge::<cpp_vqsort_stable::SortImpl>();
+    }
+
+    #[test]
+    fn sort_with_payload_u64() {
+        sort_test_tools::tests::sort_with_payload_u64(cpp_vqsort_stable::sort_with_payload_u64);
+    }
+}
+
+#[cfg(feature = "cpp_intel_avx512")]
+mod cpp_intel_avx512 {
+    use sort_research_rs::other::cpp_intel_avx512;
+
+    #[test]
+    fn random_type_f32() {
+        sort_test_tools::tests::random_type_f32::<cpp_intel_avx512::SortImpl>();
+    }
+
+    #[test]
+    fn random_type_f64() {
+        sort_test_tools::tests::random_type_f64::<cpp_intel_avx512::SortImpl>();
+    }
+
+    #[test]
+    fn random_type_i16() {
+        sort_test_tools::tests::random_type_i16::<cpp_intel_avx512::SortImpl>();
+        sort_test_tools::tests::sort_fn_i16(cpp_intel_avx512::sort_i16_fallback);
+    }
+
+    #[test]
+    fn random_type_u16() {
+        sort_test_tools::tests::random_type_u16::<cpp_intel_avx512::SortImpl>();
+        sort_test_tools::tests::sort_fn_u16(cpp_intel_avx512::sort_u16_fallback);
+    }
+
+    #[test]
+    fn sort_descending_i32() {
+        sort_test_tools::tests::sort_descending_i32(cpp_intel_avx512::sort_descending);
+    }
+
+    #[test]
+    fn sort_descending_u64() {
+        sort_test_tools::tests::sort_descending_u64(cpp_intel_avx512::sort_descending);
+    }
+
+    #[test]
+    fn sort_batch_u64() {
+        sort_test_tools::tests::sort_batch_u64(cpp_intel_avx512::sort_batch);
+    }
+
+    #[test]
+    fn select_nth_unstable_i32() {
+        sort_test_tools::tests::select_nth_unstable_i32(cpp_intel_avx512::select_nth_unstable);
+    }
+
+    #[test]
+    fn sort_with_payload_unstable_u64() {
+        sort_test_tools::tests::sort_with_payload_unstable_u64(
+            cpp_intel_avx512::sort_with_payload_u64,
+        );
+    }
+
+    #[test]
+    fn sort_packed() {
+        sort_test_tools::tests::sort_packed_key_payload_u32(cpp_intel_avx512::sort_packed);
+    }
+}
+
+#[cfg(feature = "cpp_simdsort")]
+mod cpp_simdsort {
+    use sort_research_rs::other::cpp_simdsort;
+
+    #[test]
+    fn random_type_u64() {
+        sort_test_tools::tests::random_type_u64::<cpp_simdsort::SortImpl>();
+    }
+
+    #[test]
+    fn random_type_f32() {
+        sort_test_tools::tests::random_type_f32::<cpp_simdsort::SortImpl>();
+    }
+}
+
+#[cfg(feature = "cpp_radix")]
+mod cpp_radix {
+    use sort_research_rs::other::cpp_radix;
+
+    #[test]
+    fn random() {
+        sort_test_tools::tests::random::<cpp_radix::SortImpl>();
+    }
+
+    #[test]
+    fn random_type_u64() {
+        sort_test_tools::tests::random_type_u64::<cpp_radix::SortImpl>();
+    }
+
+    #[test]
+    fn random_ffi_str() {
+        sort_test_tools::tests::random_ffi_str::<cpp_radix::SortImpl>();
+    }
+
+    #[test]
+    fn random_d4() {
+        sort_test_tools::tests::random_d4::<cpp_radix::SortImpl>();
+    }
+
+    #[test]
+    fn random_z1() {
+        sort_test_tools::tests::random_z1::<cpp_radix::SortImpl>();
+    }
+
+    #[test]
+    fn saw_mixed() {
+        sort_test_tools::tests::saw_mixed::<cpp_radix::SortImpl>();
+    }
+
+    #[test]
+    fn int_edge() {
+        sort_test_tools::tests::int_edge::<cpp_radix::SortImpl>();
+    }
+
+    #[test]
+    fn sort_with_payload_u64() {
+        sort_test_tools::tests::sort_with_payload_u64(cpp_radix::sort_with_payload_u64);
+    }
+    #[test]
+    fn sort_decorated_f128() {
+        sort_test_tools::tests::sort_decorated_f128(cpp_radix::sort_decorated);
+    }
+
+    #[test]
+    fn sort_decorated_1k() {
+        sort_test_tools::tests::sort_decorated_1k(cpp_radix::sort_decorated);
+    }
+
+    #[test]
+    fn sort_columns() {
+        sort_test_tools::tests::sort_columns(cpp_radix::sort_columns);
+    }
+
+    #[test]
+    fn encode_columns_u64() {
+        sort_test_tools::tests::encode_columns(cpp_radix::encode_columns_u64);
+    }
+
+    #[test]
+    fn encode_columns_u128() {
+        sort_test_tools::tests::encode_columns(cpp_radix::encode_columns_u128);
+    }
+
+    #[test]
+    fn encode_columns_bytes() {
+        sort_test_tools::tests::encode_columns(|columns| {
+            let (keys, key_bytes, exact_columns) = cpp_radix::encode_columns_bytes(columns, 3);
+            let keys = keys
+                .chunks(key_bytes.max(1))
+                .map(|key| key.to_vec())
+                .collect::<Vec<_>>();
+            (keys, exact_columns)
+        });
+    }
+}
+
+#[cfg(feature = "cpp_radix")]
+mod cpp_radix_parallel {
+    use sort_research_rs::other::cpp_radix_parallel;
+
+    #[test]
+    fn random_ffi_str() {
+        sort_test_tools::tests::random_ffi_str::<cpp_radix_parallel::SortImpl>();
+    }
+
+    #[test]
+    fn url_like_ffi_str() {
+        sort_test_tools::tests::url_like_ffi_str::<cpp_radix_parallel::SortImpl>();
+    }
+}
+
+#[cfg(feature = "cpp_gpu_sort")]
+mod cpp_gpu_sort {
+    use sort_research_rs::other::cpp_gpu_sort;
+
+    #[test]
+    fn random() {
+        sort_test_tools::tests::random::<cpp_gpu_sort::SortImpl>();
+    }
+
+    #[test]
+    fn random_type_u64() {
+        sort_test_tools::tests::random_type_u64::<cpp_gpu_sort::SortImpl>();
+    }
+
+    #[test]
+    fn random_d4() {
+        sort_test_tools::tests::random_d4::<cpp_gpu_sort::SortImpl>();
+    }
+
+    #[test]
+    fn int_edge() {
+        sort_test_tools::tests::int_edge::<cpp_gpu_sort::SortImpl>();
+    }
+
+    #[test]
+    fn sort_with_payload_u64() {
+        sort_test_tools::tests::sort_with_payload_u64(cpp_gpu_sort::sort_with_payload_u64);
+    }
+}
+
+#[cfg(feature = "cpp_ips4o_parallel")]
+mod cpp_ips4o_parallel {
+    use sort_research_rs::unstable::cpp_ips4o_parallel;
+
+    #[test]
+    fn sort_batch_u64() {
+        sort_test_tools::tests::sort_batch_u64(cpp_ips4o_parallel::sort_batch);
+    }
+
+    #[test]
+    fn sort_batch_skewed_u64() {
+        sort_test_tools::tests::sort_batch_skewed_u64(cpp_ips4o_parallel::sort_batch);
+    }
+
+    #[test]
+    fn async_submit_u64() {
+        use sort_research_rs::unstable::cpp_ips4o_async::Ips4oAsync;
+        use sort_test_tools::patterns;
+
+        let async_pool = Ips4oAsync::new(4);
+
+        // Several jobs in flight at once, including ones too short to be sorted in parallel.
+        let inputs: Vec<Vec<u64>> = [0, 1, 20, 1_000, 100_000, 1_000_000]
+            .into_iter()
+            .map(|len| {
+                patterns::random(len)
+                    .into_iter()
+                    .map(|val| val as u64)
+                    .collect()
+            })
+            .collect();
+        let jobs: Vec<_> = inputs
+            .iter()
+            .map(|input| async_pool.submit(input.clone()))
+            .collect();
+
+        for (job, input) in jobs.into_iter().zip(inputs) {
+            let mut expected = input;
+            expected.sort();
+            assert_eq!(job.wait(), expected);
+        }
+
+        // Dropped without waiting, must not outlive the data.
+        let _ = async_pool.submit(patterns::random(100_000));
+    }
+
+    #[test]
+    fn placed_pool_u64() {
+        use sort_research_rs::unstable::cpp_ips4o_pool::{Ips4oPool, ThreadPlacement};
+        use sort_test_tools::patterns;
+
+        // More threads than most test machines have CPUs, so placements wrap around.
+        for placement in ThreadPlacement::ALL {
+            let mut pool = Ips4oPool::new_placed(6, placement);
+
+            for len in [0, 1, 1_000, 1_000_000] {
+                let mut data: Vec<u64> =
+                    patterns::random(len).into_iter().map(|val| val as u64).collect();
+                let mut expected = data.clone();
+                expected.sort();
+
+                pool.sort_u64(&mut data);
+                assert_eq!(data, expected, "{placement:?}");
+            }
+        }
+    }
+}
+
+#[cfg(feature = "cpp_std_sys")]
+mod cpp_std_sys {
+    use sort_research_rs::stable;
+    use sort_research_rs::unstable::cpp_std_sys;
+
+    #[test]
+    fn random_arena_str() {
+        sort_test_tools::tests::random_arena_str::<cpp_std_sys::SortImpl>();
+    }
+
+    #[test]
+    fn random_type_f32() {
+        sort_test_tools::tests::random_type_f32::<cpp_std_sys::SortImpl>();
+    }
+
+    #[test]
+    fn random_type_f64() {
+        sort_test_tools::tests::random_type_f64::<cpp_std_sys::SortImpl>();
+    }
+
+    #[test]
+    fn partial_sort_i32() {
+        sort_test_tools::tests::partial_sort_i32(cpp_std_sys::partial_sort);
+    }
+
+    #[test]
+    fn select_nth_unstable_i32() {
+        sort_test_tools::tests::select_nth_unstable_i32(cpp_std_sys::select_nth_unstable);
+    }
+
+    #[test]
+    fn sort_indirect_1k() {
+        sort_test_tools::tests::sort_indirect_1k(cpp_std_sys::sort_indirect);
+    }
+
+    #[test]
+    fn sort_indirect_stable_1k() {
+        sort_test_tools::tests::sort_indirect_1k(stable::cpp_std_sys::sort_indirect);
+    }
+
+    #[test]
+    fn sort_by_known_key_u64() {
+        sort_test_tools::tests::sort_by_known_key_u64(false, cpp_std_sys::sort_by_known_key);
+    }
+
+    #[test]
+    fn sort_by_known_key_stable_u64() {
+        sort_test_tools::tests::sort_by_known_key_u64(true, stable::cpp_std_sys::sort_by_known_key);
+    }
+
+    #[test]
+    fn sort_batch_u64() {
+        sort_test_tools::tests::sort_batch_u64(cpp_std_sys::sort_batch);
+    }
+
+    #[test]
+    fn sort_batch_skewed_u64() {
+        sort_test_tools::tests::sort_batch_skewed_u64(cpp_std_sys::sort_batch);
+    }
+
+    #[test]
+    fn sort_batch_offsets_u64() {
+        sort_test_tools::tests::sort_batch_offsets_u64(cpp_std_sys::sort_batch);
+    }
+
+    // std::stable_sort ignores the buffer.
+    #[test]
+    fn sort_with_buf_stable_i32() {
+        sort_test_tools::tests::sort_with_buf_i32(stable::cpp_std_sys::sort_with_buf, |len| len);
+    }
+
+    #[test]
+    fn sort_with_buf_stable_u64() {
+        sort_test_tools::tests::sort_with_buf_u64(stable::cpp_std_sys::sort_with_buf, |len| len);
+    }
+
+    #[test]
+    fn sort_counted() {
+        sort_test_tools::tests::sort_counted_i32(cpp_std_sys::sort_counted);
+        sort_test_tools::tests::sort_counted_u64(cpp_std_sys::sort_counted);
+        sort_test_tools::tests::sort_counted_1k(cpp_std_sys::sort_counted);
+    }
+
+    #[test]
+    fn sort_counted_stable() {
+        sort_test_tools::tests::sort_counted_i32(stable::cpp_std_sys::sort_counted);
+        sort_test_tools::tests::sort_counted_u64(stable::cpp_std_sys::sort_counted);
+        sort_test_tools::tests::sort_counted_1k(stable::cpp_std_sys::sort_counted);
+    }
+}
+
+#[cfg(feature = "cpp_std_libcxx")]
+mod cpp_std_libcxx {
+    use sort_research_rs::stable::cpp_std_libcxx;
+
+    // std::stable_sort ignores the buffer.
+    #[test]
+    fn sort_with_buf_i32() {
+        sort_test_tools::tests::sort_with_buf_i32(cpp_std_libcxx::sort_with_buf, |len| len);
+    }
+
+    #[test]
+    fn sort_with_buf_u64() {
+        sort_test_tools::tests::sort_with_buf_u64(cpp_std_libcxx::sort_with_buf, |len| len);
+    }
+}
+
+#[cfg(feature = "cpp_std_gcc4_3")]
+mod cpp_std_gcc4_3 {
+    use sort_research_rs::stable::cpp_std_gcc4_3;
+
+    // std::stable_sort ignores the buffer.
+    #[test]
+    fn sort_with_buf_i32() {
+        sort_test_tools::tests::sort_with_buf_i32(cpp_std_gcc4_3::sort_with_buf, |len| len);
+    }
+
+    #[test]
+    fn sort_with_buf_u64() {
+        sort_test_tools::tests::sort_with_buf_u64(cpp_std_gcc4_3::sort_with_buf, |len| len);
+    }
+}
+
+#[cfg(feature = "cpp_pdqsort")]
+mod cpp_pdqsort {
+    use sort_research_rs::unstable::cpp_pdqsort;
+
+    #[test]
+    fn random_arena_str() {
+        sort_test_tools::tests::random_arena_str::<cpp_pdqsort::SortImpl>();
+    }
+
+    #[test]
+    fn random_type_f32() {
+        sort_test_tools::tests::random_type_f32::<cpp_pdqsort::SortImpl>();
+    }
+
+    #[test]
+    fn random_type_f64() {
+        sort_test_tools::tests::random_type_f64::<cpp_pdqsort::SortImpl>();
+    }
+
+    #[test]
+    fn random_type_i16() {
+        sort_test_tools::tests::random_type_i16::<cpp_pdqsort::SortImpl>();
+    }
+
+    #[test]
+    fn random_type_u16() {
+        sort_test_tools::tests::random_type_u16::<cpp_pdqsort::SortImpl>();
+    }
+
+    #[test]
+    fn partial_sort_i32() {
+        sort_test_tools::tests::partial_sort_i32(cpp_pdqsort::partial_sort);
+    }
+
+    #[test]
+    fn sort_lazy_i32() {
+        sort_test_tools::tests::sort_lazy_i32(|data, k| {
+            cpp_pdqsort::sort_lazy(data).take(k).copied().collect()
+        });
+    }
+
+    #[test]
+    fn sort_unique_i32() {
+        sort_test_tools::tests::sort_unique_i32(cpp_pdqsort::sort_unique);
+    }
+
+    #[test]
+    fn sort_unique_ffi_str() {
+        sort_test_tools::tests::sort_unique_ffi_str(cpp_pdqsort::sort_unique);
+    }
+
+    #[test]
+    fn sort_count_runs_u64() {
+        sort_test_tools::tests::sort_count_runs_u64(cpp_pdqsort::sort_count_runs);
+    }
+
+    #[test]
+    fn run_accumulator_u64() {
+        sort_test_tools::tests::run_accumulator_u64(
+            cpp_pdqsort::RunAccumulator::new,
+            cpp_pdqsort::RunAccumulator::append,
+            cpp_pdqsort::RunAccumulator::copy_in_order,
+            |acc| acc.finalize().to_vec(),
+        );
+    }
+
+    #[test]
+    fn sort_indirect_1k() {
+        sort_test_tools::tests::sort_indirect_1k(cpp_pdqsort::sort_indirect);
+    }
+
+    #[test]
+    fn sort_by_known_key_u64() {
+        sort_test_tools::tests::sort_by_known_key_u64(false, cpp_pdqsort::sort_by_known_key);
+    }
+
+    #[test]
+    fn sort_batch_u64() {
+        sort_test_tools::tests::sort_batch_u64(cpp_pdqsort::sort_batch);
+    }
+
+    #[test]
+    fn sort_batch_skewed_u64() {
+        sort_test_tools::tests::sort_batch_skewed_u64(cpp_pdqsort::sort_batch);
+    }
+
+    #[test]
+    fn sort_batch_offsets_u64() {
+        sort_test_tools::tests::sort_batch_offsets_u64(cpp_pdqsort::sort_batch);
+    }
+
+    #[test]
+    fn sort_counted() {
+        sort_test_tools::tests::sort_counted_i32(cpp_pdqsort::sort_counted);
+        sort_test_tools::tests::sort_counted_u64(cpp_pdqsort::sort_counted);
+        sort_test_tools::tests::sort_counted_1k(cpp_pdqsort::sort_counted);
+    }
+}
+
+#[cfg(feature = "cpp_pdqsort")]
+mod cpp_pdqsort_branchless {
+    use sort_research_rs::unstable::cpp_pdqsort_branchless;
+
+    #[test]
+    fn random_type_u64() {
+        sort_test_tools::tests::random_type_u64::<cpp_pdqsort_branchless::SortImpl>();
+    }
+
+    #[test]
+    fn random_f128() {
+        sort_test_tools::tests::random_f128::<cpp_pdqsort_branchless::SortImpl>();
+    }
+
+    #[test]
+    fn random_type_f64() {
+        sort_test_tools::tests::random_type_f64::<cpp_pdqsort_branchless::SortImpl>();
+    }
+
+    #[test]
+    fn comp_panic() {
+        sort_test_tools::tests::comp_panic::<cpp_pdqsort_branchless::SortImpl>();
+    }
+}
+
+#[cfg(feature = "cpp_pdqsort")]
+mod cpp_pdqsort_lomcyc {
+    use sort_research_rs::unstable::cpp_pdqsort_lomcyc::SortImpl;
+
+    sort_test_tools::instantiate_sort_test_impl!(
+        SortImpl,
+        [miri_yes, random],
+        [miri_yes, random_type_u64],
+        [miri_yes, random_d4],
+        [miri_yes, random_ffi_str],
+        [miri_yes, random_f128],
+        [miri_yes, saw_mixed],
+        [miri_yes, comp_panic],
+        [miri_yes, sort_vs_sort_by]
+    );
+}
+
+#[cfg(feature = "cpp_pdqsort")]
+mod cpp_pdqsort_branchy {
+    use sort_research_rs::unstable::cpp_pdqsort_branchy;
+
+    #[test]
+    fn random_type_u64() {
+        sort_test_tools::tests::random_type_u64::<cpp_pdqsort_branchy::SortImpl>();
+    }
+
+    #[test]
+    fn random_type_f32() {
+        sort_test_tools::tests::random_type_f32::<cpp_pdqsort_branchy::SortImpl>();
+    }
+}
+
+#[cfg(feature = "cpp_blockquicksort")]
+mod cpp_blockquicksort_simple {
+    use sort_research_rs::unstable::cpp_blockquicksort_simple::SortImpl;
+
+    sort_test_tools::instantiate_sort_test_impl!(
+        SortImpl,
+        [miri_yes, random],
+        [miri_yes, random_type_u64],
+        [miri_yes, random_d4],
+        [miri_yes, random_ffi_str],
+        [miri_yes, random_f128],
+        [miri_yes, saw_mixed],
+        [miri_yes, sort_vs_sort_by]
+    );
+}
+
+#[cfg(feature = "cpp_blockquicksort")]
+mod cpp_blockquicksort_mo3 {
+    use sort_research_rs::unstable::cpp_blockquicksort_mo3::SortImpl;
+
+    sort_test_tools::instantiate_sort_test_impl!(
+        SortImpl,
+        [miri_yes, random],
+        [miri_yes, random_type_u64],
+        [miri_yes, random_d4],
+        [miri_yes, random_ffi_str],
+        [miri_yes, random_f128],
+        [miri_yes, saw_mixed],
+        [miri_yes, sort_vs_sort_by]
+    );
+}
+
+#[cfg(feature = "cpp_blockquicksort")]
+mod cpp_blockquicksort_mosqrt {
+    use sort_research_rs::unstable::cpp_blockquicksort_mosqrt::SortImpl;
+
+    sort_test_tools::instantiate_sort_test_impl!(
+        SortImpl,
+        [miri_yes, random],
+        [miri_yes, random_type_u64],
+        [miri_yes, random_d4],
+        [miri_yes, random_ffi_str],
+        [miri_yes, random_f128],
+        [miri_yes, saw_mixed],
+        [miri_yes, sort_vs_sort_by]
+    );
+}
+
+#[cfg(feature = "cpp_blockquicksort")]
+mod cpp_blockquicksort_dual_pivot {
+    use sort_research_rs::unstable::cpp_blockquicksort_dual_pivot::SortImpl;
+
+    sort_test_tools::instantiate_sort_test_impl!(
+        SortImpl,
+        [miri_yes, random],
+        [miri_yes, random_type_u64],
+        [miri_yes, random_d4],
+        [miri_yes, random_ffi_str],
+        [miri_yes, random_f128],
+        [miri_yes, saw_mixed],
+        [miri_yes, sort_vs_sort_by]
+    );
+}
+
+#[cfg(feature = "cpp_blockquicksort")]
+mod cpp_blockquicksort_mo3_check {
+    use sort_research_rs::unstable::cpp_blockquicksort_mo3_check::SortImpl;
+
+    sort_test_tools::instantiate_sort_test_impl!(
+        SortImpl,
+        [miri_yes, random],
+        [miri_yes, random_type_u64],
+        [miri_yes, random_d4],
+        [miri_yes, random_ffi_str],
+        [miri_yes, random_f128],
+        [miri_yes, saw_mixed],
+        [miri_yes, sort_vs_sort_by]
+    );
+}
+
+#[cfg(feature = "cpp_gerbens_qsort")]
+mod cpp_gerbens_qsort {
+    use sort_research_rs::unstable::cpp_gerbens_qsort;
+
+    #[test]
+    fn sort_by_nothrow_i32() {
+        sort_test_tools::tests::sort_by_nothrow_i32(|v, compare| {
+            cpp_gerbens_qsort::sort_by_nothrow(v, compare)
+        });
+    }
+
+    // Every instantiated scratch size and 0 for the size picked from the L1 cache size.
+    fn scratch_sizes() -> impl Iterator<Item = usize> {
+        cpp_gerbens_qsort::SCRATCH_SIZES.into_iter().chain([0])
+    }
+
+    #[test]
+    fn sort_scratch_i32() {
+        for scratch_size in scratch_sizes() {
+            sort_test_tools::tests::sort_fn_i32(|v| {
+                cpp_gerbens_qsort::sort_scratch(v, scratch_size)
+            });
+        }
+    }
+
+    #[test]
+    fn sort_scratch_u64() {
+        for scratch_size in scratch_sizes() {
+            sort_test_tools::tests::sort_fn_u64(|v| {
+                cpp_gerbens_qsort::sort_scratch(v, scratch_size)
+            });
+        }
+    }
+
+    #[test]
+    fn sort_scratch_f128() {
+        for scratch_size in scratch_sizes() {
+            sort_test_tools::tests::sort_fn_f128(|v| {
+                cpp_gerbens_qsort::sort_scratch(v, scratch_size)
+            });
+        }
+    }
+
+    #[test]
+    fn sort_scratch_1k() {
+        for scratch_size in scratch_sizes() {
+            sort_test_tools::tests::sort_fn_large_val(|v| {
+                cpp_gerbens_qsort::sort_scratch(v, scratch_size)
+            });
+        }
+    }
+
+    #[test]
+    #[should_panic]
+    fn sort_scratch_unsupported_size() {
+        cpp_gerbens_qsort::sort_scratch(&mut [3, 1, 2], 100);
+    }
+}
+
+#[cfg(feature = "cpp_gerbens_qsort")]
+mod cpp_gerbens_qsort_fat {
+    use sort_research_rs::unstable::cpp_gerbens_qsort_fat::SortImpl;
+
+    sort_test_tools::instantiate_sort_test_impl!(
+        SortImpl,
+        [miri_yes, random],
+        [miri_yes, random_type_u64],
+        [miri_yes, random_d4],
+        [miri_yes, random_d16],
+        [miri_yes, random_d256],
+        [miri_yes, random_z1],
+        [miri_yes, random_binary],
+        [miri_yes, all_equal],
+        [miri_yes, random_ffi_str],
+        [miri_yes, random_f128],
+        [miri_yes, saw_mixed],
+        [miri_yes, comp_panic],
+        [miri_yes, sort_vs_sort_by]
+    );
+}
+
+#[cfg(feature = "cpp_nanosort")]
+mod cpp_nanosort {
+    use sort_research_rs::unstable::cpp_nanosort;
+
+    #[test]
+    fn sort_by_nothrow_i32() {
+        sort_test_tools::tests::sort_by_nothrow_i32(|v, compare| {
+            cpp_nanosort::sort_by_nothrow(v, compare)
+        });
+    }
+}
+
+#[cfg(feature = "cpp_nanosort")]
+mod cpp_nanosort_fat {
+    use sort_research_rs::unstable::cpp_nanosort_fat::SortImpl;
+
+    sort_test_tools::instantiate_sort_test_impl!(
+        SortImpl,
+        [miri_yes, random],
+        [miri_yes, random_type_u64],
+        [miri_yes, random_d4],
+        [miri_yes, random_d16],
+        [miri_yes, random_d256],
+        [miri_yes, random_z1],
+        [miri_yes, random_binary],
+        [miri_yes, all_equal],
+        [miri_yes, random_ffi_str],
+        [miri_yes, random_f128],
+        [miri_yes, saw_mixed],
+        [miri_yes, comp_panic],
+        [miri_yes, sort_vs_sort_by]
+    );
+}
+
+#[cfg(feature = "cpp_adaptive")]
+mod cpp_adaptive {
+    use sort_research_rs::unstable::cpp_adaptive;
+
+    #[test]
+    fn random_type_u64() {
+        sort_test_tools::tests::random_type_u64::<cpp_adaptive::SortImpl>();
+    }
+
+    #[test]
+    fn random_d4() {
+        sort_test_tools::tests::random_d4::<cpp_adaptive::SortImpl>();
+    }
+
+    #[test]
+    fn random_s95() {
+        sort_test_tools::tests::random_s95::<cpp_adaptive::SortImpl>();
+    }
+
+    #[test]
+    fn saw_mixed() {
+        sort_test_tools::tests::saw_mixed::<cpp_adaptive::SortImpl>();
+    }
+
+    #[test]
+    fn pipe_organ() {
+        sort_test_tools::tests::pipe_organ::<cpp_adaptive::SortImpl>();
+    }
+
+    #[test]
+    fn random_ffi_str() {
+        sort_test_tools::tests::random_ffi_str::<cpp_adaptive::SortImpl>();
+    }
+
+    #[test]
+    fn sort_vs_sort_by() {
+        sort_test_tools::tests::sort_vs_sort_by::<cpp_adaptive::SortImpl>();
+    }
+
+    #[test]
+    fn panic_retain_original_set_i32() {
+        sort_test_tools::tests::panic_retain_original_set_i32::<cpp_adaptive::SortImpl>();
+    }
+}
+
+#[cfg(feature = "cpp_ips4o")]
+mod cpp_ips4o {
+    use sort_research_rs::unstable::cpp_ips4o;
+
+    #[test]
+    fn random_arena_str() {
+        sort_test_tools::tests::random_arena_str::<cpp_ips4o::SortImpl>();
+    }
+
+    #[test]
+    fn partial_sort_i32() {
+        sort_test_tools::tests::partial_sort_i32(cpp_ips4o::partial_sort);
+    }
+
+    #[test]
+    fn sort_into_u64() {
+        sort_test_tools::tests::sort_into_u64(cpp_ips4o::sort_into);
+    }
+
+    #[test]
+    fn sort_indirect_1k() {
+        sort_test_tools::tests::sort_indirect_1k(cpp_ips4o::sort_indirect);
+    }
+
+    #[test]
+    fn sort_by_known_key_u64() {
+        sort_test_tools::tests::sort_by_known_key_u64(false, cpp_ips4o::sort_by_known_key);
+    }
+
+    #[test]
+    fn sort_profile() {
+        use cpp_ips4o::Ips4oProfile;
+        use sort_test_tools::ffi_types::{FFIOneKibiByte, F128};
+        use sort_test_tools::patterns;
+
+        fn check<T: Ord + Clone + std::fmt::Debug>(
+            profile: Ips4oProfile,
+            values: &[i32],
+            transform: fn(i32) -> T,
+        ) {
+            let mut data: Vec<T> = values.iter().map(|&val| transform(val)).collect();
+            let mut expected = data.clone();
+            expected.sort();
+
+            cpp_ips4o::sort_profile(&mut data, profile);
+            assert_eq!(data, expected, "{profile:?}");
+        }
+
+        for profile in Ips4oProfile::ALL {
+            for len in [0, 1, 20, 1_000, 100_000] {
+                for values in [patterns::random(len), patterns::random_uniform(len, 0..=15)] {
+                    check(profile, &values, |val| val);
+                    check(profile, &values, |val| val as u64);
+                    check(profile, &values, F128::new);
+                    if len <= 1_000 {
+                        check(profile, &values, FFIOneKibiByte::new);
+                    }
+                }
+            }
+
+            // Large enough for the two level threshold of every profile.
+            check(profile, &patterns::random(2_000_000), |val| val as u64);
+        }
+    }
+
+    #[test]
+    fn sort_counted() {
+        sort_test_tools::tests::sort_counted_i32(cpp_ips4o::sort_counted);
+        sort_test_tools::tests::sort_counted_u64(cpp_ips4o::sort_counted);
+        sort_test_tools::tests::sort_counted_1k(cpp_ips4o::sort_counted);
+    }
+}
+
+#[cfg(any(feature = "cpp_ips4o", feature = "cpp_ips4o_parallel"))]
+mod cpp_ips4o_splitters {
+    use sort_research_rs::unstable::cpp_ips4o_splitters::{Ips4oSplitters, SplitterUse};
+    use sort_test_tools::patterns;
+
+    // Sorts a sequence of inputs, whose distribution changes once, and checks how the splitters
+    // were picked for each of them.
+    fn check(sort: fn(&mut Ips4oSplitters<u64>, &mut [u64]) -> SplitterUse) {
+        let mut splitters = Ips4oSplitters::new();
+
+        let inputs: [(Vec<i32>, SplitterUse); 5] = [
+            (patterns::random(200_000), SplitterUse::Resampled),
+            (patterns::random(300_000), SplitterUse::Reused),
+            (patterns::random(1_000), SplitterUse::TooShort),
+            (
+                patterns::random_uniform(200_000, 0..100),
+                SplitterUse::Resampled,
+            ),
+            (
+                patterns::random_uniform(250_000, 0..100),
+                SplitterUse::Reused,
+            ),
+        ];
+
+        for (input, expected_use) in inputs {
+            let mut data: Vec<u64> = input.into_iter().map(|val| val as u64).collect();
+            let mut expected = data.clone();
+            expected.sort();
+
+            assert_eq!(sort(&mut splitters, &mut data), expected_use);
+            assert_eq!(data, expected);
+        }
+
+        let stats = splitters.stats();
+        assert_eq!((stats.reused, stats.resampled, stats.too_short), (2, 2, 1));
+
+        splitters.clear();
+        let mut data: Vec<u64> = patterns::random(200_000)
+            .into_iter()
+            .map(|val| val as u64)
+            .collect();
+        assert_eq!(sort(&mut splitters, &mut data), SplitterUse::Resampled);
+        assert!(data.windows(2).all(|w| w[0] <= w[1]));
+    }
+
+    #[cfg(feature = "cpp_ips4o")]
+    #[test]
+    fn reuse_u64() {
+        check(Ips4oSplitters::sort);
+    }
+
+    #[cfg(feature = "cpp_ips4o")]
+    #[test]
+    fn reuse_i32() {
+        let mut splitters = Ips4oSplitters::new();
+
+        for _ in 0..4 {
+            let mut data = patterns::random(200_000);
+            let mut expected = data.clone();
+            expected.sort();
+
+            splitters.sort(&mut data);
+            assert_eq!(data, expected);
+        }
+
+        assert_eq!(splitters.stats().resampled, 1);
+    }
+
+    #[cfg(feature = "cpp_ips4o_parallel")]
+    #[test]
+    fn reuse_parallel_u64() {
+        check(Ips4oSplitters::sort_parallel);
+    }
+}
+
+#[cfg(feature = "singeli_singelisort")]
+mod singeli_singelisort {
+    use sort_research_rs::other::singeli_singelisort;
+
+    #[test]
+    fn random_type_f64() {
+        sort_test_tools::tests::random_type_f64::<singeli_singelisort::SortImpl>();
+    }
+
+    #[test]
+    fn random_type_narrow() {
+        sort_test_tools::tests::random_type_i8::<singeli_singelisort::SortImpl>();
+        sort_test_tools::tests::random_type_u8::<singeli_singelisort::SortImpl>();
+        sort_test_tools::tests::random_type_i16::<singeli_singelisort::SortImpl>();
+        sort_test_tools::tests::random_type_u16::<singeli_singelisort::SortImpl>();
+    }
+
+    #[test]
+    fn sort_packed() {
+        sort_test_tools::tests::sort_packed_key_payload_u32(singeli_singelisort::sort_packed);
+    }
+
+    #[test]
+    fn grade() {
+        use sort_test_tools::patterns;
+
+        fn check<T: Ord + Copy + std::fmt::Debug>(values: &[i32], transform: fn(i32) -> T) {
+            let keys: Vec<T> = values.iter().map(|&val| transform(val)).collect();
+            let mut expected: Vec<u64> = (0..keys.len() as u64).collect();
+            expected.sort_by_key(|&i| keys[i as usize]);
+
+            assert_eq!(singeli_singelisort::grade(&keys), expected);
+        }
+
+        for len in [0, 1, 2, 15, 16, 300, 40_000, 100_000] {
+            for values in [patterns::random(len), patterns::random_uniform(len, 0..=3)] {
+                check(&values, |val| val as i8);
+                check(&values, |val| val as u8);
+                check(&values, |val| val as i16);
+                check(&values, |val| val as u16);
+            }
+        }
+    }
+
+    #[test]
+    fn sort_robin_hood() {
+        use sort_test_tools::patterns;
+
+        for len in [0, 1, 2, 20, 1_000, 100_000] {
+            for values in [
+                patterns::random(len),
+                patterns::random_uniform(len, 0..(len as i32 * 3 + 1)),
+                patterns::random_uniform(len, -5..5),
+            ] {
+                let mut data = values.clone();
+                let mut expected = values;
+                expected.sort();
+
+                singeli_singelisort::sort_robin_hood(&mut data);
+                assert_eq!(data, expected);
+            }
+        }
+    }
+}
+
+#[cfg(feature = "cpp_powersort")]
+mod cpp_powersort {
+    use sort_research_rs::stable::cpp_powersort;
+
+    #[test]
+    fn random_arena_str() {
+        sort_test_tools::tests::random_arena_str::<cpp_powersort::SortImpl>();
+    }
+
+    #[test]
+    fn sort_indirect_1k() {
+        sort_test_tools::tests::sort_indirect_1k(cpp_powersort::sort_indirect);
+    }
+
+    #[test]
+    fn merge_modes() {
+        use cpp_powersort::MergeMode;
+
+        for mode in [
+            MergeMode::Bidirectional,
+            MergeMode::Prefetch,
+            MergeMode::Blockwise,
+        ] {
+            sort_test_tools::tests::sort_fn_f128(|data| cpp_powersort::sort_merge_mode(data, mode));
+            sort_test_tools::tests::sort_fn_large_val(|data| {
+                cpp_powersort::sort_merge_mode(data, mode)
+            });
+        }
+    }
+
+    #[test]
+    fn sort_with_buf_i32() {
+        sort_test_tools::tests::sort_with_buf_i32(cpp_powersort::sort_with_buf, |len| len + 4);
+    }
+
+    #[test]
+    fn sort_with_buf_u64() {
+        sort_test_tools::tests::sort_with_buf_u64(cpp_powersort::sort_with_buf, |len| len + 4);
+    }
+
+    #[test]
+    fn sort_counted() {
+        sort_test_tools::tests::sort_counted_i32(cpp_powersort::sort_counted);
+        sort_test_tools::tests::sort_counted_u64(cpp_powersort::sort_counted);
+        sort_test_tools::tests::sort_counted_1k(cpp_powersort::sort_counted);
+    }
+}
+
+#[cfg(feature = "cpp_powersort")]
+mod cpp_powersort_4way {
+    use sort_research_rs::stable::cpp_powersort_4way;
+
+    #[test]
+    fn sort_with_buf_i32() {
+        sort_test_tools::tests::sort_with_buf_i32(cpp_powersort_4way::sort_with_buf, |len| len + 4);
+    }
+
+    #[test]
+    fn sort_with_buf_u64() {
+        sort_test_tools::tests::sort_with_buf_u64(cpp_powersort_4way::sort_with_buf, |len| len + 4);
+    }
+}
+
+#[cfg(feature = "cpp_wikisort")]
+mod cpp_wikisort {
+    use sort_research_rs::stable::cpp_wikisort;
+
+    #[test]
+    fn merge_modes() {
+        use cpp_wikisort::MergeMode;
+
+        for mode in [MergeMode::Plain, MergeMode::Prefetch, MergeMode::Blockwise] {
+            sort_test_tools::tests::sort_fn_f128(|data| cpp_wikisort::sort_merge_mode(data, mode));
+            sort_test_tools::tests::sort_fn_large_val(|data| {
+                cpp_wikisort::sort_merge_mode(data, mode)
+            });
+        }
+    }
+
+    // Odd lengths, and lengths below 8 that ignore the cache mode.
+    const CACHE_TEST_LENS: [usize; 12] = [0, 1, 2, 3, 5, 7, 8, 9, 31, 101, 1_001, 10_001];
+
+    #[test]
+    fn cache_modes() {
+        use cpp_wikisort::CacheMode;
+
+        // Fixed(1_000) is below (len + 1) / 2 for 10_001 and above it for 1_001.
+        for mode in [
+            CacheMode::Stack,
+            CacheMode::Fixed(0),
+            CacheMode::Fixed(3),
+            CacheMode::Fixed(1_000),
+            CacheMode::Fixed(100_000),
+            CacheMode::Sqrt,
+            CacheMode::Half,
+        ] {
+            sort_test_tools::tests::sort_fn_i32(|data| cpp_wikisort::sort_cache_mode(data, mode));
+            sort_test_tools::tests::sort_fn_u64(|data| cpp_wikisort::sort_cache_mode(data, mode));
+            sort_test_tools::tests::sort_fn_f128(|data| cpp_wikisort::sort_cache_mode(data, mode));
+            sort_test_tools::tests::stability_fn_large_val_lens(
+                |data| cpp_wikisort::sort_cache_mode(data, mode),
+                &CACHE_TEST_LENS,
+            );
+        }
+    }
+
+    #[test]
+    fn cache_alloc_fallback() {
+        use cpp_wikisort::CacheMode;
+
+        // 512 lets the first allocation fail and the 512 element one succeed, 0 fails both.
+        for max_alloc_len in [512, 0] {
+            for mode in [CacheMode::Fixed(100_000), CacheMode::Sqrt, CacheMode::Half] {
+                sort_test_tools::tests::sort_fn_i32(|data| {
+                    cpp_wikisort::sort_cache_mode_max_alloc(data, mode, max_alloc_len)
+                });
+                sort_test_tools::tests::stability_fn_large_val_lens(
+                    |data| cpp_wikisort::sort_cache_mode_max_alloc(data, mode, max_alloc_len),
+                    &CACHE_TEST_LENS,
+                );
+            }
+        }
+    }
+
+    #[test]
+    fn with_buf_cache_lens() {
+        use std::mem::{self, MaybeUninit};
+
+        use sort_test_tools::patterns;
+
+        for len in CACHE_TEST_LENS {
+            // From no cache at all to more than the (len + 1) / 2 elements that are used.
+            let half_len = (len + 1) / 2;
+            for cache_len in [0, 1, half_len.saturating_sub(1), half_len, len + 1] {
+                let values = patterns::random_uniform(len, 0..(len as i32 / 4 + 1));
+
+                let mut data = values.clone();
+                let mut expected = values;
+                expected.sort();
+
+                let mut buf = vec![MaybeUninit::<u8>::uninit(); cache_len * mem::size_of::<i32>()];
+                cpp_wikisort::sort_with_buf(&mut data, &mut buf);
+                assert_eq!(data, expected, "len: {len}, cache_len: {cache_len}");
+            }
+        }
+    }
+
+    #[test]
+    fn sort_with_buf_i32() {
+        sort_test_tools::tests::sort_with_buf_i32(cpp_wikisort::sort_with_buf, |len| (len + 1) / 2);
+    }
+
+    #[test]
+    fn sort_with_buf_u64() {
+        sort_test_tools::tests::sort_with_buf_u64(cpp_wikisort::sort_with_buf, |len| (len + 1) / 2);
+    }
+}
+
+#[cfg(feature = "cpp_powersort_parallel")]
+mod cpp_powersort_parallel {
+    use sort_research_rs::stable::cpp_powersort_parallel;
+
+    #[test]
+    fn merge_sorted_runs_u64() {
+        sort_test_tools::tests::merge_sorted_runs_u64(cpp_powersort_parallel::merge_sorted_runs);
+    }
+
+    #[test]
+    fn merge_sorted_runs_ffi_string() {
+        sort_test_tools::tests::merge_sorted_runs_ffi_string(
+            cpp_powersort_parallel::merge_sorted_runs,
+        );
+    }
+
+    #[test]
+    fn merge_sorted_runs_f128() {
+        sort_test_tools::tests::merge_sorted_runs_f128(cpp_powersort_parallel::merge_sorted_runs);
+    }
+
+    // PARALLEL_MIN_CHUNK_LEN is 8192, with 4 threads these sort 3 and 4 chunks, and merge them in
+    // two rounds, the second one back into the input.
+    const PARALLEL_TEST_LENS: &[usize] = &[24_577, 40_000];
+
+    #[test]
+    fn random_ffi_str_parallel() {
+        super::use_at_least_4_threads();
+        sort_test_tools::tests::random_ffi_str_lens::<cpp_powersort_parallel::SortImpl>(
+            PARALLEL_TEST_LENS,
+        );
+    }
+
+    #[test]
+    fn saw_mixed_parallel() {
+        super::use_at_least_4_threads();
+        sort_test_tools::tests::saw_mixed_lens::<cpp_powersort_parallel::SortImpl>(
+            PARALLEL_TEST_LENS,
+        );
+    }
+
+    #[test]
+    fn stability_parallel() {
+        super::use_at_least_4_threads();
+        sort_test_tools::tests::stability_lens::<cpp_powersort_parallel::SortImpl>(
+            PARALLEL_TEST_LENS,
+        );
+    }
+
+    #[test]
+    fn panic_retain_original_set_ffi_string_parallel() {
+        super::use_at_least_4_threads();
+        sort_test_tools::tests::panic_retain_original_set_ffi_string_lens::<
+            cpp_powersort_parallel::SortImpl,
+        >(PARALLEL_TEST_LENS);
+    }
+}
+
+#[cfg(feature = "cpp_std_sys_parallel")]
+mod cpp_std_sys_parallel {
+    use sort_research_rs::stable::cpp_std_sys_parallel;
+
+    #[test]
+    fn random_type_u64() {
+        sort_test_tools::tests::random_type_u64::<cpp_std_sys_parallel::SortImpl>();
+    }
+
+    #[test]
+    fn random_ffi_str() {
+        sort_test_tools::tests::random_ffi_str::<cpp_std_sys_parallel::SortImpl>();
+    }
+
+    #[test]
+    fn random_f128() {
+        sort_test_tools::tests::random_f128::<cpp_std_sys_parallel::SortImpl>();
+    }
+
+    #[test]
+    fn stability() {
+        sort_test_tools::tests::stability::<cpp_std_sys_parallel::SortImpl>();
+    }
+
+    #[test]
+    fn panic_retain_original_set_i32() {
+        sort_test_tools::tests::panic_retain_original_set_i32::<cpp_std_sys_parallel::SortImpl>();
+    }
+}
+
+#[cfg(feature = "c_fast_qsort")]
+mod c_fast_qsort {
+    use sort_research_rs::unstable::c_fast_qsort::SortImpl;
+
+    sort_test_tools::instantiate_sort_test_impl!(
+        SortImpl,
+        [miri_yes, random],
+        [miri_yes, random_type_u64],
+        [miri_yes, random_d4],
+        [miri_yes, random_ffi_str],
+        [miri_yes, random_f128],
+        [miri_yes, saw_mixed],
+        [miri_yes, sort_vs_sort_by]
+    );
+}
+
+#[cfg(feature = "c_crumsort")]
+mod c_crumsort {
+    use sort_research_rs::unstable::c_crumsort;
+
+    #[test]
+    fn random_f128() {
+        sort_test_tools::tests::random_f128::<c_crumsort::SortImpl>();
+    }
+
+    #[test]
+    fn random_large_val() {
+        sort_test_tools::tests::random_large_val::<c_crumsort::SortImpl>();
+    }
+}
+
+#[cfg(feature = "c_fluxsort")]
+mod c_fluxsort {
+    use sort_research_rs::stable::c_fluxsort;
+
+    #[test]
+    fn sort_indirect_1k() {
+        sort_test_tools::tests::sort_indirect_1k(c_fluxsort::sort_indirect);
+    }
+
+    #[test]
+    fn random_f128() {
+        sort_test_tools::tests::random_f128::<c_fluxsort::SortImpl>();
+    }
+
+    #[test]
+    fn random_large_val() {
+        sort_test_tools::tests::random_large_val::<c_fluxsort::SortImpl>();
+    }
+
+    #[test]
+    fn sort_with_buf_i32() {
+        sort_test_tools::tests::sort_with_buf_i32(c_fluxsort::sort_with_buf, |len| len);
+    }
+
+    #[test]
+    fn sort_with_buf_u64() {
+        sort_test_tools::tests::sort_with_buf_u64(c_fluxsort::sort_with_buf, |len| len);
+    }
+}
+
+#[cfg(feature = "c_fluxsort")]
+mod c_fluxsort_parallel {
+    use sort_research_rs::stable::c_fluxsort_parallel;
+
+    #[test]
+    fn random_type_u64() {
+        sort_test_tools::tests::random_type_u64::<c_fluxsort_parallel::SortImpl>();
+    }
+
+    #[test]
+    fn saw_mixed() {
+        sort_test_tools::tests::saw_mixed::<c_fluxsort_parallel::SortImpl>();
+    }
+
+    #[test]
+    fn stability() {
+        sort_test_tools::tests::stability::<c_fluxsort_parallel::SortImpl>();
+    }
+
+    // PARALLEL_MIN_CHUNK_LEN is 8192, with 4 threads these sort 3 and 4 chunks. The first round of
+    // 4 chunks merges two pairs with two parts each, every last round splits one pair into 4 parts
+    // along the merge path.
+    const PARALLEL_TEST_LENS: &[usize] = &[24_577, 40_000];
+
+    #[test]
+    fn random_parallel() {
+        super::use_at_least_4_threads();
+        sort_test_tools::tests::random_lens::<c_fluxsort_parallel::SortImpl>(PARALLEL_TEST_LENS);
+    }
+
+    #[test]
+    fn saw_mixed_parallel() {
+        super::use_at_least_4_threads();
+        sort_test_tools::tests::saw_mixed_lens::<c_fluxsort_parallel::SortImpl>(PARALLEL_TEST_LENS);
+    }
+
+    #[test]
+    fn stability_parallel() {
+        super::use_at_least_4_threads();
+        sort_test_tools::tests::stability_lens::<c_fluxsort_parallel::SortImpl>(PARALLEL_TEST_LENS);
+    }
+}
+
+#[cfg(feature = "cpp_network_sort")]
+mod cpp_network_sort {
+    use sort_research_rs::other::cpp_network_sort;
+
+    #[test]
+    fn small_len_u64() {
+        sort_test_tools::tests::small_len_u64(
+            cpp_network_sort::MAX_LEN,
+            cpp_network_sort::sort_u64,
+        );
+    }
+
+    #[test]
+    fn small_len_u64_n() {
+        fn sort_n<const N: usize>(data: &mut [u64]) {
+            cpp_network_sort::sort_u64_n::<N>(data.try_into().unwrap());
+        }
+
+        macro_rules! for_each_len {
+            ($($n:literal)*) => {
+                sort_test_tools::tests::small_len_u64(cpp_network_sort::MAX_LEN, |data| {
+                    match data.len() {
+                        $($n => sort_n::<$n>(data),)*
+                        _ => unreachable!(),
+                    }
+                });
+            };
+        }
+
+        for_each_len!(
+            0 1 2 3 4 5 6 7 8 9 10 11 12 13 14 15 16 17 18 19 20 21 22 23 24 25 26 27 28 29 30 31 32
+        );
+    }
+
+    #[test]
+    #[should_panic]
+    fn too_long() {
+        cpp_network_sort::sort_u64(&mut [0; cpp_network_sort::MAX_LEN + 1]);
+    }
+}
+
+#[cfg(feature = "cpp_sortedness")]
+mod cpp_sortedness {
+    use sort_research_rs::other::cpp_sortedness;
+    use sort_test_tools::ffi_types::{F32, F64};
+    use sort_test_tools::patterns;
+
+    // Descents and longest run, one pair at a time.
+    fn reference<T: Ord>(data: &[T]) -> (u64, u64) {
+        let mut descents = 0;
+        let mut longest_run = data.len().min(1) as u64;
+        let mut run_len = 1;
+        for w in data.windows(2) {
+            if w[1] < w[0] {
+                descents += 1;
+                run_len = 1;
+            } else {
+                run_len += 1;
+                longest_run = longest_run.max(run_len);
+            }
+        }
+
+        (descents, longest_run)
+    }
+
+    fn check<T: Ord + Clone + std::fmt::Debug>(transform: impl Fn(i32) -> T) {
+        let pattern_fns: [fn(usize) -> Vec<i32>; 6] = [
+            patterns::random,
+            |len| patterns::random_uniform(len, 0..=3),
+            |len| patterns::saw_mixed(len, (len / 50).max(1)),
+            |len| patterns::random_sorted(len, 95.0),
+            patterns::ascending,
+            patterns::descending,
+        ];
+
+        for len in [0, 1, 2, 3, 63, 64, 65, 1_000, 1_023, 1_025, 5_000, 100_000] {
+            for pattern_fn in pattern_fns {
+                let data = pattern_fn(len)
+                    .into_iter()
+                    .map(&transform)
+                    .collect::<Vec<_>>();
+
+                let metrics = cpp_sortedness::measure(&data);
+                let (descents, longest_run) = reference(&data);
+                assert_eq!(metrics.descents, descents, "{data:?}");
+                assert_eq!(metrics.longest_run, longest_run, "{data:?}");
+                assert_eq!(cpp_sortedness::is_sorted(&data), descents == 0);
+
+                let mut sorted = data.clone();
+                sorted.sort();
+                let distinct =
+                    sorted.windows(2).filter(|w| w[0] != w[1]).count() as u64 + (len > 0) as u64;
+                if len <= 1_024 {
+                    assert_eq!(metrics.distinct_estimate, distinct);
+                } else if distinct <= 4 {
+                    // Every value shows up in the sample many times.
+                    assert_eq!(metrics.distinct_estimate, distinct);
+                }
+                assert!(cpp_sortedness::is_sorted(&sorted));
+            }
+        }
+    }
+
+    #[test]
+    fn metrics_i32() {
+        check(|val| val);
+    }
+
+    #[test]
+    fn metrics_u64() {
+        check(|val| (val as u64) << 20);
+    }
+
+    #[test]
+    fn metrics_f32() {
+        // Some NaNs, which are greater than every other value.
+        check(|val| F32(if val % 7 == 3 { f32::NAN } else { val as f32 }));
+    }
+
+    #[test]
+    fn metrics_f64() {
+        check(|val| {
+            F64(if val % 7 == 3 {
+                f64::NAN
+            } else {
+                val as f64 * -0.5
+            })
+        });
+    }
+}
+
+#[cfg(feature = "golang_std")]
+mod golang_std_stable {
+    use sort_research_rs::stable::golang_std;
+
+    #[test]
+    fn random_ffi_str() {
+        sort_test_tools::tests::random_ffi_str::<golang_std::SortImpl>();
+    }
+
+    #[test]
+    fn random_f128() {
+        sort_test_tools::tests::random_f128::<golang_std::SortImpl>();
+    }
+
+    #[test]
+    fn sort_by_known_key_u64() {
+        sort_test_tools::tests::sort_by_known_key_u64(true, golang_std::sort_by_known_key);
+    }
+}
+
+#[cfg(feature = "golang_std")]
+mod golang_std_unstable {
+    use sort_research_rs::unstable::golang_std;
+
+    #[test]
+    fn random_ffi_str() {
+        sort_test_tools::tests::random_ffi_str::<golang_std::SortImpl>();
+    }
+
+    #[test]
+    fn random_f128() {
+        sort_test_tools::tests::random_f128::<golang_std::SortImpl>();
+    }
+
+    #[test]
+    fn sort_by_known_key_u64() {
+        sort_test_tools::tests::sort_by_known_key_u64(false, golang_std::sort_by_known_key);
+    }
+}
+
+#[cfg(feature = "golang_std")]
+mod golang_std_parallel_stable {
+    use sort_research_rs::stable::golang_std_parallel;
+
+    #[test]
+    fn random_type_u64() {
+        sort_test_tools::tests::random_type_u64::<golang_std_parallel::SortImpl>();
+    }
+
+    #[test]
+    fn random_ffi_str() {
+        sort_test_tools::tests::random_ffi_str::<golang_std_parallel::SortImpl>();
+    }
+
+    #[test]
+    fn stability() {
+        sort_test_tools::tests::stability::<golang_std_parallel::SortImpl>();
+    }
+
+    #[test]
+    fn panic_retain_original_set_i32() {
+        sort_test_tools::tests::panic_retain_original_set_i32::<golang_std_parallel::SortImpl>();
+    }
+
+    // From PARALLEL_MIN_LEN on the sample sort runs, the default test sizes stay below it.
+    const PARALLEL_TEST_LENS: &[usize] = &[16_384, 40_000];
+
+    #[test]
+    fn random_ffi_str_parallel() {
+        super::use_at_least_4_threads();
+        sort_test_tools::tests::random_ffi_str_lens::<golang_std_parallel::SortImpl>(
+            PARALLEL_TEST_LENS,
+        );
+    }
+
+    #[test]
+    fn saw_mixed_parallel() {
+        super::use_at_least_4_threads();
+        sort_test_tools::tests::saw_mixed_lens::<golang_std_parallel::SortImpl>(PARALLEL_TEST_LENS);
+    }
+
+    #[test]
+    fn stability_parallel() {
+        super::use_at_least_4_threads();
+        sort_test_tools::tests::stability_lens::<golang_std_parallel::SortImpl>(PARALLEL_TEST_LENS);
+    }
+
+    #[test]
+    fn panic_retain_original_set_i32_parallel() {
+        super::use_at_least_4_threads();
+        sort_test_tools::tests::panic_retain_original_set_i32_lens::<golang_std_parallel::SortImpl>(
+            PARALLEL_TEST_LENS,
+        );
+    }
+}
+
+#[cfg(feature = "golang_std")]
+mod golang_std_parallel_unstable {
+    use sort_research_rs::unstable::golang_std_parallel;
+
+    #[test]
+    fn random_type_u64() {
+        sort_test_tools::tests::random_type_u64::<golang_std_parallel::SortImpl>();
+    }
+
+    #[test]
+    fn random_f128() {
+        sort_test_tools::tests::random_f128::<golang_std_parallel::SortImpl>();
+    }
+
+    #[test]
+    fn panic_retain_original_set_i32() {
+        sort_test_tools::tests::panic_retain_original_set_i32::<golang_std_parallel::SortImpl>();
+    }
+
+    // From PARALLEL_MIN_LEN on the sample sort runs, the default test sizes stay below it.
+    const PARALLEL_TEST_LENS: &[usize] = &[16_384, 40_000];
+
+    #[test]
+    fn random_parallel() {
+        super::use_at_least_4_threads();
+        sort_test_tools::tests::random_lens::<golang_std_parallel::SortImpl>(PARALLEL_TEST_LENS);
+    }
+
+    #[test]
+    fn saw_mixed_parallel() {
+        super::use_at_least_4_threads();
+        sort_test_tools::tests::saw_mixed_lens::<golang_std_parallel::SortImpl>(PARALLEL_TEST_LENS);
+    }
+
+    #[test]
+    fn panic_retain_original_set_i32_parallel() {
+        super::use_at_least_4_threads();
+        sort_test_tools::tests::panic_retain_original_set_i32_lens::<golang_std_parallel::SortImpl>(
+            PARALLEL_TEST_LENS,
+        );
+    }
+}
+
+#[cfg(feature = "rust_ipnsort_parallel")]
+mod rust_ipnsort_parallel {
+    use sort_research_rs::unstable::rust_ipnsort_parallel;
+
+    #[test]
+    fn random() {
+        sort_test_tools::tests::random::<rust_ipnsort_parallel::SortImpl>();
+    }
+
+    #[test]
+    fn random_type_u64() {
+        sort_test_tools::tests::random_type_u64::<rust_ipnsort_parallel::SortImpl>();
+    }
+
+    #[test]
+    fn random_ffi_str() {
+        sort_test_tools::tests::random_ffi_str::<rust_ipnsort_parallel::SortImpl>();
+    }
+
+    #[test]
+    fn random_f128() {
+        sort_test_tools::tests::random_f128::<rust_ipnsort_parallel::SortImpl>();
+    }
+
+    // Twice MIN_PARALLEL_LEN, so the partitions above it hand their left side to scoped threads.
+    const PARALLEL_TEST_LENS: &[usize] = &[32_768, 50_001];
+
+    #[test]
+    fn random_parallel() {
+        super::use_at_least_4_threads();
+        sort_test_tools::tests::random_lens::<rust_ipnsort_parallel::SortImpl>(PARALLEL_TEST_LENS);
+    }
+
+    #[test]
+    fn saw_mixed_parallel() {
+        super::use_at_least_4_threads();
+        sort_test_tools::tests::saw_mixed_lens::<rust_ipnsort_parallel::SortImpl>(
+            PARALLEL_TEST_LENS,
+        );
+    }
+
+    #[test]
+    fn panic_retain_original_set_ffi_string_parallel() {
+        // sort_by is sequential, the comparison function has to be Sync to reach the threads.
+        super::use_at_least_4_threads();
+        sort_test_tools::tests::panic_retain_original_set_sync_ffi_string_lens::<
+            rust_ipnsort_parallel::SortImpl,
+        >(PARALLEL_TEST_LENS, |data, compare| {
+            rust_ipnsort_parallel::par_sort_by(data, compare)
+        });
+    }
+}
+
+#[cfg(feature = "external_sort")]
+mod external_sort {
+    use std::path::Path;
+
+    use sort_research_rs::other::external_sort::{self, Config, Record};
+    use sort_research_rs::unstable::rust_ipnsort;
+
+    fn sort_file<T: Record>(input: &Path, output: &Path) {
+        // Small chunks and fan-in, so that the larger inputs need several merge passes.
+        let config = Config {
+            chunk_bytes: 16 * 1024,
+            fan_in: 4,
+            ..Default::default()
+        };
+
+        external_sort::sort_file::<rust_ipnsort::SortImpl, T>(input, output, &config).unwrap();
+    }
+
+    #[test]
+    fn sort_file_u64() {
+        sort_test_tools::tests::sort_file_u64(sort_file::<u64>);
+    }
+
+    #[test]
+    fn sort_file_ffi_string() {
+        sort_test_tools::tests::sort_file_ffi_string(
+            sort_file::<sort_test_tools::ffi_types::FFIString>,
+        );
+    }
+}
+
+#[cfg(all(feature = "mmap_sort", target_os = "linux"))]
+mod mmap_sort {
+    use sort_research_rs::other::mmap_sort::{self, Config};
+    use sort_research_rs::unstable::rust_ipnsort;
+
+    #[test]
+    fn sort_file_in_place() {
+        sort_test_tools::tests::sort_record_file(|path, record_bytes, key| {
+            mmap_sort::sort_file_in_place::<rust_ipnsort::SortImpl>(
+                path,
+                record_bytes,
+                key,
+                &Config::default(),
+            )
+            .unwrap();
+        });
+    }
+}
+
+#[cfg(feature = "auto_tune")]
+mod auto_tune {
+    use sort_research_rs::other::auto_tune::{self, Config, Table};
+
+    fn calibrate() -> Table {
+        auto_tune::calibrate(&Config {
+            max_len: 10_000,
+            runs: 1,
+            batch_elements: 1_000,
+        })
+    }
+
+    #[test]
+    fn calibrate_and_load() {
+        let table = calibrate();
+
+        let names: Vec<String> = auto_tune::candidates::<i32>()
+            .into_iter()
+            .map(|(name, _)| name)
+            .collect();
+        for len in [0, 5, 50, 500, 5_000, 5_000_000] {
+            for type_name in ["i32", "u64"] {
+                let winner = table.winner(type_name, len).unwrap();
+                assert!(names.iter().any(|name| name == winner), "{winner}");
+            }
+        }
+
+        let path = std::env::temp_dir().join(format!("auto_tune_test_{}.txt", std::process::id()));
+        table.save(&path).unwrap();
+        let loaded = Table::load(&path);
+        let _ = std::fs::remove_file(&path);
+        assert_eq!(loaded.unwrap(), table);
+    }
+
+    #[test]
+    fn dispatch() {
+        // Another test may have installed its table first, any calibrated table will do.
+        let _ = auto_tune::set_table(calibrate());
+
+        sort_test_tools::tests::random::<auto_tune::SortImpl>();
+        sort_test_tools::tests::random_type_u64::<auto_tune::SortImpl>();
+        sort_test_tools::tests::random_d4::<auto_tune::SortImpl>();
+        sort_test_tools::tests::saw_mixed::<auto_tune::SortImpl>();
+        sort_test_tools::tests::random_str::<auto_tune::SortImpl>();
+        sort_test_tools::tests::sort_vs_sort_by::<auto_tune::SortImpl>();
+    }
+}
+
+#[cfg(feature = "parallel_cutover")]
+mod parallel_cutover {
+    use sort_research_rs::other::parallel_cutover::{self, Config, Entry, Table};
+
+    fn calibrate() -> Table {
+        parallel_cutover::calibrate(&Config {
+            max_len: 10_000,
+            runs: 1,
+            batch_elements: 1_000,
+            tolerance: 0.05,
+        })
+    }
+
+    #[test]
+    fn calibrate_and_load() {
+        let table = calibrate();
+
+        for (name, _) in parallel_cutover::candidates::<i32>() {
+            for elem_size in [4, 8] {
+                for len in [500, 5_000, 5_000_000] {
+                    let threads = table.threads(&name, elem_size, len).unwrap();
+                    assert!(
+                        (1..=table.max_threads).contains(&threads),
+                        "{name} {threads}"
+                    );
+                }
+            }
+        }
+
+        let path =
+            std::env::temp_dir().join(format!("parallel_cutover_test_{}.txt", std::process::id()));
+        table.save(&path).unwrap();
+        let loaded = Table::load(&path);
+        let _ = std::fs::remove_file(&path);
+        assert_eq!(loaded.unwrap(), table);
+    }
+
+    #[test]
+    fn lookup() {
+        let entry = |elem_size, bucket, threads| Entry {
+            sort_name: "par".into(),
+            elem_size,
+            bucket,
+            threads,
+        };
+        let table = Table {
+            cpu: "test".into(),
+            max_threads: 8,
+            entries: vec![
+                entry(4, 2, 1),
+                entry(4, 4, 2),
+                entry(4, 6, 8),
+                entry(8, 2, 1),
+                entry(8, 4, 4),
+            ],
+        };
+
+        assert_eq!(table.threads("other", 4, 1_000_000), None);
+        // Below the first bucket.
+        assert_eq!(table.threads("par", 4, 50), Some(1));
+        assert_eq!(table.threads("par", 4, 50_000), Some(2));
+        assert_eq!(table.threads("par", 4, 100_000_000), Some(8));
+        assert_eq!(table.threads("par", 8, 50_000), Some(4));
+        // 16 byte elements use the 8 byte entries at twice the len, 2 byte ones the 4 byte
+        // entries at half of it.
+        assert_eq!(table.threads("par", 16, 5_000), Some(4));
+        assert_eq!(table.threads("par", 2, 15_000), Some(1));
+    }
+
+    #[test]
+    fn dispatch() {
+        // Another test may have installed its table first, any calibrated table will do.
+        let _ = parallel_cutover::set_table(calibrate());
+
+        #[cfg(feature = "rust_ipnsort_parallel")]
+        {
+            use sort_research_rs::unstable::rust_ipnsort_parallel::SortImpl;
+            sort_test_tools::tests::random::<SortImpl>();
+            sort_test_tools::tests::random_type_u64::<SortImpl>();
+            sort_test_tools::tests::random_d4::<SortImpl>();
+        }
+
+        #[cfg(feature = "cpp_ips4o_parallel")]
+        {
+            use sort_research_rs::unstable::cpp_ips4o_parallel::SortImpl;
+            sort_test_tools::tests::random::<SortImpl>();
+            sort_test_tools::tests::random_type_u64::<SortImpl>();
+            sort_test_tools::tests::random_d4::<SortImpl>();
+            sort_test_tools::tests::random_str::<SortImpl>();
+        }
+
+        #[cfg(feature = "cpp_powersort_parallel")]
+        {
+            use sort_research_rs::stable::cpp_powersort_parallel::SortImpl;
+            sort_test_tools::tests::random::<SortImpl>();
+            sort_test_tools::tests::random_type_u64::<SortImpl>();
+            sort_test_tools::tests::stability::<SortImpl>();
+        }
+    }
+}
+
+#[cfg(all(feature = "cpp_sort_telemetry", feature = "cpp_pdqsort"))]
+mod cpp_sort_telemetry {
+    use sort_research_rs::ffi_util::TelemetryKind;
+    use sort_research_rs::unstable::cpp_pdqsort;
+
+    #[test]
+    fn partition_events() {
+        // Other tests sort with pdqsort concurrently, an unusual len tells this sort's events apart.
+        const LEN: usize = 12_345;
+
+        let mut v = sort_test_tools::patterns::random(LEN);
+        cpp_pdqsort::reset_telemetry();
+        cpp_pdqsort::sort(&mut v);
+        let telemetry = cpp_pdqsort::telemetry();
+
+        assert!(telemetry
+            .events
+            .iter()
+            .any(|event| event.kind() == TelemetryKind::Partition
+                && event.len == LEN as u64
+                && event.depth == 0));
+
+        for event in telemetry
+            .events
+            .iter()
+            .filter(|event| event.kind() == TelemetryKind::Partition)
+        {
+            assert!(event.rank < event.len, "{event}");
+        }
+    }
+}
@@ -5,9 +5,12 @@ import math
 
 
 class BenchEntry:
-    def __init__(self, time, size):
+    def __init__(self, time, size, ci=None):
         self.time_ns = time
         self.size = size
+        # (lower, upper) 95% confidence interval across processes, for results of
+        # run_benchmarks.py --repeat.
+        self.ci = ci
 
 
 def parse_result(path):
@@ -27,9 +30,15 @@ def extract_groups(bench_result):
         #     size_range = "-20-plus"
 
         ty = "-".join(entry_parts[:3])
-        bench_time = value["criterion_estimates_v1"]["median"]["point_estimate"]
+        median = value["criterion_estimates_v1"]["median"]
+        bench_time = median["point_estimate"]
 
-        groups.setdefault(ty, {})[benchmark] = BenchEntry(bench_time, test_len)
+        ci = None
+        if "repeat" in bench_result:
+            interval = median["confidence_interval"]
+            ci = (interval["lower_bound"], interval["upper_bound"])
+
+        groups.setdefault(ty, {})[benchmark] = BenchEntry(bench_time, test_len, ci)
 
     return groups
 
@@ -64,8 +73,17 @@ def analyze_group_pair(group_a, group_b):
     # Threshold, anything below this is considered noise and not relevant.
     threshold = 1.02
 
+    # With confidence intervals of repeated runs on both sides, differences whose intervals
+    # overlap are counted as unchanged.
+    def is_separated(entry_a, entry_b):
+        if entry_a.ci is None or entry_b.ci is None:
+            return True
+        return entry_a.ci[1] < entry_b.ci[0] or entry_b.ci[1] < entry_a.ci[0]
+
     bench_times = [
         (entry_a.time_ns, group_b[bench_name].time_ns)
+        if is_separated(entry_a, group_b[bench_name])
+        else (entry_a.time_ns, entry_a.time_ns)
         for bench_name, entry_a in group_a.items()
     ]
 
@@ -130,8 +148,89 @@ def analyze_bench_results(result_a, result_b):
         print(f"{name_padded}{a_vs_b}")
 
 
+def extract_perf_groups(bench_result, result_key="perf_counters"):
+    """Same grouping as extract_groups, for the PERF_COUNTERS or the RAPL_ENERGY results."""
+    groups = {}
+
+    for benchmark, counters in bench_result.get(result_key, {}).items():
+        ty = "-".join(benchmark.split("-")[:3])
+        groups.setdefault(ty, {})[benchmark] = counters
+
+    return groups
+
+
+def median_counter(group, counter_name):
+    values = [
+        counters[counter_name]
+        for counters in group.values()
+        if counters.get(counter_name) is not None
+    ]
+
+    return statistics.median(values) if len(values) > 0 else None
+
+
+def analyze_perf_counters(result_a, result_b):
+    groups_a = extract_perf_groups(result_a)
+    groups_b = extract_perf_groups(result_b)
+
+    if len(groups_a) == 0 or len(groups_b) == 0:
+        return
+
+    print("\nHardware counters, median per element a vs b")
+
+    for name, group_a in sorted(groups_a.items()):
+        group_b = groups_b.get(name)
+        if group_b is None:
+            continue
+
+        counter_names = sorted(
+            {counter for counters in group_a.values() for counter in counters}
+        )
+
+        columns = []
+        for counter_name in counter_names:
+            val_a = median_counter(group_a, counter_name)
+            val_b = median_counter(group_b, counter_name)
+            if val_a is None or val_b is None:
+                continue
+
+            columns.append(f"{counter_name}: {val_a:.3f} vs {val_b:.3f}")
+
+        name_padded = f"[{name}]:".ljust(35)
+        print(f"{name_padded}{'  '.join(columns)}")
+
+
+def analyze_rapl_energy(result_a, result_b):
+    groups_a = extract_perf_groups(result_a, "rapl_energy")
+    groups_b = extract_perf_groups(result_b, "rapl_energy")
+
+    if len(groups_a) == 0 or len(groups_b) == 0:
+        return
+
+    print("\nRAPL energy, median nJ per element a vs b")
+
+    for name, group_a in sorted(groups_a.items()):
+        group_b = groups_b.get(name)
+        if group_b is None:
+            continue
+
+        columns = []
+        for domain in ["package", "dram"]:
+            val_a = median_counter(group_a, domain)
+            val_b = median_counter(group_b, domain)
+            if val_a is None or val_b is None:
+                continue
+
+            columns.append(f"{domain}: {val_a * 1e9:.3f} vs {val_b * 1e9:.3f}")
+
+        name_padded = f"[{name}]:".ljust(35)
+        print(f"{name_padded}{'  '.join(columns)}")
+
+
 if __name__ == "__main__":
     result_a = parse_result(sys.argv[1])
     result_b = parse_result(sys.argv[2])
 
     analyze_bench_results(result_a, result_b)
+    analyze_perf_counters(result_a, result_b)
+    analyze_rapl_energy(result_a, result_b)
@@ -16,7 +16,7 @@ def bucketize_comp_data(name: str):
     result = collections.defaultdict(list)
 
     for line in comp_data.splitlines():
-        if line.startswith(name):
+        if line.startswith(name) and "-comp-" in line:
             entry = line.partition("-comp-")[2]
 
             entry_parts = entry.split("-")
@@ -91,8 +91,130 @@ def analyze(name_a, name_b):
     )
 
 
+def extract_op_counts(comp_data):
+    # Parses the -ops- lines printed for the C++ sorts that provide
+    # sort_counted. Result layout:
+    # { type (eg. u64):
+    #   { pattern (eg. descending):
+    #     { sort_name (eg. cpp_pdqsort_unstable):
+    #       { test_len (eg. 500):
+    #          (comparisons, copies, moves)
+    groups = collections.defaultdict(
+        lambda: collections.defaultdict(lambda: collections.defaultdict(dict))
+    )
+
+    for line in comp_data.splitlines():
+        if "-ops-" not in line:
+            continue
+
+        sort_name, _, entry = line.partition("-ops-")
+        name, _, counts = entry.partition(": ")
+
+        ty, pattern, test_len = name.split("-")
+        test_len = int(test_len)
+
+        if test_len < 2:
+            continue  # These don't make sense and mess up calc
+
+        counts_parts = counts.split()
+        groups[ty][pattern][sort_name][test_len] = (
+            int(counts_parts[1]),
+            int(counts_parts[3]),
+            int(counts_parts[5]),
+        )
+
+    return groups
+
+
+def plot_moves(comp_data):
+    # Only needed for the plots, the analysis above works without bokeh.
+    from bokeh import models
+    from bokeh.plotting import figure, ColumnDataSource
+    from bokeh.resources import CDN
+    from bokeh.embed import file_html
+    from bokeh.palettes import Colorblind
+
+    for ty, val1 in extract_op_counts(comp_data).items():
+        for pattern, sort_values in val1.items():
+            plot_name = f"{ty}-moves-{pattern}"
+            plot = figure(
+                title=plot_name,
+                x_axis_label="Input length (log)",
+                x_axis_type="log",
+                y_axis_label="Element moves and copies / N | Lower is better",
+                plot_width=1000,
+                plot_height=600,
+                tools="pan,wheel_zoom,box_zoom,reset",
+            )
+            plot.add_tools(
+                models.HoverTool(
+                    tooltips=[
+                        ("Sort", "@sort_names"),
+                        ("Test Size", "@test_sizes"),
+                        ("Moves / N", "@moves{0.00}"),
+                        ("Copies / N", "@copies{0.00}"),
+                        ("Comparisons / N", "@comparisons{0.00}"),
+                    ],
+                )
+            )
+            plot.add_layout(models.Legend(), "right")
+
+            palette = list(Colorblind[8])
+
+            for i, (sort_name, values) in enumerate(sorted(sort_values.items())):
+                test_sizes = sorted(values.keys())
+
+                def per_elem(index):
+                    return [
+                        values[test_len][index] / test_len
+                        for test_len in test_sizes
+                    ]
+
+                # Some implementations copy where others move, e.g. merging
+                # back from a copied run. Both are element transfers, plot
+                # their sum and show the split on hover.
+                data = {
+                    "test_sizes": test_sizes,
+                    "comparisons": per_elem(0),
+                    "copies": per_elem(1),
+                    "moves": per_elem(2),
+                    "transfers": [
+                        sum(values[test_len][1:]) / test_len
+                        for test_len in test_sizes
+                    ],
+                    "sort_names": [sort_name] * len(test_sizes),
+                }
+                source = ColumnDataSource(data=data)
+                color = palette[i % len(palette)]
+
+                plot.line(
+                    x="test_sizes",
+                    y="transfers",
+                    source=source,
+                    line_width=1.5,
+                    color=color,
+                    legend_label=sort_name,
+                )
+                plot.circle(
+                    x="test_sizes",
+                    y="transfers",
+                    source=source,
+                    size=6,
+                    fill_color=None,
+                    line_color=color,
+                    legend_label=sort_name,
+                )
+
+            html = file_html(plot, CDN, plot_name)
+            with open(f"{plot_name}.html", "w+") as outfile:
+                outfile.write(html)
+
+
 if __name__ == "__main__":
     with open(sys.argv[1], "r") as comp_data_file:
         comp_data = comp_data_file.read()
 
-    analyze("rust_std_unstable", "rust_new_unstable")
+    if len(sys.argv) > 2 and sys.argv[2] == "--plot-moves":
+        plot_moves(comp_data)
+    else:
+        analyze("rust_std_unstable", "rust_new_unstable")
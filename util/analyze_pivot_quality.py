@@ -20,8 +20,10 @@ if __name__ == "__main__":
             continue
 
         a, _, b = line.partition("is_less:")
-        len = int(a.partition("len:")[2].strip())
-        is_less = int(b.strip())
+        # Also accepts the "len: 10, is_less: 4, depth: 0" lines of
+        # Telemetry from the cpp_sort_telemetry feature.
+        len = int(a.partition("len:")[2].strip().rstrip(","))
+        is_less = int(b.partition(",")[0].strip())
         len_div_2 = len / 2
 
         # Ideally each partition operation halves the input.
@@ -6,19 +6,27 @@ rustc --version
 
 RESULT_TABLE=""
 
+# One line per measurement: profile sort_name type size. Consumed by
+# util/graph_bench_result/pareto.py.
+SIZES_PATH="out/binary_sizes.txt"
+
 function measure_binary_size_type_impl() {
+    # $1 profile, $2 type feature, $3 type name, $4 sort name, $5 optional sort feature.
     mkdir -p out
     BIN_PATH="target/$1/binary-size-measurement"
 
+    FEATURES="$2${5:+,$5}"
+    OUT_NAME="$4_$2_$1"
+
     tmpfile=$(mktemp)
 
-    cargo bloat --profile=$1 --features $2 --no-relative-size -n 0 --message-format json > out/baseline_$2_$1.json 2> "$tmpfile"
+    cargo bloat --profile=$1 --features $FEATURES --no-relative-size -n 0 --message-format json > out/baseline_$OUT_NAME.json 2> "$tmpfile"
 
     if [ $? -ne 0 ]; then
         cat "$tmpfile"
     fi
 
-    cargo bloat --profile=$1 --features $2,sort_inst --no-relative-size -n 0 --message-format json > out/with_sort_$2_$1.json 2> "$tmpfile"
+    cargo bloat --profile=$1 --features $FEATURES,sort_inst --no-relative-size -n 0 --message-format json > out/with_sort_$OUT_NAME.json 2> "$tmpfile"
 
     if [ $? -ne 0 ]; then
         cat "$tmpfile"
@@ -26,22 +34,44 @@ function measure_binary_size_type_impl() {
 
     rm "$tmpfile"
 
-    BINARY_SIZE=$(python eval_bloat.py out/baseline_$2_$1.json out/with_sort_$2_$1.json)
-    RESULT_TABLE="$RESULT_TABLE$1 $3 $BINARY_SIZE\n"
+    BINARY_SIZE=$(python eval_bloat.py out/baseline_$OUT_NAME.json out/with_sort_$OUT_NAME.json)
+    RESULT_TABLE="$RESULT_TABLE$1 $4 $3 $BINARY_SIZE\n"
+    echo "$1 $4 $3 $BINARY_SIZE" >> "$SIZES_PATH"
 }
 
 function measure_binary_size() {
     RESULT_TABLE="$RESULT_TABLE----------------------------\n"
-    measure_binary_size_type_impl "$1" "type_u64" "u64"
-    measure_binary_size_type_impl "$1" "type_string" "string"
+    measure_binary_size_type_impl "$1" "type_u64" "u64" "rust_ipnsort_unstable"
+    measure_binary_size_type_impl "$1" "type_string" "string" "rust_ipnsort_unstable"
+}
+
+# The C++ sorts only support the FFI types, so String is not measured. The size includes all code
+# reachable from the FFI entry point of the type, e.g. every Highway target of vqsort.
+function measure_binary_size_cpp() {
+    for TYPE in "i32" "u64"; do
+        RESULT_TABLE="$RESULT_TABLE----------------------------\n"
+        measure_binary_size_type_impl "$1" "type_$TYPE" "$TYPE" "rust_ipnsort_unstable"
+        measure_binary_size_type_impl "$1" "type_$TYPE" "$TYPE" "cpp_ips4o_unstable" "cpp_ips4o"
+        measure_binary_size_type_impl "$1" "type_$TYPE" "$TYPE" "cpp_vqsort" "cpp_vqsort"
+        measure_binary_size_type_impl "$1" "type_$TYPE" "$TYPE" "cpp_pdqsort_unstable" "cpp_pdqsort"
+        measure_binary_size_type_impl "$1" "type_$TYPE" "$TYPE" "cpp_blockquicksort_unstable" "cpp_blockquicksort"
+        measure_binary_size_type_impl "$1" "type_$TYPE" "$TYPE" "cpp_powersort_stable" "cpp_powersort"
+    done
 }
 
-measure_binary_size "release"
+mkdir -p out
+rm -f "$SIZES_PATH"
 
 set +u
 PARAM_1="$1"
 set -u
 
+if [ "$PARAM_1" = "cpp" ]; then
+    measure_binary_size_cpp "release"
+else
+    measure_binary_size "release"
+fi
+
 if [ "$PARAM_1" = "all" ]; then
     measure_binary_size "release_lto_thin"
     measure_binary_size "release_lto_thin_opt_level_s"
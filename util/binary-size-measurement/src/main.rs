@@ -7,10 +7,24 @@ fn instantiate_sort<T: Ord>(v: &mut [T]) {
     // v.sort();
     // v.sort_unstable();
 
+    #[cfg(not(feature = "cpp_sort"))]
     ipnsort::sort(v);
 
-    // use sort_test_tools::Sort;
-    // sort_research_rs::unstable::cpp_nanosort::SortImpl::sort(v);
+    #[cfg(feature = "cpp_sort")]
+    {
+        use sort_test_tools::Sort;
+
+        #[cfg(feature = "cpp_ips4o")]
+        sort_research_rs::unstable::cpp_ips4o::SortImpl::sort(v);
+        #[cfg(feature = "cpp_vqsort")]
+        sort_research_rs::other::cpp_vqsort::SortImpl::sort(v);
+        #[cfg(feature = "cpp_pdqsort")]
+        sort_research_rs::unstable::cpp_pdqsort::SortImpl::sort(v);
+        #[cfg(feature = "cpp_blockquicksort")]
+        sort_research_rs::unstable::cpp_blockquicksort::SortImpl::sort(v);
+        #[cfg(feature = "cpp_powersort")]
+        sort_research_rs::stable::cpp_powersort::SortImpl::sort(v);
+    }
 }
 
 #[inline(never)]
@@ -25,11 +39,17 @@ fn produce_slice<T>() -> &'static mut [T] {
 }
 
 fn main() {
+    let input_i32 = produce_slice::<i32>();
     let input_u64 = produce_slice::<u64>();
     let input_string = produce_slice::<String>();
 
     #[cfg(feature = "sort_inst")]
     {
+        #[cfg(feature = "type_i32")]
+        {
+            instantiate_sort(input_i32);
+        }
+
         #[cfg(feature = "type_u64")]
         {
             instantiate_sort(input_u64);
@@ -41,6 +61,7 @@ fn main() {
         }
     }
 
+    black_box(input_i32); // side-effect
     black_box(input_u64); // side-effect
     black_box(input_string); // side-effect
 }
@@ -0,0 +1,146 @@
+"""
+Measures the compile time and peak memory of the C++ sort wrappers, compiled
+with the same flags as build.rs. With clang it also lists the template
+instantiations that took the longest, via -ftime-trace.
+
+--split measures the cpp_split_instantiation mode, where the expensive
+instantiations are compiled in a separate translation unit. The wrapper alone
+is then what an edit to it or shared.h recompiles, given a compiler cache.
+
+Usage: measure_cpp.py [--compiler clang++] [--split] [--runs 3] [wrapper ...]
+"""
+
+import argparse
+import json
+import os
+import statistics
+import subprocess
+import tempfile
+import time
+
+from collections import defaultdict
+
+CPP_DIR = os.path.join(
+    os.path.dirname(os.path.abspath(__file__)), "..", "..", "src", "cpp"
+)
+
+WRAPPERS = [
+    "cpp_vqsort",
+    "cpp_ips4o",
+    "cpp_pdqsort",
+    "cpp_blockquicksort",
+    "cpp_powersort",
+]
+
+# The wrappers that have a separate instantiation unit, see build.rs.
+SPLIT_INSTANTIATION_UNITS = {
+    "cpp_vqsort": "cpp_vqsort_inst",
+    "cpp_ips4o": "cpp_ips4o_inst",
+}
+
+# Same as build_and_link_cpp_sort in build.rs.
+BASE_FLAGS = ["-std=c++20", "-O3", "-DNDEBUG", "-w", "-c"]
+
+
+def is_clang(compiler):
+    output = subprocess.run(
+        [compiler, "--version"], capture_output=True, text=True, check=True
+    ).stdout
+
+    return "clang" in output
+
+
+def compile_unit(compiler, unit, defines, out_dir, time_trace):
+    """Compiles unit and returns the wall time in seconds, the peak memory in
+    MiB and the path of the time trace, if any."""
+    out_path = os.path.join(out_dir, f"{unit}.o")
+
+    args = [compiler, *BASE_FLAGS, *[f"-D{define}" for define in defines]]
+    if time_trace:
+        args.append("-ftime-trace")
+    args += [os.path.join(CPP_DIR, f"{unit}.cpp"), "-o", out_path]
+
+    start = time.perf_counter()
+    process = subprocess.Popen(args)
+    _, status, rusage = os.wait4(process.pid, 0)
+    duration = time.perf_counter() - start
+
+    if os.waitstatus_to_exitcode(status) != 0:
+        raise Exception(f"Failed to compile {unit}: {' '.join(args)}")
+
+    # ru_maxrss is in KiB on Linux.
+    peak_mib = rusage.ru_maxrss / 1024
+
+    trace_path = os.path.join(out_dir, f"{unit}.json") if time_trace else None
+
+    return duration, peak_mib, trace_path
+
+
+def top_instantiations(trace_path, count):
+    """Sums the time spent per instantiated template, nested instantiations
+    are included in the time of the enclosing one."""
+    with open(trace_path, "r") as file:
+        trace = json.load(file)
+
+    durations_us = defaultdict(int)
+    for event in trace["traceEvents"]:
+        if event.get("name") in ("InstantiateFunction", "InstantiateClass"):
+            durations_us[event["args"]["detail"]] += event["dur"]
+
+    return sorted(durations_us.items(), key=lambda x: x[1], reverse=True)[:count]
+
+
+def measure_unit(compiler, unit, defines, runs, time_trace, top_count):
+    durations = []
+    peak_mibs = []
+
+    with tempfile.TemporaryDirectory() as out_dir:
+        for i in range(runs):
+            duration, peak_mib, trace_path = compile_unit(
+                compiler, unit, defines, out_dir, time_trace and i == 0
+            )
+            durations.append(duration)
+            peak_mibs.append(peak_mib)
+
+            if trace_path is not None:
+                for detail, duration_us in top_instantiations(trace_path, top_count):
+                    print(f"    {duration_us / 1e6:>7.2f}s {detail}")
+
+    return statistics.median(durations), max(peak_mibs)
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser()
+    parser.add_argument("wrappers", nargs="*", default=WRAPPERS)
+    parser.add_argument("--compiler", default=os.environ.get("CXX", "c++"))
+    parser.add_argument("--split", action="store_true")
+    parser.add_argument("--runs", type=int, default=3)
+    parser.add_argument("--top", type=int, default=10)
+    args = parser.parse_args()
+
+    time_trace = is_clang(args.compiler)
+    if not time_trace:
+        print("Not clang, the instantiations are not listed.")
+
+    results = []
+
+    for wrapper in args.wrappers:
+        units = [(wrapper, [])]
+
+        inst_unit = SPLIT_INSTANTIATION_UNITS.get(wrapper)
+        if args.split and inst_unit is not None:
+            units = [
+                (wrapper, ["CPP_SPLIT_INSTANTIATION"]),
+                (inst_unit, ["CPP_SPLIT_INSTANTIATION"]),
+            ]
+
+        for unit, defines in units:
+            print(f"{unit}:")
+            duration, peak_mib = measure_unit(
+                args.compiler, unit, defines, args.runs, time_trace, args.top
+            )
+            results.append((unit, duration, peak_mib))
+
+    print(f"\n{'unit':<24} {'time':>8} {'peak memory':>12}")
+    for unit, duration, peak_mib in results:
+        print(f"{unit:<24} {duration:>7.2f}s {peak_mib:>8.0f} MiB")
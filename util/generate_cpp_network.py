@@ -0,0 +1,220 @@
+"""
+Generates src/cpp/fixed_network_sort.h, one sorting network per length from 2 to MAX_LEN, for
+compile time fixed lengths.
+
+Lengths with a known smaller network take that one, the 20 element network of
+generate_swap_if.py and the networks of src/other/small_sort. All other lengths use Batcher's
+merge exchange, which works for any length. Every network is checked with the 0-1 principle before
+it is written, exhaustively up to MAX_VERIFY_LEN, Batcher's construction is correct by design above
+that.
+"""
+
+import os
+
+import generate_swap_if
+
+MAX_LEN = 32
+MAX_VERIFY_LEN = 24
+
+OUT_PATH = os.path.join(
+    os.path.dirname(os.path.abspath(__file__)), "..", "src", "cpp", "fixed_network_sort.h"
+)
+
+# Same networks as sort4_unstable_cmp_swap and sort10_unstable_cmp_swaps.
+KNOWN_NETWORKS = {
+    4: [[(0, 1), (2, 3)], [(0, 2), (1, 3)], [(1, 2)]],
+    10: [
+        [(0, 8), (1, 9), (2, 7), (3, 5), (4, 6)],
+        [(0, 2), (1, 4), (5, 8), (7, 9)],
+        [(0, 3), (2, 4), (5, 7), (6, 9)],
+        [(0, 1), (3, 6), (8, 9)],
+        [(1, 5), (2, 3), (4, 8), (6, 7)],
+        [(1, 2), (3, 5), (4, 6), (7, 8)],
+        [(2, 3), (4, 5), (6, 7)],
+        [(3, 4), (5, 6)],
+    ],
+}
+
+
+def parse_layers(vals):
+    """Parses the layer per line format of generate_swap_if.py and generate_network.py."""
+    layers = []
+    for line in vals.strip().split("\n"):
+        layer = []
+        for pair in line.replace("[", "").replace("]", ",").split("),"):
+            parts = pair[1:].split(",")
+            if len(parts) == 2:
+                layer.append((int(parts[0]), int(parts[1])))
+        layers.append(layer)
+
+    return layers
+
+
+KNOWN_NETWORKS[20] = parse_layers(generate_swap_if.vals)
+
+
+def batcher_merge_exchange(n):
+    """Knuth, TAOCP Vol. 3, 5.2.2 Algorithm M. Every (p, q) step is one layer."""
+    layers = []
+
+    t = max(n - 1, 1).bit_length()
+    p = 1 << (t - 1)
+    while p > 0:
+        q = 1 << (t - 1)
+        r = 0
+        d = p
+        while d > 0:
+            layers.append([(i, i + d) for i in range(n - d) if (i & p) == r])
+            d = q - p
+            q >>= 1
+            r = p
+        p >>= 1
+
+    return [layer for layer in layers if layer]
+
+
+def is_sorting_network(n, pairs):
+    # Bit k of wire i is bit i of input k, so a single pass covers all 2^n 0-1 inputs.
+    all_bits = (1 << (1 << n)) - 1
+    wires = []
+    for i in range(n):
+        block = ((1 << (1 << i)) - 1) << (1 << i)
+        mask = block
+        width = 2 << i
+        while width < (1 << n):
+            mask |= mask << width
+            width *= 2
+        wires.append(mask & all_bits)
+
+    for a, b in pairs:
+        wires[a], wires[b] = wires[a] & wires[b], wires[a] | wires[b]
+
+    return all(wires[i] & ~wires[i + 1] == 0 for i in range(n - 1))
+
+
+def network_for_len(n):
+    layers = batcher_merge_exchange(n)
+
+    known_layers = KNOWN_NETWORKS.get(n)
+    if known_layers is not None and sum(map(len, known_layers)) < sum(map(len, layers)):
+        layers = known_layers
+
+    if n <= MAX_VERIFY_LEN:
+        pairs = [pair for layer in layers for pair in layer]
+        assert is_sorting_network(n, pairs), f"Invalid network for len {n}"
+
+    return layers
+
+
+def make_network_struct(n, layers):
+    comparator_count = sum(map(len, layers))
+
+    lines = [
+        "template <>",
+        f"struct FixedNetwork<{n}> {{",
+        "  template <typename T>",
+        "  static void sort(T* v) noexcept {",
+        f"    // {comparator_count} compare-exchanges, depth {len(layers)}.",
+    ]
+
+    for layer_i, layer in enumerate(layers):
+        if layer_i != 0:
+            lines.append("")
+        for a, b in layer:
+            lines.append(f"    cmp_swap(v, {a}, {b});")
+
+    lines += ["  }", "};"]
+
+    return "\n".join(lines)
+
+
+HEADER = """#pragma once
+
+// Generated by util/generate_cpp_network.py, do not edit.
+//
+// Sorting networks for the lengths 2 to FIXED_NETWORK_MAX_LEN, with the length
+// known at compile time. All compare-exchanges are branchless, so the time is
+// independent of the input order.
+
+#include <cstddef>
+
+namespace fixed_network_sort {{
+
+constexpr size_t FIXED_NETWORK_MAX_LEN = {max_len};
+
+template <typename T>
+inline void cmp_swap(T* v, size_t a, size_t b) noexcept {{
+  const T x = v[a];
+  const T y = v[b];
+  const bool should_swap = y < x;
+  v[a] = should_swap ? y : x;
+  v[b] = should_swap ? x : y;
+}}
+
+template <size_t N>
+struct FixedNetwork;
+
+template <>
+struct FixedNetwork<0> {{
+  template <typename T>
+  static void sort(T*) noexcept {{}}
+}};
+
+template <>
+struct FixedNetwork<1> {{
+  template <typename T>
+  static void sort(T*) noexcept {{}}
+}};
+"""
+
+FOOTER = """
+// Sorts v[0..N).
+template <size_t N, typename T>
+inline void sort(T* v) noexcept {{
+  static_assert(N <= FIXED_NETWORK_MAX_LEN, "No sorting network for N");
+  FixedNetwork<N>::sort(v);
+}}
+
+// Runtime dispatch to the network for len, returns false if len is larger than
+// FIXED_NETWORK_MAX_LEN.
+template <typename T>
+inline bool sort_dispatch(T* v, size_t len) noexcept {{
+  switch (len) {{
+{cases}
+    default:
+      return false;
+  }}
+}}
+
+}}  // namespace fixed_network_sort
+
+// Calls X(N) for every N that has a network, for defining per length entry
+// points.
+#define FIXED_NETWORK_SORT_FOR_EACH_LEN(X) \\
+{for_each}
+"""
+
+
+def make_header():
+    structs = [make_network_struct(n, network_for_len(n)) for n in range(2, MAX_LEN + 1)]
+
+    cases = "\n".join(
+        f"    case {n}:\n      sort<{n}>(v);\n      return true;" for n in range(MAX_LEN + 1)
+    )
+    lens = list(range(2, MAX_LEN + 1))
+    for_each = " \\\n".join(
+        "  " + " ".join(f"X({n})" for n in lens[i : i + 8]) for i in range(0, len(lens), 8)
+    )
+
+    return (
+        HEADER.format(max_len=MAX_LEN)
+        + "\n"
+        + "\n\n".join(structs)
+        + "\n"
+        + FOOTER.format(cases=cases, for_each=for_each)
+    )
+
+
+if __name__ == "__main__":
+    with open(OUT_PATH, "w") as out_file:
+        out_file.write(make_header())
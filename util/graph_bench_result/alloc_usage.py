@@ -0,0 +1,155 @@
+"""
+Produce graphs that show the peak auxiliary heap memory and the number of
+allocations of each sort, as measured by MEASURE_ALLOC.
+"""
+
+import sys
+
+from collections import defaultdict
+
+from bokeh import models
+from bokeh.plotting import figure, ColumnDataSource
+from bokeh.resources import CDN
+from bokeh.embed import file_html
+from bokeh.palettes import Colorblind
+
+from util import base_name, plot_name_suffix
+
+
+def extract_groups(alloc_data):
+    # Result layout:
+    # { type (eg. u64):
+    #   { pattern (eg. descending):
+    #     { sort_name (eg. rust_std_stable):
+    #       { test_len (eg. 500):
+    #          (peak_bytes, mean_allocations)
+    groups = defaultdict(lambda: defaultdict(lambda: defaultdict(lambda: {})))
+
+    for line in alloc_data.splitlines():
+        if "-alloc-" not in line or "peak bytes:" not in line:
+            continue
+
+        sort_name, _, entry = line.partition("-alloc-")
+        name, _, stats = entry.partition(": ")
+
+        ty, pattern, test_len = name.split("-")
+        test_len = int(test_len)
+
+        if test_len < 2:
+            continue  # These don't make sense and mess up calc
+
+        stats_parts = stats.split()
+        peak_bytes = int(stats_parts[2])
+        mean_allocations = float(stats_parts[5])
+
+        groups[ty][pattern][sort_name][test_len] = (
+            peak_bytes,
+            mean_allocations,
+        )
+
+    return groups
+
+
+# Needs to be shared instance :/
+TOOLS = None
+
+
+def init_tools():
+    global TOOLS
+    TOOLS = [
+        models.WheelZoomTool(),
+        models.BoxZoomTool(),
+        models.PanTool(),
+        models.HoverTool(
+            tooltips=[
+                ("Sort", "@sort_names"),
+                ("Test Size", "@test_sizes"),
+                ("Peak bytes / N", "@bytes_per_elem{0.00}"),
+                ("Peak bytes", "@peak_bytes"),
+                ("Mean allocations", "@allocations{0.00}"),
+            ],
+        ),
+        models.ResetTool(),
+    ]
+
+
+def add_tools_to_plot(plot):
+    plot.add_tools(*TOOLS)
+
+    plot.toolbar.active_scroll = None
+    plot.toolbar.active_tap = None
+    plot.toolbar.active_drag = TOOLS[1]
+
+
+def plot_alloc_usage(ty, pattern, sort_values):
+    plot_name = f"{ty}-alloc-{pattern}{plot_name_suffix()}"
+    plot = figure(
+        title=plot_name,
+        x_axis_label="Input length (log)",
+        x_axis_type="log",
+        y_axis_label="Peak auxiliary heap bytes / N | Lower is better",
+        plot_width=1000,
+        plot_height=600,
+        tools="",
+    )
+    add_tools_to_plot(plot)
+
+    plot.add_layout(models.Legend(), "right")
+
+    palette = list(Colorblind[8])
+
+    for i, (sort_name, values) in enumerate(sorted(sort_values.items())):
+        test_sizes = sorted(values.keys())
+
+        data = {
+            "test_sizes": test_sizes,
+            "bytes_per_elem": [
+                values[test_len][0] / test_len for test_len in test_sizes
+            ],
+            "peak_bytes": [values[test_len][0] for test_len in test_sizes],
+            "allocations": [values[test_len][1] for test_len in test_sizes],
+            "sort_names": [sort_name] * len(test_sizes),
+        }
+        source = ColumnDataSource(data=data)
+        color = palette[i % len(palette)]
+
+        plot.line(
+            x="test_sizes",
+            y="bytes_per_elem",
+            source=source,
+            line_width=1.5,
+            color=color,
+            legend_label=sort_name,
+        )
+        plot.circle(
+            x="test_sizes",
+            y="bytes_per_elem",
+            source=source,
+            size=6,
+            fill_color=None,
+            line_color=color,
+            legend_label=sort_name,
+        )
+
+    return plot_name, plot
+
+
+def plot_alloc(alloc_data):
+    groups = extract_groups(alloc_data)
+
+    for ty, val1 in groups.items():
+        for pattern, sort_values in val1.items():
+            init_tools()
+
+            plot_name, plot = plot_alloc_usage(ty, pattern, sort_values)
+
+            html = file_html(plot, CDN, plot_name)
+            with open(f"{base_name()}-{plot_name}.html", "w+") as outfile:
+                outfile.write(html)
+
+
+if __name__ == "__main__":
+    with open(sys.argv[1], "r") as alloc_data_file:
+        alloc_data = alloc_data_file.read()
+
+    plot_alloc(alloc_data)
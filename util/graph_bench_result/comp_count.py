@@ -38,7 +38,8 @@ def extract_groups(comp_data):
     )
 
     for line in comp_data.splitlines():
-        if ":" not in line:
+        # Skips the -ops- lines of the C++ sorts, see analyze_comp_count.py.
+        if ":" not in line or "-comp-" not in line:
             continue
 
         sort_name, _, entry = line.partition("-")
@@ -28,6 +28,18 @@ def detail_get_cpu_info(name):
         cpu_boost_ghz = 4.8
         cpu_arch = "Skylake"
         os_name = "Windows"
+    elif "graviton2" in name_lower:
+        cpu_boost_ghz = 2.5
+        cpu_arch = "Graviton 2 (Neoverse N1)"
+        os_name = "Linux"
+    elif "graviton3" in name_lower:
+        cpu_boost_ghz = 2.6
+        cpu_arch = "Graviton 3 (Neoverse V1)"
+        os_name = "Linux"
+    elif "graviton4" in name_lower:
+        cpu_boost_ghz = 2.8
+        cpu_arch = "Graviton 4 (Neoverse V2)"
+        os_name = "Linux"
 
     return cpu_arch, cpu_boost_ghz, os_name
 
@@ -3,7 +3,13 @@ import sys
 import subprocess
 import shutil
 
-PLOTS = ["scaling", "single_size", "direct_versus"]
+PLOTS = [
+    "scaling",
+    "single_size",
+    "direct_versus",
+    "thread_scaling",
+    "roofline",
+]
 
 from util import parse_skip
 
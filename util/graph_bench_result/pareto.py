@@ -0,0 +1,234 @@
+"""
+Produce a scatter plot of code size versus throughput, one per type and
+prediction state, highlighting the Pareto front, the implementations no other
+implementation beats in both size and speed.
+
+Usage: pareto.py <binary_sizes.txt> <bench_result.json>...
+
+binary_sizes.txt is written by util/binary-size-measurement/measure.sh, the
+profile is selected with the PROFILE environment variable, default release.
+"""
+
+import math
+import os
+import sys
+
+from bokeh import models
+from bokeh.plotting import figure, ColumnDataSource
+from bokeh.resources import CDN
+from bokeh.embed import file_html
+from bokeh.models import LabelSet
+
+from cpu_info import get_cpu_info
+from util import (
+    parse_bench_results,
+    build_implementation_meta_info,
+    plot_name_suffix,
+)
+
+CPU_INFO = None
+
+# Needs to be shared instance :/
+TOOLS = None
+
+
+def init_tools():
+    global TOOLS
+    TOOLS = [
+        models.WheelZoomTool(),
+        models.BoxZoomTool(),
+        models.PanTool(),
+        models.HoverTool(
+            tooltips=[
+                ("Sort", "@name"),
+                ("Code size in bytes", "@x"),
+                ("Elements per ns", "@y"),
+            ],
+        ),
+        models.ResetTool(),
+    ]
+
+
+def add_tools_to_plot(plot):
+    plot.add_tools(*TOOLS)
+
+    plot.toolbar.active_scroll = None
+    plot.toolbar.active_tap = None
+    plot.toolbar.active_drag = TOOLS[1]
+
+
+def parse_binary_sizes(path, profile):
+    # Result layout:
+    # { type (eg. u64):
+    #   { sort_name (eg. cpp_pdqsort_unstable):
+    #     size_bytes
+    sizes = {}
+
+    with open(path, "r") as file:
+        for line in file:
+            parts = line.split()
+            if len(parts) != 4 or parts[0] != profile:
+                continue
+
+            _profile, sort_name, ty, size = parts
+            sizes.setdefault(ty, {})[sort_name] = int(size)
+
+    return sizes
+
+
+def geo_mean_throughput(values, sort_names):
+    """Geometric mean of elements per ns, across all lengths and patterns
+    measured for every one of sort_names."""
+    log_sums = {sort_name: 0.0 for sort_name in sort_names}
+    count = 0
+
+    for test_len, val in values.items():
+        if test_len < 1:
+            continue
+
+        for pattern_values in val.values():
+            if not all(sort_name in pattern_values for sort_name in sort_names):
+                continue
+
+            for sort_name in sort_names:
+                log_sums[sort_name] += math.log(test_len / pattern_values[sort_name])
+            count += 1
+
+    if count == 0:
+        return None
+
+    return {
+        sort_name: math.exp(log_sum / count) for sort_name, log_sum in log_sums.items()
+    }
+
+
+def pareto_front(points):
+    """Returns the points that are neither larger nor slower than any other,
+    ordered by size."""
+    front = []
+    for point in sorted(points, key=lambda point: (point[1], -point[2])):
+        if len(front) == 0 or point[2] > front[-1][2]:
+            front.append(point)
+
+    return front
+
+
+IMPL_META_INFO = build_implementation_meta_info()
+
+
+def plot_pareto(ty, prediction_state, points):
+    front = pareto_front(points)
+    front_names = set(name for name, _, _ in front)
+
+    colors = []
+    markers = []
+    for name, _, _ in points:
+        color, marker = IMPL_META_INFO.get(name, ("gray", "square"))
+        colors.append(color)
+        markers.append(marker)
+
+    source = ColumnDataSource(
+        data={
+            "name": [name for name, _, _ in points],
+            "x": [size for _, size, _ in points],
+            "y": [throughput for _, _, throughput in points],
+            "colors": colors,
+            "markers": markers,
+            "alpha": [1.0 if name in front_names else 0.4 for name, _, _ in points],
+        }
+    )
+
+    plot_name = f"pareto-{prediction_state}-{ty}{plot_name_suffix()}"
+    plot = figure(
+        x_axis_label=f"Code size (bytes) | Lower is better | {CPU_INFO}",
+        y_axis_label="Geometric mean throughput (elements per ns) | Higher is better",
+        title=plot_name,
+        tools="",
+        plot_width=800,
+        plot_height=600,
+    )
+
+    add_tools_to_plot(plot)
+
+    plot.step(
+        x=[size for _, size, _ in front],
+        y=[throughput for _, _, throughput in front],
+        mode="after",
+        line_color="black",
+        line_dash="dashed",
+    )
+
+    plot.scatter(
+        x="x",
+        y="y",
+        source=source,
+        size=12,
+        marker="markers",
+        fill_color="colors",
+        fill_alpha="alpha",
+        line_color="black",
+    )
+
+    labels = LabelSet(
+        x="x",
+        y="y",
+        text="name",
+        x_offset=8,
+        y_offset=4,
+        source=source,
+        render_mode="canvas",
+        text_font_size="9pt",
+    )
+    plot.add_layout(labels)
+
+    plot.x_range.start = 0
+    plot.y_range.start = 0
+
+    return plot_name, plot
+
+
+def plot_types(binary_sizes, groups):
+    for ty, val1 in groups.items():
+        type_sizes = binary_sizes.get(ty)
+        if type_sizes is None:
+            print(f"No binary sizes for {ty}, skipping.")
+            continue
+
+        for prediction_state, val2 in val1.items():
+            bench_sort_names = set(
+                sort_name
+                for val3 in val2.values()
+                for pattern_values in val3.values()
+                for sort_name in pattern_values.keys()
+            )
+            sort_names = sorted(bench_sort_names.intersection(type_sizes.keys()))
+            if len(sort_names) == 0:
+                continue
+
+            throughputs = geo_mean_throughput(val2, sort_names)
+            if throughputs is None:
+                continue
+
+            points = [
+                (sort_name, type_sizes[sort_name], throughputs[sort_name])
+                for sort_name in sort_names
+            ]
+
+            init_tools()
+
+            plot_name, plot = plot_pareto(ty, prediction_state, points)
+
+            html = file_html(plot, CDN, plot_name)
+            with open(f"{plot_name}.html", "w+") as outfile:
+                outfile.write(html)
+
+
+if __name__ == "__main__":
+    binary_sizes = parse_binary_sizes(
+        sys.argv[1], os.environ.get("PROFILE", "release")
+    )
+    groups = parse_bench_results(sys.argv[2:])
+
+    name = os.path.basename(sys.argv[2]).partition(".")[0]
+    CPU_INFO = get_cpu_info(name)
+    plot_types(binary_sizes, groups)
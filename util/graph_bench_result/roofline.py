@@ -0,0 +1,170 @@
+"""
+Produce graphs that show the time of every sort as equivalent passes over
+memory, as measured by ROOFLINE for the inputs larger than the LLC. One pass is
+the time a streaming copy of the input takes, solid lines use the bandwidth of
+a single thread, dashed lines that of all cores. A sort close to its own
+minimal number of passes is bound by memory bandwidth.
+"""
+
+import json
+import sys
+
+from collections import defaultdict
+
+from bokeh import models
+from bokeh.plotting import figure, ColumnDataSource
+from bokeh.resources import CDN
+from bokeh.embed import file_html
+from bokeh.palettes import Colorblind
+
+from cpu_info import get_cpu_info
+from util import (
+    BenchmarkKey,
+    build_implementation_meta_info,
+    base_name,
+    plot_name_suffix,
+)
+
+CPU_INFO = None
+
+# Needs to be shared instance :/
+TOOLS = None
+IMPL_META_INFO = build_implementation_meta_info()
+
+
+def extract_groups(paths):
+    # Result layout:
+    # { type (eg. u64):
+    #   { pattern (eg. random):
+    #     { sort_name (eg. rust_ipnsort_unstable):
+    #       { test_len (eg. 10000000): roofline entry of run_benchmarks.py
+    groups = defaultdict(lambda: defaultdict(lambda: defaultdict(lambda: {})))
+
+    for path in paths:
+        with open(path, "r") as file:
+            file_content = json.load(file)
+
+        for key, roofline in file_content.get("roofline", {}).items():
+            benchmark_key = BenchmarkKey(key)
+            groups[benchmark_key.ty][benchmark_key.pattern][
+                benchmark_key.sort_name
+            ][benchmark_key.test_len] = roofline
+
+    return groups
+
+
+def init_tools():
+    global TOOLS
+    TOOLS = [
+        models.WheelZoomTool(),
+        models.BoxZoomTool(),
+        models.PanTool(),
+        models.HoverTool(
+            tooltips=[
+                ("Sort", "@sort_names"),
+                ("Test Size", "@test_sizes"),
+                ("Copy passes", "@copy{0.00}"),
+                ("Read passes", "@read{0.00}"),
+                ("Write passes", "@write{0.00}"),
+                ("Threads", "@threads"),
+            ],
+        ),
+        models.ResetTool(),
+    ]
+
+
+def add_tools_to_plot(plot):
+    plot.add_tools(*TOOLS)
+
+    plot.toolbar.active_scroll = None
+    plot.toolbar.active_tap = None
+    plot.toolbar.active_drag = TOOLS[1]
+
+
+def plot_roofline(ty, pattern, sort_values):
+    plot_name = f"{ty}-roofline-{pattern}{plot_name_suffix()}"
+    plot = figure(
+        title=plot_name,
+        x_axis_label="Input length (log)",
+        x_axis_type="log",
+        y_axis_label=(
+            f"Equivalent copy passes over memory | Lower is better | {CPU_INFO}"
+        ),
+        plot_width=1000,
+        plot_height=600,
+        tools="",
+    )
+    add_tools_to_plot(plot)
+
+    plot.add_layout(models.Legend(), "right")
+
+    palette = list(Colorblind[8])
+
+    for i, (sort_name, values) in enumerate(sorted(sort_values.items())):
+        color, symbol = IMPL_META_INFO.get(
+            sort_name, (palette[i % len(palette)], "circle")
+        )
+        test_sizes = sorted(values.keys())
+
+        for suffix, line_dash in [("st", "solid"), ("mt", "dashed")]:
+            passes = [values[test_len]["passes"] for test_len in test_sizes]
+            threads = [
+                1 if suffix == "st" else values[test_len]["threads"]
+                for test_len in test_sizes
+            ]
+
+            data = {
+                "test_sizes": test_sizes,
+                "copy": [p[f"copy_{suffix}"] for p in passes],
+                "read": [p[f"read_{suffix}"] for p in passes],
+                "write": [p[f"write_{suffix}"] for p in passes],
+                "threads": threads,
+                "sort_names": [sort_name] * len(test_sizes),
+            }
+            source = ColumnDataSource(data=data)
+            threads_label = "1 thread" if suffix == "st" else "all cores"
+            legend_label = f"{sort_name} ({threads_label})"
+
+            plot.line(
+                x="test_sizes",
+                y="copy",
+                source=source,
+                line_width=1.5,
+                color=color,
+                line_dash=line_dash,
+                legend_label=legend_label,
+            )
+            getattr(plot, symbol)(
+                x="test_sizes",
+                y="copy",
+                source=source,
+                size=6,
+                fill_color=None,
+                line_color=color,
+                legend_label=legend_label,
+            )
+
+    plot.y_range.start = 0
+
+    return plot_name, plot
+
+
+def plot_rooflines(groups):
+    for ty, val1 in groups.items():
+        for pattern, sort_values in val1.items():
+            init_tools()
+
+            plot_name, plot = plot_roofline(ty, pattern, sort_values)
+
+            html = file_html(plot, CDN, plot_name)
+            with open(f"{base_name()}-{plot_name}.html", "w+") as outfile:
+                outfile.write(html)
+
+
+if __name__ == "__main__":
+    groups = extract_groups(sys.argv[1:])
+
+    # Only results of runs with ROOFLINE have anything to plot.
+    if len(groups) > 0:
+        CPU_INFO = get_cpu_info(base_name())
+        plot_rooflines(groups)
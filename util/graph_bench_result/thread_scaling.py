@@ -0,0 +1,183 @@
+"""
+Produce graphs that show how parallel sort implementations scale with the
+number of threads, as measured by BENCH_OTHER=thread_scaling.
+
+Results named <sort>_t<N> use one thread per physical core, <sort>_t<N>_smt
+fill up the SMT siblings of each core first. Speedup is relative to the single
+threaded run of the same sort, parallel efficiency is speedup / N.
+"""
+
+import re
+import sys
+
+from bokeh import models
+from bokeh.palettes import Colorblind
+from bokeh.plotting import figure, ColumnDataSource
+from bokeh.resources import CDN
+from bokeh.embed import file_html
+
+from cpu_info import get_cpu_info
+from util import parse_bench_results, base_name, plot_name_suffix
+
+CPU_INFO = None
+
+THREAD_SUFFIX_RE = re.compile(r"^(.+)_t(\d+)(_smt)?$")
+
+# Needs to be shared instance :/
+TOOLS = None
+
+
+def init_tools():
+    global TOOLS
+    TOOLS = [
+        models.WheelZoomTool(),
+        models.BoxZoomTool(),
+        models.PanTool(),
+        models.HoverTool(
+            tooltips=[
+                ("Threads", "@x"),
+                ("Speedup", "@y{0.00}x"),
+                ("Efficiency", "@efficiency{0.0}%"),
+                ("Name", "@name"),
+            ],
+        ),
+        models.ResetTool(),
+    ]
+
+
+def add_tools_to_plot(plot):
+    plot.add_tools(*TOOLS)
+
+    plot.toolbar.active_scroll = None
+    plot.toolbar.active_tap = None
+    plot.toolbar.active_drag = TOOLS[1]
+
+
+def extract_sweeps(sort_times):
+    """Maps (sort_name, smt_suffix) to a sorted list of (threads, time_ns)."""
+    sweeps = {}
+
+    for sort_name, bench_time_ns in sort_times.items():
+        match = THREAD_SUFFIX_RE.match(sort_name)
+        if match is None:
+            continue
+
+        base, threads, smt = match.groups()
+        sweeps.setdefault((base, smt or ""), []).append(
+            (int(threads), bench_time_ns)
+        )
+
+    return {key: sorted(values) for key, values in sweeps.items()}
+
+
+def speedup_line(sweep, baseline_ns):
+    x = [threads for threads, _ in sweep]
+    y = [baseline_ns / bench_time_ns for _, bench_time_ns in sweep]
+    efficiency = [speedup / threads * 100 for threads, speedup in zip(x, y)]
+
+    return x, y, efficiency
+
+
+def plot_thread_scaling(ty, prediction_state, pattern, test_len, sweeps):
+    plot_name = (
+        f"{prediction_state}-{ty}-thread_scaling-{pattern}-{test_len}"
+        f"{plot_name_suffix()}"
+    )
+    plot = figure(
+        title=plot_name,
+        x_axis_label="Threads",
+        y_axis_label=f"Speedup over 1 thread | Higher is better | {CPU_INFO}",
+        plot_width=1000,
+        plot_height=600,
+        tools="",
+    )
+    add_tools_to_plot(plot)
+
+    plot.add_layout(models.Legend(), "right")
+
+    palette = list(Colorblind[8])
+    bases = sorted({base for base, _ in sweeps.keys()})
+    max_threads = max(sweep[-1][0] for sweep in sweeps.values())
+
+    plot.line(
+        x=[1, max_threads],
+        y=[1, max_threads],
+        color="gray",
+        line_dash="dotted",
+        legend_label="ideal",
+    )
+
+    for (base, smt), sweep in sorted(sweeps.items()):
+        # Both modes are relative to the same single threaded run, so the SMT
+        # line directly shows what the siblings add.
+        baseline = sweeps.get((base, ""), sweep)
+        if baseline[0][0] != 1:
+            continue
+
+        name = f"{base}{smt}"
+        x, y, efficiency = speedup_line(sweep, baseline[0][1])
+
+        print(f"{plot_name} {name}:")
+        for threads, speedup, eff in zip(x, y, efficiency):
+            print(
+                f"  t{threads}: {speedup:.2f}x speedup, {eff:.1f}% efficiency"
+            )
+
+        color = palette[bases.index(base) % len(palette)]
+        line_dash = "dashed" if smt else "solid"
+
+        data = {
+            "x": x,
+            "y": y,
+            "efficiency": efficiency,
+            "name": [name] * len(x),
+        }
+        source = ColumnDataSource(data=data)
+
+        plot.line(
+            source=source,
+            line_width=1.5,
+            color=color,
+            line_dash=line_dash,
+            legend_label=name,
+        )
+        plot.circle(
+            source=source,
+            size=6,
+            fill_color=None,
+            line_color=color,
+            legend_label=name,
+        )
+
+    plot.x_range = models.Range1d(start=0, end=max_threads * 1.05)
+    plot.y_range = models.Range1d(start=0, end=max_threads * 1.05)
+
+    return plot_name, plot
+
+
+def plot_sweeps(groups):
+    for ty, val1 in groups.items():
+        for prediction_state, val2 in val1.items():
+            for test_len, val3 in sorted(val2.items()):
+                for pattern, sort_times in val3.items():
+                    sweeps = extract_sweeps(sort_times)
+                    if not any(len(sweep) > 1 for sweep in sweeps.values()):
+                        continue
+
+                    init_tools()
+
+                    plot_name, plot = plot_thread_scaling(
+                        ty, prediction_state, pattern, test_len, sweeps
+                    )
+
+                    html = file_html(plot, CDN, plot_name)
+                    with open(f"{plot_name}.html", "w+") as outfile:
+                        outfile.write(html)
+
+
+if __name__ == "__main__":
+    groups = parse_bench_results(sys.argv[1:])
+
+    name = base_name()
+    CPU_INFO = get_cpu_info(name)
+    plot_sweeps(groups)
@@ -273,14 +273,21 @@ def build_pattern_meta_info():
     # Use color blind palette to increase accessibility.
     palette = list(Colorblind[8])
 
-    meta_info = {
-        "ascending": (palette[0], "diamond"),
-        "descending": (palette[1], "square"),
-        "random_d20": (palette[3], "square_pin"),
-        "random_p5": (palette[4], "square_cross"),
-        "random_s95": (palette[5], "circle"),
-        "random_z1": (palette[6], "inverted_triangle"),
-        "random": (palette[7], "triangle"),
-    }
+    # Other patterns, e.g. BENCH_DATASET ones, share a fallback. The adversarial ones only differ
+    # from it by their symbol.
+    meta_info = defaultdict(
+        lambda: (palette[2], "hex"),
+        {
+            "antiqsort": (palette[2], "x"),
+            "median_of_3_killer": (palette[2], "star"),
+            "ascending": (palette[0], "diamond"),
+            "descending": (palette[1], "square"),
+            "random_d20": (palette[3], "square_pin"),
+            "random_p5": (palette[4], "square_cross"),
+            "random_s95": (palette[5], "circle"),
+            "random_z1": (palette[6], "inverted_triangle"),
+            "random": (palette[7], "triangle"),
+        },
+    )
 
     return meta_info
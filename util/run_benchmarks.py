@@ -4,6 +4,10 @@ import os
 import shutil
 import argparse
 import json
+import glob
+import math
+import random
+import statistics
 
 from graph_bench_result.cpu_info import get_cpu_info
 
@@ -24,7 +28,16 @@ def check_for_correct_dir():
         sys.exit(1)
 
 
-def run_benchmarks(test_name, bench_name_overwrite):
+def bench_features():
+    # Additional sort implementations can be enabled with BENCH_FEATURES, e.g.
+    # BENCH_FEATURES=cpp_vqsort,cpp_pdqsort.
+    return ",".join(
+        ["cold_benchmarks"]
+        + [f for f in os.environ.get("BENCH_FEATURES", "").split(",") if f]
+    )
+
+
+def run_benchmarks(test_name, bench_name_overwrite, repeat=1, max_ci=0.02):
     # Clean target/criterion a messy one can cause issues when exporting with critcmp.
     # We made sure we are in the current dir earlier.
     cur_dir = os.path.abspath(os.getcwd())
@@ -42,12 +55,60 @@ def run_benchmarks(test_name, bench_name_overwrite):
             )
             sys.exit(1)
 
+    # With PERF_COUNTERS=<path> the bench harness appends hardware counter results to <path>,
+    # start from an empty file so that only this run is merged into the results.
+    # Same for the energy measurements of RAPL_ENERGY=<path> and the memory bandwidth
+    # references of ROOFLINE=<path>, and the cycles per sort of BENCH_OTHER=tiny with
+    # TINY_CYCLES=<path>.
+    perf_counters_path = os.environ.get("PERF_COUNTERS", "")
+    rapl_energy_path = os.environ.get("RAPL_ENERGY", "")
+    roofline_path = os.environ.get("ROOFLINE", "")
+    tiny_cycles_path = os.environ.get("TINY_CYCLES", "")
+    for path in [perf_counters_path, rapl_energy_path, roofline_path, tiny_cycles_path]:
+        if path and os.path.exists(path):
+            os.remove(path)
+
+    if repeat > 1:
+        bench_results = run_repeated(test_name, repeat, max_ci)
+    else:
+        run_cargo_bench(test_name, os.environ)
+        bench_results = export_baseline(test_name)
+
+    if perf_counters_path and os.path.exists(perf_counters_path):
+        bench_results = merge_per_benchmark(
+            bench_results, perf_counters_path, "perf_counters", "counters"
+        )
+
+    if rapl_energy_path and os.path.exists(rapl_energy_path):
+        bench_results = merge_per_benchmark(
+            bench_results, rapl_energy_path, "rapl_energy", "energy"
+        )
+
+    if roofline_path and os.path.exists(roofline_path):
+        bench_results = merge_per_benchmark(
+            bench_results, roofline_path, "roofline", "roofline"
+        )
+
+    if tiny_cycles_path and os.path.exists(tiny_cycles_path):
+        bench_results = merge_per_benchmark(
+            bench_results, tiny_cycles_path, "tiny_cycles", "cycles"
+        )
+
+    out_file_name = f"{test_name}.json"
+    with open(out_file_name, "w+") as result_file:
+        result_file.write(bench_results)
+
+    print(f"\nWrote results to {out_file_name}")
+    return out_file_name
+
+
+def run_cargo_bench(baseline_name, env):
     subprocess.run(
         [
             "cargo",
             "bench",
             "--features",
-            "cold_benchmarks",
+            bench_features(),
             "--bench",
             "bench",
             "--",
@@ -57,14 +118,16 @@ def run_benchmarks(test_name, bench_name_overwrite):
             "4",
             "--noplot",
             "--save-baseline",
-            test_name,
+            baseline_name,
         ],
         check=True,
-        env=os.environ,
+        env=env,
     )
 
+
+def export_baseline(baseline_name):
     critcmp_result = subprocess.run(
-        ["critcmp", "--export", test_name], capture_output=True
+        ["critcmp", "--export", baseline_name], capture_output=True
     )
 
     if critcmp_result.returncode != 0:
@@ -72,17 +135,233 @@ def run_benchmarks(test_name, bench_name_overwrite):
         sys.stderr.write(f"\n[Error] Failed to export results with critcmp: {critcmp_result_stderr}")
         sys.exit(critcmp_result.returncode)
 
-    bench_results = critcmp_result.stdout.decode("utf-8")
+    return critcmp_result.stdout.decode("utf-8")
+
+
+def read_sys_file(path):
+    try:
+        with open(path, "r") as file:
+            return file.read().strip()
+    except OSError:
+        return None
+
+
+def read_cpu_state():
+    """Frequency scaling state of all CPUs, as far as the kernel exposes it."""
+    cpufreq_dirs = sorted(glob.glob("/sys/devices/system/cpu/cpu[0-9]*/cpufreq"))
+
+    def per_cpu(file_name):
+        values = [read_sys_file(os.path.join(d, file_name)) for d in cpufreq_dirs]
+        return [val for val in values if val is not None]
+
+    cur_freqs_mhz = [int(val) / 1000 for val in per_cpu("scaling_cur_freq")]
+    max_freqs_mhz = [int(val) / 1000 for val in per_cpu("cpuinfo_max_freq")]
+
+    # intel_pstate reports no_turbo, acpi-cpufreq and amd-pstate boost.
+    no_turbo = read_sys_file("/sys/devices/system/cpu/intel_pstate/no_turbo")
+    boost = read_sys_file("/sys/devices/system/cpu/cpufreq/boost")
+    turbo = None
+    if no_turbo is not None:
+        turbo = no_turbo == "0"
+    elif boost is not None:
+        turbo = boost == "1"
+
+    return {
+        "governors": sorted(set(per_cpu("scaling_governor"))),
+        "energy_performance_preferences": sorted(
+            set(per_cpu("energy_performance_preference"))
+        ),
+        "turbo": turbo,
+        "cur_freq_mhz_min": min(cur_freqs_mhz, default=None),
+        "cur_freq_mhz_max": max(cur_freqs_mhz, default=None),
+        "max_freq_mhz": max(max_freqs_mhz, default=None),
+        "aslr": read_sys_file("/proc/sys/kernel/randomize_va_space"),
+    }
 
-    out_file_name = f"{test_name}.json"
-    with open(out_file_name, "w+") as result_file:
-        result_file.write(bench_results)
 
-    print(f"\nWrote results to {out_file_name}")
-    return out_file_name
+def cpu_state_warnings(states):
+    warnings = set()
+
+    for state in states:
+        if any(governor != "performance" for governor in state["governors"]):
+            warnings.add(
+                f"CPU frequency governor is {','.join(state['governors'])}, not performance"
+            )
+        if state["turbo"]:
+            warnings.add("Turbo boost is enabled, the clock depends on temperature and load")
+        if state["aslr"] == "0":
+            warnings.add("ASLR is disabled, only the padding varies the memory layout")
+
+        max_freq_ghz = os.environ.get("CPU_MAX_FREQ_GHZ")
+        if max_freq_ghz and state["max_freq_mhz"]:
+            if abs(float(max_freq_ghz) * 1000 - state["max_freq_mhz"]) > 50:
+                warnings.add(
+                    f"CPU_MAX_FREQ_GHZ={max_freq_ghz} doesn't match the "
+                    f"{state['max_freq_mhz'] / 1000} GHz reported by the kernel"
+                )
+
+    # The current frequencies change all the time, the rest is configuration.
+    def config(state):
+        return {k: v for k, v in state.items() if not k.startswith("cur_freq")}
+
+    if any(config(state) != config(states[0]) for state in states[1:]):
+        warnings.add("The frequency scaling configuration changed between processes")
+
+    return sorted(warnings)
+
+
+# Two-sided 95% quantiles of Student's t-distribution for 1 to 30 degrees of freedom.
+T_95 = [
+    12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+    2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+    2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042,
+]
+
+
+def estimate_across_runs(values):
+    """Mean of the per process values with the 95% confidence interval of that mean."""
+    mean = statistics.mean(values)
+    standard_error = statistics.stdev(values) / math.sqrt(len(values))
+    df = len(values) - 1
+    half_width = (T_95[df - 1] if df <= len(T_95) else 1.96) * standard_error
+
+    return {
+        "confidence_interval": {
+            "confidence_level": 0.95,
+            "lower_bound": mean - half_width,
+            "upper_bound": mean + half_width,
+        },
+        "point_estimate": mean,
+        "standard_error": standard_error,
+    }
 
 
-def run_benchmarks_variant(test_name, variant):
+def relative_half_width(estimate):
+    interval = estimate["confidence_interval"]
+    return (interval["upper_bound"] - interval["lower_bound"]) / (
+        2 * estimate["point_estimate"]
+    )
+
+
+def aggregate_runs(test_name, run_results, cpu_states, max_ci):
+    """One critcmp export with the median and mean across the processes in place of the per
+    process ones, so that the graph and analysis scripts pick them up, and the per process
+    values and noise flags under "repeat"."""
+    names = set(run_results[0]["benchmarks"])
+    for run_result in run_results[1:]:
+        names &= set(run_result["benchmarks"])
+
+    combined = json.loads(json.dumps(run_results[0]))
+    combined["name"] = test_name
+    combined["benchmarks"] = {}
+    repeat_benchmarks = {}
+
+    for name in sorted(names):
+        entries = [run_result["benchmarks"][name] for run_result in run_results]
+        entry = json.loads(json.dumps(entries[0]))
+        estimates = entry["criterion_estimates_v1"]
+
+        for estimate_name in ["median", "mean"]:
+            estimates[estimate_name] = estimate_across_runs(
+                [
+                    e["criterion_estimates_v1"][estimate_name]["point_estimate"]
+                    for e in entries
+                ]
+            )
+
+        rel_ci = relative_half_width(estimates["median"])
+        noise = []
+        if rel_ci > max_ci:
+            noise.append("wide_ci")
+        if any(
+            relative_half_width(e["criterion_estimates_v1"]["median"]) > max_ci
+            for e in entries
+        ):
+            noise.append("noisy_process")
+
+        combined["benchmarks"][name] = entry
+        repeat_benchmarks[name] = {
+            "medians": [
+                e["criterion_estimates_v1"]["median"]["point_estimate"] for e in entries
+            ],
+            "rel_ci": rel_ci,
+            "noise": noise,
+        }
+
+    skipped = set().union(*(r["benchmarks"] for r in run_results)) - names
+    if skipped:
+        print(f"Left out {len(skipped)} benchmarks that didn't run in every process")
+
+    combined["repeat"] = {
+        "processes": len(run_results),
+        "max_ci": max_ci,
+        "cpu_states": cpu_states,
+        "warnings": cpu_state_warnings(cpu_states),
+        "benchmarks": repeat_benchmarks,
+    }
+
+    return combined
+
+
+def run_repeated(test_name, repeat, max_ci):
+    """Runs the benchmarks in repeat fresh processes, each with a different memory layout, and
+    aggregates them with aggregate_runs."""
+    run_results = []
+    cpu_states = []
+
+    for run_idx in range(repeat):
+        # Environment strings sit at the top of the stack, their length shifts the alignment of
+        # everything below. BENCH_HEAP_PAD makes the bench harness leak an allocation of that
+        # size before the first benchmark, which shifts the heap.
+        env = dict(os.environ)
+        env["BENCH_STACK_PAD"] = "x" * random.randrange(4096)
+        env["BENCH_HEAP_PAD"] = str(random.randrange(4096))
+
+        cpu_states.append(read_cpu_state())
+        print(f"Running process {run_idx + 1} of {repeat}")
+
+        baseline_name = f"{test_name}_p{run_idx}"
+        run_cargo_bench(baseline_name, env)
+        run_results.append(json.loads(export_baseline(baseline_name)))
+
+    cpu_states.append(read_cpu_state())
+
+    combined = aggregate_runs(test_name, run_results, cpu_states, max_ci)
+    for warning in combined["repeat"]["warnings"]:
+        print(f"[Warning] {warning}")
+
+    noisy = [
+        name
+        for name, value in combined["repeat"]["benchmarks"].items()
+        if value["noise"]
+    ]
+    print(
+        f"{len(noisy)} of {len(combined['benchmarks'])} benchmarks are flagged as noisy, their "
+        f"95% confidence interval across processes or within one is wider than +-{max_ci:.1%}"
+    )
+    for name in noisy[:20]:
+        value = combined["repeat"]["benchmarks"][name]
+        print(f"  {name}: +-{value['rel_ci']:.1%} {','.join(value['noise'])}")
+
+    return json.dumps(combined, indent=2)
+
+
+def merge_per_benchmark(bench_results, json_lines_path, result_key, entry_key):
+    """Adds the entry_key values of the JSON lines in json_lines_path under result_key, keyed by
+    benchmark name. E.g. the per element counters of PERF_COUNTERS under "perf_counters"."""
+    parsed_results = json.loads(bench_results)
+    per_benchmark = parsed_results.setdefault(result_key, {})
+
+    with open(json_lines_path, "r", encoding="utf-8") as json_lines_file:
+        for line in json_lines_file:
+            if line.strip():
+                entry = json.loads(line)
+                per_benchmark[entry["name"]] = entry[entry_key]
+
+    return json.dumps(parsed_results, indent=2)
+
+
+def run_benchmarks_variant(test_name, variant, repeat, max_ci):
     variant_name = variant["name"]
     setup_cmd = variant["setup_cmd"]
     bench_name_overwrite = variant["BENCH_NAME_OVERWRITE"]
@@ -100,7 +379,7 @@ def run_benchmarks_variant(test_name, variant):
 
     print(f"Running test: {full_test_name}")
 
-    return run_benchmarks(full_test_name, bench_name_overwrite)
+    return run_benchmarks(full_test_name, bench_name_overwrite, repeat, max_ci)
 
 
 def combine_out_files(test_name, out_file_names):
@@ -118,6 +397,14 @@ def combine_out_files(test_name, out_file_names):
             open(out_file_name, "r", encoding="utf-8").read()
         )
         combined_result["benchmarks"] |= parsed_result["benchmarks"]
+        if "perf_counters" in parsed_result:
+            combined_result.setdefault("perf_counters", {}).update(
+                parsed_result["perf_counters"]
+            )
+        if "repeat" in parsed_result:
+            combined_result.setdefault("repeat", {"benchmarks": {}})[
+                "benchmarks"
+            ].update(parsed_result["repeat"]["benchmarks"])
 
     with open(out_name, "w+", encoding="utf-8") as out_file:
         out_file.write(json.dumps(combined_result, indent=2))
@@ -157,6 +444,20 @@ JSON format:
         description="Tool for running and collecting benchmark results"
     )
     parser.add_argument("--variants", dest="variants_file", help=variants_help)
+    parser.add_argument(
+        "--repeat",
+        type=int,
+        default=1,
+        help="Run the benchmarks in this many fresh processes, each with a different stack and "
+        "heap alignment, and aggregate them with confidence intervals and noise flags",
+    )
+    parser.add_argument(
+        "--max-ci",
+        type=float,
+        default=0.02,
+        help="With --repeat, flag benchmarks whose 95%% confidence interval is wider than "
+        "+- this fraction of the time, by default 0.02",
+    )
     parser.add_argument(
         "test_name",
         nargs="?",
@@ -189,7 +490,9 @@ JSON format:
     test_name = variants["test_name"]
     out_file_names = []
     for variant in variants["variants"]:
-        out_file_names.append(run_benchmarks_variant(test_name, variant))
+        out_file_names.append(
+            run_benchmarks_variant(test_name, variant, args.repeat, args.max_ci)
+        )
 
     if len(out_file_names) > 1:
         combine_out_files(test_name, out_file_names)
@@ -0,0 +1,79 @@
+"""Profile guided optimization of the C and C++ sorts.
+
+1. Builds the benchmarks with CPP_PGO=generate and runs a training set, which writes the profiles
+   of the instrumented C and C++ objects to target/release/cpp_pgo.
+2. Benchmarks BENCH_REGEX with the regular -O3 build, and with the CPP_PGO=use rebuild.
+3. Prints the speedup per sort and type, see analyze_bench_result.py.
+
+E.g.:
+BENCH_FEATURES=cpp_pdqsort,cpp_ips4o BENCH_REGEX="-hot-(i32|u64|string)-" python util/run_cpp_pgo.py pgo_zen3
+
+The training set can be changed with PGO_TRAIN_REGEX. It should be representative, code that it
+doesn't reach is optimized as without profile.
+"""
+
+import os
+import shutil
+import subprocess
+import sys
+
+import analyze_bench_result
+import run_benchmarks
+
+DEFAULT_TRAIN_REGEX = "-hot-(i32|u64|string|f128|1k)-(random|random_d20|random_s95|ascending|descending|saws_long)-(24|900|100000)$"
+
+
+def run_training():
+    pgo_dir = os.path.join(os.path.abspath(os.getcwd()), "target", "release", "cpp_pgo")
+    if os.path.exists(pgo_dir):
+        shutil.rmtree(pgo_dir)
+
+    # Same features as the benchmark runs, gcc finds the profile of an object by its path, which
+    # depends on the features.
+    env = dict(os.environ)
+    env["CPP_PGO"] = "generate"
+    env["BENCH_REGEX"] = os.environ.get("PGO_TRAIN_REGEX", DEFAULT_TRAIN_REGEX)
+
+    subprocess.run(
+        [
+            "cargo",
+            "bench",
+            "--features",
+            run_benchmarks.bench_features(),
+            "--bench",
+            "bench",
+            "--",
+            "--warm-up-time",
+            "0.5",
+            "--measurement-time",
+            "1",
+            "--noplot",
+        ],
+        check=True,
+        env=env,
+    )
+
+
+if __name__ == "__main__":
+    run_benchmarks.check_for_critcmp()
+    run_benchmarks.check_for_correct_dir()
+
+    if len(sys.argv) != 2:
+        print("Usage: python util/run_cpp_pgo.py <test_name>, e.g. pgo_zen3")
+        sys.exit(1)
+
+    test_name = sys.argv[1]
+
+    run_training()
+
+    os.environ.pop("CPP_PGO", None)
+    o3_file_name = run_benchmarks.run_benchmarks(f"{test_name}_o3", "")
+
+    os.environ["CPP_PGO"] = "use"
+    pgo_file_name = run_benchmarks.run_benchmarks(f"{test_name}_pgo", "")
+
+    # Speedups are those of the PGO build over the -O3 one.
+    analyze_bench_result.analyze_bench_results(
+        analyze_bench_result.parse_result(pgo_file_name),
+        analyze_bench_result.parse_result(o3_file_name),
+    )
@@ -0,0 +1,80 @@
+"""Benchmarks the Rust sorts, and with BENCH_FEATURES=cpp_vqsort vqsort, compiled to WebAssembly
+with SIMD128 and run by wasmtime. Writes <test_name>.json in the same format as run_benchmarks.py,
+so that the results can be graphed or compared against a native run.
+
+E.g.:
+WASI_SYSROOT=/opt/wasi-sdk/share/wasi-sysroot BENCH_FEATURES=cpp_vqsort BENCH_REGEX="-hot-(i32|u64)-random-" python util/run_wasm_benchmarks.py wasm_zen3
+
+Needs the wasm32-wasip1 target of the nightly toolchain, wasmtime, and for the C++ sorts clang and
+the wasi-sdk sysroot in WASI_SYSROOT, see README.md. The target can be changed with WASM_TARGET,
+the runtime with WASM_RUNTIME, e.g. WASM_RUNTIME="wasmtime run -W simd=y".
+"""
+
+import os
+import shlex
+import subprocess
+import sys
+
+import run_benchmarks
+
+
+def wasm_target():
+    return os.environ.get("WASM_TARGET", "wasm32-wasip1")
+
+
+def build_driver():
+    features = ",".join(
+        ["wasm_bench_driver"]
+        + [f for f in os.environ.get("BENCH_FEATURES", "").split(",") if f]
+    )
+
+    env = dict(os.environ)
+    env["RUSTFLAGS"] = " ".join(
+        [os.environ.get("RUSTFLAGS", ""), "-C target-feature=+simd128"]
+    ).strip()
+
+    subprocess.run(
+        [
+            "cargo",
+            "build",
+            "--release",
+            "--target",
+            wasm_target(),
+            "--bin",
+            "wasm_bench_driver",
+            "--features",
+            features,
+        ],
+        check=True,
+        env=env,
+    )
+
+    return os.path.join("target", wasm_target(), "release", "wasm_bench_driver.wasm")
+
+
+def run_driver(driver_path, test_name):
+    runtime = shlex.split(os.environ.get("WASM_RUNTIME", "wasmtime run"))
+
+    # The guest only sees the environment variables and directories passed explicitly.
+    env_args = []
+    for env_var in ["BENCH_REGEX", "OVERRIDE_SEED"]:
+        if env_var in os.environ:
+            env_args += ["--env", env_var]
+
+    subprocess.run(
+        runtime + ["--dir=."] + env_args + [driver_path, test_name],
+        check=True,
+    )
+
+
+if __name__ == "__main__":
+    run_benchmarks.check_for_correct_dir()
+
+    if len(sys.argv) != 2:
+        print("Usage: python util/run_wasm_benchmarks.py <test_name>, e.g. wasm_zen3")
+        sys.exit(1)
+
+    test_name = sys.argv[1]
+
+    driver_path = build_driver()
+    run_driver(driver_path, test_name)
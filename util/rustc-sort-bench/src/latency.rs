@@ -0,0 +1,88 @@
+//! Measures the latency of single sorts on cold code, as seen by a program that only sorts once in
+//! a while. Before each measurement the branch prediction state and the instruction cache are
+//! trashed, then the input is created, so the data is in cache but the code of the sort is not.
+//! Reports the p50 and p99 latency per length, as the tail is where cold code hurts most.
+
+use std::hint::black_box;
+
+use crate::benchmark::pin_thread_to_core;
+use crate::measure::{measure_duration, DurationOpaque};
+use crate::patterns;
+use crate::trash_prediction::trash_prediction_state;
+
+/// A sort under test, monomorphized for `u64`. `u64` is the one type that all the Rust and FFI
+/// sorts support natively.
+pub type LatencySort = (String, fn(&mut [u64]));
+
+pub fn report_cold_latency(sorts: &[LatencySort]) {
+    pin_thread_to_core();
+
+    #[allow(clippy::type_complexity)]
+    let pattern_providers: Vec<(&'static str, fn(usize) -> Vec<u64>)> = vec![
+        ("random", patterns::random),
+        ("random_d20", |len| patterns::random_uniform(len, 0..20)),
+        ("random_s95", |len| patterns::random_sorted(len, 95.0)),
+    ];
+
+    let test_lens = [20, 100, 1_000, 10_000, 100_000];
+
+    let unit = DurationOpaque::unit_name();
+
+    for (pattern_name, pattern_provider) in &pattern_providers {
+        println!("\ncold-u64-{pattern_name} latency in {unit} (p50 / p99):");
+
+        let header = sorts
+            .iter()
+            .map(|(sort_name, _)| format!("{sort_name:>32}"))
+            .collect::<String>();
+        println!("{:>8}{header}", "len");
+
+        for test_len in test_lens {
+            let row = sorts
+                .iter()
+                .map(|(_, sort_fn)| {
+                    let (p50, p99) = sample_cold_latency(test_len, pattern_provider, *sort_fn);
+                    format!(
+                        "{:>32}",
+                        format!("{:.0} / {:.0}", p50.as_opaque(), p99.as_opaque())
+                    )
+                })
+                .collect::<String>();
+            println!("{test_len:>8}{row}");
+        }
+    }
+}
+
+fn sample_cold_latency(
+    test_len: usize,
+    pattern_provider: impl Fn(usize) -> Vec<u64>,
+    sort_fn: fn(&mut [u64]),
+) -> (DurationOpaque, DurationOpaque) {
+    // Every sample pays for trashing the prediction state, which takes far longer than sorting the
+    // short inputs. Enough samples that the p99 is not just the max.
+    let sample_count = if test_len <= 10_000 { 1_000 } else { 200 };
+
+    let mut durations = (0..sample_count)
+        .map(|_| {
+            // Try as best as possible to trash all prediction state in the CPU, to simulate
+            // calling the sort as part of a larger program.
+            let first_val = black_box(trash_prediction_state(black_box(0)));
+
+            let mut input = pattern_provider(test_len);
+
+            // Limit the optimizer in getting rid of trash_prediction_state, by tying its output
+            // to the input.
+            input[0] = input[0].wrapping_add(first_val as u64);
+
+            let duration = measure_duration(|| sort_fn(black_box(&mut input)));
+            black_box(input); // side-effect
+
+            duration
+        })
+        .collect::<Vec<_>>();
+
+    (
+        DurationOpaque::percentile(&mut durations, 50.0),
+        DurationOpaque::percentile(&mut durations, 99.0),
+    )
+}
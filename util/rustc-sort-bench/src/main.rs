@@ -1,12 +1,19 @@
 mod benchmark;
 mod evaluate;
+mod latency;
 mod measure;
 mod patterns;
 
+// Shared with the criterion benchmarks of sort-research-rs, flushing the BTB needs a lot of
+// generated code.
+#[path = "../../../benches/trash_prediction.rs"]
+mod trash_prediction;
+
 use std::env;
 use std::path::PathBuf;
 
 use crate::evaluate::{compare_sort, Sort};
+use crate::latency::{report_cold_latency, LatencySort};
 
 struct StdStable {}
 
@@ -44,8 +51,51 @@ impl Sort for IpnsortUnstable {
     }
 }
 
+fn latency_sort<S: Sort>() -> LatencySort {
+    (S::name(), S::sort::<u64>)
+}
+
+/// Adapts the FFI sorts of sort-research-rs.
+#[cfg(feature = "ffi_sorts")]
+struct Ffi<S: sort_test_tools::Sort>(std::marker::PhantomData<S>);
+
+#[cfg(feature = "ffi_sorts")]
+impl<S: sort_test_tools::Sort> Sort for Ffi<S> {
+    fn name() -> String {
+        S::name()
+    }
+
+    fn sort<T: Ord>(v: &mut [T]) {
+        S::sort(v);
+    }
+}
+
 fn main() {
     let args = env::args().collect::<Vec<_>>();
+
+    if args.get(1).map(String::as_str) == Some("--cold-latency") {
+        #[allow(unused_mut)]
+        let mut sorts = vec![
+            latency_sort::<StdStable>(),
+            latency_sort::<StdUnstable>(),
+            latency_sort::<IpnsortUnstable>(),
+        ];
+
+        #[cfg(feature = "ffi_sorts")]
+        {
+            use sort_research_rs::unstable;
+
+            sorts.extend([
+                latency_sort::<Ffi<unstable::cpp_std_sys::SortImpl>>(),
+                latency_sort::<Ffi<unstable::cpp_pdqsort::SortImpl>>(),
+                latency_sort::<Ffi<unstable::c_crumsort::SortImpl>>(),
+            ]);
+        }
+
+        report_cold_latency(&sorts);
+        return;
+    }
+
     let base_line_path = PathBuf::from(args.get(1).expect(
         "Please provide a base_line_path, that will either be created or compared against.",
     ));
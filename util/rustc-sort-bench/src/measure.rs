@@ -80,6 +80,29 @@ impl DurationOpaque {
         (variance, median_duration)
     }
 
+    /// Returns the duration at `percentile` in the range 0-100, sorts `durations`.
+    pub fn percentile(durations: &mut [Self], percentile: f64) -> Self {
+        assert!(!durations.is_empty() && (0.0..=100.0).contains(&percentile));
+
+        durations.sort_unstable();
+
+        let idx = ((durations.len() - 1) as f64 * (percentile / 100.0)).round() as usize;
+        durations[idx]
+    }
+
+    /// Name of the unit of `as_opaque`.
+    pub fn unit_name() -> &'static str {
+        #[cfg(target_arch = "x86_64")]
+        {
+            "cycles"
+        }
+
+        #[cfg(not(target_arch = "x86_64"))]
+        {
+            "ns"
+        }
+    }
+
     pub fn as_opaque(&self) -> f64 {
         #[cfg(target_arch = "x86_64")]
         {